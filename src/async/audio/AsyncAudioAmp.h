@@ -138,9 +138,13 @@ class AudioAmp : public Async::AudioProcessor
   protected:
     void processSamples(float *dest, const float *src, int count)
     {
+        // The gain is copied to a local variable since the compiler
+        // otherwise must assume that writing to dest may change m_gain,
+        // which prevent the loop from being vectorized
+      const float gain = m_gain;
       for (int i=0; i<count; ++i)
       {
-      	dest[i] = src[i] * m_gain;
+        dest[i] = src[i] * gain;
       }
     }
     
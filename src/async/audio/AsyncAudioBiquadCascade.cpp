@@ -0,0 +1,470 @@
+/**
+@file	 AsyncAudioBiquadCascade.cpp
+@brief   A compiled cascade of second order IIR filter sections
+@author  Tobias Blomberg / SM0SVX
+@date	 2026-10-14
+
+\verbatim
+Async - A library for programming event driven applications
+Copyright (C) 2003-2026 Tobias Blomberg / SM0SVX
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+\endverbatim
+*/
+
+
+
+/****************************************************************************
+ *
+ * System Includes
+ *
+ ****************************************************************************/
+
+#include <cassert>
+#include <cstdio>
+#include <cstring>
+#include <cstdlib>
+#include <clocale>
+#include <algorithm>
+
+
+/****************************************************************************
+ *
+ * Project Includes
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Local Includes
+ *
+ ****************************************************************************/
+
+extern "C" {
+#include "fidlib.h"
+};
+
+#include "AsyncAudioBiquadCascade.h"
+
+
+
+/****************************************************************************
+ *
+ * Namespaces to use
+ *
+ ****************************************************************************/
+
+using namespace std;
+using namespace Async;
+
+
+
+/****************************************************************************
+ *
+ * Defines & typedefs
+ *
+ ****************************************************************************/
+
+  // The GCC vector extensions are used to filter a number of channels in
+  // parallel. The compiler map the operations to whatever SIMD instructions
+  // are available on the target. If not supported by the compiler, the
+  // channels are filtered one at a time.
+#if defined(__GNUC__)
+#define BIQUAD_VECTOR_EXT
+typedef double VecDouble __attribute__((vector_size(32)));
+static const size_t VEC_LEN = sizeof(VecDouble) / sizeof(double);
+#else
+static const size_t VEC_LEN = 1;
+#endif
+
+  // On x86, also build a version of the multi channel kernel for CPU:s
+  // supporting AVX2. The best version is selected at runtime when the
+  // program is loaded.
+#if defined(BIQUAD_VECTOR_EXT) && defined(__x86_64__) && \
+    defined(__ELF__) && !defined(__clang__)
+#define BIQUAD_KERNEL __attribute__((target_clones("avx2", "default")))
+#else
+#define BIQUAD_KERNEL
+#endif
+
+  // The helper functions must be inlined into the kernel to be compiled for
+  // the selected instruction set
+#if defined(__GNUC__)
+#define BIQUAD_INLINE inline __attribute__((always_inline))
+#else
+#define BIQUAD_INLINE inline
+#endif
+
+
+
+/****************************************************************************
+ *
+ * Local class definitions
+ *
+ ****************************************************************************/
+
+namespace {
+    // Filter a block of samples in place through N sections, using the
+    // transposed direct form II structure. The type T is either a double,
+    // for one channel, or a vector of doubles for VEC_LEN interleaved
+    // channels. Running a few sections in the same loop give the CPU
+    // independent calculations to do in parallel, since the recursion in
+    // each section limit how fast one section can be run on its own. Loads
+    // and stores are done using memcpy since the buffer may not be aligned
+    // for the vector type.
+  template <typename T, int N>
+  BIQUAD_INLINE void runSections(const AudioBiquadCascade::Section *sec,
+                          T *s1, T *s2, double *x, int count)
+  {
+    const size_t stride = sizeof(T) / sizeof(double);
+    T z1[N], z2[N];
+    for (int k=0; k<N; ++k)
+    {
+      z1[k] = s1[k];
+      z2[k] = s2[k];
+    }
+    for (int i=0; i<count; ++i)
+    {
+      T v;
+      memcpy(&v, x + i * stride, sizeof(v));
+      for (int k=0; k<N; ++k)
+      {
+        const T out = sec[k].b0 * v + z1[k];
+        z1[k] = sec[k].b1 * v - sec[k].a1 * out + z2[k];
+        z2[k] = sec[k].b2 * v - sec[k].a2 * out;
+        v = out;
+      }
+      memcpy(x + i * stride, &v, sizeof(v));
+    }
+    for (int k=0; k<N; ++k)
+    {
+      s1[k] = z1[k];
+      s2[k] = z2[k];
+    }
+  } /* runSections */
+
+
+    // Run all sections, four at a time. The state for section s is stored
+    // at state[2*s*lanes + first] and state[(2*s+1)*lanes + first].
+  template <typename T>
+  BIQUAD_INLINE void runCascade(const vector<AudioBiquadCascade::Section>& sections,
+                  double *state, size_t lanes, size_t first, double *x,
+                  int count)
+  {
+    size_t s = 0;
+    while (s < sections.size())
+    {
+      const size_t n = min<size_t>(4, sections.size() - s);
+      T s1[4], s2[4];
+      for (size_t k=0; k<n; ++k)
+      {
+        memcpy(&s1[k], &state[2*(s+k)*lanes + first], sizeof(T));
+        memcpy(&s2[k], &state[(2*(s+k)+1)*lanes + first], sizeof(T));
+      }
+      switch (n)
+      {
+        case 4: runSections<T, 4>(&sections[s], s1, s2, x, count); break;
+        case 3: runSections<T, 3>(&sections[s], s1, s2, x, count); break;
+        case 2: runSections<T, 2>(&sections[s], s1, s2, x, count); break;
+        default: runSections<T, 1>(&sections[s], s1, s2, x, count); break;
+      }
+      for (size_t k=0; k<n; ++k)
+      {
+        memcpy(&state[2*(s+k)*lanes + first], &s1[k], sizeof(T));
+        memcpy(&state[(2*(s+k)+1)*lanes + first], &s2[k], sizeof(T));
+      }
+      s += n;
+    }
+  } /* runCascade */
+
+
+#ifdef BIQUAD_VECTOR_EXT
+    // Filter up to VEC_LEN channels, starting at channel first, in parallel
+  BIQUAD_KERNEL
+  void runChannelGroup(const vector<AudioBiquadCascade::Section>& sections,
+                       double *state, size_t lanes, size_t first,
+                       size_t group_size, double gain, float *const *dest,
+                       const float *const *src, double *x, int count)
+  {
+    for (int i=0; i<count; ++i)
+    {
+      for (size_t ch=0; ch<VEC_LEN; ++ch)
+      {
+        x[i*VEC_LEN + ch] = (ch < group_size) ? src[first+ch][i] : 0.0;
+      }
+    }
+    runCascade<VecDouble>(sections, state, lanes, first, x, count);
+    for (int i=0; i<count; ++i)
+    {
+      for (size_t ch=0; ch<group_size; ++ch)
+      {
+        dest[first+ch][i] = gain * x[i*VEC_LEN + ch];
+      }
+    }
+  } /* runChannelGroup */
+#endif
+};
+
+
+
+/****************************************************************************
+ *
+ * Prototypes
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Exported Global Variables
+ *
+ ****************************************************************************/
+
+
+
+
+/****************************************************************************
+ *
+ * Local Global Variables
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Public member functions
+ *
+ ****************************************************************************/
+
+AudioBiquadCascade::AudioBiquadCascade(size_t channels)
+  : channels(channels), gain(1.0)
+{
+  assert(channels > 0);
+} /* AudioBiquadCascade::AudioBiquadCascade */
+
+
+AudioBiquadCascade::~AudioBiquadCascade(void)
+{
+} /* AudioBiquadCascade::~AudioBiquadCascade */
+
+
+bool AudioBiquadCascade::parseFilterSpec(const string &filter_spec,
+                                         int sample_rate)
+{
+  char spec_buf[256];
+  strncpy(spec_buf, filter_spec.c_str(), sizeof(spec_buf));
+  spec_buf[sizeof(spec_buf) - 1] = 0;
+  char *spec = spec_buf;
+  FidFilter *ff = 0;
+  char *old_locale = setlocale(LC_ALL, "C");
+  char *fferr = fid_parse(sample_rate, &spec, &ff);
+  setlocale(LC_ALL, old_locale);
+  if (fferr != 0)
+  {
+    error_str = fferr;
+    free(fferr);
+    return false;
+  }
+  bool success = setFidFilter(ff);
+  free(ff);
+  return success;
+} /* AudioBiquadCascade::parseFilterSpec */
+
+
+bool AudioBiquadCascade::setFidFilter(const FidFilter *ff)
+{
+  clear();
+
+    // Pair the IIR and FIR elements up in the same way as the fidlib
+    // interpreter do so that the filter output is the same
+  double tot_gain = 1.0;
+  vector<Section> new_sections;
+  while (ff->len != 0)
+  {
+    if ((ff->typ == 'F') && (ff->len == 1))
+    {
+      tot_gain *= ff->val[0];
+      ff = FFNEXT(ff);
+      continue;
+    }
+
+    const FidFilter *iir = 0;
+    const FidFilter *fir = 0;
+    if (ff->typ == 'F')
+    {
+      fir = ff;
+      ff = FFNEXT(ff);
+    }
+    else if (ff->typ == 'I')
+    {
+      iir = ff;
+      ff = FFNEXT(ff);
+      while ((ff->typ == 'F') && (ff->len == 1))
+      {
+        tot_gain *= ff->val[0];
+        ff = FFNEXT(ff);
+      }
+      if (ff->typ == 'F')
+      {
+        fir = ff;
+        ff = FFNEXT(ff);
+      }
+    }
+    else
+    {
+      error_str = "Unknown fidlib filter element type";
+      return false;
+    }
+
+    if (((iir != 0) && (iir->len > 3)) || ((fir != 0) && (fir->len > 3)))
+    {
+      error_str = "Filter can not be converted to second order sections";
+      return false;
+    }
+
+    Section sec = { 1.0, 0.0, 0.0, 0.0, 0.0 };
+    if (iir != 0)
+    {
+      const double adj = 1.0 / iir->val[0];
+      tot_gain *= adj;
+      sec.a1 = (iir->len > 1) ? iir->val[1] * adj : 0.0;
+      sec.a2 = (iir->len > 2) ? iir->val[2] * adj : 0.0;
+    }
+    if (fir != 0)
+    {
+      sec.b0 = fir->val[0];
+      sec.b1 = (fir->len > 1) ? fir->val[1] : 0.0;
+      sec.b2 = (fir->len > 2) ? fir->val[2] : 0.0;
+    }
+    new_sections.push_back(sec);
+  }
+
+  for (size_t i=0; i<new_sections.size(); ++i)
+  {
+    addSection(new_sections[i]);
+  }
+  gain = tot_gain;
+
+  return true;
+} /* AudioBiquadCascade::setFidFilter */
+
+
+void AudioBiquadCascade::clear(void)
+{
+  sections.clear();
+  state.clear();
+  gain = 1.0;
+} /* AudioBiquadCascade::clear */
+
+
+void AudioBiquadCascade::addSection(const Section& section)
+{
+  sections.push_back(section);
+  state.resize(2 * sections.size() * laneCount(), 0.0);
+} /* AudioBiquadCascade::addSection */
+
+
+void AudioBiquadCascade::reset(void)
+{
+  fill(state.begin(), state.end(), 0.0);
+} /* AudioBiquadCascade::reset */
+
+
+void AudioBiquadCascade::process(float *dest, const float *src, int count)
+{
+  if (work.size() < static_cast<size_t>(count))
+  {
+    work.resize(count);
+  }
+
+  for (int i=0; i<count; ++i)
+  {
+    work[i] = src[i];
+  }
+  runCascade<double>(sections, &state[0], laneCount(), 0, &work[0], count);
+  for (int i=0; i<count; ++i)
+  {
+    dest[i] = gain * work[i];
+  }
+} /* AudioBiquadCascade::process */
+
+
+void AudioBiquadCascade::processChannels(float *const *dest,
+                                         const float *const *src, int count)
+{
+  const size_t lanes = laneCount();
+
+#ifdef BIQUAD_VECTOR_EXT
+  if (work.size() < count * VEC_LEN)
+  {
+    work.resize(count * VEC_LEN);
+  }
+  for (size_t first=0; first<channels; first+=VEC_LEN)
+  {
+    runChannelGroup(sections, &state[0], lanes, first,
+                    min(VEC_LEN, channels - first), gain, dest, src,
+                    &work[0], count);
+  }
+#else
+  if (work.size() < static_cast<size_t>(count))
+  {
+    work.resize(count);
+  }
+  for (size_t ch=0; ch<channels; ++ch)
+  {
+    for (int i=0; i<count; ++i)
+    {
+      work[i] = src[ch][i];
+    }
+    runCascade<double>(sections, &state[0], lanes, ch, &work[0], count);
+    for (int i=0; i<count; ++i)
+    {
+      dest[ch][i] = gain * work[i];
+    }
+  }
+#endif
+} /* AudioBiquadCascade::processChannels */
+
+
+
+/****************************************************************************
+ *
+ * Protected member functions
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Private member functions
+ *
+ ****************************************************************************/
+
+size_t AudioBiquadCascade::laneCount(void) const
+{
+  return (channels + VEC_LEN - 1) / VEC_LEN * VEC_LEN;
+} /* AudioBiquadCascade::laneCount */
+
+
+
+/*
+ * This file has not been truncated
+ */
+
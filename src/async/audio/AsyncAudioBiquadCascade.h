@@ -0,0 +1,267 @@
+/**
+@file	 AsyncAudioBiquadCascade.h
+@brief   A compiled cascade of second order IIR filter sections
+@author  Tobias Blomberg / SM0SVX
+@date	 2026-10-14
+
+\verbatim
+Async - A library for programming event driven applications
+Copyright (C) 2003-2026 Tobias Blomberg / SM0SVX
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+\endverbatim
+*/
+
+#ifndef ASYNC_AUDIO_BIQUAD_CASCADE_INCLUDED
+#define ASYNC_AUDIO_BIQUAD_CASCADE_INCLUDED
+
+
+/****************************************************************************
+ *
+ * System Includes
+ *
+ ****************************************************************************/
+
+#include <string>
+#include <vector>
+
+
+/****************************************************************************
+ *
+ * Project Includes
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Local Includes
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Forward declarations
+ *
+ ****************************************************************************/
+
+struct FidFilter;
+
+
+/****************************************************************************
+ *
+ * Namespace
+ *
+ ****************************************************************************/
+
+namespace Async
+{
+
+
+/****************************************************************************
+ *
+ * Forward declarations of classes inside of the declared namespace
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Defines & typedefs
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Exported Global Variables
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Class definitions
+ *
+ ****************************************************************************/
+
+/**
+@brief	A compiled cascade of second order IIR filter sections
+@author Tobias Blomberg / SM0SVX
+@date   2026-10-14
+
+This class implements an IIR filter as a cascade of second order sections
+(biquads). The filter can be created from the same filter specification
+strings that Async::AudioFilter use. The fidlib design is then converted to
+biquad sections which are executed by compiled code, one section at a time
+for a whole block of samples. That is much faster than letting fidlib
+interpret its command list for each sample. All calculations are done using
+double precision, just like fidlib do, so the output is the same.
+
+Not all fidlib designs can be converted. Filters given as raw coefficient
+lists with more than three coefficients in one element will make
+setFidFilter or parseFilterSpec return \em false. Async::AudioFilter then
+fall back to use the fidlib interpreter.
+
+The cascade may also be set up to filter a number of channels with the same
+filter. The channels are then processed in parallel using SIMD instructions,
+which is useful when a lot of receivers need the same filtering.
+*/
+class AudioBiquadCascade
+{
+  public:
+    /**
+     * @brief The coefficients for one second order section
+     *
+     * The transfer function is
+     * H(z) = (b0 + b1*z^-1 + b2*z^-2) / (1 + a1*z^-1 + a2*z^-2)
+     */
+    struct Section
+    {
+      double b0;
+      double b1;
+      double b2;
+      double a1;
+      double a2;
+    };
+
+    /**
+     * @brief 	Constuctor
+     * @param 	channels The number of channels to filter
+     */
+    explicit AudioBiquadCascade(size_t channels=1);
+
+    /**
+     * @brief 	Destructor
+     */
+    ~AudioBiquadCascade(void);
+
+    /**
+     * @brief   Create the filter from the given filter specification
+     * @param 	filter_spec The filter specification, as for AudioFilter
+     * @param 	sample_rate The sampling rate
+     * @return  Returns \em true on success or else \em false
+     */
+    bool parseFilterSpec(const std::string &filter_spec,
+                         int sample_rate=INTERNAL_SAMPLE_RATE);
+
+    /**
+     * @brief   Create the filter from a fidlib filter design
+     * @param 	ff The fidlib filter
+     * @return  Returns \em true on success or \em false if the filter could
+     *          not be converted to biquad sections
+     */
+    bool setFidFilter(const FidFilter *ff);
+
+    /**
+     * @brief   Get the latest filter creation error
+     * @return  Returns an error string if an error has occured previously
+     */
+    const std::string& errorString(void) const { return error_str; }
+
+    /**
+     * @brief 	Remove all sections and reset the gain to one
+     */
+    void clear(void);
+
+    /**
+     * @brief 	Add a section to the end of the cascade
+     * @param 	section The coefficients for the new section
+     */
+    void addSection(const Section& section);
+
+    /**
+     * @brief 	Get the number of sections in the cascade
+     * @return	Returns the number of sections
+     */
+    size_t sectionCount(void) const { return sections.size(); }
+
+    /**
+     * @brief 	Get the number of channels
+     * @return	Returns the number of channels given to the constructor
+     */
+    size_t channelCount(void) const { return channels; }
+
+    /**
+     * @brief 	Set the gain applied to the output of the cascade
+     * @param 	gain The gain as a linear factor
+     */
+    void setGain(double gain) { this->gain = gain; }
+
+    /**
+     * @brief 	Get the gain applied to the output of the cascade
+     * @return	Returns the gain as a linear factor
+     */
+    double getGain(void) const { return gain; }
+
+    /**
+     * @brief Reset the filter state for all channels
+     */
+    void reset(void);
+
+    /**
+     * @brief 	Filter a block of samples for the first channel
+     * @param 	dest  The buffer to store the filtered samples in
+     * @param 	src   The samples to filter
+     * @param 	count The number of samples
+     *
+     * The source and destination buffers may be the same.
+     */
+    void process(float *dest, const float *src, int count);
+
+    /**
+     * @brief 	Filter a block of samples for all channels
+     * @param 	dest  One destination buffer per channel
+     * @param 	src   One source buffer per channel
+     * @param 	count The number of samples in each buffer
+     *
+     * The channels are processed in parallel using SIMD instructions, if
+     * supported by the compiler.
+     */
+    void processChannels(float *const *dest, const float *const *src,
+                         int count);
+
+
+  private:
+    size_t                channels;
+    std::vector<Section>  sections;
+    std::vector<double>   state;
+    std::vector<double>   work;
+    double                gain;
+    std::string           error_str;
+
+    AudioBiquadCascade(const AudioBiquadCascade&);
+    AudioBiquadCascade& operator=(const AudioBiquadCascade&);
+    size_t laneCount(void) const;
+
+};  /* class AudioBiquadCascade */
+
+
+} /* namespace */
+
+#endif /* ASYNC_AUDIO_BIQUAD_CASCADE_INCLUDED */
+
+
+
+/*
+ * This file has not been truncated
+ */
+
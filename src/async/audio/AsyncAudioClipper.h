@@ -34,6 +34,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
  *
  ****************************************************************************/
 
+#include <algorithm>
 
 
 /****************************************************************************
@@ -134,20 +135,12 @@ class AudioClipper : public AudioProcessor
   protected:
     virtual void processSamples(float *dest, const float *src, int count)
     {
+        // Using min/max instead of branches make it possible for the
+        // compiler to vectorize the loop
+      const float level = clip_level;
       for (int i=0; i<count; ++i)
       {
-      	if (src[i] > clip_level)
-	{
-	  dest[i] = clip_level;
-	}
-	else if (src[i] < -clip_level)
-	{
-	  dest[i] = -clip_level;
-	}
-	else
-	{
-	  dest[i] = src[i];
-	}
+        dest[i] = std::min(level, std::max(-level, src[i]));
       }
     }
     
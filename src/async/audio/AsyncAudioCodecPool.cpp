@@ -0,0 +1,238 @@
+/**
+@file	 AsyncAudioCodecPool.cpp
+@brief   A pool of audio encoders and decoders that are reused
+@author  Tobias Blomberg / SM0SVX
+@date	 2026-10-14
+
+\verbatim
+Async - A library for programming event driven applications
+Copyright (C) 2003-2026 Tobias Blomberg / SM0SVX
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+\endverbatim
+*/
+
+
+
+/****************************************************************************
+ *
+ * System Includes
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Project Includes
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Local Includes
+ *
+ ****************************************************************************/
+
+#include "AsyncAudioEncoder.h"
+#include "AsyncAudioDecoder.h"
+#include "AsyncAudioCodecPool.h"
+
+
+
+/****************************************************************************
+ *
+ * Namespaces to use
+ *
+ ****************************************************************************/
+
+using namespace std;
+using namespace Async;
+
+
+
+/****************************************************************************
+ *
+ * Defines & typedefs
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Local class definitions
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Prototypes
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Exported Global Variables
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Local Global Variables
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Public member functions
+ *
+ ****************************************************************************/
+
+AudioCodecPool::~AudioCodecPool(void)
+{
+  setMaxIdle(0);
+} /* AudioCodecPool::~AudioCodecPool */
+
+
+AudioEncoder *AudioCodecPool::createEncoder(const std::string &name)
+{
+  EncoderMap::iterator it = m_idle_enc.find(name);
+  if ((it != m_idle_enc.end()) && !it->second.empty())
+  {
+    AudioEncoder *enc = it->second.back();
+    it->second.pop_back();
+    ++m_reuse_cnt;
+    return enc;
+  }
+  return AudioEncoder::create(name);
+} /* AudioCodecPool::createEncoder */
+
+
+AudioDecoder *AudioCodecPool::createDecoder(const std::string &name)
+{
+  DecoderMap::iterator it = m_idle_dec.find(name);
+  if ((it != m_idle_dec.end()) && !it->second.empty())
+  {
+    AudioDecoder *dec = it->second.back();
+    it->second.pop_back();
+    ++m_reuse_cnt;
+    return dec;
+  }
+  return AudioDecoder::create(name);
+} /* AudioCodecPool::createDecoder */
+
+
+void AudioCodecPool::release(AudioEncoder *enc)
+{
+  if (enc == 0)
+  {
+    return;
+  }
+
+  enc->unregisterSource();
+  enc->writeEncodedSamples.clear();
+  enc->flushEncodedSamples.clear();
+  enc->setPassthrough(false);
+
+  std::vector<AudioEncoder*>& idle = m_idle_enc[enc->name()];
+  if ((idle.size() >= m_max_idle) || !enc->reset())
+  {
+    delete enc;
+    return;
+  }
+  idle.push_back(enc);
+} /* AudioCodecPool::release */
+
+
+void AudioCodecPool::release(AudioDecoder *dec)
+{
+  if (dec == 0)
+  {
+    return;
+  }
+
+  dec->unregisterSink();
+  dec->allEncodedSamplesFlushed.clear();
+
+  std::vector<AudioDecoder*>& idle = m_idle_dec[dec->name()];
+  if ((idle.size() >= m_max_idle) || !dec->reset())
+  {
+    delete dec;
+    return;
+  }
+  idle.push_back(dec);
+} /* AudioCodecPool::release */
+
+
+void AudioCodecPool::setMaxIdle(unsigned max_idle)
+{
+  m_max_idle = max_idle;
+  for (EncoderMap::iterator it = m_idle_enc.begin(); it != m_idle_enc.end();
+       ++it)
+  {
+    while (it->second.size() > m_max_idle)
+    {
+      delete it->second.back();
+      it->second.pop_back();
+    }
+  }
+  for (DecoderMap::iterator it = m_idle_dec.begin(); it != m_idle_dec.end();
+       ++it)
+  {
+    while (it->second.size() > m_max_idle)
+    {
+      delete it->second.back();
+      it->second.pop_back();
+    }
+  }
+} /* AudioCodecPool::setMaxIdle */
+
+
+
+/****************************************************************************
+ *
+ * Protected member functions
+ *
+ ****************************************************************************/
+
+AudioCodecPool::AudioCodecPool(void)
+  : m_max_idle(DEFAULT_MAX_IDLE), m_reuse_cnt(0)
+{
+} /* AudioCodecPool::AudioCodecPool */
+
+
+
+/****************************************************************************
+ *
+ * Private member functions
+ *
+ ****************************************************************************/
+
+
+
+/*
+ * This file has not been truncated
+ */
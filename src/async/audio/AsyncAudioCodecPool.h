@@ -0,0 +1,241 @@
+/**
+@file	 AsyncAudioCodecPool.h
+@brief   A pool of audio encoders and decoders that are reused
+@author  Tobias Blomberg / SM0SVX
+@date	 2026-10-14
+
+\verbatim
+Async - A library for programming event driven applications
+Copyright (C) 2003-2026 Tobias Blomberg / SM0SVX
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+\endverbatim
+*/
+
+#ifndef ASYNC_AUDIO_CODEC_POOL_INCLUDED
+#define ASYNC_AUDIO_CODEC_POOL_INCLUDED
+
+
+/****************************************************************************
+ *
+ * System Includes
+ *
+ ****************************************************************************/
+
+#include <string>
+#include <vector>
+#include <map>
+
+
+/****************************************************************************
+ *
+ * Project Includes
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Local Includes
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Forward declarations
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Namespace
+ *
+ ****************************************************************************/
+
+namespace Async
+{
+
+
+/****************************************************************************
+ *
+ * Forward declarations of classes inside of the declared namespace
+ *
+ ****************************************************************************/
+
+class AudioEncoder;
+class AudioDecoder;
+
+
+/****************************************************************************
+ *
+ * Defines & typedefs
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Exported Global Variables
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Class definitions
+ *
+ ****************************************************************************/
+
+/**
+@brief	A pool of audio encoders and decoders that are reused
+@author Tobias Blomberg / SM0SVX
+@date   2026-10-14
+
+Creating a codec, like Opus, allocate and initialize a fair amount of state.
+That is done exactly when a new audio stream is about to start, e.g. when
+connecting to a server. This class keep released codec objects around so
+that they can be reset and reused instead of being created again.
+
+Encoders and decoders are obtained using createEncoder and createDecoder,
+which are used just like AudioEncoder::create and AudioDecoder::create. When
+not needed anymore, the codec object is handed back using release instead of
+deleting it. All signal connections are then removed and the codec object is
+reset to the state of a newly created one. Codecs not supporting reset, see
+AudioEncoder::reset and AudioDecoder::reset, are deleted when released.
+
+The pool is a singleton that is shared by all users in the process. It must
+only be used from the main thread.
+*/
+class AudioCodecPool
+{
+  public:
+    /**
+     * @brief The default maximum number of idle objects per codec type
+     */
+    static const unsigned DEFAULT_MAX_IDLE = 4;
+
+    /**
+     * @brief 	Get the pool singleton instance
+     * @return  Returns the pool instance
+     */
+    static AudioCodecPool &instance(void)
+    {
+      static AudioCodecPool the_pool;
+      return the_pool;
+    }
+
+    /**
+     * @brief 	Destructor
+     */
+    ~AudioCodecPool(void);
+
+    /**
+     * @brief   Get an encoder of the specified type
+     * @param   name The name of the encoder
+     * @return  Returns an encoder or 0 if the codec is not available
+     *
+     * An idle encoder of the given type is returned if there is one.
+     * Otherwise a new one is created.
+     */
+    AudioEncoder *createEncoder(const std::string &name);
+
+    /**
+     * @brief   Get a decoder of the specified type
+     * @param   name The name of the decoder
+     * @return  Returns a decoder or 0 if the codec is not available
+     *
+     * An idle decoder of the given type is returned if there is one.
+     * Otherwise a new one is created.
+     */
+    AudioDecoder *createDecoder(const std::string &name);
+
+    /**
+     * @brief   Hand an encoder back to the pool
+     * @param   enc The encoder to release (may be 0)
+     *
+     * The encoder is disconnected from its audio source and signals and is
+     * then either kept for reuse or deleted. The caller must not use the
+     * encoder after calling this function.
+     */
+    void release(AudioEncoder *enc);
+
+    /**
+     * @brief   Hand a decoder back to the pool
+     * @param   dec The decoder to release (may be 0)
+     *
+     * The decoder is disconnected from its audio sink and signals and is
+     * then either kept for reuse or deleted. The caller must not use the
+     * decoder after calling this function.
+     */
+    void release(AudioDecoder *dec);
+
+    /**
+     * @brief   Set the maximum number of idle objects per codec type
+     * @param   max_idle The maximum number of idle encoders or decoders
+     *
+     * Released codec objects over this limit are deleted. Setting the limit
+     * to 0 disable the pool.
+     */
+    void setMaxIdle(unsigned max_idle);
+
+    /**
+     * @brief   Get the maximum number of idle objects per codec type
+     * @return  Returns the maximum number of idle encoders or decoders
+     */
+    unsigned maxIdle(void) const { return m_max_idle; }
+
+    /**
+     * @brief   Get the number of codec objects that have been reused
+     * @return  Returns the number of times a released codec was reused
+     */
+    unsigned long reuseCount(void) const { return m_reuse_cnt; }
+
+  protected:
+    /**
+     * @brief   Default constuctor
+     */
+    AudioCodecPool(void);
+
+  private:
+    typedef std::map<std::string, std::vector<AudioEncoder*> > EncoderMap;
+    typedef std::map<std::string, std::vector<AudioDecoder*> > DecoderMap;
+
+    EncoderMap      m_idle_enc;
+    DecoderMap      m_idle_dec;
+    unsigned        m_max_idle;
+    unsigned long   m_reuse_cnt;
+
+    AudioCodecPool(const AudioCodecPool&);
+    AudioCodecPool& operator=(const AudioCodecPool&);
+
+};  /* class AudioCodecPool */
+
+
+} /* namespace */
+
+#endif /* ASYNC_AUDIO_CODEC_POOL_INCLUDED */
+
+
+
+/*
+ * This file has not been truncated
+ */
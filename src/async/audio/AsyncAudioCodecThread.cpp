@@ -0,0 +1,494 @@
+/**
+@file	 AsyncAudioCodecThread.cpp
+@brief   Run audio encoders and decoders in a thread of their own
+@author  Tobias Blomberg / SM0SVX
+@date	 2026-10-14
+
+\verbatim
+Async - A library for programming event driven applications
+Copyright (C) 2003-2026 Tobias Blomberg / SM0SVX
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+\endverbatim
+*/
+
+
+
+/****************************************************************************
+ *
+ * System Includes
+ *
+ ****************************************************************************/
+
+#include <vector>
+#include <cstdint>
+#include <cassert>
+
+
+/****************************************************************************
+ *
+ * Project Includes
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Local Includes
+ *
+ ****************************************************************************/
+
+#include "AsyncAudioCodecThread.h"
+#include "AsyncAudioStats.h"
+
+
+
+/****************************************************************************
+ *
+ * Namespaces to use
+ *
+ ****************************************************************************/
+
+using namespace std;
+using namespace Async;
+
+
+
+/****************************************************************************
+ *
+ * Defines & typedefs
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Local class definitions
+ *
+ ****************************************************************************/
+
+  // The output from one encoder job, handed back to the main thread
+struct AudioEncoderThreaded::Output
+{
+  vector<vector<uint8_t>> frames;
+  bool                    flush = false;
+};
+
+
+  // The part of a threaded encoder that is used by the codec thread. It is
+  // reference counted so that a job in progress can finish safely even if
+  // the encoder is deleted.
+struct AudioEncoderThreaded::State
+{
+  unique_ptr<AudioEncoder>  enc;
+  Output                    out;
+
+  explicit State(AudioEncoder *enc) : enc(enc)
+  {
+    this->enc->writeEncodedSamples.connect(
+        [this](const void *buf, int size)
+        {
+          const uint8_t *p = static_cast<const uint8_t*>(buf);
+          out.frames.emplace_back(p, p + size);
+        });
+    this->enc->flushEncodedSamples.connect([this](void) { out.flush = true; });
+  }
+
+  Output takeOutput(void)
+  {
+    Output ret;
+    swap(ret, out);
+    return ret;
+  }
+};
+
+
+  // The output from one decoder job, handed back to the main thread
+struct AudioDecoderThreaded::Output
+{
+  vector<float> samples;
+  bool          flush = false;
+};
+
+
+  // The part of a threaded decoder that is used by the codec thread
+struct AudioDecoderThreaded::State
+{
+  class Collector : public AudioSink
+  {
+    public:
+      Output out;
+
+      int writeSamples(const float *samples, int count) override
+      {
+        out.samples.insert(out.samples.end(), samples, samples + count);
+        return count;
+      }
+
+      void flushSamples(void) override
+      {
+        out.flush = true;
+        sourceAllSamplesFlushed();
+      }
+  };
+
+  Collector                 collector;
+  unique_ptr<AudioDecoder>  dec;
+
+  explicit State(AudioDecoder *dec) : dec(dec)
+  {
+    this->dec->registerSink(&collector);
+  }
+
+  Output takeOutput(void)
+  {
+    Output ret;
+    swap(ret, collector.out);
+    return ret;
+  }
+};
+
+
+
+/****************************************************************************
+ *
+ * Prototypes
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Exported Global Variables
+ *
+ ****************************************************************************/
+
+
+
+
+/****************************************************************************
+ *
+ * Local Global Variables
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Public member functions
+ *
+ ****************************************************************************/
+
+AudioCodecThread::AudioCodecThread(unsigned max_latency)
+  : pool(1, "codec"), max_latency(max_latency)
+{
+} /* AudioCodecThread::AudioCodecThread */
+
+
+AudioCodecThread::~AudioCodecThread(void)
+{
+} /* AudioCodecThread::~AudioCodecThread */
+
+
+AudioEncoderThreaded::AudioEncoderThreaded(AudioCodecThread& thread,
+                                           AudioEncoder *enc)
+  : thread(thread), state(make_shared<State>(enc)), codec_name(enc->name()),
+    pending_samples(0), dropped_samples(0), m_stats(0)
+{
+} /* AudioEncoderThreaded::AudioEncoderThreaded */
+
+
+AudioEncoderThreaded::~AudioEncoderThreaded(void)
+{
+  for (auto id : jobs)
+  {
+    thread.pool.cancel(id);
+  }
+} /* AudioEncoderThreaded::~AudioEncoderThreaded */
+
+
+void AudioEncoderThreaded::setOption(const std::string &name,
+                                     const std::string &value)
+{
+  shared_ptr<State> st(state);
+  thread.pool.run(
+      [st, name, value](void) { st->enc->setOption(name, value); });
+} /* AudioEncoderThreaded::setOption */
+
+
+void AudioEncoderThreaded::printCodecParams(void)
+{
+  shared_ptr<State> st(state);
+  thread.pool.run([st](void) { st->enc->printCodecParams(); });
+} /* AudioEncoderThreaded::printCodecParams */
+
+
+int AudioEncoderThreaded::writeSamples(const float *samples, int count)
+{
+  if (count <= 0)
+  {
+    return 0;
+  }
+
+    // Drop the samples if the codec thread is too far behind
+  const size_t max_pending = thread.maxLatencySamples();
+  if ((max_pending > 0) && (pending_samples + count > max_pending))
+  {
+    dropped_samples += count;
+    if (m_stats != 0)
+    {
+      m_stats->inc(AudioStats::ENCODER_DROPS);
+    }
+    return count;
+  }
+
+  shared_ptr<State> st(state);
+  vector<float> buf(samples, samples + count);
+  WorkerPool::JobId id = thread.pool.call(
+      [st, buf](void)
+      {
+        st->enc->writeSamples(&buf[0], buf.size());
+        return st->takeOutput();
+      },
+      [this, count](Output out) { jobDone(count, out); });
+  if (id == WorkerPool::INVALID_JOB)
+  {
+    dropped_samples += count;
+    if (m_stats != 0)
+    {
+      m_stats->inc(AudioStats::ENCODER_DROPS);
+    }
+    return count;
+  }
+  jobs.push_back(id);
+  pending_samples += count;
+  return count;
+} /* AudioEncoderThreaded::writeSamples */
+
+
+void AudioEncoderThreaded::flushSamples(void)
+{
+  shared_ptr<State> st(state);
+  WorkerPool::JobId id = thread.pool.call(
+      [st](void)
+      {
+        st->enc->flushSamples();
+        return st->takeOutput();
+      },
+      [this](Output out) { jobDone(0, out); });
+  if (id == WorkerPool::INVALID_JOB)
+  {
+    flushEncodedSamples();
+    return;
+  }
+  jobs.push_back(id);
+} /* AudioEncoderThreaded::flushSamples */
+
+
+AudioDecoderThreaded::AudioDecoderThreaded(AudioCodecThread& thread,
+                                           AudioDecoder *dec)
+  : thread(thread), state(make_shared<State>(dec)), codec_name(dec->name()),
+    pending_frames(0), frame_samples(INTERNAL_SAMPLE_RATE / 50),
+    lost_frames(0), dropped_frames(0), m_stats(0)
+{
+} /* AudioDecoderThreaded::AudioDecoderThreaded */
+
+
+AudioDecoderThreaded::~AudioDecoderThreaded(void)
+{
+  for (auto id : jobs)
+  {
+    thread.pool.cancel(id);
+  }
+} /* AudioDecoderThreaded::~AudioDecoderThreaded */
+
+
+void AudioDecoderThreaded::setOption(const std::string &name,
+                                     const std::string &value)
+{
+  shared_ptr<State> st(state);
+  thread.pool.run(
+      [st, name, value](void) { st->dec->setOption(name, value); });
+} /* AudioDecoderThreaded::setOption */
+
+
+void AudioDecoderThreaded::printCodecParams(void) const
+{
+  shared_ptr<State> st(state);
+  thread.pool.run([st](void) { st->dec->printCodecParams(); });
+} /* AudioDecoderThreaded::printCodecParams */
+
+
+void AudioDecoderThreaded::writeEncodedSamples(void *buf, int size)
+{
+  queueFrame(buf, size, false);
+} /* AudioDecoderThreaded::writeEncodedSamples */
+
+
+void AudioDecoderThreaded::skipEncodedSamples(void *buf, int size)
+{
+  queueFrame(buf, size, true);
+} /* AudioDecoderThreaded::skipEncodedSamples */
+
+
+void AudioDecoderThreaded::encodedFramesLost(unsigned count,
+                                             const void *next_buf,
+                                             int next_size)
+{
+  lost_frames += count;
+} /* AudioDecoderThreaded::encodedFramesLost */
+
+
+void AudioDecoderThreaded::flushEncodedSamples(void)
+{
+  lost_frames = 0;
+  shared_ptr<State> st(state);
+  WorkerPool::JobId id = thread.pool.call(
+      [st](void)
+      {
+        st->dec->flushEncodedSamples();
+        return st->takeOutput();
+      },
+      [this](Output out) { jobDone(0, out); });
+  if (id == WorkerPool::INVALID_JOB)
+  {
+    sinkFlushSamples();
+    return;
+  }
+  jobs.push_back(id);
+} /* AudioDecoderThreaded::flushEncodedSamples */
+
+
+
+/****************************************************************************
+ *
+ * Protected member functions
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Private member functions
+ *
+ ****************************************************************************/
+
+size_t AudioCodecThread::maxLatencySamples(void) const
+{
+  return static_cast<size_t>(max_latency) * INTERNAL_SAMPLE_RATE / 1000;
+} /* AudioCodecThread::maxLatencySamples */
+
+
+void AudioEncoderThreaded::jobDone(size_t count, Output& out)
+{
+  assert(!jobs.empty());
+  jobs.pop_front();
+  pending_samples -= count;
+  for (const auto& frame : out.frames)
+  {
+    writeEncodedSamples(frame.data(), frame.size());
+  }
+  if (out.flush)
+  {
+    flushEncodedSamples();
+  }
+} /* AudioEncoderThreaded::jobDone */
+
+
+void AudioDecoderThreaded::jobDone(size_t frames, Output& out)
+{
+  assert(!jobs.empty());
+  jobs.pop_front();
+  assert(pending_frames >= frames);
+  pending_frames -= frames;
+  if (!out.samples.empty())
+  {
+    if (frames > 0)
+    {
+      frame_samples = out.samples.size() / frames;
+    }
+    sinkWriteSamples(&out.samples[0], out.samples.size());
+  }
+  if (out.flush)
+  {
+    sinkFlushSamples();
+  }
+} /* AudioDecoderThreaded::jobDone */
+
+
+void AudioDecoderThreaded::queueFrame(void *buf, int size, bool skip)
+{
+    // Drop the frame, and let the decoder conceal the loss later, if the
+    // codec thread is too far behind
+  const size_t max_pending = thread.maxLatencySamples();
+  if ((max_pending > 0) &&
+      ((pending_frames + 1) * frame_samples > max_pending))
+  {
+    lost_frames += 1;
+    dropped_frames += 1;
+    if (m_stats != 0)
+    {
+      m_stats->inc(AudioStats::DECODER_DROPS);
+    }
+    return;
+  }
+
+  shared_ptr<State> st(state);
+  const uint8_t *p = static_cast<const uint8_t*>(buf);
+  vector<uint8_t> frame(p, p + size);
+    // There is no point in concealing lost frames that are skipped
+  const unsigned lost = skip ? 0 : lost_frames;
+  WorkerPool::JobId id = thread.pool.call(
+      [st, frame, lost, skip](void)
+      {
+        void *fbuf = const_cast<uint8_t*>(frame.data());
+        if (skip)
+        {
+          st->dec->skipEncodedSamples(fbuf, frame.size());
+          return st->takeOutput();
+        }
+        if (lost > 0)
+        {
+          st->dec->encodedFramesLost(lost, fbuf, frame.size());
+        }
+        st->dec->writeEncodedSamples(fbuf, frame.size());
+        return st->takeOutput();
+      },
+      [this](Output out) { jobDone(1, out); });
+  if (id == WorkerPool::INVALID_JOB)
+  {
+    lost_frames += 1;
+    dropped_frames += 1;
+    if (m_stats != 0)
+    {
+      m_stats->inc(AudioStats::DECODER_DROPS);
+    }
+    return;
+  }
+  lost_frames = 0;
+  jobs.push_back(id);
+  pending_frames += 1;
+} /* AudioDecoderThreaded::queueFrame */
+
+
+
+/*
+ * This file has not been truncated
+ */
@@ -0,0 +1,403 @@
+/**
+@file	 AsyncAudioCodecThread.h
+@brief   Run audio encoders and decoders in a thread of their own
+@author  Tobias Blomberg / SM0SVX
+@date	 2026-10-14
+
+\verbatim
+Async - A library for programming event driven applications
+Copyright (C) 2003-2026 Tobias Blomberg / SM0SVX
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+\endverbatim
+*/
+
+#ifndef ASYNC_AUDIO_CODEC_THREAD_INCLUDED
+#define ASYNC_AUDIO_CODEC_THREAD_INCLUDED
+
+
+/****************************************************************************
+ *
+ * System Includes
+ *
+ ****************************************************************************/
+
+#include <sigc++/sigc++.h>
+
+#include <memory>
+#include <vector>
+
+
+/****************************************************************************
+ *
+ * Project Includes
+ *
+ ****************************************************************************/
+
+#include <AsyncWorkerPool.h>
+#include <AsyncAudioEncoder.h>
+#include <AsyncAudioDecoder.h>
+
+
+/****************************************************************************
+ *
+ * Local Includes
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Forward declarations
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Namespace
+ *
+ ****************************************************************************/
+
+namespace Async
+{
+
+
+/****************************************************************************
+ *
+ * Forward declarations of classes inside of the declared namespace
+ *
+ ****************************************************************************/
+
+class AudioProcessor;
+class AudioStats;
+
+
+/****************************************************************************
+ *
+ * Defines & typedefs
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Exported Global Variables
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Class definitions
+ *
+ ****************************************************************************/
+
+/**
+@brief	A thread used to run audio encoders and decoders
+@author Tobias Blomberg / SM0SVX
+@date   2026-10-14
+
+This class is used together with Async::AudioEncoderThreaded and
+Async::AudioDecoderThreaded to move the encoding and decoding of audio out of
+the main thread. Heavy codecs, like Opus at high complexity, may otherwise
+take a big part of the time available for each block of audio on small
+systems. All codecs using the same codec thread are run in that thread, one
+at a time, in the order the work was queued.
+
+The maximum latency is the amount of audio, measured in milliseconds, that
+each codec may have queued up in the thread. If the thread cannot keep up,
+audio is dropped instead of letting the delay grow without bounds. Dropped
+encoded frames are reported to the decoder as lost so that it can conceal
+the loss.
+*/
+class AudioCodecThread
+{
+  public:
+    /**
+     * @brief The default maximum latency in milliseconds
+     */
+    static const unsigned DEFAULT_MAX_LATENCY = 100;
+
+    /**
+     * @brief   Constructor
+     * @param   max_latency The maximum latency in milliseconds, 0=unlimited
+     */
+    explicit AudioCodecThread(unsigned max_latency=DEFAULT_MAX_LATENCY);
+
+    /**
+     * @brief   Destructor
+     *
+     * All codecs using this thread must be deleted before the thread.
+     */
+    ~AudioCodecThread(void);
+
+    /**
+     * @brief   Check if the initialization was ok
+     * @return  Returns \em true if the thread was started
+     */
+    bool initOk(void) const { return pool.initOk(); }
+
+    /**
+     * @brief   Set the maximum latency
+     * @param   max_latency The maximum latency in milliseconds, 0=unlimited
+     */
+    void setMaxLatency(unsigned max_latency)
+    {
+      this->max_latency = max_latency;
+    }
+
+    /**
+     * @brief   Get the maximum latency
+     * @return  Returns the maximum latency in milliseconds
+     */
+    unsigned maxLatency(void) const { return max_latency; }
+
+  private:
+    friend class AudioEncoderThreaded;
+    friend class AudioDecoderThreaded;
+
+    WorkerPool  pool;
+    unsigned    max_latency;
+
+    AudioCodecThread(const AudioCodecThread&);
+    AudioCodecThread& operator=(const AudioCodecThread&);
+    size_t maxLatencySamples(void) const;
+
+};  /* class AudioCodecThread */
+
+
+/**
+@brief	An audio encoder that run another encoder in a codec thread
+@author Tobias Blomberg / SM0SVX
+@date   2026-10-14
+
+This class wrap an audio encoder so that the encoding is done in an
+Async::AudioCodecThread. It is used just like the wrapped encoder. The
+encoded frames are emitted from the main thread, in order, a short while
+after the samples were written. The wrapped encoder must not be used
+directly after it has been given to this object.
+*/
+class AudioEncoderThreaded : public AudioEncoder
+{
+  public:
+    /**
+     * @brief 	Constuctor
+     * @param 	thread  The codec thread to run the encoder in
+     * @param 	enc     The encoder to wrap, owned by this object
+     */
+    AudioEncoderThreaded(AudioCodecThread& thread, AudioEncoder *enc);
+
+    /**
+     * @brief 	Destructor
+     */
+    ~AudioEncoderThreaded(void);
+
+    /**
+     * @brief   Get the name of the codec
+     * @returns Return the name of the wrapped codec
+     */
+    const char *name(void) const override { return codec_name.c_str(); }
+
+    /**
+     * @brief 	Set an option for the wrapped encoder
+     * @param 	name The name of the option
+     * @param 	value The value of the option
+     */
+    void setOption(const std::string &name,
+                   const std::string &value) override;
+
+    /**
+     * @brief Print codec parameter settings
+     */
+    void printCodecParams(void) override;
+
+    /**
+     * @brief 	Write samples into this audio sink
+     * @param 	samples The buffer containing the samples
+     * @param 	count The number of samples in the buffer
+     * @return	Returns the number of samples that has been taken care of
+     */
+    int writeSamples(const float *samples, int count) override;
+
+    /**
+     * @brief 	Tell the sink to flush the previously written samples
+     */
+    void flushSamples(void) override;
+
+    /**
+     * @brief   Get the number of samples dropped due to the latency limit
+     * @return  Returns the number of dropped samples
+     */
+    unsigned long droppedSamples(void) const { return dropped_samples; }
+
+    /**
+     * @brief   Set the object to report audio health statistics to
+     * @param   stats The statistics object or 0 to disable reporting
+     *
+     * An encoder drop is reported each time a block of samples is dropped
+     * because the encoder backlog exceeded the maximum latency.
+     */
+    void setStats(AudioStats *stats) { m_stats = stats; }
+
+  private:
+    struct State;
+    struct Output;
+
+    AudioCodecThread&               thread;
+    std::shared_ptr<State>          state;
+    std::string                     codec_name;
+    std::deque<WorkerPool::JobId>   jobs;
+    size_t                          pending_samples;
+    unsigned long                   dropped_samples;
+    AudioStats*                     m_stats;
+
+    AudioEncoderThreaded(const AudioEncoderThreaded&);
+    AudioEncoderThreaded& operator=(const AudioEncoderThreaded&);
+    void jobDone(size_t count, Output& out);
+
+};  /* class AudioEncoderThreaded */
+
+
+/**
+@brief	An audio decoder that run another decoder in a codec thread
+@author Tobias Blomberg / SM0SVX
+@date   2026-10-14
+
+This class wrap an audio decoder so that the decoding is done in an
+Async::AudioCodecThread. It is used just like the wrapped decoder. The
+decoded samples are written to the sink from the main thread, in order, a
+short while after the encoded frames were written. The wrapped decoder must
+not be used directly after it has been given to this object.
+*/
+class AudioDecoderThreaded : public AudioDecoder
+{
+  public:
+    /**
+     * @brief 	Constuctor
+     * @param 	thread  The codec thread to run the decoder in
+     * @param 	dec     The decoder to wrap, owned by this object
+     */
+    AudioDecoderThreaded(AudioCodecThread& thread, AudioDecoder *dec);
+
+    /**
+     * @brief 	Destructor
+     */
+    ~AudioDecoderThreaded(void);
+
+    /**
+     * @brief   Get the name of the codec
+     * @returns Return the name of the wrapped codec
+     */
+    const char *name(void) const override { return codec_name.c_str(); }
+
+    /**
+     * @brief 	Set an option for the wrapped decoder
+     * @param 	name The name of the option
+     * @param 	value The value of the option
+     */
+    void setOption(const std::string &name,
+                   const std::string &value) override;
+
+    /**
+     * @brief Print codec parameter settings
+     */
+    void printCodecParams(void) const override;
+
+    /**
+     * @brief 	Write encoded samples into the decoder
+     * @param 	buf  Buffer containing encoded samples
+     * @param 	size The size of the buffer
+     */
+    void writeEncodedSamples(void *buf, int size) override;
+
+    /**
+     * @brief   Skip encoded samples without decoding them
+     * @param   buf  Buffer containing encoded samples
+     * @param   size The size of the buffer
+     *
+     * The frame is queued just like for writeEncodedSamples so that the
+     * order of the frames is kept, but the wrapped decoder is asked to skip
+     * it instead of decoding it.
+     */
+    void skipEncodedSamples(void *buf, int size) override;
+
+    /**
+     * @brief   Tell the decoder that encoded frames have been lost
+     * @param   count     The number of lost frames
+     * @param   next_buf  The frame received after the lost ones, or 0
+     * @param   next_size The size of the next frame
+     *
+     * The loss is reported to the wrapped decoder together with the next
+     * frame written to this object.
+     */
+    void encodedFramesLost(unsigned count, const void *next_buf=0,
+                           int next_size=0) override;
+
+    /**
+     * @brief Call this function when all encoded samples have been received
+     */
+    void flushEncodedSamples(void) override;
+
+    /**
+     * @brief   Get the number of frames dropped due to the latency limit
+     * @return  Returns the number of dropped frames
+     */
+    unsigned long droppedFrames(void) const { return dropped_frames; }
+
+    /**
+     * @brief   Set the object to report audio health statistics to
+     * @param   stats The statistics object or 0 to disable reporting
+     *
+     * A decoder drop is reported each time a frame is dropped because the
+     * decoder backlog exceeded the maximum latency.
+     */
+    void setStats(AudioStats *stats) { m_stats = stats; }
+
+  private:
+    struct State;
+    struct Output;
+
+    AudioCodecThread&               thread;
+    std::shared_ptr<State>          state;
+    std::string                     codec_name;
+    std::deque<WorkerPool::JobId>   jobs;
+    size_t                          pending_frames;
+    size_t                          frame_samples;
+    unsigned                        lost_frames;
+    unsigned long                   dropped_frames;
+    AudioStats*                     m_stats;
+
+    AudioDecoderThreaded(const AudioDecoderThreaded&);
+    AudioDecoderThreaded& operator=(const AudioDecoderThreaded&);
+    void jobDone(size_t frames, Output& out);
+    void queueFrame(void *buf, int size, bool skip);
+
+};  /* class AudioDecoderThreaded */
+
+
+} /* namespace */
+
+#endif /* ASYNC_AUDIO_CODEC_THREAD_INCLUDED */
+
+
+
+/*
+ * This file has not been truncated
+ */
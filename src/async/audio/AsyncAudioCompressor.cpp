@@ -33,6 +33,10 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
  ****************************************************************************/
 
 #include <iostream>
+#include <algorithm>
+#include <cstring>
+#include <cstdint>
+#include <cmath>
 
 
 /****************************************************************************
@@ -73,6 +77,16 @@ using namespace Async;
 // DC offset to prevent denormal
 static const double DC_OFFSET = 1.0E-25;
 
+// The number of samples processed in each pass through the block kernels
+static const int BLOCK_SIZE = 64;
+
+// The number of bits of the mantissa used to index the lookup tables
+static const int TABLE_BITS = 8;
+static const int TABLE_SIZE = 1 << TABLE_BITS;
+
+// 20 * log10(2), used to convert between dB and log2
+static const float DB_PER_LOG2 = 6.0205999132796239f;
+
 
 
 
@@ -83,6 +97,32 @@ static const double DC_OFFSET = 1.0E-25;
  *
  ****************************************************************************/
 
+namespace {
+  /*
+   * Lookup tables for log2(x) and 2^x
+   *
+   * log2 is tabulated over the mantissa, [1, 2), and 2^x over the fraction,
+   * [0, 1). The exponent is handled by splitting up the floating point
+   * number. Linear interpolation between the table entries give an error
+   * below 0.0001 dB which is far below anything audible.
+   */
+  struct LogExpTables
+  {
+    float log2_mant[TABLE_SIZE + 1];
+    float exp2_frac[TABLE_SIZE + 1];
+
+    LogExpTables(void)
+    {
+      for (int i=0; i<=TABLE_SIZE; ++i)
+      {
+        log2_mant[i] = log2(1.0 + static_cast<double>(i) / TABLE_SIZE);
+        exp2_frac[i] = exp2(static_cast<double>(i) / TABLE_SIZE);
+      }
+    }
+  };
+};
+
+
 
 
 /****************************************************************************
@@ -91,14 +131,6 @@ static const double DC_OFFSET = 1.0E-25;
  *
  ****************************************************************************/
 
-// linear -> dB conversion
-static inline double lin2dB( double lin )
-{
-    // 20 / ln( 10 )
-  static const double LOG_2_DB = 8.6858896380650365530225783783321;
-  return log( lin ) * LOG_2_DB;
-}
-
 // dB -> linear conversion
 static inline double dB2lin( double dB )
 {
@@ -107,6 +139,9 @@ static inline double dB2lin( double dB )
   return exp( dB * DB_2_LOG );
 }
 
+static void blockLin2dB(float *db, const float *src, int count);
+static void blockdB2Lin(float *lin, const float *db, int count);
+
 
 
 /****************************************************************************
@@ -124,6 +159,8 @@ static inline double dB2lin( double dB )
  *
  ****************************************************************************/
 
+static const LogExpTables tables;
+
 
 
 /****************************************************************************
@@ -197,59 +234,54 @@ void AudioCompressor::reset(void)
 
 void AudioCompressor::processSamples(float *dest, const float *src, int count)
 {
-  //double max_sample = 0.0;
-  for (int i=0; i<count; ++i)
+  const double gr_factor = ratio_ - 1.0;
+  const double att_coef = att_.getCoef();
+  const double rel_coef = rel_.getCoef();
+  float buf[BLOCK_SIZE];
+  while (count > 0)
   {
-    double rect = fabs(src[i]);	// rectify input
-
-    /* if desired, one could use another EnvelopeDetector to smooth
-     * the rectified signal.
-     */
+    const int cnt = std::min(count, BLOCK_SIZE);
 
-    rect += DC_OFFSET;			// add DC offset to avoid log( 0 )
-    double keydB = lin2dB( rect );	// convert linear -> dB
+      // Rectify the input and convert it to dB
+    blockLin2dB(buf, src, cnt);
 
-    // threshold
-    double overdB = keydB - threshdB_;	// delta over threshold
-    if ( overdB < 0.0 )
-	    overdB = 0.0;
-
-    // attack/release
-
-    overdB += DC_OFFSET;		// add DC offset to avoid denormal
-
-    if ( overdB > envdB_ )
+      // The envelope follower is recursive so it has to run one sample at a
+      // time. It is cheap now that no transcendental functions are called.
+    for (int i=0; i<cnt; ++i)
     {
-      att_.run( overdB, envdB_ );		// attack
+        // Delta over threshold. A DC offset is added to avoid denormals.
+      double overdB = std::max(0.0, buf[i] - threshdB_) + DC_OFFSET;
+
+        // Both the attack and release are calculated and then one of them
+        // is selected, which is faster than a hard to predict branch. The
+        // expressions are the same as in EnvelopeDetector::run but
+        // rearranged to shorten the dependency chain between samples.
+      const double att_env = att_coef * envdB_ + (1.0 - att_coef) * overdB;
+      const double rel_env = rel_coef * envdB_ + (1.0 - rel_coef) * overdB;
+      envdB_ = (overdB > envdB_) ? att_env : rel_env;
+
+        /* Regarding the DC offset: In this case, since the offset is added
+         * before the attack/release processes, the envelope will never fall
+         * below the offset, thereby avoiding denormals. However, to prevent
+         * the offset from causing constant gain reduction, we must subtract
+         * it from the envelope, yielding a minimum value of 0dB.
+         */
+      buf[i] = (envdB_ - DC_OFFSET) * gr_factor;  // gain reduction (dB)
     }
-    else
+
+      // Convert the gain reduction to linear and apply it, and the output
+      // gain, to the input
+    blockdB2Lin(buf, buf, cnt);
+    const float gain = output_gain;
+    for (int i=0; i<cnt; ++i)
     {
-      rel_.run( overdB, envdB_ );		// release
+      dest[i] = gain * src[i] * buf[i];
     }
 
-    overdB = envdB_ - DC_OFFSET;		// subtract DC offset
-    //cout << overdB << endl;
-
-    /* Regarding the DC offset: In this case, since the offset is added before 
-     * the attack/release processes, the envelope will never fall below the offset,
-     * thereby avoiding denormals. However, to prevent the offset from causing
-     * constant gain reduction, we must subtract it from the envelope, yielding
-     * a minimum value of 0dB.
-     */
-
-    // transfer function
-    double gr = overdB * ( ratio_ - 1.0 );    // gain reduction (dB)
-    gr = dB2lin( gr );			      // convert dB -> linear
-
-    // output gain
-    dest[i] = output_gain * src[i] * gr;      // apply gain reduction to input
-    
-    //if (fabs(dest[i]) > max_sample)
-    //  max_sample = dest[i];
+    src += cnt;
+    dest += cnt;
+    count -= cnt;
   }
-  
-  //cout << "max_sample=" << max_sample << endl;
-  
 } /* AudioCompressor::writeSamples */
 
 
@@ -262,6 +294,63 @@ void AudioCompressor::processSamples(float *dest, const float *src, int count)
 
 
 
+/****************************************************************************
+ *
+ * Local functions
+ *
+ ****************************************************************************/
+
+/*
+ * Rectify the input and convert it to dB. To avoid log(0) the rectified
+ * samples are limited to a tiny value instead of adding a DC offset, which
+ * would be lost in the float precision. It is far below any threshold.
+ */
+static void blockLin2dB(float *db, const float *src, int count)
+{
+  for (int i=0; i<count; ++i)
+  {
+    float rect = std::max(std::fabs(src[i]), 1.0e-30f);
+    uint32_t bits;
+    memcpy(&bits, &rect, sizeof(bits));
+    const int exponent = static_cast<int>(bits >> 23) - 127;
+    const uint32_t mant = bits & 0x007fffff;
+    const uint32_t idx = mant >> (23 - TABLE_BITS);
+    const float frac = static_cast<float>(mant & ((1 << (23 - TABLE_BITS)) - 1))
+                       * (1.0f / (1 << (23 - TABLE_BITS)));
+    const float lo = tables.log2_mant[idx];
+    const float hi = tables.log2_mant[idx + 1];
+    db[i] = DB_PER_LOG2 * (exponent + lo + frac * (hi - lo));
+  }
+} /* blockLin2dB */
+
+
+/*
+ * Convert dB to linear. The input is limited to what can be represented as
+ * a normal float, about +/-760 dB.
+ */
+static void blockdB2Lin(float *lin, const float *db, int count)
+{
+  for (int i=0; i<count; ++i)
+  {
+    float x = db[i] * (TABLE_SIZE / DB_PER_LOG2);
+    x = std::min(127.0f * TABLE_SIZE, std::max(-126.0f * TABLE_SIZE, x));
+      // The offset make the value positive so that the truncating
+      // conversion to int round down. The integer part of x / TABLE_SIZE
+      // is the exponent and the remaining bits index the table.
+    const int n = static_cast<int>(x + 126.0f * TABLE_SIZE);
+    const float frac = x + 126.0f * TABLE_SIZE - n;
+    const int idx = n & (TABLE_SIZE - 1);
+    const float lo = tables.exp2_frac[idx];
+    const float hi = tables.exp2_frac[idx + 1];
+    const uint32_t bits = static_cast<uint32_t>((n >> TABLE_BITS) + 1) << 23;
+    float scale;
+    memcpy(&scale, &bits, sizeof(scale));
+    lin[i] = scale * (lo + frac * (hi - lo));
+  }
+} /* blockdB2Lin */
+
+
+
 
 /*
  * This file has not been truncated
@@ -132,6 +132,9 @@ class EnvelopeDetector
 
     virtual double getSampleRate( void ) { return sampleRate_; }
 
+    // runtime coefficient
+    double getCoef( void ) const { return coef_; }
+
     // runtime function
     inline void run( double in, double &state )
     {
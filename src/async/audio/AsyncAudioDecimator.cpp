@@ -45,6 +45,7 @@ ANY KIND. See http://www.dspguru.com/wol.htm for more information.
  ****************************************************************************/
 
 #include "AsyncAudioDecimator.h"
+#include "AsyncSimd.h"
 
 
 
@@ -153,12 +154,7 @@ void AudioDecimator::processSamples(float *dest, const float *src, int count)
     count -= factor_M;
 
       // calculate FIR sum
-    float sum = 0.0;
-    for (int tap = 0; tap < H_size; tap++)
-    {
-      sum += p_H[tap] * p_Z[tap];
-    }
-    *dest++ = sum;     /* store sum and point to next output */
+    *dest++ = Simd::dotProduct(p_H, p_Z, H_size);
     num_out++;
   }
 
@@ -32,7 +32,10 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
  *
  ****************************************************************************/
 
-
+#include <deque>
+#include <mutex>
+#include <atomic>
+#include <cstring>
 
 /****************************************************************************
  *
@@ -60,6 +63,9 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 #ifdef OPUS_MAJOR
 #include "AsyncAudioDecoderOpus.h"
 #endif
+#ifdef CODEC2_MAJOR
+#include "AsyncAudioDecoderCodec2.h"
+#endif
 
 
 /****************************************************************************
@@ -112,6 +118,39 @@ using namespace Async;
  *
  ****************************************************************************/
 
+namespace {
+  struct DecodedFrame
+  {
+    std::string           codec;
+    uint64_t              hash;
+    std::vector<float>    samples;
+    std::vector<uint8_t>  frame;
+  };
+
+    // Enough to cover a few seconds of jitter buffering for a couple of
+    // decoders using 20ms frames
+  const size_t MAX_DECODED_FRAMES = 256;
+
+    // Decoders and encoders may run in codec threads so the decoded frames
+    // are protected by a mutex
+  std::mutex                decoded_frames_mu;
+  std::deque<DecodedFrame>  decoded_frames;
+  std::atomic<unsigned>     frame_tracking_users(0);
+
+  uint64_t sampleHash(const float *samples, int count)
+  {
+      // FNV-1a
+    const uint8_t *p = reinterpret_cast<const uint8_t*>(samples);
+    const uint8_t *end = p + count * sizeof(*samples);
+    uint64_t hash = 14695981039346656037ULL;
+    while (p != end)
+    {
+      hash = (hash ^ *p++) * 1099511628211ULL;
+    }
+    return hash;
+  }
+};
+
 
 
 /****************************************************************************
@@ -129,6 +168,9 @@ bool AudioDecoder::isAvailable(const std::string &name)
 #endif
 #ifdef OPUS_MAJOR
          (name == "OPUS") ||
+#endif
+#ifdef CODEC2_MAJOR
+         (name == "CODEC2") ||
 #endif
          (name == "DUMMY");
 } /* AudioDecoder::isAvailable */
@@ -167,6 +209,12 @@ AudioDecoder *AudioDecoder::create(const std::string &name)
   {
     return new AudioDecoderOpus;
   }
+#endif
+#ifdef CODEC2_MAJOR
+  else if (name == "CODEC2")
+  {
+    return new AudioDecoderCodec2;
+  }
 #endif
   else
   {
@@ -175,12 +223,78 @@ AudioDecoder *AudioDecoder::create(const std::string &name)
 }
 
 
+void AudioDecoder::enableFrameTracking(bool enable)
+{
+  std::lock_guard<std::mutex> lk(decoded_frames_mu);
+  if (enable)
+  {
+    ++frame_tracking_users;
+  }
+  else if (frame_tracking_users > 0)
+  {
+    if (--frame_tracking_users == 0)
+    {
+      decoded_frames.clear();
+    }
+  }
+} /* AudioDecoder::enableFrameTracking */
+
+
+const std::vector<uint8_t>* AudioDecoder::findEncodedFrame(
+    const std::string& codec, const float *samples, int count)
+{
+  if ((frame_tracking_users == 0) || (count <= 0))
+  {
+    return 0;
+  }
+  const uint64_t hash = sampleHash(samples, count);
+  std::lock_guard<std::mutex> lk(decoded_frames_mu);
+  for (auto it = decoded_frames.rbegin(); it != decoded_frames.rend(); ++it)
+  {
+    if ((it->hash == hash) && (it->samples.size() == size_t(count)) &&
+        (it->codec == codec) &&
+        (memcmp(it->samples.data(), samples, count * sizeof(*samples)) == 0))
+    {
+        // Return a copy since another thread may replace the entry as soon
+        // as the lock is released
+      static thread_local std::vector<uint8_t> found;
+      found = it->frame;
+      return &found;
+    }
+  }
+  return 0;
+} /* AudioDecoder::findEncodedFrame */
+
+
 /****************************************************************************
  *
  * Protected member functions
  *
  ****************************************************************************/
 
+int AudioDecoder::sinkWriteDecodedFrame(const void *frame, int frame_size,
+                                        const float *samples, int count)
+{
+  if ((frame_tracking_users > 0) && (frame_size > 0) && (count > 0))
+  {
+    std::lock_guard<std::mutex> lk(decoded_frames_mu);
+      // Reuse the buffers of the oldest entry to avoid allocations
+    DecodedFrame df;
+    if (decoded_frames.size() >= MAX_DECODED_FRAMES)
+    {
+      df = std::move(decoded_frames.front());
+      decoded_frames.pop_front();
+    }
+    df.codec = name();
+    df.hash = sampleHash(samples, count);
+    df.samples.assign(samples, samples + count);
+    const uint8_t *fbuf = reinterpret_cast<const uint8_t*>(frame);
+    df.frame.assign(fbuf, fbuf + frame_size);
+    decoded_frames.push_back(std::move(df));
+  }
+  return sinkWriteSamples(samples, count);
+} /* AudioDecoder::sinkWriteDecodedFrame */
+
 
 
 /****************************************************************************
@@ -35,6 +35,8 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
  ****************************************************************************/
 
 #include <string>
+#include <vector>
+#include <cstdint>
 #include <sigc++/sigc++.h>
 
 
@@ -124,6 +126,36 @@ class AudioDecoder : public AudioSource, public sigc::trackable
      * @param   name The name of the decoder to create
      */
     static AudioDecoder *create(const std::string &name);
+
+    /**
+     * @brief   Enable or disable tracking of decoded frames
+     * @param   enable Set to \em true to enable or \em false to disable
+     *
+     * When frame tracking is enabled, decoders supporting it remember the
+     * most recently decoded frames so that findEncodedFrame can be used. The
+     * calls are reference counted so tracking is enabled as long as at least
+     * one user have enabled it. This is normally handled by the encoders that
+     * have passthrough enabled.
+     */
+    static void enableFrameTracking(bool enable);
+
+    /**
+     * @brief   Find the encoded frame that some samples were decoded from
+     * @param   codec   The name of the codec
+     * @param   samples The samples to look for
+     * @param   count   The number of samples
+     * @return  Returns the encoded frame or 0 if not found
+     *
+     * This function is used by an encoder to find out if the samples it is
+     * about to encode are exactly the samples that came out of a decoder for
+     * the same codec. That means that they have not been mixed, filtered or
+     * otherwise modified on the way so the original encoded frame can be
+     * used as is instead of encoding the samples again. The returned frame
+     * is valid until the next call to this function from the same thread.
+     * This function is thread safe.
+     */
+    static const std::vector<uint8_t>* findEncodedFrame(
+        const std::string& codec, const float *samples, int count);
     
     /**
      * @brief 	Default constuctor
@@ -152,6 +184,17 @@ class AudioDecoder : public AudioSource, public sigc::trackable
      * @brief Print codec parameter settings
      */
     virtual void printCodecParams(void) const {}
+
+    /**
+     * @brief   Reset the decoder to the state of a newly created decoder
+     * @return  Returns \em true on success or \em false if not supported
+     *
+     * This function is used when a codec is reused for a new audio stream,
+     * @see AudioCodecPool. The codec state and all options are restored to
+     * their defaults. A decoder that do not support this return \em false and
+     * must be deleted and created again instead.
+     */
+    virtual bool reset(void) { return false; }
     
     /**
      * @brief 	Write encoded samples into the decoder
@@ -159,7 +202,38 @@ class AudioDecoder : public AudioSource, public sigc::trackable
      * @param 	size The size of the buffer
      */
     virtual void writeEncodedSamples(void *buf, int size) = 0;
+
+    /**
+     * @brief   Skip encoded samples without decoding them
+     * @param   buf  Buffer containing encoded samples
+     * @param   size The size of the buffer
+     *
+     * Call this function instead of writeEncodedSamples when the decoded
+     * audio is not going to be used by anyone. Silence, as long as the
+     * frame would have been, is written to the sink so that the timing of
+     * the stream is kept. A decoder that support it reset its state before
+     * decoding the next frame written using writeEncodedSamples. The
+     * default is to decode the frame as usual.
+     */
+    virtual void skipEncodedSamples(void *buf, int size)
+    {
+      writeEncodedSamples(buf, size);
+    }
     
+    /**
+     * @brief   Tell the decoder that encoded frames have been lost
+     * @param   count     The number of lost frames
+     * @param   next_buf  The frame received after the lost ones, or 0
+     * @param   next_size The size of the next frame
+     *
+     * This function should be called before writing the frame received
+     * after a loss. A decoder supporting it may then conceal the loss, for
+     * example using forward error correction data in the next frame. The
+     * default is to do nothing.
+     */
+    virtual void encodedFramesLost(unsigned count, const void *next_buf=0,
+                                   int next_size=0) {}
+
     /**
      * @brief Call this function when all encoded samples have been received
      */
@@ -189,6 +263,20 @@ class AudioDecoder : public AudioSource, public sigc::trackable
      * This function is normally only called from a connected sink object.
      */
     virtual void allSamplesFlushed(void) { allEncodedSamplesFlushed(); }
+
+    /**
+     * @brief   Write samples decoded from a single frame to the sink
+     * @param   frame       The encoded frame
+     * @param   frame_size  The size of the encoded frame
+     * @param   samples     The decoded samples
+     * @param   count       The number of decoded samples
+     * @return  Returns the number of samples taken care of by the sink
+     *
+     * Decoders that support passthrough should use this function instead of
+     * sinkWriteSamples so that the frame can be found by findEncodedFrame.
+     */
+    int sinkWriteDecodedFrame(const void *frame, int frame_size,
+                              const float *samples, int count);
     
     
   private:
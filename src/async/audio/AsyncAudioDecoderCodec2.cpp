@@ -0,0 +1,237 @@
+/**
+@file	 AsyncAudioDecoderCodec2.cpp
+@brief   An audio decoder that use the Codec2 audio codec
+@author  Tobias Blomberg / SM0SVX
+@date	 2026-10-15
+
+\verbatim
+Async - A library for programming event driven applications
+Copyright (C) 2003-2026 Tobias Blomberg / SM0SVX
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+\endverbatim
+*/
+
+
+
+/****************************************************************************
+ *
+ * System Includes
+ *
+ ****************************************************************************/
+
+#include <codec2/codec2.h>
+#include <codec2/codec2_fdmdv.h>
+
+#include <iostream>
+#include <cstdlib>
+#include <algorithm>
+
+
+/****************************************************************************
+ *
+ * Project Includes
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Local Includes
+ *
+ ****************************************************************************/
+
+#include "AsyncAudioDecoderCodec2.h"
+#include "AsyncAudioEncoderCodec2.h"
+
+
+
+/****************************************************************************
+ *
+ * Namespaces to use
+ *
+ ****************************************************************************/
+
+using namespace std;
+using namespace Async;
+
+
+
+/****************************************************************************
+ *
+ * Defines & typedefs
+ *
+ ****************************************************************************/
+
+  // The number of samples of filter history to keep in front of the sample
+  // buffer when interpolating from the 8kHz used by Codec2 to 16kHz
+#if INTERNAL_SAMPLE_RATE == 16000
+#define HIST_LEN  FDMDV_OS_TAPS_8K
+#define INT_FACT  FDMDV_OS
+#else
+#define HIST_LEN  0
+#define INT_FACT  1
+#endif
+
+
+/****************************************************************************
+ *
+ * Local class definitions
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Prototypes
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Exported Global Variables
+ *
+ ****************************************************************************/
+
+
+
+
+/****************************************************************************
+ *
+ * Local Global Variables
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Public member functions
+ *
+ ****************************************************************************/
+
+AudioDecoderCodec2::AudioDecoderCodec2(void)
+  : m_codec2(0), m_bitrate(0), m_samples_per_frame(0), m_bytes_per_frame(0)
+{
+  setBitrate(AudioEncoderCodec2::DEFAULT_BITRATE);
+} /* AudioDecoderCodec2::AudioDecoderCodec2 */
+
+
+AudioDecoderCodec2::~AudioDecoderCodec2(void)
+{
+  codec2_destroy(m_codec2);
+} /* AudioDecoderCodec2::~AudioDecoderCodec2 */
+
+
+void AudioDecoderCodec2::setOption(const std::string &name,
+                                   const std::string &value)
+{
+  if (name == "BITRATE")
+  {
+    if (!setBitrate(atoi(value.c_str())))
+    {
+      cerr << "*** WARNING AudioDecoderCodec2: Unsupported bitrate \""
+           << value << "\". Ignoring it.\n";
+    }
+  }
+  else
+  {
+    cerr << "*** WARNING AudioDecoderCodec2: Unknown option \""
+      	 << name << "\". Ignoring it.\n";
+  }
+} /* AudioDecoderCodec2::setOption */
+
+
+void AudioDecoderCodec2::printCodecParams(void) const
+{
+  cout << "------ Codec2 decoder parameters ------\n";
+  cout << "Bitrate         = " << bitrate() << endl;
+  cout << "---------------------------------------\n";
+} /* AudioDecoderCodec2::printCodecParams */
+
+
+bool AudioDecoderCodec2::setBitrate(unsigned new_bitrate)
+{
+  const int mode = AudioEncoderCodec2::bitrateToMode(new_bitrate);
+  if (mode < 0)
+  {
+    return false;
+  }
+  if ((m_codec2 != 0) && (new_bitrate == m_bitrate))
+  {
+    return true;
+  }
+
+  codec2_destroy(m_codec2);
+  m_codec2 = codec2_create(mode);
+  m_bitrate = new_bitrate;
+  m_samples_per_frame = codec2_samples_per_frame(m_codec2);
+  m_bytes_per_frame = codec2_bytes_per_frame(m_codec2);
+  m_speech.resize(m_samples_per_frame);
+  m_sample_buf.assign(HIST_LEN + m_samples_per_frame, 0.0f);
+  m_out_buf.resize(INT_FACT * m_samples_per_frame);
+  return true;
+} /* AudioDecoderCodec2::setBitrate */
+
+
+void AudioDecoderCodec2::writeEncodedSamples(void *buf, int size)
+{
+  unsigned char *ptr = static_cast<unsigned char *>(buf);
+  for (; size >= m_bytes_per_frame; size -= m_bytes_per_frame)
+  {
+    codec2_decode(m_codec2, &m_speech[0], ptr);
+    ptr += m_bytes_per_frame;
+
+    float *samples = &m_sample_buf[HIST_LEN];
+    for (int i=0; i<m_samples_per_frame; ++i)
+    {
+      samples[i] = m_speech[i] / 32768.0f;
+    }
+#if INTERNAL_SAMPLE_RATE == 16000
+    fdmdv_8_to_16(&m_out_buf[0], samples, m_samples_per_frame);
+    std::copy(m_sample_buf.end() - HIST_LEN, m_sample_buf.end(),
+              m_sample_buf.begin());
+    sinkWriteSamples(&m_out_buf[0], m_out_buf.size());
+#else
+    sinkWriteSamples(samples, m_samples_per_frame);
+#endif
+  }
+} /* AudioDecoderCodec2::writeEncodedSamples */
+
+
+
+/****************************************************************************
+ *
+ * Protected member functions
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Private member functions
+ *
+ ****************************************************************************/
+
+
+
+/*
+ * This file has not been truncated
+ */
@@ -0,0 +1,193 @@
+/**
+@file	 AsyncAudioDecoderCodec2.h
+@brief   An audio decoder that use the Codec2 audio codec
+@author  Tobias Blomberg / SM0SVX
+@date	 2026-10-15
+
+\verbatim
+Async - A library for programming event driven applications
+Copyright (C) 2003-2026 Tobias Blomberg / SM0SVX
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+\endverbatim
+*/
+
+#ifndef ASYNC_AUDIO_DECODER_CODEC2_INCLUDED
+#define ASYNC_AUDIO_DECODER_CODEC2_INCLUDED
+
+
+/****************************************************************************
+ *
+ * System Includes
+ *
+ ****************************************************************************/
+
+#include <vector>
+
+
+/****************************************************************************
+ *
+ * Project Includes
+ *
+ ****************************************************************************/
+
+#include <AsyncAudioDecoder.h>
+
+
+/****************************************************************************
+ *
+ * Local Includes
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Forward declarations
+ *
+ ****************************************************************************/
+
+struct CODEC2;
+
+
+/****************************************************************************
+ *
+ * Namespace
+ *
+ ****************************************************************************/
+
+namespace Async
+{
+
+
+/****************************************************************************
+ *
+ * Forward declarations of classes inside of the declared namespace
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Defines & typedefs
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Exported Global Variables
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Class definitions
+ *
+ ****************************************************************************/
+
+/**
+@brief	An audio decoder that use the Codec2 audio codec
+@author Tobias Blomberg / SM0SVX
+@date   2026-10-15
+
+This class implements an audio decoder that use the Codec2 audio codec. The
+bitrate cannot be found out from the encoded data so it must be set, using the
+BITRATE option, to the same value as used by the encoder. The decoded 8kHz
+audio is interpolated to 16kHz when that is the internal sample rate.
+*/
+class AudioDecoderCodec2 : public AudioDecoder
+{
+  public:
+    /**
+     * @brief 	Default constuctor
+     */
+    AudioDecoderCodec2(void);
+
+    /**
+     * @brief 	Destructor
+     */
+    virtual ~AudioDecoderCodec2(void);
+
+    /**
+     * @brief   Get the name of the codec
+     * @returns Return the name of the codec
+     */
+    virtual const char *name(void) const { return "CODEC2"; }
+
+    /**
+     * @brief 	Set an option for the decoder
+     * @param 	name The name of the option
+     * @param 	value The value of the option
+     */
+    virtual void setOption(const std::string &name, const std::string &value);
+
+    /**
+     * @brief Print codec parameter settings
+     */
+    virtual void printCodecParams(void) const;
+
+    /**
+     * @brief   Set the bitrate of the encoded audio
+     * @param   new_bitrate The bitrate in bits per second
+     * @return  Returns \em true on success or \em false if the bitrate is
+     *          not supported by Codec2
+     */
+    bool setBitrate(unsigned new_bitrate);
+
+    /**
+     * @brief   Get the bitrate of the encoded audio
+     * @returns Returns the bitrate in bits per second
+     */
+    unsigned bitrate(void) const { return m_bitrate; }
+
+    /**
+     * @brief 	Write encoded samples into the decoder
+     * @param 	buf  Buffer containing encoded samples
+     * @param 	size The size of the buffer
+     */
+    virtual void writeEncodedSamples(void *buf, int size);
+
+  protected:
+
+  private:
+    struct CODEC2*      m_codec2;
+    unsigned            m_bitrate;
+    int                 m_samples_per_frame;
+    int                 m_bytes_per_frame;
+    std::vector<short>  m_speech;
+    std::vector<float>  m_sample_buf;
+    std::vector<float>  m_out_buf;
+
+    AudioDecoderCodec2(const AudioDecoderCodec2&);
+    AudioDecoderCodec2& operator=(const AudioDecoderCodec2&);
+
+};  /* class AudioDecoderCodec2 */
+
+
+} /* namespace */
+
+#endif /* ASYNC_AUDIO_DECODER_CODEC2_INCLUDED */
+
+
+
+/*
+ * This file has not been truncated
+ */
@@ -36,6 +36,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 #include <iostream>
 #include <cstdlib>
 #include <cmath>
+#include <algorithm>
 
 
 /****************************************************************************
@@ -115,7 +116,7 @@ using namespace Async;
  ****************************************************************************/
 
 AudioDecoderOpus::AudioDecoderOpus(void)
-  : frame_size(0)
+  : frame_size(0), skipped(false)
 {
   int error;
   dec = opus_decoder_create(INTERNAL_SAMPLE_RATE, 1, &error);
@@ -179,15 +180,34 @@ float AudioDecoderOpus::gain(void) const
 #endif
 
 
-void AudioDecoderOpus::reset(void)
+bool AudioDecoderOpus::reset(void)
 {
-  opus_decoder_ctl(dec, OPUS_RESET_STATE);
+    // Initializing the already allocated decoder state restore all settings,
+    // like the gain, to their defaults without allocating any memory
+  int err = opus_decoder_init(dec, INTERNAL_SAMPLE_RATE, 1);
+  if (err != OPUS_OK)
+  {
+    cerr << "*** ERROR: Could not reset Opus decoder: "
+         << opus_strerror(err) << endl;
+    return false;
+  }
+  frame_size = 0;
+  skipped = false;
+  return true;
 } /* AudioDecoderOpus::reset */
 
 
 void AudioDecoderOpus::writeEncodedSamples(void *buf, int size)
 {
   unsigned char *packet = reinterpret_cast<unsigned char *>(buf);
+
+    // The decoder state is stale if packets have been skipped. Only the
+    // stream state is reset so that settings like the gain are kept.
+  if (skipped)
+  {
+    opus_decoder_ctl(dec, OPUS_RESET_STATE);
+    skipped = false;
+  }
   
   int frame_cnt = opus_packet_get_nb_frames(packet, size);
   if (frame_cnt == 0)
@@ -231,7 +251,7 @@ void AudioDecoderOpus::writeEncodedSamples(void *buf, int size)
   //cout << " " << frame_size << endl;
   if (frame_size > 0)
   {
-    sinkWriteSamples(samples, frame_size);
+    sinkWriteDecodedFrame(buf, size, samples, frame_size);
   }
   else if (frame_size < 0)
   {
@@ -241,6 +261,51 @@ void AudioDecoderOpus::writeEncodedSamples(void *buf, int size)
 } /* AudioDecoderOpus::writeEncodedSamples */
 
 
+void AudioDecoderOpus::skipEncodedSamples(void *buf, int size)
+{
+  const unsigned char *packet = reinterpret_cast<unsigned char *>(buf);
+  int count = opus_packet_get_nb_samples(packet, size, INTERNAL_SAMPLE_RATE);
+  if (count <= 0)
+  {
+    return;
+  }
+  float samples[count];
+  std::fill(samples, samples + count, 0.0f);
+  sinkWriteSamples(samples, count);
+  skipped = true;
+} /* AudioDecoderOpus::skipEncodedSamples */
+
+
+void AudioDecoderOpus::encodedFramesLost(unsigned count, const void *next_buf,
+                                         int next_size)
+{
+  if ((frame_size <= 0) || (count == 0) || (count > MAX_CONCEALED_FRAMES))
+  {
+    return;
+  }
+  const unsigned char *next =
+    reinterpret_cast<const unsigned char *>(next_buf);
+  float samples[frame_size];
+  for (unsigned i=0; i<count; ++i)
+  {
+    const bool use_fec = (i+1 == count) && (next != 0) && (next_size > 0);
+    int cnt = opus_decode_float(dec, use_fec ? next : 0,
+                                use_fec ? next_size : 0,
+                                samples, frame_size, use_fec ? 1 : 0);
+    if (cnt > 0)
+    {
+      sinkWriteSamples(samples, cnt);
+    }
+    else if (cnt < 0)
+    {
+      cerr << "**** ERROR: Opus decoder error: " << opus_strerror(cnt)
+           << endl;
+      return;
+    }
+  }
+} /* AudioDecoderOpus::encodedFramesLost */
+
+
 
 /****************************************************************************
  *
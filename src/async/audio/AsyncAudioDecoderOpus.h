@@ -139,6 +139,12 @@ class AudioDecoderOpus : public AudioDecoder
      * @brief Print codec parameter settings
      */
     virtual void printCodecParams(void) const;
+
+    /**
+     * @brief   Resets decoder to be equivalent to a freshly initialized one
+     * @return  Returns \em true on success or \em false on failure
+     */
+    virtual bool reset(void);
     
 #if OPUS_MAJOR
     /**
@@ -155,24 +161,45 @@ class AudioDecoderOpus : public AudioDecoder
     float gain(void) const;
 #endif
 
-    /**
-     * @brief   Resets encoder to be equivalent to a freshly initialized one
-     */
-    void reset(void);
-
     /**
      * @brief 	Write encoded samples into the decoder
      * @param 	buf  Buffer containing encoded samples
      * @param 	size The size of the buffer
      */
     virtual void writeEncodedSamples(void *buf, int size);
+
+    /**
+     * @brief   Skip encoded samples without decoding them
+     * @param   buf  Buffer containing encoded samples
+     * @param   size The size of the buffer
+     *
+     * Silence, as long as the packet, is written to the sink. The decoder is
+     * reset before the next packet is decoded.
+     */
+    virtual void skipEncodedSamples(void *buf, int size);
+
+    /**
+     * @brief   Tell the decoder that encoded frames have been lost
+     * @param   count     The number of lost frames
+     * @param   next_buf  The frame received after the lost ones, or 0
+     * @param   next_size The size of the next frame
+     *
+     * The last lost frame is recovered from the in-band forward error
+     * correction data in the next frame, if the encoder sent any. The other
+     * lost frames are replaced using packet loss concealment.
+     */
+    virtual void encodedFramesLost(unsigned count, const void *next_buf=0,
+                                   int next_size=0);
     
 
   protected:
     
   private:
+    static const unsigned MAX_CONCEALED_FRAMES = 5;
+
     OpusDecoder *dec;
     int         frame_size;
+    bool        skipped;
     
     AudioDecoderOpus(const AudioDecoderOpus&);
     AudioDecoderOpus& operator=(const AudioDecoderOpus&);
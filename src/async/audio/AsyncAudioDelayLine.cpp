@@ -52,6 +52,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
  ****************************************************************************/
 
 #include "AsyncAudioDelayLine.h"
+#include "AsyncSimd.h"
 
 
 
@@ -115,8 +116,8 @@ using namespace Async;
 
 AudioDelayLine::AudioDelayLine(int length_ms)
   : size(length_ms * INTERNAL_SAMPLE_RATE / 1000), ptr(0), flush_cnt(0),
-    is_muted(false), mute_cnt(0), last_clear(0), fade_gain(0), fade_len(0),
-    fade_pos(0), fade_dir(0)
+    is_muted(false), mute_cnt(0), last_clear(0), fade_gain(0),
+    fade_in_gain(0), fade_len(0), fade_pos(0), fade_dir(0), zero_copy(false)
 {
   buf = new float[size];
   memset(buf, 0, size * sizeof(*buf));
@@ -127,6 +128,7 @@ AudioDelayLine::AudioDelayLine(int length_ms)
 
 AudioDelayLine::~AudioDelayLine(void)
 {
+  delete [] fade_in_gain;
   delete [] fade_gain;
   delete [] buf;
 } /* AudioDelayLine::~AudioDelayLine */
@@ -134,6 +136,8 @@ AudioDelayLine::~AudioDelayLine(void)
 
 void AudioDelayLine::setFadeTime(int time_ms)
 {
+  delete [] fade_in_gain;
+  fade_in_gain = 0;
   delete [] fade_gain;
   fade_gain = 0;
   
@@ -153,6 +157,11 @@ void AudioDelayLine::setFadeTime(int time_ms)
     fade_gain[i] = pow(2.0f, -15.0f * (static_cast<float>(i) / fade_len));
   }
   fade_gain[fade_len-1] = 0;
+
+    // The fade in ramp is the fade out ramp reversed so that both can be
+    // applied to the samples in increasing order
+  fade_in_gain = new float[fade_len];
+  reverse_copy(fade_gain, fade_gain + fade_len, fade_in_gain);
 } /* AudioDelayLine::setFadeTime  */
 
 
@@ -229,25 +238,25 @@ int AudioDelayLine::writeSamples(const float *samples, int count)
   last_clear = 0;
   
   count = min(count, size);
-  float output[count];
-  int out_ptr = ptr;
-  for (int i=0; i<count; ++i)
-  {
-    output[i] = buf[out_ptr];
-    out_ptr = (out_ptr < size-1) ? out_ptr+1 : 0;
-  }
-
-  int written = sinkWriteSamples(output, count);
+  const int written = sinkWriteRing(count);
 
-  for (int i=0; i<written; ++i)
+    // Store the new samples in the ring buffer in segments that end at the
+    // end of the buffer or when a timed mute ends
+  for (int pos=0; pos<written; )
   {
-    buf[ptr] = samples[i] * currentFadeGain();
-    if (is_muted && (mute_cnt > 0) && (--mute_cnt == 0))
+    int cnt = min(written - pos, size - ptr);
+    if (is_muted && (mute_cnt > 0))
+    {
+      cnt = min(cnt, mute_cnt);
+    }
+    fadeSamples(buf + ptr, samples + pos, cnt);
+    if (is_muted && (mute_cnt > 0) && ((mute_cnt -= cnt) == 0))
     {
       fade_dir = -1; // Fade in
       is_muted = false;
     }
-    ptr = (ptr < size-1) ? ptr+1 : 0;
+    ptr = (ptr + cnt < size) ? ptr + cnt : 0;
+    pos += cnt;
   }
   
   return written;
@@ -306,27 +315,17 @@ void AudioDelayLine::allSamplesFlushed(void)
 
 void AudioDelayLine::writeRemainingSamples(void)
 {
-  float output[512];
   int written = 1; // Set to 1 so that we enter the loop the first time around
 
   while ((written > 0) && (flush_cnt > 0))
   {
     int count = min(512, flush_cnt);
-    
-    int out_ptr = ptr;
-    for (int i=0; i<count; ++i)
-    {
-      output[i] = buf[out_ptr];
-      out_ptr = (out_ptr < size-1) ? out_ptr+1 : 0;
-    }
+    written = sinkWriteRing(count);
 
-    written = sinkWriteSamples(output, count);
-
-    for (int i=0; i<written; ++i)
-    {
-      buf[ptr] = 0;
-      ptr = (ptr < size-1) ? ptr+1 : 0;
-    }
+    const int first = min(written, size - ptr);
+    memset(buf + ptr, 0, first * sizeof(*buf));
+    memset(buf, 0, (written - first) * sizeof(*buf));
+    ptr = (ptr + written) % size;
 
     flush_cnt -= written;
   }
@@ -338,6 +337,86 @@ void AudioDelayLine::writeRemainingSamples(void)
 } /* AudioDelayLine::writeRemainingSamples */
 
 
+int AudioDelayLine::sinkWriteRing(int count)
+{
+  const int first = min(count, size - ptr);
+  if (zero_copy)
+  {
+    int written = sinkWriteSamples(buf + ptr, first);
+    if ((written == first) && (first < count))
+    {
+      written += sinkWriteSamples(buf, count - first);
+    }
+    return written;
+  }
+
+  if (out_buf.size() < static_cast<size_t>(count))
+  {
+    out_buf.resize(count);
+  }
+  memcpy(out_buf.data(), buf + ptr, first * sizeof(*buf));
+  memcpy(out_buf.data() + first, buf, (count - first) * sizeof(*buf));
+  return sinkWriteSamples(out_buf.data(), count);
+} /* AudioDelayLine::sinkWriteRing */
+
+
+void AudioDelayLine::fadeSamples(float *dst, const float *src, int count)
+{
+  while (count > 0)
+  {
+    if ((fade_gain == 0) || (fade_dir == 0))
+    {
+      const float gain = (fade_gain == 0) ? 1.0f : fade_gain[fade_pos];
+      if (gain == 1.0f)
+      {
+        memcpy(dst, src, count * sizeof(*dst));
+      }
+      else if (gain == 0.0f)
+      {
+        memset(dst, 0, count * sizeof(*dst));
+      }
+      else
+      {
+        for (int i=0; i<count; ++i)
+        {
+          dst[i] = src[i] * gain;
+        }
+      }
+      return;
+    }
+
+      // Apply the part of the fade ramp that is left, in the same way as
+      // calling currentFadeGain for each sample would
+    const float *ramp;
+    int ramp_len;
+    if (fade_dir > 0)
+    {
+      ramp = fade_gain + fade_pos;
+      ramp_len = max(1, fade_len - 1 - fade_pos);
+    }
+    else
+    {
+      ramp = fade_in_gain + (fade_len - 1 - fade_pos);
+      ramp_len = max(1, fade_pos);
+    }
+    const int cnt = min(count, ramp_len);
+    Simd::multiply(dst, src, ramp, cnt);
+    if (cnt == ramp_len)
+    {
+      fade_pos = (fade_dir > 0) ? fade_len - 1 : 0;
+      fade_dir = 0;
+    }
+    else
+    {
+      fade_pos += fade_dir * cnt;
+    }
+    dst += cnt;
+    src += cnt;
+    count -= cnt;
+  }
+} /* AudioDelayLine::fadeSamples */
+
+
 
 /*
  * This file has not been truncated
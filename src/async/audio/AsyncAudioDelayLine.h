@@ -35,6 +35,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
  *
  ****************************************************************************/
 
+#include <vector>
 
 
 /****************************************************************************
@@ -161,6 +162,19 @@ class AudioDelayLine : public Async::AudioSink, public Async::AudioSource
      * samples will not be flushed. They will be thrown away.
      */
     void clear(int time_ms=-1);
+
+    /**
+     * @brief   Write samples to the sink directly from the delay line buffer
+     * @param   enable Set to \em true to enable zero-copy output
+     *
+     * Normally the delayed samples are copied to a separate buffer before
+     * being written to the sink. With zero-copy output enabled, the samples
+     * are instead written directly from the ring buffer. If the samples wrap
+     * around the end of the ring buffer they are written to the sink in two
+     * calls. The sink must not keep the sample pointer after its
+     * writeSamples function has returned. The default is disabled.
+     */
+    void setZeroCopy(bool enable) { zero_copy = enable; }
   
     /**
      * @brief 	Write samples into the delay line
@@ -217,13 +231,18 @@ class AudioDelayLine : public Async::AudioSink, public Async::AudioSource
     int		mute_cnt;
     int		last_clear;
     float	*fade_gain;
+    float	*fade_in_gain;
     int		fade_len;
     int		fade_pos;
     int		fade_dir;
+    bool	zero_copy;
+    std::vector<float> out_buf;
     
     AudioDelayLine(const AudioDelayLine&);
     AudioDelayLine& operator=(const AudioDelayLine&);
     void writeRemainingSamples(void);
+    int sinkWriteRing(int count);
+    void fadeSamples(float *dst, const float *src, int count);
 
     inline float currentFadeGain(void)
     {
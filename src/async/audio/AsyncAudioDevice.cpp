@@ -59,6 +59,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 #include "AsyncAudioIO.h"
 #include "AsyncAudioDevice.h"
 #include "AsyncAudioDeviceFactory.h"
+#include "AsyncAudioSampleConv.h"
 
 
 /****************************************************************************
@@ -170,7 +171,7 @@ void AudioDevice::unregisterAudioIO(AudioIO *audio_io)
   
   assert(dev->use_count > 0);
   
-  list<AudioIO*>::iterator it =
+  vector<AudioIO*>::iterator it =
       	  find(dev->aios.begin(), dev->aios.end(), audio_io);
   assert(it != dev->aios.end());
   dev->aios.erase(it);
@@ -229,7 +230,7 @@ bool AudioDevice::open(Mode mode)
 
 void AudioDevice::close(void)
 {
-  list<AudioIO*>::iterator it;
+  vector<AudioIO*>::iterator it;
   for (it=aios.begin(); it!=aios.end(); ++it)
   {
     if ((*it)->mode() != AudioIO::MODE_NONE)
@@ -272,16 +273,19 @@ void AudioDevice::putBlocks(int16_t *buf, size_t frame_cnt)
   float samples[frame_cnt];
   for (size_t ch=0; ch<channels; ch++)
   {
-    for (size_t i=0; i<frame_cnt; i++)
-    {
-        // no divisions in index calculation (embedded system performance !!!)
-      samples[i] = static_cast<float>(buf[i * channels + ch]) / 32768.0;
-    }
-    list<AudioIO*>::iterator it;
+      // The channel is only converted if there is someone listening to it
+    bool converted = false;
+    vector<AudioIO*>::iterator it;
     for (it=aios.begin(); it!=aios.end(); ++it)
     {
       if ((*it)->channel() == ch)
       {
+        if (!converted)
+        {
+          AudioSampleConv::deinterleaveS16(samples, buf, channels, ch,
+                                           frame_cnt);
+          converted = true;
+        }
         (*it)->audioRead(samples, frame_cnt);
       }
     }
@@ -301,7 +305,7 @@ size_t AudioDevice::getBlocks(int16_t *buf, size_t block_cnt)
     // written in total. If all AudioIO objects are flushing, the AudioIO
     // object with the most number of samples will decide how many samples
     // get written.
-  list<AudioIO*>::iterator it;
+  vector<AudioIO*>::iterator it;
   bool do_flush = true;
   unsigned int max_samples_in_fifo = 0;
   for (it=aios.begin(); it!=aios.end(); ++it)
@@ -348,34 +352,45 @@ size_t AudioDevice::getBlocks(int16_t *buf, size_t block_cnt)
     return 0;
   }
   
-    // Fill the sample buffer with samples from the non-idle AudioIO objects.
+    // Mix the samples from the non-idle AudioIO objects in floating point,
+    // one contiguous buffer per channel, so that the SIMD add kernel can be
+    // used. The first AudioIO object on a channel is read directly into the
+    // mix buffer so the common case of one AudioIO object per channel does
+    // not need any mixing at all. Each used channel is then converted to 16
+    // bit samples once. Unused channels are left zeroed in the output buffer.
+  float mix[channels * frames_to_write];
+  bool used[channels];
+  std::fill(used, used + channels, false);
+  float tmp[frames_to_write];
   for (it=aios.begin(); it!=aios.end(); ++it)
   {
     if (!(*it)->isIdle())
     {
-      size_t channel = (*it)->channel();
-      float tmp[frames_to_write];
-      int samples_read = (*it)->readSamples(tmp, frames_to_write);
-      assert(samples_read >= 0);
-      for (size_t i=0; i<static_cast<size_t>(samples_read); ++i)
+      const size_t ch = (*it)->channel();
+      float *ch_mix = mix + ch * frames_to_write;
+      if (!used[ch])
       {
-	int buf_pos = i * channels + channel;
-	float sample = 32767.0 * tmp[i] + buf[buf_pos];
-	if (sample > 32767)
-	{
-	  buf[buf_pos] = 32767;
-	}
-	else if (sample < -32767)
-	{
-	  buf[buf_pos] = -32767;
-	}
-	else
-	{
-	  buf[buf_pos] = static_cast<int16_t>(sample);
-	}
+        int samples_read = (*it)->readSamples(ch_mix, frames_to_write);
+        assert(samples_read >= 0);
+        std::fill(ch_mix + samples_read, ch_mix + frames_to_write, 0.0f);
+        used[ch] = true;
+      }
+      else
+      {
+        int samples_read = (*it)->readSamples(tmp, frames_to_write);
+        assert(samples_read >= 0);
+        Simd::add(ch_mix, tmp, samples_read);
       }
     }
-  }  
+  }
+  for (size_t ch=0; ch<channels; ++ch)
+  {
+    if (used[ch])
+    {
+      AudioSampleConv::interleaveS16(buf, mix + ch * frames_to_write,
+                                     channels, ch, frames_to_write);
+    }
+  }
       
     // If flushing and the number of frames to write is not an even
     // multiple of the frag size, round the number of frags to write
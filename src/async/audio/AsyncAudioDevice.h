@@ -40,7 +40,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 
 #include <string>
 #include <map>
-#include <list>
+#include <vector>
 
 
 /****************************************************************************
@@ -281,6 +281,26 @@ class AudioDevice : public sigc::trackable
      * been flushed.
      */
     virtual int samplesToWrite(void) const = 0;
+
+    /**
+     * @brief   Get the number of playback buffer underruns
+     * @return  Returns the number of underruns since the device was created
+     *
+     * An underrun occur when the audio device run out of samples to play,
+     * which is heard as a click or a gap in the audio. Audio devices that do
+     * not keep track of underruns always return 0.
+     */
+    virtual unsigned long playbackXrunCount(void) const { return 0; }
+
+    /**
+     * @brief   Get the number of capture buffer overruns
+     * @return  Returns the number of overruns since the device was created
+     *
+     * An overrun occur when recorded samples have been lost because they
+     * were not read from the audio device fast enough. Audio devices that do
+     * not keep track of overruns always return 0.
+     */
+    virtual unsigned long captureXrunCount(void) const { return 0; }
     
     /**
      * @brief 	Return the sample rate
@@ -370,7 +390,7 @@ class AudioDevice : public sigc::trackable
 
     Mode      	      	current_mode;
     size_t              use_count;
-    std::list<AudioIO*> aios;
+    std::vector<AudioIO*> aios;
     Async::Timer        reopen_timer  {1000, Async::Timer::TYPE_PERIODIC};
 
     void reopenDevice(void);
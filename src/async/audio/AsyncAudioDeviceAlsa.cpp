@@ -36,10 +36,19 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 
 #include <sigc++/sigc++.h>
 #include <poll.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <sched.h>
 #include <iostream>
 #include <sstream>
 #include <cmath>
 #include <cstring>
+#include <cerrno>
+#include <thread>
+#include <memory>
+#include <vector>
+#include <algorithm>
 
 
 /****************************************************************************
@@ -49,6 +58,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
  ****************************************************************************/
 
 #include <AsyncFdWatch.h>
+#include <AsyncThreadSched.h>
 
 
 /****************************************************************************
@@ -59,6 +69,8 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 
 #include "AsyncAudioDeviceAlsa.h"
 #include "AsyncAudioDeviceFactory.h"
+#include "AsyncAudioRingBuffer.h"
+#include "AsyncAudioSampleConv.h"
 
 
 
@@ -159,6 +171,431 @@ class AudioDeviceAlsa::AlsaWatch : public sigc::trackable
 };
 
 
+/**
+ * A real time thread servicing the Alsa PCM handles. Recorded samples are
+ * passed to the main loop and samples to play are fetched from the main loop
+ * through lock-free ring buffers. The main loop is notified through a pipe
+ * when there are recorded samples to handle or space to fill in the playback
+ * ring buffer. Nothing in the thread allocate memory or take a lock, except on
+ * error paths.
+ */
+class AudioDeviceAlsa::RtThread : public sigc::trackable
+{
+  public:
+    RtThread(AudioDeviceAlsa *dev, int prio) : dev(dev), prio(prio)
+    {
+      size_t main_buf_size = 0;
+      if (dev->play_handle != 0)
+      {
+        const size_t play_size =
+          dev->play_block_count * dev->play_block_size * channels;
+        play_ring.reset(new AudioRingBuffer<int16_t>(play_size));
+        play_buf.resize(play_size);
+        main_buf_size = play_size;
+      }
+      if (dev->rec_handle != 0)
+      {
+        const size_t rec_size =
+          dev->rec_block_count * dev->rec_block_size * channels;
+        rec_ring.reset(
+            new AudioRingBuffer<int16_t>(REC_RING_BUFFERS * rec_size));
+        rec_buf.resize(rec_size);
+        main_buf_size = std::max(main_buf_size, rec_ring->capacity());
+      }
+      main_buf.resize(main_buf_size);
+    }
+
+    ~RtThread(void)
+    {
+      if (thread.joinable())
+      {
+        stop = true;
+        wakeThread();
+        thread.join();
+      }
+      if (notify_watch.fd() >= 0)
+      {
+        notify_watch.setFd(-1, FdWatch::FD_WATCH_RD);
+      }
+      for (int fd : {wakeup_pipe[0], wakeup_pipe[1],
+                     notify_pipe[0], notify_pipe[1]})
+      {
+        if (fd >= 0)
+        {
+          ::close(fd);
+        }
+      }
+    }
+
+    bool start(void)
+    {
+      if ((pipe(wakeup_pipe) != 0) || (pipe(notify_pipe) != 0))
+      {
+        cerr << "*** ERROR: Could not create pipe for the Alsa audio thread: "
+             << strerror(errno) << endl;
+        return false;
+      }
+      for (int fd : {wakeup_pipe[0], wakeup_pipe[1],
+                     notify_pipe[0], notify_pipe[1]})
+      {
+        fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+      }
+      notify_watch.activity.connect(
+          mem_fun(*this, &RtThread::notificationReceived));
+      notify_watch.setFd(notify_pipe[0], FdWatch::FD_WATCH_RD);
+      notify_watch.setEnabled(true);
+
+      thread = std::thread(&RtThread::threadFunc, this);
+
+      sched_param param;
+      memset(&param, 0, sizeof(param));
+      param.sched_priority = prio;
+      int err = pthread_setschedparam(thread.native_handle(), SCHED_FIFO,
+                                      &param);
+      if (err != 0)
+      {
+        cerr << "*** WARNING: Could not set real time priority " << prio
+             << " for the audio thread of Alsa device " << dev->devName()
+             << ": " << strerror(err) << ". Running with normal priority."
+             << endl;
+      }
+      return true;
+    }
+
+    void requestPlaybackSamples(void)
+    {
+        // Fill the ring buffer from the main loop later, not from the function
+        // writing samples to the AudioIO object
+      notifyMain();
+    }
+
+    int samplesToWrite(void) const
+    {
+      if (play_ring == nullptr)
+      {
+        return 0;
+      }
+      return play_ring->available() / channels + play_delay;
+    }
+
+  private:
+      // The number of sound card buffers to store in the record ring buffer.
+      // This is how long the main loop can be blocked without losing audio.
+    static const size_t REC_RING_BUFFERS = 4;
+
+    AudioDeviceAlsa*                          dev;
+    int                                       prio;
+    std::unique_ptr<AudioRingBuffer<int16_t>> play_ring;
+    std::unique_ptr<AudioRingBuffer<int16_t>> rec_ring;
+    std::vector<int16_t>                      play_buf;
+    std::vector<int16_t>                      rec_buf;
+    std::vector<int16_t>                      main_buf;
+    std::thread                               thread;
+    std::atomic<bool>                         stop          {false};
+    std::atomic<bool>                         notified      {false};
+    std::atomic<bool>                         play_waiting  {false};
+    std::atomic<bool>                         dev_error     {false};
+    std::atomic<long>                         play_delay    {0};
+    int                                       wakeup_pipe[2] {-1, -1};
+    int                                       notify_pipe[2] {-1, -1};
+    FdWatch                                   notify_watch;
+
+    RtThread(const RtThread&);
+    RtThread& operator=(const RtThread&);
+
+    void wakeThread(void)
+    {
+      char ch = 0;
+      if (write(wakeup_pipe[1], &ch, 1) != 1)
+      {
+        cerr << "*** WARNING: Failed to wake up the Alsa audio thread: "
+             << strerror(errno) << endl;
+      }
+    }
+
+    void notifyMain(void)
+    {
+        // Only one byte is written to the pipe until the main loop have
+        // handled the notification
+      if (!notified.exchange(true))
+      {
+        char ch = 0;
+        if (write(notify_pipe[1], &ch, 1) != 1)
+        {
+          cerr << "*** WARNING: Failed to notify the main loop from the Alsa "
+                  "audio thread: " << strerror(errno) << endl;
+        }
+      }
+    }
+
+    void notificationReceived(FdWatch *watch)
+    {
+      char buf[64];
+      while (read(watch->fd(), buf, sizeof(buf)) > 0) {}
+      notified = false;
+
+      if (dev_error)
+      {
+        dev->setDeviceError();
+        return;
+      }
+
+      if (play_ring != nullptr)
+      {
+        fillPlayRing();
+      }
+
+      if (rec_ring != nullptr)
+      {
+          // This must be the last thing done since the device may be closed
+          // by the upper layers when handling the samples
+        const size_t cnt = rec_ring->read(&main_buf[0], main_buf.size());
+        if (cnt > 0)
+        {
+          dev->putBlocks(&main_buf[0], cnt / channels);
+        }
+      }
+    }
+
+    void fillPlayRing(void)
+    {
+      const size_t block_samples = dev->play_block_size * channels;
+      const size_t blocks = play_ring->space() / block_samples;
+      if (blocks == 0)
+      {
+        return;
+      }
+      const size_t blocks_avail = dev->getBlocks(&main_buf[0], blocks);
+      if (blocks_avail > 0)
+      {
+        play_ring->write(&main_buf[0], blocks_avail * block_samples);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (play_waiting.exchange(false))
+        {
+          wakeThread();
+        }
+      }
+    }
+
+    void threadFunc(void)
+    {
+      ThreadSched::Registration sched_reg("audio");
+
+        // The poll descriptors are stored in the order wakeup pipe, capture,
+        // playback so that playback can be left out when idle
+      std::vector<pollfd> pfds(1);
+      pfds[0].fd = wakeup_pipe[0];
+      pfds[0].events = POLLIN;
+      size_t rec_cnt = 0;
+      if (rec_ring != nullptr)
+      {
+        rec_cnt = snd_pcm_poll_descriptors_count(dev->rec_handle);
+        pfds.resize(1 + rec_cnt);
+        snd_pcm_poll_descriptors(dev->rec_handle, &pfds[1], rec_cnt);
+      }
+      size_t play_cnt = 0;
+      if (play_ring != nullptr)
+      {
+        play_cnt = snd_pcm_poll_descriptors_count(dev->play_handle);
+        pfds.resize(1 + rec_cnt + play_cnt);
+        snd_pcm_poll_descriptors(dev->play_handle, &pfds[1 + rec_cnt],
+                                 play_cnt);
+      }
+
+      bool play_active = true;
+      while (!stop)
+      {
+        const size_t nfds = 1 + rec_cnt + (play_active ? play_cnt : 0);
+        if (poll(&pfds[0], nfds, -1) < 0)
+        {
+          if (errno == EINTR)
+          {
+            continue;
+          }
+          break;
+        }
+
+        if (pfds[0].revents & POLLIN)
+        {
+          char buf[64];
+          while (read(wakeup_pipe[0], buf, sizeof(buf)) > 0) {}
+          play_active = true;
+        }
+
+        unsigned short revents = 0;
+        if ((rec_cnt > 0) &&
+            (snd_pcm_poll_descriptors_revents(dev->rec_handle, &pfds[1],
+                                              rec_cnt, &revents) == 0) &&
+            (revents & (POLLIN | POLLERR)) && !readCapture())
+        {
+          break;
+        }
+
+        revents = 0;
+        if (play_active && (play_cnt > 0) &&
+            (snd_pcm_poll_descriptors_revents(dev->play_handle,
+                                              &pfds[1 + rec_cnt], play_cnt,
+                                              &revents) == 0) &&
+            (revents & (POLLOUT | POLLERR)) && !writePlayback(play_active))
+        {
+          break;
+        }
+      }
+
+      if (!stop)
+      {
+        dev_error = true;
+        notifyMain();
+      }
+    }
+
+    bool readCapture(void)
+    {
+      snd_pcm_t *pcm = dev->rec_handle;
+      const auto pcm_state = snd_pcm_state(pcm);
+      if ((pcm_state < 0) || (pcm_state == SND_PCM_STATE_DISCONNECTED))
+      {
+        return false;
+      }
+
+      snd_pcm_sframes_t frames_avail = snd_pcm_avail_update(pcm);
+      if (frames_avail < 0)
+      {
+        if (frames_avail == -EPIPE)
+        {
+          dev->rec_xruns += 1;
+        }
+        return dev->startCapture(pcm);
+      }
+
+      size_t frames = std::min(static_cast<size_t>(frames_avail),
+                               rec_buf.size() / channels);
+      frames -= frames % dev->rec_block_size;
+      if (frames == 0)
+      {
+        return true;
+      }
+
+      const auto frames_read = dev->readFrames(&rec_buf[0], frames);
+      if (frames_read < 0)
+      {
+        if (frames_read == -EPIPE)
+        {
+          dev->rec_xruns += 1;
+        }
+        return dev->startCapture(pcm);
+      }
+
+        // If the main loop have not kept up, the samples are dropped
+      const size_t samples = frames_read * channels;
+      if (rec_ring->space() < samples)
+      {
+        dev->rec_xruns += 1;
+      }
+      else
+      {
+        rec_ring->write(&rec_buf[0], samples);
+      }
+      notifyMain();
+      return true;
+    }
+
+    bool writePlayback(bool& play_active)
+    {
+      snd_pcm_t *pcm = dev->play_handle;
+      const auto pcm_state = snd_pcm_state(pcm);
+      if ((pcm_state < 0) || (pcm_state == SND_PCM_STATE_DISCONNECTED))
+      {
+        return false;
+      }
+
+      const size_t block_size = dev->play_block_size;
+      const size_t block_samples = block_size * channels;
+      for (;;)
+      {
+        snd_pcm_sframes_t space_avail = snd_pcm_avail_update(pcm);
+        if (space_avail < 0)
+        {
+          if (space_avail == -EPIPE)
+          {
+            dev->play_xruns += 1;
+          }
+          if (!dev->startPlayback(pcm))
+          {
+            return false;
+          }
+          continue;
+        }
+
+        size_t blocks = static_cast<size_t>(space_avail) / block_size;
+        if (blocks == 0)
+        {
+          break;
+        }
+        blocks = std::min(blocks, play_ring->available() / block_samples);
+        bool zerofill = false;
+        if (blocks == 0)
+        {
+          if (!dev->zerofill_on_underflow)
+          {
+              // Stop polling until the main loop have written more samples.
+              // The ring buffer must be checked again after announcing that
+              // we are waiting since samples may have been written between
+              // the check above and setting the flag.
+            play_waiting = true;
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            if (play_ring->available() < block_samples)
+            {
+              play_active = false;
+              break;
+            }
+            play_waiting = false;
+            continue;
+          }
+            // Only write one block of zeros at a time to not build up a
+            // delay in the sound card buffer
+          memset(&play_buf[0], 0, block_samples * sizeof(play_buf[0]));
+          blocks = 1;
+          zerofill = true;
+        }
+        else
+        {
+          play_ring->read(&play_buf[0], blocks * block_samples);
+          notifyMain();
+        }
+
+        const snd_pcm_sframes_t frames_to_write = blocks * block_size;
+        const auto frames_written =
+          dev->writeFrames(&play_buf[0], frames_to_write);
+        if (frames_written < 0)
+        {
+          if (frames_written == -EPIPE)
+          {
+            dev->play_xruns += 1;
+          }
+          if (!dev->startPlayback(pcm))
+          {
+            return false;
+          }
+          continue;
+        }
+        if (zerofill || (frames_written != frames_to_write))
+        {
+          break;
+        }
+      }
+
+      const snd_pcm_sframes_t space_avail = snd_pcm_avail_update(pcm);
+      if (space_avail >= 0)
+      {
+        play_delay = static_cast<long>(
+            dev->play_block_count * block_size) - space_avail;
+      }
+      return true;
+    }
+};
+
+
 /****************************************************************************
  *
  * Prototypes
@@ -185,6 +622,52 @@ class AudioDeviceAlsa::AlsaWatch : public sigc::trackable
 REGISTER_AUDIO_DEVICE_TYPE("alsa", AudioDeviceAlsa);
 
 
+/****************************************************************************
+ *
+ * Local functions
+ *
+ ****************************************************************************/
+
+namespace {
+  void convertFromHw(int16_t *dst, const char *src, snd_pcm_format_t format,
+                     size_t cnt)
+  {
+    switch (format)
+    {
+      case SND_PCM_FORMAT_S32_LE:
+        AudioSampleConv::s32ToS16(dst, reinterpret_cast<const int32_t*>(src),
+                                  cnt);
+        break;
+      case SND_PCM_FORMAT_FLOAT_LE:
+        AudioSampleConv::floatToS16(dst, reinterpret_cast<const float*>(src),
+                                    cnt);
+        break;
+      default:
+        memcpy(dst, src, cnt * sizeof(*dst));
+        break;
+    }
+  } /* convertFromHw */
+
+
+  void convertToHw(char *dst, const int16_t *src, snd_pcm_format_t format,
+                   size_t cnt)
+  {
+    switch (format)
+    {
+      case SND_PCM_FORMAT_S32_LE:
+        AudioSampleConv::s16ToS32(reinterpret_cast<int32_t*>(dst), src, cnt);
+        break;
+      case SND_PCM_FORMAT_FLOAT_LE:
+        AudioSampleConv::s16ToFloat(reinterpret_cast<float*>(dst), src, cnt);
+        break;
+      default:
+        memcpy(dst, src, cnt * sizeof(*src));
+        break;
+    }
+  } /* convertToHw */
+}; /* End of anonymous namespace */
+
+
 /****************************************************************************
  *
  * Public member functions
@@ -195,7 +678,10 @@ AudioDeviceAlsa::AudioDeviceAlsa(const std::string& dev_name)
   : AudioDevice(dev_name), play_block_size(0), play_block_count(0),
     rec_block_size(0), rec_block_count(0), play_handle(0), 
     rec_handle(0), play_watch(0), rec_watch(0), duplex(false),
-    zerofill_on_underflow(true)
+    zerofill_on_underflow(true), use_mmap(false),
+    play_format(SND_PCM_FORMAT_S16_LE), rec_format(SND_PCM_FORMAT_S16_LE),
+    play_mmap(false), rec_mmap(false), rt_prio(0), rt_thread(0),
+    play_xruns(0), rec_xruns(0)
 {
   assert(AudioDeviceAlsa_creator_registered);
 
@@ -205,6 +691,26 @@ AudioDeviceAlsa::AudioDeviceAlsa(const std::string& dev_name)
     istringstream(zerofill_str) >> zerofill_on_underflow;
   }
 
+  char *mmap_str = getenv("ASYNC_AUDIO_ALSA_MMAP");
+  if (mmap_str != 0)
+  {
+    istringstream(mmap_str) >> use_mmap;
+  }
+
+  char *rt_prio_str = getenv("ASYNC_AUDIO_ALSA_RT_PRIO");
+  if (rt_prio_str != 0)
+  {
+    istringstream(rt_prio_str) >> rt_prio;
+    if ((rt_prio != 0) && ((rt_prio < sched_get_priority_min(SCHED_FIFO)) ||
+                           (rt_prio > sched_get_priority_max(SCHED_FIFO))))
+    {
+      cerr << "*** WARNING: Illegal value for ASYNC_AUDIO_ALSA_RT_PRIO ("
+           << rt_prio_str << "). The Alsa audio thread will not be used."
+           << endl;
+      rt_prio = 0;
+    }
+  }
+
   snd_pcm_t *play, *capture;
 
     // Open the device to check its duplex capability
@@ -254,6 +760,10 @@ bool AudioDeviceAlsa::isFullDuplexCapable(void)
 void AudioDeviceAlsa::audioToWriteAvailable(void)
 {
   //printf("AudioDeviceAlsa::audioToWriteAvailable\n");
+  if (rt_thread != 0)
+  {
+    rt_thread->requestPlaybackSamples();
+  }
   if (play_watch)
   {
     play_watch->setEnabled(true);
@@ -263,6 +773,10 @@ void AudioDeviceAlsa::audioToWriteAvailable(void)
 
 void AudioDeviceAlsa::flushSamples(void)
 {
+  if (rt_thread != 0)
+  {
+    rt_thread->requestPlaybackSamples();
+  }
   if (play_watch)
   {
     play_watch->setEnabled(true);
@@ -277,6 +791,11 @@ int AudioDeviceAlsa::samplesToWrite(void) const
     return 0;
   }
 
+  if (rt_thread != 0)
+  {
+    return rt_thread->samplesToWrite();
+  }
+
   int space_avail = snd_pcm_avail_update(play_handle);
   if (space_avail < 0)
   {
@@ -315,7 +834,7 @@ bool AudioDeviceAlsa::openDevice(Mode mode)
       return false;
     }
 
-    if (!initParams(play_handle))
+    if (!initParams(play_handle, play_format, play_mmap))
     {
       closeDevice();
       return false;
@@ -326,11 +845,20 @@ bool AudioDeviceAlsa::openDevice(Mode mode)
       closeDevice();
       return false;
     }
+    play_conv_buf.clear();
+    if (!play_mmap && (play_format != SND_PCM_FORMAT_S16_LE))
+    {
+      play_conv_buf.resize(play_block_count * play_block_size *
+                           snd_pcm_frames_to_bytes(play_handle, 1));
+    }
 
-    play_watch = new AlsaWatch(play_handle);
-    play_watch->activity.connect(
-            mem_fun(*this, &AudioDeviceAlsa::writeSpaceAvailable));
-    play_watch->setEnabled(true);
+    if (rt_prio == 0)
+    {
+      play_watch = new AlsaWatch(play_handle);
+      play_watch->activity.connect(
+              mem_fun(*this, &AudioDeviceAlsa::writeSpaceAvailable));
+      play_watch->setEnabled(true);
+    }
 
     if (!startPlayback(play_handle))
     {
@@ -352,7 +880,7 @@ bool AudioDeviceAlsa::openDevice(Mode mode)
       return false;
     }
 
-    if (!initParams(rec_handle))
+    if (!initParams(rec_handle, rec_format, rec_mmap))
     {
       closeDevice();
       return false;
@@ -363,10 +891,19 @@ bool AudioDeviceAlsa::openDevice(Mode mode)
       closeDevice();
       return false;
     }
+    rec_conv_buf.clear();
+    if (!rec_mmap && (rec_format != SND_PCM_FORMAT_S16_LE))
+    {
+      rec_conv_buf.resize(rec_block_count * rec_block_size *
+                          snd_pcm_frames_to_bytes(rec_handle, 1));
+    }
 
-    rec_watch = new AlsaWatch(rec_handle);
-    rec_watch->activity.connect(
-            mem_fun(*this, &AudioDeviceAlsa::audioReadHandler));
+    if (rt_prio == 0)
+    {
+      rec_watch = new AlsaWatch(rec_handle);
+      rec_watch->activity.connect(
+              mem_fun(*this, &AudioDeviceAlsa::audioReadHandler));
+    }
 
     if (!startCapture(rec_handle))
     {
@@ -376,6 +913,16 @@ bool AudioDeviceAlsa::openDevice(Mode mode)
     }
   }
 
+  if (rt_prio > 0)
+  {
+    rt_thread = new RtThread(this, rt_prio);
+    if (!rt_thread->start())
+    {
+      closeDevice();
+      return false;
+    }
+  }
+
   return true;
 
 } /* AudioDeviceAlsa::openDevice */
@@ -383,6 +930,9 @@ bool AudioDeviceAlsa::openDevice(Mode mode)
 
 void AudioDeviceAlsa::closeDevice(void)
 {
+  delete rt_thread;
+  rt_thread = 0;
+
   if (play_handle != 0)
   {
     snd_pcm_close(play_handle);
@@ -433,6 +983,10 @@ void AudioDeviceAlsa::audioReadHandler(FdWatch *watch, unsigned short revents)
   snd_pcm_sframes_t frames_avail = snd_pcm_avail_update(rec_handle);
   if (frames_avail < 0)
   {
+    if (frames_avail == -EPIPE)
+    {
+      rec_xruns += 1;
+    }
     if (!startCapture(rec_handle))
     {
       watch->setEnabled(false);
@@ -450,9 +1004,13 @@ void AudioDeviceAlsa::audioReadHandler(FdWatch *watch, unsigned short revents)
     int16_t buf[frames_avail * channels];
     memset(buf, 0, sizeof(buf));
 
-    const auto frames_read = snd_pcm_readi(rec_handle, buf, frames_avail);
+    const auto frames_read = readFrames(buf, frames_avail);
     if (frames_read < 0)
     {
+      if (frames_read == -EPIPE)
+      {
+        rec_xruns += 1;
+      }
       if (!startCapture(rec_handle))
       {
         setDeviceError();
@@ -495,6 +1053,10 @@ void AudioDeviceAlsa::writeSpaceAvailable(FdWatch *watch, unsigned short revents
       // Bail out if there's an error
     if (space_avail < 0)
     {
+      if (space_avail == -EPIPE)
+      {
+        play_xruns += 1;
+      }
       if (!startPlayback(play_handle))
       {
         setDeviceError();
@@ -529,12 +1091,16 @@ void AudioDeviceAlsa::writeSpaceAvailable(FdWatch *watch, unsigned short revents
     }
     
     int frames_to_write = blocks_avail * play_block_size;
-    int frames_written = snd_pcm_writei(play_handle, buf, frames_to_write);
+    int frames_written = writeFrames(buf, frames_to_write);
     //printf("frames_avail=%d  blocks_avail=%d  blocks_gotten=%d "
     //       "frames_written=%d\n", (int)frames_avail, blocks_avail,
     //       blocks_gotten, (int)frames_written);
     if (frames_written < 0)
     {
+      if (frames_written == -EPIPE)
+      {
+        play_xruns += 1;
+      }
       if (!startPlayback(play_handle))
       {
         setDeviceError();
@@ -561,7 +1127,8 @@ void AudioDeviceAlsa::writeSpaceAvailable(FdWatch *watch, unsigned short revents
 } /* AudioDeviceAlsa::writeSpaceAvailable */
 
 
-bool AudioDeviceAlsa::initParams(snd_pcm_t *pcm_handle)
+bool AudioDeviceAlsa::initParams(snd_pcm_t *pcm_handle,
+                                 snd_pcm_format_t &format, bool &mmap)
 {
   snd_pcm_hw_params_t* hw_params = nullptr;
 
@@ -584,8 +1151,12 @@ bool AudioDeviceAlsa::initParams(snd_pcm_t *pcm_handle)
     return false;
   }
 
+  mmap = use_mmap &&
+         (snd_pcm_hw_params_test_access(pcm_handle, hw_params,
+                                        SND_PCM_ACCESS_MMAP_INTERLEAVED) == 0);
   err = snd_pcm_hw_params_set_access(pcm_handle, hw_params,
-				     SND_PCM_ACCESS_RW_INTERLEAVED);
+                                     mmap ? SND_PCM_ACCESS_MMAP_INTERLEAVED
+                                          : SND_PCM_ACCESS_RW_INTERLEAVED);
   if (err < 0)
   {
     cerr << "*** ERROR: Set access type failed: "
@@ -595,8 +1166,21 @@ bool AudioDeviceAlsa::initParams(snd_pcm_t *pcm_handle)
     return false;
   }
 
-  err = snd_pcm_hw_params_set_format(pcm_handle, hw_params,
-				     SND_PCM_FORMAT_S16_LE);
+    // Use the first sample format, in order of preference, that the device
+    // support. The samples are converted to and from S16_LE internally.
+  static const snd_pcm_format_t formats[] = {
+    SND_PCM_FORMAT_S16_LE, SND_PCM_FORMAT_S32_LE, SND_PCM_FORMAT_FLOAT_LE
+  };
+  format = formats[0];
+  for (snd_pcm_format_t fmt : formats)
+  {
+    if (snd_pcm_hw_params_test_format(pcm_handle, hw_params, fmt) == 0)
+    {
+      format = fmt;
+      break;
+    }
+  }
+  err = snd_pcm_hw_params_set_format(pcm_handle, hw_params, format);
   if (err < 0)
   {
     cerr << "*** ERROR: Set sample format failed: "
@@ -737,6 +1321,132 @@ bool AudioDeviceAlsa::initParams(snd_pcm_t *pcm_handle)
 } /* AudioDeviceAlsa::initParams */
 
 
+snd_pcm_sframes_t AudioDeviceAlsa::readFrames(int16_t *buf, size_t frames)
+{
+  if (!rec_mmap)
+  {
+    if (rec_format == SND_PCM_FORMAT_S16_LE)
+    {
+      return snd_pcm_readi(rec_handle, buf, frames);
+    }
+    frames = std::min(frames, static_cast<size_t>(
+          snd_pcm_bytes_to_frames(rec_handle, rec_conv_buf.size())));
+    const auto frames_read = snd_pcm_readi(rec_handle, &rec_conv_buf[0],
+                                           frames);
+    if (frames_read > 0)
+    {
+      convertFromHw(buf, &rec_conv_buf[0], rec_format,
+                    frames_read * channels);
+    }
+    return frames_read;
+  }
+
+    // Convert the samples directly from the sound card buffer
+  snd_pcm_sframes_t frames_read = 0;
+  while (static_cast<size_t>(frames_read) < frames)
+  {
+    const snd_pcm_channel_area_t *areas;
+    snd_pcm_uframes_t offset;
+    snd_pcm_uframes_t cnt = frames - frames_read;
+    int err = snd_pcm_mmap_begin(rec_handle, &areas, &offset, &cnt);
+    if (err < 0)
+    {
+      return (frames_read > 0) ? frames_read : err;
+    }
+    if (cnt == 0)
+    {
+      break;
+    }
+    const char *src = static_cast<const char*>(areas[0].addr) +
+                      areas[0].first / 8 + offset * areas[0].step / 8;
+    convertFromHw(buf + frames_read * channels, src, rec_format,
+                  cnt * channels);
+    const auto committed = snd_pcm_mmap_commit(rec_handle, offset, cnt);
+    if (committed < 0)
+    {
+      return (frames_read > 0) ? frames_read : committed;
+    }
+    frames_read += committed;
+    if (static_cast<snd_pcm_uframes_t>(committed) != cnt)
+    {
+      break;
+    }
+  }
+  return frames_read;
+} /* AudioDeviceAlsa::readFrames */
+
+
+snd_pcm_sframes_t AudioDeviceAlsa::writeFrames(const int16_t *buf,
+                                               size_t frames)
+{
+  if (!play_mmap)
+  {
+    if (play_format == SND_PCM_FORMAT_S16_LE)
+    {
+      return snd_pcm_writei(play_handle, buf, frames);
+    }
+    frames = std::min(frames, static_cast<size_t>(
+          snd_pcm_bytes_to_frames(play_handle, play_conv_buf.size())));
+    convertToHw(&play_conv_buf[0], buf, play_format, frames * channels);
+    return snd_pcm_writei(play_handle, &play_conv_buf[0], frames);
+  }
+
+    // Convert the samples directly into the sound card buffer
+  snd_pcm_sframes_t frames_written = 0;
+  while (static_cast<size_t>(frames_written) < frames)
+  {
+    const snd_pcm_channel_area_t *areas;
+    snd_pcm_uframes_t offset;
+    snd_pcm_uframes_t cnt = frames - frames_written;
+    int err = snd_pcm_mmap_begin(play_handle, &areas, &offset, &cnt);
+    if (err < 0)
+    {
+      return (frames_written > 0) ? frames_written : err;
+    }
+    if (cnt == 0)
+    {
+      break;
+    }
+    char *dst = static_cast<char*>(areas[0].addr) +
+                areas[0].first / 8 + offset * areas[0].step / 8;
+    convertToHw(dst, buf + frames_written * channels, play_format,
+                cnt * channels);
+    const auto committed = snd_pcm_mmap_commit(play_handle, offset, cnt);
+    if (committed < 0)
+    {
+      return (frames_written > 0) ? frames_written : committed;
+    }
+    frames_written += committed;
+    if (static_cast<snd_pcm_uframes_t>(committed) != cnt)
+    {
+      break;
+    }
+  }
+
+    // Unlike snd_pcm_writei, a mmap commit does not start the stream so
+    // that have to be done here when the start threshold is reached
+  if ((snd_pcm_state(play_handle) == SND_PCM_STATE_PREPARED) &&
+      (frames_written > 0))
+  {
+    const snd_pcm_sframes_t space_avail = snd_pcm_avail_update(play_handle);
+    const snd_pcm_sframes_t filled =
+      static_cast<snd_pcm_sframes_t>(play_block_count * play_block_size) -
+      space_avail;
+    if ((space_avail >= 0) &&
+        (filled >= static_cast<snd_pcm_sframes_t>(
+                      (play_block_count - 1) * play_block_size)))
+    {
+      int err = snd_pcm_start(play_handle);
+      if (err < 0)
+      {
+        return err;
+      }
+    }
+  }
+  return frames_written;
+} /* AudioDeviceAlsa::writeFrames */
+
+
 bool AudioDeviceAlsa::getBlockAttributes(snd_pcm_t *pcm_handle,
                                          size_t &block_size,
                                          size_t &block_count)
@@ -37,6 +37,8 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
  ****************************************************************************/
 
 #include <alsa/asoundlib.h>
+#include <atomic>
+#include <vector>
 
 
 /****************************************************************************
@@ -113,6 +115,21 @@ This class implements the low level interface to an Alsa audio device. This
 class is not intended to be used by the end user of the Async library. It is
 used by the Async::AudioIO class, which is the Async API frontend for using
 audio in an application.
+
+Normally the Alsa device is serviced directly from the main loop. If the
+environment variable ASYNC_AUDIO_ALSA_RT_PRIO is set to a value between 1 and
+99, a separate real time (SCHED_FIFO) thread with that priority is used
+instead. The thread exchange blocks of samples with the main loop through
+lock-free ring buffers so that audio keeps flowing to and from the sound card
+even if the main loop is busy for a while. The price to pay is that the
+playback delay is increased by one sound card buffer.
+
+The sample format S16_LE is used if the sound card support it. Otherwise
+S32_LE or FLOAT_LE is used and the samples are converted in batches when read
+from or written to the sound card. If the environment variable
+ASYNC_AUDIO_ALSA_MMAP is set to 1, the mmap access mode is used if the device
+support it. The samples are then converted or copied directly to and from the
+sound card buffer, without first going through an intermediate buffer.
 */
 class AudioDeviceAlsa : public AudioDevice
 {
@@ -169,6 +186,21 @@ class AudioDeviceAlsa : public AudioDevice
      * been flushed.
      */
     virtual int samplesToWrite(void) const;
+
+    /**
+     * @brief   Get the number of playback buffer underruns
+     * @return  Returns the number of underruns since the device was created
+     */
+    virtual unsigned long playbackXrunCount(void) const { return play_xruns; }
+
+    /**
+     * @brief   Get the number of capture buffer overruns
+     * @return  Returns the number of overruns since the device was created
+     *
+     * When using the real time thread, samples that are lost because the
+     * main loop did not read them in time are also counted as overruns.
+     */
+    virtual unsigned long captureXrunCount(void) const { return rec_xruns; }
     
     
   protected:
@@ -187,6 +219,7 @@ class AudioDeviceAlsa : public AudioDevice
 
   private:
     class       AlsaWatch;
+    class       RtThread;
     size_t      play_block_size;
     size_t      play_block_count;
     size_t      rec_block_size;
@@ -197,12 +230,26 @@ class AudioDeviceAlsa : public AudioDevice
     AlsaWatch   *rec_watch;
     bool        duplex;
     bool        zerofill_on_underflow;
+    bool        use_mmap;
+    snd_pcm_format_t play_format;
+    snd_pcm_format_t rec_format;
+    bool        play_mmap;
+    bool        rec_mmap;
+    std::vector<char> play_conv_buf;
+    std::vector<char> rec_conv_buf;
+    int         rt_prio;
+    RtThread    *rt_thread;
+    std::atomic<unsigned long> play_xruns;
+    std::atomic<unsigned long> rec_xruns;
 
     AudioDeviceAlsa(const AudioDeviceAlsa&);
     AudioDeviceAlsa& operator=(const AudioDeviceAlsa&);
     void audioReadHandler(FdWatch *watch, unsigned short revents);
     void writeSpaceAvailable(FdWatch *watch, unsigned short revents);
-    bool initParams(snd_pcm_t *pcm_handle);
+    bool initParams(snd_pcm_t *pcm_handle, snd_pcm_format_t &format,
+                    bool &mmap);
+    snd_pcm_sframes_t readFrames(int16_t *buf, size_t frames);
+    snd_pcm_sframes_t writeFrames(const int16_t *buf, size_t frames);
     bool getBlockAttributes(snd_pcm_t *pcm_handle, size_t &block_size,
                             size_t &period_size);
     bool startPlayback(snd_pcm_t *pcm_handle);
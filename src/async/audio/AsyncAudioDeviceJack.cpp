@@ -0,0 +1,575 @@
+/**
+@file	 AsyncAudioDeviceJack.cpp
+@brief   Handle audio through the JACK audio connection kit
+@author  Tobias Blomberg / SM0SVX
+@date	 2026-10-14
+
+Implements an audio device that is a client to a JACK server. PipeWire
+provide a JACK compatible library so this device can also be used to connect
+directly to a PipeWire server.
+
+\verbatim
+Async - A library for programming event driven applications
+Copyright (C) 2003-2026 Tobias Blomberg / SM0SVX
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+\endverbatim
+*/
+
+
+
+/****************************************************************************
+ *
+ * System Includes
+ *
+ ****************************************************************************/
+
+#include <unistd.h>
+#include <fcntl.h>
+
+#include <cassert>
+#include <cstring>
+#include <cstdlib>
+#include <cerrno>
+#include <cmath>
+#include <iostream>
+#include <sstream>
+#include <algorithm>
+
+
+
+/****************************************************************************
+ *
+ * Project Includes
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Local Includes
+ *
+ ****************************************************************************/
+
+#include "AsyncAudioDeviceJack.h"
+#include "AsyncAudioDeviceFactory.h"
+
+
+
+/****************************************************************************
+ *
+ * Namespaces to use
+ *
+ ****************************************************************************/
+
+using namespace std;
+using namespace Async;
+
+
+/****************************************************************************
+ *
+ * Defines & typedefs
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Local class definitions
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Prototypes
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Exported Global Variables
+ *
+ ****************************************************************************/
+
+
+
+
+/****************************************************************************
+ *
+ * Local Global Variables
+ *
+ ****************************************************************************/
+
+REGISTER_AUDIO_DEVICE_TYPE("jack", AudioDeviceJack);
+
+
+
+/****************************************************************************
+ *
+ * Public member functions
+ *
+ ****************************************************************************/
+
+size_t AudioDeviceJack::readBlocksize(void)
+{
+  return block_size;
+} /* AudioDeviceJack::readBlocksize */
+
+
+size_t AudioDeviceJack::writeBlocksize(void)
+{
+  return block_size;
+} /* AudioDeviceJack::writeBlocksize */
+
+
+bool AudioDeviceJack::isFullDuplexCapable(void)
+{
+  return true;
+} /* AudioDeviceJack::isFullDuplexCapable */
+
+
+void AudioDeviceJack::audioToWriteAvailable(void)
+{
+    // Fill the ring buffer from the main loop later, not from the function
+    // writing samples to the AudioIO object
+  play_idle = false;
+  notifyMain();
+} /* AudioDeviceJack::audioToWriteAvailable */
+
+
+void AudioDeviceJack::flushSamples(void)
+{
+  play_idle = false;
+  notifyMain();
+} /* AudioDeviceJack::flushSamples */
+
+
+int AudioDeviceJack::samplesToWrite(void) const
+{
+  if (play_ring == nullptr)
+  {
+    return 0;
+  }
+  return play_ring->available() / channels + period_size;
+} /* AudioDeviceJack::samplesToWrite */
+
+
+
+/****************************************************************************
+ *
+ * Protected member functions
+ *
+ ****************************************************************************/
+
+
+AudioDeviceJack::AudioDeviceJack(const string& dev_name)
+  : AudioDevice(dev_name), client(0), period_size(0),
+    block_size(block_size_hint), notified(false), play_idle(true),
+    dev_error(false), play_xrun_cnt(0), rec_xrun_cnt(0)
+{
+  assert(AudioDeviceJack_creator_registered);
+  notify_pipe[0] = notify_pipe[1] = -1;
+  notify_watch.activity.connect(
+      mem_fun(*this, &AudioDeviceJack::notificationReceived));
+} /* AudioDeviceJack::AudioDeviceJack */
+
+
+AudioDeviceJack::~AudioDeviceJack(void)
+{
+  closeDevice();
+} /* AudioDeviceJack::~AudioDeviceJack */
+
+
+bool AudioDeviceJack::openDevice(Mode mode)
+{
+  closeDevice();
+
+  if (mode == MODE_NONE)
+  {
+    return true;
+  }
+
+  const string &client_name = devName();
+  if (client_name.empty())
+  {
+    cerr << "*** ERROR: Illegal JACK audio device specification ("
+         << devName() << "). Should be jack:client_name\n";
+    return false;
+  }
+
+  jack_status_t status;
+  client = jack_client_open(client_name.c_str(), JackNoStartServer, &status);
+  if (client == 0)
+  {
+    cerr << "*** ERROR: Could not connect to the JACK server for audio device "
+         << devName() << " (status=0x" << hex << status << dec << ")\n";
+    return false;
+  }
+
+  const jack_nframes_t server_rate = jack_get_sample_rate(client);
+  if (server_rate != static_cast<jack_nframes_t>(sampleRate()))
+  {
+    cerr << "*** ERROR: The JACK server run at " << server_rate
+         << "Hz but the audio device " << devName() << " should run at "
+         << sampleRate() << "Hz\n";
+    closeDevice();
+    return false;
+  }
+
+  for (size_t ch=0; ch<channels; ++ch)
+  {
+    if ((mode == MODE_RD) || (mode == MODE_RDWR))
+    {
+      ostringstream ss;
+      ss << "capture_" << (ch + 1);
+      jack_port_t *port = jack_port_register(client, ss.str().c_str(),
+                                             JACK_DEFAULT_AUDIO_TYPE,
+                                             JackPortIsInput, 0);
+      if (port == 0)
+      {
+        cerr << "*** ERROR: Could not register JACK port " << ss.str()
+             << " for audio device " << devName() << endl;
+        closeDevice();
+        return false;
+      }
+      in_ports.push_back(port);
+    }
+    if ((mode == MODE_WR) || (mode == MODE_RDWR))
+    {
+      ostringstream ss;
+      ss << "playback_" << (ch + 1);
+      jack_port_t *port = jack_port_register(client, ss.str().c_str(),
+                                             JACK_DEFAULT_AUDIO_TYPE,
+                                             JackPortIsOutput, 0);
+      if (port == 0)
+      {
+        cerr << "*** ERROR: Could not register JACK port " << ss.str()
+             << " for audio device " << devName() << endl;
+        closeDevice();
+        return false;
+      }
+      out_ports.push_back(port);
+    }
+  }
+
+  if (!in_ports.empty())
+  {
+    rec_ring.reset(new AudioRingBuffer<int16_t>(RING_FRAMES * channels));
+  }
+  if (!out_ports.empty())
+  {
+    play_ring.reset(new AudioRingBuffer<int16_t>(RING_FRAMES * channels));
+  }
+  rt_buf.resize(CHUNK_FRAMES * channels);
+  main_buf.resize(RING_FRAMES * channels);
+
+  period_size = jack_get_buffer_size(client);
+  block_size = std::min(period_size.load(), RING_FRAMES / PLAY_PERIODS);
+
+  if ((pipe(notify_pipe) != 0) ||
+      (fcntl(notify_pipe[0], F_SETFL, O_NONBLOCK) == -1) ||
+      (fcntl(notify_pipe[1], F_SETFL, O_NONBLOCK) == -1))
+  {
+    cerr << "*** ERROR: Could not create pipe for the JACK audio device "
+         << devName() << ": " << strerror(errno) << endl;
+    closeDevice();
+    return false;
+  }
+  notify_watch.setFd(notify_pipe[0], FdWatch::FD_WATCH_RD);
+  notify_watch.setEnabled(true);
+
+  jack_set_process_callback(client, processCallback, this);
+  jack_set_buffer_size_callback(client, bufferSizeCallback, this);
+  jack_on_shutdown(client, shutdownCallback, this);
+  if (jack_activate(client) != 0)
+  {
+    cerr << "*** ERROR: Could not activate JACK client for audio device "
+         << devName() << endl;
+    closeDevice();
+    return false;
+  }
+
+  const char *autoconnect_str = std::getenv("ASYNC_AUDIO_JACK_AUTOCONNECT");
+  bool autoconnect = true;
+  if (autoconnect_str != 0)
+  {
+    std::istringstream(autoconnect_str) >> autoconnect;
+  }
+  if (autoconnect)
+  {
+    connectPorts();
+  }
+
+  return true;
+
+} /* AudioDeviceJack::openDevice */
+
+
+void AudioDeviceJack::closeDevice(void)
+{
+  if (client != 0)
+  {
+    jack_deactivate(client);
+    jack_client_close(client);
+    client = 0;
+  }
+  in_ports.clear();
+  out_ports.clear();
+  rec_ring.reset();
+  play_ring.reset();
+
+  if (notify_watch.fd() >= 0)
+  {
+    notify_watch.setFd(-1, FdWatch::FD_WATCH_RD);
+  }
+  for (int i=0; i<2; ++i)
+  {
+    if (notify_pipe[i] >= 0)
+    {
+      ::close(notify_pipe[i]);
+      notify_pipe[i] = -1;
+    }
+  }
+  notified = false;
+  play_idle = true;
+  dev_error = false;
+} /* AudioDeviceJack::closeDevice */
+
+
+
+/****************************************************************************
+ *
+ * Private member functions
+ *
+ ****************************************************************************/
+
+int AudioDeviceJack::processCallback(jack_nframes_t nframes, void *arg)
+{
+  static_cast<AudioDeviceJack*>(arg)->process(nframes);
+  return 0;
+} /* AudioDeviceJack::processCallback */
+
+
+int AudioDeviceJack::bufferSizeCallback(jack_nframes_t nframes, void *arg)
+{
+    // The new period size is picked up by the main loop on the next
+    // notification
+  AudioDeviceJack *dev = static_cast<AudioDeviceJack*>(arg);
+  dev->period_size = nframes;
+  dev->notifyMain();
+  return 0;
+} /* AudioDeviceJack::bufferSizeCallback */
+
+
+void AudioDeviceJack::shutdownCallback(void *arg)
+{
+  AudioDeviceJack *dev = static_cast<AudioDeviceJack*>(arg);
+  dev->dev_error = true;
+  dev->notifyMain();
+} /* AudioDeviceJack::shutdownCallback */
+
+
+void AudioDeviceJack::process(jack_nframes_t nframes)
+{
+    // This function is called in the JACK real time thread so nothing here
+    // may allocate memory or take a lock
+  const size_t in_cnt = in_ports.size();
+  const size_t out_cnt = out_ports.size();
+  jack_default_audio_sample_t *in_bufs[in_cnt];
+  jack_default_audio_sample_t *out_bufs[out_cnt];
+  for (size_t ch=0; ch<in_cnt; ++ch)
+  {
+    in_bufs[ch] = static_cast<jack_default_audio_sample_t*>(
+        jack_port_get_buffer(in_ports[ch], nframes));
+  }
+  for (size_t ch=0; ch<out_cnt; ++ch)
+  {
+    out_bufs[ch] = static_cast<jack_default_audio_sample_t*>(
+        jack_port_get_buffer(out_ports[ch], nframes));
+  }
+
+  bool notify = false;
+  for (size_t pos=0; pos<nframes; pos+=CHUNK_FRAMES)
+  {
+    const size_t frames = std::min(size_t(nframes) - pos, CHUNK_FRAMES);
+
+    if (rec_ring != nullptr)
+    {
+      for (size_t i=0; i<frames; ++i)
+      {
+        for (size_t ch=0; ch<in_cnt; ++ch)
+        {
+          float sample = in_bufs[ch][pos + i] * 32767.0f;
+          sample = std::max(-32768.0f, std::min(32767.0f, sample));
+          rt_buf[i * channels + ch] = static_cast<int16_t>(lrintf(sample));
+        }
+      }
+      if (rec_ring->write(&rt_buf[0], frames * channels) < frames * channels)
+      {
+        ++rec_xrun_cnt;
+      }
+      notify = true;
+    }
+
+    if (play_ring != nullptr)
+    {
+      const size_t cnt =
+        play_ring->read(&rt_buf[0], frames * channels) / channels;
+      if ((cnt > 0) && (cnt < frames))
+      {
+        ++play_xrun_cnt;
+      }
+      for (size_t ch=0; ch<out_cnt; ++ch)
+      {
+        for (size_t i=0; i<cnt; ++i)
+        {
+          out_bufs[ch][pos + i] = rt_buf[i * channels + ch] / 32768.0f;
+        }
+        for (size_t i=cnt; i<frames; ++i)
+        {
+          out_bufs[ch][pos + i] = 0.0f;
+        }
+      }
+      notify |= !play_idle;
+    }
+  }
+
+  if (notify)
+  {
+    notifyMain();
+  }
+} /* AudioDeviceJack::process */
+
+
+void AudioDeviceJack::notifyMain(void)
+{
+    // Only one byte is written to the pipe until the main loop have handled
+    // the notification
+  if ((notify_pipe[1] >= 0) && !notified.exchange(true))
+  {
+    const char ch = 0;
+    if (write(notify_pipe[1], &ch, 1) != 1)
+    {
+      notified = false;
+    }
+  }
+} /* AudioDeviceJack::notifyMain */
+
+
+void AudioDeviceJack::notificationReceived(FdWatch *watch)
+{
+  char buf[64];
+  while (read(watch->fd(), buf, sizeof(buf)) > 0) {}
+  notified = false;
+
+  if (dev_error)
+  {
+    setDeviceError();
+    return;
+  }
+
+  block_size = std::min(period_size.load(), RING_FRAMES / PLAY_PERIODS);
+
+  if (play_ring != nullptr)
+  {
+    fillPlayRing();
+  }
+
+  if (rec_ring != nullptr)
+  {
+      // This must be the last thing done since the device may be closed
+      // by the upper layers when handling the samples
+    const size_t cnt = rec_ring->read(&main_buf[0], main_buf.size());
+    if (cnt > 0)
+    {
+      putBlocks(&main_buf[0], cnt / channels);
+    }
+  }
+} /* AudioDeviceJack::notificationReceived */
+
+
+void AudioDeviceJack::fillPlayRing(void)
+{
+    // Only keep a few periods in the ring buffer to keep the latency low
+  const size_t block_samples = block_size * channels;
+  const size_t target = PLAY_PERIODS * block_samples;
+  const size_t avail = play_ring->available();
+  if (avail >= target)
+  {
+    return;
+  }
+  const size_t blocks = (target - avail) / block_samples;
+  if (blocks == 0)
+  {
+    return;
+  }
+  const size_t blocks_avail = getBlocks(&main_buf[0], blocks);
+  if (blocks_avail > 0)
+  {
+    play_ring->write(&main_buf[0], blocks_avail * block_samples);
+  }
+
+    // The real time thread stop asking for more samples until the upper
+    // layers tell us that there are samples to write
+  play_idle = (blocks_avail == 0);
+} /* AudioDeviceJack::fillPlayRing */
+
+
+void AudioDeviceJack::connectPorts(void)
+{
+  const char **ports = jack_get_ports(client, NULL, JACK_DEFAULT_AUDIO_TYPE,
+                                      JackPortIsPhysical|JackPortIsOutput);
+  for (size_t ch=0; (ports != 0) && (ch<in_ports.size()); ++ch)
+  {
+    if (ports[ch] == 0)
+    {
+      break;
+    }
+    if (jack_connect(client, ports[ch], jack_port_name(in_ports[ch])) != 0)
+    {
+      cerr << "*** WARNING: Could not connect JACK port " << ports[ch]
+           << " to " << jack_port_name(in_ports[ch]) << endl;
+    }
+  }
+  jack_free(ports);
+
+  ports = jack_get_ports(client, NULL, JACK_DEFAULT_AUDIO_TYPE,
+                         JackPortIsPhysical|JackPortIsInput);
+  for (size_t ch=0; (ports != 0) && (ch<out_ports.size()); ++ch)
+  {
+    if (ports[ch] == 0)
+    {
+      break;
+    }
+    if (jack_connect(client, jack_port_name(out_ports[ch]), ports[ch]) != 0)
+    {
+      cerr << "*** WARNING: Could not connect JACK port "
+           << jack_port_name(out_ports[ch]) << " to " << ports[ch] << endl;
+    }
+  }
+  jack_free(ports);
+} /* AudioDeviceJack::connectPorts */
+
+
+
+/*
+ * This file has not been truncated
+ */
@@ -0,0 +1,272 @@
+/**
+@file	 AsyncAudioDeviceJack.h
+@brief   Handle audio through the JACK audio connection kit
+@author  Tobias Blomberg / SM0SVX
+@date	 2026-10-14
+
+Implements an audio device that is a client to a JACK server. PipeWire
+provide a JACK compatible library so this device can also be used to connect
+directly to a PipeWire server.
+
+\verbatim
+Async - A library for programming event driven applications
+Copyright (C) 2003-2026 Tobias Blomberg / SM0SVX
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+\endverbatim
+*/
+
+
+#ifndef ASYNC_AUDIO_DEVICE_JACK_INCLUDED
+#define ASYNC_AUDIO_DEVICE_JACK_INCLUDED
+
+
+/****************************************************************************
+ *
+ * System Includes
+ *
+ ****************************************************************************/
+
+#include <jack/jack.h>
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <atomic>
+
+
+/****************************************************************************
+ *
+ * Project Includes
+ *
+ ****************************************************************************/
+
+#include <AsyncFdWatch.h>
+
+
+/****************************************************************************
+ *
+ * Local Includes
+ *
+ ****************************************************************************/
+
+#include "AsyncAudioDevice.h"
+#include "AsyncAudioRingBuffer.h"
+
+
+/****************************************************************************
+ *
+ * Forward declarations
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Namespace
+ *
+ ****************************************************************************/
+
+namespace Async
+{
+
+
+/****************************************************************************
+ *
+ * Forward declarations of classes inside of the declared namespace
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Defines & typedefs
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Exported Global Variables
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Class definitions
+ *
+ ****************************************************************************/
+
+/**
+@brief	An audio device that is a client to a JACK server
+@author Tobias Blomberg / SM0SVX
+@date   2026-10-14
+
+This class implements an audio device that connect to a JACK server, or a
+PipeWire server through its JACK compatible library. The device is specified
+as "jack:client_name". One input port and one output port per channel is
+registered for the client. Unless the environment variable
+ASYNC_AUDIO_JACK_AUTOCONNECT is set to 0, the ports are connected to the
+physical ports of the server when the device is opened.
+
+The samples are moved by the JACK process callback, which run in a real time
+thread, through lock-free ring buffers to and from the main loop. The block
+size used is the period size (quantum) of the server and the playback ring
+buffer is kept at most PLAY_PERIODS periods full so the added latency is
+small.
+*/
+class AudioDeviceJack : public Async::AudioDevice
+{
+  public:
+    /**
+     * @brief 	Constuctor
+     * @param 	dev_name  The name of the device to associate this object with
+     */
+    explicit AudioDeviceJack(const std::string& dev_name);
+
+    /**
+     * @brief 	Destructor
+     */
+    ~AudioDeviceJack(void);
+
+    /**
+     * @brief 	Find out what the read (recording) blocksize is set to
+     * @return	Returns the currently set blocksize in samples per channel
+     */
+    virtual size_t readBlocksize(void);
+
+    /**
+     * @brief 	Find out what the write (playback) blocksize is set to
+     * @return	Returns the currently set blocksize in samples per channel
+     */
+    virtual size_t writeBlocksize(void);
+
+    /**
+     * @brief 	Check if the audio device has full duplex capability
+     * @return	Returns \em true if the device has full duplex capability
+     *	      	or else \em false
+     */
+    virtual bool isFullDuplexCapable(void);
+
+    /**
+     * @brief 	Tell the audio device handler that there are audio to be
+     *	      	written in the buffer
+     */
+    virtual void audioToWriteAvailable(void);
+
+    /**
+     * @brief	Tell the audio device to flush its buffers
+     */
+    virtual void flushSamples(void);
+
+    /**
+     * @brief 	Find out how many samples there are in the output buffer
+     * @return	Returns the number of samples in the output buffer on
+     *          success or -1 on failure.
+     *
+     * This function can be used to find out how many samples there are
+     * in the output buffer at the moment. This can for example be used
+     * to find out how long it will take before the output buffer has
+     * been flushed.
+     */
+    virtual int samplesToWrite(void) const;
+
+    /**
+     * @brief   Find out how many playback underruns that have occurred
+     * @return  Returns the number of playback underruns
+     */
+    virtual unsigned long playbackXrunCount(void) const
+    {
+      return play_xrun_cnt;
+    }
+
+    /**
+     * @brief   Find out how many capture overruns that have occurred
+     * @return  Returns the number of capture overruns
+     */
+    virtual unsigned long captureXrunCount(void) const
+    {
+      return rec_xrun_cnt;
+    }
+
+  protected:
+    /**
+     * @brief 	Open the audio device
+     * @param 	mode The mode to open the audio device in (See AudioIO::Mode)
+     * @return	Returns \em true on success or else \em false
+     */
+    virtual bool openDevice(Mode mode);
+
+    /**
+     * @brief 	Close the audio device
+     */
+    virtual void closeDevice(void);
+
+  private:
+      // The maximum number of periods to keep in the playback ring buffer
+    static const size_t PLAY_PERIODS  = 2;
+      // The size of the ring buffers in frames
+    static const size_t RING_FRAMES   = 8192;
+      // The maximum number of frames handled in one go by the process
+      // callback. Larger periods are handled in chunks.
+    static const size_t CHUNK_FRAMES  = 1024;
+
+    typedef std::unique_ptr<AudioRingBuffer<int16_t>> RingPtr;
+
+    jack_client_t*              client;
+    std::vector<jack_port_t*>   in_ports;
+    std::vector<jack_port_t*>   out_ports;
+    RingPtr                     rec_ring;
+    RingPtr                     play_ring;
+    std::vector<int16_t>        rt_buf;
+    std::vector<int16_t>        main_buf;
+    std::atomic<size_t>         period_size;
+    size_t                      block_size;
+    std::atomic<bool>           notified;
+    std::atomic<bool>           play_idle;
+    std::atomic<bool>           dev_error;
+    std::atomic<unsigned long>  play_xrun_cnt;
+    std::atomic<unsigned long>  rec_xrun_cnt;
+    int                         notify_pipe[2];
+    FdWatch                     notify_watch;
+
+    AudioDeviceJack(const AudioDeviceJack&);
+    AudioDeviceJack& operator=(const AudioDeviceJack&);
+    static int processCallback(jack_nframes_t nframes, void *arg);
+    static int bufferSizeCallback(jack_nframes_t nframes, void *arg);
+    static void shutdownCallback(void *arg);
+    void process(jack_nframes_t nframes);
+    void notifyMain(void);
+    void notificationReceived(FdWatch *watch);
+    void fillPlayRing(void);
+    void connectPorts(void);
+
+};  /* class AudioDeviceJack */
+
+
+} /* namespace */
+
+#endif /* ASYNC_AUDIO_DEVICE_JACK_INCLUDED */
+
+
+
+/*
+ * This file has not been truncated
+ */
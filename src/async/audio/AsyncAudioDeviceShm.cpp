@@ -0,0 +1,588 @@
+/**
+@file	 AsyncAudioDeviceShm.cpp
+@brief   Stream audio samples to/from other processes via shared memory
+@author  Tobias Blomberg / SM0SVX
+@date    2026-10-14
+
+Implements an "audio interface" that stream samples through a ring buffer in
+POSIX shared memory. This is used to move audio between processes on the same
+host without the overhead of a UDP socket.
+
+\verbatim
+Async - A library for programming event driven applications
+Copyright (C) 2003-2026 Tobias Blomberg / SM0SVX
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+\endverbatim
+*/
+
+
+
+/****************************************************************************
+ *
+ * System Includes
+ *
+ ****************************************************************************/
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <linux/futex.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <errno.h>
+
+#include <cassert>
+#include <cstring>
+#include <climits>
+#include <iostream>
+#include <algorithm>
+
+
+
+/****************************************************************************
+ *
+ * Project Includes
+ *
+ ****************************************************************************/
+
+#include <AsyncFdWatch.h>
+#include <AsyncThreadSched.h>
+
+
+/****************************************************************************
+ *
+ * Local Includes
+ *
+ ****************************************************************************/
+
+#include "AsyncAudioDeviceShm.h"
+#include "AsyncAudioDeviceFactory.h"
+
+
+
+/****************************************************************************
+ *
+ * Namespaces to use
+ *
+ ****************************************************************************/
+
+using namespace std;
+using namespace Async;
+
+
+/****************************************************************************
+ *
+ * Defines & typedefs
+ *
+ ****************************************************************************/
+
+static_assert(ATOMIC_INT_LOCK_FREE == 2,
+              "Lock free atomics are needed for shared memory audio");
+
+
+/****************************************************************************
+ *
+ * Local class definitions
+ *
+ ****************************************************************************/
+
+/**
+ * A ring buffer in a shared memory object. The layout of the shared memory
+ * is a fixed size header followed by RING_FRAMES frames of interleaved 16 bit
+ * samples. The read and write positions are free running counters so the
+ * number of frames in the ring is always write_pos - read_pos.
+ */
+struct AudioDeviceShm::Ring
+{
+  static const uint32_t MAGIC       = 0x53564141;
+  static const uint32_t VERSION     = 1;
+  static const size_t   HEADER_SIZE = 64;
+
+  struct Header
+  {
+    std::atomic<uint32_t> magic;
+    uint32_t              version;
+    uint32_t              channels;
+    uint32_t              sample_rate;
+    uint32_t              frames;
+    std::atomic<uint32_t> write_pos;
+    std::atomic<uint32_t> read_pos;
+    std::atomic<uint32_t> seq;
+    std::atomic<uint32_t> waiting;
+  };
+
+  std::string name;
+  size_t      map_size  = 0;
+  void*       map       = MAP_FAILED;
+  Header*     hdr       = nullptr;
+  int16_t*    data      = nullptr;
+
+  ~Ring(void)
+  {
+    if (map != MAP_FAILED)
+    {
+      munmap(map, map_size);
+    }
+  }
+
+  bool open(const std::string& ring_name, size_t channels, int sample_rate)
+  {
+    static_assert(sizeof(Header) <= HEADER_SIZE, "Ring header too big");
+    name = "/svxlink-audio-" + ring_name;
+    map_size = HEADER_SIZE + RING_FRAMES * channels * sizeof(int16_t);
+
+      // Try to create the shared memory object. If it already exist, the
+      // process that created it may not yet have set the size so wait a
+      // short while for that.
+    int fd = shm_open(name.c_str(), O_RDWR | O_CREAT | O_EXCL, 0660);
+    const bool created = (fd >= 0);
+    if (!created && (errno == EEXIST))
+    {
+      fd = shm_open(name.c_str(), O_RDWR, 0);
+    }
+    if (fd < 0)
+    {
+      cerr << "*** ERROR: Could not open shared memory object " << name
+           << ": " << strerror(errno) << endl;
+      return false;
+    }
+    if (created)
+    {
+      if (ftruncate(fd, map_size) == -1)
+      {
+        cerr << "*** ERROR: Could not set the size of shared memory object "
+             << name << ": " << strerror(errno) << endl;
+        ::close(fd);
+        shm_unlink(name.c_str());
+        return false;
+      }
+    }
+    struct stat st;
+    for (int i=0; i<100; ++i)
+    {
+      if ((fstat(fd, &st) == -1) || (st.st_size != 0))
+      {
+        break;
+      }
+      usleep(1000);
+    }
+    if (static_cast<size_t>(st.st_size) != map_size)
+    {
+      cerr << "*** ERROR: The shared memory object " << name
+           << " has the wrong size. Check that the number of channels is "
+              "the same in all processes.\n";
+      ::close(fd);
+      return false;
+    }
+
+    map = mmap(NULL, map_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (map == MAP_FAILED)
+    {
+      cerr << "*** ERROR: Could not map shared memory object " << name
+           << ": " << strerror(errno) << endl;
+      return false;
+    }
+    hdr = static_cast<Header*>(map);
+    data = reinterpret_cast<int16_t*>(static_cast<char*>(map) + HEADER_SIZE);
+
+      // The memory is zero filled when the object is created so only the
+      // parameters need to be set. The magic is written last to tell other
+      // processes that the ring is ready to use.
+    if (created)
+    {
+      hdr->version = VERSION;
+      hdr->channels = channels;
+      hdr->sample_rate = sample_rate;
+      hdr->frames = RING_FRAMES;
+      hdr->magic.store(MAGIC, std::memory_order_release);
+    }
+    for (int i=0; i<100; ++i)
+    {
+      if (hdr->magic.load(std::memory_order_acquire) == MAGIC)
+      {
+        break;
+      }
+      usleep(1000);
+    }
+    if ((hdr->magic.load(std::memory_order_acquire) != MAGIC) ||
+        (hdr->version != VERSION) || (hdr->frames != RING_FRAMES) ||
+        (hdr->channels != channels) ||
+        (hdr->sample_rate != static_cast<uint32_t>(sample_rate)))
+    {
+      cerr << "*** ERROR: The shared memory object " << name
+           << " is not compatible. Check that the sample rate and number of "
+              "channels is the same in all processes.\n";
+      return false;
+    }
+    return true;
+  }
+};
+
+
+/****************************************************************************
+ *
+ * Prototypes
+ *
+ ****************************************************************************/
+
+namespace {
+  void futexWait(std::atomic<uint32_t>& word, uint32_t val, int timeout_ms)
+  {
+    struct timespec timeout;
+    timeout.tv_sec = timeout_ms / 1000;
+    timeout.tv_nsec = (timeout_ms % 1000) * 1000000L;
+    syscall(SYS_futex, reinterpret_cast<uint32_t*>(&word), FUTEX_WAIT, val,
+            &timeout, NULL, 0);
+  } /* futexWait */
+
+  void futexWake(std::atomic<uint32_t>& word)
+  {
+    syscall(SYS_futex, reinterpret_cast<uint32_t*>(&word), FUTEX_WAKE,
+            INT_MAX, NULL, NULL, 0);
+  } /* futexWake */
+};
+
+
+/****************************************************************************
+ *
+ * Exported Global Variables
+ *
+ ****************************************************************************/
+
+
+
+
+/****************************************************************************
+ *
+ * Local Global Variables
+ *
+ ****************************************************************************/
+
+REGISTER_AUDIO_DEVICE_TYPE("shm", AudioDeviceShm);
+
+
+
+/****************************************************************************
+ *
+ * Public member functions
+ *
+ ****************************************************************************/
+
+size_t AudioDeviceShm::readBlocksize(void)
+{
+  return block_size;
+} /* AudioDeviceShm::readBlocksize */
+
+
+size_t AudioDeviceShm::writeBlocksize(void)
+{
+  return block_size;
+} /* AudioDeviceShm::writeBlocksize */
+
+
+bool AudioDeviceShm::isFullDuplexCapable(void)
+{
+  return true;
+} /* AudioDeviceShm::isFullDuplexCapable */
+
+
+void AudioDeviceShm::audioToWriteAvailable(void)
+{
+  if (!pace_timer->isEnabled())
+  {
+    audioWriteHandler();
+  }
+} /* AudioDeviceShm::audioToWriteAvailable */
+
+
+void AudioDeviceShm::flushSamples(void)
+{
+  if (!pace_timer->isEnabled())
+  {
+    audioWriteHandler();
+  }
+} /* AudioDeviceShm::flushSamples */
+
+
+int AudioDeviceShm::samplesToWrite(void) const
+{
+  if (wr_ring == 0)
+  {
+    return 0;
+  }
+  return wr_ring->hdr->write_pos.load(std::memory_order_relaxed) -
+         wr_ring->hdr->read_pos.load(std::memory_order_acquire);
+} /* AudioDeviceShm::samplesToWrite */
+
+
+
+/****************************************************************************
+ *
+ * Protected member functions
+ *
+ ****************************************************************************/
+
+
+AudioDeviceShm::AudioDeviceShm(const string& dev_name)
+  : AudioDevice(dev_name), block_size(0), rd_ring(0), wr_ring(0),
+    wake_watch(0), wake_thread_stop(false), wake_pending(false), xrun_cnt(0)
+{
+  assert(AudioDeviceShm_creator_registered);
+  assert(sampleRate() > 0);
+  wake_pipe[0] = wake_pipe[1] = -1;
+  size_t pace_interval = 1000 * block_size_hint / sampleRate();
+  block_size = pace_interval * sampleRate() / 1000;
+  assert(block_size <= RING_FRAMES);
+
+  pace_timer = new Timer(pace_interval, Timer::TYPE_PERIODIC);
+  pace_timer->setEnable(false);
+  pace_timer->expired.connect(
+      sigc::hide(mem_fun(*this, &AudioDeviceShm::audioWriteHandler)));
+} /* AudioDeviceShm::AudioDeviceShm */
+
+
+AudioDeviceShm::~AudioDeviceShm(void)
+{
+  closeDevice();
+  delete pace_timer;
+} /* AudioDeviceShm::~AudioDeviceShm */
+
+
+bool AudioDeviceShm::openDevice(Mode mode)
+{
+  closeDevice();
+
+  const string &dev_name = devName();
+  string rd_name(dev_name);
+  string wr_name(dev_name);
+  size_t colon = dev_name.find(':');
+  if (colon != string::npos)
+  {
+    rd_name = dev_name.substr(0, colon);
+    wr_name = dev_name.substr(colon+1);
+  }
+  if (rd_name.empty() || wr_name.empty() ||
+      (rd_name.find('/') != string::npos) ||
+      (wr_name.find('/') != string::npos))
+  {
+    cerr << "*** ERROR: Illegal shared memory audio device specification ("
+         << devName() << "). Should be shm:rd_name[:wr_name]\n";
+    return false;
+  }
+
+  if ((mode == MODE_RD) || (mode == MODE_RDWR))
+  {
+    rd_ring = new Ring;
+    if (!rd_ring->open(rd_name, channels, sampleRate()))
+    {
+      closeDevice();
+      return false;
+    }
+
+      // Skip samples written before we opened the ring since they are old
+    rd_ring->hdr->read_pos.store(
+        rd_ring->hdr->write_pos.load(std::memory_order_acquire),
+        std::memory_order_release);
+
+    if ((pipe(wake_pipe) == -1) ||
+        (fcntl(wake_pipe[1], F_SETFL, O_NONBLOCK) == -1) ||
+        (fcntl(wake_pipe[0], F_SETFL, O_NONBLOCK) == -1))
+    {
+      cerr << "*** ERROR: Could not create wakeup pipe for audio device "
+           << devName() << ": " << strerror(errno) << endl;
+      closeDevice();
+      return false;
+    }
+    wake_watch = new FdWatch(wake_pipe[0], FdWatch::FD_WATCH_RD);
+    wake_watch->activity.connect(
+        sigc::hide(mem_fun(*this, &AudioDeviceShm::audioReadHandler)));
+    wake_thread_stop = false;
+    wake_pending = false;
+    wake_thread = std::thread(&AudioDeviceShm::wakeThreadFunc, this);
+  }
+
+  if ((mode == MODE_WR) || (mode == MODE_RDWR))
+  {
+    wr_ring = new Ring;
+    if (!wr_ring->open(wr_name, channels, sampleRate()))
+    {
+      closeDevice();
+      return false;
+    }
+  }
+
+  return true;
+
+} /* AudioDeviceShm::openDevice */
+
+
+void AudioDeviceShm::closeDevice(void)
+{
+  pace_timer->setEnable(false);
+
+  if (wake_thread.joinable())
+  {
+    wake_thread_stop = true;
+    futexWake(rd_ring->hdr->seq);
+    wake_thread.join();
+  }
+  delete wake_watch;
+  wake_watch = 0;
+  for (int i=0; i<2; ++i)
+  {
+    if (wake_pipe[i] != -1)
+    {
+      ::close(wake_pipe[i]);
+      wake_pipe[i] = -1;
+    }
+  }
+
+  delete rd_ring;
+  rd_ring = 0;
+  delete wr_ring;
+  wr_ring = 0;
+} /* AudioDeviceShm::closeDevice */
+
+
+
+/****************************************************************************
+ *
+ * Private member functions
+ *
+ ****************************************************************************/
+
+
+void AudioDeviceShm::audioReadHandler(void)
+{
+  char buf[64];
+  while (read(wake_pipe[0], buf, sizeof(buf)) > 0)
+  {
+  }
+  wake_pending = false;
+
+    // Deliver the samples directly from the shared memory. At most two
+    // calls are needed, the second one if the samples wrap around the end
+    // of the ring.
+  Ring::Header* hdr = rd_ring->hdr;
+  const uint32_t wr_pos = hdr->write_pos.load(std::memory_order_acquire);
+  uint32_t rd_pos = hdr->read_pos.load(std::memory_order_relaxed);
+  uint32_t avail = std::min(wr_pos - rd_pos, uint32_t(RING_FRAMES));
+  rd_pos = wr_pos - avail;
+  while (avail > 0)
+  {
+    const uint32_t idx = rd_pos % RING_FRAMES;
+    const uint32_t cnt = std::min(avail, uint32_t(RING_FRAMES) - idx);
+    putBlocks(rd_ring->data + idx * channels, cnt);
+    rd_pos += cnt;
+    avail -= cnt;
+  }
+  hdr->read_pos.store(rd_pos, std::memory_order_release);
+} /* AudioDeviceShm::audioReadHandler */
+
+
+void AudioDeviceShm::audioWriteHandler(void)
+{
+  assert(wr_ring != 0);
+  assert((mode() == MODE_WR) || (mode() == MODE_RDWR));
+
+  Ring::Header* hdr = wr_ring->hdr;
+  const uint32_t wr_pos = hdr->write_pos.load(std::memory_order_relaxed);
+  const uint32_t rd_pos = hdr->read_pos.load(std::memory_order_acquire);
+  const uint32_t idx = wr_pos % RING_FRAMES;
+  int16_t buf[block_size * channels];
+
+    // If the other process is not reading, the block is thrown away
+  if (RING_FRAMES - (wr_pos - rd_pos) < block_size)
+  {
+    if (getBlocks(buf, 1) == 0)
+    {
+      pace_timer->setEnable(false);
+      return;
+    }
+    ++xrun_cnt;
+    pace_timer->setEnable(true);
+    return;
+  }
+
+    // Write the block directly into the shared memory unless it would wrap
+    // around the end of the ring
+  unsigned frags_read;
+  if (idx + block_size <= RING_FRAMES)
+  {
+    frags_read = getBlocks(wr_ring->data + idx * channels, 1);
+  }
+  else
+  {
+    frags_read = getBlocks(buf, 1);
+    const size_t first = RING_FRAMES - idx;
+    memcpy(wr_ring->data + idx * channels, buf,
+           first * channels * sizeof(*buf));
+    memcpy(wr_ring->data, buf + first * channels,
+           (block_size - first) * channels * sizeof(*buf));
+  }
+  if (frags_read == 0)
+  {
+    pace_timer->setEnable(false);
+    return;
+  }
+
+  hdr->write_pos.store(wr_pos + block_size, std::memory_order_release);
+  hdr->seq.fetch_add(1);
+  if (hdr->waiting.load() != 0)
+  {
+    futexWake(hdr->seq);
+  }
+
+  pace_timer->setEnable(true);
+
+} /* AudioDeviceShm::audioWriteHandler */
+
+
+void AudioDeviceShm::wakeThreadFunc(void)
+{
+  ThreadSched::Registration sched_reg("audio");
+  Ring::Header* hdr = rd_ring->hdr;
+  uint32_t seen = hdr->seq.load();
+  while (!wake_thread_stop)
+  {
+    hdr->waiting.store(1);
+    if (hdr->seq.load() == seen)
+    {
+      futexWait(hdr->seq, seen, 100);
+    }
+    hdr->waiting.store(0);
+
+      // Only wake the main thread up if it is not already about to read
+      // samples from the ring
+    const uint32_t seq = hdr->seq.load();
+    if ((seq != seen) && !wake_pending.exchange(true))
+    {
+      const char ch = 0;
+      if (write(wake_pipe[1], &ch, 1) == -1)
+      {
+        wake_pending = false;
+      }
+    }
+    seen = seq;
+  }
+} /* AudioDeviceShm::wakeThreadFunc */
+
+
+
+/*
+ * This file has not been truncated
+ */
@@ -0,0 +1,240 @@
+/**
+@file	 AsyncAudioDeviceShm.h
+@brief   Stream audio samples to/from other processes via shared memory
+@author  Tobias Blomberg / SM0SVX
+@date	 2026-10-14
+
+Implements an "audio interface" that stream samples through a ring buffer in
+POSIX shared memory. This is used to move audio between processes on the same
+host without the overhead of a UDP socket.
+
+\verbatim
+Async - A library for programming event driven applications
+Copyright (C) 2003-2026 Tobias Blomberg / SM0SVX
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+\endverbatim
+*/
+
+
+#ifndef ASYNC_AUDIO_DEVICE_SHM_INCLUDED
+#define ASYNC_AUDIO_DEVICE_SHM_INCLUDED
+
+
+/****************************************************************************
+ *
+ * System Includes
+ *
+ ****************************************************************************/
+
+#include <string>
+#include <thread>
+#include <atomic>
+
+
+/****************************************************************************
+ *
+ * Project Includes
+ *
+ ****************************************************************************/
+
+#include <AsyncTimer.h>
+
+
+/****************************************************************************
+ *
+ * Local Includes
+ *
+ ****************************************************************************/
+
+#include "AsyncAudioDevice.h"
+
+
+/****************************************************************************
+ *
+ * Forward declarations
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Namespace
+ *
+ ****************************************************************************/
+
+namespace Async
+{
+
+
+/****************************************************************************
+ *
+ * Forward declarations of classes inside of the declared namespace
+ *
+ ****************************************************************************/
+
+class FdWatch;
+
+
+/****************************************************************************
+ *
+ * Defines & typedefs
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Exported Global Variables
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Class definitions
+ *
+ ****************************************************************************/
+
+/**
+@brief	An audio device that stream samples through shared memory
+@author Tobias Blomberg / SM0SVX
+@date   2026-10-14
+
+Implements an "audio interface" that stream samples through lock free single
+producer, single consumer ring buffers in POSIX shared memory. The device is
+specified as "shm:rd_name[:wr_name]". Samples are read from the ring named
+rd_name and written to the ring named wr_name. If no wr_name is given, the
+same ring is used for both directions, which is useful when a device is only
+used in one direction. Each ring is a shared memory object called
+/svxlink-audio-\<name\> which is created by the first process that open it.
+
+A consumer waiting for samples sleep on a futex in the shared memory so no
+system calls are made by the producer unless the consumer is waiting. The
+samples are delivered directly from the shared memory, without copying them
+to an intermediate buffer.
+
+This class is only available on systems that support futexes, that is Linux.
+*/
+class AudioDeviceShm : public Async::AudioDevice
+{
+  public:
+    static const unsigned RING_FRAMES = 8192;
+
+    /**
+     * @brief 	Constuctor
+     * @param 	dev_name  The name of the device to associate this object with
+     */
+    explicit AudioDeviceShm(const std::string& dev_name);
+
+    /**
+     * @brief 	Destructor
+     */
+    ~AudioDeviceShm(void);
+
+    /**
+     * @brief 	Find out what the read (recording) blocksize is set to
+     * @return	Returns the currently set blocksize in samples per channel
+     */
+    virtual size_t readBlocksize(void);
+
+    /**
+     * @brief 	Find out what the write (playback) blocksize is set to
+     * @return	Returns the currently set blocksize in samples per channel
+     */
+    virtual size_t writeBlocksize(void);
+
+    /**
+     * @brief 	Check if the audio device has full duplex capability
+     * @return	Returns \em true if the device has full duplex capability
+     *	      	or else \em false
+     */
+    virtual bool isFullDuplexCapable(void);
+
+    /**
+     * @brief 	Tell the audio device handler that there are audio to be
+     *	      	written in the buffer
+     */
+    virtual void audioToWriteAvailable(void);
+
+    /**
+     * @brief	Tell the audio device to flush its buffers
+     */
+    virtual void flushSamples(void);
+
+    /**
+     * @brief 	Find out how many samples there are in the output buffer
+     * @return	Returns the number of samples in the output buffer on
+     *          success or -1 on failure.
+     *
+     * The samples in the output buffer are the samples that have been
+     * written to the ring buffer but not yet read by the other process.
+     */
+    virtual int samplesToWrite(void) const;
+
+    /**
+     * @brief   Find out how many blocks that have been dropped
+     * @return  Returns the number of blocks dropped since the ring was full
+     */
+    virtual unsigned long playbackXrunCount(void) const { return xrun_cnt; }
+
+  protected:
+    /**
+     * @brief 	Open the audio device
+     * @param 	mode The mode to open the audio device in (See AudioIO::Mode)
+     * @return	Returns \em true on success or else \em false
+     */
+    virtual bool openDevice(Mode mode);
+
+    /**
+     * @brief 	Close the audio device
+     */
+    virtual void closeDevice(void);
+
+  private:
+    struct Ring;
+
+    size_t              block_size;
+    Ring*               rd_ring;
+    Ring*               wr_ring;
+    Async::Timer*       pace_timer;
+    Async::FdWatch*     wake_watch;
+    int                 wake_pipe[2];
+    std::thread         wake_thread;
+    std::atomic<bool>   wake_thread_stop;
+    std::atomic<bool>   wake_pending;
+    unsigned long       xrun_cnt;
+
+    AudioDeviceShm(const AudioDeviceShm&);
+    AudioDeviceShm& operator=(const AudioDeviceShm&);
+    void audioReadHandler(void);
+    void audioWriteHandler(void);
+    void wakeThreadFunc(void);
+
+};  /* class AudioDeviceShm */
+
+
+} /* namespace */
+
+#endif /* ASYNC_AUDIO_DEVICE_SHM_INCLUDED */
+
+
+
+/*
+ * This file has not been truncated
+ */
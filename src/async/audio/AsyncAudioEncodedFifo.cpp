@@ -0,0 +1,403 @@
+/**
+@file   AsyncAudioEncodedFifo.cpp
+@brief  A FIFO that store audio in encoded form
+@author Tobias Blomberg / SM0SVX
+@date   2026-10-14
+
+\verbatim
+Async - A library for programming event driven applications
+Copyright (C) 2003-2026 Tobias Blomberg / SM0SVX
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+\endverbatim
+*/
+
+/****************************************************************************
+ *
+ * System Includes
+ *
+ ****************************************************************************/
+
+#include <algorithm>
+#include <iostream>
+
+
+/****************************************************************************
+ *
+ * Project Includes
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Local Includes
+ *
+ ****************************************************************************/
+
+#include "AsyncAudioEncoder.h"
+#include "AsyncAudioDecoder.h"
+#include "AsyncAudioEncodedFifo.h"
+
+
+/****************************************************************************
+ *
+ * Namespaces to use
+ *
+ ****************************************************************************/
+
+using namespace std;
+using namespace Async;
+
+
+/****************************************************************************
+ *
+ * Defines & typedefs
+ *
+ ****************************************************************************/
+
+  /* The encoder is fed in chunks of 2.5ms, the smallest Opus frame size,
+   * so that the duration of each encoded frame can be counted exactly */
+static const unsigned FEED_CHUNK = INTERNAL_SAMPLE_RATE / 400;
+
+  /* The maximum amount of silence used to push the last frame out of the
+   * encoder on flush, which is the largest Opus frame size */
+static const unsigned MAX_PAD = INTERNAL_SAMPLE_RATE * 120 / 1000;
+
+  /* Frames from codecs without framing are merged up to this duration */
+static const unsigned MERGE_SAMPLES = INTERNAL_SAMPLE_RATE * 20 / 1000;
+
+static const unsigned MAX_WRITE_SIZE = 800;
+
+
+/****************************************************************************
+ *
+ * Local class definitions
+ *
+ ****************************************************************************/
+
+class AudioEncodedFifo::DecoderSink : public AudioSink
+{
+  public:
+    explicit DecoderSink(std::vector<float>& buf) : buf(buf) {}
+    virtual int writeSamples(const float *samples, int count)
+    {
+      buf.insert(buf.end(), samples, samples + count);
+      return count;
+    }
+    virtual void flushSamples(void) { sourceAllSamplesFlushed(); }
+
+  private:
+    std::vector<float>& buf;
+}; /* class AudioEncodedFifo::DecoderSink */
+
+
+/****************************************************************************
+ *
+ * Prototypes
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Exported Global Variables
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Local Global Variables
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Public member functions
+ *
+ ****************************************************************************/
+
+AudioEncodedFifo::AudioEncodedFifo(const std::string& codec,
+                                   unsigned max_ms)
+  : enc(0), dec(0), dec_sink(0), enc_bytes(0),
+    max_samples(static_cast<uint64_t>(max_ms) * INTERNAL_SAMPLE_RATE / 1000),
+    stored_samples(0), samples_fed(0), samples_framed(0), dec_pos(0),
+    do_overwrite(false), is_full(false), is_flushing(false),
+    input_stopped(false), output_stopped(false),
+    merge_frames((codec == "RAW") || (codec == "S16"))
+{
+  enc = AudioEncoder::create(codec);
+  dec = AudioDecoder::create(codec);
+  if ((enc == 0) || (dec == 0))
+  {
+    cerr << "*** ERROR: Could not create the " << codec
+         << " codec for an encoded audio FIFO" << endl;
+    delete enc;
+    enc = 0;
+    delete dec;
+    dec = 0;
+    return;
+  }
+  enc->writeEncodedSamples.connect(
+      sigc::mem_fun(*this, &AudioEncodedFifo::onEncodedFrame));
+  dec_sink = new DecoderSink(dec_buf);
+  dec->registerSink(dec_sink, true);
+} /* AudioEncodedFifo::AudioEncodedFifo */
+
+
+AudioEncodedFifo::~AudioEncodedFifo(void)
+{
+  delete enc;
+  delete dec;
+} /* AudioEncodedFifo::~AudioEncodedFifo */
+
+
+void AudioEncodedFifo::setEncoderOption(const std::string& name,
+                                        const std::string& value)
+{
+  if (enc != 0)
+  {
+    enc->setOption(name, value);
+  }
+} /* AudioEncodedFifo::setEncoderOption */
+
+
+bool AudioEncodedFifo::empty(void) const
+{
+  return frames.empty() && (dec_pos == dec_buf.size());
+} /* AudioEncodedFifo::empty */
+
+
+unsigned AudioEncodedFifo::samplesInFifo(void) const
+{
+  return stored_samples + (dec_buf.size() - dec_pos);
+} /* AudioEncodedFifo::samplesInFifo */
+
+
+void AudioEncodedFifo::clear(void)
+{
+  bool was_empty = empty();
+
+  frames.clear();
+  enc_bytes = 0;
+  stored_samples = 0;
+  dec_buf.clear();
+  dec_pos = 0;
+  is_full = false;
+  output_stopped = false;
+
+  if (is_flushing && !was_empty)
+  {
+    sinkFlushSamples();
+  }
+} /* AudioEncodedFifo::clear */
+
+
+int AudioEncodedFifo::writeSamples(const float *samples, int count)
+{
+  is_flushing = false;
+
+  if (is_full || !initOk())
+  {
+    input_stopped = true;
+    return 0;
+  }
+
+  feedEncoder(samples, count);
+  writeSamplesFromFifo();
+
+  input_stopped = false;
+  return count;
+} /* AudioEncodedFifo::writeSamples */
+
+
+void AudioEncodedFifo::flushSamples(void)
+{
+    // Push the last partial frame out of the encoder by padding it with
+    // silence. Codecs without internal buffering never leave anything.
+  static const float silence[FEED_CHUNK] = {0};
+  unsigned padded = 0;
+  while (initOk() && (samples_framed != samples_fed) && (padded < MAX_PAD))
+  {
+    unsigned len = FEED_CHUNK - (samples_fed % FEED_CHUNK);
+    feedEncoder(silence, len);
+    padded += len;
+  }
+  samples_framed = samples_fed;
+
+  is_flushing = true;
+  if (empty())
+  {
+    sinkFlushSamples();
+  }
+  else
+  {
+    writeSamplesFromFifo();
+  }
+} /* AudioEncodedFifo::flushSamples */
+
+
+void AudioEncodedFifo::resumeOutput(void)
+{
+  if (output_stopped)
+  {
+    output_stopped = false;
+    writeSamplesFromFifo();
+  }
+} /* AudioEncodedFifo::resumeOutput */
+
+
+
+/****************************************************************************
+ *
+ * Protected member functions
+ *
+ ****************************************************************************/
+
+void AudioEncodedFifo::allSamplesFlushed(void)
+{
+  if (empty() && is_flushing)
+  {
+    is_flushing = false;
+    sourceAllSamplesFlushed();
+  }
+} /* AudioEncodedFifo::allSamplesFlushed */
+
+
+
+/****************************************************************************
+ *
+ * Private member functions
+ *
+ ****************************************************************************/
+
+void AudioEncodedFifo::feedEncoder(const float *samples, int count)
+{
+  int pos = 0;
+  while (pos < count)
+  {
+    int len = min(count - pos,
+                  static_cast<int>(FEED_CHUNK - (samples_fed % FEED_CHUNK)));
+    samples_fed += len;
+    enc->writeSamples(samples + pos, len);
+    pos += len;
+  }
+} /* AudioEncodedFifo::feedEncoder */
+
+
+void AudioEncodedFifo::onEncodedFrame(const void *buf, int size)
+{
+  const uint8_t *ptr = static_cast<const uint8_t *>(buf);
+  unsigned samples = samples_fed - samples_framed;
+  samples_framed = samples_fed;
+  enc_bytes += size;
+  stored_samples += samples;
+
+  if (merge_frames && !frames.empty() &&
+      (frames.back().samples < MERGE_SAMPLES))
+  {
+    frames.back().data.insert(frames.back().data.end(), ptr, ptr + size);
+    frames.back().samples += samples;
+  }
+  else
+  {
+    Frame frame;
+    frame.data.assign(ptr, ptr + size);
+    frame.samples = samples;
+    frames.push_back(std::move(frame));
+  }
+
+  while (do_overwrite && (samplesInFifo() > max_samples))
+  {
+      // A decoded frame that has not been output yet is older than all
+      // stored frames so it is thrown away first
+    if (!dec_buf.empty() && (dec_pos == 0))
+    {
+      dec_buf.clear();
+      continue;
+    }
+    if (frames.size() <= 1)
+    {
+      break;
+    }
+    enc_bytes -= frames.front().data.size();
+    stored_samples -= frames.front().samples;
+    frames.pop_front();
+  }
+  is_full = !do_overwrite && (stored_samples >= max_samples);
+} /* AudioEncodedFifo::onEncodedFrame */
+
+
+void AudioEncodedFifo::writeSamplesFromFifo(void)
+{
+  if (output_stopped || empty())
+  {
+    return;
+  }
+
+  for (;;)
+  {
+    if (dec_pos == dec_buf.size())
+    {
+      dec_buf.clear();
+      dec_pos = 0;
+      if (frames.empty())
+      {
+        break;
+      }
+      Frame frame(std::move(frames.front()));
+      frames.pop_front();
+      enc_bytes -= frame.data.size();
+      stored_samples -= frame.samples;
+      is_full = !do_overwrite && (stored_samples >= max_samples);
+      dec->writeEncodedSamples(frame.data.data(), frame.data.size());
+      continue;
+    }
+
+    int samples_to_write = min(static_cast<size_t>(MAX_WRITE_SIZE),
+                               dec_buf.size() - dec_pos);
+    int samples_written = sinkWriteSamples(&dec_buf[dec_pos],
+                                           samples_to_write);
+    if (samples_written == 0)
+    {
+      output_stopped = true;
+      break;
+    }
+    dec_pos += samples_written;
+  }
+
+  if (input_stopped && !is_full)
+  {
+    input_stopped = false;
+    sourceResumeOutput();
+  }
+
+  if (is_flushing && empty())
+  {
+    sinkFlushSamples();
+  }
+} /* AudioEncodedFifo::writeSamplesFromFifo */
+
+
+
+/*
+ * This file has not been truncated
+ */
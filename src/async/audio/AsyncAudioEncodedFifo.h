@@ -0,0 +1,270 @@
+/**
+@file   AsyncAudioEncodedFifo.h
+@brief  A FIFO that store audio in encoded form
+@author Tobias Blomberg / SM0SVX
+@date   2026-10-14
+
+\verbatim
+Async - A library for programming event driven applications
+Copyright (C) 2003-2026 Tobias Blomberg / SM0SVX
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+\endverbatim
+*/
+
+#ifndef ASYNC_AUDIO_ENCODED_FIFO_INCLUDED
+#define ASYNC_AUDIO_ENCODED_FIFO_INCLUDED
+
+
+/****************************************************************************
+ *
+ * System Includes
+ *
+ ****************************************************************************/
+
+#include <string>
+#include <vector>
+#include <deque>
+#include <cstdint>
+
+
+/****************************************************************************
+ *
+ * Project Includes
+ *
+ ****************************************************************************/
+
+#include <AsyncAudioSink.h>
+#include <AsyncAudioSource.h>
+
+
+/****************************************************************************
+ *
+ * Local Includes
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Forward declarations
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Namespace
+ *
+ ****************************************************************************/
+
+namespace Async
+{
+
+
+/****************************************************************************
+ *
+ * Forward declarations of classes inside of the declared namespace
+ *
+ ****************************************************************************/
+
+class AudioEncoder;
+class AudioDecoder;
+
+
+/****************************************************************************
+ *
+ * Defines & typedefs
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Exported Global Variables
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Class definitions
+ *
+ ****************************************************************************/
+
+/**
+@brief  A FIFO that store audio in encoded form
+@author Tobias Blomberg / SM0SVX
+@date   2026-10-14
+
+This class work like the Async::AudioFifo class but all samples written to it
+are encoded using an audio codec and stored as encoded frames. The frames are
+decoded again, one at a time, when they are written out to the connected sink.
+Using the Opus codec, a long recording use about a tenth of the memory that an
+AudioFifo would use.
+
+The size of the FIFO is given as a duration. When overwrite is enabled the
+oldest frames are thrown away when the FIFO is full, making the FIFO a ring
+buffer of the latest audio.
+
+Since all audio pass through the codec, the output is delayed by at least one
+codec frame. When the FIFO is flushed, the last partial frame is padded with
+silence so that it is not lost inside the encoder. The codec must operate at
+the internal sample rate, e.g. OPUS, SPEEX, S16 or RAW.
+*/
+class AudioEncodedFifo : public AudioSink, public AudioSource
+{
+  public:
+    /**
+     * @brief   Constructor
+     * @param   codec   The name of the codec to use, e.g. "OPUS"
+     * @param   max_ms  The maximum duration to store in milliseconds
+     */
+    AudioEncodedFifo(const std::string& codec, unsigned max_ms);
+
+    /**
+     * @brief   Destructor
+     */
+    virtual ~AudioEncodedFifo(void);
+
+    /**
+     * @brief   Check if the codec could be created
+     * @return  Returns \em true if the FIFO is usable or else \em false
+     */
+    bool initOk(void) const { return (enc != 0) && (dec != 0); }
+
+    /**
+     * @brief   Set an option for the encoder
+     * @param   name  The name of the option
+     * @param   value The value of the option
+     *
+     * Encoder options should be set before any samples are written.
+     */
+    void setEncoderOption(const std::string& name, const std::string& value);
+
+    /**
+     * @brief   Set the overwrite mode
+     * @param   overwrite Set to \em true to overwrite or else \em false
+     *
+     * When overwrite is set, the oldest frames are thrown away to make room
+     * for new ones so the FIFO never get full. In normal mode no more samples
+     * are accepted when the FIFO is full.
+     */
+    void setOverwrite(bool overwrite) { do_overwrite = overwrite; }
+
+    /**
+     * @brief   Check if the FIFO is empty
+     * @return  Returns \em true if the FIFO is empty or else \em false
+     */
+    bool empty(void) const;
+
+    /**
+     * @brief   Check if the FIFO is full
+     * @return  Returns \em true if the FIFO is full or else \em false
+     */
+    bool full(void) const { return is_full; }
+
+    /**
+     * @brief   Find out the duration of stored audio
+     * @return  Returns the number of samples that are waiting to be output
+     */
+    unsigned samplesInFifo(void) const;
+
+    /**
+     * @brief   Find out how much memory the encoded frames use
+     * @return  Returns the number of stored encoded bytes
+     */
+    size_t encodedBytes(void) const { return enc_bytes; }
+
+    /**
+     * @brief   Clear all samples from the FIFO
+     *
+     * This will immediately reset the FIFO and discard all samples.
+     * The source will be told that all samples have been flushed.
+     */
+    void clear(void);
+
+    /**
+     * @brief   Write samples into the FIFO
+     * @param   samples The buffer containing the samples
+     * @param   count The number of samples in the buffer
+     * @return  Returns the number of samples that has been taken care of
+     */
+    virtual int writeSamples(const float *samples, int count);
+
+    /**
+     * @brief   Tell the FIFO to flush the previously written samples
+     */
+    virtual void flushSamples(void);
+
+    /**
+     * @brief   Resume audio output to the connected sink
+     */
+    virtual void resumeOutput(void);
+
+  protected:
+    /**
+     * @brief   The registered sink has flushed all samples
+     */
+    virtual void allSamplesFlushed(void);
+
+  private:
+    class DecoderSink;
+    struct Frame
+    {
+      std::vector<uint8_t>  data;
+      unsigned              samples;
+    };
+
+    AudioEncoder*       enc;
+    AudioDecoder*       dec;
+    DecoderSink*        dec_sink;
+    std::deque<Frame>   frames;
+    size_t              enc_bytes;
+    unsigned            max_samples;
+    unsigned            stored_samples;
+    uint64_t            samples_fed;
+    uint64_t            samples_framed;
+    std::vector<float>  dec_buf;
+    size_t              dec_pos;
+    bool                do_overwrite;
+    bool                is_full;
+    bool                is_flushing;
+    bool                input_stopped;
+    bool                output_stopped;
+    bool                merge_frames;
+
+    AudioEncodedFifo(const AudioEncodedFifo&);
+    AudioEncodedFifo& operator=(const AudioEncodedFifo&);
+    void feedEncoder(const float *samples, int count);
+    void onEncodedFrame(const void *buf, int size);
+    void writeSamplesFromFifo(void);
+
+};  /* class AudioEncodedFifo */
+
+
+} /* namespace */
+
+#endif /* ASYNC_AUDIO_ENCODED_FIFO_INCLUDED */
+
+
+
+/*
+ * This file has not been truncated
+ */
@@ -49,6 +49,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
  ****************************************************************************/
 
 #include "AsyncAudioEncoder.h"
+#include "AsyncAudioDecoder.h"
 #include "AsyncAudioEncoderDummy.h"
 #include "AsyncAudioEncoderNull.h"
 #include "AsyncAudioEncoderRaw.h"
@@ -60,6 +61,9 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 #ifdef OPUS_MAJOR
 #include "AsyncAudioEncoderOpus.h"
 #endif
+#ifdef CODEC2_MAJOR
+#include "AsyncAudioEncoderCodec2.h"
+#endif
 
 
 /****************************************************************************
@@ -129,6 +133,9 @@ bool AudioEncoder::isAvailable(const std::string &name)
 #endif
 #ifdef OPUS_MAJOR
          (name == "OPUS") ||
+#endif
+#ifdef CODEC2_MAJOR
+         (name == "CODEC2") ||
 #endif
          (name == "DUMMY");
 } /* AudioEncoder::isAvailable */
@@ -167,6 +174,12 @@ AudioEncoder *AudioEncoder::create(const std::string &name)
   {
     return new AudioEncoderOpus;
   }
+#endif
+#ifdef CODEC2_MAJOR
+  else if (name == "CODEC2")
+  {
+    return new AudioEncoderCodec2;
+  }
 #endif
   else
   {
@@ -175,12 +188,44 @@ AudioEncoder *AudioEncoder::create(const std::string &name)
 } /* AudioEncoder::create */
 
 
+AudioEncoder::~AudioEncoder(void)
+{
+  setPassthrough(false);
+} /* AudioEncoder::~AudioEncoder */
+
+
+void AudioEncoder::setPassthrough(bool enable)
+{
+  if (enable != passthrough)
+  {
+    passthrough = enable;
+    AudioDecoder::enableFrameTracking(enable);
+  }
+} /* AudioEncoder::setPassthrough */
+
+
 /****************************************************************************
  *
  * Protected member functions
  *
  ****************************************************************************/
 
+bool AudioEncoder::writePassthroughFrame(const float *samples, int count)
+{
+  if (!passthrough)
+  {
+    return false;
+  }
+  const std::vector<uint8_t>* frame =
+    AudioDecoder::findEncodedFrame(name(), samples, count);
+  if (frame == 0)
+  {
+    return false;
+  }
+  writeEncodedSamples(frame->data(), frame->size());
+  return true;
+} /* AudioEncoder::writePassthroughFrame */
+
 
 
 /****************************************************************************
@@ -128,12 +128,12 @@ class AudioEncoder : public AudioSink, public sigc::trackable
     /**
      * @brief 	Default constuctor
      */
-    AudioEncoder(void) {}
+    AudioEncoder(void) : passthrough(false) {}
   
     /**
      * @brief 	Destructor
      */
-    ~AudioEncoder(void) {}
+    ~AudioEncoder(void);
   
     /**
      * @brief   Get the name of the codec
@@ -152,6 +152,38 @@ class AudioEncoder : public AudioSink, public sigc::trackable
      * @brief Print codec parameter settings
      */
     virtual void printCodecParams(void) {}
+
+    /**
+     * @brief   Reset the encoder to the state of a newly created encoder
+     * @return  Returns \em true on success or \em false if not supported
+     *
+     * This function is used when a codec is reused for a new audio stream,
+     * @see AudioCodecPool. The codec state and all options are restored to
+     * their defaults. An encoder that do not support this return \em false and
+     * must be deleted and created again instead.
+     */
+    virtual bool reset(void) { return false; }
+
+    /**
+     * @brief   Enable or disable passthrough of already encoded frames
+     * @param   enable Set to \em true to enable passthrough
+     *
+     * When passthrough is enabled, an encoder that support it check if each
+     * frame of audio to encode is exactly what came out of a decoder for the
+     * same codec, @see AudioDecoder::findEncodedFrame. If so, the original
+     * encoded frame is sent instead of encoding the samples again. That save
+     * CPU and avoid the quality loss and extra delay of encoding twice. The
+     * encoded frames are then sent using the parameters of the original
+     * encoder. As soon as the audio is mixed or processed in any way, the
+     * encoder will encode it as usual.
+     */
+    void setPassthrough(bool enable);
+
+    /**
+     * @brief   Check if passthrough is enabled
+     * @return  Returns \em true if passthrough is enabled
+     */
+    bool passthroughEnabled(void) const { return passthrough; }
     
     /**
      * @brief 	Call this function when all encoded samples have been flushed
@@ -182,8 +214,21 @@ class AudioEncoder : public AudioSink, public sigc::trackable
     
   
   protected:
+    /**
+     * @brief   Try to send the original encoded frame for some samples
+     * @param   samples The samples to encode
+     * @param   count   The number of samples
+     * @return  Returns \em true if the encoded frame was sent
+     *
+     * An encoder supporting passthrough call this function for each frame of
+     * samples before encoding it. If \em false is returned, the samples
+     * must be encoded as usual.
+     */
+    bool writePassthroughFrame(const float *samples, int count);
     
   private:
+    bool passthrough;
+
     AudioEncoder(const AudioEncoder&);
     AudioEncoder& operator=(const AudioEncoder&);
     
@@ -0,0 +1,333 @@
+/**
+@file	 AsyncAudioEncoderCodec2.cpp
+@brief   An audio encoder that encodes samples using the Codec2 codec
+@author  Tobias Blomberg / SM0SVX
+@date	 2026-10-15
+
+\verbatim
+Async - A library for programming event driven applications
+Copyright (C) 2003-2026 Tobias Blomberg / SM0SVX
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+\endverbatim
+*/
+
+
+
+/****************************************************************************
+ *
+ * System Includes
+ *
+ ****************************************************************************/
+
+#include <codec2/codec2.h>
+#include <codec2/codec2_fdmdv.h>
+
+#include <iostream>
+#include <cstdlib>
+#include <algorithm>
+
+
+/****************************************************************************
+ *
+ * Project Includes
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Local Includes
+ *
+ ****************************************************************************/
+
+#include "AsyncAudioEncoderCodec2.h"
+
+
+
+/****************************************************************************
+ *
+ * Namespaces to use
+ *
+ ****************************************************************************/
+
+using namespace std;
+using namespace Async;
+
+
+
+/****************************************************************************
+ *
+ * Defines & typedefs
+ *
+ ****************************************************************************/
+
+  // The number of samples of filter history to keep in front of the sample
+  // buffer when decimating from 16kHz to the 8kHz used by Codec2
+#if INTERNAL_SAMPLE_RATE == 16000
+#define HIST_LEN  FDMDV_OS_TAPS_16K
+#define DEC_FACT  FDMDV_OS
+#else
+#define HIST_LEN  0
+#define DEC_FACT  1
+#endif
+
+
+/****************************************************************************
+ *
+ * Local class definitions
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Prototypes
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Exported Global Variables
+ *
+ ****************************************************************************/
+
+
+
+
+/****************************************************************************
+ *
+ * Local Global Variables
+ *
+ ****************************************************************************/
+
+const float AudioEncoderCodec2::DEFAULT_FRAME_SIZE = 80.0f;
+
+
+/****************************************************************************
+ *
+ * Public member functions
+ *
+ ****************************************************************************/
+
+int AudioEncoderCodec2::bitrateToMode(unsigned bitrate)
+{
+  switch (bitrate)
+  {
+    case 3200: return CODEC2_MODE_3200;
+    case 2400: return CODEC2_MODE_2400;
+    case 1600: return CODEC2_MODE_1600;
+    case 1400: return CODEC2_MODE_1400;
+    case 1300: return CODEC2_MODE_1300;
+    case 1200: return CODEC2_MODE_1200;
+    case 700:  return CODEC2_MODE_700C;
+    default:   return -1;
+  }
+} /* AudioEncoderCodec2::bitrateToMode */
+
+
+AudioEncoderCodec2::AudioEncoderCodec2(void)
+  : m_codec2(0), m_bitrate(0), m_frame_size(DEFAULT_FRAME_SIZE),
+    m_samples_per_frame(0), m_frames_per_packet(1), m_buf_len(0),
+    m_frame_cnt(0)
+{
+  setBitrate(DEFAULT_BITRATE);
+} /* AudioEncoderCodec2::AudioEncoderCodec2 */
+
+
+AudioEncoderCodec2::~AudioEncoderCodec2(void)
+{
+  codec2_destroy(m_codec2);
+} /* AudioEncoderCodec2::~AudioEncoderCodec2 */
+
+
+void AudioEncoderCodec2::setOption(const std::string &name,
+                                   const std::string &value)
+{
+  if (name == "BITRATE")
+  {
+    if (!setBitrate(atoi(value.c_str())))
+    {
+      cerr << "*** WARNING AudioEncoderCodec2: Unsupported bitrate \""
+           << value << "\". Ignoring it.\n";
+    }
+  }
+  else if (name == "FRAME_SIZE")
+  {
+    setFrameSize(atof(value.c_str()));
+  }
+  else
+  {
+    cerr << "*** WARNING AudioEncoderCodec2: Unknown option \""
+      	 << name << "\". Ignoring it.\n";
+  }
+} /* AudioEncoderCodec2::setOption */
+
+
+void AudioEncoderCodec2::printCodecParams(void)
+{
+  cout << "------ Codec2 encoder parameters ------\n";
+  cout << "Bitrate         = " << bitrate() << endl;
+  cout << "Frame size      = " << frameSize() << "ms" << endl;
+  cout << "---------------------------------------\n";
+} /* AudioEncoderCodec2::printCodecParams */
+
+
+bool AudioEncoderCodec2::setBitrate(unsigned new_bitrate)
+{
+  const int mode = bitrateToMode(new_bitrate);
+  if (mode < 0)
+  {
+    return false;
+  }
+  if ((m_codec2 != 0) && (new_bitrate == m_bitrate))
+  {
+    return true;
+  }
+
+    // The frame length depend on the mode so the samples that have not been
+    // encoded yet are thrown away
+  codec2_destroy(m_codec2);
+  m_codec2 = codec2_create(mode);
+  m_bitrate = new_bitrate;
+  m_samples_per_frame = codec2_samples_per_frame(m_codec2);
+  m_sample_buf.assign(HIST_LEN + DEC_FACT * m_samples_per_frame, 0.0f);
+  m_buf_len = 0;
+  m_speech.resize(m_samples_per_frame);
+#if INTERNAL_SAMPLE_RATE == 16000
+  m_speech_8k.resize(m_samples_per_frame);
+#endif
+  m_frame_cnt = 0;
+  setFrameSize(m_frame_size);
+  return true;
+} /* AudioEncoderCodec2::setBitrate */
+
+
+void AudioEncoderCodec2::setFrameSize(float frame_size)
+{
+  m_frame_size = frame_size;
+  const float frame_ms = 1000.0f * m_samples_per_frame / 8000;
+  m_frames_per_packet = max(1, static_cast<int>(frame_size / frame_ms + 0.5f));
+  m_packet.resize(m_frames_per_packet * codec2_bytes_per_frame(m_codec2));
+  m_frame_cnt = min(m_frame_cnt, m_frames_per_packet - 1);
+} /* AudioEncoderCodec2::setFrameSize */
+
+
+float AudioEncoderCodec2::frameSize(void) const
+{
+  return 1000.0f * m_frames_per_packet * m_samples_per_frame / 8000;
+} /* AudioEncoderCodec2::frameSize */
+
+
+int AudioEncoderCodec2::writeSamples(const float *samples, int count)
+{
+  const int buf_size = DEC_FACT * m_samples_per_frame;
+  int pos = 0;
+  while (pos < count)
+  {
+    const int cnt = min(count - pos, buf_size - m_buf_len);
+    std::copy(samples + pos, samples + pos + cnt,
+              m_sample_buf.begin() + HIST_LEN + m_buf_len);
+    m_buf_len += cnt;
+    pos += cnt;
+    if (m_buf_len == buf_size)
+    {
+      encodeFrame();
+    }
+  }
+  return count;
+} /* AudioEncoderCodec2::writeSamples */
+
+
+void AudioEncoderCodec2::flushSamples(void)
+{
+  if (m_buf_len > 0)
+  {
+    const int buf_size = DEC_FACT * m_samples_per_frame;
+    std::fill(m_sample_buf.begin() + HIST_LEN + m_buf_len,
+              m_sample_buf.begin() + HIST_LEN + buf_size, 0.0f);
+    m_buf_len = buf_size;
+    encodeFrame();
+  }
+  if (m_frame_cnt > 0)
+  {
+    writeEncodedSamples(&m_packet[0],
+                        m_frame_cnt * codec2_bytes_per_frame(m_codec2));
+    m_frame_cnt = 0;
+  }
+  flushEncodedSamples();
+} /* AudioEncoderCodec2::flushSamples */
+
+
+
+/****************************************************************************
+ *
+ * Protected member functions
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Private member functions
+ *
+ ****************************************************************************/
+
+void AudioEncoderCodec2::encodeFrame(void)
+{
+  float *speech = &m_sample_buf[HIST_LEN];
+#if INTERNAL_SAMPLE_RATE == 16000
+  fdmdv_16_to_8(&m_speech_8k[0], speech, m_samples_per_frame);
+  std::copy(m_sample_buf.end() - HIST_LEN, m_sample_buf.end(),
+            m_sample_buf.begin());
+  speech = &m_speech_8k[0];
+#endif
+  for (int i=0; i<m_samples_per_frame; ++i)
+  {
+    const float sample = speech[i];
+    if (sample > 1.0f)
+    {
+      m_speech[i] = 32767;
+    }
+    else if (sample < -1.0f)
+    {
+      m_speech[i] = -32767;
+    }
+    else
+    {
+      m_speech[i] = static_cast<short>(sample * 32767.0f);
+    }
+  }
+  m_buf_len = 0;
+
+  const int frame_bytes = codec2_bytes_per_frame(m_codec2);
+  codec2_encode(m_codec2, &m_packet[m_frame_cnt * frame_bytes], &m_speech[0]);
+  if (++m_frame_cnt == m_frames_per_packet)
+  {
+    m_frame_cnt = 0;
+    writeEncodedSamples(&m_packet[0], m_packet.size());
+  }
+} /* AudioEncoderCodec2::encodeFrame */
+
+
+
+/*
+ * This file has not been truncated
+ */
@@ -0,0 +1,247 @@
+/**
+@file	 AsyncAudioEncoderCodec2.h
+@brief   An audio encoder that encodes samples using the Codec2 codec
+@author  Tobias Blomberg / SM0SVX
+@date	 2026-10-15
+
+\verbatim
+Async - A library for programming event driven applications
+Copyright (C) 2003-2026 Tobias Blomberg / SM0SVX
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+\endverbatim
+*/
+
+#ifndef ASYNC_AUDIO_ENCODER_CODEC2_INCLUDED
+#define ASYNC_AUDIO_ENCODER_CODEC2_INCLUDED
+
+
+/****************************************************************************
+ *
+ * System Includes
+ *
+ ****************************************************************************/
+
+#include <vector>
+
+
+/****************************************************************************
+ *
+ * Project Includes
+ *
+ ****************************************************************************/
+
+#include <AsyncAudioEncoder.h>
+
+
+/****************************************************************************
+ *
+ * Local Includes
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Forward declarations
+ *
+ ****************************************************************************/
+
+struct CODEC2;
+
+
+/****************************************************************************
+ *
+ * Namespace
+ *
+ ****************************************************************************/
+
+namespace Async
+{
+
+
+/****************************************************************************
+ *
+ * Forward declarations of classes inside of the declared namespace
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Defines & typedefs
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Exported Global Variables
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Class definitions
+ *
+ ****************************************************************************/
+
+/**
+@brief	An audio encoder that encodes samples using the Codec2 codec
+@author Tobias Blomberg / SM0SVX
+@date   2026-10-15
+
+This class implements an audio encoder that use the Codec2 audio codec. Codec2
+is a very low bitrate speech codec, running at 700 to 3200 bits per second,
+intended for narrow links like HF data or satellite links. Codec2 always
+operate on 8kHz audio so, when the internal sample rate is 16kHz, the audio
+is decimated before it is encoded.
+
+The bitrate is set using the BITRATE option. The decoder cannot tell the
+bitrate from the encoded data so it must be set to the same value in the
+decoder. The FRAME_SIZE option set the packet size in milliseconds. It is
+rounded to a whole number of Codec2 frames.
+*/
+class AudioEncoderCodec2 : public AudioEncoder
+{
+  public:
+    /**
+     * @brief   The default bitrate
+     */
+    static const unsigned DEFAULT_BITRATE = 3200;
+
+    /**
+     * @brief   Find the Codec2 mode for a bitrate
+     * @param   bitrate The bitrate in bits per second
+     * @return  Returns the Codec2 mode or -1 if the bitrate is not supported
+     */
+    static int bitrateToMode(unsigned bitrate);
+
+    /**
+     * @brief 	Default constuctor
+     */
+    AudioEncoderCodec2(void);
+
+    /**
+     * @brief 	Destructor
+     */
+    virtual ~AudioEncoderCodec2(void);
+
+    /**
+     * @brief   Get the name of the codec
+     * @returns Return the name of the codec
+     */
+    virtual const char *name(void) const { return "CODEC2"; }
+
+    /**
+     * @brief 	Set an option for the encoder
+     * @param 	name The name of the option
+     * @param 	value The value of the option
+     */
+    virtual void setOption(const std::string &name, const std::string &value);
+
+    /**
+     * @brief Print codec parameter settings
+     */
+    virtual void printCodecParams(void);
+
+    /**
+     * @brief   Set the bitrate to use
+     * @param   new_bitrate The new bitrate in bits per second
+     * @return  Returns \em true on success or \em false if the bitrate is
+     *          not supported by Codec2
+     */
+    bool setBitrate(unsigned new_bitrate);
+
+    /**
+     * @brief   Get the current bitrate
+     * @returns Returns the current bitrate in bits per second
+     */
+    unsigned bitrate(void) const { return m_bitrate; }
+
+    /**
+     * @brief   Set the packet size
+     * @param   frame_size The packet size in milliseconds
+     *
+     * The packet size is rounded to a whole number of Codec2 frames.
+     */
+    void setFrameSize(float frame_size);
+
+    /**
+     * @brief   Get the packet size
+     * @returns Returns the packet size in milliseconds
+     */
+    float frameSize(void) const;
+
+    /**
+     * @brief 	Write samples into this audio sink
+     * @param 	samples The buffer containing the samples
+     * @param 	count The number of samples in the buffer
+     * @return	Returns the number of samples that has been taken care of
+     *
+     * This function is used to write audio into this audio sink. If it
+     * returns 0, no more samples should be written until the resumeOutput
+     * function in the source have been called.
+     * This function is normally only called from a connected source object.
+     */
+    virtual int writeSamples(const float *samples, int count);
+
+    /**
+     * @brief 	Tell the sink to flush the previously written samples
+     *
+     * A partially filled frame is padded with silence and is sent before
+     * the flush is forwarded.
+     */
+    virtual void flushSamples(void);
+
+  protected:
+
+  private:
+    static const float DEFAULT_FRAME_SIZE;
+
+    struct CODEC2*        m_codec2;
+    unsigned              m_bitrate;
+    float                 m_frame_size;
+    int                   m_samples_per_frame;
+    int                   m_frames_per_packet;
+    std::vector<float>    m_sample_buf;
+    int                   m_buf_len;
+    std::vector<float>    m_speech_8k;
+    std::vector<short>    m_speech;
+    std::vector<uint8_t>  m_packet;
+    int                   m_frame_cnt;
+
+    AudioEncoderCodec2(const AudioEncoderCodec2&);
+    AudioEncoderCodec2& operator=(const AudioEncoderCodec2&);
+
+    void encodeFrame(void);
+
+};  /* class AudioEncoderCodec2 */
+
+
+} /* namespace */
+
+#endif /* ASYNC_AUDIO_ENCODER_CODEC2_INCLUDED */
+
+
+
+/*
+ * This file has not been truncated
+ */
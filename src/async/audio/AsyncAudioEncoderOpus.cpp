@@ -36,6 +36,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 #include <cassert>
 #include <cstdlib>
 #include <sstream>
+#include <algorithm>
 
 
 /****************************************************************************
@@ -115,7 +116,8 @@ using namespace Async;
  ****************************************************************************/
 
 AudioEncoderOpus::AudioEncoderOpus(void)
-  : enc(0), frame_size(0), sample_buf(0), buf_len(0)
+  : enc(0), frame_size(0), sample_buf(0), buf_len(0),
+    passthrough_active(false)
 {
   int error;
   enc = opus_encoder_create(INTERNAL_SAMPLE_RATE, 1, OPUS_APPLICATION_AUDIO,
@@ -126,17 +128,7 @@ AudioEncoderOpus::AudioEncoderOpus(void)
     exit(1);
   }
 
-  setFrameSize(20);
-  setBitrate(20000);
-  enableVbr(true);
-  setMaxBandwidth(OPUS_BANDWIDTH_MEDIUMBAND);
-  setBandwidth(OPUS_AUTO);
-  setSignalType(OPUS_SIGNAL_VOICE);
-  enableDtx(false);
-#if OPUS_MAJOR > 0
-  setLsbDepth(16);
-#endif
-
+  setDefaults();
 } /* AsyncAudioEncoderOpus::AsyncAudioEncoderOpus */
 
 
@@ -181,6 +173,22 @@ void AudioEncoderOpus::setOption(const std::string &name,
   {
     enableConstrainedVbr(atoi(value.c_str()) != 0);
   }
+  else if (name == "FEC")
+  {
+    enableInbandFec(atoi(value.c_str()) != 0);
+  }
+  else if (name == "PACKET_LOSS")
+  {
+    setExpectedPacketLoss(atoi(value.c_str()));
+  }
+  else if (name == "DTX")
+  {
+    enableDtx(atoi(value.c_str()) != 0);
+  }
+  else if (name == "PASSTHROUGH")
+  {
+    setPassthrough(atoi(value.c_str()) != 0);
+  }
   else
   {
     cerr << "*** WARNING AudioEncoderOpus: Unknown option \""
@@ -211,6 +219,8 @@ void AudioEncoderOpus::printCodecParams(void)
 #if OPUS_MAJOR > 0
   cout << "LSB depth            = " << lsbDepth() << endl;
 #endif
+  cout << "Passthrough          = "
+       << (passthroughEnabled() ? "YES" : "NO") << endl;
   cout << "--------------------------------------\n";
 } /* AudioEncoderOpus::printCodecParams */
 
@@ -222,6 +232,7 @@ float AudioEncoderOpus::setFrameSize(float new_frame_size_ms)
     static_cast<int>(new_frame_size_ms * INTERNAL_SAMPLE_RATE / 1000);
   delete [] sample_buf;
   sample_buf = new float[frame_size];
+  buf_len = 0;
   return new_frame_size_ms;
 } /* AudioEncoderOpus::setFrameSize */
 
@@ -556,14 +567,21 @@ opus_int32 AudioEncoderOpus::lsbDepth(void)
 #endif
 
 
-void AudioEncoderOpus::reset(void)
+bool AudioEncoderOpus::reset(void)
 {
-  int err = opus_encoder_ctl(enc, OPUS_RESET_STATE);
+    // Initializing the already allocated encoder state restore all settings
+    // to their defaults without allocating any memory
+  int err = opus_encoder_init(enc, INTERNAL_SAMPLE_RATE, 1,
+                              OPUS_APPLICATION_AUDIO);
   if (err != OPUS_OK)
   {
     cerr << "*** ERROR: Could not reset Opus encoder: "
          << opus_strerror(err) << endl;
+    return false;
   }
+  passthrough_active = false;
+  setDefaults();
+  return true;
 } /* AudioEncoderOpus::reset */
 
 
@@ -638,19 +656,7 @@ int AudioEncoderOpus::writeSamples(const float *samples, int count)
     if (buf_len == frame_size)
     {
       buf_len = 0;
-      unsigned char output_buf[4000];
-      opus_int32 nbytes = opus_encode_float(enc, sample_buf, frame_size,
-                                            output_buf, sizeof(output_buf));
-      //cout << "### frame_size=" << frame_size << " nbytes=" << nbytes << endl;
-      if (nbytes > 0)
-      {
-        writeEncodedSamples(output_buf, nbytes);
-      }
-      else if (nbytes < 0)
-      {
-        cerr << "**** ERROR: Opus encoder error: " << opus_strerror(frame_size)
-             << endl;
-      }
+      encodeFrame();
     }
   }
   
@@ -659,6 +665,21 @@ int AudioEncoderOpus::writeSamples(const float *samples, int count)
 } /* AudioEncoderOpus::writeSamples */
 
 
+void AudioEncoderOpus::flushSamples(void)
+{
+    // When using passthrough, the frames must stay aligned with the frames
+    // coming out of the decoder so a partial frame cannot be left in the
+    // buffer until the next transmission
+  if (passthroughEnabled() && (buf_len > 0))
+  {
+    std::fill(sample_buf + buf_len, sample_buf + frame_size, 0.0f);
+    buf_len = 0;
+    encodeFrame();
+  }
+  AudioEncoder::flushSamples();
+} /* AudioEncoderOpus::flushSamples */
+
+
 
 
 /****************************************************************************
@@ -675,6 +696,54 @@ int AudioEncoderOpus::writeSamples(const float *samples, int count)
  *
  ****************************************************************************/
 
+void AudioEncoderOpus::setDefaults(void)
+{
+  if (frame_size != 20 * INTERNAL_SAMPLE_RATE / 1000)
+  {
+    setFrameSize(20);
+  }
+  buf_len = 0;
+  setBitrate(20000);
+  enableVbr(true);
+  setMaxBandwidth(OPUS_BANDWIDTH_MEDIUMBAND);
+  setBandwidth(OPUS_AUTO);
+  setSignalType(OPUS_SIGNAL_VOICE);
+  enableDtx(false);
+#if OPUS_MAJOR > 0
+  setLsbDepth(16);
+#endif
+} /* AudioEncoderOpus::setDefaults */
+
+
+void AudioEncoderOpus::encodeFrame(void)
+{
+  if (writePassthroughFrame(sample_buf, frame_size))
+  {
+    passthrough_active = true;
+    return;
+  }
+  if (passthrough_active)
+  {
+      // The encoder state does not match what the receiver have seen
+    opus_encoder_ctl(enc, OPUS_RESET_STATE);
+    passthrough_active = false;
+  }
+
+  unsigned char output_buf[4000];
+  opus_int32 nbytes = opus_encode_float(enc, sample_buf, frame_size,
+                                        output_buf, sizeof(output_buf));
+  //cout << "### frame_size=" << frame_size << " nbytes=" << nbytes << endl;
+  if (nbytes > 0)
+  {
+    writeEncodedSamples(output_buf, nbytes);
+  }
+  else if (nbytes < 0)
+  {
+    cerr << "**** ERROR: Opus encoder error: " << opus_strerror(frame_size)
+         << endl;
+  }
+} /* AudioEncoderOpus::encodeFrame */
+
 
 
 /*
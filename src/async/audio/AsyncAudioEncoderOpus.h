@@ -156,6 +156,12 @@ class AudioEncoderOpus : public AudioEncoder
      * @brief Print codec parameter settings
      */
     virtual void printCodecParams(void);
+
+    /**
+     * @brief   Resets encoder to be equivalent to a freshly initialized one
+     * @return  Returns \em true on success or \em false on failure
+     */
+    virtual bool reset(void);
     
     /**
      * @brief   Set the complexity to use
@@ -362,11 +368,6 @@ class AudioEncoderOpus : public AudioEncoder
     opus_int32 lsbDepth(void);
 #endif
 
-    /**
-     * @brief   Resets encoder to be equivalent to a freshly initialized one
-     */
-    void reset(void);
-
 #if 0
     /**
      * @brief 	Set the number of frames that are sent in each packet
@@ -409,6 +410,16 @@ class AudioEncoderOpus : public AudioEncoder
      * This function is normally only called from a connected source object.
      */
     virtual int writeSamples(const float *samples, int count);
+
+    /**
+     * @brief 	Tell the sink to flush the previously written samples
+     *
+     * This function is used to tell the sink to flush previously written
+     * samples. When done flushing, the sink should call the
+     * sourceAllSamplesFlushed function.
+     * This function is normally only called from a connected source object.
+     */
+    virtual void flushSamples(void);
     
     
   protected:
@@ -418,11 +429,14 @@ class AudioEncoderOpus : public AudioEncoder
     int       frame_size;
     float     *sample_buf;
     int       buf_len;
+    bool      passthrough_active;
     //int       frames_per_packet;
     //int       frame_cnt;
     
     AudioEncoderOpus(const AudioEncoderOpus&);
     AudioEncoderOpus& operator=(const AudioEncoderOpus&);
+    void encodeFrame(void);
+    void setDefaults(void);
     
 };  /* class AudioEncoderOpus */
 
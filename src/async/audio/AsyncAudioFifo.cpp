@@ -8,7 +8,7 @@ Implements a FIFO (with some extra functionality) for storing samples.
 
 \verbatim
 Async - A library for programming event driven applications
-Copyright (C) 2003-2009  Tobias Blomberg / SM0SVX
+Copyright (C) 2003-2026  Tobias Blomberg / SM0SVX
 
 This program is free software; you can redistribute it and/or modify
 it under the terms of the GNU General Public License as published by
@@ -55,6 +55,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
  ****************************************************************************/
 
 #include "AsyncAudioFifo.h"
+#include "AsyncAudioStats.h"
 
 
 
@@ -118,13 +119,14 @@ static const unsigned  MAX_WRITE_SIZE = 800;
 
 
 AudioFifo::AudioFifo(unsigned fifo_size)
-  : fifo_size(fifo_size), head(0), tail(0),
+  : fifo(0), fifo_size(fifo_size), fifo_mask(0), head(0), tail(0),
     do_overwrite(false), output_stopped(false), prebuf_samples(0),
-    prebuf(false), is_flushing(false), is_full(false), buffering_enabled(true),
-    disable_buffering_when_flushed(false), is_idle(true), input_stopped(false)
+    prebuf(false), is_flushing(false), buffering_enabled(true),
+    disable_buffering_when_flushed(false), is_idle(true), input_stopped(false),
+    m_stats(0)
 {
   assert(fifo_size > 0);
-  fifo = new float[fifo_size];
+  allocateFifo();
 } /* AudioFifo */
 
 
@@ -141,7 +143,7 @@ void AudioFifo::setSize(unsigned new_size)
   {
     delete [] fifo;
     fifo_size = new_size;
-    fifo = new float[fifo_size];
+    allocateFifo();
   }
   clear();
 } /* AudioFifo::setSize */
@@ -149,8 +151,7 @@ void AudioFifo::setSize(unsigned new_size)
 
 unsigned AudioFifo::samplesInFifo(bool ignore_prebuf) const
 {
-  unsigned samples_in_buffer =
-      	  is_full ? fifo_size : (head - tail + fifo_size) % fifo_size;
+  unsigned samples_in_buffer = head - tail;
 
   if (!ignore_prebuf && prebuf && !is_flushing)
   {
@@ -169,7 +170,6 @@ void AudioFifo::clear(void)
 {
   bool was_empty = empty();
   
-  is_full = false;
   tail = head = 0;
   prebuf = (prebuf_samples > 0);
   output_stopped = false;
@@ -222,6 +222,37 @@ void AudioFifo::enableBuffering(bool enable)
 } /* AudioFifo::enableBuffering */
 
 
+unsigned AudioFifo::writeWindow(float **data)
+{
+  const unsigned pos = head & fifo_mask;
+  *data = fifo + pos;
+  if (!buffering_enabled)
+  {
+    return 0;
+  }
+  return min(fifo_size - (head - tail), fifo_mask + 1 - pos);
+} /* AudioFifo::writeWindow */
+
+
+void AudioFifo::commitWrite(unsigned count)
+{
+  assert(count <= fifo_size - (head - tail));
+  if (count == 0)
+  {
+    return;
+  }
+
+  is_idle = false;
+  is_flushing = false;
+  head += count;
+  if (prebuf && (samplesInFifo() > 0))
+  {
+    prebuf = false;
+  }
+  writeSamplesFromFifo();
+} /* AudioFifo::commitWrite */
+
+
 int AudioFifo::writeSamples(const float *samples, int count)
 {
   /*
@@ -234,7 +265,7 @@ int AudioFifo::writeSamples(const float *samples, int count)
   is_idle = false;
   is_flushing = false;
   
-  if (is_full)
+  if (full())
   {
     input_stopped = true;
     return 0;
@@ -252,24 +283,34 @@ int AudioFifo::writeSamples(const float *samples, int count)
   
   if (buffering_enabled)
   {
-    while (!is_full && (samples_written < count))
+    while (!full() && (samples_written < count))
     {
-      while (!is_full && (samples_written < count))
+      unsigned samples_left = count - samples_written;
+      if (do_overwrite)
+      {
+          // Samples that would be overwritten directly are just skipped
+        if (samples_left > fifo_size)
+        {
+          samples_written += samples_left - fifo_size;
+          samples_left = fifo_size;
+        }
+        unsigned space = fifo_size - (head - tail);
+        if (samples_left > space)
+        {
+          tail += samples_left - space;
+        }
+      }
+      else
       {
-	fifo[head] = samples[samples_written++];
-	head = (head < fifo_size-1) ? head + 1 : 0;
-	if (head == tail)
-	{
-	  if (do_overwrite)
-	  {
-      	    tail = (tail < fifo_size-1) ? tail + 1 : 0;
-	  }
-	  else
-	  {
-	    is_full = true;
-	  }
-	}
+        samples_left = min(samples_left, fifo_size - (head - tail));
       }
+      const unsigned pos = head & fifo_mask;
+      const unsigned first = min(samples_left, fifo_mask + 1 - pos);
+      memcpy(fifo + pos, samples + samples_written, first * sizeof(*fifo));
+      memcpy(fifo, samples + samples_written + first,
+             (samples_left - first) * sizeof(*fifo));
+      head += samples_left;
+      samples_written += samples_left;
       
       if (prebuf && (samplesInFifo() > 0))
       {
@@ -315,6 +356,12 @@ void AudioFifo::resumeOutput(void)
     if (buffering_enabled)
     {
       writeSamplesFromFifo();
+        // The sink still want more samples but the stream ran dry
+      if ((m_stats != 0) && (prebuf_samples > 0) && !is_flushing &&
+          !output_stopped && empty())
+      {
+        m_stats->inc(AudioStats::UNDERRUNS);
+      }
     }
     else if (input_stopped)
     {
@@ -362,6 +409,22 @@ void AudioFifo::allSamplesFlushed(void)
  ****************************************************************************/
 
 
+void AudioFifo::allocateFifo(void)
+{
+    // The buffer size is rounded up to a power of two so that the
+    // positions can be wrapped using a mask. The head and tail counters
+    // are never wrapped, which make the number of samples in the FIFO
+    // simply head - tail.
+  fifo_mask = 1;
+  while (fifo_mask < fifo_size)
+  {
+    fifo_mask <<= 1;
+  }
+  fifo = new float[fifo_mask];
+  fifo_mask -= 1;
+} /* AudioFifo::allocateFifo */
+
+
 void AudioFifo::writeSamplesFromFifo(void)
 {
   if (output_stopped || (samplesInFifo() == 0))
@@ -369,24 +432,18 @@ void AudioFifo::writeSamplesFromFifo(void)
     return;
   }
   
-  bool was_full = full();
-  
   int samples_written;
   do
   {
+    const unsigned pos = tail & fifo_mask;
     int samples_to_write = min(MAX_WRITE_SIZE, samplesInFifo(true));
-    int to_end_of_fifo = fifo_size - tail;
+    int to_end_of_fifo = fifo_mask + 1 - pos;
     samples_to_write = min(samples_to_write, to_end_of_fifo);
-    samples_written = sinkWriteSamples(fifo+tail, samples_to_write);
+    samples_written = sinkWriteSamples(fifo+pos, samples_to_write);
     //printf("AudioFifo::writeSamplesFromFifo(%s): samples_to_write=%d "
     //  	   "samples_written=%d\n", debug_name.c_str(), samples_to_write,
 	//   samples_written);
-    if (was_full && (samples_written > 0))
-    {
-      is_full = false;
-      was_full = false;
-    }
-    tail = (tail + samples_written) % fifo_size;
+    tail += samples_written;
   } while((samples_written > 0) && !empty());
   
   if (samples_written == 0)
@@ -8,7 +8,7 @@ Implements a FIFO (with some extra functionality) for storing samples.
 
 \verbatim
 Async - A library for programming event driven applications
-Copyright (C) 2003-2009  Tobias Blomberg / SM0SVX
+Copyright (C) 2003-2026  Tobias Blomberg / SM0SVX
 
 This program is free software; you can redistribute it and/or modify
 it under the terms of the GNU General Public License as published by
@@ -81,6 +81,8 @@ namespace Async
  *
  ****************************************************************************/
 
+class AudioStats;
+
   
 
 /****************************************************************************
@@ -145,7 +147,7 @@ class AudioFifo : public AudioSink, public AudioSource
      * @brief 	Check if the FIFO is empty
      * @return	Returns \em true if the FIFO is empty or else \em false
      */
-    bool empty(void) const { return !is_full && (tail == head); }
+    bool empty(void) const { return tail == head; }
     
     /**
      * @brief 	Check if the FIFO is full
@@ -155,7 +157,10 @@ class AudioFifo : public AudioSink, public AudioSource
      * only reach the buffer full condition if overwrite is false. The overwrite
      * mode is set by the setOverwrite function.
      */
-    bool full(void) const { return is_full; }
+    bool full(void) const
+    {
+      return !do_overwrite && (head - tail == fifo_size);
+    }
     
     /**
      * @brief 	Find out how many samples there are in the FIFO
@@ -225,6 +230,41 @@ class AudioFifo : public AudioSink, public AudioSource
      * @return  Returns \em true if buffering is enabled or else \em false
      */
     bool bufferingEnabled(void) const { return buffering_enabled; }
+
+    /**
+     * @brief   Set the object to report audio health statistics to
+     * @param   stats The statistics object or 0 to disable reporting
+     *
+     * When set, an underrun is reported each time a pre-buffered FIFO run
+     * empty in the middle of a stream, that is when the sink ask for more
+     * samples and there are none. The statistics object is not owned by the
+     * FIFO.
+     */
+    void setStats(AudioStats *stats) { m_stats = stats; }
+
+    /**
+     * @brief   Get a window into the FIFO for writing samples in place
+     * @param   data Set to point at the first free sample in the FIFO
+     * @return  Returns the number of samples that can be written at data
+     *
+     * This function can be used by code that produce samples to write them
+     * directly into the FIFO buffer instead of writing them using the
+     * writeSamples function, which would copy them. The returned window is
+     * contiguous so it may be smaller than the free space in the FIFO. Call
+     * commitWrite when the samples have been written. The window never
+     * overwrite samples in the FIFO, even if overwrite mode is enabled.
+     * Zero is returned if the FIFO is full or if buffering is disabled.
+     */
+    unsigned writeWindow(float **data);
+
+    /**
+     * @brief   Commit samples written to the window returned by writeWindow
+     * @param   count The number of samples written, at most the window size
+     *
+     * The committed samples are handled just as if they had been written
+     * using the writeSamples function.
+     */
+    void commitWrite(unsigned count);
     
     /**
      * @brief 	Write samples into the FIFO
@@ -272,18 +312,20 @@ class AudioFifo : public AudioSink, public AudioSource
   private:    
     float     	*fifo;
     unsigned    fifo_size;
+    unsigned    fifo_mask;
     unsigned    head, tail;
     bool      	do_overwrite;
     bool      	output_stopped;
     unsigned  	prebuf_samples;
     bool      	prebuf;
     bool      	is_flushing;
-    bool      	is_full;
     bool        buffering_enabled;
     bool      	disable_buffering_when_flushed;
     bool      	is_idle;
     bool      	input_stopped;
+    AudioStats  *m_stats;
     
+    void allocateFifo(void);
     void writeSamplesFromFifo(void);
 
 };  /* class AudioFifo */
@@ -59,6 +59,7 @@ extern "C" {
 };
 
 #include "AsyncAudioFilter.h"
+#include "AsyncAudioBiquadCascade.h"
 
 
 
@@ -96,6 +97,7 @@ namespace Async
       FidRun    	*run;
       FidFunc   	*func;
       void      	*buf;
+      AudioBiquadCascade  sos;
 
       FidVars(void) : ff(0), run(0), func(0), buf(0) {}
   };
@@ -177,8 +179,14 @@ bool AudioFilter::parseFilterSpec(const std::string &filter_spec)
     deleteFilter();
     return false;
   }
-  fv->run = fid_run_new(fv->ff, &fv->func);
-  fv->buf = fid_run_newbuf(fv->run);
+
+    // Use the compiled biquad cascade if the filter can be converted to
+    // second order sections. Otherwise let fidlib run the filter.
+  if (!fv->sos.setFidFilter(fv->ff))
+  {
+    fv->run = fid_run_new(fv->ff, &fv->func);
+    fv->buf = fid_run_newbuf(fv->run);
+  }
   return true;
 } /* AudioFilter::parseFilterSpec */
 
@@ -191,7 +199,14 @@ void AudioFilter::setOutputGain(float gain_db)
 
 void AudioFilter::reset(void)
 {
-  fid_run_zapbuf(fv->buf);
+  if (fv->run != 0)
+  {
+    fid_run_zapbuf(fv->buf);
+  }
+  else
+  {
+    fv->sos.reset();
+  }
 } /* AudioFilter::reset */
 
 
@@ -207,6 +222,19 @@ void AudioFilter::processSamples(float *dest, const float *src, int count)
 {
   //cout << "AudioFilter::processSamples: len=" << len << endl;
   
+  if (fv->run == 0)
+  {
+    fv->sos.process(dest, src, count);
+    if (output_gain != 1.0f)
+    {
+      for (int i=0; i<count; ++i)
+      {
+        dest[i] *= output_gain;
+      }
+    }
+    return;
+  }
+
   for (int i=0; i<count; ++i)
   {
     dest[i] = output_gain * fv->func(fv->buf, src[i]);
@@ -226,12 +254,12 @@ void AudioFilter::deleteFilter(void)
 {
   if (fv != 0)
   {
-    if (fv->ff != 0)
+    if (fv->run != 0)
     {
       fid_run_freebuf(fv->buf);
       fid_run_free(fv->run);
-      free(fv->ff);
     }
+    free(fv->ff);
     delete fv;
     fv = 0;
   }
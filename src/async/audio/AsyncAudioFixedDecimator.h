@@ -0,0 +1,239 @@
+/**
+@file	 AsyncAudioFixedDecimator.h
+@brief   A decimator with a compile time factor and filter length
+@author  Tobias Blomberg / SM0SVX
+@date	 2026-10-15
+
+\verbatim
+Async - A library for programming event driven applications
+Copyright (C) 2003-2026 Tobias Blomberg / SM0SVX
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+\endverbatim
+*/
+
+#ifndef ASYNC_AUDIO_FIXED_DECIMATOR_INCLUDED
+#define ASYNC_AUDIO_FIXED_DECIMATOR_INCLUDED
+
+
+/****************************************************************************
+ *
+ * System Includes
+ *
+ ****************************************************************************/
+
+#include <vector>
+#include <cassert>
+
+
+/****************************************************************************
+ *
+ * Project Includes
+ *
+ ****************************************************************************/
+
+#include <AsyncAudioProcessor.h>
+
+
+/****************************************************************************
+ *
+ * Local Includes
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Forward declarations
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Namespace
+ *
+ ****************************************************************************/
+
+namespace Async
+{
+
+
+/****************************************************************************
+ *
+ * Forward declarations of classes inside of the declared namespace
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Defines & typedefs
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Exported Global Variables
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Class definitions
+ *
+ ****************************************************************************/
+
+/**
+@brief	A decimator with the factor and filter length set at compile time
+@author Tobias Blomberg / SM0SVX
+@date   2026-10-15
+
+This audio pipe class do the same thing as Async::AudioDecimator but the
+decimation factor and the number of filter taps are template parameters. That
+make all loop bounds compile time constants so that the compiler can unroll
+and vectorize the filter for each specific combination. Linear phase filters,
+with symmetric coefficients, are detected when the object is created and are
+then folded so that each coefficient is only multiplied once for each pair of
+samples.
+
+\code
+  static constexpr int coeff_taps = 30;
+  static constexpr float coeff[coeff_taps] = { ... };
+  AudioProcessor *dec = new AudioFixedDecimator<3, coeff_taps>(coeff);
+\endcode
+*/
+template <int M, int TAPS>
+class AudioFixedDecimator : public AudioProcessor
+{
+  public:
+    /**
+     * @brief 	Constructor
+     * @param 	coeff An array holding the filter coefficients
+     */
+    explicit AudioFixedDecimator(const float (&coeff)[TAPS])
+      : m_symmetric(true)
+    {
+      static_assert((M > 0) && (TAPS >= M),
+                    "The filter must be at least as long as the factor");
+      setInputOutputSampleRate(M, 1);
+
+        // The coefficients are stored in reverse order, that is the
+        // coefficient for the oldest sample first, so that the filter can
+        // run forward over the sample buffer
+      for (int k=0; k<TAPS; ++k)
+      {
+        m_coeff[k] = coeff[TAPS - 1 - k];
+        m_symmetric = m_symmetric && (coeff[k] == coeff[TAPS - 1 - k]);
+      }
+      m_buf.assign(TAPS - 1, 0.0f);
+    }
+
+    /**
+     * @brief 	Destructor
+     */
+    ~AudioFixedDecimator(void) {}
+
+    /**
+     * @brief   Find out if the filter coefficients are symmetric
+     * @return  Returns \em true if the folded filter is used
+     */
+    bool isSymmetric(void) const { return m_symmetric; }
+
+  protected:
+    /**
+     * @brief Process incoming samples and put them into the output buffer
+     * @param dest  Destination buffer
+     * @param src   Source buffer
+     * @param count Number of samples in the source buffer
+     */
+    virtual void processSamples(float *dest, const float *src, int count)
+    {
+        // this implementation assumes count is a multiple of M
+      assert(count % M == 0);
+
+        // The delay line is kept first in the buffer so that the new samples
+        // end up right after it
+      m_buf.insert(m_buf.end(), src, src + count);
+      const float *x = &m_buf[M - 1];
+      const int out_cnt = count / M;
+      if (m_symmetric)
+      {
+        for (int i=0; i<out_cnt; ++i, x+=M)
+        {
+          *dest++ = firSym(x);
+        }
+      }
+      else
+      {
+        for (int i=0; i<out_cnt; ++i, x+=M)
+        {
+          *dest++ = fir(x);
+        }
+      }
+      m_buf.erase(m_buf.begin(), m_buf.end() - (TAPS - 1));
+    }
+
+  private:
+    float               m_coeff[TAPS];
+    bool                m_symmetric;
+    std::vector<float>  m_buf;
+
+    AudioFixedDecimator(const AudioFixedDecimator&);
+    AudioFixedDecimator& operator=(const AudioFixedDecimator&);
+
+    inline float fir(const float *x) const
+    {
+      float sum = 0.0f;
+      for (int k=0; k<TAPS; ++k)
+      {
+        sum += m_coeff[k] * x[k];
+      }
+      return sum;
+    }
+
+    inline float firSym(const float *x) const
+    {
+      float sum = 0.0f;
+      for (int k=0; k<TAPS/2; ++k)
+      {
+        sum += m_coeff[k] * (x[k] + x[TAPS - 1 - k]);
+      }
+      if (TAPS % 2 == 1)
+      {
+        sum += m_coeff[TAPS/2] * x[TAPS/2];
+      }
+      return sum;
+    }
+
+};  /* class AudioFixedDecimator */
+
+
+} /* namespace */
+
+#endif /* ASYNC_AUDIO_FIXED_DECIMATOR_INCLUDED */
+
+
+
+/*
+ * This file has not been truncated
+ */
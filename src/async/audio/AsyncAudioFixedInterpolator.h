@@ -0,0 +1,203 @@
+/**
+@file	 AsyncAudioFixedInterpolator.h
+@brief   An interpolator with a compile time factor and filter length
+@author  Tobias Blomberg / SM0SVX
+@date	 2026-10-15
+
+\verbatim
+Async - A library for programming event driven applications
+Copyright (C) 2003-2026 Tobias Blomberg / SM0SVX
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+\endverbatim
+*/
+
+#ifndef ASYNC_AUDIO_FIXED_INTERPOLATOR_INCLUDED
+#define ASYNC_AUDIO_FIXED_INTERPOLATOR_INCLUDED
+
+
+/****************************************************************************
+ *
+ * System Includes
+ *
+ ****************************************************************************/
+
+#include <vector>
+#include <cassert>
+
+
+/****************************************************************************
+ *
+ * Project Includes
+ *
+ ****************************************************************************/
+
+#include <AsyncAudioProcessor.h>
+
+
+/****************************************************************************
+ *
+ * Local Includes
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Forward declarations
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Namespace
+ *
+ ****************************************************************************/
+
+namespace Async
+{
+
+
+/****************************************************************************
+ *
+ * Forward declarations of classes inside of the declared namespace
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Defines & typedefs
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Exported Global Variables
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Class definitions
+ *
+ ****************************************************************************/
+
+/**
+@brief	An interpolator with the factor and filter length set at compile time
+@author Tobias Blomberg / SM0SVX
+@date   2026-10-15
+
+This audio pipe class do the same thing as Async::AudioInterpolator but the
+interpolation factor and the number of filter taps are template parameters.
+The filter is split into one polyphase filter per output phase when the object
+is created, with the coefficients for each phase stored contiguously and the
+gain compensation for the interpolation applied. With the loop bounds known at
+compile time, the compiler can unroll and vectorize the filter. The number of
+taps must be a multiple of the interpolation factor.
+
+\code
+  static constexpr int coeff_taps = 30;
+  static constexpr float coeff[coeff_taps] = { ... };
+  AudioProcessor *interp = new AudioFixedInterpolator<3, coeff_taps>(coeff);
+\endcode
+*/
+template <int L, int TAPS>
+class AudioFixedInterpolator : public AudioProcessor
+{
+  public:
+    /**
+     * @brief 	Constructor
+     * @param 	coeff An array holding the filter coefficients
+     */
+    explicit AudioFixedInterpolator(const float (&coeff)[TAPS])
+    {
+      static_assert((L > 0) && (TAPS % L == 0),
+                    "The filter length must be a multiple of the factor");
+      setInputOutputSampleRate(1, L);
+
+        // Each phase is stored with the coefficient for the oldest sample
+        // first so that the filter can run forward over the sample buffer
+      for (int phase=0; phase<L; ++phase)
+      {
+        for (int tap=0; tap<PHASE_TAPS; ++tap)
+        {
+          m_coeff[phase][PHASE_TAPS - 1 - tap] = L * coeff[phase + tap * L];
+        }
+      }
+      m_buf.assign(PHASE_TAPS - 1, 0.0f);
+    }
+
+    /**
+     * @brief 	Destructor
+     */
+    ~AudioFixedInterpolator(void) {}
+
+  protected:
+    /**
+     * @brief Process incoming samples and put them into the output buffer
+     * @param dest  Destination buffer
+     * @param src   Source buffer
+     * @param count Number of samples in the source buffer
+     */
+    virtual void processSamples(float *dest, const float *src, int count)
+    {
+      m_buf.insert(m_buf.end(), src, src + count);
+      const float *x = &m_buf[0];
+      for (int i=0; i<count; ++i, ++x)
+      {
+        for (int phase=0; phase<L; ++phase)
+        {
+          const float *h = m_coeff[phase];
+          float sum = 0.0f;
+          for (int tap=0; tap<PHASE_TAPS; ++tap)
+          {
+            sum += h[tap] * x[tap];
+          }
+          *dest++ = sum;
+        }
+      }
+      m_buf.erase(m_buf.begin(), m_buf.end() - (PHASE_TAPS - 1));
+    }
+
+  private:
+    static const int PHASE_TAPS = TAPS / L;
+
+    float               m_coeff[L][PHASE_TAPS];
+    std::vector<float>  m_buf;
+
+    AudioFixedInterpolator(const AudioFixedInterpolator&);
+    AudioFixedInterpolator& operator=(const AudioFixedInterpolator&);
+
+};  /* class AudioFixedInterpolator */
+
+
+} /* namespace */
+
+#endif /* ASYNC_AUDIO_FIXED_INTERPOLATOR_INCLUDED */
+
+
+
+/*
+ * This file has not been truncated
+ */
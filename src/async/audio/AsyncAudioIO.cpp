@@ -316,6 +316,18 @@ bool AudioIO::isFullDuplexCapable(void)
 } /* AudioIO::isFullDuplexCapable */
 
 
+unsigned long AudioIO::playbackXrunCount(void) const
+{
+  return (audio_dev != 0) ? audio_dev->playbackXrunCount() : 0;
+} /* AudioIO::playbackXrunCount */
+
+
+unsigned long AudioIO::captureXrunCount(void) const
+{
+  return (audio_dev != 0) ? audio_dev->captureXrunCount() : 0;
+} /* AudioIO::captureXrunCount */
+
+
 bool AudioIO::open(Mode mode)
 {
   if (m_channel >= AudioDevice::getChannels())
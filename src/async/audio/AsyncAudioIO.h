@@ -302,6 +302,26 @@ class AudioIO : public Async::AudioSource, public Async::AudioSink
      * @return  Returns the audio channel that was given to the constructor
      */
     size_t channel(void) const { return m_channel; }
+
+    /**
+     * @brief   Get the number of playback underruns for the audio device
+     * @return  Returns the number of underruns counted for the audio device
+     *
+     * The counter is shared by all AudioIO objects using the same audio
+     * device. Audio devices that do not keep track of underruns always
+     * return 0.
+     */
+    unsigned long playbackXrunCount(void) const;
+
+    /**
+     * @brief   Get the number of capture overruns for the audio device
+     * @return  Returns the number of overruns counted for the audio device
+     *
+     * The counter is shared by all AudioIO objects using the same audio
+     * device. Audio devices that do not keep track of overruns always
+     * return 0.
+     */
+    unsigned long captureXrunCount(void) const;
     
     /**
      * @brief Resume audio output to the sink
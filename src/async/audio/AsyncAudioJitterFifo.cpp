@@ -36,6 +36,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 
 #include <cstdio>
 #include <cstring>
+#include <cmath>
 #include <algorithm>
 #include <cassert>
 
@@ -55,6 +56,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
  ****************************************************************************/
 
 #include "AsyncAudioJitterFifo.h"
+#include "AsyncAudioStats.h"
 
 
 
@@ -109,6 +111,16 @@ using namespace Async;
 
 static const unsigned  MAX_WRITE_SIZE = 800;
 
+  // Adaptive mode parameters. The arrival jitter is estimated over the last
+  // HIST_LEN packets and the playout delay is measured as the median of the
+  // last DELAY_HIST_LEN packets.
+static const size_t    HIST_LEN = 250;
+static const size_t    DELAY_HIST_LEN = 8;
+static const int       MIN_LAG = INTERNAL_SAMPLE_RATE / 400;   // 2.5ms
+static const int       MAX_LAG = INTERNAL_SAMPLE_RATE / 80;    // 12.5ms
+static const int       OVERLAP = INTERNAL_SAMPLE_RATE / 200;   // 5ms
+static const unsigned  HYSTERESIS = INTERNAL_SAMPLE_RATE / 200; // 5ms
+
 
 /****************************************************************************
  *
@@ -119,10 +131,14 @@ static const unsigned  MAX_WRITE_SIZE = 800;
 
 AudioJitterFifo::AudioJitterFifo(unsigned fifo_size)
   : fifo_size(fifo_size), head(0), tail(0),
-    output_stopped(false), prebuf(true), is_flushing(false)
+    output_stopped(false), prebuf(true), is_flushing(false),
+    adaptive(false), min_delay(0), max_delay(0), in_spurt(false),
+    spurt_media(0.0), min_rel_delay(0.0), media_since_stretch(0), m_stats(0)
 {
   assert(fifo_size > 0);
   fifo = new float[fifo_size];
+  stats.target_delay = 0;
+  resetStatistics();
 } /* AudioJitterFifo */
 
 
@@ -151,7 +167,8 @@ unsigned AudioJitterFifo::samplesInFifo(void) const
 
   if (prebuf && !is_flushing)
   {
-    if (samples_in_buffer < (fifo_size >> 1))
+    unsigned prebuf_size = adaptive ? stats.target_delay : (fifo_size >> 1);
+    if ((samples_in_buffer == 0) || (samples_in_buffer < prebuf_size))
     {
       return 0;
     }
@@ -169,6 +186,8 @@ void AudioJitterFifo::clear(void)
   tail = head = 0;
   prebuf = true;
   output_stopped = false;
+  in_spurt = false;
+  delay_hist.clear();
   
   if (is_flushing)
   {
@@ -191,15 +210,33 @@ int AudioJitterFifo::writeSamples(const float *samples, int count)
     prebuf = true;
   }
 
-  int samples_written = 0;
-  while (samples_written < count)
+  const float *src = samples;
+  int src_count = count;
+  if (adaptive)
+  {
+    stats.received_frames += 1;
+    updateDelayEstimate(count);
+    src = adaptPlayoutDelay(samples, src_count);
+  }
+
+  for (int i=0; i<src_count; ++i)
   {
-    fifo[head] = samples[samples_written++];
+    fifo[head] = src[i];
     head = (head + 1) % fifo_size;
     if (head == tail)
     {
-        // Throw away the first half of the buffer.
-      tail = (tail + (fifo_size >> 1)) % fifo_size;
+      if (adaptive)
+      {
+          // Throw away all but the target delay
+        unsigned drop = fifo_size - max(stats.target_delay, 1U);
+        tail = (tail + drop) % fifo_size;
+        stats.dropped_samples += drop;
+      }
+      else
+      {
+          // Throw away the first half of the buffer.
+        tail = (tail + (fifo_size >> 1)) % fifo_size;
+      }
     }
   }
 
@@ -210,7 +247,7 @@ int AudioJitterFifo::writeSamples(const float *samples, int count)
   
   writeSamplesFromFifo();
 
-  return samples_written;
+  return count;
   
 } /* writeSamples */
 
@@ -218,10 +255,16 @@ int AudioJitterFifo::writeSamples(const float *samples, int count)
 void AudioJitterFifo::flushSamples(void)
 {
   is_flushing = true;
+  in_spurt = false;
   if (empty())
   {
     sinkFlushSamples();
   }
+  else if (adaptive)
+  {
+      // Write samples that may be held back by prebuffering
+    writeSamplesFromFifo();
+  }
 } /* AudioJitterFifo::flushSamples */
 
 
@@ -235,6 +278,27 @@ void AudioJitterFifo::resumeOutput(void)
 } /* resumeOutput */
 
 
+void AudioJitterFifo::enableAdaptive(unsigned min_delay, unsigned max_delay)
+{
+  assert((max_delay > 0) && (min_delay <= max_delay));
+  adaptive = true;
+  this->min_delay = min_delay;
+  this->max_delay = max_delay;
+  spread_hist.clear();
+  setSize(max(fifo_size, 2 * max_delay));
+  resetStatistics();
+  stats.target_delay = min_delay;
+} /* AudioJitterFifo::enableAdaptive */
+
+
+void AudioJitterFifo::resetStatistics(void)
+{
+  unsigned target_delay = stats.target_delay;
+  stats = Stats();
+  stats.target_delay = target_delay;
+} /* AudioJitterFifo::resetStatistics */
+
+
 
 /****************************************************************************
  *
@@ -273,8 +337,12 @@ void AudioJitterFifo::writeSamplesFromFifo(void)
     return;
   }
 
-  int samples_written;
-  if (prebuf && !empty())
+  int samples_written = 1;
+  if (adaptive && prebuf && !is_flushing)
+  {
+      // Just wait for the target delay to be reached
+  }
+  else if (prebuf && !empty())
   {
     float silence[MAX_WRITE_SIZE];
     for (unsigned i=0; i<MAX_WRITE_SIZE; i++)
@@ -287,7 +355,7 @@ void AudioJitterFifo::writeSamplesFromFifo(void)
       samples_written = sinkWriteSamples(silence, MAX_WRITE_SIZE);
     } while ((samples_written > 0) && (--timeout));
   }
-  else
+  else if (!empty())
   {
     do
     {
@@ -312,6 +380,14 @@ void AudioJitterFifo::writeSamplesFromFifo(void)
     }
     else
     {
+      if (adaptive && !prebuf)
+      {
+        stats.underruns += 1;
+      }
+      if ((m_stats != 0) && !prebuf)
+      {
+        m_stats->inc(AudioStats::UNDERRUNS);
+      }
       prebuf = true;
     }
   }
@@ -319,6 +395,167 @@ void AudioJitterFifo::writeSamplesFromFifo(void)
 } /* writeSamplesFromFifo */
 
 
+unsigned AudioJitterFifo::samplesBuffered(void) const
+{
+  return (head - tail + fifo_size) % fifo_size;
+} /* AudioJitterFifo::samplesBuffered */
+
+
+/*
+ *----------------------------------------------------------------------------
+ * Method:    AudioJitterFifo::updateDelayEstimate
+ * Purpose:   Update the target delay from the arrival time of a packet.
+ *            The relative delay of each packet is the difference between
+ *            the time elapsed since the start of the talk spurt and the
+ *            amount of audio received. The spread is the relative delay
+ *            measured from the earliest packet in the talk spurt.
+ * Input:     count - The number of samples in the packet
+ * Output:    None
+ * Author:    Tobias Blomberg / SM0SVX
+ * Created:   2026-10-14
+ * Remarks:   
+ * Bugs:      
+ *----------------------------------------------------------------------------
+ */
+void AudioJitterFifo::updateDelayEstimate(unsigned count)
+{
+  chrono::steady_clock::time_point now = chrono::steady_clock::now();
+  if (!in_spurt)
+  {
+    in_spurt = true;
+    spurt_start = now;
+    spurt_media = 0.0;
+    min_rel_delay = 0.0;
+  }
+  chrono::duration<double> elapsed = now - spurt_start;
+  double rel_delay = elapsed.count() * INTERNAL_SAMPLE_RATE - spurt_media;
+  min_rel_delay = min(min_rel_delay, rel_delay);
+  spurt_media += count;
+
+  double spread = min(rel_delay - min_rel_delay, double(max_delay));
+  spread_hist.push_back(static_cast<unsigned>(spread + 0.5));
+  if (spread_hist.size() > HIST_LEN)
+  {
+    spread_hist.pop_front();
+  }
+
+  vector<unsigned> sorted(spread_hist.begin(), spread_hist.end());
+  vector<unsigned>::iterator p95 = sorted.begin() + sorted.size() * 95 / 100;
+  nth_element(sorted.begin(), p95, sorted.end());
+  unsigned target = *p95 + count;
+  stats.target_delay = min(max(target, min_delay), max_delay);
+} /* AudioJitterFifo::updateDelayEstimate */
+
+
+/*
+ *----------------------------------------------------------------------------
+ * Method:    AudioJitterFifo::adaptPlayoutDelay
+ * Purpose:   Time-stretch an incoming packet if the playout delay is too
+ *            far away from the target. The playout delay is the number of
+ *            buffered samples plus the spread of the packet, which is
+ *            constant as long as no stretching is done.
+ * Input:     samples - The samples in the packet
+ *            count   - The number of samples. Updated on return.
+ * Output:    Returns a pointer to the samples to store in the FIFO
+ * Author:    Tobias Blomberg / SM0SVX
+ * Created:   2026-10-14
+ * Remarks:   
+ * Bugs:      
+ *----------------------------------------------------------------------------
+ */
+const float *AudioJitterFifo::adaptPlayoutDelay(const float *samples,
+                                                int &count)
+{
+  if (prebuf)
+  {
+    delay_hist.clear();
+    return samples;
+  }
+
+  media_since_stretch += count;
+  delay_hist.push_back(samplesBuffered() + count + spread_hist.back());
+  if (delay_hist.size() > DELAY_HIST_LEN)
+  {
+    delay_hist.pop_front();
+  }
+  if (delay_hist.size() < DELAY_HIST_LEN / 2)
+  {
+    return samples;
+  }
+  vector<unsigned> sorted(delay_hist.begin(), delay_hist.end());
+  vector<unsigned>::iterator median = sorted.begin() + sorted.size() / 2;
+  nth_element(sorted.begin(), median, sorted.end());
+  const bool compress = (*median > stats.target_delay + HYSTERESIS);
+  const bool expand = (*median + HYSTERESIS < stats.target_delay);
+  const int max_lag = min(MAX_LAG, count - OVERLAP);
+  if ((!compress && !expand) || (max_lag < MIN_LAG))
+  {
+    return samples;
+  }
+
+    // Find the lag, within the pitch range, where the start of the packet
+    // best match itself. For silence, use the largest lag.
+  int lag = max_lag;
+  double best_corr = 0.0;
+  for (int k=MIN_LAG; k<=max_lag; ++k)
+  {
+    double xy = 0.0, xx = 0.0, yy = 0.0;
+    for (int i=0; i<OVERLAP; ++i)
+    {
+      xy += samples[i] * samples[k + i];
+      xx += samples[i] * samples[i];
+      yy += samples[k + i] * samples[k + i];
+    }
+    if ((xx > 1.0e-6) && (yy > 1.0e-6) && (xy / sqrt(xx * yy) > best_corr))
+    {
+      best_corr = xy / sqrt(xx * yy);
+      lag = k;
+    }
+  }
+
+    // Do not change the playout rate by more than ten percent
+  if (media_since_stretch < 10UL * lag)
+  {
+    return samples;
+  }
+
+  if (compress)
+  {
+      // Remove lag samples by cross fading from the start of the packet
+      // into the same position one lag later
+    stretch_buf.resize(count - lag);
+    for (int i=0; i<OVERLAP; ++i)
+    {
+      float w = (i + 0.5f) / OVERLAP;
+      stretch_buf[i] = (1.0f - w) * samples[i] + w * samples[lag + i];
+    }
+    copy(samples + lag + OVERLAP, samples + count,
+         stretch_buf.begin() + OVERLAP);
+    stats.dropped_samples += lag;
+  }
+  else
+  {
+      // Insert lag samples by cross fading from one lag into the packet
+      // back to the start of the packet
+    stretch_buf.resize(count + lag);
+    copy(samples, samples + lag, stretch_buf.begin());
+    for (int i=0; i<OVERLAP; ++i)
+    {
+      float w = (i + 0.5f) / OVERLAP;
+      stretch_buf[lag + i] = (1.0f - w) * samples[lag + i] + w * samples[i];
+    }
+    copy(samples + OVERLAP, samples + count,
+         stretch_buf.begin() + lag + OVERLAP);
+    stats.concealed_samples += lag;
+  }
+
+  media_since_stretch = 0;
+  delay_hist.clear();
+  count = stretch_buf.size();
+  return &stretch_buf[0];
+} /* AudioJitterFifo::adaptPlayoutDelay */
+
+
 
 /*
  * This file has not been truncated
@@ -37,6 +37,9 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
  *
  ****************************************************************************/
 
+#include <chrono>
+#include <deque>
+#include <vector>
 
 
 /****************************************************************************
@@ -81,7 +84,8 @@ namespace Async
  *
  ****************************************************************************/
 
-  
+class AudioStats;
+
 
 /****************************************************************************
  *
@@ -116,10 +120,36 @@ of sample rate or packet jitter. Under normal operation, the FIFO is kept
 half full. Varying sample rates or packet rates slowly move the amount of
 samples out of center. When the FIFO reaches a full or empty state, it is
 automatically reset to the half-full state.
+
+The FIFO can also be put in adaptive mode using the enableAdaptive function.
+The target delay is then continuously estimated from the arrival times of
+the written sample blocks, which are assumed to be network packets. The
+target is the delay needed to cover 95% of the arrival jitter seen during the
+last few seconds, plus one packet. The FIFO is prebuffered up to the target
+delay and then the playout delay is adjusted toward the target, during
+playout, by time-stretching the incoming audio using a simple WSOLA method.
+One pitch period is removed or inserted at a time, at the best matching
+position in the packet, so that the playout rate never change by more than
+ten percent. The FIFO does not write silence while prebuffering in adaptive
+mode.
 */
 class AudioJitterFifo : public AudioSink, public AudioSource
 {
   public:
+    /**
+     * @brief Statistics for the adaptive mode
+     */
+    struct Stats
+    {
+      unsigned long received_frames;    ///< Number of blocks written
+      unsigned long late_frames;        ///< Reported late frames
+      unsigned long lost_frames;        ///< Reported lost frames
+      unsigned long underruns;          ///< Times the FIFO ran empty
+      unsigned long concealed_samples;  ///< Samples inserted by stretching
+      unsigned long dropped_samples;    ///< Samples removed or discarded
+      unsigned      target_delay;       ///< Current target delay in samples
+    };
+
     /**
      * @brief 	Constuctor
      * @param   fifo_size This is the size of the fifo expressed in number
@@ -192,6 +222,65 @@ class AudioJitterFifo : public AudioSink, public AudioSource
      * This function is normally only called from a connected sink object.
      */
     virtual void resumeOutput(void);
+
+    /**
+     * @brief 	Enable the adaptive jitter buffer mode
+     * @param 	min_delay The minimum target delay in samples
+     * @param 	max_delay The maximum target delay in samples
+     *
+     * The FIFO will be resized to hold at least two times the maximum
+     * delay. The target delay will start at the minimum delay.
+     */
+    void enableAdaptive(unsigned min_delay, unsigned max_delay);
+
+    /**
+     * @brief 	Check if the adaptive mode is enabled
+     * @return	Returns \em true if the adaptive mode is enabled
+     */
+    bool isAdaptive(void) const { return adaptive; }
+
+    /**
+     * @brief 	Get the current target delay
+     * @return	Returns the target delay in samples
+     */
+    unsigned targetDelay(void) const { return stats.target_delay; }
+
+    /**
+     * @brief 	Report frames that arrived too late to be used
+     * @param 	count The number of late frames
+     *
+     * This function is only used to keep statistics. The frame counting is
+     * normally done using packet sequence numbers by the user of the FIFO.
+     */
+    void reportLateFrames(unsigned count) { stats.late_frames += count; }
+
+    /**
+     * @brief 	Report frames that was lost on the way
+     * @param 	count The number of lost frames
+     */
+    void reportLostFrames(unsigned count) { stats.lost_frames += count; }
+
+    /**
+     * @brief 	Get the statistics collected in adaptive mode
+     * @return	Returns the statistics
+     */
+    const Stats& statistics(void) const { return stats; }
+
+    /**
+     * @brief 	Reset the statistics counters
+     */
+    void resetStatistics(void);
+
+    /**
+     * @brief   Set the object to report audio health statistics to
+     * @param   stats The statistics object or 0 to disable reporting
+     *
+     * When set, an underrun is reported each time the FIFO run empty in the
+     * middle of a stream, in both adaptive and fixed delay mode. Unlike the
+     * statistics above, these counters are never reset by the FIFO. The
+     * statistics object is not owned by the FIFO.
+     */
+    void setStats(AudioStats *stats) { m_stats = stats; }
     
     
   protected:
@@ -212,8 +301,24 @@ class AudioJitterFifo : public AudioSink, public AudioSource
     bool      	output_stopped;
     bool      	prebuf;
     bool      	is_flushing;
+    bool        adaptive;
+    unsigned    min_delay;
+    unsigned    max_delay;
+    Stats       stats;
+    bool        in_spurt;
+    std::chrono::steady_clock::time_point spurt_start;
+    double      spurt_media;
+    double      min_rel_delay;
+    std::deque<unsigned> spread_hist;
+    std::deque<unsigned> delay_hist;
+    unsigned long media_since_stretch;
+    std::vector<float> stretch_buf;
+    AudioStats  *m_stats;
     
     void writeSamplesFromFifo(void);
+    unsigned samplesBuffered(void) const;
+    void updateDelayEstimate(unsigned count);
+    const float *adaptPlayoutDelay(const float *samples, int &count);
 
 };  /* class AudioJitterFifo */
 
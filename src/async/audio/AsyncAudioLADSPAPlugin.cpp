@@ -6,7 +6,7 @@
 
 \verbatim
 Async - A library for programming event driven applications
-Copyright (C) 2003-2024 Tobias Blomberg / SM0SVX
+Copyright (C) 2003-2026 Tobias Blomberg / SM0SVX
 
 This program is free software; you can redistribute it and/or modify
 it under the terms of the GNU General Public License as published by
@@ -36,6 +36,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 #include <stdlib.h>
 
 #include <dlfcn.h>
+#include <algorithm>
 #include <cmath>
 #include <cstring>
 #include <iostream>
@@ -403,6 +404,15 @@ AudioLADSPAPlugin::findControlInputByName(const std::string& name)
 } /* AudioLADSPAPlugin::findControlInputByName */
 
 
+void AudioLADSPAPlugin::setBlockSize(unsigned block_size)
+{
+  m_block_size = block_size;
+  m_block_pos = 0;
+  m_block_in.assign(block_size, 0.0f);
+  m_block_out.assign(block_size, 0.0f);
+} /* AudioLADSPAPlugin::setBlockSize */
+
+
 void AudioLADSPAPlugin::activate(void)
 {
   assert((m_desc != nullptr) && (m_inst_handle != nullptr));
@@ -570,10 +580,34 @@ void AudioLADSPAPlugin::processSamples(float *dest, const float *src,
   {
     return;
   }
-  m_desc->connect_port(m_inst_handle, m_sample_input_port,
-      const_cast<LADSPA_Data*>(src));
-  m_desc->connect_port(m_inst_handle, m_sample_output_port, dest);
-  m_desc->run(m_inst_handle, count);
+
+  if (m_block_size == 0)
+  {
+    connectSamplePorts(src, dest);
+    m_desc->run(m_inst_handle, count);
+    return;
+  }
+
+    // The output from the previous block is returned while the input for
+    // the next block is collected, which delay the audio by one block
+  while (count > 0)
+  {
+    unsigned cnt = std::min(static_cast<unsigned>(count),
+                            m_block_size - m_block_pos);
+    std::copy(src, src + cnt, m_block_in.begin() + m_block_pos);
+    std::copy(m_block_out.begin() + m_block_pos,
+              m_block_out.begin() + m_block_pos + cnt, dest);
+    m_block_pos += cnt;
+    src += cnt;
+    dest += cnt;
+    count -= cnt;
+    if (m_block_pos == m_block_size)
+    {
+      connectSamplePorts(m_block_in.data(), m_block_out.data());
+      m_desc->run(m_inst_handle, m_block_size);
+      m_block_pos = 0;
+    }
+  }
 } /* AudioLADSPAPlugin::processSamples */
 
 
@@ -583,6 +617,25 @@ void AudioLADSPAPlugin::processSamples(float *dest, const float *src,
  *
  ****************************************************************************/
 
+void AudioLADSPAPlugin::connectSamplePorts(const LADSPA_Data* in,
+                                           LADSPA_Data* out)
+{
+    // The buffers are normally the same from call to call so the ports are
+    // only connected again when they change
+  if (in != m_connected_in)
+  {
+    m_desc->connect_port(m_inst_handle, m_sample_input_port,
+        const_cast<LADSPA_Data*>(in));
+    m_connected_in = in;
+  }
+  if (out != m_connected_out)
+  {
+    m_desc->connect_port(m_inst_handle, m_sample_output_port, out);
+    m_connected_out = out;
+  }
+} /* AudioLADSPAPlugin::connectSamplePorts */
+
+
 const LADSPA_Descriptor* AudioLADSPAPlugin::ladspaDescriptor(void)
 {
   m_handle = dlopen(m_path.c_str(), RTLD_NOW);
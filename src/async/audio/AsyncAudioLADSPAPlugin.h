@@ -6,7 +6,7 @@
 
 \verbatim
 Async - A library for programming event driven applications
-Copyright (C) 2003-2024 Tobias Blomberg / SM0SVX
+Copyright (C) 2003-2026 Tobias Blomberg / SM0SVX
 
 This program is free software; you can redistribute it and/or modify
 it under the terms of the GNU General Public License as published by
@@ -46,6 +46,7 @@ extern "C" {
 #include <map>
 #include <memory>
 #include <limits>
+#include <vector>
 
 
 /****************************************************************************
@@ -249,6 +250,24 @@ class AudioLADSPAPlugin : public AudioProcessor
      */
     void deactivate(void);
 
+    /**
+     * @brief   Set a fixed processing block size
+     * @param   block_size The number of samples per plugin run, 0 to disable
+     *
+     * By default the plugin is run on the blocks of samples in the size that
+     * they arrive, which often are small. For heavy plugins the overhead for
+     * each run may then dominate. When a block size is set, the incoming
+     * samples are collected and the plugin is always run on exactly that
+     * number of samples. This delay the audio by block_size samples.
+     */
+    void setBlockSize(unsigned block_size);
+
+    /**
+     * @brief   Get the fixed processing block size
+     * @returns Returns the block size or 0 if not set
+     */
+    unsigned blockSize(void) const { return m_block_size; }
+
     /**
      * @brief   Get the path to the plugin
      * @returns Returns the path to the plugin
@@ -369,6 +388,7 @@ class AudioLADSPAPlugin : public AudioProcessor
 
     const LADSPA_Descriptor* ladspaDescriptor(void);
     bool setDefault(PortNumber portno);
+    void connectSamplePorts(const LADSPA_Data* in, LADSPA_Data* out);
 
     std::string               m_path;
     void*                     m_handle              = nullptr;
@@ -379,6 +399,12 @@ class AudioLADSPAPlugin : public AudioProcessor
     LADSPA_Data*              m_ctrl_buf            = nullptr;
     PortNumber                m_sample_input_port   = NOPORT;
     PortNumber                m_sample_output_port  = NOPORT;
+    const LADSPA_Data*        m_connected_in        = nullptr;
+    LADSPA_Data*              m_connected_out       = nullptr;
+    unsigned                  m_block_size          = 0;
+    unsigned                  m_block_pos           = 0;
+    std::vector<LADSPA_Data>  m_block_in;
+    std::vector<LADSPA_Data>  m_block_out;
 
 };  /* class AudioLADSPAPlugin */
 
@@ -34,6 +34,8 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 
 #include <algorithm>
 #include <cstring>
+#include <cmath>
+#include <cassert>
 
 
 /****************************************************************************
@@ -82,6 +84,51 @@ using namespace Async;
  *
  ****************************************************************************/
 
+namespace {
+    // The GCC vector extensions are used to sum the input streams. The
+    // compiler map the operations to whatever SIMD instructions are
+    // available on the target.
+#if defined(__GNUC__)
+  typedef float VecFloat __attribute__((vector_size(16)));
+  const unsigned VEC_LEN = sizeof(VecFloat) / sizeof(float);
+#endif
+
+  void addSamples(float *dest, const float *src, unsigned count)
+  {
+    unsigned i = 0;
+#if defined(__GNUC__)
+    for (; i + VEC_LEN <= count; i += VEC_LEN)
+    {
+      VecFloat d, s;
+      memcpy(&d, dest + i, sizeof(d));
+      memcpy(&s, src + i, sizeof(s));
+      d += s;
+      memcpy(dest + i, &d, sizeof(d));
+    }
+#endif
+    for (; i < count; ++i)
+    {
+      dest[i] += src[i];
+    }
+  } /* addSamples */
+
+
+  void softLimit(float *samples, unsigned count, float knee)
+  {
+    const float range = 1.0f - knee;
+    for (unsigned i=0; i<count; ++i)
+    {
+      const float abs_sample = fabsf(samples[i]);
+      if (abs_sample > knee)
+      {
+        const float limited = knee + range * tanhf((abs_sample - knee) / range);
+        samples[i] = copysignf(limited, samples[i]);
+      }
+    }
+  } /* softLimit */
+};
+
+
 class Async::AudioMixer::MixerSrc : public AudioSink
 {
   public:
@@ -189,7 +236,8 @@ class Async::AudioMixer::MixerSrc : public AudioSink
 
 AudioMixer::AudioMixer(void)
   : output_timer(0, Timer::TYPE_ONESHOT, false), outbuf_pos(0),
-    outbuf_cnt(0), is_flushed(true), output_stopped(false)
+    outbuf_cnt(0), is_flushed(true), output_stopped(false),
+    soft_limit(false), soft_limit_knee(0.7f)
 {
   output_timer.expired.connect(mem_fun(*this, &AudioMixer::outputHandler));
 } /* AudioMixer::AudioMixer */
@@ -223,6 +271,14 @@ void AudioMixer::resumeOutput(void)
 } /* AudioMixer::resumeOutput */
 
 
+void AudioMixer::setSoftLimiter(bool enable, float knee)
+{
+  assert((knee >= 0.0f) && (knee < 1.0f));
+  soft_limit = enable;
+  soft_limit_knee = knee;
+} /* AudioMixer::setSoftLimiter */
+
+
 
 /****************************************************************************
  *
@@ -351,23 +407,30 @@ void AudioMixer::outputHandler(Timer *t)
 	break;
       }
 
-      	// Fill the output buffer with samples from all active FIFOs
-      memset(outbuf, 0, sizeof(outbuf));
-      float tmp[OUTBUF_SIZE];
+      	// Fill the output buffer with samples from all active FIFOs. The
+	// first one is read directly into the output buffer and the others
+	// are added to it.
+      bool is_first = true;
       for (it = sources.begin(); it != sources.end(); ++it)
       {
 	if ((*it)->isActive())
 	{
-	  unsigned samples_read = (*it)->readSamples(tmp, samples_to_read);
+	  float *buf = is_first ? outbuf : mixbuf;
+	  unsigned samples_read = (*it)->readSamples(buf, samples_to_read);
 	  assert(samples_read == samples_to_read);
-
-	  for (unsigned i=0; i<samples_to_read; ++i)
+	  if (!is_first)
 	  {
-      	    outbuf[i] += tmp[i];
+	    addSamples(outbuf, mixbuf, samples_to_read);
 	  }
+	  is_first = false;
 	}
       }
 
+      if (soft_limit)
+      {
+	softLimit(outbuf, samples_to_read, soft_limit_knee);
+      }
+
       outbuf_pos = 0;
       outbuf_cnt = samples_to_read;
     }
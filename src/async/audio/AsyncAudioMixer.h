@@ -109,7 +109,15 @@ namespace Async
 @author Tobias Blomberg / SM0SVX
 @date   2007-10-05
 
-This class is used to mix audio streams together.
+This class is used to mix audio streams together. Only the inputs that are
+active are read. The first active input is read directly into the output
+buffer and the rest are summed into it, a block at a time, by a loop that
+the compiler can vectorize.
+
+Since the sum of a number of streams can easily go above full scale, a soft
+limiter can be enabled on the output of the mixer. Samples below the knee
+level pass unchanged while larger samples are smoothly compressed so that
+the output never reach full scale.
 */
 class AudioMixer : public sigc::trackable, public Async::AudioSource
 {
@@ -138,6 +146,22 @@ class AudioMixer : public sigc::trackable, public Async::AudioSource
      * This function is normally only called from a connected sink object.
      */
     void resumeOutput(void);
+
+    /**
+     * @brief 	Enable or disable the output soft limiter
+     * @param 	enable Set to \em true to enable the limiter
+     * @param 	knee   The level above which the samples are limited
+     *
+     * The knee level must be between 0.0 and 1.0. Above the knee, the
+     * amplitude is given by a tanh curve that approach 1.0.
+     */
+    void setSoftLimiter(bool enable, float knee=0.7f);
+
+    /**
+     * @brief 	Check if the soft limiter is enabled
+     * @return	Returns \em true if the soft limiter is enabled
+     */
+    bool softLimiterEnabled(void) const { return soft_limit; }
     
     
   protected:
@@ -159,10 +183,13 @@ class AudioMixer : public sigc::trackable, public Async::AudioSource
     std::list<MixerSrc *> sources;
     Timer     	      	  output_timer;
     float     	      	  outbuf[OUTBUF_SIZE];
+    float     	      	  mixbuf[OUTBUF_SIZE];
     unsigned       	  outbuf_pos;
     unsigned  	      	  outbuf_cnt;
     bool      	      	  is_flushed;
     bool      	      	  output_stopped;
+    bool      	      	  soft_limit;
+    float     	      	  soft_limit_knee;
     
     AudioMixer(const AudioMixer&);
     AudioMixer& operator=(const AudioMixer&);
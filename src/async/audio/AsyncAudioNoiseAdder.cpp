@@ -38,7 +38,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 #include <cstdlib>
 #include <cmath>
 #include <locale>
-#include <limits>
+#include <algorithm>
 
 
 /****************************************************************************
@@ -107,6 +107,7 @@ using namespace Async;
  *
  ****************************************************************************/
 
+uint64_t AudioNoiseAdder::next_seed = 0;
 
 
 /****************************************************************************
@@ -116,8 +117,7 @@ using namespace Async;
  ****************************************************************************/
 
 AudioNoiseAdder::AudioNoiseAdder(float level_db)
-  : sigma(sqrt(powf(10.0f, level_db / 10.0f) / 2.0f)), z1(0.0f),
-    generate(false), seed(0)
+  : sigma(sqrt(powf(10.0f, level_db / 10.0f) / 2.0f)), prng(next_seed++)
 {
 } /* AudioNoiseAdder::AudioNoiseAdder */
 
@@ -137,13 +137,24 @@ AudioNoiseAdder::~AudioNoiseAdder(void)
 void AudioNoiseAdder::processSamples(float *dest, const float *src, int count)
 {
   //cout << "AudioNoiseAdder::processSamples: len=" << len << endl;
-  
-  for (int i=0; i<count; ++i)
+
+    // The noise is generated into a separate buffer since dest and src
+    // may point to the same buffer
+  float noise[256];
+  while (count > 0)
   {
-    float noise = generateGaussianNoise();
-    dest[i] = src[i] + noise;
+    const int n = std::min(count, static_cast<int>(sizeof(noise) /
+                                                   sizeof(*noise)));
+    prng.fillGaussian(noise, n, sigma);
+    for (int i=0; i<n; ++i)
+    {
+      dest[i] = src[i] + noise[i];
+    }
+    dest += n;
+    src += n;
+    count -= n;
   }
-} /* AudioNoiseAdder::writeSamples */
+} /* AudioNoiseAdder::processSamples */
 
 
 
@@ -153,31 +164,6 @@ void AudioNoiseAdder::processSamples(float *dest, const float *src, int count)
  *
  ****************************************************************************/
 
-float AudioNoiseAdder::generateGaussianNoise(void)
-{
-  static const float epsilon = std::numeric_limits<float>::min();
-  static const float two_pi = 2.0f * M_PI;
-  static const float mu = 0.0f;
-
-  generate = !generate;
-
-  if (!generate)
-  {
-    return z1 * sigma + mu;
-  }
-
-  float u1, u2;
-  do
-  {
-    u1 = rand_r(&seed) * (1.0f / RAND_MAX);
-    u2 = rand_r(&seed) * (1.0f / RAND_MAX);
-  }
-  while (u1 <= epsilon);
-
-  float z0 = sqrt(-2.0f * log(u1)) * cos(two_pi * u2);
-  z1 = sqrt(-2.0f * log(u1)) * sin(two_pi * u2);
-  return z0 * sigma + mu;
-} /* AudioNoiseAdder::generateGaussianNoise */
 
 
 /*
@@ -44,6 +44,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
  *
  ****************************************************************************/
 
+#include <AsyncPrng.h>
 
 
 /****************************************************************************
@@ -117,6 +118,11 @@ example is described on Wikipedia:
 
 The class is not implemented as a pure audio source but rather as an audio pipe
 component that should be inserted in the audio path.
+
+The noise is generated a block at a time using the vectorized Async::Prng so
+that a large number of simulated receivers can be run in real time. Each
+instance get its own seed so that the noise of different instances are not
+correlated.
 */
 class AudioNoiseAdder : public AudioProcessor
 {
@@ -154,14 +160,13 @@ class AudioNoiseAdder : public AudioProcessor
     void processSamples(float *dest, const float *src, int count);
 
   private:
+    static uint64_t next_seed;
+
     float sigma;        // Standard deviation of the generated noise
-    float z1;
-    bool generate;
-    unsigned int seed;
+    Prng  prng;
 
     AudioNoiseAdder(const AudioNoiseAdder&);
     AudioNoiseAdder& operator=(const AudioNoiseAdder&);
-    float generateGaussianNoise(void);
 
 };  /* class AudioNoiseAdder */
 
@@ -6,7 +6,7 @@
 
 \verbatim
 Async - A library for programming event driven applications
-Copyright (C) 2003-2008 Tobias Blomberg / SM0SVX
+Copyright (C) 2003-2026 Tobias Blomberg / SM0SVX
 
 This program is free software; you can redistribute it and/or modify
 it under the terms of the GNU General Public License as published by
@@ -119,7 +119,8 @@ using namespace Async;
 
 AudioPacer::AudioPacer(int sample_rate, int block_size, int prebuf_time)
   : sample_rate(sample_rate), buf_size(block_size), prebuf_time(prebuf_time),
-    buf_pos(0), pace_timer(0), do_flush(false), input_stopped(false)
+    buf_pos(0), pace_timer(0), do_flush(false), input_stopped(false),
+    use_sample_clock(false), clock_samples(0)
 {
   assert(sample_rate > 0);
   assert(block_size > 0);
@@ -147,6 +148,14 @@ AudioPacer::~AudioPacer(void)
 } /* AudioPacer::~AudioPacer */
 
 
+void AudioPacer::setSampleClockEnabled(bool enable)
+{
+  use_sample_clock = enable;
+  clock_start = chrono::steady_clock::now();
+  clock_samples = 0;
+} /* AudioPacer::setSampleClockEnabled */
+
+
 int AudioPacer::writeSamples(const float *samples, int count)
 {
   assert(count > 0);
@@ -175,7 +184,7 @@ int AudioPacer::writeSamples(const float *samples, int count)
 	samples_written += writeSamples(samples + samples_written,
 	      	      	      	      	samples_left);
       }
-      pace_timer->setEnable(true);
+      startPacing();
     }
     else
     {
@@ -192,10 +201,7 @@ int AudioPacer::writeSamples(const float *samples, int count)
     memcpy(buf + buf_pos, samples, samples_written * sizeof(*buf));
     buf_pos += samples_written;
     
-    if (!pace_timer->isEnabled())
-    {
-      pace_timer->setEnable(true);
-    }
+    startPacing();
   }
   
   if (samples_written == 0)
@@ -224,7 +230,7 @@ void AudioPacer::resumeOutput(void)
 {
   if (prebuf_samples <= 0)
   {
-    pace_timer->setEnable(true);
+    startPacing();
     outputNextBlock();
   }
 } /* AudioPacer::resumeOutput */
@@ -255,8 +261,25 @@ void AudioPacer::allSamplesFlushed(void)
  ****************************************************************************/
 
 
+void AudioPacer::startPacing(void)
+{
+  if (!pace_timer->isEnabled())
+  {
+    pace_timer->setEnable(true);
+    clock_start = chrono::steady_clock::now();
+    clock_samples = 0;
+  }
+} /* AudioPacer::startPacing */
+
+
 void AudioPacer::outputNextBlock(Timer *t)
 {
+  if (use_sample_clock)
+  {
+    outputDueSamples();
+    return;
+  }
+
   if (buf_pos < buf_size)
   {
     pace_timer->setEnable(false);
@@ -308,6 +331,83 @@ void AudioPacer::outputNextBlock(Timer *t)
 } /* AudioPacer::outputNextBlock */
 
 
+void AudioPacer::outputDueSamples(void)
+{
+  const auto elapsed = chrono::duration_cast<chrono::microseconds>(
+      chrono::steady_clock::now() - clock_start);
+  const uint64_t due_total = elapsed.count() * sample_rate / 1000000;
+  int64_t due = due_total - clock_samples;
+
+  bool sink_stopped = false;
+  int tot_written = 0;
+  while ((due > 0) && (buf_pos > 0))
+  {
+    int count = min(static_cast<int64_t>(buf_pos), due);
+    int written = writeBuffer(count);
+    clock_samples += written;
+    due -= written;
+    tot_written += written;
+    if (written < count)
+    {
+      sink_stopped = true;
+      break;
+    }
+
+      // Let the source refill the buffer if we are still behind
+    if (input_stopped && (buf_pos < buf_size))
+    {
+      input_stopped = false;
+      sourceResumeOutput();
+    }
+  }
+
+  if (sink_stopped)
+  {
+    pace_timer->setEnable(false);
+  }
+  else if ((due > 0) && (tot_written == 0))
+  {
+      // Buffer underrun. Wait for new samples to be prebuffered.
+    pace_timer->setEnable(false);
+    prebuf_samples = prebuf_time * sample_rate / 1000;
+  }
+  else if (due > buf_size)
+  {
+      // Do not try to catch up more than one block. Samples that arrive
+      // too late are sent at the normal pace instead of in a burst.
+    clock_samples = due_total - buf_size;
+  }
+
+  if (input_stopped && (buf_pos < buf_size))
+  {
+    input_stopped = false;
+    sourceResumeOutput();
+  }
+
+  if (do_flush && (buf_pos == 0))
+  {
+    sinkFlushSamples();
+  }
+} /* AudioPacer::outputDueSamples */
+
+
+int AudioPacer::writeBuffer(int count)
+{
+  int tot_samples_written = 0;
+  int samples_written;
+  do {
+    samples_written = sinkWriteSamples(buf + tot_samples_written,
+                                       count - tot_samples_written);
+    tot_samples_written += samples_written;
+  } while ((samples_written > 0) && (tot_samples_written < count));
+
+  buf_pos -= tot_samples_written;
+  memmove(buf, buf + tot_samples_written, buf_pos * sizeof(*buf));
+
+  return tot_samples_written;
+} /* AudioPacer::writeBuffer */
+
+
 
 
 /*
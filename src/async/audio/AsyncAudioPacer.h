@@ -6,7 +6,7 @@
 
 \verbatim
 Async - A library for programming event driven applications
-Copyright (C) 2003-2008 Tobias Blomberg / SM0SVX
+Copyright (C) 2003-2026 Tobias Blomberg / SM0SVX
 
 This program is free software; you can redistribute it and/or modify
 it under the terms of the GNU General Public License as published by
@@ -36,6 +36,8 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
  ****************************************************************************/
 
 #include <sigc++/sigc++.h>
+#include <chrono>
+#include <cstdint>
 
 
 /****************************************************************************
@@ -127,6 +129,22 @@ class AudioPacer : public AudioSink, public AudioSource, public sigc::trackable
      * @brief 	Destructor
      */
     ~AudioPacer(void);
+
+    /**
+     * @brief   Pace the output using a sample clock
+     * @param   enable Set to \em true to enable the sample clock
+     *
+     * By default one block of audio is written to the sink each time the
+     * pace timer expire. Any jitter in the timer is then passed on to the
+     * sink and the output will slowly drift when the timer is late.
+     * When the sample clock is enabled, the number of samples that should
+     * have been written since the output started is instead calculated from
+     * a monotonic clock each time the timer expire and exactly that many
+     * samples are written. A late timer is thereby compensated for in the
+     * next block so the output rate follow the sample rate closely,
+     * which make it possible to use smaller buffers downstream.
+     */
+    void setSampleClockEnabled(bool enable);
   
     /**
      * @brief 	Write samples into this audio sink
@@ -183,8 +201,14 @@ class AudioPacer : public AudioSink, public AudioSource, public sigc::trackable
     Async::Timer  *pace_timer;
     bool      	  do_flush;
     bool      	  input_stopped;
+    bool          use_sample_clock;
+    std::chrono::steady_clock::time_point clock_start;
+    uint64_t      clock_samples;
     
+    void startPacing(void);
     void outputNextBlock(Async::Timer *t=0);
+    void outputDueSamples(void);
+    int writeBuffer(int count);
 
 };  /* class AudioPacer */
 
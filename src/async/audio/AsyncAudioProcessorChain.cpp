@@ -0,0 +1,234 @@
+/**
+@file	 AsyncAudioProcessorChain.cpp
+@brief   Run a chain of audio processors in one pass on fixed size buffers
+@author  Tobias Blomberg / SM0SVX
+@date	 2026-10-14
+
+\verbatim
+Async - A library for programming event driven applications
+Copyright (C) 2003-2026 Tobias Blomberg / SM0SVX
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+\endverbatim
+*/
+
+
+
+/****************************************************************************
+ *
+ * System Includes
+ *
+ ****************************************************************************/
+
+#include <cassert>
+#include <cstring>
+#include <chrono>
+
+
+/****************************************************************************
+ *
+ * Project Includes
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Local Includes
+ *
+ ****************************************************************************/
+
+#include "AsyncAudioProcessorChain.h"
+
+
+
+/****************************************************************************
+ *
+ * Namespaces to use
+ *
+ ****************************************************************************/
+
+using namespace std;
+using namespace Async;
+
+
+
+/****************************************************************************
+ *
+ * Defines & typedefs
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Local class definitions
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Prototypes
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Exported Global Variables
+ *
+ ****************************************************************************/
+
+
+
+
+/****************************************************************************
+ *
+ * Local Global Variables
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Public member functions
+ *
+ ****************************************************************************/
+
+AudioProcessorChain::AudioProcessorChain(void)
+  : dec_fact(1), profiling(false)
+{
+} /* AudioProcessorChain::AudioProcessorChain */
+
+
+AudioProcessorChain::~AudioProcessorChain(void)
+{
+  for (vector<Stage>::iterator it = stages.begin(); it != stages.end(); ++it)
+  {
+    if (it->managed)
+    {
+      delete it->proc;
+    }
+  }
+} /* AudioProcessorChain::~AudioProcessorChain */
+
+
+void AudioProcessorChain::addStage(AudioProcessor *stage, bool managed,
+                                   const string& name)
+{
+  assert(stage != 0);
+  assert(stage != this);
+  assert(stage->input_rate % stage->output_rate == 0);
+
+  Stage s;
+  s.proc = stage;
+  s.managed = managed;
+  s.name = name;
+  s.dec_fact = stage->input_rate / stage->output_rate;
+  s.time = 0.0;
+  s.samples = 0;
+  stages.push_back(s);
+
+  if (s.dec_fact > 1)
+  {
+    dec_fact *= s.dec_fact;
+    setInputOutputSampleRate(dec_fact, 1);
+  }
+
+    // The base class never give us more samples than will fit in its output
+    // buffer after all decimation has been done
+  const size_t buf_size = BUFSIZE * dec_fact;
+  buf_a.resize(buf_size);
+  buf_b.resize(buf_size);
+} /* AudioProcessorChain::addStage */
+
+
+void AudioProcessorChain::resetProfiling(void)
+{
+  for (vector<Stage>::iterator it = stages.begin(); it != stages.end(); ++it)
+  {
+    it->time = 0.0;
+    it->samples = 0;
+  }
+} /* AudioProcessorChain::resetProfiling */
+
+
+
+/****************************************************************************
+ *
+ * Protected member functions
+ *
+ ****************************************************************************/
+
+void AudioProcessorChain::processSamples(float *dest, const float *src,
+                                         int count)
+{
+  if (stages.empty())
+  {
+    memcpy(dest, src, count * sizeof(*dest));
+    return;
+  }
+
+  assert(static_cast<size_t>(count) <= buf_a.size());
+
+    // Ping-pong between the two internal buffers. The last stage write
+    // directly to the destination buffer.
+  const float *in = src;
+  float *out = &buf_a[0];
+  for (size_t i=0; i<stages.size(); ++i)
+  {
+    Stage& stage = stages[i];
+    if (i + 1 == stages.size())
+    {
+      out = dest;
+    }
+    if (profiling)
+    {
+      chrono::steady_clock::time_point start = chrono::steady_clock::now();
+      stage.proc->processSamples(out, in, count);
+      chrono::duration<double> elapsed = chrono::steady_clock::now() - start;
+      stage.time += elapsed.count();
+      stage.samples += count;
+    }
+    else
+    {
+      stage.proc->processSamples(out, in, count);
+    }
+    count /= stage.dec_fact;
+    in = out;
+    out = (out == &buf_a[0]) ? &buf_b[0] : &buf_a[0];
+  }
+} /* AudioProcessorChain::processSamples */
+
+
+
+/****************************************************************************
+ *
+ * Private member functions
+ *
+ ****************************************************************************/
+
+
+
+/*
+ * This file has not been truncated
+ */
+
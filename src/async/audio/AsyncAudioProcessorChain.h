@@ -0,0 +1,258 @@
+/**
+@file	 AsyncAudioProcessorChain.h
+@brief   Run a chain of audio processors in one pass on fixed size buffers
+@author  Tobias Blomberg / SM0SVX
+@date	 2026-10-14
+
+\verbatim
+Async - A library for programming event driven applications
+Copyright (C) 2003-2026 Tobias Blomberg / SM0SVX
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+\endverbatim
+*/
+
+#ifndef ASYNC_AUDIO_PROCESSOR_CHAIN_INCLUDED
+#define ASYNC_AUDIO_PROCESSOR_CHAIN_INCLUDED
+
+
+/****************************************************************************
+ *
+ * System Includes
+ *
+ ****************************************************************************/
+
+#include <vector>
+#include <string>
+
+
+/****************************************************************************
+ *
+ * Project Includes
+ *
+ ****************************************************************************/
+
+#include <AsyncAudioProcessor.h>
+
+
+/****************************************************************************
+ *
+ * Local Includes
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Forward declarations
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Namespace
+ *
+ ****************************************************************************/
+
+namespace Async
+{
+
+
+/****************************************************************************
+ *
+ * Forward declarations of classes inside of the declared namespace
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Defines & typedefs
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Exported Global Variables
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Class definitions
+ *
+ ****************************************************************************/
+
+/**
+@brief	Run a chain of audio processors in one pass on fixed size buffers
+@author Tobias Blomberg / SM0SVX
+@date   2026-10-14
+
+When a number of audio processors (filters, amplifiers, clippers etc) are
+connected one after the other in the usual way, each block of samples is
+passed through writeSamples in every stage. Every stage buffer the samples,
+handle partial writes and call the next stage through a virtual function.
+Since the blocks often are small and odd sized, that overhead may be larger
+than the actual processing.
+
+This class is itself an audio processor so it can be used anywhere a normal
+audio pipe component can be used. Processors added to it are not connected
+to anything. Instead, their processSamples function is called directly, one
+after the other, on two buffers that are allocated when the stages are added.
+The buffering, flow control and flushing is only done once, at the input and
+output of the chain.
+
+Stages that keep the sample rate and stages that decimate, like the
+Async::AudioDecimator, can be added. Stages that increase the sample rate
+cannot be used. Components that distribute audio to more than one sink or
+that can block the audio (splitters, valves, selectors, mixers) are not
+audio processors and cannot be part of a chain. They are used to connect
+chains together like before.
+
+The time spent in each stage can optionally be measured, which is useful
+when looking for the expensive parts of a large audio pipe. A complete
+example can be found in AsyncAudioProcessorChain_demo.cpp.
+
+\include AsyncAudioProcessorChain_demo.cpp
+*/
+class AudioProcessorChain : public AudioProcessor
+{
+  public:
+    /**
+     * @brief 	Default constuctor
+     */
+    AudioProcessorChain(void);
+
+    /**
+     * @brief 	Destructor
+     *
+     * All managed stages are deleted.
+     */
+    ~AudioProcessorChain(void);
+
+    /**
+     * @brief 	Add a processor stage to the end of the chain
+     * @param 	stage   The processor to add
+     * @param 	managed If managed is \em true the stage will be deleted
+     *                  when the chain is deleted
+     * @param 	name    A name used to identify the stage in statistics
+     *
+     * The processor must not be connected to any other audio pipe
+     * component since its output is never used. Since the buffers are
+     * allocated here, all stages should be added before any audio is
+     * written to the chain.
+     */
+    void addStage(AudioProcessor *stage, bool managed=false,
+                  const std::string& name="");
+
+    /**
+     * @brief 	Get the number of stages in the chain
+     * @return	Returns the number of stages
+     */
+    size_t stageCount(void) const { return stages.size(); }
+
+    /**
+     * @brief 	Get the name of a stage
+     * @param 	idx The index of the stage, in the order it was added
+     * @return	Returns the name given when the stage was added
+     */
+    const std::string& stageName(size_t idx) const { return stages[idx].name; }
+
+    /**
+     * @brief 	Enable or disable measuring of the time spent in each stage
+     * @param 	enable Set to \em true to enable time measurement
+     */
+    void setProfilingEnabled(bool enable) { profiling = enable; }
+
+    /**
+     * @brief 	Check if time measurement is enabled
+     * @return	Returns \em true if the time spent in each stage is measured
+     */
+    bool profilingEnabled(void) const { return profiling; }
+
+    /**
+     * @brief 	Get the time spent in a stage
+     * @param 	idx The index of the stage
+     * @return	Returns the accumulated processing time in seconds
+     */
+    double stageTime(size_t idx) const { return stages[idx].time; }
+
+    /**
+     * @brief 	Get the number of samples processed by a stage
+     * @param 	idx The index of the stage
+     * @return	Returns the accumulated number of input samples
+     */
+    unsigned long long stageSamples(size_t idx) const
+    {
+      return stages[idx].samples;
+    }
+
+    /**
+     * @brief 	Reset the time and sample counters for all stages
+     */
+    void resetProfiling(void);
+
+
+  protected:
+    /**
+     * @brief Process incoming samples and put them into the output buffer
+     * @param dest  Destination buffer
+     * @param src   Source buffer
+     * @param count Number of samples in the source buffer
+     */
+    void processSamples(float *dest, const float *src, int count);
+
+
+  private:
+    struct Stage
+    {
+      AudioProcessor*     proc;
+      bool                managed;
+      std::string         name;
+      int                 dec_fact;
+      double              time;
+      unsigned long long  samples;
+    };
+
+    std::vector<Stage>  stages;
+    std::vector<float>  buf_a;
+    std::vector<float>  buf_b;
+    int                 dec_fact;
+    bool                profiling;
+
+    AudioProcessorChain(const AudioProcessorChain&);
+    AudioProcessorChain& operator=(const AudioProcessorChain&);
+
+};  /* class AudioProcessorChain */
+
+
+} /* namespace */
+
+#endif /* ASYNC_AUDIO_PROCESSOR_CHAIN_INCLUDED */
+
+
+
+/*
+ * This file has not been truncated
+ */
+
@@ -38,6 +38,8 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 #include <cerrno>
 #include <algorithm>
 #include <sstream>
+#include <vector>
+#include <atomic>
 #include <sys/time.h>
 
 
@@ -47,6 +49,8 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
  *
  ****************************************************************************/
 
+#include <AsyncTimer.h>
+#include <AsyncWorkerPool.h>
 
 
 /****************************************************************************
@@ -56,6 +60,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
  ****************************************************************************/
 
 #include "AsyncAudioRecorder.h"
+#include "AsyncAudioContainer.h"
 
 
 
@@ -85,6 +90,80 @@ using namespace Async;
  *
  ****************************************************************************/
 
+/**
+ * A buffer for the audio data written to a file in the background. The main
+ * thread push data into a lock free single producer, single consumer ring
+ * buffer. The worker thread write the data in the buffer to the file. When a
+ * recording is closed, the object is kept alive by the last worker job until
+ * all data has been written.
+ *
+ * If the writer is given an audio container, the ring buffer hold float
+ * samples that are encoded by the container in the worker thread.
+ */
+class AudioRecorder::FileWriter
+{
+  public:
+    FileWriter(FILE *file, size_t size, AudioContainer *container=nullptr)
+      : file(file), buf(size), container(container)
+    {
+      if (container != nullptr)
+      {
+        container->writeBlock.connect(
+            sigc::mem_fun(*this, &FileWriter::onContainerBlock));
+      }
+    }
+    ~FileWriter(void)
+    {
+      delete container;
+      if (file != NULL)
+      {
+        fclose(file);
+      }
+    }
+
+      // Called from the main thread
+    bool push(const void *data, size_t len);
+    size_t fill(void) const
+    {
+      return head.load(std::memory_order_acquire) -
+             tail.load(std::memory_order_acquire);
+    }
+    size_t size(void) const { return buf.size(); }
+    bool hasFailed(void) const { return failed.load(); }
+
+      // Called from the worker thread
+    void writeOut(void);
+    void finish(std::string header);
+
+    std::atomic<bool> write_queued{false};
+    std::string       errmsg;
+    bool              close_ok = false;
+
+  private:
+    FILE*               file;
+    std::vector<char>   buf;
+    std::atomic<size_t> head{0};
+    std::atomic<size_t> tail{0};
+    std::atomic<bool>   failed{false};
+    AudioContainer*     container;
+
+    void onContainerBlock(const char *data, size_t len)
+    {
+      if (!failed && (fwrite(data, 1, len, file) != len))
+      {
+        setError("fwrite");
+      }
+    }
+
+    void setError(const char *fname)
+    {
+      ostringstream ss;
+      ss << fname << ": " << strerror(errno);
+      errmsg = ss.str();
+      failed = true;
+    }
+};
+
 
 
 /****************************************************************************
@@ -140,6 +219,10 @@ AudioRecorder::AudioRecorder(const string& filename,
       {
         format = FMT_WAV;
       }
+      else if (ext == "opus")
+      {
+        format = FMT_OPUS;
+      }
     }
   }
 } /* AudioRecorder::AudioRecorder */
@@ -154,37 +237,92 @@ AudioRecorder::~AudioRecorder(void)
 bool AudioRecorder::initialize(void)
 {
   assert(file == NULL);
+
+  if (format == FMT_OPUS)
+  {
+    container = createAudioContainer("opus");
+    if (container == nullptr)
+    {
+      errmsg = "The Opus audio container is not available";
+      return false;
+    }
+    container->writeBlock.connect(
+        sigc::mem_fun(*this, &AudioRecorder::onContainerBlock));
+  }
   
   file = fopen(filename.c_str(), "w");
   if (file == NULL)
   {
     setErrMsgFromErrno("fopen");
+    delete container;
+    container = nullptr;
     return false;
   }
   
+  size_t header_size = 0;
   if (format == FMT_WAV)
   {
-      // Leave room for the wave file header
-    if (fseek(file, WAVE_HEADER_SIZE, SEEK_SET) != 0)
+    header_size = WAVE_HEADER_SIZE;
+  }
+  else if (container != nullptr)
+  {
+    header_size = container->headerSize();
+  }
+  if (header_size > 0)
+  {
+      // Leave room for the file header
+    if (fseek(file, header_size, SEEK_SET) != 0)
     {
       setErrMsgFromErrno("fseek");
       fclose(file);
       file = NULL;
+      delete container;
+      container = nullptr;
       return false;
     }
   }
+
+  if (pool != nullptr)
+  {
+      // Encode in the writer thread. The ring buffer then hold float samples
+      // instead of the encoded data.
+    size_t size = buffer_size;
+    if (container != nullptr)
+    {
+      size = buffer_size / sizeof(short) * sizeof(float);
+    }
+    writer = std::make_shared<FileWriter>(file, size, container);
+    container = nullptr;
+    flush_timer = new Timer(flush_interval, Timer::TYPE_PERIODIC);
+    flush_timer->expired.connect(
+        sigc::hide(sigc::mem_fun(*this, &AudioRecorder::scheduleWrite)));
+  }
   
   samples_written = 0;
   high_water_mark_reached = false;
   timerclear(&begin_timestamp);
   timerclear(&end_timestamp);
   errmsg = "";
+  overflow_cnt = 0;
+  dropped_bytes = 0;
+  write_failed = false;
   
   return true;
   
 } /* AudioRecorder::initialize */
 
 
+void AudioRecorder::setBackgroundWrite(WorkerPool *pool, unsigned buffer_ms,
+                                       unsigned flush_interval_ms)
+{
+  assert(file == NULL);
+  this->pool = pool;
+  buffer_size = std::max(1U, buffer_ms * (sample_rate / 1000)) *
+                sizeof(short);
+  flush_interval = std::max(1U, flush_interval_ms);
+} /* AudioRecorder::setBackgroundWrite */
+
+
 void AudioRecorder::setMaxRecordingTime(unsigned time_ms, unsigned hw_time_ms)
 {
   max_samples = time_ms * (sample_rate / 1000);
@@ -193,13 +331,54 @@ void AudioRecorder::setMaxRecordingTime(unsigned time_ms, unsigned hw_time_ms)
 
 
 bool AudioRecorder::closeFile(void)
+{
+  return closeFile(nullptr);
+} /* AudioRecorder::closeFile */
+
+
+bool AudioRecorder::closeFile(CloseDone done)
 {
   bool success = true;
   if (file != NULL)
   {
-    if (format == FMT_WAV)
+    if (container != nullptr)
     {
-      success = writeWaveHeader();
+      container->endStream();
+    }
+    delete flush_timer;
+    flush_timer = nullptr;
+
+    string header;
+    headerData(header);
+    delete container;
+    container = nullptr;
+
+    if (writer != nullptr)
+    {
+        // The file is now owned by the writer which close it when all
+        // buffered data has been written
+      std::shared_ptr<FileWriter> w(writer);
+      writer.reset();
+      file = NULL;
+      pool->run([w, header]() { w->finish(header); },
+                [w, done]()
+                {
+                  if (done)
+                  {
+                    done(w->close_ok, w->errmsg);
+                  }
+                });
+      return true;
+    }
+
+    if (!header.empty())
+    {
+      rewind(file);
+      if (fwrite(header.data(), 1, header.size(), file) != header.size())
+      {
+        setErrMsgFromErrno("fwrite");
+        success = false;
+      }
     }
     if (fclose(file) != 0)
     {
@@ -208,6 +387,10 @@ bool AudioRecorder::closeFile(void)
     }
     file = NULL;
   }
+  if (done)
+  {
+    done(success, errmsg);
+  }
   return success;
 } /* AudioRecorder::closeFile */
 
@@ -238,31 +421,77 @@ int AudioRecorder::writeSamples(const float *samples, int count)
     timersub(&end_timestamp, &block_time, &begin_timestamp);
   }
   
-  short buf[count];
-  for (int i=0; i<count; ++i)
+  int written = count;
+  if ((writer != nullptr) && (format == FMT_OPUS))
   {
-    float sample = samples[i];
-    if (sample > 1)
+    int ret = writeData(samples, count * sizeof(*samples));
+    if (ret < 0)
     {
-      buf[i] = 32767;
+      errorOccurred();
+      closeFile();
+      return count;
     }
-    else if (sample < -1)
+    if (ret == 0)
     {
-      buf[i] = -32767;
+      return count;
     }
-    else
+  }
+  else if (container != nullptr)
+  {
+    container->writeSamples(samples, count);
+    if (write_failed)
     {
-      buf[i] = static_cast<short>(32767.0 * sample);
+      errorOccurred();
+      closeFile();
+      return count;
     }
   }
-  
-  int written = fwrite(buf, sizeof(*buf), count, file);
-  if ((written != count) && ferror(file))
+  else
   {
-    setErrMsgFromErrno("fwrite");
-    errorOccurred();
-    closeFile();
-    return count;
+    short buf[count];
+    for (int i=0; i<count; ++i)
+    {
+      float sample = samples[i];
+      if (sample > 1)
+      {
+        buf[i] = 32767;
+      }
+      else if (sample < -1)
+      {
+        buf[i] = -32767;
+      }
+      else
+      {
+        buf[i] = static_cast<short>(32767.0 * sample);
+      }
+    }
+
+    if (writer != nullptr)
+    {
+      int ret = writeData(buf, sizeof(buf));
+      if (ret < 0)
+      {
+        errorOccurred();
+        closeFile();
+        return count;
+      }
+      if (ret == 0)
+      {
+          // The samples were thrown away so they are not part of the file
+        return count;
+      }
+    }
+    else
+    {
+      written = fwrite(buf, sizeof(*buf), count, file);
+      if ((written != count) && ferror(file))
+      {
+        setErrMsgFromErrno("fwrite");
+        errorOccurred();
+        closeFile();
+        return count;
+      }
+    }
   }
   
   samples_written += written;
@@ -317,11 +546,81 @@ void AudioRecorder::flushSamples(void)
  *
  ****************************************************************************/
 
-bool AudioRecorder::writeWaveHeader(void)
+int AudioRecorder::writeData(const void *data, size_t len)
+{
+  if (writer == nullptr)
+  {
+    if (fwrite(data, 1, len, file) != len)
+    {
+      setErrMsgFromErrno("fwrite");
+      return -1;
+    }
+    return 1;
+  }
+
+  if (writer->hasFailed())
+  {
+    errmsg = writer->errmsg;
+    return -1;
+  }
+  if (!writer->push(data, len))
+  {
+    overflow_cnt += 1;
+    dropped_bytes += len;
+    return 0;
+  }
+  if (writer->fill() >= writer->size() / 2)
+  {
+    scheduleWrite();
+  }
+  return 1;
+} /* AudioRecorder::writeData */
+
+
+void AudioRecorder::onContainerBlock(const char *buf, size_t len)
+{
+    // Errors are handled by writeSamples since the container must not be
+    // deleted from within this callback
+  if (!write_failed && (writeData(buf, len) < 0))
+  {
+    write_failed = true;
+  }
+} /* AudioRecorder::onContainerBlock */
+
+
+void AudioRecorder::scheduleWrite(void)
+{
+  if ((writer == nullptr) || (writer->fill() == 0) ||
+      writer->write_queued.exchange(true))
+  {
+    return;
+  }
+  std::shared_ptr<FileWriter> w(writer);
+  pool->run([w]()
+    {
+      w->write_queued = false;
+      w->writeOut();
+    });
+} /* AudioRecorder::scheduleWrite */
+
+
+void AudioRecorder::headerData(std::string& header)
+{
+  header.clear();
+  if (format == FMT_WAV)
+  {
+    header.resize(WAVE_HEADER_SIZE);
+    buildWaveHeader(&header[0]);
+  }
+  else if ((container != nullptr) && (container->headerSize() > 0))
+  {
+    header.assign(container->header(), container->headerSize());
+  }
+} /* AudioRecorder::headerData */
+
+
+void AudioRecorder::buildWaveHeader(char *buf)
 {
-  rewind(file);
- 
-  char buf[WAVE_HEADER_SIZE];
   char *ptr = buf;
   
     // ChunkID
@@ -368,14 +667,7 @@ bool AudioRecorder::writeWaveHeader(void)
   ptr += store32bitValue(ptr, samples_written * 1 * sizeof(short));
   
   assert(ptr - buf == WAVE_HEADER_SIZE);
-
-  if (fwrite(buf, 1, WAVE_HEADER_SIZE, file) != WAVE_HEADER_SIZE)
-  {
-    setErrMsgFromErrno("fwrite");
-    return false;
-  }
-  return true;
-} /* AudioRecorder::writeWaveHeader */
+} /* AudioRecorder::buildWaveHeader */
 
 
 int AudioRecorder::store32bitValue(char *ptr, uint32_t val)
@@ -409,7 +701,94 @@ void AudioRecorder::setErrMsgFromErrno(const std::string &fname)
 
 
 
+/****************************************************************************
+ *
+ * Member functions for class AudioRecorder::FileWriter
+ *
+ ****************************************************************************/
+
+bool AudioRecorder::FileWriter::push(const void *data, size_t len)
+{
+  size_t h = head.load(std::memory_order_relaxed);
+  size_t t = tail.load(std::memory_order_acquire);
+  if (len > buf.size() - (h - t))
+  {
+    return false;
+  }
+  const char *src = static_cast<const char*>(data);
+  size_t pos = h % buf.size();
+  size_t first = std::min(len, buf.size() - pos);
+  memcpy(&buf[pos], src, first);
+  memcpy(&buf[0], src + first, len - first);
+  head.store(h + len, std::memory_order_release);
+  return true;
+} /* AudioRecorder::FileWriter::push */
+
+
+void AudioRecorder::FileWriter::writeOut(void)
+{
+  size_t t = tail.load(std::memory_order_relaxed);
+  size_t h = head.load(std::memory_order_acquire);
+  while ((t != h) && !failed)
+  {
+    size_t pos = t % buf.size();
+    size_t len = std::min(h - t, buf.size() - pos);
+    if (container != nullptr)
+    {
+        // Whole samples are always pushed and the buffer size is a multiple
+        // of the sample size so a sample never wrap around
+      container->writeSamples(reinterpret_cast<const float*>(&buf[pos]),
+                              len / sizeof(float));
+    }
+    else if (fwrite(&buf[pos], 1, len, file) != len)
+    {
+      setError("fwrite");
+    }
+    t += len;
+  }
+    // After a failure all data is thrown away
+  tail.store(h, std::memory_order_release);
+  if (!failed && (fflush(file) != 0))
+  {
+    setError("fflush");
+  }
+} /* AudioRecorder::FileWriter::writeOut */
+
+
+void AudioRecorder::FileWriter::finish(std::string header)
+{
+  writeOut();
+  if (container != nullptr)
+  {
+    container->endStream();
+    if (container->headerSize() > 0)
+    {
+      header.assign(container->header(), container->headerSize());
+    }
+    delete container;
+    container = nullptr;
+  }
+  if (!failed && !header.empty())
+  {
+    if (fseek(file, 0, SEEK_SET) != 0)
+    {
+      setError("fseek");
+    }
+    else if (fwrite(header.data(), 1, header.size(), file) != header.size())
+    {
+      setError("fwrite");
+    }
+  }
+  if ((fclose(file) != 0) && !failed)
+  {
+    setError("fclose");
+  }
+  file = NULL;
+  close_ok = !failed;
+} /* AudioRecorder::FileWriter::finish */
+
+
+
 /*
  * This file has not been truncated
  */
-
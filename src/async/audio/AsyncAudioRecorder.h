@@ -40,6 +40,8 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 #include <sys/time.h>
 
 #include <string>
+#include <memory>
+#include <functional>
 
 #include <AsyncAudioSink.h>
 
@@ -84,6 +86,10 @@ namespace Async
  *
  ****************************************************************************/
 
+class WorkerPool;
+class Timer;
+class AudioContainer;
+
   
 
 /****************************************************************************
@@ -119,7 +125,15 @@ Use this class to stream audio into a file. The audio is stored in raw format,
 class AudioRecorder : public Async::AudioSink
 {
   public:
-    typedef enum { FMT_AUTO, FMT_RAW, FMT_WAV } Format;
+    typedef enum { FMT_AUTO, FMT_RAW, FMT_WAV, FMT_OPUS } Format;
+
+    /**
+     * @brief   A function that is called when a file has been closed
+     * @param   success \em true if all data was written and the file closed
+     * @param   errmsg  An error message if success is \em false
+     */
+    using CloseDone = std::function<void(bool success,
+                                         const std::string& errmsg)>;
     
     /**
      * @brief 	Default constuctor
@@ -145,6 +159,25 @@ class AudioRecorder : public Async::AudioSink
      * retrieved using the errorMsg function.
      */
     bool initialize(void);
+
+    /**
+     * @brief   Write to the file in the background
+     * @param   pool              The worker pool to do file writes in
+     * @param   buffer_ms         The size of the write buffer in milliseconds
+     * @param   flush_interval_ms How often to write the buffer to the file
+     *
+     * Call this function before calling initialize to make the file writes
+     * happen in a thread in the given worker pool instead of in the audio
+     * path. The audio is put into a buffer that is written to the file
+     * every flush interval, or earlier if the buffer is half full. If the
+     * buffer become full since the file writes cannot keep up, the incoming
+     * audio is thrown away. This is counted by the overflowCount and
+     * droppedBytes functions. The worker pool should only have one thread so
+     * that the writes for one file are done in order. For the Opus format,
+     * the encoding is also done in the worker thread.
+     */
+    void setBackgroundWrite(WorkerPool *pool, unsigned buffer_ms=10000,
+                            unsigned flush_interval_ms=1000);
     
     /**
      * @brief   Set the maximum length of this recording
@@ -174,6 +207,20 @@ class AudioRecorder : public Async::AudioSink
      */
     bool closeFile(void);
 
+    /**
+     * @brief   Close the file and get told when it has been closed
+     * @param   done  The function to call when the file has been closed
+     * @returns Return \em false if the file could not be closed
+     *
+     * When writing in the background (@see setBackgroundWrite), the rest of
+     * the buffered audio is written and the file is closed in the worker
+     * thread. This function then return directly and the done function is
+     * called from the main loop when the file is complete. It is safe to
+     * delete the recorder before that. Without background writes, the done
+     * function is called before this function returns.
+     */
+    bool closeFile(CloseDone done);
+
     /**
      * @brief   Find out how many samples that have been written so far
      * @return  Returns the number of samples written so far
@@ -192,6 +239,18 @@ class AudioRecorder : public Async::AudioSink
      */
     const struct timeval &endTimestamp(void) const { return end_timestamp; }
 
+    /**
+     * @brief   Get the number of times the write buffer has overflowed
+     * @returns Returns the number of audio blocks thrown away
+     */
+    unsigned overflowCount(void) const { return overflow_cnt; }
+
+    /**
+     * @brief   Get the number of bytes thrown away due to buffer overflows
+     * @returns Returns the number of bytes that was not written to the file
+     */
+    size_t droppedBytes(void) const { return dropped_bytes; }
+
     /**
      * @brief 	Write samples into this audio sink
      * @param 	samples The buffer containing the samples
@@ -246,6 +305,8 @@ class AudioRecorder : public Async::AudioSink
     sigc::signal<void()> errorOccurred;
 
   private:
+    class FileWriter;
+
     std::string     filename;
     FILE      	    *file;
     unsigned        samples_written;
@@ -257,10 +318,23 @@ class AudioRecorder : public Async::AudioSink
     struct timeval  begin_timestamp;
     struct timeval  end_timestamp;
     std::string     errmsg;
+    WorkerPool*     pool                  = nullptr;
+    size_t          buffer_size           = 0;
+    unsigned        flush_interval        = 1000;
+    Timer*          flush_timer           = nullptr;
+    AudioContainer* container             = nullptr;
+    std::shared_ptr<FileWriter> writer;
+    unsigned        overflow_cnt          = 0;
+    size_t          dropped_bytes         = 0;
+    bool            write_failed          = false;
     
     AudioRecorder(const AudioRecorder&);
     AudioRecorder& operator=(const AudioRecorder&);
-    bool writeWaveHeader(void);
+    int writeData(const void *data, size_t len);
+    void onContainerBlock(const char *buf, size_t len);
+    void scheduleWrite(void);
+    void headerData(std::string& header);
+    void buildWaveHeader(char *buf);
     int store32bitValue(char *ptr, uint32_t val);
     int store16bitValue(char *ptr, uint16_t val);
     void setErrMsgFromErrno(const std::string &fname);
@@ -0,0 +1,516 @@
+/**
+@file	 AsyncAudioResampler.cpp
+@brief   A polyphase rational sample rate converter
+@author  Tobias Blomberg / SM0SVX
+@date	 2026-10-14
+
+\verbatim
+Async - A library for programming event driven applications
+Copyright (C) 2003-2026 Tobias Blomberg / SM0SVX
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+\endverbatim
+*/
+
+
+
+/****************************************************************************
+ *
+ * System Includes
+ *
+ ****************************************************************************/
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstring>
+#include <map>
+#include <tuple>
+
+
+/****************************************************************************
+ *
+ * Project Includes
+ *
+ ****************************************************************************/
+
+#include <AsyncApplication.h>
+
+
+/****************************************************************************
+ *
+ * Local Includes
+ *
+ ****************************************************************************/
+
+#include "AsyncAudioResampler.h"
+
+
+
+/****************************************************************************
+ *
+ * Namespaces to use
+ *
+ ****************************************************************************/
+
+using namespace std;
+using namespace Async;
+
+
+
+/****************************************************************************
+ *
+ * Defines & typedefs
+ *
+ ****************************************************************************/
+
+  // The GCC vector extensions are used to calculate the filter dot products.
+  // The compiler map the operations to whatever SIMD instructions are
+  // available on the target.
+#if defined(__GNUC__)
+#define RESAMPLER_VECTOR_EXT
+typedef float VecFloat __attribute__((vector_size(32)));
+static const unsigned VEC_LEN = sizeof(VecFloat) / sizeof(float);
+#else
+static const unsigned VEC_LEN = 1;
+#endif
+
+  // On x86, also build a version of the filter kernel for CPU:s supporting
+  // AVX2. The best version is selected at runtime when the program is loaded.
+#if defined(RESAMPLER_VECTOR_EXT) && defined(__x86_64__) && \
+    defined(__ELF__) && !defined(__clang__)
+#define RESAMPLER_KERNEL __attribute__((target_clones("avx2", "default")))
+#else
+#define RESAMPLER_KERNEL
+#endif
+
+  // The helper functions must be inlined into the kernel to be compiled for
+  // the selected instruction set
+#if defined(__GNUC__)
+#define RESAMPLER_INLINE inline __attribute__((always_inline))
+#else
+#define RESAMPLER_INLINE inline
+#endif
+
+
+
+/****************************************************************************
+ *
+ * Local class definitions
+ *
+ ****************************************************************************/
+
+struct Async::AudioResampler::Filter
+{
+  unsigned      L;      // Interpolation factor
+  unsigned      M;      // Decimation factor
+  unsigned      taps;   // Taps per polyphase filter, a multiple of VEC_LEN
+  vector<float> coeff;  // L filters of length taps, in reverse order
+};
+
+
+namespace {
+    // The design parameters for each quality preset
+  struct QualityParams
+  {
+    double passband;  // Passband edge as a fraction of the Nyquist frequency
+    double atten;     // Stopband attenuation in dB
+  };
+  const QualityParams quality_params[] =
+  {
+    { 0.7,   50.0 },  // QUALITY_LOW
+    { 0.875, 60.0 },  // QUALITY_MEDIUM
+    { 0.9,   90.0 }   // QUALITY_HIGH
+  };
+
+
+  unsigned gcd(unsigned a, unsigned b)
+  {
+    while (b != 0)
+    {
+      unsigned tmp = a % b;
+      a = b;
+      b = tmp;
+    }
+    return a;
+  } /* gcd */
+
+
+    // The zeroth order modified Bessel function of the first kind
+  double besselI0(double x)
+  {
+    double sum = 1.0;
+    double term = 1.0;
+    for (int k=1; k<50; ++k)
+    {
+      term *= (x / (2.0 * k)) * (x / (2.0 * k));
+      sum += term;
+      if (term < 1.0e-12 * sum)
+      {
+        break;
+      }
+    }
+    return sum;
+  } /* besselI0 */
+
+
+  RESAMPLER_INLINE float dotProduct(const float *coeff, const float *x,
+                                    unsigned taps)
+  {
+#if defined(RESAMPLER_VECTOR_EXT)
+    VecFloat acc = {0};
+    for (unsigned j=0; j<taps; j+=VEC_LEN)
+    {
+      VecFloat c, s;
+      memcpy(&c, coeff + j, sizeof(c));
+      memcpy(&s, x + j, sizeof(s));
+      acc += c * s;
+    }
+    float sum = 0.0f;
+    for (unsigned j=0; j<VEC_LEN; ++j)
+    {
+      sum += acc[j];
+    }
+    return sum;
+#else
+    float sum = 0.0f;
+    for (unsigned j=0; j<taps; ++j)
+    {
+      sum += coeff[j] * x[j];
+    }
+    return sum;
+#endif
+  } /* dotProduct */
+
+
+    // Calculate all output samples for upsampled time instants from t up to
+    // t_end. Time is counted in ticks of the upsampled rate, where the first
+    // new input sample, hist[taps-1], is at tick zero.
+  RESAMPLER_KERNEL
+  int runPolyphase(float *dest, const float *hist, const float *coeff,
+                   unsigned taps, unsigned L, unsigned M, unsigned long& t,
+                   unsigned long t_end)
+  {
+    const unsigned i_step = M / L;
+    const unsigned p_step = M % L;
+    unsigned long i = t / L;
+    unsigned p = t % L;
+    int cnt = 0;
+    while (t < t_end)
+    {
+      dest[cnt++] = dotProduct(coeff + p * taps, hist + i, taps);
+      t += M;
+      i += i_step;
+      p += p_step;
+      if (p >= L)
+      {
+        p -= L;
+        i += 1;
+      }
+    }
+    return cnt;
+  } /* runPolyphase */
+};
+
+
+
+/****************************************************************************
+ *
+ * Prototypes
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Exported Global Variables
+ *
+ ****************************************************************************/
+
+
+
+
+/****************************************************************************
+ *
+ * Local Global Variables
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Public member functions
+ *
+ ****************************************************************************/
+
+AudioResampler::AudioResampler(unsigned input_rate, unsigned output_rate,
+                               Quality quality)
+  : input_rate(input_rate), output_rate(output_rate), t(0), outbuf_cnt(0),
+    do_flush(false), input_stopped(false), output_stopped(false)
+{
+  assert((input_rate > 0) && (output_rate > 0));
+  const unsigned g = gcd(input_rate, output_rate);
+  filter = getFilter(output_rate / g, input_rate / g, quality);
+
+    // We must always be able to produce at least one output sample for each
+    // input sample when the output buffer is empty
+  assert(filter->L <= OUTBUF_SIZE * filter->M);
+
+  hist.resize(filter->taps - 1 + BLOCK_SIZE);
+  reset();
+} /* AudioResampler::AudioResampler */
+
+
+AudioResampler::~AudioResampler(void)
+{
+} /* AudioResampler::~AudioResampler */
+
+
+size_t AudioResampler::tapsPerPhase(void) const
+{
+  return filter->taps;
+} /* AudioResampler::tapsPerPhase */
+
+
+void AudioResampler::reset(void)
+{
+  fill(hist.begin(), hist.end(), 0.0f);
+  t = 0;
+} /* AudioResampler::reset */
+
+
+int AudioResampler::writeSamples(const float *samples, int count)
+{
+  assert(count > 0);
+
+  do_flush = false;
+  writeFromBuf();
+
+  const unsigned long L = filter->L;
+  const unsigned long M = filter->M;
+  const unsigned hist_len = filter->taps - 1;
+  int written = 0;
+  while (written < count)
+  {
+      // Find out how many input samples we can take without producing more
+      // output samples than will fit in the output buffer
+    const unsigned long space = OUTBUF_SIZE - outbuf_cnt;
+    int n = min(count - written, BLOCK_SIZE);
+    n = min<unsigned long>(n, (t + space * M) / L);
+    if (n == 0)
+    {
+      break;
+    }
+
+    memcpy(&hist[hist_len], samples + written, n * sizeof(*samples));
+    outbuf_cnt += runPolyphase(outbuf + outbuf_cnt, &hist[0],
+                               &filter->coeff[0], filter->taps, L, M, t,
+                               n * L);
+    assert(outbuf_cnt <= OUTBUF_SIZE);
+    t -= n * L;
+    memmove(&hist[0], &hist[n], hist_len * sizeof(hist[0]));
+    written += n;
+
+    writeFromBuf();
+  }
+
+  if (written == 0)
+  {
+    input_stopped = true;
+  }
+
+  return written;
+} /* AudioResampler::writeSamples */
+
+
+void AudioResampler::flushSamples(void)
+{
+  do_flush = true;
+  input_stopped = false;
+  if (outbuf_cnt == 0)
+  {
+    do_flush = false;
+    sinkFlushSamples();
+  }
+} /* AudioResampler::flushSamples */
+
+
+void AudioResampler::resumeOutput(void)
+{
+  output_stopped = false;
+  writeFromBuf();
+} /* AudioResampler::resumeOutput */
+
+
+void AudioResampler::allSamplesFlushed(void)
+{
+  do_flush = false;
+  sourceAllSamplesFlushed();
+} /* AudioResampler::allSamplesFlushed */
+
+
+
+/****************************************************************************
+ *
+ * Protected member functions
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Private member functions
+ *
+ ****************************************************************************/
+
+shared_ptr<const AudioResampler::Filter> AudioResampler::getFilter(
+    unsigned L, unsigned M, Quality quality)
+{
+  typedef tuple<unsigned, unsigned, int> FilterKey;
+  static map<FilterKey, weak_ptr<const Filter> > cache;
+
+  const FilterKey key(L, M, quality);
+  shared_ptr<const Filter> cached = cache[key].lock();
+  if (cached)
+  {
+    return cached;
+  }
+
+  shared_ptr<Filter> f(new Filter);
+  f->L = L;
+  f->M = M;
+  if ((L == 1) && (M == 1))
+  {
+    f->taps = VEC_LEN;
+    f->coeff.assign(VEC_LEN, 0.0f);
+    f->coeff[VEC_LEN - 1] = 1.0f;
+    cache[key] = f;
+    return f;
+  }
+
+    // All frequencies are normalized to the upsampled rate. The passband
+    // edge is set relative to the Nyquist frequency of the lower sample rate
+    // and the stopband edge is mirrored around it so that aliased components
+    // only end up in the transition band.
+  const QualityParams& qp = quality_params[quality];
+  const double f_ny = 0.5 / max(L, M);
+  const double f_pass = qp.passband * f_ny;
+  const double df = 2.0 * (f_ny - f_pass);
+  const double atten = qp.atten;
+
+    // Kaiser window design formulas
+  double beta = 0.0;
+  if (atten > 50.0)
+  {
+    beta = 0.1102 * (atten - 8.7);
+  }
+  else if (atten > 21.0)
+  {
+    beta = 0.5842 * pow(atten - 21.0, 0.4) + 0.07886 * (atten - 21.0);
+  }
+  unsigned len = static_cast<unsigned>(
+      ceil((atten - 7.95) / (2.285 * 2.0 * M_PI * df))) + 1;
+
+    // Round up so that each polyphase filter is a whole number of vectors
+  unsigned taps = (len + L - 1) / L;
+  taps = (taps + VEC_LEN - 1) / VEC_LEN * VEC_LEN;
+  len = taps * L;
+
+  vector<double> h(len);
+  const double center = 0.5 * (len - 1);
+  const double i0_beta = besselI0(beta);
+  double sum = 0.0;
+  for (unsigned k=0; k<len; ++k)
+  {
+    const double x = k - center;
+    const double r = x / center;
+    const double w = besselI0(beta * sqrt(max(0.0, 1.0 - r * r))) / i0_beta;
+    const double arg = 2.0 * M_PI * f_ny * x;
+    const double sinc = (x == 0.0) ? 1.0 : sin(arg) / arg;
+    h[k] = 2.0 * f_ny * sinc * w;
+    sum += h[k];
+  }
+
+    // Normalize to a gain of L so that the interpolated signal keep its
+    // level, then split into polyphase filters. The coefficients are stored
+    // in reverse order to match the order of the samples in the history
+    // buffer.
+  f->taps = taps;
+  f->coeff.resize(len);
+  for (unsigned p=0; p<L; ++p)
+  {
+    for (unsigned j=0; j<taps; ++j)
+    {
+      f->coeff[p * taps + j] = L * h[p + (taps - 1 - j) * L] / sum;
+    }
+  }
+
+  cache[key] = f;
+  return f;
+} /* AudioResampler::getFilter */
+
+
+void AudioResampler::writeFromBuf(void)
+{
+  if ((outbuf_cnt == 0) || output_stopped)
+  {
+    return;
+  }
+
+  int written;
+  do
+  {
+    written = sinkWriteSamples(outbuf, outbuf_cnt);
+    assert((written >= 0) && (written <= outbuf_cnt));
+    if (written > 0)
+    {
+      outbuf_cnt -= written;
+      if (outbuf_cnt > 0)
+      {
+        memmove(outbuf, outbuf + written, outbuf_cnt * sizeof(*outbuf));
+      }
+    }
+
+    if (do_flush && (outbuf_cnt == 0))
+    {
+      do_flush = false;
+      Application::app().runTask(
+          mem_fun(*this, &AudioResampler::sinkFlushSamples));
+    }
+  }
+  while ((written > 0) && (outbuf_cnt > 0));
+
+  output_stopped = (written == 0);
+
+    // Only resume the source when there is room for the output of at least
+    // one more input sample
+  if (input_stopped &&
+      ((OUTBUF_SIZE - outbuf_cnt) * filter->M >= filter->L))
+  {
+    input_stopped = false;
+    Application::app().runTask(
+        mem_fun(*this, &AudioResampler::sourceResumeOutput));
+  }
+} /* AudioResampler::writeFromBuf */
+
+
+
+/*
+ * This file has not been truncated
+ */
+
@@ -0,0 +1,247 @@
+/**
+@file	 AsyncAudioResampler.h
+@brief   A polyphase rational sample rate converter
+@author  Tobias Blomberg / SM0SVX
+@date	 2026-10-14
+
+\verbatim
+Async - A library for programming event driven applications
+Copyright (C) 2003-2026 Tobias Blomberg / SM0SVX
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+\endverbatim
+*/
+
+#ifndef ASYNC_AUDIO_RESAMPLER_INCLUDED
+#define ASYNC_AUDIO_RESAMPLER_INCLUDED
+
+
+/****************************************************************************
+ *
+ * System Includes
+ *
+ ****************************************************************************/
+
+#include <sigc++/sigc++.h>
+
+#include <memory>
+#include <vector>
+
+
+/****************************************************************************
+ *
+ * Project Includes
+ *
+ ****************************************************************************/
+
+#include <AsyncAudioSink.h>
+#include <AsyncAudioSource.h>
+
+
+/****************************************************************************
+ *
+ * Local Includes
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Forward declarations
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Namespace
+ *
+ ****************************************************************************/
+
+namespace Async
+{
+
+
+/****************************************************************************
+ *
+ * Forward declarations of classes inside of the declared namespace
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Defines & typedefs
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Exported Global Variables
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Class definitions
+ *
+ ****************************************************************************/
+
+/**
+@brief	A polyphase rational sample rate converter
+@author Tobias Blomberg / SM0SVX
+@date   2026-10-14
+
+This audio pipe class convert an audio stream from one sample rate to
+another. The ratio between the two sample rates may be any rational number
+L/M, so for example 8000 to 48000 or 44100 to 16000 is done in one stage.
+Compared to using a chain of Async::AudioInterpolator and
+Async::AudioDecimator objects, that give lower CPU usage and lower delay.
+
+The anti-aliasing/anti-imaging lowpass filter is designed when the object
+is created, using the Kaiser window method. The passband edge is placed at
+a fraction of the Nyquist frequency of the lower of the two sample rates,
+given by the selected quality. The stopband edge is placed so that aliasing
+only fall into the transition band. The filter coefficients are shared
+between all resampler objects using the same conversion ratio and quality.
+
+Quality   | Passband             | Stopband attenuation
+----------|----------------------|---------------------
+LOW       | 70% of Nyquist       | 50dB
+MEDIUM    | 87.5% of Nyquist     | 60dB
+HIGH      | 90% of Nyquist       | 90dB
+
+For example, MEDIUM quality when converting between 8kHz and 16kHz give a
+passband of 0 - 3500Hz, the same as the old coeff_16_8 filter.
+*/
+class AudioResampler : public AudioSink, public AudioSource,
+                       public sigc::trackable
+{
+  public:
+    /**
+     * @brief The available quality presets
+     */
+    typedef enum
+    {
+      QUALITY_LOW,    ///< Use a short filter with a wide transition band
+      QUALITY_MEDIUM, ///< Good enough for most voice applications
+      QUALITY_HIGH    ///< A long filter with a high stopband attenuation
+    } Quality;
+
+    /**
+     * @brief 	Constuctor
+     * @param 	input_rate  The sample rate of the incoming audio
+     * @param 	output_rate The sample rate of the outgoing audio
+     * @param 	quality     The filter quality to use
+     */
+    AudioResampler(unsigned input_rate, unsigned output_rate,
+                   Quality quality=QUALITY_MEDIUM);
+
+    /**
+     * @brief 	Destructor
+     */
+    ~AudioResampler(void);
+
+    /**
+     * @brief 	Get the input sample rate
+     * @return	Returns the sample rate of the incoming audio
+     */
+    unsigned inputRate(void) const { return input_rate; }
+
+    /**
+     * @brief 	Get the output sample rate
+     * @return	Returns the sample rate of the outgoing audio
+     */
+    unsigned outputRate(void) const { return output_rate; }
+
+    /**
+     * @brief 	Get the number of filter taps used for each output sample
+     * @return	Returns the number of taps in each polyphase filter
+     */
+    size_t tapsPerPhase(void) const;
+
+    /**
+     * @brief 	Clear the filter history
+     */
+    void reset(void);
+
+    /**
+     * @brief 	Write audio to the resampler
+     * @param 	samples The buffer containing the samples
+     * @param 	count   The number of samples in the buffer
+     * @return	Return the number of samples processed
+     */
+    int writeSamples(const float *samples, int count);
+
+    /**
+     * @brief Order a flush of all samples
+     */
+    void flushSamples(void);
+
+    /**
+     * @brief Resume output to the sink if previously stopped
+     */
+    void resumeOutput(void);
+
+    /**
+     * @brief All samples have been flushed by the sink
+     */
+    void allSamplesFlushed(void);
+
+
+  private:
+    struct Filter;
+
+    static const int BLOCK_SIZE = 256;
+    static const int OUTBUF_SIZE = 256;
+
+    const unsigned                input_rate;
+    const unsigned                output_rate;
+    std::shared_ptr<const Filter> filter;
+    std::vector<float>            hist;
+    unsigned long                 t;
+    float                         outbuf[OUTBUF_SIZE];
+    int                           outbuf_cnt;
+    bool                          do_flush;
+    bool                          input_stopped;
+    bool                          output_stopped;
+
+    static std::shared_ptr<const Filter> getFilter(unsigned L, unsigned M,
+                                                   Quality quality);
+
+    AudioResampler(const AudioResampler&);
+    AudioResampler& operator=(const AudioResampler&);
+    void writeFromBuf(void);
+
+};  /* class AudioResampler */
+
+
+} /* namespace */
+
+#endif /* ASYNC_AUDIO_RESAMPLER_INCLUDED */
+
+
+
+/*
+ * This file has not been truncated
+ */
+
@@ -0,0 +1,306 @@
+/**
+@file	 AsyncAudioRingBuffer.h
+@brief   A lock-free single producer, single consumer sample ring buffer
+@author  Tobias Blomberg / SM0SVX
+@date	 2026-10-14
+
+Implements a ring buffer that can be used to pass samples between exactly one
+producer thread and one consumer thread without any locking.
+
+\verbatim
+Async - A library for programming event driven applications
+Copyright (C) 2003-2026 Tobias Blomberg / SM0SVX
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+\endverbatim
+*/
+
+#ifndef ASYNC_AUDIO_RING_BUFFER_INCLUDED
+#define ASYNC_AUDIO_RING_BUFFER_INCLUDED
+
+
+/****************************************************************************
+ *
+ * System Includes
+ *
+ ****************************************************************************/
+
+#include <atomic>
+#include <vector>
+#include <algorithm>
+#include <cstring>
+
+
+/****************************************************************************
+ *
+ * Project Includes
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Local Includes
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Forward declarations
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Namespace
+ *
+ ****************************************************************************/
+
+namespace Async
+{
+
+
+/****************************************************************************
+ *
+ * Forward declarations of classes inside of the declared namespace
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Defines & typedefs
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Exported Global Variables
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Class definitions
+ *
+ ****************************************************************************/
+
+/**
+@brief	A lock-free single producer, single consumer sample ring buffer
+@author Tobias Blomberg / SM0SVX
+@date   2026-10-14
+
+This class is used to pass samples from one thread to another without using
+any locks, which make it usable from a real time audio thread. It is only
+safe to use with one thread calling the write function and one thread
+calling the read function. The available and space functions may be called
+by both threads but the result is only exact for the thread that would be
+affected by it, i.e. the reader for available and the writer for space.
+
+The buffer memory is allocated once, in the constructor, so no allocation is
+ever done when reading or writing.
+
+Elements may also be produced or consumed in place using the writeWindow and
+readWindow functions, which avoid copying the data an extra time.
+*/
+template <typename T>
+class AudioRingBuffer
+{
+  public:
+    /**
+     * @brief 	Constuctor
+     * @param 	size The maximum number of elements to store in the buffer
+     *
+     * The storage is rounded up to a power of two so that positions can be
+     * wrapped using a mask but the capacity is exactly the given size.
+     */
+    explicit AudioRingBuffer(size_t size)
+      : m_buf(storageSize(size)), m_mask(m_buf.size() - 1), m_capacity(size)
+    {
+    }
+
+    /**
+     * @brief 	Get the maximum number of elements the buffer can store
+     * @return	Returns the buffer capacity
+     */
+    size_t capacity(void) const { return m_capacity; }
+
+    /**
+     * @brief 	Get the number of elements available for reading
+     * @return	Returns the number of elements in the buffer
+     */
+    size_t available(void) const
+    {
+      const size_t tail = m_tail.load(std::memory_order_acquire);
+      return m_head.load(std::memory_order_acquire) - tail;
+    }
+
+    /**
+     * @brief 	Get the number of elements that can be written
+     * @return	Returns the free space in the buffer
+     */
+    size_t space(void) const { return capacity() - available(); }
+
+    /**
+     * @brief 	Write elements to the buffer
+     * @param 	data  The elements to write
+     * @param 	count The number of elements to write
+     * @return	Returns the number of elements actually written
+     *
+     * This function must only be called by the producer thread. If there is
+     * not enough space, as many elements as possible are written.
+     */
+    size_t write(const T *data, size_t count)
+    {
+      const size_t head = m_head.load(std::memory_order_relaxed);
+      const size_t tail = m_tail.load(std::memory_order_acquire);
+      count = std::min(count, m_capacity - (head - tail));
+      const size_t pos = head & m_mask;
+      const size_t first = std::min(count, m_buf.size() - pos);
+      std::memcpy(&m_buf[pos], data, first * sizeof(T));
+      std::memcpy(&m_buf[0], data + first, (count - first) * sizeof(T));
+      m_head.store(head + count, std::memory_order_release);
+      return count;
+    }
+
+    /**
+     * @brief 	Read elements from the buffer
+     * @param 	data  The buffer to store the elements in
+     * @param 	count The maximum number of elements to read
+     * @return	Returns the number of elements actually read
+     *
+     * This function must only be called by the consumer thread.
+     */
+    size_t read(T *data, size_t count)
+    {
+      const size_t tail = m_tail.load(std::memory_order_relaxed);
+      const size_t head = m_head.load(std::memory_order_acquire);
+      count = std::min(count, head - tail);
+      const size_t pos = tail & m_mask;
+      const size_t first = std::min(count, m_buf.size() - pos);
+      std::memcpy(data, &m_buf[pos], first * sizeof(T));
+      std::memcpy(data + first, &m_buf[0], (count - first) * sizeof(T));
+      m_tail.store(tail + count, std::memory_order_release);
+      return count;
+    }
+
+    /**
+     * @brief   Get a window into the buffer for writing elements in place
+     * @param   data Set to point at the first free element
+     * @return  Returns the number of elements that can be written at data
+     *
+     * Use this function to produce elements directly into the buffer
+     * instead of copying them using the write function. The window is
+     * contiguous so it may be smaller than the free space. The written
+     * elements are made visible to the consumer by calling commitWrite.
+     * This function must only be called by the producer thread.
+     */
+    size_t writeWindow(T **data)
+    {
+      const size_t head = m_head.load(std::memory_order_relaxed);
+      const size_t tail = m_tail.load(std::memory_order_acquire);
+      const size_t pos = head & m_mask;
+      *data = &m_buf[pos];
+      return std::min(m_capacity - (head - tail), m_buf.size() - pos);
+    }
+
+    /**
+     * @brief   Commit elements written to the window from writeWindow
+     * @param   count The number of elements written, at most the window size
+     *
+     * This function must only be called by the producer thread.
+     */
+    void commitWrite(size_t count)
+    {
+      const size_t head = m_head.load(std::memory_order_relaxed);
+      m_head.store(head + count, std::memory_order_release);
+    }
+
+    /**
+     * @brief   Get a window into the buffer for reading elements in place
+     * @param   data Set to point at the first element to read
+     * @return  Returns the number of elements that can be read at data
+     *
+     * The window is contiguous so it may be smaller than the number of
+     * available elements. Call commitRead to release the elements that
+     * have been consumed. This function must only be called by the consumer
+     * thread.
+     */
+    size_t readWindow(const T **data) const
+    {
+      const size_t tail = m_tail.load(std::memory_order_relaxed);
+      const size_t head = m_head.load(std::memory_order_acquire);
+      const size_t pos = tail & m_mask;
+      *data = &m_buf[pos];
+      return std::min(head - tail, m_buf.size() - pos);
+    }
+
+    /**
+     * @brief   Release elements read from the window from readWindow
+     * @param   count The number of elements consumed, at most the window size
+     *
+     * This function must only be called by the consumer thread.
+     */
+    void commitRead(size_t count)
+    {
+      const size_t tail = m_tail.load(std::memory_order_relaxed);
+      m_tail.store(tail + count, std::memory_order_release);
+    }
+
+  private:
+      // The read and write positions are kept in separate cache lines so
+      // that the two threads do not fight over the same cache line. The
+      // positions are never wrapped, only masked when used as an index.
+    std::vector<T>                  m_buf;
+    const size_t                    m_mask;
+    const size_t                    m_capacity;
+    alignas(64) std::atomic<size_t> m_head {0};
+    alignas(64) std::atomic<size_t> m_tail {0};
+
+    static size_t storageSize(size_t size)
+    {
+      size_t storage_size = 1;
+      while (storage_size < size)
+      {
+        storage_size <<= 1;
+      }
+      return storage_size;
+    }
+
+    AudioRingBuffer(const AudioRingBuffer&);
+    AudioRingBuffer& operator=(const AudioRingBuffer&);
+
+};  /* class AudioRingBuffer */
+
+
+} /* namespace */
+
+#endif /* ASYNC_AUDIO_RING_BUFFER_INCLUDED */
+
+
+
+/*
+ * This file has not been truncated
+ */
@@ -0,0 +1,248 @@
+/**
+@file	 AsyncAudioSampleConv.h
+@brief   Batched sample format conversion kernels for audio devices
+@author  Tobias Blomberg / SM0SVX
+@date	 2026-10-14
+
+Implements the conversions between the interleaved integer or floating point
+sample buffers used by sound cards and the per channel float streams used by
+the AudioIO objects.
+
+\verbatim
+Async - A library for programming event driven applications
+Copyright (C) 2003-2026 Tobias Blomberg / SM0SVX
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+\endverbatim
+*/
+
+#ifndef ASYNC_AUDIO_SAMPLE_CONV_INCLUDED
+#define ASYNC_AUDIO_SAMPLE_CONV_INCLUDED
+
+
+/****************************************************************************
+ *
+ * System Includes
+ *
+ ****************************************************************************/
+
+#include <stdint.h>
+#include <cstddef>
+#include <algorithm>
+
+
+/****************************************************************************
+ *
+ * Project Includes
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Local Includes
+ *
+ ****************************************************************************/
+
+#include "AsyncSimd.h"
+
+
+/****************************************************************************
+ *
+ * Forward declarations
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Namespace
+ *
+ ****************************************************************************/
+
+namespace Async
+{
+
+
+/****************************************************************************
+ *
+ * Forward declarations of classes inside of the declared namespace
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Defines & typedefs
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Exported Global Variables
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Class definitions
+ *
+ ****************************************************************************/
+
+/**
+@brief	Batched sample format conversion kernels
+@author Tobias Blomberg / SM0SVX
+@date   2026-10-14
+
+This class gather the sample conversion functions used by the audio device
+classes. Each function convert a whole buffer in one call. The loops are
+written so that the compiler can vectorize them, i.e. they have no data
+dependent branches and no aliasing between the source and the destination.
+The clipping is done using min/max which map directly to SIMD instructions
+(e.g. SSE/AVX/NEON) when the compiler vectorize the loop. The conversions
+between contiguous float and 16 bit buffers use the Simd kernels so that the
+best instruction set for the CPU is used.
+
+The 16 bit integer format use the same scaling as the rest of the audio
+devices. A sample of -32768 read from the sound card is -1.0 and the output
+is clipped to +/-32767.
+*/
+class AudioSampleConv
+{
+  public:
+    /**
+     * @brief   Extract one channel from interleaved 16 bit samples
+     * @param   dst       The destination float buffer (frames samples)
+     * @param   src       The interleaved source buffer
+     * @param   channels  The number of interleaved channels in src
+     * @param   ch        The channel to extract
+     * @param   frames    The number of frames to convert
+     */
+    static void deinterleaveS16(float *dst, const int16_t *src,
+                                size_t channels, size_t ch, size_t frames)
+    {
+      if (channels == 1)
+      {
+        Simd::s16ToFloat(dst, src, frames);
+        return;
+      }
+      src += ch;
+      for (size_t i=0; i<frames; ++i)
+      {
+        dst[i] = static_cast<float>(src[i * channels]) * (1.0f / 32768.0f);
+      }
+    }
+
+    /**
+     * @brief   Convert float samples into one channel of an interleaved buffer
+     * @param   dst       The interleaved 16 bit destination buffer
+     * @param   src       The source float buffer (frames samples)
+     * @param   channels  The number of interleaved channels in dst
+     * @param   ch        The channel to write the samples to
+     * @param   frames    The number of frames to convert
+     */
+    static void interleaveS16(int16_t *dst, const float *src, size_t channels,
+                              size_t ch, size_t frames)
+    {
+      if (channels == 1)
+      {
+        Simd::floatToS16(dst, src, frames);
+        return;
+      }
+      dst += ch;
+      for (size_t i=0; i<frames; ++i)
+      {
+        const float sample = src[i] * 32767.0f;
+        dst[i * channels] = static_cast<int16_t>(
+            std::min(32767.0f, std::max(-32767.0f, sample)));
+      }
+    }
+
+    /**
+     * @brief   Convert float samples to clipped 16 bit samples
+     * @param   dst   The destination buffer
+     * @param   src   The source buffer
+     * @param   cnt   The number of samples to convert
+     */
+    static void floatToS16(int16_t *dst, const float *src, size_t cnt)
+    {
+      Simd::floatToS16(dst, src, cnt);
+    }
+
+    /**
+     * @brief   Convert 16 bit samples to float samples
+     * @param   dst   The destination buffer
+     * @param   src   The source buffer
+     * @param   cnt   The number of samples to convert
+     */
+    static void s16ToFloat(float *dst, const int16_t *src, size_t cnt)
+    {
+      Simd::s16ToFloat(dst, src, cnt);
+    }
+
+    /**
+     * @brief   Convert 32 bit samples to 16 bit samples
+     * @param   dst   The destination buffer
+     * @param   src   The source buffer
+     * @param   cnt   The number of samples to convert
+     *
+     * The 16 most significant bits are kept, which also work for sound
+     * cards delivering 24 bit samples in the upper bits of a 32 bit word.
+     */
+    static void s32ToS16(int16_t *dst, const int32_t *src, size_t cnt)
+    {
+      for (size_t i=0; i<cnt; ++i)
+      {
+        dst[i] = static_cast<int16_t>(src[i] >> 16);
+      }
+    }
+
+    /**
+     * @brief   Convert 16 bit samples to 32 bit samples
+     * @param   dst   The destination buffer
+     * @param   src   The source buffer
+     * @param   cnt   The number of samples to convert
+     */
+    static void s16ToS32(int32_t *dst, const int16_t *src, size_t cnt)
+    {
+      for (size_t i=0; i<cnt; ++i)
+      {
+        dst[i] = static_cast<int32_t>(
+            static_cast<uint32_t>(static_cast<int32_t>(src[i])) << 16);
+      }
+    }
+
+  private:
+    AudioSampleConv(void);
+
+};  /* class AudioSampleConv */
+
+
+} /* namespace */
+
+#endif /* ASYNC_AUDIO_SAMPLE_CONV_INCLUDED */
+
+
+
+/*
+ * This file has not been truncated
+ */
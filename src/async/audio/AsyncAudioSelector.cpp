@@ -82,24 +82,37 @@ using namespace Async;
 class Async::AudioSelector::Branch : public AudioSink
 {
   public:
-    Branch(AudioSelector *selector)
-      : m_selector(selector), m_auto_select(false), m_prio(0),
-        m_stream_state(STATE_IDLE), m_flush_wait(true)
+    Branch(AudioSelector *selector, AudioSource *source)
+      : m_selector(selector), m_source(source), m_auto_select(false),
+        m_prio(0), m_stream_state(STATE_IDLE), m_flush_wait(true)
     {
       assert(selector != 0);
     }
 
+    AudioSource *source(void) const { return m_source; }
     StreamState streamState(void) const { return m_stream_state; }
     void setSelectionPrio(int prio) { m_prio = prio; }
     int selectionPrio(void) const { return m_prio; }
-    void enableAutoSelect(void) { m_auto_select = true; }
     bool autoSelectEnabled(void) const { return m_auto_select; }
     void setFlushWait(bool flush_wait) { m_flush_wait = flush_wait; }
     bool flushWait(void) const { return m_flush_wait; }
 
+    bool isActive(void) const
+    {
+      return m_auto_select && ((m_stream_state == STATE_WRITING) ||
+                               (m_stream_state == STATE_STOPPED));
+    }
+
+    void enableAutoSelect(void)
+    {
+      m_auto_select = true;
+      m_selector->updateActiveBranch(this);
+    }
+
     void disableAutoSelect(void)
     {
       m_auto_select = false;
+      m_selector->updateActiveBranch(this);
       if (isSelected())
       {
         m_selector->selectHighestPrioActiveBranch(true);
@@ -114,7 +127,7 @@ class Async::AudioSelector::Branch : public AudioSink
     virtual int writeSamples(const float *samples, int count)
     {
       assert(count > 0);
-      m_stream_state = STATE_WRITING;
+      setStreamState(STATE_WRITING);
       if (m_auto_select && !isSelected())
       {
 	const Branch *selected_branch = m_selector->selectedBranch();
@@ -130,7 +143,7 @@ class Async::AudioSelector::Branch : public AudioSink
         ret = m_selector->branchWriteSamples(samples, count);
         if (ret == 0)
         {
-          m_stream_state = STATE_STOPPED;
+          setStreamState(STATE_STOPPED);
         }
       }
       return ret;
@@ -148,12 +161,12 @@ class Async::AudioSelector::Branch : public AudioSink
         case STATE_STOPPED:
           if (isSelected())
           {
-            m_stream_state = STATE_FLUSHING;
+            setStreamState(STATE_FLUSHING);
             m_selector->branchFlushSamples();
           }
           else
           {
-            m_stream_state = STATE_IDLE;
+            setStreamState(STATE_IDLE);
             sourceAllSamplesFlushed();
           }
           break;
@@ -167,7 +180,7 @@ class Async::AudioSelector::Branch : public AudioSink
     {
       if (m_stream_state == STATE_STOPPED)
       {
-        m_stream_state = STATE_WRITING;
+        setStreamState(STATE_WRITING);
         sourceResumeOutput();
       }
     }
@@ -176,7 +189,7 @@ class Async::AudioSelector::Branch : public AudioSink
     {
       if (m_stream_state == STATE_FLUSHING)
       {
-        m_stream_state = STATE_IDLE;
+        setStreamState(STATE_IDLE);
         if (m_auto_select)
         {
           m_selector->selectBranch(0);
@@ -194,12 +207,12 @@ class Async::AudioSelector::Branch : public AudioSink
           break;
 
         case STATE_STOPPED:
-          m_stream_state = STATE_WRITING;
+          setStreamState(STATE_WRITING);
           sourceResumeOutput();
           break;
 
         case STATE_FLUSHING:
-          m_stream_state = STATE_IDLE;
+          setStreamState(STATE_IDLE);
           sourceAllSamplesFlushed();
           break;
       }
@@ -207,14 +220,39 @@ class Async::AudioSelector::Branch : public AudioSink
 
   private:
     AudioSelector * m_selector;
+    AudioSource *   m_source;
     bool            m_auto_select;
     int             m_prio;
     StreamState     m_stream_state;
     bool            m_flush_wait;
 
+    void setStreamState(StreamState state)
+    {
+      const bool was_active = isActive();
+      m_stream_state = state;
+      if (isActive() != was_active)
+      {
+        m_selector->updateActiveBranch(this);
+      }
+    }
+
 }; /* class Async::AudioSelector::Branch */
 
 
+bool AudioSelector::BranchPrioCmp::operator()(const Branch *a,
+                                              const Branch *b) const
+{
+    // Order on descending priority. Branches with the same priority are
+    // ordered on the source address, which is the order that the branches
+    // were scanned in before the active branches were kept sorted.
+  if (a->selectionPrio() != b->selectionPrio())
+  {
+    return a->selectionPrio() > b->selectionPrio();
+  }
+  return std::less<const AudioSource*>()(a->source(), b->source());
+} /* AudioSelector::BranchPrioCmp::operator() */
+
+
 /****************************************************************************
  *
  * Prototypes
@@ -267,7 +305,7 @@ void AudioSelector::addSource(Async::AudioSource *source)
 {
   assert(source != 0);
   assert(m_branch_map.find(source) == m_branch_map.end());
-  Branch *branch = new Branch(this);
+  Branch *branch = new Branch(this, source);
   source->registerSink(branch);
   m_branch_map[source] = branch;
 } /* AudioSelector::addSource */
@@ -280,6 +318,7 @@ void AudioSelector::removeSource(AudioSource *source)
   Branch *branch = (*it).second;
   m_branch_map.erase(it);
   assert(m_branch_map.find(source) == m_branch_map.end());
+  m_active_branches.erase(branch);
   if (branch == selectedBranch())
   {
     selectHighestPrioActiveBranch(true);
@@ -293,7 +332,9 @@ void AudioSelector::setSelectionPrio(AudioSource *source, int prio)
   BranchMap::iterator it = m_branch_map.find(source);
   assert(it != m_branch_map.end());
   Branch *branch = (*it).second;
+  m_active_branches.erase(branch);
   branch->setSelectionPrio(prio);
+  updateActiveBranch(branch);
 } /* AudioSelector::setAutoSelectPrio */
 
 
@@ -302,6 +343,7 @@ void AudioSelector::enableAutoSelect(AudioSource *source, int prio)
   BranchMap::iterator it = m_branch_map.find(source);
   assert(it != m_branch_map.end());
   Branch *branch = (*it).second;
+  m_active_branches.erase(branch);
   branch->setSelectionPrio(prio);
   branch->enableAutoSelect();
 } /* AudioSelector::enableAutoSelect */
@@ -341,15 +383,7 @@ void AudioSelector::selectSource(AudioSource *source)
 
 AudioSource *AudioSelector::selectedSource(void) const
 {
-  for (BranchMap::const_iterator it = m_branch_map.begin();
-       it != m_branch_map.end(); ++it)
-  {
-    if (it->second == selectedBranch())
-    {
-      return it->first;
-    }
-  }
-  return 0;
+  return (m_selected_branch != 0) ? m_selected_branch->source() : 0;
 } /* AudioSelector::selectedSource */
 
 
@@ -481,20 +515,9 @@ void AudioSelector::selectBranch(Branch *branch)
 void AudioSelector::selectHighestPrioActiveBranch(bool clear_if_no_active)
 {
   Branch *new_branch = 0;
-  for (BranchMap::iterator it = m_branch_map.begin();
-       it != m_branch_map.end(); ++it)
+  if (!m_active_branches.empty())
   {
-    Branch *branch = (*it).second;
-    if (branch->autoSelectEnabled())
-    {
-      if (((branch->streamState() == STATE_WRITING) ||
-           (branch->streamState() == STATE_STOPPED)) &&
-          ((new_branch == 0) ||
-          (branch->selectionPrio() > new_branch->selectionPrio())))
-      {
-        new_branch = branch;
-      }
-    }
+    new_branch = *m_active_branches.begin();
   }
   if ((new_branch != 0) || clear_if_no_active)
   {
@@ -503,6 +526,19 @@ void AudioSelector::selectHighestPrioActiveBranch(bool clear_if_no_active)
 } /* AudioSelector::selectHighestPrioActiveBranch */
 
 
+void AudioSelector::updateActiveBranch(Branch *branch)
+{
+  if (branch->isActive())
+  {
+    m_active_branches.insert(branch);
+  }
+  else
+  {
+    m_active_branches.erase(branch);
+  }
+} /* AudioSelector::updateActiveBranch */
+
+
 /*
  * This file has not been truncated
  */
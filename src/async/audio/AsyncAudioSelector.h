@@ -36,6 +36,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
  ****************************************************************************/
 
 #include <map>
+#include <set>
 
 
 /****************************************************************************
@@ -210,11 +211,17 @@ class AudioSelector : public AudioSource
     } StreamState;
 
     class Branch;
+    struct BranchPrioCmp
+    {
+      bool operator()(const Branch *a, const Branch *b) const;
+    };
     typedef std::map<Async::AudioSource *, Branch *> BranchMap;
+    typedef std::set<Branch *, BranchPrioCmp> ActiveBranchSet;
     
-    BranchMap 	m_branch_map;
-    Branch *    m_selected_branch;
-    StreamState m_stream_state;
+    BranchMap 	    m_branch_map;
+    ActiveBranchSet m_active_branches;
+    Branch *        m_selected_branch;
+    StreamState     m_stream_state;
     
     AudioSelector(const AudioSelector&);
     AudioSelector& operator=(const AudioSelector&);
@@ -223,6 +230,7 @@ class AudioSelector : public AudioSource
     void selectHighestPrioActiveBranch(bool clear_if_no_active);
     int branchWriteSamples(const float *samples, int count);
     void branchFlushSamples(void);
+    void updateActiveBranch(Branch *branch);
     
     friend class Branch;
     
@@ -6,7 +6,7 @@
 
 \verbatim
 Async - A library for programming event driven applications
-Copyright (C) 2004-2024 Tobias Blomberg / SM0SVX
+Copyright (C) 2004-2026 Tobias Blomberg / SM0SVX
 
 This program is free software; you can redistribute it and/or modify
 it under the terms of the GNU General Public License as published by
@@ -32,9 +32,13 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
  *
  ****************************************************************************/
 
+#include <algorithm>
 #include <cassert>
 #include <cstring>
+#include <deque>
 #include <iostream>
+#include <memory>
+#include <vector>
 
 
 /****************************************************************************
@@ -86,10 +90,12 @@ class Async::AudioSplitter::Branch : public AudioSource
   public:
     int   current_buf_pos;
     bool  is_flushed;
+    bool  flush_pending;
   
     Branch(AudioSplitter *splitter)
-      : current_buf_pos(0), is_flushed(true), is_enabled(true),
-	is_stopped(false), is_flushing(false), splitter(splitter)
+      : current_buf_pos(0), is_flushed(true), flush_pending(false),
+        is_enabled(true), is_stopped(false), is_flushing(false),
+        splitter(splitter), queued(0), is_draining(false)
     {
     }
     
@@ -111,6 +117,8 @@ class Async::AudioSplitter::Branch : public AudioSource
       
       if (!enabled)
       {
+        queue.clear();
+        queued = 0;
 	if (is_stopped)
 	{
 	  is_stopped = false;
@@ -124,9 +132,53 @@ class Async::AudioSplitter::Branch : public AudioSource
 	else if (!is_flushed)
       	{
 	  AudioSource::sinkFlushSamples();
+          if (flush_pending)
+          {
+            flush_pending = false;
+            splitter->branchAllSamplesFlushed();
+          }
 	}
       }
     }
+
+    bool hasQueuedSamples(void) const { return !queue.empty(); }
+
+      /*
+       * Write samples to the branch, queueing what it cannot take. The
+       * block is created on first use so that all branches lagging behind
+       * share the same copy of the samples.
+       */
+    void writeQueued(const float *samples, int len,
+                     std::shared_ptr<std::vector<float>>& block)
+    {
+      flush_pending = false;
+      int written = 0;
+      if (queue.empty())
+      {
+        written = sinkWriteSamples(samples, len);
+      }
+      if (written < len)
+      {
+        if (!block)
+        {
+          block = std::make_shared<std::vector<float>>(samples, samples+len);
+        }
+        queue.push_back({block, static_cast<size_t>(written)});
+        queued += len - written;
+        while (queued > static_cast<size_t>(splitter->max_branch_buf))
+        {
+          QueuedBlock& qb = queue.front();
+          size_t drop = std::min<size_t>(queued - splitter->max_branch_buf,
+                                 qb.samples->size() - qb.pos);
+          qb.pos += drop;
+          queued -= drop;
+          if (qb.pos == qb.samples->size())
+          {
+            queue.pop_front();
+          }
+        }
+      }
+    } /* writeQueued */
     
     int sinkWriteSamples(const float *samples, int len)
     {
@@ -170,15 +222,60 @@ class Async::AudioSplitter::Branch : public AudioSource
     bool      	  is_stopped;
     bool      	  is_flushing;
     AudioSplitter *splitter;
+
+    struct QueuedBlock
+    {
+      std::shared_ptr<const std::vector<float>> samples;
+      size_t                                    pos;
+    };
+    std::deque<QueuedBlock> queue;
+    size_t                  queued;
+    bool                    is_draining;
   
     virtual void resumeOutput(void)
     {
       is_stopped = false;
       if (is_enabled)
       {
+        drainQueue();
       	splitter->branchResumeOutput();
       }
     } /* resumeOutput */
+
+    void drainQueue(void)
+    {
+      if (is_draining || queue.empty())
+      {
+        return;
+      }
+      is_draining = true;
+      while (!queue.empty() && !is_stopped)
+      {
+        QueuedBlock& qb = queue.front();
+        int len = qb.samples->size() - qb.pos;
+        int written = sinkWriteSamples(qb.samples->data() + qb.pos, len);
+        if (queue.empty())
+        {
+          break;  // The branch was disabled while writing
+        }
+        qb.pos += written;
+        queued -= written;
+        if (written == len)
+        {
+          queue.pop_front();
+        }
+        else if (written == 0)
+        {
+          break;
+        }
+      }
+      is_draining = false;
+      if (queue.empty() && flush_pending)
+      {
+        flush_pending = false;
+        sinkFlushSamples();
+      }
+    } /* drainQueue */
     
     virtual void allSamplesFlushed(void)
     {
@@ -228,7 +325,7 @@ class Async::AudioSplitter::Branch : public AudioSource
 
 AudioSplitter::AudioSplitter(void)
   : buf(0), buf_size(0), buf_len(0), do_flush(false), input_stopped(false),
-    flushed_branches(0), main_branch(0)
+    flushed_branches(0), main_branch(0), max_branch_buf(0)
 {
   main_branch = new Branch(this);
   branches.push_back(main_branch);
@@ -321,6 +418,31 @@ void AudioSplitter::enableSink(AudioSink *sink, bool enable)
 } /* AudioSplitter::enableSink */
 
 
+void AudioSplitter::setMaxBranchBuffer(int max_samples)
+{
+  max_branch_buf = std::max(max_samples, 0);
+  if ((max_branch_buf > 0) && (buf_len > 0))
+  {
+      // Move what is left in the copy buffer to the branch queues
+    std::shared_ptr<std::vector<float>> block;
+    for (const auto& branch : branches)
+    {
+      if (branch->current_buf_pos < buf_len)
+      {
+        branch->writeQueued(buf + branch->current_buf_pos,
+                            buf_len - branch->current_buf_pos, block);
+      }
+    }
+    buf_len = 0;
+    if (input_stopped)
+    {
+      input_stopped = false;
+      sourceResumeOutput();
+    }
+  }
+} /* AudioSplitter::setMaxBranchBuffer */
+
+
 int AudioSplitter::writeSamples(const float *samples, int len)
 {
   do_flush = false;
@@ -330,6 +452,16 @@ int AudioSplitter::writeSamples(const float *samples, int len)
     return 0;
   }
 
+  if (max_branch_buf > 0)
+  {
+    std::shared_ptr<std::vector<float>> block;
+    for (const auto& branch : branches)
+    {
+      branch->writeQueued(samples, len, block);
+    }
+    return len;
+  }
+
   if (buf_len > 0)
   {
     input_stopped = true;
@@ -483,7 +615,14 @@ void AudioSplitter::flushAllBranches(void)
   list<Branch *>::iterator it;
   for (it = branches.begin(); it != branches.end(); ++it)
   {
-    (*it)->sinkFlushSamples();
+    if ((*it)->hasQueuedSamples())
+    {
+      (*it)->flush_pending = true;
+    }
+    else
+    {
+      (*it)->sinkFlushSamples();
+    }
   }
 } /* AudioSplitter::flushAllBranches */
 
@@ -6,7 +6,7 @@
 
 \verbatim
 Async - A library for programming event driven applications
-Copyright (C) 2004-2024 Tobias Blomberg / SM0SVX
+Copyright (C) 2004-2026 Tobias Blomberg / SM0SVX
 
 This program is free software; you can redistribute it and/or modify
 it under the terms of the GNU General Public License as published by
@@ -155,6 +155,23 @@ class AudioSplitter : public Async::AudioSink, public Async::AudioSource,
      */
     void enableSink(AudioSink *sink, bool enable);
 
+    /**
+     * @brief   Let each branch consume the audio at its own pace
+     * @param   max_samples The maximum number of samples to queue per branch
+     *
+     * By default, the input to the splitter is stopped as soon as one of the
+     * branches stop its output and it will not be resumed until all branches
+     * have accepted the audio. Setting max_samples to a value larger than
+     * zero instead give each branch a queue of its own. The audio for a
+     * branch that cannot accept it is put on its queue and the input is
+     * never stopped. The queued audio is stored in read-only blocks that are
+     * shared between all branches that lag behind, so one copy at most is
+     * made for each written buffer. If a queue grow beyond max_samples, the
+     * oldest samples on that queue are thrown away. Setting max_samples to
+     * zero restore the default behaviour.
+     */
+    void setMaxBranchBuffer(int max_samples);
+
     /**
      * @brief 	Write samples into this audio sink
      * @param 	samples The buffer containing the samples
@@ -191,6 +208,7 @@ class AudioSplitter : public Async::AudioSink, public Async::AudioSource,
     bool      	      	input_stopped;
     int       	      	flushed_branches;
     Branch              *main_branch;
+    int                 max_branch_buf;
     
     void writeFromBuffer(void);
     void flushAllBranches(void);
@@ -0,0 +1,335 @@
+/**
+@file	 AsyncAudioStats.h
+@brief   Lockless audio health counters shared by audio pipe components
+@author  Tobias Blomberg / SM0SVX
+@date	 2026-10-15
+
+\verbatim
+Async - A library for programming event driven applications
+Copyright (C) 2003-2026 Tobias Blomberg / SM0SVX
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+\endverbatim
+*/
+
+
+#ifndef ASYNC_AUDIO_STATS_INCLUDED
+#define ASYNC_AUDIO_STATS_INCLUDED
+
+
+/****************************************************************************
+ *
+ * System Includes
+ *
+ ****************************************************************************/
+
+#include <atomic>
+#include <cstdint>
+
+
+/****************************************************************************
+ *
+ * Project Includes
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Local Includes
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Forward declarations
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Namespace
+ *
+ ****************************************************************************/
+
+namespace Async
+{
+
+
+/****************************************************************************
+ *
+ * Forward declarations of classes inside of the declared namespace
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Defines & typedefs
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Exported Global Variables
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Class definitions
+ *
+ ****************************************************************************/
+
+/**
+@brief	Lockless audio health counters
+@author Tobias Blomberg / SM0SVX
+@date   2026-10-15
+
+This class hold a set of counters and a latency histogram describing the
+health of an audio path. One object is normally owned by a logic core and
+handed to the audio pipe components of that logic core, which update it
+when something goes wrong, like a FIFO running empty or a frame arriving too
+late. All updates are relaxed atomic operations so it is cheap to update the
+counters from the audio path and it is safe to do so from any thread, like
+a codec thread or an audio device thread.
+
+The counters are read by taking a snapshot, which is a plain copy of all
+values. Snapshots from more than one object can be added together to
+aggregate the statistics.
+
+\code
+  Async::AudioStats stats;
+  fifo->setStats(&stats);
+  ...
+  Async::AudioStats::Snapshot snap;
+  stats.snapshot(snap);
+  std::cout << snap.counters[Async::AudioStats::UNDERRUNS] << std::endl;
+\endcode
+*/
+class AudioStats
+{
+  public:
+    /**
+     * @brief The available counters
+     */
+    typedef enum
+    {
+      UNDERRUNS,        ///< A buffer ran empty in the middle of a stream
+      XRUNS,            ///< Audio device playback or capture xruns
+      LATE_FRAMES,      ///< Network frames that arrived too late
+      LOST_FRAMES,      ///< Network frames that never arrived
+      CONCEALED_FRAMES, ///< Frames recreated by packet loss concealment
+      ENCODER_DROPS,    ///< Audio blocks dropped due to an encoder backlog
+      DECODER_DROPS,    ///< Frames dropped due to a decoder backlog
+      COUNTER_CNT
+    } Counter;
+
+    /**
+     * @brief The number of latency histogram buckets
+     *
+     * The upper bound of bucket i is 2^i milliseconds, except for the last
+     * bucket that count all larger values.
+     */
+    static const unsigned LATENCY_BUCKETS = 12;
+
+    /**
+     * @brief A copy of all values at one point in time
+     */
+    struct Snapshot
+    {
+      uint64_t counters[COUNTER_CNT];           ///< The counter values
+      uint64_t latency_hist[LATENCY_BUCKETS];   ///< Latency bucket counts
+      uint64_t latency_cnt;                     ///< Number of observations
+      double   latency_sum;                     ///< Sum of latencies in ms
+
+      Snapshot(void) { clear(); }
+
+      /**
+       * @brief   Set all values to zero
+       */
+      void clear(void)
+      {
+        for (unsigned i=0; i<COUNTER_CNT; ++i)
+        {
+          counters[i] = 0;
+        }
+        for (unsigned i=0; i<LATENCY_BUCKETS; ++i)
+        {
+          latency_hist[i] = 0;
+        }
+        latency_cnt = 0;
+        latency_sum = 0.0;
+      }
+
+      /**
+       * @brief   Add the values from another snapshot to this one
+       * @param   other The snapshot to add
+       */
+      void add(const Snapshot& other)
+      {
+        for (unsigned i=0; i<COUNTER_CNT; ++i)
+        {
+          counters[i] += other.counters[i];
+        }
+        for (unsigned i=0; i<LATENCY_BUCKETS; ++i)
+        {
+          latency_hist[i] += other.latency_hist[i];
+        }
+        latency_cnt += other.latency_cnt;
+        latency_sum += other.latency_sum;
+      }
+
+      bool operator==(const Snapshot& other) const
+      {
+        for (unsigned i=0; i<COUNTER_CNT; ++i)
+        {
+          if (counters[i] != other.counters[i])
+          {
+            return false;
+          }
+        }
+        return latency_cnt == other.latency_cnt;
+      }
+
+      bool operator!=(const Snapshot& other) const
+      {
+        return !(*this == other);
+      }
+    };
+
+    /**
+     * @brief   Get the name of a counter
+     * @param   counter The counter
+     * @return  Returns a lower case name usable as a key or metric name
+     */
+    static const char* counterName(Counter counter)
+    {
+      static const char* names[COUNTER_CNT] =
+      {
+        "underruns", "xruns", "late_frames", "lost_frames",
+        "concealed_frames", "encoder_drops", "decoder_drops"
+      };
+      return names[counter];
+    }
+
+    /**
+     * @brief   Get the upper bound of a latency histogram bucket
+     * @param   bucket The bucket index
+     * @return  Returns the upper bound in milliseconds
+     */
+    static double latencyBucketBound(unsigned bucket)
+    {
+      return static_cast<double>(1U << bucket);
+    }
+
+    /**
+     * @brief 	Default constructor
+     */
+    AudioStats(void) : m_latency_sum_us(0), m_latency_cnt(0)
+    {
+      for (unsigned i=0; i<COUNTER_CNT; ++i)
+      {
+        m_counters[i].store(0, std::memory_order_relaxed);
+      }
+      for (unsigned i=0; i<LATENCY_BUCKETS; ++i)
+      {
+        m_latency_hist[i].store(0, std::memory_order_relaxed);
+      }
+    }
+
+    AudioStats(const AudioStats&) = delete;
+    AudioStats& operator=(const AudioStats&) = delete;
+
+    /**
+     * @brief   Increase a counter
+     * @param   counter The counter to increase
+     * @param   n       The amount to increase the counter with
+     */
+    void inc(Counter counter, uint64_t n=1)
+    {
+      m_counters[counter].fetch_add(n, std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief   Add a latency observation
+     * @param   latency_ms The latency in milliseconds
+     */
+    void observeLatency(double latency_ms)
+    {
+      unsigned bucket = 0;
+      while ((bucket < LATENCY_BUCKETS-1) &&
+             (latency_ms > latencyBucketBound(bucket)))
+      {
+        ++bucket;
+      }
+      m_latency_hist[bucket].fetch_add(1, std::memory_order_relaxed);
+      m_latency_sum_us.fetch_add(
+          static_cast<uint64_t>(latency_ms * 1000.0),
+          std::memory_order_relaxed);
+      m_latency_cnt.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief   Add the current values to a snapshot
+     * @param   snap The snapshot to add the values to
+     *
+     * The values are added, not assigned, so that the statistics from
+     * more than one object can be aggregated into the same snapshot.
+     */
+    void snapshot(Snapshot& snap) const
+    {
+      for (unsigned i=0; i<COUNTER_CNT; ++i)
+      {
+        snap.counters[i] += m_counters[i].load(std::memory_order_relaxed);
+      }
+      for (unsigned i=0; i<LATENCY_BUCKETS; ++i)
+      {
+        snap.latency_hist[i] +=
+          m_latency_hist[i].load(std::memory_order_relaxed);
+      }
+      snap.latency_cnt += m_latency_cnt.load(std::memory_order_relaxed);
+      snap.latency_sum +=
+        m_latency_sum_us.load(std::memory_order_relaxed) / 1000.0;
+    }
+
+  private:
+    std::atomic<uint64_t> m_counters[COUNTER_CNT];
+    std::atomic<uint64_t> m_latency_hist[LATENCY_BUCKETS];
+    std::atomic<uint64_t> m_latency_sum_us;
+    std::atomic<uint64_t> m_latency_cnt;
+
+};  /* class AudioStats */
+
+
+} /* namespace */
+
+#endif /* ASYNC_AUDIO_STATS_INCLUDED */
+
+
+
+/*
+ * This file has not been truncated
+ */
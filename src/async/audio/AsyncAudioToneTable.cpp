@@ -0,0 +1,251 @@
+/**
+@file	 AsyncAudioToneTable.cpp
+@brief   A precomputed table holding one period of a sine wave
+@author  Tobias Blomberg / SM0SVX
+@date	 2026-10-14
+
+\verbatim
+Async - A library for programming event driven applications
+Copyright (C) 2003-2026 Tobias Blomberg / SM0SVX
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+\endverbatim
+*/
+
+
+
+/****************************************************************************
+ *
+ * System Includes
+ *
+ ****************************************************************************/
+
+#include <cmath>
+#include <cassert>
+#include <cstdint>
+#include <map>
+#include <utility>
+#include <algorithm>
+
+
+/****************************************************************************
+ *
+ * Project Includes
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Local Includes
+ *
+ ****************************************************************************/
+
+#include "AsyncAudioToneTable.h"
+
+
+
+/****************************************************************************
+ *
+ * Namespaces to use
+ *
+ ****************************************************************************/
+
+using namespace std;
+using namespace Async;
+
+
+
+/****************************************************************************
+ *
+ * Defines & typedefs
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Local class definitions
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Prototypes
+ *
+ ****************************************************************************/
+
+static unsigned gcd(unsigned a, unsigned b);
+
+
+
+/****************************************************************************
+ *
+ * Exported Global Variables
+ *
+ ****************************************************************************/
+
+
+
+
+/****************************************************************************
+ *
+ * Local Global Variables
+ *
+ ****************************************************************************/
+
+
+
+
+/****************************************************************************
+ *
+ * Public member functions
+ *
+ ****************************************************************************/
+
+AudioToneTable::Ptr AudioToneTable::get(unsigned fq, unsigned sample_rate)
+{
+  typedef std::map<std::pair<unsigned, unsigned>, Ptr> Cache;
+  static Cache cache;
+
+  const Cache::key_type key(fq, sample_rate);
+  Cache::iterator it = cache.find(key);
+  if (it != cache.end())
+  {
+    return it->second;
+  }
+
+    // Make room for the new table by throwing away a table that is not
+    // currently in use. If all tables are in use, the cache is allowed to
+    // grow a bit.
+  if (cache.size() >= MAX_CACHED_TABLES)
+  {
+    for (it=cache.begin(); it!=cache.end(); ++it)
+    {
+      if (it->second.use_count() == 1)
+      {
+        cache.erase(it);
+        break;
+      }
+    }
+  }
+
+  Ptr table(new AudioToneTable(fq, sample_rate));
+  cache[key] = table;
+  return table;
+} /* AudioToneTable::get */
+
+
+AudioToneTable::AudioToneTable(unsigned fq, unsigned sample_rate)
+  : m_fq(fq), m_sample_rate(sample_rate)
+{
+  assert(sample_rate > 0);
+  const unsigned period = sample_rate / gcd(fq % sample_rate, sample_rate);
+  m_table.resize(period);
+  for (unsigned i=0; i<period; ++i)
+  {
+      // The phase is reduced to one period using integer arithmetic so that
+      // the precision does not depend on the position in the tone
+    const uint64_t phase = (static_cast<uint64_t>(fq) * i) % sample_rate;
+    m_table[i] = sin(2 * M_PI * static_cast<double>(phase) / sample_rate);
+  }
+} /* AudioToneTable::AudioToneTable */
+
+
+void AudioToneTable::read(float *dest, size_t pos, size_t count,
+                          float amp) const
+{
+  const size_t period = m_table.size();
+  pos %= period;
+  while (count > 0)
+  {
+    const size_t len = min(count, period - pos);
+    const float *src = m_table.data() + pos;
+    for (size_t i=0; i<len; ++i)
+    {
+      dest[i] = amp * src[i];
+    }
+    dest += len;
+    count -= len;
+    pos = 0;
+  }
+} /* AudioToneTable::read */
+
+
+void AudioToneTable::add(float *dest, size_t pos, size_t count,
+                         float amp) const
+{
+  const size_t period = m_table.size();
+  pos %= period;
+  while (count > 0)
+  {
+    const size_t len = min(count, period - pos);
+    const float *src = m_table.data() + pos;
+    for (size_t i=0; i<len; ++i)
+    {
+      dest[i] += amp * src[i];
+    }
+    dest += len;
+    count -= len;
+    pos = 0;
+  }
+} /* AudioToneTable::add */
+
+
+
+/****************************************************************************
+ *
+ * Protected member functions
+ *
+ ****************************************************************************/
+
+
+
+
+/****************************************************************************
+ *
+ * Private member functions
+ *
+ ****************************************************************************/
+
+
+
+
+/****************************************************************************
+ *
+ * Local functions
+ *
+ ****************************************************************************/
+
+static unsigned gcd(unsigned a, unsigned b)
+{
+  while (b != 0)
+  {
+    unsigned t = a % b;
+    a = b;
+    b = t;
+  }
+  return a;
+} /* gcd */
+
+
+
+/*
+ * This file has not been truncated
+ */
@@ -0,0 +1,193 @@
+/**
+@file	 AsyncAudioToneTable.h
+@brief   A precomputed table holding one period of a sine wave
+@author  Tobias Blomberg / SM0SVX
+@date	 2026-10-14
+
+\verbatim
+Async - A library for programming event driven applications
+Copyright (C) 2003-2026 Tobias Blomberg / SM0SVX
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+\endverbatim
+*/
+
+#ifndef ASYNC_AUDIO_TONE_TABLE_INCLUDED
+#define ASYNC_AUDIO_TONE_TABLE_INCLUDED
+
+
+/****************************************************************************
+ *
+ * System Includes
+ *
+ ****************************************************************************/
+
+#include <vector>
+#include <memory>
+#include <cstddef>
+
+
+/****************************************************************************
+ *
+ * Project Includes
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Local Includes
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Forward declarations
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Namespace
+ *
+ ****************************************************************************/
+
+namespace Async
+{
+
+
+/****************************************************************************
+ *
+ * Forward declarations of classes inside of the declared namespace
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Defines & typedefs
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Exported Global Variables
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Class definitions
+ *
+ ****************************************************************************/
+
+/**
+@brief	A precomputed table holding one period of a sine wave
+@author Tobias Blomberg / SM0SVX
+@date   2026-10-14
+
+A sine wave with an integer frequency, sampled at an integer sample rate, is
+periodic with a period of sample_rate / gcd(fq, sample_rate) samples. This
+class calculate that period once so that tones can be generated by copying
+samples from memory instead of calling sin() for each sample. Tables are
+shared through a small cache, using the get function, so that tones that are
+played over and over again, like CW and DTMF tones, are only calculated once.
+
+The generated samples are the same as when calculating
+sin(2 * M_PI * fq * pos / sample_rate) directly, except that they do not
+suffer from the loss of precision that occur for large values of pos.
+*/
+class AudioToneTable
+{
+  public:
+    typedef std::shared_ptr<const AudioToneTable> Ptr;
+
+    /**
+     * @brief   Get a table from the cache, creating it if needed
+     * @param   fq          The tone frequency in Hz
+     * @param   sample_rate The sample rate in Hz
+     * @return  Returns a shared table for the given parameters
+     */
+    static Ptr get(unsigned fq, unsigned sample_rate);
+
+    /**
+     * @brief   Constructor
+     * @param   fq          The tone frequency in Hz
+     * @param   sample_rate The sample rate in Hz
+     */
+    AudioToneTable(unsigned fq, unsigned sample_rate);
+
+    /**
+     * @brief   Get the tone frequency
+     * @return  Returns the tone frequency in Hz
+     */
+    unsigned fq(void) const { return m_fq; }
+
+    /**
+     * @brief   Get the period of the tone
+     * @return  Returns the number of samples in one period
+     */
+    size_t period(void) const { return m_table.size(); }
+
+    /**
+     * @brief   Write samples from the table
+     * @param   dest  The buffer to write the samples to
+     * @param   pos   The sample position, from the start of the tone
+     * @param   count The number of samples to write
+     * @param   amp   The amplitude of the tone
+     */
+    void read(float *dest, size_t pos, size_t count, float amp) const;
+
+    /**
+     * @brief   Add samples from the table to a buffer
+     * @param   dest  The buffer to add the samples to
+     * @param   pos   The sample position, from the start of the tone
+     * @param   count The number of samples to add
+     * @param   amp   The amplitude of the tone
+     */
+    void add(float *dest, size_t pos, size_t count, float amp) const;
+
+  private:
+    static const size_t MAX_CACHED_TABLES = 16;
+
+    unsigned            m_fq;
+    unsigned            m_sample_rate;
+    std::vector<float>  m_table;
+
+    AudioToneTable(const AudioToneTable&);
+    AudioToneTable& operator=(const AudioToneTable&);
+
+};  /* class AudioToneTable */
+
+
+} /* namespace */
+
+#endif /* ASYNC_AUDIO_TONE_TABLE_INCLUDED */
+
+
+
+/*
+ * This file has not been truncated
+ */
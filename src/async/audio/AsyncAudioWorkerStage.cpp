@@ -0,0 +1,412 @@
+/**
+@file	 AsyncAudioWorkerStage.cpp
+@brief   Run an audio processor in a worker thread
+@author  Tobias Blomberg / SM0SVX
+@date	 2026-10-14
+
+\verbatim
+Async - A library for programming event driven applications
+Copyright (C) 2003-2026 Tobias Blomberg / SM0SVX
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+\endverbatim
+*/
+
+
+
+/****************************************************************************
+ *
+ * System Includes
+ *
+ ****************************************************************************/
+
+#include <sigc++/sigc++.h>
+
+#include <cassert>
+#include <algorithm>
+
+
+/****************************************************************************
+ *
+ * Project Includes
+ *
+ ****************************************************************************/
+
+#include <AsyncApplication.h>
+
+
+/****************************************************************************
+ *
+ * Local Includes
+ *
+ ****************************************************************************/
+
+#include "AsyncAudioProcessor.h"
+#include "AsyncAudioWorkerStage.h"
+
+
+
+/****************************************************************************
+ *
+ * Namespaces to use
+ *
+ ****************************************************************************/
+
+using namespace std;
+using namespace Async;
+
+
+
+/****************************************************************************
+ *
+ * Defines & typedefs
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Local class definitions
+ *
+ ****************************************************************************/
+
+  // The part of a worker stage that is used by the worker thread. It is
+  // reference counted so that a job in progress can finish safely even if
+  // the stage is deleted.
+struct AudioWorkerStage::State
+{
+  class Collector : public AudioSink
+  {
+    public:
+      vector<float> *out      = nullptr;
+      bool          flushed   = false;
+
+      int writeSamples(const float *samples, int count) override
+      {
+        out->insert(out->end(), samples, samples + count);
+        return count;
+      }
+
+      void flushSamples(void) override
+      {
+        flushed = true;
+        sourceAllSamplesFlushed();
+      }
+  };
+
+  Collector                 collector;
+  unique_ptr<AudioProcessor> proc;
+  vector<float>             job_in;
+  vector<float>             job_out;
+  bool                      job_flush = false;
+
+  void process(void)
+  {
+    job_out.clear();
+    collector.out = &job_out;
+    const float *ptr = job_in.empty() ? nullptr : &job_in[0];
+    int left = job_in.size();
+    while (left > 0)
+    {
+      int cnt = proc->writeSamples(ptr, left);
+      if (cnt <= 0)
+      {
+        break;
+      }
+      ptr += cnt;
+      left -= cnt;
+    }
+    job_in.clear();
+    if (job_flush)
+    {
+      collector.flushed = false;
+      proc->flushSamples();
+    }
+  }
+};
+
+
+
+/****************************************************************************
+ *
+ * Prototypes
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Exported Global Variables
+ *
+ ****************************************************************************/
+
+
+
+
+/****************************************************************************
+ *
+ * Local Global Variables
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Public member functions
+ *
+ ****************************************************************************/
+
+AudioWorkerStage::Group::Group(unsigned threads)
+  : pool(threads), batch_scheduled(false), in_flight(0)
+{
+} /* AudioWorkerStage::Group::Group */
+
+
+AudioWorkerStage::Group::~Group(void)
+{
+  assert(std::none_of(stages.begin(), stages.end(),
+                      [](AudioWorkerStage *s) { return s != 0; }));
+} /* AudioWorkerStage::Group::~Group */
+
+
+AudioWorkerStage::AudioWorkerStage(Group& group, AudioProcessor *proc,
+                                   unsigned buf_size)
+  : group(group), state(make_shared<State>()), out_pos(0), busy(false),
+    flush_pending(false), out_flush(false), job_flush_cancelled(false),
+    is_flushing(false), input_stopped(false)
+{
+  assert(proc != 0);
+  assert(buf_size > 0);
+  state->proc.reset(proc);
+  proc->registerSink(&state->collector);
+
+    // All buffers are allocated up front. The input and output buffers
+    // are swapped with the job buffers so they never have to grow.
+  in_buf.reserve(buf_size);
+  state->job_in.reserve(buf_size);
+  out_buf.reserve(buf_size);
+  state->job_out.reserve(buf_size);
+
+  group.addStage(this);
+} /* AudioWorkerStage::AudioWorkerStage */
+
+
+AudioWorkerStage::~AudioWorkerStage(void)
+{
+  group.removeStage(this);
+} /* AudioWorkerStage::~AudioWorkerStage */
+
+
+int AudioWorkerStage::writeSamples(const float *samples, int count)
+{
+  assert(count > 0);
+
+    // Writing new samples cancel any ongoing flush
+  flush_pending = false;
+  out_flush = false;
+  job_flush_cancelled = busy;
+  is_flushing = false;
+  int cnt = min(static_cast<size_t>(count),
+                in_buf.capacity() - in_buf.size());
+  if (cnt == 0)
+  {
+    input_stopped = true;
+    return 0;
+  }
+  in_buf.insert(in_buf.end(), samples, samples + cnt);
+  group.scheduleBatch();
+  return cnt;
+} /* AudioWorkerStage::writeSamples */
+
+
+void AudioWorkerStage::flushSamples(void)
+{
+  flush_pending = true;
+  group.scheduleBatch();
+} /* AudioWorkerStage::flushSamples */
+
+
+void AudioWorkerStage::resumeOutput(void)
+{
+  writeOutput();
+  if (hasWork())
+  {
+    group.scheduleBatch();
+  }
+} /* AudioWorkerStage::resumeOutput */
+
+
+void AudioWorkerStage::allSamplesFlushed(void)
+{
+  if (is_flushing && !hasWork() && !busy)
+  {
+    is_flushing = false;
+    sourceAllSamplesFlushed();
+  }
+} /* AudioWorkerStage::allSamplesFlushed */
+
+
+
+/****************************************************************************
+ *
+ * Protected member functions
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Private member functions
+ *
+ ****************************************************************************/
+
+void AudioWorkerStage::Group::addStage(AudioWorkerStage *stage)
+{
+  stages.push_back(stage);
+} /* AudioWorkerStage::Group::addStage */
+
+
+void AudioWorkerStage::Group::removeStage(AudioWorkerStage *stage)
+{
+    // The slot is just cleared since the stage may be removed while the
+    // stages are being iterated
+  replace(stages.begin(), stages.end(), stage,
+          static_cast<AudioWorkerStage*>(0));
+} /* AudioWorkerStage::Group::removeStage */
+
+
+void AudioWorkerStage::Group::scheduleBatch(void)
+{
+  if (!batch_scheduled && (in_flight == 0))
+  {
+    batch_scheduled = true;
+    Application::app().runTask(
+        sigc::mem_fun(*this, &AudioWorkerStage::Group::startBatch));
+  }
+} /* AudioWorkerStage::Group::scheduleBatch */
+
+
+void AudioWorkerStage::Group::startBatch(void)
+{
+  batch_scheduled = false;
+  stages.erase(remove(stages.begin(), stages.end(),
+                      static_cast<AudioWorkerStage*>(0)),
+               stages.end());
+  for (size_t i=0; i<stages.size(); ++i)
+  {
+    AudioWorkerStage *stage = stages[i];
+    if ((stage != 0) && !stage->busy && stage->hasWork() &&
+        (stage->out_pos == stage->out_buf.size()))
+    {
+      ++in_flight;
+      stage->startJob();
+    }
+  }
+} /* AudioWorkerStage::Group::startBatch */
+
+
+void AudioWorkerStage::Group::jobDone(void)
+{
+  assert(in_flight > 0);
+  if (--in_flight > 0)
+  {
+    return;
+  }
+
+    // All jobs in the batch are done. Deliver the result in the order the
+    // stages were created.
+  bool more_work = false;
+  for (size_t i=0; i<stages.size(); ++i)
+  {
+    AudioWorkerStage *stage = stages[i];
+    if ((stage != 0) && stage->busy)
+    {
+      stage->jobFinished();
+    }
+  }
+  for (size_t i=0; i<stages.size(); ++i)
+  {
+    more_work = more_work || ((stages[i] != 0) && stages[i]->hasWork());
+  }
+  if (more_work)
+  {
+    scheduleBatch();
+  }
+} /* AudioWorkerStage::Group::jobDone */
+
+
+void AudioWorkerStage::startJob(void)
+{
+  busy = true;
+  swap(in_buf, state->job_in);
+  state->job_flush = flush_pending;
+  flush_pending = false;
+  job_flush_cancelled = false;
+
+  shared_ptr<State> st(state);
+  Group *grp = &group;
+  group.pool.run([st](void) { st->process(); },
+                 [st, grp](void) { grp->jobDone(); });
+
+  if (input_stopped)
+  {
+    input_stopped = false;
+    sourceResumeOutput();
+  }
+} /* AudioWorkerStage::startJob */
+
+
+void AudioWorkerStage::jobFinished(void)
+{
+  busy = false;
+  swap(out_buf, state->job_out);
+  out_pos = 0;
+  out_flush = out_flush || (state->job_flush && !job_flush_cancelled);
+  writeOutput();
+} /* AudioWorkerStage::jobFinished */
+
+
+void AudioWorkerStage::writeOutput(void)
+{
+  while (out_pos < out_buf.size())
+  {
+    int cnt = sinkWriteSamples(&out_buf[out_pos], out_buf.size() - out_pos);
+    if (cnt <= 0)
+    {
+      return;
+    }
+    out_pos += cnt;
+  }
+  out_buf.clear();
+  out_pos = 0;
+
+  if (out_flush && !busy && !hasWork())
+  {
+    out_flush = false;
+    is_flushing = true;
+    sinkFlushSamples();
+  }
+} /* AudioWorkerStage::writeOutput */
+
+
+
+/*
+ * This file has not been truncated
+ */
+
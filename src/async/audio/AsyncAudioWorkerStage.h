@@ -0,0 +1,271 @@
+/**
+@file	 AsyncAudioWorkerStage.h
+@brief   Run an audio processor in a worker thread
+@author  Tobias Blomberg / SM0SVX
+@date	 2026-10-14
+
+\verbatim
+Async - A library for programming event driven applications
+Copyright (C) 2003-2026 Tobias Blomberg / SM0SVX
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+\endverbatim
+*/
+
+#ifndef ASYNC_AUDIO_WORKER_STAGE_INCLUDED
+#define ASYNC_AUDIO_WORKER_STAGE_INCLUDED
+
+
+/****************************************************************************
+ *
+ * System Includes
+ *
+ ****************************************************************************/
+
+#include <sigc++/sigc++.h>
+
+#include <memory>
+#include <vector>
+
+
+/****************************************************************************
+ *
+ * Project Includes
+ *
+ ****************************************************************************/
+
+#include <AsyncAudioSink.h>
+#include <AsyncAudioSource.h>
+#include <AsyncWorkerPool.h>
+
+
+/****************************************************************************
+ *
+ * Local Includes
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Forward declarations
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Namespace
+ *
+ ****************************************************************************/
+
+namespace Async
+{
+
+
+/****************************************************************************
+ *
+ * Forward declarations of classes inside of the declared namespace
+ *
+ ****************************************************************************/
+
+class AudioProcessor;
+
+
+/****************************************************************************
+ *
+ * Defines & typedefs
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Exported Global Variables
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Class definitions
+ *
+ ****************************************************************************/
+
+/**
+@brief	Run an audio processor in a worker thread
+@author Tobias Blomberg / SM0SVX
+@date   2026-10-14
+
+This audio pipe component run an audio processor, often an
+Async::AudioProcessorChain, in a worker thread instead of in the main
+thread. It is used to spread the load of many audio pipes that are doing
+heavy signal processing, like the receivers in a voter, over more than one
+CPU core.
+
+All worker stages sharing the same Async::AudioWorkerStage::Group are
+processed in batches. Audio written to a stage is buffered until the end of
+the current main loop iteration. Then the buffered audio for all stages in
+the group is processed in parallel in the worker threads. When all stages
+in the batch are done, the processed audio is written to the sinks of the
+stages from the main loop, in the order the stages were created. That make
+the order of everything happening further down the audio pipes
+deterministic, no matter how the threads were scheduled. Audio arriving
+while a batch is being processed is put in the next batch.
+
+Only the processor is run in the worker thread so it must not emit signals,
+use timers or touch anything else that belong to the main thread. Filters,
+amplifiers, decimators and similar processors are fine. Detectors that
+emit signals must be connected after the worker stage. Each batch add a
+small delay, typically well below a millisecond, to the audio.
+
+The input buffer is allocated when the stage is created and the stage stop
+accepting audio when it is full so the memory usage is predictable.
+*/
+class AudioWorkerStage : public AudioSink, public AudioSource
+{
+  public:
+    /**
+     * @brief A group of worker stages that are processed together
+     */
+    class Group : public sigc::trackable
+    {
+      public:
+        /**
+         * @brief   Constructor
+         * @param   threads The number of worker threads to use
+         */
+        explicit Group(unsigned threads);
+
+        /**
+         * @brief   Destructor
+         *
+         * All stages in the group must be deleted before the group.
+         */
+        ~Group(void);
+
+        /**
+         * @brief   Check if the initialization was ok
+         * @return  Returns \em true if the worker threads were started
+         */
+        bool initOk(void) const { return pool.initOk(); }
+
+        /**
+         * @brief   Get the number of worker threads
+         * @return  Returns the number of worker threads
+         */
+        unsigned threadCount(void) const { return pool.threadCount(); }
+
+      private:
+        friend class AudioWorkerStage;
+
+        WorkerPool                      pool;
+        std::vector<AudioWorkerStage*>  stages;
+        bool                            batch_scheduled;
+        unsigned                        in_flight;
+
+        Group(const Group&);
+        Group& operator=(const Group&);
+        void addStage(AudioWorkerStage *stage);
+        void removeStage(AudioWorkerStage *stage);
+        void scheduleBatch(void);
+        void startBatch(void);
+        void jobDone(void);
+    };
+
+    /**
+     * @brief The default input buffer size in samples
+     */
+    static const unsigned DEFAULT_BUFFER_SIZE = 4096;
+
+    /**
+     * @brief 	Constuctor
+     * @param 	group     The group that this stage belong to
+     * @param 	proc      The processor to run, owned by this object
+     * @param 	buf_size  The size of the input buffer in samples
+     *
+     * The processor must not be connected to anything else. It is deleted
+     * when it is no longer used by a worker thread, which may be after this
+     * object has been deleted.
+     */
+    AudioWorkerStage(Group& group, AudioProcessor *proc,
+                     unsigned buf_size=DEFAULT_BUFFER_SIZE);
+
+    /**
+     * @brief 	Destructor
+     */
+    ~AudioWorkerStage(void);
+
+    /**
+     * @brief 	Write samples into this audio sink
+     * @param 	samples The buffer containing the samples
+     * @param 	count The number of samples in the buffer
+     * @return	Returns the number of samples that has been taken care of
+     */
+    int writeSamples(const float *samples, int count) override;
+
+    /**
+     * @brief 	Tell the sink to flush the previously written samples
+     */
+    void flushSamples(void) override;
+
+    /**
+     * @brief Resume audio output to the sink
+     */
+    void resumeOutput(void) override;
+
+    /**
+     * @brief The registered sink has flushed all samples
+     */
+    void allSamplesFlushed(void) override;
+
+  private:
+    struct State;
+
+    Group&                  group;
+    std::shared_ptr<State>  state;
+    std::vector<float>      in_buf;
+    std::vector<float>      out_buf;
+    size_t                  out_pos;
+    bool                    busy;
+    bool                    flush_pending;
+    bool                    out_flush;
+    bool                    job_flush_cancelled;
+    bool                    is_flushing;
+    bool                    input_stopped;
+
+    AudioWorkerStage(const AudioWorkerStage&);
+    AudioWorkerStage& operator=(const AudioWorkerStage&);
+    bool hasWork(void) const { return !in_buf.empty() || flush_pending; }
+    void startJob(void);
+    void jobFinished(void);
+    void writeOutput(void);
+
+};  /* class AudioWorkerStage */
+
+
+} /* namespace */
+
+#endif /* ASYNC_AUDIO_WORKER_STAGE_INCLUDED */
+
+
+
+/*
+ * This file has not been truncated
+ */
@@ -0,0 +1,305 @@
+/**
+@file	 AsyncSimd.cpp
+@brief   SIMD kernels selected at runtime depending on the CPU
+@author  Tobias Blomberg / SM0SVX
+@date	 2026-10-14
+
+\verbatim
+Async - A library for programming event driven applications
+Copyright (C) 2003-2026 Tobias Blomberg / SM0SVX
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+\endverbatim
+*/
+
+
+
+/****************************************************************************
+ *
+ * System Includes
+ *
+ ****************************************************************************/
+
+#if defined(__arm__) && defined(__linux__)
+#include <sys/auxv.h>
+#include <asm/hwcap.h>
+#endif
+
+
+/****************************************************************************
+ *
+ * Project Includes
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Local Includes
+ *
+ ****************************************************************************/
+
+#include "AsyncSimd.h"
+#include "AsyncSimdKernels.h"
+
+
+
+/****************************************************************************
+ *
+ * Namespaces to use
+ *
+ ****************************************************************************/
+
+using namespace std;
+using namespace Async;
+
+
+
+/****************************************************************************
+ *
+ * Defines & typedefs
+ *
+ ****************************************************************************/
+
+#if defined(__arm__) && defined(__linux__) && !defined(HWCAP_NEON)
+#define HWCAP_NEON (1 << 12)
+#endif
+
+
+
+/****************************************************************************
+ *
+ * Local class definitions
+ *
+ ****************************************************************************/
+
+namespace {
+  ASYNC_SIMD_KERNEL_TABLE(generic, )
+
+    // On x86, also build the kernels for CPU:s supporting AVX2 and FMA
+#if defined(ASYNC_SIMD_VECTOR_EXT) && defined(__x86_64__)
+#define ASYNC_SIMD_AVX2
+  ASYNC_SIMD_KERNEL_TABLE(avx2, __attribute__((target("avx2,fma"))))
+#endif
+
+  struct Active
+  {
+    Simd::Isa                 isa;
+    const SimdKernels::Table* table;
+  };
+
+  const SimdKernels::Table* kernelTable(Simd::Isa isa)
+  {
+    switch (isa)
+    {
+      case Simd::ISA_GENERIC:
+        return &generic::table;
+      case Simd::ISA_AVX2:
+#ifdef ASYNC_SIMD_AVX2
+        return &avx2::table;
+#else
+        return 0;
+#endif
+      case Simd::ISA_NEON:
+        return SimdKernels::neonTable();
+    }
+    return 0;
+  } /* kernelTable */
+
+
+  bool cpuSupports(Simd::Isa isa)
+  {
+    switch (isa)
+    {
+      case Simd::ISA_GENERIC:
+        return true;
+      case Simd::ISA_AVX2:
+#ifdef ASYNC_SIMD_AVX2
+        __builtin_cpu_init();
+        return __builtin_cpu_supports("avx2") &&
+               __builtin_cpu_supports("fma");
+#else
+        return false;
+#endif
+      case Simd::ISA_NEON:
+#if defined(__aarch64__)
+          // NEON is a mandatory part of the 64 bit ARM architecture
+        return true;
+#elif defined(__arm__) && defined(__linux__)
+        return (getauxval(AT_HWCAP) & HWCAP_NEON) != 0;
+#else
+        return false;
+#endif
+    }
+    return false;
+  } /* cpuSupports */
+
+
+    // The best instruction set is selected the first time a kernel is used.
+    // Doing it on first use rather than at load time make it safe to use the
+    // kernels from the constructors of static objects.
+  Active& active(void)
+  {
+    static Active a = []
+      {
+        for (Simd::Isa isa : {Simd::ISA_AVX2, Simd::ISA_NEON})
+        {
+          if (Simd::isSupported(isa))
+          {
+            return Active{isa, kernelTable(isa)};
+          }
+        }
+        return Active{Simd::ISA_GENERIC, kernelTable(Simd::ISA_GENERIC)};
+      }();
+    return a;
+  } /* active */
+};
+
+
+
+/****************************************************************************
+ *
+ * Prototypes
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Exported Global Variables
+ *
+ ****************************************************************************/
+
+
+
+
+/****************************************************************************
+ *
+ * Local Global Variables
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Public member functions
+ *
+ ****************************************************************************/
+
+bool Simd::isSupported(Isa isa)
+{
+  return (kernelTable(isa) != 0) && cpuSupports(isa);
+} /* Simd::isSupported */
+
+
+Simd::Isa Simd::isa(void)
+{
+  return active().isa;
+} /* Simd::isa */
+
+
+bool Simd::setIsa(Isa isa)
+{
+  if (!isSupported(isa))
+  {
+    return false;
+  }
+  active() = Active{isa, kernelTable(isa)};
+  return true;
+} /* Simd::setIsa */
+
+
+const char *Simd::isaName(Isa isa)
+{
+  switch (isa)
+  {
+    case ISA_GENERIC:
+      return "generic";
+    case ISA_AVX2:
+      return "avx2";
+    case ISA_NEON:
+      return "neon";
+  }
+  return "?";
+} /* Simd::isaName */
+
+
+float Simd::dotProduct(const float *a, const float *b, size_t cnt)
+{
+  return active().table->dotProduct(a, b, cnt);
+} /* Simd::dotProduct */
+
+
+void Simd::complexMac(float *acc, const float *a, const float *b,
+                      size_t cnt)
+{
+  active().table->complexMac(acc, a, b, cnt);
+} /* Simd::complexMac */
+
+
+void Simd::complexMultiply(float *dst, const float *a, const float *b,
+                           size_t cnt)
+{
+  active().table->complexMultiply(dst, a, b, cnt);
+} /* Simd::complexMultiply */
+
+
+void Simd::multiply(float *dst, const float *a, const float *b, size_t cnt)
+{
+  active().table->multiply(dst, a, b, cnt);
+} /* Simd::multiply */
+
+
+void Simd::add(float *dst, const float *src, size_t cnt)
+{
+  active().table->add(dst, src, cnt);
+} /* Simd::add */
+
+
+void Simd::s16ToFloat(float *dst, const int16_t *src, size_t cnt)
+{
+  active().table->s16ToFloat(dst, src, cnt);
+} /* Simd::s16ToFloat */
+
+
+void Simd::floatToS16(int16_t *dst, const float *src, size_t cnt)
+{
+  active().table->floatToS16(dst, src, cnt);
+} /* Simd::floatToS16 */
+
+
+
+/****************************************************************************
+ *
+ * Protected member functions
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Private member functions
+ *
+ ****************************************************************************/
+
+
+
+/*
+ * This file has not been truncated
+ */
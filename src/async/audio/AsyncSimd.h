@@ -0,0 +1,262 @@
+/**
+@file	 AsyncSimd.h
+@brief   SIMD kernels selected at runtime depending on the CPU
+@author  Tobias Blomberg / SM0SVX
+@date	 2026-10-14
+
+Implements a small set of vectorized DSP kernels, built for a number of
+instruction sets, together with a runtime check of what the CPU support.
+
+\verbatim
+Async - A library for programming event driven applications
+Copyright (C) 2003-2026 Tobias Blomberg / SM0SVX
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+\endverbatim
+*/
+
+#ifndef ASYNC_SIMD_INCLUDED
+#define ASYNC_SIMD_INCLUDED
+
+
+/****************************************************************************
+ *
+ * System Includes
+ *
+ ****************************************************************************/
+
+#include <stdint.h>
+#include <cstddef>
+
+
+/****************************************************************************
+ *
+ * Project Includes
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Local Includes
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Forward declarations
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Namespace
+ *
+ ****************************************************************************/
+
+namespace Async
+{
+
+
+/****************************************************************************
+ *
+ * Forward declarations of classes inside of the declared namespace
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Defines & typedefs
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Exported Global Variables
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Class definitions
+ *
+ ****************************************************************************/
+
+/**
+@brief	SIMD kernels with runtime CPU feature dispatch
+@author Tobias Blomberg / SM0SVX
+@date   2026-10-14
+
+This class gather a few DSP kernels that are used in the innermost loops of
+the filters, detectors and demodulators. Each kernel is built for a number of
+instruction sets and the best version supported by the CPU is selected the
+first time a kernel is used. This make it possible to use NEON on 32 bit ARM
+boards, like the Raspberry Pi, and AVX2 on x86, without requiring the whole
+program to be built for a specific CPU.
+
+The kernels are written using the GCC vector extensions so the same source
+is used for all instruction sets. Since the summation order differ between
+the instruction sets, the result of the reducing kernels may differ in the
+last bits between CPU:s.
+
+Complex samples are stored interleaved, i.e. the real part followed by the
+imaginary part, which is the same layout as for std::complex<float>.
+*/
+class Simd
+{
+  public:
+    /**
+     * @brief The instruction sets that kernels are built for
+     */
+    typedef enum
+    {
+      ISA_GENERIC,  ///< The base instruction set of the build
+      ISA_AVX2,     ///< x86 with AVX2 and FMA
+      ISA_NEON      ///< ARM with NEON (Advanced SIMD)
+    } Isa;
+
+    /**
+     * @brief   Check if the CPU support the given instruction set
+     * @param   isa The instruction set to check
+     * @return  Returns \em true if kernels for the instruction set are built
+     *          and the CPU support it
+     */
+    static bool isSupported(Isa isa);
+
+    /**
+     * @brief   Get the instruction set used by the kernels
+     * @return  Returns the instruction set of the active kernels
+     */
+    static Isa isa(void);
+
+    /**
+     * @brief   Select which instruction set to use
+     * @param   isa The instruction set to use
+     * @return  Returns \em true on success or \em false if not supported
+     *
+     * The best supported instruction set is selected automatically so this
+     * function is normally only used for benchmarking or for verifying that
+     * all versions of the kernels give the same result. It must not be
+     * called while kernels are being run in other threads.
+     */
+    static bool setIsa(Isa isa);
+
+    /**
+     * @brief   Get the name of an instruction set
+     * @param   isa The instruction set
+     * @return  Returns the name, e.g. "neon"
+     */
+    static const char *isaName(Isa isa);
+
+    /**
+     * @brief   Calculate the dot product of two vectors
+     * @param   a     The first vector
+     * @param   b     The second vector
+     * @param   cnt   The number of elements in each vector
+     * @return  Returns the sum of a[i]*b[i]
+     */
+    static float dotProduct(const float *a, const float *b, size_t cnt);
+
+    /**
+     * @brief   Multiply and accumulate two complex vectors
+     * @param   acc   The complex accumulator to add the result to
+     * @param   a     The first vector of interleaved complex samples
+     * @param   b     The second vector of interleaved complex samples
+     * @param   cnt   The number of complex samples in each vector
+     *
+     * The sum of a[i]*b[i] is added to the complex number in acc[0] and
+     * acc[1].
+     */
+    static void complexMac(float *acc, const float *a, const float *b,
+                           size_t cnt);
+
+    /**
+     * @brief   Multiply two complex vectors element by element
+     * @param   dst   The interleaved complex destination buffer
+     * @param   a     The first vector of interleaved complex samples
+     * @param   b     The second vector of interleaved complex samples
+     * @param   cnt   The number of complex samples in each vector
+     *
+     * The destination buffer may be the same as one of the sources.
+     */
+    static void complexMultiply(float *dst, const float *a, const float *b,
+                                size_t cnt);
+
+    /**
+     * @brief   Multiply two vectors element by element
+     * @param   dst   The destination buffer
+     * @param   a     The first vector
+     * @param   b     The second vector
+     * @param   cnt   The number of elements in each vector
+     *
+     * The destination buffer may be the same as one of the sources.
+     */
+    static void multiply(float *dst, const float *a, const float *b,
+                         size_t cnt);
+
+    /**
+     * @brief   Add a vector to another vector element by element
+     * @param   dst   The vector to add to
+     * @param   src   The vector to add
+     * @param   cnt   The number of elements in each vector
+     */
+    static void add(float *dst, const float *src, size_t cnt);
+
+    /**
+     * @brief   Convert 16 bit samples to float samples
+     * @param   dst   The destination buffer
+     * @param   src   The source buffer
+     * @param   cnt   The number of samples to convert
+     *
+     * A sample value of -32768 is converted to -1.0.
+     */
+    static void s16ToFloat(float *dst, const int16_t *src, size_t cnt);
+
+    /**
+     * @brief   Convert float samples to clipped 16 bit samples
+     * @param   dst   The destination buffer
+     * @param   src   The source buffer
+     * @param   cnt   The number of samples to convert
+     *
+     * The samples are scaled by 32767 and clipped to +/-32767.
+     */
+    static void floatToS16(int16_t *dst, const float *src, size_t cnt);
+
+  private:
+    Simd(void);
+
+};  /* class Simd */
+
+
+} /* namespace */
+
+#endif /* ASYNC_SIMD_INCLUDED */
+
+
+
+/*
+ * This file has not been truncated
+ */
@@ -0,0 +1,448 @@
+/**
+@file	 AsyncSimdKernels.h
+@brief   The implementation of the kernels used by the Simd class
+@author  Tobias Blomberg / SM0SVX
+@date	 2026-10-14
+
+This is an internal header file that is included by each file building the
+kernels for an instruction set.
+
+\verbatim
+Async - A library for programming event driven applications
+Copyright (C) 2003-2026 Tobias Blomberg / SM0SVX
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+\endverbatim
+*/
+
+#ifndef ASYNC_SIMD_KERNELS_INCLUDED
+#define ASYNC_SIMD_KERNELS_INCLUDED
+
+
+/****************************************************************************
+ *
+ * System Includes
+ *
+ ****************************************************************************/
+
+#include <stdint.h>
+#include <cstddef>
+#include <cstring>
+#include <algorithm>
+
+
+/****************************************************************************
+ *
+ * Project Includes
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Local Includes
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Forward declarations
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Namespace
+ *
+ ****************************************************************************/
+
+namespace Async
+{
+
+
+/****************************************************************************
+ *
+ * Forward declarations of classes inside of the declared namespace
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Defines & typedefs
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Exported Global Variables
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Class definitions
+ *
+ ****************************************************************************/
+
+namespace SimdKernels
+{
+
+  // The kernels must be inlined into the functions built for each instruction
+  // set to be compiled using that instruction set
+#if defined(__GNUC__)
+#define ASYNC_SIMD_INLINE inline __attribute__((always_inline))
+#else
+#define ASYNC_SIMD_INLINE inline
+#endif
+
+  // The GCC vector extensions are used to write the kernels in a portable
+  // way. The compiler map the operations to whatever SIMD instructions are
+  // enabled for the function being compiled. If not supported by the
+  // compiler, plain scalar code is used.
+#if defined(__GNUC__)
+#define ASYNC_SIMD_VECTOR_EXT
+typedef float   VecFloat __attribute__((vector_size(32)));
+typedef int32_t VecInt   __attribute__((vector_size(32)));
+typedef int16_t VecS16   __attribute__((vector_size(16)));
+static const size_t VEC_LEN = sizeof(VecFloat) / sizeof(float);
+#endif
+
+/**
+ * @brief The kernels built for one instruction set
+ */
+struct Table
+{
+  float (*dotProduct)(const float *a, const float *b, size_t cnt);
+  void (*complexMac)(float *acc, const float *a, const float *b, size_t cnt);
+  void (*complexMultiply)(float *dst, const float *a, const float *b,
+                          size_t cnt);
+  void (*multiply)(float *dst, const float *a, const float *b, size_t cnt);
+  void (*add)(float *dst, const float *src, size_t cnt);
+  void (*s16ToFloat)(float *dst, const int16_t *src, size_t cnt);
+  void (*floatToS16)(int16_t *dst, const float *src, size_t cnt);
+};
+
+/**
+ * @brief   Get the NEON kernels
+ * @return  Returns the kernels or 0 if not built for NEON
+ */
+const Table *neonTable(void);
+
+#ifdef ASYNC_SIMD_VECTOR_EXT
+  // Load and store using possibly unaligned addresses. Returning the vector
+  // by value would trigger ABI warnings on x86 so out parameters are used.
+template <typename V, typename T>
+ASYNC_SIMD_INLINE void loadVec(V& v, const T *ptr)
+{
+  memcpy(&v, ptr, sizeof(v));
+} /* loadVec */
+
+
+template <typename V, typename T>
+ASYNC_SIMD_INLINE void storeVec(T *ptr, const V& v)
+{
+  memcpy(ptr, &v, sizeof(v));
+} /* storeVec */
+
+
+ASYNC_SIMD_INLINE float sumVec(const VecFloat& v)
+{
+  float sum = 0.0f;
+  for (size_t i=0; i<VEC_LEN; ++i)
+  {
+    sum += v[i];
+  }
+  return sum;
+} /* sumVec */
+
+
+  // Swap the real and imaginary parts of interleaved complex samples
+ASYNC_SIMD_INLINE void swapPairs(VecFloat& dst, const VecFloat& v)
+{
+#if defined(__clang__)
+  dst = __builtin_shufflevector(v, v, 1, 0, 3, 2, 5, 4, 7, 6);
+#else
+  const VecInt idx = {1, 0, 3, 2, 5, 4, 7, 6};
+  dst = __builtin_shuffle(v, idx);
+#endif
+} /* swapPairs */
+
+
+  // Copy the real (odd=false) or imaginary part to both elements of each
+  // interleaved complex sample
+ASYNC_SIMD_INLINE void dupParts(VecFloat& dst, const VecFloat& v, bool odd)
+{
+#if defined(__clang__)
+  if (odd)
+  {
+    dst = __builtin_shufflevector(v, v, 1, 1, 3, 3, 5, 5, 7, 7);
+  }
+  else
+  {
+    dst = __builtin_shufflevector(v, v, 0, 0, 2, 2, 4, 4, 6, 6);
+  }
+#else
+  const VecInt even_idx = {0, 0, 2, 2, 4, 4, 6, 6};
+  const VecInt odd_idx = even_idx + 1;
+  dst = __builtin_shuffle(v, odd ? odd_idx : even_idx);
+#endif
+} /* dupParts */
+#endif
+
+
+ASYNC_SIMD_INLINE float dotProduct(const float *a, const float *b,
+                                   size_t cnt)
+{
+  size_t i = 0;
+  float sum = 0.0f;
+#ifdef ASYNC_SIMD_VECTOR_EXT
+    // Two accumulators are used to hide the latency of the additions
+  VecFloat acc0 = {0}, acc1 = {0};
+  for (; i+2*VEC_LEN<=cnt; i+=2*VEC_LEN)
+  {
+    VecFloat a0, a1, b0, b1;
+    loadVec(a0, a + i);
+    loadVec(b0, b + i);
+    loadVec(a1, a + i + VEC_LEN);
+    loadVec(b1, b + i + VEC_LEN);
+    acc0 += a0 * b0;
+    acc1 += a1 * b1;
+  }
+  sum = sumVec(acc0 + acc1);
+#endif
+  for (; i<cnt; ++i)
+  {
+    sum += a[i] * b[i];
+  }
+  return sum;
+} /* dotProduct */
+
+
+ASYNC_SIMD_INLINE void complexMac(float *acc, const float *a,
+                                  const float *b, size_t cnt)
+{
+  size_t i = 0;
+  float re = 0.0f;
+  float im = 0.0f;
+#ifdef ASYNC_SIMD_VECTOR_EXT
+    // Accumulate (ar*br, ai*bi) and (ar*bi, ai*br) for each sample and
+    // combine them into the real and imaginary parts at the end
+  VecFloat acc_rr = {0}, acc_ri = {0};
+  for (; 2*i+VEC_LEN<=2*cnt; i+=VEC_LEN/2)
+  {
+    VecFloat va, vb, vb_swapped;
+    loadVec(va, a + 2*i);
+    loadVec(vb, b + 2*i);
+    swapPairs(vb_swapped, vb);
+    acc_rr += va * vb;
+    acc_ri += va * vb_swapped;
+  }
+  for (size_t k=0; k<VEC_LEN; k+=2)
+  {
+    re += acc_rr[k] - acc_rr[k+1];
+    im += acc_ri[k] + acc_ri[k+1];
+  }
+#endif
+  for (; i<cnt; ++i)
+  {
+    re += a[2*i] * b[2*i] - a[2*i+1] * b[2*i+1];
+    im += a[2*i] * b[2*i+1] + a[2*i+1] * b[2*i];
+  }
+  acc[0] += re;
+  acc[1] += im;
+} /* complexMac */
+
+
+ASYNC_SIMD_INLINE void complexMultiply(float *dst, const float *a,
+                                       const float *b, size_t cnt)
+{
+  size_t i = 0;
+#ifdef ASYNC_SIMD_VECTOR_EXT
+  const VecFloat sign = {-1.0f, 1.0f, -1.0f, 1.0f, -1.0f, 1.0f, -1.0f, 1.0f};
+  for (; 2*i+VEC_LEN<=2*cnt; i+=VEC_LEN/2)
+  {
+    VecFloat va, vb, a_re, a_im, vb_swapped;
+    loadVec(va, a + 2*i);
+    loadVec(vb, b + 2*i);
+    dupParts(a_re, va, false);
+    dupParts(a_im, va, true);
+    swapPairs(vb_swapped, vb);
+    const VecFloat res = a_re * vb + sign * a_im * vb_swapped;
+    storeVec(dst + 2*i, res);
+  }
+#endif
+  for (; i<cnt; ++i)
+  {
+    const float re = a[2*i] * b[2*i] - a[2*i+1] * b[2*i+1];
+    const float im = a[2*i] * b[2*i+1] + a[2*i+1] * b[2*i];
+    dst[2*i] = re;
+    dst[2*i+1] = im;
+  }
+} /* complexMultiply */
+
+
+ASYNC_SIMD_INLINE void multiply(float *dst, const float *a, const float *b,
+                                size_t cnt)
+{
+  size_t i = 0;
+#ifdef ASYNC_SIMD_VECTOR_EXT
+  for (; i+VEC_LEN<=cnt; i+=VEC_LEN)
+  {
+    VecFloat va, vb;
+    loadVec(va, a + i);
+    loadVec(vb, b + i);
+    const VecFloat res = va * vb;
+    storeVec(dst + i, res);
+  }
+#endif
+  for (; i<cnt; ++i)
+  {
+    dst[i] = a[i] * b[i];
+  }
+} /* multiply */
+
+
+ASYNC_SIMD_INLINE void add(float *dst, const float *src, size_t cnt)
+{
+  size_t i = 0;
+#ifdef ASYNC_SIMD_VECTOR_EXT
+  for (; i+VEC_LEN<=cnt; i+=VEC_LEN)
+  {
+    VecFloat vd, vs;
+    loadVec(vd, dst + i);
+    loadVec(vs, src + i);
+    vd += vs;
+    storeVec(dst + i, vd);
+  }
+#endif
+  for (; i<cnt; ++i)
+  {
+    dst[i] += src[i];
+  }
+} /* add */
+
+
+ASYNC_SIMD_INLINE void s16ToFloat(float *dst, const int16_t *src, size_t cnt)
+{
+  size_t i = 0;
+#ifdef ASYNC_SIMD_VECTOR_EXT
+  for (; i+VEC_LEN<=cnt; i+=VEC_LEN)
+  {
+    VecS16 v;
+    loadVec(v, src + i);
+    const VecFloat res = __builtin_convertvector(v, VecFloat) *
+                         (1.0f / 32768.0f);
+    storeVec(dst + i, res);
+  }
+#endif
+  for (; i<cnt; ++i)
+  {
+    dst[i] = static_cast<float>(src[i]) * (1.0f / 32768.0f);
+  }
+} /* s16ToFloat */
+
+
+ASYNC_SIMD_INLINE void floatToS16(int16_t *dst, const float *src, size_t cnt)
+{
+  size_t i = 0;
+#ifdef ASYNC_SIMD_VECTOR_EXT
+  const VecFloat hi = VecFloat{} + 32767.0f;
+  const VecFloat lo = -hi;
+  for (; i+VEC_LEN<=cnt; i+=VEC_LEN)
+  {
+    VecFloat v;
+    loadVec(v, src + i);
+    v *= 32767.0f;
+    v = (v > hi) ? hi : v;
+    v = (v < lo) ? lo : v;
+    const VecS16 res = __builtin_convertvector(v, VecS16);
+    storeVec(dst + i, res);
+  }
+#endif
+  for (; i<cnt; ++i)
+  {
+    const float sample = src[i] * 32767.0f;
+    dst[i] = static_cast<int16_t>(
+        std::min(32767.0f, std::max(-32767.0f, sample)));
+  }
+} /* floatToS16 */
+
+} /* namespace SimdKernels */
+
+
+  // Build the kernels into a table for the instruction set ISA. The ATTR
+  // argument give the function attributes used to enable the instruction set.
+#define ASYNC_SIMD_KERNEL_TABLE(ISA, ATTR) \
+  namespace ISA \
+  { \
+    ATTR float dotProduct(const float *a, const float *b, size_t cnt) \
+    { \
+      return SimdKernels::dotProduct(a, b, cnt); \
+    } \
+    ATTR void complexMac(float *acc, const float *a, const float *b, \
+                         size_t cnt) \
+    { \
+      SimdKernels::complexMac(acc, a, b, cnt); \
+    } \
+    ATTR void complexMultiply(float *dst, const float *a, const float *b, \
+                              size_t cnt) \
+    { \
+      SimdKernels::complexMultiply(dst, a, b, cnt); \
+    } \
+    ATTR void multiply(float *dst, const float *a, const float *b, \
+                       size_t cnt) \
+    { \
+      SimdKernels::multiply(dst, a, b, cnt); \
+    } \
+    ATTR void add(float *dst, const float *src, size_t cnt) \
+    { \
+      SimdKernels::add(dst, src, cnt); \
+    } \
+    ATTR void s16ToFloat(float *dst, const int16_t *src, size_t cnt) \
+    { \
+      SimdKernels::s16ToFloat(dst, src, cnt); \
+    } \
+    ATTR void floatToS16(int16_t *dst, const float *src, size_t cnt) \
+    { \
+      SimdKernels::floatToS16(dst, src, cnt); \
+    } \
+    const SimdKernels::Table table = \
+    { \
+      dotProduct, complexMac, complexMultiply, multiply, add, s16ToFloat, \
+      floatToS16 \
+    }; \
+  }
+
+
+} /* namespace */
+
+#endif /* ASYNC_SIMD_KERNELS_INCLUDED */
+
+
+
+/*
+ * This file has not been truncated
+ */
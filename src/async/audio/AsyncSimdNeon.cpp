@@ -0,0 +1,138 @@
+/**
+@file	 AsyncSimdNeon.cpp
+@brief   The NEON versions of the SIMD kernels
+@author  Tobias Blomberg / SM0SVX
+@date	 2026-10-14
+
+\verbatim
+Async - A library for programming event driven applications
+Copyright (C) 2003-2026 Tobias Blomberg / SM0SVX
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+\endverbatim
+*/
+
+
+
+/****************************************************************************
+ *
+ * System Includes
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Project Includes
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Local Includes
+ *
+ ****************************************************************************/
+
+#include "AsyncSimdKernels.h"
+
+
+
+/****************************************************************************
+ *
+ * Namespaces to use
+ *
+ ****************************************************************************/
+
+using namespace Async;
+
+
+
+/****************************************************************************
+ *
+ * Defines & typedefs
+ *
+ ****************************************************************************/
+
+  // This file is built with NEON enabled on 32 bit ARM, where it is not part
+  // of the base instruction set. The kernels are then only used if the CPU
+  // support NEON. On 64 bit ARM, NEON is always available.
+#if defined(ASYNC_SIMD_VECTOR_EXT) && \
+    (defined(__ARM_NEON) || defined(__ARM_NEON__))
+#define ASYNC_SIMD_NEON
+#endif
+
+
+
+/****************************************************************************
+ *
+ * Local class definitions
+ *
+ ****************************************************************************/
+
+#ifdef ASYNC_SIMD_NEON
+namespace {
+  ASYNC_SIMD_KERNEL_TABLE(neon, )
+};
+#endif
+
+
+
+/****************************************************************************
+ *
+ * Prototypes
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Exported Global Variables
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Local Global Variables
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Public functions
+ *
+ ****************************************************************************/
+
+const SimdKernels::Table *SimdKernels::neonTable(void)
+{
+#ifdef ASYNC_SIMD_NEON
+  return &neon::table;
+#else
+  return 0;
+#endif
+} /* SimdKernels::neonTable */
+
+
+
+/*
+ * This file has not been truncated
+ */
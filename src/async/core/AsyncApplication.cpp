@@ -9,7 +9,7 @@ application that use the Async classes.
 
 \verbatim
 Async - A library for programming event driven applications
-Copyright (C) 2003-2015 Tobias Blomberg
+Copyright (C) 2003-2026 Tobias Blomberg
 
 This program is free software; you can redistribute it and/or modify
 it under the terms of the GNU General Public License as published by
@@ -38,9 +38,24 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 #include <sys/types.h>
 #include <sys/select.h>
 #include <stdlib.h>
+#include <signal.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <time.h>
+#ifdef HAS_BACKTRACE
+#include <execinfo.h>
+#endif
 
 #include <cassert>
+#include <cerrno>
 #include <algorithm>
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+#include <iostream>
+#include <sstream>
 
 
 /****************************************************************************
@@ -88,6 +103,104 @@ using namespace Async;
  *
  ****************************************************************************/
 
+class Application::Watchdog
+{
+  public:
+    static const int SIGNUM = SIGURG;
+
+    std::atomic<uint64_t> busy_since  {0};
+    std::atomic<uint64_t> iteration   {0};
+
+    Watchdog(unsigned threshold_ms)
+      : m_threshold_us(1000 * uint64_t(threshold_ms)),
+        m_main_thread(pthread_self())
+    {
+#ifdef HAS_BACKTRACE
+        // The first call to backtrace may allocate memory when loading the
+        // unwinder so make that call here instead of in the signal handler
+      void* frames[1];
+      backtrace(frames, 1);
+#endif
+      struct sigaction act;
+      act.sa_handler = signalHandler;
+      sigemptyset(&act.sa_mask);
+      act.sa_flags = SA_RESTART;
+      sigaction(SIGNUM, &act, &m_old_act);
+      m_thread = std::thread(&Watchdog::run, this);
+    }
+
+    ~Watchdog(void)
+    {
+      {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stop = true;
+      }
+      m_cond.notify_one();
+      m_thread.join();
+      sigaction(SIGNUM, &m_old_act, nullptr);
+    }
+
+  private:
+    static std::atomic<bool> backtrace_requested;
+
+    const uint64_t          m_threshold_us;
+    const pthread_t         m_main_thread;
+    struct sigaction        m_old_act;
+    std::thread             m_thread;
+    std::mutex              m_mutex;
+    std::condition_variable m_cond;
+    bool                    m_stop        {false};
+
+    static void signalHandler(int signum)
+    {
+      if (!backtrace_requested.exchange(false))
+      {
+        return;
+      }
+#ifdef HAS_BACKTRACE
+      const int saved_errno = errno;
+      void* frames[64];
+      int cnt = backtrace(frames, 64);
+      backtrace_symbols_fd(frames, cnt, STDERR_FILENO);
+      errno = saved_errno;
+#endif
+    }
+
+    void run(void)
+    {
+      const auto interval = std::chrono::microseconds(
+          std::max(m_threshold_us / 4, uint64_t(1000)));
+      uint64_t reported = 0;
+      std::unique_lock<std::mutex> lock(m_mutex);
+      while (!m_stop)
+      {
+        m_cond.wait_for(lock, interval);
+        const uint64_t since = busy_since.load(std::memory_order_acquire);
+        const uint64_t iter = iteration.load(std::memory_order_acquire);
+        if (m_stop || (since == 0) || (iter == reported))
+        {
+          continue;
+        }
+        const uint64_t now = Application::monotonicUs();
+        if ((now > since) && (now - since >= m_threshold_us))
+        {
+          reported = iter;
+          std::ostringstream ss;
+          ss << "*** WARNING: The event loop has been busy for "
+             << (now - since) / 1000 << " ms";
+#ifdef HAS_BACKTRACE
+          ss << ". Backtrace of the main thread:";
+#endif
+          std::cerr << ss.str() << std::endl;
+#ifdef HAS_BACKTRACE
+          backtrace_requested = true;
+          pthread_kill(m_main_thread, SIGNUM);
+#endif
+        }
+      }
+    }
+};  /* class Application::Watchdog */
+
 
 
 /****************************************************************************
@@ -105,6 +218,8 @@ using namespace Async;
  ****************************************************************************/
 
 Application *Application::app_ptr = 0;
+Application::ObjectCounts Application::object_counts;
+std::atomic<bool> Application::Watchdog::backtrace_requested(false);
 
 
 /****************************************************************************
@@ -142,6 +257,8 @@ Application &Application::app(void)
  *------------------------------------------------------------------------
  */
 Application::Application(void)
+  : busy_start_us(0), busy_valid(false), watchdog_threshold(0),
+    watchdog(0), wakeup_audit(false)
 {
   assert(app_ptr == 0);
   app_ptr = this;  
@@ -153,6 +270,8 @@ Application::Application(void)
 
 Application::~Application(void)
 {
+  delete watchdog;
+  watchdog = 0;
   delete task_timer;
   task_timer = 0;
 } /* Application::~Application */
@@ -165,6 +284,94 @@ void Application::runTask(sigc::slot<void()> task)
 } /* Application::runTask */
 
 
+std::vector<Application::SlowCallback> Application::slowCallbacks(void) const
+{
+  std::vector<SlowCallback> callbacks;
+  for (const auto& entry : slow_callbacks)
+  {
+    std::ostringstream ss;
+    switch (entry.type)
+    {
+      case CALLBACK_FD_RD:
+        ss << "FdWatch fd=" << entry.id << " read";
+        break;
+      case CALLBACK_FD_WR:
+        ss << "FdWatch fd=" << entry.id << " write";
+        break;
+      case CALLBACK_FD_PRI:
+        ss << "FdWatch fd=" << entry.id << " priority";
+        break;
+      case CALLBACK_TIMER:
+        ss << "Timer " << entry.obj << " timeout=" << entry.id << "ms";
+        break;
+    }
+    callbacks.push_back({ss.str(), entry.count, entry.max_us,
+                         entry.total_us});
+  }
+  std::sort(callbacks.begin(), callbacks.end(),
+      [](const SlowCallback& a, const SlowCallback& b)
+      {
+        return a.max_us > b.max_us;
+      });
+  return callbacks;
+} /* Application::slowCallbacks */
+
+
+void Application::setLoopWatchdog(unsigned threshold_ms)
+{
+  delete watchdog;
+  watchdog = 0;
+  watchdog_threshold = threshold_ms;
+  if (threshold_ms > 0)
+  {
+    watchdog = new Watchdog(threshold_ms);
+  }
+} /* Application::setLoopWatchdog */
+
+
+void Application::setWakeupAudit(bool enable)
+{
+  wakeup_audit = enable;
+  if (!enable)
+  {
+    wakeup_sources.clear();
+  }
+} /* Application::setWakeupAudit */
+
+
+std::vector<Application::WakeupSource> Application::wakeupSources(void) const
+{
+  std::vector<WakeupSource> sources;
+  for (const auto& entry : wakeup_sources)
+  {
+    std::ostringstream ss;
+    switch (entry.type)
+    {
+      case CALLBACK_FD_RD:
+        ss << "FdWatch fd=" << entry.id << " read";
+        break;
+      case CALLBACK_FD_WR:
+        ss << "FdWatch fd=" << entry.id << " write";
+        break;
+      case CALLBACK_FD_PRI:
+        ss << "FdWatch fd=" << entry.id << " priority";
+        break;
+      case CALLBACK_TIMER:
+        ss << "Timer " << ((entry.name != 0) ? entry.name : "<unnamed>")
+           << " timeout=" << entry.id << "ms";
+        break;
+    }
+    sources.push_back({ss.str(), entry.count});
+  }
+  std::sort(sources.begin(), sources.end(),
+      [](const WakeupSource& a, const WakeupSource& b)
+      {
+        return a.count > b.count;
+      });
+  return sources;
+} /* Application::wakeupSources */
+
+
 
 /****************************************************************************
  *
@@ -179,6 +386,127 @@ void Application::clearTasks(void)
 } /* Application::clearTasks */
 
 
+void Application::loopBusyBegin(uint64_t now_us)
+{
+  busy_start_us = now_us;
+  busy_valid = true;
+  if (watchdog != 0)
+  {
+    watchdog->iteration.store(loop_stats.iterations + 1,
+                              std::memory_order_release);
+    watchdog->busy_since.store(now_us, std::memory_order_release);
+  }
+} /* Application::loopBusyBegin */
+
+
+void Application::loopBusyEnd(uint64_t now_us)
+{
+  if (!busy_valid)
+  {
+    return;
+  }
+  busy_valid = false;
+  if (watchdog != 0)
+  {
+    watchdog->busy_since.store(0, std::memory_order_release);
+  }
+  if (now_us >= busy_start_us)
+  {
+    const uint64_t busy_us = now_us - busy_start_us;
+    loop_stats.busy_us += busy_us;
+    loop_stats.busy_us_hist[LoopStats::bucket(busy_us)] += 1;
+  }
+  ++loop_stats.iterations;
+} /* Application::loopBusyEnd */
+
+
+Application::CallbackType Application::fdCallbackType(const FdWatch* watch)
+{
+  switch (watch->type())
+  {
+    case FdWatch::FD_WATCH_WR:
+      return CALLBACK_FD_WR;
+    case FdWatch::FD_WATCH_PRI:
+      return CALLBACK_FD_PRI;
+    default:
+      return CALLBACK_FD_RD;
+  }
+} /* Application::fdCallbackType */
+
+
+void Application::callbackDone(CallbackType type, const void* obj, int id,
+                               uint64_t start_us)
+{
+  const uint64_t now_us = monotonicUs();
+  if ((now_us < start_us) || (now_us - start_us < SLOW_CALLBACK_US))
+  {
+    return;
+  }
+  const uint64_t dur_us = now_us - start_us;
+
+    // File descriptors are identified by number since the watch objects
+    // often are recreated for the same file descriptor
+  if (type != CALLBACK_TIMER)
+  {
+    obj = 0;
+  }
+  SlowCallbackEntry* entry = 0;
+  SlowCallbackEntry* min_entry = 0;
+  for (auto& e : slow_callbacks)
+  {
+    if ((e.type == type) && (e.obj == obj) && (e.id == id))
+    {
+      entry = &e;
+      break;
+    }
+    if ((min_entry == 0) || (e.max_us < min_entry->max_us))
+    {
+      min_entry = &e;
+    }
+  }
+  if (entry == 0)
+  {
+    if (slow_callbacks.size() < SLOW_CALLBACK_CNT)
+    {
+      slow_callbacks.push_back({type, obj, id, 0, 0, 0});
+      entry = &slow_callbacks.back();
+    }
+    else if (dur_us > min_entry->max_us)
+    {
+      *min_entry = {type, obj, id, 0, 0, 0};
+      entry = min_entry;
+    }
+    else
+    {
+      return;
+    }
+  }
+  entry->count += 1;
+  entry->total_us += dur_us;
+  entry->max_us = std::max(entry->max_us, dur_us);
+} /* Application::callbackDone */
+
+
+uint64_t Application::monotonicUs(void)
+{
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return uint64_t(now.tv_sec) * 1000000 + now.tv_nsec / 1000;
+} /* Application::monotonicUs */
+
+
+void* Application::timerBackendData(const Timer* timer)
+{
+  return timer->m_backend_data;
+} /* Application::timerBackendData */
+
+
+void Application::setTimerBackendData(Timer* timer, void* data)
+{
+  timer->m_backend_data = data;
+} /* Application::setTimerBackendData */
+
+
 /****************************************************************************
  *
  * Private member functions
@@ -196,6 +524,24 @@ void Application::taskTimerExpired(void)
 } /* Application::taskTimerExpired */
 
 
+void Application::countWakeupSource(CallbackType type, const char* name,
+                                    int id)
+{
+    // Timers are identified by name and timeout rather than by object
+    // since many timers are recreated over and over again. The list is
+    // usually short so a linear search is fast enough.
+  for (auto& entry : wakeup_sources)
+  {
+    if ((entry.type == type) && (entry.name == name) && (entry.id == id))
+    {
+      entry.count += 1;
+      return;
+    }
+  }
+  wakeup_sources.push_back({type, name, id, 1});
+} /* Application::countWakeupSource */
+
+
 
 /*
  * This file has not been truncated
@@ -9,7 +9,7 @@ application that use the Async classes.
 
 \verbatim
 Async - A library for programming event driven applications
-Copyright (C) 2003-2022 Tobias Blomberg
+Copyright (C) 2003-2026 Tobias Blomberg
 
 This program is free software; you can redistribute it and/or modify
 it under the terms of the GNU General Public License as published by
@@ -40,6 +40,8 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 #include <sigc++/sigc++.h>
 
 #include <string>
+#include <vector>
+#include <cstdint>
 
 
 /****************************************************************************
@@ -119,6 +121,83 @@ class DnsLookupWorker;
 class Application : public sigc::trackable
 {
   public:
+    /**
+     * @brief Event loop statistics
+     *
+     * The histograms have one bucket for each power of two. Bucket i count
+     * the values that are less than 2^i and the last bucket count the rest.
+     * The busy time is the time spent handling timers and file descriptor
+     * events in one iteration of the main loop. The timer lag is how late a
+     * timer was when its expiration handler was called.
+     */
+    struct LoopStats
+    {
+      static const unsigned HIST_BUCKETS = 20;
+
+      uint64_t iterations                     {0};
+      uint64_t busy_us                        {0};
+      uint64_t busy_us_hist[HIST_BUCKETS]     {};
+      uint64_t timer_expirations              {0};
+      uint64_t timer_lag_ms                   {0};
+      uint64_t timer_lag_ms_hist[HIST_BUCKETS] {};
+
+      static unsigned bucket(uint64_t value)
+      {
+        unsigned idx = 0;
+        while ((value > 0) && (idx < HIST_BUCKETS-1))
+        {
+          value >>= 1;
+          ++idx;
+        }
+        return idx;
+      }
+    };
+
+    /**
+     * @brief Statistics for a callback that has been slow
+     */
+    struct SlowCallback
+    {
+      std::string source;   ///< A description of the callback source
+      uint64_t    count;    ///< The number of slow calls
+      uint64_t    max_us;   ///< The longest call in microseconds
+      uint64_t    total_us; ///< The total time of the slow calls
+    };
+
+    /**
+     * @brief Information about what woke the event loop up
+     */
+    struct WakeupSource
+    {
+      std::string source;   ///< A description of the wakeup source
+      uint64_t    count;    ///< The number of callbacks from this source
+    };
+
+    /**
+     * @brief The number of timer and file descriptor watch objects
+     *
+     * The counters are updated by the Timer and FdWatch classes themselves
+     * so they are valid even before the application object is created. A
+     * steadily growing number of objects is a sign of a leak.
+     */
+    struct ObjectCounts
+    {
+      size_t timers               {0};  ///< Existing timers
+      size_t enabled_timers       {0};  ///< Enabled timers
+      size_t fd_watches           {0};  ///< Existing file descriptor watches
+      size_t enabled_fd_watches   {0};  ///< Enabled file descriptor watches
+    };
+
+    /**
+     * @brief Callbacks taking at least this long are counted as slow
+     */
+    static const unsigned SLOW_CALLBACK_US  = 1000;
+
+    /**
+     * @brief The number of slow callback sources to keep track of
+     */
+    static const unsigned SLOW_CALLBACK_CNT = 10;
+
     /**
      * @brief 	Get the one and only application instance
      *
@@ -177,9 +256,168 @@ class Application : public sigc::trackable
      * and the second is an integer.
      */
     void runTask(sigc::slot<void()> task);
+
+    /**
+     * @brief   Get the event loop statistics
+     * @return  Returns the statistics collected since the loop was started
+     *
+     * Not all statistics are available for all application types.
+     */
+    const LoopStats& loopStats(void) const { return loop_stats; }
+
+    /**
+     * @brief   Get the number of timer and file descriptor watch objects
+     * @return  Returns the number of existing and enabled objects
+     */
+    static const ObjectCounts& objectCounts(void) { return object_counts; }
+
+    /**
+     * @brief   Get the slowest callbacks
+     * @return  Returns the slowest callbacks, the slowest first
+     *
+     * The time used by each file descriptor and timer callback is only
+     * measured when the loop watchdog is enabled.
+     */
+    std::vector<SlowCallback> slowCallbacks(void) const;
+
+    /**
+     * @brief   Enable the event loop watchdog
+     * @param   threshold_ms The longest allowed loop iteration, 0 to disable
+     *
+     * When the watchdog is enabled, a thread check that no single iteration
+     * of the event loop take longer than the given threshold. If it does, a
+     * warning is printed together with a backtrace of the main thread, where
+     * supported, showing what it is busy with. Enabling the watchdog also
+     * enable the measurement of the time used by each callback, which is
+     * available using the slowCallbacks function.
+     * This function must be called from the thread running the event loop.
+     */
+    void setLoopWatchdog(unsigned threshold_ms);
+
+    /**
+     * @brief   Get the event loop watchdog threshold
+     * @return  Returns the threshold in milliseconds, 0 if disabled
+     */
+    unsigned loopWatchdog(void) const { return watchdog_threshold; }
+
+    /**
+     * @brief   Enable counting of what wake the event loop up
+     * @param   enable Set to \em true to enable the wakeup audit
+     *
+     * When enabled, each timer expiration and file descriptor callback is
+     * counted per source. Timers are identified by their name, if set using
+     * Timer::setName, and timeout. File descriptors are identified by number.
+     * This is useful to find out what prevent a system from going idle.
+     * Disabling the audit clear the collected counters.
+     */
+    void setWakeupAudit(bool enable);
+
+    /**
+     * @brief   Check if the wakeup audit is enabled
+     * @return  Returns \em true if wakeups are counted
+     */
+    bool wakeupAudit(void) const { return wakeup_audit; }
+
+    /**
+     * @brief   Get the wakeup sources counted so far
+     * @return  Returns the wakeup sources, the most frequent first
+     */
+    std::vector<WakeupSource> wakeupSources(void) const;
+
+    /**
+     * @brief   Clear the wakeup source counters
+     */
+    void clearWakeupSources(void) { wakeup_sources.clear(); }
     
   protected:
+    typedef enum
+    {
+      CALLBACK_FD_RD, CALLBACK_FD_WR, CALLBACK_FD_PRI, CALLBACK_TIMER
+    } CallbackType;
+
     void clearTasks(void);
+
+    /**
+     * @brief   To be called by the event loop when it wake up
+     * @param   now_us The current monotonic time in microseconds
+     */
+    void loopBusyBegin(uint64_t now_us);
+
+    /**
+     * @brief   To be called by the event loop before waiting for events
+     * @param   now_us The current monotonic time in microseconds
+     */
+    void loopBusyEnd(uint64_t now_us);
+
+    /**
+     * @brief   To be called by the event loop when a timer expire
+     * @param   lag_ms How late the timer expired in milliseconds
+     */
+    void timerExpiredLate(uint64_t lag_ms)
+    {
+      ++loop_stats.timer_expirations;
+      loop_stats.timer_lag_ms += lag_ms;
+      loop_stats.timer_lag_ms_hist[LoopStats::bucket(lag_ms)] += 1;
+    }
+
+    /**
+     * @brief   Check if the time used by each callback should be measured
+     */
+    bool callbackTimingEnabled(void) const { return watchdog_threshold > 0; }
+
+    /**
+     * @brief   To be called by the event loop when a callback has returned
+     * @param   type      The type of callback
+     * @param   obj       The timer or watch object, only used as an id
+     * @param   id        The file descriptor or timer timeout
+     * @param   start_us  The monotonic time when the callback was called
+     */
+    void callbackDone(CallbackType type, const void* obj, int id,
+                      uint64_t start_us);
+
+    /**
+     * @brief   Get the callback type to use for a file descriptor watch
+     * @param   watch The watch object
+     * @return  Returns the callback type matching the type of the watch
+     */
+    static CallbackType fdCallbackType(const FdWatch* watch);
+
+    /**
+     * @brief   To be called by the event loop before calling a callback
+     * @param   type  The type of callback
+     * @param   name  The name of the timer, may be 0
+     * @param   id    The file descriptor or timer timeout
+     */
+    void countWakeup(CallbackType type, const char* name, int id)
+    {
+      if (wakeup_audit)
+      {
+        countWakeupSource(type, name, id);
+      }
+    }
+
+    /**
+     * @brief   Get the current monotonic time
+     * @return  Returns the time in microseconds
+     */
+    static uint64_t monotonicUs(void);
+
+    /**
+     * @brief   Get the backend data stored in a timer
+     * @param   timer The timer
+     * @return  Returns the data set by setTimerBackendData, or 0 if not set
+     */
+    static void* timerBackendData(const Timer* timer);
+
+    /**
+     * @brief   Store backend data in a timer
+     * @param   timer The timer
+     * @param   data  The data to store, owned by the backend
+     *
+     * An application backend may use this to associate its own data with
+     * each enabled timer without keeping a separate lookup table.
+     */
+    static void setTimerBackendData(Timer* timer, void* data);
     
   private:
     friend class FdWatch;
@@ -187,13 +425,40 @@ class Application : public sigc::trackable
     friend class DnsLookup;
     
     typedef std::list<sigc::slot<void()>> SlotList;
+    struct SlowCallbackEntry
+    {
+      CallbackType  type;
+      const void*   obj;
+      int           id;
+      uint64_t      count;
+      uint64_t      max_us;
+      uint64_t      total_us;
+    };
+    struct WakeupEntry
+    {
+      CallbackType  type;
+      const char*   name;
+      int           id;
+      uint64_t      count;
+    };
+    class Watchdog;
 
     static Application *app_ptr;
+    static ObjectCounts object_counts;
     
-    SlotList task_list;
-    Timer    *task_timer;
+    SlotList                        task_list;
+    Timer                           *task_timer;
+    LoopStats                       loop_stats;
+    uint64_t                        busy_start_us;
+    bool                            busy_valid;
+    unsigned                        watchdog_threshold;
+    Watchdog*                       watchdog;
+    std::vector<SlowCallbackEntry>  slow_callbacks;
+    bool                            wakeup_audit;
+    std::vector<WakeupEntry>        wakeup_sources;
 
     void taskTimerExpired(void);
+    void countWakeupSource(CallbackType type, const char* name, int id);
     virtual void addFdWatch(FdWatch *fd_watch) = 0;
     virtual void delFdWatch(FdWatch *fd_watch) = 0;
     virtual void addTimer(Timer *timer) = 0;
@@ -151,19 +151,13 @@ bool Config::open(const string& name)
 bool Config::getValue(const std::string& section, const std::string& tag,
                       std::string& value, bool missing_ok) const
 {
-  Sections::const_iterator sec_it = sections.find(section);
-  if (sec_it == sections.end())
+  const Value* v = findValue(section, tag);
+  if (v == nullptr)
   {
     return missing_ok;
   }
 
-  Values::const_iterator val_it = sec_it->second.find(tag);
-  if (val_it == sec_it->second.end())
-  {
-    return missing_ok;
-  }
-
-  value = val_it->second.val;
+  value = v->val;
   return true;
 } /* Config::getValue */
 
@@ -171,24 +165,18 @@ bool Config::getValue(const std::string& section, const std::string& tag,
 bool Config::getValue(const std::string& section, const std::string& tag,
                       char& value, bool missing_ok) const
 {
-  Sections::const_iterator sec_it = sections.find(section);
-  if (sec_it == sections.end())
-  {
-    return missing_ok;
-  }
-
-  Values::const_iterator val_it = sec_it->second.find(tag);
-  if (val_it == sec_it->second.end())
+  const Value* v = findValue(section, tag);
+  if (v == nullptr)
   {
     return missing_ok;
   }
 
-  if (val_it->second.val.size() != 1)
+  if (v->val.size() != 1)
   {
     return false;
   }
 
-  value = val_it->second.val[0];
+  value = v->val[0];
   return true;
 } /* Config::getValue */
 
@@ -197,19 +185,13 @@ const string &Config::getValue(const string& section, const string& tag) const
 {
   static const string empty_strng;
   
-  Sections::const_iterator sec_it = sections.find(section);
-  if (sec_it == sections.end())
+  const Value* v = findValue(section, tag);
+  if (v == nullptr)
   {
     return empty_strng;
   }
 
-  Values::const_iterator val_it = sec_it->second.find(tag);
-  if (val_it == sec_it->second.end())
-  {
-    return empty_strng;
-  }
-
-  return val_it->second.val;
+  return v->val;
 } /* Config::getValue */
 
 
@@ -220,6 +202,9 @@ list<string> Config::listSections(void)
   {
     section_list.push_back((*it).first);
   }
+    // The sections are stored in a hash table so sort the names to give the
+    // same order as before
+  section_list.sort();
   return section_list;
 } /* Config::listSections */
 
@@ -239,6 +224,7 @@ list<string> Config::listSection(const string& section)
   {
     tags.push_back(it->first);
   }
+  tags.sort();
   
   return tags;
   
@@ -248,12 +234,13 @@ list<string> Config::listSection(const string& section)
 void Config::setValue(const std::string& section, const std::string& tag,
                       const std::string& value)
 {
-  Values &values = sections[section];
-  if (value != values[tag].val)
+  Value& v = sections[section][tag];
+  if (value != v.val)
   {
-    values[tag].val = value;
+    v.val = value;
+    v.cache.clear();
     valueUpdated(section, tag);
-    for (const auto& func : values[tag].subs)
+    for (const auto& func : v.subs)
     {
       func(value);
     }
@@ -261,6 +248,41 @@ void Config::setValue(const std::string& section, const std::string& tag,
 } /* Config::setValue */
 
 
+size_t Config::loadSnapshot(const Config& other)
+{
+  std::vector<std::pair<std::string, std::string>> changed;
+  for (const auto& other_sec : other.sections)
+  {
+    Values& values = sections[other_sec.first];
+    values.reserve(other_sec.second.size());
+    for (const auto& other_val : other_sec.second)
+    {
+      Value& v = values[other_val.first];
+      if (v.val != other_val.second.val)
+      {
+        v.val = other_val.second.val;
+        v.cache.clear();
+        changed.emplace_back(other_sec.first, other_val.first);
+      }
+    }
+  }
+
+    // Notify after all values have been updated so that subscribers see the
+    // complete new configuration
+  for (const auto& sec_tag : changed)
+  {
+    const Value& v = sections[sec_tag.first][sec_tag.second];
+    valueUpdated(sec_tag.first, sec_tag.second);
+    for (const auto& func : v.subs)
+    {
+      func(v.val);
+    }
+  }
+
+  return changed.size();
+} /* Config::loadSnapshot */
+
+
 /****************************************************************************
  *
  * Protected member functions
@@ -292,6 +314,25 @@ void Config::setValue(const std::string& section, const std::string& tag,
  *
  ****************************************************************************/
 
+const Config::Value* Config::findValue(const std::string& section,
+                                       const std::string& tag) const
+{
+  Sections::const_iterator sec_it = sections.find(section);
+  if (sec_it == sections.end())
+  {
+    return nullptr;
+  }
+
+  Values::const_iterator val_it = sec_it->second.find(tag);
+  if (val_it == sec_it->second.end())
+  {
+    return nullptr;
+  }
+
+  return &val_it->second;
+} /* Config::findValue */
+
+
 
 /*
  *----------------------------------------------------------------------------
@@ -365,9 +406,9 @@ bool Config::parseCfgFile(FILE *file)
 	}
 	assert(!current_sec.empty());
 	
-	Values &values = sections[current_sec];
-	string& value = values[current_tag].val;
-	value += val;
+	Value& v = sections[current_sec][current_tag];
+	v.val += val;
+	v.cache.clear();
 	break;
       }
       
@@ -388,9 +429,10 @@ bool Config::parseCfgFile(FILE *file)
 	      	  "section on line " << line_no << endl;
 	  return false;
 	}
-	Values &values = sections[current_sec];
 	current_tag = tag;
-	values[current_tag].val = value;
+	Value& v = sections[current_sec][current_tag];
+	v.val = value;
+	v.cache.clear();
       	break;
       }
     }
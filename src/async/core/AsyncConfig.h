@@ -50,8 +50,10 @@ An example of how to use the Config class
 
 #include <string>
 #include <map>
+#include <unordered_map>
 #include <list>
 #include <memory>
+#include <typeindex>
 #include <sstream>
 #include <locale>
 #include <vector>
@@ -134,6 +136,12 @@ is shown below.
 \include test.cfg
 
 \include AsyncConfig_demo.cpp
+
+The configuration variables are stored in hash tables so looking up a
+variable is fast even in sections with thousands of variables. Values read
+using one of the template getValue functions are parsed once and the parsed
+value is cached until the variable is changed, so configuration variables can
+be read in frequently executed code paths without much overhead.
 */
 class Config
 {
@@ -228,23 +236,17 @@ class Config
     bool getValue(const std::string& section, const std::string& tag,
 		  Rsp &rsp, bool missing_ok = false) const
     {
-      std::string str_val;
-      if (!getValue(section, tag, str_val))
+      const Value* v = findValue(section, tag);
+      if (v == nullptr)
       {
 	return missing_ok;
       }
-      std::stringstream ssval(str_val);
-      Rsp tmp;
-      ssval >> tmp;
-      if(!ssval.eof())
-      {
-        ssval >> std::ws;
-      }
-      if (ssval.fail() || !ssval.eof())
+      const Rsp* val = cachedValue<Rsp>(*v, parseScalar<Rsp>);
+      if (val == nullptr)
       {
 	return false;
       }
-      rsp = tmp;
+      rsp = *val;
       return true;
     } /* Config::getValue */
 
@@ -269,37 +271,48 @@ class Config
      * still returns \em false if an illegal value is specified.
      */
     template <template <typename, typename> class Container,
-              typename Value>
+              typename Elem>
     bool getValue(const std::string& section, const std::string& tag,
-		  Container<Value, std::allocator<Value> > &c,
+		  Container<Elem, std::allocator<Elem> > &c,
                   bool missing_ok = false) const
     {
-      std::string str_val;
-      if (!getValue(section, tag, str_val))
+      typedef Container<Elem, std::allocator<Elem> > C;
+      const Value* v = findValue(section, tag);
+      if (v == nullptr)
       {
 	return missing_ok;
       }
-      if (str_val.empty())
+      if (v->val.empty())
       {
         c.clear();
         return true;
       }
-      std::stringstream ssval(str_val);
-      ssval.imbue(std::locale(ssval.getloc(), new csv_whitespace));
-      while (!ssval.eof())
+      const C* val = cachedValue<C>(*v,
+          [](const std::string& str_val, C& parsed) -> bool
+          {
+            std::stringstream ssval(str_val);
+            ssval.imbue(std::locale(ssval.getloc(), new csv_whitespace));
+            while (!ssval.eof())
+            {
+              Elem tmp;
+              ssval >> tmp;
+              if(!ssval.eof())
+              {
+                ssval >> std::ws;
+              }
+              if (ssval.fail())
+              {
+                return false;
+              }
+              parsed.push_back(tmp);
+            }
+            return true;
+          });
+      if (val == nullptr)
       {
-        Value tmp;
-        ssval >> tmp;
-        if(!ssval.eof())
-        {
-          ssval >> std::ws;
-        }
-        if (ssval.fail())
-        {
-          return false;
-        }
-        c.push_back(tmp);
+        return false;
       }
+      c.insert(c.end(), val->begin(), val->end());
       return true;
     } /* Config::getValue */
 
@@ -330,32 +343,43 @@ class Config
                   Container<Key, std::less<Key>, std::allocator<Key> > &c,
                   bool missing_ok = false) const
     {
-      std::string str_val;
-      if (!getValue(section, tag, str_val))
+      typedef Container<Key, std::less<Key>, std::allocator<Key> > C;
+      const Value* v = findValue(section, tag);
+      if (v == nullptr)
       {
         return missing_ok;
       }
-      if (str_val.empty())
+      if (v->val.empty())
       {
         c.clear();
         return true;
       }
-      std::stringstream ssval(str_val);
-      ssval.imbue(std::locale(ssval.getloc(), new csv_whitespace));
-      while (!ssval.eof())
+      const C* val = cachedValue<C>(*v,
+          [](const std::string& str_val, C& parsed) -> bool
+          {
+            std::stringstream ssval(str_val);
+            ssval.imbue(std::locale(ssval.getloc(), new csv_whitespace));
+            while (!ssval.eof())
+            {
+              Key tmp;
+              ssval >> tmp;
+              if(!ssval.eof())
+              {
+                ssval >> std::ws;
+              }
+              if (ssval.fail())
+              {
+                return false;
+              }
+              parsed.insert(tmp);
+            }
+            return true;
+          });
+      if (val == nullptr)
       {
-        Key tmp;
-        ssval >> tmp;
-        if(!ssval.eof())
-        {
-          ssval >> std::ws;
-        }
-        if (ssval.fail())
-        {
-          return false;
-        }
-        c.insert(tmp);
+        return false;
       }
+      c.insert(val->begin(), val->end());
       return true;
     } /* Config::getValue */
 
@@ -456,23 +480,17 @@ class Config
 		  const Rsp& min, const Rsp& max, Rsp &rsp,
 		  bool missing_ok = false) const
     {
-      std::string str_val;
-      if (!getValue(section, tag, str_val))
+      const Value* v = findValue(section, tag);
+      if (v == nullptr)
       {
 	return missing_ok;
       }
-      std::stringstream ssval(str_val);
-      Rsp tmp;
-      ssval >> tmp;
-      if(!ssval.eof())
-      {
-        ssval >> std::ws;
-      }
-      if (ssval.fail() || !ssval.eof() || (tmp < min) || (tmp > max))
+      const Rsp* val = cachedValue<Rsp>(*v, parseScalar<Rsp>);
+      if ((val == nullptr) || (*val < min) || (*val > max))
       {
 	return false;
       }
-      rsp = tmp;
+      rsp = *val;
       return true;
     } /* Config::getValue */
 
@@ -616,6 +634,21 @@ class Config
     void setValue(const std::string& section, const std::string& tag,
       	      	  const std::string& value);
 
+    /**
+     * @brief   Load the values from another configuration object
+     * @param   other The configuration object to load values from
+     * @return  Returns the number of configuration variables that changed
+     *
+     * This function is used to load a snapshot of configuration variables,
+     * e.g. a reread configuration file, into this object in one go. All
+     * values are updated before any notifications are sent so a subscriber
+     * will see the complete new configuration when it is notified. Only
+     * variables that actually change are notified and cached parsed values
+     * are only thrown away for those. Variables that only exist in this
+     * object are left untouched.
+     */
+    size_t loadSnapshot(const Config& other);
+
     /**
      * @brief   Set the value of a configuration variable (generic type)
      * @param   section   The name of the section where the configuration
@@ -693,13 +726,19 @@ class Config
 
   private:
     using Subscriber = std::function<void(const std::string&)>;
+    struct CachedValue
+    {
+      std::type_index         type;
+      std::shared_ptr<void>   val;
+    };
     struct Value
     {
-      std::string             val;
-      std::vector<Subscriber> subs;
+      std::string                       val;
+      std::vector<Subscriber>           subs;
+      mutable std::vector<CachedValue>  cache;
     };
-    typedef std::map<std::string, Value>  Values;
-    typedef std::map<std::string, Values> Sections;
+    typedef std::unordered_map<std::string, Value>  Values;
+    typedef std::unordered_map<std::string, Values> Sections;
 
       // Really wanted to use classic_table() but it returns nullptr on Alpine
     static const std::ctype<char>::mask* empty_table()
@@ -739,6 +778,43 @@ class Config
     char *parseValue(char *value);
     char *translateEscapedChars(char *val);
 
+    const Value* findValue(const std::string& section,
+                           const std::string& tag) const;
+
+    template <typename T>
+    static bool parseScalar(const std::string& str_val, T& val)
+    {
+      std::stringstream ssval(str_val);
+      ssval >> val;
+      if(!ssval.eof())
+      {
+        ssval >> std::ws;
+      }
+      return !ssval.fail() && ssval.eof();
+    }
+
+      // Return the value parsed into type T, parsing and caching it if it
+      // is not already in the cache. A parse failure is not cached.
+    template <typename T, typename Parser>
+    static const T* cachedValue(const Value& v, Parser parse)
+    {
+      const std::type_index type(typeid(T));
+      for (const auto& cached : v.cache)
+      {
+        if (cached.type == type)
+        {
+          return static_cast<const T*>(cached.val.get());
+        }
+      }
+      auto parsed = std::make_shared<T>();
+      if (!parse(v.val, *parsed))
+      {
+        return nullptr;
+      }
+      v.cache.push_back({type, parsed});
+      return parsed.get();
+    }
+
     template <class T>
     bool setValueFromString(T& val, const std::string &str) const
     {
@@ -6,7 +6,7 @@
 
 \verbatim
 Async - A library for programming event driven applications
-Copyright (C) 2003-2023 Tobias Blomberg / SM0SVX
+Copyright (C) 2003-2026 Tobias Blomberg / SM0SVX
 
 This program is free software; you can redistribute it and/or modify
 it under the terms of the GNU General Public License as published by
@@ -32,6 +32,9 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 
 #include <openssl/rand.h>
 #include <openssl/err.h>
+#if defined(__linux__) && (defined(__aarch64__) || defined(__arm__))
+#include <sys/auxv.h>
+#endif
 
 #include <cassert>
 #include <cstring>
@@ -70,6 +73,13 @@ using namespace Async;
  *
  ****************************************************************************/
 
+#if defined(__aarch64__) && !defined(HWCAP_AES)
+#define HWCAP_AES (1 << 3)
+#endif
+#if defined(__arm__) && !defined(HWCAP2_AES)
+#define HWCAP2_AES (1 << 0)
+#endif
+
 
 
 /****************************************************************************
@@ -131,6 +141,21 @@ const std::string EncryptedUdpSocket::cipherName(
 } /* EncryptedUdpSocket::cipherName */
 
 
+bool EncryptedUdpSocket::hasAesHardware(void)
+{
+#if defined(__x86_64__) || defined(__i386__)
+  __builtin_cpu_init();
+  return __builtin_cpu_supports("aes");
+#elif defined(__linux__) && defined(__aarch64__)
+  return (getauxval(AT_HWCAP) & HWCAP_AES) != 0;
+#elif defined(__linux__) && defined(__arm__)
+  return (getauxval(AT_HWCAP2) & HWCAP2_AES) != 0;
+#else
+  return true;
+#endif
+} /* EncryptedUdpSocket::hasAesHardware */
+
+
 bool EncryptedUdpSocket::randomBytes(std::vector<uint8_t>& bytes)
 {
   if (bytes.size() == 0)
@@ -141,18 +166,98 @@ bool EncryptedUdpSocket::randomBytes(std::vector<uint8_t>& bytes)
 } /* EncryptedUdpSocket::randomBytes */
 
 
+bool EncryptedUdpSocket::encrypt(EVP_CIPHER_CTX* ctx,
+                                 const std::vector<uint8_t>& key,
+                                 const std::vector<uint8_t>& iv,
+                                 size_t taglen,
+                                 const void *aad, int aadlen,
+                                 const void *buf, int cnt,
+                                 uint8_t* outbuf, int& totoutlen)
+{
+  assert(ctx != nullptr);
+  assert((aad == nullptr) == (aadlen <= 0));
+
+  auto inbuf = static_cast<const uint8_t*>(buf);
+  auto aadbuf = static_cast<const uint8_t*>(aad);
+
+  auto key_length = EVP_CIPHER_CTX_key_length(ctx);
+  //auto iv_length = EVP_CIPHER_CTX_iv_length(ctx);
+  //std::cout << "### key_length=" << key_length << std::endl;
+  //std::cout << "### iv_length=" << iv_length << std::endl;
+  if (key_length > 0)
+  {
+    //OPENSSL_assert(key_length == key.size());
+    //OPENSSL_assert(iv_length == iv.size());
+
+      // Set key and IV in the cipher context. Without a key, only the IV
+      // is set which avoid calculating the key schedule again.
+    EVP_EncryptInit_ex(ctx, NULL, NULL, key.empty() ? NULL : key.data(),
+                       iv.data());
+  }
+
+  //auto taglen = EVP_CIPHER_CTX_get_tag_length(ctx);
+  //std::cout << "### taglen=" << taglen << std::endl;
+
+  auto outbufp = outbuf;
+  int outlen = 0;
+  totoutlen = aadlen + taglen;
+  if (aadlen > 0)
+  {
+    std::memcpy(outbufp, aadbuf, aadlen);
+    if(!EVP_EncryptUpdate(ctx, nullptr, &outlen, aadbuf, aadlen))
+    {
+      std::cout << "### EVP_EncryptUpdate with AAD failed" << std::endl;
+      ERR_print_errors_fp(stderr);
+      return false;
+    }
+  }
+  outbufp += aadlen + taglen;
+
+  if(!EVP_EncryptUpdate(ctx, outbufp, &outlen, inbuf, cnt))
+  {
+    std::cout << "### EVP_EncryptUpdate failed" << std::endl;
+    return false;
+  }
+  outbufp += outlen;
+  totoutlen += outlen;
+
+  if(!EVP_EncryptFinal_ex(ctx, outbufp, &outlen))
+  {
+    std::cout << "### EVP_EncryptFinal failed" << std::endl;
+    return false;
+  }
+  totoutlen += outlen;
+
+  if (taglen > 0)
+  {
+    outbufp = outbuf + aadlen;
+    if (!EVP_CIPHER_CTX_ctrl(ctx, EVP_CTRL_AEAD_GET_TAG, taglen, outbufp))
+    {
+      std::cout << "### EVP_CIPHER_CTX_ctrl(EVP_CTRL_AEAD_GET_TAG) failed"
+                << std::endl;
+      return false;
+    }
+  }
+
+  //std::cout << "### EncryptedUdpSocket::encrypt: totoutlen=" << totoutlen
+  //          << " data=";
+  //std::copy(outbuf, outbuf+totoutlen,
+  //    std::ostream_iterator<int>(std::cout << std::hex, " "));
+  //std::cout << std::dec << std::endl;
+
+  return true;
+} /* EncryptedUdpSocket::encrypt */
+
+
 EncryptedUdpSocket::EncryptedUdpSocket(uint16_t local_port,
-    const IpAddress &bind_ip)
-  : UdpSocket(local_port, bind_ip)
+    const IpAddress &bind_ip, bool reuse_port)
+  : UdpSocket(local_port, bind_ip, reuse_port)
 {
-  m_cipher_ctx = EVP_CIPHER_CTX_new();
 } /* EncryptedUdpSocket::EncryptedUdpSocket */
 
 
 EncryptedUdpSocket::~EncryptedUdpSocket(void)
 {
-  EVP_CIPHER_CTX_free(m_cipher_ctx);
-  m_cipher_ctx = nullptr;
 } /* EncryptedUdpSocket::~EncryptedUdpSocket */
 
 
@@ -165,34 +270,16 @@ bool EncryptedUdpSocket::setCipher(const std::string& type)
 
 bool EncryptedUdpSocket::setCipher(const EncryptedUdpSocket::Cipher* cipher)
 {
-    // Clean up the context, free all memory except the context itself
-  if (!EVP_CIPHER_CTX_reset(m_cipher_ctx))
-  {
-    std::cout << "### EVP_CIPHER_CTX_reset failed" << std::endl;
-    return false;
-  }
-
-  if (cipher == nullptr)
-  {
-    return true;
-  }
-
-    // Set cipher type in the cipher context
-  if (!EVP_EncryptInit_ex(m_cipher_ctx, cipher, NULL, NULL, NULL) ||
-      !EVP_DecryptInit_ex(m_cipher_ctx, cipher, NULL, NULL, NULL))
-  {
-    std::cout << "### EVP_EncryptInit_ex failed" << std::endl;
-    return false;
-  }
-
+    // The cipher contexts are set up lazily by the context cache
+  m_cipher = cipher;
   return true;
 } /* EncryptedUdpSocket::setCipher */
 
 
-bool EncryptedUdpSocket::setCipherIV(std::vector<uint8_t> iv)
+bool EncryptedUdpSocket::setCipherIV(const std::vector<uint8_t>& iv)
 {
   m_cipher_iv = iv;
-  size_t iv_length = EVP_CIPHER_CTX_iv_length(m_cipher_ctx);
+  size_t iv_length = (m_cipher != nullptr) ? EVP_CIPHER_iv_length(m_cipher) : 0;
   //std::cout << "### EncryptedUdpSocket::setCipherIV: iv_length="
   //          << iv_length << " iv.size()=" << iv.size() << std::endl;
   return (iv.size() == iv_length);
@@ -205,19 +292,21 @@ const std::vector<uint8_t> EncryptedUdpSocket::cipherIV(void) const
 } /* EncryptedUdpSocket::cipherIV */
 
 
-bool EncryptedUdpSocket::setCipherKey(std::vector<uint8_t> key)
+bool EncryptedUdpSocket::setCipherKey(const std::vector<uint8_t>& key)
 {
   //std::cout << "### EncryptedUdpSocket::setCipherKey: key.size()="
   //          << key.size() << std::endl;
   m_cipher_key = key;
-  size_t key_length = EVP_CIPHER_CTX_key_length(m_cipher_ctx);
+  size_t key_length =
+    (m_cipher != nullptr) ? EVP_CIPHER_key_length(m_cipher) : 0;
   return (key.size() == key_length);
 } /* EncryptedUdpSocket::setCipherKey */
 
 
 bool EncryptedUdpSocket::setCipherKey(void)
 {
-  std::vector<uint8_t> cipher_key(EVP_CIPHER_CTX_key_length(m_cipher_ctx));
+  std::vector<uint8_t> cipher_key(
+      (m_cipher != nullptr) ? EVP_CIPHER_key_length(m_cipher) : 0);
   //std::cout << "### EncryptedUdpSocket::setCipherKey: cipher_key.size()="
   //          << cipher_key.size() << std::endl;
   if (!randomBytes(cipher_key))
@@ -252,79 +341,22 @@ bool EncryptedUdpSocket::write(const IpAddress& remote_ip, int remote_port,
   //    std::ostream_iterator<int>(std::cout << std::hex, " "));
   //std::cout << std::dec << std::endl;
 
-  assert(m_cipher_ctx != nullptr);
-  assert((aad == nullptr) == (aadlen <= 0));
-
-  auto inbuf = static_cast<const uint8_t*>(buf);
-  auto aadbuf = static_cast<const uint8_t*>(aad);
-
-  auto key_length = EVP_CIPHER_CTX_key_length(m_cipher_ctx);
-  //auto iv_length = EVP_CIPHER_CTX_iv_length(m_cipher_ctx);
-  //std::cout << "### key_length=" << key_length << std::endl;
-  //std::cout << "### iv_length=" << iv_length << std::endl;
-  if (key_length > 0)
+  static const std::vector<uint8_t> cached_key;
+  auto ctx = m_ctx_cache.encryptContext(m_cipher, m_cipher_key);
+  if (ctx == nullptr)
   {
-    //OPENSSL_assert(key_length == m_cipher_key.size());
-    //OPENSSL_assert(iv_length == m_cipher_iv.size());
-
-      // Set key and IV in the cipher context
-    EVP_EncryptInit_ex(m_cipher_ctx, NULL, NULL, m_cipher_key.data(),
-                       m_cipher_iv.data());
+    return false;
   }
 
-  //auto taglen = EVP_CIPHER_CTX_get_tag_length(m_cipher_ctx);
-  //std::cout << "### taglen=" << m_taglen << std::endl;
-
     // Allow enough space in output buffer for AAD, tag, encrypted plaintext
     // and one additional block
-  uint8_t outbuf[aadlen + m_taglen + cnt + EVP_MAX_BLOCK_LENGTH];
-  auto outbufp = outbuf;
-  int outlen = 0;
-  int totoutlen = aadlen + m_taglen;
-  if (aadlen > 0)
-  {
-    std::memcpy(outbufp, aadbuf, aadlen);
-    if(!EVP_EncryptUpdate(m_cipher_ctx, nullptr, &outlen, aadbuf, aadlen))
-    {
-      std::cout << "### EVP_EncryptUpdate with AAD failed" << std::endl;
-      ERR_print_errors_fp(stderr);
-      return false;
-    }
-  }
-  outbufp += aadlen + m_taglen;
-
-  if(!EVP_EncryptUpdate(m_cipher_ctx, outbufp, &outlen, inbuf, cnt))
-  {
-    std::cout << "### EVP_EncryptUpdate failed" << std::endl;
-    return false;
-  }
-  outbufp += outlen;
-  totoutlen += outlen;
-
-  if(!EVP_EncryptFinal_ex(m_cipher_ctx, outbufp, &outlen))
+  uint8_t outbuf[cipherTextMaxSize(aadlen, m_taglen, cnt)];
+  int totoutlen = 0;
+  if (!encrypt(ctx, cached_key, m_cipher_iv, m_taglen,
+               aad, aadlen, buf, cnt, outbuf, totoutlen))
   {
-    std::cout << "### EVP_EncryptFinal failed" << std::endl;
     return false;
   }
-  totoutlen += outlen;
-
-  if (m_taglen > 0)
-  {
-    outbufp = outbuf + aadlen;
-    if (!EVP_CIPHER_CTX_ctrl(m_cipher_ctx, EVP_CTRL_AEAD_GET_TAG,
-          m_taglen, outbufp))
-    {
-      std::cout << "### EVP_CIPHER_CTX_ctrl(EVP_CTRL_AEAD_GET_TAG) failed"
-                << std::endl;
-      return false;
-    }
-  }
-
-  //std::cout << "### EncryptedUdpSocket::write: totoutlen=" << totoutlen
-  //          << " data=";
-  //std::copy(outbuf, outbuf+totoutlen,
-  //    std::ostream_iterator<int>(std::cout << std::hex, " "));
-  //std::cout << std::dec << std::endl;
 
   return UdpSocket::write(remote_ip, remote_port, outbuf, totoutlen);
 
@@ -345,7 +377,11 @@ void EncryptedUdpSocket::onDataReceived(const IpAddress& ip, uint16_t port,
     return;
   }
 
-  assert(m_cipher_ctx != nullptr);
+  auto ctx = m_ctx_cache.decryptContext(m_cipher, m_cipher_key);
+  if (ctx == nullptr)
+  {
+    return;
+  }
   //std::cout << "### EncryptedUdpSocket::onDataReceived: count="
   //          << count << " iv=";
   //std::copy(m_cipher_iv.begin(), m_cipher_iv.end(),
@@ -357,8 +393,8 @@ void EncryptedUdpSocket::onDataReceived(const IpAddress& ip, uint16_t port,
   /* Allow enough space in output buffer for additional block */
   unsigned char outbuf[count + EVP_MAX_BLOCK_LENGTH];
 
-  auto key_length = EVP_CIPHER_CTX_key_length(m_cipher_ctx);
-  //auto iv_length = EVP_CIPHER_CTX_iv_length(m_cipher_ctx);
+  auto key_length = EVP_CIPHER_CTX_key_length(ctx);
+  //auto iv_length = EVP_CIPHER_CTX_iv_length(ctx);
   //std::cout << "### key_length=" << key_length << std::endl;
   //std::cout << "### iv_length=" << iv_length << std::endl;
   if (key_length > 0)
@@ -366,9 +402,9 @@ void EncryptedUdpSocket::onDataReceived(const IpAddress& ip, uint16_t port,
     //OPENSSL_assert(key_length == m_cipher_key.size());
     //OPENSSL_assert(iv_length == m_cipher_iv.size());
 
-      // Set key and IV in the cipher context
-    EVP_DecryptInit_ex(m_cipher_ctx, NULL, NULL, m_cipher_key.data(),
-                      m_cipher_iv.data());
+      // The key is already set up in the cached context so only the IV
+      // need to be set
+    EVP_DecryptInit_ex(ctx, NULL, NULL, NULL, m_cipher_iv.data());
   }
 
   int outlen = 0;
@@ -381,7 +417,7 @@ void EncryptedUdpSocket::onDataReceived(const IpAddress& ip, uint16_t port,
                 << " m_aadlen=" << m_aadlen << std::endl;
       return;
     }
-    if(!EVP_DecryptUpdate(m_cipher_ctx, nullptr, &outlen, inbuf, m_aadlen))
+    if(!EVP_DecryptUpdate(ctx, nullptr, &outlen, inbuf, m_aadlen))
     {
       std::cout << "### : EVP_DecryptUpdate AAD failed" << std::endl;
       return;
@@ -392,7 +428,7 @@ void EncryptedUdpSocket::onDataReceived(const IpAddress& ip, uint16_t port,
     count -= m_aadlen;
   }
 
-  //auto taglen = EVP_CIPHER_CTX_get_tag_length(m_cipher_ctx);
+  //auto taglen = EVP_CIPHER_CTX_get_tag_length(ctx);
   //std::cout << "### taglen=" << m_taglen << std::endl;
   if (m_taglen > 0)
   {
@@ -403,7 +439,7 @@ void EncryptedUdpSocket::onDataReceived(const IpAddress& ip, uint16_t port,
       return;
     }
     if (!EVP_CIPHER_CTX_ctrl(
-          m_cipher_ctx, EVP_CTRL_AEAD_SET_TAG, m_taglen, inbuf))
+          ctx, EVP_CTRL_AEAD_SET_TAG, m_taglen, inbuf))
     {
       std::cout << "### EVP_CIPHER_CTX_ctrl(EVP_CTRL_AEAD_SET_TAG) failed"
                 << std::endl;
@@ -413,14 +449,14 @@ void EncryptedUdpSocket::onDataReceived(const IpAddress& ip, uint16_t port,
     count -= m_taglen;
   }
 
-  if(!EVP_DecryptUpdate(m_cipher_ctx, outbuf, &outlen, inbuf, count))
+  if(!EVP_DecryptUpdate(ctx, outbuf, &outlen, inbuf, count))
   {
     std::cout << "### EVP_DecryptUpdate failed" << std::endl;
     return;
   }
 
   int totoutlen = outlen;
-  if(!EVP_DecryptFinal_ex(m_cipher_ctx, outbuf+outlen, &outlen))
+  if(!EVP_DecryptFinal_ex(ctx, outbuf+outlen, &outlen))
   {
     std::cout << "### EVP_DecryptFinal_ex failed" << std::endl;
     return;
@@ -440,6 +476,74 @@ void EncryptedUdpSocket::onDataReceived(const IpAddress& ip, uint16_t port,
  *
  ****************************************************************************/
 
+void EncryptedUdpSocket::ContextCache::erase(const std::vector<uint8_t>& key)
+{
+  auto it = m_entries.begin();
+  while (it != m_entries.end())
+  {
+    if (it->first.matches(key))
+    {
+      EVP_CIPHER_CTX_free(it->second.enc);
+      EVP_CIPHER_CTX_free(it->second.dec);
+      it = m_entries.erase(it);
+    }
+    else
+    {
+      ++it;
+    }
+  }
+} /* EncryptedUdpSocket::ContextCache::erase */
+
+
+void EncryptedUdpSocket::ContextCache::clear(void)
+{
+  for (auto& entry : m_entries)
+  {
+    EVP_CIPHER_CTX_free(entry.second.enc);
+    EVP_CIPHER_CTX_free(entry.second.dec);
+  }
+  m_entries.clear();
+} /* EncryptedUdpSocket::ContextCache::clear */
+
+
+EVP_CIPHER_CTX* EncryptedUdpSocket::ContextCache::context(
+    const Cipher* cipher, const std::vector<uint8_t>& key, bool enc)
+{
+  if ((cipher == nullptr) || (key.size() > EVP_MAX_KEY_LENGTH) ||
+      (key.size() != static_cast<size_t>(EVP_CIPHER_key_length(cipher))))
+  {
+    return nullptr;
+  }
+
+  Key cache_key(cipher, key);
+  auto it = m_entries.find(cache_key);
+  if (it == m_entries.end())
+  {
+    if (m_entries.size() >= m_max_size)
+    {
+      clear();
+    }
+    it = m_entries.emplace(std::move(cache_key), Entry()).first;
+  }
+
+  EVP_CIPHER_CTX*& ctx = enc ? it->second.enc : it->second.dec;
+  if (ctx == nullptr)
+  {
+    ctx = EVP_CIPHER_CTX_new();
+    const unsigned char* keyp = key.empty() ? NULL : key.data();
+    if ((ctx == nullptr) ||
+        (enc ? !EVP_EncryptInit_ex(ctx, cipher, NULL, keyp, NULL)
+             : !EVP_DecryptInit_ex(ctx, cipher, NULL, keyp, NULL)))
+    {
+      std::cout << "### EVP_CipherInit_ex failed" << std::endl;
+      EVP_CIPHER_CTX_free(ctx);
+      ctx = nullptr;
+    }
+  }
+  return ctx;
+} /* EncryptedUdpSocket::ContextCache::context */
+
+
 
 
 /*
@@ -6,7 +6,7 @@
 
 \verbatim
 Async - A library for programming event driven applications
-Copyright (C) 2003-2023 Tobias Blomberg / SM0SVX
+Copyright (C) 2003-2026 Tobias Blomberg / SM0SVX
 
 This program is free software; you can redistribute it and/or modify
 it under the terms of the GNU General Public License as published by
@@ -39,6 +39,9 @@ An example of how to use the Async::EncryptedUdpSocket class
  ****************************************************************************/
 
 #include <openssl/evp.h>
+#include <algorithm>
+#include <functional>
+#include <map>
 #include <vector>
 
 
@@ -123,6 +126,124 @@ class EncryptedUdpSocket : public UdpSocket
   public:
     using Cipher = EVP_CIPHER;
 
+    /**
+     * @brief   A cache of cipher contexts with the key already set up
+     *
+     * Setting up the key of a cipher context is costly since the key schedule
+     * is calculated. This class keep one encryption and one decryption
+     * context for each combination of cipher and key so that only the IV has
+     * to be set up for each datagram. When the cache is full, it is cleared
+     * and filled up again. An object must only be used by one thread at a
+     * time.
+     */
+    class ContextCache
+    {
+      public:
+        /**
+         * @brief   Constructor
+         * @param   max_size The maximum number of cached keys
+         */
+        explicit ContextCache(size_t max_size=1024) : m_max_size(max_size) {}
+
+        /**
+         * @brief   Destructor
+         */
+        ~ContextCache(void) { clear(); }
+
+        ContextCache(const ContextCache&) = delete;
+        ContextCache& operator=(const ContextCache&) = delete;
+
+        /**
+         * @brief   Set the maximum number of cached keys
+         * @param   max_size The maximum number of keys
+         */
+        void setMaxSize(size_t max_size) { m_max_size = max_size; }
+
+        /**
+         * @brief   Get a context set up for encryption
+         * @param   cipher  The cipher to use
+         * @param   key     The cipher key
+         * @return  Returns a context or \em nullptr on failure
+         *
+         * The returned context is owned by the cache. It is valid until the
+         * key is erased or the cache is cleared.
+         */
+        EVP_CIPHER_CTX* encryptContext(const Cipher* cipher,
+                                       const std::vector<uint8_t>& key)
+        {
+          return context(cipher, key, true);
+        }
+
+        /**
+         * @brief   Get a context set up for decryption
+         * @param   cipher  The cipher to use
+         * @param   key     The cipher key
+         * @return  Returns a context or \em nullptr on failure
+         */
+        EVP_CIPHER_CTX* decryptContext(const Cipher* cipher,
+                                       const std::vector<uint8_t>& key)
+        {
+          return context(cipher, key, false);
+        }
+
+        /**
+         * @brief   Remove the contexts for a key
+         * @param   key The key to forget
+         */
+        void erase(const std::vector<uint8_t>& key);
+
+        /**
+         * @brief   Remove all contexts
+         */
+        void clear(void);
+
+        /**
+         * @brief   Get the number of cached keys
+         * @return  Returns the number of cached keys
+         */
+        size_t size(void) const { return m_entries.size(); }
+
+      private:
+        struct Entry
+        {
+          EVP_CIPHER_CTX* enc = nullptr;
+          EVP_CIPHER_CTX* dec = nullptr;
+        };
+          // A fixed size key so that a lookup does not allocate memory
+        struct Key
+        {
+          const Cipher* cipher;
+          size_t        len;
+          uint8_t       bytes[EVP_MAX_KEY_LENGTH];
+
+          Key(const Cipher* cipher, const std::vector<uint8_t>& key)
+            : cipher(cipher), len(key.size())
+          {
+            std::copy(key.begin(), key.end(), bytes);
+          }
+          bool matches(const std::vector<uint8_t>& key) const
+          {
+            return (key.size() == len) &&
+                   std::equal(key.begin(), key.end(), bytes);
+          }
+          bool operator<(const Key& other) const
+          {
+            if (cipher != other.cipher)
+            {
+              return std::less<const Cipher*>()(cipher, other.cipher);
+            }
+            return std::lexicographical_compare(bytes, bytes + len,
+                other.bytes, other.bytes + other.len);
+          }
+        };
+
+        std::map<Key, Entry>  m_entries;
+        size_t                m_max_size;
+
+        EVP_CIPHER_CTX* context(const Cipher* cipher,
+                                const std::vector<uint8_t>& key, bool enc);
+    };
+
     /**
      * @brief   Fetch a named cipher object
      * @param   name The name of the cipher
@@ -148,6 +269,17 @@ class EncryptedUdpSocket : public UdpSocket
      */
     static const std::string cipherName(const Cipher* cipher);
 
+    /**
+     * @brief   Find out if the CPU have instructions for AES
+     * @return  Returns \em true if AES is accelerated in hardware
+     *
+     * AES-GCM is very fast on CPUs with AES instructions, like x86 CPUs with
+     * AES-NI and ARMv8 CPUs with the crypto extensions. On CPUs without them,
+     * e.g. the ARM cores in most Raspberry Pi models, ChaCha20-Poly1305 is
+     * a lot faster.
+     */
+    static bool hasAesHardware(void);
+
     /**
      * @brief   Fill a vector with random bytes
      * @param   bytes The vector to fill
@@ -161,13 +293,55 @@ class EncryptedUdpSocket : public UdpSocket
      */
     static bool randomBytes(std::vector<uint8_t>& bytes);
 
+    /**
+     * @brief   Get the maximum size of an encrypted datagram
+     * @param   aadlen  The length of the associated data
+     * @param   taglen  The length of the AEAD tag
+     * @param   cnt     The length of the plaintext
+     * @return  Returns the size of the buffer needed by the encrypt function
+     */
+    static size_t cipherTextMaxSize(size_t aadlen, size_t taglen, size_t cnt)
+    {
+      return aadlen + taglen + cnt + EVP_MAX_BLOCK_LENGTH;
+    }
+
+    /**
+     * @brief   Encrypt a datagram using the given cipher context
+     * @param   ctx     A cipher context set up with the cipher to use
+     * @param   key     The cipher key
+     * @param   iv      The initialization vector
+     * @param   taglen  The length of the AEAD tag
+     * @param   aad     Prepended unencrypted data
+     * @param   aadlen  The length of the associated data
+     * @param   buf     The plaintext to encrypt
+     * @param   cnt     The length of the plaintext
+     * @param   outbuf  The output buffer, see cipherTextMaxSize
+     * @param   outlen  Set to the length of the encrypted datagram
+     * @return  Returns \em true on success
+     *
+     * This is the function used by the write function to produce the datagram
+     * that is sent on the network. It does not use any state in the socket
+     * object so it may be called from other threads, as long as each thread
+     * uses its own cipher context. If the key is empty, the key already set
+     * up in the context is used, e.g. for a context from a ContextCache, and
+     * only the IV is set.
+     */
+    static bool encrypt(EVP_CIPHER_CTX* ctx,
+                        const std::vector<uint8_t>& key,
+                        const std::vector<uint8_t>& iv,
+                        size_t taglen,
+                        const void *aad, int aadlen,
+                        const void *buf, int cnt,
+                        uint8_t* outbuf, int& outlen);
+
     /**
      * @brief   Constructor
      * @param   local_port  The local UDP port to bind to, 0=ephemeral
      * @param   bind_ip     The local interface (IP) to bind to
+     * @param   reuse_port  Allow other sockets to bind to the same port
      */
     EncryptedUdpSocket(uint16_t local_port=0,
-        const IpAddress &bind_ip=IpAddress());
+        const IpAddress &bind_ip=IpAddress(), bool reuse_port=false);
 
     /**
      * @brief   Disallow copy construction
@@ -192,10 +366,7 @@ class EncryptedUdpSocket : public UdpSocket
      * This function should always be called after constructing the object to
      * see if everything went fine.
      */
-    bool initOk(void) const override
-    {
-      return UdpSocket::initOk() && (m_cipher_ctx != nullptr);
-    }
+    bool initOk(void) const override { return UdpSocket::initOk(); }
 
     /**
      * @brief   Set which cipher algorithm type to use
@@ -204,7 +375,9 @@ class EncryptedUdpSocket : public UdpSocket
      *
      * This function must be called before sending or receiving any datagrams.
      * Use this function to set which block cipher algorithm to use, e.g.
-     * AES-128-GCM, ChaCha20, NULL.
+     * AES-128-GCM, ChaCha20, NULL. The cipher may be changed between
+     * datagrams, e.g. when a server use different ciphers for different
+     * clients. The contexts for earlier used ciphers are kept in the cache.
      */
     bool setCipher(const std::string& type);
 
@@ -228,7 +401,7 @@ class EncryptedUdpSocket : public UdpSocket
      * the requirements for a specific cipher for constructing a safe IV.
      * The setCipher function must be called before calling this function.
      */
-    bool setCipherIV(std::vector<uint8_t> iv);
+    bool setCipherIV(const std::vector<uint8_t>& iv);
 
     /**
      * @brief   Get a previously set initialization vector (IV)
@@ -246,7 +419,7 @@ class EncryptedUdpSocket : public UdpSocket
      * for a specific cipher for constructing a key. The setCipher function
      * must be called before calling this function.
      */
-    bool setCipherKey(std::vector<uint8_t> key);
+    bool setCipherKey(const std::vector<uint8_t>& key);
 
     /**
      * @brief   Set a random cipher key to use
@@ -265,6 +438,29 @@ class EncryptedUdpSocket : public UdpSocket
      */
     const std::vector<uint8_t> cipherKey(void) const;
 
+    /**
+     * @brief   Forget a cipher key that is not used any more
+     * @param   key The key to forget
+     *
+     * The cipher contexts for each key that has been used are cached so that
+     * the key schedule need not be calculated for each datagram. Call this
+     * function when a key is not going to be used again, e.g. when a client
+     * disconnects, to free the memory.
+     */
+    void forgetCipherKey(const std::vector<uint8_t>& key)
+    {
+      m_ctx_cache.erase(key);
+    }
+
+    /**
+     * @brief   Set the maximum number of cipher keys to cache contexts for
+     * @param   max_size The maximum number of keys
+     */
+    void setContextCacheSize(size_t max_size)
+    {
+      m_ctx_cache.setMaxSize(max_size);
+    }
+
     /**
      * @brief   Set the length of the AEAD tag
      * @param   taglen The length of the tag in bytes
@@ -350,7 +546,8 @@ class EncryptedUdpSocket : public UdpSocket
         int count) override;
 
   private:
-    EVP_CIPHER_CTX*       m_cipher_ctx  = nullptr;
+    const Cipher*         m_cipher      = nullptr;
+    ContextCache          m_ctx_cache;
     std::vector<uint8_t>  m_cipher_iv;
     std::vector<uint8_t>  m_cipher_key;
     size_t                m_taglen      = 0;
@@ -39,6 +39,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 #include <sys/wait.h>
 #include <sys/resource.h>
 #include <sys/types.h>
+#include <spawn.h>
 
 #include <cstring>
 #include <cassert>
@@ -54,6 +55,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
  ****************************************************************************/
 
 #include <AsyncTimer.h>
+#include <AsyncApplication.h>
 
 
 /****************************************************************************
@@ -99,6 +101,22 @@ using namespace Async;
  *
  ****************************************************************************/
 
+extern char **environ;
+
+namespace {
+  void closePipe(int filedes[2])
+  {
+    for (int i=0; i<2; ++i)
+    {
+      if (filedes[i] != -1)
+      {
+        close(filedes[i]);
+        filedes[i] = -1;
+      }
+    }
+  } /* closePipe */
+};
+
 
 
 /****************************************************************************
@@ -263,118 +281,135 @@ void Exec::setTimeout(int time_s)
 
 bool Exec::run(void)
 {
-    // Create pipe file descriptor pair for handling stdin to subprocess
-  int in_filedes[2];
-  int ret = pipe(in_filedes);
-  if (ret == -1)
-  {
-    cerr << "*** ERROR: Could not set up stdin pipe for subprocess "
-         << args[0] << ": " << strerror(errno) << endl;
-    return false;
-  }
-
-    // Create pipe file descriptor pair for handling stdout from subprocess
-  int out_filedes[2];
-  ret = pipe(out_filedes);
-  if (ret == -1)
-  {
-    cerr << "*** ERROR: Could not set up stdout pipe for subprocess "
-         << args[0] << ": " << strerror(errno) << endl;
-    return false;
+    // Create pipe file descriptor pairs for handling stdin, stdout and stderr
+    // for the subprocess. The close-on-exec flag is set on all of them so
+    // that they are not inherited by other subprocesses.
+  int filedes[3][2] = {{-1, -1}, {-1, -1}, {-1, -1}};
+  static const char* const pipe_names[3] = {"stdin", "stdout", "stderr"};
+  for (int i=0; i<3; ++i)
+  {
+    if ((pipe(filedes[i]) == -1) ||
+        (fcntl(filedes[i][0], F_SETFD, FD_CLOEXEC) == -1) ||
+        (fcntl(filedes[i][1], F_SETFD, FD_CLOEXEC) == -1))
+    {
+      cerr << "*** ERROR: Could not set up " << pipe_names[i]
+           << " pipe for subprocess " << args[0] << ": "
+           << strerror(errno) << endl;
+      for (int j=0; j<=i; ++j)
+      {
+        closePipe(filedes[j]);
+      }
+      return false;
+    }
   }
+  int (&in_filedes)[2] = filedes[0];
+  int (&out_filedes)[2] = filedes[1];
+  int (&err_filedes)[2] = filedes[2];
 
-    // Create pipe file descriptor pair for handling stderr from subprocess
-  int err_filedes[2];
-  ret = pipe(err_filedes);
-  if (ret == -1)
+    // Set up the argument and environment vectors. This is done before
+    // starting the subprocess since nothing may be allocated between the
+    // start of the subprocess and the exec.
+  std::vector<char*> cmd;
+  for (auto& arg : args)
   {
-    cerr << "*** ERROR: Could not set up stderr pipe for subprocess "
-         << args[0] << ": " << strerror(errno) << endl;
-    return false;
+    cmd.push_back(const_cast<char*>(arg.c_str()));
   }
+  cmd.push_back(0);
 
-  pid = fork();
-  if (pid == -1)
+  std::vector<std::string> envstr;
+  if (!clear_env)
   {
-    cerr << "*** ERROR: The fork system call failed for subprocess "
-         << args[0] << ": " << strerror(errno) << endl;
-    return false;
+    for (char **e=environ; (e != 0) && (*e != 0); ++e)
+    {
+      envstr.push_back(*e);
+    }
   }
-
-    // If pid is non-zero we're in the parent process
-  if (pid != 0)
+  for (const auto& var : env)
   {
-      // Set up priority for child if specified
-    if (nice_value != 0)
+    const std::string name(var.substr(0, var.find('=') + 1));
+    for (auto it=envstr.begin(); it!=envstr.end(); )
     {
-      nice(0);
+      it = (it->compare(0, name.size(), name) == 0) ? envstr.erase(it) : it+1;
     }
+    envstr.push_back(var);
+  }
+  std::vector<char*> envp;
+  for (auto& var : envstr)
+  {
+    envp.push_back(const_cast<char*>(var.c_str()));
+  }
+  envp.push_back(0);
+
+    // Connect the pipes to stdin, stdout and stderr in the subprocess. The
+    // dup2 call clear the close-on-exec flag on the new file descriptor.
+  posix_spawn_file_actions_t actions;
+  posix_spawn_file_actions_init(&actions);
+  posix_spawn_file_actions_adddup2(&actions, in_filedes[0], STDIN_FILENO);
+  posix_spawn_file_actions_adddup2(&actions, out_filedes[1], STDOUT_FILENO);
+  posix_spawn_file_actions_adddup2(&actions, err_filedes[1], STDERR_FILENO);
+
+    // The subprocess is started using posix_spawn, which on most systems
+    // use vfork or clone semantics. Using fork in a big process takes a lot
+    // of time since all page tables have to be copied.
+  posix_spawnattr_t attr;
+  posix_spawnattr_init(&attr);
+#ifdef POSIX_SPAWN_USEVFORK
+  posix_spawnattr_setflags(&attr, POSIX_SPAWN_USEVFORK);
+#endif
+
+  pid_t child_pid = -1;
+  int ret = posix_spawn(&child_pid, cmd[0], &actions, &attr,
+                        cmd.data(), envp.data());
+  posix_spawnattr_destroy(&attr);
+  posix_spawn_file_actions_destroy(&actions);
 
-      // Add the new child to the global map
-    execs[pid] = this;
-
-      // Set up handling for subprocess stdin
-    close(in_filedes[0]);
-    stdin_fd = in_filedes[1];
-
-      // Set up handling for subprocess stdout
-    close(out_filedes[1]);
-    stdout_watch = new FdWatch(out_filedes[0], FdWatch::FD_WATCH_RD);
-    stdout_watch->activity.connect(mem_fun(*this, &Exec::stdoutActivity));
-
-      // Set up handling for subprocess stderr
-    close(err_filedes[1]);
-    stderr_watch = new FdWatch(err_filedes[0], FdWatch::FD_WATCH_RD);
-    stderr_watch->activity.connect(mem_fun(*this, &Exec::stderrActivity));
+  close(in_filedes[0]);
+  close(out_filedes[1]);
+  close(err_filedes[1]);
 
-    if (timeout_timer != 0)
-    {
-      timeout_timer->setEnable(true);
-    }
+  if (ret != 0)
+  {
+    close(in_filedes[1]);
+    close(out_filedes[0]);
+    close(err_filedes[0]);
 
+      // Exec errors are reported directly by posix_spawn on most systems.
+      // To behave in the same way as if the exec fail in the subprocess, the
+      // exited signal is emitted with exit code 255.
+    cerr << "*** ERROR: Failed to exec " << args[0]
+         << ": " << strerror(ret) << endl;
+    status = 255 << 8;
+    Application::app().runTask(mem_fun(*this, &Exec::subprocessExited));
     return true;
   }
+  pid = child_pid;
 
-  /* From this point we are in the child process */
+    // Set up priority for child if specified
+  if (nice_value != 0)
+  {
+    nice(0);
+  }
 
-    // Set up stdin pipe
-  close(in_filedes[1]);
-  dup2(in_filedes[0], STDIN_FILENO);
-  close(in_filedes[0]);
+    // Add the new child to the global map
+  execs[pid] = this;
 
-    // Set up stdout pipe
-  close(out_filedes[0]);
-  dup2(out_filedes[1], STDOUT_FILENO);
-  close(out_filedes[1]);
+    // Set up handling for subprocess stdin
+  stdin_fd = in_filedes[1];
 
-    // Set up stderr pipe
-  close(err_filedes[0]);
-  dup2(err_filedes[1], STDERR_FILENO);
-  close(err_filedes[1]);
+    // Set up handling for subprocess stdout
+  stdout_watch = new FdWatch(out_filedes[0], FdWatch::FD_WATCH_RD);
+  stdout_watch->activity.connect(mem_fun(*this, &Exec::stdoutActivity));
 
-  char *cmd[args.size()+1];
-  for (size_t i=0; i<args.size(); ++i)
-  {
-    cmd[i] = strdup(args[i].c_str());
-  }
-  cmd[args.size()] = 0;
+    // Set up handling for subprocess stderr
+  stderr_watch = new FdWatch(err_filedes[0], FdWatch::FD_WATCH_RD);
+  stderr_watch->activity.connect(mem_fun(*this, &Exec::stderrActivity));
 
-  if (clear_env)
+  if (timeout_timer != 0)
   {
-    clearenv();
+    timeout_timer->setEnable(true);
   }
-  for (size_t i=0; i<env.size(); ++i)
-  {
-    putenv(strdup(env[i].c_str()));
-  }
-
-  ret = execv(cmd[0], cmd);
-  assert (ret == -1);
 
-  cerr << "*** ERROR: Failed to exec " << args[0]
-       << ": " << strerror(errno) << endl;
-
-  exit(255);
+  return true;
 } /* Exec::run */
 
 
@@ -224,10 +224,14 @@ class Exec : public sigc::trackable
      *
      * This method is used to run the command specified using the constructor,
      * setCommandLine and appendArgument. This function will return success as
-     * long as the fork call succeeds. If the command cannot be run for some
-     * reason, this function will still return success. Errors that occurr
-     * after the fork call will be handled through the "exited" signal. If the
-     * command cannot run for some reason, the exit code will be 255.
+     * long as the pipes to the subprocess could be set up. If the command
+     * cannot be run for some reason, this function will still return success.
+     * Errors that occurr when starting the command will be handled through
+     * the "exited" signal. If the command cannot run for some reason, the
+     * exit code will be 255.
+     *
+     * The subprocess is started using posix_spawn so the cost of starting a
+     * command does not grow with the size of the calling process.
      */
     bool run(void);
 
@@ -303,6 +307,15 @@ class Exec : public sigc::trackable
      */
     int termSig(void) const;
 
+    /**
+     * @brief   Get the process id of the subprocess
+     * @returns Returns the process id or -1 if no subprocess is running
+     *
+     * This can for example be used to read resource usage statistics for
+     * the subprocess from the /proc filesystem while it is running.
+     */
+    pid_t processId(void) const { return pid; }
+
     /**
      * @brief   A signal that is emitted when the subprocess write to stdout
      * @param   buf The buffer containing the data
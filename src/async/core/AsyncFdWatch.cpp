@@ -117,22 +117,23 @@ using namespace Async;
 FdWatch::FdWatch(void)
   : m_fd(-1), m_type(FD_WATCH_RD), m_enabled(false)
 {
+  Application::object_counts.fd_watches += 1;
 } /* FdWatch::FdWatch */
 
 
 FdWatch::FdWatch(int fd, FdWatchType type)
   : m_fd(fd), m_type(type), m_enabled(true)
 {
+  Application::object_counts.fd_watches += 1;
+  Application::object_counts.enabled_fd_watches += 1;
   Application::app().addFdWatch(this);
 } /* FdWatch::FdWatch */
 
 
 FdWatch::~FdWatch(void)
 {
-  if (m_enabled)
-  {
-    Application::app().delFdWatch(this);
-  }
+  setEnabled(false);
+  Application::object_counts.fd_watches -= 1;
 } /* FdWatch::~FdWatch */
 
 
@@ -159,11 +160,13 @@ void FdWatch::setEnabled(bool enabled)
     assert(m_fd >= 0);
     Application::app().addFdWatch(this);
     m_enabled = enabled;
+    Application::object_counts.enabled_fd_watches += 1;
   }
   else if (m_enabled && !enabled)
   {
     Application::app().delFdWatch(this);
     m_enabled = enabled;
+    Application::object_counts.enabled_fd_watches -= 1;
   }
 } /* FdWatch::setEnabled */
 
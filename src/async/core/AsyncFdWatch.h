@@ -125,7 +125,8 @@ class FdWatch : public sigc::trackable
     typedef enum
     { 
       FD_WATCH_RD,  ///< File descriptor watch for incoming data
-      FD_WATCH_WR   ///< File descriptor watch for outgoing data
+      FD_WATCH_WR,  ///< File descriptor watch for outgoing data
+      FD_WATCH_PRI  ///< File descriptor watch for priority events
     } FdWatchType;
     
     /**
@@ -140,8 +141,11 @@ class FdWatch : public sigc::trackable
      * @brief Constructor
      *
      * Add the given file descriptor to the watch list and watch it for
-     * incoming data (FD_WATCH_RD) or write buffer space available
-     * (FD_WATCH_WR).
+     * incoming data (FD_WATCH_RD), write buffer space available
+     * (FD_WATCH_WR) or priority events (FD_WATCH_PRI). A priority event is
+     * for example out-of-band data on a socket or a changed value of a sysfs
+     * attribute file, like the value of a GPIO pin with edge detection
+     * enabled.
      * @param fd    The file descriptor to watch
      * @param type  The type of watch to create (see @ref FdWatchType)
      */
@@ -6,7 +6,7 @@
 
 \verbatim
 Async - A library for programming event driven applications
-Copyright (C) 2003-2022 Tobias Blomberg / SM0SVX
+Copyright (C) 2003-2026 Tobias Blomberg / SM0SVX
 
 This program is free software; you can redistribute it and/or modify
 it under the terms of the GNU General Public License as published by
@@ -116,10 +116,6 @@ FramedTcpConnection::FramedTcpConnection(size_t recv_buf_len)
   : TcpConnection(recv_buf_len), m_max_rx_frame_size(DEFAULT_MAX_FRAME_SIZE),
     m_max_tx_frame_size(DEFAULT_MAX_FRAME_SIZE), m_size_received(false)
 {
-#if 0
-  TcpConnection::sendBufferFull.connect(
-      sigc::mem_fun(*this, &FramedTcpConnection::onSendBufferFull));
-#endif
 } /* FramedTcpConnection::FramedTcpConnection */
 
 
@@ -130,20 +126,11 @@ FramedTcpConnection::FramedTcpConnection(
     m_max_rx_frame_size(DEFAULT_MAX_FRAME_SIZE),
     m_max_tx_frame_size(DEFAULT_MAX_FRAME_SIZE), m_size_received(false)
 {
-#if 0
-  TcpConnection::sendBufferFull.connect(
-      sigc::mem_fun(*this, &FramedTcpConnection::onSendBufferFull));
-#endif
 } /* FramedTcpConnection::FramedTcpConnection */
 
 
 FramedTcpConnection::~FramedTcpConnection(void)
 {
-  for (auto& item : m_txq)
-  {
-    delete item;
-  }
-  m_txq.clear();
 } /* FramedTcpConnection::~FramedTcpConnection */
 
 
@@ -169,9 +156,6 @@ TcpConnection& FramedTcpConnection::operator=(TcpConnection&& other_base)
   m_frame.swap(other.m_frame);
   other.m_frame.clear();
 
-  m_txq.swap(other.m_txq);
-  other.m_txq.clear();
-
   return *this;
 } /* FramedTcpConnection::operator=(TcpConnection&&) */
 
@@ -183,42 +167,45 @@ int FramedTcpConnection::write(const void *buf, int count)
   {
     return 0;
   }
-  else if (static_cast<uint32_t>(count) > m_max_tx_frame_size)
+  else if (!checkTxFrameSize(count))
   {
-    errno = EMSGSIZE;
     return -1;
   }
 
-  QueueItem *qi = new QueueItem(buf, count);
-  if (m_txq.empty())
+    // The header and the frame data are written in one go so that no
+    // separate frame buffer need to be allocated and so that they end up in
+    // the same TLS record when the connection is encrypted
+  uint8_t head[4];
+  setFrameHeader(head, count);
+  struct iovec iov[2];
+  iov[0].iov_base = head;
+  iov[0].iov_len = sizeof(head);
+  iov[1].iov_base = const_cast<void*>(buf);
+  iov[1].iov_len = count;
+  if (TcpConnection::writev(iov, 2) < 0)
   {
-    int ret = TcpConnection::write(qi->m_buf, qi->m_size);
-    //cout << "###   count=" << (qi->m_size-qi->m_pos) << " ret=" << ret << endl;
-    if (ret < 0)
-    {
-      delete qi;
-      qi = 0;
-      return -1;
-    }
-    if (ret >= qi->m_size)
-    {
-      delete qi;
-      qi = 0;
-    }
-    else
-    {
-      //cout << "### Not all bytes were sent: count=" << count
-      //     << " ret=" << ret << endl;
-      qi->m_pos += ret;
-    }
+    return -1;
+  }
+
+  return count;
+} /* FramedTcpConnection::write */
+
+
+int FramedTcpConnection::write(const SharedBuffer& buf)
+{
+  if (!checkTxFrameSize(buf->size()))
+  {
+    return -1;
   }
 
-  if (qi != 0)
+  uint8_t head[4];
+  setFrameHeader(head, buf->size());
+  if (writeWithHeader(head, sizeof(head), buf) < 0)
   {
-    m_txq.push_back(qi);
+    return -1;
   }
 
-  return count;
+  return buf->size();
 } /* FramedTcpConnection::write */
 
 
@@ -247,41 +234,87 @@ int FramedTcpConnection::onDataReceived(void *buf, int count)
   int orig_count = count;
   uint8_t* ptr = reinterpret_cast<uint8_t*>(buf);
 
+    // Without SSL the data is presented directly from the receive buffer in
+    // the TcpConnection class. Complete frames are then delivered in place
+    // and a partial frame is left in the receive buffer until the rest of it
+    // has arrived. With SSL, unprocessed data would be lost so partial frames,
+    // and partial frame headers, must be assembled in the frame buffer.
+  const bool in_place = !sslActive();
+
   while (count > 0)
   {
     if (!m_size_received)
     {
-      if (static_cast<size_t>(count) < sizeof(m_frame_size))
+      if (in_place)
+      {
+        if (static_cast<size_t>(count) < FRAME_HEADER_SIZE)
+        {
+          break;
+        }
+        uint32_t frame_size = frameHeaderSize(ptr);
+        if (frame_size > m_max_rx_frame_size)
+        {
+          closeConnection();
+          onDisconnected(DR_PROTOCOL_ERROR);
+          return orig_count - count;
+        }
+        if (static_cast<size_t>(count) - FRAME_HEADER_SIZE < frame_size)
+        {
+            // Make room for the whole frame so that it can be read without
+            // growing the buffer in steps. The buffer content is moved by
+            // this so the data pointer must not be used after this point.
+          reserveRecvBuf(FRAME_HEADER_SIZE + frame_size);
+          break;
+        }
+        ptr += FRAME_HEADER_SIZE;
+        count -= FRAME_HEADER_SIZE + frame_size;
+        if (!emitFrame(ptr, frame_size))
+        {
+          return orig_count;
+        }
+        ptr += frame_size;
+        continue;
+      }
+
+      size_t copy_cnt = min(FRAME_HEADER_SIZE - m_frame.size(),
+                            static_cast<size_t>(count));
+      m_frame.insert(m_frame.end(), ptr, ptr+copy_cnt);
+      count -= copy_cnt;
+      ptr += copy_cnt;
+      if (m_frame.size() < FRAME_HEADER_SIZE)
       {
         break;
       }
-      m_frame_size = static_cast<uint32_t>(*ptr++) << 24;
-      m_frame_size |= static_cast<uint32_t>(*ptr++) << 16;
-      m_frame_size |= static_cast<uint32_t>(*ptr++) << 8;
-      m_frame_size |= static_cast<uint32_t>(*ptr++);
+      m_frame_size = frameHeaderSize(m_frame.data());
+      m_frame.clear();
       if (m_frame_size > m_max_rx_frame_size)
       {
         closeConnection();
         onDisconnected(DR_PROTOCOL_ERROR);
         return orig_count - count;
       }
-      m_frame.clear();
       m_frame.reserve(m_frame_size);
-      count -= sizeof(m_frame_size);
       m_size_received = true;
     }
-    else
+
+    if (m_size_received)
     {
       size_t cur_size = m_frame.size();
       size_t copy_cnt = min(m_frame_size - cur_size, static_cast<size_t>(count));
-      m_frame.resize(cur_size + copy_cnt);
-      ::memcpy(m_frame.data()+cur_size, ptr, copy_cnt);
-      count -= copy_cnt;
-      ptr += copy_cnt;
+      if (copy_cnt > 0)
+      {
+        m_frame.resize(cur_size + copy_cnt);
+        ::memcpy(m_frame.data()+cur_size, ptr, copy_cnt);
+        count -= copy_cnt;
+        ptr += copy_cnt;
+      }
       if (m_frame.size() == m_frame_size)
       {
         m_size_received = false;
-        frameReceived(this, m_frame);
+        if (!emitFrame(m_frame.data(), m_frame.size()))
+        {
+          return orig_count;
+        }
       }
     }
   }
@@ -296,43 +329,74 @@ int FramedTcpConnection::onDataReceived(void *buf, int count)
  *
  ****************************************************************************/
 
-#if 0
-void FramedTcpConnection::onSendBufferFull(bool is_full)
+void FramedTcpConnection::setFrameHeader(uint8_t* head, uint32_t size)
+{
+  head[0] = size >> 24;
+  head[1] = (size >> 16) & 0xff;
+  head[2] = (size >> 8) & 0xff;
+  head[3] = size & 0xff;
+} /* FramedTcpConnection::setFrameHeader */
+
+
+uint32_t FramedTcpConnection::frameHeaderSize(const uint8_t* head)
+{
+  return (static_cast<uint32_t>(head[0]) << 24) |
+         (static_cast<uint32_t>(head[1]) << 16) |
+         (static_cast<uint32_t>(head[2]) << 8) |
+         static_cast<uint32_t>(head[3]);
+} /* FramedTcpConnection::frameHeaderSize */
+
+
+bool FramedTcpConnection::checkTxFrameSize(size_t size) const
+{
+  if (size > m_max_tx_frame_size)
+  {
+    errno = EMSGSIZE;
+    return false;
+  }
+  return true;
+} /* FramedTcpConnection::checkTxFrameSize */
+
+
+bool FramedTcpConnection::emitFrame(const uint8_t* buf, size_t len)
 {
-  //cout << "### FramedTcpConnection::onSendBufferFull: is_full="
-  //     << is_full << "\n";
-  if (!is_full)
+  frameDataReceived(this, buf, len);
+  if (!isConnected())
   {
-    while (!m_txq.empty())
+    return false;
+  }
+
+  if (!frameReceived.empty())
+  {
+    if (buf != m_frame.data())
     {
-      QueueItem *qi = m_txq.front();
-      int ret = TcpConnection::write(qi->m_buf+qi->m_pos, qi->m_size-qi->m_pos);
-      //cout << "###   count=" << (qi->m_size-qi->m_pos) << " ret=" << ret << endl;
-      if (ret <= 0)
-      {
-        return;
-      }
-      qi->m_pos += ret;
-      if (qi->m_pos < qi->m_size)
-      {
-        break;
-      }
-      m_txq.pop_front();
-      delete qi;
-      qi = 0;
+      m_frame.assign(buf, buf + len);
     }
+    frameReceived(this, m_frame);
+    if (!isConnected())
+    {
+      return false;
+    }
+  }
+
+    // The frame buffer is also used to assemble split frame headers so it
+    // must be empty when the next frame start. Memory used for large frames
+    // is given back since there may be many idle connections.
+  m_frame.clear();
+  if (m_frame.capacity() > MAX_IDLE_FRAME_BUF)
+  {
+    std::vector<uint8_t>().swap(m_frame);
   }
-} /* FramedTcpConnection::onSendBufferFull */
-#endif
+
+  return true;
+} /* FramedTcpConnection::emitFrame */
 
 
 void FramedTcpConnection::disconnectCleanup(void)
 {
-  for (TxQueue::iterator it = m_txq.begin(); it != m_txq.end(); ++it)
-  {
-    delete *it;
-  }
-  m_txq.clear();
+    // Throw away any partially received frame
+  m_size_received = false;
+  m_frame.clear();
 } /* FramedTcpConnection::disconnectCleanup */
 
 
@@ -6,7 +6,7 @@
 
 \verbatim
 Async - A library for programming event driven applications
-Copyright (C) 2003-2024 Tobias Blomberg / SM0SVX
+Copyright (C) 2003-2026 Tobias Blomberg / SM0SVX
 
 This program is free software; you can redistribute it and/or modify
 it under the terms of the GNU General Public License as published by
@@ -45,8 +45,8 @@ An example of how to use the FramedTcpConnection class in a server
 
 #include <stdint.h>
 #include <vector>
-#include <deque>
-#include <cstring>
+#include <istream>
+#include <streambuf>
 
 
 /****************************************************************************
@@ -124,13 +124,51 @@ given to one call to the write function will arrive at the other end in one
 piece or not at all. This makes it easier to implement message based protocols
 that only want to see completely transfered messages at the other end.
 
+Received frames can be delivered either in a vector, using the frameReceived
+signal, or as a pointer and a length using the frameDataReceived signal. The
+latter is the most efficient since, on unencrypted connections, the frames are
+parsed in place in the receive buffer without being copied. Use the
+FrameIStream class to unpack a frame delivered that way.
+
 \include AsyncFramedTcpClient_demo.cpp
 
 \include AsyncFramedTcpServer_demo.cpp
 */
 class FramedTcpConnection : public TcpConnection
 {
+  private:
+    struct FrameStreamBuf : public std::streambuf
+    {
+      FrameStreamBuf(const uint8_t* buf, size_t len)
+      {
+        char* begin = const_cast<char*>(reinterpret_cast<const char*>(buf));
+        setg(begin, begin, begin + len);
+      }
+    };
+
   public:
+    /**
+     * @brief The default receive buffer size for framed connections
+     *
+     * The receive buffer is larger than for a plain TCP connection so that a
+     * burst of small frames can be read and parsed in one go.
+     */
+    static const int DEFAULT_RECV_BUF_LEN = 16384;
+
+    /**
+     * @brief A read only input stream reading directly from a received frame
+     *
+     * Use this class to unpack a frame received using the frameDataReceived
+     * signal without copying it into a stringstream first. The stream must not
+     * be used after the signal handler has returned.
+     */
+    class FrameIStream : private FrameStreamBuf, public std::istream
+    {
+      public:
+        FrameIStream(const uint8_t* buf, size_t len)
+          : FrameStreamBuf(buf, len), std::istream(this) {}
+    };
+
     /**
      * @brief 	Constructor
      * @param 	recv_buf_len  The length of the receiver buffer to use
@@ -178,6 +216,15 @@ class FramedTcpConnection : public TcpConnection
       m_max_rx_frame_size = frame_size;
     }
 
+    /**
+     * @brief   Get the size of the frame assembly buffer
+     * @return  Returns the number of bytes allocated for the frame buffer
+     *
+     * The frame buffer is used to assemble frames that are split over
+     * multiple reads. It is released after a large frame.
+     */
+    size_t rxFrameBufLen(void) const { return m_frame.capacity(); }
+
     /**
      * @brief   Set the maximum TX frame size
      * @param   frame_size The maximum frame size in bytes
@@ -219,6 +266,18 @@ class FramedTcpConnection : public TcpConnection
      */
     virtual int write(const void *buf, int count) override;
 
+    /**
+     * @brief 	Send a shared buffer as a frame on the TCP connection
+     * @param 	buf The buffer containing the frame to send
+     * @return	Return bytes written or -1 on failure
+     *
+     * This function work like the function above but the frame data is not
+     * copied. The frame header and the shared buffer are sent using one
+     * vectored write so the same buffer can be sent efficiently to many
+     * connections. The buffer must not be modified after it has been written.
+     */
+    virtual int write(const SharedBuffer& buf) override;
+
     /**
      * @brief 	A signal that is emitted when a connection has been terminated
      * @param 	con   	The connection object
@@ -237,6 +296,20 @@ class FramedTcpConnection : public TcpConnection
     sigc::signal<void(FramedTcpConnection*,
                       std::vector<uint8_t>&)> frameReceived;
 
+    /**
+     * @brief 	A signal that is emitted when a frame has been received on the
+     *	      	connection
+     * @param 	con   The connection object
+     * @param 	buf   A pointer to the frame data
+     * @param 	len   The number of bytes in the frame
+     *
+     * This signal is emitted when a frame has been received on this
+     * connection, before the frameReceived signal. No copy of the frame is
+     * made so the buffer is only valid during the signal emission.
+     */
+    sigc::signal<void(FramedTcpConnection*, const uint8_t*,
+                      size_t)> frameDataReceived;
+
   protected:
     sigc::signal<int(TcpConnection*, void*, int)> dataReceived;
     sigc::signal<void(bool)> sendBufferFull;
@@ -288,37 +361,21 @@ class FramedTcpConnection : public TcpConnection
 
   private:
     static const uint32_t DEFAULT_MAX_FRAME_SIZE = 1024 * 1024; // 1MB
-
-    struct QueueItem
-    {
-      char* m_buf;
-      int   m_size;
-      int   m_pos;
-
-      QueueItem(const void* buf, int count)
-        : m_buf(0), m_size(4+count), m_pos(0)
-      {
-        m_buf = new char[4+count];
-        char *ptr = m_buf;
-        *ptr++ = static_cast<uint32_t>(count) >> 24;
-        *ptr++ = (static_cast<uint32_t>(count) >> 16) & 0xff;
-        *ptr++ = (static_cast<uint32_t>(count) >> 8) & 0xff;
-        *ptr++ = (static_cast<uint32_t>(count)) & 0xff;
-        std::memcpy(ptr, buf, count);
-      }
-      ~QueueItem(void) { delete [] m_buf; }
-    };
-    typedef std::deque<QueueItem*> TxQueue;
+    static const size_t   FRAME_HEADER_SIZE = 4;
+    static const size_t   MAX_IDLE_FRAME_BUF = 4096;
 
     uint32_t              m_max_rx_frame_size;
     uint32_t              m_max_tx_frame_size;
     bool                  m_size_received;
     uint32_t              m_frame_size;
     std::vector<uint8_t>  m_frame;
-    TxQueue               m_txq;
+
+    static void setFrameHeader(uint8_t* head, uint32_t size);
+    static uint32_t frameHeaderSize(const uint8_t* head);
 
     FramedTcpConnection(const FramedTcpConnection&) = delete;
-    //void onSendBufferFull(bool is_full);
+    bool checkTxFrameSize(size_t size) const;
+    bool emitFrame(const uint8_t* buf, size_t len);
     void disconnectCleanup(void);
 
 };  /* class FramedTcpConnection */
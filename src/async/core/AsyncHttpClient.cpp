@@ -0,0 +1,361 @@
+/**
+@file   AsyncHttpClient.cpp
+@brief  A non-blocking HTTP client driven by the Async main loop
+@author Tobias Blomberg / SM0SVX
+@date   2026-10-14
+
+\verbatim
+Async - A library for programming event driven applications
+Copyright (C) 2003-2026 Tobias Blomberg / SM0SVX
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+\endverbatim
+*/
+
+/****************************************************************************
+ *
+ * System Includes
+ *
+ ****************************************************************************/
+
+#include <curl/curl.h>
+
+#include <cstring>
+#include <iostream>
+#include <vector>
+
+
+/****************************************************************************
+ *
+ * Project Includes
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Local Includes
+ *
+ ****************************************************************************/
+
+#include "AsyncHttpClient.h"
+
+
+/****************************************************************************
+ *
+ * Namespaces to use
+ *
+ ****************************************************************************/
+
+using namespace Async;
+
+
+/****************************************************************************
+ *
+ * Defines & typedefs
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Local class definitions
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Prototypes
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Exported Global Variables
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Local Global Variables
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Public member functions
+ *
+ ****************************************************************************/
+
+std::shared_ptr<HttpClient> HttpClient::shared(void)
+{
+  static std::weak_ptr<HttpClient> shared_client;
+  std::shared_ptr<HttpClient> client = shared_client.lock();
+  if (client == nullptr)
+  {
+    client = std::make_shared<HttpClient>();
+    shared_client = client;
+  }
+  return client;
+} /* HttpClient::shared */
+
+
+HttpClient::HttpClient(void)
+  : m_multi(curl_multi_init()), m_timer(0, Timer::TYPE_ONESHOT, false)
+{
+  m_timer.expired.connect(sigc::mem_fun(*this, &HttpClient::onTimeout));
+  if (m_multi == nullptr)
+  {
+    std::cerr << "*** ERROR: Could not create a curl multi handle"
+              << std::endl;
+    return;
+  }
+  curl_multi_setopt(m_multi, CURLMOPT_SOCKETFUNCTION,
+                    &HttpClient::socketCallback);
+  curl_multi_setopt(m_multi, CURLMOPT_SOCKETDATA, this);
+  curl_multi_setopt(m_multi, CURLMOPT_TIMERFUNCTION,
+                    &HttpClient::timerCallback);
+  curl_multi_setopt(m_multi, CURLMOPT_TIMERDATA, this);
+} /* HttpClient::HttpClient */
+
+
+HttpClient::~HttpClient(void)
+{
+  for (auto& item : m_requests)
+  {
+    curl_multi_remove_handle(m_multi, item.first);
+    curl_easy_cleanup(item.first);
+  }
+  m_requests.clear();
+  if (m_multi != nullptr)
+  {
+    curl_multi_cleanup(m_multi);
+  }
+} /* HttpClient::~HttpClient */
+
+
+HttpClient::RequestId HttpClient::get(const std::string& url,
+                                      Handler handler)
+{
+  if (m_multi == nullptr)
+  {
+    return INVALID_REQUEST;
+  }
+
+  CURL* easy = curl_easy_init();
+  if (easy == nullptr)
+  {
+    std::cerr << "*** ERROR: Could not create a curl easy handle"
+              << std::endl;
+    return INVALID_REQUEST;
+  }
+
+  RequestPtr req(new Request);
+  req->id = ++m_next_id;
+  req->easy = easy;
+  req->handler = std::move(handler);
+  req->max_body_size = m_max_body_size;
+  req->errbuf[0] = '\0';
+
+  curl_easy_setopt(easy, CURLOPT_URL, url.c_str());
+  curl_easy_setopt(easy, CURLOPT_WRITEFUNCTION, &HttpClient::writeCallback);
+  curl_easy_setopt(easy, CURLOPT_WRITEDATA, req.get());
+  curl_easy_setopt(easy, CURLOPT_ERRORBUFFER, req->errbuf);
+  curl_easy_setopt(easy, CURLOPT_NOSIGNAL, 1L);
+  curl_easy_setopt(easy, CURLOPT_FOLLOWLOCATION, 1L);
+  curl_easy_setopt(easy, CURLOPT_MAXREDIRS, 5L);
+  curl_easy_setopt(easy, CURLOPT_ACCEPT_ENCODING, "");
+  curl_easy_setopt(easy, CURLOPT_TIMEOUT_MS, static_cast<long>(m_timeout_ms));
+
+  RequestId id = req->id;
+  m_requests[easy] = std::move(req);
+  CURLMcode ret = curl_multi_add_handle(m_multi, easy);
+  if (ret != CURLM_OK)
+  {
+    std::cerr << "*** ERROR: Could not start HTTP request for " << url
+              << ": " << curl_multi_strerror(ret) << std::endl;
+    m_requests.erase(easy);
+    curl_easy_cleanup(easy);
+    return INVALID_REQUEST;
+  }
+
+  return id;
+} /* HttpClient::get */
+
+
+bool HttpClient::cancel(RequestId id)
+{
+  for (auto it = m_requests.begin(); it != m_requests.end(); ++it)
+  {
+    if (it->second->id == id)
+    {
+      CURL* easy = it->first;
+      m_requests.erase(it);
+      curl_multi_remove_handle(m_multi, easy);
+      curl_easy_cleanup(easy);
+      return true;
+    }
+  }
+  return false;
+} /* HttpClient::cancel */
+
+
+
+/****************************************************************************
+ *
+ * Protected member functions
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Private member functions
+ *
+ ****************************************************************************/
+
+size_t HttpClient::writeCallback(char *ptr, size_t size, size_t nmemb,
+                                 void *userp)
+{
+  Request* req = static_cast<Request*>(userp);
+  size_t len = size * nmemb;
+  if ((req->max_body_size > 0) &&
+      (req->rsp.body.size() + len > req->max_body_size))
+  {
+    return 0;
+  }
+  req->rsp.body.append(ptr, len);
+  return len;
+} /* HttpClient::writeCallback */
+
+
+int HttpClient::socketCallback(void *easy, int fd, int what, void *userp,
+                               void *socketp)
+{
+  HttpClient* client = static_cast<HttpClient*>(userp);
+
+    // The watches for a file descriptor are only disabled when curl is done
+    // with it since this function may be called from the activity handler
+    // of the watch itself. They are reused if the descriptor is reused.
+  WatchPtr& ws = client->m_watches[fd];
+  if (ws == nullptr)
+  {
+    ws.reset(new WatchSet);
+    ws->rd.setFd(fd, FdWatch::FD_WATCH_RD);
+    ws->rd.activity.connect(sigc::mem_fun(*client, &HttpClient::onActivity));
+    ws->wr.setFd(fd, FdWatch::FD_WATCH_WR);
+    ws->wr.activity.connect(sigc::mem_fun(*client, &HttpClient::onActivity));
+  }
+  ws->rd.setEnabled((what == CURL_POLL_IN) || (what == CURL_POLL_INOUT));
+  ws->wr.setEnabled((what == CURL_POLL_OUT) || (what == CURL_POLL_INOUT));
+
+  return 0;
+} /* HttpClient::socketCallback */
+
+
+int HttpClient::timerCallback(void *multi, long timeout_ms, void *userp)
+{
+  HttpClient* client = static_cast<HttpClient*>(userp);
+  if (timeout_ms < 0)
+  {
+    client->m_timer.setEnable(false);
+  }
+  else
+  {
+    client->m_timer.setTimeout(timeout_ms);
+    client->m_timer.setEnable(true);
+    client->m_timer.reset();
+  }
+  return 0;
+} /* HttpClient::timerCallback */
+
+
+void HttpClient::onActivity(FdWatch *watch)
+{
+  int ev_bitmask = (watch->type() == FdWatch::FD_WATCH_RD)
+                   ? CURL_CSELECT_IN : CURL_CSELECT_OUT;
+  int running = 0;
+  curl_multi_socket_action(m_multi, watch->fd(), ev_bitmask, &running);
+  checkDone();
+} /* HttpClient::onActivity */
+
+
+void HttpClient::onTimeout(Timer *timer)
+{
+  int running = 0;
+  curl_multi_socket_action(m_multi, CURL_SOCKET_TIMEOUT, 0, &running);
+  checkDone();
+} /* HttpClient::onTimeout */
+
+
+void HttpClient::checkDone(void)
+{
+    // Collect all finished requests before calling any handler since a
+    // handler may start new requests or even delete this object
+  std::vector<RequestPtr> done;
+  CURLMsg* msg;
+  int msgs_left = 0;
+  while ((msg = curl_multi_info_read(m_multi, &msgs_left)) != nullptr)
+  {
+    if (msg->msg != CURLMSG_DONE)
+    {
+      continue;
+    }
+    CURL* easy = msg->easy_handle;
+    CURLcode result = msg->data.result;
+    auto it = m_requests.find(easy);
+    if (it == m_requests.end())
+    {
+      continue;
+    }
+    RequestPtr req = std::move(it->second);
+    m_requests.erase(it);
+
+    curl_easy_getinfo(easy, CURLINFO_RESPONSE_CODE, &req->rsp.status);
+    if (result != CURLE_OK)
+    {
+      req->rsp.error = (req->errbuf[0] != '\0')
+                       ? req->errbuf : curl_easy_strerror(result);
+    }
+    curl_multi_remove_handle(m_multi, easy);
+    curl_easy_cleanup(easy);
+    done.push_back(std::move(req));
+  }
+
+  for (auto& req : done)
+  {
+    if (req->handler)
+    {
+      req->handler(req->rsp);
+    }
+  }
+} /* HttpClient::checkDone */
+
+
+
+/*
+ * This file has not been truncated
+ */
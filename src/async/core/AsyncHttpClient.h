@@ -0,0 +1,279 @@
+/**
+@file   AsyncHttpClient.h
+@brief  A non-blocking HTTP client driven by the Async main loop
+@author Tobias Blomberg / SM0SVX
+@date   2026-10-14
+
+\verbatim
+Async - A library for programming event driven applications
+Copyright (C) 2003-2026 Tobias Blomberg / SM0SVX
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+\endverbatim
+*/
+
+/** @example AsyncHttpClient_demo.cpp
+An example of how to use the Async::HttpClient class
+*/
+
+#ifndef ASYNC_HTTP_CLIENT_INCLUDED
+#define ASYNC_HTTP_CLIENT_INCLUDED
+
+
+/****************************************************************************
+ *
+ * System Includes
+ *
+ ****************************************************************************/
+
+#include <functional>
+#include <memory>
+#include <string>
+#include <map>
+#include <cstdint>
+
+
+/****************************************************************************
+ *
+ * Project Includes
+ *
+ ****************************************************************************/
+
+#include <AsyncFdWatch.h>
+#include <AsyncTimer.h>
+
+
+/****************************************************************************
+ *
+ * Local Includes
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Forward declarations
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Namespace
+ *
+ ****************************************************************************/
+
+namespace Async
+{
+
+
+/****************************************************************************
+ *
+ * Forward declarations of classes inside of the declared namespace
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Defines & typedefs
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Exported Global Variables
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Class definitions
+ *
+ ****************************************************************************/
+
+/**
+@brief  A non-blocking HTTP client driven by the Async main loop
+@author Tobias Blomberg / SM0SVX
+@date   2026-10-14
+
+This class fetch documents over HTTP or HTTPS using libcurl without blocking
+the main loop. All requests are run by one curl multi handle whose sockets
+are watched using Async::FdWatch objects and whose timeouts are handled using
+an Async::Timer. Any number of requests can be running at the same time and
+connections are kept open and reused between requests to the same server.
+
+When a request is done, successful or not, the handler given when starting
+the request is called from the main loop with the response. A request can be
+cancelled before it is done, in which case the handler is never called.
+
+The shared function return an instance that is shared by everyone in the
+process, e.g. all SvxLink modules, so that they also share connections and
+DNS cache. The shared instance is deleted when the last user release it.
+
+\code
+  std::shared_ptr<Async::HttpClient> http = Async::HttpClient::shared();
+  http->get("https://www.svxlink.org/",
+      [](const Async::HttpClient::Response& rsp)
+      {
+        std::cout << rsp.status << ": " << rsp.body.size() << std::endl;
+      });
+\endcode
+*/
+class HttpClient
+{
+  public:
+    using RequestId = uint64_t;
+
+    static const RequestId INVALID_REQUEST = 0;
+
+    /**
+     * @brief The result of a request
+     */
+    struct Response
+    {
+      long        status  = 0;  ///< The HTTP status code, 0 if none received
+      std::string body;         ///< The received document
+      std::string error;        ///< Transfer error message, empty if none
+
+      /**
+       * @brief   Check if the document was successfully received
+       * @return  Returns \em true on a 2xx status without transfer errors
+       */
+      bool ok(void) const
+      {
+        return error.empty() && (status >= 200) && (status < 300);
+      }
+    };
+
+    using Handler = std::function<void(const Response&)>;
+
+    /**
+     * @brief   Get the HTTP client shared by the whole process
+     * @return  Returns a pointer to the shared client
+     *
+     * The client is created on the first call and is deleted when the last
+     * pointer to it is released.
+     */
+    static std::shared_ptr<HttpClient> shared(void);
+
+    /**
+     * @brief   Default constructor
+     */
+    HttpClient(void);
+
+    /**
+     * @brief   Destructor
+     *
+     * All requests that are not done are cancelled without calling their
+     * handlers.
+     */
+    ~HttpClient(void);
+
+    /**
+     * @brief   Set the maximum time a request may take
+     * @param   timeout_ms The total timeout in milliseconds, 0 for no limit
+     *
+     * Only requests started after the call are affected. Default 30 seconds.
+     */
+    void setTimeout(unsigned timeout_ms) { m_timeout_ms = timeout_ms; }
+
+    /**
+     * @brief   Set the maximum size of a received document
+     * @param   max_size The maximum size in bytes, 0 for no limit
+     *
+     * A transfer that exceed the limit fail. Default 1MB.
+     */
+    void setMaxBodySize(size_t max_size) { m_max_body_size = max_size; }
+
+    /**
+     * @brief   Start a GET request
+     * @param   url     The URL to fetch
+     * @param   handler The function to call when the request is done
+     * @return  Returns the request id or INVALID_REQUEST on failure
+     */
+    RequestId get(const std::string& url, Handler handler);
+
+    /**
+     * @brief   Cancel a request
+     * @param   id The request id returned by the get function
+     * @return  Returns \em true if the request was found
+     *
+     * The handler of a cancelled request is never called.
+     */
+    bool cancel(RequestId id);
+
+    /**
+     * @brief   Get the number of requests that are not done
+     * @return  Returns the number of running requests
+     */
+    size_t pending(void) const { return m_requests.size(); }
+
+  private:
+    struct Request
+    {
+      RequestId   id;
+      void*       easy;
+      Handler     handler;
+      Response    rsp;
+      size_t      max_body_size;
+      char        errbuf[256];
+    };
+    struct WatchSet
+    {
+      FdWatch rd;
+      FdWatch wr;
+    };
+    using RequestPtr = std::unique_ptr<Request>;
+    using WatchPtr = std::unique_ptr<WatchSet>;
+
+    void*                         m_multi;
+    Timer                         m_timer;
+    std::map<void*, RequestPtr>   m_requests;
+    std::map<int, WatchPtr>       m_watches;
+    RequestId                     m_next_id       = INVALID_REQUEST;
+    unsigned                      m_timeout_ms    = 30000;
+    size_t                        m_max_body_size = 1024 * 1024;
+
+    HttpClient(const HttpClient&);
+    HttpClient& operator=(const HttpClient&);
+    static size_t writeCallback(char *ptr, size_t size, size_t nmemb,
+                                void *userp);
+    static int socketCallback(void *easy, int fd, int what, void *userp,
+                              void *socketp);
+    static int timerCallback(void *multi, long timeout_ms, void *userp);
+    void onActivity(FdWatch *watch);
+    void onTimeout(Timer *timer);
+    void checkDone(void);
+
+};  /* class HttpClient */
+
+
+} /* namespace */
+
+#endif /* ASYNC_HTTP_CLIENT_INCLUDED */
+
+
+
+/*
+ * This file has not been truncated
+ */
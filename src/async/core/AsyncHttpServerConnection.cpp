@@ -30,10 +30,18 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
  *
  ****************************************************************************/
 
+#include <strings.h>
+
 #include <cstring>
 #include <cerrno>
 #include <sstream>
 #include <cassert>
+#include <cstdlib>
+#include <algorithm>
+
+#ifdef HAS_ZLIB
+#include <zlib.h>
+#endif
 
 
 /****************************************************************************
@@ -114,8 +122,12 @@ using namespace Async;
 
 HttpServerConnection::HttpServerConnection(size_t recv_buf_len)
   : TcpConnection(recv_buf_len), m_state(STATE_DISCONNECTED),
-    m_chunked(false)
+    m_chunked(false), m_compress_threshold(DEFAULT_COMPRESS_THRESHOLD),
+    m_keep_alive_timeout(DEFAULT_KEEP_ALIVE_TIMEOUT),
+    m_idle_timer(DEFAULT_KEEP_ALIVE_TIMEOUT, Timer::TYPE_ONESHOT, false)
 {
+  m_idle_timer.expired.connect(
+      sigc::mem_fun(*this, &HttpServerConnection::onIdleTimeout));
 #if 0
   TcpConnection::sendBufferFull.connect(
       sigc::mem_fun(*this, &HttpServerConnection::onSendBufferFull));
@@ -127,8 +139,13 @@ HttpServerConnection::HttpServerConnection(
     int sock, const IpAddress& remote_addr, uint16_t remote_port,
     size_t recv_buf_len)
   : TcpConnection(sock, remote_addr, remote_port, recv_buf_len),
-    m_state(STATE_EXPECT_START_LINE), m_chunked(false)
+    m_state(STATE_EXPECT_START_LINE), m_chunked(false),
+    m_compress_threshold(DEFAULT_COMPRESS_THRESHOLD),
+    m_keep_alive_timeout(DEFAULT_KEEP_ALIVE_TIMEOUT),
+    m_idle_timer(DEFAULT_KEEP_ALIVE_TIMEOUT, Timer::TYPE_ONESHOT, true)
 {
+  m_idle_timer.expired.connect(
+      sigc::mem_fun(*this, &HttpServerConnection::onIdleTimeout));
 #if 0
   TcpConnection::sendBufferFull.connect(
       sigc::mem_fun(*this, &HttpServerConnection::onSendBufferFull));
@@ -157,9 +174,30 @@ TcpConnection& HttpServerConnection::operator=(TcpConnection&& other_base)
 
   m_req = std::move(other.m_req);
 
+  m_content_left = other.m_content_left;
+  other.m_content_left = 0;
+
   m_chunked = other.m_chunked;
   other.m_chunked = false;
 
+  m_chunk_framed = other.m_chunk_framed;
+  m_chunk_keep_alive = other.m_chunk_keep_alive;
+  m_in_chunked = other.m_in_chunked;
+  other.m_in_chunked = false;
+
+  m_pending = std::move(other.m_pending);
+  other.m_pending.clear();
+
+  m_close_when_sent = other.m_close_when_sent;
+  other.m_close_when_sent = false;
+
+  m_compress_threshold = other.m_compress_threshold;
+  m_keep_alive_timeout = other.m_keep_alive_timeout;
+
+  m_idle_timer.setTimeout(other.m_idle_timer.timeout());
+  m_idle_timer.setEnable(other.m_idle_timer.isEnabled());
+  other.m_idle_timer.setEnable(false);
+
   return *this;
 } /* HttpServerConnection::operator=(TcpConnection&&) */
 
@@ -205,27 +243,108 @@ TcpConnection& HttpServerConnection::operator=(TcpConnection&& other_base)
 //} /* HttpServerConnection::write */
 
 
+void HttpServerConnection::setKeepAliveTimeout(unsigned timeout_ms)
+{
+  m_keep_alive_timeout = timeout_ms;
+  if (timeout_ms > 0)
+  {
+    m_idle_timer.setTimeout(timeout_ms);
+  }
+} /* HttpServerConnection::setKeepAliveTimeout */
+
+
 bool HttpServerConnection::write(const Response& res)
 {
+  if (!isConnected())
+  {
+    return false;
+  }
+
+    // Responses are written in the same order as the requests were received
+  PendingResponse pr;
+  if (!m_pending.empty())
+  {
+    pr = m_pending.front();
+    m_pending.pop_front();
+  }
+
+  if (m_chunked)
+  {
+    m_chunked = false;
+    m_in_chunked = true;
+    m_chunk_framed = pr.chunked_ok;
+    m_chunk_keep_alive = pr.keep_alive && pr.chunked_ok;
+  }
+  const bool keep_alive = m_in_chunked ? m_chunk_keep_alive : pr.keep_alive;
+
+  const std::string* content = &res.content();
+  std::string compressed;
+  const bool is_compressed = !m_in_chunked &&
+      (pr.coding != CODING_IDENTITY) && (m_compress_threshold > 0) &&
+      (content->size() >= m_compress_threshold) &&
+      (findHeader(res.headers(), "Content-Encoding") == nullptr) &&
+      compress(pr.coding, *content, compressed);
+  if (is_compressed)
+  {
+    content = &compressed;
+  }
+
   std::ostringstream os;
   os << "HTTP/1.1 " << res.code() << " " << codeToString(res.code()) << "\r\n";
   for (const auto& header : res.headers())
   {
+    if (((m_in_chunked || is_compressed) &&
+         (strcasecmp(header.first.c_str(), "Content-Length") == 0)) ||
+        (strcasecmp(header.first.c_str(), "Connection") == 0))
+    {
+      continue;
+    }
     os << header.first << ": " << header.second << "\r\n";
   }
-  if (m_chunked)
+  if (is_compressed)
+  {
+    os << "Content-encoding: "
+       << ((pr.coding == CODING_GZIP) ? "gzip" : "deflate") << "\r\n";
+    os << "Content-length: " << content->size() << "\r\n";
+    os << "Vary: Accept-Encoding\r\n";
+  }
+  else if (!m_in_chunked && (res.code() >= 200) && (res.code() != 204) &&
+           (res.code() != 304) &&
+           (findHeader(res.headers(), "Content-Length") == nullptr))
+  {
+      // The client need the content length to find the end of the response
+      // on a persistent connection
+    os << "Content-length: 0\r\n";
+  }
+  if (m_in_chunked && m_chunk_framed)
   {
     os << "Transfer-encoding: chunked\r\n";
   }
+  if (!keep_alive)
+  {
+    os << "Connection: close\r\n";
+  }
+  else if (!pr.chunked_ok)
+  {
+      // A HTTP/1.0 client that asked for a persistent connection
+    os << "Connection: keep-alive\r\n";
+  }
   os << "\r\n";
   if (res.sendContent())
   {
-    os << res.content();
+    os << *content;
   }
   //std::cout << "### HttpServerConnection::write:" << std::endl;
   //std::cout << os.str() << std::endl;
-  int len = os.str().size();
-  return TcpConnection::write(os.str().c_str(), len) == len;
+  const std::string str(os.str());
+  const int len = str.size();
+  const bool ok = (TcpConnection::write(str.data(), len) == len);
+  if (!m_in_chunked)
+  {
+    m_close_when_sent = m_close_when_sent || !keep_alive;
+    responseSent();
+  }
+  return ok;
 } /* HttpServerConnection::write */
 
 
@@ -233,24 +352,50 @@ bool HttpServerConnection::write(const char* buf, int len)
 {
   assert(len >= 0);
 
-  int ret = -1;
-  if (m_chunked)
+  if (!isConnected())
   {
+    return false;
+  }
+
+  if (m_in_chunked && m_chunk_framed)
+  {
+      // An empty chunk would end the response so it is not sent
+    if (len == 0)
+    {
+      return true;
+    }
     std::ostringstream os;
     //os << hex << len << ";tg=240;talker=SM0SVX\r\n";
     os << hex << len << "\r\n";
-    ret = TcpConnection::write(os.str().c_str(), os.str().size());
-    ret += TcpConnection::write(buf, len);
-    ret += TcpConnection::write("\r\n", 2);
-    len += os.str().size() + 2;
+    std::string chunk(os.str());
+    chunk.reserve(chunk.size() + len + 2);
+    chunk.append(buf, len);
+    chunk.append("\r\n", 2);
+    const int chunk_len = chunk.size();
+    return TcpConnection::write(chunk.data(), chunk_len) == chunk_len;
   }
-  else
+
+  return TcpConnection::write(buf, len) == len;
+} /* HttpServerConnection::write */
+
+
+bool HttpServerConnection::endChunked(void)
+{
+  if (!m_in_chunked || !isConnected())
   {
-    ret = TcpConnection::write(buf, len);
+    return false;
   }
 
-  return ret == len;
-} /* HttpServerConnection::write */
+  bool ok = true;
+  if (m_chunk_framed)
+  {
+    ok = (TcpConnection::write("0\r\n\r\n", 5) == 5);
+  }
+  m_in_chunked = false;
+  m_close_when_sent = m_close_when_sent || !m_chunk_keep_alive;
+  responseSent();
+  return ok;
+} /* HttpServerConnection::endChunked */
 
 
 /****************************************************************************
@@ -275,89 +420,108 @@ void HttpServerConnection::onDisconnected(DisconnectReason reason)
 
 int HttpServerConnection::onDataReceived(void *buf, int count)
 {
-  std::string data(reinterpret_cast<char*>(buf), count);
-  size_t data_pos = 0;
-
   //std::cout << "### HttpServerConnection::onDataReceived: "
-  //         << data << std::endl;
-
-  while (data.size() > data_pos)
+  //         << std::string(reinterpret_cast<char*>(buf), count) << std::endl;
+
+  m_idle_timer.reset();
+
+    // More than one request may be received in one go if the client use
+    // pipelining so continue until all data has been processed
+  const char* ptr = reinterpret_cast<const char*>(buf);
+  const char* end = ptr + count;
+  while ((ptr < end) &&
+         ((m_state == STATE_EXPECT_START_LINE) ||
+          (m_state == STATE_EXPECT_HEADER) ||
+          (m_state == STATE_EXPECT_PAYLOAD)))
   {
-    if (m_state == STATE_EXPECT_START_LINE)
+    if (m_state == STATE_EXPECT_PAYLOAD)
     {
-      size_t eol = data.find("\r\n", data_pos);
-      size_t len = eol;
-      if (len != std::string::npos)
-      {
-        len -= data_pos;
-      }
-      m_row.append(data.substr(data_pos, len));
-      data_pos = eol;
-      if (eol != std::string::npos)
+      size_t len = std::min(m_content_left, static_cast<size_t>(end - ptr));
+      m_req.content.append(ptr, len);
+      ptr += len;
+      m_content_left -= len;
+      if (m_content_left == 0)
       {
-        data_pos += 2;
-        handleStartLine();
-        m_row.clear();
+        m_state = STATE_REQ_COMPLETE;
       }
     }
-    else if (m_state == STATE_EXPECT_HEADER)
+    else
     {
-      size_t eol = data.find("\r\n", data_pos);
-      size_t len = eol;
-      if (len != std::string::npos)
+      const char* eol = static_cast<const char*>(memchr(ptr, '\n', end - ptr));
+      const char* row_end = (eol != nullptr) ? eol : end;
+      if (m_row.size() + (row_end - ptr) > MAX_ROW_LEN)
+      {
+        std::cerr << "*** ERROR: Too long HTTP header line received"
+                  << std::endl;
+        return -1;
+      }
+      m_row.append(ptr, row_end);
+      if (eol == nullptr)
+      {
+        break;
+      }
+      ptr = eol + 1;
+      if (!m_row.empty() && (m_row[m_row.size()-1] == '\r'))
       {
-        len -= data_pos;
+        m_row.erase(m_row.size()-1);
       }
-      m_row.append(data.substr(data_pos, len));
-      data_pos = eol;
-      if (eol != std::string::npos)
+      const bool ok = (m_state == STATE_EXPECT_START_LINE)
+                    ? handleStartLine()
+                    : handleHeader();
+      m_row.clear();
+      if (!ok)
       {
-        data_pos += 2;
-        handleHeader();
-        m_row.clear();
+        return -1;
       }
     }
-    else
+
+    if ((m_state == STATE_REQ_COMPLETE) && !requestComplete())
     {
-      data_pos = std::string::npos;
-      //m_req.content.append(data);
+      return -1;
     }
   }
 
-  if (m_state == STATE_REQ_COMPLETE)
-  {
-    requestReceived(this, m_req);
-    m_req.clear();
-    m_state = STATE_EXPECT_START_LINE;
-  }
-
   return count;
 } /* HttpServerConnection::onDataReceived */
 
 
+void HttpServerConnection::onWriteQueueEmpty(void)
+{
+  if (m_close_when_sent && isConnected())
+  {
+    closeConnection();
+    onDisconnected(DR_ORDERED_DISCONNECT);
+  }
+} /* HttpServerConnection::onWriteQueueEmpty */
+
+
 /****************************************************************************
  *
  * Private member functions
  *
  ****************************************************************************/
 
-void HttpServerConnection::handleStartLine(void)
+bool HttpServerConnection::handleStartLine(void)
 {
+    // Empty lines before the request line should be ignored
+  if (m_row.empty())
+  {
+    return true;
+  }
+
   std::istringstream is(m_row);
   std::string protocol;
   if (!(is >> m_req.method >> m_req.target >> protocol) || !is.eof())
   {
     std::cerr << "*** ERROR: Could not parse HTTP header" << std::endl;
-    disconnect();
-    return;
+    return false;
   }
 
   if (protocol.substr(0, 5) != "HTTP/")
   {
     std::cerr << "*** ERROR: Illegal protocol specification string \""
               << protocol << "\"" << std::endl;
-    disconnect();
-    return;
+    return false;
   }
 
   is.clear();
@@ -368,8 +532,7 @@ void HttpServerConnection::handleStartLine(void)
   {
     std::cerr << "*** ERROR: Illegal protocol version specification \""
               << protocol << "\"" << std::endl;
-    disconnect();
-    return;
+    return false;
   }
 
   //std::cout << "### HttpServerConnection::handleStartLine: method="
@@ -378,26 +541,46 @@ void HttpServerConnection::handleStartLine(void)
   //          << m_req.ver_minor
   //          << std::endl;
   m_state = STATE_EXPECT_HEADER;
+  return true;
 } /* HttpServerConnection::handleStartLine */
 
 
-void HttpServerConnection::handleHeader(void)
+bool HttpServerConnection::handleHeader(void)
 {
   //std::cout << "### HttpServerConnection::handleHeader: m_row="
   //          << m_row << std::endl;
 
   if (m_row.empty())
   {
-    m_state = STATE_REQ_COMPLETE;
-    return;
+    if (findHeader(m_req.headers, "Transfer-Encoding") != nullptr)
+    {
+      std::cerr << "*** ERROR: HTTP request content with a transfer encoding "
+                   "is not supported" << std::endl;
+      return false;
+    }
+    m_content_left = 0;
+    const std::string* content_len = findHeader(m_req.headers,
+                                                "Content-Length");
+    if (content_len != nullptr)
+    {
+      std::istringstream is(*content_len);
+      if (!(is >> m_content_left) || !is.eof() ||
+          (m_content_left > MAX_CONTENT_LEN))
+      {
+        std::cerr << "*** ERROR: Illegal HTTP content length \""
+                  << *content_len << "\"" << std::endl;
+        return false;
+      }
+    }
+    m_state = (m_content_left > 0) ? STATE_EXPECT_PAYLOAD : STATE_REQ_COMPLETE;
+    return true;
   }
 
   size_t colon = m_row.find(":");
   if (colon == std::string::npos)
   {
     std::cerr << "*** ERROR: Malformed HTTP header received" << std::endl;
-    disconnect();
-    return;
+    return false;
   }
   std::string key(m_row.substr(0, colon));
   size_t value_begin = m_row.find_first_not_of(" \t", colon+1);
@@ -405,8 +588,7 @@ void HttpServerConnection::handleHeader(void)
   if (value_begin == std::string::npos)
   {
     std::cerr << "*** ERROR: Malformed HTTP header value received" << std::endl;
-    disconnect();
-    return;
+    return false;
   }
   std::string value(m_row.substr(value_begin, value_end-value_begin+1));
 
@@ -414,9 +596,44 @@ void HttpServerConnection::handleHeader(void)
   //          << key << " value=" << value << std::endl;
 
   m_req.headers[key] = value;
+  return true;
 } /* HttpServerConnection::handleHeader */
 
 
+bool HttpServerConnection::requestComplete(void)
+{
+  if (m_pending.size() >= MAX_PENDING)
+  {
+    std::cerr << "*** ERROR: Too many pipelined HTTP requests" << std::endl;
+    return false;
+  }
+
+  PendingResponse pr;
+  pr.chunked_ok = (m_req.ver_major > 1) ||
+                  ((m_req.ver_major == 1) && (m_req.ver_minor >= 1));
+  if (pr.chunked_ok)
+  {
+    pr.keep_alive = !headerHasToken(m_req.headers, "Connection", "close");
+  }
+  else
+  {
+    pr.keep_alive = headerHasToken(m_req.headers, "Connection", "keep-alive");
+  }
+  pr.keep_alive = pr.keep_alive && (m_keep_alive_timeout > 0);
+  pr.coding = selectCoding(m_req.headers);
+  m_pending.push_back(pr);
+
+    // No more requests are read if the connection is to be closed after
+    // the response
+  m_state = pr.keep_alive ? STATE_EXPECT_START_LINE : STATE_REQ_COMPLETE;
+
+  Request req;
+  req = std::move(m_req);
+  requestReceived(this, req);
+  return true;
+} /* HttpServerConnection::requestComplete */
+
+
 #if 0
 void HttpServerConnection::onSendBufferFull(bool is_full)
 {
@@ -453,15 +670,48 @@ void HttpServerConnection::disconnectCleanup(void)
   m_state = STATE_DISCONNECTED;
   m_row.clear();
   m_req.clear();
+  m_content_left = 0;
+  m_chunked = false;
+  m_in_chunked = false;
+  m_pending.clear();
+  m_close_when_sent = false;
+  m_idle_timer.setEnable(false);
 } /* HttpServerConnection::disconnectCleanup */
 
 
+void HttpServerConnection::responseSent(void)
+{
+  m_idle_timer.reset();
+  if (m_close_when_sent && (writeQueueBytes() == 0))
+  {
+    onWriteQueueEmpty();
+  }
+} /* HttpServerConnection::responseSent */
+
+
+void HttpServerConnection::onIdleTimeout(Timer* t)
+{
+    // Do not close the connection while a response is outstanding
+  if (!m_pending.empty() || m_in_chunked || m_close_when_sent)
+  {
+    m_idle_timer.setEnable(true);
+    return;
+  }
+  closeConnection();
+  onDisconnected(DR_ORDERED_DISCONNECT);
+} /* HttpServerConnection::onIdleTimeout */
+
+
 const char* HttpServerConnection::codeToString(unsigned code)
 {
   switch (code)
   {
     case 200:
       return "OK";
+    case 304:
+      return "Not Modified";
+    case 400:
+      return "Bad Request";
     case 404:
       return "Not Found";
     case 406:
@@ -474,6 +724,135 @@ const char* HttpServerConnection::codeToString(unsigned code)
 } /* HttpServerConnection::codeToString */
 
 
+const std::string* HttpServerConnection::findHeader(const Headers& headers,
+                                                    const char* name)
+{
+    // HTTP header names are case insensitive
+  for (const auto& header : headers)
+  {
+    if (strcasecmp(header.first.c_str(), name) == 0)
+    {
+      return &header.second;
+    }
+  }
+  return nullptr;
+} /* HttpServerConnection::findHeader */
+
+
+bool HttpServerConnection::headerHasToken(const Headers& headers,
+                                          const char* name, const char* token)
+{
+  const std::string* value = findHeader(headers, name);
+  if (value == nullptr)
+  {
+    return false;
+  }
+  std::istringstream is(*value);
+  std::string item;
+  while (std::getline(is, item, ','))
+  {
+    size_t begin = item.find_first_not_of(" \t");
+    size_t end = item.find_last_not_of(" \t");
+    if ((begin != std::string::npos) &&
+        (strcasecmp(item.substr(begin, end-begin+1).c_str(), token) == 0))
+    {
+      return true;
+    }
+  }
+  return false;
+} /* HttpServerConnection::headerHasToken */
+
+
+HttpServerConnection::ContentCoding HttpServerConnection::selectCoding(
+    const Headers& headers)
+{
+#ifdef HAS_ZLIB
+  const std::string* value = findHeader(headers, "Accept-Encoding");
+  if (value == nullptr)
+  {
+    return CODING_IDENTITY;
+  }
+  bool gzip_ok = false;
+  bool deflate_ok = false;
+  std::istringstream is(*value);
+  std::string item;
+  while (std::getline(is, item, ','))
+  {
+    std::string params;
+    size_t semicolon = item.find(';');
+    if (semicolon != std::string::npos)
+    {
+      params = item.substr(semicolon+1);
+      item.erase(semicolon);
+    }
+    size_t begin = item.find_first_not_of(" \t");
+    size_t end = item.find_last_not_of(" \t");
+    if (begin == std::string::npos)
+    {
+      continue;
+    }
+    item = item.substr(begin, end-begin+1);
+
+      // A quality value of zero mean "not acceptable"
+    size_t qpos = params.find("q=");
+    if ((qpos != std::string::npos) &&
+        (atof(params.c_str() + qpos + 2) <= 0.0))
+    {
+      continue;
+    }
+
+    if ((strcasecmp(item.c_str(), "gzip") == 0) ||
+        (strcasecmp(item.c_str(), "x-gzip") == 0) || (item == "*"))
+    {
+      gzip_ok = true;
+    }
+    else if (strcasecmp(item.c_str(), "deflate") == 0)
+    {
+      deflate_ok = true;
+    }
+  }
+  if (gzip_ok)
+  {
+    return CODING_GZIP;
+  }
+  if (deflate_ok)
+  {
+    return CODING_DEFLATE;
+  }
+#endif
+  return CODING_IDENTITY;
+} /* HttpServerConnection::selectCoding */
+
+
+bool HttpServerConnection::compress(ContentCoding coding,
+                                    const std::string& in, std::string& out)
+{
+#ifdef HAS_ZLIB
+    // Add 16 to the window bits to get a gzip header instead of a zlib
+    // header. The "deflate" content coding use the zlib format.
+  const int window_bits = (coding == CODING_GZIP) ? (15 + 16) : 15;
+  z_stream zs;
+  memset(&zs, 0, sizeof(zs));
+  if (deflateInit2(&zs, Z_DEFAULT_COMPRESSION, Z_DEFLATED, window_bits, 8,
+                   Z_DEFAULT_STRATEGY) != Z_OK)
+  {
+    return false;
+  }
+  out.resize(deflateBound(&zs, in.size()));
+  zs.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(in.data()));
+  zs.avail_in = in.size();
+  zs.next_out = reinterpret_cast<Bytef*>(&out[0]);
+  zs.avail_out = out.size();
+  const int ret = deflate(&zs, Z_FINISH);
+  out.resize(zs.total_out);
+  deflateEnd(&zs);
+  return (ret == Z_STREAM_END) && (out.size() < in.size());
+#else
+  return false;
+#endif
+} /* HttpServerConnection::compress */
+
+
 /*
  * This file has not been truncated
  */
@@ -6,7 +6,7 @@
 
 \verbatim
 Async - A library for programming event driven applications
-Copyright (C) 2003-2024 Tobias Blomberg / SM0SVX
+Copyright (C) 2003-2026 Tobias Blomberg / SM0SVX
 
 This program is free software; you can redistribute it and/or modify
 it under the terms of the GNU General Public License as published by
@@ -54,6 +54,7 @@ An example of how to use the HttpServerConnection class in a client
  ****************************************************************************/
 
 #include <AsyncTcpConnection.h>
+#include <AsyncTimer.h>
 
 
 /****************************************************************************
@@ -120,6 +121,19 @@ namespace Async
 This class implement a VERY simple HTTP server side connection. It can be used
 together with the Async::TcpServer class to build a HTTP server.
 
+Persistent connections are supported so a client may send many requests on
+the same connection. Requests may also be pipelined, that is sent before the
+response to the previous request has been received. The requestReceived
+signal is emitted once for each request and the responses must be written in
+the same order as the requests were received. The connection is closed after
+the response has been sent if the client asked for it, if the client use
+HTTP/1.0 without asking for keep-alive or when the connection has been idle
+for longer than the keep-alive timeout.
+
+If the library was built with zlib support, response content larger than the
+compression threshold is compressed using gzip or deflate if the client
+accept one of those content codings.
+
 WARNING: This implementation is not suitable to be exposed to the public
 Internet. It contains a number of security flaws and probably also
 incompatibilities. Only use this class with known clients.
@@ -137,6 +151,7 @@ class HttpServerConnection : public TcpConnection
       unsigned ver_major;
       unsigned ver_minor;
       Headers headers;
+      std::string content;
 
       Request(void)
       {
@@ -151,6 +166,7 @@ class HttpServerConnection : public TcpConnection
         ver_major = 0;
         ver_minor = 0;
         headers.clear();
+        content.clear();
       }
 
       Request& operator=(Request&& other)
@@ -160,6 +176,7 @@ class HttpServerConnection : public TcpConnection
         ver_major = other.ver_major;
         ver_minor = other.ver_minor;
         headers = std::move(other.headers);
+        content = std::move(other.content);
         other.clear();
         return *this;
       }
@@ -211,6 +228,16 @@ class HttpServerConnection : public TcpConnection
         bool        m_send_content;
     };
 
+    /**
+     * @brief The default time a connection may be idle before it is closed
+     */
+    static const unsigned DEFAULT_KEEP_ALIVE_TIMEOUT = 30000;
+
+    /**
+     * @brief The default minimum content size for compression to be used
+     */
+    static const size_t DEFAULT_COMPRESS_THRESHOLD = 1024;
+
     /**
      * @brief   Constructor
      * @param   recv_buf_len  The length of the receiver buffer to use
@@ -244,15 +271,45 @@ class HttpServerConnection : public TcpConnection
      */
     virtual TcpConnection& operator=(TcpConnection&& other_base) override;
 
+    /**
+     * @brief   Set the keep-alive timeout
+     * @param   timeout_ms The timeout in milliseconds
+     *
+     * A connection that has been idle for longer than the given time will be
+     * closed. Setting the timeout to zero disable persistent connections so
+     * that the connection is closed after each response.
+     */
+    void setKeepAliveTimeout(unsigned timeout_ms);
+
+    /**
+     * @brief   Set the minimum content size for compression to be used
+     * @param   threshold The size in bytes, zero to disable compression
+     */
+    void setCompressThreshold(size_t threshold)
+    {
+      m_compress_threshold = threshold;
+    }
+
     /**
      * @brief   Send data with chunked transfer encoding
      *
-     * Calling this function will enable data to be sent in chunks. The
-     * "Transfer-encoding: chunked" will be set in the header and each call to
-     * write() will send a chunk.
+     * Calling this function will make the next response be sent in chunks.
+     * The "Transfer-encoding: chunked" will be set in the header and each
+     * call to write() will send a chunk. The response is ended by calling
+     * endChunked(). If the client use HTTP/1.0 the data is sent without
+     * chunk framing and the connection is closed when the response ends.
      */
     void setChunked(void) { m_chunked = true; }
 
+    /**
+     * @brief   End a chunked response
+     * @return  Return \em true on success or else \em false
+     *
+     * Send the last chunk of a response started after calling setChunked().
+     * After this, the next response can be written.
+     */
+    bool endChunked(void);
+
     /**
      * @brief   Send a HTTP response
      * @param   res The response (@see Response)
@@ -267,8 +324,9 @@ class HttpServerConnection : public TcpConnection
      * @return  Return \em true on success or else \em false
      *
      * If chunked mode has been set a chunked header and trailer will be added
-     * to the data. If not in chunked mode, the raw buffer will be sent without
-     * modification.
+     * to the data. An empty buffer is not sent since that would end the
+     * response, use endChunked() for that. If not in chunked mode, the raw
+     * buffer will be sent without modification.
      */
     virtual bool write(const char* buf, int len);
 
@@ -323,6 +381,14 @@ class HttpServerConnection : public TcpConnection
      */
     virtual int onDataReceived(void *buf, int count) override;
 
+    /**
+     * @brief   Called when all queued data has been sent
+     *
+     * If the connection should be closed after the last response, this is
+     * where it happen.
+     */
+    virtual void onWriteQueueEmpty(void) override;
+
     /**
      * @brief   Emit the disconnected signal
      * @param   reason The reason for the disconnection
@@ -338,20 +404,53 @@ class HttpServerConnection : public TcpConnection
       STATE_DISCONNECTED, STATE_EXPECT_START_LINE, STATE_EXPECT_HEADER,
       STATE_EXPECT_PAYLOAD, STATE_REQ_COMPLETE
     };
+    enum ContentCoding
+    {
+      CODING_IDENTITY, CODING_GZIP, CODING_DEFLATE
+    };
+    struct PendingResponse
+    {
+      bool          keep_alive  {true};
+      bool          chunked_ok  {true};
+      ContentCoding coding      {CODING_IDENTITY};
+    };
 
-    State                   m_state;
-    std::string             m_row;
-    Request                 m_req;
-    bool                    m_chunked;
+    static const size_t MAX_ROW_LEN         = 8192;
+    static const size_t MAX_CONTENT_LEN     = 65536;
+    static const size_t MAX_PENDING         = 32;
+
+    State                       m_state;
+    std::string                 m_row;
+    Request                     m_req;
+    size_t                      m_content_left        {0};
+    bool                        m_chunked;
+    bool                        m_chunk_framed        {false};
+    bool                        m_chunk_keep_alive    {true};
+    bool                        m_in_chunked          {false};
+    std::deque<PendingResponse> m_pending;
+    bool                        m_close_when_sent     {false};
+    size_t                      m_compress_threshold;
+    unsigned                    m_keep_alive_timeout;
+    Timer                       m_idle_timer;
 
     HttpServerConnection(const HttpServerConnection&);
     HttpServerConnection& operator=(const HttpServerConnection&);
     using TcpConnection::write;
-    void handleStartLine(void);
-    void handleHeader(void);
+    bool handleStartLine(void);
+    bool handleHeader(void);
+    bool requestComplete(void);
     //void onSendBufferFull(bool is_full);
     void disconnectCleanup(void);
+    void responseSent(void);
+    void onIdleTimeout(Timer* t);
     const char* codeToString(unsigned code);
+    static const std::string* findHeader(const Headers& headers,
+                                         const char* name);
+    static bool headerHasToken(const Headers& headers, const char* name,
+                               const char* token);
+    static ContentCoding selectCoding(const Headers& headers);
+    static bool compress(ContentCoding coding, const std::string& in,
+                         std::string& out);
 
 };  /* class HttpServerConnection */
 
@@ -39,6 +39,8 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 
 #include <netinet/in.h>
 
+#include <cstdint>
+#include <functional>
 #include <string>
 #include <iostream>
 
@@ -265,6 +267,23 @@ std::istream& operator>>(std::istream& is, IpAddress& ip);
 } /* namespace */
 
 
+/**
+@brief  Hash function making it possible to use IpAddress as a key in
+        unordered containers
+*/
+namespace std
+{
+  template <>
+  struct hash<Async::IpAddress>
+  {
+    size_t operator()(const Async::IpAddress& ip) const
+    {
+      return std::hash<uint32_t>()(ip.ip4Addr().s_addr);
+    }
+  };
+} /* namespace std */
+
+
 #endif /* ASYNC_IP_ADDRESS_INCLUDED */
 
 
@@ -21,8 +21,11 @@ class MsgBase : public Async::Msg
 \endcode
 
 The most common types may be packed, like number types, std::string,
-std::vector, std::map. Adding new types are rather simple. This is an example
-implementing support for the std::pair type:
+std::vector, std::map. Adding new types are rather simple. The pack and unpack
+functions are templates on the stream type so that the same code is used both
+when packing to a std::ostream and when packing directly into a byte buffer
+using Async::MsgBufWriter/Async::MsgBufReader. This is an example implementing
+support for the std::pair type:
 
 \code{.cpp}
 namespace Async
@@ -31,7 +34,8 @@ namespace Async
   class MsgPacker<std::pair<First, Second> >
   {
     public:
-      static bool pack(std::ostream& os, const std::pair<First, Second>& p)
+      template <typename OS>
+      static bool pack(OS& os, const std::pair<First, Second>& p)
       {
         return MsgPacker<First>::pack(os, p.first) &&
                MsgPacker<Second>::pack(os, p.second);
@@ -41,7 +45,8 @@ namespace Async
         return MsgPacker<First>::packedSize(p.first) +
                MsgPacker<Second>::packedSize(p.second);
       }
-      static bool unpack(std::istream& is, std::pair<First, Second>& p)
+      template <typename IS>
+      static bool unpack(IS& is, std::pair<First, Second>& p)
       {
         return MsgPacker<First>::unpack(is, p.first) &&
                MsgPacker<Second>::unpack(is, p.second);
@@ -86,6 +91,21 @@ MsgDerived d2;
 d2.unpack(ss);
 \endcode
 
+When performance matters, e.g. in the audio path of a network protocol, the
+message can be packed straight into a preallocated buffer and unpacked in
+place, without involving any stream objects. The resulting bytes are exactly
+the same as when using streams.
+
+\code{.cpp}
+std::vector<uint8_t> buf(d1.packedSize());
+Async::MsgBufWriter w(buf.data(), buf.size());
+d1.pack(w);
+
+MsgDerived d3;
+Async::MsgBufReader r(buf.data(), w.size());
+d3.unpack(r);
+\endcode
+
 For a working example, have a look at the demo application,
 \ref AsyncMsg_demo.cpp.
 
@@ -131,6 +151,8 @@ An example of how to use the AsyncMsg class
 #include <set>
 #include <map>
 #include <limits>
+#include <algorithm>
+#include <cstring>
 #include <endian.h>
 #include <stdint.h>
 
@@ -191,7 +213,8 @@ namespace Async
  * class. Multiple inheritance is not supported.
  */
 #define ASYNC_MSG_DERIVED_FROM(BASE_CLASS) \
-    bool packParent(std::ostream& os) const \
+    template <typename OS> \
+    bool packParent(OS& os) const \
     { \
       return BASE_CLASS::pack(os); \
     } \
@@ -199,7 +222,8 @@ namespace Async
     { \
       return BASE_CLASS::packedSize(); \
     } \
-    bool unpackParent(std::istream& is) \
+    template <typename IS> \
+    bool unpackParent(IS& is) \
     { \
       return BASE_CLASS::unpack(is); \
     }
@@ -216,11 +240,19 @@ namespace Async
     { \
       return packParent(os) && Msg::pack(os, __VA_ARGS__); \
     } \
+    bool pack(Async::MsgBufWriter& os) const override \
+    { \
+      return packParent(os) && Msg::pack(os, __VA_ARGS__); \
+    } \
     size_t packedSize(void) const override \
     { \
       return packedSizeParent() + Msg::packedSize(__VA_ARGS__); \
     } \
     bool unpack(std::istream& is) override \
+    { \
+      return unpackParent(is) && Msg::unpack(is, __VA_ARGS__); \
+    } \
+    bool unpack(Async::MsgBufReader& is) override \
     { \
       return unpackParent(is) && Msg::unpack(is, __VA_ARGS__); \
     }
@@ -235,8 +267,16 @@ namespace Async
     { \
       return packParent(os); \
     } \
+    bool pack(Async::MsgBufWriter& os) const override \
+    { \
+      return packParent(os); \
+    } \
     size_t packedSize(void) const override { return packedSizeParent(); } \
     bool unpack(std::istream& is) override \
+    { \
+      return unpackParent(is); \
+    } \
+    bool unpack(Async::MsgBufReader& is) override \
     { \
       return unpackParent(is); \
     }
@@ -256,26 +296,187 @@ namespace Async
  *
  ****************************************************************************/
 
+/**
+@brief  Pack messages straight into a preallocated byte buffer
+@author Tobias Blomberg / SM0SVX
+@date   2026-10-14
+
+This class can be used instead of a std::ostream when packing a message. The
+data is written directly into the given buffer, which must be large enough to
+hold the packed message. Use the packedSize function of the message to find
+out how large the buffer need to be. The encoding is exactly the same as when
+packing to a stream.
+
+\code{.cpp}
+std::vector<uint8_t> buf(msg.packedSize());
+Async::MsgBufWriter w(buf.data(), buf.size());
+if (msg.pack(w))
+{
+  send(buf.data(), w.size());
+}
+\endcode
+*/
+class MsgBufWriter
+{
+  public:
+    /**
+     * @brief   Constructor
+     * @param   buf   The buffer to write to
+     * @param   size  The size of the buffer
+     */
+    MsgBufWriter(void* buf, size_t size)
+      : m_buf(static_cast<char*>(buf)), m_size(size) {}
+
+    /**
+     * @brief   Write data to the buffer
+     * @param   data  The data to write
+     * @param   count The number of bytes to write
+     * @return  Returns a reference to this object
+     *
+     * If the data does not fit in the buffer, nothing is written and the
+     * writer enters a failed state.
+     */
+    MsgBufWriter& write(const char* data, size_t count)
+    {
+      if (!m_good || (count > m_size - m_pos))
+      {
+        m_good = false;
+        return *this;
+      }
+      std::memcpy(m_buf + m_pos, data, count);
+      m_pos += count;
+      return *this;
+    }
+
+    /**
+     * @brief   Check if all writes so far have succeeded
+     * @return  Returns \em true if no write has failed
+     */
+    bool good(void) const { return m_good; }
+    explicit operator bool(void) const { return m_good; }
+
+    /**
+     * @brief   Get the number of bytes written
+     * @return  Returns the number of bytes written so far
+     */
+    size_t size(void) const { return m_pos; }
+
+    /**
+     * @brief   Get a pointer to the start of the buffer
+     * @return  Returns the buffer pointer given in the constructor
+     */
+    const char* data(void) const { return m_buf; }
+
+  private:
+    char*   m_buf;
+    size_t  m_size;
+    size_t  m_pos   = 0;
+    bool    m_good  = true;
+};  /* class MsgBufWriter */
+
+
+/**
+@brief  Unpack messages directly from a byte buffer
+@author Tobias Blomberg / SM0SVX
+@date   2026-10-14
+
+This class can be used instead of a std::istream when unpacking a message. The
+data is read directly from the given buffer so there is no need to first copy
+it into a stringstream. The buffer must be kept alive while reading.
+*/
+class MsgBufReader
+{
+  public:
+    /**
+     * @brief   Constructor
+     * @param   buf   The buffer to read from
+     * @param   size  The number of bytes in the buffer
+     */
+    MsgBufReader(const void* buf, size_t size)
+      : m_buf(static_cast<const char*>(buf)), m_size(size) {}
+
+    /**
+     * @brief   Read data from the buffer
+     * @param   data  The buffer to write the read data to
+     * @param   count The number of bytes to read
+     * @return  Returns a reference to this object
+     *
+     * If there is not enough data left in the buffer, nothing is read and the
+     * reader enters a failed state.
+     */
+    MsgBufReader& read(char* data, size_t count)
+    {
+      if (!m_good || (count > m_size - m_pos))
+      {
+        m_good = false;
+        return *this;
+      }
+      std::memcpy(data, m_buf + m_pos, count);
+      m_pos += count;
+      return *this;
+    }
+
+    /**
+     * @brief   Check if all reads so far have succeeded
+     * @return  Returns \em true if no read has failed
+     */
+    bool good(void) const { return m_good; }
+    explicit operator bool(void) const { return m_good; }
+
+    /**
+     * @brief   Set the read position and clear the failed state
+     * @param   pos The new read position
+     */
+    void seek(size_t pos)
+    {
+      m_pos = std::min(pos, m_size);
+      m_good = true;
+    }
+
+    /**
+     * @brief   Get the current read position
+     * @return  Returns the number of bytes read so far
+     */
+    size_t pos(void) const { return m_pos; }
+
+    /**
+     * @brief   Get the number of bytes left to read
+     * @return  Returns the number of unread bytes
+     */
+    size_t remaining(void) const { return m_size - m_pos; }
+
+  private:
+    const char* m_buf;
+    size_t      m_size;
+    size_t      m_pos   = 0;
+    bool        m_good  = true;
+};  /* class MsgBufReader */
+
+
 template <typename T>
 class MsgPacker
 {
   public:
-    static bool pack(std::ostream& os, const T& val) { return val.pack(os); }
+    template <typename OS>
+    static bool pack(OS& os, const T& val) { return val.pack(os); }
     static size_t packedSize(const T& val) { return val.packedSize(); }
-    static bool unpack(std::istream& is, T& val) { return val.unpack(is); }
+    template <typename IS>
+    static bool unpack(IS& is, T& val) { return val.unpack(is); }
 };
 
 template <>
 class MsgPacker<char>
 {
   public:
-    static bool pack(std::ostream& os, char val)
+    template <typename OS>
+    static bool pack(OS& os, char val)
     {
       //std::cout << "pack<char>("<< int(val) << ")" << std::endl;
       return os.write(&val, 1).good();
     }
     static size_t packedSize(const char& val) { return sizeof(char); }
-    static bool unpack(std::istream& is, char& val)
+    template <typename IS>
+    static bool unpack(IS& is, char& val)
     {
       is.read(&val, 1);
       //std::cout << "unpack<char>(" << int(val) << ")" << std::endl;
@@ -287,7 +488,8 @@ template <typename T>
 class Packer64
 {
   public:
-    static bool pack(std::ostream& os, const T& val)
+    template <typename OS>
+    static bool pack(OS& os, const T& val)
     {
       //std::cout << "pack<64>(" << val << ")" << std::endl;
       Overlay o;
@@ -296,7 +498,8 @@ class Packer64
       return os.write(o.buf, sizeof(T)).good();
     }
     static size_t packedSize(const T& val) { return sizeof(T); }
-    static bool unpack(std::istream& is, T& val)
+    template <typename IS>
+    static bool unpack(IS& is, T& val)
     {
       Overlay o;
       is.read(o.buf, sizeof(T));
@@ -321,7 +524,8 @@ template <typename T>
 class Packer32
 {
   public:
-    static bool pack(std::ostream& os, const T& val)
+    template <typename OS>
+    static bool pack(OS& os, const T& val)
     {
       //std::cout << "pack<32>(" << val << ")" << std::endl;
       Overlay o;
@@ -330,7 +534,8 @@ class Packer32
       return os.write(o.buf, sizeof(T)).good();
     }
     static size_t packedSize(const T& val) { return sizeof(T); }
-    static bool unpack(std::istream& is, T& val)
+    template <typename IS>
+    static bool unpack(IS& is, T& val)
     {
       Overlay o;
       is.read(o.buf, sizeof(T));
@@ -355,7 +560,8 @@ template <typename T>
 class Packer16
 {
   public:
-    static bool pack(std::ostream& os, const T& val)
+    template <typename OS>
+    static bool pack(OS& os, const T& val)
     {
       //std::cout << "pack<16>(" << val << ")" << std::endl;
       Overlay o;
@@ -364,7 +570,8 @@ class Packer16
       return os.write(o.buf, sizeof(T)).good();
     }
     static size_t packedSize(const T& val) { return sizeof(T); }
-    static bool unpack(std::istream& is, T& val)
+    template <typename IS>
+    static bool unpack(IS& is, T& val)
     {
       Overlay o;
       is.read(o.buf, sizeof(T));
@@ -388,13 +595,15 @@ template <typename T>
 class Packer8
 {
   public:
-    static bool pack(std::ostream& os, const T& val)
+    template <typename OS>
+    static bool pack(OS& os, const T& val)
     {
       //std::cout << "pack<8>(" << int(val) << ")" << std::endl;
       return os.write(reinterpret_cast<const char*>(&val), sizeof(T)).good();
     }
     static size_t packedSize(const T& val) { return sizeof(T); }
-    static bool unpack(std::istream& is, T& val)
+    template <typename IS>
+    static bool unpack(IS& is, T& val)
     {
       is.read(reinterpret_cast<char*>(&val), sizeof(T));
       //std::cout << "unpack<8>(" << int(val) << ")" << std::endl;
@@ -408,7 +617,8 @@ template <>
 class MsgPacker<std::string>
 {
   public:
-    static bool pack(std::ostream& os, const std::string& val)
+    template <typename OS>
+    static bool pack(OS& os, const std::string& val)
     {
       //std::cout << "pack<string>(" << val << ")" << std::endl;
       if (val.size() > std::numeric_limits<uint16_t>::max())
@@ -423,7 +633,8 @@ class MsgPacker<std::string>
     {
       return sizeof(uint16_t) + val.size();
     }
-    static bool unpack(std::istream& is, std::string& val)
+    template <typename IS>
+    static bool unpack(IS& is, std::string& val)
     {
       uint16_t str_len;
       if (MsgPacker<uint16_t>::unpack(is, str_len))
@@ -448,7 +659,8 @@ template <typename I>
 class MsgPacker<std::vector<I>>
 {
   public:
-    static bool pack(std::ostream& os, const std::vector<I>& vec)
+    template <typename OS>
+    static bool pack(OS& os, const std::vector<I>& vec)
     {
       //std::cout << "pack<vector>(" << vec.size() << ")" << std::endl;
       if (vec.size() > std::numeric_limits<uint16_t>::max())
@@ -474,7 +686,8 @@ class MsgPacker<std::vector<I>>
       }
       return size;
     }
-    static bool unpack(std::istream& is, std::vector<I>& vec)
+    template <typename IS>
+    static bool unpack(IS& is, std::vector<I>& vec)
     {
       uint16_t vec_size;
       MsgPacker<uint16_t>::unpack(is, vec_size);
@@ -499,7 +712,8 @@ template <typename I>
 class MsgPacker<std::set<I>>
 {
   public:
-    static bool pack(std::ostream& os, const std::set<I>& s)
+    template <typename OS>
+    static bool pack(OS& os, const std::set<I>& s)
     {
       //std::cout << "pack<set>(" << s.size() << ")" << std::endl;
       if (s.size() > std::numeric_limits<uint16_t>::max())
@@ -528,7 +742,8 @@ class MsgPacker<std::set<I>>
       }
       return size;
     }
-    static bool unpack(std::istream& is, std::set<I>& s)
+    template <typename IS>
+    static bool unpack(IS& is, std::set<I>& s)
     {
       uint16_t set_size;
       if (!MsgPacker<uint16_t>::unpack(is, set_size))
@@ -558,7 +773,8 @@ template <typename Tag, typename Value>
 class MsgPacker<std::map<Tag,Value>>
 {
   public:
-    static bool pack(std::ostream& os, const std::map<Tag, Value>& m)
+    template <typename OS>
+    static bool pack(OS& os, const std::map<Tag, Value>& m)
     {
       //std::cout << "pack<map>(" << m.size() << ")" << std::endl;
       if (m.size() > std::numeric_limits<uint16_t>::max())
@@ -583,7 +799,8 @@ class MsgPacker<std::map<Tag,Value>>
       }
       return size;
     }
-    static bool unpack(std::istream& is, std::map<Tag,Value>& m)
+    template <typename IS>
+    static bool unpack(IS& is, std::map<Tag,Value>& m)
     {
       uint16_t map_size;
       MsgPacker<uint16_t>::unpack(is, map_size);
@@ -609,7 +826,8 @@ template <typename T, size_t N>
 class MsgPacker<std::array<T, N>>
 {
   public:
-    static bool pack(std::ostream& os, const std::array<T, N>& vec)
+    template <typename OS>
+    static bool pack(OS& os, const std::array<T, N>& vec)
     {
       for (const auto& item : vec)
       {
@@ -629,7 +847,8 @@ class MsgPacker<std::array<T, N>>
       }
       return size;
     }
-    static bool unpack(std::istream& is, std::array<T, N>& vec)
+    template <typename IS>
+    static bool unpack(IS& is, std::array<T, N>& vec)
     {
       for (auto& item : vec)
       {
@@ -645,7 +864,8 @@ class MsgPacker<std::array<T, N>>
 template <typename T, size_t N> class MsgPacker<T[N]>
 {
   public:
-    static bool pack(std::ostream& os, const T (&vec)[N])
+    template <typename OS>
+    static bool pack(OS& os, const T (&vec)[N])
     {
       for (const auto& item : vec)
       {
@@ -665,7 +885,8 @@ template <typename T, size_t N> class MsgPacker<T[N]>
       }
       return size;
     }
-    static bool unpack(std::istream& is, T (&vec)[N])
+    template <typename IS>
+    static bool unpack(IS& is, T (&vec)[N])
     {
       for (auto& item : vec)
       {
@@ -689,16 +910,20 @@ class Msg
   public:
     virtual ~Msg(void) {}
 
-    bool packParent(std::ostream&) const { return true; }
+    template <typename OS>
+    bool packParent(OS&) const { return true; }
     size_t packedSizeParent(void) const { return 0; }
-    bool unpackParent(std::istream&) { return true; }
+    template <typename IS>
+    bool unpackParent(IS&) { return true; }
 
     virtual bool pack(std::ostream&) const { return true; }
+    virtual bool pack(MsgBufWriter&) const { return true; }
     virtual size_t packedSize(void) const { return 0; }
     virtual bool unpack(std::istream&) { return true; }
+    virtual bool unpack(MsgBufReader&) { return true; }
 
-    template <typename T>
-    bool pack(std::ostream& os, const T& val) const
+    template <typename OS, typename T>
+    bool pack(OS& os, const T& val) const
     {
       return MsgPacker<T>::pack(os, val);
     }
@@ -707,15 +932,14 @@ class Msg
     {
       return MsgPacker<T>::packedSize(val);
     }
-    template <typename T>
-    bool unpack(std::istream& is, T& val) const
+    template <typename IS, typename T>
+    bool unpack(IS& is, T& val) const
     {
       return MsgPacker<T>::unpack(is, val);
     }
 
-    template <typename T1, typename T2, typename... Args>
-    bool pack(std::ostream& os, const T1& v1, const T2& v2,
-              const Args&... args) const
+    template <typename OS, typename T1, typename T2, typename... Args>
+    bool pack(OS& os, const T1& v1, const T2& v2, const Args&... args) const
     {
       return pack(os, v1) && pack(os, v2, args...);
     }
@@ -724,8 +948,8 @@ class Msg
     {
       return packedSize(v1) + packedSize(v2, args...);
     }
-    template <typename T1, typename T2, typename... Args>
-    bool unpack(std::istream& is, T1& v1, T2& v2, Args&... args)
+    template <typename IS, typename T1, typename T2, typename... Args>
+    bool unpack(IS& is, T1& v1, T2& v2, Args&... args)
     {
       return unpack(is, v1) && unpack(is, v2, args...);
     }
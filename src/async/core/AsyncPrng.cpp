@@ -0,0 +1,210 @@
+/**
+@file   AsyncPrng.cpp
+@brief  A fast pseudo random number generator for signal simulation
+@author Tobias Blomberg / SM0SVX
+@date   2026-10-14
+
+\verbatim
+Async - A library for programming event driven applications
+Copyright (C) 2003-2026 Tobias Blomberg / SM0SVX
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+\endverbatim
+*/
+
+/****************************************************************************
+ *
+ * System Includes
+ *
+ ****************************************************************************/
+
+#include <cmath>
+
+
+/****************************************************************************
+ *
+ * Project Includes
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Local Includes
+ *
+ ****************************************************************************/
+
+#include "AsyncPrng.h"
+
+
+/****************************************************************************
+ *
+ * Namespaces to use
+ *
+ ****************************************************************************/
+
+using namespace Async;
+
+
+/****************************************************************************
+ *
+ * Defines & typedefs
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Local class definitions
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Prototypes
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Exported Global Variables
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Local Global Variables
+ *
+ ****************************************************************************/
+
+namespace {
+  const float TWO_PI = 6.28318530717958647692f;
+
+    // Convert the upper 24 bits to a float in the range (0, 1]. Zero must be
+    // avoided since the logarithm is taken in the Box-Muller transform.
+  inline float toUnitOpen(uint32_t v)
+  {
+    return ((v >> 8) + 1) * (1.0f / 16777216.0f);
+  }
+};
+
+
+/****************************************************************************
+ *
+ * Public member functions
+ *
+ ****************************************************************************/
+
+void Prng::setSeed(uint64_t seed)
+{
+  for (size_t i=0; i<LANES; ++i)
+  {
+    for (size_t j=0; j<4; j+=2)
+    {
+      seed += 0x9e3779b97f4a7c15ULL;
+      uint64_t z = seed;
+      z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+      z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+      z ^= z >> 31;
+      m_s[j][i] = static_cast<uint32_t>(z);
+      m_s[j+1][i] = static_cast<uint32_t>(z >> 32);
+    }
+      // An all zero state would only ever produce zeros
+    if ((m_s[0][i] | m_s[1][i] | m_s[2][i] | m_s[3][i]) == 0)
+    {
+      m_s[0][i] = 1;
+    }
+  }
+  m_pos = LANES;
+} /* Prng::setSeed */
+
+
+void Prng::fillUniform(float *dest, size_t count)
+{
+  uint32_t r[LANES];
+  while (count >= LANES)
+  {
+    step(r);
+    for (size_t i=0; i<LANES; ++i)
+    {
+      dest[i] = (r[i] >> 8) * (1.0f / 16777216.0f);
+    }
+    dest += LANES;
+    count -= LANES;
+  }
+  while (count-- > 0)
+  {
+    *dest++ = uniform();
+  }
+} /* Prng::fillUniform */
+
+
+void Prng::fillGaussian(float *dest, size_t count, float sigma, float mu)
+{
+    // Each Box-Muller transform produce two independent gaussian numbers
+    // from two uniform ones so each round yield 2 * LANES output values.
+  uint32_t r1[LANES];
+  uint32_t r2[LANES];
+  float out[2 * LANES];
+  while (count > 0)
+  {
+    step(r1);
+    step(r2);
+    for (size_t i=0; i<LANES; ++i)
+    {
+      const float mag = sigma * sqrtf(-2.0f * logf(toUnitOpen(r1[i])));
+      const float phi = TWO_PI * (r2[i] >> 8) * (1.0f / 16777216.0f);
+      out[i] = mag * cosf(phi) + mu;
+      out[LANES + i] = mag * sinf(phi) + mu;
+    }
+    const size_t n = (count < 2 * LANES) ? count : 2 * LANES;
+    for (size_t i=0; i<n; ++i)
+    {
+      dest[i] = out[i];
+    }
+    dest += n;
+    count -= n;
+  }
+} /* Prng::fillGaussian */
+
+
+
+/****************************************************************************
+ *
+ * Protected member functions
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Private member functions
+ *
+ ****************************************************************************/
+
+
+
+/*
+ * This file has not been truncated
+ */
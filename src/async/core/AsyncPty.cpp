@@ -6,7 +6,7 @@
 
 \verbatim
 Async - A library for programming event driven applications
-Copyright (C) 2003-2024 Tobias Blomberg / SM0SVX
+Copyright (C) 2003-2026 Tobias Blomberg / SM0SVX
 
 This program is free software; you can redistribute it and/or modify
 it under the terms of the GNU General Public License as published by
@@ -37,6 +37,9 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 #include <errno.h>
 #include <termios.h>
 #include <poll.h>
+#ifdef HAS_INOTIFY
+#include <sys/inotify.h>
+#endif
 
 #include <cstdlib>
 #include <cstring>
@@ -127,8 +130,14 @@ Pty::Pty(const std::string &slave_link)
   m_watch.activity.connect(
       sigc::hide(sigc::mem_fun(*this, &Pty::charactersReceived)));
   m_pollhup_timer.setEnable(false);
+  m_pollhup_timer.setSlack(POLLHUP_CHECK_INTERVAL);
+  m_pollhup_timer.setName("Pty::pollhup");
   m_pollhup_timer.expired.connect(
       sigc::hide(sigc::mem_fun(*this, &Pty::checkIfSlaveEndOpen)));
+  m_inotify_watch.activity.connect(
+      sigc::hide(sigc::mem_fun(*this, &Pty::inotifyActivity)));
+  m_tx_watch.activity.connect(
+      sigc::hide(sigc::mem_fun(*this, &Pty::writeQueued)));
 } /* Pty::Pty */
 
 
@@ -211,9 +220,26 @@ bool Pty::open(void)
 
   m_slave_path = slave_path;
 
+#ifdef HAS_INOTIFY
+    // Get notified when the slave end is opened instead of polling the
+    // master end. Fall back to polling if inotify cannot be used.
+  m_inotify_fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+  if ((m_inotify_fd >= 0) &&
+      (inotify_add_watch(m_inotify_fd, slave_path, IN_OPEN) < 0))
+  {
+    ::close(m_inotify_fd);
+    m_inotify_fd = -1;
+  }
+  if (m_inotify_fd >= 0)
+  {
+    m_inotify_watch.setFd(m_inotify_fd, Async::FdWatch::FD_WATCH_RD);
+  }
+#endif
+
   m_watch.setFd(m_master, Async::FdWatch::FD_WATCH_RD);
-  m_watch.setEnabled(false);
-  m_pollhup_timer.setEnable(true);
+  m_tx_watch.setFd(m_master, Async::FdWatch::FD_WATCH_WR);
+  m_tx_watch.setEnabled(false);
+  waitForSlaveOpen();
 
   return true;
 } /* Pty::open */
@@ -228,6 +254,15 @@ void Pty::close(void)
   m_slave_path = "";
   m_pollhup_timer.setEnable(false);
   m_watch.setEnabled(false);
+  m_inotify_watch.setEnabled(false);
+  discardQueued();
+  m_line_buffer.clear();
+  m_discard_line = false;
+  if (m_inotify_fd >= 0)
+  {
+    ::close(m_inotify_fd);
+    m_inotify_fd = -1;
+  }
   if (m_master >= 0)
   {
     ::close(m_master);
@@ -251,9 +286,41 @@ ssize_t Pty::write(const void *buf, size_t count)
 {
   if ((pollMaster() & POLLHUP) != 0)
   {
+    discardQueued();
     return count;
   }
-  return ::write(m_master, buf, count);
+
+  const char* ptr = static_cast<const char*>(buf);
+  size_t written = 0;
+  if (m_tx_buf.empty())
+  {
+    ssize_t ret = ::write(m_master, ptr, count);
+    if (ret < 0)
+    {
+      if (errno != EAGAIN)
+      {
+        return -1;
+      }
+      ret = 0;
+    }
+    written = ret;
+    m_stats.tx_bytes += written;
+  }
+
+    // Queue what could not be written directly rather than blocking on a
+    // slow reader
+  size_t remaining = count - written;
+  if (remaining > MAX_TX_QUEUE_SIZE - m_tx_buf.size())
+  {
+    m_stats.tx_dropped_bytes += remaining;
+    return written;
+  }
+  if (remaining > 0)
+  {
+    m_tx_buf.append(ptr + written, remaining);
+    m_tx_watch.setEnabled(true);
+  }
+  return count;
 } /* Pty::write */
 
 
@@ -281,11 +348,10 @@ void Pty::charactersReceived(void)
   short revent = pollMaster();
 
     // If the slave side is not open, stop watching the descriptor
-    // and start polling instead
+    // and wait for the slave side to be opened again
   if ((revent & POLLHUP) != 0)
   {
-    m_watch.setEnabled(false);
-    m_pollhup_timer.setEnable(true);
+    waitForSlaveOpen();
   }
 
     // If there is no data to read, bail out
@@ -294,46 +360,129 @@ void Pty::charactersReceived(void)
     return;
   }
 
-  char buf[256];
-  int rd = ::read(m_master, buf, sizeof(buf));
-  if (rd < 0)
+    // Keep reading as long as the buffer is filled so that a burst of
+    // commands is handled in one main loop iteration
+  char buf[4096];
+  const int master = m_master;
+  int rd = sizeof(buf);
+  while ((rd == sizeof(buf)) && (m_master == master))
   {
-    std::cerr << "*** ERROR: Failed to read master PTY: "
-              << std::strerror(errno) << ". Trying to reopen the PTY."
-              << std::endl;
-    reopen();
-    return;
-  }
-  else if (rd == 0)
-  {
-    reopen();
-    return;
+    rd = ::read(m_master, buf, sizeof(buf));
+    if (rd < 0)
+    {
+      if (errno == EAGAIN)
+      {
+        return;
+      }
+      std::cerr << "*** ERROR: Failed to read master PTY: "
+                << std::strerror(errno) << ". Trying to reopen the PTY."
+                << std::endl;
+      reopen();
+      return;
+    }
+    else if (rd == 0)
+    {
+      reopen();
+      return;
+    }
+
+    m_stats.rx_bytes += rd;
+    if (m_is_line_buffered)
+    {
+      processLines(buf, rd);
+    }
+    else
+    {
+      dataReceived(buf, rd);
+    }
   }
+} /* Pty::charactersReceived */
+
 
-  if (m_is_line_buffered)
+/**
+ * @brief   Split received data into lines and emit them
+ *
+ * Lines completely contained in the buffer are emitted directly from it. Only
+ * a partial line at the end is copied to the line buffer.
+ */
+void Pty::processLines(const char* buf, size_t len)
+{
+  size_t start = 0;
+  for (size_t i = 0; i < len; ++i)
   {
-    for (int i = 0; i < rd; ++i)
+    if ((buf[i] != '\r') && (buf[i] != '\n'))
     {
-      const char& ch = buf[i];
-      if ((ch == '\r') || (ch == '\n'))
-      {
-        if (!m_line_buffer.empty())
-        {
-          dataReceived(m_line_buffer.c_str(), m_line_buffer.size());
-          m_line_buffer.clear();
-        }
-      }
-      else
+      continue;
+    }
+    if (m_discard_line)
+    {
+      m_discard_line = false;
+    }
+    else if (m_line_buffer.empty())
+    {
+      if (i > start)
       {
-        m_line_buffer += ch;
+        ++m_stats.rx_lines;
+        dataReceived(buf + start, i - start);
       }
     }
+    else
+    {
+      m_line_buffer.append(buf + start, i - start);
+      ++m_stats.rx_lines;
+      dataReceived(m_line_buffer.c_str(), m_line_buffer.size());
+      m_line_buffer.clear();
+    }
+    start = i + 1;
   }
-  else
+
+  if (!m_discard_line)
   {
-    dataReceived(buf, rd);
+    m_line_buffer.append(buf + start, len - start);
+    if (m_line_buffer.size() > MAX_LINE_LENGTH)
+    {
+      std::cerr << "*** WARNING: Discarding a line longer than "
+                << MAX_LINE_LENGTH << " characters received on PTY "
+                << m_slave_link << std::endl;
+      m_line_buffer.clear();
+      m_discard_line = true;
+    }
   }
-} /* Pty::charactersReceived */
+} /* Pty::processLines */
+
+
+/**
+ * @brief   Write queued data when the master end is writable
+ */
+void Pty::writeQueued(void)
+{
+  ssize_t ret = ::write(m_master, m_tx_buf.data(), m_tx_buf.size());
+  if (ret < 0)
+  {
+    if (errno != EAGAIN)
+    {
+      discardQueued();
+    }
+    return;
+  }
+  m_stats.tx_bytes += ret;
+  m_tx_buf.erase(0, ret);
+  if (m_tx_buf.empty())
+  {
+    m_tx_watch.setEnabled(false);
+  }
+} /* Pty::writeQueued */
+
+
+/**
+ * @brief   Throw away data waiting to be written
+ */
+void Pty::discardQueued(void)
+{
+  m_stats.tx_dropped_bytes += m_tx_buf.size();
+  m_tx_buf.clear();
+  m_tx_watch.setEnabled(false);
+} /* Pty::discardQueued */
 
 
 /**
@@ -375,6 +524,7 @@ void Pty::checkIfSlaveEndOpen(void)
   {
     m_watch.setEnabled(true);
     m_pollhup_timer.setEnable(false);
+    m_inotify_watch.setEnabled(false);
   }
   if ((revents & POLLIN) != 0)
   {
@@ -383,6 +533,41 @@ void Pty::checkIfSlaveEndOpen(void)
 } /* Pty::checkIfSlaveEndOpen */
 
 
+/**
+ * @brief Start waiting for the slave end of the PTY to be opened
+ *
+ * If inotify is available, the slave device is watched for open events.
+ * Otherwise the master end is polled periodically.
+ */
+void Pty::waitForSlaveOpen(void)
+{
+  m_watch.setEnabled(false);
+  if (m_inotify_fd >= 0)
+  {
+    m_inotify_watch.setEnabled(true);
+  }
+  else
+  {
+    m_pollhup_timer.setEnable(true);
+  }
+} /* Pty::waitForSlaveOpen */
+
+
+/**
+ * @brief Called when the slave device has been opened by someone
+ */
+void Pty::inotifyActivity(void)
+{
+#ifdef HAS_INOTIFY
+  char buf[sizeof(struct inotify_event) + 256];
+  while (::read(m_inotify_fd, buf, sizeof(buf)) > 0)
+  {
+  }
+#endif
+  checkIfSlaveEndOpen();
+} /* Pty::inotifyActivity */
+
+
 /*
  * This file has not been truncated
  */
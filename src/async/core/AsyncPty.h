@@ -6,7 +6,7 @@
 
 \verbatim
 Async - A library for programming event driven applications
-Copyright (C) 2003-2024 Tobias Blomberg / SM0SVX
+Copyright (C) 2003-2026 Tobias Blomberg / SM0SVX
 
 This program is free software; you can redistribute it and/or modify
 it under the terms of the GNU General Public License as published by
@@ -38,6 +38,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 #include <sigc++/sigc++.h>
 
 #include <string>
+#include <cstdint>
 
 
 /****************************************************************************
@@ -115,15 +116,44 @@ This class wrap up some functionality that is nice to have when using a PTY.
 
 The PTY is opened in raw mode.
 
-If the slave end of the PTY is not open, the master file descriptor will be
-continuously polled to detect when it is opened.  When the slave end of the PTY
-is open, an FdWatch will be used to check for activity instead of polling.
+If the slave end of the PTY is not open, inotify is used to detect when it is
+opened. On systems without inotify the master file descriptor will instead be
+continuously polled.  When the slave end of the PTY is open, an FdWatch will be
+used to check for activity.
 
 Data written to the master end will be discarded if the slave end is not open.
+Data that cannot be written directly, because the reader on the slave end is
+slow, is queued and written when the PTY is writable again. The write
+functions never block. If the queue grows larger than MAX_TX_QUEUE_SIZE bytes
+the written data is dropped.
+
+In line buffered mode all complete lines received in one read are emitted one
+by one. Lines longer than MAX_LINE_LENGTH are discarded.
 */
 class Pty : public sigc::trackable
 {
   public:
+    /**
+     * @brief   The maximum number of bytes queued for writing
+     */
+    static const size_t MAX_TX_QUEUE_SIZE = 65536;
+
+    /**
+     * @brief   The maximum length of a line in line buffered mode
+     */
+    static const size_t MAX_LINE_LENGTH = 4096;
+
+    /**
+     * @brief   Throughput counters
+     */
+    struct Stats
+    {
+      uint64_t rx_bytes         = 0;  ///< The number of bytes read
+      uint64_t rx_lines         = 0;  ///< The number of lines emitted
+      uint64_t tx_bytes         = 0;  ///< The number of bytes written
+      uint64_t tx_dropped_bytes = 0;  ///< Bytes dropped on a full queue
+    };
+
     /**
      * @brief   Constructor
      * @param   slave_link Path to the slave softlink
@@ -143,6 +173,7 @@ class Pty : public sigc::trackable
     {
       m_is_line_buffered = line_buffered;
       m_line_buffer.clear();
+      m_discard_line = false;
     }
 
     /**
@@ -175,9 +206,9 @@ class Pty : public sigc::trackable
      * @brief   Write data to the PTY
      * @param   buf A buffer containing the data to write
      * @param   count The number of bytes to write
-     * @return  On success, the number of bytes written is returned (zero
-     *          indicates nothing was written).  On error, -1 is returned,
-     *          and errno is set appropriately.
+     * @return  On success, the number of bytes written or queued is
+     *          returned. It is less than \em count if the write queue is
+     *          full. On error, -1 is returned, and errno is set appropriately.
      * 
      * Use this function to write data to the PTY. If the slave end of the PTY
      * is not open, the written data will just be discarded and \em count is
@@ -207,6 +238,18 @@ class Pty : public sigc::trackable
      */
     bool isOpen(void) const { return m_master >= 0; }
 
+    /**
+     * @brief   Get the throughput counters
+     * @return  Returns the counters since the object was created
+     */
+    const Stats& stats(void) const { return m_stats; }
+
+    /**
+     * @brief   Get the number of bytes waiting to be written
+     * @return  Returns the number of bytes in the write queue
+     */
+    size_t txQueuedBytes(void) const { return m_tx_buf.size(); }
+
     /**
      * @brief   Get the path to the slave PTS device
      * @return  Returns the slave path after the PTY has been opened
@@ -229,15 +272,26 @@ class Pty : public sigc::trackable
     int             m_master            = -1;
     Async::FdWatch  m_watch;
     Async::Timer    m_pollhup_timer;
+    int             m_inotify_fd        = -1;
+    Async::FdWatch  m_inotify_watch;
     bool            m_is_line_buffered  = false;
     std::string     m_line_buffer;
+    bool            m_discard_line      = false;
     std::string     m_slave_path;
+    Async::FdWatch  m_tx_watch;
+    std::string     m_tx_buf;
+    Stats           m_stats;
 
     Pty(const Pty&);
     Pty& operator=(const Pty&);
     
     void charactersReceived(void);
+    void processLines(const char* buf, size_t len);
+    void writeQueued(void);
+    void discardQueued(void);
     short pollMaster(void);
+    void waitForSlaveOpen(void);
+    void inotifyActivity(void);
     void checkIfSlaveEndOpen(void);
 
 };  /* class Pty */
@@ -41,6 +41,9 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 #include <fcntl.h>
 #include <errno.h>
 #include <sys/ioctl.h>
+#ifdef __linux__
+#include <linux/serial.h>
+#endif
 
 #include <cstdio>
 #include <cstring>
@@ -447,6 +450,36 @@ bool Serial::setCanonical(bool canonical)
 } /* Serial::setCanonical */
 
 
+bool Serial::setLowLatency(bool enable)
+{
+  if (fd == -1)
+  {
+    errno = EBADF;
+    return false;
+  }
+
+#if defined(TIOCGSERIAL) && defined(ASYNC_LOW_LATENCY)
+  struct serial_struct ser_info;
+  if (ioctl(fd, TIOCGSERIAL, &ser_info) == -1)
+  {
+    return false;
+  }
+  if (enable)
+  {
+    ser_info.flags |= ASYNC_LOW_LATENCY;
+  }
+  else
+  {
+    ser_info.flags &= ~ASYNC_LOW_LATENCY;
+  }
+  return ioctl(fd, TIOCSSERIAL, &ser_info) != -1;
+#else
+  errno = ENOTSUP;
+  return false;
+#endif
+} /* Serial::setLowLatency */
+
+
 bool Serial::stopInput(bool stop)
 {
   return tcflow(fd, stop ? TCIOFF : TCION) == 0;
@@ -263,6 +263,22 @@ class Serial : public sigc::trackable
      * opened and the setting is remembered after a close.
      */
     bool setCanonical(bool canonical);
+
+    /**
+     * @brief 	Enable or disable low latency mode in the serial port driver
+     * @param 	enable Set to \em true to enable low latency mode
+     * @return	Return \em true on success or else \em false on failue. On
+     *	      	failure the global variable \em errno will be set to indicate
+     *	      	the cause of the error.
+     *
+     * Many USB serial adapters buffer received data, and the state of the
+     * modem control input pins, for up to 16ms before it is delivered to the
+     * host. In low latency mode the driver deliver it as soon as possible.
+     * This lower the latency for squelch pins and short messages at the
+     * cost of more USB traffic. The port must be open and the setting is
+     * not restored when the port is closed. Only supported on Linux.
+     */
+    bool setLowLatency(bool enable);
     
     /**
      * @brief 	Stop/start input of data
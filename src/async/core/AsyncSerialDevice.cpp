@@ -40,6 +40,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 #include <fcntl.h>
 #include <errno.h>
 #include <cstdio>
+#include <iostream>
 
 
 /****************************************************************************
@@ -305,7 +306,20 @@ void SerialDevice::onIncomingData(FdWatch *watch)
   cnt = ::read(fd, buf, sizeof(buf)-1);
   if (cnt == -1)
   {
-    perror("read");
+    if ((errno != EAGAIN) && (errno != EINTR))
+    {
+      perror("read");
+    }
+    return;
+  }
+  if (cnt == 0)
+  {
+      // End of file, e.g. an unplugged USB serial adapter. The descriptor
+      // would be reported as readable in every main loop iteration so stop
+      // watching it.
+    cerr << "*** WARNING: End of file on serial port " << port_name
+         << ". Not reading from it anymore." << endl;
+    rd_watch->setEnabled(false);
     return;
   }
   
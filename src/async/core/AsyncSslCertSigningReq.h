@@ -466,10 +466,8 @@ class SslCertSigningReq
     bool sign(SslKeypair& privkey)
     {
       assert(m_req != nullptr);
-      auto md = EVP_sha256();
-      //auto md_size = EVP_MD_get_size(md);
-      auto md_size = EVP_MD_size(md);
-      return (X509_REQ_sign(m_req, privkey, md) == md_size);
+        // X509_REQ_sign return the size of the signature, not of the digest
+      return (X509_REQ_sign(m_req, privkey, EVP_sha256()) > 0);
     }
 
     /**
@@ -6,7 +6,7 @@
 
 \verbatim
 Async - A library for programming event driven applications
-Copyright (C) 2003-2025 Tobias Blomberg / SM0SVX
+Copyright (C) 2003-2026 Tobias Blomberg / SM0SVX
 
 This program is free software; you can redistribute it and/or modify
 it under the terms of the GNU General Public License as published by
@@ -39,7 +39,12 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 #include <openssl/ssl.h>
 
 #include <iostream>
+#include <algorithm>
 #include <cassert>
+#include <ctime>
+#include <map>
+#include <mutex>
+#include <string>
 
 
 /****************************************************************************
@@ -173,6 +178,10 @@ class SslContext
      */
     ~SslContext(void)
     {
+      for (auto& entry : m_sessions)
+      {
+        SSL_SESSION_free(entry.second);
+      }
       SSL_CTX_free(m_ctx);
       m_ctx = nullptr;
     }
@@ -182,12 +191,17 @@ class SslContext
      * @param   keyfile The path to the key file
      * @param   crtfile The path to the certificate file
      * @return  Returns \em true on success
+     *
+     * Cached client sessions are cleared since they were set up using the
+     * previous certificate.
      */
     bool setCertificateFiles(const std::string& keyfile,
                              const std::string& crtfile)
     {
       if (crtfile.empty() || keyfile.empty()) return false;
 
+      clearClientSessionCache();
+
         // Load certificate chain and private key files, and check consistency
       //if (SSL_CTX_use_certificate_file(
       //      m_ctx, crtfile.c_str(), SSL_FILETYPE_PEM) != 1)
@@ -232,9 +246,126 @@ class SslContext
     {
       int ret = SSL_CTX_load_verify_locations(m_ctx, cafile.c_str(), NULL);
       m_cafile_set = (ret == 1);
+      clearVerifiedPeerCache();
+      clearClientSessionCache();
       return m_cafile_set;
     }
 
+    /**
+     * @brief   Enable caching of client sessions for resumption
+     *
+     * When enabled, the TLS 1.3 session tickets received from a server are
+     * stored in this context. A later client connection to the same peer
+     * will then try to resume the session which save a round trip and the
+     * certificate chain verification in the handshake. If the server does not
+     * accept the ticket, a full handshake is made. Only client connections
+     * are affected. A resumed session use the client certificate that was
+     * used when the session was first set up, so the cache is cleared when
+     * a new certificate or CA file is loaded.
+     */
+    void enableClientSessionCache(void)
+    {
+      SSL_CTX_set_app_data(m_ctx, this);
+      SSL_CTX_set_session_cache_mode(m_ctx,
+          SSL_SESS_CACHE_CLIENT | SSL_SESS_CACHE_NO_INTERNAL_STORE);
+      SSL_CTX_sess_set_new_cb(m_ctx, newSessionCallback);
+      m_session_cache_enabled = true;
+    }
+
+    /**
+     * @brief   Prepare a client connection for session resumption
+     * @param   ssl   The SSL object of the new client connection
+     * @param   peer  A string identifying the peer, e.g. "ip:port"
+     *
+     * This function is called by the TcpConnection class before a client
+     * handshake is started. It does nothing unless the client session cache
+     * has been enabled.
+     */
+    void prepareClientSession(SSL* ssl, const std::string& peer)
+    {
+      if (!m_session_cache_enabled)
+      {
+        return;
+      }
+      SSL_set_ex_data(ssl, peerIndex(), new std::string(peer));
+      std::lock_guard<std::mutex> lk(m_sessions_mu);
+      auto it = m_sessions.find(peer);
+      if (it == m_sessions.end())
+      {
+        return;
+      }
+      if (SSL_SESSION_is_resumable(it->second))
+      {
+        SSL_set_session(ssl, it->second);
+      }
+      else
+      {
+        SSL_SESSION_free(it->second);
+        m_sessions.erase(it);
+      }
+    }
+
+    /**
+     * @brief   Forget all cached client sessions
+     */
+    void clearClientSessionCache(void)
+    {
+      std::lock_guard<std::mutex> lk(m_sessions_mu);
+      for (auto& entry : m_sessions)
+      {
+        SSL_SESSION_free(entry.second);
+      }
+      m_sessions.clear();
+    }
+
+    /**
+     * @brief   Enable resumption of sessions on the server side
+     * @param   id_context  A string identifying the application
+     * @param   timeout     The lifetime of a session in seconds
+     *
+     * A server that verify client certificates must have a session id context
+     * set for clients to be able to resume their sessions. Both session IDs
+     * and session tickets are enabled.
+     */
+    void enableServerSessionCache(const std::string& id_context, long timeout)
+    {
+      SSL_CTX_set_session_id_context(m_ctx,
+          reinterpret_cast<const unsigned char*>(id_context.data()),
+          std::min(id_context.size(), size_t(SSL_MAX_SID_CTX_LENGTH)));
+      SSL_CTX_set_session_cache_mode(m_ctx, SSL_SESS_CACHE_SERVER);
+      SSL_CTX_clear_options(m_ctx, SSL_OP_NO_TICKET);
+      SSL_CTX_set_timeout(m_ctx, timeout);
+    }
+
+    /**
+     * @brief   Enable caching of successfully verified peer certificates
+     * @param   max_age   Seconds to remember a verified certificate
+     * @param   max_size  The maximum number of cached certificates
+     *
+     * When enabled, the SHA256 fingerprint of each peer certificate that pass
+     * verification is remembered. When the same certificate is presented again
+     * within max_age seconds, the walk up the CA chain is skipped. The
+     * validity period of the certificate is still checked and the verify
+     * callback of the connection, e.g. the TcpConnection::verifyPeer signal,
+     * is called once for the certificate. The cache is cleared when a new CA
+     * file is loaded.
+     */
+    void enableVerifiedPeerCache(unsigned max_age, size_t max_size)
+    {
+      m_verified_max_age = max_age;
+      m_verified_max_size = max_size;
+      SSL_CTX_set_cert_verify_callback(m_ctx, certVerifyCallback, this);
+    }
+
+    /**
+     * @brief   Forget all previously verified peer certificates
+     */
+    void clearVerifiedPeerCache(void)
+    {
+      std::lock_guard<std::mutex> lk(m_verified_mu);
+      m_verified.clear();
+    }
+
     /**
      * @brief   Cast to pointer to SSL_CTX
      * @return  Returns a pointer to the internal SSL_CTX
@@ -245,8 +376,122 @@ class SslContext
   protected:
 
   private:
-    SSL_CTX*  m_ctx         = nullptr;
-    bool      m_cafile_set  = false;
+    SSL_CTX*                              m_ctx         = nullptr;
+    bool                                  m_cafile_set  = false;
+    bool                                  m_session_cache_enabled = false;
+    std::map<std::string, SSL_SESSION*>   m_sessions;
+    std::mutex                            m_sessions_mu;
+    std::map<std::string, time_t>         m_verified;
+    std::mutex                            m_verified_mu;
+    unsigned                              m_verified_max_age  = 0;
+    size_t                                m_verified_max_size = 0;
+
+    static void freePeerString(void*, void* ptr, CRYPTO_EX_DATA*, int, long,
+                               void*)
+    {
+      delete static_cast<std::string*>(ptr);
+    }
+
+    static int peerIndex(void)
+    {
+      static const int index =
+        SSL_get_ex_new_index(0, nullptr, nullptr, nullptr, freePeerString);
+      return index;
+    }
+
+    static int certVerifyCallback(X509_STORE_CTX* store_ctx, void* arg)
+    {
+      auto ctx = static_cast<SslContext*>(arg);
+      X509* cert = X509_STORE_CTX_get0_cert(store_ctx);
+      unsigned char md[EVP_MAX_MD_SIZE];
+      unsigned int md_len = 0;
+      std::string fp;
+      if ((cert != nullptr) &&
+          (X509_digest(cert, EVP_sha256(), md, &md_len) == 1))
+      {
+        fp.assign(reinterpret_cast<char*>(md), md_len);
+      }
+      time_t now = std::time(NULL);
+
+      bool is_cached = false;
+      if (!fp.empty())
+      {
+        std::lock_guard<std::mutex> lk(ctx->m_verified_mu);
+        auto it = ctx->m_verified.find(fp);
+        if (it != ctx->m_verified.end())
+        {
+          is_cached = (it->second > now) &&
+                      (X509_cmp_current_time(X509_get0_notAfter(cert)) > 0);
+          if (!is_cached)
+          {
+            ctx->m_verified.erase(it);
+          }
+        }
+      }
+
+        // The chain is not walked again for a cached certificate but the
+        // verify callback of the connection is still called for the leaf
+        // certificate so that the application checks are made
+      if (is_cached)
+      {
+        X509_STORE_CTX_set_error(store_ctx, X509_V_OK);
+        X509_STORE_CTX_set_error_depth(store_ctx, 0);
+        X509_STORE_CTX_set_current_cert(store_ctx, cert);
+        SSL* ssl = static_cast<SSL*>(X509_STORE_CTX_get_ex_data(store_ctx,
+              SSL_get_ex_data_X509_STORE_CTX_idx()));
+        SSL_verify_cb verify_cb =
+          (ssl != nullptr) ? SSL_get_verify_callback(ssl) : nullptr;
+        return (verify_cb != nullptr) ? verify_cb(1, store_ctx) : 1;
+      }
+
+      int ok = X509_verify_cert(store_ctx);
+      if ((ok == 1) && !fp.empty())
+      {
+        std::lock_guard<std::mutex> lk(ctx->m_verified_mu);
+        auto& verified = ctx->m_verified;
+        for (auto it = verified.begin();
+             (verified.size() >= ctx->m_verified_max_size) &&
+             (it != verified.end()); )
+        {
+          it = (it->second <= now) ? verified.erase(it) : std::next(it);
+        }
+        if (verified.size() >= ctx->m_verified_max_size)
+        {
+          verified.clear();
+        }
+        verified[fp] = now + ctx->m_verified_max_age;
+      }
+      return ok;
+    }
+
+    static int newSessionCallback(SSL* ssl, SSL_SESSION* sess)
+    {
+        // Sessions from older protocol versions are not cached since a
+        // server that verify client certificates may refuse to resume them
+      auto ctx = static_cast<SslContext*>(
+          SSL_CTX_get_app_data(SSL_get_SSL_CTX(ssl)));
+      auto peer = static_cast<std::string*>(SSL_get_ex_data(ssl, peerIndex()));
+      if ((ctx == nullptr) || (peer == nullptr) ||
+          (SSL_version(ssl) != TLS1_3_VERSION))
+      {
+        return 0;
+      }
+        // A copy is stored since OpenSSL mark the session of a connection
+        // as not resumable if the connection is freed without a shutdown
+      SSL_SESSION* copy = SSL_SESSION_dup(sess);
+      if (copy == nullptr)
+      {
+        return 0;
+      }
+      std::lock_guard<std::mutex> lk(ctx->m_sessions_mu);
+      auto& stored = ctx->m_sessions[*peer];
+      if (stored != nullptr)
+      {
+        SSL_SESSION_free(stored);
+      }
+      stored = copy;
+      return 0;
+    }
 
     static void initializeGlobals(void)
     {
@@ -847,9 +847,8 @@ class SslX509
      */
     bool sign(SslKeypair& pkey)
     {
-      auto md = EVP_sha256();
-      auto md_size = EVP_MD_size(md);
-      return (X509_sign(m_cert, pkey, md) != md_size);
+        // X509_sign return the size of the signature, not of the digest
+      return (X509_sign(m_cert, pkey, EVP_sha256()) > 0);
     }
 
     /**
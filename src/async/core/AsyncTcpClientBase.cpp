@@ -9,7 +9,7 @@ to a remote host. See usage instructions in the class definition.
 
 \verbatim
 Async - A library for programming event driven applications
-Copyright (C) 2003-2022 Tobias Blomberg
+Copyright (C) 2003-2026 Tobias Blomberg
 
 This program is free software; you can redistribute it and/or modify
 it under the terms of the GNU General Public License as published by
@@ -38,6 +38,8 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 
 #include <sys/types.h>
 #include <sys/socket.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
 #include <unistd.h>
 #include <fcntl.h>
 
@@ -184,6 +186,8 @@ TcpClientBase& TcpClientBase::operator=(TcpClientBase&& other)
   bind_ip = other.bind_ip;
   other.bind_ip.clear();
 
+  no_delay = other.no_delay;
+
   return *this;
 } /* TcpClientBase::operator= */
 
@@ -316,6 +320,15 @@ void TcpClientBase::connectToRemote(void)
     return;
   }
 
+  if (no_delay)
+  {
+    int on = 1;
+    if (setsockopt(sock, IPPROTO_TCP, TCP_NODELAY, &on, sizeof(on)) == -1)
+    {
+      perror("setsockopt(sock, TCP_NODELAY)");
+    }
+  }
+
   if (!bind_ip.isEmpty())
   {
     struct sockaddr_in addr = { 0 };
@@ -9,7 +9,7 @@ to a remote host. See usage instructions in the class definition.
 
 \verbatim
 Async - A library for programming event driven applications
-Copyright (C) 2003-2022 Tobias Blomberg
+Copyright (C) 2003-2026 Tobias Blomberg
 
 This program is free software; you can redistribute it and/or modify
 it under the terms of the GNU General Public License as published by
@@ -200,6 +200,23 @@ class TcpClientBase : virtual public sigc::trackable
      */
     const IpAddress& bindIp(void) const { return bind_ip; }
 
+    /**
+     * @brief   Disable the Nagle algorithm on the connection
+     * @param   enable Set to \em true to send small writes without delay
+     *
+     * Set this before the connection is made. The Nagle algorithm delays
+     * small writes until previously sent data has been acknowledged, which
+     * add latency to protocols that send small real time messages, like
+     * audio frames.
+     */
+    void setNoDelay(bool enable) { no_delay = enable; }
+
+    /**
+     * @brief   Check if the Nagle algorithm is disabled
+     * @return  Returns \em true if small writes are sent without delay
+     */
+    bool noDelay(void) const { return no_delay; }
+
     /**
      * @brief 	Connect to the remote host
      * @param 	remote_host   The hostname of the remote host
@@ -308,6 +325,7 @@ class TcpClientBase : virtual public sigc::trackable
     int       	      sock;
     FdWatch           wr_watch;
     Async::IpAddress  bind_ip;
+    bool              no_delay  = false;
     //bool              m_successful_connect  = false;
 
     void dnsResultsReady(DnsLookup& dns_lookup);
@@ -9,7 +9,7 @@ to a remote host. See usage instructions in the class definition.
 
 \verbatim
 Async - A library for programming event driven applications
-Copyright (C) 2003-2025 Tobias Blomberg
+Copyright (C) 2003-2026 Tobias Blomberg
 
 This program is free software; you can redistribute it and/or modify
 it under the terms of the GNU General Public License as published by
@@ -43,6 +43,9 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 #include <cstdio>
 #include <cstring>
 #include <algorithm>
+#include <iterator>
+#include <mutex>
+#include <condition_variable>
 
 
 /****************************************************************************
@@ -63,6 +66,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 #include "AsyncDnsLookup.h"
 #include "AsyncTcpConnection.h"
 #include "AsyncSslX509.h"
+#include "AsyncWorkerPool.h"
 
 
 /****************************************************************************
@@ -89,6 +93,25 @@ using namespace Async;
  *
  ****************************************************************************/
 
+struct TcpConnection::SslHandshakeJob
+  : public std::enable_shared_from_this<SslHandshakeJob>
+{
+  enum State { STATE_QUEUED, STATE_RUNNING, STATE_FINISHED };
+
+  std::mutex              mutex;
+  std::condition_variable cond;
+  TcpConnection*          con               = nullptr;
+  SSL*                    ssl               = nullptr;
+  WorkerPool*             pool              = nullptr;
+  State                   state             = STATE_QUEUED;
+  bool                    cancelled         = false;
+  SslStatus               status            = SSLSTATUS_OK;
+  bool                    verify_done       = false;
+  int                     verify_preverify  = 0;
+  X509_STORE_CTX*         verify_store_ctx  = nullptr;
+  int                     verify_result     = 0;
+};
+
 
 
 /****************************************************************************
@@ -114,6 +137,8 @@ using namespace Async;
  ****************************************************************************/
 
 std::map<SSL*, TcpConnection*> TcpConnection::ssl_con_map;
+thread_local TcpConnection::SslHandshakeJob*
+  TcpConnection::ssl_hs_job_in_thread = nullptr;
 
 
 /****************************************************************************
@@ -161,7 +186,8 @@ TcpConnection::TcpConnection(size_t recv_buf_len)
 
 TcpConnection::TcpConnection(int sock, const IpAddress& remote_addr,
       	      	      	     uint16_t remote_port, size_t recv_buf_len)
-  : remote_addr(remote_addr), remote_port(remote_port), sock(sock)
+  : remote_addr(remote_addr), remote_port(remote_port), sock(sock),
+    m_recv_buf_len(recv_buf_len)
 {
   m_recv_buf.reserve(recv_buf_len);
   rd_watch.activity.connect(
@@ -182,6 +208,8 @@ TcpConnection& TcpConnection::operator=(TcpConnection&& other)
 {
   //std::cout << "### TcpConnection::operator=(TcpConnection&&)" << std::endl;
 
+  assert(other.m_ssl_hs_job == nullptr);
+
   closeConnection();
 
   remote_addr = other.remote_addr;
@@ -197,12 +225,14 @@ TcpConnection& TcpConnection::operator=(TcpConnection&& other)
   m_wr_watch = std::move(other.m_wr_watch);
 
   m_recv_buf = std::move(other.m_recv_buf);
+  m_recv_buf_len = other.m_recv_buf_len;
   other.m_recv_buf.clear();
-  other.m_recv_buf.reserve(m_recv_buf.capacity());
+  other.m_recv_buf.reserve(m_recv_buf_len);
 
-  m_write_buf = std::move(other.m_write_buf);
-  other.m_write_buf.clear();
-  other.m_write_buf.reserve(m_write_buf.capacity());
+  m_write_queue = std::move(other.m_write_queue);
+  other.m_write_queue.clear();
+  m_write_queue_bytes = other.m_write_queue_bytes;
+  other.m_write_queue_bytes = 0;
 
   m_ssl_ctx = other.m_ssl_ctx;
   other.m_ssl_ctx = nullptr;
@@ -223,6 +253,9 @@ TcpConnection& TcpConnection::operator=(TcpConnection&& other)
   other.m_ssl_encrypt_buf.clear();
   other.m_ssl_encrypt_buf.reserve(m_ssl_encrypt_buf.capacity());
 
+  m_ssl_worker_pool = other.m_ssl_worker_pool;
+  other.m_ssl_worker_pool = nullptr;
+
   return *this;
 } /* TcpConnection::operator= */
 
@@ -231,6 +264,11 @@ void TcpConnection::setRecvBufLen(size_t recv_buf_len)
 {
   if (recv_buf_len > m_recv_buf.size())
   {
+    m_recv_buf_len = recv_buf_len;
+    if (m_recv_buf.empty())
+    {
+      shrinkRecvBuf();
+    }
     m_recv_buf.reserve(recv_buf_len);
   }
 } /* TcpConnection::setRecvBufLen */
@@ -248,6 +286,38 @@ int TcpConnection::write(const void *buf, int count)
 } /* TcpConnection::write */
 
 
+int TcpConnection::write(const SharedBuffer& buf)
+{
+  return writeWithHeader(nullptr, 0, buf);
+} /* TcpConnection::write */
+
+
+int TcpConnection::writev(const struct iovec* iov, int iovcnt, bool prio)
+{
+  assert(sock >= 0);
+  size_t len = 0;
+  for (int i=0; i<iovcnt; ++i)
+  {
+    len += iov[i].iov_len;
+  }
+  if (m_ssl != nullptr)
+  {
+    for (int i=0; i<iovcnt; ++i)
+    {
+      const char* ptr = reinterpret_cast<const char*>(iov[i].iov_base);
+      m_ssl_encrypt_buf.insert(m_ssl_encrypt_buf.end(),
+                               ptr, ptr+iov[i].iov_len);
+    }
+    sslEncrypt();
+  }
+  else
+  {
+    addToWriteBuf(iov, iovcnt, len, prio);
+  }
+  return len;
+} /* TcpConnection::writev */
+
+
 void TcpConnection::enableSsl(bool enable)
 {
   if (enable)
@@ -268,6 +338,8 @@ void TcpConnection::enableSsl(bool enable)
     else
     {
       //SSL_set_tlsext_host_name(m_ssl, "svxreflector.example.com");
+      m_ssl_ctx->prepareClientSession(m_ssl,
+          remoteHost().toString() + ":" + std::to_string(remotePort()));
       SSL_set_connect_state(m_ssl);
       auto ret = sslDoHandshake();
       assert(ret != SSLSTATUS_FAIL);
@@ -303,7 +375,7 @@ void TcpConnection::freeze(void)
 void TcpConnection::unfreeze(void)
 {
   m_freezed = false;
-  m_wr_watch.setEnabled(!m_write_buf.empty());
+  m_wr_watch.setEnabled(!m_write_queue.empty());
   processRecvBuf();
 } /* TcpConnection::unfreeze */
 
@@ -375,6 +447,26 @@ std::string TcpConnection::sslCommonName(void) const
  *
  ****************************************************************************/
 
+int TcpConnection::writeWithHeader(const void* head, size_t head_len,
+                                   const SharedBuffer& buf)
+{
+  assert(sock >= 0);
+  if (m_ssl != nullptr)
+  {
+      // Add the header directly to the encryption buffer so that the header
+      // and the data are encrypted together
+    const char* ptr = reinterpret_cast<const char*>(head);
+    m_ssl_encrypt_buf.insert(m_ssl_encrypt_buf.end(), ptr, ptr+head_len);
+    sslWrite(buf->data(), buf->size());
+  }
+  else
+  {
+    addToWriteBuf(head, head_len, buf);
+  }
+  return head_len + buf->size();
+} /* TcpConnection::writeWithHeader */
+
+
 void TcpConnection::setSocket(int sock)
 {
   this->sock = sock;
@@ -434,12 +526,15 @@ Async::IpAddress TcpConnection::localHost(void) const
 void TcpConnection::closeConnection(void)
 {
   m_recv_buf.clear();
-  m_write_buf.clear();
+  m_write_queue.clear();
+  m_write_queue_bytes = 0;
   m_ssl_encrypt_buf.clear();
 
   m_wr_watch.setEnabled(false);
   rd_watch.setEnabled(false);
 
+  sslAbortHandshakeJob();
+
   if (m_ssl != nullptr)
   {
     ssl_con_map.erase(m_ssl);
@@ -468,6 +563,14 @@ int TcpConnection::sslVerifyCallback(int preverify_ok,
   //std::cout << "### TcpConnection::sslVerifyCallback: preverify_ok: "
   //          << preverify_ok << std::endl;
 
+    // When called from a handshake worker thread, the verification is
+    // forwarded to the main thread
+  if (ssl_hs_job_in_thread != nullptr)
+  {
+    return sslVerifyInMainThread(ssl_hs_job_in_thread, preverify_ok,
+                                 x509_store_ctx);
+  }
+
   SSL* ssl = reinterpret_cast<SSL*>(X509_STORE_CTX_get_ex_data(x509_store_ctx,
       SSL_get_ex_data_X509_STORE_CTX_idx()));
   assert(ssl != nullptr);
@@ -479,6 +582,60 @@ int TcpConnection::sslVerifyCallback(int preverify_ok,
 } /* TcpConnection::sslVerifyCallback */
 
 
+TcpConnection::SslStatus TcpConnection::sslGetStatus(SSL* ssl, int n)
+{
+  int err = SSL_get_error(ssl, n);
+  switch (err)
+  {
+    case SSL_ERROR_NONE:
+      return SSLSTATUS_OK;
+    case SSL_ERROR_WANT_WRITE:
+    case SSL_ERROR_WANT_READ:
+      return SSLSTATUS_WANT_IO;
+    case SSL_ERROR_ZERO_RETURN:
+    case SSL_ERROR_SYSCALL:
+    default:
+      return SSLSTATUS_FAIL;
+  }
+} /* TcpConnection::sslGetStatus */
+
+
+int TcpConnection::sslVerifyInMainThread(SslHandshakeJob* job,
+                                         int preverify_ok,
+                                         X509_STORE_CTX* x509_store_ctx)
+{
+  std::unique_lock<std::mutex> lk(job->mutex);
+  job->verify_done = false;
+  job->verify_preverify = preverify_ok;
+  job->verify_store_ctx = x509_store_ctx;
+  lk.unlock();
+
+  auto shared_job = job->shared_from_this();
+  job->pool->runInMainThread(
+      [shared_job](void)
+      {
+          // The job is only cancelled from the main thread so no locking
+          // is needed for reading the flag here. The lock must not be held
+          // while calling the application since it may delete the
+          // connection, which will cancel the job.
+        if (shared_job->cancelled)
+        {
+          return;
+        }
+        int result = shared_job->con->emitVerifyPeer(
+            shared_job->verify_preverify, shared_job->verify_store_ctx);
+        std::lock_guard<std::mutex> lk(shared_job->mutex);
+        shared_job->verify_result = result;
+        shared_job->verify_done = true;
+        shared_job->cond.notify_all();
+      });
+
+  lk.lock();
+  job->cond.wait(lk, [job]{ return job->verify_done || job->cancelled; });
+  return job->cancelled ? 0 : job->verify_result;
+} /* TcpConnection::sslVerifyInMainThread */
+
+
 void TcpConnection::recvHandler(FdWatch *watch)
 {
   //std::cout << "### TcpConnection::recvHandler:"
@@ -486,34 +643,58 @@ void TcpConnection::recvHandler(FdWatch *watch)
   //          << " m_recv_buf.capacity()=" << m_recv_buf.capacity()
   //          << std::endl;
 
-  size_t recv_buf_size = m_recv_buf.size();
-  int cnt = read(sock, m_recv_buf.data()+recv_buf_size,
-                 m_recv_buf.capacity()-recv_buf_size);
-  //std::cout << "###   cnt=" << cnt << std::endl;
-  if (cnt <= -1)
-  {
-    int errno_tmp = errno;
-    closeConnection();
-    errno = errno_tmp;
-    onDisconnected(DR_SYSTEM_ERROR);
-    return;
-  }
-  else if (cnt == 0)
+    // Keep reading as long as the kernel fill the whole free space in the
+    // receive buffer so that a burst of data is processed in one go. The
+    // loop end when a read come up short, which mean that the socket has
+    // been drained, or when MAX_RECV_BATCH bytes have been read.
+  size_t read_cnt = 0;
+  for (;;)
   {
-    //cout << "Connection closed by remote host!\n";
-    closeConnection();
-    onDisconnected(DR_REMOTE_DISCONNECTED);
-    return;
-  }
+    size_t recv_buf_size = m_recv_buf.size();
+    size_t space = m_recv_buf.capacity() - recv_buf_size;
+    ssize_t cnt = read(sock, m_recv_buf.data()+recv_buf_size, space);
+    //std::cout << "###   cnt=" << cnt << std::endl;
+    if (cnt <= -1)
+    {
+      if ((read_cnt > 0) && ((errno == EAGAIN) || (errno == EWOULDBLOCK)))
+      {
+        break;
+      }
+      int errno_tmp = errno;
+      closeConnection();
+      errno = errno_tmp;
+      onDisconnected(DR_SYSTEM_ERROR);
+      return;
+    }
+    else if (cnt == 0)
+    {
+      if (read_cnt > 0)
+      {
+          // Process what we got. The end of file will be seen again on the
+          // next read.
+        break;
+      }
+      //cout << "Connection closed by remote host!\n";
+      closeConnection();
+      onDisconnected(DR_REMOTE_DISCONNECTED);
+      return;
+    }
 
-  m_recv_buf.resize(recv_buf_size + cnt);
-  //std::cout << "### TcpConnection::recvHandler: size="
-  //          << m_recv_buf.size() << std::endl;
-  if (m_recv_buf.size() == m_recv_buf.capacity())
-  {
-    size_t new_capacity = m_recv_buf.capacity() * 2;
-    //std::cout << "### new_capacity=" << new_capacity << std::endl;
-    m_recv_buf.reserve(new_capacity);
+    m_recv_buf.resize(recv_buf_size + cnt);
+    read_cnt += cnt;
+    //std::cout << "### TcpConnection::recvHandler: size="
+    //          << m_recv_buf.size() << std::endl;
+    if (m_recv_buf.size() == m_recv_buf.capacity())
+    {
+      size_t new_capacity = m_recv_buf.capacity() * 2;
+      //std::cout << "### new_capacity=" << new_capacity << std::endl;
+      m_recv_buf.reserve(new_capacity);
+    }
+
+    if ((static_cast<size_t>(cnt) < space) || (read_cnt >= MAX_RECV_BATCH))
+    {
+      break;
+    }
   }
 
   if (!m_freezed)
@@ -540,6 +721,7 @@ void TcpConnection::processRecvBuf(void)
   if (processed >= static_cast<ssize_t>(m_recv_buf.size()))
   {
     m_recv_buf.clear();
+    shrinkRecvBuf();
   }
   else if (processed > 0)
   {
@@ -561,47 +743,156 @@ void TcpConnection::processRecvBuf(void)
 } /* TcpConnection::processRecvBuf */
 
 
+void TcpConnection::shrinkRecvBuf(void)
+{
+    // Only called when the buffer is empty. Reallocate the buffer if it is
+    // larger than the configured size, e.g. after a burst of data.
+  assert(m_recv_buf.empty());
+  if (m_recv_buf.capacity() > m_recv_buf_len)
+  {
+    std::vector<Char>().swap(m_recv_buf);
+    m_recv_buf.reserve(m_recv_buf_len);
+  }
+} /* TcpConnection::shrinkRecvBuf */
+
+
 void TcpConnection::addToWriteBuf(const char *buf, size_t len)
 {
-  m_write_buf.insert(m_write_buf.end(), buf, buf+len);
-  m_wr_watch.setEnabled(!m_freezed && !m_write_buf.empty());
+  struct iovec iov;
+  iov.iov_base = const_cast<char*>(buf);
+  iov.iov_len = len;
+  addToWriteBuf(&iov, 1, len, false);
+} /* TcpConnection::addToWriteBuf */
+
+
+void TcpConnection::addToWriteBuf(const struct iovec* iov, int iovcnt,
+                                  size_t len, bool prio)
+{
+  WriteQueue::iterator it;
+  if (prio)
+  {
+      // Put prioritized data after the segment that is being sent, if any,
+      // and after previously queued prioritized segments
+    it = m_write_queue.begin();
+    if ((it != m_write_queue.end()) && (it->pos > 0))
+    {
+      ++it;
+    }
+    while ((it != m_write_queue.end()) && it->prio)
+    {
+      ++it;
+    }
+    it = m_write_queue.emplace(it);
+    it->prio = true;
+    it->own.reserve(len);
+  }
+  else
+  {
+      // Coalesce small writes into the last queued segment as long as it is
+      // not a shared buffer or a prioritized segment
+    if (m_write_queue.empty() || m_write_queue.back().shared ||
+        (m_write_queue.back().head_len > 0) || m_write_queue.back().prio ||
+        (m_write_queue.back().own.size() + len > MAX_COALESCE_SIZE))
+    {
+      m_write_queue.emplace_back();
+      m_write_queue.back().own.reserve(std::max(len, DEFAULT_BUF_SIZE));
+    }
+    it = std::prev(m_write_queue.end());
+  }
+  for (int i=0; i<iovcnt; ++i)
+  {
+    const char* ptr = reinterpret_cast<const char*>(iov[i].iov_base);
+    it->own.insert(it->own.end(), ptr, ptr+iov[i].iov_len);
+  }
+  m_write_queue_bytes += len;
+  m_wr_watch.setEnabled(!m_freezed);
+} /* TcpConnection::addToWriteBuf */
+
+
+void TcpConnection::addToWriteBuf(const void *head, size_t head_len,
+                                  const SharedBuffer& buf)
+{
+  WriteSegment seg;
+  assert(head_len <= sizeof(seg.head));
+  if (head_len > 0)
+  {
+    std::memcpy(seg.head, head, head_len);
+  }
+  seg.head_len = head_len;
+  seg.shared = buf;
+  m_write_queue_bytes += seg.size();
+  m_write_queue.push_back(std::move(seg));
+  m_wr_watch.setEnabled(!m_freezed);
 } /* TcpConnection::addToWriteBuf */
 
 
 void TcpConnection::onWriteSpaceAvailable(Async::FdWatch* w)
 {
-  ssize_t n = rawWrite(m_write_buf.data(), m_write_buf.size());
+    // Send as many of the queued segments as possible in one system call
+  struct iovec iov[MAX_WRITE_IOV];
+  int iovcnt = 0;
+  for (auto it = m_write_queue.begin();
+       (it != m_write_queue.end()) && (iovcnt + 2 <= MAX_WRITE_IOV); ++it)
+  {
+    if (it->pos < it->head_len)
+    {
+      iov[iovcnt].iov_base = it->head + it->pos;
+      iov[iovcnt].iov_len = it->head_len - it->pos;
+      ++iovcnt;
+    }
+    size_t body_pos = (it->pos > it->head_len) ? (it->pos - it->head_len) : 0;
+    if (body_pos < it->bodySize())
+    {
+      iov[iovcnt].iov_base = const_cast<char*>(it->bodyData()) + body_pos;
+      iov[iovcnt].iov_len = it->bodySize() - body_pos;
+      ++iovcnt;
+    }
+  }
+
+  ssize_t n = rawWrite(iov, iovcnt);
   //std::cout << "### TcpConnection::onWriteSpaceAvailabe:"
   //          << "  fd=" << w->fd()
   //          << "  n=" << n
-  //          << "  bufsize=" << m_write_buf.size()
+  //          << "  bufsize=" << m_write_queue_bytes
   //          << std::endl;
-  assert(n <= static_cast<ssize_t>(m_write_buf.size()));
+  assert(n <= static_cast<ssize_t>(m_write_queue_bytes));
   if (n >= 0)
   {
-    if (n == static_cast<ssize_t>(m_write_buf.size()))
+    size_t left = n;
+    m_write_queue_bytes -= left;
+    while (!m_write_queue.empty())
     {
-      m_write_buf.clear();
-    }
-    else if (n > 0)
-    {
-      std::rotate(m_write_buf.begin(), m_write_buf.begin() + n,
-                  m_write_buf.end());
-      m_write_buf.resize(m_write_buf.size() - n);
+      WriteSegment& seg = m_write_queue.front();
+      size_t seg_left = seg.size() - seg.pos;
+      if (left < seg_left)
+      {
+        seg.pos += left;
+        break;
+      }
+      left -= seg_left;
+      m_write_queue.pop_front();
     }
   }
   else
   {
     perror("### TcpConnection::onWriteSpaceAvailable: rawWrite()");
   }
-  w->setEnabled(!m_write_buf.empty());
+  w->setEnabled(!m_write_queue.empty());
+  if ((n > 0) && (writeQueueBytes() == 0))
+  {
+    onWriteQueueEmpty();
+  }
 } /* TcpConnection::onWriteSpaceAvailable */
 
 
-int TcpConnection::rawWrite(const void* buf, int count)
+ssize_t TcpConnection::rawWrite(const struct iovec* iov, int iovcnt)
 {
   assert(sock != -1);
-  int cnt = ::send(sock, buf, count, MSG_NOSIGNAL);
+  struct msghdr msg;
+  std::memset(&msg, 0, sizeof(msg));
+  msg.msg_iov = const_cast<struct iovec*>(iov);
+  msg.msg_iovlen = iovcnt;
+  ssize_t cnt = ::sendmsg(sock, &msg, MSG_NOSIGNAL);
   if (cnt < 0)
   {
     if (errno != EAGAIN)
@@ -617,19 +908,7 @@ int TcpConnection::rawWrite(const void* buf, int count)
 
 TcpConnection::SslStatus TcpConnection::sslGetStatus(int n)
 {
-  int err = SSL_get_error(m_ssl, n);
-  switch (err)
-  {
-    case SSL_ERROR_NONE:
-      return SSLSTATUS_OK;
-    case SSL_ERROR_WANT_WRITE:
-    case SSL_ERROR_WANT_READ:
-      return SSLSTATUS_WANT_IO;
-    case SSL_ERROR_ZERO_RETURN:
-    case SSL_ERROR_SYSCALL:
-    default:
-      return SSLSTATUS_FAIL;
-  }
+  return sslGetStatus(m_ssl, n);
 } /* TcpConnection::sslGetStatus */
 
 
@@ -638,85 +917,119 @@ int TcpConnection::sslRecvHandler(char* src, int count)
   //std::cout << "### TcpConnection::sslRecvHandler: count=" << count
   //          << std::endl;
 
-  SslStatus status;
-  int n;
+    // A handshake step is running in a worker thread. Keep the data in the
+    // receive buffer until it has finished.
+  if (m_ssl_hs_job != nullptr)
+  {
+    return 0;
+  }
 
   int orig_count = count;
 
-  while (count > 0)
+  do
   {
-    n = BIO_write(m_ssl_rd_bio, src, count);
-    //std::cout << "### BIO_write: n=" << n << std::endl;
-    if (n <= 0)
+    if (count > 0)
     {
-      SslContext::sslPrintErrors("BIO_write");
-      return 0;
-    }
+      int n = BIO_write(m_ssl_rd_bio, src, count);
+      //std::cout << "### BIO_write: n=" << n << std::endl;
+      if (n <= 0)
+      {
+        SslContext::sslPrintErrors("BIO_write");
+        return 0;
+      }
 
-    src += n;
-    count -= n;
+      src += n;
+      count -= n;
+    }
 
-    if (!SSL_is_init_finished(m_ssl))
+    int ret = sslProcessInput();
+    if (ret < 0)
     {
-      if (sslDoHandshake() == SSLSTATUS_FAIL)
-      {
-        SslContext::sslPrintErrors("sslDoHandshake");
-        return -1;
-      }
-      if ((m_ssl == nullptr) || !SSL_is_init_finished(m_ssl))
-      {
-        //std::cout << "### onDataReceived: init not finished" << std::endl;
-        return (orig_count - count);
-      }
+      return -1;
     }
+    if (ret == 0)
+    {
+      break;
+    }
+  } while (count > 0);
+
+  return (orig_count - count);
+} /* TcpConnection::sslRecvHandler */
 
-    /* The encrypted data is now in the input bio so now we can perform actual
-     * read of unencrypted data. */
-    char buf[DEFAULT_BUF_SIZE];
-    //while (SSL_pending(m_ssl) > 0)
-    do
+
+int TcpConnection::sslProcessInput(void)
+{
+  SslStatus status;
+  int n;
+
+  if (!SSL_is_init_finished(m_ssl))
+  {
+    if (m_ssl_worker_pool != nullptr)
     {
-      if (m_ssl == nullptr)
-      {
-        return (orig_count - count);
-      }
-      n = SSL_read(m_ssl, buf, sizeof(buf));
-      //std::cout << "### SSL_read: n=" << n << std::endl;
-      if (n > 0)
+      if (BIO_ctrl_pending(m_ssl_rd_bio) > 0)
       {
-        onDataReceived(buf, n);
+        sslStartHandshakeJob();
       }
-    } while (n > 0);
-
-    status = sslGetStatus(n);
-
-    if (status == SSLSTATUS_FAIL)
+      return 0;
+    }
+    if (sslDoHandshake() == SSLSTATUS_FAIL)
     {
-      SslContext::sslPrintErrors("SSL_read/SSL_pending");
+      SslContext::sslPrintErrors("sslDoHandshake");
       return -1;
     }
+    if ((m_ssl == nullptr) || !SSL_is_init_finished(m_ssl))
+    {
+      //std::cout << "### onDataReceived: init not finished" << std::endl;
+      return 0;
+    }
+  }
 
-    /* Did SSL request to write bytes? This can happen if peer has requested SSL
-     * renegotiation. */
-    if (status == SSLSTATUS_WANT_IO)
+  /* The encrypted data is now in the input bio so now we can perform actual
+   * read of unencrypted data. */
+  char buf[DEFAULT_BUF_SIZE];
+  //while (SSL_pending(m_ssl) > 0)
+  do
+  {
+    if (m_ssl == nullptr)
     {
-      do {
-        n = BIO_read(m_ssl_wr_bio, buf, sizeof(buf));
-        if (n > 0)
-        {
-          addToWriteBuf(buf, n);
-        }
-        else if (!BIO_should_retry(m_ssl_wr_bio))
-        {
-          SslContext::sslPrintErrors("BIO_should_retry");
-          return -1;
-        }
-      } while (n > 0);
+      return 0;
     }
+    n = SSL_read(m_ssl, buf, sizeof(buf));
+    //std::cout << "### SSL_read: n=" << n << std::endl;
+    if (n > 0)
+    {
+      onDataReceived(buf, n);
+    }
+  } while (n > 0);
+
+  status = sslGetStatus(n);
+
+  if (status == SSLSTATUS_FAIL)
+  {
+    SslContext::sslPrintErrors("SSL_read/SSL_pending");
+    return -1;
   }
 
-  return (orig_count - count);
-} /* TcpConnection::sslRecvHandler */
+  /* Did SSL request to write bytes? This can happen if peer has requested SSL
+   * renegotiation. */
+  if (status == SSLSTATUS_WANT_IO)
+  {
+    do {
+      n = BIO_read(m_ssl_wr_bio, buf, sizeof(buf));
+      if (n > 0)
+      {
+        addToWriteBuf(buf, n);
+      }
+      else if (!BIO_should_retry(m_ssl_wr_bio))
+      {
+        SslContext::sslPrintErrors("BIO_should_retry");
+        return -1;
+      }
+    } while (n > 0);
+  }
+
+  return 1;
+} /* TcpConnection::sslProcessInput */
 
 
 enum TcpConnection::SslStatus TcpConnection::sslDoHandshake(void)
@@ -751,12 +1064,135 @@ enum TcpConnection::SslStatus TcpConnection::sslDoHandshake(void)
 } /* TcpConnection::sslDoHandshake */
 
 
+void TcpConnection::sslStartHandshakeJob(void)
+{
+  assert(m_ssl_hs_job == nullptr);
+  auto job = std::make_shared<SslHandshakeJob>();
+  job->con = this;
+  job->ssl = m_ssl;
+  job->pool = m_ssl_worker_pool;
+  m_ssl_hs_job = job;
+
+    // The SSL object must not be touched by the main thread while the
+    // handshake step is running in the worker thread
+  m_ssl_worker_pool->run(
+      [job](void)
+      {
+        {
+          std::lock_guard<std::mutex> lk(job->mutex);
+          if (job->cancelled)
+          {
+            job->state = SslHandshakeJob::STATE_FINISHED;
+            job->cond.notify_all();
+            return;
+          }
+          job->state = SslHandshakeJob::STATE_RUNNING;
+        }
+
+        ssl_hs_job_in_thread = job.get();
+        ERR_clear_error();
+        int n = SSL_do_handshake(job->ssl);
+        SslStatus status = sslGetStatus(job->ssl, n);
+        ssl_hs_job_in_thread = nullptr;
+
+        std::lock_guard<std::mutex> lk(job->mutex);
+        if ((status == SSLSTATUS_FAIL) && !job->cancelled)
+        {
+          SslContext::sslPrintErrors("SSL_do_handshake");
+        }
+        ERR_clear_error();
+        job->status = status;
+        job->state = SslHandshakeJob::STATE_FINISHED;
+        job->cond.notify_all();
+      },
+      [job](void)
+      {
+        if (!job->cancelled)
+        {
+          job->con->sslHandshakeJobDone(job->status);
+        }
+      });
+} /* TcpConnection::sslStartHandshakeJob */
+
+
+void TcpConnection::sslHandshakeJobDone(SslStatus status)
+{
+  m_ssl_hs_job.reset();
+
+  char buf[DEFAULT_BUF_SIZE];
+  if (status == SSLSTATUS_WANT_IO)
+  {
+    int n;
+    do {
+      n = BIO_read(m_ssl_wr_bio, buf, sizeof(buf));
+      if (n > 0)
+      {
+        addToWriteBuf(buf, n);
+      }
+      else if (!BIO_should_retry(m_ssl_wr_bio))
+      {
+        status = SSLSTATUS_FAIL;
+      }
+    } while (n > 0);
+  }
+
+  if ((status != SSLSTATUS_FAIL) && SSL_is_init_finished(m_ssl))
+  {
+    sslConnectionReady(this);
+    sslEncrypt();
+  }
+
+    // Handle data that may already be in the input BIO or that arrived
+    // while the handshake step was running
+  if ((status != SSLSTATUS_FAIL) && (m_ssl != nullptr) && !m_freezed)
+  {
+    if (sslProcessInput() < 0)
+    {
+      status = SSLSTATUS_FAIL;
+    }
+    else if (m_ssl_hs_job == nullptr)
+    {
+      processRecvBuf();
+      return;
+    }
+  }
+
+  if ((status == SSLSTATUS_FAIL) && isConnected())
+  {
+    std::cerr << "*** ERROR: Network communication failed with "
+              << remoteHost() << ":" << remotePort()
+              << std::endl;
+    closeConnection();
+    onDisconnected(DR_PROTOCOL_ERROR);
+  }
+} /* TcpConnection::sslHandshakeJobDone */
+
+
+void TcpConnection::sslAbortHandshakeJob(void)
+{
+  if (m_ssl_hs_job == nullptr)
+  {
+    return;
+  }
+
+    // Wait for a running handshake step to finish. A worker waiting for the
+    // certificate verification result will be released by the cancel flag.
+  auto job = std::move(m_ssl_hs_job);
+  std::unique_lock<std::mutex> lk(job->mutex);
+  job->cancelled = true;
+  job->cond.notify_all();
+  job->cond.wait(lk,
+      [&job]{ return job->state != SslHandshakeJob::STATE_RUNNING; });
+} /* TcpConnection::sslAbortHandshakeJob */
+
+
 int TcpConnection::sslEncrypt(void)
 {
   char buf[DEFAULT_BUF_SIZE];
   SslStatus status;
 
-  if ((m_ssl == nullptr) || !SSL_is_init_finished(m_ssl))
+  if ((m_ssl == nullptr) || (m_ssl_hs_job != nullptr) ||
+      !SSL_is_init_finished(m_ssl))
   {
     return 0;
   }
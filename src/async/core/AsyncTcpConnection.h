@@ -9,7 +9,7 @@ to a remote host. See usage instructions in the class definition.
 
 \verbatim
 Async - A library for programming event driven applications
-Copyright (C) 2003-2025 Tobias Blomberg
+Copyright (C) 2003-2026 Tobias Blomberg
 
 This program is free software; you can redistribute it and/or modify
 it under the terms of the GNU General Public License as published by
@@ -39,6 +39,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 
 #include <sigc++/sigc++.h>
 #include <stdint.h>
+#include <sys/uio.h>
 #include <openssl/bio.h>
 #include <openssl/err.h>
 #include <openssl/pem.h>
@@ -48,7 +49,9 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 #include <cassert>
 #include <cstring>
 #include <vector>
+#include <deque>
 #include <map>
+#include <memory>
 
 
 /****************************************************************************
@@ -95,6 +98,7 @@ namespace Async
  ****************************************************************************/
 
 class IpAddress;
+class WorkerPool;
 
 
 /****************************************************************************
@@ -133,7 +137,10 @@ be encrypted using the setSslContext() and enableSsl() functions.
 
 The reception buffer size given at construction time or using the
 setRecvBufLen() function is an initial value. If during the connection a larger
-buffer is needed the size will be automatically increased.
+buffer is needed the size will be automatically increased. When all received
+data in a larger buffer has been processed, the buffer is shrunk back to the
+given size so that a server with many mostly idle connections does not keep
+the memory needed for the largest burst on each connection.
 */
 class TcpConnection : virtual public sigc::trackable
 {
@@ -152,6 +159,11 @@ class TcpConnection : virtual public sigc::trackable
       DR_BAD_STATE             ///< The connection ended up in a bad state
     } DisconnectReason;
 
+    /**
+     * @brief A reference counted buffer that can be shared by connections
+     */
+    typedef std::shared_ptr<const std::vector<uint8_t>> SharedBuffer;
+
     /**
      * @brief   A sigc return value accumulator for signals returning bool
      *
@@ -222,7 +234,8 @@ class TcpConnection : virtual public sigc::trackable
      * This function will resize the receive buffer to the specified size.
      * If the buffer size is reduced and there are more bytes in the current
      * buffer than can be fitted into the new buffer, the buffer resize
-     * request vill be silently ignored.
+     * request vill be silently ignored. A reduced buffer size is applied when
+     * the buffer is empty.
      */
     void setRecvBufLen(size_t recv_buf_len);
 
@@ -245,6 +258,56 @@ class TcpConnection : virtual public sigc::trackable
      */
     virtual int write(const void *buf, int count);
 
+    /**
+     * @brief   Write a shared buffer to the TCP connection
+     * @param   buf The buffer containing the data to send
+     * @return  Returns the number of bytes written or -1 on failure
+     *
+     * The buffer is queued by reference so that the same data can be written
+     * to many connections without making a copy for each one. The buffer
+     * must not be modified after it has been written. On an encrypted
+     * connection the data is copied into the encryption buffer.
+     */
+    virtual int write(const SharedBuffer& buf);
+
+    /**
+     * @brief   Write data from a number of buffers to the TCP connection
+     * @param   iov     The buffers to send
+     * @param   iovcnt  The number of buffers
+     * @param   prio    Set to \em true to send the data before queued data
+     * @return  Returns the number of bytes written or -1 on failure
+     *
+     * The buffers are sent as one contiguous block of data, just like if
+     * they had been copied into one buffer and written using the write
+     * function. Data written with the prio flag set is placed in the write
+     * queue before all data that has not started to be sent yet, but after
+     * data earlier written with the prio flag set. This makes it possible to
+     * send small, time critical, messages on a connection that also is used
+     * for bulk transfer. Since data is only reordered at write boundaries,
+     * each message must be written using one call for this to work. On an
+     * encrypted connection the prio flag is ignored.
+     */
+    virtual int writev(const struct iovec* iov, int iovcnt, bool prio=false);
+
+    /**
+     * @brief   Get the number of queued write segments
+     * @return  Returns the number of segments waiting to be sent
+     *
+     * Small writes are coalesced into one segment while shared buffers
+     * always use a segment of their own. All queued segments are sent using
+     * one system call when the socket becomes writable.
+     */
+    size_t writeQueueDepth(void) const { return m_write_queue.size(); }
+
+    /**
+     * @brief   Get the number of bytes waiting to be sent
+     * @return  Returns the number of bytes not yet handed over to the OS
+     */
+    size_t writeQueueBytes(void) const
+    {
+      return m_write_queue_bytes + m_ssl_encrypt_buf.size();
+    }
+
     /**
      * @brief   Get the local IP address associated with this connection
      * @return  Returns an IP address
@@ -327,6 +390,18 @@ class TcpConnection : virtual public sigc::trackable
 
     bool isServer(void) const { return m_ssl_is_server; }
 
+    /**
+     * @brief   Run the TLS handshake in a worker pool
+     * @param   pool The worker pool to use or nullptr to disable
+     *
+     * When a worker pool is set, the TLS handshake steps, which include the
+     * expensive public key operations, are run in a worker thread instead of
+     * in the main loop. Data received while a handshake step is running is
+     * buffered and the verifyPeer signal is still emitted from the main loop.
+     * The pool must outlive the connection.
+     */
+    void setSslWorkerPool(WorkerPool* pool) { m_ssl_worker_pool = pool; }
+
     /**
      * @brief   Stop all communication
      *
@@ -399,6 +474,29 @@ class TcpConnection : virtual public sigc::trackable
     sigc::signal<void(TcpConnection*)> sslConnectionReady;
 
   protected:
+    /**
+     * @brief   Write a header followed by a shared buffer
+     * @param   head      The header data, which is copied
+     * @param   head_len  The length of the header, at most eight bytes
+     * @param   buf       The shared buffer to send after the header
+     * @return  Returns the number of bytes written or -1 on failure
+     *
+     * This function is used by protocol implementations that need to send a
+     * small header in front of a shared buffer. The header and the buffer is
+     * sent together using one vectored write.
+     */
+    int writeWithHeader(const void* head, size_t head_len,
+                        const SharedBuffer& buf);
+
+    /**
+     * @brief   Temporarily make room for more data in the receive buffer
+     * @param   len The minimum receive buffer size in bytes
+     *
+     * Unlike setRecvBufLen, this function does not change the configured
+     * buffer size so the buffer is shrunk back when it has been emptied.
+     */
+    void reserveRecvBuf(size_t len) { m_recv_buf.reserve(len); }
+
     /**
      * @brief 	Setup information about the connection
      * @param 	sock  	      The socket for the connection to handle
@@ -471,6 +569,26 @@ class TcpConnection : virtual public sigc::trackable
       return dataReceived(this, buf, count);
     }
 
+    /**
+     * @brief   Check if received data is decrypted before being processed
+     * @return  Returns \em true if SSL is enabled on the connection
+     *
+     * When SSL is active, the data given to onDataReceived is decrypted into
+     * a temporary buffer so any unprocessed data will be lost. Without SSL
+     * the data is given directly from the receive buffer and unprocessed
+     * data is kept until more data arrive.
+     */
+    bool sslActive(void) const { return m_ssl != nullptr; }
+
+    /**
+     * @brief   Called when all queued data has been handed over to the OS
+     *
+     * This function is called by the write handler when the write queue has
+     * become empty. It may be used to close the connection gracefully after
+     * the last data has been sent. The default action is to do nothing.
+     */
+    virtual void onWriteQueueEmpty(void) {}
+
     /**
      * @brief   Emit the disconnected signal
      * @param   reason The reason for the disconnection
@@ -499,6 +617,7 @@ class TcpConnection : virtual public sigc::trackable
     friend class TcpClientBase;
 
     enum SslStatus { SSLSTATUS_OK, SSLSTATUS_WANT_IO, SSLSTATUS_FAIL };
+    struct SslHandshakeJob;
     struct Char
     {
       char value;
@@ -511,17 +630,45 @@ class TcpConnection : virtual public sigc::trackable
       }
     };
 
+    struct WriteSegment
+    {
+      char              head[8];
+      size_t            head_len  = 0;
+      SharedBuffer      shared;
+      std::vector<char> own;
+      size_t            pos       = 0;
+      bool              prio      = false;
+
+      size_t bodySize(void) const
+      {
+        return shared ? shared->size() : own.size();
+      }
+      const char* bodyData(void) const
+      {
+        return shared ? reinterpret_cast<const char*>(shared->data())
+                      : own.data();
+      }
+      size_t size(void) const { return head_len + bodySize(); }
+    };
+    typedef std::deque<WriteSegment> WriteQueue;
+
     static constexpr const size_t DEFAULT_BUF_SIZE = 1024;
+    static constexpr const size_t MAX_COALESCE_SIZE = 16384;
+    static constexpr const int    MAX_WRITE_IOV = 64;
+    static constexpr const size_t MAX_RECV_BATCH = 65536;
 
     static std::map<SSL*, TcpConnection*> ssl_con_map;
+    static thread_local SslHandshakeJob*  ssl_hs_job_in_thread;
 
     IpAddress         remote_addr;
     uint16_t          remote_port         = 0;
     int               sock                = -1;
     FdWatch           rd_watch;
     std::vector<Char> m_recv_buf;
+    size_t            m_recv_buf_len      = DEFAULT_RECV_BUF_LEN;
     Async::FdWatch    m_wr_watch;
-    std::vector<char> m_write_buf;
+    WriteQueue        m_write_queue;
+    size_t            m_write_queue_bytes = 0;
 
     SslContext*       m_ssl_ctx           = nullptr;
     bool              m_ssl_is_server     = false;
@@ -529,6 +676,8 @@ class TcpConnection : virtual public sigc::trackable
     BIO*              m_ssl_rd_bio        = nullptr; // SSL reads, we write
     BIO*              m_ssl_wr_bio        = nullptr; // SSL writes, we read
     std::vector<char> m_ssl_encrypt_buf;
+    WorkerPool*       m_ssl_worker_pool   = nullptr;
+    std::shared_ptr<SslHandshakeJob> m_ssl_hs_job;
 
     bool              m_freezed           = false;
 
@@ -539,16 +688,28 @@ class TcpConnection : virtual public sigc::trackable
     }
     static int sslVerifyCallback(int preverify_ok,
                                  X509_STORE_CTX* x509_store_ctx);
+    static SslStatus sslGetStatus(SSL* ssl, int n);
+    static int sslVerifyInMainThread(SslHandshakeJob* job, int preverify_ok,
+                                     X509_STORE_CTX* x509_store_ctx);
 
     void recvHandler(FdWatch *watch);
     void processRecvBuf(void);
+    void shrinkRecvBuf(void);
     void addToWriteBuf(const char *buf, size_t len);
+    void addToWriteBuf(const struct iovec* iov, int iovcnt, size_t len,
+                       bool prio);
+    void addToWriteBuf(const void *head, size_t head_len,
+                       const SharedBuffer& buf);
     void onWriteSpaceAvailable(Async::FdWatch* w);
-    int rawWrite(const void* buf, int count);
+    ssize_t rawWrite(const struct iovec* iov, int iovcnt);
 
     SslStatus sslGetStatus(int n);
     int sslRecvHandler(char* src, int count);
+    int sslProcessInput(void);
     SslStatus sslDoHandshake(void);
+    void sslStartHandshakeJob(void);
+    void sslHandshakeJobDone(SslStatus status);
+    void sslAbortHandshakeJob(void);
     int sslEncrypt(void);
     int sslWrite(const void* buf, int count);
 
@@ -6,7 +6,7 @@
 
 \verbatim
 Async - A library for programming event driven applications
-Copyright (C) 2003-2022 Tobias Blomberg / SM0SVX
+Copyright (C) 2003-2026 Tobias Blomberg / SM0SVX
 
 This program is free software; you can redistribute it and/or modify
 it under the terms of the GNU General Public License as published by
@@ -31,6 +31,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
  ****************************************************************************/
 
 #include <sys/time.h>
+#include <algorithm>
 #include <cassert>
 
 
@@ -132,6 +133,10 @@ class TcpPrioClientBase::Machine
     {
       ctx.connect_retry_wait.setRandomizePercent(p);
     }
+    void setFastFailover(bool enable)
+    {
+      ctx.fast_failover = enable;
+    }
 
     void setLookupParams(const std::string& label, DnsLookup::Type type)
     {
@@ -242,6 +247,7 @@ class TcpPrioClientBase::Machine
       DnsSRVList::iterator            next_rr                 = rrs.end();
       BackoffTime                     connect_retry_wait;
       bool                            marked_as_established   = false;
+      bool                            fast_failover           = false;
 
       Context(TcpPrioClientBase *client)
         : client(client), bg_con(client->newTcpClient()) {}
@@ -491,7 +497,28 @@ class TcpPrioClientBase::Machine
       virtual void disconnectedEvent(void) noexcept override
       {
         DEBUG_EVENT;
-        if (ctx().marked_as_established)
+        if (ctx().marked_as_established && ctx().fast_failover &&
+            (ctx().rrs.size() > 1))
+        {
+            // Try the rest of the list, starting over from the highest
+            // priority host if the lost one was the last in the list
+          auto& rrs = ctx().rrs;
+          auto it = std::find_if(rrs.begin(), rrs.end(),
+              [&](const Context::DnsSRVList::value_type& rr)
+              {
+                return (rr->target() == ctx().remoteHostName()) &&
+                       (rr->port() == ctx().remotePort());
+              });
+          if ((it != rrs.end()) && (std::next(it) == rrs.end()))
+          {
+            it = rrs.end();
+          }
+          ctx().next_rr = it;
+          ctx().marked_as_established = false;
+          ctx().connect_retry_wait.reset();
+          setState<StateConnectingTryConnect>();
+        }
+        else if (ctx().marked_as_established)
         {
           setState<StateConnectingIdle>();
         }
@@ -716,6 +743,12 @@ void TcpPrioClientBase::setReconnectRandomizePercent(unsigned p)
 }
 
 
+void TcpPrioClientBase::setFastFailover(bool enable)
+{
+  machine()->setFastFailover(enable);
+} /* TcpPrioClientBase::setFastFailover */
+
+
 void TcpPrioClientBase::setService(const std::string& srv_name,
                                    const std::string& srv_proto,
                                    const std::string& srv_domain)
@@ -9,7 +9,7 @@ Async::TcpPrioClient for more information.
 
 \verbatim
 Async - A library for programming event driven applications
-Copyright (C) 2003-2024 Tobias Blomberg
+Copyright (C) 2003-2026 Tobias Blomberg
 
 This program is free software; you can redistribute it and/or modify
 it under the terms of the GNU General Public License as published by
@@ -169,6 +169,20 @@ class TcpPrioClientBase : public TcpClientBase
      */
     void setReconnectRandomizePercent(unsigned p);
 
+    /**
+     * @brief   Fail over directly to the next host when a connection is lost
+     * @param   enable Set to \em true to enable fast failover
+     *
+     * Normally, when an established connection is lost, the reconnect timer
+     * is started and a new DNS lookup is made before the first host in the
+     * list is tried again. With fast failover enabled, the next host in the
+     * previously looked up list is tried immediately instead. If all hosts
+     * fail, the normal reconnect procedure is used. A connection to a host of
+     * lower priority will switch back to the highest priority host as usual
+     * when it comes back.
+     */
+    void setFastFailover(bool enable);
+
     /**
      * @brief   Use a DNS service resource record for connections
      * @param   srv_name    The name of the service
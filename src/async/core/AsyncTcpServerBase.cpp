@@ -6,7 +6,7 @@
 
 \verbatim
 Async - A library for programming event driven applications
-Copyright (C) 2003-2025 Tobias Blomberg / SM0SVX
+Copyright (C) 2003-2026 Tobias Blomberg / SM0SVX
 
 This program is free software; you can redistribute it and/or modify
 it under the terms of the GNU General Public License as published by
@@ -123,7 +123,8 @@ using namespace Async;
 
 TcpServerBase::TcpServerBase(const string& port_str,
                              const Async::IpAddress &bind_ip)
-  : m_sock(-1), m_rd_watch(0), m_con_throt_timer(-1, Timer::TYPE_PERIODIC)
+  : m_sock(-1), m_rd_watch(0), m_con_throt_timer(-1, Timer::TYPE_PERIODIC),
+    m_admit_timer(ADMIT_INTERVAL, Timer::TYPE_PERIODIC, false)
 {
   if ((m_sock = socket(AF_INET, SOCK_STREAM, 0)) == -1)
   {
@@ -192,7 +193,9 @@ TcpServerBase::TcpServerBase(const string& port_str,
     return;
   }
 
-  if (listen(m_sock, 5) != 0)
+    // A short backlog would make the kernel drop connections during a
+    // reconnect storm, which then are retried only after seconds
+  if (listen(m_sock, SOMAXCONN) != 0)
   {
     perror("listen");
     cleanup();
@@ -204,6 +207,8 @@ TcpServerBase::TcpServerBase(const string& port_str,
 
   m_con_throt_timer.expired.connect(
       sigc::mem_fun(*this, &TcpServerBase::updateConnThrotMap));
+  m_admit_timer.expired.connect(
+      sigc::mem_fun(*this, &TcpServerBase::updateAdmission));
 } /* TcpServerBase::TcpServerBase */
 
 
@@ -314,6 +319,30 @@ void TcpServerBase::setConnectionThrottling(unsigned bucket_max,
 } /* TcpServerBase::setConnectionThrottling */
 
 
+void TcpServerBase::setAdmissionRate(unsigned burst, unsigned rate)
+{
+  if (rate > 0)
+  {
+    m_admit_bucket_max = 1000 * std::max(burst, 1U);
+    m_admit_bucket_inc = rate * ADMIT_INTERVAL;
+    m_admit_bucket = m_admit_bucket_max;
+  }
+  else
+  {
+    m_admit_bucket_max = 0;
+    m_admit_bucket_inc = 0;
+    m_admit_timer.setEnable(false);
+    auto pending = std::move(m_admit_pending);
+    m_admit_pending.clear();
+    for (auto con : pending)
+    {
+      emitClientConnected(con);
+      con->unfreeze();
+    }
+  }
+} /* TcpServerBase::setAdmissionRate */
+
+
 /****************************************************************************
  *
  * Protected member functions
@@ -325,6 +354,7 @@ void TcpServerBase::addConnection(TcpConnection *con)
   if (m_ssl_ctx != nullptr)
   {
     con->setSslContext(*m_ssl_ctx, true);
+    con->setSslWorkerPool(m_ssl_worker_pool);
   }
   m_tcpConnectionList.push_back(con);
 
@@ -341,7 +371,7 @@ void TcpServerBase::addConnection(TcpConnection *con)
     if (it->second.m_bucket >= 1000)
     {
       it->second.m_bucket -= 1000;
-      emitClientConnected(con);
+      admitConnection(con);
     }
     else
     {
@@ -352,7 +382,7 @@ void TcpServerBase::addConnection(TcpConnection *con)
   }
   else
   {
-    emitClientConnected(con);
+    admitConnection(con);
   }
 } /* TcpServerBase::addConnection */
 
@@ -366,6 +396,12 @@ void TcpServerBase::removeConnection(TcpConnection *con)
   }
   m_tcpConnectionList.erase(it);
 
+  auto admit_it = find(m_admit_pending.begin(), m_admit_pending.end(), con);
+  if (admit_it != m_admit_pending.end())
+  {
+    m_admit_pending.erase(admit_it);
+  }
+
   for (auto& map_item : m_con_throt_map)
   {
     if (map_item.first == con->remoteHost())
@@ -401,6 +437,7 @@ void TcpServerBase::cleanup(void)
   }
 
   m_con_throt_map.clear();
+  m_admit_pending.clear();
 
     // If there are any connected clients, disconnect them and clear the list
   TcpConnectionList::const_iterator it;
@@ -472,8 +509,10 @@ void TcpServerBase::updateConnThrotMap(Timer*)
       item.m_bucket -= 1000;
       auto con = *con_it;
       item.m_pending_connections.erase(con_it);
-      emitClientConnected(con);
-      con->unfreeze();
+      if (admitConnection(con))
+      {
+        con->unfreeze();
+      }
     }
     if (it->second.m_bucket >= m_con_throt_bucket_max)
     {
@@ -487,6 +526,46 @@ void TcpServerBase::updateConnThrotMap(Timer*)
 } /* TcpServerBase::updateConnThrotMap */
 
 
+bool TcpServerBase::admitConnection(TcpConnection *con)
+{
+  if (m_admit_bucket_max == 0)
+  {
+    emitClientConnected(con);
+    return true;
+  }
+
+  if (!m_admit_pending.empty() || (m_admit_bucket < 1000))
+  {
+    con->freeze();
+    m_admit_pending.push_back(con);
+    m_admit_timer.setEnable(true);
+    return false;
+  }
+
+  m_admit_bucket -= 1000;
+  m_admit_timer.setEnable(true);
+  emitClientConnected(con);
+  return true;
+} /* TcpServerBase::admitConnection */
+
+
+void TcpServerBase::updateAdmission(Timer*)
+{
+  m_admit_bucket = std::min(m_admit_bucket + m_admit_bucket_inc,
+                            m_admit_bucket_max);
+  while (!m_admit_pending.empty() && (m_admit_bucket >= 1000))
+  {
+    m_admit_bucket -= 1000;
+    auto con = m_admit_pending.front();
+    m_admit_pending.erase(m_admit_pending.begin());
+    emitClientConnected(con);
+    con->unfreeze();
+  }
+  m_admit_timer.setEnable(!m_admit_pending.empty() ||
+                          (m_admit_bucket < m_admit_bucket_max));
+} /* TcpServerBase::updateAdmission */
+
+
 /*
  * This file has not been truncated
  */
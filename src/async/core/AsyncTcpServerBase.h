@@ -6,7 +6,7 @@
 
 \verbatim
 Async - A library for programming event driven applications
-Copyright (C) 2003-2025 Tobias Blomberg / SM0SVX
+Copyright (C) 2003-2026 Tobias Blomberg / SM0SVX
 
 This program is free software; you can redistribute it and/or modify
 it under the terms of the GNU General Public License as published by
@@ -83,6 +83,7 @@ namespace Async
  ****************************************************************************/
 
 class FdWatch;
+class WorkerPool;
 
 
 /****************************************************************************
@@ -183,6 +184,18 @@ class TcpServerBase : public sigc::trackable
      */
     void setSslContext(SslContext& ctx);
 
+    /**
+     * @brief   Set a worker pool to use for TLS handshakes
+     * @param   pool The worker pool to use or nullptr to disable
+     *
+     * When set, the pool is applied automatically for all client connections
+     * so that the TLS handshakes are run in worker threads instead of in the
+     * main loop. Have a look at TcpConnection::setSslWorkerPool for more
+     * information. The pool is not managed by this class and it must outlive
+     * this class and all connections.
+     */
+    void setSslWorkerPool(WorkerPool* pool) { m_ssl_worker_pool = pool; }
+
     /**
      * @brief   Enable connection throttling
      * @param   bucket_max The size of the bucket
@@ -205,6 +218,24 @@ class TcpServerBase : public sigc::trackable
     void setConnectionThrottling(unsigned bucket_max, float bucket_inc,
                                  int inc_interval_ms);
 
+    /**
+     * @brief   Limit the total rate at which new connections are admitted
+     * @param   burst The number of connections admitted without delay
+     * @param   rate  The sustained number of connections admitted per second
+     *
+     * While setConnectionThrottling limit the connection rate for each IP
+     * address, this function put a limit on the rate for all connections
+     * together. It is meant to shape connection storms, e.g. when all clients
+     * reconnect at the same time after a restart of the server. The same
+     * "token bucket" algorithm is used. Connections that arrive when the
+     * bucket is empty are accepted but frozen and queued. They are handed
+     * over to the application, one per token, in the order they arrived. That
+     * way expensive work like TLS handshakes are spread out over time and the
+     * already established connections are not starved. Set the rate to zero
+     * to disable admission control.
+     */
+    void setAdmissionRate(unsigned burst, unsigned rate);
+
   protected:
     virtual void createConnection(int sock, const IpAddress& remote_addr,
                                   uint16_t remote_port) = 0;
@@ -222,19 +253,30 @@ class TcpServerBase : public sigc::trackable
     };
     using ConThrotMap = std::map<IpAddress, ConThrotItem>;
 
+    static constexpr int ADMIT_INTERVAL = 100; // Admission tick in ms
+
     int               m_sock;
     FdWatch*          m_rd_watch;
     TcpConnectionList m_tcpConnectionList;
     SslContext*       m_ssl_ctx               = nullptr;
+    WorkerPool*       m_ssl_worker_pool       = nullptr;
 
     ConThrotMap       m_con_throt_map;
     Timer             m_con_throt_timer;
     unsigned          m_con_throt_bucket_max  = 0;
     unsigned          m_con_throt_bucket_inc  = 0;
 
+    TcpConnectionList m_admit_pending;
+    Timer             m_admit_timer;
+    unsigned          m_admit_bucket          = 0;
+    unsigned          m_admit_bucket_max      = 0;
+    unsigned          m_admit_bucket_inc      = 0;
+
     void cleanup(void);
     void onConnection(FdWatch *watch);
     void updateConnThrotMap(Timer*);
+    bool admitConnection(TcpConnection *con);
+    void updateAdmission(Timer*);
 
 };  /* class TcpServerBase */
 
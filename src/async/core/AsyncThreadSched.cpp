@@ -0,0 +1,346 @@
+/**
+@file   AsyncThreadSched.cpp
+@brief  Real time priority and CPU affinity for the threads of a program
+@author Tobias Blomberg / SM0SVX
+@date   2026-10-14
+
+\verbatim
+Async - A library for programming event driven applications
+Copyright (C) 2003-2026 Tobias Blomberg / SM0SVX
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+\endverbatim
+*/
+
+/****************************************************************************
+ *
+ * System Includes
+ *
+ ****************************************************************************/
+
+#include <sched.h>
+#include <sys/mman.h>
+
+#include <map>
+#include <mutex>
+#include <sstream>
+#include <iostream>
+#include <algorithm>
+#include <cstring>
+#include <cerrno>
+#include <cstdlib>
+
+
+/****************************************************************************
+ *
+ * Project Includes
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Local Includes
+ *
+ ****************************************************************************/
+
+#include "AsyncThreadSched.h"
+
+
+
+/****************************************************************************
+ *
+ * Namespaces to use
+ *
+ ****************************************************************************/
+
+using namespace Async;
+
+
+
+/****************************************************************************
+ *
+ * Defines & typedefs
+ *
+ ****************************************************************************/
+
+#ifdef CPU_SETSIZE
+#define MAX_CPUS CPU_SETSIZE
+#else
+#define MAX_CPUS 1024
+#endif
+
+
+/****************************************************************************
+ *
+ * Local class definitions
+ *
+ ****************************************************************************/
+
+namespace {
+  struct Registry
+  {
+    std::mutex                                          mutex;
+    std::map<std::string, ThreadSched::Params>          params;
+    std::multimap<std::string, pthread_t>               threads;
+  };
+};
+
+
+/****************************************************************************
+ *
+ * Prototypes
+ *
+ ****************************************************************************/
+
+namespace {
+  Registry& registry(void);
+  bool applyParams(const std::string& thread_class, pthread_t thread,
+                   const ThreadSched::Params& params);
+};
+
+
+/****************************************************************************
+ *
+ * Exported Global Variables
+ *
+ ****************************************************************************/
+
+
+
+
+/****************************************************************************
+ *
+ * Local Global Variables
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Public member functions
+ *
+ ****************************************************************************/
+
+ThreadSched::Registration::Registration(const std::string& thread_class)
+  : m_thread_class(thread_class), m_thread(pthread_self())
+{
+  Registry& reg = registry();
+  std::lock_guard<std::mutex> lk(reg.mutex);
+  reg.threads.emplace(m_thread_class, m_thread);
+  auto it = reg.params.find(m_thread_class);
+  if (it != reg.params.end())
+  {
+    applyParams(m_thread_class, m_thread, it->second);
+  }
+} /* ThreadSched::Registration::Registration */
+
+
+ThreadSched::Registration::~Registration(void)
+{
+  Registry& reg = registry();
+  std::lock_guard<std::mutex> lk(reg.mutex);
+  auto range = reg.threads.equal_range(m_thread_class);
+  for (auto it = range.first; it != range.second; ++it)
+  {
+    if (pthread_equal(it->second, m_thread))
+    {
+      reg.threads.erase(it);
+      break;
+    }
+  }
+} /* ThreadSched::Registration::~Registration */
+
+
+bool ThreadSched::setParams(const std::string& thread_class,
+                            const Params& params)
+{
+  Registry& reg = registry();
+  std::lock_guard<std::mutex> lk(reg.mutex);
+  reg.params[thread_class] = params;
+  bool success = true;
+  auto range = reg.threads.equal_range(thread_class);
+  for (auto it = range.first; it != range.second; ++it)
+  {
+    success &= applyParams(thread_class, it->second, params);
+  }
+  return success;
+} /* ThreadSched::setParams */
+
+
+bool ThreadSched::parseCpuList(const std::string& str,
+                               std::vector<unsigned>& cpus)
+{
+  cpus.clear();
+  std::istringstream ss(str);
+  std::string range;
+  while (std::getline(ss, range, '+'))
+  {
+    const char *begin = range.c_str();
+    char *end = nullptr;
+    unsigned long first = strtoul(begin, &end, 10);
+    if (end == begin)
+    {
+      return false;
+    }
+    unsigned long last = first;
+    if (*end == '-')
+    {
+      begin = end + 1;
+      last = strtoul(begin, &end, 10);
+      if (end == begin)
+      {
+        return false;
+      }
+    }
+    if ((*end != '\0') || (first > last) || (last >= MAX_CPUS))
+    {
+      return false;
+    }
+    for (unsigned long cpu=first; cpu<=last; ++cpu)
+    {
+      cpus.push_back(cpu);
+    }
+  }
+  std::sort(cpus.begin(), cpus.end());
+  cpus.erase(std::unique(cpus.begin(), cpus.end()), cpus.end());
+  return !cpus.empty();
+} /* ThreadSched::parseCpuList */
+
+
+std::string ThreadSched::cpuListString(const std::vector<unsigned>& cpus)
+{
+  std::ostringstream ss;
+  for (size_t i=0; i<cpus.size(); )
+  {
+    size_t j = i;
+    while ((j+1 < cpus.size()) && (cpus[j+1] == cpus[j] + 1))
+    {
+      ++j;
+    }
+    if (i > 0)
+    {
+      ss << "+";
+    }
+    ss << cpus[i];
+    if (j > i)
+    {
+      ss << "-" << cpus[j];
+    }
+    i = j + 1;
+  }
+  return ss.str();
+} /* ThreadSched::cpuListString */
+
+
+bool ThreadSched::lockMemory(void)
+{
+  if (mlockall(MCL_CURRENT | MCL_FUTURE) != 0)
+  {
+    std::cerr << "*** WARNING: Could not lock the process memory: "
+              << strerror(errno) << std::endl;
+    return false;
+  }
+  return true;
+} /* ThreadSched::lockMemory */
+
+
+
+/****************************************************************************
+ *
+ * Protected member functions
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Private member functions
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Local functions
+ *
+ ****************************************************************************/
+
+namespace {
+  Registry& registry(void)
+  {
+      // The registry is never destroyed since threads may unregister
+      // during the destruction of static objects
+    static Registry *reg = new Registry;
+    return *reg;
+  } /* registry */
+
+
+  bool applyParams(const std::string& thread_class, pthread_t thread,
+                   const ThreadSched::Params& params)
+  {
+    bool success = true;
+    if (params.rt_prio > 0)
+    {
+      sched_param param;
+      memset(&param, 0, sizeof(param));
+      param.sched_priority = params.rt_prio;
+      int err = pthread_setschedparam(thread, SCHED_FIFO, &param);
+      if (err != 0)
+      {
+        std::cerr << "*** WARNING: Could not set real time priority "
+                  << params.rt_prio << " for thread \"" << thread_class
+                  << "\": " << strerror(err) << std::endl;
+        success = false;
+      }
+    }
+    if (!params.cpus.empty())
+    {
+#ifdef HAS_PTHREAD_SETAFFINITY
+      cpu_set_t cpuset;
+      CPU_ZERO(&cpuset);
+      for (unsigned cpu : params.cpus)
+      {
+        CPU_SET(cpu, &cpuset);
+      }
+      int err = pthread_setaffinity_np(thread, sizeof(cpuset), &cpuset);
+      if (err != 0)
+      {
+        std::cerr << "*** WARNING: Could not set CPU affinity "
+                  << ThreadSched::cpuListString(params.cpus)
+                  << " for thread \"" << thread_class << "\": "
+                  << strerror(err) << std::endl;
+        success = false;
+      }
+#else
+      std::cerr << "*** WARNING: Setting the CPU affinity for thread \""
+                << thread_class << "\" is not supported on this platform"
+                << std::endl;
+      success = false;
+#endif
+    }
+    return success;
+  } /* applyParams */
+};
+
+
+
+/*
+ * This file has not been truncated
+ */
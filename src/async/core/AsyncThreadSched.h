@@ -0,0 +1,225 @@
+/**
+@file   AsyncThreadSched.h
+@brief  Real time priority and CPU affinity for the threads of a program
+@author Tobias Blomberg / SM0SVX
+@date   2026-10-14
+
+\verbatim
+Async - A library for programming event driven applications
+Copyright (C) 2003-2026 Tobias Blomberg / SM0SVX
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+\endverbatim
+*/
+
+#ifndef ASYNC_THREAD_SCHED_INCLUDED
+#define ASYNC_THREAD_SCHED_INCLUDED
+
+
+/****************************************************************************
+ *
+ * System Includes
+ *
+ ****************************************************************************/
+
+#include <pthread.h>
+
+#include <string>
+#include <vector>
+
+
+/****************************************************************************
+ *
+ * Project Includes
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Local Includes
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Forward declarations
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Namespace
+ *
+ ****************************************************************************/
+
+namespace Async
+{
+
+
+/****************************************************************************
+ *
+ * Forward declarations of classes inside of the declared namespace
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Defines & typedefs
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Exported Global Variables
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Class definitions
+ *
+ ****************************************************************************/
+
+/**
+@brief  Real time priority and CPU affinity for the threads of a program
+@author Tobias Blomberg / SM0SVX
+@date   2026-10-14
+
+This class is used to control the scheduling of the threads in a program. Each
+thread that want to be controlled register itself using a Registration object,
+giving the class of thread it belong to, e.g. "main", "logwriter" or "dns".
+Scheduling parameters, a real time (SCHED_FIFO) priority and a set of CPUs to
+run on, are then set per thread class using setParams. The parameters are
+applied both to threads that are already registered and to threads that
+register later on.
+
+\code
+  void MyClass::threadFunc(void)
+  {
+    Async::ThreadSched::Registration reg("myclass");
+    ...
+  }
+\endcode
+
+All functions are thread safe.
+*/
+class ThreadSched
+{
+  public:
+    /**
+     * @brief The scheduling parameters for a class of threads
+     */
+    struct Params
+    {
+      int                   rt_prio = 0;  ///< SCHED_FIFO priority, 0=unset
+      std::vector<unsigned> cpus;         ///< CPUs to run on, empty=unset
+    };
+
+    /**
+     * @brief Register the current thread during the lifetime of this object
+     *
+     * A Registration object should be created as a local variable first in
+     * the thread function so that the thread is unregistered before it
+     * exit.
+     */
+    class Registration
+    {
+      public:
+        /**
+         * @brief   Constructor
+         * @param   thread_class The class of thread the current thread is
+         */
+        explicit Registration(const std::string& thread_class);
+
+        /**
+         * @brief   Destructor
+         */
+        ~Registration(void);
+
+      private:
+        std::string m_thread_class;
+        pthread_t   m_thread;
+
+        Registration(const Registration&);
+        Registration& operator=(const Registration&);
+    };
+
+    /**
+     * @brief   Set the scheduling parameters for a class of threads
+     * @param   thread_class The class of threads to set parameters for
+     * @param   params The scheduling parameters
+     * @return  Returns \em false if the parameters could not be applied to
+     *          a thread that is already registered
+     */
+    static bool setParams(const std::string& thread_class,
+                          const Params& params);
+
+    /**
+     * @brief   Parse a list of CPUs
+     * @param   str The string to parse, e.g. "0-2+5"
+     * @param   cpus The parsed CPU numbers are returned here
+     * @return  Returns \em true on success or else \em false
+     *
+     * A CPU list is a '+' separated list of CPU numbers or ranges of CPU
+     * numbers. The character '+' is used instead of ',' so that CPU lists
+     * can be given in comma separated configuration variables.
+     */
+    static bool parseCpuList(const std::string& str,
+                             std::vector<unsigned>& cpus);
+
+    /**
+     * @brief   Format a list of CPUs
+     * @param   cpus The CPU numbers
+     * @return  Returns a string in the same format as parseCpuList handle
+     */
+    static std::string cpuListString(const std::vector<unsigned>& cpus);
+
+    /**
+     * @brief   Lock all current and future memory pages of the process
+     * @return  Returns \em true on success or else \em false
+     *
+     * Locking the memory in RAM avoid page faults, e.g. in the audio path,
+     * when the system is under memory pressure. This require root privileges
+     * or the CAP_IPC_LOCK capability (e.g. LimitMEMLOCK in the systemd unit).
+     */
+    static bool lockMemory(void);
+
+  private:
+    ThreadSched(void);
+
+};  /* class ThreadSched */
+
+
+} /* namespace */
+
+#endif /* ASYNC_THREAD_SCHED_INCLUDED */
+
+
+
+/*
+ * This file has not been truncated
+ */
@@ -10,7 +10,7 @@ class documentation.
 
 \verbatim
 Async - A library for programming event driven applications
-Copyright (C) 2003-2022 Tobias Blomberg
+Copyright (C) 2003-2026 Tobias Blomberg
 
 This program is free software; you can redistribute it and/or modify
 it under the terms of the GNU General Public License as published by
@@ -121,6 +121,7 @@ using namespace Async;
 Timer::Timer(int timeout_ms, Type type, bool enabled)
   : m_type(type), m_timeout_ms(timeout_ms), m_is_enabled(false)
 {
+  Application::object_counts.timers += 1;
   setEnable(enabled && (timeout_ms >= 0));
 } /* Timer::Timer */
 
@@ -129,6 +130,7 @@ Timer::~Timer(void)
 {
   //expired.clear();
   setEnable(false);
+  Application::object_counts.timers -= 1;
 } /* Timer::~Timer */
 
 
@@ -153,11 +155,13 @@ void Timer::setEnable(bool do_enable)
   {
     Application::app().addTimer(this);
     m_is_enabled = true;
+    Application::object_counts.enabled_timers += 1;
   }
   else if (!do_enable && m_is_enabled)
   {
     Application::app().delTimer(this);
     m_is_enabled = false;
+    Application::object_counts.enabled_timers -= 1;
   }
 } /* Timer::setEnable */
 
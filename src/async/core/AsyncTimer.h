@@ -198,6 +198,42 @@ class Timer : public sigc::trackable
      * If the timer is disabled, this function will do nothing.
      */
     void reset(void);
+
+    /**
+     * @brief   Set how late the timer is allowed to expire
+     * @param   slack_ms The allowed slack in milliseconds, 0 for none
+     *
+     * A timer that is allowed to expire a little late can be coalesced with
+     * other timers so that the process wake up less often. The expiration
+     * time is rounded up to a multiple of the slack, so all timers using
+     * the same slack expire in the same event loop wakeup. The slack take
+     * effect the next time the timer is started, reset or, for periodic
+     * timers, restarted after expiring. Not all application types support
+     * timer slack.
+     */
+    void setSlack(int slack_ms) { m_slack_ms = slack_ms; }
+
+    /**
+     * @brief   Get the allowed slack
+     * @return  Returns the allowed slack in milliseconds
+     */
+    int slack(void) const { return m_slack_ms; }
+
+    /**
+     * @brief   Give the timer a name
+     * @param   name The name of the timer
+     *
+     * The name is used to identify the timer in the event loop statistics,
+     * like the wakeup audit. The string is not copied so it must be valid
+     * as long as the timer exist, for example a string literal.
+     */
+    void setName(const char *name) { m_name = name; }
+
+    /**
+     * @brief   Get the name of the timer
+     * @return  Returns the name of the timer or 0 if no name has been set
+     */
+    const char *name(void) const { return m_name; }
     
     /**
      * @brief 	A signal that is emitted when the timer expires
@@ -213,9 +249,17 @@ class Timer : public sigc::trackable
   protected:
     
   private:
-    Type  m_type;
-    int   m_timeout_ms;
-    bool  m_is_enabled;
+    friend class Application;
+
+    Type        m_type;
+    int         m_timeout_ms;
+    bool        m_is_enabled;
+    int         m_slack_ms      = 0;
+    const char* m_name          = 0;
+
+      // Opaque data owned by the application backend, e.g. the timer wheel
+      // entry of the CppApplication, while the timer is enabled
+    void*       m_backend_data  = 0;
   
 };  /* class Timer */
 
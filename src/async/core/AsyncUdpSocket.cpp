@@ -37,6 +37,7 @@
 
 #include <sys/types.h>
 #include <sys/socket.h>
+#include <sys/stat.h>
 #include <arpa/inet.h>
 #include <unistd.h>
 #include <fcntl.h>
@@ -44,7 +45,12 @@
 
 #include <cerrno>
 #include <cstdio>
+#include <cstdlib>
 #include <cstring>
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <sstream>
 
 
 /****************************************************************************
@@ -115,6 +121,63 @@ class UdpPacket
  *
  ****************************************************************************/
 
+namespace {
+#if defined(HAS_SENDMMSG) && defined(HAS_RECVMMSG)
+  typedef struct mmsghdr MultiMsgHdr;
+
+  int sendMultiMsg(int sockfd, MultiMsgHdr *msgvec, unsigned int vlen)
+  {
+    return sendmmsg(sockfd, msgvec, vlen, 0);
+  }
+
+  int recvMultiMsg(int sockfd, MultiMsgHdr *msgvec, unsigned int vlen)
+  {
+    return recvmmsg(sockfd, msgvec, vlen, MSG_DONTWAIT, NULL);
+  }
+#else
+    // Emulate sendmmsg/recvmmsg on systems that lack them. Just like the real
+    // thing, an error is only returned if the first message failed.
+  struct MultiMsgHdr
+  {
+    struct msghdr msg_hdr;
+    unsigned int  msg_len;
+  };
+
+  int sendMultiMsg(int sockfd, MultiMsgHdr *msgvec, unsigned int vlen)
+  {
+    unsigned int i;
+    for (i=0; i<vlen; ++i)
+    {
+      ssize_t ret = sendmsg(sockfd, &msgvec[i].msg_hdr, 0);
+      if (ret == -1)
+      {
+        return (i > 0) ? static_cast<int>(i) : -1;
+      }
+      msgvec[i].msg_len = ret;
+    }
+    return static_cast<int>(i);
+  }
+
+  int recvMultiMsg(int sockfd, MultiMsgHdr *msgvec, unsigned int vlen)
+  {
+    unsigned int i;
+    for (i=0; i<vlen; ++i)
+    {
+      ssize_t ret = recvmsg(sockfd, &msgvec[i].msg_hdr, MSG_DONTWAIT);
+      if (ret == -1)
+      {
+        return (i > 0) ? static_cast<int>(i) : -1;
+      }
+      msgvec[i].msg_len = ret;
+    }
+    return static_cast<int>(i);
+  }
+#endif
+
+    // The maximum number of datagrams to hand to the kernel in one call
+  const unsigned BATCH_CHUNK_SIZE = 64;
+};
+
 
 
 /****************************************************************************
@@ -153,8 +216,10 @@ class UdpPacket
  * Bugs:      
  *------------------------------------------------------------------------
  */
-UdpSocket::UdpSocket(uint16_t local_port, const IpAddress &bind_ip)
-  : sock(-1), rd_watch(0), wr_watch(0), send_buf(0)
+UdpSocket::UdpSocket(uint16_t local_port, const IpAddress &bind_ip,
+                     bool reuse_port)
+  : sock(-1), rd_watch(0), wr_watch(0), send_buf(0), batching(false),
+    batch_pending(false), batch_pos(0), rx_batch_size(1), rx_deleted(0)
 {
     // Create UDP socket
   sock = socket(AF_INET, SOCK_DGRAM, 0);
@@ -173,6 +238,24 @@ UdpSocket::UdpSocket(uint16_t local_port, const IpAddress &bind_ip)
     return;
   }
   
+  if (reuse_port)
+  {
+#ifdef SO_REUSEPORT
+    int on = 1;
+    if (setsockopt(sock, SOL_SOCKET, SO_REUSEPORT, &on, sizeof(on)) == -1)
+    {
+      perror("setsockopt(sock, SO_REUSEPORT)");
+      cleanup();
+      return;
+    }
+#else
+    std::cerr << "*** ERROR: SO_REUSEPORT is not supported on this platform"
+              << std::endl;
+    cleanup();
+    return;
+#endif
+  }
+
     // Bind the socket to a local port if one was specified
   if (local_port > 0)
   {
@@ -214,6 +297,10 @@ UdpSocket::UdpSocket(uint16_t local_port, const IpAddress &bind_ip)
 
 UdpSocket::~UdpSocket(void)
 {
+  if (rx_deleted != 0)
+  {
+    *rx_deleted = true;
+  }
   cleanup();
 } /* UdpSocket::~UdpSocket */
 
@@ -255,10 +342,23 @@ uint16_t UdpSocket::localPort(void) const
 bool UdpSocket::write(const IpAddress& remote_ip, int remote_port,
     const void *buf, int count)
 {
-  if (send_buf != 0)
+  if ((send_buf != 0) || batch_pending)
   {
     return false;
   }
+
+  if (batching)
+  {
+    BatchEntry entry;
+    entry.ip = remote_ip;
+    entry.port = remote_port;
+    entry.offset = batch_buf.size();
+    entry.len = count;
+    batch.push_back(entry);
+    const uint8_t *ptr = static_cast<const uint8_t*>(buf);
+    batch_buf.insert(batch_buf.end(), ptr, ptr + count);
+    return true;
+  }
   
   struct sockaddr_in addr;
   addr.sin_family = AF_INET;
@@ -288,6 +388,32 @@ bool UdpSocket::write(const IpAddress& remote_ip, int remote_port,
 } /* UdpSocket::write */
 
 
+bool UdpSocket::flushBatch(void)
+{
+  batching = false;
+  if (batch_pending)
+  {
+    return true;
+  }
+  return sendBatch();
+} /* UdpSocket::flushBatch */
+
+
+void UdpSocket::setRxBatchSize(unsigned batch_size)
+{
+  const unsigned max_size = RX_BATCH_SIZE_MAX;
+  rx_batch_size = std::max(1U, std::min(batch_size, max_size));
+  if (rx_batch_size > 1)
+  {
+    rx_buf.resize(rx_batch_size * 65536);
+  }
+  else
+  {
+    std::vector<char>().swap(rx_buf);
+  }
+} /* UdpSocket::setRxBatchSize */
+
+
 
 /****************************************************************************
  *
@@ -295,6 +421,88 @@ bool UdpSocket::write(const IpAddress& remote_ip, int remote_port,
  *
  ****************************************************************************/
 
+bool UdpSocket::setRxBufferSize(int size)
+{
+  if (setsockopt(sock, SOL_SOCKET, SO_RCVBUF, &size, sizeof(size)) == -1)
+  {
+    perror("setsockopt(sock, SO_RCVBUF)");
+    return false;
+  }
+  return true;
+} /* UdpSocket::setRxBufferSize */
+
+
+int UdpSocket::rxBufferSize(void) const
+{
+  int size = 0;
+  socklen_t len = sizeof(size);
+  if (getsockopt(sock, SOL_SOCKET, SO_RCVBUF, &size, &len) == -1)
+  {
+    perror("getsockopt(sock, SO_RCVBUF)");
+    return -1;
+  }
+  return size;
+} /* UdpSocket::rxBufferSize */
+
+
+bool UdpSocket::setTxBufferSize(int size)
+{
+  if (setsockopt(sock, SOL_SOCKET, SO_SNDBUF, &size, sizeof(size)) == -1)
+  {
+    perror("setsockopt(sock, SO_SNDBUF)");
+    return false;
+  }
+  return true;
+} /* UdpSocket::setTxBufferSize */
+
+
+int UdpSocket::txBufferSize(void) const
+{
+  int size = 0;
+  socklen_t len = sizeof(size);
+  if (getsockopt(sock, SOL_SOCKET, SO_SNDBUF, &size, &len) == -1)
+  {
+    perror("getsockopt(sock, SO_SNDBUF)");
+    return -1;
+  }
+  return size;
+} /* UdpSocket::txBufferSize */
+
+
+bool UdpSocket::kernelDrops(uint64_t& drops) const
+{
+  struct stat st;
+  if ((sock == -1) || (fstat(sock, &st) == -1))
+  {
+    return false;
+  }
+
+    // The socket is found in the table using its inode number. The drops
+    // counter is the last column.
+  std::ifstream is("/proc/net/udp");
+  std::string line;
+  std::getline(is, line);
+  while (std::getline(is, line))
+  {
+    std::istringstream ss(line);
+    std::string col;
+    unsigned long inode = 0;
+    for (int i=0; (i < 9) && (ss >> col); ++i) {}
+    if ((ss >> inode) && (inode == st.st_ino))
+    {
+      std::string last;
+      while (ss >> col)
+      {
+        last = col;
+      }
+      drops = std::strtoull(last.c_str(), nullptr, 10);
+      return !last.empty();
+    }
+  }
+  return false;
+} /* UdpSocket::kernelDrops */
+
+
 void UdpSocket::onDataReceived(const IpAddress& ip, uint16_t port, void* buf,
     int count)
 {
@@ -331,6 +539,11 @@ void UdpSocket::cleanup(void)
   
   delete send_buf;
   send_buf = 0;
+
+  batch.clear();
+  batch_buf.clear();
+  batch_pos = 0;
+  batch_pending = false;
   
   if (sock != -1)
   {
@@ -345,6 +558,12 @@ void UdpSocket::cleanup(void)
 
 void UdpSocket::handleInput(FdWatch *watch)
 {
+  if (rx_batch_size > 1)
+  {
+    handleInputBatch();
+    return;
+  }
+
   char buf[65536];
   struct sockaddr_in addr;
   socklen_t addr_len = sizeof(addr);
@@ -357,12 +576,71 @@ void UdpSocket::handleInput(FdWatch *watch)
     return;
   }
 
+  rx_stats.wakeups += 1;
+  rx_stats.datagrams += 1;
+  rx_stats.max_per_wakeup = std::max(rx_stats.max_per_wakeup, 1U);
+
   onDataReceived(IpAddress(addr.sin_addr), ntohs(addr.sin_port), buf, len);
 } /* UdpSocket::handleInput */
 
 
+void UdpSocket::handleInputBatch(void)
+{
+  MultiMsgHdr msgs[RX_BATCH_SIZE_MAX];
+  struct iovec iov[RX_BATCH_SIZE_MAX];
+  struct sockaddr_in addrs[RX_BATCH_SIZE_MAX];
+  const size_t bufsize = rx_buf.size() / rx_batch_size;
+  memset(msgs, 0, rx_batch_size * sizeof(msgs[0]));
+  for (unsigned i=0; i<rx_batch_size; ++i)
+  {
+    iov[i].iov_base = &rx_buf[i * bufsize];
+    iov[i].iov_len = bufsize;
+    msgs[i].msg_hdr.msg_name = &addrs[i];
+    msgs[i].msg_hdr.msg_namelen = sizeof(addrs[i]);
+    msgs[i].msg_hdr.msg_iov = &iov[i];
+    msgs[i].msg_hdr.msg_iovlen = 1;
+  }
+
+  int cnt = recvMultiMsg(sock, msgs, rx_batch_size);
+  if (cnt == -1)
+  {
+    if ((errno != EAGAIN) && (errno != EINTR))
+    {
+      perror("recvmmsg in UdpSocket::handleInput");
+    }
+    return;
+  }
+
+  rx_stats.wakeups += 1;
+  rx_stats.datagrams += cnt;
+  rx_stats.max_per_wakeup = std::max(rx_stats.max_per_wakeup,
+                                     static_cast<unsigned>(cnt));
+
+    // The socket may be deleted by a handler connected to the dataReceived
+    // signal so we need to detect that before delivering the next datagram
+  bool deleted = false;
+  rx_deleted = &deleted;
+  for (int i=0; i<cnt; ++i)
+  {
+    onDataReceived(IpAddress(addrs[i].sin_addr), ntohs(addrs[i].sin_port),
+                   iov[i].iov_base, msgs[i].msg_len);
+    if (deleted)
+    {
+      return;
+    }
+  }
+  rx_deleted = 0;
+} /* UdpSocket::handleInputBatch */
+
+
 void UdpSocket::sendRest(FdWatch *watch)
 {
+  if (batch_pending)
+  {
+    sendBatch();
+    return;
+  }
+
   struct sockaddr_in addr;
   addr.sin_family = AF_INET;
   addr.sin_port = htons(send_buf->port);
@@ -388,16 +666,85 @@ void UdpSocket::sendRest(FdWatch *watch)
   else
   {
     assert(ret == send_buf->len);
-    sendBufferFull(false);
   }
   
   delete send_buf;
   send_buf = 0;
   wr_watch->setEnabled(false);
+
+    // The buffered datagram is gone, whether it was sent or not, so the
+    // socket accept new datagrams again
+  sendBufferFull(false);
   
 } /* UdpSocket::sendRest */
 
 
+bool UdpSocket::sendBatch(void)
+{
+  bool success = true;
+  while (batch_pos < batch.size())
+  {
+    MultiMsgHdr msgs[BATCH_CHUNK_SIZE];
+    struct iovec iov[BATCH_CHUNK_SIZE];
+    struct sockaddr_in addrs[BATCH_CHUNK_SIZE];
+    unsigned cnt = std::min(static_cast<size_t>(BATCH_CHUNK_SIZE),
+                            batch.size() - batch_pos);
+    memset(msgs, 0, cnt * sizeof(msgs[0]));
+    for (unsigned i=0; i<cnt; ++i)
+    {
+      const BatchEntry& entry = batch[batch_pos + i];
+      memset(&addrs[i], 0, sizeof(addrs[i]));
+      addrs[i].sin_family = AF_INET;
+      addrs[i].sin_port = htons(entry.port);
+      addrs[i].sin_addr = entry.ip.ip4Addr();
+      iov[i].iov_base = &batch_buf[entry.offset];
+      iov[i].iov_len = entry.len;
+      msgs[i].msg_hdr.msg_name = &addrs[i];
+      msgs[i].msg_hdr.msg_namelen = sizeof(addrs[i]);
+      msgs[i].msg_hdr.msg_iov = &iov[i];
+      msgs[i].msg_hdr.msg_iovlen = 1;
+    }
+
+    int ret = sendMultiMsg(sock, msgs, cnt);
+    if (ret == -1)
+    {
+      if (errno == EAGAIN)
+      {
+        if (!batch_pending)
+        {
+          batch_pending = true;
+          wr_watch->setEnabled(true);
+          sendBufferFull(true);
+        }
+        return success;
+      }
+      else if (errno == EINTR)
+      {
+        continue;
+      }
+        // The first datagram in the chunk failed. Drop it and go on with
+        // the rest since the error probably only applies to one destination.
+      perror("sendmmsg in UdpSocket::sendBatch");
+      success = false;
+      ret = 1;
+    }
+    batch_pos += ret;
+  }
+
+  batch.clear();
+  batch_buf.clear();
+  batch_pos = 0;
+  if (batch_pending)
+  {
+    batch_pending = false;
+    wr_watch->setEnabled(false);
+    sendBufferFull(false);
+  }
+
+  return success;
+} /* UdpSocket::sendBatch */
+
+
 
 
 
@@ -44,6 +44,8 @@ An example of how to use the Async::UdpSocket class
 #include <sigc++/sigc++.h>
 #include <stdint.h>
 
+#include <vector>
+
 
 /****************************************************************************
  *
@@ -124,14 +126,35 @@ This class is used to work with UDP sockets. An example usage is shown below.
 class UdpSocket : public sigc::trackable
 {
   public:
+    /**
+     * @brief   Receive statistics
+     */
+    struct RxStats
+    {
+      uint64_t  wakeups;          ///< Number of read events handled
+      uint64_t  datagrams;        ///< Number of datagrams received
+      unsigned  max_per_wakeup;   ///< Max datagrams received in one event
+
+      RxStats(void) : wakeups(0), datagrams(0), max_per_wakeup(0) {}
+    };
+
+    /**
+     * @brief   The maximum number of datagrams received per read event
+     */
+    static const unsigned RX_BATCH_SIZE_MAX = 64;
+
     /**
      * @brief 	Constructor
      * @param 	local_port  The local port to use. If not specified, a random
      *	      	      	    local port will be used.
      * @param  	bind_ip     Bind to the interface with the given IP address.
      *	      	            If left empty, bind to all interfaces.
+     * @param   reuse_port  Set to \em true to allow other sockets to bind to
+     *                      the same port (SO_REUSEPORT). The kernel will then
+     *                      distribute incoming datagrams between the sockets.
      */
-    UdpSocket(uint16_t local_port=0, const IpAddress &bind_ip=IpAddress());
+    UdpSocket(uint16_t local_port=0, const IpAddress &bind_ip=IpAddress(),
+              bool reuse_port=false);
   
     /**
      * @brief 	Destructor
@@ -171,6 +194,108 @@ class UdpSocket : public sigc::trackable
     virtual bool write(const IpAddress& remote_ip, int remote_port,
         const void *buf, int count);
 
+    /**
+     * @brief   Start queueing outgoing datagrams
+     *
+     * After calling this function, calls to write will not send the datagram
+     * directly but rather queue it. The queued datagrams are sent using as
+     * few system calls as possible (sendmmsg) when flushBatch is called.
+     * This is useful when the same data is to be sent to many destinations.
+     */
+    void beginBatch(void) { batching = true; }
+
+    /**
+     * @brief   Send all datagrams queued since beginBatch was called
+     * @return  Returns \em true on success or \em false if one or more
+     *          datagrams could not be sent
+     *
+     * If the send buffer becomes full, the remaining datagrams are kept and
+     * are sent when the socket becomes writable again. The sendBufferFull
+     * signal is emitted just like for the write function.
+     */
+    bool flushBatch(void);
+
+    /**
+     * @brief   Check if outgoing datagrams are currently being queued
+     * @return  Returns \em true if beginBatch has been called
+     */
+    bool isBatching(void) const { return batching; }
+
+    /**
+     * @brief   Set the number of datagrams to receive per read event
+     * @param   batch_size The maximum number of datagrams (1 - 64)
+     *
+     * By default a single datagram is read each time the socket becomes
+     * readable. A batch size larger than one will make the socket read up to
+     * that many datagrams (using recvmmsg when available) before returning to
+     * the main loop. One 64kB receive buffer is allocated per datagram in the
+     * batch.
+     */
+    void setRxBatchSize(unsigned batch_size);
+
+    /**
+     * @brief   Get the number of datagrams to receive per read event
+     * @return  Returns the currently set receive batch size
+     */
+    unsigned rxBatchSize(void) const { return rx_batch_size; }
+
+    /**
+     * @brief   Set the size of the kernel receive buffer (SO_RCVBUF)
+     * @param   size The requested size in bytes
+     * @return  Returns \em true on success or \em false on failure
+     *
+     * The kernel may limit the size (net.core.rmem_max) and it also reserve
+     * some of the space for book keeping. Use rxBufferSize to find out the
+     * size that was actually set.
+     */
+    bool setRxBufferSize(int size);
+
+    /**
+     * @brief   Get the size of the kernel receive buffer
+     * @return  Returns the size in bytes or -1 on error
+     */
+    int rxBufferSize(void) const;
+
+    /**
+     * @brief   Set the size of the kernel send buffer (SO_SNDBUF)
+     * @param   size The requested size in bytes
+     * @return  Returns \em true on success or \em false on failure
+     *
+     * The kernel may limit the size (net.core.wmem_max). Use txBufferSize to
+     * find out the size that was actually set.
+     */
+    bool setTxBufferSize(int size);
+
+    /**
+     * @brief   Get the size of the kernel send buffer
+     * @return  Returns the size in bytes or -1 on error
+     */
+    int txBufferSize(void) const;
+
+    /**
+     * @brief   Get the number of datagrams dropped by the kernel
+     * @param   drops Set to the number of dropped datagrams on success
+     * @return  Returns \em true on success or \em false if the counter is
+     *          not available
+     *
+     * The counter include datagrams that were dropped because the receive
+     * buffer of this socket was full. It is read from /proc/net/udp so it is
+     * only available on Linux. Reading it is a bit expensive so it should not
+     * be done too often.
+     */
+    bool kernelDrops(uint64_t& drops) const;
+
+    /**
+     * @brief   Get the receive statistics
+     * @return  Returns the receive counters for this socket
+     */
+    const RxStats& rxStats(void) const { return rx_stats; }
+
+    /**
+     * @brief   Reset the receive statistics
+     */
+    void resetRxStats(void) { rx_stats = RxStats(); }
+
     /**
      * @brief   Get the file descriptor for the UDP socket
      * @return  Returns the file descriptor associated with the socket or
@@ -191,6 +316,9 @@ class UdpSocket : public sigc::trackable
      * @brief 	A signal that is emitted when the send buffer is full
      * @param 	is_full Set to \em true if the buffer is full or \em false
      *	      	      	if the buffer full condition has been cleared
+     *
+     * The buffer full condition is also cleared if the buffered data could
+     * not be sent because of an error, in which case the data is dropped.
      */
     sigc::signal<void(bool)> sendBufferFull;
     
@@ -199,14 +327,33 @@ class UdpSocket : public sigc::trackable
         int count);
 
   private:
-    int       	sock;
-    FdWatch * 	rd_watch;
-    FdWatch * 	wr_watch;
-    UdpPacket * send_buf;
+    struct BatchEntry
+    {
+      IpAddress ip;
+      uint16_t  port;
+      size_t    offset;
+      size_t    len;
+    };
+
+    int       	            sock;
+    FdWatch * 	            rd_watch;
+    FdWatch * 	            wr_watch;
+    UdpPacket *             send_buf;
+    bool                    batching;
+    bool                    batch_pending;
+    std::vector<BatchEntry> batch;
+    std::vector<uint8_t>    batch_buf;
+    size_t                  batch_pos;
+    unsigned                rx_batch_size;
+    std::vector<char>       rx_buf;
+    RxStats                 rx_stats;
+    bool*                   rx_deleted;
     
     void cleanup(void);
     void handleInput(FdWatch *watch);
+    void handleInputBatch(void);
     void sendRest(FdWatch *watch);
+    bool sendBatch(void);
 
 };  /* class UdpSocket */
 
@@ -0,0 +1,416 @@
+/**
+@file   AsyncWorkerPool.cpp
+@brief  Run CPU heavy work in worker threads and complete on the main loop
+@author Tobias Blomberg / SM0SVX
+@date   2026-10-14
+
+\verbatim
+Async - A library for programming event driven applications
+Copyright (C) 2003-2026 Tobias Blomberg / SM0SVX
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+\endverbatim
+*/
+
+/****************************************************************************
+ *
+ * System Includes
+ *
+ ****************************************************************************/
+
+#include <unistd.h>
+#include <fcntl.h>
+#ifdef HAS_EVENTFD
+#include <sys/eventfd.h>
+#endif
+
+#include <cassert>
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+
+
+/****************************************************************************
+ *
+ * Project Includes
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Local Includes
+ *
+ ****************************************************************************/
+
+#include "AsyncWorkerPool.h"
+#include "AsyncThreadSched.h"
+
+
+/****************************************************************************
+ *
+ * Namespaces to use
+ *
+ ****************************************************************************/
+
+using namespace Async;
+
+
+/****************************************************************************
+ *
+ * Defines & typedefs
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Local class definitions
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Prototypes
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Exported Global Variables
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Local Global Variables
+ *
+ ****************************************************************************/
+
+thread_local WorkerPool::Worker* WorkerPool::current_worker = nullptr;
+
+
+
+/****************************************************************************
+ *
+ * Public member functions
+ *
+ ****************************************************************************/
+
+bool WorkerPool::cancelled(void)
+{
+  return (current_worker != nullptr) &&
+         current_worker->cancel.load(std::memory_order_relaxed);
+} /* WorkerPool::cancelled */
+
+
+WorkerPool::WorkerPool(unsigned threads, const std::string& thread_class)
+  : m_thread_class(thread_class)
+{
+    // An eventfd is used, where available, to wake up the main loop. It is
+    // cheaper than a pipe and the same file descriptor is used for both
+    // reading and writing.
+  int fd[2];
+#ifdef HAS_EVENTFD
+  fd[0] = fd[1] = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+  if (fd[0] < 0)
+  {
+    std::cerr << "*** ERROR: Could not create worker pool eventfd: "
+              << std::strerror(errno) << std::endl;
+    return;
+  }
+#else
+  if (pipe(fd) != 0)
+  {
+    std::cerr << "*** ERROR: Could not create worker pool pipe: "
+              << std::strerror(errno) << std::endl;
+    return;
+  }
+  fcntl(fd[0], F_SETFL, fcntl(fd[0], F_GETFL) | O_NONBLOCK);
+  fcntl(fd[1], F_SETFL, fcntl(fd[1], F_GETFL) | O_NONBLOCK);
+#endif
+  m_notifier_wr = fd[1];
+  m_notifier_watch.activity.connect(
+      sigc::mem_fun(*this, &WorkerPool::notificationReceived));
+  m_notifier_watch.setFd(fd[0], FdWatch::FD_WATCH_RD);
+  m_notifier_watch.setEnabled(true);
+
+  for (unsigned i=0; i<threads; ++i)
+  {
+    Worker* worker = new Worker;
+    m_threads.emplace_back(worker);
+    worker->thread = std::thread(&WorkerPool::workerFunc, this, worker);
+  }
+} /* WorkerPool::WorkerPool */
+
+
+WorkerPool::~WorkerPool(void)
+{
+  {
+    std::lock_guard<std::mutex> lk(m_mutex);
+    m_stop = true;
+    m_jobs.clear();
+  }
+  m_work_cond.notify_all();
+  for (auto& worker : m_threads)
+  {
+    worker->thread.join();
+  }
+
+  int fd = m_notifier_watch.fd();
+  if (fd >= 0)
+  {
+    m_notifier_watch.setFd(-1, FdWatch::FD_WATCH_RD);
+    if (fd != m_notifier_wr)
+    {
+      close(fd);
+    }
+  }
+  if (m_notifier_wr >= 0)
+  {
+    close(m_notifier_wr);
+    m_notifier_wr = -1;
+  }
+} /* WorkerPool::~WorkerPool */
+
+
+size_t WorkerPool::pending(void) const
+{
+  std::lock_guard<std::mutex> lk(m_mutex);
+  return m_pending;
+} /* WorkerPool::pending */
+
+
+void WorkerPool::setMaxQueued(size_t max_queued)
+{
+  std::lock_guard<std::mutex> lk(m_mutex);
+  m_max_queued = max_queued;
+} /* WorkerPool::setMaxQueued */
+
+
+size_t WorkerPool::maxQueued(void) const
+{
+  std::lock_guard<std::mutex> lk(m_mutex);
+  return m_max_queued;
+} /* WorkerPool::maxQueued */
+
+
+WorkerPool::JobId WorkerPool::run(Work work, Done done)
+{
+  assert(initOk());
+  const bool has_done = static_cast<bool>(done);
+  JobId id = INVALID_JOB;
+  {
+    std::lock_guard<std::mutex> lk(m_mutex);
+    if ((m_max_queued > 0) && (m_jobs.size() >= m_max_queued))
+    {
+      return INVALID_JOB;
+    }
+    id = ++m_next_id;
+    m_jobs.push_back({id, std::move(work), std::move(done)});
+    m_pending += 1;
+  }
+  m_work_cond.notify_one();
+  if (has_done)
+  {
+    m_waiting_done.insert(id);
+  }
+  return id;
+} /* WorkerPool::run */
+
+
+bool WorkerPool::cancel(JobId id)
+{
+  if (id == INVALID_JOB)
+  {
+    return false;
+  }
+
+  Job job;
+  bool was_queued = false;
+  bool was_running = false;
+  {
+    std::lock_guard<std::mutex> lk(m_mutex);
+    for (auto it=m_jobs.begin(); it!=m_jobs.end(); ++it)
+    {
+      if (it->id == id)
+      {
+        job = std::move(*it);
+        m_jobs.erase(it);
+        was_queued = true;
+        m_pending -= 1;
+        if (m_pending == 0)
+        {
+          m_idle_cond.notify_all();
+        }
+        break;
+      }
+    }
+    if (!was_queued)
+    {
+      for (auto& worker : m_threads)
+      {
+        if (worker->current == id)
+        {
+          worker->cancel = true;
+          was_running = true;
+        }
+      }
+    }
+  }
+
+    // The removed job, if any, is destroyed here in the main thread
+  if (was_queued)
+  {
+    m_waiting_done.erase(id);
+    return true;
+  }
+  if (m_waiting_done.erase(id) > 0)
+  {
+    m_cancelled.insert(id);
+    return true;
+  }
+  return was_running;
+} /* WorkerPool::cancel */
+
+
+void WorkerPool::runInMainThread(Done func)
+{
+  std::lock_guard<std::mutex> lk(m_mutex);
+  m_done.push_back({INVALID_JOB, nullptr, std::move(func)});
+  notify();
+} /* WorkerPool::runInMainThread */
+
+
+void WorkerPool::waitForIdle(void)
+{
+  std::unique_lock<std::mutex> lk(m_mutex);
+  m_idle_cond.wait(lk, [this]{ return m_pending == 0; });
+} /* WorkerPool::waitForIdle */
+
+
+
+/****************************************************************************
+ *
+ * Protected member functions
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Private member functions
+ *
+ ****************************************************************************/
+
+void WorkerPool::workerFunc(Worker* worker)
+{
+  ThreadSched::Registration sched_reg(m_thread_class);
+  current_worker = worker;
+  std::unique_lock<std::mutex> lk(m_mutex);
+  for (;;)
+  {
+    m_work_cond.wait(lk, [this]{ return m_stop || !m_jobs.empty(); });
+    if (m_stop)
+    {
+      break;
+    }
+    Job job(std::move(m_jobs.front()));
+    m_jobs.pop_front();
+    worker->current = job.id;
+    worker->cancel = false;
+    lk.unlock();
+
+    job.work();
+    job.work = nullptr;
+
+    lk.lock();
+    worker->current = INVALID_JOB;
+    m_pending -= 1;
+    if (m_pending == 0)
+    {
+      m_idle_cond.notify_all();
+    }
+    if (job.done)
+    {
+      m_done.push_back(std::move(job));
+      notify();
+    }
+  }
+} /* WorkerPool::workerFunc */
+
+
+void WorkerPool::notify(void)
+{
+    // Must be called with the mutex locked. Only one wakeup is written until
+    // the main thread have emptied the completion queue.
+  if (!m_notified)
+  {
+    m_notified = true;
+#ifdef HAS_EVENTFD
+    uint64_t val = 1;
+    if (write(m_notifier_wr, &val, sizeof(val)) != sizeof(val))
+#else
+    char ch = 0;
+    if (write(m_notifier_wr, &ch, 1) != 1)
+#endif
+    {
+      std::cerr << "*** WARNING: Failed to write to worker pool pipe: "
+                << std::strerror(errno) << std::endl;
+    }
+  }
+} /* WorkerPool::notify */
+
+
+void WorkerPool::notificationReceived(FdWatch *w)
+{
+  char buf[64];
+  while (read(w->fd(), buf, sizeof(buf)) > 0) {}
+
+  std::deque<Job> done;
+  {
+    std::lock_guard<std::mutex> lk(m_mutex);
+    done.swap(m_done);
+    m_notified = false;
+  }
+
+  for (auto& job : done)
+  {
+    if (job.id != INVALID_JOB)
+    {
+      if (m_cancelled.erase(job.id) > 0)
+      {
+        continue;
+      }
+      m_waiting_done.erase(job.id);
+    }
+    job.done();
+  }
+} /* WorkerPool::notificationReceived */
+
+
+
+/*
+ * This file has not been truncated
+ */
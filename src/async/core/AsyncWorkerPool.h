@@ -0,0 +1,343 @@
+/**
+@file   AsyncWorkerPool.h
+@brief  Run CPU heavy work in worker threads and complete on the main loop
+@author Tobias Blomberg / SM0SVX
+@date   2026-10-14
+
+\verbatim
+Async - A library for programming event driven applications
+Copyright (C) 2003-2026 Tobias Blomberg / SM0SVX
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+\endverbatim
+*/
+
+#ifndef ASYNC_WORKER_POOL_INCLUDED
+#define ASYNC_WORKER_POOL_INCLUDED
+
+
+/****************************************************************************
+ *
+ * System Includes
+ *
+ ****************************************************************************/
+
+#include <functional>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <deque>
+#include <vector>
+#include <memory>
+#include <atomic>
+#include <set>
+#include <string>
+#include <cstdint>
+
+
+/****************************************************************************
+ *
+ * Project Includes
+ *
+ ****************************************************************************/
+
+#include <AsyncFdWatch.h>
+
+
+/****************************************************************************
+ *
+ * Local Includes
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Forward declarations
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Namespace
+ *
+ ****************************************************************************/
+
+namespace Async
+{
+
+
+/****************************************************************************
+ *
+ * Forward declarations of classes inside of the declared namespace
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Defines & typedefs
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Exported Global Variables
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Class definitions
+ *
+ ****************************************************************************/
+
+/**
+@brief  Run CPU heavy work in worker threads and complete on the main loop
+@author Tobias Blomberg / SM0SVX
+@date   2026-10-14
+
+This class is used to move work that would otherwise block the main loop for
+a noticeable amount of time, like public key cryptography, to a number of
+worker threads. Each piece of work is given together with a completion
+function. The work function is run in one of the worker threads and when it
+returns the completion function is called from the main loop, just like any
+other Async callback.
+
+The work function must not touch anything that is also used by the main
+thread, unless it is properly synchronized. A common pattern is to move all
+input data into the work function and to return the result using variables
+that are captured by both the work and the completion function, e.g. using
+a std::shared_ptr.
+
+The completion function is only moved, never copied, on its way through the
+worker thread and it is both called and destroyed in the main thread. That
+makes it safe to capture objects in it that are not thread safe, like sigc++
+slots. Completion functions for work that has finished when the pool is
+destroyed are not called so the pool should be destroyed before any object
+referenced by the completion functions.
+
+The job queue can be bounded using setMaxQueued, in which case the run
+function fail when the queue is full. Each job get an id that can be used to
+cancel it. A cancelled job that has not been started is removed from the
+queue. A cancelled job that is running will run to completion, unless the
+work function check the cancelled function and return early, but its
+completion function will not be called.
+
+The call function can be used to get the value returned by the work function
+delivered to the completion function.
+
+\code
+  pool.call([data]() { return heavyCalculation(data); },
+            [this](Result result) { handleResult(result); });
+\endcode
+*/
+class WorkerPool
+{
+  public:
+    using Work = std::function<void(void)>;
+    using Done = std::function<void(void)>;
+    using JobId = uint64_t;
+
+    static const JobId INVALID_JOB = 0;
+
+    /**
+     * @brief   Check if the current job has been cancelled
+     * @return  Returns \em true if the job has been cancelled
+     *
+     * This function can be called from a work function to find out if it
+     * should return early since its result is not going to be used.
+     */
+    static bool cancelled(void);
+
+    /**
+     * @brief   Constructor
+     * @param   threads The number of worker threads to start
+     * @param   thread_class The thread class used for the worker threads
+     *                       when registering them with ThreadSched
+     */
+    explicit WorkerPool(unsigned threads,
+                        const std::string& thread_class="worker");
+
+    /**
+     * @brief   Destructor
+     *
+     * Wait for the work that is being executed to finish and then stop all
+     * worker threads. Work that has not been started is discarded.
+     */
+    ~WorkerPool(void);
+
+    /**
+     * @brief   Check if the initialization was ok
+     * @return  Returns \em true if the pool is ready to use
+     */
+    bool initOk(void) const { return m_notifier_wr >= 0; }
+
+    /**
+     * @brief   Get the number of worker threads
+     * @return  Returns the number of worker threads
+     */
+    unsigned threadCount(void) const { return m_threads.size(); }
+
+    /**
+     * @brief   Get the number of unfinished jobs
+     * @return  Returns the number of queued or running jobs
+     */
+    size_t pending(void) const;
+
+    /**
+     * @brief   Set the maximum number of jobs waiting to be started
+     * @param   max_queued The maximum number of waiting jobs, 0 for no limit
+     *
+     * There is no limit by default.
+     */
+    void setMaxQueued(size_t max_queued);
+
+    /**
+     * @brief   Get the maximum number of jobs waiting to be started
+     * @return  Returns the maximum number of waiting jobs, 0 for no limit
+     */
+    size_t maxQueued(void) const;
+
+    /**
+     * @brief   Run the given work in a worker thread
+     * @param   work The work function, called in a worker thread
+     * @param   done The completion function, called from the main loop
+     * @return  Returns the job id or INVALID_JOB if the queue is full
+     *
+     * This function must be called from the main thread.
+     */
+    JobId run(Work work, Done done=nullptr);
+
+    /**
+     * @brief   Run a function in a worker thread and deliver its result
+     * @param   work The work function, called in a worker thread
+     * @param   done The completion function taking the result as argument
+     * @return  Returns the job id or INVALID_JOB if the queue is full
+     *
+     * The value returned by the work function is moved to the completion
+     * function, which is called from the main loop. This function must be
+     * called from the main thread.
+     */
+    template <typename WorkFunc, typename DoneFunc>
+    JobId call(WorkFunc work, DoneFunc done)
+    {
+      typedef decltype(work()) Result;
+      struct Holder { std::unique_ptr<Result> value; };
+      std::shared_ptr<Holder> holder = std::make_shared<Holder>();
+      return run(
+          [holder, work](void) { holder->value.reset(new Result(work())); },
+          [holder, done](void)
+          {
+            if (holder->value != nullptr)
+            {
+              done(std::move(*holder->value));
+            }
+          });
+    }
+
+    /**
+     * @brief   Cancel a job
+     * @param   id The id of the job to cancel
+     * @return  Returns \em true if the job was found
+     *
+     * A job that has not been started is removed from the queue. For a job
+     * that is running or has finished, the completion function will not be
+     * called. This function must be called from the main thread.
+     */
+    bool cancel(JobId id);
+
+    /**
+     * @brief   Call a function from the main loop
+     * @param   func The function to call
+     *
+     * This function can be called from any thread, typically from a work
+     * function, to get something done in the main thread. The function will
+     * be called from the main loop as soon as possible.
+     */
+    void runInMainThread(Done func);
+
+    /**
+     * @brief   Wait until all queued work has been executed
+     *
+     * This function block the calling thread until all work, including the
+     * work that has not been started yet, has been executed. Completion
+     * functions are called from the main loop as usual. It is typically used
+     * before deleting the pool when queued work must not be discarded.
+     * This function must be called from the main thread and the work
+     * functions must not wait for the main thread.
+     */
+    void waitForIdle(void);
+
+  private:
+    struct Job
+    {
+      JobId id;
+      Work  work;
+      Done  done;
+    };
+    struct Worker
+    {
+      std::thread       thread;
+      JobId             current     = INVALID_JOB;
+      std::atomic<bool> cancel      {false};
+    };
+
+    static thread_local Worker* current_worker;
+
+    std::vector<std::unique_ptr<Worker>> m_threads;
+    mutable std::mutex        m_mutex;
+    std::condition_variable   m_work_cond;
+    std::condition_variable   m_idle_cond;
+    std::deque<Job>           m_jobs;
+    std::deque<Job>           m_done;
+    size_t                    m_pending     = 0;
+    size_t                    m_max_queued  = 0;
+    JobId                     m_next_id     = INVALID_JOB;
+    bool                      m_stop        = false;
+    bool                      m_notified    = false;
+    int                       m_notifier_wr = -1;
+    FdWatch                   m_notifier_watch;
+    std::string               m_thread_class;
+      // Only used by the main thread
+    std::set<JobId>           m_waiting_done;
+    std::set<JobId>           m_cancelled;
+
+    WorkerPool(const WorkerPool&);
+    WorkerPool& operator=(const WorkerPool&);
+    void workerFunc(Worker* worker);
+    void notify(void);
+    void notificationReceived(FdWatch *w);
+
+};  /* class WorkerPool */
+
+
+} /* namespace */
+
+#endif /* ASYNC_WORKER_POOL_INCLUDED */
+
+
+
+/*
+ * This file has not been truncated
+ */
@@ -9,7 +9,7 @@
  *
  * \verbatim
  * Async - A library for programming event driven applications
- * Copyright (C) 2003-2022 Tobias Blomberg
+ * Copyright (C) 2003-2026 Tobias Blomberg
  *
  * This program is free software; you can redistribute it and/or modify
  * it under the terms of the GNU General Public License as published by
@@ -39,12 +39,17 @@
 #include <sys/select.h>
 #include <signal.h>
 #include <unistd.h>
+#ifdef HAS_EPOLL_SUPPORT
+#include <sys/epoll.h>
+#endif
 
 #include <cstdlib>
 #include <cstdio>
 #include <cerrno>
 #include <cassert>
+#include <cstring>
 #include <algorithm>
+#include <iostream>
 
 
 /****************************************************************************
@@ -85,27 +90,9 @@ using namespace Async;
  *
  ****************************************************************************/
 
-# define clock_timeradd(a, b, result)                                         \
-  do {                                                                        \
-    (result)->tv_sec = (a)->tv_sec + (b)->tv_sec;                             \
-    (result)->tv_nsec = (a)->tv_nsec + (b)->tv_nsec;                          \
-    if ((result)->tv_nsec >= 1000000000)                                      \
-      {                                                                       \
-        ++(result)->tv_sec;                                                   \
-        (result)->tv_nsec -= 1000000000;                                      \
-      }                                                                       \
-  } while (0)
-
-# define clock_timersub(a, b, result)                                         \
-  do {                                                                        \
-    (result)->tv_sec = (a)->tv_sec - (b)->tv_sec;                             \
-    (result)->tv_nsec = (a)->tv_nsec - (b)->tv_nsec;                          \
-    if ((result)->tv_nsec < 0) {                                              \
-      --(result)->tv_sec;                                                     \
-      (result)->tv_nsec += 1000000000;                                        \
-    }                                                                         \
-  } while (0)
-
+#ifndef HAS_EPOLL_SUPPORT
+struct epoll_event {};
+#endif
 
 
 
@@ -123,6 +110,24 @@ using namespace Async;
  *
  ****************************************************************************/
 
+namespace {
+  uint64_t timespecToMs(const struct timespec& ts)
+  {
+    return static_cast<uint64_t>(ts.tv_sec) * 1000 + ts.tv_nsec / 1000000;
+  }
+
+  uint64_t timespecToMsCeil(const struct timespec& ts)
+  {
+    return static_cast<uint64_t>(ts.tv_sec) * 1000 +
+           (ts.tv_nsec + 999999) / 1000000;
+  }
+
+  uint64_t timespecToUs(const struct timespec& ts)
+  {
+    return static_cast<uint64_t>(ts.tv_sec) * 1000000 + ts.tv_nsec / 1000;
+  }
+};
+
 
 
 /****************************************************************************
@@ -162,17 +167,57 @@ int CppApplication::sighandler_pipe[2];
  *------------------------------------------------------------------------
  */
 CppApplication::CppApplication(void)
-  : do_quit(false), max_desc(0), unix_signal_recv(-1), unix_signal_recv_cnt(0)
+  : do_quit(false), loop_backend(EVENT_LOOP_SELECT), max_desc(0),
+    epoll_fd(-1), epoll_event_cnt(0), watch_cnt(0), wheel_due(0),
+    wheel_work(0), wheel_free(0), wheel_tick(0), timer_now_tick(0),
+    expiring_timer(0), unix_signal_recv(-1), unix_signal_recv_cnt(0)
 {
+  std::fill_n(wheel_l0, WHEEL_L0_SIZE, static_cast<WheelEntry*>(0));
+  std::fill_n(&wheel_ln[0][0], (WHEEL_LEVELS-1) * WHEEL_LN_SIZE,
+              static_cast<WheelEntry*>(0));
+  std::fill_n(wheel_cnt, WHEEL_LEVELS+1, 0);
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  wheel_tick = timespecToMs(now);
+  watch_table.resize(FD_SETSIZE, FdWatchSlots());
+
   FD_ZERO(&rd_set);
   FD_ZERO(&wr_set);
+  FD_ZERO(&pri_set);
+  FD_ZERO(&active_rd_set);
+  FD_ZERO(&active_wr_set);
+  FD_ZERO(&active_pri_set);
   sighandler_pipe[0] = sighandler_pipe[1] = -1;
+
+  const char *backend_str = getenv("ASYNC_CPP_EVENT_LOOP");
+  if ((backend_str == 0) || (strcmp(backend_str, "epoll") == 0))
+  {
+    initEpoll();
+  }
+  else if (strcmp(backend_str, "select") != 0)
+  {
+    cerr << "*** WARNING: Unknown event loop backend \"" << backend_str
+              << "\" specified in environment variable ASYNC_CPP_EVENT_LOOP. "
+                 "Valid values are \"epoll\" and \"select\"." << endl;
+    initEpoll();
+  }
 } /* CppApplication::CppApplication */
 
 
 CppApplication::~CppApplication(void)
 {
   clearTasks();
+  if (dns_cache != nullptr)
+  {
+    dns_cache->shutdown();
+  }
+#ifdef HAS_EPOLL_SUPPORT
+  if (epoll_fd >= 0)
+  {
+    close(epoll_fd);
+    epoll_fd = -1;
+  }
+#endif
 } /* CppApplication::~CppApplication */
 
 
@@ -205,35 +250,17 @@ void CppApplication::exec(void)
   
   while (!do_quit)
   {
-    struct timespec *timeout_ptr = 0;
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    loopBusyEnd(timespecToUs(now));
     struct timespec timeout;
-    TimerMap::iterator titer = timer_map.begin();
-    while (titer != timer_map.end())
+    struct timespec *timeout_ptr = 0;
+    if (nextTimeout(now, timeout))
     {
-      if (titer->second != 0)
-      {
-	struct timespec ts;
-	clock_gettime(CLOCK_MONOTONIC, &ts);
-	clock_timersub(&titer->first, &ts, &timeout);
-	if (timeout.tv_sec < 0)
-	{
-	  timeout.tv_sec = 0;
-	  timeout.tv_nsec = 0;
-	}
-	timeout_ptr = &timeout;
-	break;
-      }
-      else
-      {
-	timer_map.erase(titer);
-      }
-      titer = timer_map.begin();
+      timeout_ptr = &timeout;
     }
     
-    fd_set local_rd_set = rd_set;
-    fd_set local_wr_set = wr_set;
-    int dcnt = pselect(max_desc, &local_rd_set, &local_wr_set, NULL,
-	timeout_ptr, NULL);
+    int dcnt = waitForEvents(timeout_ptr);
     if (dcnt == -1)
     {
       if ((errno == EINTR) || (errno == EAGAIN))
@@ -242,71 +269,16 @@ void CppApplication::exec(void)
       }
       else
       {
-        perror("pselect");
+        perror((loop_backend == EVENT_LOOP_EPOLL) ? "epoll_wait" : "pselect");
         exit(1);
       }
     }
     
-    if ((timeout_ptr != 0)
-        && ((dcnt == 0)
-            || ((timeout_ptr->tv_sec == 0) && (timeout_ptr->tv_nsec == 0))
-           )
-       )
-    {
-      titer->second->expired(titer->second);
-      if ((titer->second != 0) &&
-	  (titer->second->type() == Timer::TYPE_PERIODIC))
-      {
-	addTimerP(titer->second, titer->first);
-      }
-      timer_map.erase(titer);
-    }
-    
-    WatchMap::iterator witer, next_witer;
-    
-      /* Check for activity on the read watch file descriptors */
-    witer=rd_watch_map.begin();
-    while ((dcnt > 0) && (witer != rd_watch_map.end()))
-    {
-      next_witer = witer;
-      ++next_witer;
-      if (FD_ISSET(witer->first, &local_rd_set))
-      {
-	if (witer->second != 0)
-	{
-	  witer->second->activity(witer->second);
-	}
-	else
-	{
-	  rd_watch_map.erase(witer);
-	}
-	--dcnt;
-      }
-      witer = next_witer;
-    }
-    
-      /* Check for activity on the write watch file descriptors */
-    witer=wr_watch_map.begin();
-    while ((dcnt > 0) && (witer != wr_watch_map.end()))
-    {
-      next_witer = witer;
-      ++next_witer;
-      if (FD_ISSET(witer->first, &local_wr_set))
-      {
-	if (witer->second != 0)
-	{
-	  witer->second->activity(witer->second);
-	}
-	else
-	{
-	  wr_watch_map.erase(witer);
-	}
-	--dcnt;
-      }
-      witer = next_witer;
-    }
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    loopBusyBegin(timespecToUs(now));
+    processTimers(now);
     
-    assert(dcnt == 0);
+    dispatchEvents(dcnt);
   }
 
   for (UnixSignalMap::const_iterator it = unix_signals.begin();
@@ -417,129 +389,733 @@ void CppApplication::unixSignalHandler(int signum)
 } /* CppApplication::unixSignalHandler */
 
 
+bool CppApplication::initEpoll(void)
+{
+#ifdef HAS_EPOLL_SUPPORT
+  epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+  if (epoll_fd == -1)
+  {
+    perror("epoll_create1");
+    cerr << "*** WARNING: Falling back to the select event loop backend"
+              << endl;
+    return false;
+  }
+  loop_backend = EVENT_LOOP_EPOLL;
+  epoll_events.resize(64);
+  return true;
+#else
+  return false;
+#endif
+} /* CppApplication::initEpoll */
+
+
+int CppApplication::waitForEvents(const struct timespec *timeout)
+{
+#ifdef HAS_EPOLL_SUPPORT
+  if (loop_backend == EVENT_LOOP_EPOLL)
+  {
+      // File descriptors that cannot be handled by epoll, like regular files,
+      // are always ready so we must not block if there are any of those
+    int timeout_ms = -1;
+    if (!epoll_nopoll_fds.empty())
+    {
+      timeout_ms = 0;
+    }
+    else if (timeout != 0)
+    {
+        // Round up to make sure that we do not wake up before the timer expire
+      timeout_ms = timeout->tv_sec * 1000 +
+                   (timeout->tv_nsec + 999999) / 1000000;
+    }
+    if (epoll_events.size() < watch_cnt)
+    {
+      epoll_events.resize(watch_cnt);
+    }
+    int dcnt = epoll_wait(epoll_fd, &epoll_events[0], epoll_events.size(),
+                          timeout_ms);
+    if (dcnt < 0)
+    {
+      epoll_event_cnt = 0;
+      return dcnt;
+    }
+    epoll_event_cnt = dcnt;
+    return dcnt + epoll_nopoll_fds.size();
+  }
+#endif
+
+  active_rd_set = rd_set;
+  active_wr_set = wr_set;
+  active_pri_set = pri_set;
+  return pselect(max_desc, &active_rd_set, &active_wr_set, &active_pri_set,
+                 timeout, NULL);
+} /* CppApplication::waitForEvents */
+
+
+void CppApplication::dispatchEvents(int dcnt)
+{
+  if (loop_backend == EVENT_LOOP_EPOLL)
+  {
+    epollDispatch(dcnt);
+  }
+  else
+  {
+    selectDispatch(dcnt);
+  }
+} /* CppApplication::dispatchEvents */
+
+
+void CppApplication::selectDispatch(int dcnt)
+{
+  static const FdWatch::FdWatchType types[] =
+  {
+    FdWatch::FD_WATCH_RD, FdWatch::FD_WATCH_WR, FdWatch::FD_WATCH_PRI
+  };
+  const fd_set* active_sets[] =
+  {
+    &active_rd_set, &active_wr_set, &active_pri_set
+  };
+
+    // The watches are looked up for each dispatch since they may be
+    // removed by any of the activity handlers. The number of file
+    // descriptors is taken before dispatching since max_desc may shrink.
+  const int nfds = max_desc;
+  for (unsigned t=0; t<3; ++t)
+  {
+    for (int fd=0; (dcnt > 0) && (fd < nfds); ++fd)
+    {
+      if (FD_ISSET(fd, active_sets[t]))
+      {
+        FdWatch* watch = findWatch(fd, types[t]);
+        if (watch != 0)
+        {
+          fdActivity(watch);
+        }
+        --dcnt;
+      }
+    }
+  }
+
+  assert(dcnt == 0);
+} /* CppApplication::selectDispatch */
+
+
+void CppApplication::epollDispatch(int dcnt)
+{
+#ifdef HAS_EPOLL_SUPPORT
+  for (int i=0; i<epoll_event_cnt; ++i)
+  {
+    const struct epoll_event& ev = epoll_events[i];
+    int fd = ev.data.fd;
+
+      // The watch table must be searched for each dispatch since the watch
+      // may be removed by any of the activity handlers
+    FdWatch* watch;
+    if (((ev.events & (EPOLLIN | EPOLLHUP | EPOLLERR)) != 0) &&
+        ((watch = findWatch(fd, FdWatch::FD_WATCH_RD)) != 0))
+    {
+      fdActivity(watch);
+    }
+    if (((ev.events & (EPOLLOUT | EPOLLHUP | EPOLLERR)) != 0) &&
+        ((watch = findWatch(fd, FdWatch::FD_WATCH_WR)) != 0))
+    {
+      fdActivity(watch);
+    }
+    if (((ev.events & EPOLLPRI) != 0) &&
+        ((watch = findWatch(fd, FdWatch::FD_WATCH_PRI)) != 0))
+    {
+      fdActivity(watch);
+    }
+  }
+
+    // File descriptors not supported by epoll are always active. A copy of
+    // the set is made since the handlers may add or remove watches.
+  if (!epoll_nopoll_fds.empty())
+  {
+    std::set<int> nopoll_fds(epoll_nopoll_fds);
+    for (std::set<int>::const_iterator fit = nopoll_fds.begin();
+         fit != nopoll_fds.end(); ++fit)
+    {
+      FdWatch* watch;
+      if ((watch = findWatch(*fit, FdWatch::FD_WATCH_RD)) != 0)
+      {
+        fdActivity(watch);
+      }
+      if ((watch = findWatch(*fit, FdWatch::FD_WATCH_WR)) != 0)
+      {
+        fdActivity(watch);
+      }
+      if ((watch = findWatch(*fit, FdWatch::FD_WATCH_PRI)) != 0)
+      {
+        fdActivity(watch);
+      }
+    }
+  }
+#endif
+} /* CppApplication::epollDispatch */
+
+
+void CppApplication::fdActivity(FdWatch *watch)
+{
+  countWakeup(fdCallbackType(watch), 0, watch->fd());
+  if (!callbackTimingEnabled())
+  {
+    watch->activity(watch);
+    return;
+  }
+
+    // The watch may be deleted by the activity handler
+  const uint64_t start_us = monotonicUs();
+  const int fd = watch->fd();
+  const CallbackType type = fdCallbackType(watch);
+  watch->activity(watch);
+  callbackDone(type, 0, fd, start_us);
+} /* CppApplication::fdActivity */
+
+
+FdWatch* CppApplication::findWatch(int fd, FdWatch::FdWatchType type) const
+{
+  if ((fd < 0) || (static_cast<size_t>(fd) >= watch_table.size()))
+  {
+    return 0;
+  }
+  return watch_table[fd].watch[type];
+} /* CppApplication::findWatch */
+
+
+bool CppApplication::fdIsWatched(int fd) const
+{
+  return (findWatch(fd, FdWatch::FD_WATCH_RD) != 0) ||
+         (findWatch(fd, FdWatch::FD_WATCH_WR) != 0) ||
+         (findWatch(fd, FdWatch::FD_WATCH_PRI) != 0);
+} /* CppApplication::fdIsWatched */
+
+
+void CppApplication::epollUpdate(int fd, bool was_watched)
+{
+#ifdef HAS_EPOLL_SUPPORT
+  struct epoll_event ev;
+  memset(&ev, 0, sizeof(ev));
+  ev.data.fd = fd;
+  if (findWatch(fd, FdWatch::FD_WATCH_RD) != 0)
+  {
+    ev.events |= EPOLLIN;
+  }
+  if (findWatch(fd, FdWatch::FD_WATCH_WR) != 0)
+  {
+    ev.events |= EPOLLOUT;
+  }
+  if (findWatch(fd, FdWatch::FD_WATCH_PRI) != 0)
+  {
+    ev.events |= EPOLLPRI;
+  }
+
+  if (ev.events == 0)
+  {
+    if (epoll_nopoll_fds.erase(fd) == 0)
+    {
+        // The file descriptor may already have been closed, in which case
+        // the kernel have removed it from the epoll set automatically
+      if ((epoll_ctl(epoll_fd, EPOLL_CTL_DEL, fd, &ev) == -1) &&
+          (errno != ENOENT) && (errno != EBADF))
+      {
+        perror("epoll_ctl(EPOLL_CTL_DEL)");
+      }
+    }
+    return;
+  }
+
+  if (epoll_nopoll_fds.count(fd) > 0)
+  {
+    return;
+  }
+
+  int op = was_watched ? EPOLL_CTL_MOD : EPOLL_CTL_ADD;
+  if (epoll_ctl(epoll_fd, op, fd, &ev) == 0)
+  {
+    return;
+  }
+
+    // A closed and then reused file descriptor will have been removed from
+    // the epoll set behind our back, and the other way around for duplicated
+    // file descriptors, so just retry with the other operation.
+  if ((errno == ENOENT) || (errno == EEXIST))
+  {
+    op = (op == EPOLL_CTL_MOD) ? EPOLL_CTL_ADD : EPOLL_CTL_MOD;
+    if (epoll_ctl(epoll_fd, op, fd, &ev) == 0)
+    {
+      return;
+    }
+  }
+
+    // Regular files and some other file types are not supported by epoll.
+    // Just like for select, these are considered to always be active.
+  if (errno == EPERM)
+  {
+    epoll_nopoll_fds.insert(fd);
+    return;
+  }
+
+  perror("epoll_ctl");
+#endif
+} /* CppApplication::epollUpdate */
+
+
 void CppApplication::addFdWatch(FdWatch *fd_watch)
 {
   int fd = fd_watch->fd();
   //printf("Adding watch for fd=%d (max_desc=%d)\n", fd, max_desc);
-  
-  WatchMap *watch_map = 0;
+  assert(fd >= 0);
+
+  if (static_cast<size_t>(fd) >= watch_table.size())
+  {
+    watch_table.resize(2 * (fd + 1), FdWatchSlots());
+  }
+  const bool was_watched = fdIsWatched(fd);
+  FdWatch*& slot = watch_table[fd].watch[fd_watch->type()];
+  assert(slot == 0);
+  slot = fd_watch;
+  ++watch_cnt;
+
+  if (loop_backend == EVENT_LOOP_EPOLL)
+  {
+    epollUpdate(fd, was_watched);
+    return;
+  }
+
   switch (fd_watch->type())
   {
     case FdWatch::FD_WATCH_RD:
       FD_SET(fd, &rd_set);
-      watch_map = &rd_watch_map;
       break;
 
     case FdWatch::FD_WATCH_WR:
       FD_SET(fd, &wr_set);
-      watch_map = &wr_watch_map;
+      break;
+
+    case FdWatch::FD_WATCH_PRI:
+      FD_SET(fd, &pri_set);
       break;
   }
-  assert(watch_map != 0);
 
-  WatchMap::iterator iter = watch_map->find(fd);
-  assert((iter == watch_map->end()) || (iter->second == 0));
-  
   if (fd+1 > max_desc)
   {
     max_desc = fd+1;
   }
-
-  (*watch_map)[fd] = fd_watch;
-  
 } /* CppApplication::addFdWatch */
 
 
 void CppApplication::delFdWatch(FdWatch *fd_watch)
 {
   int fd = fd_watch->fd();
-  WatchMap *watch_map = 0;
+
+  FdWatch*& slot = watch_table[fd].watch[fd_watch->type()];
+  assert(slot == fd_watch);
+  slot = 0;
+  --watch_cnt;
+
+  if (loop_backend == EVENT_LOOP_EPOLL)
+  {
+    epollUpdate(fd, true);
+    return;
+  }
+
   switch (fd_watch->type())
   {
     case FdWatch::FD_WATCH_RD:
       FD_CLR(fd, &rd_set);
-      watch_map = &rd_watch_map;
       break;
-      
+
     case FdWatch::FD_WATCH_WR:
       FD_CLR(fd, &wr_set);
-      watch_map = &wr_watch_map;
+      break;
+
+    case FdWatch::FD_WATCH_PRI:
+      FD_CLR(fd, &pri_set);
       break;
   }
-  assert(watch_map != 0);
-  
-  WatchMap::iterator iter = watch_map->find(fd);
-  assert((iter != watch_map->end()) && (iter->second != 0));
-  iter->second = 0;
-  
+
   if (fd+1 == max_desc)
   {
-    max_desc = -1;
+    while ((max_desc > 0) && !fdIsWatched(max_desc-1))
+    {
+      --max_desc;
+    }
+  }
+} /* CppApplication::delFdWatch */
+
+
+void CppApplication::addTimer(Timer *timer)
+{
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+
+    // Fast forward an empty wheel so that we do not have to step through
+    // all the ticks that may have passed since the last timer expired
+  if (wheelTimerCount() == 0)
+  {
+    wheel_tick = std::max(wheel_tick, timespecToMs(now));
+  }
+
+    // A zero timeout should expire as soon as possible. Other timeouts are
+    // rounded up to make sure that the timer never expire too early.
+  WheelEntry *entry = wheelEntry(timer);
+  wheelUnlink(entry);
+  if (timer->timeout() == 0)
+  {
+    entry->nominal = entry->expire = timespecToMs(now);
+  }
+  else
+  {
+    entry->nominal = timespecToMsCeil(now) + timer->timeout();
+    entry->expire = coalescedExpire(entry);
+  }
+  wheelInsert(entry);
+} /* CppApplication::addTimer */
+
+
+void CppApplication::delTimer(Timer *timer)
+{
+  if (timer == expiring_timer)
+  {
+    expiring_timer = 0;
+  }
+
+    // The entry is put back in the pool when the timer is disabled
+  WheelEntry *entry = static_cast<WheelEntry*>(timerBackendData(timer));
+  if (entry != 0)
+  {
+    wheelUnlink(entry);
+    setTimerBackendData(timer, 0);
+    entry->timer = 0;
+    entry->next = wheel_free;
+    wheel_free = entry;
+  }
+} /* CppApplication::delTimer */
+
+
+uint64_t CppApplication::coalescedExpire(const WheelEntry *entry)
+{
+    // Rounding up to a multiple of the slack make all timers with the same
+    // slack expire on the same tick
+  const uint64_t slack =
+    (entry->timer->slack() > 0) ? entry->timer->slack() : 1;
+  return (entry->nominal + slack - 1) / slack * slack;
+} /* CppApplication::coalescedExpire */
+
+
+size_t CppApplication::wheelTimerCount(void) const
+{
+  size_t cnt = 0;
+  for (unsigned i=0; i<WHEEL_LEVELS+1; ++i)
+  {
+    cnt += wheel_cnt[i];
+  }
+  return cnt;
+} /* CppApplication::wheelTimerCount */
+
+
+CppApplication::WheelEntry *CppApplication::wheelEntry(Timer *timer)
+{
+  WheelEntry *entry = static_cast<WheelEntry*>(timerBackendData(timer));
+  if (entry != 0)
+  {
+    return entry;
+  }
+  if (wheel_free != 0)
+  {
+    entry = wheel_free;
+    wheel_free = entry->next;
+  }
+  else
+  {
+    wheel_entries.emplace_back();
+    entry = &wheel_entries.back();
+  }
+  entry->timer = timer;
+  entry->next = 0;
+  entry->pprev = 0;
+  entry->expire = 0;
+  entry->nominal = 0;
+  entry->level = -1;
+  setTimerBackendData(timer, entry);
+  return entry;
+} /* CppApplication::wheelEntry */
+
+
+void CppApplication::wheelLink(WheelEntry **head, WheelEntry *entry,
+                               int level)
+{
+  entry->next = *head;
+  if (*head != 0)
+  {
+    (*head)->pprev = &entry->next;
+  }
+  *head = entry;
+  entry->pprev = head;
+  entry->level = level;
+  if (level >= 0)
+  {
+    ++wheel_cnt[level];
+  }
+} /* CppApplication::wheelLink */
+
+
+void CppApplication::wheelUnlink(WheelEntry *entry)
+{
+  if (entry->pprev == 0)
+  {
+    return;
+  }
+  *entry->pprev = entry->next;
+  if (entry->next != 0)
+  {
+    entry->next->pprev = entry->pprev;
+  }
+  if (entry->level >= 0)
+  {
+    assert(wheel_cnt[entry->level] > 0);
+    --wheel_cnt[entry->level];
+  }
+  entry->next = 0;
+  entry->pprev = 0;
+  entry->level = -1;
+} /* CppApplication::wheelUnlink */
 
-    WatchMap::reverse_iterator riter;
-    for (riter = rd_watch_map.rbegin(); riter != rd_watch_map.rend(); ++riter)
+
+void CppApplication::wheelInsert(WheelEntry *entry)
+{
+  uint64_t expire = entry->expire;
+  if (expire < wheel_tick)
+  {
+    wheelLink(&wheel_due, entry, WHEEL_DUE_LIST);
+    return;
+  }
+
+  uint64_t delta = expire - wheel_tick;
+  if (delta < WHEEL_L0_SIZE)
+  {
+    wheelLink(&wheel_l0[expire & (WHEEL_L0_SIZE-1)], entry, 0);
+    return;
+  }
+
+  for (unsigned level=1; level<WHEEL_LEVELS; ++level)
+  {
+    unsigned shift = WHEEL_L0_BITS + (level-1) * WHEEL_LN_BITS;
+    uint64_t level_span = uint64_t(1) << (shift + WHEEL_LN_BITS);
+    if ((delta < level_span) || (level == WHEEL_LEVELS-1))
     {
-      if ((riter->second != 0) && (riter->first > max_desc))
+        // Timers beyond the range of the wheel are put in the last slot. They
+        // will be reinserted when that slot is cascaded.
+      if (delta >= level_span)
       {
-        max_desc = riter->first;
-        break;
+        expire = wheel_tick + level_span - 1;
       }
+      unsigned idx = (expire >> shift) & (WHEEL_LN_SIZE-1);
+      wheelLink(&wheel_ln[level-1][idx], entry, level);
+      return;
     }
-    
-    for (riter = wr_watch_map.rbegin(); riter != wr_watch_map.rend(); ++riter)
+  }
+} /* CppApplication::wheelInsert */
+
+
+void CppApplication::wheelCascade(unsigned level, unsigned idx)
+{
+  WheelEntry *entry = wheel_ln[level-1][idx];
+  wheel_ln[level-1][idx] = 0;
+  while (entry != 0)
+  {
+    WheelEntry *next = entry->next;
+    entry->next = 0;
+    entry->pprev = 0;
+    --wheel_cnt[level];
+    wheelInsert(entry);
+    entry = next;
+  }
+} /* CppApplication::wheelCascade */
+
+
+void CppApplication::wheelExpireList(WheelEntry **head, int level)
+{
+    // Move the timers to a separate work list so that timers that are
+    // rearmed by the expiration handlers will not end up in the list we
+    // are currently processing
+  assert(wheel_work == 0);
+  wheel_work = *head;
+  *head = 0;
+  if (wheel_work != 0)
+  {
+    wheel_work->pprev = &wheel_work;
+  }
+  for (WheelEntry *e=wheel_work; e!=0; e=e->next)
+  {
+    e->level = -1;
+    --wheel_cnt[level];
+  }
+
+  while (wheel_work != 0)
+  {
+    WheelEntry *entry = wheel_work;
+    Timer *timer = entry->timer;
+    wheelUnlink(entry);
+    if (level != WHEEL_DUE_LIST)
+    {
+      const uint64_t lag = (timer_now_tick > entry->expire)
+                         ? (timer_now_tick - entry->expire) : 0;
+      timerExpiredLate(lag);
+      countWakeup(CALLBACK_TIMER, timer->name(), timer->timeout());
+    }
+    expiring_timer = timer;
+    if (callbackTimingEnabled())
+    {
+      const uint64_t start_us = monotonicUs();
+      const int timeout = timer->timeout();
+      timer->expired(timer);
+      callbackDone(CALLBACK_TIMER, timer, timeout, start_us);
+    }
+    else
     {
-      if ((riter->second != 0) && (riter->first > max_desc))
+      timer->expired(timer);
+    }
+
+      // If the timer was deleted, disabled or reset in the expiration
+      // handler the expiring_timer variable have been cleared and the
+      // entry may have been reused
+    if (expiring_timer == timer)
+    {
+      if (timer->type() == Timer::TYPE_PERIODIC)
       {
-        max_desc = riter->first;
-        break;
+          // The period is counted from the nominal expiration time so that
+          // the slack does not make a periodic timer drift
+        entry->nominal += timer->timeout();
+        entry->expire = coalescedExpire(entry);
+        wheelInsert(entry);
       }
     }
-    
-    ++max_desc;
+    expiring_timer = 0;
   }
-} /* CppApplication::delFdWatch */
+} /* CppApplication::wheelExpireList */
 
 
-void CppApplication::addTimer(Timer *timer)
+void CppApplication::processTimers(const struct timespec& now)
 {
-  struct timespec current;
-  clock_gettime(CLOCK_MONOTONIC, &current);
-  addTimerP(timer, current);
-} /* CppApplication::addTimer */
+  if (wheel_due != 0)
+  {
+    wheelExpireList(&wheel_due, WHEEL_DUE_LIST);
+  }
 
+  uint64_t now_tick = timespecToMs(now);
+  timer_now_tick = now_tick;
+  while (wheel_tick <= now_tick)
+  {
+    if (wheelTimerCount() == 0)
+    {
+      wheel_tick = now_tick + 1;
+      break;
+    }
 
-void CppApplication::addTimerP(Timer *timer, const struct timespec& current)
-{
-  struct timespec add;
-  struct timespec expiration;
-  int timeout = timer->timeout();
-  add.tv_sec = timeout / 1000;
-  timeout -= add.tv_sec * 1000;
-  add.tv_nsec = timeout * 1000000;
-  clock_timeradd(&current, &add, &expiration);
-  
-  timer_map.insert(pair<struct timespec, Timer *>(expiration, timer));
-} /* CppApplication::addTimerP */
+    unsigned idx = wheel_tick & (WHEEL_L0_SIZE-1);
+    if (idx == 0)
+    {
+      for (unsigned level=1; level<WHEEL_LEVELS; ++level)
+      {
+        unsigned shift = WHEEL_L0_BITS + (level-1) * WHEEL_LN_BITS;
+        unsigned lidx = (wheel_tick >> shift) & (WHEEL_LN_SIZE-1);
+        wheelCascade(level, lidx);
+        if (lidx != 0)
+        {
+          break;
+        }
+      }
+    }
+    else if (wheel_cnt[0] == 0)
+    {
+        // Nothing to do on the first level so skip ahead to the next cascade
+      wheel_tick = std::min((wheel_tick | (WHEEL_L0_SIZE-1)) + 1,
+                            now_tick + 1);
+      continue;
+    }
+
+    ++wheel_tick;
+    if (wheel_l0[idx] != 0)
+    {
+      wheelExpireList(&wheel_l0[idx], 0);
+    }
+  }
+} /* CppApplication::processTimers */
 
 
-void CppApplication::delTimer(Timer *timer)
+bool CppApplication::nextTimeout(const struct timespec& now,
+                                 struct timespec& timeout)
 {
-  TimerMap::iterator iter;
-  for (iter=timer_map.begin(); iter!=timer_map.end(); ++iter)
+  if (wheel_due != 0)
   {
-    if (iter->second == timer)
+    timeout.tv_sec = 0;
+    timeout.tv_nsec = 0;
+    return true;
+  }
+  if (wheelTimerCount() == 0)
+  {
+    return false;
+  }
+
+  uint64_t next = UINT64_MAX;
+  for (unsigned i=0; (wheel_cnt[0] > 0) && (i<WHEEL_L0_SIZE); ++i)
+  {
+    if (wheel_l0[(wheel_tick + i) & (WHEEL_L0_SIZE-1)] != 0)
     {
-      //timer_map.erase(iter);
-      iter->second = 0;
+      next = wheel_tick + i;
       break;
     }
   }
-} /* CppApplication::delTimer */
+
+    // All timers on a higher level will expire at or after the next cascade
+    // of that level. On each level, the first non-empty slot after the
+    // next cascade point contain the timers that expire first on that level.
+  for (unsigned level=1; level<WHEEL_LEVELS; ++level)
+  {
+    unsigned shift = WHEEL_L0_BITS + (level-1) * WHEEL_LN_BITS;
+    uint64_t cascade_blk = (wheel_tick + (uint64_t(1) << shift) - 1) >> shift;
+    if ((cascade_blk << shift) >= next)
+    {
+      break;
+    }
+    if (wheel_cnt[level] == 0)
+    {
+      continue;
+    }
+    for (unsigned i=0; i<WHEEL_LN_SIZE; ++i)
+    {
+      WheelEntry *entry =
+        wheel_ln[level-1][(cascade_blk + i) & (WHEEL_LN_SIZE-1)];
+      if (entry != 0)
+      {
+        for (; entry!=0; entry=entry->next)
+        {
+          next = std::min(next, entry->expire);
+        }
+        break;
+      }
+    }
+  }
+  assert(next != UINT64_MAX);
+
+  uint64_t now_ns = static_cast<uint64_t>(now.tv_sec) * 1000000000 +
+                    now.tv_nsec;
+  uint64_t next_ns = next * 1000000;
+  uint64_t diff_ns = (next_ns > now_ns) ? (next_ns - now_ns) : 0;
+  timeout.tv_sec = diff_ns / 1000000000;
+  timeout.tv_nsec = diff_ns % 1000000000;
+  return true;
+} /* CppApplication::nextTimeout */
 
 
 DnsLookupWorker *CppApplication::newDnsLookupWorker(const DnsLookup& lookup)
 {
-  return new CppDnsLookupWorker(lookup);
+  if (dns_cache == nullptr)
+  {
+    dns_cache = std::make_shared<CppDnsCache>();
+  }
+  return new CppDnsLookupWorker(lookup, dns_cache);
 } /* CppApplication::newDnsLookupWorker */
 
 
@@ -9,7 +9,7 @@
  *
  * \verbatim
  * Async - A library for programming event driven applications
- * Copyright (C) 2003-2022 Tobias Blomberg
+ * Copyright (C) 2003-2026 Tobias Blomberg
  *
  * This program is free software; you can redistribute it and/or modify
  * it under the terms of the GNU General Public License as published by
@@ -45,7 +45,12 @@
 #include <sigc++/sigc++.h>
 
 #include <map>
+#include <cstdint>
+#include <set>
+#include <vector>
+#include <deque>
 #include <utility>
+#include <memory>
 
 
 /****************************************************************************
@@ -55,6 +60,7 @@
  ****************************************************************************/
 
 #include <AsyncApplication.h>
+#include <AsyncFdWatch.h>
 
 
 /****************************************************************************
@@ -71,6 +77,7 @@
  *
  ****************************************************************************/
 
+struct epoll_event;
 
 
 /****************************************************************************
@@ -82,6 +89,9 @@
 namespace Async
 {
 
+class CppDnsCache;
+
+
 /****************************************************************************
  *
  * Defines & typedefs
@@ -136,8 +146,22 @@ namespace Async
 class CppApplication : public Application
 {
   public:
+    /**
+     * @brief The backend used to wait for file descriptor activity
+     */
+    typedef enum
+    {
+      EVENT_LOOP_SELECT,  ///< Use pselect(2), available on all platforms
+      EVENT_LOOP_EPOLL    ///< Use epoll(7), only available on Linux
+    } EventLoopBackend;
+
     /**
      * @brief Constructor
+     *
+     * The event loop backend is selected when the application object is
+     * created. The epoll backend is used if it is available on the platform.
+     * Set the environment variable ASYNC_CPP_EVENT_LOOP to "select" to force
+     * the use of pselect(2) or "epoll" to explicitly ask for epoll(7).
      */
     CppApplication(void);
 
@@ -174,6 +198,12 @@ class CppApplication : public Application
      */
     void quit(void);
 
+    /**
+     * @brief   Get the event loop backend in use
+     * @return  Returns the backend used to wait for file descriptor activity
+     */
+    EventLoopBackend eventLoopBackend(void) const { return loop_backend; }
+
     /**
      * @brief   A signal that is emitted when a monitored UNIX signal is caught
      * @param   signum The signal number that was caught
@@ -187,39 +217,98 @@ class CppApplication : public Application
   protected:
     
   private:
-    struct lttimespec
+    typedef std::map<int, struct sigaction>                     UnixSignalMap;
+
+      // The watches are kept in a table indexed by file descriptor, with one
+      // slot per watch type, so that enabling and disabling a watch never
+      // allocate memory. The table only grow when a higher file descriptor
+      // than ever before is watched.
+    struct FdWatchSlots
     {
-      bool operator()(const struct timespec& t1, const struct timespec& t2) const
-      {
-        return ((t1.tv_sec == t2.tv_sec)
-                ? (t1.tv_nsec < t2.tv_nsec)
-                : (t1.tv_sec < t2.tv_sec));
-      }
+      FdWatch* watch[3];
+    };
+    typedef std::vector<FdWatchSlots>                           WatchTable;
+
+      // The timer wheel bookkeeping for an enabled timer. The entries are
+      // kept in a pool and reused so that arming and cancelling a timer do
+      // not allocate memory once the pool is large enough.
+    struct WheelEntry
+    {
+      Timer*        timer;
+      WheelEntry*   next;
+      WheelEntry**  pprev;
+      uint64_t      expire;
+      uint64_t      nominal;
+      int           level;
     };
-    typedef std::map<int, FdWatch*>   	      	      	        WatchMap;
-    typedef std::multimap<struct timespec, Timer *, lttimespec> TimerMap;
-    typedef std::map<int, struct sigaction>                     UnixSignalMap;
     
+      // The timer wheel have one level with 256 slots of one millisecond
+      // each and four levels with 64 slots each that are cascaded into the
+      // lower levels as time passes. That covers timeouts up to 2^32 ms.
+    static const unsigned WHEEL_L0_BITS   = 8;
+    static const unsigned WHEEL_LN_BITS   = 6;
+    static const unsigned WHEEL_L0_SIZE   = 1 << WHEEL_L0_BITS;
+    static const unsigned WHEEL_LN_SIZE   = 1 << WHEEL_LN_BITS;
+    static const unsigned WHEEL_LEVELS    = 5;
+    static const int      WHEEL_DUE_LIST  = WHEEL_LEVELS;
+
     static int          sighandler_pipe[2];
 
     bool      	      	do_quit;
+    EventLoopBackend    loop_backend;
     int       	      	max_desc;
     fd_set    	      	rd_set;
     fd_set    	      	wr_set;
-    WatchMap  	      	rd_watch_map;
-    WatchMap  	      	wr_watch_map;
-    TimerMap  	      	timer_map;
+    fd_set    	      	pri_set;
+    fd_set    	      	active_rd_set;
+    fd_set    	      	active_wr_set;
+    fd_set    	      	active_pri_set;
+    int                 epoll_fd;
+    std::vector<struct epoll_event> epoll_events;
+    int                 epoll_event_cnt;
+    std::set<int>       epoll_nopoll_fds;
+    WatchTable          watch_table;
+    size_t              watch_cnt;
+    WheelEntry*         wheel_l0[WHEEL_L0_SIZE];
+    WheelEntry*         wheel_ln[WHEEL_LEVELS-1][WHEEL_LN_SIZE];
+    WheelEntry*         wheel_due;
+    WheelEntry*         wheel_work;
+    std::deque<WheelEntry> wheel_entries;
+    WheelEntry*         wheel_free;
+    size_t              wheel_cnt[WHEEL_LEVELS+1];
+    uint64_t            wheel_tick;
+    uint64_t            timer_now_tick;
+    Timer*              expiring_timer;
     UnixSignalMap       unix_signals;
     int                 unix_signal_recv;
     size_t              unix_signal_recv_cnt;
+    std::shared_ptr<CppDnsCache> dns_cache;
     
     static void unixSignalHandler(int signum);
 
+    bool initEpoll(void);
+    int waitForEvents(const struct timespec *timeout);
+    void dispatchEvents(int dcnt);
+    void selectDispatch(int dcnt);
+    void epollDispatch(int dcnt);
+    void fdActivity(FdWatch *watch);
+    FdWatch* findWatch(int fd, FdWatch::FdWatchType type) const;
+    bool fdIsWatched(int fd) const;
+    void epollUpdate(int fd, bool was_watched);
     void addFdWatch(FdWatch *fd_watch);
     void delFdWatch(FdWatch *fd_watch);
     void addTimer(Timer *timer);
-    void addTimerP(Timer *timer, const struct timespec& current);
     void delTimer(Timer *timer);    
+    static uint64_t coalescedExpire(const WheelEntry *entry);
+    size_t wheelTimerCount(void) const;
+    WheelEntry *wheelEntry(Timer *timer);
+    void wheelLink(WheelEntry **head, WheelEntry *entry, int level);
+    void wheelUnlink(WheelEntry *entry);
+    void wheelInsert(WheelEntry *entry);
+    void wheelCascade(unsigned level, unsigned idx);
+    void wheelExpireList(WheelEntry **head, int level);
+    void processTimers(const struct timespec& now);
+    bool nextTimeout(const struct timespec& now, struct timespec& timeout);
     DnsLookupWorker *newDnsLookupWorker(const DnsLookup& lookup);
     void handleUnixSignal(void);
     
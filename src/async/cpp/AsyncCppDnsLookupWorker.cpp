@@ -45,6 +45,8 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 #include <cassert>
 #include <cstring>
 #include <mutex>
+#include <sstream>
+#include <algorithm>
 
 
 /****************************************************************************
@@ -54,6 +56,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
  ****************************************************************************/
 
 #include <AsyncDnsLookup.h>
+#include <AsyncWorkerPool.h>
 
 
 /****************************************************************************
@@ -178,174 +181,215 @@ namespace {
  ****************************************************************************/
 
 
-CppDnsLookupWorker::CppDnsLookupWorker(const DnsLookup& dns)
-  : DnsLookupWorker(dns)
+CppDnsCache::CppDnsCache(void)
 {
-  m_notifier_watch.activity.connect(
-      sigc::mem_fun(*this, &CppDnsLookupWorker::notificationReceived));
-} /* CppDnsLookupWorker::CppDnsLookupWorker */
+} /* CppDnsCache::CppDnsCache */
 
 
-CppDnsLookupWorker::~CppDnsLookupWorker(void)
+CppDnsCache::~CppDnsCache(void)
 {
-  abortLookup();
-} /* CppDnsLookupWorker::~CppDnsLookupWorker */
+  shutdown();
+} /* CppDnsCache::~CppDnsCache */
 
 
-DnsLookupWorker& CppDnsLookupWorker::operator=(DnsLookupWorker&& other_base)
+void CppDnsCache::lookup(CppDnsLookupWorker* worker,
+                         const std::string& label, DnsLookup::Type type)
 {
-  this->DnsLookupWorker::operator=(std::move(other_base));
-  auto& other = static_cast<CppDnsLookupWorker&>(other_base);
+  if (m_entries.size() > MAX_ENTRIES)
+  {
+    expire();
+  }
 
-  abortLookup();
+  const Key key(type, label);
+  Entry& entry = m_entries[key];
+  const auto now = Clock::now();
+  if ((entry.answer != nullptr) && (now < entry.expires))
+  {
+      // Renew the answer in the background when the last tenth of its
+      // lifetime has been reached
+    if (!entry.pending && (10 * (entry.expires - now) < entry.answer->ttl))
+    {
+      startQuery(key, entry);
+    }
+    worker->answerReady(entry.answer);
+    return;
+  }
 
-  m_result = std::move(other.m_result);
-  assert(!other.m_result.valid());
+  entry.waiters.push_back(worker);
+  if (!entry.pending)
+  {
+    startQuery(key, entry);
+  }
+} /* CppDnsCache::lookup */
 
-  m_notifier_watch = std::move(other.m_notifier_watch);
 
-  return *this;
-} /* CppDnsLookupWorker::operator=(DnsLookupWorker&&) */
+void CppDnsCache::cancel(CppDnsLookupWorker* worker)
+{
+  for (auto& item : m_entries)
+  {
+    auto& waiters = item.second.waiters;
+    waiters.erase(std::remove(waiters.begin(), waiters.end(), worker),
+                  waiters.end());
+  }
+} /* CppDnsCache::cancel */
+
+
+void CppDnsCache::shutdown(void)
+{
+  m_pool.reset();
+  m_entries.clear();
+} /* CppDnsCache::shutdown */
 
 
 /****************************************************************************
  *
- * Protected member functions
+ * Private member functions
  *
  ****************************************************************************/
 
-bool CppDnsLookupWorker::doLookup(void)
+void CppDnsCache::startQuery(const Key& key, Entry& entry)
 {
-    // A lookup is already running
-  if (m_result.valid())
+  if (m_pool == nullptr)
   {
-    return true;
+    m_pool.reset(new WorkerPool(THREADS, "dns"));
   }
+  entry.pending = true;
+  m_pool->call(
+      [key](void) { return runQuery(key.second, key.first); },
+      [this, key](std::shared_ptr<CppDnsAnswer> answer)
+      {
+        queryDone(key, answer);
+      });
+} /* CppDnsCache::startQuery */
 
-  setLookupFailed(false);
 
-  int fd[2];
-  if (pipe(fd) != 0)
+void CppDnsCache::queryDone(const Key& key,
+                            std::shared_ptr<CppDnsAnswer> answer)
+{
+  auto it = m_entries.find(key);
+  if (it == m_entries.end())
   {
-    printErrno("ERROR: Could not create pipe");
-    setLookupFailed();
-    return false;
+    return;
   }
-  m_notifier_watch.setFd(fd[0], FdWatch::FD_WATCH_RD);
-  m_notifier_watch.setEnabled(true);
-
-  m_ctx = std::unique_ptr<ThreadContext>(new ThreadContext);
-  m_ctx->label = dns().label();
-  m_ctx->type = dns().type();
-  m_ctx->notifier_wr = fd[1];
-  m_ctx->anslen = 0;
-  m_ctx->thread_cerr.clear();
-  m_result = std::async(std::launch::async, workerFunc, std::ref(*m_ctx));
-
-  return true;
-
-} /* CppDnsLookupWorker::doLookup */
-
-
-void CppDnsLookupWorker::abortLookup(void)
-{
-  if (m_result.valid())
+  Entry& entry = it->second;
+  answer->timestamp = Clock::now();
+  entry.pending = false;
+  entry.answer = answer;
+  entry.expires = answer->timestamp + answer->ttl;
+
+  std::vector<CppDnsLookupWorker*> waiters;
+  waiters.swap(entry.waiters);
+  if (answer->ttl.count() == 0)
   {
-    m_result.get();
+    m_entries.erase(it);
   }
-
-  int fd = m_notifier_watch.fd();
-  if (fd >= 0)
+  for (auto& worker : waiters)
   {
-    m_notifier_watch.setFd(-1, FdWatch::FD_WATCH_RD);
-    close(fd);
+    worker->answerReady(answer);
   }
+} /* CppDnsCache::queryDone */
 
-  m_ctx.reset();
-} /* CppDnsLookupWorker::abortLookup */
 
+void CppDnsCache::expire(void)
+{
+  const auto now = Clock::now();
+  auto it = m_entries.begin();
+  while (it != m_entries.end())
+  {
+    const Entry& entry = it->second;
+    if (!entry.pending && entry.waiters.empty() && (entry.expires <= now))
+    {
+      it = m_entries.erase(it);
+    }
+    else
+    {
+      ++it;
+    }
+  }
+} /* CppDnsCache::expire */
 
-/****************************************************************************
- *
- * Private member functions
- *
- ****************************************************************************/
 
 /*
  *----------------------------------------------------------------------------
- * Method:    CppDnsLookupWorker::workerFunc
+ * Method:    CppDnsCache::runQuery
  * Purpose:   This is the function that do the actual DNS lookup. It is
- *    	      started as a separate thread since res_nsearch is a
- *    	      blocking function.
- * Input:     ctx - A context containing query and result parameters
- * Output:    The answer and anslen variables in the ThreadContext will be
- *            filled in with the lookup result. The context will be returned
- *            from this function.
+ *    	      run in a worker thread since the resolver functions are
+ *    	      blocking.
+ * Input:     label - The label to look up
+ *            type  - The record type to look up
+ * Output:    Returns the answer, which is also used for negative answers
  * Author:    Tobias Blomberg
  * Created:   2021-07-14
  * Remarks:   
  * Bugs:      
  *----------------------------------------------------------------------------
  */
-void CppDnsLookupWorker::workerFunc(CppDnsLookupWorker::ThreadContext& ctx)
+std::shared_ptr<CppDnsAnswer> CppDnsCache::runQuery(const std::string& label,
+                                                    DnsLookup::Type type)
 {
-  std::ostream& th_cerr = ctx.thread_cerr;
+  std::shared_ptr<CppDnsAnswer> ctx = std::make_shared<CppDnsAnswer>();
+  ctx->label = label;
+  ctx->type = type;
+  std::ostringstream th_cerr;
 
   int qtype = 0;
-  switch (ctx.type)
+  switch (ctx->type)
   {
     case DnsLookup::Type::A:
     {
       struct addrinfo hints = {0};
       hints.ai_family = AF_INET;
-      int ret = getaddrinfo(ctx.label.c_str(), NULL, &hints, &ctx.addrinfo);
+      int ret = getaddrinfo(ctx->label.c_str(), NULL, &hints, &ctx->addrinfo);
       if (ret != 0)
       {
         th_cerr << "*** WARNING[getaddrinfo]: Could not look up host \""
-                << ctx.label << "\": " << gai_strerror(ret) << std::endl;
+                << ctx->label << "\": " << gai_strerror(ret) << std::endl;
       }
-      else if (ctx.addrinfo == nullptr)
+      else if (ctx->addrinfo == nullptr)
       {
         th_cerr << "*** WARNING[getaddrinfo]: No address info returned "
-                   "for host \"" << ctx.label << "\"" << std::endl;
+                   "for host \"" << ctx->label << "\"" << std::endl;
       }
+      ctx->failed = (ctx->addrinfo == nullptr);
       break;
     }
     case DnsLookup::Type::PTR:
     {
       IpAddress ip_addr;
-      size_t arpa_domain_pos = ctx.label.find(".in-addr.arpa");
+      size_t arpa_domain_pos = ctx->label.find(".in-addr.arpa");
       if (arpa_domain_pos != std::string::npos)
       {
-        ip_addr.setIpFromString(ctx.label.substr(0, arpa_domain_pos));
+        ip_addr.setIpFromString(ctx->label.substr(0, arpa_domain_pos));
         struct in_addr addr = ip_addr.ip4Addr();
         addr.s_addr = htonl(addr.s_addr);
         ip_addr.setIp(addr);
       }
       else
       {
-        ip_addr.setIpFromString(ctx.label);
+        ip_addr.setIpFromString(ctx->label);
       }
       if (!ip_addr.isEmpty())
       {
         struct sockaddr_in in_addr = {0};
         in_addr.sin_family = AF_INET;
         in_addr.sin_addr = ip_addr.ip4Addr();
+        char host[NI_MAXHOST] = {0};
         int ret = getnameinfo(reinterpret_cast<struct sockaddr*>(&in_addr),
-                              sizeof(in_addr),
-                              ctx.host, sizeof(ctx.host),
+                              sizeof(in_addr), host, sizeof(host),
                               NULL, 0, NI_NAMEREQD);
         if (ret != 0)
         {
           th_cerr << "*** WARNING[getnameinfo]: Could not look up IP \""
-                  << ctx.label << "\": " << gai_strerror(ret) << std::endl;
+                  << ctx->label << "\": " << gai_strerror(ret) << std::endl;
         }
+        ctx->host = host;
       }
       else
       {
         th_cerr << "*** WARNING: Failed to parse PTR label \""
-                << ctx.label << "\"" << std::endl;
+                << ctx->label << "\"" << std::endl;
       }
+      ctx->failed = ctx->host.empty();
       break;
     }
     case DnsLookup::Type::CNAME:
@@ -358,19 +402,52 @@ void CppDnsLookupWorker::workerFunc(CppDnsLookupWorker::ThreadContext& ctx)
       assert(0);
   }
 
+  ctx->ttl = std::chrono::seconds(
+      ctx->failed ? unsigned(NEGATIVE_TTL) : unsigned(HOST_TTL));
   if (qtype != 0)
   {
+    ctx->failed = true;
+    ctx->ttl = std::chrono::seconds(unsigned(NEGATIVE_TTL));
     Resolver res;
     int ret = res.init();
     if (ret != -1)
     {
-      const char *dname = ctx.label.c_str();
-      ctx.anslen = res.search(dname, ns_c_in, qtype,
-                              ctx.answer, sizeof(ctx.answer));
-      if (ctx.anslen == -1)
+      ctx->answer.resize(NS_MAXMSG);
+      const char *dname = ctx->label.c_str();
+      ctx->anslen = res.search(dname, ns_c_in, qtype,
+                               ctx->answer.data(), ctx->answer.size());
+      if (ctx->anslen == -1)
       {
         th_cerr << "*** ERROR: Name resolver failure -- res_nsearch: "
                 << hstrerror(h_errno) << std::endl;
+        ctx->answer.clear();
+      }
+      else
+      {
+        ctx->answer.resize(ctx->anslen);
+        ctx->answer.shrink_to_fit();
+
+          // Find the lowest TTL in the answer to know how long the answer
+          // can be cached
+        ns_msg msg;
+        if (ns_initparse(ctx->answer.data(), ctx->anslen, &msg) != -1)
+        {
+          uint32_t min_ttl = MAX_TTL;
+          uint16_t msg_cnt = ns_msg_count(msg, ns_s_an);
+          for (uint16_t rrnum=0; rrnum<msg_cnt; ++rrnum)
+          {
+            ns_rr rr;
+            if (ns_parserr(&msg, ns_s_an, rrnum, &rr) != -1)
+            {
+              min_ttl = std::min(min_ttl, uint32_t(ns_rr_ttl(rr)));
+            }
+          }
+          if (msg_cnt > 0)
+          {
+            ctx->failed = false;
+            ctx->ttl = std::chrono::seconds(min_ttl);
+          }
+        }
       }
     }
     else
@@ -380,18 +457,103 @@ void CppDnsLookupWorker::workerFunc(CppDnsLookupWorker::ThreadContext& ctx)
     }
   }
 
-  close(ctx.notifier_wr);
-  ctx.notifier_wr = -1;
-} /* CppDnsLookupWorker::workerFunc */
+  ctx->errstr = th_cerr.str();
+  return ctx;
+} /* CppDnsCache::runQuery */
+
+
+CppDnsLookupWorker::CppDnsLookupWorker(const DnsLookup& dns,
+                                       std::shared_ptr<CppDnsCache> cache)
+  : DnsLookupWorker(dns), m_cache(cache),
+    m_answer_timer(0, Timer::TYPE_ONESHOT, false)
+{
+  m_answer_timer.expired.connect(
+      sigc::hide(sigc::mem_fun(*this, &CppDnsLookupWorker::parseAnswer)));
+} /* CppDnsLookupWorker::CppDnsLookupWorker */
 
 
+CppDnsLookupWorker::~CppDnsLookupWorker(void)
+{
+  abortLookup();
+} /* CppDnsLookupWorker::~CppDnsLookupWorker */
+
+
+DnsLookupWorker& CppDnsLookupWorker::operator=(DnsLookupWorker&& other_base)
+{
+  this->DnsLookupWorker::operator=(std::move(other_base));
+  auto& other = static_cast<CppDnsLookupWorker&>(other_base);
+
+  abortLookup();
+  other.abortLookup();
+
+    // The lookup is started again for this worker. Since the query is
+    // shared in the cache this does not cause a new query to be sent.
+  if (lookupPending())
+  {
+    m_waiting = true;
+    m_cache->lookup(this, dns().label(), dns().type());
+  }
+
+  return *this;
+} /* CppDnsLookupWorker::operator=(DnsLookupWorker&&) */
+
+
+void CppDnsLookupWorker::answerReady(std::shared_ptr<const CppDnsAnswer> answer)
+{
+  m_waiting = false;
+  m_answer = answer;
+  m_answer_timer.setEnable(true);
+} /* CppDnsLookupWorker::answerReady */
+
+
+/****************************************************************************
+ *
+ * Protected member functions
+ *
+ ****************************************************************************/
+
+bool CppDnsLookupWorker::doLookup(void)
+{
+    // A lookup is already running
+  if (m_waiting || m_answer_timer.isEnabled())
+  {
+    return true;
+  }
+
+  setLookupFailed(false);
+  m_waiting = true;
+  m_cache->lookup(this, dns().label(), dns().type());
+
+  return true;
+
+} /* CppDnsLookupWorker::doLookup */
+
+
+void CppDnsLookupWorker::abortLookup(void)
+{
+  if (m_waiting)
+  {
+    m_cache->cancel(this);
+    m_waiting = false;
+  }
+  m_answer_timer.setEnable(false);
+  m_answer.reset();
+} /* CppDnsLookupWorker::abortLookup */
+
+
+/****************************************************************************
+ *
+ * Private member functions
+ *
+ ****************************************************************************/
+
 /*
  *----------------------------------------------------------------------------
- * Method:    CppDnsLookupWorker::notificationReceived
- * Purpose:   When the DNS lookup thread is done, this function will be
- *            called to parse the result and notify the user that an answer
- *            is available.
- * Input:     w - The file watch object (notification pipe)
+ * Method:    CppDnsLookupWorker::parseAnswer
+ * Purpose:   When the answer is available from the cache, this function
+ *            will be called to parse the result and notify the user that an
+ *            answer is available.
+ * Input:     None
  * Output:    None
  * Author:    Tobias Blomberg
  * Created:   2005-04-12
@@ -399,30 +561,29 @@ void CppDnsLookupWorker::workerFunc(CppDnsLookupWorker::ThreadContext& ctx)
  * Bugs:      
  *----------------------------------------------------------------------------
  */
-void CppDnsLookupWorker::notificationReceived(FdWatch *w)
+void CppDnsLookupWorker::parseAnswer(void)
 {
-  char buf[1];
-  int cnt = read(w->fd(), buf, sizeof(buf));
-  assert(cnt == 0);
-  close(w->fd());
-  w->setFd(-1, FdWatch::FD_WATCH_RD);
+  assert(m_answer != nullptr);
+  std::shared_ptr<const CppDnsAnswer> ans;
+  ans.swap(m_answer);
 
-  m_result.get();
-
-  const std::string& thread_errstr = m_ctx->thread_cerr.str();
-  if (!thread_errstr.empty())
+  if (!ans->errstr.empty())
+  {
+    std::cerr << ans->errstr;
+    setLookupFailed();
+  }
+  if (ans->failed)
   {
-    std::cerr << thread_errstr;
     setLookupFailed();
   }
 
-  if (m_ctx->type == DnsResourceRecord::Type::A)
+  if (ans->type == DnsResourceRecord::Type::A)
   {
-    if (m_ctx->addrinfo != nullptr)
+    if (ans->addrinfo != nullptr)
     {
       struct addrinfo *entry;
       std::vector<IpAddress> the_addresses;
-      for (entry = m_ctx->addrinfo; entry != 0; entry = entry->ai_next)
+      for (entry = ans->addrinfo; entry != 0; entry = entry->ai_next)
       {
         IpAddress ip_addr(
             reinterpret_cast<struct sockaddr_in*>(entry->ai_addr)->sin_addr);
@@ -435,34 +596,33 @@ void CppDnsLookupWorker::notificationReceived(FdWatch *w)
         {
           the_addresses.push_back(ip_addr);
           addResourceRecord(
-              new DnsResourceRecordA(m_ctx->label, 0, ip_addr));
+              new DnsResourceRecordA(ans->label, 0, ip_addr));
         }
       }
-      m_ctx.reset();
     }
   }
-  else if (m_ctx->type == DnsResourceRecord::Type::PTR)
+  else if (ans->type == DnsResourceRecord::Type::PTR)
   {
-    if (m_ctx->host[0] != '\0')
+    if (!ans->host.empty())
     {
       addResourceRecord(
-          new DnsResourceRecordPTR(m_ctx->label, 0, m_ctx->host));
+          new DnsResourceRecordPTR(ans->label, 0, ans->host));
     }
   }
   else
   {
-    if (m_ctx->anslen == -1)
+    if (ans->anslen == -1)
     {
       workerDone();
       return;
     }
 
     ns_msg msg;
-    int ret = ns_initparse(m_ctx->answer, m_ctx->anslen, &msg);
+    int ret = ns_initparse(ans->answer.data(), ans->anslen, &msg);
     if (ret == -1)
     {
       std::stringstream ss;
-      ss << "WARNING: ns_initparse failed (anslen=" << m_ctx->anslen << ")";
+      ss << "WARNING: ns_initparse failed (anslen=" << ans->anslen << ")";
       printErrno(ss.str());
       setLookupFailed();
       workerDone();
@@ -493,7 +653,12 @@ void CppDnsLookupWorker::notificationReceived(FdWatch *w)
         setLookupFailed();
         continue;
       }
+        // The answer may have been cached for a while so the TTL is reduced
+        // with the age of the answer
+      const uint32_t age = std::chrono::duration_cast<std::chrono::seconds>(
+          CppDnsAnswer::Clock::now() - ans->timestamp).count();
       uint32_t ttl = ns_rr_ttl(rr);
+      ttl = (ttl > age) ? ttl - age : 0;
       uint16_t type = ns_rr_type(rr);
       const unsigned char *cp = ns_rr_rdata(rr);
       switch (type)
@@ -578,7 +743,7 @@ void CppDnsLookupWorker::notificationReceived(FdWatch *w)
     }
   }
   workerDone();
-} /* CppDnsLookupWorker::notificationReceived */
+} /* CppDnsLookupWorker::parseAnswer */
 
 
 void CppDnsLookupWorker::printErrno(const std::string& msg)
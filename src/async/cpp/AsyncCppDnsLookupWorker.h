@@ -44,8 +44,10 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 #include <arpa/nameser.h>
 
 #include <string>
-#include <sstream>
-#include <future>
+#include <vector>
+#include <map>
+#include <memory>
+#include <chrono>
 #include <netdb.h>
 
 
@@ -55,7 +57,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
  *
  ****************************************************************************/
 
-#include <AsyncFdWatch.h>
+#include <AsyncTimer.h>
 
 
 /****************************************************************************
@@ -91,6 +93,9 @@ namespace Async
  *
  ****************************************************************************/
 
+class WorkerPool;
+class CppDnsLookupWorker;
+
 
 
 /****************************************************************************
@@ -115,6 +120,123 @@ namespace Async
  *
  ****************************************************************************/
 
+/**
+@brief	The answer to one DNS query
+@author Tobias Blomberg / SM0SVX
+@date   2026-10-14
+
+This is the raw result of a query, as returned by the system resolver
+functions. It is shared between the DNS cache and all lookup workers that
+have asked for the same label and type, which each parse it into their own
+set of resource records.
+*/
+struct CppDnsAnswer
+{
+  using Clock = std::chrono::steady_clock;
+
+  std::string                 label;
+  DnsLookup::Type             type          = DnsLookup::Type::A;
+  std::vector<unsigned char>  answer;
+  int                         anslen        = 0;
+  struct addrinfo*            addrinfo      = nullptr;
+  std::string                 host;
+  std::string                 errstr;
+  Clock::time_point           timestamp;
+  std::chrono::seconds        ttl           {0};
+  bool                        failed        = false;
+
+  ~CppDnsAnswer(void)
+  {
+    if (addrinfo != nullptr)
+    {
+      freeaddrinfo(addrinfo);
+      addrinfo = nullptr;
+    }
+  }
+};  /* struct CppDnsAnswer */
+
+
+/**
+@brief	A process wide cache for DNS answers
+@author Tobias Blomberg / SM0SVX
+@date   2026-10-14
+
+All DNS lookups in a Cpp application go through this cache. Answers are kept
+for as long as their TTL allow. Failed lookups are kept for a short time too
+so that a failing name server is not hammered with the same queries. Since
+getaddrinfo and getnameinfo do not give the TTL, A and PTR answers are kept
+for a fixed time. When more than one lookup for the same label and type is
+started while a query is running, they all wait for the same answer. A query
+is started in the background when a cached answer is used near the end of
+its lifetime so that it is renewed before it expire. The queries are run by a
+small pool of threads that is reused between lookups.
+This is an internal class that should only be used from within the async
+library.
+*/
+class CppDnsCache
+{
+  public:
+    static const unsigned THREADS         = 4;
+    static const unsigned MAX_ENTRIES     = 1024;
+    static const unsigned HOST_TTL        = 30;
+    static const unsigned NEGATIVE_TTL    = 30;
+    static const unsigned MAX_TTL         = 86400;
+
+    CppDnsCache(void);
+    ~CppDnsCache(void);
+
+    /**
+     * @brief   Look up a label
+     * @param   worker  The worker to deliver the answer to
+     * @param   label   The label to look up
+     * @param   type    The record type to look up
+     *
+     * The answer is delivered by calling answerReady on the worker, but
+     * never before this function has returned.
+     */
+    void lookup(CppDnsLookupWorker* worker, const std::string& label,
+                DnsLookup::Type type);
+
+    /**
+     * @brief   Cancel a lookup started by a worker
+     * @param   worker The worker that started the lookup
+     */
+    void cancel(CppDnsLookupWorker* worker);
+
+    /**
+     * @brief   Stop all queries and clear the cache
+     *
+     * This function is called when the application is destroyed. Lookups
+     * that are waiting for an answer will never get one.
+     */
+    void shutdown(void);
+
+  private:
+    using Clock = CppDnsAnswer::Clock;
+    using Key = std::pair<DnsLookup::Type, std::string>;
+    using AnswerPtr = std::shared_ptr<const CppDnsAnswer>;
+    struct Entry
+    {
+      AnswerPtr                         answer;
+      Clock::time_point                 expires;
+      bool                              pending = false;
+      std::vector<CppDnsLookupWorker*>  waiters;
+    };
+
+    std::map<Key, Entry>                m_entries;
+    std::unique_ptr<WorkerPool>         m_pool;
+
+    CppDnsCache(const CppDnsCache&);
+    CppDnsCache& operator=(const CppDnsCache&);
+    void startQuery(const Key& key, Entry& entry);
+    void queryDone(const Key& key, std::shared_ptr<CppDnsAnswer> answer);
+    void expire(void);
+    static std::shared_ptr<CppDnsAnswer> runQuery(const std::string& label,
+                                                  DnsLookup::Type type);
+
+};  /* class CppDnsCache */
+
+
 /**
 @brief	DNS lookup worker for the Cpp (Posix) variant of the async environment
 @author Tobias Blomberg
@@ -131,7 +253,8 @@ class CppDnsLookupWorker : public DnsLookupWorker, public sigc::trackable
      * @brief 	Constructor
      * @param 	dns The lookup object
      */
-    CppDnsLookupWorker(const DnsLookup& dns);
+    CppDnsLookupWorker(const DnsLookup& dns,
+                       std::shared_ptr<CppDnsCache> cache);
 
     /**
      * @brief 	Destructor
@@ -145,6 +268,12 @@ class CppDnsLookupWorker : public DnsLookupWorker, public sigc::trackable
      */
     virtual DnsLookupWorker& operator=(DnsLookupWorker&& other_base);
 
+    /**
+     * @brief   Called by the DNS cache when the answer is available
+     * @param   answer The answer to the query
+     */
+    void answerReady(std::shared_ptr<const CppDnsAnswer> answer);
+
   protected:
     /**
      * @brief   Called by the DnsLookupWorker class to start the lookup
@@ -159,33 +288,12 @@ class CppDnsLookupWorker : public DnsLookupWorker, public sigc::trackable
     virtual void abortLookup(void);
 
   private:
-    struct ThreadContext
-    {
-      std::string         label;
-      DnsLookup::Type     type                = DnsLookup::Type::A;
-      int                 notifier_wr         = -1;
-      unsigned char       answer[NS_MAXMSG];
-      int                 anslen              = 0;
-      struct addrinfo*    addrinfo            = nullptr;
-      char                host[NI_MAXHOST]    = {0};
-      std::ostringstream  thread_cerr;
-
-      ~ThreadContext(void)
-      {
-        if (addrinfo != nullptr)
-        {
-          freeaddrinfo(addrinfo);
-          addrinfo = nullptr;
-        }
-      }
-    };
-
-    Async::FdWatch                  m_notifier_watch;
-    std::future<void>               m_result;
-    std::unique_ptr<ThreadContext>  m_ctx;
+    std::shared_ptr<CppDnsCache>        m_cache;
+    std::shared_ptr<const CppDnsAnswer> m_answer;
+    Async::Timer                        m_answer_timer;
+    bool                                m_waiting       = false;
 
-    static void workerFunc(ThreadContext& ctx);
-    void notificationReceived(FdWatch *w);
+    void parseAnswer(void);
     void printErrno(const std::string& msg);
 
 };  /* class CppDnsLookupWorker */
@@ -0,0 +1,194 @@
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <chrono>
+#include <cstdlib>
+#include <cmath>
+
+#include <AsyncAudioAmp.h>
+#include <AsyncAudioClipper.h>
+#include <AsyncAudioCompressor.h>
+
+using namespace std;
+using namespace Async;
+
+  // The block size used by most of the audio pipe
+static const int BLOCK_SIZE = 256;
+
+  // Make the processSamples function of an audio processor accessible
+template <class T>
+class Kernel : public T
+{
+  public:
+    void process(float *dest, const float *src, int count)
+    {
+      T::processSamples(dest, src, count);
+    }
+};
+
+  // The per sample implementations that the block kernels replaced, used
+  // as a reference for both speed and output
+class RefAmp
+{
+  public:
+    float gain = powf(10, 3.0f / 20);
+
+    void process(float *dest, const float *src, int count)
+    {
+      for (int i=0; i<count; ++i)
+      {
+        dest[i] = src[i] * gain;
+      }
+    }
+};
+
+class RefClipper
+{
+  public:
+    float clip_level = 0.98f;
+
+    void process(float *dest, const float *src, int count)
+    {
+      for (int i=0; i<count; ++i)
+      {
+        if (src[i] > clip_level)
+        {
+          dest[i] = clip_level;
+        }
+        else if (src[i] < -clip_level)
+        {
+          dest[i] = -clip_level;
+        }
+        else
+        {
+          dest[i] = src[i];
+        }
+      }
+    }
+};
+
+class RefCompressor
+{
+  public:
+    RefCompressor(double thresh_db, double ratio, double att_ms,
+                  double rel_ms)
+      : threshdB_(thresh_db), ratio_(ratio), att_(att_ms), rel_(rel_ms),
+        envdB_(DC_OFFSET)
+    {
+    }
+
+    void process(float *dest, const float *src, int count)
+    {
+      for (int i=0; i<count; ++i)
+      {
+        double rect = fabs(src[i]) + DC_OFFSET;
+        double keydB = log(rect) * 8.6858896380650365530225783783321;
+        double overdB = keydB - threshdB_;
+        if (overdB < 0.0)
+        {
+          overdB = 0.0;
+        }
+        overdB += DC_OFFSET;
+        if (overdB > envdB_)
+        {
+          att_.run(overdB, envdB_);
+        }
+        else
+        {
+          rel_.run(overdB, envdB_);
+        }
+        overdB = envdB_ - DC_OFFSET;
+        double gr = overdB * (ratio_ - 1.0);
+        gr = exp(gr * 0.11512925464970228420089957273422);
+        dest[i] = src[i] * gr;
+      }
+    }
+
+  private:
+    static constexpr double DC_OFFSET = 1.0E-25;
+
+    double            threshdB_;
+    double            ratio_;
+    EnvelopeDetector  att_;
+    EnvelopeDetector  rel_;
+    double            envdB_;
+};
+
+  // Run a kernel over all samples and return the throughput in samples/s
+template <class K>
+static double bench(K& kernel, const vector<float>& in, vector<float>& out)
+{
+  chrono::steady_clock::time_point start = chrono::steady_clock::now();
+  for (size_t pos=0; pos<in.size(); pos+=BLOCK_SIZE)
+  {
+    int count = min<size_t>(BLOCK_SIZE, in.size() - pos);
+    kernel.process(&out[pos], &in[pos], count);
+  }
+  chrono::duration<double> elapsed = chrono::steady_clock::now() - start;
+  return in.size() / elapsed.count();
+}
+
+static void report(const char *name, double ref_rate, double rate,
+                   const vector<float>& ref, const vector<float>& out)
+{
+  float max_diff = 0.0f;
+  for (size_t i=0; i<ref.size(); ++i)
+  {
+    max_diff = max(max_diff, fabsf(ref[i] - out[i]));
+  }
+  cout << setw(12) << left << name << right
+       << setw(10) << setprecision(1) << ref_rate / 1.0e6
+       << setw(10) << rate / 1.0e6
+       << setw(9) << setprecision(2) << rate / ref_rate << "x"
+       << setw(12) << scientific << setprecision(1) << max_diff
+       << fixed << "\n";
+}
+
+int main(int argc, const char **argv)
+{
+  const int seconds = (argc > 1) ? atoi(argv[1]) : 600;
+  vector<float> in(INTERNAL_SAMPLE_RATE * seconds);
+  for (size_t i=0; i<in.size(); ++i)
+  {
+      // A tone that is slowly amplitude modulated so that the compressor
+      // both attack and release, with some added noise
+    float env = 0.6f + 0.5f * sin(2.0 * M_PI * 0.5 * i / INTERNAL_SAMPLE_RATE);
+    in[i] = env * sin(2.0 * M_PI * 1000.0 * i / INTERNAL_SAMPLE_RATE) +
+            0.05f * (rand() / (float)RAND_MAX - 0.5f);
+  }
+  vector<float> ref(in.size());
+  vector<float> out(in.size());
+
+  cout << "Processed " << seconds << " seconds of audio in blocks of "
+       << BLOCK_SIZE << " samples\n";
+  cout << fixed;
+  cout << "Kernel      Ref MS/s  New MS/s  Speedup    Max diff\n";
+
+  RefAmp ref_amp;
+  Kernel<AudioAmp> amp;
+  amp.setGain(3.0f);
+  double ref_rate = bench(ref_amp, in, ref);
+  double rate = bench(amp, in, out);
+  report("amp", ref_rate, rate, ref, out);
+
+  RefClipper ref_clipper;
+  Kernel<AudioClipper> clipper;
+  clipper.setClipLevel(0.98f);
+  ref_rate = bench(ref_clipper, in, ref);
+  rate = bench(clipper, in, out);
+  report("clipper", ref_rate, rate, ref, out);
+
+    // The same settings as used for the limiter in the receivers
+  RefCompressor ref_comp(-1.0, 0.1, 2, 20);
+  Kernel<AudioCompressor> comp;
+  comp.setThreshold(-1.0);
+  comp.setRatio(0.1);
+  comp.setAttack(2);
+  comp.setDecay(20);
+  comp.setOutputGain(1);
+  ref_rate = bench(ref_comp, in, ref);
+  rate = bench(comp, in, out);
+  report("compressor", ref_rate, rate, ref, out);
+
+  return 0;
+}
@@ -0,0 +1,145 @@
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <chrono>
+#include <cstdlib>
+#include <cmath>
+
+#include <AsyncCppApplication.h>
+#include <AsyncAudioSink.h>
+#include <AsyncAudioAmp.h>
+#include <AsyncAudioFilter.h>
+#include <AsyncAudioCompressor.h>
+#include <AsyncAudioClipper.h>
+#include <AsyncAudioProcessorChain.h>
+
+using namespace std;
+using namespace Async;
+
+  // A sink that accept all samples and calculate a simple checksum so that
+  // the output of the two chains can be compared
+class NullSink : public AudioSink
+{
+  public:
+    double sum = 0.0;
+
+    int writeSamples(const float *samples, int count)
+    {
+      for (int i=0; i<count; ++i)
+      {
+        sum += fabs(samples[i]);
+      }
+      return count;
+    }
+
+    void flushSamples(void) { sourceAllSamplesFlushed(); }
+};
+
+  // Create the same type of stages as used at the end of the LocalRxBase
+  // audio pipe
+static void createStages(vector<AudioProcessor*>& stages)
+{
+  AudioAmp *preamp = new AudioAmp;
+  preamp->setGain(3.0f);
+  stages.push_back(preamp);
+  stages.push_back(new AudioFilter("LpBu1/300"));
+  stages.push_back(new AudioFilter("BpCh12/-0.1/300-3500"));
+  AudioCompressor *limit = new AudioCompressor;
+  limit->setThreshold(-1.0);
+  limit->setRatio(0.1);
+  limit->setAttack(2);
+  limit->setDecay(20);
+  limit->setOutputGain(1);
+  stages.push_back(limit);
+  AudioClipper *clipper = new AudioClipper;
+  clipper->setClipLevel(0.98);
+  stages.push_back(clipper);
+  stages.push_back(new AudioFilter("LpCh9/-0.05/3500"));
+}
+
+  // Write all samples in odd sized blocks, like they arrive from the audio
+  // device, and return the time it took in seconds
+static double run(AudioSink *sink, const vector<float>& samples)
+{
+  srand(1);
+  chrono::steady_clock::time_point start = chrono::steady_clock::now();
+  size_t pos = 0;
+  while (pos < samples.size())
+  {
+    int count = min<size_t>(1 + rand() % 300, samples.size() - pos);
+    int written = 0;
+    while (written < count)
+    {
+      written += sink->writeSamples(&samples[pos + written], count - written);
+    }
+    pos += count;
+  }
+  chrono::duration<double> elapsed = chrono::steady_clock::now() - start;
+  return elapsed.count();
+}
+
+int main(int argc, const char **argv)
+{
+  CppApplication app;
+
+  const int seconds = (argc > 1) ? atoi(argv[1]) : 60;
+  vector<float> samples(INTERNAL_SAMPLE_RATE * seconds);
+  for (size_t i=0; i<samples.size(); ++i)
+  {
+    samples[i] = 0.5f * sin(2.0 * M_PI * 1000.0 * i / INTERNAL_SAMPLE_RATE) +
+                 0.2f * (rand() / (float)RAND_MAX - 0.5f);
+  }
+  const char *names[] = { "amp", "deemph", "voiceband", "limiter",
+                          "clipper", "splatter" };
+
+    // The usual way, with the stages connected one after the other
+  vector<AudioProcessor*> push_stages;
+  createStages(push_stages);
+  NullSink push_sink;
+  for (size_t i=1; i<push_stages.size(); ++i)
+  {
+    push_stages[i-1]->registerSink(push_stages[i]);
+  }
+  push_stages.back()->registerSink(&push_sink);
+  double push_time = run(push_stages.front(), samples);
+
+    // The same stages run by a processor chain
+  vector<AudioProcessor*> chain_stages;
+  createStages(chain_stages);
+  AudioProcessorChain chain;
+  for (size_t i=0; i<chain_stages.size(); ++i)
+  {
+    chain.addStage(chain_stages[i], true, names[i]);
+  }
+  NullSink chain_sink;
+  chain.registerSink(&chain_sink);
+  double chain_time = run(&chain, samples);
+  double chain_sum = chain_sink.sum;
+
+    // Run again, measuring the time spent in each stage
+  chain.setProfilingEnabled(true);
+  run(&chain, samples);
+
+  cout << "Processed " << seconds << " seconds of audio\n";
+  cout << fixed << setprecision(1);
+  cout << "Connected stages: " << push_time * 1000.0 << " ms\n";
+  cout << "Processor chain:  " << chain_time * 1000.0 << " ms\n";
+  cout << "Output checksums: " << push_sink.sum << " / "
+       << chain_sum << "\n";
+  cout << "Time per stage:\n";
+  for (size_t i=0; i<chain.stageCount(); ++i)
+  {
+    cout << "  " << setw(10) << left << chain.stageName(i) << right
+         << setw(8) << chain.stageTime(i) * 1000.0 << " ms"
+         << setw(8) << setprecision(2)
+         << 1.0e9 * chain.stageTime(i) / chain.stageSamples(i)
+         << " ns/sample" << setprecision(1) << "\n";
+  }
+
+  for (size_t i=0; i<push_stages.size(); ++i)
+  {
+    delete push_stages[i];
+  }
+
+  return 0;
+}
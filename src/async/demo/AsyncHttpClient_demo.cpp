@@ -0,0 +1,52 @@
+// A demo of the non-blocking HTTP client.
+// Give one or more URLs on the command line. All of them are fetched at the
+// same time using the shared HTTP client.
+//
+//   ./AsyncHttpClient_demo https://www.svxlink.org/ http://localhost:8080
+//
+
+#include <iostream>
+#include <memory>
+#include <AsyncCppApplication.h>
+#include <AsyncHttpClient.h>
+
+int main(int argc, const char **argv)
+{
+  Async::CppApplication app;
+
+  if (argc < 2)
+  {
+    std::cerr << "Usage: AsyncHttpClient_demo <url> [<url>...]" << std::endl;
+    return 1;
+  }
+
+  std::shared_ptr<Async::HttpClient> http = Async::HttpClient::shared();
+  Async::HttpClient* client = http.get();
+  for (int i=1; i<argc; ++i)
+  {
+    std::string url(argv[i]);
+    http->get(url,
+        [url, client](const Async::HttpClient::Response& rsp)
+        {
+          if (rsp.ok())
+          {
+            std::cout << "--- " << url << ": " << rsp.status << " "
+                      << rsp.body.size() << " bytes" << std::endl;
+            std::cout << rsp.body.substr(0, 200) << std::endl;
+          }
+          else
+          {
+            std::cout << "*** ERROR: " << url << ": status=" << rsp.status
+                      << " error=\"" << rsp.error << "\"" << std::endl;
+          }
+          if (client->pending() == 0)
+          {
+            Async::Application::app().quit();
+          }
+        });
+  }
+
+  app.exec();
+
+  return 0;
+}
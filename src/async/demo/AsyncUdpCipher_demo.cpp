@@ -0,0 +1,105 @@
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <chrono>
+#include <cstdlib>
+
+#include <AsyncEncryptedUdpSocket.h>
+
+using namespace std;
+using namespace Async;
+
+  // Typical sizes for the reflector UDP protocol
+static const size_t AADLEN = 4;
+static const size_t TAGLEN = 8;
+static const size_t IVLEN = 12;
+
+  // One 20ms Opus frame with some message overhead
+static const size_t PAYLOAD_SIZE = 80;
+
+  // Encrypt datagrams for the given number of keys, round robin, like a
+  // server sending to many clients. Return the number of packets per second.
+static double benchmark(const EncryptedUdpSocket::Cipher* cipher,
+                        size_t keycnt, size_t packets, bool cached)
+{
+  vector<vector<uint8_t>> keys(keycnt);
+  for (auto& key : keys)
+  {
+    key.resize(EVP_CIPHER_key_length(cipher));
+    EncryptedUdpSocket::randomBytes(key);
+  }
+  vector<uint8_t> iv(IVLEN, 0);
+  uint8_t aad[AADLEN] = {0};
+  vector<uint8_t> plain(PAYLOAD_SIZE, 0x55);
+  vector<uint8_t> out(
+      EncryptedUdpSocket::cipherTextMaxSize(AADLEN, TAGLEN, plain.size()));
+
+  EVP_CIPHER_CTX* ctx = EVP_CIPHER_CTX_new();
+  EVP_EncryptInit_ex(ctx, cipher, NULL, NULL, NULL);
+  EncryptedUdpSocket::ContextCache cache(keycnt);
+  static const vector<uint8_t> cached_key;
+
+  int outlen = 0;
+  bool ok = true;
+  chrono::steady_clock::time_point start = chrono::steady_clock::now();
+  for (size_t i=0; i<packets; ++i)
+  {
+    const auto& key = keys[i % keycnt];
+    iv[IVLEN-1] = i & 0xff;
+    if (cached)
+    {
+      ok &= EncryptedUdpSocket::encrypt(cache.encryptContext(cipher, key),
+          cached_key, iv, TAGLEN, aad, AADLEN, plain.data(), plain.size(),
+          out.data(), outlen);
+    }
+    else
+    {
+      ok &= EncryptedUdpSocket::encrypt(ctx, key, iv, TAGLEN,
+          aad, AADLEN, plain.data(), plain.size(), out.data(), outlen);
+    }
+  }
+  chrono::duration<double> elapsed = chrono::steady_clock::now() - start;
+  EVP_CIPHER_CTX_free(ctx);
+  if (!ok)
+  {
+    cerr << "*** ERROR: Encryption failed" << endl;
+    exit(1);
+  }
+  return packets / elapsed.count();
+}
+
+
+int main(int argc, const char **argv)
+{
+  size_t packets = 1000000;
+  if (argc > 1)
+  {
+    packets = atoi(argv[1]);
+  }
+
+  cout << "AES instructions: "
+       << (EncryptedUdpSocket::hasAesHardware() ? "yes" : "no") << endl;
+  cout << "Encrypting " << packets << " datagrams of " << PAYLOAD_SIZE
+       << " bytes\n\n";
+  cout << fixed << setprecision(0);
+  cout << "Cipher               Keys   Set key pkt/s   Cached pkt/s\n";
+  for (const char* name : {"AES-128-GCM", "ChaCha20-Poly1305"})
+  {
+    const auto cipher = EncryptedUdpSocket::fetchCipher(name);
+    if (cipher == nullptr)
+    {
+      cout << setw(20) << left << name << " not supported" << endl;
+      continue;
+    }
+    for (size_t keycnt : {1, 100})
+    {
+      cout << setw(20) << left << name << right
+           << setw(6) << keycnt
+           << setw(16) << benchmark(cipher, keycnt, packets, false)
+           << setw(15) << benchmark(cipher, keycnt, packets, true)
+           << endl;
+    }
+  }
+
+  return 0;
+}
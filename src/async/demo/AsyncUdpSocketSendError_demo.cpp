@@ -0,0 +1,124 @@
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <cstring>
+#include <iostream>
+#include <AsyncCppApplication.h>
+#include <AsyncUdpSocket.h>
+#include <AsyncIpAddress.h>
+#include <AsyncTimer.h>
+
+using namespace std;
+using namespace Async;
+
+  // A UDP send buffer on localhost never fill up so, to force a datagram to
+  // be buffered, the socket is replaced by a TCP connection whose send
+  // buffer is full. The TCP connection is then shut down so that sending
+  // the buffered datagram fail with an error other than EAGAIN.
+class MyClass : public sigc::trackable
+{
+  public:
+    MyClass(void) : timeout_timer(5000)
+    {
+      sock = new UdpSocket;
+      sock->sendBufferFull.connect(
+          mem_fun(*this, &MyClass::onSendBufferFull));
+      timeout_timer.expired.connect(mem_fun(*this, &MyClass::onTimeout));
+
+      int tcp_fd = stalledTcpConnection();
+      if ((tcp_fd < 0) || (dup2(tcp_fd, sock->fd()) < 0))
+      {
+        cout << "*** ERROR: Could not set up the stalled TCP connection\n";
+        Application::app().quit();
+        return;
+      }
+      close(tcp_fd);
+
+      IpAddress addr("127.0.0.1");
+      char buf[1024];
+      memset(buf, 0, sizeof(buf));
+      bool success = sock->write(addr, 12345, buf, sizeof(buf));
+      cout << "Write: " << success << endl;
+      shutdown(sock->fd(), SHUT_WR);
+    }
+
+    ~MyClass(void)
+    {
+      delete sock;
+      if (peer_fd >= 0)
+      {
+        close(peer_fd);
+      }
+    }
+
+  private:
+    UdpSocket * sock;
+    Timer       timeout_timer;
+    int         peer_fd = -1;
+
+    int stalledTcpConnection(void)
+    {
+      int lsock = socket(AF_INET, SOCK_STREAM, 0);
+      struct sockaddr_in addr;
+      memset(&addr, 0, sizeof(addr));
+      addr.sin_family = AF_INET;
+      addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+      socklen_t len = sizeof(addr);
+      int bufsize = 4096;
+      setsockopt(lsock, SOL_SOCKET, SO_RCVBUF, &bufsize, sizeof(bufsize));
+      if ((bind(lsock, reinterpret_cast<struct sockaddr*>(&addr), len) < 0) ||
+          (listen(lsock, 1) < 0) ||
+          (getsockname(lsock, reinterpret_cast<struct sockaddr*>(&addr),
+                       &len) < 0))
+      {
+        close(lsock);
+        return -1;
+      }
+      int fd = socket(AF_INET, SOCK_STREAM, 0);
+      setsockopt(fd, SOL_SOCKET, SO_SNDBUF, &bufsize, sizeof(bufsize));
+      if (connect(fd, reinterpret_cast<struct sockaddr*>(&addr), len) < 0)
+      {
+        close(fd);
+        close(lsock);
+        return -1;
+      }
+      peer_fd = accept(lsock, 0, 0);
+      close(lsock);
+
+        // Fill the send buffer. The peer never read anything.
+      fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+      char buf[1024];
+      memset(buf, 0, sizeof(buf));
+      while (send(fd, buf, sizeof(buf), 0) > 0)
+      {
+      }
+      return fd;
+    }
+
+    void onSendBufferFull(bool is_full)
+    {
+      cout << "Send buffer full: " << is_full << endl;
+      if (!is_full)
+      {
+        Application::app().quit();
+      }
+    }
+
+    void onTimeout(Timer *t)
+    {
+      cout << "*** ERROR: The send buffer full condition was never cleared\n";
+      Application::app().quit();
+    }
+};
+
+int main(int argc, char **argv)
+{
+  CppApplication app;
+  signal(SIGPIPE, SIG_IGN);
+  MyClass my_class;
+  app.exec();
+}
@@ -39,6 +39,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 #include <sigc++/sigc++.h>
 
 #include <QSocketNotifier>
+#include <QAbstractEventDispatcher>
 #undef emit
 
 #include <cassert>
@@ -150,11 +151,42 @@ QtApplication::QtApplication(int &argc, char **argv)
 QtApplication::~QtApplication(void)
 {
   clearTasks();
+
+  FdWatchMap *watch_maps[] = { &rd_watch_map, &wr_watch_map, &pri_watch_map };
+  for (FdWatchMap *watch_map : watch_maps)
+  {
+    FdWatchMap::iterator it = watch_map->begin();
+    while (it != watch_map->end())
+    {
+      if (it->second.first == 0)
+      {
+        delete it->second.second;
+        it = watch_map->erase(it);
+      }
+      else
+      {
+        ++it;
+      }
+    }
+  }
+
+  for (AsyncQtTimer *t : timer_pool)
+  {
+    delete t;
+  }
+  timer_pool.clear();
 } /* QtApplication::~QtApplication */
 
 
 void QtApplication::exec(void)
 {
+  QAbstractEventDispatcher *dispatcher = QAbstractEventDispatcher::instance();
+  if (dispatcher != 0)
+  {
+    QObject::connect(dispatcher, SIGNAL(awake()), this, SLOT(loopAwake()));
+    QObject::connect(dispatcher, SIGNAL(aboutToBlock()),
+                     this, SLOT(loopAboutToBlock()));
+  }
   QApplication::exec();
 } /* QtApplication::exec */
 
@@ -212,50 +244,68 @@ void QtApplication::quit(void)
  */
 void QtApplication::addFdWatch(FdWatch *fd_watch)
 {
+    // The socket notifier of a removed watch is disabled and kept in the
+    // watch map so that it can be reused the next time a watch is added for
+    // the same file descriptor. Watches are enabled and disabled often, e.g.
+    // for each packet sent on a socket, so this save a lot of allocations.
+  FdWatchMap& watch_map = watchMap(fd_watch);
+  FdWatchMap::iterator iter = watch_map.find(fd_watch->fd());
+  if (iter != watch_map.end())
+  {
+    iter->second.first = fd_watch;
+    iter->second.second->setEnabled(true);
+    return;
+  }
+
   QSocketNotifier *notifier = 0;
-  
   switch (fd_watch->type())
   {
     case FdWatch::FD_WATCH_RD:
       notifier = new QSocketNotifier(fd_watch->fd(), QSocketNotifier::Read);
-      rd_watch_map[fd_watch->fd()] = FdWatchMapItem(fd_watch, notifier);
       QObject::connect(notifier, SIGNAL(activated(int)),
                        this, SLOT(rdFdActivity(int)));
       break;
       
     case FdWatch::FD_WATCH_WR:
       notifier = new QSocketNotifier(fd_watch->fd(), QSocketNotifier::Write);
-      wr_watch_map[fd_watch->fd()] = FdWatchMapItem(fd_watch, notifier);
       QObject::connect(notifier, SIGNAL(activated(int)),
                        this, SLOT(wrFdActivity(int)));
       break;
-  }  
+
+    case FdWatch::FD_WATCH_PRI:
+      notifier = new QSocketNotifier(fd_watch->fd(),
+                                     QSocketNotifier::Exception);
+      QObject::connect(notifier, SIGNAL(activated(int)),
+                       this, SLOT(priFdActivity(int)));
+      break;
+  }
+  watch_map[fd_watch->fd()] = FdWatchMapItem(fd_watch, notifier);
 } /* QtApplication::addFdWatch */
 
 
 void QtApplication::delFdWatch(FdWatch *fd_watch)
 {
-  FdWatchMap::iterator iter;
-  
+  FdWatchMap& watch_map = watchMap(fd_watch);
+  FdWatchMap::iterator iter = watch_map.find(fd_watch->fd());
+  assert((iter != watch_map.end()) && (iter->second.first == fd_watch));
+  iter->second.first = 0;
+  iter->second.second->setEnabled(false);
+} /* QtApplication::delFdWatch */
+
+
+QtApplication::FdWatchMap& QtApplication::watchMap(FdWatch *fd_watch)
+{
   switch (fd_watch->type())
   {
-    case FdWatch::FD_WATCH_RD:
-      iter = rd_watch_map.find(fd_watch->fd());
-      assert(iter != rd_watch_map.end());
-      delete iter->second.second;
-      rd_watch_map.erase(fd_watch->fd());
-      break;
-      
     case FdWatch::FD_WATCH_WR:
-      iter = wr_watch_map.find(fd_watch->fd());
-      assert(iter != wr_watch_map.end());
-      delete iter->second.second;
-      wr_watch_map.erase(fd_watch->fd());
-      break;
+      return wr_watch_map;
+    case FdWatch::FD_WATCH_PRI:
+      return pri_watch_map;
+    case FdWatch::FD_WATCH_RD:
+    default:
+      return rd_watch_map;
   }
-  
-
-} /* QtApplication::delFdWatch */
+} /* QtApplication::watchMap */
 
 
 void QtApplication::rdFdActivity(int socket)
@@ -263,7 +313,7 @@ void QtApplication::rdFdActivity(int socket)
   FdWatchMap::iterator iter;
   iter = rd_watch_map.find(socket);
   assert(iter != rd_watch_map.end());
-  iter->second.first->activity(iter->second.first);
+  fdActivity(iter->second.first);
 } /* QtApplication::rdFdActivity */
 
 
@@ -272,13 +322,66 @@ void QtApplication::wrFdActivity(int socket)
   FdWatchMap::iterator iter;
   iter = wr_watch_map.find(socket);
   assert(iter != wr_watch_map.end());
-  iter->second.first->activity(iter->second.first);
+  fdActivity(iter->second.first);
 } /* QtApplication::wrFdActivity */
 
 
+void QtApplication::priFdActivity(int socket)
+{
+  FdWatchMap::iterator iter;
+  iter = pri_watch_map.find(socket);
+  assert(iter != pri_watch_map.end());
+  fdActivity(iter->second.first);
+} /* QtApplication::priFdActivity */
+
+
+void QtApplication::fdActivity(FdWatch *watch)
+{
+  if (watch == 0)
+  {
+    return;
+  }
+
+  if (!callbackTimingEnabled())
+  {
+    watch->activity(watch);
+    return;
+  }
+
+    // The watch may be deleted by the activity handler
+  const uint64_t start_us = monotonicUs();
+  const int fd = watch->fd();
+  const CallbackType type = fdCallbackType(watch);
+  watch->activity(watch);
+  callbackDone(type, 0, fd, start_us);
+} /* QtApplication::fdActivity */
+
+
+void QtApplication::loopAwake(void)
+{
+  loopBusyBegin(monotonicUs());
+} /* QtApplication::loopAwake */
+
+
+void QtApplication::loopAboutToBlock(void)
+{
+  loopBusyEnd(monotonicUs());
+} /* QtApplication::loopAboutToBlock */
+
+
 void QtApplication::addTimer(Timer *timer)
 {
-  AsyncQtTimer *t = new AsyncQtTimer(timer);
+  AsyncQtTimer *t = 0;
+  if (!timer_pool.empty())
+  {
+    t = timer_pool.back();
+    timer_pool.pop_back();
+    t->start(timer);
+  }
+  else
+  {
+    t = new AsyncQtTimer(timer);
+  }
   timer_map[timer] = t;  
 } /* QtApplication::addTimer */
 
@@ -288,8 +391,17 @@ void QtApplication::delTimer(Timer *timer)
   TimerMap::iterator iter;
   iter = timer_map.find(timer);
   assert(iter != timer_map.end());
-  delete iter->second;
+  AsyncQtTimer *t = iter->second;
   timer_map.erase(iter);
+  if (timer_pool.size() < TIMER_POOL_SIZE)
+  {
+    t->stop();
+    timer_pool.push_back(t);
+  }
+  else
+  {
+    delete t;
+  }
 } /* QtApplication::delTimer */
 
 
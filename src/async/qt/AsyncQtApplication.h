@@ -51,6 +51,7 @@ An example of how to use the Async::QtApplication class
 #include <utility>
 #include <map>
 #include <set>
+#include <vector>
 
 
 /****************************************************************************
@@ -194,23 +195,33 @@ class QtApplication : public QApplication, public Application
   protected:
     
   private:
+    static const size_t TIMER_POOL_SIZE = 32;
+
     typedef std::pair<Async::FdWatch*, QSocketNotifier*>  FdWatchMapItem;
     typedef std::map<int, FdWatchMapItem> 	      	  FdWatchMap;
     typedef std::map<Timer *, AsyncQtTimer *>         	  TimerMap;
     
-    FdWatchMap  rd_watch_map;
-    FdWatchMap  wr_watch_map;
-    TimerMap  	timer_map;
+    FdWatchMap                  rd_watch_map;
+    FdWatchMap                  wr_watch_map;
+    FdWatchMap                  pri_watch_map;
+    TimerMap                    timer_map;
+    std::vector<AsyncQtTimer*>  timer_pool;
     
     void addFdWatch(FdWatch *fd_watch);
     void delFdWatch(FdWatch *fd_watch);
+    FdWatchMap& watchMap(FdWatch *fd_watch);
     void addTimer(Timer *timer);
     void delTimer(Timer *timer);
     DnsLookupWorker *newDnsLookupWorker(const DnsLookup& lookup);
 
+    void fdActivity(FdWatch *watch);
+
   private slots:
     void rdFdActivity(int socket);
     void wrFdActivity(int socket);
+    void priFdActivity(int socket);
+    void loopAwake(void);
+    void loopAboutToBlock(void);
     
 };  /* class QtApplication */
 
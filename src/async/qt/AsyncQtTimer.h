@@ -122,20 +122,41 @@ class AsyncQtTimer : public QObject
      * @brief 	Constructor
      * @param 	timer The async timer object to associate the Qt timer to
      */
-    AsyncQtTimer(Timer *timer) : timer(timer), qtimer(0)
+    AsyncQtTimer(Timer *timer) : timer(0), qtimer(0)
     {
       qtimer = new QTimer(this);
-      qtimer->setSingleShot(timer->type() == Timer::TYPE_ONESHOT);
-      qtimer->start(timer->timeout());
       QObject::connect(qtimer, SIGNAL(timeout()),
                        this, SLOT(timerExpired()));
-      
+      start(timer);
     }
     
     /**
      * @brief 	Destructor
      */
     virtual ~AsyncQtTimer(void) {}
+
+    /**
+     * @brief 	Start the Qt timer for the given async timer
+     * @param 	timer The async timer object to associate the Qt timer to
+     *
+     * This function is used to reuse a stopped AsyncQtTimer object for
+     * another async timer.
+     */
+    void start(Timer *timer)
+    {
+      this->timer = timer;
+      qtimer->setSingleShot(timer->type() == Timer::TYPE_ONESHOT);
+      qtimer->start(timer->timeout());
+    }
+
+    /**
+     * @brief 	Stop the Qt timer and release the async timer
+     */
+    void stop(void)
+    {
+      qtimer->stop();
+      timer = 0;
+    }
   
   protected:
     
@@ -146,7 +167,10 @@ class AsyncQtTimer : public QObject
   private slots:
     void timerExpired(void)
     {
-      timer->expired(timer);
+      if (timer != 0)
+      {
+        timer->expired(timer);
+      }
     }
     
 };  /* class AsyncQtTimer */
@@ -0,0 +1,91 @@
+#.rst:
+# FindCodec2
+# ----------
+# Find the codec2 library and include directory
+#
+#  Codec2_FOUND         - Set to true if the codec2 library is found
+#  Codec2_INCLUDE_DIRS  - The directory where codec2/codec2.h can be found
+#  Codec2_LIBRARIES     - Libraries to link with to use codec2
+#  Codec2_VERSION       - Full version string (if available)
+#  Codec2_VERSION_MAJOR - Major version (if available)
+#  Codec2_VERSION_MINOR - Minor version (if available)
+
+#=============================================================================
+# Copyright (C) 2003-2026 Tobias Blomberg / SM0SVX
+# 
+# This program is free software; you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation; either version 2 of the License, or
+# (at your option) any later version.
+# 
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+# 
+# You should have received a copy of the GNU General Public License
+# along with this program; if not, write to the Free Software
+# Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+#=============================================================================
+
+if(CMAKE_MINIMUM_REQUIRED_VERSION VERSION_LESS 2.6)
+  message(AUTHOR_WARNING
+    "Your project should require at least CMake 2.6 to use FindCodec2.cmake")
+endif()
+
+# use pkg-config to get the directories and then use these values
+# in the FIND_PATH() and FIND_LIBRARY() calls
+find_package(PkgConfig)
+if(CMAKE_VERSION VERSION_LESS 2.8.2)
+  pkg_check_modules(PC_Codec2 codec2)
+else()
+  pkg_check_modules(PC_Codec2 QUIET codec2)
+endif()
+
+# Try to find the directory where the codec2/codec2.h header file is located
+find_path(Codec2_INCLUDE_DIR
+  NAMES codec2/codec2.h
+  PATHS ${PC_Codec2_INCLUDE_DIRS}
+  DOC "Codec2 include directory"
+)
+
+# Try to find the codec2 library
+find_library(Codec2_LIBRARY
+  NAMES codec2
+  DOC "Codec2 library path"
+  PATHS ${PC_Codec2_LIBRARY_DIRS}
+)
+
+# Set up version variables
+if(PC_Codec2_VERSION)
+  set(Codec2_VERSION ${PC_Codec2_VERSION})
+  string(REGEX MATCHALL "[0-9]+" _Codec2_VERSION_PARTS "${PC_Codec2_VERSION}")
+  list(GET _Codec2_VERSION_PARTS 0 Codec2_VERSION_MAJOR)
+  list(GET _Codec2_VERSION_PARTS 1 Codec2_VERSION_MINOR)
+endif()
+
+# Handle the QUIETLY and REQUIRED arguments and set Codec2_FOUND to TRUE if 
+# all listed variables are TRUE
+include(FindPackageHandleStandardArgs)
+if(CMAKE_VERSION VERSION_LESS 2.8.12)
+  find_package_handle_standard_args(CODEC2
+    DEFAULT_MSG
+    Codec2_LIBRARY Codec2_INCLUDE_DIR
+  )
+else()
+  find_package_handle_standard_args(Codec2
+    FOUND_VAR CODEC2_FOUND
+    REQUIRED_VARS Codec2_LIBRARY Codec2_INCLUDE_DIR
+    VERSION_VAR Codec2_VERSION
+  )
+endif()
+
+if(CODEC2_FOUND)
+  set(Codec2_FOUND 1)
+  set(Codec2_LIBRARIES ${Codec2_LIBRARY})
+  set(Codec2_INCLUDE_DIRS ${Codec2_INCLUDE_DIR})
+  set(Codec2_DEFINITIONS ${PC_Codec2_CFLAGS_OTHER})
+endif()
+
+mark_as_advanced(Codec2_INCLUDE_DIR Codec2_LIBRARY)
+
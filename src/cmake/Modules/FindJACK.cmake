@@ -0,0 +1,66 @@
+#.rst:
+# FindJACK
+# --------
+# Find the JACK audio connection kit library and include directory
+#
+#  JACK_FOUND         - Set to true if the jack library is found
+#  JACK_INCLUDE_DIRS  - The directory where jack/jack.h can be found
+#  JACK_LIBRARIES     - Libraries to link with to use jack
+#  JACK_VERSION       - Full version string (if available)
+
+#=============================================================================
+# Copyright (C) 2003-2026 Tobias Blomberg / SM0SVX
+# 
+# This program is free software; you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation; either version 2 of the License, or
+# (at your option) any later version.
+# 
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+# 
+# You should have received a copy of the GNU General Public License
+# along with this program; if not, write to the Free Software
+# Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+#=============================================================================
+
+# use pkg-config to get the directories and then use these values
+# in the FIND_PATH() and FIND_LIBRARY() calls
+find_package(PkgConfig)
+pkg_check_modules(PC_JACK QUIET jack)
+
+# Try to find the directory where the jack/jack.h header file is located
+find_path(JACK_INCLUDE_DIR
+  NAMES jack/jack.h
+  PATHS ${PC_JACK_INCLUDE_DIRS}
+  DOC "JACK include directory"
+)
+
+# Try to find the jack library
+find_library(JACK_LIBRARY
+  NAMES jack
+  DOC "JACK library path"
+  PATHS ${PC_JACK_LIBRARY_DIRS}
+)
+
+if(PC_JACK_VERSION)
+  set(JACK_VERSION ${PC_JACK_VERSION})
+endif()
+
+# Handle the QUIETLY and REQUIRED arguments and set JACK_FOUND to TRUE if
+# all listed variables are TRUE
+include(FindPackageHandleStandardArgs)
+find_package_handle_standard_args(JACK
+  FOUND_VAR JACK_FOUND
+  REQUIRED_VARS JACK_LIBRARY JACK_INCLUDE_DIR
+  VERSION_VAR JACK_VERSION
+)
+
+if(JACK_FOUND)
+  set(JACK_LIBRARIES ${JACK_LIBRARY})
+  set(JACK_INCLUDE_DIRS ${JACK_INCLUDE_DIR})
+endif()
+
+mark_as_advanced(JACK_INCLUDE_DIR JACK_LIBRARY)
@@ -47,6 +47,12 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 #include <cctype>
 #include <cassert>
 #include <cstring>
+#include <iterator>
+#include <fstream>
+#include <sstream>
+#include <ctime>
+#include <sys/stat.h>
+#include <unistd.h>
 
 
 /****************************************************************************
@@ -85,6 +91,8 @@ using namespace EchoLink;
  *
  ****************************************************************************/
 
+  /* The first line of a station cache file */
+static const char *STATION_CACHE_MAGIC = "EchoLink station cache v1";
 
 
 /****************************************************************************
@@ -141,7 +149,7 @@ Directory::Directory(const vector<string>& servers, const string& callsign,
   : com_state(CS_IDLE),       	      	      the_servers(servers),
     the_password(password),   	      	      the_description(""),
     error_str(""),    	      	      	      get_call_cnt(0),
-    ctrl_con(0),
+    get_call_pos(0),                          ctrl_con(0),
     the_status(StationData::STAT_OFFLINE),    reg_refresh_timer(0),
     current_status(StationData::STAT_OFFLINE),server_changed(false),
     cmd_timer(0), bind_ip(bind_ip)
@@ -207,10 +215,7 @@ void Directory::getCalls(void)
   }
   else
   {
-    the_links.clear();
-    the_repeaters.clear();
-    the_conferences.clear();
-    the_stations.clear();
+    clearStationLists();
     error("Trying to update the directory list while not registered with the "
       	  "directory server");
     //stationListUpdated();
@@ -251,141 +256,148 @@ void Directory::setDescription(const string& description)
 
 const StationData *Directory::findCall(const string& call)
 {
-  list<StationData> calls;
-  list<StationData>::const_iterator iter;
-  
-  for (iter=the_links.begin(); iter!=the_links.end(); ++iter)
-  {
-    if (iter->callsign() == call)
-    {
-      return &(*iter);
-    }
-  }
-  
-  for (iter=the_repeaters.begin(); iter!=the_repeaters.end(); ++iter)
-  {
-    if (iter->callsign() == call)
-    {
-      return &(*iter);
-    }
-  }
-  
-  for (iter=the_conferences.begin(); iter!=the_conferences.end(); ++iter)
-  {
-    if (iter->callsign() == call)
-    {
-      return &(*iter);
-    }
-  }
-  
-  for (iter=the_stations.begin(); iter!=the_stations.end(); ++iter)
-  {
-    if (iter->callsign() == call)
-    {
-      return &(*iter);
-    }
-  }
-  
-  return 0;
-  
+  CallIndex::const_iterator it = call_index.find(call);
+  return (it != call_index.end()) ? it->second : 0;
 } /* Directory::findCall */
 
 
 const StationData *Directory::findStation(int id)
 {
-  list<StationData> calls;
-  list<StationData>::const_iterator iter;
-  
-  for (iter=the_links.begin(); iter!=the_links.end(); ++iter)
+  IdIndex::const_iterator it = id_index.find(id);
+  return (it != id_index.end()) ? it->second : 0;
+} /* Directory::findStation */
+
+
+void Directory::findStationsByCode(vector<StationData> &stns,
+		const string& code, bool exact)
+{
+  stns.clear();
+
+    // The code index is sorted on code so all matching stations are found in
+    // one range, starting at the first entry not less than the code.
+  CodeIndexEntry key = { code, 0, 0 };
+  CodeIndex::const_iterator it =
+    lower_bound(code_index.begin(), code_index.end(), key);
+  vector<const CodeIndexEntry*> found;
+  for (; it != code_index.end(); ++it)
   {
-    if (iter->id() == id)
+    bool match = exact ? (it->code == code)
+                       : (it->code.compare(0, code.size(), code) == 0);
+    if (!match)
     {
-      return &(*iter);
+      break;
     }
+    found.push_back(&(*it));
   }
-  
-  for (iter=the_repeaters.begin(); iter!=the_repeaters.end(); ++iter)
+
+    // Return the stations in the same order as they appear in the lists
+  sort(found.begin(), found.end(),
+      [](const CodeIndexEntry* lhs, const CodeIndexEntry* rhs)
+      {
+        return lhs->seq < rhs->seq;
+      });
+  stns.reserve(found.size());
+  for (const auto& entry : found)
   {
-    if (iter->id() == id)
-    {
-      return &(*iter);
-    }
+    stns.push_back(*entry->stn);
   }
-  
-  for (iter=the_conferences.begin(); iter!=the_conferences.end(); ++iter)
+} /* Directory::findStationsByCode  */
+
+
+bool Directory::saveStationCache(const std::string& filename) const
+{
+  const std::string tmp_filename(filename + ".tmp");
+  std::ofstream os(tmp_filename);
+  if (!os.is_open())
   {
-    if (iter->id() == id)
-    {
-      return &(*iter);
-    }
+    return false;
   }
-  
-  for (iter=the_stations.begin(); iter!=the_stations.end(); ++iter)
+  os << STATION_CACHE_MAGIC << "\n";
+  for (const StationList* stn_list :
+         { &the_links, &the_repeaters, &the_conferences, &the_stations })
   {
-    if (iter->id() == id)
+    for (const auto& stn : *stn_list)
     {
-      return &(*iter);
+      os << stn.callsign() << '\t' << stn.status() << '\t' << stn.time()
+         << '\t' << stn.id() << '\t' << stn.ipStr() << '\t'
+         << stn.description() << "\n";
     }
   }
-  
-  return 0;
-  
-} /* Directory::findStation */
+  os.close();
+  if (os.fail() || (rename(tmp_filename.c_str(), filename.c_str()) != 0))
+  {
+    unlink(tmp_filename.c_str());
+    return false;
+  }
+  return true;
+} /* Directory::saveStationCache */
 
 
-bool Directory::stationCodeEq(const StationData& stn, string code, bool exact)
+bool Directory::loadStationCache(const std::string& filename,
+                                 unsigned max_age)
 {
-  if (exact)
+  if ((com_state != CS_IDLE) || !the_links.empty() ||
+      !the_repeaters.empty() || !the_conferences.empty() ||
+      !the_stations.empty())
   {
-    return (stn.code() == code);
+    return false;
   }
-  else
+
+  struct stat st;
+  if ((stat(filename.c_str(), &st) != 0) ||
+      (time(NULL) - st.st_mtime > static_cast<time_t>(max_age)))
   {
-    return (stn.code().find(code) == 0);
+    return false;
   }
-} /* Directory::stationCodeEq  */
 
+  std::ifstream is(filename);
+  std::string line;
+  if (!std::getline(is, line) || (line != STATION_CACHE_MAGIC))
+  {
+    return false;
+  }
 
-void Directory::findStationsByCode(vector<StationData> &stns,
-		const string& code, bool exact)
-{
-  list<StationData>::const_iterator iter;
-  
-  stns.clear();
-
-  for (iter=the_links.begin(); iter!=the_links.end(); ++iter)
+  get_call_pos = 0;
+  while (std::getline(is, line))
   {
-    if (stationCodeEq(*iter, code, exact))
+    std::istringstream ss(line);
+    std::string callsign, status, tm, id, ip, desc;
+    if (!std::getline(ss, callsign, '\t') || !std::getline(ss, status, '\t') ||
+        !std::getline(ss, tm, '\t') || !std::getline(ss, id, '\t') ||
+        !std::getline(ss, ip, '\t'))
     {
-      stns.push_back(*iter);
+      get_call_pos = 0;
+      return false;
     }
-  }
-  
-  for (iter=the_repeaters.begin(); iter!=the_repeaters.end(); ++iter)
-  {
-    if (stationCodeEq(*iter, code, exact))
+    std::getline(ss, desc);
+
+    StationData stn;
+    stn.setCallsign(callsign);
+    int status_val = atoi(status.c_str());
+    if ((status_val >= StationData::STAT_UNKNOWN) &&
+        (status_val <= StationData::STAT_BUSY))
     {
-      stns.push_back(*iter);
+      stn.setStatus(static_cast<StationData::Status>(status_val));
     }
-  }
-  
-  for (iter=the_conferences.begin(); iter!=the_conferences.end(); ++iter)
-  {
-    if (stationCodeEq(*iter, code, exact))
+    stn.setTime(tm);
+    stn.setId(atoi(id.c_str()));
+    stn.setIp(IpAddress(ip));
+    stn.setDescription(desc);
+    if (get_call_pos < get_call_list.size())
     {
-      stns.push_back(*iter);
+      get_call_list[get_call_pos] = std::move(stn);
     }
-  }
-  
-  for (iter=the_stations.begin(); iter!=the_stations.end(); ++iter)
-  {
-    if (stationCodeEq(*iter, code, exact))
+    else
     {
-      stns.push_back(*iter);
+      get_call_list.push_back(std::move(stn));
     }
+    ++get_call_pos;
   }
 
-} /* Directory::findStationsByCode  */
+  updateStationLists();
+  stationListUpdated();
+  return true;
+} /* Directory::loadStationCache */
 
 
 ostream& EchoLink::operator<<(ostream& os, const StationData& station)
@@ -494,10 +506,11 @@ int Directory::handleCallList(char *buf, int len)
 	read_len = nl-buf+1;
 	buf[read_len-1] = 0;
 	get_call_cnt = atoi(buf);
+	get_call_pos = 0;
 	//printf("Number of calls to get: %d\n", get_call_cnt);
 	if (get_call_cnt > 0)
 	{
-	  get_call_list.clear();
+	  get_call_list.reserve(get_call_cnt);
 	  the_message = "";
 	  com_state = CS_WAITING_FOR_CALL;
 	}
@@ -583,9 +596,16 @@ int Directory::handleCallList(char *buf, int len)
 	{
 	  the_message += get_call_entry.description() + "\n";
 	}
+	else if (get_call_pos < get_call_list.size())
+	{
+	    // Reuse an entry from the previous list. The assignment reuse the
+	    // already allocated strings when possible.
+	  get_call_list[get_call_pos++] = get_call_entry;
+	}
 	else
 	{
       	  get_call_list.push_back(get_call_entry);
+	  ++get_call_pos;
 	}
 
 	if (--get_call_cnt <= 0)
@@ -607,32 +627,7 @@ int Directory::handleCallList(char *buf, int len)
 	if (memcmp(buf, "+++", 3) == 0)
 	{
 	  //printf("End received!\n");
-	  the_links.clear();
-	  the_repeaters.clear();
-	  the_conferences.clear();
-	  the_stations.clear();
-	  list<StationData>::const_iterator it;
-	  for (it = get_call_list.begin(); it != get_call_list.end(); ++it)
-	  {
-	    const string &callsign = it->callsign();
-	    if (callsign.rfind("-L") == callsign.size()-2)
-	    {
-	      the_links.push_back(*it);
-	    }
-	    else if (callsign.rfind("-R") == callsign.size()-2)
-	    {
-	      the_repeaters.push_back(*it);
-	    }
-	    else if (callsign.find("*") == 0)
-	    {
-	      the_conferences.push_back(*it);
-	    }
-	    else
-	    {
-	      the_stations.push_back(*it);
-	    }
-	  }
-	  get_call_list.clear();
+	  updateStationLists();
 	  com_state = CS_IDLE;
 	  read_len = 3;
 
@@ -1008,6 +1003,101 @@ void Directory::onCmdTimeout(Timer *timer)
 } /* Directory::onCmdTimeout */
 
 
+/*
+ * @brief Move the received stations into the station lists
+ *
+ * The stations are moved, not copied, into the lists. The entries of the
+ * old lists are kept in get_call_list so that their memory can be reused
+ * when the next station list is received.
+ */
+void Directory::updateStationLists(void)
+{
+  StationList recycled;
+  recycled.reserve(the_links.size() + the_repeaters.size() +
+                   the_conferences.size() + the_stations.size() +
+                   get_call_list.size() - get_call_pos);
+  for (StationList* stn_list :
+         { &the_links, &the_repeaters, &the_conferences, &the_stations })
+  {
+    std::move(stn_list->begin(), stn_list->end(), back_inserter(recycled));
+  }
+  clearStationLists();
+
+  for (size_t i=0; i<get_call_pos; ++i)
+  {
+    StationData &stn = get_call_list[i];
+    const string &callsign = stn.callsign();
+    if (callsign.rfind("-L") == callsign.size()-2)
+    {
+      the_links.push_back(std::move(stn));
+    }
+    else if (callsign.rfind("-R") == callsign.size()-2)
+    {
+      the_repeaters.push_back(std::move(stn));
+    }
+    else if (callsign.find("*") == 0)
+    {
+      the_conferences.push_back(std::move(stn));
+    }
+    else
+    {
+      the_stations.push_back(std::move(stn));
+    }
+  }
+  std::move(get_call_list.begin() + get_call_pos, get_call_list.end(),
+            back_inserter(recycled));
+  get_call_list.swap(recycled);
+  get_call_pos = 0;
+
+  buildIndex();
+} /* Directory::updateStationLists */
+
+
+void Directory::clearStationLists(void)
+{
+  call_index.clear();
+  id_index.clear();
+  code_index.clear();
+  the_links.clear();
+  the_repeaters.clear();
+  the_conferences.clear();
+  the_stations.clear();
+} /* Directory::clearStationLists */
+
+
+/*
+ * @brief Build the lookup indexes for the station lists
+ *
+ * The indexes point into the station lists so they must be rebuilt each time
+ * the lists have been changed. The lists are searched in the same order as
+ * before so the first of any duplicate callsigns or ids is found.
+ */
+void Directory::buildIndex(void)
+{
+  size_t cnt = the_links.size() + the_repeaters.size() +
+               the_conferences.size() + the_stations.size();
+  call_index.clear();
+  call_index.reserve(cnt);
+  id_index.clear();
+  id_index.reserve(cnt);
+  code_index.clear();
+  code_index.reserve(cnt);
+
+  unsigned seq = 0;
+  for (const StationList* stn_list :
+         { &the_links, &the_repeaters, &the_conferences, &the_stations })
+  {
+    for (const auto& stn : *stn_list)
+    {
+      call_index.emplace(stn.callsign(), &stn);
+      id_index.emplace(stn.id(), &stn);
+      code_index.push_back({stn.code(), seq++, &stn});
+    }
+  }
+  sort(code_index.begin(), code_index.end());
+} /* Directory::buildIndex */
+
+
 
 /*
  * This file has not been truncated
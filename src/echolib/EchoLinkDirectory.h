@@ -48,6 +48,7 @@ An example of how to use the EchoLink::Directory class
 #include <string>
 #include <list>
 #include <vector>
+#include <unordered_map>
 #include <iostream>
 
 
@@ -131,6 +132,11 @@ class Directory : public sigc::trackable
 {
   public:
     static const unsigned MAX_DESCRIPTION_SIZE = 27;
+
+    /**
+     * @brief A list of stations, stored contiguously
+     */
+    typedef std::vector<StationData> StationList;
     
     /**
      * @brief 	Constructor
@@ -189,7 +195,7 @@ class Directory : public sigc::trackable
      *	      	representation
      * @return	Returns a string representing the current status
      */
-    std::string statusStr(void) const
+    const std::string& statusStr(void) const
     { 
       return StationData::statusStr(current_status);
     }
@@ -268,7 +274,7 @@ class Directory : public sigc::trackable
      * where the callsign end with "-L". For this function to return anything,
      * a previous call to Directory::getCalls must have been made.
      */
-    const std::list<StationData>& links(void) const { return the_links; }
+    const StationList& links(void) const { return the_links; }
     
     /**
      * @brief 	Get a list of all active repeasters
@@ -278,7 +284,7 @@ class Directory : public sigc::trackable
      * stations where the callsign end with "-R". For this function to return
      * anything, a previous call to Directory::getCalls must have been made.
      */
-    const std::list<StationData>& repeaters(void) const
+    const StationList& repeaters(void) const
     {
       return the_repeaters;
     }
@@ -292,7 +298,7 @@ class Directory : public sigc::trackable
      * to return anything, a previous call to Directory::getCalls must have been
      * made.
      */
-    const std::list<StationData>& conferences(void) const
+    const StationList& conferences(void) const
     {
       return the_conferences;
     }
@@ -301,7 +307,7 @@ class Directory : public sigc::trackable
      * @brief 	Get a list of all active "normal" stations
      * @return	Returns a reference to a list of StationData objects
      */
-    const std::list<StationData>& stations(void) const { return the_stations; }
+    const StationList& stations(void) const { return the_stations; }
     
     /**
      * @brief 	Get the message returned by the directory server
@@ -341,6 +347,30 @@ class Directory : public sigc::trackable
      */
     void findStationsByCode(std::vector<StationData> &stns,
 		    const std::string& code, bool exact=true);
+
+    /**
+     * @brief   Save the station list to a cache file
+     * @param   filename The name of the cache file
+     * @return  Returns \em true on success or else \em false
+     *
+     * The station list is written to a temporary file which is then renamed
+     * to the given filename, so a reader never see a half written file.
+     */
+    bool saveStationCache(const std::string& filename) const;
+
+    /**
+     * @brief   Load the station list from a cache file
+     * @param   filename The name of the cache file
+     * @param   max_age The maximum age of the cache file in seconds
+     * @return  Returns \em true if the station list was loaded
+     *
+     * Use this function directly after creating the directory object to have
+     * a station list available before the first list has been received from
+     * the directory server. The cache file is ignored if it is older than
+     * max_age seconds or if a station list has already been received. The
+     * stationListUpdated signal is emitted when the list has been loaded.
+     */
+    bool loadStationCache(const std::string& filename, unsigned max_age);
     
     /**
      * @brief A signal that is emitted when the registration status changes
@@ -378,16 +408,34 @@ class Directory : public sigc::trackable
     std::string       	      the_callsign;
     std::string       	      the_password;
     std::string       	      the_description;
-    std::list<StationData>    the_links;
-    std::list<StationData>    the_repeaters;
-    std::list<StationData>    the_stations;
-    std::list<StationData>    the_conferences;
+    typedef std::unordered_map<std::string, const StationData*> CallIndex;
+    typedef std::unordered_map<int, const StationData*> IdIndex;
+    struct CodeIndexEntry
+    {
+      std::string         code;
+      unsigned            seq;
+      const StationData*  stn;
+      bool operator<(const CodeIndexEntry& rhs) const
+      {
+        return (code < rhs.code) || ((code == rhs.code) && (seq < rhs.seq));
+      }
+    };
+    typedef std::vector<CodeIndexEntry> CodeIndex;
+
+    StationList               the_links;
+    StationList               the_repeaters;
+    StationList               the_stations;
+    StationList               the_conferences;
+    CallIndex                 call_index;
+    IdIndex                   id_index;
+    CodeIndex                 code_index;
     std::string       	      the_message;
     std::string       	      error_str;
     
     int       	      	      get_call_cnt;
     StationData       	      get_call_entry;
-    std::list<StationData>    get_call_list;
+    StationList               get_call_list;
+    size_t                    get_call_pos;
     
     DirectoryCon *            ctrl_con;
     std::list<Cmd>    	      cmd_queue;
@@ -414,7 +462,9 @@ class Directory : public sigc::trackable
     void createClientObject(void);
     void onRefreshRegistration(Async::Timer *timer);
     void onCmdTimeout(Async::Timer *timer);
-    bool stationCodeEq(const StationData& stn, std::string code, bool exact);
+    void updateStationLists(void);
+    void clearStationLists(void);
+    void buildIndex(void);
 
 };  /* class Directory */
 
@@ -47,8 +47,8 @@ class MyClass : public sigc::trackable
     
     void onStationListUpdated(void)
     {
-      const list<StationData>& stations = dir->stations();
-      list<StationData>::const_iterator it;
+      const Directory::StationList& stations = dir->stations();
+      Directory::StationList::const_iterator it;
       for (it = stations.begin(); it != stations.end(); ++it)
       {
 	cerr << *it << endl;
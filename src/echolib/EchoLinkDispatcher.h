@@ -46,7 +46,7 @@ An example of how to use the EchoLink::Dispatcher class
 
 #include <sigc++/sigc++.h>
 
-#include <map>
+#include <unordered_map>
 
 
 /****************************************************************************
@@ -223,7 +223,7 @@ class Dispatcher : public sigc::trackable
       CtrlInputHandler	cih;
       AudioInputHandler aih;
     } ConData;
-    typedef std::map<Async::IpAddress, ConData> ConMap;
+    typedef std::unordered_map<Async::IpAddress, ConData> ConMap;
     
     static const int  	DEFAULT_PORT_BASE = 5198;
     
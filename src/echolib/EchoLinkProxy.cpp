@@ -6,7 +6,7 @@
 
 \verbatim
 EchoLib - A library for EchoLink communication
-Copyright (C) 2003-2013 Tobias Blomberg / SM0SVX
+Copyright (C) 2003-2026 Tobias Blomberg / SM0SVX
 
 This program is free software; you can redistribute it and/or modify
 it under the terms of the GNU General Public License as published by
@@ -32,6 +32,8 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
  *
  ****************************************************************************/
 
+#include <sys/uio.h>
+
 #include <cerrno>
 #include <cstdio>
 #include <cstring>
@@ -145,6 +147,7 @@ Proxy::Proxy(const string &host, uint16_t port, const string &callsign,
     transform(this->password.begin(), this->password.end(),
               this->password.begin(), ::toupper);
   }
+  con.setNoDelay(true);
   con.connected.connect(mem_fun(*this, &Proxy::onConnected));
   con.dataReceived.connect(mem_fun(*this, &Proxy::onDataReceived));
   con.disconnected.connect(mem_fun(*this, &Proxy::onDisconnected));
@@ -228,13 +231,13 @@ bool Proxy::tcpData(const void *data, unsigned len)
 
 bool Proxy::udpData(const IpAddress &addr, const void *data, unsigned len)
 {
-  return sendMsgBlock(MSG_TYPE_UDP_DATA, addr, data, len);
+  return sendMsgBlock(MSG_TYPE_UDP_DATA, addr, data, len, true);
 } /* Proxy::udpData */
 
 
 bool Proxy::udpCtrl(const IpAddress &addr, const void *data, unsigned len)
 {
-  return sendMsgBlock(MSG_TYPE_UDP_CONTROL, addr, data, len);
+  return sendMsgBlock(MSG_TYPE_UDP_CONTROL, addr, data, len, true);
 } /* Proxy::udpCtrl */
 
 
@@ -254,7 +257,7 @@ bool Proxy::udpCtrl(const IpAddress &addr, const void *data, unsigned len)
  ****************************************************************************/
 
 bool Proxy::sendMsgBlock(MsgBlockType type, const IpAddress &remote_ip,
-                         const void *data, unsigned len)
+                         const void *data, unsigned len, bool prio)
 {
   //cout << "> type=" << type << " remote_ip=" << remote_ip
   //     << " len=" << len << endl;
@@ -265,8 +268,8 @@ bool Proxy::sendMsgBlock(MsgBlockType type, const IpAddress &remote_ip,
   }
 
   int msg_len = MSG_HEADER_SIZE + len;
-  uint8_t msg_buf[msg_len];
-  uint8_t *msg_ptr = msg_buf;
+  uint8_t msg_header[MSG_HEADER_SIZE];
+  uint8_t *msg_ptr = msg_header;
 
     // Store the message type
   *msg_ptr++ = static_cast<uint8_t>(type);
@@ -288,11 +291,14 @@ bool Proxy::sendMsgBlock(MsgBlockType type, const IpAddress &remote_ip,
   *msg_ptr++ = (len >> 16) & 0xff;
   *msg_ptr++ = (len >> 24) & 0xff;
 
-    // Store the message data
-  memcpy(msg_ptr, data, len);
-
-    // Send the message
-  int ret = con.write(msg_buf, msg_len);
+    // Send the header and the message data without copying them together.
+    // UDP data is prioritized so that audio is not delayed by TCP data.
+  struct iovec iov[2];
+  iov[0].iov_base = msg_header;
+  iov[0].iov_len = MSG_HEADER_SIZE;
+  iov[1].iov_base = const_cast<void*>(data);
+  iov[1].iov_len = len;
+  int ret = con.writev(iov, (len > 0) ? 2 : 1, prio);
   if (ret == -1)
   {
     char errstr[256];
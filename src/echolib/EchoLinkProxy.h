@@ -6,7 +6,7 @@
 
 \verbatim
 EchoLib - A library for EchoLink communication
-Copyright (C) 2003-2013 Tobias Blomberg / SM0SVX
+Copyright (C) 2003-2026 Tobias Blomberg / SM0SVX
 
 This program is free software; you can redistribute it and/or modify
 it under the terms of the GNU General Public License as published by
@@ -355,7 +355,7 @@ class Proxy : public sigc::trackable
     Proxy& operator=(const Proxy&);
     bool sendMsgBlock(MsgBlockType type,
                       const Async::IpAddress &remote_ip=Async::IpAddress(),
-                      const void *data=0, unsigned len=0);
+                      const void *data=0, unsigned len=0, bool prio=false);
     void onConnected(void);
     int onDataReceived(Async::TcpConnection *con, void *data, int len);
     void onDisconnected(Async::TcpConnection *con,
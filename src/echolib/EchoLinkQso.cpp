@@ -102,7 +102,8 @@ struct Qso::Private
 #endif
   } Codec;
 
-  Codec     remote_codec;
+  Codec       remote_codec;
+  std::string remote_priv;
 #ifdef SPEEX_MAJOR
   SpeexBits enc_bits;
   SpeexBits dec_bits;
@@ -346,49 +347,66 @@ bool Qso::sendInfoData(const string& info)
     return false;
   }
   
-  string info_msg("oNDATA\r");
-  if (info.empty())
-  {
-    info_msg += local_stn_info;
-  }
-  else
-  {
-    info_msg += info;
-  }
-  replace(info_msg.begin(), info_msg.end(), '\n', '\r');
+  return sendDataPacket(infoPacket(info.empty() ? local_stn_info : info));
+} /* Qso::sendInfoData */
 
-  bool success = Dispatcher::instance()->sendAudioMsg(
-      remote_ip, info_msg.c_str(), info_msg.length()+1);
-  if (!success)
+
+bool Qso::sendChatData(const string& msg)
+{
+  if (state != STATE_CONNECTED)
   {
-    perror("sendAudioMsg in Qso::sendInfoData");
     return false;
   }
   
-  return true;
-  
-} /* Qso::sendInfoData */
+  return sendDataPacket(chatPacket(callsign, msg));
+} /* Qso::sendChatData */
 
 
-bool Qso::sendChatData(const string& msg)
+string Qso::infoPacket(const string& info)
+{
+  static const string prefix("oNDATA\r");
+  string packet;
+  packet.reserve(prefix.size() + info.size());
+  packet += prefix;
+  packet += info;
+  replace(packet.begin(), packet.end(), '\n', '\r');
+  return packet;
+} /* Qso::infoPacket */
+
+
+string Qso::chatPacket(const string& callsign, const string& msg)
+{
+  static const string prefix("oNDATA");
+  string packet;
+  packet.reserve(prefix.size() + callsign.size() + msg.size() + 3);
+  packet += prefix;
+  packet += callsign;
+  packet += '>';
+  packet += msg;
+  packet += "\r\n";
+  return packet;
+} /* Qso::chatPacket */
+
+
+bool Qso::sendDataPacket(const string& packet)
 {
   if (state != STATE_CONNECTED)
   {
     return false;
   }
   
-  string buf("oNDATA" + callsign + '>' + msg + "\r\n");
-  bool success = Dispatcher::instance()->sendAudioMsg(remote_ip, buf.c_str(),
-      buf.length()+1);
+    // The terminating NUL character is sent too
+  bool success = Dispatcher::instance()->sendAudioMsg(
+      remote_ip, packet.c_str(), packet.length()+1);
   if (!success)
   {
-    perror("sendAudioMsg in Qso::sendChatData");
+    perror("sendAudioMsg in Qso::sendDataPacket");
     return false;
   }
   
   return true;
   
-} /* Qso::sendChatData */
+} /* Qso::sendDataPacket */
 
 
 bool Qso::sendAudioRaw(RawPacket *raw_packet)
@@ -625,41 +643,33 @@ inline void Qso::handleByePacket(unsigned char *buf, int len)
 
 inline void Qso::handleSdesPacket(unsigned char *buf, int len)
 {
-  char remote_id[256];
-  if(parseSDES(remote_id, buf, RTCP_SDES_NAME))
+    // The SDES items are parsed in place and assigned to the already
+    // existing strings so that keep-alive packets do not allocate memory
+  const unsigned char *item;
+  int item_len = findSDESItem(buf, len, RTCP_SDES_NAME, &item);
+  if (item_len > 0)
   {
-    //printData(reinterpret_cast<unsigned char*>(remote_id), strlen(remote_id));
-#if 0
-    char strtok_buf[256];
-    char *strtok_buf_ptr = strtok_buf;
-    char *remote_call_str = strtok_r(remote_id, " \t\n\r", &strtok_buf_ptr);
-    const char *remote_name_str = strtok_r(NULL, " \t\n\r", &strtok_buf_ptr);
-    if ((remote_call_str != 0) && (remote_call_str[0] != 0))
-    {
-      if (remote_name_str == 0)
-      {
-	remote_name_str = "?";
-      }
-      remote_call = remote_call_str;
-      remote_name = remote_name_str;
-    }
-#endif
-    string str(remote_id);
-    size_t pos = str.find_first_of(" \t\n\r");
-    if (pos != string::npos)
+    const char *id_begin = reinterpret_cast<const char *>(item);
+    const char *id_end = find(id_begin, id_begin + item_len, '\0');
+    const char *ws = " \t\n\r";
+    const char *call_end = find_first_of(id_begin, id_end, ws, ws + 4);
+    if (call_end != id_end)
     {
-      remote_call = str.substr(0, pos);
-      pos = str.find_first_not_of(" \t\n\r", pos);
-      if (pos != string::npos)
+      remote_call.assign(id_begin, call_end);
+      const char *name_begin = find_if(call_end, id_end,
+          [ws](char ch) { return strchr(ws, ch) == 0; });
+      if (name_begin != id_end)
       {
-        remote_name = str.substr(pos);
+        remote_name.assign(name_begin, id_end);
       }
     }
   }
-  char priv[256];
-  if(parseSDES(priv, buf, RTCP_SDES_PRIV))
+  item_len = findSDESItem(buf, len, RTCP_SDES_PRIV, &item);
+  if (item_len >= 0)
   {
-    setRemoteParams(priv);
+    const char *priv = reinterpret_cast<const char *>(item);
+    p->remote_priv.assign(priv, find(priv, priv + item_len, '\0'));
+    setRemoteParams(p->remote_priv);
   }
       
   switch (state)
@@ -707,7 +717,7 @@ inline void Qso::handleNonAudioPacket(unsigned char *buf, int len)
 {
   //printData(buf, len);
 
-  if(memcmp(buf+1, "NDATA", 5) == 0)
+  if ((len > 6) && (memcmp(buf+1, "NDATA", 5) == 0))
   {
     if (buf[6] == 0x0d) // Remote station info / conference status
     {
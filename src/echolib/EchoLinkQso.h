@@ -293,6 +293,32 @@ class Qso
      * @return	Returns \em true on success or \em false on failure
      */
     bool sendChatData(const std::string& msg);
+
+    /**
+     * @brief 	Build an info data packet
+     * @param 	info The info to put in the packet
+     * @return	Returns the packet, ready to be sent using sendDataPacket
+     *
+     * Use this function together with sendDataPacket to build a packet once
+     * and then send it to many stations.
+     */
+    static std::string infoPacket(const std::string& info);
+
+    /**
+     * @brief 	Build a chat data packet
+     * @param 	callsign The callsign of the sender
+     * @param 	msg The message to put in the packet
+     * @return	Returns the packet, ready to be sent using sendDataPacket
+     */
+    static std::string chatPacket(const std::string& callsign,
+                                  const std::string& msg);
+
+    /**
+     * @brief 	Send a prebuilt info or chat data packet
+     * @param 	packet The packet to send
+     * @return	Returns \em true on success or \em false on failure
+     */
+    bool sendDataPacket(const std::string& packet);
     
     /**
      * @brief 	Get the IP address of the remote station
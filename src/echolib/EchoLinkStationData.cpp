@@ -117,31 +117,28 @@ using namespace EchoLink;
  *
  ****************************************************************************/
 
-string StationData::statusStr(Status status)
+const string& StationData::statusStr(Status status)
 {
-  const char *str;
+    // The strings are only created once and then shared by all stations
+  static const string unknown_str("?");
+  static const string offline_str("OFF");
+  static const string online_str("ON");
+  static const string busy_str("BUSY");
   
   switch (status)
   {
     case STAT_ONLINE:
-      str = "ON";
-      break;
+      return online_str;
       
     case STAT_BUSY:
-      str = "BUSY";
-      break;
+      return busy_str;
       
     case STAT_OFFLINE:
-      str = "OFF";
-      break;
+      return offline_str;
       
     default:
-      str="?";
-      break;
+      return unknown_str;
   }
-  
-  return str;
-  
 } /* StationData::statusStr */
 
 
@@ -177,14 +174,12 @@ void StationData::clear(void)
 void StationData::setCallsign(const string& callsign)
 {
   m_callsign = callsign;
-  m_code = callToCode(callsign);
+  callToCode(callsign, m_code);
 } /* StationData::setCallsign  */
 
 
 void StationData::setData(const char *data)
 {
-  char str[MAXDATA];
-  
   const char *end_desc = strrchr(data, '[');
   if (end_desc != 0)
   {
@@ -204,9 +199,7 @@ void StationData::setData(const char *data)
     const char *space = strchr(end_desc, ' ');
     if (space != 0)
     {
-      strncpy(str, space+1, 5);
-      str[5] = 0;
-      m_time = str;
+      m_time.assign(space+1, strnlen(space+1, 5));
     }
   }
   else
@@ -214,9 +207,8 @@ void StationData::setData(const char *data)
     end_desc = data + strlen(data);
   }
   
-  strncpy(str, data, end_desc-data);
-  str[end_desc-data] = 0;
-  m_description = str;
+    // Assign in place to reuse the memory already allocated for the string
+  m_description.assign(data, end_desc-data);
   removeTrailingSpaces(m_description);
   
 } /* StationData::setData */
@@ -301,10 +293,11 @@ void StationData::removeTrailingSpaces(string& str)
 } /* StationData::removeTrailingSpaces */
 
 
-string StationData::callToCode(const string& call)
+void StationData::callToCode(const string& call, string& code)
 {
-  string code;
-
+    // The code is built in place to reuse the memory already allocated for
+    // the string
+  code.clear();
   for (unsigned i=0; i<call.length(); ++i)
   {
     char digit;
@@ -330,9 +323,6 @@ string StationData::callToCode(const string& call)
     }
     code += digit;
   }
-
-  return code;
-  
 } /* StationData::callToCode  */
 
 
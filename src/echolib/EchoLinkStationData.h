@@ -130,7 +130,7 @@ class StationData
      * @param 	status The status code to translate
      * @return  Returns the string representation of the given status code
      */
-    static std::string statusStr(Status status);
+    static const std::string& statusStr(Status status);
     
     /**
      * @brief Default constructor
@@ -141,6 +141,11 @@ class StationData
      * @brief Copy constructor
      */
     StationData(const StationData& rhs) { *this = rhs; }
+
+    /**
+     * @brief Move constructor
+     */
+    StationData(StationData&& rhs) = default;
     
     /**
      * @brief Clear the contents and reset to default values
@@ -188,7 +193,7 @@ class StationData
      * @brief 	Return the string representation of the status
      * @return	Returns a string representation of the status
      */
-    std::string statusStr(void) const { return statusStr(m_status); }
+    const std::string& statusStr(void) const { return statusStr(m_status); }
     
     /**
      * @brief 	Set the time
@@ -256,7 +261,7 @@ class StationData
      * Star is ignored.
      * All other characters are mapped to digit 1.
      */
-    std::string code(void) const { return m_code; }
+    const std::string& code(void) const { return m_code; }
     
     /**
      * @brief 	Assignment operator
@@ -264,6 +269,13 @@ class StationData
      * @return	Returns a reference to this object
      */
     StationData& operator=(const StationData& rhs);
+
+    /**
+     * @brief 	Move assignment operator
+     * @param 	rhs Right Hand Side expression
+     * @return	Returns a reference to this object
+     */
+    StationData& operator=(StationData&& rhs) = default;
     
     bool operator<(const StationData &rhs) const
     {
@@ -291,7 +303,7 @@ class StationData
     std::string       m_code;
   
     void removeTrailingSpaces(std::string& str);
-    std::string callToCode(const std::string& call);
+    static void callToCode(const std::string& call, std::string& code);
 
 };  /* class StationData */
 
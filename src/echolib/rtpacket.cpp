@@ -137,34 +137,36 @@ int rtp_make_bye(unsigned char *p)
     return (ap - p) + 8;
 }
 
-/*  PARSESDES  --  Look for an SDES message in a possibly composite
-		   RTCP packet. */
+/*  FINDSDESITEM  --  Look for an SDES item in a possibly composite
+		      RTCP packet. The item is not copied. Instead r_text
+		      is set to point at the item text inside the packet
+		      and the length of the text is returned. If the item
+		      is not found, -1 is returned. */
 
 /***************************************************/
 
-bool parseSDES(char *r_text, unsigned char *packet, unsigned char r_item)
+int findSDESItem(const unsigned char *packet, int len, unsigned char r_item,
+                 const unsigned char **r_text)
 {
-    bool success = false;
-    unsigned char *p = packet;
-
-    /* Initialise the result in the request packet to NULL. */
-    *r_text = 0;
+    const unsigned char *p = packet;
+    const unsigned char *end = packet + len;
 
     /* Walk through the individual items in a possibly composite
        packet until we locate an SDES. This allows us to accept
        packets that comply with the RTP standard that all RTCP packets
        begin with an SR or RR. */
 
-    while ((p[0] >> 6 & 3) == RTP_VERSION || (p[0] >> 6 & 3) == 1)
+    while ((end - p >= 8) &&
+           ((p[0] >> 6 & 3) == RTP_VERSION || (p[0] >> 6 & 3) == 1))
     {
-        int len = (ntohs(*((uint16_t *) (p + 2))) + 1) * 4;
-        
+        int plen = (((p[2] << 8) | p[3]) + 1) * 4;
+
 	if ((p[1] == RTCP_SDES) && ((p[0] & 0x1F) > 0))
 	{
-	    unsigned char *cp = p + 8;
-	    unsigned char *lp = cp + len;
-	    
-	    while (cp < lp)
+	    const unsigned char *cp = p + 8;
+	    const unsigned char *lp = (end - cp > plen) ? cp + plen : end;
+
+	    while (lp - cp >= 2)
 	    {
 		unsigned char itype = cp[0];
 		unsigned char ilen = cp[1];
@@ -174,33 +176,65 @@ bool parseSDES(char *r_text, unsigned char *packet, unsigned char r_item)
 		    break;
 		}
 
-		/* Search for a match in the request and fill the
-		   matching item. */
-                if (r_item == itype && *r_text == 0)
-                {
-                    memcpy(r_text, cp + 2, ilen);
-                    r_text[ilen] = 0;
-                    success = true;
-                    break;
+		/* Never point outside of the received packet */
+		if (end - (cp + 2) < ilen)
+		{
+		    break;
+		}
+
+		if (r_item == itype)
+		{
+		    *r_text = cp + 2;
+		    return ilen;
 		}
 		cp += ilen + 2;
 	    }
 	    break;
 	}
 	/* If not of interest to us, skip to next subpacket. */
-	p += len;
+	p += plen;
+    }
+    return -1;
+}
+
+
+/*  PARSESDES  --  Look for an SDES message in a possibly composite
+		   RTCP packet and copy it, null terminated, to r_text
+		   which must be at least 256 bytes long. */
+
+/***************************************************/
+
+bool parseSDES(char *r_text, const unsigned char *packet, int len,
+               unsigned char r_item)
+{
+    const unsigned char *text;
+    int ilen = findSDESItem(packet, len, r_item, &text);
+
+    /* Initialise the result in the request packet to NULL. */
+    *r_text = 0;
+
+    if (ilen < 0)
+    {
+        return false;
     }
-    return success;
+    memcpy(r_text, text, ilen);
+    r_text[ilen] = 0;
+    return true;
 }
 
 
 /************************************/
 /*  ISRTCPBYEPACKET  --  Test if this RTCP packet contains a BYE.  */
 
-bool isRTCPByepacket(unsigned char *p, int len)
+bool isRTCPByepacket(const unsigned char *p, int len)
 {
-    unsigned char *end = p + len;
+    const unsigned char *end = p + len;
     bool sawbye = false;
+                                                   /* Too short ? */
+    if (len < 4)
+    {
+        return false;
+    }
                                                    /* Version incorrect ? */
     if ((((p[0] >> 6) & 3) != RTP_VERSION && ((p[0] >> 6) & 3) != 1) ||
         ((p[0] & 0x20) != 0) ||                    /* Padding in first packet ? */
@@ -215,8 +249,8 @@ bool isRTCPByepacket(unsigned char *p, int len)
             sawbye = true;
         }
         /* Advance to next subpacket */
-        p += (ntohs(*((uint16_t *) (p + 2))) + 1) * 4;
-    } while (p < end && (((p[0] >> 6) & 3) == RTP_VERSION));
+        p += (((p[2] << 8) | p[3]) + 1) * 4;
+    } while ((end - p >= 4) && (((p[0] >> 6) & 3) == RTP_VERSION));
 
     return sawbye;
 }
@@ -224,10 +258,15 @@ bool isRTCPByepacket(unsigned char *p, int len)
 /************************************/
 /*  ISRTCPSDESPACKET  --  Test if this RTCP packet contains a SDES.  */
 
-bool isRTCPSdespacket(unsigned char *p, int len)
+bool isRTCPSdespacket(const unsigned char *p, int len)
 {
-    unsigned char *end = p + len;
+    const unsigned char *end = p + len;
     bool sawsdes = 0;
+                                                   /* Too short ? */
+    if (len < 4)
+    {
+        return false;
+    }
                                                    /* Version incorrect ? */
     if ((((p[0] >> 6) & 3) != RTP_VERSION && ((p[0] >> 6) & 3) != 1) ||
         ((p[0] & 0x20) != 0) ||                    /* Padding in first packet ? */
@@ -242,8 +281,8 @@ bool isRTCPSdespacket(unsigned char *p, int len)
             sawsdes = true;
         }
         /* Advance to next subpacket */
-        p += (ntohs(*((uint16_t *) (p + 2))) + 1) * 4;
-    } while (p < end && (((p[0] >> 6) & 3) == RTP_VERSION));
+        p += (((p[2] << 8) | p[3]) + 1) * 4;
+    } while ((end - p >= 4) && (((p[0] >> 6) & 3) == RTP_VERSION));
 
     return sawsdes;
 }
@@ -11,8 +11,10 @@
 
 int rtp_make_sdes(unsigned char *, const char *, const char *, const char *);
 int rtp_make_bye(unsigned char *);
-bool parseSDES(char *, unsigned char *, unsigned char);
-bool isRTCPByepacket(unsigned char *, int);
-bool isRTCPSdespacket(unsigned char *, int);
+int findSDESItem(const unsigned char *, int, unsigned char,
+                 const unsigned char **);
+bool parseSDES(char *, const unsigned char *, int, unsigned char);
+bool isRTCPByepacket(const unsigned char *, int);
+bool isRTCPSdespacket(const unsigned char *, int);
 
 #endif
@@ -45,6 +45,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
  *
  ****************************************************************************/
 
+#include <AsyncApplication.h>
 #include <AsyncTimer.h>
 #include <AsyncConfig.h>
 
@@ -159,7 +160,8 @@ namespace {
 AprsTcpClient::AprsTcpClient(LocationInfo::Cfg &loc_cfg,
                             const std::string &server, int port)
   : loc_cfg(loc_cfg), server(server), port(port), con(0), beacon_timer(0),
-    status_timer(0), reconnect_timer(0), offset_timer(0), num_connected(0)
+    status_timer(0), reconnect_timer(0), offset_timer(0), num_connected(0),
+    flush_pending(false), obj_symbol_pos(0), src_symbol_pos(0)
 {
    StrList str_list;
 
@@ -212,30 +214,33 @@ void AprsTcpClient::updateQsoStatus(int action, const std::string& call,
 
   num_connected = calls.size();
 
-  char msg[80];
+  char msg[80] = "";
   switch(action)
   {
     case 0:
-      sprintf(msg, "connection to %s closed", call.c_str());
+      snprintf(msg, sizeof(msg), "connection to %s closed", call.c_str());
       break;
     case 1:
-      sprintf(msg, "connection to %s (%s)", call.c_str(), info.c_str());
+      snprintf(msg, sizeof(msg), "connection to %s (%s)", call.c_str(),
+               info.c_str());
       break;
     case 2:
-      sprintf(msg, "incoming connection %s (%s)", call.c_str(), info.c_str());
+      snprintf(msg, sizeof(msg), "incoming connection %s (%s)", call.c_str(),
+               info.c_str());
       break;
   }
 
+  if (qso_obj_prefix.empty())
+  {
+    buildBeaconTemplates();
+  }
+
     // Object message for Echolink
     // ;EL-242660*111111z4900.05NE00823.29E0QSO status message
-  std::ostringstream objmsg;
-  objmsg << addrStr(loc_cfg.sourcecall)
-         << ";" << addresseeStr(loc_cfg.objectname) << "*"
-         << "111111z"
-         << posStr("E0")
-         << msg
-         ;
-  sendMsg(objmsg.str());
+  std::string objmsg(qso_obj_prefix);
+  objmsg += overlayChar();
+  objmsg += msg;
+  sendMsg(objmsg);
 
     // Status message for Echolink, connected calls
   std::string status;
@@ -298,33 +303,52 @@ std::string AprsTcpClient::posStr(const std::string& symbol) const
     // Set overlay if Echolink object position string
   if (symbol_table_id == 'E')
   {
-    symbol_code = (num_connected < 10) ? '0' + num_connected : '9';
+    symbol_code = overlayChar();
   }
 
-  char pos[32];
-  sprintf(pos, "%02d%02d.%02d%c%c%03d%02d.%02d%c%c",
-               loc_cfg.lat_pos.deg, loc_cfg.lat_pos.min,
-               (loc_cfg.lat_pos.sec * 100) / 60, loc_cfg.lat_pos.dir,
-               symbol_table_id,
-               loc_cfg.lon_pos.deg, loc_cfg.lon_pos.min,
-               (loc_cfg.lon_pos.sec * 100) / 60, loc_cfg.lon_pos.dir,
-               symbol_code);
-  return std::string(pos);
+  std::string pos(latStr());
+  pos += symbol_table_id;
+  pos += lonStr();
+  pos += symbol_code;
+  return pos;
 } /* AprsTcpClient::posStr */
 
 
+std::string AprsTcpClient::latStr(void) const
+{
+  char lat[16];
+  snprintf(lat, sizeof(lat), "%02d%02d.%02d%c",
+           loc_cfg.lat_pos.deg, loc_cfg.lat_pos.min,
+           (loc_cfg.lat_pos.sec * 100) / 60, loc_cfg.lat_pos.dir);
+  return std::string(lat);
+} /* AprsTcpClient::latStr */
+
+
+std::string AprsTcpClient::lonStr(void) const
+{
+  char lon[16];
+  snprintf(lon, sizeof(lon), "%03d%02d.%02d%c",
+           loc_cfg.lon_pos.deg, loc_cfg.lon_pos.min,
+           (loc_cfg.lon_pos.sec * 100) / 60, loc_cfg.lon_pos.dir);
+  return std::string(lon);
+} /* AprsTcpClient::lonStr */
+
+
+char AprsTcpClient::overlayChar(void) const
+{
+    // The number of connected stations, used as the overlay character of
+    // Echolink object symbols
+  return (num_connected < 10) ? '0' + num_connected : '9';
+} /* AprsTcpClient::overlayChar */
+
+
 std::string AprsTcpClient::timeStr(void) const
 {
   time_t now = time(NULL);
-  struct tm tm, *tm_ptr;
-  tm_ptr = gmtime_r(&now, &tm);
-  std::ostringstream tstr;
-  tstr << std::setw(2) << std::setfill('0') << tm_ptr->tm_mday
-       << std::setw(2) << std::setfill('0') << tm_ptr->tm_hour
-       << std::setw(2) << std::setfill('0') << tm_ptr->tm_min
-       << "z"
-       ;
-  return tstr.str();
+  struct tm tm;
+  char tstr[16];
+  strftime(tstr, sizeof(tstr), "%d%H%Mz", gmtime_r(&now, &tm));
+  return std::string(tstr);
 } /* AprsTcpClient::timeStr */
 
 
@@ -424,39 +448,54 @@ std::string AprsTcpClient::prependSpaceIfNotEmpty(const std::string& str) const
 } /* AprsTcpClient::prependSpaceIfNotEmpty */
 
 
+void AprsTcpClient::buildBeaconTemplates(void)
+{
+  src_addr = addrStr(loc_cfg.sourcecall);
+
+  const std::string beacon_tail = phgStr() + frequencyStr() +
+                                  " " + toneStr() +
+                                  prependSpaceIfNotEmpty(txOffsetStr()) +
+                                  " " + rangeStr() +
+                                  prependSpaceIfNotEmpty(loc_cfg.comment);
+  const std::string obj_head =
+      src_addr + ";" + addresseeStr(loc_cfg.objectname) + "*" + "111111z";
+  const std::string pos = posStr(loc_cfg.symbol);
+
+    // Position report for main object
+  obj_beacon = obj_head + pos + beacon_tail;
+  obj_symbol_pos = obj_head.size() + pos.size() - 1;
+
+    // Position for source callsign
+  src_beacon = src_addr + "=" + pos + beacon_tail;
+  src_symbol_pos = src_addr.size() + pos.size();
+
+    // Echolink QSO status object, the overlay character is appended on send
+  qso_obj_prefix = obj_head + latStr() + "E" + lonStr();
+} /* AprsTcpClient::buildBeaconTemplates */
+
+
 void AprsTcpClient::sendAprsBeacon(Timer *t)
 {
-  const std::string tx_offset_str = prependSpaceIfNotEmpty(txOffsetStr());
-  const std::string comment_str = prependSpaceIfNotEmpty(loc_cfg.comment);
+  if (obj_beacon.empty())
+  {
+    buildBeaconTemplates();
+  }
+
+    // Only the overlay character of an Echolink symbol change between
+    // beacons
+  if (loc_cfg.symbol[0] == 'E')
+  {
+    obj_beacon[obj_symbol_pos] = overlayChar();
+    src_beacon[src_symbol_pos] = overlayChar();
+  }
 
     // Position report for main object
-  std::ostringstream posmsg;
-  posmsg << addrStr(loc_cfg.sourcecall)
-         << ";" << addresseeStr(loc_cfg.objectname) << "*"
-         << "111111z"
-         << posStr(loc_cfg.symbol)
-         << phgStr()
-         << frequencyStr()
-         << " " << toneStr()
-         << tx_offset_str
-         << " " << rangeStr()
-         << comment_str;
-  sendMsg(posmsg.str());
+  sendMsg(obj_beacon);
 
   if (loc_cfg.objectname != loc_cfg.statscall)
   {
       // Position for source callsign
-    std::ostringstream posmsg;
-    posmsg << addrStr(loc_cfg.sourcecall)
-           << "="
-           << posStr(loc_cfg.symbol)
-           << phgStr()
-           << frequencyStr()
-           << " " << toneStr()
-           << tx_offset_str
-           << " " << rangeStr()
-           << comment_str;
-    sendMsg(posmsg.str());
+    sendMsg(src_beacon);
     //std::ostringstream objmsg;
     //objmsg << addrStr(loc_cfg.sourcecall)
     //       << ";" << addresseeStr(loc_cfg.sourcecall) << "*"
@@ -483,10 +522,15 @@ void AprsTcpClient::sendAprsStatus(const std::string& src,
     return;
   }
 
+  if (src_addr.empty())
+  {
+    buildBeaconTemplates();
+  }
+
   if (status.empty() || (status == SVXVER_STATUS))
   {
       // Send SvxLink version as status
-    std::string verstatus = addrStr(src) + ">" + timeStr() +
+    std::string verstatus = src_addr + ">" + timeStr() +
                          "SvxLink v" + SVXLINK_APP_VERSION +
                          " (https://www.svxlink.org)";
     sendMsg(verstatus);
@@ -500,14 +544,13 @@ void AprsTcpClient::sendAprsStatus(const std::string& src,
   if (!current_status.empty())
   {
       // Send given info as status
-    std::string msg = addrStr(loc_cfg.sourcecall) + ">" + timeStr() +
-                      current_status;
+    std::string msg = src_addr + ">" + timeStr() + current_status;
     sendMsg(msg);
   }
 } /* AprsTcpClient::sendAprsStatus*/
 
 
-void AprsTcpClient::sendMsg(std::string aprsmsg)
+void AprsTcpClient::sendMsg(const std::string& aprsmsg)
 {
   const size_t max_packet_size = 512;
   if (aprsmsg.size() >= max_packet_size-2)
@@ -529,21 +572,46 @@ void AprsTcpClient::sendMsg(std::string aprsmsg)
     return;
   }
 
-  aprsmsg.append("\r\n");
+  tx_buf.append(aprsmsg).append("\r\n");
+
+    // Send all messages queued up during this main loop iteration, e.g. a
+    // beacon and the status messages, in one write
+  if (!flush_pending)
+  {
+    flush_pending = true;
+    Application::app().runTask(mem_fun(*this, &AprsTcpClient::flushTxBuf));
+  }
+} /* AprsTcpClient::sendMsg */
 
-  int written = con->write(aprsmsg.c_str(), aprsmsg.size());
+
+void AprsTcpClient::flushTxBuf(void)
+{
+  flush_pending = false;
+  if (tx_buf.empty())
+  {
+    return;
+  }
+  if (!con->isConnected())
+  {
+    tx_buf.clear();
+    return;
+  }
+
+  const size_t len = tx_buf.size();
+  int written = con->write(tx_buf.data(), len);
+  tx_buf.clear();
   if (written < 0)
   {
     std::cerr << "*** ERROR: TCP write error" << std::endl;
     disconnect();
   }
-  else if (static_cast<size_t>(written) != aprsmsg.size())
+  else if (static_cast<size_t>(written) != len)
   {
     std::cerr << "*** ERROR: TCP transmit buffer overflow, reconnecting."
               << std::endl;
     disconnect();
   }
-} /* AprsTcpClient::sendMsg */
+} /* AprsTcpClient::flushTxBuf */
 
 
 void AprsTcpClient::aprsLogin(void)
@@ -591,6 +659,8 @@ void AprsTcpClient::tcpConnected(void)
             << ":" << con->remotePort() << std::endl;
 
   recv_buf.clear();
+  tx_buf.clear();
+  buildBeaconTemplates();
 
   aprsLogin();                    // login
   offset_timer->reset();          // reset the offset_timer
@@ -729,6 +799,7 @@ void AprsTcpClient::tcpDisconnected(TcpClient<>::TcpConnection *con,
   offset_timer->setEnable(false);
   offset_timer->reset();
   recv_buf.clear();
+  tx_buf.clear();
 } /* AprsTcpClient::tcpDisconnected */
 
 
@@ -112,6 +112,10 @@ namespace Async
 @brief	Aprs-logics
 @author Adi Bier / DL1HRC
 @date   2008-11-01
+
+The static parts of the beacons are formatted once when connected to the
+server and only the dynamic fields are filled in when a beacon is sent. All
+messages produced during one main loop iteration are sent in a single write.
 */
 class AprsTcpClient : public AprsClient, public sigc::trackable
 {
@@ -143,10 +147,24 @@ class AprsTcpClient : public AprsClient, public sigc::trackable
 
     std::string         recv_buf;
     std::string         current_status;
-
-    void  sendMsg(std::string aprsmsg);
+    std::string         tx_buf;
+    bool                flush_pending;
+
+    std::string         src_addr;
+    std::string         obj_beacon;
+    std::string         src_beacon;
+    std::string         qso_obj_prefix;
+    size_t              obj_symbol_pos;
+    size_t              src_symbol_pos;
+
+    void  sendMsg(const std::string& aprsmsg);
+    void  flushTxBuf(void);
+    void  buildBeaconTemplates(void);
     std::string addrStr(const std::string& source) const;
     std::string posStr(const std::string& symbol) const;
+    std::string latStr(void) const;
+    std::string lonStr(void) const;
+    char overlayChar(void) const;
     std::string timeStr(void) const;
     std::string phgStr(void) const;
     std::string toneStr(void) const;
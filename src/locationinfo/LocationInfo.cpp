@@ -39,6 +39,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 #include <limits>
 #include <string>
 #include <regex>
+#include <set>
 
 
 /****************************************************************************
@@ -49,6 +50,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 
 #include <AsyncConfig.h>
 #include <AsyncTimer.h>
+#include <AsyncWorkerPool.h>
 
 
 /****************************************************************************
@@ -141,6 +143,11 @@ LocationInfo::LocationInfo(void)
 
 LocationInfo::~LocationInfo(void)
 {
+    // Delete the pool first so that no completion function is called
+    // for a partly destroyed object
+  delete stats_pool;
+  stats_pool = nullptr;
+
   for (const auto client : clients)
   {
     delete client;
@@ -271,6 +278,15 @@ bool LocationInfo::initialize(Async::Config& cfg, const std::string& cfg_name)
     cfg.getValue(cfg_name, "STATISTICS_INTERVAL", 5U, 60U,
         _instance->sinterval);
     _instance->startStatisticsTimer(_instance->sinterval * 60 * 1000);
+
+      // The telemetry messages are formatted in a worker thread. If it
+      // cannot be started, they are formatted in the main thread instead.
+    _instance->stats_pool = new WorkerPool(1);
+    if (!_instance->stats_pool->initOk())
+    {
+      delete _instance->stats_pool;
+      _instance->stats_pool = nullptr;
+    }
   }
 
   cfg.getValue(cfg_name, "SYMBOL", loc_cfg.symbol);
@@ -651,6 +667,7 @@ bool LocationInfo::parseClients(const Async::Config &cfg,
   std::string client, host;
   int port;
   bool success = true;
+  std::set<std::string> aprs_servers;
 
   while (clientStream >> client)
   {
@@ -660,6 +677,13 @@ bool LocationInfo::parseClients(const Async::Config &cfg,
                   "APRS_SERVER_LIST=euro.aprs2.net:14580");
       success = false;
     }
+    else if (!aprs_servers.insert(client).second)
+    {
+        // All logics share the same APRS-IS connection so a server
+        // should only be connected once
+      std::cerr << "*** WARNING: Ignoring duplicate APRS server " << client
+                << " in " << name << "/APRS_SERVER_LIST" << std::endl;
+    }
     else
     {
       AprsTcpClient *client = new AprsTcpClient(loc_cfg, host, port);
@@ -736,37 +760,107 @@ void LocationInfo::startStatisticsTimer(int sinterval)
 
 
 void LocationInfo::sendAprsStatistics(void)
+{
+    // Only the counters are handled here, in the main thread where they are
+    // updated. The messages are formatted in a worker thread.
+  StatsJob job;
+  job.sourcecall = loc_cfg.sourcecall;
+  job.statscall = loc_cfg.statscall;
+  job.destination = loc_cfg.destination;
+  job.path = loc_cfg.path;
+  job.sinterval = sinterval;
+  job.sequence = sequence;
+
+  const auto now = Clock::now();
+  job.send_metadata = (now - last_tlm_metadata > std::chrono::minutes(59));
+  if (job.send_metadata)
+  {
+    last_tlm_metadata = now;
+  }
+
+    // Loop for each logic
+  for (auto& entry : aprs_stats)
+  {
+    const std::string& logic_name = entry.first;
+    AprsStatistics& stats = entry.second;
+
+    if (!slogic.empty() && (logic_name != slogic))
+    {
+      continue;
+    }
+
+      // Remember squelch and tx state then force inactive to finish statistics
+      // interval
+    bool is_receiving = stats.is_receiving;
+    bool is_transmitting = stats.is_transmitting;
+    setReceiving(logic_name, false, now);
+    setTransmitting(logic_name, false, now);
+
+    StatsSnapshot snapshot;
+    snapshot.logic_name = logic_name;
+    snapshot.rx_on_nr = stats.rx_on_nr;
+    snapshot.tx_on_nr = stats.tx_on_nr;
+    snapshot.rx_sec = stats.rx_sec.count();
+    snapshot.tx_sec = stats.tx_sec.count();
+    snapshot.is_receiving = is_receiving;
+    snapshot.is_transmitting = is_transmitting;
+    job.stats.push_back(snapshot);
+
+      // Reset statistics
+    stats.reset();
+
+      // Restore squelch and tx state
+    setReceiving(logic_name, is_receiving, now);
+    setTransmitting(logic_name, is_transmitting, now);
+  }
+
+    // Advance sequence number, one for each logic
+  sequence = (sequence + job.stats.size()) % 1000;
+
+  if (stats_pool != nullptr)
+  {
+    stats_pool->call(
+        [job](void) { return formatAprsStatistics(job); },
+        [this](std::vector<std::string> msgs) { sendAprsMessages(msgs); });
+  }
+  else
+  {
+    sendAprsMessages(formatAprsStatistics(job));
+  }
+} /* LocationInfo::sendAprsStatistics */
+
+
+std::vector<std::string>
+LocationInfo::formatAprsStatistics(const StatsJob& job)
 {
   // https://github.com/PhirePhly/aprs_notes/blob/master/telemetry_format.md
 
+  std::vector<std::string> msgs;
+
     // FROM>APSVXn,VIA1,VIA2,VIAn:
   std::ostringstream addr;
-  addr << addrStr(loc_cfg.sourcecall, loc_cfg.destination, loc_cfg.path);
+  addr << addrStr(job.sourcecall, job.destination, job.path);
 
     // :ADDRESSEE:
   std::ostringstream addressee;
-  addressee << ":" << std::left << std::setw(9) << loc_cfg.statscall << ":";
+  addressee << ":" << std::left << std::setw(9) << job.statscall << ":";
 
-  const auto now = Clock::now();
-  bool send_metadata = (now - last_tlm_metadata > std::chrono::minutes(59));
-  if (send_metadata)
+  if (job.send_metadata)
   {
-    last_tlm_metadata = now;
-
       // PARM.A1,A2,A3,A4,A5,B1,B2,B3,B4,B5,B6,B7,B8
     std::ostringstream parm;
     parm << addr.str()
          << addressee.str()
          << "PARM."
-         << "RX Avg " << sinterval << "m"     // A1
-         << ",TX Avg " << sinterval << "m"    // A2
-         << ",RX Count " << sinterval << "m"  // A3
-         << ",TX Count " << sinterval << "m"  // A4
-         << ","                               // A5
-         << ",RX"                             // B1
-         << ",TX"                             // B2
+         << "RX Avg " << job.sinterval << "m"     // A1
+         << ",TX Avg " << job.sinterval << "m"    // A2
+         << ",RX Count " << job.sinterval << "m"  // A3
+         << ",TX Count " << job.sinterval << "m"  // A4
+         << ","                                   // A5
+         << ",RX"                                 // B1
+         << ",TX"                                 // B2
          ;
-    igateMessage(parm.str());
+    msgs.push_back(parm.str());
 
       // UNIT.A1,A2,A3,A4,A5,B1,B2,B3,B4,B5,B6,B7,B8
     std::ostringstream unit;
@@ -778,36 +872,21 @@ void LocationInfo::sendAprsStatistics(void)
          << ",receptions"     // A3
          << ",transmissions"  // A4
          ;
-    igateMessage(unit.str());
+    msgs.push_back(unit.str());
   }
 
-    // Loop for each logic
-  for (auto& entry : LocationInfo::instance()->aprs_stats)
+  int sequence = job.sequence;
+  for (const auto& stats : job.stats)
   {
-    const std::string& logic_name = entry.first;
-    AprsStatistics& stats = entry.second;
-
-    if (!slogic.empty() && (logic_name != slogic))
-    {
-      continue;
-    }
-
-      // Remember squelch and tx state then force inactive to finish statistics
-      // interval
-    bool is_receiving = stats.is_receiving;
-    bool is_transmitting = stats.is_transmitting;
-    setReceiving(logic_name, false, now);
-    setTransmitting(logic_name, false, now);
-
     const double erlang_b = 1.0 / 999.0;
-    if (send_metadata)
+    if (job.send_metadata)
     {
         // BITS.XXXXXXXX,Project Title
       std::ostringstream bits;
       bits << addr.str()
            << addressee.str()
-           << "BITS.11111111,SvxLink " << logic_name;
-      igateMessage(bits.str());
+           << "BITS.11111111,SvxLink " << stats.logic_name;
+      msgs.push_back(bits.str());
 
         // EQNS.a,b,c,a,b,c,a,b,c,a,b,c,a,b,c
       std::ostringstream eqns;
@@ -821,14 +900,14 @@ void LocationInfo::sendAprsStatistics(void)
            << "," << std::fixed << std::setprecision(5) << erlang_b // A2b
            << ",0"                                                  // A2c
            ;
-      igateMessage(eqns.str());
+      msgs.push_back(eqns.str());
     }
 
       // T#nnn,nnn,nnn,nnn,nnn,nnn,nnnnnnnn
-    auto rx_erlang = stats.rx_sec.count() / (60.0 * sinterval);
-    auto tx_erlang = stats.tx_sec.count() / (60.0 * sinterval);
+    auto rx_erlang = stats.rx_sec / (60.0 * job.sinterval);
+    auto tx_erlang = stats.tx_sec / (60.0 * job.sinterval);
     std::ostringstream tlm;
-    tlm << addrStr(loc_cfg.statscall, loc_cfg.destination, loc_cfg.path)
+    tlm << addrStr(job.statscall, job.destination, job.path)
         << "T#" << std::setw(3) << std::setfill('0') << sequence  // Sequence
         << "," << std::setw(3) << std::setfill('0')               // A1
                << std::min(std::lrint(rx_erlang / erlang_b), 999L)
@@ -840,23 +919,26 @@ void LocationInfo::sendAprsStatistics(void)
           << std::min(stats.tx_on_nr, 999U)
         << ",000"                                                 // A5
         << ","
-        << (is_receiving ? 1 : 0)                                 // B1
-        << (is_transmitting ? 1 : 0)                              // B2
+        << (stats.is_receiving ? 1 : 0)                           // B1
+        << (stats.is_transmitting ? 1 : 0)                        // B2
         << "000000"                                               // B3-B8
         ;
-    igateMessage(tlm.str());
+    msgs.push_back(tlm.str());
 
-      // Reset statistics
-    stats.reset();
+    sequence = (sequence < 999) ? sequence+1 : 0;
+  }
 
-      // Restore squelch and tx state
-    setReceiving(logic_name, is_receiving, now);
-    setTransmitting(logic_name, is_transmitting, now);
+  return msgs;
+} /* LocationInfo::formatAprsStatistics */
 
-      // Advance sequence number
-    sequence = (sequence < 999) ? sequence+1 : 0;
+
+void LocationInfo::sendAprsMessages(const std::vector<std::string>& msgs)
+{
+  for (const auto& msg : msgs)
+  {
+    igateMessage(msg);
   }
-} /* LocationInfo::sendAprsStatistics */
+} /* LocationInfo::sendAprsMessages */
 
 
 void LocationInfo::initExtPty(std::string ptydevice)
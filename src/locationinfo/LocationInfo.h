@@ -37,6 +37,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 
 #include <string>
 #include <list>
+#include <vector>
 #include <chrono>
 
 
@@ -67,6 +68,10 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
  ****************************************************************************/
 
 class AprsClient;
+namespace Async
+{
+  class WorkerPool;
+};
 
 
 /****************************************************************************
@@ -214,6 +219,30 @@ class LocationInfo
     };
     using AprsStatsMap = std::map<std::string, AprsStatistics>;
 
+      // A copy of everything needed to format the telemetry messages for one
+      // statistics interval so that it can be done in a worker thread
+    struct StatsSnapshot
+    {
+      std::string logic_name;
+      unsigned    rx_on_nr        {0};
+      unsigned    tx_on_nr        {0};
+      double      rx_sec          {0.0};
+      double      tx_sec          {0.0};
+      bool        is_receiving    {false};
+      bool        is_transmitting {false};
+    };
+    struct StatsJob
+    {
+      std::string sourcecall;
+      std::string statscall;
+      std::string destination;
+      std::string path;
+      unsigned    sinterval       {10};
+      int         sequence        {0};
+      bool        send_metadata   {false};
+      std::vector<StatsSnapshot> stats;
+    };
+
     Cfg           loc_cfg; // weshalb?
     ClientList    clients;
     int           sequence          {0};
@@ -223,6 +252,7 @@ class LocationInfo
     Timepoint     last_tlm_metadata {-std::chrono::hours(1)};
     AprsStatsMap  aprs_stats;
     Async::Pty*   aprspty           {nullptr};
+    Async::WorkerPool* stats_pool   {nullptr};
 
     bool parsePosition(const Async::Config &cfg, const std::string &name);
     bool parseLatitude(Coordinate &pos, const std::string &value);
@@ -236,6 +266,8 @@ class LocationInfo
     bool parseClients(const Async::Config &cfg, const std::string &name);
     void startStatisticsTimer(int sinterval);
     void sendAprsStatistics(void);
+    static std::vector<std::string> formatAprsStatistics(const StatsJob& job);
+    void sendAprsMessages(const std::vector<std::string>& msgs);
     void initExtPty(std::string ptydevice);
     void mesReceived(const void* buf, size_t len);
     AprsStatistics& aprsStats(const std::string& logic_name);
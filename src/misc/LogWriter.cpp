@@ -32,10 +32,13 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 
 #include <fcntl.h>
 #include <unistd.h>
+#include <poll.h>
 #include <sys/time.h>
 #include <syslog.h>
 
 #include <cstring>
+#include <cerrno>
+#include <algorithm>
 #include <iostream>
 #include <iomanip>
 #include <sstream>
@@ -47,6 +50,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
  *
  ****************************************************************************/
 
+#include <AsyncThreadSched.h>
 
 
 /****************************************************************************
@@ -98,6 +102,9 @@ class LogWriter::LogWriterWorker
     virtual void logReopen(std::string reason) {}
     virtual bool logWriteTimestamp(void) { return true; }
     virtual void logWrite(const char *buf) = 0;
+    virtual void logWriteRecord(const struct timeval& tv, bool line_start,
+                                const char* buf, size_t len) = 0;
+    virtual void logWriteFlush(void) {}
 };
 
 
@@ -112,11 +119,22 @@ class LogWriter::LogWriterWorkerFile : public LogWriter::LogWriterWorker
     virtual void logReopen(std::string reason) override;
     virtual bool logWriteTimestamp(void) override;
     virtual void logWrite(const char *buf) override;
+    virtual void logWriteRecord(const struct timeval& tv, bool line_start,
+                                const char* buf, size_t len) override;
+    virtual void logWriteFlush(void) override;
 
   private:
     std::string       m_logfile_name;
     int               m_logfd           {-1};
     std::string       m_tstamp_format   {"%c"};
+    bool              m_tstamp_has_frac {false};
+    std::string       m_batch;
+    time_t            m_tstamp_sec      {-1};
+    long              m_tstamp_msec     {-1};
+    std::string       m_tstamp;
+
+    const std::string& formatTimestamp(const struct timeval& tv);
+    bool writeAll(const char* buf, size_t len);
 };
 
 
@@ -125,8 +143,49 @@ class LogWriter::LogWriterWorkerSyslog : public LogWriter::LogWriterWorker
   public:
     virtual ~LogWriterWorkerSyslog(void) {}
     virtual void logWrite(const char *buf) override;
+    virtual void logWriteRecord(const struct timeval& tv, bool line_start,
+                                const char* buf, size_t len) override;
   private:
     std::string   m_buf;
+    std::string   m_rec_buf;
+
+    void logLines(std::string& buf);
+};
+
+
+class LogWriter::LogStreamBuf : public std::streambuf
+{
+  public:
+    LogStreamBuf(LogWriter* writer, unsigned idx)
+      : m_writer(writer), m_idx(idx) {}
+
+  protected:
+    virtual int_type overflow(int_type ch) override
+    {
+      if (!traits_type::eq_int_type(ch, traits_type::eof()))
+      {
+        const char c = traits_type::to_char_type(ch);
+        m_writer->streamWrite(m_idx, &c, 1);
+      }
+      return traits_type::not_eof(ch);
+    }
+
+    virtual std::streamsize xsputn(const char_type* s,
+                                   std::streamsize n) override
+    {
+      m_writer->streamWrite(m_idx, s, n);
+      return n;
+    }
+
+    virtual int sync(void) override
+    {
+      m_writer->streamFlush(m_idx);
+      return 0;
+    }
+
+  private:
+    LogWriter*  m_writer;
+    unsigned    m_idx;
 };
 
 
@@ -151,6 +210,7 @@ namespace {
  ****************************************************************************/
 
 LogWriter::LogWriter(void)
+  : m_ring(new LogSlot[LOG_RING_SIZE])
 {
     // Create a pipe to route stdout and stderr through
   if (pipe(m_pipefd) == -1)
@@ -158,12 +218,39 @@ LogWriter::LogWriter(void)
     perror("pipe");
     exit(1);
   }
+
+    // Create a non-blocking pipe used to wake the writer thread up when new
+    // lines have been put in the ring buffer
+  if ((pipe(m_wakeup_pipefd) == -1) ||
+      (fcntl(m_wakeup_pipefd[0], F_SETFL, O_NONBLOCK) == -1) ||
+      (fcntl(m_wakeup_pipefd[1], F_SETFL, O_NONBLOCK) == -1))
+  {
+    perror("pipe");
+    exit(1);
+  }
+
+  for (size_t i=0; i<LOG_RING_SIZE; ++i)
+  {
+    m_ring[i].seq.store(i, std::memory_order_relaxed);
+  }
 } /* LogWriter::LogWriter */
 
 
 LogWriter::~LogWriter(void)
 {
   stop();
+  for (auto& fd : m_wakeup_pipefd)
+  {
+    if (fd != -1)
+    {
+      close(fd);
+      fd = -1;
+    }
+  }
+  delete m_stdout_buf;
+  m_stdout_buf = nullptr;
+  delete m_stderr_buf;
+  m_stderr_buf = nullptr;
 } /* LogWriter::~LogWriter */
 
 
@@ -194,6 +281,19 @@ void LogWriter::stop(void)
 {
   logFlush();
 
+    // Restore the original stream buffers so that nothing is written to the
+    // ring buffer after the writer thread has exited
+  if (m_orig_stdout_buf != nullptr)
+  {
+    std::cout.rdbuf(m_orig_stdout_buf);
+    m_orig_stdout_buf = nullptr;
+  }
+  if (m_orig_stderr_buf != nullptr)
+  {
+    std::cerr.rdbuf(m_orig_stderr_buf);
+    m_orig_stderr_buf = nullptr;
+  }
+
   if (m_pipefd[1] != -1)
   {
     write(m_pipefd[1], "\0", 1);
@@ -237,6 +337,16 @@ void LogWriter::redirectStdout(void)
     perror("setvbuf(stdout, NULL, _IOLBF, 0)");
     exit(1);
   }
+
+    // Route std::cout through the ring buffer
+  if (m_stdout_buf == nullptr)
+  {
+    m_stdout_buf = new LogStreamBuf(this, 0);
+  }
+  if (m_orig_stdout_buf == nullptr)
+  {
+    m_orig_stdout_buf = std::cout.rdbuf(m_stdout_buf);
+  }
 } /* LogWriter::redirectStdout */
 
 
@@ -248,6 +358,16 @@ void LogWriter::redirectStderr(void)
     perror("dup2(stderr)");
     exit(1);
   }
+
+    // Route std::cerr through the ring buffer
+  if (m_stderr_buf == nullptr)
+  {
+    m_stderr_buf = new LogStreamBuf(this, 1);
+  }
+  if (m_orig_stderr_buf == nullptr)
+  {
+    m_orig_stderr_buf = std::cerr.rdbuf(m_stderr_buf);
+  }
 } /* LogWriter::redirectStderr */
 
 
@@ -268,6 +388,8 @@ void LogWriter::redirectStderr(void)
 
 void LogWriter::writerThread(void)
 {
+  Async::ThreadSched::Registration sched_reg("logwriter");
+
   {
     const std::lock_guard<std::mutex> lock(m_mutex);
 
@@ -287,24 +409,62 @@ void LogWriter::writerThread(void)
     }
   }
 
+  struct pollfd fds[2];
+  fds[0].fd = m_pipefd[0];
+  fds[0].events = POLLIN;
+  fds[1].fd = m_wakeup_pipefd[0];
+  fds[1].events = POLLIN;
   for (;;)
   {
-    char buf[256];
-    auto len = read(m_pipefd[0], buf, sizeof(buf)-1);
-    if ((len <= 0) || (buf[len-1] == '\0'))
+    ringDrain();
+
+      // Tell the producers that we are about to sleep, then check the ring
+      // buffer again so that a line queued in between is not missed
+    m_writer_waiting = true;
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (!ringEmpty())
+    {
+      m_writer_waiting = false;
+      continue;
+    }
+
+    if (poll(fds, 2, -1) == -1)
     {
+      if (errno == EINTR)
+      {
+        continue;
+      }
       break;
     }
-    buf[len] = 0;
-    const std::lock_guard<std::mutex> lock(m_mutex);
-    m_worker->logWrite(buf);
-    if (m_reopen_log)
+    m_writer_waiting = false;
+
+    if (fds[1].revents != 0)
     {
-      m_worker->logReopen("Reopen requested");
-      m_reopen_log = false;
+      char buf[64];
+      while (read(m_wakeup_pipefd[0], buf, sizeof(buf)) > 0) {}
+    }
+
+    if (fds[0].revents != 0)
+    {
+      char buf[256];
+      auto len = read(m_pipefd[0], buf, sizeof(buf)-1);
+      if ((len <= 0) || (buf[len-1] == '\0'))
+      {
+        break;
+      }
+      buf[len] = 0;
+      const std::lock_guard<std::mutex> lock(m_mutex);
+      m_worker->logWrite(buf);
+      if (m_reopen_log)
+      {
+        m_worker->logReopen("Reopen requested");
+        m_reopen_log = false;
+      }
     }
   }
 
+  ringDrain();
+
   const std::lock_guard<std::mutex> lock(m_mutex);
   //m_worker->logWrite("### logwriter exited\n");
   delete m_worker;
@@ -319,6 +479,186 @@ void LogWriter::logFlush(void)
 } /* LogWriter::logFlush */
 
 
+LogWriter::ThreadLine& LogWriter::threadLine(unsigned idx)
+{
+    // Each thread assemble its own lines so that output from different
+    // threads is not mixed up within a line
+  static thread_local ThreadLine lines[2];
+  return lines[idx];
+} /* LogWriter::threadLine */
+
+
+void LogWriter::streamWrite(unsigned idx, const char* buf, size_t len)
+{
+  ThreadLine& tl = threadLine(idx);
+  const char* end = buf + len;
+  while (buf < end)
+  {
+    if (tl.buf.empty() && tl.at_line_start)
+    {
+      gettimeofday(&tl.tv, NULL);
+    }
+    const char* nl = static_cast<const char*>(memchr(buf, '\n', end - buf));
+    const char* chunk_end = (nl != nullptr) ? nl + 1 : end;
+    tl.buf.append(buf, chunk_end);
+    buf = chunk_end;
+    if ((nl != nullptr) || (tl.buf.size() >= LOG_SLOT_SIZE))
+    {
+      pushLine(tl);
+    }
+  }
+} /* LogWriter::streamWrite */
+
+
+void LogWriter::streamFlush(unsigned idx)
+{
+  ThreadLine& tl = threadLine(idx);
+  if (!tl.buf.empty())
+  {
+    pushLine(tl);
+  }
+} /* LogWriter::streamFlush */
+
+
+void LogWriter::pushLine(ThreadLine& tl)
+{
+  bool pushed = false;
+  size_t pos = 0;
+  while (pos < tl.buf.size())
+  {
+    size_t len = std::min(tl.buf.size() - pos,
+                          static_cast<size_t>(LOG_SLOT_SIZE));
+    const char* chunk = tl.buf.data() + pos;
+    const bool eol = (chunk[len-1] == '\n');
+    if (!tl.dropping)
+    {
+      if (ringPush(tl.tv, tl.at_line_start, chunk, len))
+      {
+        pushed = true;
+      }
+      else
+      {
+          // Drop the rest of the line and count it as one dropped line
+        m_dropped.fetch_add(1, std::memory_order_relaxed);
+        tl.dropping = true;
+      }
+    }
+    if (eol)
+    {
+      tl.dropping = false;
+    }
+    tl.at_line_start = eol;
+    pos += len;
+  }
+  tl.buf.clear();
+
+  if (pushed)
+  {
+    wakeWriter();
+  }
+} /* LogWriter::pushLine */
+
+
+bool LogWriter::ringPush(const struct timeval& tv, bool line_start,
+                         const char* buf, size_t len)
+{
+    // This is a bounded multi producer queue where each slot carry a
+    // sequence number telling if it is free or filled
+  size_t pos = m_enqueue_pos.load(std::memory_order_relaxed);
+  for (;;)
+  {
+    LogSlot& slot = m_ring[pos & (LOG_RING_SIZE-1)];
+    size_t seq = slot.seq.load(std::memory_order_acquire);
+    intptr_t diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos);
+    if (diff == 0)
+    {
+      if (m_enqueue_pos.compare_exchange_weak(pos, pos + 1,
+                                              std::memory_order_relaxed))
+      {
+        slot.tv = tv;
+        slot.line_start = line_start;
+        slot.len = len;
+        memcpy(slot.data, buf, len);
+        slot.seq.store(pos + 1, std::memory_order_release);
+        return true;
+      }
+    }
+    else if (diff < 0)
+    {
+      return false;
+    }
+    else
+    {
+      pos = m_enqueue_pos.load(std::memory_order_relaxed);
+    }
+  }
+} /* LogWriter::ringPush */
+
+
+bool LogWriter::ringEmpty(void) const
+{
+  const LogSlot& slot = m_ring[m_dequeue_pos & (LOG_RING_SIZE-1)];
+  return slot.seq.load(std::memory_order_acquire) != m_dequeue_pos + 1;
+} /* LogWriter::ringEmpty */
+
+
+void LogWriter::ringDrain(void)
+{
+  const std::lock_guard<std::mutex> lock(m_mutex);
+  bool written = false;
+  while (!ringEmpty())
+  {
+    LogSlot& slot = m_ring[m_dequeue_pos & (LOG_RING_SIZE-1)];
+    m_worker->logWriteRecord(slot.tv, slot.line_start, slot.data, slot.len);
+    m_last_eol = (slot.data[slot.len-1] == '\n');
+    slot.seq.store(m_dequeue_pos + LOG_RING_SIZE, std::memory_order_release);
+    ++m_dequeue_pos;
+    written = true;
+  }
+
+  uint64_t dropped = m_dropped.exchange(0, std::memory_order_relaxed);
+  if (dropped > 0)
+  {
+    struct timeval tv;
+    gettimeofday(&tv, NULL);
+    std::ostringstream ss;
+    if (!m_last_eol)
+    {
+      ss << "\n";
+    }
+    ss << "*** WARNING: " << dropped
+       << " log lines dropped since the log buffer was full\n";
+    const std::string msg(ss.str());
+    m_worker->logWriteRecord(tv, true, msg.data(), msg.size());
+    m_last_eol = true;
+    written = true;
+  }
+
+  if (written)
+  {
+    m_worker->logWriteFlush();
+    if (m_reopen_log)
+    {
+      m_worker->logReopen("Reopen requested");
+      m_reopen_log = false;
+    }
+  }
+} /* LogWriter::ringDrain */
+
+
+void LogWriter::wakeWriter(void)
+{
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  if (m_writer_waiting.exchange(false))
+  {
+    if (write(m_wakeup_pipefd[1], "", 1) == -1)
+    {
+        // The pipe is full so the writer will wake up anyway
+    }
+  }
+} /* LogWriter::wakeWriter */
+
+
 
 LogWriter::LogWriterWorkerFile::LogWriterWorkerFile(const std::string& filename)
   : m_logfile_name(filename)
@@ -329,6 +669,8 @@ LogWriter::LogWriterWorkerFile::LogWriterWorkerFile(const std::string& filename)
 void LogWriter::LogWriterWorkerFile::setTimestampFormat(const std::string& fmt)
 {
   m_tstamp_format = fmt;
+  m_tstamp_has_frac = (fmt.find("%f") != std::string::npos);
+  m_tstamp_sec = -1;
 } /* LogWriter::LogWriterWorkerFile::setTimestampFormat */
 
 
@@ -393,21 +735,9 @@ bool LogWriter::LogWriterWorkerFile::logWriteTimestamp(void)
   {
     struct timeval tv;
     gettimeofday(&tv, NULL);
-    std::string fmt(m_tstamp_format);
-    const std::string frac_code("%f");
-    size_t pos = fmt.find(frac_code);
-    if (pos != std::string::npos)
-    {
-      std::stringstream ss;
-      ss << std::setfill('0') << std::setw(3) << (tv.tv_usec / 1000);
-      fmt.replace(pos, frac_code.length(), ss.str());
-    }
-    struct tm tm;
-    char tstr[256];
-    size_t tlen = strftime(tstr, sizeof(tstr), fmt.c_str(),
-                           localtime_r(&tv.tv_sec, &tm));
-    ssize_t ret = write(m_logfd, tstr, tlen);
-    if (ret != static_cast<ssize_t>(tlen))
+    const std::string& tstamp = formatTimestamp(tv);
+    ssize_t ret = write(m_logfd, tstamp.data(), tstamp.size());
+    if (ret != static_cast<ssize_t>(tstamp.size()))
     {
       return false;
     }
@@ -421,6 +751,82 @@ bool LogWriter::LogWriterWorkerFile::logWriteTimestamp(void)
 } /* LogWriter::LogWriterWorkerFile::logWriteTimestamp */
 
 
+void LogWriter::LogWriterWorkerFile::logWriteRecord(const struct timeval& tv,
+                                                    bool line_start,
+                                                    const char* buf,
+                                                    size_t len)
+{
+  if (line_start && !m_tstamp_format.empty())
+  {
+    m_batch += formatTimestamp(tv);
+    m_batch += ": ";
+  }
+  m_batch.append(buf, len);
+} /* LogWriter::LogWriterWorkerFile::logWriteRecord */
+
+
+void LogWriter::LogWriterWorkerFile::logWriteFlush(void)
+{
+  if ((m_logfd != -1) && !m_batch.empty() &&
+      !writeAll(m_batch.data(), m_batch.size()))
+  {
+    logReopen("Write error");
+  }
+  m_batch.clear();
+} /* LogWriter::LogWriterWorkerFile::logWriteFlush */
+
+
+const std::string& LogWriter::LogWriterWorkerFile::formatTimestamp(
+    const struct timeval& tv)
+{
+    // The formatted timestamp is reused as long as the time, with the
+    // resolution used in the format, has not changed
+  const long msec = m_tstamp_has_frac ? tv.tv_usec / 1000 : 0;
+  if ((tv.tv_sec == m_tstamp_sec) && (msec == m_tstamp_msec))
+  {
+    return m_tstamp;
+  }
+
+  std::string fmt(m_tstamp_format);
+  const std::string frac_code("%f");
+  size_t pos = fmt.find(frac_code);
+  if (pos != std::string::npos)
+  {
+    std::stringstream ss;
+    ss << std::setfill('0') << std::setw(3) << msec;
+    fmt.replace(pos, frac_code.length(), ss.str());
+  }
+  struct tm tm;
+  char tstr[256];
+  size_t tlen = strftime(tstr, sizeof(tstr), fmt.c_str(),
+                         localtime_r(&tv.tv_sec, &tm));
+  m_tstamp.assign(tstr, tlen);
+  m_tstamp_sec = tv.tv_sec;
+  m_tstamp_msec = msec;
+  return m_tstamp;
+} /* LogWriter::LogWriterWorkerFile::formatTimestamp */
+
+
+bool LogWriter::LogWriterWorkerFile::writeAll(const char* buf, size_t len)
+{
+  while (len > 0)
+  {
+    ssize_t ret = write(m_logfd, buf, len);
+    if (ret <= 0)
+    {
+      if ((ret == -1) && (errno == EINTR))
+      {
+        continue;
+      }
+      return false;
+    }
+    buf += ret;
+    len -= ret;
+  }
+  return true;
+} /* LogWriter::LogWriterWorkerFile::writeAll */
+
+
 void LogWriter::LogWriterWorkerFile::logWrite(const char *buf)
 {
   if (m_logfd == -1)
@@ -469,12 +875,27 @@ void LogWriter::LogWriterWorkerFile::logWrite(const char *buf)
 void LogWriter::LogWriterWorkerSyslog::logWrite(const char* buf)
 {
   m_buf.append(buf);
+  logLines(m_buf);
+} /* LogWriter::LogWriterWorkerSyslog::logWrite */
+
 
+void LogWriter::LogWriterWorkerSyslog::logWriteRecord(const struct timeval& tv,
+                                                      bool line_start,
+                                                      const char* buf,
+                                                      size_t len)
+{
+  m_rec_buf.append(buf, len);
+  logLines(m_rec_buf);
+} /* LogWriter::LogWriterWorkerSyslog::logWriteRecord */
+
+
+void LogWriter::LogWriterWorkerSyslog::logLines(std::string& buf)
+{
   std::string::size_type pos;
-  while ((pos = m_buf.find ('\n')) != std::string::npos)
+  while ((pos = buf.find ('\n')) != std::string::npos)
   {
-    std::string line(m_buf, 0, pos);
-    m_buf.erase(0, pos + 1);
+    std::string line(buf, 0, pos);
+    buf.erase(0, pos + 1);
 
     int loglevel = LOG_INFO;
     if (line.rfind("*** ERROR", 0) == 0)
@@ -495,7 +916,7 @@ void LogWriter::LogWriterWorkerSyslog::logWrite(const char* buf)
     }
     syslog(LOG_DAEMON | loglevel, "%s", line.c_str());
   }
-} /* LogWriter::LogWriterWorkerSyslog::logWrite */
+} /* LogWriter::LogWriterWorkerSyslog::logLines */
 
 
 
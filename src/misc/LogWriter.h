@@ -34,10 +34,15 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
  *
  ****************************************************************************/
 
+#include <sys/time.h>
+
 #include <string>
 #include <thread>
 #include <atomic>
 #include <mutex>
+#include <memory>
+#include <streambuf>
+#include <cstdint>
 
 
 /****************************************************************************
@@ -113,6 +118,15 @@ to syslog.
 When writing to a file, each row will be prefixed with a timestamp.
 
 When writing to syslog, the timestamp format in SvxLink is ignored.
+
+Output written to std::cout and std::cerr does not go through the pipe.
+Complete lines are put in a lock free, bounded ring buffer together with the
+time when the line was started. The writer thread format the timestamps and
+write everything that has been queued in one go so a thread that log will
+never block. If the ring buffer is full, lines are dropped and a warning
+stating the number of dropped lines is written when there is room again.
+Output written directly to the file descriptors, e.g. using printf, still go
+through the pipe.
 */
 class LogWriter
 {
@@ -178,6 +192,27 @@ class LogWriter
     class LogWriterWorker;
     class LogWriterWorkerFile;
     class LogWriterWorkerSyslog;
+    class LogStreamBuf;
+
+    static const size_t LOG_RING_SIZE = 1024;   // Must be a power of two
+    static const size_t LOG_SLOT_SIZE = 240;
+
+    struct LogSlot
+    {
+      std::atomic<size_t> seq;
+      struct timeval      tv;
+      uint16_t            len;
+      bool                line_start;
+      char                data[LOG_SLOT_SIZE];
+    };
+
+    struct ThreadLine
+    {
+      std::string     buf;
+      struct timeval  tv;
+      bool            at_line_start = true;
+      bool            dropping      = false;
+    };
 
     std::string       m_dest_name;
     std::string       m_tstamp_format {"%c"};
@@ -186,9 +221,29 @@ class LogWriter
     std::thread       m_logthread;
     std::mutex        m_mutex;
     LogWriterWorker*  m_worker        {nullptr};
+    int               m_wakeup_pipefd[2] {-1, -1};
+    std::unique_ptr<LogSlot[]>  m_ring;
+    std::atomic<size_t>         m_enqueue_pos     {0};
+    size_t                      m_dequeue_pos     {0};
+    std::atomic<uint64_t>       m_dropped         {0};
+    std::atomic_bool            m_writer_waiting  {false};
+    bool                        m_last_eol        {true};
+    LogStreamBuf*               m_stdout_buf      {nullptr};
+    LogStreamBuf*               m_stderr_buf      {nullptr};
+    std::streambuf*             m_orig_stdout_buf {nullptr};
+    std::streambuf*             m_orig_stderr_buf {nullptr};
 
     void writerThread(void);
     void logFlush(void);
+    void streamWrite(unsigned idx, const char* buf, size_t len);
+    void streamFlush(unsigned idx);
+    void pushLine(ThreadLine& tl);
+    bool ringPush(const struct timeval& tv, bool line_start, const char* buf,
+                  size_t len);
+    bool ringEmpty(void) const;
+    void ringDrain(void);
+    void wakeWriter(void);
+    static ThreadLine& threadLine(unsigned idx);
 
 }; /* class LogWriter */
 
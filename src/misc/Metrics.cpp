@@ -0,0 +1,416 @@
+/**
+@file   Metrics.cpp
+@brief  Counters, gauges and histograms exported in the Prometheus format
+@author Tobias Blomberg / SM0SVX
+@date   2026-10-14
+
+\verbatim
+SvxLink - A Multi Purpose Voice Services System for Ham Radio Use
+Copyright (C) 2003-2026 Tobias Blomberg / SM0SVX
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+\endverbatim
+*/
+
+/****************************************************************************
+ *
+ * System Includes
+ *
+ ****************************************************************************/
+
+#include <algorithm>
+#include <cmath>
+#include <sstream>
+#include <iomanip>
+#include <limits>
+
+
+/****************************************************************************
+ *
+ * Project Includes
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Local Includes
+ *
+ ****************************************************************************/
+
+#include "Metrics.h"
+
+
+/****************************************************************************
+ *
+ * Namespaces to use
+ *
+ ****************************************************************************/
+
+using namespace SvxLink;
+
+
+/****************************************************************************
+ *
+ * Defines & typedefs
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Local class definitions
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Prototypes
+ *
+ ****************************************************************************/
+
+namespace {
+  void atomicAdd(std::atomic<double>& var, double value)
+  {
+    double old_value = var.load(std::memory_order_relaxed);
+    while (!var.compare_exchange_weak(old_value, old_value + value,
+                                      std::memory_order_relaxed))
+    {
+    }
+  } /* atomicAdd */
+};
+
+
+/****************************************************************************
+ *
+ * Exported Global Variables
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Local Global Variables
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Public member functions
+ *
+ ****************************************************************************/
+
+void MetricGauge::add(double value)
+{
+  atomicAdd(m_value, value);
+} /* MetricGauge::add */
+
+
+MetricHistogram::MetricHistogram(const std::vector<double>& bounds)
+  : m_bounds(bounds), m_buckets(new std::atomic<uint64_t>[bounds.size()+1]),
+    m_count(0), m_sum(0.0)
+{
+  clear();
+} /* MetricHistogram::MetricHistogram */
+
+
+void MetricHistogram::observe(double value)
+{
+  const size_t bucket =
+    std::lower_bound(m_bounds.begin(), m_bounds.end(), value) -
+    m_bounds.begin();
+  add(bucket, 1, value);
+} /* MetricHistogram::observe */
+
+
+void MetricHistogram::add(size_t bucket, uint64_t count, double sum)
+{
+  if (bucket > m_bounds.size())
+  {
+    bucket = m_bounds.size();
+  }
+  m_buckets[bucket].fetch_add(count, std::memory_order_relaxed);
+  m_count.fetch_add(count, std::memory_order_relaxed);
+  atomicAdd(m_sum, sum);
+} /* MetricHistogram::add */
+
+
+void MetricHistogram::clear(void)
+{
+  for (size_t i=0; i<=m_bounds.size(); ++i)
+  {
+    m_buckets[i].store(0, std::memory_order_relaxed);
+  }
+  m_count.store(0, std::memory_order_relaxed);
+  m_sum.store(0.0, std::memory_order_relaxed);
+} /* MetricHistogram::clear */
+
+
+Metrics* Metrics::instance(void)
+{
+  static Metrics metrics;
+  return &metrics;
+} /* Metrics::instance */
+
+
+std::vector<double> Metrics::exponentialBuckets(double start, double factor,
+                                                unsigned count)
+{
+  std::vector<double> bounds;
+  bounds.reserve(count);
+  for (unsigned i=0; i<count; ++i)
+  {
+    bounds.push_back(start);
+    start *= factor;
+  }
+  return bounds;
+} /* Metrics::exponentialBuckets */
+
+
+MetricCounter& Metrics::counter(const std::string& name,
+                                const std::string& help, const Labels& labels)
+{
+  const std::lock_guard<std::mutex> lock(m_mutex);
+  auto& metric = family(name, help, TYPE_COUNTER).counters[labelString(labels)];
+  if (metric == nullptr)
+  {
+    metric.reset(new MetricCounter);
+  }
+  return *metric;
+} /* Metrics::counter */
+
+
+MetricGauge& Metrics::gauge(const std::string& name, const std::string& help,
+                            const Labels& labels)
+{
+  const std::lock_guard<std::mutex> lock(m_mutex);
+  auto& metric = family(name, help, TYPE_GAUGE).gauges[labelString(labels)];
+  if (metric == nullptr)
+  {
+    metric.reset(new MetricGauge);
+  }
+  return *metric;
+} /* Metrics::gauge */
+
+
+MetricHistogram& Metrics::histogram(const std::string& name,
+                                    const std::string& help,
+                                    const std::vector<double>& bounds,
+                                    const Labels& labels)
+{
+  const std::lock_guard<std::mutex> lock(m_mutex);
+  Family& fam = family(name, help, TYPE_HISTOGRAM);
+  if (fam.histograms.empty())
+  {
+    fam.bounds = bounds;
+  }
+  auto& metric = fam.histograms[labelString(labels)];
+  if (metric == nullptr)
+  {
+    metric.reset(new MetricHistogram(fam.bounds));
+  }
+  return *metric;
+} /* Metrics::histogram */
+
+
+void Metrics::clear(const std::string& name)
+{
+  const std::lock_guard<std::mutex> lock(m_mutex);
+  auto it = m_families.find(name);
+  if (it != m_families.end())
+  {
+    it->second.counters.clear();
+    it->second.gauges.clear();
+    it->second.histograms.clear();
+  }
+} /* Metrics::clear */
+
+
+void Metrics::write(std::ostream& os)
+{
+  collect();
+
+  const std::lock_guard<std::mutex> lock(m_mutex);
+  for (const auto& item : m_families)
+  {
+    const std::string& name = item.first;
+    const Family& fam = item.second;
+    if (fam.counters.empty() && fam.gauges.empty() && fam.histograms.empty())
+    {
+      continue;
+    }
+
+    os << "# HELP " << name << " " << fam.help << "\n";
+    switch (fam.type)
+    {
+      case TYPE_COUNTER:
+        os << "# TYPE " << name << " counter\n";
+        for (const auto& series : fam.counters)
+        {
+          os << name << series.first << " " << series.second->value() << "\n";
+        }
+        break;
+
+      case TYPE_GAUGE:
+        os << "# TYPE " << name << " gauge\n";
+        for (const auto& series : fam.gauges)
+        {
+          os << name << series.first << " ";
+          writeValue(os, series.second->value());
+          os << "\n";
+        }
+        break;
+
+      case TYPE_HISTOGRAM:
+        os << "# TYPE " << name << " histogram\n";
+        for (const auto& series : fam.histograms)
+        {
+          const MetricHistogram& hist = *series.second;
+          uint64_t cumulative = 0;
+          for (size_t i=0; i<=hist.bounds().size(); ++i)
+          {
+            cumulative += hist.bucketCount(i);
+            std::ostringstream le;
+            if (i < hist.bounds().size())
+            {
+              le << "le=\"";
+              writeValue(le, hist.bounds()[i]);
+              le << "\"";
+            }
+            else
+            {
+              le << "le=\"+Inf\"";
+            }
+            os << name << "_bucket" << joinLabels(series.first, le.str())
+               << " " << cumulative << "\n";
+          }
+          os << name << "_sum" << series.first << " ";
+          writeValue(os, hist.sum());
+          os << "\n";
+          os << name << "_count" << series.first << " " << cumulative << "\n";
+        }
+        break;
+    }
+  }
+} /* Metrics::write */
+
+
+/****************************************************************************
+ *
+ * Protected member functions
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Private member functions
+ *
+ ****************************************************************************/
+
+Metrics::Family& Metrics::family(const std::string& name,
+                                 const std::string& help, Type type)
+{
+  auto it = m_families.find(name);
+  if (it == m_families.end())
+  {
+    it = m_families.insert(std::make_pair(name, Family())).first;
+    it->second.help = help;
+    it->second.type = type;
+  }
+  return it->second;
+} /* Metrics::family */
+
+
+std::string Metrics::labelString(const Labels& labels)
+{
+  if (labels.empty())
+  {
+    return std::string();
+  }
+  std::string str("{");
+  for (const auto& label : labels)
+  {
+    if (str.size() > 1)
+    {
+      str += ",";
+    }
+    str += label.first;
+    str += "=\"";
+    for (const char ch : label.second)
+    {
+      switch (ch)
+      {
+        case '\\':
+          str += "\\\\";
+          break;
+        case '"':
+          str += "\\\"";
+          break;
+        case '\n':
+          str += "\\n";
+          break;
+        default:
+          str += ch;
+          break;
+      }
+    }
+    str += "\"";
+  }
+  str += "}";
+  return str;
+} /* Metrics::labelString */
+
+
+std::string Metrics::joinLabels(const std::string& labels,
+                                const std::string& extra)
+{
+  if (labels.empty())
+  {
+    return "{" + extra + "}";
+  }
+  return labels.substr(0, labels.size()-1) + "," + extra + "}";
+} /* Metrics::joinLabels */
+
+
+void Metrics::writeValue(std::ostream& os, double value)
+{
+  if (std::isnan(value))
+  {
+    os << "NaN";
+  }
+  else if (std::isinf(value))
+  {
+    os << ((value > 0.0) ? "+Inf" : "-Inf");
+  }
+  else
+  {
+    os << std::setprecision(std::numeric_limits<double>::digits10 + 1)
+       << value;
+  }
+} /* Metrics::writeValue */
+
+
+/*
+ * This file has not been truncated
+ */
@@ -0,0 +1,405 @@
+/**
+@file   Metrics.h
+@brief  Counters, gauges and histograms exported in the Prometheus format
+@author Tobias Blomberg / SM0SVX
+@date   2026-10-14
+
+\verbatim
+SvxLink - A Multi Purpose Voice Services System for Ham Radio Use
+Copyright (C) 2003-2026 Tobias Blomberg / SM0SVX
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+\endverbatim
+*/
+
+#ifndef METRICS_INCLUDED
+#define METRICS_INCLUDED
+
+
+/****************************************************************************
+ *
+ * System Includes
+ *
+ ****************************************************************************/
+
+#include <sigc++/sigc++.h>
+
+#include <string>
+#include <vector>
+#include <map>
+#include <atomic>
+#include <mutex>
+#include <memory>
+#include <ostream>
+#include <cstdint>
+
+
+/****************************************************************************
+ *
+ * Project Includes
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Local Includes
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Forward declarations
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Namespace
+ *
+ ****************************************************************************/
+
+namespace SvxLink
+{
+
+
+/****************************************************************************
+ *
+ * Forward declarations of classes inside of the declared namespace
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Defines & typedefs
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Exported Global Variables
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Class definitions
+ *
+ ****************************************************************************/
+
+/**
+@brief  A monotonically increasing counter
+@author Tobias Blomberg / SM0SVX
+@date   2026-10-14
+
+The counter is updated using relaxed atomic operations so it is safe, and
+cheap, to update it from any thread.
+*/
+class MetricCounter
+{
+  public:
+    MetricCounter(void) : m_value(0) {}
+    MetricCounter(const MetricCounter&) = delete;
+    MetricCounter& operator=(const MetricCounter&) = delete;
+
+    /**
+     * @brief   Increase the counter
+     * @param   n The amount to increase the counter with
+     */
+    void inc(uint64_t n=1) { m_value.fetch_add(n, std::memory_order_relaxed); }
+
+    /**
+     * @brief   Set the counter value
+     * @param   value The new value
+     *
+     * This is used to export a counter that is kept somewhere else. The
+     * value must never decrease.
+     */
+    void set(uint64_t value)
+    {
+      m_value.store(value, std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief   Get the counter value
+     * @return  Returns the current value
+     */
+    uint64_t value(void) const
+    {
+      return m_value.load(std::memory_order_relaxed);
+    }
+
+  private:
+    std::atomic<uint64_t> m_value;
+
+};  /* class MetricCounter */
+
+
+/**
+@brief  A value that can go up and down
+@author Tobias Blomberg / SM0SVX
+@date   2026-10-14
+*/
+class MetricGauge
+{
+  public:
+    MetricGauge(void) : m_value(0.0) {}
+    MetricGauge(const MetricGauge&) = delete;
+    MetricGauge& operator=(const MetricGauge&) = delete;
+
+    /**
+     * @brief   Set the gauge value
+     * @param   value The new value
+     */
+    void set(double value) { m_value.store(value, std::memory_order_relaxed); }
+
+    /**
+     * @brief   Add to the gauge value
+     * @param   value The value to add, which may be negative
+     */
+    void add(double value);
+
+    /**
+     * @brief   Get the gauge value
+     * @return  Returns the current value
+     */
+    double value(void) const { return m_value.load(std::memory_order_relaxed); }
+
+  private:
+    std::atomic<double> m_value;
+
+};  /* class MetricGauge */
+
+
+/**
+@brief  A histogram with fixed buckets
+@author Tobias Blomberg / SM0SVX
+@date   2026-10-14
+
+Each observation is counted in the first bucket that has an upper bound
+larger than or equal to the value. The bucket counts are kept per bucket and
+are accumulated when the histogram is written.
+*/
+class MetricHistogram
+{
+  public:
+    /**
+     * @brief   Constructor
+     * @param   bounds The upper bounds of the buckets in increasing order
+     */
+    explicit MetricHistogram(const std::vector<double>& bounds);
+    MetricHistogram(const MetricHistogram&) = delete;
+    MetricHistogram& operator=(const MetricHistogram&) = delete;
+
+    /**
+     * @brief   Add an observation
+     * @param   value The observed value
+     */
+    void observe(double value);
+
+    /**
+     * @brief   Add a number of observations to a bucket
+     * @param   bucket  The bucket index, bounds().size() for the +Inf bucket
+     * @param   count   The number of observations
+     * @param   sum     The sum of the observed values
+     *
+     * This is used to export histograms that are kept somewhere else.
+     */
+    void add(size_t bucket, uint64_t count, double sum);
+
+    /**
+     * @brief   Set all counts to zero
+     */
+    void clear(void);
+
+    const std::vector<double>& bounds(void) const { return m_bounds; }
+    uint64_t bucketCount(size_t bucket) const
+    {
+      return m_buckets[bucket].load(std::memory_order_relaxed);
+    }
+    uint64_t count(void) const
+    {
+      return m_count.load(std::memory_order_relaxed);
+    }
+    double sum(void) const { return m_sum.load(std::memory_order_relaxed); }
+
+  private:
+    const std::vector<double>               m_bounds;
+    std::unique_ptr<std::atomic<uint64_t>[]> m_buckets;
+    std::atomic<uint64_t>                   m_count;
+    std::atomic<double>                     m_sum;
+
+};  /* class MetricHistogram */
+
+
+/**
+@brief  A registry of metrics exported in the Prometheus text format
+@author Tobias Blomberg / SM0SVX
+@date   2026-10-14
+
+Metrics are registered by name and a set of labels. Registering the same
+name and labels again return the same metric object so the pointer, or
+reference, returned should be kept and used in the code that update the
+metric. Looking up a metric is protected by a mutex but updating it is not.
+
+Values that are cheaper to read when the metrics are written, like
+statistics kept by other classes, are set by a slot connected to the
+collect signal. That signal is emitted each time the metrics are written.
+
+\code
+  SvxLink::MetricCounter& rx = SvxLink::Metrics::instance()->counter(
+      "svxlink_squelch_open_total", "Number of squelch openings",
+      {{"logic", name()}});
+  rx.inc();
+\endcode
+*/
+class Metrics
+{
+  public:
+    typedef std::map<std::string, std::string> Labels;
+
+    /**
+     * @brief   Get the process wide metrics registry
+     * @return  Returns the registry
+     */
+    static Metrics* instance(void);
+
+    /**
+     * @brief   Create exponentially spaced histogram bucket bounds
+     * @param   start   The upper bound of the first bucket
+     * @param   factor  The factor between two bucket bounds
+     * @param   count   The number of buckets
+     * @return  Returns a vector with the bucket bounds
+     */
+    static std::vector<double> exponentialBuckets(double start, double factor,
+                                                  unsigned count);
+
+    Metrics(void) {}
+    Metrics(const Metrics&) = delete;
+    Metrics& operator=(const Metrics&) = delete;
+
+    /**
+     * @brief   Get or create a counter
+     * @param   name    The metric name
+     * @param   help    The help text for the metric
+     * @param   labels  The labels for this time series
+     * @return  Returns the counter
+     */
+    MetricCounter& counter(const std::string& name, const std::string& help,
+                           const Labels& labels=Labels());
+
+    /**
+     * @brief   Get or create a gauge
+     * @param   name    The metric name
+     * @param   help    The help text for the metric
+     * @param   labels  The labels for this time series
+     * @return  Returns the gauge
+     */
+    MetricGauge& gauge(const std::string& name, const std::string& help,
+                       const Labels& labels=Labels());
+
+    /**
+     * @brief   Get or create a histogram
+     * @param   name    The metric name
+     * @param   help    The help text for the metric
+     * @param   bounds  The upper bounds of the buckets
+     * @param   labels  The labels for this time series
+     * @return  Returns the histogram
+     *
+     * The bucket bounds given when the first time series for a name is
+     * created is used for all time series with the same name.
+     */
+    MetricHistogram& histogram(const std::string& name,
+                               const std::string& help,
+                               const std::vector<double>& bounds,
+                               const Labels& labels=Labels());
+
+    /**
+     * @brief   Remove all time series for a metric name
+     * @param   name The metric name
+     *
+     * This is used for metrics that are labeled by something that come and
+     * go, like a client, so that they are created again by the collect
+     * handler. References to the removed metrics become invalid.
+     */
+    void clear(const std::string& name);
+
+    /**
+     * @brief   Write all metrics in the Prometheus text exposition format
+     * @param   os The stream to write to
+     *
+     * The collect signal is emitted before the metrics are written.
+     */
+    void write(std::ostream& os);
+
+    /**
+     * @brief   The content type of the text written by the write function
+     */
+    static const char* contentType(void)
+    {
+      return "text/plain; version=0.0.4; charset=utf-8";
+    }
+
+    /**
+     * @brief   A signal that is emitted before the metrics are written
+     */
+    sigc::signal<void()> collect;
+
+  private:
+    typedef enum
+    {
+      TYPE_COUNTER, TYPE_GAUGE, TYPE_HISTOGRAM
+    } Type;
+    struct Family
+    {
+      std::string                                       help;
+      Type                                              type;
+      std::vector<double>                               bounds;
+      std::map<std::string, std::unique_ptr<MetricCounter>>   counters;
+      std::map<std::string, std::unique_ptr<MetricGauge>>     gauges;
+      std::map<std::string, std::unique_ptr<MetricHistogram>> histograms;
+    };
+
+    std::mutex                    m_mutex;
+    std::map<std::string, Family> m_families;
+
+    Family& family(const std::string& name, const std::string& help,
+                   Type type);
+    static std::string labelString(const Labels& labels);
+    static std::string joinLabels(const std::string& labels,
+                                  const std::string& extra);
+    static void writeValue(std::ostream& os, double value);
+
+};  /* class Metrics */
+
+
+} /* namespace */
+
+#endif /* METRICS_INCLUDED */
+
+/*
+ * This file has not been truncated
+ */
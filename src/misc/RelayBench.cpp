@@ -0,0 +1,220 @@
+/**
+@file   RelayBench.cpp
+@brief  Measurement helpers shared by the relay load generators
+@author Tobias Blomberg / SM0SVX
+@date   2026-10-14
+
+\verbatim
+SvxLink - A Multi Purpose Voice Services System for Ham Radio Use
+Copyright (C) 2003-2026 Tobias Blomberg / SM0SVX
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+\endverbatim
+*/
+
+/****************************************************************************
+ *
+ * System Includes
+ *
+ ****************************************************************************/
+
+#include <unistd.h>
+#include <sys/time.h>
+#include <sys/resource.h>
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <sstream>
+#include <string>
+
+
+/****************************************************************************
+ *
+ * Project Includes
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Local Includes
+ *
+ ****************************************************************************/
+
+#include "RelayBench.h"
+
+
+/****************************************************************************
+ *
+ * Namespaces to use
+ *
+ ****************************************************************************/
+
+using namespace SvxLink;
+
+
+/****************************************************************************
+ *
+ * Defines & typedefs
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Local class definitions
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Prototypes
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Exported Global Variables
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Local Global Variables
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Public member functions
+ *
+ ****************************************************************************/
+
+void LatencyHistogram::add(double ms)
+{
+  size_t idx = static_cast<size_t>(std::max(0.0, ms) * 10.0);
+  m_buckets[std::min(idx, BUCKET_CNT - 1)] += 1;
+  m_cnt += 1;
+  m_sum += ms;
+  m_min = std::min(m_min, ms);
+  m_max = std::max(m_max, ms);
+} /* LatencyHistogram::add */
+
+
+void LatencyHistogram::clear(void)
+{
+  std::fill(m_buckets.begin(), m_buckets.end(), 0);
+  m_cnt = 0;
+  m_sum = 0.0;
+  m_min = 1.0e300;
+  m_max = 0.0;
+} /* LatencyHistogram::clear */
+
+
+double LatencyHistogram::percentile(double p) const
+{
+  if (m_cnt == 0)
+  {
+    return 0.0;
+  }
+  const uint64_t limit = static_cast<uint64_t>(std::ceil(p * m_cnt));
+  uint64_t acc = 0;
+  for (size_t idx=0; idx<BUCKET_CNT; ++idx)
+  {
+    acc += m_buckets[idx];
+    if (acc >= limit)
+    {
+      return std::min((idx + 1) / 10.0, m_max);
+    }
+  }
+  return m_max;
+} /* LatencyHistogram::percentile */
+
+
+bool SvxLink::processCpuUsec(pid_t pid, uint64_t& usec)
+{
+  if (pid <= 0)
+  {
+    return false;
+  }
+  std::ifstream ifs("/proc/" + std::to_string(pid) + "/stat");
+  std::string stat;
+  if (!std::getline(ifs, stat))
+  {
+    return false;
+  }
+    // The process name may contain spaces so skip past it before parsing
+    // the utime (14) and stime (15) fields
+  const size_t pos = stat.rfind(')');
+  if (pos == std::string::npos)
+  {
+    return false;
+  }
+  std::istringstream is(stat.substr(pos + 1));
+  std::string field;
+  for (int i=3; i<14; ++i)
+  {
+    is >> field;
+  }
+  uint64_t utime = 0, stime = 0;
+  if (!(is >> utime >> stime))
+  {
+    return false;
+  }
+  usec = (utime + stime) * 1000000ULL / sysconf(_SC_CLK_TCK);
+  return true;
+} /* SvxLink::processCpuUsec */
+
+
+uint64_t SvxLink::ownCpuUsec(void)
+{
+  struct rusage ru;
+  getrusage(RUSAGE_SELF, &ru);
+  return (ru.ru_utime.tv_sec + ru.ru_stime.tv_sec) * 1000000ULL +
+         ru.ru_utime.tv_usec + ru.ru_stime.tv_usec;
+} /* SvxLink::ownCpuUsec */
+
+
+
+/****************************************************************************
+ *
+ * Protected member functions
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Private member functions
+ *
+ ****************************************************************************/
+
+
+
+/*
+ * This file has not been truncated
+ */
@@ -0,0 +1,180 @@
+/**
+@file   RelayBench.h
+@brief  Measurement helpers shared by the relay load generators
+@author Tobias Blomberg / SM0SVX
+@date   2026-10-14
+
+\verbatim
+SvxLink - A Multi Purpose Voice Services System for Ham Radio Use
+Copyright (C) 2003-2026 Tobias Blomberg / SM0SVX
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+\endverbatim
+*/
+
+#ifndef RELAY_BENCH_INCLUDED
+#define RELAY_BENCH_INCLUDED
+
+
+/****************************************************************************
+ *
+ * System Includes
+ *
+ ****************************************************************************/
+
+#include <vector>
+#include <cstdint>
+#include <sys/types.h>
+
+
+/****************************************************************************
+ *
+ * Project Includes
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Local Includes
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Forward declarations
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Namespace
+ *
+ ****************************************************************************/
+
+namespace SvxLink
+{
+
+
+/****************************************************************************
+ *
+ * Forward declarations of classes inside of the declared namespace
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Defines & typedefs
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Exported Global Variables
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Class definitions
+ *
+ ****************************************************************************/
+
+/**
+@brief  A latency histogram with a resolution of 0.1ms
+@author Tobias Blomberg / SM0SVX
+@date   2026-10-14
+
+A histogram is used instead of storing each sample so that long runs with
+many nodes use a fixed amount of memory. The same histogram is used by the
+load generators for both svxreflector and svxserver so that the numbers they
+print can be compared directly.
+*/
+class LatencyHistogram
+{
+  public:
+    LatencyHistogram(void) : m_buckets(BUCKET_CNT, 0) {}
+
+    /**
+     * @brief   Add a latency sample
+     * @param   ms The latency in milliseconds
+     */
+    void add(double ms);
+
+    /**
+     * @brief   Remove all samples
+     */
+    void clear(void);
+
+    uint64_t count(void) const { return m_cnt; }
+    double min(void) const { return (m_cnt > 0) ? m_min : 0.0; }
+    double max(void) const { return m_max; }
+    double mean(void) const { return (m_cnt > 0) ? m_sum / m_cnt : 0.0; }
+
+    /**
+     * @brief   Get a percentile
+     * @param   p The percentile as a fraction (e.g. 0.95)
+     * @return  Returns the latency in milliseconds
+     */
+    double percentile(double p) const;
+
+  private:
+      // Up to ten seconds with 0.1ms resolution
+    static const size_t BUCKET_CNT = 100000;
+
+    std::vector<uint64_t> m_buckets;
+    uint64_t              m_cnt = 0;
+    double                m_sum = 0.0;
+    double                m_min = 1.0e300;
+    double                m_max = 0.0;
+
+};  /* class LatencyHistogram */
+
+
+/**
+ * @brief   Read the CPU time used by another process
+ * @param   pid   The process id
+ * @param   usec  Set to the user plus system time in microseconds
+ * @return  Returns \em true on success or \em false if the process could
+ *          not be read
+ */
+bool processCpuUsec(pid_t pid, uint64_t& usec);
+
+/**
+ * @brief   Get the CPU time used by this process
+ * @return  Returns the user plus system time in microseconds
+ */
+uint64_t ownCpuUsec(void);
+
+
+} /* namespace SvxLink */
+
+#endif /* RELAY_BENCH_INCLUDED */
+
+
+/*
+ * This file has not been truncated
+ */
@@ -34,6 +34,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 
 #include <iostream>
 #include <cassert>
+#include <algorithm>
 
 #include <sigc++/sigc++.h>
 
@@ -66,8 +67,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 #include <AsyncAudioFifo.h>
 #include <AsyncAudioValve.h>
 #include <AsyncAudioSplitter.h>
-#include <AsyncAudioInterpolator.h>
-#include <AsyncAudioDecimator.h>
+#include <AsyncAudioResampler.h>
 
 
 /****************************************************************************
@@ -79,7 +79,6 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 #include "MyMessageBox.h"
 #include "Settings.h"
 #include "ComDialog.h"
-#include "multirate_filter_coeff.h"
 
 
 
@@ -315,29 +314,15 @@ void ComDialog::init(const QString& remote_name)
   prev_src->registerSink(rem_audio_valve);
   prev_src = rem_audio_valve;
 
-#if (INTERNAL_SAMPLE_RATE == 8000)  
-  if (spkr_audio_io->sampleRate() > 8000)
-#endif
+    // Convert the 8kHz EchoLink audio to the sound card sample rate, but
+    // never lower than the internal sample rate
+  const int spkr_rate = max(spkr_audio_io->sampleRate(),
+                            INTERNAL_SAMPLE_RATE);
+  if (spkr_rate != 8000)
   {
-      // Interpolate sample rate to 16kHz
-    AudioInterpolator *i1 = new AudioInterpolator(2, coeff_16_8,
-                                                  coeff_16_8_taps);
-    prev_src->registerSink(i1, true);
-    prev_src = i1;
-  }
-
-  if (spkr_audio_io->sampleRate() > 16000)
-  {
-      // Interpolate sample rate to 48kHz
-#if (INTERNAL_SAMPLE_RATE == 8000)
-    AudioInterpolator *i2 = new AudioInterpolator(3, coeff_48_16_int,
-                                                  coeff_48_16_int_taps);
-#else
-    AudioInterpolator *i2 = new AudioInterpolator(3, coeff_48_16,
-                                                  coeff_48_16_taps);
-#endif
-    prev_src->registerSink(i2, true);
-    prev_src = i2;
+    AudioResampler *spkr_resampler = new AudioResampler(8000, spkr_rate);
+    prev_src->registerSink(spkr_resampler, true);
+    prev_src = spkr_resampler;
   }
   
   prev_src->registerSink(spkr_audio_io);
@@ -346,32 +331,21 @@ void ComDialog::init(const QString& remote_name)
     // Mic audio audio pipe starts here
   prev_src = mic_audio_io;
 
-    // We need a buffer before the Decimators
+    // We need a buffer before the resampler
   AudioFifo *mic_fifo = new AudioFifo(2048);
   prev_src->registerSink(mic_fifo, true);
   prev_src = mic_fifo;
 
-    // If the sound card sample rate is higher than 16kHz (48kHz assumed),
-    // decimate it down to 16kHz
-  if (mic_audio_io->sampleRate() > 16000)
+    // If the sound card sample rate is higher than the internal sample rate,
+    // convert it down in one step
+  if (mic_audio_io->sampleRate() > INTERNAL_SAMPLE_RATE)
   {
-    AudioDecimator *d1 = new AudioDecimator(3, coeff_48_16_wide,
-					    coeff_48_16_wide_taps);
-    prev_src->registerSink(d1, true);
-    prev_src = d1;
+    AudioResampler *mic_resampler = new AudioResampler(
+        mic_audio_io->sampleRate(), INTERNAL_SAMPLE_RATE);
+    prev_src->registerSink(mic_resampler, true);
+    prev_src = mic_resampler;
   }
 
-#if (INTERNAL_SAMPLE_RATE < 16000)
-    // If the sound card sample rate is higher than 8kHz (16 or 48kHz assumed)
-    // decimate it down to 8kHz.
-  if (mic_audio_io->sampleRate() > 8000)
-  {
-    AudioDecimator *d2 = new AudioDecimator(2, coeff_16_8, coeff_16_8_taps);
-    prev_src->registerSink(d2, true);
-    prev_src = d2;
-  }
-#endif
-
   tx_audio_splitter = new AudioSplitter;
   prev_src->registerSink(tx_audio_splitter);
   prev_src = 0;
@@ -399,8 +373,7 @@ void ComDialog::init(const QString& remote_name)
   vox_delay->setValue(vox->delay());
   
 #if INTERNAL_SAMPLE_RATE == 16000
-  AudioDecimator *down_sampler = new AudioDecimator(
-          2, coeff_16_8, coeff_16_8_taps);
+  AudioResampler *down_sampler = new AudioResampler(16000, 8000);
   tx_audio_splitter->addSink(down_sampler, true);
   ptt_valve = new AudioValve;
   down_sampler->registerSink(ptt_valve);
@@ -0,0 +1,176 @@
+/**
+@file	 EchoLinkDirectoryFilterModel.cpp
+@brief   A proxy model used to search the EchoLink station lists
+@author  Tobias Blomberg / SM0SVX
+@date	 2026-10-14
+
+\verbatim
+Qtel - The Qt EchoLink client
+Copyright (C) 2003-2026 Tobias Blomberg / SM0SVX
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+\endverbatim
+*/
+
+
+
+/****************************************************************************
+ *
+ * System Includes
+ *
+ ****************************************************************************/
+
+#include <QtGlobal>
+
+
+/****************************************************************************
+ *
+ * Project Includes
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Local Includes
+ *
+ ****************************************************************************/
+
+#include "EchoLinkDirectoryModel.h"
+#include "EchoLinkDirectoryFilterModel.h"
+
+
+
+/****************************************************************************
+ *
+ * Namespaces to use
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Defines & typedefs
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Local class definitions
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Prototypes
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Exported Global Variables
+ *
+ ****************************************************************************/
+
+
+
+
+/****************************************************************************
+ *
+ * Local Global Variables
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Public member functions
+ *
+ ****************************************************************************/
+
+EchoLinkDirectoryFilterModel::EchoLinkDirectoryFilterModel(QObject *parent)
+  : QSortFilterProxyModel(parent), dir_model(0)
+{
+  setDynamicSortFilter(true);
+} /* EchoLinkDirectoryFilterModel::EchoLinkDirectoryFilterModel */
+
+
+EchoLinkDirectoryFilterModel::~EchoLinkDirectoryFilterModel(void)
+{
+
+} /* EchoLinkDirectoryFilterModel::~EchoLinkDirectoryFilterModel */
+
+
+void EchoLinkDirectoryFilterModel::setSourceModel(
+    QAbstractItemModel *source_model)
+{
+  dir_model = qobject_cast<EchoLinkDirectoryModel*>(source_model);
+  Q_ASSERT((source_model == 0) || (dir_model != 0));
+  QSortFilterProxyModel::setSourceModel(source_model);
+} /* EchoLinkDirectoryFilterModel::setSourceModel */
+
+
+void EchoLinkDirectoryFilterModel::setSearchString(const QString &str)
+{
+  QString new_str = str.trimmed().toLower();
+  if (new_str == search_str)
+  {
+    return;
+  }
+  search_str = new_str;
+  invalidateFilter();
+} /* EchoLinkDirectoryFilterModel::setSearchString */
+
+
+
+/****************************************************************************
+ *
+ * Protected member functions
+ *
+ ****************************************************************************/
+
+bool EchoLinkDirectoryFilterModel::filterAcceptsRow(int source_row,
+    const QModelIndex &source_parent) const
+{
+  Q_UNUSED(source_parent);
+  if (search_str.isEmpty() || (dir_model == 0))
+  {
+    return true;
+  }
+  return dir_model->searchKey(source_row).contains(search_str);
+} /* EchoLinkDirectoryFilterModel::filterAcceptsRow */
+
+
+
+/****************************************************************************
+ *
+ * Private member functions
+ *
+ ****************************************************************************/
+
+
+
+/*
+ * This file has not been truncated
+ */
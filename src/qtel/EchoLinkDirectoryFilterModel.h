@@ -0,0 +1,173 @@
+/**
+@file	 EchoLinkDirectoryFilterModel.h
+@brief   A proxy model used to search the EchoLink station lists
+@author  Tobias Blomberg / SM0SVX
+@date	 2026-10-14
+
+\verbatim
+Qtel - The Qt EchoLink client
+Copyright (C) 2003-2026 Tobias Blomberg / SM0SVX
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+\endverbatim
+*/
+
+
+#ifndef ECHOLINK_DIRECTORY_FILTER_MODEL_INCLUDED
+#define ECHOLINK_DIRECTORY_FILTER_MODEL_INCLUDED
+
+
+/****************************************************************************
+ *
+ * System Includes
+ *
+ ****************************************************************************/
+
+#include <QSortFilterProxyModel>
+#include <QString>
+
+
+/****************************************************************************
+ *
+ * Project Includes
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Local Includes
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Forward declarations
+ *
+ ****************************************************************************/
+
+class EchoLinkDirectoryModel;
+
+
+/****************************************************************************
+ *
+ * Namespace
+ *
+ ****************************************************************************/
+
+//namespace MyNameSpace
+//{
+
+
+/****************************************************************************
+ *
+ * Forward declarations of classes inside of the declared namespace
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Defines & typedefs
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Exported Global Variables
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Class definitions
+ *
+ ****************************************************************************/
+
+/**
+@brief	A proxy model used to search the EchoLink station lists
+@author Tobias Blomberg / SM0SVX
+@date   2026-10-14
+
+This proxy model show the stations of an EchoLinkDirectoryModel that match a
+search string. A station match if its callsign, description or node id
+contain the search string, ignoring case. The precomputed search keys of the
+source model are used so that no strings have to be created when filtering.
+Since the source model only report the rows that actually changed when the
+station list is refreshed, only those rows are filtered again.
+*/
+class EchoLinkDirectoryFilterModel : public QSortFilterProxyModel
+{
+  Q_OBJECT
+
+  public:
+    /**
+     * @brief 	Default constuctor
+     * @param   parent The parent object
+     */
+    EchoLinkDirectoryFilterModel(QObject *parent = 0);
+
+    /**
+     * @brief 	Destructor
+     */
+    ~EchoLinkDirectoryFilterModel(void);
+
+    /**
+     * @brief   Set the source model
+     * @param   source_model The model to filter
+     *
+     * The source model must be an EchoLinkDirectoryModel.
+     */
+    virtual void setSourceModel(QAbstractItemModel *source_model);
+
+  public slots:
+    /**
+     * @brief   Set the search string
+     * @param   str The string to search for. Empty to show all stations.
+     */
+    void setSearchString(const QString &str);
+
+  protected:
+    virtual bool filterAcceptsRow(int source_row,
+                                  const QModelIndex &source_parent) const;
+
+  private:
+    EchoLinkDirectoryModel *dir_model;
+    QString                 search_str;
+
+    EchoLinkDirectoryFilterModel(const EchoLinkDirectoryFilterModel&);
+    EchoLinkDirectoryFilterModel& operator=(
+        const EchoLinkDirectoryFilterModel&);
+
+};  /* class EchoLinkDirectoryFilterModel */
+
+
+//} /* namespace */
+
+#endif /* ECHOLINK_DIRECTORY_FILTER_MODEL_INCLUDED */
+
+
+
+/*
+ * This file has not been truncated
+ */
@@ -36,6 +36,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 
 #include <algorithm>
 #include <iostream>
+#include <iterator>
 
 #include <QtAlgorithms>
 #include <QtGlobal>
@@ -131,92 +132,97 @@ EchoLinkDirectoryModel::~EchoLinkDirectoryModel(void)
 
 
 void EchoLinkDirectoryModel::updateStationList(
-				    const list<StationData> &stn_list)
+				    const vector<StationData> &stn_list)
 {
-#if QT_VERSION >= 0x050e00
-  QList<StationData> updated_stations(stn_list.begin(), stn_list.end());
-  std::stable_sort(updated_stations.begin(), updated_stations.end());
-#else
-  QList<StationData> updated_stations =
-      QList<StationData>::fromStdList(stn_list);
-  qStableSort(updated_stations);
-#endif
-  
-  //cout << "### updated_stations=" << updated_stations.count() << endl;  
-  
-  int row = 0;
-  while (!updated_stations.isEmpty() && (row < stations.count()))
+    // Sort pointers to the stations instead of copying the whole list.
+    // Only stations that are new in the list are copied into the model.
+  vector<const StationData*> updated_stations;
+  updated_stations.reserve(stn_list.size());
+  for (const auto& stn : stn_list)
   {
-    const StationData &updated_stn = updated_stations.first();
-    StationData &stn = stations[row];
-    if (updated_stn.callsign() == stn.callsign())
-    {
-      if (updated_stn.description() != stn.description())
-      {
-	QModelIndex stn_index = index(row, 1);
-	stn.setDescription(updated_stn.description());
-	dataChanged(stn_index, stn_index);
-      }
-      if (updated_stn.status() != stn.status())
-      {
-	QModelIndex stn_index = index(row, 2);
-	stn.setStatus(updated_stn.status());
-	dataChanged(stn_index, stn_index);
-      }
-      if (updated_stn.time() != stn.time())
+    updated_stations.push_back(&stn);
+  }
+  std::stable_sort(updated_stations.begin(), updated_stations.end(),
+      [](const StationData* lhs, const StationData* rhs)
       {
-	QModelIndex stn_index = index(row, 3);
-	stn.setTime(updated_stn.time());
-	dataChanged(stn_index, stn_index);
-      }
-      if (updated_stn.id() != stn.id())
+        return *lhs < *rhs;
+      });
+
+    // Walk through both sorted lists. Consecutive changed rows are reported
+    // using one dataChanged notification and consecutive new or removed
+    // stations using one row insert or remove notification.
+  int changed_first = -1;
+  int changed_last = -1;
+  auto flush_changed = [&]()
+    {
+      if (changed_first >= 0)
       {
-	QModelIndex stn_index = index(row, 4);
-	stn.setId(updated_stn.id());
-	dataChanged(stn_index, stn_index);
+        dataChanged(index(changed_first, 1),
+                    index(changed_last, columnCount()-1));
+        changed_first = -1;
       }
-      if (updated_stn.ip() != stn.ip())
+    };
+
+  int row = 0;
+  size_t pos = 0;
+  while ((pos < updated_stations.size()) && (row < rowCount()))
+  {
+    const StationData &updated_stn = *updated_stations[pos];
+    const StationData &stn = stations[row];
+    if (updated_stn.callsign() == stn.callsign())
+    {
+      if (updateStation(row, updated_stn))
       {
-	QModelIndex stn_index = index(row, 5);
-	stn.setIp(updated_stn.ip());
-	dataChanged(stn_index, stn_index);
+        if ((changed_first < 0) || (changed_last + 1 != row))
+        {
+          flush_changed();
+          changed_first = row;
+        }
+        changed_last = row;
       }
       row += 1;
-      updated_stations.removeFirst();
+      pos += 1;
     }
     else if (updated_stn.callsign() < stn.callsign())
     {
-      //cout << "### Inserting 1 row starting at row " << row << endl;
-      beginInsertRows(QModelIndex(), row, row);
-      stations.insert(row, updated_stn);
-      endInsertRows();
-      row += 1;
-      updated_stations.removeFirst();
+      size_t end = pos + 1;
+      while ((end < updated_stations.size()) &&
+             (updated_stations[end]->callsign() < stn.callsign()))
+      {
+        ++end;
+      }
+      flush_changed();
+      int count = static_cast<int>(end - pos);
+      insertStations(row, &updated_stations[pos], count);
+      row += count;
+      pos = end;
     }
     else
     {
-      removeRows(row, 1);
+      int end = row + 1;
+      while ((end < rowCount()) &&
+             (stations[end].callsign() < updated_stn.callsign()))
+      {
+        ++end;
+      }
+      flush_changed();
+      removeRows(row, end - row);
     }
   }
-  
-  if (!updated_stations.isEmpty())
+  flush_changed();
+
+  if (pos < updated_stations.size())
   {
-    int first = stations.count();
-    int last = stations.count()+updated_stations.count()-1;
-    //cout << "### Inserting " << last-first+1 << " rows starting at row " << row << endl;
-    beginInsertRows(QModelIndex(), first, last);
-    //stations.append(updated_stations);
-    copy(updated_stations.begin(), updated_stations.end(),
-         back_inserter(stations));
-    endInsertRows();
+    insertStations(rowCount(), &updated_stations[pos],
+                   static_cast<int>(updated_stations.size() - pos));
   }
-  else if (row < stations.count())
+  else if (row < rowCount())
   {
-    removeRows(row, stations.count()-row);
+    removeRows(row, rowCount()-row);
   }
-  
+
   //cout << "### stations=" << rowCount() << endl;
-  
+
 } /* EchoLinkDirectoryModel::updateStationList */
 
 
@@ -248,7 +254,7 @@ int EchoLinkDirectoryModel::rowCount(const QModelIndex &parent) const
     return 0;
   }
   
-  return stations.count();
+  return static_cast<int>(stations.size());
 } /* EchoLinkDirectoryModel::rowCount */
 
 
@@ -340,8 +346,8 @@ bool EchoLinkDirectoryModel::removeRows(int row, int count,
   
   //cout << "### Removing " << count << " rows starting at row " << row << endl;
   beginRemoveRows(QModelIndex(), row, row+count-1);
-  QList<StationData>::iterator begin(stations.begin()+row);
-  stations.erase(begin, begin+count);
+  stations.erase(stations.begin()+row, stations.begin()+row+count);
+  search_keys.erase(search_keys.begin()+row, search_keys.begin()+row+count);
   endRemoveRows();
   
   return true;
@@ -362,6 +368,84 @@ bool EchoLinkDirectoryModel::removeRows(int row, int count,
  *
  ****************************************************************************/
 
+QString EchoLinkDirectoryModel::makeSearchKey(const StationData &stn)
+{
+  QString key = QString::fromStdString(stn.callsign());
+  key += QChar('\n');
+  key += QString::fromStdString(stn.description());
+  if (stn.id() != -1)
+  {
+    key += QChar('\n');
+    key += QString::number(stn.id());
+  }
+  return key.toLower();
+} /* EchoLinkDirectoryModel::makeSearchKey */
+
+
+bool EchoLinkDirectoryModel::updateStation(int row,
+                                           const StationData &updated_stn)
+{
+  StationData &stn = stations[row];
+  bool changed = false;
+  bool key_changed = false;
+  if (updated_stn.description() != stn.description())
+  {
+    stn.setDescription(updated_stn.description());
+    changed = key_changed = true;
+  }
+  if (updated_stn.status() != stn.status())
+  {
+    stn.setStatus(updated_stn.status());
+    changed = true;
+  }
+  if (updated_stn.time() != stn.time())
+  {
+    stn.setTime(updated_stn.time());
+    changed = true;
+  }
+  if (updated_stn.id() != stn.id())
+  {
+    stn.setId(updated_stn.id());
+    changed = key_changed = true;
+  }
+  if (updated_stn.ip() != stn.ip())
+  {
+    stn.setIp(updated_stn.ip());
+    changed = true;
+  }
+  if (key_changed)
+  {
+    search_keys[row] = makeSearchKey(stn);
+  }
+  return changed;
+} /* EchoLinkDirectoryModel::updateStation */
+
+
+void EchoLinkDirectoryModel::insertStations(int row,
+    const StationData* const *first, int count)
+{
+  //cout << "### Inserting " << count << " rows starting at row " << row
+  //     << endl;
+  beginInsertRows(QModelIndex(), row, row+count-1);
+  vector<StationData> new_stations;
+  vector<QString> new_keys;
+  new_stations.reserve(count);
+  new_keys.reserve(count);
+  for (int i=0; i<count; ++i)
+  {
+    new_stations.push_back(*first[i]);
+    new_keys.push_back(makeSearchKey(*first[i]));
+  }
+  stations.insert(stations.begin()+row,
+                  make_move_iterator(new_stations.begin()),
+                  make_move_iterator(new_stations.end()));
+  search_keys.insert(search_keys.begin()+row,
+                     make_move_iterator(new_keys.begin()),
+                     make_move_iterator(new_keys.end()));
+  endInsertRows();
+} /* EchoLinkDirectoryModel::insertStations */
+
+
 
 
 /*
@@ -41,8 +41,10 @@ An example of how to use the EchoLinkDirectoryModel class
  *
  ****************************************************************************/
 
-#include <QList>
 #include <QAbstractItemModel>
+#include <QString>
+
+#include <vector>
 
 
 /****************************************************************************
@@ -135,11 +137,26 @@ class EchoLinkDirectoryModel : public QAbstractItemModel
     ~EchoLinkDirectoryModel(void);
   
     /**
-     * @brief 	A_brief_member_function_description
-     * @param 	param1 Description_of_param1
-     * @return	Return_value_of_this_member_function
+     * @brief 	Update the model with a new station list
+     * @param 	stn_list The new list of stations
+     *
+     * The new list is compared to the stations already in the model. Only
+     * the differences are applied, using as few row insert, row remove and
+     * data changed notifications as possible. Selections and filtering in
+     * views using the model are therefore kept when the list is refreshed.
      */
-    void updateStationList(const std::list<EchoLink::StationData> &stn_list);
+    void updateStationList(const std::vector<EchoLink::StationData> &stn_list);
+
+    /**
+     * @brief   Get the search key for a row
+     * @param   row The row to get the search key for
+     * @return  Returns the lower case callsign, description and node id
+     *
+     * The search key is created when a row is inserted or changed so that
+     * a filter model does not have to build strings for each row each time
+     * the filter is changed.
+     */
+    const QString& searchKey(int row) const { return search_keys.at(row); }
     
     QModelIndex index(int row, int column,
 			      const QModelIndex &parent = QModelIndex()) const;
@@ -158,7 +175,13 @@ class EchoLinkDirectoryModel : public QAbstractItemModel
   protected:
     
   private:
-    QList<EchoLink::StationData> stations;
+    std::vector<EchoLink::StationData>  stations;
+    std::vector<QString>                search_keys;
+
+    static QString makeSearchKey(const EchoLink::StationData &stn);
+    bool updateStation(int row, const EchoLink::StationData &updated_stn);
+    void insertStations(int row, const EchoLink::StationData* const *first,
+                        int count);
     
     EchoLinkDirectoryModel(const EchoLinkDirectoryModel&);
     EchoLinkDirectoryModel& operator=(const EchoLinkDirectoryModel&);
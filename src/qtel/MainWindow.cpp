@@ -59,7 +59,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
  ****************************************************************************/
 
 #include <AsyncIpAddress.h>
-#include <AsyncAudioInterpolator.h>
+#include <AsyncAudioResampler.h>
 #include <EchoLinkDirectory.h>
 #include <EchoLinkProxy.h>
 #include <common.h>
@@ -78,7 +78,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 #include "MainWindow.h"
 #include "MsgHandler.h"
 #include "EchoLinkDirectoryModel.h"
-#include "multirate_filter_coeff.h"
+#include "EchoLinkDirectoryFilterModel.h"
 
 
 /****************************************************************************
@@ -235,6 +235,18 @@ MainWindow::MainWindow(void)
   repeater_model = new EchoLinkDirectoryModel(this);
   station_model = new EchoLinkDirectoryModel(this);
   updateBookmarkModel();
+
+    // The station view always show the filter model. Selecting a station
+    // list only change the source model of the filter.
+  station_filter_model = new EchoLinkDirectoryFilterModel(this);
+  station_view->setModel(station_filter_model);
+  connect(station_view->selectionModel(),
+          SIGNAL(selectionChanged(const QItemSelection&,
+                                  const QItemSelection&)),
+          this, SLOT(stationViewSelectionChanged(const QItemSelection&,
+                                                 const QItemSelection&)));
+  connect(station_filter, SIGNAL(textChanged(const QString&)),
+          station_filter_model, SLOT(setSearchString(const QString&)));
   station_view_selector->setCurrentRow(0);
 
   QList<int> sizes = Settings::instance()->stationViewColSizes();
@@ -440,29 +452,13 @@ void MainWindow::initMsgAudioIo(void)
     mem_fun(*this, &MainWindow::allMsgsWritten));
   AudioSource *prev_src = msg_handler;
 
-#if (INTERNAL_SAMPLE_RATE == 8000)  
-  if (msg_audio_io->sampleRate() > 8000)
+  if (msg_audio_io->sampleRate() > INTERNAL_SAMPLE_RATE)
   {
-      // Interpolate sample rate to 16kHz
-    AudioInterpolator *i1 = new AudioInterpolator(2, coeff_16_8,
-                                                  coeff_16_8_taps);
-    prev_src->registerSink(i1, true);
-    prev_src = i1;
-  }
-#endif
-
-  if (msg_audio_io->sampleRate() > 16000)
-  {
-      // Interpolate sample rate to 48kHz
-#if (INTERNAL_SAMPLE_RATE == 8000)
-    AudioInterpolator *i2 = new AudioInterpolator(3, coeff_48_16_int,
-                                                  coeff_48_16_int_taps);
-#else
-    AudioInterpolator *i2 = new AudioInterpolator(3, coeff_48_16,
-                                                  coeff_48_16_taps);
-#endif
-    prev_src->registerSink(i2, true);
-    prev_src = i2;
+      // Convert the sample rate up to the sound card sample rate
+    AudioResampler *resampler = new AudioResampler(
+        INTERNAL_SAMPLE_RATE, msg_audio_io->sampleRate());
+    prev_src->registerSink(resampler, true);
+    prev_src = resampler;
   }
 
   prev_src->registerSink(msg_audio_io);
@@ -490,6 +486,21 @@ void MainWindow::setupAudioParams(void)
     AudioIO::setBlockCount(2);
   }
 #endif
+
+    // A configured buffer time override the default buffer sizes above.
+    // The buffer is split in two blocks to keep the latency low. The block
+    // size is rounded to a power of two, which most sound cards prefer.
+  int buffer_time = Settings::instance()->audioBufferTime();
+  if (buffer_time > 0)
+  {
+    int block_size = 64;
+    while (2 * block_size <= rate * buffer_time / 2000)
+    {
+      block_size *= 2;
+    }
+    AudioIO::setBlocksize(block_size);
+    AudioIO::setBlockCount(2);
+  }
   AudioIO::setSampleRate(rate);
   AudioIO::setChannels(1);
 } /* MainWindow::setupAudioParams */
@@ -549,7 +560,7 @@ void MainWindow::initEchoLink(void)
 
 void MainWindow::updateBookmarkModel(void)
 {
-  list<StationData> bookmarks;
+  Directory::StationList bookmarks;
   QStringList callsigns = Settings::instance()->bookmarks();
   QStringList::iterator it;
   foreach (QString callsign, callsigns)
@@ -586,7 +597,6 @@ void MainWindow::stationViewSelectorCurrentItemChanged(QListWidgetItem *current,
   }
   
   QAbstractItemModel *model = 0;
-  QItemSelectionModel *m = station_view->selectionModel();
   if (current->text() == tr("Bookmarks"))
   {
     model = bookmark_model;
@@ -608,21 +618,8 @@ void MainWindow::stationViewSelectorCurrentItemChanged(QListWidgetItem *current,
     model = station_model;
   }
   
-  station_view->setModel(model);
-  if (m != 0)
-  {
-    m->clear();
-    delete m;
-  }
-  
-  QItemSelectionModel *sm = station_view->selectionModel();
-  if (sm != 0)
-  {
-    connect(sm, SIGNAL(selectionChanged(const QItemSelection&,
-					const QItemSelection&)),
-	    this, SLOT(stationViewSelectionChanged(const QItemSelection&,
-						   const QItemSelection&)));
-  }
+  station_view->selectionModel()->clear();
+  station_filter_model->setSourceModel(model);
 
 } /* MainWindow::stationViewSelectorCurrentItemChanged */
 
@@ -76,6 +76,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 class IncomingConnection;
 class MsgHandler;
 class EchoLinkDirectoryModel;
+class EchoLinkDirectoryFilterModel;
 
 namespace EchoLink
 {
@@ -178,6 +179,7 @@ class MainWindow : public QMainWindow, private Ui::MainWindowBase,
     EchoLinkDirectoryModel	  *link_model;
     EchoLinkDirectoryModel	  *repeater_model;
     EchoLinkDirectoryModel	  *station_model;
+    EchoLinkDirectoryFilterModel  *station_filter_model;
     EchoLink::Proxy               *proxy;
     
     QMap<QString, QString> incoming_con_param;
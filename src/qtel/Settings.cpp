@@ -105,6 +105,7 @@ using namespace std;
 #define CONF_USE_FULL_DUPLEX          "UseFullDuplex"
 #define CONF_CONNECT_SOUND            "ConnectSound"
 #define CONF_CARD_SAMPLE_RATE         "CardSampleRate"
+#define CONF_AUDIO_BUFFER_TIME        "AudioBufferTime"
 
 #define CONF_CHAT_ENCODING	      "ChatEncoding"
 
@@ -137,6 +138,7 @@ using namespace std;
 #define CONF_CONNECT_SOUND_DEFAULT 	SHARE_INSTALL_PREFIX \
                                         "/qtel/sounds/connect.raw"
 #define CONF_CARD_SAMPLE_RATE_DEFAULT   48000
+#define CONF_AUDIO_BUFFER_TIME_DEFAULT  0
 
 #define CONF_CHAT_ENCODING_DEFAULT	"ISO8859-1"
 
@@ -220,6 +222,7 @@ Settings::Settings(void)
     m_proxy_port(CONF_PROXY_PORT_DEFAULT),
     m_use_full_duplex(CONF_USE_FULL_DUPLEX_DEFAULT),
     m_card_sample_rate(CONF_CARD_SAMPLE_RATE_DEFAULT),
+    m_audio_buffer_time(CONF_AUDIO_BUFFER_TIME_DEFAULT),
     m_chat_encoding(0),
     m_vox_enabled(CONF_VOX_ENABLED_DEFAULT),
     m_vox_threshold(CONF_VOX_THRESHOLD_DEFAULT),
@@ -344,6 +347,7 @@ void Settings::showDialog(void)
   {
     settings_dialog.card_sample_rate->setCurrentIndex(card_sample_rate_idx);
   }
+  settings_dialog.audio_buffer_time->setValue(m_audio_buffer_time);
 
   settings_dialog.chat_encoding->setCurrentIndex(m_chat_encoding);
 
@@ -400,6 +404,7 @@ void Settings::showDialog(void)
 	m_connect_sound = settings_dialog.connect_sound->text();
         m_card_sample_rate =
                 settings_dialog.card_sample_rate->currentText().toInt();
+        m_audio_buffer_time = settings_dialog.audio_buffer_time->value();
 	
 	m_chat_encoding = settings_dialog.chat_encoding->currentIndex();
 
@@ -424,6 +429,7 @@ void Settings::showDialog(void)
 	qsettings.setValue(CONF_USE_FULL_DUPLEX, m_use_full_duplex);
 	qsettings.setValue(CONF_CONNECT_SOUND, m_connect_sound);
 	qsettings.setValue(CONF_CARD_SAMPLE_RATE, m_card_sample_rate);
+	qsettings.setValue(CONF_AUDIO_BUFFER_TIME, m_audio_buffer_time);
       	
 	qsettings.setValue(CONF_CHAT_ENCODING,
 			     encodings[m_chat_encoding].name);
@@ -477,6 +483,8 @@ void Settings::readSettings(void)
       CONF_CONNECT_SOUND_DEFAULT).toString();
   m_card_sample_rate = qsettings.value(CONF_CARD_SAMPLE_RATE,
       CONF_CARD_SAMPLE_RATE_DEFAULT).toInt();
+  m_audio_buffer_time = qsettings.value(CONF_AUDIO_BUFFER_TIME,
+      CONF_AUDIO_BUFFER_TIME_DEFAULT).toInt();
   
   m_chat_encoding = 0;
   QString encoding_name = qsettings.value(CONF_CHAT_ENCODING,
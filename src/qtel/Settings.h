@@ -167,6 +167,7 @@ class Settings : public sigc::trackable
     bool useFullDuplex(void) const { return m_use_full_duplex; }
     const QString& connectSound(void) const { return m_connect_sound; }
     int cardSampleRate(void) const { return m_card_sample_rate; }
+    int audioBufferTime(void) const { return m_audio_buffer_time; }
     
     const QString& chatEncoding(void) const
     {
@@ -234,6 +235,7 @@ class Settings : public sigc::trackable
     bool      	            m_use_full_duplex;
     QString   	            m_connect_sound;
     int                     m_card_sample_rate;
+    int                     m_audio_buffer_time;
     
     int		            m_chat_encoding;
 
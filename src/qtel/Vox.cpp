@@ -35,6 +35,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 #include <iostream>
 #include <cmath>
 #include <cassert>
+#include <algorithm>
 
 #include <QTimer>
 
@@ -117,7 +118,7 @@ using namespace Async;
 
 Vox::Vox(void)
   : m_threshold(0), m_delay(0), m_vox_timer(0), m_vox_state(IDLE),
-    m_enabled(false)
+    m_enabled(false), m_block_pos(0)
 {
   m_vox_timer = new QTimer;
   connect(m_vox_timer, SIGNAL(timeout()),
@@ -140,48 +141,19 @@ int Vox::writeSamples(const float *samples, int count)
     return count;
   }
   
-    // Calculate DC offset
-  float dc_offset = 0.0f;
-  for (int i=0; i < count; i++)
-  {
-    dc_offset += samples[i] / count;
-  }
-
-    // Calculate absolute average level sans offset
-  float avg = 0.0f;
-  for (int i=0; i < count; i++)
+  int pos = 0;
+  while (pos < count)
   {
-    float sample = (samples[i] - dc_offset) / count;
-    if (sample > 0)
-    {
-      avg += sample;
-    }
-    else
+    int len = std::min(count - pos, BLOCK_SIZE - m_block_pos);
+    std::copy(samples + pos, samples + pos + len, m_block + m_block_pos);
+    m_block_pos += len;
+    pos += len;
+    if (m_block_pos == BLOCK_SIZE)
     {
-      avg -= sample;
+      processBlock();
+      m_block_pos = 0;
     }
   }
-
-  int db_level = -60;
-  if (avg > 1.0f)
-  {
-    db_level = 0;
-  }
-  else if (avg > 0.001f)
-  {
-    db_level = (int)(20.0f * log10f(avg));
-  }
-  levelChanged(db_level);
-
-  if (db_level > m_threshold)
-  {
-    setState(ACTIVE);
-  }
-  else if (m_vox_state == ACTIVE)
-  {
-    setState(HANG);
-  }
-
   return count;
     
 } /* Vox::writeSamples */
@@ -220,6 +192,7 @@ void Vox::setDelay(int delay_ms)
 void Vox::setEnabled(bool enable)
 {
   m_enabled = enable;
+  m_block_pos = 0;
   if (!m_enabled)
   {
     levelChanged(-60);
@@ -244,6 +217,49 @@ void Vox::setEnabled(bool enable)
  ****************************************************************************/
 
 
+/**
+ * @brief Measure the level of a full block and update the VOX state
+ */
+void Vox::processBlock(void)
+{
+    // Calculate DC offset
+  float dc_offset = 0.0f;
+  for (int i=0; i < BLOCK_SIZE; i++)
+  {
+    dc_offset += m_block[i];
+  }
+  dc_offset /= BLOCK_SIZE;
+  
+    // Calculate absolute average level sans offset
+  float avg = 0.0f;
+  for (int i=0; i < BLOCK_SIZE; i++)
+  {
+    avg += fabsf(m_block[i] - dc_offset);
+  }
+  avg /= BLOCK_SIZE;
+  
+  int db_level = -60;
+  if (avg > 1.0f)
+  {
+    db_level = 0;
+  }
+  else if (avg > 0.001f)
+  {
+    db_level = (int)(20.0f * log10f(avg));
+  }
+  levelChanged(db_level);
+  
+  if (db_level > m_threshold)
+  {
+    setState(ACTIVE);
+  }
+  else if (m_vox_state == ACTIVE)
+  {
+    setState(HANG);
+  }
+} /* Vox::processBlock */
+
+
 /**
  * @brief Called when the VOX delay time has expired
  */
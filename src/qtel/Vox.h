@@ -110,7 +110,10 @@ class QTimer;
 @date   2008-03-07
 
 This class implements the logic for a voice operated transmission control
-(VOX).
+(VOX). The level is measured over fixed blocks of 20ms, independent of how
+the audio is chunked by the sound card, so a small audio device buffer size
+does not make the VOX more sensitive to short peaks or flood the level meter
+with updates.
 */
 class Vox : public QObject, public Async::AudioSink
 {
@@ -219,15 +222,20 @@ class Vox : public QObject, public Async::AudioSink
   protected:
     
   private:
+    static const int BLOCK_SIZE = INTERNAL_SAMPLE_RATE / 50;
+
     int  	  m_threshold;
     int       	  m_delay;
     QTimer    	  *m_vox_timer;
     State     	  m_vox_state;
     bool      	  m_enabled;
+    float         m_block[BLOCK_SIZE];
+    int           m_block_pos;
     
     Vox(const Vox&);
     Vox& operator=(const Vox&);
     void setState(State new_state);
+    void processBlock(void);
 
 
   private slots:
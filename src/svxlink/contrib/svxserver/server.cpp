@@ -10,7 +10,7 @@ server core (e.g. via a TCP/IP network).
 
 \verbatim
 svxserver - A svxlink server application
-Copyright (C) 2003-2017 Tobias Blomberg / SM0SVX
+Copyright (C) 2003-2026 Tobias Blomberg / SM0SVX
 
 This program is free software; you can redistribute it and/or modify
 it under the terms of the GNU General Public License as published by
@@ -42,6 +42,8 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 #include <cstring>
 #include <cstdlib>
 #include <map>
+#include <algorithm>
+#include <memory>
 
 
 /****************************************************************************
@@ -168,9 +170,13 @@ SvxServer::SvxServer(Async::Config &cfg)
 SvxServer::~SvxServer(void)
 {
   clients.clear();
+  ready_cons.clear();
   delete server;
-  delete master;
   delete heartbeat_timer;
+  delete sql_timer;
+  delete sql_resettimer;
+  delete audio_timer;
+  delete auth_msg;
 }
 
 
@@ -181,38 +187,36 @@ void SvxServer::clientConnected(Async::TcpConnection *con)
 
   con->dataReceived.connect(mem_fun(*this, &SvxServer::tcpDataReceived));
 
-  pair<const string, uint16_t> key(con->remoteHost().toString(),
-                                   con->remotePort());
-  Cons clpair;
+    // The client list is indexed by the connection so that no search is
+    // needed when a message is received
+  Cons& clpair = clients[con];
   clpair.con = con;
-  clpair.state = STATE_VER_WAIT;
+  clpair.state = STATE_AUTH_WAIT;
   clpair.sql_open = false;  // set SQL close as default
   clpair.blocked = false;   // node is not blocked as default
   clpair.recv_exp = sizeof(Msg);
   clpair.recv_cnt = 0;
   gettimeofday(&clpair.last_msg, NULL);
   gettimeofday(&clpair.sent_msg, NULL);
+  heartbeat_timer->setEnable(true);
 
-  clients[key] = clpair;
-
-  MsgProtoVer *ver_msg = new MsgProtoVer;
-  sendMsg(con, ver_msg);
+  MsgProtoVer ver_msg;
+  sendMsg(con, &ver_msg);
 
   if (auth_key.empty())
   {
-    MsgAuthOk *auth_ok = new MsgAuthOk;
-    sendMsg(con, auth_ok);
-    clpair.state = STATE_VER_WAIT;
+    Clients::iterator it = clients.find(con);
+    if (it != clients.end())
+    {
+      setReady(it);
+    }
+    MsgAuthOk auth_ok;
+    sendMsg(con, &auth_ok);
   }
   else
   {
     sendMsg(con, auth_msg);
-    clpair.state = STATE_AUTH_WAIT;
   }
-
-  clients[key] = clpair;
-  heartbeat_timer->setEnable(true);
-
 } /* SvxServer::clientConnected */
 
 
@@ -222,38 +226,33 @@ void SvxServer::clientDisconnected(Async::TcpConnection *con,
   cout << "--- Client disconnected: " << con->remoteHost() << ":"
        << con->remotePort() << endl;
 
-  if (clients.size() < 1)
+  Clients::iterator it = clients.find(con);
+  if (it == clients.end())
   {
-    heartbeat_timer->setEnable(false);
-    heartbeat_timer->reset();
+    return;
   }
+
+  const bool was_master = isMaster(con);
   resetMaster(con);
+  removeReady(con);
 
-  Clients::iterator it;
-  for (it=clients.begin(); it!=clients.end(); it++)
-  {
-    if ((*it).second.con == con)
-    {
-      (*it).second.state = STATE_DISC;
-      (*it).second.sql_open = false;
+  cout << "-X- removing client " << con->remoteHost() << ":"
+       << con->remotePort()  << " from client list" << endl;
+  clients.erase(it);
 
-        // If a station lost network connection it can't be
-        // master anymore, send a SQL close command to all
-        // connected stations
-      if (isMaster(con))
-      {
-        MsgSquelch *ms = new MsgSquelch(false, 0.0, 1);
-        sendMsg(con, ms);
-      }
-      break;
-    }
+    // If a station lost network connection it can't be
+    // master anymore, send a SQL close command to all
+    // connected stations
+  if (was_master)
+  {
+    MsgSquelch ms(false, 0.0, 1, "");
+    sendExcept(con, &ms);
   }
 
-  if (it != clients.end())
+  if (clients.empty())
   {
-    cout << "-X- removing client " << con->remoteHost() << ":"
-         << con->remotePort()  << " from client list" << endl;
-    clients.erase(it);
+    heartbeat_timer->setEnable(false);
+    heartbeat_timer->reset();
   }
 } /* SvxServer::clientDisconnected */
 
@@ -264,15 +263,7 @@ int SvxServer::tcpDataReceived(Async::TcpConnection *con, void *data, int size)
 //  cout << "tcpDataReceived: " << con->remoteHost() << ":"
 //       << con->remotePort() << endl;
 
-  Clients::iterator it;
-  for (it=clients.begin(); it!=clients.end(); it++)
-  {
-    if (((*it).second).con == con)
-    {
-      break;
-    }
-  }
-
+  Clients::iterator it = clients.find(con);
   if (it == clients.end())
   {
     cout << "--- tcp data received from station out of my list "
@@ -344,26 +335,15 @@ void SvxServer::handleMsg(Async::TcpConnection *con, Msg *msg)
 //  cout << "message <---------- " << con->remoteHost() << ":" 
 //       << con->remotePort() << ", type=" << msg->type() << " received\n";
 
-  int state = STATE_READY;
-  Clients::iterator it;
-  Clients t_clients;
-
-  for (it=clients.begin(); it!=clients.end(); it++)
-  {
-    if ( ((*it).second).con == con)
-    {
-      state = (*it).second.state;
-      gettimeofday(&((*it).second).last_msg, NULL);
-      break;
-    }
-  }
-
+  Clients::iterator it = clients.find(con);
   if (it == clients.end())
   {
     cout << "-- message received from ip out of my list "
          << con->remoteHost() << ":" << con->remotePort() << endl;
     return;
   }
+  int state = (*it).second.state;
+  gettimeofday(&((*it).second).last_msg, NULL);
 
   switch (state)
   {
@@ -388,14 +368,14 @@ void SvxServer::handleMsg(Async::TcpConnection *con, Msg *msg)
         }
         else
         {
-          MsgAuthOk *ok_msg = new MsgAuthOk;
-          sendMsg(con, ok_msg);
-          ((*it).second).state = STATE_READY;
+          setReady(it);
+          MsgAuthOk ok_msg;
+          sendMsg(con, &ok_msg);
 
           // sending SQL close to connected node just to be sure that it 
           // isn't still open from former connects
-          MsgTransmitterStateChange *txcl = new MsgTransmitterStateChange(false);
-          sendMsg(con, txcl);
+          MsgTransmitterStateChange txcl(false);
+          sendMsg(con, &txcl);
         }
       }
       else
@@ -419,8 +399,8 @@ void SvxServer::handleMsg(Async::TcpConnection *con, Msg *msg)
       // is heartbeat, send a heartbeat back to client
     case MsgHeartbeat::TYPE:
     {
-      MsgHeartbeat *m = new MsgHeartbeat;
-      sendMsg(con, m);
+      MsgHeartbeat m;
+      sendMsg(con, &m);
       return;
     }
 
@@ -476,8 +456,8 @@ void SvxServer::handleMsg(Async::TcpConnection *con, Msg *msg)
       {
         audio_timer->setEnable(true);
         setMaster(con);
-        MsgSquelch *ms = new MsgSquelch(true, 1.0, 1);
-        sendExcept(con, ms);
+        MsgSquelch ms(true, 1.0, 1, "");
+        sendExcept(con, &ms);
         (*it).second.sql_open = true;
 
         // sends the audiostream to all connected clients without the
@@ -485,9 +465,9 @@ void SvxServer::handleMsg(Async::TcpConnection *con, Msg *msg)
         if ((*it).second.tx_mode != Tx::TX_AUTO)
         {
           (*it).second.tx_mode = Tx::TX_AUTO;
-          MsgSetTxCtrlMode *n = new MsgSetTxCtrlMode(Tx::TX_AUTO);
-          sendExcept(con, n);
-          sendMsg(con, n);
+          MsgSetTxCtrlMode n(Tx::TX_AUTO);
+          sendExcept(con, &n);
+          sendMsg(con, &n);
         }
       }
 
@@ -508,16 +488,16 @@ void SvxServer::handleMsg(Async::TcpConnection *con, Msg *msg)
       if (isMaster(con))
       {
         resetMaster(con);
-        MsgSquelch  *ms = new MsgSquelch(false, 0.0, 1);
-        sendExcept(con, ms);
-        sendMsg(con, ms);
-
         (*it).second.sql_open = false;
 
-        MsgAllSamplesFlushed *o = new MsgAllSamplesFlushed;
-        sendMsg(con, o);
-        cmsg = o;
-        break;
+        MsgSquelch ms(false, 0.0, 1, "");
+        sendExcept(con, &ms);
+        sendMsg(con, &ms);
+
+        MsgAllSamplesFlushed o;
+        sendMsg(con, &o);
+        sendExcept(con, &o);
+        return;
       }
       else
       {
@@ -547,14 +527,14 @@ void SvxServer::handleMsg(Async::TcpConnection *con, Msg *msg)
       {
         // the station with 1st SQL opening becomes a master
         setMaster(con);
+        (*it).second.sql_open = true;
 
-        MsgTransmitterStateChange *n = new MsgTransmitterStateChange(true);
-        sendMsg(con, n);
-        sendExcept(con, n);
+        MsgTransmitterStateChange n(true);
+        sendMsg(con, &n);
+        sendExcept(con, &n);
 
-        MsgSquelch  *ms = new MsgSquelch(true, 1.0, 1);
-        sendExcept(con, ms);
-        (*it).second.sql_open = true;
+        MsgSquelch ms(true, 1.0, 1, "");
+        sendExcept(con, &ms);
         audio_timer->reset();
         audio_timer->setEnable(true);
       }
@@ -566,12 +546,12 @@ void SvxServer::handleMsg(Async::TcpConnection *con, Msg *msg)
         (*it).second.sql_open = false;
 
         (*it).second.tx_mode = Tx::TX_AUTO;
-        MsgSetTxCtrlMode *n = new MsgSetTxCtrlMode(Tx::TX_AUTO);
-        sendExcept(con, n);
+        MsgSetTxCtrlMode n(Tx::TX_AUTO);
+        sendExcept(con, &n);
 
-        MsgTransmitterStateChange *m = new MsgTransmitterStateChange(false);
-        sendExcept(con, m);
-        sendMsg(con, m);
+        MsgTransmitterStateChange m(false);
+        sendExcept(con, &m);
+        sendMsg(con, &m);
       }
 
       cmsg = s;
@@ -584,7 +564,10 @@ void SvxServer::handleMsg(Async::TcpConnection *con, Msg *msg)
       return;
   }
 
-  sendExcept(con, cmsg);
+  if (cmsg != 0)
+  {
+    sendExcept(con, cmsg);
+  }
 
 } /* SvxServer::handleMsg */
 
@@ -602,22 +585,16 @@ void SvxServer::audiotimeout(Timer *t)
 
 void SvxServer::sqltimeout(Timer *t)
 {
-  Clients::iterator it;
-  Clients t_clients;
-
   // find the connection handler that has a problem with
   // the SQL -> revoke the AUTH grant
-  for (it=clients.begin(); it!=clients.end(); it++)
+  Clients::iterator it = clients.find(master);
+  if (it != clients.end())
   {
-    if ( (*it).second.con == master)
-    {
-      (*it).second.state = STATE_DISC;
-      (*it).second.blocked = true;
-      cout << "*** WARNING: SQL on " << master->remoteHost() 
-           << " has been open too long, blocking station." << endl;
-      gettimeofday(&((*it).second).last_msg, NULL);
-      break;
-    }
+    (*it).second.state = STATE_DISC;
+    (*it).second.blocked = true;
+    cout << "*** WARNING: SQL on " << master->remoteHost() 
+         << " has been open too long, blocking station." << endl;
+    gettimeofday(&((*it).second).last_msg, NULL);
   }
 
   resetAll();
@@ -632,27 +609,23 @@ void SvxServer::sqlresettimeout(Timer *t)
 
 void SvxServer::resetAll(void)
 {
-  MsgSquelch *ms = new MsgSquelch(false, 0.0, 1);
-  sendExcept(master, ms);
-  sendMsg(master, ms);
-
-  Clients::iterator it;
-  Clients t_clients;
+  Async::TcpConnection *con = master;
+  resetMaster(con);
 
-  for (it=clients.begin(); it!=clients.end(); it++)
+  Clients::iterator it = clients.find(con);
+  if (it != clients.end())
   {
-    if ( (*it).second.con == master)
-    {
-      (*it).second.sql_open = false;
-      gettimeofday(&(*it).second.last_msg, NULL);
-      break;
-    }
+    (*it).second.sql_open = false;
+    gettimeofday(&(*it).second.last_msg, NULL);
   }
 
-  MsgAllSamplesFlushed *o = new MsgAllSamplesFlushed;
-  sendMsg(master, o);
-  sendExcept(master, o);
-  resetMaster(master);
+  MsgSquelch ms(false, 0.0, 1, "");
+  sendExcept(con, &ms);
+  sendMsg(con, &ms);
+
+  MsgAllSamplesFlushed o;
+  sendMsg(con, &o);
+  sendExcept(con, &o);
 } /* SvxServer::resetAll */
 
 
@@ -662,14 +635,13 @@ void SvxServer::hbtimeout(Timer *t)
   struct timeval t_diff;
   int diff_ms;
 
-  Clients::iterator it;
-  Clients t_clients;
-  MsgHeartbeat *m = new MsgHeartbeat;
-
-  for (it=clients.begin(); it!=clients.end(); it++)
+  ConList alive;
+  ConList timed_out;
+  gettimeofday(&t_time, NULL);
+  for (auto& item : clients)
   {
-    gettimeofday(&t_time, NULL);
-    timersub(&t_time, &(*it).second.last_msg, &t_diff );
+    Cons& client = item.second;
+    timersub(&t_time, &client.last_msg, &t_diff);
     diff_ms = int(t_diff.tv_sec * 1000 +  t_diff.tv_usec/1000);
 
       // if the difference more then 2*timeout, put the client
@@ -677,24 +649,36 @@ void SvxServer::hbtimeout(Timer *t)
     if (diff_ms > 2 * hbto)
     {
       cerr << "**** ERROR: Heartbeat timeout, lost connection to "
-           << (*it).second.con->remoteHost() << ":"
-           << (*it).second.con->remotePort() << endl;
-      t_clients.insert(*it); // storing clients to be removed later
-      (*it).second.state = STATE_DISC;
+           << client.con->remoteHost() << ":"
+           << client.con->remotePort() << endl;
+      timed_out.push_back(client.con);
+      client.state = STATE_DISC;
     }
     else 
     {
-      sendMsg((*it).second.con, m);
+      alive.push_back(client.con);
     }
   }
 
+    // A failing write will remove the client so the heartbeats are sent
+    // after the client list has been traversed
+  MsgHeartbeat m;
+  for (auto con : alive)
+  {
+    sendMsg(con, &m);
+  }
+
   // removing client connection from connection pool
-  for (it = t_clients.begin(); it != t_clients.end(); it++)
+  for (auto con : timed_out)
   {
-    cout << "-X- disconnect client " << (*it).second.con->remoteHost() << ":"
-         << (*it).second.con->remotePort() << endl;
-    (*it).second.con->disconnect();
-    clientDisconnected((*it).second.con, TcpConnection::DR_ORDERED_DISCONNECT);
+    if (clients.find(con) == clients.end())
+    {
+      continue;
+    }
+    cout << "-X- disconnect client " << con->remoteHost() << ":"
+         << con->remotePort() << endl;
+    con->disconnect();
+    clientDisconnected(con, TcpConnection::DR_ORDERED_DISCONNECT);
   }
 
   t->reset();
@@ -704,34 +688,82 @@ void SvxServer::hbtimeout(Timer *t)
 
 void SvxServer::sendExcept(Async::TcpConnection *con, Msg *msg)
 {
+  if (ready_cons.empty())
+  {
+    return;
+  }
 
-    // copy map to prevent a segfault by erasing a connection
-    // that exists anymore
-  Clients t_clients = clients;
-  Clients::iterator it;
+    // The message is copied once into a buffer that is shared by the write
+    // queues of all connections. A snapshot of the recipient list is used
+    // since a failing write will remove the client from the list.
+  const uint8_t *data = reinterpret_cast<const uint8_t*>(msg);
+  TcpConnection::SharedBuffer buf =
+    std::make_shared<std::vector<uint8_t>>(data, data + msg->size());
+  const ConList recipients(ready_cons);
 
     // sending data to connected clients without the source client
-  for (it = t_clients.begin(); it != t_clients.end(); it++)
+  for (auto rcon : recipients)
   {
-    if ((*it).second.con != con)
+    if (rcon != con)
     {
-      sendMsg((*it).second.con, msg);
+      sendBuf(rcon, buf);
     }
   }
 } /* SvxServer::sendExcept */
 
 
-void SvxServer::sendMsg(Async::TcpConnection *con, Msg *msg)
+void SvxServer::setReady(Clients::iterator it)
+{
+  if ((*it).second.state != STATE_READY)
+  {
+    (*it).second.state = STATE_READY;
+    ready_cons.push_back((*it).first);
+  }
+} /* SvxServer::setReady */
+
+
+void SvxServer::removeReady(Async::TcpConnection *con)
 {
+  ConList::iterator it = std::find(ready_cons.begin(), ready_cons.end(), con);
+  if (it != ready_cons.end())
+  {
+    *it = ready_cons.back();
+    ready_cons.pop_back();
+  }
+} /* SvxServer::removeReady */
 
-  assert(con->isConnected());
-  if (clients.size() < 1)
+
+void SvxServer::sendMsg(Async::TcpConnection *con, Msg *msg)
+{
+  if (clients.find(con) == clients.end())
   {
     return;
   }
+  assert(con->isConnected());
 
   int written = con->write(msg, msg->size());
-  if (written != static_cast<int>(msg->size()))
+  checkWrite(con, written, msg->size());
+} /* SvxServer::sendMsg */
+
+
+void SvxServer::sendBuf(Async::TcpConnection *con,
+                        const Async::TcpConnection::SharedBuffer& buf)
+{
+  if (clients.find(con) == clients.end())
+  {
+    return;
+  }
+  assert(con->isConnected());
+
+  int written = con->write(buf);
+  checkWrite(con, written, buf->size());
+} /* SvxServer::sendBuf */
+
+
+void SvxServer::checkWrite(Async::TcpConnection *con, int written,
+                           size_t expected)
+{
+  if (written != static_cast<int>(expected))
   {
     cout << "*** ERROR: (" << con->remoteHost() << ":"
          << con->remotePort() << ") TCP transmit "
@@ -740,7 +772,7 @@ void SvxServer::sendMsg(Async::TcpConnection *con, Msg *msg)
     con->disconnect();
     clientDisconnected(con, TcpConnection::DR_ORDERED_DISCONNECT);
   }
-} /* SvxServer::sendMsg */
+} /* SvxServer::checkWrite */
 
 
 bool SvxServer::hasMaster()
@@ -6,7 +6,7 @@
 
 \verbatim
 RemoteTrx - A remote receiver for the SvxLink server
-Copyright (C) 2003-2015 Tobias Blomberg / SM0SVX
+Copyright (C) 2003-2026 Tobias Blomberg / SM0SVX
 
 This program is free software; you can redistribute it and/or modify
 it under the terms of the GNU General Public License as published by
@@ -34,6 +34,9 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
  *
  ****************************************************************************/
 
+#include <map>
+#include <vector>
+#include <string>
 
 
 /****************************************************************************
@@ -161,8 +164,11 @@ class SvxServer : public sigc::trackable
       bool  blocked;
     };
 
-    typedef std::map<std::pair<const std::string, uint16_t>, Cons> Clients;
+    typedef std::map<Async::TcpConnection*, Cons> Clients;
+    typedef std::vector<Async::TcpConnection*> ConList;
+
     Clients clients;
+    ConList ready_cons;
 
     std::string     auth_key;
     NetTrxMsg::MsgAuthChallenge *auth_msg;
@@ -174,12 +180,17 @@ class SvxServer : public sigc::trackable
     unsigned char   auth_challenge[NetTrxMsg::MsgAuthChallenge::CHALLENGE_LEN];
 
     void sendExcept(Async::TcpConnection *con, NetTrxMsg::Msg *msg);
+    void setReady(Clients::iterator it);
+    void removeReady(Async::TcpConnection *con);
     void clientConnected(Async::TcpConnection *incoming_con);
     void clientDisconnected(Async::TcpConnection *con,
       	      	      	Async::TcpConnection::DisconnectReason reason);
     int tcpDataReceived(Async::TcpConnection *con, void *data, int size);
     void handleMsg(Async::TcpConnection *con, NetTrxMsg::Msg *msg);
     void sendMsg(Async::TcpConnection *con, NetTrxMsg::Msg *msg);
+    void sendBuf(Async::TcpConnection *con,
+                 const Async::TcpConnection::SharedBuffer& buf);
+    void checkWrite(Async::TcpConnection *con, int written, size_t expected);
     void hbtimeout(Async::Timer *t);
     void sqltimeout(Async::Timer *t);
     void sqlresettimeout(Async::Timer *t);
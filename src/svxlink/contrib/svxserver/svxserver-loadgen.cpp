@@ -0,0 +1,580 @@
+/**
+@file	 svxserver-loadgen.cpp
+@brief   A load generator and benchmark for the svxserver relay
+@author  Tobias Blomberg / SM0SVX
+@date	 2026-10-14
+
+This program connects a number of emulated nodes to a running svxserver. The
+nodes take turns in sending audio spurts while all other nodes receive the
+relayed audio. The fan-out latency, the delivery ratio and optionally the
+server CPU time per forwarded frame are measured. The summary use the same
+format as svxreflector-loadgen so that the two relay implementations can be
+compared.
+
+\verbatim
+svxserver - A remote receiver for the SvxLink server
+Copyright (C) 2003-2026 Tobias Blomberg / SM0SVX
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+\endverbatim
+*/
+
+
+
+/****************************************************************************
+ *
+ * System Includes
+ *
+ ****************************************************************************/
+
+#include <popt.h>
+#include <sigc++/sigc++.h>
+#include <json/json.h>
+
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <chrono>
+#include <vector>
+#include <memory>
+#include <algorithm>
+
+
+/****************************************************************************
+ *
+ * Project Includes
+ *
+ ****************************************************************************/
+
+#include <AsyncCppApplication.h>
+#include <AsyncTimer.h>
+#include <AsyncTcpClient.h>
+#include <RelayBench.h>
+
+
+/****************************************************************************
+ *
+ * Local Includes
+ *
+ ****************************************************************************/
+
+#include "version/SVXSERVER.h"
+#include "NetTrxMsg.h"
+
+
+/****************************************************************************
+ *
+ * Namespaces to use
+ *
+ ****************************************************************************/
+
+using namespace std;
+using namespace Async;
+using namespace SvxLink;
+using namespace NetTrxMsg;
+
+
+/****************************************************************************
+ *
+ * Defines & typedefs
+ *
+ ****************************************************************************/
+
+#define PROGRAM_NAME "SvxServerLoadGen"
+
+typedef std::chrono::steady_clock Clock;
+
+
+/****************************************************************************
+ *
+ * Local class definitions
+ *
+ ****************************************************************************/
+
+namespace {
+
+  /**
+   * @brief An emulated node, speaking the NetTrx protocol to svxserver
+   */
+  class Node : public sigc::trackable
+  {
+    public:
+      Node(const string& host, uint16_t port, const string& auth_key)
+        : m_con(host, port, RECV_BUF_LEN), m_auth_key(auth_key)
+      {
+        m_con.connected.connect(sigc::mem_fun(*this, &Node::onConnected));
+        m_con.disconnected.connect(
+            sigc::mem_fun(*this, &Node::onDisconnected));
+        m_con.dataReceived.connect(sigc::mem_fun(*this, &Node::onData));
+      }
+
+      void connect(void) { m_con.connect(); }
+      bool isLoggedIn(void) const { return m_logged_in; }
+
+      bool send(Msg& msg)
+      {
+        if (!m_con.isConnected())
+        {
+          return false;
+        }
+        return m_con.write(&msg, msg.size()) == static_cast<int>(msg.size());
+      }
+
+      sigc::signal<void(Node*)>             loggedIn;
+      sigc::signal<void(Node*)>             disconnected;
+      sigc::signal<void(MsgAudio*)>         audioReceived;
+
+    private:
+      static const size_t RECV_BUF_LEN = 65536;
+
+      TcpClient<>           m_con;
+      string                m_auth_key;
+      bool                  m_logged_in = false;
+      vector<uint8_t>       m_buf;
+
+      void onConnected(void)
+      {
+        m_buf.clear();
+      }
+
+      void onDisconnected(TcpConnection*, TcpConnection::DisconnectReason)
+      {
+        m_logged_in = false;
+        disconnected(this);
+      }
+
+      int onData(TcpConnection*, void* data, int size)
+      {
+          // Messages are prefixed by their size in the common header
+        const uint8_t* ptr = static_cast<const uint8_t*>(data);
+        int used = 0;
+        while (size - used >= static_cast<int>(sizeof(Msg)))
+        {
+          const Msg* msg = reinterpret_cast<const Msg*>(ptr + used);
+          if ((msg->size() < sizeof(Msg)) || (msg->size() > RECV_BUF_LEN))
+          {
+            cerr << "*** ERROR: Illegal message size " << msg->size()
+                 << " received from svxserver\n";
+            m_con.disconnect();
+            return size;
+          }
+          if (size - used < static_cast<int>(msg->size()))
+          {
+            break;
+          }
+            // Copy to an aligned buffer before the message is interpreted
+          m_buf.assign(ptr + used, ptr + used + msg->size());
+          used += msg->size();
+          handleMsg(reinterpret_cast<Msg*>(m_buf.data()));
+        }
+        return used;
+      }
+
+      void handleMsg(Msg* msg)
+      {
+        switch (msg->type())
+        {
+          case MsgAuthChallenge::TYPE:
+          {
+            MsgAuthChallenge* challenge =
+              reinterpret_cast<MsgAuthChallenge*>(msg);
+            MsgAuthResponse response(m_auth_key, challenge->challenge());
+            send(response);
+            break;
+          }
+
+          case MsgAuthOk::TYPE:
+            if (!m_logged_in)
+            {
+              m_logged_in = true;
+              loggedIn(this);
+            }
+            break;
+
+          case MsgAudio::TYPE:
+            audioReceived(reinterpret_cast<MsgAudio*>(msg));
+            break;
+
+          default:
+            break;
+        }
+      }
+  };
+
+};
+
+
+/****************************************************************************
+ *
+ * Prototypes
+ *
+ ****************************************************************************/
+
+static void node_logged_in(Node* node);
+static void node_disconnected(Node* node);
+static void audio_received(MsgAudio* msg);
+static void send_frame(Timer* t);
+static void send_heartbeats(Timer* t);
+static void stop_run(Timer* t);
+static void print_summary(void);
+static bool write_json(void);
+
+
+/****************************************************************************
+ *
+ * Local Global Variables
+ *
+ ****************************************************************************/
+
+static const int FRAME_INTERVAL = 20;
+static const int HEARTBEAT_INTERVAL = 5000;
+  // The number of frame intervals between two spurts
+static const unsigned SPURT_GAP = 10;
+
+static const char*    host = "localhost";
+static int            port = 5210;
+static const char*    auth_key = "";
+static int            node_cnt = 10;
+static int            spurt_len = 50;
+static int            payload_size = 160;
+static int            duration = 30;
+static int            server_pid = 0;
+static const char*    json_file = 0;
+
+static vector<unique_ptr<Node>> nodes;
+static size_t         logged_in = 0;
+static size_t         disconnects = 0;
+static size_t         talker = 0;
+static unsigned       frame_in_spurt = 0;
+static unsigned       gap_left = 0;
+static uint32_t       seq = 0;
+static uint64_t       frames_sent = 0;
+static uint64_t       frames_expected = 0;
+static uint64_t       frames_received = 0;
+static LatencyHistogram latency;
+static Clock::time_point start_time;
+static double         initial_login_time = -1.0;
+static uint64_t       own_cpu_start = 0;
+static uint64_t       server_cpu_start = 0;
+
+
+/****************************************************************************
+ *
+ * MAIN
+ *
+ ****************************************************************************/
+
+int main(int argc, const char **argv)
+{
+  const struct poptOption options_table[] =
+  {
+    {"host", 0, POPT_ARG_STRING, &host, 0,
+            "The host running svxserver", "<host>"},
+    {"port", 0, POPT_ARG_INT, &port, 0,
+            "The svxserver TCP port", "<port>"},
+    {"auth-key", 0, POPT_ARG_STRING, &auth_key, 0,
+            "The svxserver GLOBAL/AUTH_KEY", "<key>"},
+    {"nodes", 0, POPT_ARG_INT, &node_cnt, 0,
+            "The number of nodes to emulate", "<count>"},
+    {"spurt", 0, POPT_ARG_INT, &spurt_len, 0,
+            "The number of 20ms frames in each talk spurt", "<frames>"},
+    {"payload", 0, POPT_ARG_INT, &payload_size, 0,
+            "The number of bytes of audio in each frame", "<bytes>"},
+    {"duration", 0, POPT_ARG_INT, &duration, 0,
+            "How long to run the test", "<seconds>"},
+    {"server-pid", 0, POPT_ARG_INT, &server_pid, 0,
+            "The process id of svxserver, used to measure its CPU time",
+            "<pid>"},
+    {"json", 0, POPT_ARG_STRING, &json_file, 0,
+            "Write a summary in JSON format to the given file", "<file>"},
+    POPT_AUTOHELP
+    {NULL, 0, 0, NULL, 0}
+  };
+
+  poptContext opt_con = poptGetContext(PROGRAM_NAME, argc, argv,
+                                       options_table, 0);
+  int err = poptGetNextOpt(opt_con);
+  if (err != -1)
+  {
+    cerr << "*** ERROR: " << poptBadOption(opt_con, POPT_BADOPTION_NOALIAS)
+         << ": " << poptStrerror(err) << endl;
+    exit(1);
+  }
+  poptFreeContext(opt_con);
+
+  if ((node_cnt < 2) || (spurt_len < 1) || (duration < 1) ||
+      (payload_size < static_cast<int>(sizeof(seq))) ||
+      (payload_size > MsgAudio::BUFSIZE))
+  {
+    cerr << "*** ERROR: Illegal command line argument. At least two nodes "
+            "are needed and the payload must be between "
+         << sizeof(seq) << " and " << MsgAudio::BUFSIZE << " bytes.\n";
+    exit(1);
+  }
+
+  CppApplication app;
+  cout << PROGRAM_NAME " v" SVXSERVER_VERSION
+          " Copyright (C) 2003-2026 Tobias Blomberg / SM0SVX\n\n";
+  cout << "--- Using the "
+       << ((app.eventLoopBackend() == CppApplication::EVENT_LOOP_EPOLL)
+           ? "epoll" : "select")
+       << " event loop backend\n";
+
+  for (int i=0; i<node_cnt; ++i)
+  {
+    nodes.emplace_back(new Node(host, port, auth_key));
+    Node* node = nodes.back().get();
+    node->loggedIn.connect(sigc::ptr_fun(&node_logged_in));
+    node->disconnected.connect(sigc::ptr_fun(&node_disconnected));
+    node->audioReceived.connect(sigc::ptr_fun(&audio_received));
+    node->connect();
+  }
+
+  start_time = Clock::now();
+  own_cpu_start = ownCpuUsec();
+  processCpuUsec(server_pid, server_cpu_start);
+
+  Timer frame_timer(FRAME_INTERVAL, Timer::TYPE_PERIODIC);
+  frame_timer.expired.connect(sigc::ptr_fun(&send_frame));
+  Timer heartbeat_timer(HEARTBEAT_INTERVAL, Timer::TYPE_PERIODIC);
+  heartbeat_timer.expired.connect(sigc::ptr_fun(&send_heartbeats));
+  Timer stop_timer(1000 * duration);
+  stop_timer.expired.connect(sigc::ptr_fun(&stop_run));
+
+  app.exec();
+
+  print_summary();
+  if ((json_file != 0) && !write_json())
+  {
+    return 1;
+  }
+
+  nodes.clear();
+
+  return 0;
+} /* main */
+
+
+/****************************************************************************
+ *
+ * Functions
+ *
+ ****************************************************************************/
+
+static void node_logged_in(Node* node)
+{
+  if ((++logged_in == nodes.size()) && (initial_login_time < 0.0))
+  {
+    const chrono::duration<double> elapsed = Clock::now() - start_time;
+    initial_login_time = elapsed.count();
+    cout << "--- All " << nodes.size() << " nodes logged in after "
+         << initial_login_time << "s\n";
+  }
+} /* node_logged_in */
+
+
+static void node_disconnected(Node* node)
+{
+  if (logged_in > 0)
+  {
+    --logged_in;
+  }
+  ++disconnects;
+} /* node_disconnected */
+
+
+static void audio_received(MsgAudio* msg)
+{
+  ++frames_received;
+  if (msg->hasTimestamp())
+  {
+    const uint64_t now = Msg::currentTimestamp();
+    latency.add((now - msg->timestamp()) / 1000.0);
+  }
+} /* audio_received */
+
+
+static void send_frame(Timer* t)
+{
+  if (gap_left > 0)
+  {
+    --gap_left;
+    return;
+  }
+
+  Node* node = nodes[talker].get();
+  if (!node->isLoggedIn())
+  {
+    talker = (talker + 1) % nodes.size();
+    return;
+  }
+
+  vector<uint8_t> payload(payload_size, 0);
+  ++seq;
+  memcpy(payload.data(), &seq, sizeof(seq));
+  MsgAudio msg(payload.data(), payload.size(), Msg::currentTimestamp());
+  if (node->send(msg))
+  {
+    ++frames_sent;
+    frames_expected += logged_in - 1;
+  }
+
+    // End the spurt with a flush so that svxserver release the talker and
+    // let the next node in
+  if (++frame_in_spurt >= static_cast<unsigned>(spurt_len))
+  {
+    MsgFlush flush;
+    node->send(flush);
+    frame_in_spurt = 0;
+    gap_left = SPURT_GAP;
+    talker = (talker + 1) % nodes.size();
+  }
+} /* send_frame */
+
+
+static void send_heartbeats(Timer* t)
+{
+  for (auto& node : nodes)
+  {
+    if (node->isLoggedIn())
+    {
+      MsgHeartbeat msg;
+      node->send(msg);
+    }
+  }
+} /* send_heartbeats */
+
+
+static void stop_run(Timer* t)
+{
+  Application::app().quit();
+} /* stop_run */
+
+
+static void print_summary(void)
+{
+  const chrono::duration<double> elapsed = Clock::now() - start_time;
+  cout << fixed << setprecision(1)
+       << "\n--- Summary after " << elapsed.count() << "s\n"
+       << "Nodes logged in:       " << logged_in << "/" << nodes.size()
+       << "\n"
+       << "Frames sent:           " << frames_sent << "\n"
+       << "Frames received:       " << frames_received << " of "
+       << frames_expected << " expected ("
+       << ((frames_expected > 0)
+           ? 100.0 * frames_received / frames_expected : 100.0)
+       << "%)\n"
+       << "Latency ms:            min=" << latency.min()
+       << " avg=" << latency.mean()
+       << " p50=" << latency.percentile(0.5)
+       << " p95=" << latency.percentile(0.95)
+       << " p99=" << latency.percentile(0.99)
+       << " max=" << latency.max() << "\n"
+       << "Load generator CPU:    "
+       << (ownCpuUsec() - own_cpu_start) / 1.0e6 << "s\n";
+  uint64_t server_cpu = 0;
+  if (processCpuUsec(server_pid, server_cpu))
+  {
+    cout << "Server CPU:            "
+         << (server_cpu - server_cpu_start) / 1.0e6 << "s";
+    if (frames_received > 0)
+    {
+      cout << " ("
+           << (static_cast<double>(server_cpu - server_cpu_start) /
+               frames_received)
+           << "us per forwarded frame)";
+    }
+    cout << "\n";
+  }
+  if (disconnects > 0)
+  {
+    cout << "Disconnects:           " << disconnects << "\n";
+  }
+  cout << flush;
+} /* print_summary */
+
+
+static bool write_json(void)
+{
+  const chrono::duration<double> elapsed = Clock::now() - start_time;
+
+  Json::Value root(Json::objectValue);
+  Json::Value& settings = root["settings"];
+  settings["relay"] = "svxserver";
+  settings["host"] = host;
+  settings["port"] = port;
+  settings["nodes"] = node_cnt;
+  settings["spurt"] = spurt_len;
+  settings["payload"] = payload_size;
+
+  root["elapsed_s"] = elapsed.count();
+  root["nodes_logged_in"] = Json::UInt64(logged_in);
+  root["initial_login_s"] =
+    (initial_login_time >= 0.0) ? Json::Value(initial_login_time)
+                                : Json::Value(Json::nullValue);
+
+  Json::Value& frames = root["frames"];
+  frames["sent"] = Json::UInt64(frames_sent);
+  frames["expected"] = Json::UInt64(frames_expected);
+  frames["received"] = Json::UInt64(frames_received);
+  frames["delivery_ratio"] =
+    (frames_expected > 0)
+      ? static_cast<double>(frames_received) / frames_expected : 1.0;
+
+  Json::Value& lat = root["latency_ms"];
+  lat["min"] = latency.min();
+  lat["avg"] = latency.mean();
+  lat["p50"] = latency.percentile(0.5);
+  lat["p95"] = latency.percentile(0.95);
+  lat["p99"] = latency.percentile(0.99);
+  lat["max"] = latency.max();
+
+  root["loadgen_cpu_s"] = (ownCpuUsec() - own_cpu_start) / 1.0e6;
+  uint64_t server_cpu = 0;
+  if (processCpuUsec(server_pid, server_cpu))
+  {
+    root["relay_cpu_s"] = (server_cpu - server_cpu_start) / 1.0e6;
+    if (frames_received > 0)
+    {
+      root["relay_us_per_frame"] =
+        static_cast<double>(server_cpu - server_cpu_start) / frames_received;
+    }
+  }
+  Json::Value& reasons = root["disconnects"];
+  reasons = Json::Value(Json::objectValue);
+  if (disconnects > 0)
+  {
+    reasons["disconnected"] = Json::UInt64(disconnects);
+  }
+
+  ofstream ofs(json_file);
+  Json::StreamWriterBuilder builder;
+  builder["indentation"] = "  ";
+  ofs << Json::writeString(builder, root) << endl;
+  if (!ofs)
+  {
+    cerr << "*** ERROR: Could not write JSON file \"" << json_file
+         << "\"" << endl;
+    return false;
+  }
+  return true;
+} /* write_json */
+
+
+/*
+ * This file has not been truncated
+ */
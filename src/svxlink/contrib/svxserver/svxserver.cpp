@@ -10,7 +10,7 @@ server core (e.g. via a TCP/IP network).
 
 \verbatim
 svxserver - A remote receiver for the SvxLink server
-Copyright (C) 2003-2017 Tobias Blomberg / SM0SVX
+Copyright (C) 2003-2026 Tobias Blomberg / SM0SVX
 
 This program is free software; you can redistribute it and/or modify
 it under the terms of the GNU General Public License as published by
@@ -434,7 +434,7 @@ int main(int argc, char **argv)
   cfg.getValue("GLOBAL", "TIMESTAMP_FORMAT", tstamp_format);
 
   cout << PROGRAM_NAME " v" SVXSERVER_VERSION " (" __DATE__
-          ") Copyright (C) 2003-2015 Tobias Blomberg / SM0SVX\n\n";
+          ") Copyright (C) 2003-2026 Tobias Blomberg / SM0SVX\n\n";
   cout << PROGRAM_NAME " comes with ABSOLUTELY NO WARRANTY. "
           "This is free software, and you are\n";
   cout << "welcome to redistribute it in accordance with the "
@@ -459,6 +459,11 @@ int main(int argc, char **argv)
     stdin_watch->activity.connect(sigc::ptr_fun(&stdinHandler));
   }
 
+  cout << "--- Using the "
+       << ((app.eventLoopBackend() == CppApplication::EVENT_LOOP_EPOLL)
+           ? "epoll" : "select")
+       << " event loop backend" << endl;
+
   SvxServer my_server(cfg);
   app.exec();
 
@@ -6,7 +6,7 @@
 
 \verbatim
 SvxLink - A Multi Purpose Voice Services System for Ham Radio Use
-Copyright (C) 2003-2025 Tobias Blomberg / SM0SVX
+Copyright (C) 2003-2026 Tobias Blomberg / SM0SVX
 
 This program is free software; you can redistribute it and/or modify
 it under the terms of the GNU General Public License as published by
@@ -42,6 +42,8 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 #include <vector>
 #include <algorithm>
 #include <iterator>
+#include <sstream>
+#include <json/json.h>
 
 
 /****************************************************************************
@@ -55,6 +57,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 #include <AsyncAudioSplitter.h>
 #include <AsyncConfig.h>
 #include <AsyncFdWatch.h>
+#include <AsyncTimer.h>
 #include <Tx.h>
 #include <Rx.h>
 #include <common.h>
@@ -70,7 +73,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 #if 0
 #include "../trx/Ptt.h"
 #endif
-#include "../trx/Goertzel.h"
+#include "../trx/GoertzelBank.h"
 #include "../trx/Emphasis.h"
 #include "../trx/RtlSdr.h"
 #include "../trx/Ddr.h"
@@ -237,6 +240,8 @@ class Window
 
     inline size_t size(void) const { return N; }
 
+    inline const float *data(void) const { return w; }
+
     inline float operator[](int i) const { return w[i]; }
 
   protected:
@@ -278,17 +283,20 @@ class DevPrinter : public AudioSink
     DevPrinter(unsigned samp_rate, const vector<float> &mod_fqs,
                float max_dev=1.0f, float headroom_db=0.0f)
       : block_size(samp_rate / 20), w(block_size),
-        g(mod_fqs.size()), samp_cnt(0), max_dev(max_dev),
-        headroom(pow(10.0, headroom_db/20.0)), adj_level(1.0f), dev_est(0.0),
-        block_cnt(0), pwr_sum(0.0), tot_dev_est(0.0f), amp_sum(0.0),
-        fqerr_est(0.0), carrier_fq(0.0)
+        g(mod_fqs, samp_rate), block(block_size), samp_cnt(0),
+        max_dev(max_dev), headroom(pow(10.0, headroom_db/20.0)),
+        adj_level(1.0f), level_offset(0.0f), caldev(0.0f), dev_est(0.0),
+        block_cnt(0), tot_dev_est(0.0f), fqerr_est(0.0), carrier_fq(0.0),
+        json(false), total_blocks(0)
     {
-      for (size_t i=0; i<mod_fqs.size(); ++i)
-      {
-        g[i].initialize(mod_fqs[i], samp_rate);
-      }
     }
 
+    void setName(const string& name) { this->name = name; }
+
+    const string& rxName(void) const { return name; }
+
+    void setJsonOutput(bool json) { this->json = json; }
+
     void adjustLevel(double adj_db)
     {
       adj_level = pow(10.0, adj_db / 20.0);
@@ -303,6 +311,26 @@ class DevPrinter : public AudioSink
       return 20.0 * log10(adj_level);
     }
 
+      // The configured level adjustment, e.g. PREAMP, and the deviation
+      // that it should be adjusted to give
+    void setCalibration(float level_offset, float caldev)
+    {
+      this->level_offset = level_offset;
+      this->caldev = caldev;
+    }
+
+    double levelOffset(void) const { return level_offset; }
+
+      // The level adjustment that would give the calibration deviation
+    double suggestedLevel(void) const
+    {
+      if (dev_est <= 0.0)
+      {
+        return level_offset + levelAdjust();
+      }
+      return level_offset + levelAdjust() + 20.0 * log10(caldev / dev_est);
+    }
+
     void setCarrierFq(double carrier_fq)
     {
       this->carrier_fq = carrier_fq;
@@ -312,59 +340,16 @@ class DevPrinter : public AudioSink
     
     virtual int writeSamples(const float *samples, int count)
     {
-      for (int i=0; i<count; ++i)
+      int pos = 0;
+      while (pos < count)
       {
-        pwr_sum += static_cast<double>(samples[i]) * samples[i];
-        amp_sum += samples[i];
-
-        float windowed = w[samp_cnt] * samples[i];
-        for (size_t i=0; i<g.size(); ++i)
-        {
-          g[i].calc(windowed);
-        }
-        if (++samp_cnt >= block_size)
+        int len = min(count - pos, block_size - samp_cnt);
+        copy(samples + pos, samples + pos + len, block.begin() + samp_cnt);
+        samp_cnt += len;
+        pos += len;
+        if (samp_cnt >= block_size)
         {
-          double avg_power = pwr_sum / block_size;
-          double tot_dev = sqrt(avg_power) * sqrt(2);
-          tot_dev *= adj_level;
-          tot_dev *= headroom * max_dev;
-          tot_dev_est = (1.0-ALPHA) * tot_dev + ALPHA * tot_dev_est;
-          pwr_sum = 0.0;
-
-          double dev = 0.0;
-          for (size_t i=0; i<g.size(); ++i)
-          {
-            dev += g[i].magnitudeSquared();
-          }
-          dev = 2 * sqrt(dev) / block_size;
-          dev *= adj_level;
-          dev *= headroom * max_dev;
-          dev_est = (1.0-ALPHA) * dev + ALPHA * dev_est;
-
-          double fqerr = amp_sum / block_size;
-          fqerr *= adj_level;
-          fqerr *= headroom * max_dev;
-          amp_sum = 0.0;
-          fqerr_est = (1.0-ALPHA) * fqerr + ALPHA * fqerr_est;
-
-          if (++block_cnt >= PRINT_INTERVAL)
-          {
-            cout << "\r\033[K" "Tone dev=" << dev_est
-                 << "  Full bw dev=" << tot_dev_est 
-                 << "  Carrier freq err=" << fqerr_est;
-            if (carrier_fq > 0.0)
-            {
-              int ppm_err =
-                static_cast<int>(round(1000000.0 * fqerr_est / carrier_fq));
-              cout << "(" << ppm_err << "ppm)";
-            }
-            cout.flush();
-            block_cnt = 0;
-          }
-          for (size_t i=0; i<g.size(); ++i)
-          {
-            g[i].reset();
-          }
+          processBlock();
           samp_cnt = 0;
         }
       }
@@ -376,24 +361,144 @@ class DevPrinter : public AudioSink
       sourceAllSamplesFlushed();
     }
 
+    void printStatus(bool is_final=false)
+    {
+      int ppm_err = 0;
+      if (carrier_fq > 0.0)
+      {
+        ppm_err = static_cast<int>(round(1000000.0 * fqerr_est / carrier_fq));
+      }
+      if (json)
+      {
+        Json::Value status(Json::objectValue);
+        if (!name.empty())
+        {
+          status["rx"] = name;
+        }
+        status["toneDev"] = dev_est;
+        status["fullBwDev"] = tot_dev_est;
+        status["carrierFqErr"] = fqerr_est;
+        if (carrier_fq > 0.0)
+        {
+          status["carrierFqErrPpm"] = ppm_err;
+        }
+        if (caldev > 0.0f)
+        {
+          status["level"] = level_offset + levelAdjust();
+          status["suggestedLevel"] = round(100.0 * suggestedLevel()) / 100.0;
+        }
+        status["final"] = is_final;
+        Json::StreamWriterBuilder builder;
+        builder["commentStyle"] = "None";
+        builder["indentation"] = "";
+        cout << Json::writeString(builder, status) << endl;
+        return;
+      }
+
+        // With more than one receiver, one line is printed for each
+        // receiver instead of updating the same line
+      if (name.empty())
+      {
+        cout << "\r\033[K";
+      }
+      else
+      {
+        cout << name << ": ";
+      }
+      cout << "Tone dev=" << dev_est
+           << "  Full bw dev=" << tot_dev_est 
+           << "  Carrier freq err=" << fqerr_est;
+      if (carrier_fq > 0.0)
+      {
+        cout << "(" << ppm_err << "ppm)";
+      }
+      if (caldev > 0.0f)
+      {
+        cout << "  Suggested PREAMP=" << suggestedLevel();
+      }
+      if (!name.empty() || is_final)
+      {
+        cout << endl;
+      }
+      else
+      {
+        cout.flush();
+      }
+    }
+
   private:
     static CONSTEXPR double ALPHA = 0.9;        //!< IIR filter coeff
     static CONSTEXPR size_t PRINT_INTERVAL = 5; //!< Block count
 
-    int           block_size;
-    FlatTopWindow w;
-    vector<Goertzel> g;
-    int           samp_cnt;
-    float         max_dev;
-    double        headroom;
-    double        adj_level;
-    double        dev_est;
-    size_t        block_cnt;
-    double        pwr_sum;
-    double        tot_dev_est;
-    double        amp_sum;
-    double        fqerr_est;
-    double        carrier_fq;
+    int             block_size;
+    FlatTopWindow   w;
+    GoertzelBank    g;
+    vector<float>   block;
+    int             samp_cnt;
+    float           max_dev;
+    double          headroom;
+    double          adj_level;
+    double          level_offset;
+    double          caldev;
+    double          dev_est;
+    size_t          block_cnt;
+    double          tot_dev_est;
+    double          fqerr_est;
+    double          carrier_fq;
+    string          name;
+    bool            json;
+    size_t          total_blocks;
+
+      // All tones are analyzed in one pass over a whole block using a
+      // Goertzel bank, with the window applied on the fly
+    void processBlock(void)
+    {
+      double pwr_sum = 0.0;
+      double amp_sum = 0.0;
+      for (int i=0; i<block_size; ++i)
+      {
+        pwr_sum += static_cast<double>(block[i]) * block[i];
+        amp_sum += block[i];
+      }
+      g.reset();
+      g.calc(block.data(), block_size, w.data());
+
+      double avg_power = pwr_sum / block_size;
+      double tot_dev = sqrt(avg_power) * sqrt(2);
+      tot_dev *= adj_level;
+      tot_dev *= headroom * max_dev;
+
+      double dev = 0.0;
+      for (size_t i=0; i<g.size(); ++i)
+      {
+        dev += g.magnitudeSquared(i);
+      }
+      dev = 2 * sqrt(dev) / block_size;
+      dev *= adj_level;
+      dev *= headroom * max_dev;
+
+      double fqerr = amp_sum / block_size;
+      fqerr *= adj_level;
+      fqerr *= headroom * max_dev;
+
+        // Start the estimators at the first measured value so that a short
+        // measurement is not biased towards zero
+      if (total_blocks++ == 0)
+      {
+        tot_dev_est = tot_dev;
+        dev_est = dev;
+        fqerr_est = fqerr;
+      }
+      tot_dev_est = (1.0-ALPHA) * tot_dev + ALPHA * tot_dev_est;
+      dev_est = (1.0-ALPHA) * dev + ALPHA * dev_est;
+      fqerr_est = (1.0-ALPHA) * fqerr + ALPHA * fqerr_est;
+
+      if (++block_cnt >= PRINT_INTERVAL)
+      {
+        printStatus();
+        block_cnt = 0;
+      }
+    }
 };
 
 
@@ -427,6 +532,8 @@ class DevMeasure : public sigc::trackable
       dev_print.writeSamples(&audio[0], audio.size());
     }
 
+    DevPrinter& printer(void) { return dev_print; }
+
   private:
     float         iold;
     float         qold;
@@ -443,6 +550,10 @@ class DevMeasure : public sigc::trackable
  ****************************************************************************/
 
 static void parse_arguments(int argc, const char **argv);
+static void add_rx_sections(const Config& cfg, const string& sect,
+                            vector<string>& rx_sects);
+static void measurement_done(Timer *t);
+static void print_preamp(void);
 static void stdin_handler(FdWatch *w);
 static void sigterm_handler(int signal);
 
@@ -464,11 +575,14 @@ static bool wb_mode = false;
 static int flat_fq_response = false;
 static string cfgfile;
 static string cfgsect;
+static vector<string> cfgsects;
+static int json_output = false;
+static int duration = 0;
 static FdWatch *stdin_watch = 0;
 static SineGenerator *gen = 0;
-static DevPrinter *dp = 0;
+static vector<DevPrinter*> dps;
 static Tx *tx = 0;
-static Rx *rx = 0;
+static vector<Rx*> rxs;
 static float level_adjust_offset = 0.0f;
 static vector<float> mod_fqs;
 static const char *audio_dev = "alsa:default";
@@ -494,7 +608,7 @@ int main(int argc, const char *argv[])
   parse_arguments(argc, const_cast<const char **>(argv));
 
   cout << PROGRAM_NAME " v" DEVCAL_VERSION
-          " Copyright (C) 2003-2025 Tobias Blomberg / SM0SVX\n\n";
+          " Copyright (C) 2003-2026 Tobias Blomberg / SM0SVX\n\n";
   cout << PROGRAM_NAME " comes with ABSOLUTELY NO WARRANTY. "
           "This is free software, and you\n";
   cout << "are welcome to redistribute it in accordance with the "
@@ -562,55 +676,79 @@ int main(int argc, const char *argv[])
   }
   else if (cal_rx)
   {
-    cfg.getValue(cfgsect, "PREAMP", level_adjust_offset);
-    cout << "--- Initial PREAMP=" << level_adjust_offset << endl;
-
-    cout << "--- Setting SQL_DET=OPEN\n";
-    cfg.setValue(cfgsect, "SQL_DET", "OPEN");
-    cout << "--- Setting DTMF_MUTING=0\n";
-    cfg.setValue(cfgsect, "DTMF_MUTING", "0");
-
-    cout << "--- Use +, - and 0 to adjust PREAMP\n";
-
-    rx = RxFactory::createNamedRx(cfg, cfgsect);
-    if ((rx == 0) || !rx->initialize())
+      // All receivers given on the command line, or all receivers in a
+      // given voter, are calibrated at the same time
+    vector<string> rx_sects;
+    for (const auto& sect : cfgsects)
     {
-      cerr << "*** ERROR: Could not initialize receiver object\n";
-      exit(1);
+      add_rx_sections(cfg, sect, rx_sects);
     }
-    rx->setVerbose(false);
-    AudioSource *prev_src = rx;
-
-    AudioSplitter *splitter = new AudioSplitter;
-    prev_src->registerSink(splitter);
-    prev_src = splitter;
+    const bool multi_rx = (rx_sects.size() > 1);
 
-    if (!flat_fq_response)
+    for (const auto& rx_sect : rx_sects)
     {
-      PreemphasisFilter *preemph = new PreemphasisFilter;
-      prev_src->registerSink(preemph, true);
-      prev_src = preemph;
-    }
-    
-    dp = new DevPrinter(INTERNAL_SAMPLE_RATE, mod_fqs, maxdev, headroom_db);
-    prev_src->registerSink(dp, true);
-    prev_src = 0;
+      float preamp = 0.0f;
+      cfg.getValue(rx_sect, "PREAMP", preamp);
+      cout << "--- " << rx_sect << ": Initial PREAMP=" << preamp << endl;
 
-    if (audio_dev[0] != '\0')
-    {
-      audio_io = new AudioIO(audio_dev, audio_ch);
-      if (!audio_io->open(AudioIO::MODE_WR))
+      cout << "--- " << rx_sect << ": Setting SQL_DET=OPEN\n";
+      cfg.setValue(rx_sect, "SQL_DET", "OPEN");
+      cout << "--- " << rx_sect << ": Setting DTMF_MUTING=0\n";
+      cfg.setValue(rx_sect, "DTMF_MUTING", "0");
+
+      Rx *rx = RxFactory::createNamedRx(cfg, rx_sect);
+      if ((rx == 0) || !rx->initialize())
       {
-        cerr << "*** WARNING: Could not open audio output device \""
-             << audio_dev << "\"\n";
+        cerr << "*** ERROR: Could not initialize receiver object "
+             << rx_sect << "\n";
+        exit(1);
       }
-      else
+      rx->setVerbose(false);
+      rxs.push_back(rx);
+      AudioSource *prev_src = rx;
+
+      AudioSplitter *splitter = new AudioSplitter;
+      prev_src->registerSink(splitter);
+      prev_src = splitter;
+
+      if (!flat_fq_response)
       {
-        splitter->addSink(audio_io, true);
+        PreemphasisFilter *preemph = new PreemphasisFilter;
+        prev_src->registerSink(preemph, true);
+        prev_src = preemph;
       }
+      
+      DevPrinter *dp = new DevPrinter(INTERNAL_SAMPLE_RATE, mod_fqs, maxdev,
+                                      headroom_db);
+      dp->setCalibration(preamp, caldev);
+      dp->setJsonOutput(json_output);
+      if (multi_rx || json_output)
+      {
+        dp->setName(rx_sect);
+      }
+      prev_src->registerSink(dp, true);
+      prev_src = 0;
+      dps.push_back(dp);
+
+        // Only the audio from the first receiver is played
+      if ((audio_io == 0) && (audio_dev[0] != '\0'))
+      {
+        audio_io = new AudioIO(audio_dev, audio_ch);
+        if (!audio_io->open(AudioIO::MODE_WR))
+        {
+          cerr << "*** WARNING: Could not open audio output device \""
+               << audio_dev << "\"\n";
+        }
+        else
+        {
+          splitter->addSink(audio_io, true);
+        }
+      }
+
+      rx->setMuteState(Rx::MUTE_NONE);
     }
 
-    rx->setMuteState(Rx::MUTE_NONE);
+    cout << "--- Use +, - and 0 to adjust PREAMP\n";
   }
   else if (measure)
   {
@@ -625,13 +763,14 @@ int main(int argc, const char *argv[])
       cfg.setValue(wbrx_sect, "SAMPLE_RATE", "");
     }
 
-    rx = RxFactory::createNamedRx(cfg, cfgsect);
+    Rx *rx = RxFactory::createNamedRx(cfg, cfgsect);
     if ((rx == 0) || !rx->initialize())
     {
       cerr << "*** ERROR: Could not initialize receiver object\n";
       exit(1);
     }
     rx->setVerbose(false);
+    rxs.push_back(rx);
     AudioSource *prev_src = rx;
 
     Ddr *ddr = dynamic_cast<Ddr*>(rx);
@@ -646,6 +785,8 @@ int main(int argc, const char *argv[])
     }
     DevMeasure *dev_measure = new DevMeasure(ddr->preDemodSampleRate(), 
                                              mod_fqs, ddr->nbFq());
+    dev_measure->printer().setJsonOutput(json_output);
+    dps.push_back(&dev_measure->printer());
     ddr->preDemod.connect(mem_fun(*dev_measure, &DevMeasure::processPreDemod));
 
     if (audio_dev[0] != '\0')
@@ -666,12 +807,26 @@ int main(int argc, const char *argv[])
 
   cout << "--- Use Q or Ctrl+C to quit\n\n";
 
+    // In batch mode the measurement is stopped after the given time and
+    // the final values are printed
+  Timer *duration_timer = 0;
+  if ((duration > 0) && !cal_tx)
+  {
+    duration_timer = new Timer(1000 * duration);
+    duration_timer->expired.connect(sigc::ptr_fun(&measurement_done));
+  }
+
+    // Stdin may not be a terminal when run from a script
+  const bool is_tty = isatty(STDIN_FILENO);
   struct termios org_termios;
   struct termios termios;
-  tcgetattr(STDIN_FILENO, &org_termios);
-  termios = org_termios;
-  termios.c_lflag &= ~(ICANON | ECHO);
-  tcsetattr(STDIN_FILENO, TCSANOW, &termios);
+  if (is_tty)
+  {
+    tcgetattr(STDIN_FILENO, &org_termios);
+    termios = org_termios;
+    termios.c_lflag &= ~(ICANON | ECHO);
+    tcsetattr(STDIN_FILENO, TCSANOW, &termios);
+  }
   stdin_watch = new FdWatch(STDIN_FILENO, FdWatch::FD_WATCH_RD);
   stdin_watch->activity.connect(sigc::ptr_fun(&stdin_handler));
 
@@ -682,12 +837,19 @@ int main(int argc, const char *argv[])
     audio_io->close();
     delete audio_io;
   }
+  delete duration_timer;
   delete gen;
   delete tx;
-  delete rx;
+  for (auto& rx : rxs)
+  {
+    delete rx;
+  }
 
   delete stdin_watch;
-  tcsetattr(STDIN_FILENO, TCSANOW, &org_termios);
+  if (is_tty)
+  {
+    tcsetattr(STDIN_FILENO, TCSANOW, &org_termios);
+  }
 
   cout.flags(old_cout_flags);
 
@@ -744,6 +906,12 @@ static void parse_arguments(int argc, const char **argv)
             "Flat TX/RX frequency response (no emphasis)", NULL},
     {"measure", 'M', POPT_ARG_NONE, &measure, 0, "Measure deviation", NULL},
     {"wide", 'w', POPT_ARG_NONE, &wb_mode, 0, "Wideband mode", NULL},
+    {"json", 'j', POPT_ARG_NONE, &json_output, 0,
+            "Print the measurements in JSON format, one object per line",
+            NULL},
+    {"duration", 'D', POPT_ARG_INT, &duration, 0,
+            "Stop the measurement after the given time and print the final "
+            "values", "<seconds>"},
     {"audiodev", 'a', POPT_ARG_STRING | POPT_ARGFLAG_SHOW_DEFAULT,
             &audio_dev, 0,
 	    "The audio device to use for audio output",
@@ -755,7 +923,8 @@ static void parse_arguments(int argc, const char **argv)
   int err;
   
   optCon = poptGetContext(PROGRAM_NAME, argc, argv, optionsTable, 0);
-  poptSetOtherOptionHelp(optCon, "<config file> <config section>");
+  poptSetOtherOptionHelp(optCon,
+      "<config file> <config section> [<config section>...]");
   poptReadDefaultConfig(optCon, 0);
   
   err = poptGetNextOpt(optCon);
@@ -779,11 +948,19 @@ static void parse_arguments(int argc, const char **argv)
         break;
       case 1:
         cfgsect = arg;
+        cfgsects.push_back(arg);
         break;
       default:
-        cerr << "*** ERROR: Too many command line arguments\n";
-        poptPrintUsage(optCon, stderr, 0);
-        exit(1);
+        if (!cal_rx)
+        {
+          cerr << "*** ERROR: Too many command line arguments. More than "
+                  "one config section can only be given in RX calibration "
+                  "mode.\n";
+          poptPrintUsage(optCon, stderr, 0);
+          exit(1);
+        }
+        cfgsects.push_back(arg);
+        break;
     }
   }
 
@@ -842,6 +1019,58 @@ static void parse_arguments(int argc, const char **argv)
 } /* parse_arguments */
 
 
+static void add_rx_sections(const Config& cfg, const string& sect,
+                            vector<string>& rx_sects)
+{
+  string type;
+  cfg.getValue(sect, "TYPE", type);
+  if (type != "Voter")
+  {
+    rx_sects.push_back(sect);
+    return;
+  }
+
+    // A voter is expanded into its receivers. Each receiver may be followed
+    // by a ":<delay>" specifier which is not relevant here.
+  string receivers;
+  cfg.getValue(sect, "RECEIVERS", receivers);
+  stringstream ss(receivers);
+  string rx_name;
+  while (getline(ss, rx_name, ','))
+  {
+    rx_name = rx_name.substr(0, rx_name.find(':'));
+    if (!rx_name.empty())
+    {
+      rx_sects.push_back(rx_name);
+    }
+  }
+} /* add_rx_sections */
+
+
+static void measurement_done(Timer *t)
+{
+  for (auto& dp : dps)
+  {
+    dp->printStatus(true);
+  }
+  Application::app().quit();
+} /* measurement_done */
+
+
+static void print_preamp(void)
+{
+  cout << "\r\033[K";
+  for (auto& dp : dps)
+  {
+    if (!dp->rxName().empty())
+    {
+      cout << dp->rxName() << ": ";
+    }
+    cout << "PREAMP=" << (dp->levelAdjust() + dp->levelOffset()) << endl;
+  }
+} /* print_preamp */
+
+
 static void stdin_handler(FdWatch *w)
 {
   char buf[1];
@@ -879,11 +1108,11 @@ static void stdin_handler(FdWatch *w)
       }
       else if (cal_rx)
       {
-        double gain = dp->levelAdjust() + 0.01;
-        dp->adjustLevel(gain);
-        cout << "\r\033[K" "PREAMP="
-             << (dp->levelAdjust() + level_adjust_offset)
-             << endl;
+        for (auto& dp : dps)
+        {
+          dp->adjustLevel(dp->levelAdjust() + 0.01);
+        }
+        print_preamp();
       }
       break;
     }
@@ -900,11 +1129,11 @@ static void stdin_handler(FdWatch *w)
       }
       else if (cal_rx)
       {
-        double gain = dp->levelAdjust() - 0.01;
-        dp->adjustLevel(gain);
-        cout << "\r\033[K" "PREAMP="
-             << (dp->levelAdjust() + level_adjust_offset)
-             << endl;
+        for (auto& dp : dps)
+        {
+          dp->adjustLevel(dp->levelAdjust() - 0.01);
+        }
+        print_preamp();
       }
       break;
     }
@@ -920,10 +1149,11 @@ static void stdin_handler(FdWatch *w)
       }
       else if (cal_rx)
       {
-        dp->adjustLevel(-level_adjust_offset);
-        cout << "\r\033[K" "PREAMP="
-             << (dp->levelAdjust() + level_adjust_offset)
-             << endl;
+        for (auto& dp : dps)
+        {
+          dp->adjustLevel(-dp->levelOffset());
+        }
+        print_preamp();
       }
       break;
     }
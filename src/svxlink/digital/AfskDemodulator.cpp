@@ -6,7 +6,7 @@
 
 \verbatim
 SvxLink - A Multi Purpose Voice Services System for Ham Radio Use
-Copyright (C) 2003-2018 Tobias Blomberg / SM0SVX
+Copyright (C) 2003-2026 Tobias Blomberg / SM0SVX
 
 This program is free software; you can redistribute it and/or modify
 it under the terms of the GNU General Public License as published by
@@ -32,10 +32,10 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 
 #include <cstring>
 #include <cmath>
-#include <iostream>
-#include <iomanip>
-#include <sstream>
-#include <deque>
+#include <vector>
+#include <map>
+#include <memory>
+#include <algorithm>
 
 
 /****************************************************************************
@@ -45,8 +45,6 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
  ****************************************************************************/
 
 #include <AsyncAudioProcessor.h>
-//#include <AsyncAudioClipper.h>
-#include <AsyncAudioFilter.h>
 
 
 /****************************************************************************
@@ -56,7 +54,6 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
  ****************************************************************************/
 
 #include "AfskDemodulator.h"
-//#include "remez.h"
 
 
 /****************************************************************************
@@ -83,124 +80,199 @@ using namespace Async;
  ****************************************************************************/
 
 namespace {
-  class Correlator : public AudioProcessor
+  /*
+   * Reference oscillators for the mark and space frequencies. The table
+   * holds one full period of both oscillators followed by one block more,
+   * so that a whole block can always be mixed using contiguous indices.
+   * Demodulators using the same frequencies share one table.
+   */
+  class ReferenceTable
   {
     public:
-      Correlator(float f0, float f1, unsigned baudrate,
-          unsigned sample_rate=INTERNAL_SAMPLE_RATE)
-        : delay(0), head(0)
+      static const unsigned MAX_BLOCK = 256;
+
+      static shared_ptr<const ReferenceTable> get(unsigned f0, unsigned f1,
+                                                  unsigned sample_rate)
       {
-          // Calculate the optimum value for the delay
-        unsigned samples_per_symbol = sample_rate / baudrate;
-        double max_k_val = 0.0;
-        for (unsigned k=0; k<samples_per_symbol; ++k)
+        typedef map<vector<unsigned>, weak_ptr<const ReferenceTable> > Cache;
+        static Cache cache;
+        vector<unsigned> key = {f0, f1, sample_rate};
+        shared_ptr<const ReferenceTable> table = cache[key].lock();
+        if (table == nullptr)
         {
-          double k_val = abs(cos(2.0 * M_PI * f0 * k / sample_rate)
-              - cos(2.0 * M_PI * f1 * k / sample_rate));
-          if (k_val > max_k_val)
-          {
-            max_k_val = k_val;
-            delay = k;
-          }
+          table = make_shared<const ReferenceTable>(f0, f1, sample_rate);
+          cache[key] = table;
         }
-        cout << "### Delay: " << delay << endl;
-
-        buf = new float[delay];
-        memset(buf, 0, sizeof(float) * delay);
+        return table;
       }
 
-      ~Correlator(void)
+      ReferenceTable(unsigned f0, unsigned f1, unsigned sample_rate)
       {
-        delete [] buf;
+          // The period, in samples, after which both oscillators repeat.
+          // Both single periods divide the sample rate so their least common
+          // multiple do too.
+        unsigned p0 = sample_rate / gcd(f0, sample_rate);
+        unsigned p1 = sample_rate / gcd(f1, sample_rate);
+        period = p0 / gcd(p0, p1) * p1;
+        for (int k=0; k<4; ++k)
+        {
+          osc[k].resize(period + MAX_BLOCK);
+        }
+        for (unsigned n=0; n<period + MAX_BLOCK; ++n)
+        {
+          double w0 = 2.0 * M_PI * f0 * (n % period) / sample_rate;
+          double w1 = 2.0 * M_PI * f1 * (n % period) / sample_rate;
+          osc[0][n] = cos(w0);
+          osc[1][n] = sin(w0);
+          osc[2][n] = cos(w1);
+          osc[3][n] = sin(w1);
+        }
       }
 
-    protected:
-      void processSamples(float *out, const float *in, int len)
+      unsigned      period;
+      vector<float> osc[4];
+
+    private:
+      static unsigned gcd(unsigned a, unsigned b)
       {
-        for (int i=0; i<len; ++i)
+        while (b != 0)
         {
-          out[i] = in[i] * buf[head];
-          buf[head] = in[i];
-          head = (head+1) % delay;
+          unsigned t = a % b;
+          a = b;
+          b = t;
         }
+        return a;
       }
-
-    private:
-      unsigned  delay;
-      float *   buf;
-      unsigned  head;
   };
 
-#if 0
-  class RollingAverage
+
+  /*
+   * A non-coherent mark/space correlator. The incoming signal is mixed
+   * with a quadrature reference oscillator for each of the two frequencies
+   * and each product is summed over one symbol time. The output is the
+   * difference between the energy found at the upper and the lower
+   * frequency. The work is split up in loops over whole blocks, storing
+   * the four mixer outputs in separate arrays, so that the compiler is able
+   * to vectorize the mixing and the energy calculation.
+   */
+  class QuadratureCorrelator : public AudioProcessor
   {
     public:
-      RollingAverage(unsigned order)
-        : delay(order-1, 0), prev(0.0f)
+      QuadratureCorrelator(unsigned f0, unsigned f1, unsigned baudrate,
+                           unsigned sample_rate)
+        : ref(ReferenceTable::get(f0, f1, sample_rate)),
+          window(max(sample_rate / baudrate, 1U)), phase(0),
+          dc_pole(1.0f - 2.0f * M_PI * DC_CUTOFF / sample_rate),
+          dc_prev_in(0.0f), dc_prev_out(0.0f),
+          gain(4.0f / (window * window))
       {
+        for (int k=0; k<4; ++k)
+        {
+          mix[k].assign(window + ReferenceTable::MAX_BLOCK, 0.0f);
+          sum[k] = 0.0;
+        }
       }
 
-      void process(float *dest, const float *src, size_t count)
+    protected:
+      void processSamples(float *dest, const float *src, int count)
       {
-        for (size_t i=0; i<count; ++i)
+        while (count > 0)
         {
-          float in = src[i];
-          float out = in - delay.front() + prev;
-          out /= delay.size();
-          dest[i] = out;
-          prev = out;
-          delay.push_back(in);
-          delay.pop_front();
+          unsigned len = min(static_cast<unsigned>(count),
+                             ReferenceTable::MAX_BLOCK);
+          processBlock(dest, src, len);
+          dest += len;
+          src += len;
+          count -= len;
         }
       }
 
     private:
-      deque<float>  delay;
-      float         prev;
-  };
-#endif
-
-
-  class DcBlocker : public AudioProcessor
-  {
-    public:
-      DcBlocker(size_t order)
-        : order(order), delay(order, 0.0f), prev(0.0f)
+        // The cutoff frequency of the DC blocking filter
+      static constexpr float DC_CUTOFF = 10.0f;
+
+      shared_ptr<const ReferenceTable>  ref;
+      const unsigned                    window;
+      unsigned                          phase;
+      const float                       dc_pole;
+      float                             dc_prev_in;
+      float                             dc_prev_out;
+      const float                       gain;
+      vector<float>                     mix[4];
+      double                            sum[4];
+      float                             blocked[ReferenceTable::MAX_BLOCK];
+      float                             acc[4][ReferenceTable::MAX_BLOCK];
+
+      void processBlock(float *dest, const float *src, unsigned len)
       {
-      }
+          // Remove any DC component
+        float prev_in = dc_prev_in;
+        float prev_out = dc_prev_out;
+        for (unsigned i=0; i<len; ++i)
+        {
+          prev_out = src[i] - prev_in + dc_pole * prev_out;
+          prev_in = src[i];
+          blocked[i] = prev_out;
+        }
+        dc_prev_in = prev_in;
+          // Do not let the filter decay into denormal numbers on silence
+        dc_prev_out = (fabsf(prev_out) > 1.0e-20f) ? prev_out : 0.0f;
 
-      ~DcBlocker(void) {}
-
-      /**
-       * @brief Process incoming samples and put them into the output buffer
-       * @param dest  Destination buffer
-       * @param src   Source buffer
-       * @param count Number of samples in the source buffer
-       *
-       * This function do the actual processing of the incoming samples. All
-       * samples must be processed, otherwise they are lost and the output
-       * buffer will contain garbage.
-       */
-      virtual void processSamples(float *dest, const float *src, int count)
-      {
-        for (int i=0; i<count; ++i)
+          // Mix with the reference oscillators. The mixer outputs are stored
+          // after the last window of mixer outputs from the previous block.
+        for (int k=0; k<4; ++k)
         {
-          float in = src[i];
-          float out = (in - delay.back()) / order + prev;
-          //dest[i] = delay[order/2]-out;
-          dest[i] = in-out;
-          prev = out;
-          delay.pop_back();
-          delay.push_front(in);
+          const float *osc = &ref->osc[k][phase];
+          float *out = &mix[k][window];
+          for (unsigned i=0; i<len; ++i)
+          {
+            out[i] = blocked[i] * osc[i];
+          }
         }
-      }
+        phase = (phase + len) % ref->period;
+
+          // Run the sum over one symbol time. A double is used for the sums
+          // so that rounding errors do not build up over time.
+          // The four sums are run in the same loop so that their dependency
+          // chains can execute in parallel.
+        const float *m0 = &mix[0][0];
+        const float *m1 = &mix[1][0];
+        const float *m2 = &mix[2][0];
+        const float *m3 = &mix[3][0];
+        double s0 = sum[0];
+        double s1 = sum[1];
+        double s2 = sum[2];
+        double s3 = sum[3];
+        for (unsigned i=0; i<len; ++i)
+        {
+          s0 += m0[window + i] - m0[i];
+          s1 += m1[window + i] - m1[i];
+          s2 += m2[window + i] - m2[i];
+          s3 += m3[window + i] - m3[i];
+          acc[0][i] = s0;
+          acc[1][i] = s1;
+          acc[2][i] = s2;
+          acc[3][i] = s3;
+        }
+        sum[0] = s0;
+        sum[1] = s1;
+        sum[2] = s2;
+        sum[3] = s3;
 
-    private:
-      const size_t  order;
-      deque<float>  delay;
-      float         prev;
+          // Calculate the energy difference between the two frequencies
+        for (unsigned i=0; i<len; ++i)
+        {
+          dest[i] = gain * (acc[2][i] * acc[2][i] + acc[3][i] * acc[3][i] -
+                            acc[0][i] * acc[0][i] - acc[1][i] * acc[1][i]);
+        }
 
-  }; /* class DcBlocker */
+          // Save the last window of mixer outputs for the next block
+        for (int k=0; k<4; ++k)
+        {
+          memmove(&mix[k][0], &mix[k][len], window * sizeof(float));
+        }
+      }
+  };
 }; /* Anonymous namespace */
 
 
@@ -224,68 +296,6 @@ namespace {
  *
  ****************************************************************************/
 
-#if 0
-namespace {
-  const double pre_filter_taps[] =
-  {
-    -0.0497607774343533,
-    -0.0414626205397930,
-    0.0147754767686696,
-    -0.0050460885570081,
-    0.0126147216425678,
-    -0.0264073840416123,
-    0.0296003565900331,
-    -0.0130149931857980,
-    -0.0144000295612727,
-    0.0295301867452591,
-    -0.0152325941654806,
-    -0.0201650467073737,
-    0.0449705722700260,
-    -0.0314722795301329,
-    -0.0147694650389599,
-    0.0541293567854939,
-    -0.0469861720933350,
-    -0.0064907618162468,
-    0.0607226391419224,
-    -0.0637607134140635,
-    0.0074537437539216,
-    0.0603289683874208,
-    -0.0769560352643945,
-    0.0239509524606725,
-    0.0532261698461783,
-    -0.0844641222378282,
-    0.0403188191263031,
-    0.0403188191263031,
-    -0.0844641222378282,
-    0.0532261698461783,
-    0.0239509524606725,
-    -0.0769560352643945,
-    0.0603289683874208,
-    0.0074537437539216,
-    -0.0637607134140635,
-    0.0607226391419224,
-    -0.0064907618162468,
-    -0.0469861720933350,
-    0.0541293567854939,
-    -0.0147694650389599,
-    -0.0314722795301329,
-    0.0449705722700260,
-    -0.0201650467073737,
-    -0.0152325941654806,
-    0.0295301867452591,
-    -0.0144000295612727,
-    -0.0130149931857980,
-    0.0296003565900331,
-    -0.0264073840416123,
-    0.0126147216425678,
-    -0.0050460885570081,
-    0.0147754767686696,
-    -0.0414626205397930,
-    -0.0497607774343533
-  };
-  const int numtaps = sizeof(pre_filter_taps) / sizeof(*pre_filter_taps);
-};
-#endif
 
 
 /****************************************************************************
@@ -298,100 +308,17 @@ AfskDemodulator::AfskDemodulator(unsigned f0, unsigned f1, unsigned baudrate,
                                  unsigned sample_rate)
   : f0(f0), f1(f1), baudrate(baudrate)
 {
-  AudioSource *prev_src = 0;
-
-  //assert(f0 == 5415);
-  //assert(f1 == 5585);
-  //assert(baudrate == 300);
-  assert(sample_rate == 16000);
-
-    // Clip the signal to eliminate level differences
-  /*
-  AudioClipper *clipper = new AudioClipper(0.05);
-  AudioSink::setHandler(clipper);
-  prev_src = clipper;
-  */
-
-  DcBlocker *dc_blocker = new DcBlocker(sample_rate / 10);
-  AudioSink::setHandler(dc_blocker);
-  prev_src = dc_blocker;
-
-
-#if 0
-    // Apply a bandpass filter to filter out the AFSK signal.
-    // The constructed filter is a FIR filter with linear phase.
-    // The Parks-Macclellan algorithm is used to design the filter.
-    // The length of the filter is chosen to be one symbol long to not cause
-    // inter symbol interference (ISI).
-  const int numtaps = sample_rate / baudrate;
-  const int numband = 3;
-  const double bands[] = {
-    0.0,
-    (f0-baudrate/2.0-200.0)/sample_rate,
-    (f0-baudrate/2.0)/sample_rate,
-    (f1+baudrate/2.0)/sample_rate,
-    (f1+baudrate/2.0+200.0)/sample_rate,
-    0.5
-  };
-  const double des[] = {0.0, 0.0, 1.0, 1.0, 0.0, 0.0};
-  const double weight[] = {1.0, 1.0, 1.0};
-  const int type = BANDPASS;
-  const int griddensity = 16;
-  double pre_filter_taps[numtaps];
-  int ret = remez(pre_filter_taps, numtaps, numband, bands, des, weight, type,
-                  griddensity);
-  assert(ret == 0);
-#endif
-  /*
-  cout << "ret=" << ret << endl;
-  for (int i=0; i<numtaps; ++i)
-  {
-    cout << pre_filter_taps[i] << endl;
-  }
-  */
-#if 0
-  if ((f0 == 5415) && (f1 == 5585) && (baudrate == 300))
-  {
-    stringstream ss;
-    //ss << "BpBu3/" << (f0 - baudrate/2) << "-" << (f1 + baudrate/2);
-    ss << fixed << setprecision(9);
-    ss << "x";
-    for (int i=0; i<numtaps; ++i)
-    {
-      ss << " " << pre_filter_taps[i];
-    }
-    cout << "### AFSK RX Passband filter: " << ss.str() << endl;
-    AudioFilter *passband_filter = new AudioFilter(ss.str(), sample_rate);
-    //AudioSink::setHandler(passband_filter);
-    prev_src->registerSink(passband_filter, true);
-    prev_src = passband_filter;
-    AudioFilter *passband_filter2 = new AudioFilter(ss.str(), sample_rate);
-    prev_src->registerSink(passband_filter2, true);
-    prev_src = passband_filter2;
-  }
-#endif
-
-    // Run the sample stream through the correlator
-  Correlator *corr = new Correlator(f0, f1, baudrate, sample_rate);
-  prev_src->registerSink(corr, true);
-  prev_src = corr;
-
-    // Low pass out the constant component from the correlator
-  stringstream ss("");
-  ss << "LpBu5/" << baudrate;
-  cout << "### Correlator filter: " << ss.str() << endl;
-  AudioFilter *corr_filter = new AudioFilter(ss.str(), sample_rate);
-  corr_filter->setOutputGain(10);
-  prev_src->registerSink(corr_filter, true);
-  prev_src = corr_filter;
-
-  AudioSource::setHandler(prev_src);
+  QuadratureCorrelator *corr =
+    new QuadratureCorrelator(f0, f1, baudrate, sample_rate);
+  AudioSink::setHandler(corr);
+  AudioSource::setHandler(corr);
 } /* AfskDemodulator::AfskDemodulator */
 
 
 AfskDemodulator::~AfskDemodulator(void)
 {
   AudioSink *handler = AudioSink::handler();
+  AudioSource::clearHandler();
   AudioSink::clearHandler();
   delete handler;
 } /* AfskDemodulator::~AfskDemodulator */
@@ -6,7 +6,7 @@
 
 \verbatim
 SvxLink - A Multi Purpose Voice Services System for Ham Radio Use
-Copyright (C) 2003-2018 Tobias Blomberg / SM0SVX
+Copyright (C) 2003-2026 Tobias Blomberg / SM0SVX
 
 This program is free software; you can redistribute it and/or modify
 it under the terms of the GNU General Public License as published by
@@ -112,18 +112,18 @@ stream. The output is a sample stream of high and low DC values corresponding
 to the high and low AFSK frequencies. The demodulated sample stream will have
 to be bit synchronized and downsampled in the next stage.
 
-The method used to demodulate the signal is to correlate a sample with a
-previous sample of the same signal, an autocorrelation. This will produce the
-output signal consisting of the two DC levels. The delay used in the correlator
-is optimized to maximize the difference between the high and low frequencies.
-
-  cos(x) * cos(x-phi) =
-  cos(x) * (cos(x)*cos(phi) + sin(x)*sin(phi)) =
-  cos(x)*cos(x)*cos(phi) + cos(x)*sin(x)*sin(phi) =
-  0.5*cos(2x)*cos(phi) + 0.5*(1 - sin(2x))*sin(phi) =
-  [low pass filter to remote the 2x frequency component] =
-  0.5 * sin(phi)
-
+The method used to demodulate the signal is a non-coherent quadrature
+correlator. The signal is mixed with a cosine and a sine reference oscillator
+for each of the two frequencies and each product is summed over one symbol
+time. The output is the difference between the energy found at the upper and
+the lower frequency and so will be positive when the upper frequency is
+received and negative when the lower frequency is received.
+
+The samples are processed in blocks with the four mixer outputs stored in
+separate arrays so that the compiler is able to vectorize the calculations.
+The reference oscillator tables are shared between all demodulators using the
+same frequencies and sample rate, so a site running many receivers with AFSK
+enabled only keep one copy of them.
 */
 class AfskDemodulator : public Async::AudioSink, public Async::AudioSource
 {
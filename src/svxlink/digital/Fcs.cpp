@@ -151,7 +151,7 @@ namespace {
  *
  ****************************************************************************/
 
-uint16_t fcsCalc(const std::vector<uint8_t> buf)
+uint16_t fcsCalc(const std::vector<uint8_t> &buf)
 {
   uint16_t fcs = PPPINITFCS;
   fcs = pppfcs(fcs, buf.data(), buf.size());
@@ -160,7 +160,7 @@ uint16_t fcsCalc(const std::vector<uint8_t> buf)
 } /* fcsCalc */
 
 
-bool fcsOk(const std::vector<uint8_t> buf)
+bool fcsOk(const std::vector<uint8_t> &buf)
 {
   uint16_t fcs = PPPINITFCS;
   fcs = pppfcs(fcs, buf.data(), buf.size());
@@ -107,14 +107,14 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
  * @param   buf The buffer containing the data bytes
  * @return  Return the 16 bit frame check sequence
  */
-uint16_t fcsCalc(const std::vector<uint8_t> buf);
+uint16_t fcsCalc(const std::vector<uint8_t> &buf);
 
 /**
  * @brief   Check if the buffer contain a valid data stream
  * @param   buf The buffer containing the data bytes and the transmitted FCS
  * @return  Returns \em true on success or \em false on failure
  * */
-bool fcsOk(const std::vector<uint8_t> buf);
+bool fcsOk(const std::vector<uint8_t> &buf);
 
 
 //} /* namespace */
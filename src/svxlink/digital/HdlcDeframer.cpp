@@ -75,6 +75,57 @@ using namespace std;
  *
  ****************************************************************************/
 
+namespace {
+  /*
+   * For each possible byte, find out how many ones that may have been
+   * received right before it for the byte to be free of stuffed bits and
+   * flags. A byte containing five ones in a row can never be handled as a
+   * whole. The number of ones at the end of the byte is also stored since
+   * that is needed to handle the next byte.
+   */
+  class FastPathTable
+  {
+    public:
+      struct Entry
+      {
+        int8_t  max_ones;
+        uint8_t trailing_ones;
+      };
+
+      Entry entry[256];
+
+      FastPathTable(void)
+      {
+        for (unsigned byte=0; byte<256; ++byte)
+        {
+          unsigned leading = 0;
+          while ((leading < 8) && (byte & (1 << leading)))
+          {
+            ++leading;
+          }
+          unsigned trailing = 0;
+          while ((trailing < 8) && (byte & (0x80 >> trailing)))
+          {
+            ++trailing;
+          }
+          unsigned max_run = 0;
+          unsigned run = 0;
+          for (unsigned bit=0; bit<8; ++bit)
+          {
+            run = (byte & (1 << bit)) ? run + 1 : 0;
+            if (run > max_run)
+            {
+              max_run = run;
+            }
+          }
+          entry[byte].max_ones = (max_run < 5) ? 4 - leading : -1;
+          entry[byte].trailing_ones = trailing;
+        }
+      }
+  };
+};
+
+
 
 
 /****************************************************************************
@@ -99,6 +150,10 @@ using namespace std;
  *
  ****************************************************************************/
 
+namespace {
+  const FastPathTable fast_path_tab;
+};
+
 
 
 /****************************************************************************
@@ -122,112 +177,55 @@ void HdlcDeframer::bitsReceived(vector<bool> &bits)
 {
   for (size_t i=0; i<bits.size(); ++i)
   {
-    bool flag_detected = false;
+    handleBit(bits[i]);
+  }
+} /* HdlcDeframer::bitsReceived */
 
-      // Undo bitstuffing. If we receive a zero and the previous five bits
-      // have been ones, the zero should be thrown away.
-    if (bits[i])
-    {
-      ones += 1;
-    }
-    else
+
+void HdlcDeframer::packedBitsReceived(const vector<uint8_t> &bytes)
+{
+  for (size_t i=0; i<bytes.size(); ++i)
+  {
+    const unsigned byte = bytes[i];
+    const FastPathTable::Entry &entry = fast_path_tab.entry[byte];
+
+      // A byte that cannot contain a stuffed bit or the end of a flag is
+      // handled as a whole in the synchronizing and receiving states.
+      // In the synchronizing state a flag may still be found when a stuffed
+      // bit was removed in the previous byte so that is checked separately.
+    if (static_cast<int>(ones) <= entry.max_ones)
     {
-      if (ones == 5)
+      if (state == STATE_SYNCHRONIZING)
       {
-        ones = 0;
-        continue;
+        const unsigned window = next_byte | (byte << 8);
+        bool flag_found = false;
+        for (unsigned shift=1; shift<=8; ++shift)
+        {
+          flag_found |= (((window >> shift) & 0xff) == 0x7e);
+        }
+        if (!flag_found)
+        {
+          next_byte = byte;
+          ones = entry.trailing_ones;
+          continue;
+        }
       }
-      else if (ones == 6)
+      else if ((state == STATE_RECEIVING) && (frame.size() < 330))
       {
-        flag_detected = true;
+        const unsigned shift = 8 - bit_cnt;
+        frame.push_back(((next_byte >> shift) | (byte << bit_cnt)) & 0xff);
+        next_byte = byte & (0xff << shift);
+        ones = entry.trailing_ones;
+        continue;
       }
-      ones = 0;
     }
 
-    next_byte >>= 1;
-    next_byte |= (bits[i] << 7);
-    switch (state)
+    for (unsigned bit=0; bit<8; ++bit)
     {
-      case STATE_SYNCHRONIZING:
-        if (next_byte == 0x7e)
-        {
-          state = STATE_FRAME_START_WAIT;
-          bit_cnt = 0;
-        }
-        break;
-
-      case STATE_FRAME_START_WAIT:
-        if (++bit_cnt >= 8)
-        {
-          if (next_byte != 0x7e)
-          {
-            state = STATE_RECEIVING;
-            frame.clear();
-            frame.push_back(next_byte);
-          }
-          //frame.push_back(next_byte);
-          bit_cnt = 0;
-        }
-        else if (next_byte == 0x7e)
-        {
-          bit_cnt = 0;
-          //frame.clear();
-          //frame.push_back(next_byte);
-        }
-        break;
-
-      case STATE_RECEIVING:
-        if (++bit_cnt >= 8)
-        {
-          if (flag_detected)
-          {
-            state = STATE_FRAME_START_WAIT;
-            /*
-            for (size_t i=0; i<frame.size(); ++i)
-            {
-              if (isprint(frame[i]))
-              {
-                cout << setw(2) << setfill(' ') << (char)frame[i];
-              }
-              else
-              {
-                cout << hex << setw(2) << setfill('0')
-                     << (int)frame[i] << " ";
-              }
-            }
-            cout << endl << endl;
-            */
-            if ((frame.size() > 2) && fcsOk(frame))
-            {
-                // Remove CRC from frame
-              frame.pop_back();
-              frame.pop_back();
-              frameReceived(frame);
-            }
-          }
-          else
-          {
-            if(frame.size() < 330)
-            {
-              frame.push_back(next_byte);
-              next_byte = 0;
-            }
-            else
-            {
-              state = STATE_SYNCHRONIZING;
-            }
-          }
-          bit_cnt = 0;
-        }
-        else if (flag_detected)
-        {
-          state = STATE_FRAME_START_WAIT;
-          bit_cnt = 0;
-        }
-        break;
+      handleBit((byte >> bit) & 0x01);
     }
   }
-} /* HdlcDeframer::bitsReceived */
+} /* HdlcDeframer::packedBitsReceived */
 
 
 /****************************************************************************
@@ -244,6 +242,114 @@ void HdlcDeframer::bitsReceived(vector<bool> &bits)
  *
  ****************************************************************************/
 
+void HdlcDeframer::handleBit(bool bit)
+{
+  bool flag_detected = false;
+
+    // Undo bitstuffing. If we receive a zero and the previous five bits
+    // have been ones, the zero should be thrown away.
+  if (bit)
+  {
+    ones += 1;
+  }
+  else
+  {
+    if (ones == 5)
+    {
+      ones = 0;
+      return;
+    }
+    else if (ones == 6)
+    {
+      flag_detected = true;
+    }
+    ones = 0;
+  }
+
+  next_byte >>= 1;
+  next_byte |= (bit << 7);
+  switch (state)
+  {
+    case STATE_SYNCHRONIZING:
+      if (next_byte == 0x7e)
+      {
+        state = STATE_FRAME_START_WAIT;
+        bit_cnt = 0;
+      }
+      break;
+
+    case STATE_FRAME_START_WAIT:
+      if (++bit_cnt >= 8)
+      {
+        if (next_byte != 0x7e)
+        {
+          state = STATE_RECEIVING;
+          frame.clear();
+          frame.push_back(next_byte);
+        }
+        //frame.push_back(next_byte);
+        bit_cnt = 0;
+      }
+      else if (next_byte == 0x7e)
+      {
+        bit_cnt = 0;
+        //frame.clear();
+        //frame.push_back(next_byte);
+      }
+      break;
+
+    case STATE_RECEIVING:
+      if (++bit_cnt >= 8)
+      {
+        if (flag_detected)
+        {
+          state = STATE_FRAME_START_WAIT;
+          /*
+          for (size_t i=0; i<frame.size(); ++i)
+          {
+            if (isprint(frame[i]))
+            {
+              cout << setw(2) << setfill(' ') << (char)frame[i];
+            }
+            else
+            {
+              cout << hex << setw(2) << setfill('0')
+                   << (int)frame[i] << " ";
+            }
+          }
+          cout << endl << endl;
+          */
+          if ((frame.size() > 2) && fcsOk(frame))
+          {
+              // Remove CRC from frame
+            frame.pop_back();
+            frame.pop_back();
+            frameReceived(frame);
+          }
+        }
+        else
+        {
+          if(frame.size() < 330)
+          {
+            frame.push_back(next_byte);
+            next_byte = 0;
+          }
+          else
+          {
+            state = STATE_SYNCHRONIZING;
+          }
+        }
+        bit_cnt = 0;
+      }
+      else if (flag_detected)
+      {
+        state = STATE_FRAME_START_WAIT;
+        bit_cnt = 0;
+      }
+      break;
+  }
+} /* HdlcDeframer::handleBit */
+
 
 
 /*
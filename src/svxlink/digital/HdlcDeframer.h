@@ -132,6 +132,18 @@ class HdlcDeframer : public sigc::trackable
      */
     void bitsReceived(std::vector<bool> &bits);
 
+    /**
+     * @brief 	Process a bitstream packed into bytes
+     * @param 	bytes The bitstream to process, eight bits to a byte with the
+     *                first bit in the least significant bit
+     *
+     * This function process the same kind of bitstream as the bitsReceived
+     * function but a whole byte at a time when possible. Bytes that cannot
+     * contain a stuffed bit or a flag are found using a lookup table and are
+     * handled without looking at the individual bits.
+     */
+    void packedBitsReceived(const std::vector<uint8_t> &bytes);
+
     /**
      * @brief 	Signal that is emitted when a complete frame have been received
      * @param 	frame The received frame bytes
@@ -151,6 +163,7 @@ class HdlcDeframer : public sigc::trackable
 
     HdlcDeframer(const HdlcDeframer&);
     HdlcDeframer& operator=(const HdlcDeframer&);
+    void handleBit(bool bit);
 
 };  /* class HdlcDeframer */
 
@@ -133,7 +133,9 @@ void HdlcFramer::sendBytes(const vector<uint8_t> &frame)
     bitbuf.push_back(prev_was_mark);
   }
 
-    // Store frame data
+    // Store frame data. The flags end with a zero, so the bit stuffing
+    // starts over.
+  ones = 0;
   for (size_t i=0; i<frame.size(); ++i)
   {
     encodeByte(bitbuf, frame[i]);
@@ -107,8 +107,8 @@ using namespace std;
 
 Synchronizer::Synchronizer(unsigned baudrate, unsigned sample_rate)
   : baudrate(baudrate), sample_rate(sample_rate),
-    shift_pos(sample_rate / 2), pos(0), was_mark(false),
-    last_stored_was_mark(false)
+    shift_pos(sample_rate / 2), pos(0), next_byte(0), bit_cnt(0),
+    was_mark(false), last_stored_was_mark(false)
 {
 } /* Synchronizer::Synchronizer */
 
@@ -144,25 +144,46 @@ int Synchronizer::writeSamples(const float *samples, int len)
       // Extract bit if pos >= sample_rate
     if (pos >= sample_rate)
     {
-      bitbuf.push_back(is_mark == last_stored_was_mark);
+      bool bit = (is_mark == last_stored_was_mark);
       last_stored_was_mark = is_mark;
-      if (bitbuf.size() >= 8)
+
+        // Pack the bits into bytes, first bit in the least significant bit
+      next_byte |= static_cast<uint8_t>(bit) << bit_cnt;
+      if (++bit_cnt >= 8)
+      {
+        bytebuf.push_back(next_byte);
+        next_byte = 0;
+        bit_cnt = 0;
+      }
+
+        // Only build the unpacked bit vector if someone want it
+      if (!bitsReceived.empty())
       {
-        /*
-        for (size_t i=0; i<bitbuf.size(); ++i)
+        bitbuf.push_back(bit);
+        if (bitbuf.size() >= 8)
         {
-          cout << (bitbuf[i] ? '1' : '0');
+          /*
+          for (size_t i=0; i<bitbuf.size(); ++i)
+          {
+            cout << (bitbuf[i] ? '1' : '0');
+          }
+          float err_percent = 100.0 * static_cast<float>(err) / sample_rate;
+          cout << "  " << err << " " << err_percent << "%" << endl;
+          */
+          bitsReceived(bitbuf);
+          bitbuf.clear();
         }
-        float err_percent = 100.0 * static_cast<float>(err) / sample_rate;
-        cout << "  " << err << " " << err_percent << "%" << endl;
-        */
-        bitsReceived(bitbuf);
-        bitbuf.clear();
       }
       pos -= sample_rate;
     }
   }
 
+  if (!bytebuf.empty())
+  {
+    packedBitsReceived(bytebuf);
+    bytebuf.clear();
+  }
+
   return len;
 } /* Synchronizer::writeSamples */
 
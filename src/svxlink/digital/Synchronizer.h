@@ -36,6 +36,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 
 #include <vector>
 #include <sigc++/sigc++.h>
+#include <stdint.h>
 
 
 /****************************************************************************
@@ -156,15 +157,30 @@ class Synchronizer : public Async::AudioSink, public sigc::trackable
      */
     sigc::signal<void(std::vector<bool>&)> bitsReceived;
 
+    /**
+     * @brief   A signal emitted when new bits have been received
+     * @param   A vector of received bits packed eight to a byte
+     *
+     * This signal carry the same bitstream as the bitsReceived signal but
+     * with the bits packed into bytes, the first received bit in the least
+     * significant bit. Only complete bytes are emitted and the signal is
+     * emitted at most once for each block of samples written. Using this
+     * signal instead of bitsReceived save a lot of per bit overhead.
+     */
+    sigc::signal<void(const std::vector<uint8_t>&)> packedBitsReceived;
+
   private:
     const unsigned    baudrate;
     const unsigned    sample_rate;
     const unsigned    shift_pos;
     unsigned          pos;
-    std::vector<bool> bitbuf;
-    bool              was_mark;
-    bool              last_stored_was_mark;
-    int               err;
+    std::vector<bool>     bitbuf;
+    std::vector<uint8_t>  bytebuf;
+    uint8_t               next_byte;
+    unsigned              bit_cnt;
+    bool                  was_mark;
+    bool                  last_stored_was_mark;
+    int                   err;
 
     Synchronizer(const Synchronizer&);
     Synchronizer& operator=(const Synchronizer&);
@@ -4,6 +4,9 @@
  * sox TNC_Test_Ver-1.1-01.wav -t raw -esigned-integer -c1 -r 16000 - | \
  * valgrind --leak-check=full svxlink/digital/afsk_test
  *
+ * Measure the throughput of the HDLC deframer with:
+ * svxlink/digital/afsk_test --bench [frame count]
+ *
  ******************************************************************************/
 
 #include <iostream>
@@ -12,6 +15,7 @@
 
 #include <cstdlib>
 #include <cstring>
+#include <chrono>
 #include <unistd.h>
 
 #include <AsyncCppApplication.h>
@@ -329,8 +333,87 @@ class StdInSourceDev : public StdInSource
 };
 
 
+  /*
+   * Feed the same bitstream, containing HDLC frames generated by the framer,
+   * to one deframer one bit at a time and to another deframer with the bits
+   * packed into bytes. The number of frames found and the throughput of
+   * each is printed.
+   */
+static int benchmarkDeframer(unsigned frame_cnt)
+{
+  vector<bool> marks;
+  HdlcFramer framer;
+  framer.sendBits.connect([&](const vector<bool>& bits) {
+      marks.insert(marks.end(), bits.begin(), bits.end());
+    });
+  for (unsigned i=0; i<frame_cnt; ++i)
+  {
+    vector<uint8_t> frame(20 + rand() % 300);
+    for (size_t j=0; j<frame.size(); ++j)
+    {
+      frame[j] = rand() & 0xff;
+    }
+      // Start the frame like an AX.25 address, a shifted callsign character
+    frame[0] = ('A' + rand() % 26) << 1;
+    framer.sendBytes(frame);
+  }
+
+    // Undo NRZI coding the same way as the synchronizer do and produce
+    // both an unpacked and a packed bitstream
+  vector<bool> bits;
+  vector<uint8_t> bytes((marks.size() + 7) / 8, 0);
+  bool prev_mark = false;
+  for (size_t i=0; i<marks.size(); ++i)
+  {
+    bool bit = (marks[i] == prev_mark);
+    prev_mark = marks[i];
+    bits.push_back(bit);
+    bytes[i / 8] |= static_cast<uint8_t>(bit) << (i % 8);
+  }
+
+  unsigned unpacked_cnt = 0;
+  HdlcDeframer unpacked;
+  unpacked.frameReceived.connect([&](vector<uint8_t>&) { ++unpacked_cnt; });
+  chrono::steady_clock::time_point start = chrono::steady_clock::now();
+  vector<bool> chunk;
+  for (size_t i=0; i<bits.size(); i+=8)
+  {
+    chunk.assign(bits.begin() + i, bits.begin() + min(i + 8, bits.size()));
+    unpacked.bitsReceived(chunk);
+  }
+  chrono::duration<double> unpacked_time = chrono::steady_clock::now() - start;
+
+  unsigned packed_cnt = 0;
+  HdlcDeframer packed;
+  packed.frameReceived.connect([&](vector<uint8_t>&) { ++packed_cnt; });
+  start = chrono::steady_clock::now();
+  vector<uint8_t> byte_chunk;
+  for (size_t i=0; i<bytes.size(); i+=32)
+  {
+    byte_chunk.assign(bytes.begin() + i,
+                      bytes.begin() + min(i + 32, bytes.size()));
+    packed.packedBitsReceived(byte_chunk);
+  }
+  chrono::duration<double> packed_time = chrono::steady_clock::now() - start;
+
+  cout << "Deframed " << frame_cnt << " frames, " << bits.size()
+       << " bits\n";
+  cout << "Unpacked: " << unpacked_cnt << " frames, "
+       << bits.size() / unpacked_time.count() / 1.0e6 << " Mbit/s\n";
+  cout << "Packed:   " << packed_cnt << " frames, "
+       << bits.size() / packed_time.count() / 1.0e6 << " Mbit/s\n";
+
+  return ((unpacked_cnt == frame_cnt) && (packed_cnt == frame_cnt)) ? 0 : 1;
+} /* benchmarkDeframer */
+
+
 int main(int argc, const char **argv)
 {
+  if ((argc > 1) && (strcmp(argv[1], "--bench") == 0))
+  {
+    return benchmarkDeframer((argc > 2) ? atoi(argv[2]) : 100000);
+  }
+
   // 1200Bd AMPR
 #if 1
   unsigned baudrate = 1200;
@@ -379,6 +379,7 @@ void ModuleDtmfRepeater::onRepeatDelayExpired(void)
 void ModuleDtmfRepeater::sendStoredDigits(void)
 {
   cout << name() << ": Sending DTMF digits " << received_digits << endl;
+  squelchCloseHandled();
   sendDtmf(received_digits);
   received_digits.clear();
 } /* ModuleDtmfRepeater::sendStoredDigits */
@@ -52,10 +52,12 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 #include <AsyncAudioSplitter.h>
 #include <AsyncAudioValve.h>
 #include <AsyncAudioSelector.h>
+#include <AsyncAudioResampler.h>
 #include <EchoLinkDirectory.h>
 #include <EchoLinkDispatcher.h>
 #include <EchoLinkProxy.h>
 #include <LocationInfo.h>
+#include <EventHandler.h>
 #include <common.h>
 
 
@@ -71,6 +73,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 #include "version/MODULE_ECHO_LINK.h"
 #include "ModuleEchoLink.h"
 #include "QsoImpl.h"
+#include "SharedEncoder.h"
 
 
 /****************************************************************************
@@ -169,7 +172,8 @@ ModuleEchoLink::ModuleEchoLink(void *dl_handle, Logic *logic,
     listen_only_valve(0), selector(0), num_con_max(0), num_con_ttl(5*60),
     num_con_block_time(120*60), num_con_update_timer(0), reject_conf(false),
     autocon_echolink_id(0), autocon_time(DEFAULT_AUTOCON_TIME),
-    autocon_timer(0), proxy(0), pty(0)
+    autocon_timer(0), proxy(0), pty(0), shared_encoder(0),
+    shared_down_sampler(0)
 {
   cout << "\tModule EchoLink v" MODULE_ECHO_LINK_VERSION " starting...\n";
   
@@ -345,6 +349,24 @@ bool ModuleEchoLink::initialize(void)
 
     // Initialize directory server communication
   dir = new Directory(servers, mycall, password, location, bind_addr);
+
+    // Load the station list saved by the previous run so that stations can
+    // be looked up before the first list has been received from the server
+  cfg().getValue(cfgName(), "DIRECTORY_CACHE_FILE", dir_cache_file);
+  if (!dir_cache_file.empty())
+  {
+    unsigned dir_cache_max_age = DEFAULT_DIR_CACHE_MAX_AGE;
+    cfg().getValue(cfgName(), "DIRECTORY_CACHE_MAX_AGE", dir_cache_max_age);
+    if (dir->loadStationCache(dir_cache_file, dir_cache_max_age))
+    {
+      cout << cfgName() << ": Loaded "
+           << (dir->links().size() + dir->repeaters().size() +
+               dir->conferences().size() + dir->stations().size())
+           << " stations from the directory cache " << dir_cache_file
+           << endl;
+    }
+  }
+
   dir->statusChanged.connect(mem_fun(*this, &ModuleEchoLink::onStatusChanged));
   dir->stationListUpdated.connect(
       	  mem_fun(*this, &ModuleEchoLink::onStationListUpdated));
@@ -376,6 +398,24 @@ bool ModuleEchoLink::initialize(void)
   splitter = new AudioSplitter;
   listen_only_valve->registerSink(splitter);
 
+    // Optionally encode the audio once for all stations:
+    // Splitter -> (Resampler ->) SharedEncoder -> QsoImpl::sendAudioRaw
+  bool use_shared_encoder = false;
+  cfg().getValue(cfgName(), "SHARED_AUDIO_ENCODER", use_shared_encoder);
+  if (use_shared_encoder)
+  {
+    shared_encoder = new SharedEncoder;
+    shared_encoder->packetEncoded.connect(
+        mem_fun(*this, &ModuleEchoLink::audioFromSharedEncoder));
+#if INTERNAL_SAMPLE_RATE == 16000
+    shared_down_sampler = new AudioResampler(16000, 8000);
+    shared_down_sampler->registerSink(shared_encoder);
+    splitter->addSink(shared_down_sampler);
+#else
+    splitter->addSink(shared_encoder);
+#endif
+  }
+
     // Create audio pipe chain for audio received from the remove EchoLink
     // stations: (QsoImpl -> ) Selector -> Fifo -> <to core>
   selector = new AudioSelector;
@@ -420,6 +460,32 @@ bool ModuleEchoLink::initialize(void)
 } /* ModuleEchoLink::initialize */
 
 
+EventHandler *ModuleEchoLink::takeRemoteEventHandler(void)
+{
+  if (remote_event_handlers.empty())
+  {
+    return 0;
+  }
+  EventHandler *event_handler = remote_event_handlers.back();
+  remote_event_handlers.pop_back();
+  return event_handler;
+} /* ModuleEchoLink::takeRemoteEventHandler */
+
+
+void ModuleEchoLink::releaseRemoteEventHandler(EventHandler *event_handler)
+{
+  assert(event_handler != 0);
+  if (remote_event_handlers.size() < max_connections)
+  {
+    remote_event_handlers.push_back(event_handler);
+  }
+  else
+  {
+    delete event_handler;
+  }
+} /* ModuleEchoLink::releaseRemoteEventHandler */
+
+
 
 /****************************************************************************
  *
@@ -587,10 +653,20 @@ void ModuleEchoLink::moduleCleanup(void)
   state = STATE_NORMAL;
   delete autocon_timer;
   autocon_timer = 0;
+
+  for (EventHandler *event_handler : remote_event_handlers)
+  {
+    delete event_handler;
+  }
+  remote_event_handlers.clear();
   
   AudioSink::clearHandler();
   delete splitter;
   splitter = 0;
+  delete shared_down_sampler;
+  shared_down_sampler = 0;
+  delete shared_encoder;
+  shared_encoder = 0;
   delete listen_only_valve;
   listen_only_valve = 0;
   
@@ -901,6 +977,12 @@ void ModuleEchoLink::onStationListUpdated(void)
     cout << dir->message() << endl;
     last_message = dir->message();
   }
+
+  if (!dir_cache_file.empty() && !dir->saveStationCache(dir_cache_file))
+  {
+    cerr << "*** WARNING: Could not write the EchoLink directory cache file "
+         << dir_cache_file << endl;
+  }
 } /* onStationListUpdated */
 
 
@@ -1049,7 +1131,10 @@ void ModuleEchoLink::onIncomingConnection(const IpAddress& ip,
       	  mem_fun(*this, &ModuleEchoLink::audioFromRemoteRaw));
   qso->destroyMe.connect(mem_fun(*this, &ModuleEchoLink::destroyQsoObject));
 
-  splitter->addSink(qso);
+  if (shared_encoder == 0)
+  {
+    splitter->addSink(qso);
+  }
   selector->addSource(qso);
   selector->enableAutoSelect(qso, 0);
 
@@ -1187,12 +1272,14 @@ void ModuleEchoLink::onChatMsgReceived(QsoImpl *qso, const string& msg)
   //     << " ---" << endl
   //     << msg << endl;
   
+    // The packet is built once and then sent to all other stations
+  const string packet(Qso::chatPacket(mycall, msg));
   vector<QsoImpl*>::iterator it;
   for (it=qsos.begin(); it!=qsos.end(); ++it)
   {
     if (*it != qso)
     {
-      (*it)->sendChatData(msg);
+      (*it)->sendDataPacket(packet);
     }
   }
 
@@ -1454,7 +1541,10 @@ void ModuleEchoLink::createOutgoingConnection(const StationData &station)
       	    mem_fun(*this, &ModuleEchoLink::audioFromRemoteRaw));
     qso->destroyMe.connect(mem_fun(*this, &ModuleEchoLink::destroyQsoObject));
 
-    splitter->addSink(qso);
+    if (shared_encoder == 0)
+    {
+      splitter->addSink(qso);
+    }
     selector->addSource(qso);
     selector->enableAutoSelect(qso, 0);
   }
@@ -1503,6 +1593,16 @@ void ModuleEchoLink::audioFromRemoteRaw(Qso::RawPacket *packet,
 } /* ModuleEchoLink::audioFromRemoteRaw */
 
 
+void ModuleEchoLink::audioFromSharedEncoder(Qso::RawPacket *packet)
+{
+  vector<QsoImpl*>::iterator it;
+  for (it=qsos.begin(); it!=qsos.end(); ++it)
+  {
+    (*it)->sendAudioRaw(packet);
+  }
+} /* ModuleEchoLink::audioFromSharedEncoder */
+
+
 QsoImpl *ModuleEchoLink::findFirstTalker(void) const
 {
   vector<QsoImpl*>::const_iterator it;
@@ -1563,9 +1663,11 @@ void ModuleEchoLink::broadcastTalkerStatus(void)
     }
   }
   
+    // The packet is built once and then sent to all stations
+  const string packet(Qso::infoPacket(msg.str()));
   for (it=qsos.begin(); it!=qsos.end(); ++it)
   {
-    (*it)->sendInfoData(msg.str());
+    (*it)->sendDataPacket(packet);
   }
   
 } /* ModuleEchoLink::broadcastTalkerStatus */
@@ -1894,9 +1996,9 @@ void ModuleEchoLink::handleCommand(const string& cmd)
     
     if (cmd[1] == '1')	// Random connect to link or repeater
     {
-      const list<StationData>& links = dir->links();
-      const list<StationData>& repeaters = dir->repeaters();
-      list<StationData>::const_iterator it;
+      const Directory::StationList& links = dir->links();
+      const Directory::StationList& repeaters = dir->repeaters();
+      Directory::StationList::const_iterator it;
       for (it=links.begin(); it!=links.end(); it++)
       {
 	nodes.push_back(*it);
@@ -1908,8 +2010,8 @@ void ModuleEchoLink::handleCommand(const string& cmd)
     }
     else if (cmd[1] == '2') // Random connect to conference
     {
-      const list<StationData>& conferences = dir->conferences();
-      list<StationData>::const_iterator it;
+      const Directory::StationList& conferences = dir->conferences();
+      Directory::StationList::const_iterator it;
       for (it=conferences.begin(); it!=conferences.end(); it++)
       {
 	nodes.push_back(*it);
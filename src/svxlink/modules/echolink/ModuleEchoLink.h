@@ -75,6 +75,7 @@ namespace Async
   class AudioSplitter;
   class AudioValve;
   class AudioSelector;
+  class AudioResampler;
   class Pty;
 };
 namespace EchoLink
@@ -102,7 +103,9 @@ namespace EchoLink
  ****************************************************************************/
 
 class MsgHandler;
+class EventHandler;
 class QsoImpl;
+class SharedEncoder;
 class LocationInfo;
   
 
@@ -141,6 +144,24 @@ class ModuleEchoLink : public Module
     bool initialize(void);
     const char *compiledForVersion(void) const { return SVXLINK_APP_VERSION; }
 
+    /**
+     * @brief   Take an already initialized remote event handler
+     * @return  Returns an event handler or 0 if there are none available
+     *
+     * Event handlers for the remote station announcements are reused
+     * between QSOs since loading the event handling script is costly. Note
+     * that TCL variables set by a previous QSO are kept.
+     */
+    EventHandler *takeRemoteEventHandler(void);
+
+    /**
+     * @brief   Give back a remote event handler when a QSO is destroyed
+     * @param   event_handler The event handler to give back
+     *
+     * All signal connections to the event handler must have been removed.
+     */
+    void releaseRemoteEventHandler(EventHandler *event_handler);
+
     
   protected:
     /**
@@ -171,6 +192,7 @@ class ModuleEchoLink : public Module
     typedef std::map<const std::string, NumConStn> NumConMap;
 
     static const int	  DEFAULT_AUTOCON_TIME = 3*60*1000; // Three minutes
+    static const unsigned DEFAULT_DIR_CACHE_MAX_AGE = 15*60; // 15 minutes
 
     EchoLink::Directory   *dir;
     Async::Timer      	  *dir_refresh_timer;
@@ -182,8 +204,10 @@ class ModuleEchoLink : public Module
     bool      	      	  remote_activation;
     int       	      	  pending_connect_id;
     std::string       	  last_message;
+    std::string           dir_cache_file;
     std::vector<QsoImpl*> outgoing_con_pending;
     std::vector<QsoImpl*> qsos;
+    std::vector<EventHandler*> remote_event_handlers;
     unsigned       	  max_connections;
     unsigned       	  max_qsos;
     QsoImpl   	      	  *talker;
@@ -213,6 +237,8 @@ class ModuleEchoLink : public Module
     EchoLink::Proxy       *proxy;
     Async::Pty            *pty;
     std::string           command_buf;
+    SharedEncoder         *shared_encoder;
+    Async::AudioResampler *shared_down_sampler;
 
     void moduleCleanup(void);
     void activateInit(void);
@@ -245,6 +271,7 @@ class ModuleEchoLink : public Module
     int audioFromRemote(float *samples, int count, QsoImpl *qso);
     void audioFromRemoteRaw(EchoLink::Qso::RawPacket *packet,
       	      	      	    QsoImpl *qso);
+    void audioFromSharedEncoder(EchoLink::Qso::RawPacket *packet);
     QsoImpl *findFirstTalker(void) const;
     void broadcastTalkerStatus(void);
     void updateDescription(void);
@@ -52,8 +52,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 #include <AsyncAudioSelector.h>
 #include <AsyncAudioPassthrough.h>
 #include <AsyncAudioFifo.h>
-#include <AsyncAudioDecimator.h>
-#include <AsyncAudioInterpolator.h>
+#include <AsyncAudioResampler.h>
 #include <AsyncAudioDebugger.h>
 
 #include <MsgHandler.h>
@@ -69,7 +68,6 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 
 #include "ModuleEchoLink.h"
 #include "QsoImpl.h"
-#include "multirate_filter_coeff.h"
 
 
 /****************************************************************************
@@ -221,8 +219,7 @@ QsoImpl::QsoImpl(const StationData &station, ModuleEchoLink *module)
   AudioSource *prev_src = output_sel;
 
 #if INTERNAL_SAMPLE_RATE == 16000
-  AudioDecimator *down_sampler = new AudioDecimator(
-          2, coeff_16_8, coeff_16_8_taps);
+  AudioResampler *down_sampler = new AudioResampler(16000, 8000);
   prev_src->registerSink(down_sampler, true);
   prev_src = down_sampler;
 #endif
@@ -230,36 +227,49 @@ QsoImpl::QsoImpl(const StationData &station, ModuleEchoLink *module)
   prev_src->registerSink(&m_qso);
   prev_src = 0;
 
-  event_handler = new EventHandler(event_handler_script,
-      module->logicName() + ", module " + module->cfgName());
-  event_handler->playFile.connect(
-      sigc::bind(mem_fun(*msg_handler, &MsgHandler::playFile), false));
-  event_handler->playSilence.connect(
-      sigc::bind(mem_fun(*msg_handler, &MsgHandler::playSilence), false));
-  event_handler->playTone.connect(
-      sigc::bind(mem_fun(*msg_handler, &MsgHandler::playTone), false));
-  event_handler->getConfigValue.connect(
-      sigc::mem_fun(*this, &QsoImpl::getConfigValue));
-
-  event_handler->setVariable("logic_name", module->logicName());
-  event_handler->setVariable("module_name", module->cfgName());
-  event_handler->setVariable("module_type", module->name());
-
-  event_handler->processEvent(
-      std::string("namespace eval ") + module->logicName() + "::" +
-      module->cfgName() + " {}");
-  for (const auto& cfgvar : cfg.listSection(module->cfgName()))
+    // Reuse the event handler of an old QSO if there is one. Loading the
+    // event handling script take time and each TCL interpreter use a couple
+    // of megabytes of memory.
+  event_handler = module->takeRemoteEventHandler();
+  const bool new_event_handler = (event_handler == 0);
+  if (new_event_handler)
   {
-    std::string var =
-      module->logicName() + "::" + module->cfgName() + "::CFG_" + cfgvar;
-    std::string value;
-    cfg.getValue(module->cfgName(), cfgvar, value);
-    event_handler->setVariable(var, value);
+    event_handler = new EventHandler(event_handler_script,
+        module->logicName() + ", module " + module->cfgName());
   }
-
-  if (!event_handler->initialize())
+  event_handler_cons.push_back(event_handler->playFile.connect(
+      sigc::bind(mem_fun(*msg_handler, &MsgHandler::playFile), false)));
+  event_handler_cons.push_back(event_handler->playSilence.connect(
+      sigc::bind(mem_fun(*msg_handler, &MsgHandler::playSilence), false)));
+  event_handler_cons.push_back(event_handler->playTone.connect(
+      sigc::bind(mem_fun(*msg_handler, &MsgHandler::playTone), false)));
+  event_handler_cons.push_back(event_handler->getConfigValue.connect(
+      sigc::mem_fun(*this, &QsoImpl::getConfigValue)));
+
+  if (new_event_handler)
   {
-    return;
+    event_handler->setVariable("logic_name", module->logicName());
+    event_handler->setVariable("module_name", module->cfgName());
+    event_handler->setVariable("module_type", module->name());
+
+    event_handler->processEvent(
+        std::string("namespace eval ") + module->logicName() + "::" +
+        module->cfgName() + " {}");
+    for (const auto& cfgvar : cfg.listSection(module->cfgName()))
+    {
+      std::string var =
+        module->logicName() + "::" + module->cfgName() + "::CFG_" + cfgvar;
+      std::string value;
+      cfg.getValue(module->cfgName(), cfgvar, value);
+      event_handler->setVariable(var, value);
+    }
+
+    if (!event_handler->initialize())
+    {
+      delete event_handler;
+      event_handler = 0;
+      return;
+    }
   }
 
   m_qso.infoMsgReceived.connect(mem_fun(*this, &QsoImpl::onInfoMsgReceived));
@@ -278,8 +288,7 @@ QsoImpl::QsoImpl(const StationData &station, ModuleEchoLink *module)
   prev_src = input_fifo;
   
 #if INTERNAL_SAMPLE_RATE == 16000
-  AudioInterpolator *up_sampler = new AudioInterpolator(
-          2, coeff_16_8, coeff_16_8_taps);
+  AudioResampler *up_sampler = new AudioResampler(8000, 16000);
   prev_src->registerSink(up_sampler, true);
   prev_src = up_sampler;
 #endif
@@ -295,7 +304,14 @@ QsoImpl::~QsoImpl(void)
 {
   AudioSink::clearHandler();
   AudioSource::clearHandler();
-  delete event_handler;
+  for (auto& con : event_handler_cons)
+  {
+    con.disconnect();
+  }
+  if (event_handler != 0)
+  {
+    module->releaseRemoteEventHandler(event_handler);
+  }
   delete output_sel;
   delete msg_handler;
   delete sink_handler;
@@ -38,6 +38,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
  ****************************************************************************/
 
 #include <string>
+#include <vector>
 #include <sigc++/sigc++.h>
 
 
@@ -241,6 +242,11 @@ class QsoImpl
       return m_qso.sendChatData(msg);
     }
 
+    bool sendDataPacket(const std::string& packet)
+    {
+      return m_qso.sendDataPacket(packet);
+    }
+
     bool receivingAudio(void) const { return m_qso.receivingAudio(); }
 
 
@@ -319,6 +325,7 @@ class QsoImpl
     EchoLink::Qso     	    m_qso;
     ModuleEchoLink    	    *module;
     EventHandler      	    *event_handler;
+    std::vector<sigc::connection> event_handler_cons;
     MsgHandler	      	    *msg_handler;
     Async::AudioSelector    *output_sel;
     bool      	      	    init_ok;
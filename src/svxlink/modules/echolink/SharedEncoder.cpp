@@ -0,0 +1,216 @@
+/**
+@file	 SharedEncoder.cpp
+@brief   An encoder for audio that is sent to all connected stations
+@author  Tobias Blomberg / SM0SVX
+@date	 2026-10-14
+
+\verbatim
+A module (plugin) for the multi purpose tranciever frontend system.
+Copyright (C) 2004-2026 Tobias Blomberg / SM0SVX
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+\endverbatim
+*/
+
+
+
+/****************************************************************************
+ *
+ * System Includes
+ *
+ ****************************************************************************/
+
+#include <arpa/inet.h>
+
+#include <algorithm>
+#include <cstring>
+
+
+/****************************************************************************
+ *
+ * Project Includes
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Local Includes
+ *
+ ****************************************************************************/
+
+#include "SharedEncoder.h"
+
+
+/****************************************************************************
+ *
+ * Namespaces to use
+ *
+ ****************************************************************************/
+
+using namespace std;
+using namespace Async;
+using namespace EchoLink;
+
+
+
+/****************************************************************************
+ *
+ * Defines & typedefs
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Local class definitions
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Prototypes
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Exported Global Variables
+ *
+ ****************************************************************************/
+
+
+
+
+/****************************************************************************
+ *
+ * Local Global Variables
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Public member functions
+ *
+ ****************************************************************************/
+
+SharedEncoder::SharedEncoder(void)
+  : gsmh(gsm_create()), buf_cnt(0)
+{
+} /* SharedEncoder::SharedEncoder */
+
+
+SharedEncoder::~SharedEncoder(void)
+{
+  gsm_destroy(gsmh);
+} /* SharedEncoder::~SharedEncoder */
+
+
+int SharedEncoder::writeSamples(const float *samples, int count)
+{
+  int samples_read = 0;
+  while (samples_read < count)
+  {
+    int read_cnt = min(BUFFER_SIZE - buf_cnt, count - samples_read);
+    for (int i=0; i<read_cnt; ++i)
+    {
+      float sample = samples[samples_read++];
+      if (sample > 1)
+      {
+        buf[buf_cnt++] = 32767;
+      }
+      else if (sample < -1)
+      {
+        buf[buf_cnt++] = -32767;
+      }
+      else
+      {
+        buf[buf_cnt++] = static_cast<short>(32767.0 * sample);
+      }
+    }
+
+    if (buf_cnt == BUFFER_SIZE)
+    {
+      encodePacket();
+    }
+  }
+
+  return count;
+} /* SharedEncoder::writeSamples */
+
+
+void SharedEncoder::flushSamples(void)
+{
+  if (buf_cnt > 0)
+  {
+    memset(buf + buf_cnt, 0, sizeof(*buf) * (BUFFER_SIZE - buf_cnt));
+    buf_cnt = BUFFER_SIZE;
+    encodePacket();
+  }
+  sourceAllSamplesFlushed();
+} /* SharedEncoder::flushSamples */
+
+
+
+/****************************************************************************
+ *
+ * Protected member functions
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Private member functions
+ *
+ ****************************************************************************/
+
+void SharedEncoder::encodePacket(void)
+{
+  Qso::VoicePacket voice_packet;
+  voice_packet.header.version = 0xc0;
+  voice_packet.header.pt = 0x03;
+  voice_packet.header.seqNum = 0;
+  voice_packet.header.time = htonl(0);
+  voice_packet.header.ssrc = htonl(0);
+  for (int i=0; i<FRAME_COUNT; ++i)
+  {
+    gsm_encode(gsmh, buf + i * FRAME_SIZE,
+               voice_packet.data + i * GSM_FRAME_BYTES);
+  }
+  buf_cnt = 0;
+
+  Qso::RawPacket raw_packet;
+  raw_packet.voice_packet = &voice_packet;
+  raw_packet.length = sizeof(voice_packet.header) +
+                      FRAME_COUNT * GSM_FRAME_BYTES;
+  raw_packet.samples = buf;
+  packetEncoded(&raw_packet);
+} /* SharedEncoder::encodePacket */
+
+
+
+/*
+ * This file has not been truncated
+ */
@@ -0,0 +1,187 @@
+/**
+@file	 SharedEncoder.h
+@brief   An encoder for audio that is sent to all connected stations
+@author  Tobias Blomberg / SM0SVX
+@date	 2026-10-14
+
+\verbatim
+A module (plugin) for the multi purpose tranciever frontend system.
+Copyright (C) 2004-2026 Tobias Blomberg / SM0SVX
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+\endverbatim
+*/
+
+#ifndef SHARED_ENCODER_INCLUDED
+#define SHARED_ENCODER_INCLUDED
+
+
+/****************************************************************************
+ *
+ * System Includes
+ *
+ ****************************************************************************/
+
+#include <sigc++/sigc++.h>
+
+extern "C" {
+#include <gsm.h>
+}
+
+
+/****************************************************************************
+ *
+ * Project Includes
+ *
+ ****************************************************************************/
+
+#include <AsyncAudioSink.h>
+#include <EchoLinkQso.h>
+
+
+/****************************************************************************
+ *
+ * Local Includes
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Forward declarations
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Namespace
+ *
+ ****************************************************************************/
+
+//namespace MyNameSpace
+//{
+
+
+/****************************************************************************
+ *
+ * Forward declarations of classes inside of the declared namespace
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Defines & typedefs
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Exported Global Variables
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Class definitions
+ *
+ ****************************************************************************/
+
+/**
+@brief	An encoder for audio that is sent to all connected stations
+@author Tobias Blomberg / SM0SVX
+@date   2026-10-14
+
+Normally each QSO encode the audio from the local node on its own. When many
+stations are connected, e.g. on a conference node, the same audio is then
+encoded once for each station. This class encode the audio from the local node
+once, into GSM voice packets, that are then sent to all stations using
+EchoLink::Qso::sendAudioRaw, in the same way as audio from one remote station
+is forwarded to the other remote stations.
+
+The audio written to this sink must be sampled at 8kHz.
+*/
+class SharedEncoder : public Async::AudioSink, public sigc::trackable
+{
+  public:
+    /**
+     * @brief 	Default constructor
+     */
+    SharedEncoder(void);
+
+    /**
+     * @brief 	Destructor
+     */
+    ~SharedEncoder(void);
+
+    /**
+     * @brief 	Write samples into this audio sink
+     * @param 	samples The buffer containing the samples
+     * @param 	count The number of samples in the buffer
+     * @return	Returns the number of samples that has been taken care of
+     */
+    int writeSamples(const float *samples, int count) override;
+
+    /**
+     * @brief 	Tell the sink to flush the previously written samples
+     *
+     * The last, partially filled, voice packet is padded with silence and
+     * sent.
+     */
+    void flushSamples(void) override;
+
+    /**
+     * @brief 	A signal that is emitted when a voice packet has been encoded
+     * @param 	packet The encoded packet
+     *
+     * The packet is only valid during the signal emission. The sequence
+     * number in the packet is set by each Qso object when it is sent.
+     */
+    sigc::signal<void(EchoLink::Qso::RawPacket*)> packetEncoded;
+
+  private:
+    static const int FRAME_COUNT      = 4;
+    static const int FRAME_SIZE       = 160;
+    static const int GSM_FRAME_BYTES  = 33;
+    static const int BUFFER_SIZE      = FRAME_COUNT * FRAME_SIZE;
+
+    gsm   gsmh;
+    short buf[BUFFER_SIZE];
+    int   buf_cnt;
+
+    SharedEncoder(const SharedEncoder&);
+    SharedEncoder& operator=(const SharedEncoder&);
+    void encodePacket(void);
+
+};  /* class SharedEncoder */
+
+
+//} /* namespace */
+
+#endif /* SHARED_ENCODER_INCLUDED */
+
+
+
+/*
+ * This file has not been truncated
+ */
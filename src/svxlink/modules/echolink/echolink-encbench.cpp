@@ -0,0 +1,261 @@
+/**
+@file	 echolink-encbench.cpp
+@brief   A micro benchmark for the shared EchoLink audio encoder
+@author  Tobias Blomberg / SM0SVX
+@date	 2026-10-15
+
+This program compare the cost of sending the audio from the local node to a
+number of connected EchoLink stations, with and without the
+SHARED_AUDIO_ENCODER option of ModuleEchoLink. Without it, each QSO convert
+and GSM encode the audio on its own. With it, the audio is encoded once by a
+SharedEncoder and the same packet is handed to every QSO, which only set the
+sequence number. In both cases the packet is copied to a per station buffer,
+standing in for the UDP send that is the same for both methods.
+
+Run with something like:
+
+  echolink-encbench [max stations] [seconds of audio]
+
+\verbatim
+A module (plugin) for the multi purpose tranciever frontend system.
+Copyright (C) 2004-2026 Tobias Blomberg / SM0SVX
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+\endverbatim
+*/
+
+
+
+/****************************************************************************
+ *
+ * System Includes
+ *
+ ****************************************************************************/
+
+#include <arpa/inet.h>
+
+#include <cstdlib>
+#include <cstring>
+#include <cstdint>
+#include <cmath>
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <random>
+#include <vector>
+#include <memory>
+
+
+/****************************************************************************
+ *
+ * Project Includes
+ *
+ ****************************************************************************/
+
+#include <EchoLinkQso.h>
+
+
+/****************************************************************************
+ *
+ * Local Includes
+ *
+ ****************************************************************************/
+
+#include "SharedEncoder.h"
+
+
+/****************************************************************************
+ *
+ * Namespaces to use
+ *
+ ****************************************************************************/
+
+using namespace std;
+using namespace EchoLink;
+
+
+/****************************************************************************
+ *
+ * Defines & typedefs
+ *
+ ****************************************************************************/
+
+typedef std::chrono::steady_clock Clock;
+
+
+/****************************************************************************
+ *
+ * Local class definitions
+ *
+ ****************************************************************************/
+
+  /*
+   * Stand in for the sending part of a QSO. The packet is copied to a
+   * buffer with the sequence number of this station, like
+   * Qso::sendAudioRaw do before handing it to the dispatcher.
+   */
+class Station
+{
+  public:
+    void sendPacket(Qso::RawPacket *raw_packet)
+    {
+      raw_packet->voice_packet->header.seqNum = htons(next_audio_seq++);
+      memcpy(out, raw_packet->voice_packet, raw_packet->length);
+      checksum += out[sizeof(out) - 1];
+      ++packets;
+    }
+
+    unsigned packets = 0;
+    unsigned checksum = 0;
+
+  private:
+    uint16_t  next_audio_seq = 0;
+    uint8_t   out[sizeof(Qso::VoicePacket)];
+};
+
+
+/****************************************************************************
+ *
+ * Local Global Variables
+ *
+ ****************************************************************************/
+
+static const unsigned SAMPLE_RATE = 8000;
+static const size_t BLOCK_SIZE = 256;
+
+
+/****************************************************************************
+ *
+ * Local functions
+ *
+ ****************************************************************************/
+
+  /*
+   * Create a speech like test signal, a few tones and some noise
+   */
+static vector<float> createAudio(unsigned seconds)
+{
+  vector<float> audio(seconds * SAMPLE_RATE);
+  mt19937 rng(1);
+  normal_distribution<float> noise(0.0f, 0.02f);
+  for (size_t i=0; i<audio.size(); ++i)
+  {
+    const float t = static_cast<float>(i) / SAMPLE_RATE;
+    audio[i] = 0.3f * sinf(2.0f * M_PI * 300.0f * t) +
+               0.2f * sinf(2.0f * M_PI * 1250.0f * t) +
+               0.1f * sinf(2.0f * M_PI * 2700.0f * t) + noise(rng);
+  }
+  return audio;
+} /* createAudio */
+
+
+  /*
+   * Write the audio to the encoders in blocks, like the audio pipe in the
+   * module do, and return the time it took
+   */
+static double run(vector<unique_ptr<SharedEncoder> >& encoders,
+                  const vector<float>& audio)
+{
+  Clock::time_point start = Clock::now();
+  for (size_t pos=0; pos+BLOCK_SIZE<=audio.size(); pos+=BLOCK_SIZE)
+  {
+    for (auto& enc : encoders)
+    {
+      enc->writeSamples(&audio[pos], BLOCK_SIZE);
+    }
+  }
+  return chrono::duration<double>(Clock::now() - start).count();
+} /* run */
+
+
+/****************************************************************************
+ *
+ * MAIN
+ *
+ ****************************************************************************/
+
+int main(int argc, const char **argv)
+{
+  unsigned max_stations = 50;
+  unsigned seconds = 60;
+  if (argc > 1)
+  {
+    max_stations = atoi(argv[1]);
+  }
+  if (argc > 2)
+  {
+    seconds = atoi(argv[2]);
+  }
+  if ((max_stations == 0) || (seconds == 0))
+  {
+    cerr << "Usage: echolink-encbench [max stations] [seconds of audio]"
+         << endl;
+    return 1;
+  }
+
+  const vector<float> audio = createAudio(seconds);
+
+  cout << setw(10) << "Stations"
+       << setw(16) << "Per QSO (ms)" << setw(16) << "Shared (ms)"
+       << setw(12) << "Speedup" << setw(14) << "CPU saved" << endl;
+  unsigned checksum = 0;
+  for (unsigned cnt=1; cnt<=max_stations; cnt=(cnt < 5) ? cnt+1 : cnt*2)
+  {
+    vector<Station> stations(cnt);
+
+      // One encoder per QSO, each sending to its own station
+    vector<unique_ptr<SharedEncoder> > per_qso;
+    for (auto& station : stations)
+    {
+      per_qso.emplace_back(new SharedEncoder);
+      per_qso.back()->packetEncoded.connect(
+          sigc::mem_fun(station, &Station::sendPacket));
+    }
+    const double per_qso_time = run(per_qso, audio);
+
+      // One encoder sending the same packet to all stations
+    vector<unique_ptr<SharedEncoder> > shared;
+    shared.emplace_back(new SharedEncoder);
+    for (auto& station : stations)
+    {
+      shared.back()->packetEncoded.connect(
+          sigc::mem_fun(station, &Station::sendPacket));
+    }
+    const double shared_time = run(shared, audio);
+
+    for (const auto& station : stations)
+    {
+      checksum += station.checksum;
+    }
+
+      // The CPU saved is given as a percentage of one core when the audio
+      // is sent in real time
+    cout << setw(10) << cnt << fixed
+         << setw(16) << setprecision(2) << (1000.0 * per_qso_time)
+         << setw(16) << setprecision(2) << (1000.0 * shared_time)
+         << setw(11) << setprecision(1) << (per_qso_time / shared_time) << "x"
+         << setw(13) << setprecision(3)
+         << (100.0 * (per_qso_time - shared_time) / seconds) << "%" << endl;
+  }
+  cout << "Checksum: " << checksum << endl;
+
+  return 0;
+} /* main */
+
+
+
+/*
+ * This file has not been truncated
+ */
@@ -46,8 +46,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 #include <AsyncAudioSelector.h>
 #include <AsyncAudioFifo.h>
 #include <AsyncAudioJitterFifo.h>
-#include <AsyncAudioDecimator.h>
-#include <AsyncAudioInterpolator.h>
+#include <AsyncAudioResampler.h>
 
 
 /****************************************************************************
@@ -57,7 +56,6 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
  ****************************************************************************/
 #include <version/MODULE_FRN.h>
 #include "ModuleFrn.h"
-#include "multirate_filter_coeff.h"
 
 
 /****************************************************************************
@@ -201,8 +199,7 @@ bool ModuleFrn::initialize(void)
   AudioSink::setHandler(audio_valve);
   audio_valve->registerSink(audio_splitter);
 #if INTERNAL_SAMPLE_RATE == 16000
-  AudioDecimator *down_sampler = new AudioDecimator(
-      2, coeff_16_8, coeff_16_8_taps);
+  AudioResampler *down_sampler = new AudioResampler(16000, 8000);
   audio_splitter->addSink(down_sampler, true);
   down_sampler->registerSink(qso);
 #else
@@ -214,8 +211,7 @@ bool ModuleFrn::initialize(void)
   audio_fifo = new Async::AudioFifo(100 * 320 * 5);
 
 #if INTERNAL_SAMPLE_RATE == 16000
-  AudioInterpolator *up_sampler = new AudioInterpolator(
-      2, coeff_16_8, coeff_16_8_taps);
+  AudioResampler *up_sampler = new AudioResampler(8000, 16000);
   qso->registerSink(up_sampler, true);
   audio_selector->addSource(up_sampler);
   audio_selector->enableAutoSelect(up_sampler, 0);
@@ -37,6 +37,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 #include <cassert>
 #include <cstring>
 #include <cstdlib>
+#include <cstdio>
 #include <sigc++/bind.h>
 #include <sstream>
 #include <regex.h>
@@ -52,8 +53,6 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 #include <AsyncAudioSelector.h>
 #include <AsyncAudioPassthrough.h>
 #include <AsyncAudioFifo.h>
-#include <AsyncAudioDecimator.h>
-#include <AsyncAudioInterpolator.h>
 #include <AsyncAudioDebugger.h>
 #include <AsyncTcpClient.h>
 #include <AsyncTimer.h>
@@ -67,7 +66,6 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 #include "Utils.h"
 #include "ModuleFrn.h"
 #include "QsoFrn.h"
-#include "multirate_filter_coeff.h"
 
 
 /****************************************************************************
@@ -137,7 +135,8 @@ QsoFrn::QsoFrn(ModuleFrn *module)
   , state(STATE_DISCONNECTED)
   , connect_retry_cnt(0)
   , send_buffer_cnt(0)
-  , gsmh(gsm_create())
+  , gsm_enc(gsm_create())
+  , gsm_dec(gsm_create())
   , lines_to_read(-1)
   , is_receiving_voice(false)
   , is_rf_disabled(false)
@@ -240,8 +239,11 @@ QsoFrn::QsoFrn(ModuleFrn *module)
     return;
   }
 
+    // Separate encoder and decoder states so that the WAV49 frame
+    // alternation and filter memories of one do not disturb the other
   int gsm_one = 1;
-  assert(gsm_option(gsmh, GSM_OPT_WAV49, &gsm_one) != -1);
+  assert(gsm_option(gsm_enc, GSM_OPT_WAV49, &gsm_one) != -1);
+  assert(gsm_option(gsm_dec, GSM_OPT_WAV49, &gsm_one) != -1);
 
   tcp_client->connected.connect(
       mem_fun(*this, &QsoFrn::onConnected));
@@ -296,8 +298,10 @@ QsoFrn::~QsoFrn(void)
   delete keepalive_timer;
   keepalive_timer = 0;
 
-  gsm_destroy(gsmh);
-  gsmh = 0;
+  gsm_destroy(gsm_enc);
+  gsm_enc = 0;
+  gsm_destroy(gsm_dec);
+  gsm_dec = 0;
 }
 
 
@@ -509,8 +513,12 @@ void QsoFrn::sendVoiceData(short *data, int len)
 {
   assert(len == BUFFER_SIZE);
 
-  size_t nbytes = 0;
-  unsigned char gsm_data[FRN_AUDIO_PACKET_SIZE];
+  static const char tx1[] = "TX1\r\n";
+  static const size_t TX1_LEN = sizeof(tx1) - 1;
+
+  unsigned char packet[TX1_LEN + FRN_AUDIO_PACKET_SIZE];
+  memcpy(packet, tx1, TX1_LEN);
+  unsigned char *gsm_data = packet + TX1_LEN;
 
   for (int nframe = 0; nframe < FRAME_COUNT; nframe++)
   {
@@ -518,13 +526,19 @@ void QsoFrn::sendVoiceData(short *data, int len)
     unsigned char * dst = gsm_data + nframe * GSM_FRAME_SIZE;
 
     // GSM_OPT_WAV49, produce alternating frames 32, 33, 32, 33, ..
-    gsm_encode(gsmh, src, dst);
-    gsm_encode(gsmh, src + PCM_FRAME_SIZE / 2, dst + 32);
-
-    nbytes += GSM_FRAME_SIZE;
+    gsm_encode(gsm_enc, src, dst);
+    gsm_encode(gsm_enc, src + PCM_FRAME_SIZE / 2, dst + 32);
   }
-  sendRequest(RQ_TX1);
-  size_t written = tcp_client->write(gsm_data, nbytes);
+
+  if (opt_frn_debug)
+    cout << "req:   " << requestToString(RQ_TX1) << endl;
+  if (!tcp_client->isConnected())
+    return;
+
+    // Send the request and the voice data in one write to avoid
+    // an extra system call and TCP segment for each voice packet
+  size_t nbytes = sizeof(packet);
+  size_t written = tcp_client->write(packet, nbytes);
   if (written != nbytes)
   {
     cerr << "not all voice data was written to FRN: "
@@ -557,43 +571,43 @@ void QsoFrn::reconnect(void)
 }
 
 
-void QsoFrn::sendRequest(Request rq)
+const char *QsoFrn::requestToString(Request rq)
 {
-  std::stringstream s;
-
   switch(rq)
   {
     case RQ_RX0:
-      s << "RX0";
-      break;
-
+      return "RX0";
     case RQ_TX0:
-      s << "TX0";
-      break;
-
+      return "TX0";
     case RQ_TX1:
-      s << "TX1";
-      break;
-
+      return "TX1";
     case RQ_P:
-      s << "P";
-      break;
-
+      return "P";
     default:
-      cerr << "unknown request " << rq << endl;
-      return;
+      return 0;
+  }
+}
+
+
+void QsoFrn::sendRequest(Request rq)
+{
+  const char *rq_str = requestToString(rq);
+  if (rq_str == 0)
+  {
+    cerr << "unknown request " << rq << endl;
+    return;
   }
   if (opt_frn_debug)
-    cout << "req:   " << s.str() << endl;
+    cout << "req:   " << rq_str << endl;
   if (tcp_client->isConnected())
   {
-    s << "\r\n";
-    std::string rq_s = s.str();
-    size_t written = tcp_client->write(rq_s.c_str(), rq_s.length());
-    if (written != rq_s.length())
+    char rq_buf[8];
+    size_t rq_len = snprintf(rq_buf, sizeof(rq_buf), "%s\r\n", rq_str);
+    size_t written = tcp_client->write(rq_buf, rq_len);
+    if (written != rq_len)
     {
-      cerr << "request " << rq_s << " was not written to FRN: "
-           << written << "\\" << rq_s.length() << endl;
+      cerr << "request " << rq_str << " was not written to FRN: "
+           << written << "\\" << rq_len << endl;
     }
   }
 }
@@ -602,9 +616,9 @@ void QsoFrn::sendRequest(Request rq)
 int QsoFrn::handleAudioData(unsigned char *data, int len)
 {
   unsigned char *gsm_data = data + CLIENT_INDEX_SIZE;
-  short *pcm_buffer = receive_buffer;
-  float pcm_samples[PCM_FRAME_SIZE];
 
+    // Wait until the whole packet is in the receive buffer. The TCP
+    // connection keeps the unconsumed data so no copy is needed here.
   if (len < FRN_AUDIO_PACKET_SIZE + CLIENT_INDEX_SIZE)
     return 0;
 
@@ -621,36 +635,35 @@ int QsoFrn::handleAudioData(unsigned char *data, int len)
     for (int frameno = 0; frameno < FRAME_COUNT; frameno++)
     {
       unsigned char *src = gsm_data + frameno * GSM_FRAME_SIZE;
-      short *dst = pcm_buffer;
+      short *dst = receive_buffer + frameno * PCM_FRAME_SIZE;
       bool is_gsm_decode_success = true;
 
       // GSM_OPT_WAV49, consume alternating frames of size 33, 32, 33, 32, ..
-      if (gsm_decode(gsmh, src, dst) == -1)
+      if (gsm_decode(gsm_dec, src, dst) == -1)
         is_gsm_decode_success = false;
 
-      if (gsm_decode(gsmh, src + 33, dst + PCM_FRAME_SIZE / 2) == -1)
+      if (gsm_decode(gsm_dec, src + 33, dst + PCM_FRAME_SIZE / 2) == -1)
         is_gsm_decode_success = false;
 
       if (!is_gsm_decode_success)
         cerr << "gsm decoder failed to decode frame " << frameno << endl;
+    }
 
-      for (int i = 0; i < PCM_FRAME_SIZE; i++)
-         pcm_samples[i] = static_cast<float>(pcm_buffer[i]) / 32768.0;
+    for (int i = 0; i < BUFFER_SIZE; i++)
+      receive_samples[i] = receive_buffer[i] * (1.0f / 32768.0f);
 
-      int all_written = 0;
-      while (all_written < PCM_FRAME_SIZE)
+    int all_written = 0;
+    while (all_written < BUFFER_SIZE)
+    {
+      int written = sinkWriteSamples(receive_samples + all_written,
+          BUFFER_SIZE - all_written);
+      if (written == 0)
       {
-        int written = sinkWriteSamples(pcm_samples + all_written,
-            PCM_FRAME_SIZE - all_written);
-        if (written == 0)
-        {
-          cerr << "cannot write frame to sink, dropping sample "
-               << (PCM_FRAME_SIZE - all_written) << endl;
-          break;
-        }
-        all_written += written;
+        cerr << "cannot write frame to sink, dropping sample "
+             << (BUFFER_SIZE - all_written) << endl;
+        break;
       }
-      pcm_buffer += PCM_FRAME_SIZE;
+      all_written += written;
     }
   }
   setState(STATE_IDLE);
@@ -727,12 +740,10 @@ int QsoFrn::handleListHeader(unsigned char *data, int len)
 
 int QsoFrn::handleList(unsigned char *data, int len)
 {
-  int bytes_read = 0;
   std::string line;
-  std::istringstream lines(std::string((char*)data, len));
-  bool has_win_newline = hasWinNewline(lines);
+  int bytes_read = getLine(data, len, line);
 
-  if (hasLine(lines) && safeGetline(lines, line))
+  if (bytes_read > 0)
   {
     if (lines_to_read == -1)
     {
@@ -743,7 +754,6 @@ int QsoFrn::handleList(unsigned char *data, int len)
       cur_item_list.push_back(line);
       lines_to_read--;
     }
-    bytes_read += line.length() + (has_win_newline ? 2 : 1);
   }
   if (lines_to_read == 0)
   {
@@ -761,12 +771,10 @@ int QsoFrn::handleList(unsigned char *data, int len)
 
 int QsoFrn::handleLogin(unsigned char *data, int len, bool stage_one)
 {
-  int bytes_read = 0;
   std::string line;
-  std::istringstream lines(std::string((char*)data, len));
-  bool has_win_newline = hasWinNewline(lines);
+  int bytes_read = getLine(data, len, line);
 
-  if (hasLine(lines) && safeGetline(lines, line))
+  if (bytes_read > 0)
   {
     if (stage_one)
     {
@@ -797,7 +805,6 @@ int QsoFrn::handleLogin(unsigned char *data, int len, bool stage_one)
         cerr << "login stage 2 failed: " << line << endl;
       }
     }
-    bytes_read += line.length() + (has_win_newline ? 2 : 1);
   }
   return bytes_read;
 }
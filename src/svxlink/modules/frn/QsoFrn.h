@@ -379,9 +379,20 @@ class QsoFrn
      *
      * @param Pcm buffer with samples
      * @param Size of buffer
+     *
+     * All frames are encoded in one go and sent together with the TX1
+     * request in a single write.
      */
     void sendVoiceData(short *data, int len);
 
+    /**
+     * @brief Get the protocol string for a FRN client request
+     *
+     * @param Request to get the string for
+     * @return The request string, without line ending, or 0 if unknown
+     */
+    static const char *requestToString(Request rq);
+
     /**
      * @brief Sends FRN client request to the server
      *
@@ -422,8 +433,9 @@ class QsoFrn
      * @param length of received data
      * @return count of bytes consumed
      *
-     * Consumes and handles one incoming FRN audio frame. Decodes 
-     * from gsm wav49 format and sends to audio sink.
+     * Consumes and handles one incoming FRN audio frame. All gsm wav49
+     * frames in the packet are decoded directly from the receive buffer and
+     * then written to the audio sink in one go.
      */
     int handleAudioData(unsigned char *data, int len);
 
@@ -548,9 +560,11 @@ class QsoFrn
     State               state;
     int                 connect_retry_cnt;
     short               receive_buffer[BUFFER_SIZE];
+    float               receive_samples[BUFFER_SIZE];
     short               send_buffer[BUFFER_SIZE];
     int                 send_buffer_cnt;
-    gsm                 gsmh;
+    gsm                 gsm_enc;
+    gsm                 gsm_dec;
     int                 lines_to_read;
     FrnList             cur_item_list;
     FrnList             client_list;
@@ -26,7 +26,7 @@ along with this program; if not, write to the Free Software
 Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 \endverbatim
 */
-#include <sstream>
+#include <string>
 #include <cstring>
 #include <cstdlib>
 #include <cstdio>
@@ -35,49 +35,22 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 namespace FrnUtils
 {
 
-std::istream& safeGetline(std::istream& is, std::string& t)
+int getLine(const unsigned char *data, int len, std::string& line)
 {
-  t.clear();
-  std::istream::sentry se(is, true);
-  std::streambuf* sb = is.rdbuf();
-
-  for(;;) {
-    int c = sb->sbumpc();
-    switch (c) {
-      case '\n':
-        if(sb->sgetc() == '\r')
-          sb->sbumpc();
-        return is;
-      case '\r':
-        if(sb->sgetc() == '\n')
-        {
-          sb->sbumpc();
-          return is;
-        }
-        t += (char)c;
-        break;
-      case EOF:
-        if(t.empty())
-          is.setstate(std::ios::eofbit);
-        return is;
-      default:
-       t += (char)c;
-       break;
-    }
-  }
-}
-
-
-bool hasLine(std::istringstream& is)
-{
-  return (is.str().find('\n') != std::string::npos);
-}
-
-
-bool hasWinNewline(std::istringstream& is)
-{
-  return !(is.str().find("\r\n") == std::string::npos && 
-           is.str().find("\n\r") == std::string::npos);
+  const unsigned char *nl =
+    static_cast<const unsigned char*>(memchr(data, '\n', len));
+  if (nl == 0)
+    return 0;
+
+  int line_len = nl - data;
+  int consumed = line_len + 1;
+  if (line_len > 0 && data[line_len - 1] == '\r')
+    line_len--;
+  else if (consumed < len && data[consumed] == '\r')
+    consumed++;
+
+  line.assign(reinterpret_cast<const char*>(data), line_len);
+  return consumed;
 }
 
 
@@ -27,32 +27,23 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 \endverbatim
 */
 
+#include <string>
+
 namespace FrnUtils
 {
 
 /**
- * @brief Checks if there is a line in string stream
- *
- * This functions checks if string stream has a line, returns true
- * when line has been found.
- */
-bool hasLine(std::istringstream& is);
-
-/** 
- * @brief Checks if string stream has windows style newline
+ * @brief Get the first line from a receive buffer
  *
- * This function returns true if windows style newline has been found
- * in given stream.
- */
-bool hasWinNewline(std::istringstream& is);
-
-/**
- * @brief Returns line from string stream halding also windows newlines
+ * @param data Pointer to received data
+ * @param len Length of received data
+ * @param line Set to the line without the newline characters
+ * @return Count of bytes consumed, zero if there is no complete line
  *
- * This function is similar to std::getline, but takes care of windows
- * style new lines.
+ * The line is read directly from the receive buffer without copying the
+ * rest of the buffer. Both unix and windows style newlines are handled.
  */
-std::istream& safeGetline(std::istream& is, std::string& t);
+int getLine(const unsigned char *data, int len, std::string& line);
 
 } // namespace FrnUtils
 
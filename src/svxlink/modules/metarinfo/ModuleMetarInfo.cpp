@@ -52,7 +52,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 
 #include <AsyncConfig.h>
 #include <AsyncTimer.h>
-#include <AsyncFdWatch.h>
+#include <AsyncHttpClient.h>
 
 
 
@@ -145,6 +145,8 @@ using namespace SvxLink;
 #define NOTACTUAL 98
 #define INVALID 99
 
+#define DEFAULT_CACHE_TTL 600
+
 
 /****************************************************************************
  *
@@ -152,196 +154,6 @@ using namespace SvxLink;
  *
  ****************************************************************************/
 
-class ModuleMetarInfo::Http : public sigc::trackable
-{
-   struct WatchSet
-   {
-     ~WatchSet(void)
-     {
-       rd.activity.clear();
-       wr.activity.clear();
-     }
-     Async::FdWatch rd;
-     Async::FdWatch wr;
-   };
-   typedef std::map<int, WatchSet> WatchMap;
-   CURLM* multi_handle; 
-   Async::Timer update_timer;
-   WatchMap watch_map;
-   std::queue<CURL*> url_queue;
-   CURL* pending_curl;
-
-  public:
-
-   Http() : multi_handle(0), pending_curl(0)
-   {
-     multi_handle = curl_multi_init();
-     long curl_timeout = -1;
-     curl_multi_timeout(multi_handle, &curl_timeout);
-     update_timer.setTimeout((curl_timeout >= 0) ? curl_timeout : 100);
-     update_timer.setEnable(false);
-     update_timer.expired.connect(mem_fun(*this, &Http::onTimeout));
-   } /* Http */
-
-   ~Http()
-   {
-     if (pending_curl)
-       curl_easy_cleanup(pending_curl);
-     while (!url_queue.empty())
-     {
-       curl_easy_cleanup(url_queue.front());
-       url_queue.pop();
-     }
-     disableAllWatches();
-     curl_multi_cleanup(multi_handle);
-   } /* ~Http */
-
-   // a signal when a metar has been available
-   sigc::signal<void(std::string, size_t)> metarInfo;
-
-   // a signal when a metar has a timeout
-   sigc::signal<void()> metarTimeout;
-
-
-   // update the html handler periodically
-   void onTimeout(Async::Timer *timer)
-   {
-     int handle_count;
-     curl_multi_perform(multi_handle, &handle_count);
-     if (handle_count == 0) 
-     {
-       disableAllWatches();
-       curl_easy_cleanup(pending_curl);
-       if (url_queue.empty())
-       {
-         pending_curl = 0;
-         update_timer.setEnable(false);
-       }
-       else
-       {
-         pending_curl = url_queue.front();
-         url_queue.pop();
-         curl_multi_add_handle(multi_handle, pending_curl);
-         update_timer.setEnable(true);
-       }
-     }
-     updateWatchMap();
-     update_timer.reset();
-   } /* Update */
-
-   void onActivity(Async::FdWatch *watch)
-   {
-     int handle_count;
-     curl_multi_perform(multi_handle, &handle_count);
-     if (handle_count == 0)
-     {
-       disableAllWatches();
-       curl_easy_cleanup(pending_curl);
-       if (url_queue.empty())
-       {
-         pending_curl = 0;
-         update_timer.setEnable(false);
-       }
-       else
-       {
-         pending_curl = url_queue.front();
-         url_queue.pop();
-         curl_multi_add_handle(multi_handle, pending_curl);
-         updateWatchMap();
-         update_timer.setEnable(true);
-       }
-     }
-     update_timer.reset();
-   } /* onActivity */
-
-   static size_t callback(char *contents, size_t size, size_t nmemb,
-                                       void *userp)
-   {
-     if (userp == NULL) return 0;
-     size_t written = size * nmemb;
-     std::string html((const char *)contents, written);
-     static_cast<Http*>(userp)->metarInfo(html, html.size());
-     return written;
-   } /* callback */
-
-   void AddRequest(const char* uri)
-   {
-     CURL* curl = curl_easy_init();
-     curl_easy_setopt(curl, CURLOPT_URL, uri);
-     curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, &Http::callback);
-     curl_easy_setopt(curl, CURLOPT_WRITEDATA, this);
-
-     if (!pending_curl)
-     {
-       pending_curl = curl;
-       curl_multi_add_handle(multi_handle, pending_curl);
-       updateWatchMap();
-       update_timer.reset();
-       update_timer.setEnable(true);
-     }
-     else
-     {
-       url_queue.push(curl);
-     }
-   } /* AddRequest */
-
-  private:
-
-   void updateWatchMap()
-   {
-     fd_set fdread;
-     fd_set fdwrite;
-     fd_set fdexcep;
-     int maxfd = -1;
-
-     FD_ZERO(&fdread);
-     FD_ZERO(&fdwrite);
-     FD_ZERO(&fdexcep);
-     curl_multi_fdset(multi_handle, &fdread, &fdwrite, &fdexcep, &maxfd);
-
-     for (int fd = 0; fd <= maxfd; fd++) 
-     {
-       bool read_isset = FD_ISSET(fd, &fdread);
-       bool write_isset = FD_ISSET(fd, &fdwrite);
-       WatchSet *ws = 0;
-       WatchMap::iterator it = watch_map.find(fd);
-       if (it != watch_map.end())
-       {
-         ws = &(it->second);
-       }
-       else
-       {
-         if (!(read_isset || write_isset))
-         {
-           continue;
-         }
-         ws = &(watch_map[fd]);
-       }
-       if (read_isset && !ws->rd.isEnabled())
-       {
-         ws->rd.setFd(fd, Async::FdWatch::FD_WATCH_RD);
-         ws->rd.activity.connect(mem_fun(*this, &Http::onActivity));
-         ws->rd.setEnabled(true);
-       }
-       if (write_isset && !ws->wr.isEnabled())
-       {
-         ws->wr.setFd(fd, Async::FdWatch::FD_WATCH_WR);
-         ws->wr.activity.connect(mem_fun(*this, &Http::onActivity));
-         ws->wr.setEnabled(true);
-       }
-     }
-   } /* updateWatchMap */
-
-   void disableAllWatches(void)
-   {
-     WatchMap::iterator it;
-     for (it = watch_map.begin(); it != watch_map.end(); ++it)
-     {
-       it->second.rd.setEnabled(false);
-       it->second.wr.setEnabled(false);
-     }
-   } /* disableAllWatches */
-};
 
 
 /****************************************************************************
@@ -410,7 +222,8 @@ extern "C" {
 
 ModuleMetarInfo::ModuleMetarInfo(void *dl_handle, Logic *logic,
                                  const string& cfg_name)
-  : Module(dl_handle, logic, cfg_name), remarks(false), debug(false), http(0)
+  : Module(dl_handle, logic, cfg_name), remarks(false), debug(false),
+    cache_ttl(DEFAULT_CACHE_TTL), prefetch_timer(0), say_capture(0)
 {
   cout << "\tModule MetarInfo v" MODULE_METAR_INFO_VERSION " starting...\n";
 
@@ -419,7 +232,16 @@ ModuleMetarInfo::ModuleMetarInfo(void *dl_handle, Logic *logic,
 
 ModuleMetarInfo::~ModuleMetarInfo(void)
 {
+  delete prefetch_timer;
+  prefetch_timer = 0;
 
+    // The response handlers refer to this object so all fetches that are
+    // still running must be cancelled
+  for (FetchMap::iterator it = fetches.begin(); it != fetches.end(); ++it)
+  {
+    http->cancel(it->second.id);
+  }
+  fetches.clear();
 } /* ~ModuleMetarInfo */
 
 
@@ -496,7 +318,6 @@ bool ModuleMetarInfo::initialize(void)
   string value;
   StrList apset;
   std::string tp;
-  html = "";
 
   repstr["shra"] = "ra sh ";
   repstr["shsn"] = "sn sh ";
@@ -604,6 +425,28 @@ bool ModuleMetarInfo::initialize(void)
      longmsg = "_long ";  // taking "cavok_long" instead of "cavok"
   }
 
+  cfg().getValue(cfgName(), "CACHE_TTL", cache_ttl);
+
+  http = Async::HttpClient::shared();
+
+    // Periodically fetch the METAR for all configured airports in the
+    // background so that a request can be answered directly from the cache
+  unsigned prefetch_interval = 0;
+  cfg().getValue(cfgName(), "PREFETCH_INTERVAL", prefetch_interval);
+  if (prefetch_interval > 0)
+  {
+    if (prefetch_interval >= cache_ttl)
+    {
+      cout << "*** WARNING: " << cfgName() << "/PREFETCH_INTERVAL should be "
+           << "less than " << cfgName() << "/CACHE_TTL for the prefetched "
+           << "reports to be used\n";
+    }
+    prefetch_timer = new Timer(1000 * prefetch_interval, Timer::TYPE_PERIODIC);
+    prefetch_timer->expired.connect(
+        mem_fun(*this, &ModuleMetarInfo::prefetchAll));
+    prefetchAll(prefetch_timer);
+  }
+
   return true;
 
 } /* initialize */
@@ -626,7 +469,7 @@ void ModuleMetarInfo::activateInit(void)
   if (icao_default.length() == 4)
   {
       icao = icao_default;
-      openConnection();
+      requestMetar(icao);
   }
 } /* activateInit */
 
@@ -646,7 +489,7 @@ void ModuleMetarInfo::activateInit(void)
  */
 void ModuleMetarInfo::deactivateCleanup(void)
 {
-  closeConnection();
+  cancelAnnouncements();
 } /* deactivateCleanup */
 
 
@@ -782,7 +625,7 @@ void ModuleMetarInfo::dtmfCmdReceived(const string& cmd)
   else if (icmd <= (int)aplist.size() && icmd > 0)
   {
      icao = aplist[icmd - 1];
-     openConnection();
+     requestMetar(icao);
      return;
   }
 
@@ -790,7 +633,7 @@ void ModuleMetarInfo::dtmfCmdReceived(const string& cmd)
   if (icao.length() == 4)
   {
      if (debug) cout << "icao-code by dtmf-method: " << icao << endl;
-     openConnection();
+     requestMetar(icao);
   }
   else
   {
@@ -850,47 +693,177 @@ void ModuleMetarInfo::allMsgsWritten(void)
 
 
 /*
-* establish a https-connection to the METAR-Server
-* using curl library
+* Announce the METAR for the given airport, from the cache if a valid report
+* is available or else by fetching it from the METAR-Server
 */
-void ModuleMetarInfo::openConnection(void)
+void ModuleMetarInfo::requestMetar(const std::string& station)
 {
-  closeConnection();
+  cancelAnnouncements();
+
+  ReportCache::const_iterator rit = report_cache.find(station);
+  if ((rit != report_cache.end()) && isReportValid(rit->second))
+  {
+    if (debug) cout << "using cached METAR for " << station << endl;
+    announceReport(rit->second);
+    return;
+  }
+
+  FetchMap::iterator fit = fetches.find(station);
+  if (fit != fetches.end())
+  {
+    fit->second.announce = true;
+    return;
+  }
 
-  http = new Http();
+  fetchMetar(station, true);
+} /* requestMetar */
 
-  html = "";
+
+/*
+* establish a https-connection to the METAR-Server
+* using the shared HTTP client
+*/
+void ModuleMetarInfo::fetchMetar(const std::string& station, bool announce)
+{
   std::string path = server;
               path += link;
-              path += icao;
+              path += station;
 
-  http->AddRequest(path.c_str());
-  cout << path << endl;
-  http->metarInfo.connect(mem_fun(*this, &ModuleMetarInfo::onData));
-  http->metarTimeout.connect(mem_fun(*this, &ModuleMetarInfo::onTimeout));
+  if (debug) cout << path << endl;
+  Async::HttpClient::RequestId id = http->get(path,
+      [this, station](const Async::HttpClient::Response& rsp)
+      {
+        onResponse(station, rsp);
+      });
+  if (id == Async::HttpClient::INVALID_REQUEST)
+  {
+    if (announce)
+    {
+      stringstream temp;
+      temp << "metar_not_valid";
+      say(temp);
+    }
+    return;
+  }
 
-} /* openConnection */
+  Fetch& fetch = fetches[station];
+  fetch.id = id;
+  fetch.announce = announce;
+} /* fetchMetar */
 
 
-void ModuleMetarInfo::closeConnection(void)
+void ModuleMetarInfo::cancelAnnouncements(void)
 {
-  delete http;
-  http = 0;
-} /* ModuleMetarInfo::closeConnection */
+    // Fetches that are running are not cancelled since the result is
+    // still useful for the cache
+  for (FetchMap::iterator it = fetches.begin(); it != fetches.end(); ++it)
+  {
+    it->second.announce = false;
+  }
+} /* ModuleMetarInfo::cancelAnnouncements */
 
 
-void ModuleMetarInfo::onTimeout(void)
+void ModuleMetarInfo::prefetchAll(Async::Timer *timer)
 {
-  stringstream temp;
-  temp << "metar_not_valid";
-  say(temp);
-} /* ModuleMetarInfo::onTimeout */
+  StrList stations(aplist);
+  if ((icao_default.length() == 4) &&
+      (find(stations.begin(), stations.end(), icao_default) == stations.end()))
+  {
+    stations.push_back(icao_default);
+  }
+
+  for (StrList::const_iterator it = stations.begin(); it != stations.end();
+       ++it)
+  {
+    if (fetches.find(*it) == fetches.end())
+    {
+      fetchMetar(*it, false);
+    }
+  }
+} /* ModuleMetarInfo::prefetchAll */
+
+
+bool ModuleMetarInfo::isReportValid(const Report& report)
+{
+  if (difftime(time(NULL), report.fetched) >= cache_ttl)
+  {
+    return false;
+  }
+  return report.obs_time.empty() || isvalidUTC(report.obs_time);
+} /* ModuleMetarInfo::isReportValid */
 
 
-void ModuleMetarInfo::onData(std::string metarinput, size_t count)
+void ModuleMetarInfo::announceReport(const Report& report)
 {
-  std::string metar = "";
-  html += metarinput;
+  for (StrList::const_iterator it = report.events.begin();
+       it != report.events.end(); ++it)
+  {
+    if (debug) cout << *it << endl;
+    processEvent(*it);
+  }
+} /* ModuleMetarInfo::announceReport */
+
+
+void ModuleMetarInfo::onResponse(std::string station,
+                                 const Async::HttpClient::Response& rsp)
+{
+  FetchMap::iterator fit = fetches.find(station);
+  if (fit == fetches.end())
+  {
+    return;
+  }
+  bool announce = fit->second.announce;
+  fetches.erase(fit);
+
+  std::string metar;
+  std::string obs_time;
+  std::string error;
+  if (rsp.status == 404)
+  {
+    cout << "ERROR 404 from webserver -> no such airport\n";
+    error = "no_such_airport";
+  }
+  else if (!rsp.ok())
+  {
+    cout << "*** WARNING: Could not fetch METAR for " << station << ": "
+         << (rsp.error.empty() ? "HTTP status " : rsp.error);
+    if (rsp.error.empty()) cout << rsp.status;
+    cout << endl;
+    error = "metar_not_valid";
+  }
+  else if (extractMetar(station, rsp.body, metar, obs_time, error))
+  {
+      // Parse the report once and store the resulting announcement so that
+      // later requests can be answered directly from the cache
+    Report& report = report_cache[station];
+    report.fetched = time(NULL);
+    report.obs_time = obs_time;
+    report.events.clear();
+    say_capture = &report.events;
+    handleMetar(station, metar);
+    say_capture = 0;
+
+    if (announce)
+    {
+      announceReport(report);
+    }
+    return;
+  }
+
+  if (announce && !error.empty())
+  {
+    stringstream temp;
+    temp << error;
+    say(temp);
+  }
+} /* ModuleMetarInfo::onResponse */
+
+
+bool ModuleMetarInfo::extractMetar(const std::string& station,
+                                   const std::string& doc, std::string& metar,
+                                   std::string& obs_time, std::string& error)
+{
+  std::string html(doc);
 
   // switching between the newer xml-service by aviationweather and the old 
   // noaa.gov version. With the standard TXT format anybody will be able to 
@@ -905,11 +878,9 @@ void ModuleMetarInfo::onData(std::string metarinput, size_t count)
 
     if (html.find("<data num_results=\"0\" />") != string::npos)
     {
-      stringstream temp;
       cout << "Metar information not available" << endl;
-      temp << "metar_not_valid";
-      say(temp);
-      return;
+      error = "metar_not_valid";
+      return false;
     }
 
     // check day and time, if not in limit throw information away
@@ -926,13 +897,15 @@ void ModuleMetarInfo::onData(std::string metarinput, size_t count)
         cout << "XML-METAR: " << metar << endl;
       }
 
-      if (met_utc.length() == 20 && !isvalidUTC(met_utc))
+      if (met_utc.length() == 20)
       {
-        stringstream temp;
-        cout << "Metar information outdated" << endl;
-        temp << "metar_not_valid";
-        say(temp);
-        return;
+        if (!isvalidUTC(met_utc))
+        {
+          cout << "Metar information outdated" << endl;
+          error = "metar_not_valid";
+          return false;
+        }
+        obs_time = met_utc;
       }
     }
   }
@@ -946,7 +919,6 @@ void ModuleMetarInfo::onData(std::string metarinput, size_t count)
 
     size_t found;
     StrList values;
-    std::stringstream temp;
 
     splitStr(values, html, "\n");
 
@@ -955,9 +927,15 @@ void ModuleMetarInfo::onData(std::string metarinput, size_t count)
     if (html.find("404 Not Found") != string::npos)
     {
       cout << "ERROR 404 from webserver -> no such airport\n";
-      temp << "no_such_airport";
-      say(temp);
-      return;
+      error = "no_such_airport";
+      return false;
+    }
+
+    if (values.size() < 2)
+    {
+      cout << "ERROR: wrong Metarfile format, expected two lines but got \""
+           << html << "\"" << endl;
+      return false;
     }
 
     metar = values.back();  // contains the METAR
@@ -971,15 +949,15 @@ void ModuleMetarInfo::onData(std::string metarinput, size_t count)
       cout << "ERROR: wrong Metarfile format, first line should have the date + UTC and "
            << "must have 16 digits, e.g.:\n"
            << "2019/04/07 13:20" << endl;
-      return;
+      return false;
     }
 
-    if ((metar.find(icao)) == string::npos)
+    if ((metar.find(station)) == string::npos)
     {
       cout << "ERROR: wrong Metarfile format, second line must begin with the correct "
-           << "ICAO airport code (" << icao << ") configured in ModuleMetarInfo.conf,"
+           << "ICAO airport code (" << station << ") configured in ModuleMetarInfo.conf,"
            << "but is \"" << metar << "\"" << endl;
-      return;
+      return false;
     }
 
     if (debug)
@@ -990,16 +968,14 @@ void ModuleMetarInfo::onData(std::string metarinput, size_t count)
     // check if METAR is actual
     if (!isvalidUTC(metartime.substr(0,16)))
     {
-      temp << "metar_not_valid";
-      say(temp);
-      return;
+      error = "metar_not_valid";
+      return false;
     }
+    obs_time = metartime.substr(0,16);
   }
 
-  handleMetar(metar);
-
-  html = "";
-} /* onDataReceived */
+  return true;
+} /* extractMetar */
 
 
 std::string ModuleMetarInfo::getXmlParam(std::string token, std::string input)
@@ -1026,7 +1002,8 @@ std::string ModuleMetarInfo::getXmlParam(std::string token, std::string input)
 } /* getXmlParam */
 
 
-int ModuleMetarInfo::handleMetar(std::string input)
+int ModuleMetarInfo::handleMetar(const std::string& station,
+                                 std::string input)
 {
    std::string current;
    std::string tempstr;
@@ -1047,7 +1024,7 @@ int ModuleMetarInfo::handleMetar(std::string input)
    temp << "metar \"" << input << "\"";
    say(temp);
 
-   temp << "announce_airport " << icao;
+   temp << "announce_airport " << station;
    say(temp);
 
    splitStr(values, input, " ");
@@ -2268,6 +2245,12 @@ bool ModuleMetarInfo::ispObscurance(std::string &retval, std::string token)
 
 void ModuleMetarInfo::say(stringstream &tmp)
 {
+   if (say_capture != 0)
+   {
+     say_capture->push_back(tmp.str());
+     tmp.str("");
+     return;
+   }
    if (debug) cout << tmp.str() << endl;  // debug
    processEvent(tmp.str());
    tmp.str("");
@@ -43,7 +43,8 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 #include <list>
 #include <map>
 #include <iostream>
-#include <curl/curl.h>
+#include <memory>
+#include <ctime>
 
 
 /****************************************************************************
@@ -54,6 +55,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 
 #include <Module.h>
 #include <AsyncConfig.h>
+#include <AsyncHttpClient.h>
 
 
 
@@ -136,7 +138,20 @@ class ModuleMetarInfo : public Module
     virtual void flushSamples(void);
 
   private:
-    class Http;
+    struct Report
+    {
+      time_t                    fetched;
+      std::string               obs_time;
+      std::vector<std::string>  events;
+    };
+    typedef std::map<std::string, Report> ReportCache;
+
+    struct Fetch
+    {
+      Async::HttpClient::RequestId  id;
+      bool                          announce;
+    };
+    typedef std::map<std::string, Fetch> FetchMap;
 
     std::string icao;
     std::string icao_default;
@@ -154,11 +169,16 @@ class ModuleMetarInfo : public Module
     typedef std::map<std::string, std::string> Repdefs;
     Repdefs repstr;
 
-    std::string html;
     std::string type;
     std::string server;
     std::string link;
-    Http* http;
+
+    std::shared_ptr<Async::HttpClient> http;
+    FetchMap                  fetches;
+    ReportCache               report_cache;
+    unsigned                  cache_ttl;
+    Async::Timer*             prefetch_timer;
+    std::vector<std::string>* say_capture;
 
     bool initialize(void);
     void activateInit(void);
@@ -168,9 +188,12 @@ class ModuleMetarInfo : public Module
     void dtmfCmdReceivedWhenIdle(const std::string& cmd);
     void squelchOpen(bool is_open);
     void allMsgsWritten(void);
-    void openConnection(void);
-    void closeConnection(void);
-    void onTimeout(void);
+    void requestMetar(const std::string& station);
+    void fetchMetar(const std::string& station, bool announce);
+    void cancelAnnouncements(void);
+    void prefetchAll(Async::Timer *timer);
+    bool isReportValid(const Report& report);
+    void announceReport(const Report& report);
     std::string getSlp(std::string token);
     std::string getTempTime(std::string token);
     std::string getTempinRmk(std::string token);
@@ -181,7 +204,11 @@ class ModuleMetarInfo : public Module
     std::string getPrecipitation(std::string token);
     std::string getCloudType(std::string token);
     void isRwyState(std::string &retval, std::string token);
-    void onData(std::string metarinput, size_t count);
+    void onResponse(std::string station,
+                    const Async::HttpClient::Response& rsp);
+    bool extractMetar(const std::string& station, const std::string& doc,
+                      std::string& metar, std::string& obs_time,
+                      std::string& error);
     int  splitEmptyStr(StrList& L, const std::string& seq);
     bool isWind(std::string &retval, std::string token);
     bool isvalidUTC(std::string utctoken);
@@ -203,7 +230,7 @@ class ModuleMetarInfo : public Module
     bool ispObscurance(std::string &tempstr, std::string token);
     bool getPeakWind(std::string &retval, std::string token);
     void say(std::stringstream &tmp);
-    int handleMetar(std::string input);
+    int handleMetar(const std::string& station, std::string input);
     std::string getXmlParam(std::string token, std::string input);
 };  /* class ModuleMetarInfo */
 
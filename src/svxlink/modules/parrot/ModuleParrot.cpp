@@ -50,7 +50,8 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 
 #include <AsyncConfig.h>
 #include <AsyncTimer.h>
-#include <AsyncAudioFifo.h>
+#include <AsyncAudioEncodedFifo.h>
+#include <AsyncAudioEncoder.h>
 #include <AsyncAudioPassthrough.h>
 #include <AsyncAudioValve.h>
 
@@ -201,11 +202,40 @@ bool ModuleParrot::initialize(void)
     repeat_delay_timer.setTimeout(repeat_delay);
   }
   
+    // The recording is stored compressed to save memory. Fall back to
+    // storing the raw samples if the Opus codec is not available.
+  string fifo_codec(AudioEncoder::isAvailable("OPUS") ? "OPUS" : "RAW");
+  cfg().getValue(cfgName(), "FIFO_CODEC", fifo_codec);
+  if (!AudioEncoder::isAvailable(fifo_codec))
+  {
+    std::cerr << "*** ERROR: Unknown codec \"" << fifo_codec
+              << "\" specified in " << cfgName() << "/FIFO_CODEC"
+              << std::endl;
+    return false;
+  }
+
   adapter = new FifoAdapter(this);
   AudioSink::setHandler(adapter);
   
-  fifo = new AudioFifo(atoi(fifo_len.c_str())*INTERNAL_SAMPLE_RATE);
+  fifo = new AudioEncodedFifo(fifo_codec, atoi(fifo_len.c_str()) * 1000);
+  if (!fifo->initOk())
+  {
+    delete fifo;
+    fifo = 0;
+    return false;
+  }
   fifo->setOverwrite(true);
+  string opt_prefix(fifo_codec + "_ENC_");
+  list<string> names = cfg().listSection(cfgName());
+  for (list<string>::const_iterator nit=names.begin(); nit!=names.end(); ++nit)
+  {
+    if ((*nit).find(opt_prefix) == 0)
+    {
+      string opt_value;
+      cfg().getValue(cfgName(), *nit, opt_value);
+      fifo->setEncoderOption((*nit).substr(opt_prefix.size()), opt_value);
+    }
+  }
   adapter->registerSink(fifo, true);
   
   valve = new AudioValve;
@@ -396,6 +426,7 @@ void ModuleParrot::allSamplesWritten(void)
 void ModuleParrot::onRepeatDelayExpired(void)
 {
   repeat_delay_timer.setEnable(false);
+  squelchCloseHandled();
   valve->setOpen(true);
 } /* ModuleParrot::onRepeatDelayExpired */
 
@@ -71,7 +71,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 
 namespace Async
 {
-  class SampleFifo;
+  class AudioEncodedFifo;
   class AudioValve;
 };
 
@@ -145,7 +145,7 @@ class ModuleParrot : public Module
     friend class FifoAdapter;
     
     FifoAdapter       	    *adapter;
-    Async::AudioFifo	    *fifo;
+    Async::AudioEncodedFifo *fifo;
     Async::AudioValve 	    *valve;
     bool      	      	    squelch_is_open;
     Async::Timer      	    repeat_delay_timer;
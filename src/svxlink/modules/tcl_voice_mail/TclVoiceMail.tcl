@@ -41,7 +41,6 @@ proc activating_module {} {
 #
 proc status_report {} {
   variable users
-  variable recdir
   
   #printInfo "status_report called...";
   
@@ -50,7 +49,7 @@ proc status_report {} {
   set user_list {}
   foreach userid [lsort [array names users]] {
     set call [id2var $userid call]
-    if {[llength [glob -nocomplain -directory "$recdir/$call" *_subj.wav]] > 0} {
+    if {[llength [messageList $call]] > 0} {
       lappend user_list $call
     }
   }
@@ -235,14 +234,18 @@ proc rec_done {} {
 #
 # This is not an event but a helper to play back a message specified by the
 # function argument "basename". The basename is the full path to the voice
-# mail file excluding the end of the filename (_subj.wav and _mesg.wav).
+# mail file excluding the end of the filename (e.g. _subj.wav and _mesg.wav).
 #
 #   basename - The basename of the message and subject file
 #
 proc playMessage {basename} {
-  playFile "$basename\_subj.wav"
+  set ext "wav"
+  if {[file exists "$basename\_subj.opus"]} {
+    set ext "opus"
+  }
+  playFile "$basename\_subj.$ext"
   playSilence 1000
-  playFile "$basename\_mesg.wav"
+  playFile "$basename\_mesg.$ext"
 }
 
 
@@ -0,0 +1,303 @@
+/**
+@file   AudioTraceStats.cpp
+@brief  Aggregate audio latency traces per talk group and per path
+@author Tobias Blomberg / SM0SVX
+@date   2026-10-15
+
+\verbatim
+SvxReflector - An audio reflector for connecting SvxLink Servers
+Copyright (C) 2003-2026 Tobias Blomberg / SM0SVX
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+\endverbatim
+*/
+
+/****************************************************************************
+ *
+ * System Includes
+ *
+ ****************************************************************************/
+
+#include <chrono>
+#include <vector>
+
+
+/****************************************************************************
+ *
+ * Project Includes
+ *
+ ****************************************************************************/
+
+#include <Metrics.h>
+
+
+/****************************************************************************
+ *
+ * Local Includes
+ *
+ ****************************************************************************/
+
+#include "AudioTraceStats.h"
+
+
+/****************************************************************************
+ *
+ * Namespaces to use
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Defines & typedefs
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Local class definitions
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Prototypes
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Exported Global Variables
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Local Global Variables
+ *
+ ****************************************************************************/
+
+namespace {
+  int64_t monotonicSeconds(void)
+  {
+    return std::chrono::duration_cast<std::chrono::seconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+  }
+
+  double latencyMs(uint64_t from_us, uint64_t to_us)
+  {
+    return (to_us > from_us) ? (to_us - from_us) / 1000.0 : 0.0;
+  }
+};
+
+
+/****************************************************************************
+ *
+ * Public member functions
+ *
+ ****************************************************************************/
+
+bool AudioTraceStats::add(const std::string& receiver,
+                          const MsgUdpAudioTrace& msg)
+{
+  uint64_t origin_ts = 0;
+  uint64_t reflector_ts = 0;
+  uint64_t node_rx_ts = 0;
+  uint64_t playout_ts = 0;
+  if ((msg.tg() == 0) || msg.origin().empty() ||
+      !msg.findHop(MsgUdpAudioTrace::HOP_ORIGIN, origin_ts) ||
+      !msg.findHop(MsgUdpAudioTrace::HOP_REFLECTOR, reflector_ts) ||
+      !msg.findHop(MsgUdpAudioTrace::HOP_NODE_RX, node_rx_ts) ||
+      !msg.findHop(MsgUdpAudioTrace::HOP_PLAYOUT, playout_ts))
+  {
+    return false;
+  }
+
+  double ms[SEGMENT_CNT];
+  ms[TOTAL] = latencyMs(origin_ts, playout_ts);
+  ms[UPLINK] = latencyMs(origin_ts, reflector_ts);
+  ms[DOWNLINK] = latencyMs(reflector_ts, node_rx_ts);
+  ms[PLAYOUT] = latencyMs(node_rx_ts, playout_ts);
+
+  const int64_t now = monotonicSeconds();
+  m_tgs[msg.tg()].add(ms, now);
+  const auto path = std::make_pair(msg.origin(), receiver);
+  if ((m_paths.size() < MAX_PATHS) || (m_paths.count(path) > 0))
+  {
+    m_paths[path].add(ms, now);
+  }
+  ++m_ver;
+
+    // The totals are kept in the metrics registry since the histograms in
+    // the status document are removed when a talk group has been idle
+  static const std::vector<double> bounds =
+    SvxLink::Metrics::exponentialBuckets(0.001, 2.0, BUCKETS-1);
+  for (unsigned i=0; i<SEGMENT_CNT; ++i)
+  {
+    SvxLink::Metrics::instance()->histogram(
+        "svxreflector_audio_trace_latency_seconds",
+        "Traced audio latency per talk group and path segment", bounds,
+        {{"tg", std::to_string(msg.tg())},
+         {"segment", segmentName(Segment(i))}}).observe(ms[i] / 1000.0);
+  }
+
+  return true;
+} /* AudioTraceStats::add */
+
+
+bool AudioTraceStats::prune(void)
+{
+  const int64_t now = monotonicSeconds();
+  bool changed = false;
+  for (auto it = m_tgs.begin(); it != m_tgs.end(); )
+  {
+    if (now - it->second.last_update >= IDLE_LIMIT)
+    {
+      it = m_tgs.erase(it);
+      changed = true;
+    }
+    else
+    {
+      ++it;
+    }
+  }
+  for (auto it = m_paths.begin(); it != m_paths.end(); )
+  {
+    if (now - it->second.last_update >= IDLE_LIMIT)
+    {
+      it = m_paths.erase(it);
+      changed = true;
+    }
+    else
+    {
+      ++it;
+    }
+  }
+  if (changed)
+  {
+    ++m_ver;
+  }
+  return changed;
+} /* AudioTraceStats::prune */
+
+
+Json::Value AudioTraceStats::status(void) const
+{
+  Json::Value status(Json::objectValue);
+  Json::Value& tgs = status["tg"] = Json::Value(Json::objectValue);
+  for (const auto& item : m_tgs)
+  {
+    tgs[std::to_string(item.first)] = item.second.json();
+  }
+  Json::Value& paths = status["path"] = Json::Value(Json::objectValue);
+  for (const auto& item : m_paths)
+  {
+    paths[item.first.first][item.first.second] = item.second.json();
+  }
+  return status;
+} /* AudioTraceStats::status */
+
+
+
+/****************************************************************************
+ *
+ * Protected member functions
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Private member functions
+ *
+ ****************************************************************************/
+
+void AudioTraceStats::Histogram::add(double ms)
+{
+  unsigned bucket = 0;
+  while ((bucket < BUCKETS-1) && (ms > static_cast<double>(1U << bucket)))
+  {
+    ++bucket;
+  }
+  buckets[bucket] += 1;
+  count += 1;
+  sum_ms += ms;
+  if (ms > max_ms)
+  {
+    max_ms = ms;
+  }
+} /* AudioTraceStats::Histogram::add */
+
+
+Json::Value AudioTraceStats::Histogram::json(void) const
+{
+  Json::Value hist(Json::objectValue);
+  hist["count"] = Json::UInt64(count);
+  hist["avgMs"] = (count > 0) ? sum_ms / count : 0.0;
+  hist["maxMs"] = max_ms;
+  Json::Value& hist_buckets = hist["hist"] = Json::Value(Json::arrayValue);
+  for (unsigned i=0; i<BUCKETS; ++i)
+  {
+    hist_buckets.append(Json::UInt64(buckets[i]));
+  }
+  return hist;
+} /* AudioTraceStats::Histogram::json */
+
+
+void AudioTraceStats::Entry::add(const double (&ms)[SEGMENT_CNT], int64_t now)
+{
+  for (unsigned i=0; i<SEGMENT_CNT; ++i)
+  {
+    segments[i].add(ms[i]);
+  }
+  last_update = now;
+} /* AudioTraceStats::Entry::add */
+
+
+Json::Value AudioTraceStats::Entry::json(void) const
+{
+  Json::Value entry(Json::objectValue);
+  for (unsigned i=0; i<SEGMENT_CNT; ++i)
+  {
+    entry[segmentName(Segment(i))] = segments[i].json();
+  }
+  return entry;
+} /* AudioTraceStats::Entry::json */
+
+
+const char* AudioTraceStats::segmentName(Segment segment)
+{
+  static const char* names[SEGMENT_CNT] =
+  {
+    "total", "uplink", "downlink", "playout"
+  };
+  return names[segment];
+} /* AudioTraceStats::segmentName */
+
+
+
+/*
+ * This file has not been truncated
+ */
@@ -0,0 +1,215 @@
+/**
+@file   AudioTraceStats.h
+@brief  Aggregate audio latency traces per talk group and per path
+@author Tobias Blomberg / SM0SVX
+@date   2026-10-15
+
+\verbatim
+SvxReflector - An audio reflector for connecting SvxLink Servers
+Copyright (C) 2003-2026 Tobias Blomberg / SM0SVX
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+\endverbatim
+*/
+
+#ifndef AUDIO_TRACE_STATS_INCLUDED
+#define AUDIO_TRACE_STATS_INCLUDED
+
+
+/****************************************************************************
+ *
+ * System Includes
+ *
+ ****************************************************************************/
+
+#include <json/json.h>
+
+#include <cstdint>
+#include <map>
+#include <string>
+#include <utility>
+
+
+/****************************************************************************
+ *
+ * Project Includes
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Local Includes
+ *
+ ****************************************************************************/
+
+#include "ReflectorMsg.h"
+
+
+/****************************************************************************
+ *
+ * Forward declarations
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Namespace
+ *
+ ****************************************************************************/
+
+//namespace MyNameSpace
+//{
+
+
+/****************************************************************************
+ *
+ * Forward declarations of classes inside of the declared namespace
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Defines & typedefs
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Exported Global Variables
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Class definitions
+ *
+ ****************************************************************************/
+
+/**
+@brief  Aggregate audio latency traces per talk group and per path
+@author Tobias Blomberg / SM0SVX
+@date   2026-10-15
+
+This class collect completed MsgUdpAudioTrace messages, sent back by the
+receiving nodes, into latency histograms. There is one set of histograms per
+talk group and one per path, where a path is the combination of the origin
+node and the receiving node. Each set hold one histogram for the end to end
+latency and one for each segment of the path:
+
+  uplink    From the origin node to the reflector
+  downlink  From the reflector to the receiving node
+  playout   From reception on the receiving node until the audio is played
+
+The end to end, uplink and downlink latencies depend on the clocks of the
+hosts being synchronized. Negative latencies, caused by clock offsets, are
+counted as zero. The playout latency is measured using one clock only.
+
+Talk groups and paths that have not seen a trace for a while are removed.
+*/
+class AudioTraceStats
+{
+  public:
+    typedef enum
+    {
+      TOTAL, UPLINK, DOWNLINK, PLAYOUT, SEGMENT_CNT
+    } Segment;
+
+    /**
+     * @brief   Default constructor
+     */
+    AudioTraceStats(void) {}
+
+    /**
+     * @brief   Add a completed trace
+     * @param   receiver  The callsign of the node that sent the trace back
+     * @param   msg       The trace message
+     * @return  Returns \em true if the trace was complete and was added
+     */
+    bool add(const std::string& receiver, const MsgUdpAudioTrace& msg);
+
+    /**
+     * @brief   Remove talk groups and paths that have been idle for a while
+     * @return  Returns \em true if anything was removed
+     */
+    bool prune(void);
+
+    /**
+     * @brief   Get a version number that is increased on each change
+     * @return  Returns the version number
+     */
+    uint64_t version(void) const { return m_ver; }
+
+    /**
+     * @brief   Get the status for the reflector status document
+     * @return  Returns a JSON object with a "tg" and a "path" member
+     */
+    Json::Value status(void) const;
+
+  private:
+    static const unsigned BUCKETS     = 12;
+    static const unsigned IDLE_LIMIT  = 3600;
+    static const size_t   MAX_PATHS   = 4096;
+
+    struct Histogram
+    {
+      uint64_t  buckets[BUCKETS] = {0};
+      uint64_t  count            = 0;
+      double    sum_ms           = 0.0;
+      double    max_ms           = 0.0;
+
+      void add(double ms);
+      Json::Value json(void) const;
+    };
+
+    struct Entry
+    {
+      Histogram segments[SEGMENT_CNT];
+      int64_t   last_update = 0;
+
+      void add(const double (&ms)[SEGMENT_CNT], int64_t now);
+      Json::Value json(void) const;
+    };
+
+    typedef std::map<uint32_t, Entry> TgMap;
+    typedef std::map<std::pair<std::string, std::string>, Entry> PathMap;
+
+    TgMap     m_tgs;
+    PathMap   m_paths;
+    uint64_t  m_ver = 0;
+
+    static const char* segmentName(Segment segment);
+
+};  /* class AudioTraceStats */
+
+
+//} /* namespace */
+
+#endif /* AUDIO_TRACE_STATS_INCLUDED */
+
+
+
+/*
+ * This file has not been truncated
+ */
@@ -0,0 +1,291 @@
+/**
+@file   CertStore.cpp
+@brief  An in-memory index of the client certificates and pending CSRs
+@author Tobias Blomberg / SM0SVX
+@date   2026-10-15
+
+\verbatim
+SvxReflector - An audio reflector for connecting SvxLink Servers
+Copyright (C) 2003-2026 Tobias Blomberg / SM0SVX
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+\endverbatim
+*/
+
+/****************************************************************************
+ *
+ * System Includes
+ *
+ ****************************************************************************/
+
+#include <sys/stat.h>
+#include <dirent.h>
+#include <unistd.h>
+#ifdef HAS_INOTIFY
+#include <sys/inotify.h>
+#endif
+
+#include <iostream>
+
+
+/****************************************************************************
+ *
+ * Project Includes
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Local Includes
+ *
+ ****************************************************************************/
+
+#include "CertStore.h"
+
+
+/****************************************************************************
+ *
+ * Namespaces to use
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Defines & typedefs
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Local class definitions
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Prototypes
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Exported Global Variables
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Local Global Variables
+ *
+ ****************************************************************************/
+
+namespace {
+  bool hasExtension(const std::string& filename, const std::string& ext)
+  {
+    return (filename.size() > ext.size()) &&
+           (filename.compare(filename.size()-ext.size(), ext.size(), ext) == 0);
+  }
+};
+
+
+/****************************************************************************
+ *
+ * Public member functions
+ *
+ ****************************************************************************/
+
+CertStore::CertStore(void)
+{
+  m_inotify_watch.activity.connect(
+      sigc::hide(sigc::mem_fun(*this, &CertStore::inotifyActivity)));
+} /* CertStore::CertStore */
+
+
+CertStore::~CertStore(void)
+{
+  m_inotify_watch.setEnabled(false);
+  if (m_inotify_fd >= 0)
+  {
+    ::close(m_inotify_fd);
+    m_inotify_fd = -1;
+  }
+} /* CertStore::~CertStore */
+
+
+bool CertStore::initialize(const std::string& certs_dir,
+                           const std::string& pending_csrs_dir)
+{
+  m_certs_dir = certs_dir;
+  m_pending_csrs_dir = pending_csrs_dir;
+
+#ifdef HAS_INOTIFY
+    // The watches are set up before the directories are scanned so that no
+    // change can slip through in between
+  const uint32_t mask = IN_CLOSE_WRITE | IN_MOVED_TO | IN_MOVED_FROM |
+                        IN_DELETE;
+  m_inotify_fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+  if (m_inotify_fd >= 0)
+  {
+    m_certs_wd = inotify_add_watch(m_inotify_fd, m_certs_dir.c_str(), mask);
+    m_pending_csrs_wd = inotify_add_watch(m_inotify_fd,
+                                          m_pending_csrs_dir.c_str(), mask);
+  }
+  if ((m_inotify_fd < 0) || (m_certs_wd < 0) || (m_pending_csrs_wd < 0))
+  {
+    std::cerr << "*** WARNING: Could not watch the certificate directories. "
+                 "Changes made by others will not be noticed until restart."
+              << std::endl;
+  }
+  if (m_inotify_fd >= 0)
+  {
+    m_inotify_watch.setFd(m_inotify_fd, Async::FdWatch::FD_WATCH_RD);
+    m_inotify_watch.setEnabled(true);
+  }
+#endif
+
+  m_certs.clear();
+  m_pending_csrs.clear();
+  scanDir(m_certs_dir, ".crt", &CertStore::refreshCert);
+  scanDir(m_pending_csrs_dir, ".csr", &CertStore::refreshPendingCsr);
+
+  return true;
+} /* CertStore::initialize */
+
+
+const CertStore::CertEntry* CertStore::findCert(
+    const std::string& callsign) const
+{
+  auto it = m_certs.find(callsign);
+  return (it != m_certs.end()) ? &it->second : nullptr;
+} /* CertStore::findCert */
+
+
+CertStore::CsrEntry* CertStore::findPendingCsr(const std::string& callsign)
+{
+  auto it = m_pending_csrs.find(callsign);
+  return (it != m_pending_csrs.end()) ? &it->second : nullptr;
+} /* CertStore::findPendingCsr */
+
+
+void CertStore::refreshCert(const std::string& callsign)
+{
+  CertEntry& entry = m_certs[callsign];
+  if (!entry.cert.readPemFile(m_certs_dir + "/" + callsign + ".crt") ||
+      entry.cert.isNull())
+  {
+    m_certs.erase(callsign);
+  }
+} /* CertStore::refreshCert */
+
+
+void CertStore::refreshPendingCsr(const std::string& callsign)
+{
+  const std::string path(m_pending_csrs_dir + "/" + callsign + ".csr");
+  CsrEntry& entry = m_pending_csrs[callsign];
+  struct stat st;
+  if (!entry.csr.readPemFile(path) || entry.csr.isNull() ||
+      (stat(path.c_str(), &st) != 0))
+  {
+    m_pending_csrs.erase(callsign);
+    return;
+  }
+  entry.received_time = st.st_mtime;
+} /* CertStore::refreshPendingCsr */
+
+
+
+/****************************************************************************
+ *
+ * Protected member functions
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Private member functions
+ *
+ ****************************************************************************/
+
+void CertStore::scanDir(const std::string& dir, const std::string& ext,
+                        void (CertStore::*refresh)(const std::string&))
+{
+  DIR* dirp = opendir(dir.c_str());
+  if (dirp == nullptr)
+  {
+    return;
+  }
+  struct dirent* entry;
+  while ((entry = readdir(dirp)) != nullptr)
+  {
+    std::string filename(entry->d_name);
+    if (hasExtension(filename, ext))
+    {
+      (this->*refresh)(filename.substr(0, filename.size()-ext.size()));
+    }
+  }
+  closedir(dirp);
+} /* CertStore::scanDir */
+
+
+void CertStore::inotifyActivity(void)
+{
+#ifdef HAS_INOTIFY
+  alignas(struct inotify_event) char buf[4096];
+  ssize_t len;
+  while ((len = ::read(m_inotify_fd, buf, sizeof(buf))) > 0)
+  {
+    for (char* ptr = buf; ptr < buf + len; )
+    {
+      const struct inotify_event* event =
+        reinterpret_cast<const struct inotify_event*>(ptr);
+      ptr += sizeof(struct inotify_event) + event->len;
+      if (event->len == 0)
+      {
+        continue;
+      }
+      const std::string filename(event->name);
+      if ((event->wd == m_certs_wd) && hasExtension(filename, ".crt"))
+      {
+        refreshCert(filename.substr(0, filename.size()-4));
+      }
+      else if ((event->wd == m_pending_csrs_wd) &&
+               hasExtension(filename, ".csr"))
+      {
+        refreshPendingCsr(filename.substr(0, filename.size()-4));
+      }
+    }
+  }
+#endif
+} /* CertStore::inotifyActivity */
+
+
+
+/*
+ * This file has not been truncated
+ */
@@ -0,0 +1,246 @@
+/**
+@file   CertStore.h
+@brief  An in-memory index of the client certificates and pending CSRs
+@author Tobias Blomberg / SM0SVX
+@date   2026-10-15
+
+\verbatim
+SvxReflector - An audio reflector for connecting SvxLink Servers
+Copyright (C) 2003-2026 Tobias Blomberg / SM0SVX
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+\endverbatim
+*/
+
+#ifndef CERT_STORE_INCLUDED
+#define CERT_STORE_INCLUDED
+
+
+/****************************************************************************
+ *
+ * System Includes
+ *
+ ****************************************************************************/
+
+#include <sigc++/sigc++.h>
+
+#include <ctime>
+#include <map>
+#include <string>
+#include <vector>
+
+
+/****************************************************************************
+ *
+ * Project Includes
+ *
+ ****************************************************************************/
+
+#include <AsyncFdWatch.h>
+#include <AsyncSslX509.h>
+#include <AsyncSslCertSigningReq.h>
+
+
+/****************************************************************************
+ *
+ * Local Includes
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Forward declarations
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Namespace
+ *
+ ****************************************************************************/
+
+//namespace MyNameSpace
+//{
+
+
+/****************************************************************************
+ *
+ * Forward declarations of classes inside of the declared namespace
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Defines & typedefs
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Exported Global Variables
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Class definitions
+ *
+ ****************************************************************************/
+
+/**
+@brief  An in-memory index of the client certificates and pending CSRs
+@author Tobias Blomberg / SM0SVX
+@date   2026-10-15
+
+This class keep the parsed client certificates and pending certificate
+signing requests in memory, indexed on the callsign, so that they do not
+have to be read from disk and parsed each time they are needed. The files on
+disk are still the persistent storage. The index is built when the store is
+initialized and it is then kept up to date using inotify so that files that
+are added, changed or removed by someone else are noticed. Files written by
+the reflector itself should be refreshed directly using refreshCert and
+refreshPendingCsr since the inotify events arrive asynchronously.
+
+Certificates are read from files named CALLSIGN.crt in the certificates
+directory and pending CSRs from files named CALLSIGN.csr in the pending CSRs
+directory.
+*/
+class CertStore : public sigc::trackable
+{
+  public:
+    struct CertEntry
+    {
+      Async::SslX509  cert;
+    };
+
+    struct CsrEntry
+    {
+      Async::SslCertSigningReq  csr;
+      std::time_t               received_time = 0;
+    };
+
+    typedef std::map<std::string, CertEntry> CertMap;
+    typedef std::map<std::string, CsrEntry>  CsrMap;
+
+    /**
+     * @brief   Default constructor
+     */
+    CertStore(void);
+
+    /**
+     * @brief   Disallow copy construction
+     */
+    CertStore(const CertStore&) = delete;
+
+    /**
+     * @brief   Disallow copy assignment
+     */
+    CertStore& operator=(const CertStore&) = delete;
+
+    /**
+     * @brief   Destructor
+     */
+    ~CertStore(void);
+
+    /**
+     * @brief   Build the index and start watching the directories
+     * @param   certs_dir         The directory holding the certificates
+     * @param   pending_csrs_dir  The directory holding the pending CSRs
+     * @return  Returns \em true on success or \em false on failure
+     *
+     * The index is still usable if the directories cannot be watched but
+     * changes made by others will then not be noticed.
+     */
+    bool initialize(const std::string& certs_dir,
+                    const std::string& pending_csrs_dir);
+
+    /**
+     * @brief   Find the certificate for a callsign
+     * @param   callsign The callsign to look for
+     * @return  Returns a pointer to the entry or \em nullptr if not found
+     */
+    const CertEntry* findCert(const std::string& callsign) const;
+
+    /**
+     * @brief   Find the pending CSR for a callsign
+     * @param   callsign The callsign to look for
+     * @return  Returns a pointer to the entry or \em nullptr if not found
+     */
+    CsrEntry* findPendingCsr(const std::string& callsign);
+
+    /**
+     * @brief   Get all certificates
+     * @return  Returns the map of certificates indexed on callsign
+     */
+    const CertMap& certs(void) const { return m_certs; }
+
+    /**
+     * @brief   Get all pending CSRs
+     * @return  Returns the map of pending CSRs indexed on callsign
+     */
+    CsrMap& pendingCsrs(void) { return m_pending_csrs; }
+
+    /**
+     * @brief   Read the certificate file for a callsign again
+     * @param   callsign The callsign of the certificate
+     *
+     * The entry is removed if the file does not exist or cannot be parsed.
+     */
+    void refreshCert(const std::string& callsign);
+
+    /**
+     * @brief   Read the pending CSR file for a callsign again
+     * @param   callsign The callsign of the CSR
+     *
+     * The entry is removed if the file does not exist or cannot be parsed.
+     */
+    void refreshPendingCsr(const std::string& callsign);
+
+  private:
+    std::string     m_certs_dir;
+    std::string     m_pending_csrs_dir;
+    CertMap         m_certs;
+    CsrMap          m_pending_csrs;
+    int             m_inotify_fd          = -1;
+    int             m_certs_wd            = -1;
+    int             m_pending_csrs_wd     = -1;
+    Async::FdWatch  m_inotify_watch;
+
+    void scanDir(const std::string& dir, const std::string& ext,
+                 void (CertStore::*refresh)(const std::string&));
+    void inotifyActivity(void);
+
+};  /* class CertStore */
+
+
+//} /* namespace */
+
+#endif /* CERT_STORE_INCLUDED */
+
+
+
+/*
+ * This file has not been truncated
+ */
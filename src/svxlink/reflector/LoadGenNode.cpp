@@ -0,0 +1,666 @@
+/**
+@file   LoadGenNode.cpp
+@brief  An emulated node used by the reflector load generator
+@author Tobias Blomberg / SM0SVX
+@date   2026-10-14
+
+\verbatim
+SvxReflector - An audio reflector for connecting SvxLink Servers
+Copyright (C) 2003-2026 Tobias Blomberg / SM0SVX
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+\endverbatim
+*/
+
+/****************************************************************************
+ *
+ * System Includes
+ *
+ ****************************************************************************/
+
+#include <iostream>
+#include <sstream>
+
+
+/****************************************************************************
+ *
+ * Project Includes
+ *
+ ****************************************************************************/
+
+#include <AsyncEncryptedUdpSocket.h>
+#include <AsyncSslCertSigningReq.h>
+#include <AsyncSslX509Extensions.h>
+
+
+/****************************************************************************
+ *
+ * Local Includes
+ *
+ ****************************************************************************/
+
+#include "LoadGenNode.h"
+
+
+/****************************************************************************
+ *
+ * Namespaces to use
+ *
+ ****************************************************************************/
+
+using namespace std;
+using namespace Async;
+
+
+/****************************************************************************
+ *
+ * Defines & typedefs
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Local class definitions
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Prototypes
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Exported Global Variables
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Local Global Variables
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Public member functions
+ *
+ ****************************************************************************/
+
+LoadGenNode::LoadGenNode(const Shared& shared, const std::string& callsign,
+                         uint32_t tg, const std::set<uint32_t>& monitor_tgs)
+  : m_shared(shared), m_callsign(callsign), m_tg(tg),
+    m_monitor_tgs(monitor_tgs), m_con(shared.host, shared.port)
+{
+  m_con.connected.connect(sigc::mem_fun(*this, &LoadGenNode::onConnected));
+  m_con.disconnected.connect(
+      sigc::mem_fun(*this, &LoadGenNode::onDisconnected));
+  m_con.frameDataReceived.connect(
+      sigc::mem_fun(*this, &LoadGenNode::onFrameReceived));
+  m_con.verifyPeer.connect(sigc::mem_fun(*this, &LoadGenNode::onVerifyPeer));
+  m_con.sslConnectionReady.connect(
+      sigc::mem_fun(*this, &LoadGenNode::onSslConnectionReady));
+  m_con.setMaxFrameSize(ReflectorMsg::MAX_POSTAUTH_FRAME_SIZE);
+} /* LoadGenNode::LoadGenNode */
+
+
+LoadGenNode::~LoadGenNode(void)
+{
+  delete m_udp_sock;
+  m_udp_sock = nullptr;
+} /* LoadGenNode::~LoadGenNode */
+
+
+void LoadGenNode::connect(void)
+{
+  if (m_con_state != STATE_DISCONNECTED)
+  {
+    return;
+  }
+  if (m_csr_pem.empty() && !createCsr())
+  {
+    disconnected(this, "CSR creation failed");
+    return;
+  }
+  m_con_state = STATE_EXPECT_CA_INFO;
+  m_login_time_left = LOGIN_TIMEOUT;
+  m_con.setSslContext(*m_shared.ssl_ctx);
+  m_con.setBindIp(m_bind_ip);
+  m_con.connect();
+} /* LoadGenNode::connect */
+
+
+void LoadGenNode::disconnect(void)
+{
+  m_con.disconnect();
+  delete m_udp_sock;
+  m_udp_sock = nullptr;
+  m_con_state = STATE_DISCONNECTED;
+} /* LoadGenNode::disconnect */
+
+
+void LoadGenNode::tick(void)
+{
+  if (m_con_state == STATE_DISCONNECTED)
+  {
+    return;
+  }
+
+  if (m_con_state != STATE_CONNECTED)
+  {
+    if (--m_login_time_left == 0)
+    {
+      fail("Login timeout");
+    }
+    if (m_con_state != STATE_EXPECT_UDP_HEARTBEAT)
+    {
+      return;
+    }
+  }
+
+  if (--m_udp_heartbeat_tx_cnt == 0)
+  {
+    if (m_con_state == STATE_EXPECT_UDP_HEARTBEAT)
+    {
+      sendUdpMsg(UdpCipher::InitialAAD{m_client_id}, MsgUdpHeartbeat());
+    }
+    else
+    {
+      sendUdpMsg(MsgUdpHeartbeat());
+    }
+  }
+
+  if (--m_tcp_heartbeat_tx_cnt == 0)
+  {
+    sendMsg(MsgHeartbeat());
+  }
+
+  if (--m_udp_heartbeat_rx_cnt == 0)
+  {
+    fail("UDP heartbeat timeout");
+    return;
+  }
+
+  if (--m_tcp_heartbeat_rx_cnt == 0)
+  {
+    fail("Heartbeat timeout");
+  }
+} /* LoadGenNode::tick */
+
+
+void LoadGenNode::sendAudio(const std::vector<uint8_t>& frame, bool drop)
+{
+  if (!isLoggedIn())
+  {
+    return;
+  }
+  if (drop)
+  {
+    m_udp_cipher_iv_cntr += 1;
+    m_udp_heartbeat_tx_cnt = UDP_HEARTBEAT_TX_CNT_RESET;
+    return;
+  }
+  sendUdpMsg(MsgUdpAudio(frame));
+} /* LoadGenNode::sendAudio */
+
+
+void LoadGenNode::flushAudio(void)
+{
+  if (isLoggedIn())
+  {
+    sendUdpMsg(MsgUdpFlushSamples());
+  }
+} /* LoadGenNode::flushAudio */
+
+
+
+/****************************************************************************
+ *
+ * Protected member functions
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Private member functions
+ *
+ ****************************************************************************/
+
+bool LoadGenNode::createCsr(void)
+{
+  SslCertSigningReq csr;
+  SslX509Extensions csr_exts;
+  csr_exts.addBasicConstraints("critical, CA:FALSE");
+  csr_exts.addKeyUsage(
+      "critical, digitalSignature, keyEncipherment, keyAgreement");
+  csr_exts.addExtKeyUsage("clientAuth");
+  if (!m_shared.cert_email.empty())
+  {
+    csr_exts.addSubjectAltNames(std::string("email:") + m_shared.cert_email);
+  }
+  if (!csr.setVersion(SslCertSigningReq::VERSION_1) ||
+      !csr.addSubjectName("CN", m_callsign))
+  {
+    return false;
+  }
+  csr.addExtensions(csr_exts);
+  if (!csr.setPublicKey(*m_shared.keypair) || !csr.sign(*m_shared.keypair))
+  {
+    return false;
+  }
+  m_csr_pem = csr.pem();
+  return !m_csr_pem.empty();
+} /* LoadGenNode::createCsr */
+
+
+void LoadGenNode::onConnected(void)
+{
+  m_udp_heartbeat_tx_cnt = UDP_HEARTBEAT_TX_CNT_RESET;
+  m_udp_heartbeat_rx_cnt = UDP_HEARTBEAT_RX_CNT_RESET;
+  m_tcp_heartbeat_tx_cnt = TCP_HEARTBEAT_TX_CNT_RESET;
+  m_tcp_heartbeat_rx_cnt = TCP_HEARTBEAT_RX_CNT_RESET;
+  m_next_udp_rx_seq = 0;
+  m_con_state = STATE_EXPECT_CA_INFO;
+  sendMsg(MsgProtoVer());
+} /* LoadGenNode::onConnected */
+
+
+void LoadGenNode::onDisconnected(FramedTcpConnection*,
+                                 FramedTcpConnection::DisconnectReason reason)
+{
+  fail(TcpConnection::disconnectReasonStr(reason));
+} /* LoadGenNode::onDisconnected */
+
+
+int LoadGenNode::onVerifyPeer(TcpConnection*, int preverify_ok,
+                              X509_STORE_CTX*)
+{
+  return m_shared.verify_server ? preverify_ok : 1;
+} /* LoadGenNode::onVerifyPeer */
+
+
+void LoadGenNode::onSslConnectionReady(TcpConnection*)
+{
+  if (m_con_state != STATE_EXPECT_SSL_CON_READY)
+  {
+    fail("Unexpected SSL connection readiness");
+    return;
+  }
+  if (m_shared.verify_server && (m_con.sslVerifyResult() != X509_V_OK))
+  {
+    fail("SSL certificate verification failed");
+    return;
+  }
+  m_con_state = STATE_EXPECT_AUTH_ANSWER;
+} /* LoadGenNode::onSslConnectionReady */
+
+
+void LoadGenNode::onFrameReceived(FramedTcpConnection*,
+                                  const uint8_t* data, size_t len)
+{
+  FramedTcpConnection::FrameIStream ss(data, len);
+
+  ReflectorMsg header;
+  if (!header.unpack(ss))
+  {
+    fail("Unpacking failed for TCP message header");
+    return;
+  }
+
+  m_tcp_heartbeat_rx_cnt = TCP_HEARTBEAT_RX_CNT_RESET;
+
+  switch (header.type())
+  {
+    case MsgError::TYPE:
+      handleMsgError(ss);
+      break;
+    case MsgCAInfo::TYPE:
+      handleMsgCAInfo(ss);
+      break;
+    case MsgStartEncryption::TYPE:
+      handleMsgStartEncryption();
+      break;
+    case MsgClientCsrRequest::TYPE:
+      handleMsgClientCsrRequest();
+      break;
+    case MsgClientCert::TYPE:
+      handleMsgClientCert();
+      break;
+    case MsgAuthChallenge::TYPE:
+      handleMsgAuthChallenge(ss);
+      break;
+    case MsgAuthOk::TYPE:
+      handleMsgAuthOk();
+      break;
+    case MsgServerInfo::TYPE:
+      handleMsgServerInfo(ss);
+      break;
+    case MsgStartUdpEncryption::TYPE:
+      handleMsgStartUdpEncryption();
+      break;
+    default:
+        // All other messages, like the node list and talker updates, are
+        // not needed to generate load
+      break;
+  }
+} /* LoadGenNode::onFrameReceived */
+
+
+void LoadGenNode::handleMsgError(std::istream& is)
+{
+  MsgError msg;
+  if (!msg.unpack(is))
+  {
+    fail("Could not unpack MsgError");
+    return;
+  }
+  fail(string("Server error: ") + msg.message());
+} /* LoadGenNode::handleMsgError */
+
+
+void LoadGenNode::handleMsgCAInfo(std::istream& is)
+{
+  if (m_con_state != STATE_EXPECT_CA_INFO)
+  {
+    fail("Unexpected MsgCAInfo");
+    return;
+  }
+  MsgCAInfo msg;
+  if (!msg.unpack(is))
+  {
+    fail("Could not unpack MsgCAInfo");
+    return;
+  }
+  sendMsg(MsgStartEncryptionRequest());
+  m_con_state = STATE_EXPECT_START_ENCRYPTION;
+} /* LoadGenNode::handleMsgCAInfo */
+
+
+void LoadGenNode::handleMsgStartEncryption(void)
+{
+  if (m_con_state != STATE_EXPECT_START_ENCRYPTION)
+  {
+    fail("Unexpected MsgStartEncryption");
+    return;
+  }
+  m_con_state = STATE_EXPECT_SSL_CON_READY;
+  m_con.enableSsl(true);
+} /* LoadGenNode::handleMsgStartEncryption */
+
+
+void LoadGenNode::handleMsgClientCsrRequest(void)
+{
+  if (m_con_state != STATE_EXPECT_AUTH_ANSWER)
+  {
+    fail("Unexpected MsgClientCsrRequest");
+    return;
+  }
+  sendMsg(MsgClientCsr(m_csr_pem));
+} /* LoadGenNode::handleMsgClientCsrRequest */
+
+
+void LoadGenNode::handleMsgClientCert(void)
+{
+    // The load generator cannot use client certificates since all nodes
+    // share the same SSL context. The reflector will keep sending the
+    // certificate so the node cannot log in.
+  fail("Received a client certificate. Remove the certificate for this "
+       "callsign from the reflector to use it for load testing");
+} /* LoadGenNode::handleMsgClientCert */
+
+
+void LoadGenNode::handleMsgAuthChallenge(std::istream& is)
+{
+  if (m_con_state != STATE_EXPECT_AUTH_ANSWER)
+  {
+    fail("Unexpected MsgAuthChallenge");
+    return;
+  }
+  MsgAuthChallenge msg;
+  if (!msg.unpack(is) || (msg.challenge() == nullptr))
+  {
+    fail("Illegal MsgAuthChallenge");
+    return;
+  }
+  sendMsg(MsgAuthResponse(m_callsign, m_shared.auth_key, msg.challenge()));
+} /* LoadGenNode::handleMsgAuthChallenge */
+
+
+void LoadGenNode::handleMsgAuthOk(void)
+{
+  if (m_con_state != STATE_EXPECT_AUTH_ANSWER)
+  {
+    fail("Unexpected MsgAuthOk");
+    return;
+  }
+  m_con_state = STATE_EXPECT_SERVER_INFO;
+} /* LoadGenNode::handleMsgAuthOk */
+
+
+void LoadGenNode::handleMsgServerInfo(std::istream& is)
+{
+  if (m_con_state != STATE_EXPECT_SERVER_INFO)
+  {
+    fail("Unexpected MsgServerInfo");
+    return;
+  }
+  MsgServerInfo msg;
+  if (!msg.unpack(is))
+  {
+    fail("Could not unpack MsgServerInfo");
+    return;
+  }
+  m_client_id = msg.clientId();
+
+  const auto cipher = EncryptedUdpSocket::fetchCipher(UdpCipher::NAME);
+  if (cipher == nullptr)
+  {
+    fail(string("Unsupported UDP cipher ") + UdpCipher::NAME);
+    return;
+  }
+
+  delete m_udp_sock;
+  m_udp_cipher_iv_cntr = 1;
+  m_udp_sock = new EncryptedUdpSocket(0, m_bind_ip);
+  m_udp_cipher_iv_rand.resize(UdpCipher::IVRANDLEN);
+  if (!m_udp_sock->initOk() || !m_udp_sock->setCipher(cipher) ||
+      !EncryptedUdpSocket::randomBytes(m_udp_cipher_iv_rand) ||
+      !m_udp_sock->setCipherKey())
+  {
+    fail("Could not create UDP socket");
+    return;
+  }
+  m_udp_sock->setCipherAADLength(UdpCipher::AADLEN);
+  m_udp_sock->setTagLength(UdpCipher::TAGLEN);
+  m_udp_sock->cipherDataReceived.connect(
+      sigc::mem_fun(*this, &LoadGenNode::udpCipherDataReceived));
+  m_udp_sock->dataReceived.connect(
+      sigc::mem_fun(*this, &LoadGenNode::udpDatagramReceived));
+
+  m_con_state = STATE_EXPECT_START_UDP_ENCRYPTION;
+  sendMsg(MsgNodeInfo(m_udp_cipher_iv_rand, m_udp_sock->cipherKey(),
+                      m_shared.node_info_json));
+} /* LoadGenNode::handleMsgServerInfo */
+
+
+void LoadGenNode::handleMsgStartUdpEncryption(void)
+{
+  if (m_con_state != STATE_EXPECT_START_UDP_ENCRYPTION)
+  {
+    fail("Unexpected MsgStartUdpEncryption");
+    return;
+  }
+  m_con_state = STATE_EXPECT_UDP_HEARTBEAT;
+  sendUdpMsg(UdpCipher::InitialAAD{m_client_id}, MsgUdpHeartbeat());
+} /* LoadGenNode::handleMsgStartUdpEncryption */
+
+
+bool LoadGenNode::udpCipherDataReceived(const IpAddress& addr, uint16_t port,
+                                        void* buf, int count)
+{
+  if (static_cast<size_t>(count) < UdpCipher::AADLEN)
+  {
+    return true;
+  }
+  Async::MsgBufReader r(buf, UdpCipher::AADLEN);
+  if (!m_aad.unpack(r))
+  {
+    return true;
+  }
+  UdpCipher::IV{m_udp_cipher_iv_rand, 0, m_aad.iv_cntr}
+    .assignTo(m_udp_iv_buf);
+  m_udp_sock->setCipherIV(m_udp_iv_buf);
+  return false;
+} /* LoadGenNode::udpCipherDataReceived */
+
+
+void LoadGenNode::udpDatagramReceived(const IpAddress& addr, uint16_t port,
+                                      void* aad, void* buf, int count)
+{
+  if ((m_con_state < STATE_EXPECT_UDP_HEARTBEAT) ||
+      (addr != m_con.remoteHost()) || (port != m_con.remotePort()))
+  {
+    return;
+  }
+
+  Async::MsgBufReader r(buf, count);
+  ReflectorUdpMsg header;
+  if (!header.unpack(r))
+  {
+    return;
+  }
+
+  if (m_aad.iv_cntr < m_next_udp_rx_seq)
+  {
+    return;
+  }
+  const uint32_t lost = m_aad.iv_cntr - m_next_udp_rx_seq;
+  m_next_udp_rx_seq = m_aad.iv_cntr + 1;
+  m_udp_heartbeat_rx_cnt = UDP_HEARTBEAT_RX_CNT_RESET;
+
+  if ((m_con_state == STATE_EXPECT_UDP_HEARTBEAT) &&
+      (header.type() == MsgUdpHeartbeat::TYPE))
+  {
+    m_con_state = STATE_CONNECTED;
+    sendMsg(MsgSelectTG(m_tg));
+    if (!m_monitor_tgs.empty())
+    {
+      sendMsg(MsgTgMonitor(m_monitor_tgs));
+    }
+    loggedIn(this);
+    return;
+  }
+
+  if ((m_con_state == STATE_CONNECTED) &&
+      (header.type() == MsgUdpAudio::TYPE))
+  {
+    const uint8_t* audio = nullptr;
+    size_t audio_size = 0;
+    if (MsgUdpAudio::peekAudioData(r, buf, audio, audio_size) &&
+        (audio_size > 0))
+    {
+      audioReceived(this, audio, audio_size, lost);
+    }
+  }
+} /* LoadGenNode::udpDatagramReceived */
+
+
+void LoadGenNode::sendMsg(const ReflectorMsg& msg)
+{
+  if (!m_con.isConnected())
+  {
+    return;
+  }
+  m_tcp_heartbeat_tx_cnt = TCP_HEARTBEAT_TX_CNT_RESET;
+
+  ReflectorMsg header(msg.type());
+  std::vector<uint8_t> buf(header.packedSize() + msg.packedSize());
+  Async::MsgBufWriter w(buf.data(), buf.size());
+  if (!header.pack(w) || !msg.pack(w))
+  {
+    fail("Failed to pack reflector TCP message");
+    return;
+  }
+  if (m_con.write(buf.data(), w.size()) == -1)
+  {
+    fail("Failed to write message to network connection");
+  }
+} /* LoadGenNode::sendMsg */
+
+
+void LoadGenNode::sendUdpMsg(const UdpCipher::AAD& aad,
+                             const ReflectorUdpMsg& msg)
+{
+  m_udp_heartbeat_tx_cnt = UDP_HEARTBEAT_TX_CNT_RESET;
+  if (m_udp_sock == nullptr)
+  {
+    return;
+  }
+
+  ReflectorUdpMsg header(msg.type());
+  m_udp_tx_buf.resize(header.packedSize() + msg.packedSize());
+  Async::MsgBufWriter w(m_udp_tx_buf.data(), m_udp_tx_buf.size());
+  if (!header.pack(w) || !msg.pack(w))
+  {
+    return;
+  }
+  UdpCipher::IV{m_udp_cipher_iv_rand, m_client_id, aad.iv_cntr}
+    .assignTo(m_udp_iv_buf);
+  m_udp_sock->setCipherIV(m_udp_iv_buf);
+  uint8_t aadbuf[UdpCipher::AADLEN + sizeof(UdpCipher::ClientId)];
+  Async::MsgBufWriter aadw(aadbuf, sizeof(aadbuf));
+  if (!aad.pack(aadw))
+  {
+    return;
+  }
+  m_udp_sock->write(m_con.remoteHost(), m_con.remotePort(),
+                    aadbuf, aadw.size(), m_udp_tx_buf.data(), w.size());
+} /* LoadGenNode::sendUdpMsg */
+
+
+void LoadGenNode::sendUdpMsg(const ReflectorUdpMsg& msg)
+{
+  sendUdpMsg(UdpCipher::AAD{m_udp_cipher_iv_cntr++}, msg);
+} /* LoadGenNode::sendUdpMsg */
+
+
+void LoadGenNode::fail(const std::string& reason)
+{
+  if (m_con_state == STATE_DISCONNECTED)
+  {
+    return;
+  }
+  disconnect();
+  disconnected(this, reason);
+} /* LoadGenNode::fail */
+
+
+
+/*
+ * This file has not been truncated
+ */
@@ -0,0 +1,345 @@
+/**
+@file   LoadGenNode.h
+@brief  An emulated node used by the reflector load generator
+@author Tobias Blomberg / SM0SVX
+@date   2026-10-14
+
+\verbatim
+SvxReflector - An audio reflector for connecting SvxLink Servers
+Copyright (C) 2003-2026 Tobias Blomberg / SM0SVX
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+\endverbatim
+*/
+
+#ifndef LOAD_GEN_NODE_INCLUDED
+#define LOAD_GEN_NODE_INCLUDED
+
+
+/****************************************************************************
+ *
+ * System Includes
+ *
+ ****************************************************************************/
+
+#include <sigc++/sigc++.h>
+
+#include <string>
+#include <vector>
+#include <set>
+
+
+/****************************************************************************
+ *
+ * Project Includes
+ *
+ ****************************************************************************/
+
+#include <AsyncTcpClient.h>
+#include <AsyncFramedTcpConnection.h>
+#include <AsyncSslContext.h>
+#include <AsyncSslKeypair.h>
+#include <AsyncIpAddress.h>
+
+
+/****************************************************************************
+ *
+ * Local Includes
+ *
+ ****************************************************************************/
+
+#include "ReflectorMsg.h"
+
+
+/****************************************************************************
+ *
+ * Forward declarations
+ *
+ ****************************************************************************/
+
+namespace Async
+{
+  class EncryptedUdpSocket;
+};
+
+
+/****************************************************************************
+ *
+ * Namespace
+ *
+ ****************************************************************************/
+
+//namespace MyNameSpace
+//{
+
+
+/****************************************************************************
+ *
+ * Forward declarations of classes inside of the declared namespace
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Defines & typedefs
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Exported Global Variables
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Class definitions
+ *
+ ****************************************************************************/
+
+/**
+@brief  An emulated node used by the reflector load generator
+@author Tobias Blomberg / SM0SVX
+@date   2026-10-14
+
+This class implement the client side of the reflector protocol in the same
+way as the ReflectorLogic does, but without any audio processing. A node log
+in to the reflector using TLS and password authentication, set up ciphered
+UDP, select a talk group and optionally monitor a set of talk groups. It can
+then be told to send prepared audio frames and it will report all audio
+frames that it receive. A large number of nodes can be run in one process.
+
+Since the nodes do not have client certificates, the reflector will store a
+pending certificate signing request for each node. All nodes share the same
+key pair so that the CSR for a callsign stay the same between runs.
+*/
+class LoadGenNode : public sigc::trackable
+{
+  public:
+    /**
+     * @brief Settings shared by all nodes
+     */
+    struct Shared
+    {
+      std::string         host;
+      uint16_t            port            = 5300;
+      std::string         auth_key;
+      std::string         cert_email;
+      Async::SslContext*  ssl_ctx         = nullptr;
+      Async::SslKeypair*  keypair         = nullptr;
+      bool                verify_server   = false;
+      std::string         node_info_json;
+    };
+
+    /**
+     * @brief   Constructor
+     * @param   shared      Settings shared by all nodes
+     * @param   callsign    The callsign of this node
+     * @param   tg          The talk group to select
+     * @param   monitor_tgs The talk groups to monitor
+     */
+    LoadGenNode(const Shared& shared, const std::string& callsign,
+                uint32_t tg, const std::set<uint32_t>& monitor_tgs);
+
+    /**
+     * @brief   Destructor
+     */
+    ~LoadGenNode(void);
+
+    /**
+     * @brief   Get the callsign of this node
+     * @return  Returns the callsign
+     */
+    const std::string& callsign(void) const { return m_callsign; }
+
+    /**
+     * @brief   Get the selected talk group
+     * @return  Returns the talk group selected by this node
+     */
+    uint32_t tg(void) const { return m_tg; }
+
+    /**
+     * @brief   Check if the node is fully logged in
+     * @return  Returns \em true if bidirectional UDP has been verified
+     */
+    bool isLoggedIn(void) const { return m_con_state == STATE_CONNECTED; }
+
+    /**
+     * @brief   Check if the node is disconnected
+     * @return  Returns \em true if there is no connection or login ongoing
+     */
+    bool isDisconnected(void) const
+    {
+      return m_con_state == STATE_DISCONNECTED;
+    }
+
+    /**
+     * @brief   Set the local IP address to use for the connections
+     * @param   bind_ip The IP address to bind both TCP and UDP to
+     *
+     * The reflector throttle the number of connections from each IP address
+     * so binding the nodes to different local addresses make it possible to
+     * run many nodes from the same host.
+     */
+    void setBindIp(const Async::IpAddress& bind_ip) { m_bind_ip = bind_ip; }
+
+    /**
+     * @brief   Connect to the reflector
+     */
+    void connect(void);
+
+    /**
+     * @brief   Disconnect from the reflector
+     *
+     * The disconnected signal is not emitted when calling this function.
+     */
+    void disconnect(void);
+
+    /**
+     * @brief   Handle heartbeats and timeouts
+     *
+     * This function must be called once every second.
+     */
+    void tick(void);
+
+    /**
+     * @brief   Send an encoded audio frame
+     * @param   frame The encoded audio frame
+     * @param   drop  Simulate that the frame is lost on the way
+     *
+     * A dropped frame still use up a sequence number so the reflector will
+     * see the loss.
+     */
+    void sendAudio(const std::vector<uint8_t>& frame, bool drop=false);
+
+    /**
+     * @brief   Tell the reflector that the talk spurt has ended
+     */
+    void flushAudio(void);
+
+    /**
+     * @brief   A signal that is emitted when the node is fully logged in
+     * @param   node The node that logged in
+     */
+    sigc::signal<void(LoadGenNode*)> loggedIn;
+
+    /**
+     * @brief   A signal that is emitted when the connection is lost
+     * @param   node    The node that was disconnected
+     * @param   reason  A short description of the reason
+     */
+    sigc::signal<void(LoadGenNode*, const std::string&)> disconnected;
+
+    /**
+     * @brief   A signal that is emitted when an audio frame is received
+     * @param   node  The node that received the frame
+     * @param   data  The encoded audio data
+     * @param   size  The size of the encoded audio data
+     * @param   lost  The number of UDP datagrams lost before this one
+     */
+    sigc::signal<void(LoadGenNode*, const uint8_t*, size_t,
+                      uint32_t)> audioReceived;
+
+  private:
+    typedef enum
+    {
+      STATE_DISCONNECTED,
+      STATE_EXPECT_CA_INFO,
+      STATE_EXPECT_START_ENCRYPTION,
+      STATE_EXPECT_SSL_CON_READY,
+      STATE_EXPECT_AUTH_ANSWER,
+      STATE_EXPECT_SERVER_INFO,
+      STATE_EXPECT_START_UDP_ENCRYPTION,
+      STATE_EXPECT_UDP_HEARTBEAT,
+      STATE_CONNECTED
+    } ConState;
+
+    typedef Async::TcpClient<Async::FramedTcpConnection> FramedTcpClient;
+
+    static const unsigned UDP_HEARTBEAT_TX_CNT_RESET  = 15;
+    static const unsigned UDP_HEARTBEAT_RX_CNT_RESET  = 60;
+    static const unsigned TCP_HEARTBEAT_TX_CNT_RESET  = 10;
+    static const unsigned TCP_HEARTBEAT_RX_CNT_RESET  = 15;
+    static const unsigned LOGIN_TIMEOUT               = 30;
+
+    const Shared&               m_shared;
+    const std::string           m_callsign;
+    const uint32_t              m_tg;
+    const std::set<uint32_t>    m_monitor_tgs;
+    FramedTcpClient             m_con;
+    Async::IpAddress            m_bind_ip;
+    ConState                    m_con_state             = STATE_DISCONNECTED;
+    std::string                 m_csr_pem;
+    Async::EncryptedUdpSocket*  m_udp_sock              = nullptr;
+    std::vector<uint8_t>        m_udp_cipher_iv_rand;
+    UdpCipher::IVCntr           m_udp_cipher_iv_cntr    = 1;
+    std::vector<uint8_t>        m_udp_iv_buf;
+    std::vector<uint8_t>        m_udp_tx_buf;
+    UdpCipher::AAD              m_aad;
+    UdpCipher::IVCntr           m_next_udp_rx_seq       = 0;
+    ReflectorUdpMsg::ClientId   m_client_id             = 0;
+    unsigned                    m_udp_heartbeat_tx_cnt  = 0;
+    unsigned                    m_udp_heartbeat_rx_cnt  = 0;
+    unsigned                    m_tcp_heartbeat_tx_cnt  = 0;
+    unsigned                    m_tcp_heartbeat_rx_cnt  = 0;
+    unsigned                    m_login_time_left       = 0;
+
+    LoadGenNode(const LoadGenNode&);
+    LoadGenNode& operator=(const LoadGenNode&);
+    bool createCsr(void);
+    void onConnected(void);
+    void onDisconnected(Async::FramedTcpConnection* con,
+                        Async::FramedTcpConnection::DisconnectReason reason);
+    int onVerifyPeer(Async::TcpConnection* con, int preverify_ok,
+                     X509_STORE_CTX* store_ctx);
+    void onSslConnectionReady(Async::TcpConnection* con);
+    void onFrameReceived(Async::FramedTcpConnection* con,
+                         const uint8_t* data, size_t len);
+    void handleMsgError(std::istream& is);
+    void handleMsgCAInfo(std::istream& is);
+    void handleMsgStartEncryption(void);
+    void handleMsgClientCsrRequest(void);
+    void handleMsgClientCert(void);
+    void handleMsgAuthChallenge(std::istream& is);
+    void handleMsgAuthOk(void);
+    void handleMsgServerInfo(std::istream& is);
+    void handleMsgStartUdpEncryption(void);
+    bool udpCipherDataReceived(const Async::IpAddress& addr, uint16_t port,
+                               void* buf, int count);
+    void udpDatagramReceived(const Async::IpAddress& addr, uint16_t port,
+                             void* aad, void* buf, int count);
+    void sendMsg(const ReflectorMsg& msg);
+    void sendUdpMsg(const UdpCipher::AAD& aad, const ReflectorUdpMsg& msg);
+    void sendUdpMsg(const ReflectorUdpMsg& msg);
+    void fail(const std::string& reason);
+
+};  /* class LoadGenNode */
+
+
+//} /* namespace */
+
+#endif /* LOAD_GEN_NODE_INCLUDED */
+
+
+
+/*
+ * This file has not been truncated
+ */
@@ -36,8 +36,11 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 #include <fstream>
 #include <iterator>
 #include <regex>
-#include <dirent.h>   // for listing directories (list certs)
-#include <sys/stat.h> // for checking if a directory exists (list certs)
+#include <memory>
+#include <sstream>
+#include <strings.h>
+#include <chrono>
+#include <sys/stat.h>
 
 
 /****************************************************************************
@@ -53,9 +56,12 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 #include <AsyncEncryptedUdpSocket.h>
 #include <AsyncApplication.h>
 #include <AsyncPty.h>
+#include <AsyncWorkerPool.h>
+#include <AsyncAudioStats.h>
 
 #include <common.h>
 #include <config.h>
+#include <Metrics.h>
 
 
 /****************************************************************************
@@ -67,6 +73,11 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 #include "Reflector.h"
 #include "ReflectorClient.h"
 #include "TGHandler.h"
+#include "TGMixer.h"
+#include "TGTranscoder.h"
+#include "ReflectorTrunk.h"
+#include "UdpFanoutEncryptor.h"
+#include "ReflectorUserDb.h"
 
 
 /****************************************************************************
@@ -174,6 +185,40 @@ namespace {
     timer.setExpireOffset(10000);
     timer.start();
   } /* startCertRenewTimer */
+
+
+  std::string jsonString(const Json::Value& value)
+  {
+    std::ostringstream os;
+    Json::StreamWriterBuilder builder;
+    builder["commentStyle"] = "None";
+    builder["indentation"] = ""; //The JSON document is written on a single line
+    std::unique_ptr<Json::StreamWriter> writer(builder.newStreamWriter());
+    writer->write(value, &os);
+    return os.str();
+  } /* jsonString */
+
+
+  const std::string* findHttpHeader(
+      const Async::HttpServerConnection::Headers& headers, const char* name)
+  {
+      // HTTP header names are case insensitive
+    for (const auto& header : headers)
+    {
+      if (strcasecmp(header.first.c_str(), name) == 0)
+      {
+        return &header.second;
+      }
+    }
+    return nullptr;
+  } /* findHttpHeader */
+
+
+  std::string clientAudioMetricName(Async::AudioStats::Counter counter)
+  {
+    return std::string("svxreflector_client_audio_") +
+           Async::AudioStats::counterName(counter) + "_total";
+  } /* clientAudioMetricName */
 };
 
 
@@ -198,6 +243,10 @@ namespace {
   //    ProtoVer(2, 0), ProtoVer(2, 999));
   ReflectorClient::ProtoVerLargerOrEqualFilter ge_v2_client_filter(
       ProtoVer(2, 0));
+  ReflectorClient::ProtoVerLargerOrEqualFilter audio_trace_client_filter(
+      ProtoVer(3, 3));
+  ReflectorClient::ProtoVerRangeFilter node_joined_left_client_filter(
+      ProtoVer(0, 0), ProtoVer(3, 3));
 };
 
 
@@ -232,10 +281,23 @@ Reflector::Reflector(void)
   : m_srv(0), m_udp_sock(0), m_tg_for_v1_clients(1), m_random_qsy_lo(0),
     m_random_qsy_hi(0), m_random_qsy_tg(0), m_http_server(0), m_cmd_pty(0),
     m_keys_dir("private/"), m_pending_csrs_dir("pending_csrs/"),
-    m_csrs_dir("csrs/"), m_certs_dir("certs/"), m_pki_dir("pki/")
+    m_csrs_dir("csrs/"), m_certs_dir("certs/"), m_pki_dir("pki/"),
+    m_tg_audio_stats_timer(1000, Async::Timer::TYPE_PERIODIC)
 {
+  m_tg_audio_stats_timer.expired.connect(sigc::hide(
+      mem_fun(*this, &Reflector::updateTgAudioStats)));
+  m_tg_audio_stats_timer.expired.connect(sigc::hide(
+      mem_fun(*this, &Reflector::cleanupTgMixers)));
+  m_tg_audio_stats_timer.expired.connect(sigc::hide(
+      mem_fun(*this, &Reflector::cleanupTgTranscoders)));
+  m_tg_audio_stats_timer.expired.connect(sigc::hide(
+      mem_fun(*this, &Reflector::updateTrunkSubscriptions)));
+  m_tg_audio_stats_timer.expired.connect(sigc::hide(
+      mem_fun(*this, &Reflector::updateUdpKernelDrops)));
   TGHandler::instance()->talkerUpdated.connect(
       mem_fun(*this, &Reflector::onTalkerUpdated));
+  TGHandler::instance()->trunkTalkerUpdated.connect(
+      mem_fun(*this, &Reflector::onTrunkTalkerUpdated));
   TGHandler::instance()->requestAutoQsy.connect(
       mem_fun(*this, &Reflector::onRequestAutoQsy));
   m_renew_cert_timer.expired.connect(
@@ -264,12 +326,44 @@ Reflector::~Reflector(void)
 {
   delete m_http_server;
   m_http_server = 0;
-  delete m_udp_sock;
+  delete m_udp_fanout_encryptor;
+  m_udp_fanout_encryptor = nullptr;
+  for (auto& sock : m_udp_socks)
+  {
+    delete sock;
+  }
+  m_udp_socks.clear();
   m_udp_sock = 0;
   delete m_srv;
   m_srv = 0;
+  delete m_crypto_pool;
+  m_crypto_pool = nullptr;
   delete m_cmd_pty;
   m_cmd_pty = 0;
+  for (auto& trunk : m_trunks)
+  {
+    delete trunk;
+  }
+  m_trunks.clear();
+  for (auto& item : m_trunk_pending_cons)
+  {
+    item.second.disconnect();
+  }
+  m_trunk_pending_cons.clear();
+  delete m_trunk_srv;
+  m_trunk_srv = nullptr;
+  delete m_user_db;
+  m_user_db = nullptr;
+  for (auto& item : m_tg_mixers)
+  {
+    delete item.second;
+  }
+  m_tg_mixers.clear();
+  for (auto& item : m_tg_transcoders)
+  {
+    delete item.second;
+  }
+  m_tg_transcoders.clear();
   m_client_con_map.clear();
   ReflectorClient::cleanup();
   delete TGHandler::instance();
@@ -281,10 +375,17 @@ bool Reflector::initialize(Async::Config &cfg)
   m_cfg = &cfg;
   TGHandler::instance()->setConfig(m_cfg);
 
+  initMetrics();
+
   std::string listen_port("5300");
   cfg.getValue("GLOBAL", "LISTEN_PORT", listen_port);
   m_srv = new TcpServer<FramedTcpConnection>(listen_port);
   m_srv->setConnectionThrottling(10, 0.1, 1000);
+  unsigned accept_rate = 50;
+  cfg.getValue("GLOBAL", "ACCEPT_RATE", accept_rate);
+  unsigned accept_burst = 100;
+  cfg.getValue("GLOBAL", "ACCEPT_BURST", accept_burst);
+  m_srv->setAdmissionRate(accept_burst, accept_rate);
   m_srv->clientConnected.connect(
       mem_fun(*this, &Reflector::clientConnected));
   m_srv->clientDisconnected.connect(
@@ -295,26 +396,104 @@ bool Reflector::initialize(Async::Config &cfg)
     return false;
   }
 
+    // Let reconnecting clients resume their TLS session and skip the
+    // certificate chain verification for recently verified certificates
+  unsigned tls_session_timeout = 0;
+  cfg.getValue("GLOBAL", "TLS_SESSION_TIMEOUT", tls_session_timeout);
+  if (tls_session_timeout > 0)
+  {
+    m_ssl_ctx.enableServerSessionCache("SvxReflector", tls_session_timeout);
+    m_ssl_ctx.enableVerifiedPeerCache(tls_session_timeout,
+                                      VERIFIED_PEER_CACHE_SIZE);
+  }
+
   m_srv->setSslContext(m_ssl_ctx);
 
+  unsigned crypto_worker_threads = 1;
+  cfg.getValue("GLOBAL", "CRYPTO_WORKER_THREADS", crypto_worker_threads);
+  if (crypto_worker_threads > 0)
+  {
+    m_crypto_pool = new Async::WorkerPool(crypto_worker_threads);
+    if (!m_crypto_pool->initOk())
+    {
+      std::cerr << "*** ERROR: Could not start the crypto worker threads"
+                << std::endl;
+      return false;
+    }
+    m_srv->setSslWorkerPool(m_crypto_pool);
+  }
+
   uint16_t udp_listen_port = 5300;
   cfg.getValue("GLOBAL", "LISTEN_PORT", udp_listen_port);
-  m_udp_sock = new Async::EncryptedUdpSocket(udp_listen_port);
-  const char* err = "unknown reason";
-  if ((err="bad allocation",          (m_udp_sock == 0)) ||
-      (err="initialization failure",  !m_udp_sock->initOk()) ||
-      (err="unsupported cipher",      !m_udp_sock->setCipher(UdpCipher::NAME)))
-  {
-    std::cerr << "*** ERROR: Could not initialize UDP socket due to "
-              << err << std::endl;
+  unsigned udp_sockets = 1;
+  cfg.getValue("GLOBAL", "UDP_SOCKETS", udp_sockets);
+  if ((udp_sockets < 1) || (udp_sockets > UDP_SOCKETS_MAX))
+  {
+    std::cerr << "*** ERROR: GLOBAL/UDP_SOCKETS must be in the range 1 to "
+              << UDP_SOCKETS_MAX << std::endl;
     return false;
   }
-  m_udp_sock->setCipherAADLength(UdpCipher::AADLEN);
-  m_udp_sock->setTagLength(UdpCipher::TAGLEN);
-  m_udp_sock->cipherDataReceived.connect(
-      mem_fun(*this, &Reflector::udpCipherDataReceived));
-  m_udp_sock->dataReceived.connect(
-      mem_fun(*this, &Reflector::udpDatagramReceived));
+  int udp_rcvbuf = 0;
+  cfg.getValue("GLOBAL", "UDP_RCVBUF", udp_rcvbuf);
+  int udp_sndbuf = 0;
+  cfg.getValue("GLOBAL", "UDP_SNDBUF", udp_sndbuf);
+
+    // With more than one socket, all sockets are bound to the same port
+    // using SO_REUSEPORT. The kernel then spread the incoming datagrams over
+    // the receive queues of the sockets using a hash of the source address
+    // so all datagrams from a client end up in the same socket. All sockets
+    // are handled by the main thread and the first one is used for sending.
+  for (unsigned i=0; i<udp_sockets; ++i)
+  {
+    auto sock = new Async::EncryptedUdpSocket(udp_listen_port,
+        Async::IpAddress(), udp_sockets > 1);
+    const char* err = "unknown reason";
+    if ((err="bad allocation",          (sock == 0)) ||
+        (err="initialization failure",  !sock->initOk()) ||
+        (err="unsupported cipher",      !sock->setCipher(UdpCipher::NAME)) ||
+        (err="could not set UDP_RCVBUF",
+         (udp_rcvbuf > 0) && !sock->setRxBufferSize(udp_rcvbuf)) ||
+        (err="could not set UDP_SNDBUF",
+         (udp_sndbuf > 0) && !sock->setTxBufferSize(udp_sndbuf)))
+    {
+      std::cerr << "*** ERROR: Could not initialize UDP socket due to "
+                << err << std::endl;
+      delete sock;
+      return false;
+    }
+    m_udp_socks.push_back(sock);
+    sock->setCipherAADLength(UdpCipher::AADLEN);
+    sock->setTagLength(UdpCipher::TAGLEN);
+    sock->setRxBatchSize(UDP_RX_BATCH_SIZE);
+    sock->setContextCacheSize(UDP_CIPHER_CACHE_SIZE);
+    sock->cipherDataReceived.connect(sigc::bind(
+        mem_fun(*this, &Reflector::udpCipherDataReceived), sock));
+    sock->dataReceived.connect(sigc::bind(
+        mem_fun(*this, &Reflector::udpDatagramReceived), sock));
+  }
+  m_udp_sock = m_udp_socks.front();
+  m_udp_kernel_drops.assign(m_udp_socks.size(), 0);
+  if ((udp_sockets > 1) || (udp_rcvbuf > 0) || (udp_sndbuf > 0))
+  {
+    std::cout << "UDP sockets: " << udp_sockets
+              << " (rcvbuf=" << m_udp_sock->rxBufferSize()
+              << " sndbuf=" << m_udp_sock->txBufferSize() << ")" << std::endl;
+  }
+  m_udp_sock->sendBufferFull.connect(
+      mem_fun(*this, &Reflector::udpSendBufferFull));
+
+  unsigned udp_crypto_threads = 0;
+  cfg.getValue("GLOBAL", "UDP_CRYPTO_THREADS", udp_crypto_threads);
+  if (udp_crypto_threads > 0)
+  {
+    m_udp_fanout_encryptor = new UdpFanoutEncryptor(udp_crypto_threads);
+    if (!m_udp_fanout_encryptor->initOk())
+    {
+      std::cerr << "*** ERROR: Could not start the UDP encryption worker "
+                   "threads" << std::endl;
+      return false;
+    }
+  }
 
   unsigned sql_timeout = 0;
   cfg.getValue("GLOBAL", "SQL_TIMEOUT", sql_timeout);
@@ -340,6 +519,13 @@ bool Reflector::initialize(Async::Config &cfg)
     m_random_qsy_tg = m_random_qsy_hi;
   }
 
+  unsigned loop_watchdog_threshold = 0;
+  if (m_cfg->getValue("GLOBAL", "LOOP_WATCHDOG_THRESHOLD",
+                      loop_watchdog_threshold))
+  {
+    Async::Application::app().setLoopWatchdog(loop_watchdog_threshold);
+  }
+
   std::string http_srv_port;
   if (m_cfg->getValue("GLOBAL", "HTTP_SRV_PORT", http_srv_port))
   {
@@ -370,6 +556,22 @@ bool Reflector::initialize(Async::Config &cfg)
 
   m_cfg->getValue("GLOBAL", "ACCEPT_CERT_EMAIL", m_accept_cert_email);
 
+  if (!compileCallsignPatterns())
+  {
+    return false;
+  }
+
+  m_user_db = new ReflectorUserDb(*m_cfg);
+  if (!m_user_db->initialize())
+  {
+    return false;
+  }
+
+  if (!initTrunks())
+  {
+    return false;
+  }
+
   m_cfg->valueUpdated.connect(sigc::mem_fun(*this, &Reflector::cfgUpdated));
 
   return true;
@@ -390,55 +592,209 @@ void Reflector::nodeList(std::vector<std::string>& nodes) const
 } /* Reflector::nodeList */
 
 
+void Reflector::nodeList(std::vector<std::string>& nodes,
+                         const std::set<uint32_t>& tgs) const
+{
+  nodes.clear();
+  for (const auto& tg : tgs)
+  {
+    for (const auto& client : TGHandler::instance()->clientsForTG(tg))
+    {
+      if (!client->callsign().empty())
+      {
+        nodes.push_back(client->callsign());
+      }
+    }
+  }
+} /* Reflector::nodeList */
+
+
+void Reflector::nodeJoined(ReflectorClient* client)
+{
+  typedef ReflectorClient::NodeListFilter NodeListFilter;
+  typedef MsgNodeListSubscribe Sub;
+
+  ++m_node_list_ver;
+  broadcastMsg(MsgNodeJoined(client->callsign()),
+      ReflectorClient::mkAndFilter(
+        node_joined_left_client_filter,
+        ReflectorClient::ExceptFilter(client)));
+
+  MsgNodeListDelta delta(m_node_list_ver);
+  delta.addJoined(client->callsign());
+  broadcastMsg(delta,
+      ReflectorClient::mkAndFilter(
+        NodeListFilter(Sub::SCOPE_ALL),
+        ReflectorClient::ExceptFilter(client)));
+  if (client->currentTG() != 0)
+  {
+    broadcastMsgToTg(client->currentTG(), delta,
+        ReflectorClient::mkAndFilter(
+          NodeListFilter(Sub::SCOPE_TGS),
+          ReflectorClient::ExceptFilter(client)),
+        true);
+  }
+} /* Reflector::nodeJoined */
+
+
+void Reflector::nodeTgChanged(ReflectorClient* client, uint32_t old_tg,
+                              uint32_t new_tg)
+{
+  typedef ReflectorClient::NodeListFilter NodeListFilter;
+  typedef MsgNodeListSubscribe Sub;
+
+  if (client->callsign().empty())
+  {
+    return;
+  }
+
+    // Subscribers that only follow their own talk groups see the node leave
+    // the old TG and join the new one, unless they follow both
+  ++m_node_list_ver;
+  if (old_tg != 0)
+  {
+    MsgNodeListDelta delta(m_node_list_ver);
+    delta.addLeft(client->callsign());
+    broadcastMsgToTg(old_tg, delta,
+        ReflectorClient::mkAndFilter(
+          NodeListFilter(Sub::SCOPE_TGS, new_tg),
+          ReflectorClient::ExceptFilter(client)),
+        true);
+  }
+  if (new_tg != 0)
+  {
+    MsgNodeListDelta delta(m_node_list_ver);
+    delta.addJoined(client->callsign());
+    broadcastMsgToTg(new_tg, delta,
+        ReflectorClient::mkAndFilter(
+          NodeListFilter(Sub::SCOPE_TGS, old_tg),
+          ReflectorClient::ExceptFilter(client)),
+        true);
+  }
+} /* Reflector::nodeTgChanged */
+
+
 void Reflector::broadcastMsg(const ReflectorMsg& msg,
                              const ReflectorClient::Filter& filter)
 {
+    // The message is packed once, when the first recipient is found, and the
+    // same buffer is then queued on all client connections
+  Async::TcpConnection::SharedBuffer buf;
   for (const auto& item : m_client_con_map)
   {
     ReflectorClient *client = item.second;
     if (filter(client) &&
         (client->conState() == ReflectorClient::STATE_CONNECTED))
     {
-      client->sendMsg(msg);
+      if (buf == nullptr)
+      {
+        buf = ReflectorClient::packMsg(msg);
+      }
+      client->sendPackedMsg(msg.type(), buf);
     }
   }
 } /* Reflector::broadcastMsg */
 
 
+void Reflector::broadcastMsgToTg(uint32_t tg, const ReflectorMsg& msg,
+                                 const ReflectorClient::Filter& filter,
+                                 bool include_monitors)
+{
+    // Take a snapshot of the recipients since a failing send will disconnect
+    // the client which in turn will modify the talk group client sets.
+  const TGHandler::ClientSet& clients = TGHandler::instance()->clientsForTG(tg);
+  std::vector<ReflectorClient*> recipients(clients.begin(), clients.end());
+  if (include_monitors)
+  {
+    for (const auto& client : TGHandler::instance()->monitorsForTG(tg))
+    {
+      if (clients.count(client) == 0)
+      {
+        recipients.push_back(client);
+      }
+    }
+  }
+
+  Async::TcpConnection::SharedBuffer buf;
+  for (const auto& client : recipients)
+  {
+    TGHandler* tg_handler = TGHandler::instance();
+    if ((tg_handler->clientsForTG(tg).count(client) == 0) &&
+        (!include_monitors ||
+         (tg_handler->monitorsForTG(tg).count(client) == 0)))
+    {
+      continue;
+    }
+    if (filter(client) &&
+        (client->conState() == ReflectorClient::STATE_CONNECTED))
+    {
+      if (buf == nullptr)
+      {
+        buf = ReflectorClient::packMsg(msg);
+      }
+      client->sendPackedMsg(msg.type(), buf);
+    }
+  }
+} /* Reflector::broadcastMsgToTg */
+
+
 bool Reflector::sendUdpDatagram(ReflectorClient *client,
     const ReflectorUdpMsg& msg)
 {
+  return sendUdpDatagram(client, ReflectorPackedUdpMsg(msg));
+} /* Reflector::sendUdpDatagram */
+
+
+bool Reflector::sendUdpDatagram(ReflectorClient *client,
+    const ReflectorPackedUdpMsg& msg)
+{
+  if (!msg.isValid())
+  {
+    std::cout << "*** WARNING: Packing UDP message of type " << msg.type()
+              << " failed" << std::endl;
+    return false;
+  }
+
   auto udp_addr = client->remoteUdpHost();
   auto udp_port = client->remoteUdpPort();
   if (client->protoVer() >= ProtoVer(3, 0))
   {
-    ReflectorUdpMsg header(msg.type());
-    ostringstream ss;
-    assert(header.pack(ss) && msg.pack(ss));
-
-    m_udp_sock->setCipherIV(client->udpCipherIV());
+    client->udpCipherIV(m_udp_iv_buf);
+    m_udp_sock->setCipher(client->udpCipher());
+    m_udp_sock->setCipherIV(m_udp_iv_buf);
     m_udp_sock->setCipherKey(client->udpCipherKey());
     UdpCipher::AAD aad{client->udpCipherIVCntrNext()};
-    std::stringstream aadss;
-    if (!aad.pack(aadss))
+    uint8_t aadbuf[UdpCipher::AADLEN];
+    Async::MsgBufWriter aadw(aadbuf, sizeof(aadbuf));
+    if (!aad.pack(aadw))
     {
       std::cout << "*** WARNING: Packing associated data failed for UDP "
                    "datagram to " << udp_addr << ":" << udp_port << std::endl;
       return false;
     }
+    m_metric_udp_tx_datagrams->inc();
+    m_metric_udp_tx_bytes->inc(msg.datagramSize());
     return m_udp_sock->write(udp_addr, udp_port,
-                             aadss.str().data(), aadss.str().size(),
-                             ss.str().data(), ss.str().size());
+                             aadbuf, aadw.size(),
+                             msg.datagramData(), msg.datagramSize());
   }
   else
   {
     ReflectorUdpMsgV2 header(msg.type(), client->clientId(),
         client->udpCipherIVCntrNext() & 0xffff);
-    ostringstream ss;
-    assert(header.pack(ss) && msg.pack(ss));
+    m_udp_tx_buf.resize(header.packedSize() + msg.bodySize());
+    Async::MsgBufWriter w(m_udp_tx_buf.data(), m_udp_tx_buf.size());
+    if (!header.pack(w))
+    {
+      std::cout << "*** WARNING: Packing UDP header failed for datagram to "
+                << udp_addr << ":" << udp_port << std::endl;
+      return false;
+    }
+    w.write(reinterpret_cast<const char*>(msg.bodyData()), msg.bodySize());
+    m_metric_udp_tx_datagrams->inc();
+    m_metric_udp_tx_bytes->inc(w.size());
     return m_udp_sock->UdpSocket::write(
-        udp_addr, udp_port,
-        ss.str().data(), ss.str().size());
+        udp_addr, udp_port, m_udp_tx_buf.data(), w.size());
   }
 } /* Reflector::sendUdpDatagram */
 
@@ -446,18 +802,116 @@ bool Reflector::sendUdpDatagram(ReflectorClient *client,
 void Reflector::broadcastUdpMsg(const ReflectorUdpMsg& msg,
                                 const ReflectorClient::Filter& filter)
 {
+  const ReflectorPackedUdpMsg packed_msg(msg);
+  m_udp_sock->beginBatch();
   for (const auto& item : m_client_con_map)
   {
     ReflectorClient *client = item.second;
     if (filter(client) &&
-        (client->conState() == ReflectorClient::STATE_CONNECTED))
+        (client->conState() == ReflectorClient::STATE_CONNECTED) &&
+        udpTxAllowed(client))
     {
-      client->sendUdpMsg(msg);
+      client->sendUdpMsg(packed_msg);
     }
   }
+  m_udp_sock->flushBatch();
 } /* Reflector::broadcastUdpMsg */
 
 
+void Reflector::broadcastUdpMsgToTg(uint32_t tg, const ReflectorUdpMsg& msg,
+                                    const ReflectorClient::Filter& filter)
+{
+  broadcastUdpMsgToTg(tg, ReflectorPackedUdpMsg(msg), filter);
+} /* Reflector::broadcastUdpMsgToTg */
+
+
+void Reflector::broadcastUdpMsgToTg(uint32_t tg,
+                                    const ReflectorPackedUdpMsg& packed_msg,
+                                    const ReflectorClient::Filter& filter)
+{
+    // Sending UDP never disconnects a client so it is safe to iterate the
+    // subscriber set directly. The datagrams are queued and then handed
+    // to the kernel in as few system calls as possible. The message is only
+    // serialized once, leaving just the per client encryption in the loop.
+  typedef std::chrono::steady_clock Clock;
+  const Clock::time_point fanout_start = Clock::now();
+  const auto& clients = TGHandler::instance()->clientsForTG(tg);
+  m_udp_sock->beginBatch();
+  if ((m_udp_fanout_encryptor == nullptr) ||
+      (clients.size() < UDP_FANOUT_MIN_CLIENTS) || !packed_msg.isValid())
+  {
+    for (const auto& client : clients)
+    {
+      if (filter(client) &&
+          (client->conState() == ReflectorClient::STATE_CONNECTED) &&
+          udpTxAllowed(client))
+      {
+        client->sendUdpMsg(packed_msg);
+      }
+    }
+    m_udp_sock->flushBatch();
+    m_metric_fanout_time->observe(
+        std::chrono::duration<double>(Clock::now() - fanout_start).count());
+    return;
+  }
+
+    // For large talk groups the encryption is spread over the worker
+    // threads. The IV counters are handed out here, in the main thread, so
+    // the datagrams get the same sequence as when sending them one by one.
+  size_t job_cnt = 0;
+  for (const auto& client : clients)
+  {
+    if (!filter(client) ||
+        (client->conState() != ReflectorClient::STATE_CONNECTED) ||
+        (client->remoteUdpPort() == 0) || !udpTxAllowed(client))
+    {
+      continue;
+    }
+    if (client->protoVer() < ProtoVer(3, 0))
+    {
+      client->sendUdpMsg(packed_msg);
+      continue;
+    }
+    UdpFanoutEncryptor::Job& job = m_udp_fanout_encryptor->job(job_cnt);
+    job.addr = client->remoteUdpHost();
+    job.port = client->remoteUdpPort();
+    job.cipher = client->udpCipher();
+    job.key = client->udpCipherKey();
+    client->udpCipherIV(job.iv);
+    UdpCipher::AAD aad{client->udpCipherIVCntrNext()};
+    Async::MsgBufWriter aadw(job.aad, sizeof(job.aad));
+    if (!aad.pack(aadw))
+    {
+      std::cout << "*** WARNING: Packing associated data failed for UDP "
+                   "datagram to " << job.addr << ":" << job.port << std::endl;
+      continue;
+    }
+    client->udpMsgSent();
+    ++job_cnt;
+  }
+
+  const Clock::time_point encrypt_start = Clock::now();
+  m_udp_fanout_encryptor->run(packed_msg.datagramData(),
+                              packed_msg.datagramSize(), job_cnt);
+  m_metric_encrypt_time->observe(
+      std::chrono::duration<double>(Clock::now() - encrypt_start).count());
+  for (size_t i=0; i<job_cnt; ++i)
+  {
+    const UdpFanoutEncryptor::Job& job = m_udp_fanout_encryptor->job(i);
+    if (job.ok)
+    {
+      m_udp_sock->UdpSocket::write(job.addr, job.port, job.out.data(),
+                                   job.outlen);
+      m_metric_udp_tx_datagrams->inc();
+      m_metric_udp_tx_bytes->inc(packed_msg.datagramSize());
+    }
+  }
+  m_udp_sock->flushBatch();
+  m_metric_fanout_time->observe(
+      std::chrono::duration<double>(Clock::now() - fanout_start).count());
+} /* Reflector::broadcastUdpMsgToTg */
+
+
 void Reflector::requestQsy(ReflectorClient *client, uint32_t tg)
 {
   uint32_t current_tg = TGHandler::instance()->TGForClient(client);
@@ -477,18 +931,19 @@ void Reflector::requestQsy(ReflectorClient *client, uint32_t tg)
   cout << client->callsign() << ": Requesting QSY from TG #"
        << current_tg << " to TG #" << tg << endl;
 
-  broadcastMsg(MsgRequestQsy(tg),
-      ReflectorClient::mkAndFilter(
-        ge_v2_client_filter,
-        ReflectorClient::TgFilter(current_tg)));
+  broadcastMsgToTg(current_tg, MsgRequestQsy(tg), ge_v2_client_filter);
 } /* Reflector::requestQsy */
 
 
 Async::SslCertSigningReq
 Reflector::loadClientPendingCsr(const std::string& callsign)
 {
-  Async::SslCertSigningReq csr;
-  (void)csr.readPemFile(m_pending_csrs_dir + "/" + callsign + ".csr");
+  CertStore::CsrEntry* entry = m_cert_store.findPendingCsr(callsign);
+  if (entry == nullptr)
+  {
+    return Async::SslCertSigningReq(nullptr);
+  }
+  Async::SslCertSigningReq csr(entry->csr);
   return csr;
 } /* Reflector::loadClientPendingCsr */
 
@@ -502,11 +957,13 @@ Reflector::loadClientCsr(const std::string& callsign)
 } /* Reflector::loadClientPendingCsr */
 
 
-bool Reflector::renewedClientCert(Async::SslX509& cert)
+void Reflector::renewedClientCert(Async::SslX509&& cert,
+                                  const CertSignedSlot& done)
 {
   if (cert.isNull())
   {
-    return false;
+    done(cert);
+    return;
   }
 
   std::string callsign(cert.commonName());
@@ -515,45 +972,76 @@ bool Reflector::renewedClientCert(Async::SslX509& cert)
       ((new_cert.publicKey() != cert.publicKey()) ||
        (timeToRenewCert(new_cert) <= std::time(NULL))))
   {
-    return signClientCert(cert, "CRT_RENEWED");
+    signClientCert(std::move(cert), "CRT_RENEWED", done);
+    return;
   }
-  cert = std::move(new_cert);
-  return !cert.isNull();
+  done(new_cert);
 } /* Reflector::renewedClientCert */
 
 
-bool Reflector::signClientCert(Async::SslX509& cert, const std::string& ca_op)
+void Reflector::signClientCert(Async::SslX509&& cert, const std::string& ca_op,
+                               const CertSignedSlot& done)
 {
   //std::cout << "### Reflector::signClientCert" << std::endl;
 
-  cert.setSerialNumber();
-  cert.setIssuerName(m_issue_ca_cert.subjectName());
-  cert.setValidityTime(CERT_VALIDITY_DAYS, CERT_VALIDITY_OFFSET_DAYS);
-  auto cn = cert.commonName();
-  if (!cert.sign(m_issue_ca_pkey))
-  {
-    std::cerr << "*** ERROR: Certificate signing failed for client "
-              << cn << std::endl;
-    return false;
-  }
-  auto crtfile = m_certs_dir + "/" + cn + ".crt";
-  if (cert.writePemFile(crtfile) && m_issue_ca_cert.appendPemFile(crtfile))
+  auto pcert = std::make_shared<Async::SslX509>(std::move(cert));
+  pcert->setSerialNumber();
+  pcert->setIssuerName(m_issue_ca_cert.subjectName());
+  pcert->setValidityTime(CERT_VALIDITY_DAYS, CERT_VALIDITY_OFFSET_DAYS);
+  auto pkey = std::make_shared<Async::SslKeypair>(m_issue_ca_pkey);
+  auto sign_ok = std::make_shared<bool>(false);
+
+    // The signing is the only expensive part so only that is done in the
+    // worker thread. The key is copied so that a renewal of the issuing CA
+    // cannot pull it away from under the worker.
+  Async::WorkerPool::Work work = [pcert, pkey, sign_ok](void)
+    {
+      *sign_ok = pcert->sign(*pkey);
+    };
+  Async::WorkerPool::Done finished = [this, pcert, ca_op, sign_ok, done](void)
+    {
+      auto cn = pcert->commonName();
+      if (!*sign_ok)
+      {
+        std::cerr << "*** ERROR: Certificate signing failed for client "
+                  << cn << std::endl;
+        pcert->set(nullptr);
+        done(*pcert);
+        return;
+      }
+      auto crtfile = m_certs_dir + "/" + cn + ".crt";
+      const bool write_ok = pcert->writePemFile(crtfile) &&
+                            m_issue_ca_cert.appendPemFile(crtfile);
+      m_cert_store.refreshCert(cn);
+      if (write_ok)
+      {
+        runCAHook({
+            { "CA_OP",      ca_op },
+            { "CA_CRT_PEM", pcert->pem() }
+          });
+      }
+      else
+      {
+        std::cerr << "*** WARNING: Failed to write client certificate file '"
+                  << crtfile << "'" << std::endl;
+      }
+      done(*pcert);
+    };
+
+  if (m_crypto_pool != nullptr)
   {
-    runCAHook({
-        { "CA_OP",      ca_op },
-        { "CA_CRT_PEM", cert.pem() }
-      });
+    m_crypto_pool->run(std::move(work), std::move(finished));
   }
   else
   {
-    std::cerr << "*** WARNING: Failed to write client certificate file '"
-              << crtfile << "'" << std::endl;
+    work();
+    finished();
   }
-  return true;
 } /* Reflector::signClientCert */
 
 
-Async::SslX509 Reflector::signClientCsr(const std::string& cn)
+void Reflector::signClientCsr(const std::string& cn,
+                              const CertSignedSlot& done)
 {
   //std::cout << "### Reflector::signClientCsr" << std::endl;
 
@@ -562,9 +1050,10 @@ Async::SslX509 Reflector::signClientCsr(const std::string& cn)
   auto req = loadClientPendingCsr(cn);
   if (req.isNull())
   {
-    std::cerr << "*** ERROR: Cannot find CSR to sign '" << req.filePath()
-              << "'" << std::endl;
-    return cert;
+    std::cerr << "*** ERROR: Cannot find CSR to sign '"
+              << m_pending_csrs_dir << "/" << cn << ".csr'" << std::endl;
+    done(cert);
+    return;
   }
 
   cert.clear();
@@ -582,41 +1071,42 @@ Async::SslX509 Reflector::signClientCsr(const std::string& cn)
   Async::SslKeypair csr_pkey(req.publicKey());
   cert.setPublicKey(csr_pkey);
 
-  if (!signClientCert(cert, "CSR_SIGNED"))
-  {
-    cert.set(nullptr);
-  }
-
-  std::string csr_path = m_csrs_dir + "/" + cn + ".csr";
-  if (rename(req.filePath().c_str(), csr_path.c_str()) != 0)
-  {
-    auto errstr = SvxLink::strError(errno);
-    std::cerr << "*** WARNING: Failed to move signed CSR from '"
-              << req.filePath() << "' to '" << csr_path << "': "
-              << errstr << std::endl;
-  }
+  const std::string req_path(req.filePath());
+  signClientCert(std::move(cert), "CSR_SIGNED",
+      [this, cn, req_path, done](Async::SslX509& cert)
+      {
+        std::string csr_path = m_csrs_dir + "/" + cn + ".csr";
+        if (rename(req_path.c_str(), csr_path.c_str()) != 0)
+        {
+          auto errstr = SvxLink::strError(errno);
+          std::cerr << "*** WARNING: Failed to move signed CSR from '"
+                    << req_path << "' to '" << csr_path << "': "
+                    << errstr << std::endl;
+        }
+        m_cert_store.refreshPendingCsr(cn);
 
-  auto client = ReflectorClient::lookup(cn);
-  if ((client != nullptr) && !cert.isNull())
-  {
-    client->certificateUpdated(cert);
-  }
+        auto client = ReflectorClient::lookup(cn);
+        if ((client != nullptr) && !cert.isNull())
+        {
+          client->certificateUpdated(cert);
+        }
 
-  return cert;
+        done(cert);
+      });
 } /* Reflector::signClientCsr */
 
 
 Async::SslX509 Reflector::loadClientCertificate(const std::string& callsign)
 {
-  Async::SslX509 cert;
-  if (!cert.readPemFile(m_certs_dir + "/" + callsign + ".crt") ||
-      cert.isNull() ||
-      //!cert.verify(m_issue_ca_pkey) ||
-      !cert.timeIsWithinRange())
+  const CertStore::CertEntry* entry = m_cert_store.findCert(callsign);
+  if ((entry == nullptr) ||
+      //!entry->cert.verify(m_issue_ca_pkey) ||
+      !entry->cert.timeIsWithinRange())
   {
     return nullptr;
   }
-  return cert;
+  const X509* cert = entry->cert;
+  return Async::SslX509(X509_dup(const_cast<X509*>(cert)));
 } /* Reflector::loadClientCertificate */
 
 
@@ -662,15 +1152,7 @@ bool Reflector::callsignOk(const std::string& callsign, bool verbose) const
   }
 
     // Accept check
-  std::string accept_cs_re_str;
-  if (!m_cfg->getValue("GLOBAL", "ACCEPT_CALLSIGN", accept_cs_re_str) ||
-      accept_cs_re_str.empty())
-  {
-    accept_cs_re_str =
-      "[A-Z0-9][A-Z]{0,2}\\d[A-Z0-9]{0,3}[A-Z](?:-[A-Z0-9]{1,3})?";
-  }
-  const std::regex accept_callsign_re(accept_cs_re_str);
-  if (!std::regex_match(callsign, accept_callsign_re))
+  if (!std::regex_match(callsign, m_accept_cs_re))
   {
     if (verbose)
     {
@@ -682,12 +1164,9 @@ bool Reflector::callsignOk(const std::string& callsign, bool verbose) const
   }
 
     // Reject check
-  std::string reject_cs_re_str;
-  m_cfg->getValue("GLOBAL", "REJECT_CALLSIGN", reject_cs_re_str);
-  if (!reject_cs_re_str.empty())
+  if (m_reject_cs_re_set)
   {
-    const std::regex reject_callsign_re(reject_cs_re_str);
-    if (std::regex_match(callsign, reject_callsign_re))
+    if (std::regex_match(callsign, m_reject_cs_re))
     {
       if (verbose)
       {
@@ -800,19 +1279,21 @@ Async::SslX509 Reflector::csrReceived(Async::SslCertSigningReq& req)
 
   const std::string pending_csr_path(
       m_pending_csrs_dir + "/" + callsign + ".csr");
-  Async::SslCertSigningReq pending_csr;
+  Async::SslCertSigningReq pending_csr = loadClientPendingCsr(callsign);
   if ((
         csr.isNull() ||
         (req.digest() != csr.digest()) ||
         cert.isNull()
       ) && (
-        !pending_csr.readPemFile(pending_csr_path) ||
+        pending_csr.isNull() ||
         (req.digest() != pending_csr.digest())
       ))
   {
     std::cout << callsign << ": Add pending CSR '" << pending_csr_path
               << "' to CA" << std::endl;
-    if (req.writePemFile(pending_csr_path))
+    const bool write_ok = req.writePemFile(pending_csr_path);
+    m_cert_store.refreshPendingCsr(callsign);
+    if (write_ok)
     {
       const auto ca_op =
         pending_csr.isNull() ? "PENDING_CSR_CREATE" : "PENDING_CSR_UPDATE";
@@ -834,14 +1315,24 @@ Async::SslX509 Reflector::csrReceived(Async::SslCertSigningReq& req)
 
 Json::Value& Reflector::clientStatus(const std::string& callsign)
 {
-  if (!m_status.isMember(callsign))
+  Json::Value& nodes = m_status["nodes"];
+  if (!nodes.isMember(callsign))
   {
-    m_status["nodes"][callsign] = Json::Value(Json::objectValue);
+    nodes[callsign] = Json::Value(Json::objectValue);
+    clientStatusUpdated(callsign);
   }
-  return m_status["nodes"][callsign];
+  return nodes[callsign];
 } /* Reflector::clientStatus */
 
 
+void Reflector::clientStatusUpdated(const std::string& callsign)
+{
+  m_status_node_ver[callsign] = ++m_status_ver;
+  m_status_removed_ver.erase(callsign);
+  m_status_dirty = true;
+} /* Reflector::clientStatusUpdated */
+
+
 /****************************************************************************
  *
  * Protected member functions
@@ -873,7 +1364,18 @@ void Reflector::clientDisconnected(Async::FramedTcpConnection *con,
   assert(it != m_client_con_map.end());
   ReflectorClient *client = (*it).second;
 
+  for (auto& sock : m_udp_socks)
+  {
+    sock->forgetCipherKey(client->udpCipherKey());
+  }
   TGHandler::instance()->removeClient(client);
+  for (auto& item : m_tg_mixers)
+  {
+    if (item.second != nullptr)
+    {
+      item.second->removeClient(client);
+    }
+  }
 
   if (!client->callsign().empty())
   {
@@ -891,8 +1393,39 @@ void Reflector::clientDisconnected(Async::FramedTcpConnection *con,
   if (!client->callsign().empty())
   {
     m_status["nodes"].removeMember(client->callsign());
+    m_status_node_ver.erase(client->callsign());
+    m_status_removed_ver[client->callsign()] = ++m_status_ver;
+    m_status_dirty = true;
+    if (m_status_removed_ver.size() > STATUS_MAX_REMOVED_NODES)
+    {
+        // Forget the oldest removal. Deltas based on a version older than
+        // that removal cannot be produced anymore.
+      auto oldest = std::min_element(
+          m_status_removed_ver.begin(), m_status_removed_ver.end(),
+          [](const std::pair<const std::string, uint64_t>& a,
+             const std::pair<const std::string, uint64_t>& b)
+          {
+            return a.second < b.second;
+          });
+      m_status_removed_floor = oldest->second;
+      m_status_removed_ver.erase(oldest);
+    }
     broadcastMsg(MsgNodeLeft(client->callsign()),
-        ReflectorClient::ExceptFilter(client));
+        ReflectorClient::mkAndFilter(
+          node_joined_left_client_filter,
+          ReflectorClient::ExceptFilter(client)));
+
+    MsgNodeListDelta delta(++m_node_list_ver);
+    delta.addLeft(client->callsign());
+    broadcastMsg(delta, ReflectorClient::mkAndFilter(
+          ReflectorClient::NodeListFilter(MsgNodeListSubscribe::SCOPE_ALL),
+          ReflectorClient::ExceptFilter(client)));
+    if (client->currentTG() != 0)
+    {
+      broadcastMsgToTg(client->currentTG(), delta,
+          ReflectorClient::NodeListFilter(MsgNodeListSubscribe::SCOPE_TGS),
+          true);
+    }
   }
   //Application::app().runTask([=]{ delete client; });
   delete client;
@@ -900,7 +1433,8 @@ void Reflector::clientDisconnected(Async::FramedTcpConnection *con,
 
 
 bool Reflector::udpCipherDataReceived(const IpAddress& addr, uint16_t port,
-                                      void *buf, int count)
+                                      void *buf, int count,
+                                      Async::EncryptedUdpSocket* sock)
 {
   if ((count <= 0) || (static_cast<size_t>(count) < UdpCipher::AADLEN))
   {
@@ -909,9 +1443,11 @@ bool Reflector::udpCipherDataReceived(const IpAddress& addr, uint16_t port,
     return true;
   }
 
-  stringstream ss;
-  ss.write(reinterpret_cast<const char *>(buf), UdpCipher::AADLEN);
-  assert(m_aad.unpack(ss));
+  Async::MsgBufReader r(buf, count);
+  if (!m_aad.unpack(r))
+  {
+    return true;
+  }
 
   ReflectorClient* client = nullptr;
   if (m_aad.iv_cntr == 0)
@@ -925,11 +1461,7 @@ bool Reflector::udpCipherDataReceived(const IpAddress& addr, uint16_t port,
                    "Ignoring malformed UDP registration datagram" << std::endl;
       return true;
     }
-    ss.clear();
-    ss.write(reinterpret_cast<const char *>(buf)+UdpCipher::AADLEN,
-        sizeof(UdpCipher::ClientId));
-
-    Async::MsgPacker<UdpCipher::ClientId>::unpack(ss, iaad.client_id);
+    Async::MsgPacker<UdpCipher::ClientId>::unpack(r, iaad.client_id);
     //std::cout << "### Reflector::udpCipherDataReceived: client_id="
     //          << iaad.client_id << std::endl;
     auto client = ReflectorClient::lookup(iaad.client_id);
@@ -939,10 +1471,12 @@ bool Reflector::udpCipherDataReceived(const IpAddress& addr, uint16_t port,
                 << ") specified in initial AAD datagram" << std::endl;
       return true;
     }
-    m_udp_sock->setCipherIV(UdpCipher::IV{client->udpCipherIVRand(),
-                                          client->clientId(), 0});
-    m_udp_sock->setCipherKey(client->udpCipherKey());
-    m_udp_sock->setCipherAADLength(iaad.packedSize());
+    UdpCipher::IV{client->udpCipherIVRand(), client->clientId(), 0}
+      .assignTo(m_udp_iv_buf);
+    sock->setCipher(client->udpCipher());
+    sock->setCipherIV(m_udp_iv_buf);
+    sock->setCipherKey(client->udpCipherKey());
+    sock->setCipherAADLength(iaad.packedSize());
   }
   else if ((client=ReflectorClient::lookup(std::make_pair(addr, port))))
   {
@@ -961,14 +1495,16 @@ bool Reflector::udpCipherDataReceived(const IpAddress& addr, uint16_t port,
     //}
     //std::cout << "### Reflector::udpCipherDataReceived: m_aad.iv_cntr="
     //          << m_aad.iv_cntr << std::endl;
-    m_udp_sock->setCipherIV(UdpCipher::IV{client->udpCipherIVRand(),
-                                          client->clientId(), m_aad.iv_cntr});
-    m_udp_sock->setCipherKey(client->udpCipherKey());
-    m_udp_sock->setCipherAADLength(UdpCipher::AADLEN);
+    UdpCipher::IV{client->udpCipherIVRand(), client->clientId(),
+                  m_aad.iv_cntr}.assignTo(m_udp_iv_buf);
+    sock->setCipher(client->udpCipher());
+    sock->setCipherIV(m_udp_iv_buf);
+    sock->setCipherKey(client->udpCipherKey());
+    sock->setCipherAADLength(UdpCipher::AADLEN);
   }
   else
   {
-    udpDatagramReceived(addr, port, nullptr, buf, count);
+    udpDatagramReceived(addr, port, nullptr, buf, count, sock);
     return true;
   }
 
@@ -977,7 +1513,8 @@ bool Reflector::udpCipherDataReceived(const IpAddress& addr, uint16_t port,
 
 
 void Reflector::udpDatagramReceived(const IpAddress& addr, uint16_t port,
-                                    void* aadptr, void *buf, int count)
+                                    void* aadptr, void *buf, int count,
+                                    Async::EncryptedUdpSocket* sock)
 {
   //std::cout << "### Reflector::udpDatagramReceived:"
   //          << " addr=" << addr
@@ -985,13 +1522,14 @@ void Reflector::udpDatagramReceived(const IpAddress& addr, uint16_t port,
   //          << " count=" << count
   //          << std::endl;
 
-  assert(m_udp_sock->cipherAADLength() >= UdpCipher::AADLEN);
+  assert(sock->cipherAADLength() >= UdpCipher::AADLEN);
+
+  m_metric_udp_rx_bytes->inc(count);
 
-  stringstream ss;
-  ss.write(reinterpret_cast<const char *>(buf), static_cast<size_t>(count));
+  Async::MsgBufReader r(buf, count);
 
   ReflectorUdpMsg header;
-  if (!header.unpack(ss))
+  if (!header.unpack(r))
   {
     cout << "*** WARNING: Unpacking message header failed for UDP datagram "
             "from " << addr << ":" << port << endl;
@@ -1006,19 +1544,17 @@ void Reflector::udpDatagramReceived(const IpAddress& addr, uint16_t port,
     //std::cout << "### Reflector::udpDatagramReceived: m_aad.iv_cntr="
     //          << m_aad.iv_cntr << std::endl;
 
-    stringstream aadss;
-    aadss.write(reinterpret_cast<const char *>(aadptr),
-        m_udp_sock->cipherAADLength());
+    Async::MsgBufReader aadr(aadptr, sock->cipherAADLength());
 
-    if (!aad.unpack(aadss))
+    if (!aad.unpack(aadr))
     {
       return;
     }
     if (aad.iv_cntr == 0) // Client UDP registration
     {
       UdpCipher::InitialAAD iaad;
-      assert(aadss.seekg(0));
-      if (!iaad.unpack(aadss))
+      aadr.seek(0);
+      if (!iaad.unpack(aadr))
       {
         std::cout << "### Reflector::udpDatagramReceived: "
                      "Could not unpack iaad" << std::endl;
@@ -1058,8 +1594,8 @@ void Reflector::udpDatagramReceived(const IpAddress& addr, uint16_t port,
   }
   else
   {
-    ss.seekg(0);
-    if (!header_v2.unpack(ss))
+    r.seek(0);
+    if (!header_v2.unpack(r))
     {
       std::cout << "*** WARNING: Unpacking V2 message header failed for UDP "
               "datagram from " << addr << ":" << port << std::endl;
@@ -1121,6 +1657,7 @@ void Reflector::udpDatagramReceived(const IpAddress& addr, uint16_t port,
     }
     else if (aad.iv_cntr > client->nextUdpRxSeq()) // Frame lost
     {
+      client->udpFramesLost(aad.iv_cntr - client->nextUdpRxSeq());
       std::cout << client->callsign() << ": UDP frame(s) lost. Expected seq="
                 << client->nextUdpRxSeq()
                 << " but received " << aad.iv_cntr
@@ -1143,6 +1680,7 @@ void Reflector::udpDatagramReceived(const IpAddress& addr, uint16_t port,
     }
     else if (udp_rx_seq_diff > 0) // Frame(s) lost
     {
+      client->udpFramesLost(udp_rx_seq_diff);
       cout << client->callsign()
            << ": UDP frame(s) lost. Expected seq=" << next_udp_rx_seq
            << ". Received seq=" << header_v2.sequenceNum() << endl;
@@ -1159,22 +1697,56 @@ void Reflector::udpDatagramReceived(const IpAddress& addr, uint16_t port,
     case MsgUdpHeartbeat::TYPE:
       break;
 
+    case MsgUdpKeepalive::TYPE:
+    {
+      MsgUdpKeepalive msg;
+      if (!msg.unpack(r))
+      {
+        cerr << "*** WARNING[" << client->callsign()
+             << "]: Could not unpack incoming MsgUdpKeepalive message" << endl;
+        return;
+      }
+      client->udpKeepaliveReceived(msg);
+      break;
+    }
+
     case MsgUdpAudio::TYPE:
     {
       if (!client->isBlocked())
       {
-        MsgUdpAudio msg;
-        if (!msg.unpack(ss))
+          // The audio is not unpacked into a MsgUdpAudio object since that
+          // would copy it. It is instead relayed directly from the receive
+          // buffer.
+        const size_t body_offset = r.pos();
+        const uint8_t* audio = nullptr;
+        size_t audio_size = 0;
+        if (!MsgUdpAudio::peekAudioData(r, buf, audio, audio_size))
         {
           cerr << "*** WARNING[" << client->callsign()
                << "]: Could not unpack incoming MsgUdpAudioV1 message" << endl;
           return;
         }
         uint32_t tg = TGHandler::instance()->TGForClient(client);
-        if (!msg.audioData().empty() && (tg > 0))
+        TGMixer* mixer = nullptr;
+        if ((audio_size > 0) && (tg > 0) &&
+            ((mixer = tgMixer(tg, client)) != nullptr))
+        {
+            // Conference TG. Mix the audio with the other talkers. The
+            // first talker is reported as the talker for the TG.
+          if (mixer->writeAudio(client, audio, audio_size))
+          {
+            ReflectorClient* talker = TGHandler::instance()->talkerForTG(tg);
+            if ((talker == 0) || (talker == client))
+            {
+              TGHandler::instance()->setTalkerForTG(tg, client);
+            }
+            m_tg_audio_stats[tg].rx_bytes += audio_size;
+          }
+        }
+        else if ((audio_size > 0) && (tg > 0))
         {
           ReflectorClient* talker = TGHandler::instance()->talkerForTG(tg);
-          if (talker == 0)
+          if ((talker == 0) && !TGHandler::instance()->hasTrunkTalker(tg))
           {
             TGHandler::instance()->setTalkerForTG(tg, client);
             talker = TGHandler::instance()->talkerForTG(tg);
@@ -1182,10 +1754,44 @@ void Reflector::udpDatagramReceived(const IpAddress& addr, uint16_t port,
           if (talker == client)
           {
             TGHandler::instance()->setTalkerForTG(tg, client);
-            broadcastUdpMsg(msg,
-                ReflectorClient::mkAndFilter(
-                  ReflectorClient::ExceptFilter(client),
-                  ReflectorClient::TgFilter(tg)));
+            if (aadptr != nullptr)
+            {
+                // A V3 datagram can be relayed as is since the header does
+                // not contain anything client specific
+              broadcastUdpMsgToTg(tg,
+                  ReflectorPackedUdpMsg(MsgUdpAudio::TYPE, buf, r.pos(),
+                                        body_offset),
+                  ReflectorClient::mkAndFilter(
+                    ReflectorClient::mkAndFilter(
+                      ReflectorClient::ExceptFilter(client),
+                      ReflectorClient::AudioRedundancyFilter(false)),
+                    ReflectorClient::TranscodeFilter("")));
+            }
+            else
+            {
+              broadcastUdpMsgToTg(tg,
+                  ReflectorPackedUdpMsg(MsgUdpAudio::TYPE,
+                      static_cast<const uint8_t*>(buf) + body_offset,
+                      r.pos() - body_offset),
+                  ReflectorClient::mkAndFilter(
+                    ReflectorClient::mkAndFilter(
+                      ReflectorClient::ExceptFilter(client),
+                      ReflectorClient::AudioRedundancyFilter(false)),
+                    ReflectorClient::TranscodeFilter("")));
+            }
+            sendRedundantAudio(tg, client, audio, audio_size);
+            sendMonitorAudio(tg, client, audio, audio_size);
+            transcodeAudio(tg, audio, audio_size);
+            for (const auto& trunk : m_trunks)
+            {
+              trunk->sendAudio(tg, audio, audio_size);
+            }
+            const auto& clients = TGHandler::instance()->clientsForTG(tg);
+            const size_t receivers =
+              clients.size() - clients.count(client);
+            TgAudioStats& stats = m_tg_audio_stats[tg];
+            stats.rx_bytes += audio_size;
+            stats.tx_bytes += receivers * audio_size;
             //broadcastUdpMsgExcept(tg, client, msg,
             //    ProtoVerRange(ProtoVer(0, 6),
             //                  ProtoVer(1, ProtoVer::max().minor())));
@@ -1232,148 +1838,1272 @@ void Reflector::udpDatagramReceived(const IpAddress& addr, uint16_t port,
     //  break;
     //}
 
-    case MsgUdpFlushSamples::TYPE:
+    case MsgUdpFlushSamples::TYPE:
+    {
+      uint32_t tg = TGHandler::instance()->TGForClient(client);
+      ReflectorClient* talker = TGHandler::instance()->talkerForTG(tg);
+      if ((tg > 0) && (client == talker))
+      {
+        TGHandler::instance()->setTalkerForTG(tg, 0);
+      }
+      auto mixer_it = m_tg_mixers.find(tg);
+      if ((mixer_it != m_tg_mixers.end()) && (mixer_it->second != nullptr))
+      {
+        mixer_it->second->flushAudio(client);
+      }
+        // To be 100% correct the reflector should wait for all connected
+        // clients to send a MsgUdpAllSamplesFlushed message but that will
+        // probably lead to problems, especially on reflectors with many
+        // clients. We therefore acknowledge the flush immediately here to
+        // the client who sent the flush request.
+      client->sendUdpMsg(MsgUdpAllSamplesFlushed());
+      break;
+    }
+
+    case MsgUdpAllSamplesFlushed::TYPE:
+      // Ignore
+      break;
+
+    case MsgUdpAudioTrace::TYPE:
+    {
+      MsgUdpAudioTrace msg;
+      if (!msg.unpack(r) || (msg.hops().size() > MsgUdpAudioTrace::MAX_HOPS))
+      {
+        cerr << "*** WARNING[" << client->callsign()
+             << "]: Could not unpack incoming MsgUdpAudioTrace message"
+             << endl;
+        return;
+      }
+      handleAudioTrace(client, msg);
+      break;
+    }
+
+    case MsgUdpSignalStrengthValues::TYPE:
+    {
+      if (!client->isBlocked())
+      {
+        MsgUdpSignalStrengthValues msg;
+        if (!msg.unpack(r))
+        {
+          cerr << "*** WARNING[" << client->callsign()
+               << "]: Could not unpack incoming "
+                  "MsgUdpSignalStrengthValues message" << endl;
+          return;
+        }
+        client->setRxSignalStrengthValues(msg.rxs());
+      }
+      break;
+    }
+
+    default:
+      // Better ignoring unknown messages to make it easier to add messages to
+      // the protocol but still be backwards compatible
+
+      //cerr << "*** WARNING[" << client->callsign()
+      //     << "]: Unknown UDP protocol message received: msg_type="
+      //     << header.type() << endl;
+      break;
+  }
+} /* Reflector::udpDatagramReceived */
+
+
+void Reflector::onTalkerUpdated(uint32_t tg, ReflectorClient* old_talker,
+                                ReflectorClient *new_talker)
+{
+  if (old_talker != 0)
+  {
+    cout << old_talker->callsign() << ": Talker stop on TG #" << tg << endl;
+    old_talker->updateIsTalker();
+    m_tg_prev_audio.erase(tg);
+    broadcastMsgToTg(tg, MsgTalkerStop(tg, old_talker->callsign()),
+        ge_v2_client_filter, true);
+    if (tg == tgForV1Clients())
+    {
+      broadcastMsg(MsgTalkerStopV1(old_talker->callsign()), v1_client_filter);
+    }
+      // In a conference TG the mixer end the mixed audio streams
+    auto mixer_it = m_tg_mixers.find(tg);
+    if ((mixer_it == m_tg_mixers.end()) || (mixer_it->second == nullptr))
+    {
+      flushTranscoder(tg);
+      broadcastUdpMsgToTg(tg, MsgUdpFlushSamples(),
+            ReflectorClient::ExceptFilter(old_talker));
+    }
+    if (!isConferenceTg(tg))
+    {
+      for (const auto& trunk : m_trunks)
+      {
+        trunk->sendTalkerStop(tg);
+      }
+    }
+  }
+  if (new_talker != 0)
+  {
+    cout << new_talker->callsign() << ": Talker start on TG #" << tg << endl;
+    new_talker->updateIsTalker();
+    broadcastMsgToTg(tg, MsgTalkerStart(tg, new_talker->callsign()),
+        ge_v2_client_filter, true);
+    if (tg == tgForV1Clients())
+    {
+      broadcastMsg(MsgTalkerStartV1(new_talker->callsign()), v1_client_filter);
+    }
+    if (!isConferenceTg(tg))
+    {
+      for (const auto& trunk : m_trunks)
+      {
+        trunk->sendTalkerStart(tg, new_talker->callsign());
+      }
+    }
+  }
+} /* Reflector::onTalkerUpdated */
+
+
+void Reflector::httpRequestReceived(Async::HttpServerConnection *con,
+                                    Async::HttpServerConnection::Request& req)
+{
+  //std::cout << "### " << req.method << " " << req.target << std::endl;
+
+  Async::HttpServerConnection::Response res;
+  if ((req.method != "GET") && (req.method != "HEAD"))
+  {
+    res.setCode(501);
+    res.setContent("application/json",
+        "{\"msg\":\"" + req.method + ": Method not implemented\"}");
+    con->write(res);
+    return;
+  }
+
+  std::string path(req.target);
+  std::string query;
+  size_t qpos = path.find('?');
+  if (qpos != std::string::npos)
+  {
+    query = path.substr(qpos + 1);
+    path.erase(qpos);
+  }
+
+  if (path == "/status")
+  {
+    httpStatusRequest(con, req);
+    return;
+  }
+  if (path == "/status/delta")
+  {
+    httpStatusDeltaRequest(con, req, query);
+    return;
+  }
+  if (path == "/metrics")
+  {
+    httpMetricsRequest(con, req);
+    return;
+  }
+
+  res.setCode(404);
+  res.setContent("application/json",
+      "{\"msg\":\"Not found!\"}");
+  con->write(res);
+} /* Reflector::requestReceived */
+
+
+void Reflector::httpStatusRequest(Async::HttpServerConnection *con,
+                                  Async::HttpServerConnection::Request& req)
+{
+    // The UDP receive and transmit statistics change all the time so they
+    // are not part of the cached document but they must be part of the
+    // entity tag.
+  const Async::UdpSocket::RxStats rx_stats = udpRxStats();
+  std::ostringstream etag;
+  etag << "\"" << m_status_ver << "-" << rx_stats.wakeups << "-"
+       << rx_stats.datagrams << "-" << m_tg_audio_stats_ver << "-"
+       << m_audio_trace_stats.version() << "-" << m_udp_tx_drops << "-"
+       << m_udp_tx_congested << "-" << m_udp_kernel_drops_total << "\"";
+
+  Async::HttpServerConnection::Response res;
+  res.setHeader("ETag", etag.str());
+  res.setHeader("Cache-Control", "no-cache");
+
+  const std::string* if_none_match = findHttpHeader(req.headers,
+                                                    "If-None-Match");
+  if ((if_none_match != nullptr) &&
+      ((*if_none_match == "*") ||
+       (if_none_match->find(etag.str()) != std::string::npos)))
+  {
+    res.setCode(304);
+    con->write(res);
+    return;
+  }
+
+  if (m_status_dirty)
+  {
+    syncClientTelemetry();
+    m_status_nodes_json = jsonString(m_status["nodes"]);
+    m_status_dirty = false;
+  }
+
+    // Keep the member order of the document the same as when it was written
+    // using the JSON library, that is sorted by key
+  std::string doc;
+  doc.reserve(m_status_nodes_json.size() + 256);
+  doc += "{\"audioTrace\":";
+  doc += jsonString(m_audio_trace_stats.status());
+  doc += ",\"clientMemory\":";
+  doc += jsonString(clientMemoryStatus());
+  doc += ",\"commandPty\":";
+  doc += jsonString(commandPtyStatus());
+  doc += ",\"nodes\":";
+  doc += m_status_nodes_json;
+  doc += ",\"tcpTx\":";
+  doc += jsonString(tcpTxStatus());
+  doc += ",\"tgAudio\":";
+  doc += jsonString(tgAudioStatus());
+  doc += ",\"udpRx\":";
+  doc += jsonString(udpRxStatus());
+  doc += ",\"udpTx\":";
+  doc += jsonString(udpTxStatus());
+  doc += ",\"version\":";
+  doc += std::to_string(m_status_ver);
+  doc += "}";
+
+  res.setContent("application/json", doc);
+  res.setSendContent(req.method == "GET");
+  res.setCode(200);
+  con->write(res);
+} /* Reflector::httpStatusRequest */
+
+
+void Reflector::httpStatusDeltaRequest(Async::HttpServerConnection *con,
+                                       Async::HttpServerConnection::Request& req,
+                                       const std::string& query)
+{
+  Async::HttpServerConnection::Response res;
+  res.setHeader("Cache-Control", "no-cache");
+
+  uint64_t since = 0;
+  std::vector<std::string> params;
+  SvxLink::splitStr(params, query, "&");
+  for (const auto& param : params)
+  {
+    if (param.compare(0, 6, "since=") == 0)
+    {
+      std::istringstream is(param.substr(6));
+      if (!(is >> since) || !is.eof())
+      {
+        res.setCode(400);
+        res.setContent("application/json",
+            "{\"msg\":\"Malformed since parameter\"}");
+        con->write(res);
+        return;
+      }
+    }
+  }
+
+    // If the client is asking for changes since a version that we do not
+    // have enough history for, just send the full node list. The client
+    // will know that it has to replace its view of the nodes by looking at
+    // the "full" member.
+  const bool full = (since == 0) || (since < m_status_removed_floor) ||
+                    (since > m_status_ver);
+
+  Json::Value delta(Json::objectValue);
+  delta["version"] = Json::UInt64(m_status_ver);
+  delta["full"] = full;
+  Json::Value& nodes = delta["nodes"] = Json::Value(Json::objectValue);
+  Json::Value& removed = delta["removed"] = Json::Value(Json::arrayValue);
+  syncClientTelemetry();
+  const Json::Value& status_nodes = m_status["nodes"];
+  for (const auto& node_ver : m_status_node_ver)
+  {
+    if ((full || (node_ver.second > since)) &&
+        status_nodes.isMember(node_ver.first))
+    {
+      nodes[node_ver.first] = status_nodes[node_ver.first];
+    }
+  }
+  if (!full)
+  {
+    for (const auto& removed_ver : m_status_removed_ver)
+    {
+      if (removed_ver.second > since)
+      {
+        removed.append(removed_ver.first);
+      }
+    }
+  }
+
+  delta["audioTrace"] = m_audio_trace_stats.status();
+  delta["clientMemory"] = clientMemoryStatus();
+  delta["commandPty"] = commandPtyStatus();
+  delta["tcpTx"] = tcpTxStatus();
+  delta["tgAudio"] = tgAudioStatus();
+  delta["udpRx"] = udpRxStatus();
+  delta["udpTx"] = udpTxStatus();
+
+  res.setContent("application/json", jsonString(delta));
+  res.setSendContent(req.method == "GET");
+  res.setCode(200);
+  con->write(res);
+} /* Reflector::httpStatusDeltaRequest */
+
+
+void Reflector::httpMetricsRequest(Async::HttpServerConnection *con,
+                                   Async::HttpServerConnection::Request& req)
+{
+  std::ostringstream os;
+  SvxLink::Metrics::instance()->write(os);
+
+  Async::HttpServerConnection::Response res;
+  res.setHeader("Cache-Control", "no-cache");
+  res.setContent(SvxLink::Metrics::contentType(), os.str());
+  res.setSendContent(req.method == "GET");
+  res.setCode(200);
+  con->write(res);
+} /* Reflector::httpMetricsRequest */
+
+
+void Reflector::initMetrics(void)
+{
+    // The metrics that are updated in the audio path are looked up once
+    // here. Everything else is read from where it is already kept when the
+    // metrics are collected.
+  SvxLink::Metrics* metrics = SvxLink::Metrics::instance();
+  m_metric_udp_rx_bytes = &metrics->counter("svxreflector_udp_rx_bytes_total",
+      "Number of UDP bytes received");
+  m_metric_udp_tx_datagrams = &metrics->counter(
+      "svxreflector_udp_tx_datagrams_total", "Number of UDP datagrams sent");
+  m_metric_udp_tx_bytes = &metrics->counter("svxreflector_udp_tx_bytes_total",
+      "Number of UDP payload bytes sent, not counting the encryption "
+      "overhead");
+  m_metric_fanout_time = &metrics->histogram("svxreflector_fanout_seconds",
+      "Time used to send one audio frame to all receivers in a talk group",
+      SvxLink::Metrics::exponentialBuckets(0.00001, 2.0, 14));
+  m_metric_encrypt_time = &metrics->histogram(
+      "svxreflector_fanout_encrypt_seconds",
+      "Time used by the worker threads to encrypt one audio frame for all "
+      "receivers in a large talk group",
+      SvxLink::Metrics::exponentialBuckets(0.00001, 2.0, 14));
+  metrics->collect.connect(mem_fun(*this, &Reflector::collectMetrics));
+} /* Reflector::initMetrics */
+
+
+void Reflector::collectMetrics(void)
+{
+  SvxLink::Metrics* metrics = SvxLink::Metrics::instance();
+
+  const Async::UdpSocket::RxStats rx_stats = udpRxStats();
+  metrics->counter("svxreflector_udp_rx_datagrams_total",
+      "Number of UDP datagrams received").set(rx_stats.datagrams);
+  metrics->counter("svxreflector_udp_rx_wakeups_total",
+      "Number of times the UDP socket was read").set(rx_stats.wakeups);
+  for (size_t i=0; i<m_udp_socks.size(); ++i)
+  {
+    metrics->counter("svxreflector_udp_rx_kernel_drops_total",
+        "Number of UDP datagrams dropped by the kernel",
+        {{"socket", std::to_string(i)}}).set(m_udp_kernel_drops[i]);
+  }
+
+    // Clients come and go so the metrics labeled by client or protocol
+    // version are created again each time
+  const char* clients_name = "svxreflector_clients";
+  const char* lost_name = "svxreflector_client_udp_rx_lost_frames_total";
+  const char* jitter_name = "svxreflector_client_udp_rx_jitter_seconds";
+  const char* dropped_name = "svxreflector_client_udp_tx_dropped_total";
+  const char* audio_latency_name = "svxreflector_client_audio_latency_seconds";
+  metrics->clear(clients_name);
+  metrics->clear(lost_name);
+  metrics->clear(jitter_name);
+  metrics->clear(dropped_name);
+  metrics->clear(audio_latency_name);
+  for (unsigned i=0; i<Async::AudioStats::COUNTER_CNT; ++i)
+  {
+    metrics->clear(clientAudioMetricName(Async::AudioStats::Counter(i)));
+  }
+  for (const auto& item : m_client_con_map)
+  {
+    const ReflectorClient* client = item.second;
+    if (client->conState() != ReflectorClient::STATE_CONNECTED)
+    {
+      continue;
+    }
+    std::ostringstream ver;
+    ver << client->protoVer().majorVer() << "."
+        << client->protoVer().minorVer();
+    metrics->gauge(clients_name,
+        "Number of connected clients per protocol version",
+        {{"proto_ver", ver.str()}}).add(1.0);
+    const SvxLink::Metrics::Labels labels{{"callsign", client->callsign()}};
+    metrics->counter(lost_name, "Number of UDP frames lost from the client",
+        labels).set(client->udpRxLostFrames());
+    metrics->gauge(jitter_name,
+        "Estimated audio packet arrival jitter for the client",
+        labels).set(client->udpRxJitter());
+    metrics->counter(dropped_name,
+        "Number of UDP datagrams not sent to the client",
+        {{"callsign", client->callsign()}, {"reason", "stale"}}).set(
+          client->udpTxDropCount(ReflectorClient::UDP_TX_DROP_STALE));
+    metrics->counter(dropped_name,
+        "Number of UDP datagrams not sent to the client",
+        {{"callsign", client->callsign()}, {"reason", "congested"}}).set(
+          client->udpTxDropCount(ReflectorClient::UDP_TX_DROP_CONGESTED));
+
+      // Audio health statistics reported by each logic core in the client
+    const Json::Value* audio_stats = client->audioStats();
+    if (audio_stats == nullptr)
+    {
+      continue;
+    }
+    for (const auto& logic : audio_stats->getMemberNames())
+    {
+      const Json::Value& stats = (*audio_stats)[logic];
+      const SvxLink::Metrics::Labels logic_labels{
+        {"callsign", client->callsign()}, {"logic", logic}};
+      for (unsigned i=0; i<Async::AudioStats::COUNTER_CNT; ++i)
+      {
+        const Async::AudioStats::Counter counter =
+          Async::AudioStats::Counter(i);
+        const Json::Value& value =
+          stats.get(Async::AudioStats::counterName(counter), 0);
+        if (value.isIntegral())
+        {
+          metrics->counter(clientAudioMetricName(counter),
+              "Audio health counter reported by the client",
+              logic_labels).set(value.asUInt64());
+        }
+      }
+      const Json::Value& latency = stats.get("latency", Json::Value());
+      if (latency.isObject() && latency.get("avg_ms", 0).isNumeric())
+      {
+        metrics->gauge(audio_latency_name,
+            "Average audio latency from network ingress to the audio device "
+            "reported by the client",
+            logic_labels).set(latency.get("avg_ms", 0).asDouble() / 1000.0);
+      }
+    }
+  }
+
+  typedef Async::Application::LoopStats LoopStats;
+  const LoopStats& loop_stats = Async::Application::app().loopStats();
+  if (loop_stats.iterations > 0)
+  {
+    std::vector<double> busy_bounds;
+    std::vector<double> lag_bounds;
+    for (unsigned i=0; i<LoopStats::HIST_BUCKETS-1; ++i)
+    {
+      busy_bounds.push_back((1 << i) / 1000000.0);
+      lag_bounds.push_back((1 << i) / 1000.0);
+    }
+    SvxLink::MetricHistogram& busy = metrics->histogram(
+        "svxreflector_event_loop_busy_seconds",
+        "Time spent handling events in one event loop iteration",
+        busy_bounds);
+    busy.clear();
+    SvxLink::MetricHistogram& lag = metrics->histogram(
+        "svxreflector_timer_lag_seconds",
+        "How late timers were when they expired", lag_bounds);
+    lag.clear();
+    for (unsigned i=0; i<LoopStats::HIST_BUCKETS; ++i)
+    {
+      busy.add(i, loop_stats.busy_us_hist[i], 0.0);
+      lag.add(i, loop_stats.timer_lag_ms_hist[i], 0.0);
+    }
+    busy.add(0, 0, loop_stats.busy_us / 1000000.0);
+    lag.add(0, 0, loop_stats.timer_lag_ms / 1000.0);
+  }
+
+  typedef Async::Application::ObjectCounts ObjectCounts;
+  const ObjectCounts& objs = Async::Application::objectCounts();
+  metrics->gauge("svxreflector_event_loop_timers",
+      "Number of existing event loop timers").set(objs.timers);
+  metrics->gauge("svxreflector_event_loop_enabled_timers",
+      "Number of enabled event loop timers").set(objs.enabled_timers);
+  metrics->gauge("svxreflector_event_loop_fd_watches",
+      "Number of existing file descriptor watches").set(objs.fd_watches);
+  metrics->gauge("svxreflector_event_loop_enabled_fd_watches",
+      "Number of enabled file descriptor watches").set(
+        objs.enabled_fd_watches);
+
+  const char* slow_max_name = "svxreflector_event_loop_slow_callback_seconds";
+  const char* slow_cnt_name = "svxreflector_event_loop_slow_callbacks_total";
+  metrics->clear(slow_max_name);
+  metrics->clear(slow_cnt_name);
+  for (const auto& cb : Async::Application::app().slowCallbacks())
+  {
+    const SvxLink::Metrics::Labels labels{{"source", cb.source}};
+    metrics->gauge(slow_max_name,
+        "The longest time used by one call to a slow event loop callback",
+        labels).set(cb.max_us / 1000000.0);
+    metrics->counter(slow_cnt_name,
+        "Number of calls to an event loop callback that were slow",
+        labels).set(cb.count);
+  }
+} /* Reflector::collectMetrics */
+
+
+void Reflector::updateTgAudioStats(void)
+{
+  bool changed = false;
+  for (auto it = m_tg_audio_stats.begin(); it != m_tg_audio_stats.end(); )
+  {
+    TgAudioStats& stats = it->second;
+    const uint64_t rx_rate = stats.rx_bytes - stats.prev_rx_bytes;
+    const uint64_t tx_rate = stats.tx_bytes - stats.prev_tx_bytes;
+    if ((rx_rate > 0) || (tx_rate > 0))
+    {
+        // The statistics for a TG are removed when it has been idle for a
+        // while so the totals are kept in the metrics registry
+      const SvxLink::Metrics::Labels labels{{"tg", std::to_string(it->first)}};
+      SvxLink::Metrics::instance()->counter("svxreflector_tg_rx_bytes_total",
+          "Audio bytes received per talk group", labels).inc(rx_rate);
+      SvxLink::Metrics::instance()->counter("svxreflector_tg_tx_bytes_total",
+          "Audio bytes sent per talk group", labels).inc(tx_rate);
+    }
+    stats.prev_rx_bytes = stats.rx_bytes;
+    stats.prev_tx_bytes = stats.tx_bytes;
+    if ((rx_rate != stats.rx_rate) || (tx_rate != stats.tx_rate))
+    {
+      stats.rx_rate = rx_rate;
+      stats.tx_rate = tx_rate;
+      changed = true;
+    }
+    stats.idle_cnt = ((rx_rate == 0) && (tx_rate == 0)) ? stats.idle_cnt+1 : 0;
+    if (stats.idle_cnt >= TG_AUDIO_STATS_IDLE_LIMIT)
+    {
+      it = m_tg_audio_stats.erase(it);
+      changed = true;
+    }
+    else
+    {
+      ++it;
+    }
+  }
+  if (changed)
+  {
+    ++m_tg_audio_stats_ver;
+  }
+  m_audio_trace_stats.prune();
+} /* Reflector::updateTgAudioStats */
+
+
+Json::Value Reflector::tgAudioStatus(void) const
+{
+  Json::Value tg_audio(Json::objectValue);
+  for (const auto& item : m_tg_audio_stats)
+  {
+    const TgAudioStats& stats = item.second;
+    Json::Value& tg = tg_audio[std::to_string(item.first)];
+    tg["rxBytesPerSec"] = Json::UInt64(stats.rx_rate);
+    tg["txBytesPerSec"] = Json::UInt64(stats.tx_rate);
+    tg["rxBytes"] = Json::UInt64(stats.rx_bytes);
+    tg["txBytes"] = Json::UInt64(stats.tx_bytes);
+  }
+  return tg_audio;
+} /* Reflector::tgAudioStatus */
+
+
+void Reflector::handleAudioTrace(ReflectorClient* client,
+                                 MsgUdpAudioTrace& msg)
+{
+  if (msg.hops().empty())
+  {
+    return;
+  }
+
+  if (msg.lastHop() == MsgUdpAudioTrace::HOP_PLAYOUT)
+  {
+      // A trace sent back by a receiving node
+    m_audio_trace_stats.add(client->callsign(), msg);
+    return;
+  }
+
+  if ((msg.hops().size() != 1) || client->isBlocked())
+  {
+    return;
+  }
+
+    // A new trace from the talker. It follow the audio frame that it was sent
+    // with. The frames for a conference TG are mixed so they cannot be
+    // traced through the reflector.
+  uint32_t tg = TGHandler::instance()->TGForClient(client);
+  if ((tg == 0) || isConferenceTg(tg) ||
+      (TGHandler::instance()->talkerForTG(tg) != client))
+  {
+    return;
+  }
+  const uint64_t now = std::chrono::duration_cast<std::chrono::microseconds>(
+      std::chrono::system_clock::now().time_since_epoch()).count();
+  msg.addHop(MsgUdpAudioTrace::HOP_REFLECTOR, now);
+  msg.setTg(tg);
+  msg.setOrigin(client->callsign());
+  broadcastUdpMsgToTg(tg, msg,
+      ReflectorClient::mkAndFilter(
+        ReflectorClient::ExceptFilter(client),
+        audio_trace_client_filter));
+} /* Reflector::handleAudioTrace */
+
+
+TGMixer* Reflector::tgMixer(uint32_t tg, const ReflectorClient* client)
+{
+  auto it = m_tg_mixers.find(tg);
+  if (it != m_tg_mixers.end())
+  {
+    return it->second;
+  }
+
+  const unsigned max_talkers = TGHandler::instance()->maxTalkers(tg);
+  if (max_talkers < 2)
+  {
+    return nullptr;
+  }
+
+    // A failed mixer is remembered as a null pointer so that we do not try
+    // again for every audio packet. Audio is then forwarded as usual.
+  TGMixer* mixer = new TGMixer(tg, max_talkers, client->codecName());
+  if (!mixer->initOk())
+  {
+    delete mixer;
+    m_tg_mixers[tg] = nullptr;
+    return nullptr;
+  }
+  mixer->audioMixed.connect(
+      sigc::bind(mem_fun(*this, &Reflector::onMixedAudio), tg));
+  mixer->mixFlushed.connect(
+      sigc::bind(mem_fun(*this, &Reflector::onMixFlushed), tg));
+
+  std::ostringstream ss;
+  ss << "TG#" << tg;
+  const std::string opt_prefix(client->codecName() + "_ENC_");
+  for (const auto& tag : m_cfg->listSection(ss.str()))
+  {
+    if (tag.find(opt_prefix) == 0)
+    {
+      std::string opt_value;
+      m_cfg->getValue(ss.str(), tag, opt_value);
+      mixer->setEncoderOption(tag.substr(opt_prefix.size()), opt_value);
+    }
+  }
+  std::cout << "Created an audio mixer for up to " << mixer->maxTalkers()
+            << " talkers on TG #" << tg << std::endl;
+  mixer->printCodecParams();
+
+  m_tg_mixers[tg] = mixer;
+  return mixer;
+} /* Reflector::tgMixer */
+
+
+void Reflector::onMixedAudio(ReflectorClient* to, const void* buf, int size,
+                             uint32_t tg)
+{
+  MsgUdpAudio msg(buf, size);
+  TgAudioStats& stats = m_tg_audio_stats[tg];
+  if (to != nullptr)
+  {
+    to->sendUdpMsg(msg);
+    stats.tx_bytes += size;
+    return;
+  }
+  const TGMixer* mixer = m_tg_mixers[tg];
+  assert(mixer != nullptr);
+  broadcastUdpMsgToTg(tg, msg,
+      ReflectorClient::mkAndFilter(
+        TGMixer::ListenerFilter(*mixer),
+        ReflectorClient::TranscodeFilter("")));
+  transcodeAudio(tg, buf, size);
+  const size_t clients = TGHandler::instance()->clientsForTG(tg).size();
+  const size_t talkers = mixer->talkerCount();
+  stats.tx_bytes += (clients > talkers) ? (clients - talkers) * size : 0;
+} /* Reflector::onMixedAudio */
+
+
+void Reflector::onMixFlushed(ReflectorClient* to, uint32_t tg)
+{
+  if (to != nullptr)
+  {
+    to->sendUdpMsg(MsgUdpFlushSamples());
+    return;
+  }
+  const TGMixer* mixer = m_tg_mixers[tg];
+  assert(mixer != nullptr);
+  flushTranscoder(tg);
+  broadcastUdpMsgToTg(tg, MsgUdpFlushSamples(),
+                      TGMixer::ListenerFilter(*mixer));
+} /* Reflector::onMixFlushed */
+
+
+void Reflector::cleanupTgMixers(void)
+{
+  for (auto it = m_tg_mixers.begin(); it != m_tg_mixers.end(); )
+  {
+    TGMixer* mixer = it->second;
+    if (TGHandler::instance()->clientsForTG(it->first).empty() &&
+        ((mixer == nullptr) || mixer->isIdle()))
+    {
+      delete mixer;
+      it = m_tg_mixers.erase(it);
+    }
+    else
+    {
+      ++it;
+    }
+  }
+} /* Reflector::cleanupTgMixers */
+
+
+bool Reflector::isConferenceTg(uint32_t tg) const
+{
+  return TGHandler::instance()->maxTalkers(tg) > 1;
+} /* Reflector::isConferenceTg */
+
+
+void Reflector::transcodeAudio(uint32_t tg, const void* audio,
+                               size_t audio_size)
+{
+  TGTranscoder* transcoder = nullptr;
+  auto it = m_tg_transcoders.find(tg);
+  if (it != m_tg_transcoders.end())
+  {
+    transcoder = it->second;
+  }
+  for (const auto& client : TGHandler::instance()->clientsForTG(tg))
+  {
+    if (client->transcodeProfile().empty())
+    {
+      continue;
+    }
+    if (transcoder == nullptr)
+    {
+      transcoder = new TGTranscoder(tg, client->codecName());
+      if (!transcoder->initOk())
+      {
+        delete transcoder;
+        return;
+      }
+      transcoder->audioTranscoded.connect(
+          sigc::bind(mem_fun(*this, &Reflector::onTranscodedAudio), tg));
+      m_tg_transcoders[tg] = transcoder;
+    }
+    transcoder->addProfile(client->transcodeCodec(),
+                           client->transcodeBitrate());
+  }
+  if (transcoder != nullptr)
+  {
+    transcoder->writeAudio(audio, audio_size);
+  }
+} /* Reflector::transcodeAudio */
+
+
+void Reflector::onTranscodedAudio(const std::string& profile, const void* buf,
+                                  int size, uint32_t tg)
+{
+  MsgUdpAudio msg(buf, size);
+  auto mixer_it = m_tg_mixers.find(tg);
+  if ((mixer_it != m_tg_mixers.end()) && (mixer_it->second != nullptr))
+  {
+    broadcastUdpMsgToTg(tg, msg,
+        ReflectorClient::mkAndFilter(
+          TGMixer::ListenerFilter(*mixer_it->second),
+          ReflectorClient::TranscodeFilter(profile)));
+    return;
+  }
+  ReflectorClient* talker = TGHandler::instance()->talkerForTG(tg);
+  broadcastUdpMsgToTg(tg, msg,
+      ReflectorClient::mkAndFilter(
+        ReflectorClient::ExceptFilter(talker),
+        ReflectorClient::TranscodeFilter(profile)));
+} /* Reflector::onTranscodedAudio */
+
+
+void Reflector::flushTranscoder(uint32_t tg)
+{
+  auto it = m_tg_transcoders.find(tg);
+  if (it != m_tg_transcoders.end())
+  {
+    it->second->flushAudio();
+  }
+} /* Reflector::flushTranscoder */
+
+
+void Reflector::cleanupTgTranscoders(void)
+{
+  for (auto it = m_tg_transcoders.begin(); it != m_tg_transcoders.end(); )
+  {
+    TGTranscoder* transcoder = it->second;
+    bool in_use = false;
+    for (const auto& client : TGHandler::instance()->clientsForTG(it->first))
+    {
+      in_use = in_use || !client->transcodeProfile().empty();
+    }
+    if (!in_use && transcoder->isIdle())
+    {
+      delete transcoder;
+      it = m_tg_transcoders.erase(it);
+    }
+    else
+    {
+      ++it;
+    }
+  }
+} /* Reflector::cleanupTgTranscoders */
+
+
+bool Reflector::initTrunks(void)
+{
+  std::vector<std::string> trunk_names;
+  m_cfg->getValue("GLOBAL", "TRUNKS", trunk_names, true);
+  if (trunk_names.empty())
+  {
+    return true;
+  }
+
+    // The instance id decide which reflector win when two talkers start at
+    // the same time on different reflectors in a cluster
+  uint64_t instance_id = 0;
+  while (instance_id == 0)
+  {
+    if (RAND_bytes(reinterpret_cast<unsigned char*>(&instance_id),
+                   sizeof(instance_id)) != 1)
+    {
+      std::cerr << "*** ERROR: Failed to generate the reflector instance id"
+                << std::endl;
+      return false;
+    }
+  }
+  TGHandler::instance()->setInstanceId(instance_id);
+
+  bool has_incoming = false;
+  for (const auto& name : trunk_names)
+  {
+    ReflectorTrunk* trunk = new ReflectorTrunk(*m_cfg, name,
+                                               m_ca_bundle_file);
+    m_trunks.push_back(trunk);
+    if (!trunk->initialize())
+    {
+      return false;
+    }
+    trunk->stateChanged.connect(
+        mem_fun(*this, &Reflector::onTrunkStateChanged));
+    trunk->talkerStartReceived.connect(
+        mem_fun(*this, &Reflector::onTrunkTalkerStart));
+    trunk->talkerStopReceived.connect(
+        mem_fun(*this, &Reflector::onTrunkTalkerStop));
+    trunk->audioReceived.connect(
+        mem_fun(*this, &Reflector::onTrunkAudio));
+    has_incoming = has_incoming || !trunk->isOutgoing();
+  }
+
+  std::string trunk_listen_port;
+  if (m_cfg->getValue("GLOBAL", "TRUNK_LISTEN_PORT", trunk_listen_port))
+  {
+    m_trunk_srv = new FramedTcpServer(trunk_listen_port);
+    m_trunk_srv->setSslContext(m_ssl_ctx);
+    m_trunk_srv->setConnectionThrottling(10, 0.1, 1000);
+    m_trunk_srv->clientConnected.connect(
+        mem_fun(*this, &Reflector::trunkClientConnected));
+    m_trunk_srv->clientDisconnected.connect(
+        mem_fun(*this, &Reflector::trunkClientDisconnected));
+  }
+  else if (has_incoming)
+  {
+    std::cerr << "*** ERROR: GLOBAL/TRUNK_LISTEN_PORT must be set when "
+                 "there are trunks without HOST configured" << std::endl;
+    return false;
+  }
+
+  updateTrunkSubscriptions();
+
+  return true;
+} /* Reflector::initTrunks */
+
+
+void Reflector::trunkClientConnected(Async::FramedTcpConnection *con)
+{
+  std::cout << con->remoteHost() << ":" << con->remotePort()
+            << ": Trunk client connected" << std::endl;
+  con->setMaxRxFrameSize(ReflectorTrunk::MAX_PREAUTH_FRAME_SIZE);
+  m_trunk_pending_cons[con] = con->frameReceived.connect(
+      mem_fun(*this, &Reflector::trunkHelloReceived));
+    // The connecting side start the TLS handshake directly
+  con->enableSsl(true);
+} /* Reflector::trunkClientConnected */
+
+
+void Reflector::trunkClientDisconnected(Async::FramedTcpConnection *con,
+                          Async::FramedTcpConnection::DisconnectReason reason)
+{
+  auto it = m_trunk_pending_cons.find(con);
+  if (it != m_trunk_pending_cons.end())
+  {
+    std::cout << con->remoteHost() << ":" << con->remotePort()
+              << ": Trunk client disconnected: "
+              << TcpConnection::disconnectReasonStr(reason) << std::endl;
+    it->second.disconnect();
+    m_trunk_pending_cons.erase(it);
+  }
+  for (const auto& trunk : m_trunks)
+  {
+    trunk->connectionClosed(con);
+  }
+} /* Reflector::trunkClientDisconnected */
+
+
+void Reflector::trunkHelloReceived(Async::FramedTcpConnection *con,
+                                   std::vector<uint8_t>& data)
+{
+  auto it = m_trunk_pending_cons.find(con);
+  assert(it != m_trunk_pending_cons.end());
+  it->second.disconnect();
+  m_trunk_pending_cons.erase(it);
+
+  std::stringstream ss;
+  ss.write(reinterpret_cast<const char*>(data.data()), data.size());
+  ReflectorMsg header;
+  MsgTrunkHello hello;
+  ReflectorTrunk* trunk = nullptr;
+  if (header.unpack(ss) && (header.type() == MsgTrunkHello::TYPE) &&
+      hello.unpack(ss))
+  {
+    for (const auto& t : m_trunks)
     {
-      uint32_t tg = TGHandler::instance()->TGForClient(client);
-      ReflectorClient* talker = TGHandler::instance()->talkerForTG(tg);
-      if ((tg > 0) && (client == talker))
+      if (!t->isOutgoing() && (t->name() == hello.trunkName()))
       {
-        TGHandler::instance()->setTalkerForTG(tg, 0);
+        trunk = t;
+        break;
       }
-        // To be 100% correct the reflector should wait for all connected
-        // clients to send a MsgUdpAllSamplesFlushed message but that will
-        // probably lead to problems, especially on reflectors with many
-        // clients. We therefore acknowledge the flush immediately here to
-        // the client who sent the flush request.
-      client->sendUdpMsg(MsgUdpAllSamplesFlushed());
-      break;
     }
+    if (trunk == nullptr)
+    {
+      std::cerr << "*** WARNING: Unknown trunk \"" << hello.trunkName()
+                << "\" requested by " << con->remoteHost() << ":"
+                << con->remotePort() << std::endl;
+    }
+  }
+  else
+  {
+    std::cerr << "*** WARNING: Malformed trunk hello from "
+              << con->remoteHost() << ":" << con->remotePort() << std::endl;
+  }
 
-    case MsgUdpAllSamplesFlushed::TYPE:
-      // Ignore
-      break;
+  if (((trunk == nullptr) || !trunk->acceptConnection(con, hello)) &&
+      con->isConnected())
+  {
+    con->disconnect();
+    con->disconnected(con, FramedTcpConnection::DR_ORDERED_DISCONNECT);
+  }
+} /* Reflector::trunkHelloReceived */
 
-    case MsgUdpSignalStrengthValues::TYPE:
+
+void Reflector::onTrunkStateChanged(ReflectorTrunk* trunk, bool is_up)
+{
+  if (!is_up)
+  {
+    TGHandler::instance()->removeTrunkTalkers(trunk->peerInstanceId());
+  }
+} /* Reflector::onTrunkStateChanged */
+
+
+void Reflector::onTrunkTalkerStart(ReflectorTrunk* trunk, uint32_t tg,
+                                   const std::string& callsign)
+{
+  if ((tg > 0) && !isConferenceTg(tg))
+  {
+    TGHandler::instance()->trunkTalkerStart(tg, trunk->peerInstanceId(),
+                                            callsign);
+  }
+} /* Reflector::onTrunkTalkerStart */
+
+
+void Reflector::onTrunkTalkerStop(ReflectorTrunk* trunk, uint32_t tg)
+{
+  TGHandler::instance()->trunkTalkerStop(tg, trunk->peerInstanceId());
+} /* Reflector::onTrunkTalkerStop */
+
+
+void Reflector::udpSendBufferFull(bool is_full)
+{
+  if (is_full && !m_udp_tx_congested)
+  {
+    SvxLink::Metrics::instance()->counter(
+        "svxreflector_udp_tx_congested_total",
+        "Number of times the UDP socket send buffer became full").inc();
+  }
+  m_udp_tx_congested = is_full;
+} /* Reflector::udpSendBufferFull */
+
+
+bool Reflector::udpTxAllowed(ReflectorClient* client)
+{
+  if (client->udpIsStale())
+  {
+    client->udpTxDropped(ReflectorClient::UDP_TX_DROP_STALE);
+    ++m_udp_tx_drops;
+    return false;
+  }
+    // Datagrams written while the send buffer is full are thrown away by
+    // the socket so there is no point in spending time encrypting them
+  if (m_udp_tx_congested)
+  {
+    client->udpTxDropped(ReflectorClient::UDP_TX_DROP_CONGESTED);
+    ++m_udp_tx_drops;
+    return false;
+  }
+  return true;
+} /* Reflector::udpTxAllowed */
+
+
+void Reflector::sendMonitorAudio(uint32_t tg, const ReflectorClient* talker,
+                                 const uint8_t* audio, size_t audio_size)
+{
+    // Clients that have selected the talk group already get the audio
+  TGHandler* tg_handler = TGHandler::instance();
+  const TGHandler::ClientSet& clients = tg_handler->clientsForTG(tg);
+  std::unique_ptr<ReflectorPackedUdpMsg> packed_msg;
+  for (const auto& client : tg_handler->monitorsForTG(tg))
+  {
+    if ((client == talker) || !client->monitorAudio() ||
+        !client->transcodeProfile().empty() ||
+        (client->conState() != ReflectorClient::STATE_CONNECTED) ||
+        (clients.count(client) > 0) || !udpTxAllowed(client))
     {
-      if (!client->isBlocked())
-      {
-        MsgUdpSignalStrengthValues msg;
-        if (!msg.unpack(ss))
-        {
-          cerr << "*** WARNING[" << client->callsign()
-               << "]: Could not unpack incoming "
-                  "MsgUdpSignalStrengthValues message" << endl;
-          return;
-        }
-        typedef MsgUdpSignalStrengthValues::Rxs::const_iterator RxsIter;
-        for (RxsIter it = msg.rxs().begin(); it != msg.rxs().end(); ++it)
-        {
-          const MsgUdpSignalStrengthValues::Rx& rx = *it;
-          //std::cout << "### MsgUdpSignalStrengthValues:"
-          //  << " id=" << rx.id()
-          //  << " siglev=" << rx.siglev()
-          //  << " enabled=" << rx.enabled()
-          //  << " sql_open=" << rx.sqlOpen()
-          //  << " active=" << rx.active()
-          //  << std::endl;
-          client->setRxSiglev(rx.id(), rx.siglev());
-          client->setRxEnabled(rx.id(), rx.enabled());
-          client->setRxSqlOpen(rx.id(), rx.sqlOpen());
-          client->setRxActive(rx.id(), rx.active());
-        }
-      }
-      break;
+      continue;
+    }
+    if (packed_msg == nullptr)
+    {
+      packed_msg.reset(new ReflectorPackedUdpMsg(
+            MsgUdpMonitorAudio(tg, audio, audio_size)));
     }
+    sendUdpDatagram(client, *packed_msg);
+  }
+} /* Reflector::sendMonitorAudio */
 
-    default:
-      // Better ignoring unknown messages to make it easier to add messages to
-      // the protocol but still be backwards compatible
 
-      //cerr << "*** WARNING[" << client->callsign()
-      //     << "]: Unknown UDP protocol message received: msg_type="
-      //     << header.type() << endl;
-      break;
+void Reflector::sendRedundantAudio(uint32_t tg, const ReflectorClient* talker,
+                                   const uint8_t* audio, size_t audio_size)
+{
+  std::vector<uint8_t>& prev_audio = m_tg_prev_audio[tg];
+  std::unique_ptr<ReflectorPackedUdpMsg> packed_msg;
+  for (const auto& client : TGHandler::instance()->clientsForTG(tg))
+  {
+    if ((client == talker) || !client->audioRedundancy() ||
+        !client->transcodeProfile().empty() ||
+        (client->conState() != ReflectorClient::STATE_CONNECTED) ||
+        !udpTxAllowed(client))
+    {
+      continue;
+    }
+    if (packed_msg == nullptr)
+    {
+      packed_msg.reset(new ReflectorPackedUdpMsg(
+            MsgUdpRedundantAudio(audio, audio_size, prev_audio)));
+    }
+    sendUdpDatagram(client, *packed_msg);
   }
-} /* Reflector::udpDatagramReceived */
+  prev_audio.assign(audio, audio + audio_size);
+} /* Reflector::sendRedundantAudio */
 
 
-void Reflector::onTalkerUpdated(uint32_t tg, ReflectorClient* old_talker,
-                                ReflectorClient *new_talker)
+void Reflector::onTrunkAudio(ReflectorTrunk* trunk, uint32_t tg,
+                             const std::vector<uint8_t>& audio)
 {
-  if (old_talker != 0)
+  if (audio.empty() ||
+      !TGHandler::instance()->trunkTalkerAudio(tg, trunk->peerInstanceId()))
   {
-    cout << old_talker->callsign() << ": Talker stop on TG #" << tg << endl;
-    old_talker->updateIsTalker();
-    broadcastMsg(MsgTalkerStop(tg, old_talker->callsign()),
-        ReflectorClient::mkAndFilter(
-          ge_v2_client_filter,
-          ReflectorClient::mkOrFilter(
-            ReflectorClient::TgFilter(tg),
-            ReflectorClient::TgMonitorFilter(tg))));
+    return;
+  }
+  broadcastUdpMsgToTg(tg, MsgUdpAudio(audio),
+                      ReflectorClient::TranscodeFilter(""));
+  sendMonitorAudio(tg, nullptr, audio.data(), audio.size());
+  transcodeAudio(tg, audio.data(), audio.size());
+  TgAudioStats& stats = m_tg_audio_stats[tg];
+  stats.rx_bytes += audio.size();
+  stats.tx_bytes +=
+    TGHandler::instance()->clientsForTG(tg).size() * audio.size();
+} /* Reflector::onTrunkAudio */
+
+
+void Reflector::onTrunkTalkerUpdated(uint32_t tg,
+                                     const std::string& old_callsign,
+                                     const std::string& new_callsign)
+{
+  if (!old_callsign.empty())
+  {
+    cout << old_callsign << ": Trunk talker stop on TG #" << tg << endl;
+    broadcastMsgToTg(tg, MsgTalkerStop(tg, old_callsign),
+        ge_v2_client_filter, true);
     if (tg == tgForV1Clients())
     {
-      broadcastMsg(MsgTalkerStopV1(old_talker->callsign()), v1_client_filter);
+      broadcastMsg(MsgTalkerStopV1(old_callsign), v1_client_filter);
     }
-    broadcastUdpMsg(MsgUdpFlushSamples(),
-          ReflectorClient::mkAndFilter(
-            ReflectorClient::TgFilter(tg),
-            ReflectorClient::ExceptFilter(old_talker)));
+    broadcastUdpMsgToTg(tg, MsgUdpFlushSamples(),
+                        ReflectorClient::NoFilter());
   }
-  if (new_talker != 0)
+  if (!new_callsign.empty())
   {
-    cout << new_talker->callsign() << ": Talker start on TG #" << tg << endl;
-    new_talker->updateIsTalker();
-    broadcastMsg(MsgTalkerStart(tg, new_talker->callsign()),
-        ReflectorClient::mkAndFilter(
-          ge_v2_client_filter,
-          ReflectorClient::mkOrFilter(
-            ReflectorClient::TgFilter(tg),
-            ReflectorClient::TgMonitorFilter(tg))));
+    cout << new_callsign << ": Trunk talker start on TG #" << tg << endl;
+    broadcastMsgToTg(tg, MsgTalkerStart(tg, new_callsign),
+        ge_v2_client_filter, true);
     if (tg == tgForV1Clients())
     {
-      broadcastMsg(MsgTalkerStartV1(new_talker->callsign()), v1_client_filter);
+      broadcastMsg(MsgTalkerStartV1(new_callsign), v1_client_filter);
     }
   }
-} /* Reflector::onTalkerUpdated */
+} /* Reflector::onTrunkTalkerUpdated */
 
 
-void Reflector::httpRequestReceived(Async::HttpServerConnection *con,
-                                    Async::HttpServerConnection::Request& req)
+void Reflector::updateTrunkSubscriptions(void)
 {
-  //std::cout << "### " << req.method << " " << req.target << std::endl;
-
-  Async::HttpServerConnection::Response res;
-  if ((req.method != "GET") && (req.method != "HEAD"))
+  if (m_trunks.empty())
   {
-    res.setCode(501);
-    res.setContent("application/json",
-        "{\"msg\":\"" + req.method + ": Method not implemented\"}");
-    con->write(res);
     return;
   }
+  const std::set<uint32_t> tgs = TGHandler::instance()->activeTGs();
+  for (const auto& trunk : m_trunks)
+  {
+    trunk->setLocalTGs(tgs);
+  }
+} /* Reflector::updateTrunkSubscriptions */
+
 
-  if (req.target != "/status")
+void Reflector::syncClientTelemetry(void)
+{
+  for (auto& item : m_client_con_map)
   {
-    res.setCode(404);
-    res.setContent("application/json",
-        "{\"msg\":\"Not found!\"}");
-    con->write(res);
-    return;
+    item.second->syncRxTelemetry();
   }
+} /* Reflector::syncClientTelemetry */
 
-  std::ostringstream os;
-  Json::StreamWriterBuilder builder;
-  builder["commentStyle"] = "None";
-  builder["indentation"] = ""; //The JSON document is written on a single line
-  Json::StreamWriter* writer = builder.newStreamWriter();
-  writer->write(m_status, &os);
-  delete writer;
-
-  res.setContent("application/json", os.str());
-  res.setSendContent(req.method == "GET");
-  res.setCode(200);
-  con->write(res);
-} /* Reflector::requestReceived */
+
+Async::UdpSocket::RxStats Reflector::udpRxStats(void) const
+{
+  Async::UdpSocket::RxStats rx_stats;
+  for (const auto& sock : m_udp_socks)
+  {
+    const Async::UdpSocket::RxStats& sock_stats = sock->rxStats();
+    rx_stats.wakeups += sock_stats.wakeups;
+    rx_stats.datagrams += sock_stats.datagrams;
+    rx_stats.max_per_wakeup = std::max(rx_stats.max_per_wakeup,
+                                       sock_stats.max_per_wakeup);
+  }
+  return rx_stats;
+} /* Reflector::udpRxStats */
+
+
+void Reflector::updateUdpKernelDrops(void)
+{
+  uint64_t total = 0;
+  for (size_t i=0; i<m_udp_socks.size(); ++i)
+  {
+    uint64_t drops = 0;
+    if (m_udp_socks[i]->kernelDrops(drops))
+    {
+      m_udp_kernel_drops[i] = drops;
+    }
+    total += m_udp_kernel_drops[i];
+  }
+  m_udp_kernel_drops_total = total;
+} /* Reflector::updateUdpKernelDrops */
+
+
+Json::Value Reflector::udpRxStatus(void) const
+{
+  const Async::UdpSocket::RxStats rx_stats = udpRxStats();
+  Json::Value udp_rx(Json::objectValue);
+  udp_rx["wakeups"] = Json::UInt64(rx_stats.wakeups);
+  udp_rx["datagrams"] = Json::UInt64(rx_stats.datagrams);
+  udp_rx["maxPerWakeup"] = rx_stats.max_per_wakeup;
+  udp_rx["kernelDrops"] = Json::UInt64(m_udp_kernel_drops_total);
+  Json::Value& socks = udp_rx["sockets"] = Json::Value(Json::arrayValue);
+  for (size_t i=0; i<m_udp_socks.size(); ++i)
+  {
+    const Async::EncryptedUdpSocket* udp_sock = m_udp_socks[i];
+    Json::Value sock(Json::objectValue);
+    sock["datagrams"] = Json::UInt64(udp_sock->rxStats().datagrams);
+    sock["kernelDrops"] = Json::UInt64(m_udp_kernel_drops[i]);
+    sock["rcvbuf"] = udp_sock->rxBufferSize();
+    sock["sndbuf"] = udp_sock->txBufferSize();
+    socks.append(sock);
+  }
+  const ReflectorPackedUdpMsg::PoolStats& pool_stats =
+    ReflectorPackedUdpMsg::poolStats();
+  udp_rx["packedMsgs"] = Json::UInt64(pool_stats.packets);
+  udp_rx["bufferAllocs"] = Json::UInt64(pool_stats.allocations);
+  return udp_rx;
+} /* Reflector::udpRxStatus */
+
+
+Json::Value Reflector::udpTxStatus(void) const
+{
+  Json::Value udp_tx(Json::objectValue);
+  udp_tx["congested"] = m_udp_tx_congested;
+  Json::Value& nodes = udp_tx["nodes"] = Json::Value(Json::objectValue);
+  for (const auto& item : m_client_con_map)
+  {
+    const ReflectorClient* client = item.second;
+    if (client->callsign().empty())
+    {
+      continue;
+    }
+    Json::Value& node = nodes[client->callsign()];
+    node["stale"] = client->udpIsStale();
+    node["droppedStale"] = Json::UInt64(
+        client->udpTxDropCount(ReflectorClient::UDP_TX_DROP_STALE));
+    node["droppedCongested"] = Json::UInt64(
+        client->udpTxDropCount(ReflectorClient::UDP_TX_DROP_CONGESTED));
+  }
+  return udp_tx;
+} /* Reflector::udpTxStatus */
+
+
+Json::Value Reflector::tcpTxStatus(void) const
+{
+  Json::Value tcp_tx(Json::objectValue);
+  for (const auto& item : m_client_con_map)
+  {
+    const ReflectorClient* client = item.second;
+    if (client->callsign().empty())
+    {
+      continue;
+    }
+    Json::Value& node = tcp_tx[client->callsign()];
+    node["queueDepth"] = Json::UInt64(client->tcpTxQueueDepth());
+    node["queuedBytes"] = Json::UInt64(client->tcpTxQueueBytes());
+  }
+  return tcp_tx;
+} /* Reflector::tcpTxStatus */
+
+
+Json::Value Reflector::commandPtyStatus(void) const
+{
+  Json::Value cmd_pty(Json::objectValue);
+  if (m_cmd_pty == nullptr)
+  {
+    return cmd_pty;
+  }
+  const Pty::Stats& stats = m_cmd_pty->stats();
+  cmd_pty["rxBytes"] = Json::UInt64(stats.rx_bytes);
+  cmd_pty["rxLines"] = Json::UInt64(stats.rx_lines);
+  cmd_pty["txBytes"] = Json::UInt64(stats.tx_bytes);
+  cmd_pty["txDroppedBytes"] = Json::UInt64(stats.tx_dropped_bytes);
+  cmd_pty["txQueuedBytes"] = Json::UInt64(m_cmd_pty->txQueuedBytes());
+  return cmd_pty;
+} /* Reflector::commandPtyStatus */
+
+
+Json::Value Reflector::clientMemoryStatus(void) const
+{
+  size_t total = 0;
+  size_t max_bytes = 0;
+  for (const auto& item : m_client_con_map)
+  {
+    const size_t bytes = item.second->memoryUsage();
+    total += bytes;
+    max_bytes = std::max(max_bytes, bytes);
+  }
+  const size_t clients = m_client_con_map.size();
+  Json::Value mem(Json::objectValue);
+  mem["clients"] = Json::UInt64(clients);
+  mem["totalBytes"] = Json::UInt64(total);
+  mem["bytesPerClient"] = Json::UInt64((clients > 0) ? total / clients : 0);
+  mem["maxBytes"] = Json::UInt64(max_bytes);
+  return mem;
+} /* Reflector::clientMemoryStatus */
 
 
 void Reflector::httpClientConnected(Async::HttpServerConnection *con)
@@ -1402,10 +3132,7 @@ void Reflector::onRequestAutoQsy(uint32_t from_tg)
   std::cout << "Requesting auto-QSY from TG #" << from_tg
             << " to TG #" << tg << std::endl;
 
-  broadcastMsg(MsgRequestQsy(tg),
-      ReflectorClient::mkAndFilter(
-        ge_v2_client_filter,
-        ReflectorClient::TgFilter(from_tg)));
+  broadcastMsgToTg(from_tg, MsgRequestQsy(tg), ge_v2_client_filter);
 } /* Reflector::onRequestAutoQsy */
 
 
@@ -1537,21 +3264,29 @@ void Reflector::ctrlPtyDataReceived(const void *buf, size_t count)
                  "Usage: CA SIGN <callsign>";
         goto write_status;
       }
-      auto cert = signClientCsr(cn);
-      if (!cert.isNull())
-      {
-        m_cmd_pty->write("---------- Signed Client Certificate ----------\n");
-        m_cmd_pty->write(cert.toString());
-        m_cmd_pty->write("-----------------------------------------------\n");
-        std::cout << "---------- Signed Client Certificate ----------\n"
-                  << cert.toString()
-                  << "-----------------------------------------------"
-                  << std::endl;
-      }
-      else
-      {
-        errss << "Certificate signing failed";
-      }
+      signClientCsr(cn,
+          [this](Async::SslX509& cert)
+          {
+            if (cert.isNull())
+            {
+              std::cerr << "*** ERROR: Certificate signing failed"
+                        << std::endl;
+              m_cmd_pty->write("ERR:Certificate signing failed\n");
+              return;
+            }
+            m_cmd_pty->write(
+                "---------- Signed Client Certificate ----------\n");
+            m_cmd_pty->write(cert.toString());
+            m_cmd_pty->write(
+                "-----------------------------------------------\n");
+            std::cout << "---------- Signed Client Certificate ----------\n"
+                      << cert.toString()
+                      << "-----------------------------------------------"
+                      << std::endl;
+            m_cmd_pty->write("OK\n");
+          });
+        // The status is written when the signing has finished
+      return;
     }
     else if (subcmd == "RM")
     {
@@ -1602,13 +3337,34 @@ void Reflector::ctrlPtyDataReceived(const void *buf, size_t count)
       goto write_status;
     }
   }
+  else if (cmd == "USERDB")
+  {
+    std::string subcmd;
+    ss >> subcmd;
+    std::transform(subcmd.begin(), subcmd.end(), subcmd.begin(), ::toupper);
+    if (subcmd != "RELOAD")
+    {
+      errss << "Invalid USERDB PTY command '" << cmdline << "'. "
+               "Usage: USERDB RELOAD";
+      goto write_status;
+    }
+    if (!m_user_db->reload())
+    {
+      errss << "Failed to reload the user store";
+      goto write_status;
+    }
+    std::ostringstream os;
+    os << "Loaded " << m_user_db->size() << " users\n";
+    m_cmd_pty->write(os.str());
+  }
   else
   {
-    errss << "Valid commands are: CFG, NODE, CA\n"
+    errss << "Valid commands are: CFG, NODE, CA, USERDB\n"
           << "Usage:\n"
           << "CFG <section> <tag> <value>\n"
           << "NODE BLOCK <callsign> <blocktime seconds>\n"
           << "CA LS|LSC|LSP|SIGN <callsign>|RM <callsign>\n"
+          << "USERDB RELOAD\n"
           << "\nEmpty CFG lists all configuration";
   }
 
@@ -1633,9 +3389,21 @@ void Reflector::cfgUpdated(const std::string& section, const std::string& tag)
     return;
   }
 
-  if (section == "GLOBAL")
+  if ((section == "USERS") || (section == "PASSWORDS"))
+  {
+    m_user_db->invalidate();
+  }
+  else if (section == "GLOBAL")
   {
-    if (tag == "SQL_TIMEOUT_BLOCKTIME")
+    if (tag == "USER_DB_FILE")
+    {
+      m_user_db->invalidate();
+    }
+    else if ((tag == "ACCEPT_CALLSIGN") || (tag == "REJECT_CALLSIGN"))
+    {
+      compileCallsignPatterns();
+    }
+    else if (tag == "SQL_TIMEOUT_BLOCKTIME")
     {
       unsigned t = TGHandler::instance()->sqlTimeoutBlocktime();
       if (!SvxLink::setValueFromString(t, value))
@@ -1663,6 +3431,44 @@ void Reflector::cfgUpdated(const std::string& section, const std::string& tag)
 } /* Reflector::cfgUpdated */
 
 
+bool Reflector::compileCallsignPatterns(void)
+{
+  std::string accept_cs_re_str;
+  if (!m_cfg->getValue("GLOBAL", "ACCEPT_CALLSIGN", accept_cs_re_str) ||
+      accept_cs_re_str.empty())
+  {
+    accept_cs_re_str =
+      "[A-Z0-9][A-Z]{0,2}\\d[A-Z0-9]{0,3}[A-Z](?:-[A-Z0-9]{1,3})?";
+  }
+  std::string reject_cs_re_str;
+  m_cfg->getValue("GLOBAL", "REJECT_CALLSIGN", reject_cs_re_str);
+
+    // Compile both patterns before replacing the old ones so that an illegal
+    // pattern set at runtime leave the old patterns in use
+  std::regex accept_cs_re;
+  std::regex reject_cs_re;
+  try
+  {
+    accept_cs_re.assign(accept_cs_re_str, std::regex::optimize);
+    if (!reject_cs_re_str.empty())
+    {
+      reject_cs_re.assign(reject_cs_re_str, std::regex::optimize);
+    }
+  }
+  catch (const std::regex_error& e)
+  {
+    std::cerr << "*** ERROR: Illegal regular expression in configuration "
+                 "variable GLOBAL/ACCEPT_CALLSIGN or GLOBAL/REJECT_CALLSIGN: "
+              << e.what() << std::endl;
+    return false;
+  }
+  m_accept_cs_re = std::move(accept_cs_re);
+  m_reject_cs_re = std::move(reject_cs_re);
+  m_reject_cs_re_set = !reject_cs_re_str.empty();
+  return true;
+} /* Reflector::compileCallsignPatterns */
+
+
 bool Reflector::loadCertificateFiles(void)
 {
   if (!buildPath("GLOBAL", "CERT_PKI_DIR", SVX_LOCAL_STATE_DIR, m_pki_dir) ||
@@ -1681,6 +3487,13 @@ bool Reflector::loadCertificateFiles(void)
     return false;
   }
 
+  if (!ensureDirectoryExist(m_certs_dir + "/") ||
+      !ensureDirectoryExist(m_pending_csrs_dir + "/") ||
+      !m_cert_store.initialize(m_certs_dir, m_pending_csrs_dir))
+  {
+    return false;
+  }
+
   if (!m_cfg->getValue("GLOBAL", "CERT_CA_BUNDLE", m_ca_bundle_file))
   {
     m_ca_bundle_file = m_pki_dir + "/ca-bundle.crt";
@@ -2265,6 +4078,9 @@ bool Reflector::removeClientCertFiles(const std::string& cn)
     }
   }
 
+  m_cert_store.refreshCert(cn);
+  m_cert_store.refreshPendingCsr(cn);
+
   return success && (path_unlink_cnt > 0);
 } /* Reflector::removeClientCertFiles */
 
@@ -2313,40 +4129,28 @@ std::vector<CertInfo> Reflector::getAllCerts(void)
 {
   std::vector<CertInfo> certs;
 
-  DIR* dir = opendir(m_certs_dir.c_str());
-  if (dir != nullptr)
+  for (const auto& item : m_cert_store.certs())
   {
-    struct dirent* entry;
-    while ((entry = readdir(dir)) != nullptr)
+    const Async::SslX509& cert = item.second.cert;
+    if (cert.timeIsWithinRange() && callsignOk(item.first, false))
     {
-      std::string filename(entry->d_name);
-      if (filename.length() > 4 &&
-          filename.substr(filename.length() - 4) == ".crt")
-      {
-        std::string callsign = filename.substr(0, filename.length() - 4);
-        Async::SslX509 cert = loadClientCertificate(callsign);
-        if (!cert.isNull() && callsignOk(callsign, false))
-        {
-          CertInfo info;
-          info.callsign = cert.commonName();
-          info.is_signed = true;
-          info.valid_until = cert.notAfterLocaltimeString();
-          info.not_after = cert.notAfter();
-          info.received_time = 0;
-
-          certs.push_back(info);
-        }
-      }
+      CertInfo info;
+      info.callsign = cert.commonName();
+      info.is_signed = true;
+      info.valid_until = cert.notAfterLocaltimeString();
+      info.not_after = cert.notAfter();
+      info.received_time = 0;
+
+      certs.push_back(info);
     }
-    closedir(dir);
-
-    std::sort(certs.begin(), certs.end(),
-        [](const CertInfo& a, const CertInfo& b)
-        {
-          return a.callsign < b.callsign;
-        });
   }
 
+  std::sort(certs.begin(), certs.end(),
+      [](const CertInfo& a, const CertInfo& b)
+      {
+        return a.callsign < b.callsign;
+      });
+
   return certs;
 } /* Reflector::getAllCerts */
 
@@ -2355,64 +4159,39 @@ std::vector<CertInfo> Reflector::getAllPendingCSRs(void)
 {
   std::vector<CertInfo> certs;
 
-  DIR* dir = opendir(m_pending_csrs_dir.c_str());
-  if (dir != nullptr)
+  for (const auto& item : m_cert_store.pendingCsrs())
   {
-    struct dirent* entry;
-    while ((entry = readdir(dir)) != nullptr)
+    const Async::SslCertSigningReq& csr = item.second.csr;
+    CertInfo info;
+    info.callsign = csr.commonName();
+    info.is_signed = false;
+    info.valid_until = "";
+    info.not_after = 0;
+
+      // Extract email addresses, might be useful to contact user or
+      // check against a database
+    const auto san = csr.extensions().subjectAltName();
+    if (!san.isNull())
     {
-      std::string filename(entry->d_name);
-      if (filename.length() > 4 &&
-          filename.substr(filename.length() - 4) == ".csr")
-      {
-        std::string callsign = filename.substr(0, filename.length() - 4);
-        Async::SslCertSigningReq csr = loadClientPendingCsr(callsign);
-        if (!csr.isNull())
-        {
-          CertInfo info;
-          info.callsign = csr.commonName();
-          info.is_signed = false;
-          info.valid_until = "";
-          info.not_after = 0;
-
-            // Extract email addresses, might be useful to contact user or
-            // check against a database
-          const auto san = csr.extensions().subjectAltName();
-          if (!san.isNull())
-          {
-            san.forEach(
-                [&](int type, std::string value)
-                {
-                  info.emails.push_back(value);
-                },
-                GEN_EMAIL);
-          }
-
-            // Get file timestamp
-          std::string csr_path = m_pending_csrs_dir + "/" + callsign + ".csr";
-          struct stat st;
-          if (stat(csr_path.c_str(), &st) == 0)
+      san.forEach(
+          [&](int type, std::string value)
           {
-            info.received_time = st.st_mtime;
-          }
-          else
-          {
-            info.received_time = 0;
-          }
-
-          certs.push_back(info);
-        }
-      }
+            info.emails.push_back(value);
+          },
+          GEN_EMAIL);
     }
-    closedir(dir);
 
-    std::sort(certs.begin(), certs.end(),
-        [](const CertInfo& a, const CertInfo& b)
-        {
-          return a.callsign < b.callsign;
-        });
+    info.received_time = item.second.received_time;
+
+    certs.push_back(info);
   }
 
+  std::sort(certs.begin(), certs.end(),
+      [](const CertInfo& a, const CertInfo& b)
+      {
+        return a.callsign < b.callsign;
+      });
+
   return certs;
 } /* Reflector::getAllPendingCSRs */
 
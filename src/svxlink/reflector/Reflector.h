@@ -37,8 +37,12 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 #include <sigc++/sigc++.h>
 #include <sys/time.h>
 #include <vector>
+#include <map>
+#include <set>
 #include <string>
+#include <vector>
 #include <json/json.h>
+#include <regex>
 
 
 /****************************************************************************
@@ -63,6 +67,8 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 
 #include "ProtoVer.h"
 #include "ReflectorClient.h"
+#include "AudioTraceStats.h"
+#include "CertStore.h"
 
 
 /****************************************************************************
@@ -76,10 +82,22 @@ namespace Async
   class EncryptedUdpSocket;
   class Config;
   class Pty;
+  class WorkerPool;
 };
 
 class ReflectorMsg;
 class ReflectorUdpMsg;
+class UdpFanoutEncryptor;
+class TGMixer;
+class TGTranscoder;
+class ReflectorTrunk;
+class ReflectorUserDb;
+
+namespace SvxLink
+{
+  class MetricCounter;
+  class MetricHistogram;
+};
 
 
 /****************************************************************************
@@ -173,6 +191,35 @@ class Reflector : public sigc::trackable
      */
     void nodeList(std::vector<std::string>& nodes) const;
 
+    /**
+     * @brief   Return a list of the nodes that have selected some talk groups
+     * @param   nodes The vector to return the result in
+     * @param   tgs   The talk groups to list the nodes for
+     */
+    void nodeList(std::vector<std::string>& nodes,
+                  const std::set<uint32_t>& tgs) const;
+
+    /**
+     * @brief   Get the node membership version
+     * @return  Returns a counter that is increased on each membership change
+     */
+    uint32_t nodeListVersion(void) const { return m_node_list_ver; }
+
+    /**
+     * @brief   Tell other clients that a node has logged in
+     * @param   client The client that logged in
+     */
+    void nodeJoined(ReflectorClient* client);
+
+    /**
+     * @brief   Tell other clients that a node has switched talk group
+     * @param   client  The client that switched talk group
+     * @param   old_tg  The talk group that was selected before
+     * @param   new_tg  The talk group that is selected now
+     */
+    void nodeTgChanged(ReflectorClient* client, uint32_t old_tg,
+                       uint32_t new_tg);
+
     /**
      * @brief   Broadcast a TCP message to connected clients
      * @param   msg The message to broadcast
@@ -194,9 +241,56 @@ class Reflector : public sigc::trackable
      */
     bool sendUdpDatagram(ReflectorClient *client, const ReflectorUdpMsg& msg);
 
+    /**
+     * @brief   Send an already packed UDP message to the specified client
+     * @param   client The client to the send datagram to
+     * @param   msg The packed message to send
+     * @return  Returns \em true on success or else \em false
+     */
+    bool sendUdpDatagram(ReflectorClient *client,
+                         const ReflectorPackedUdpMsg& msg);
+
     void broadcastUdpMsg(const ReflectorUdpMsg& msg,
         const ReflectorClient::Filter& filter=ReflectorClient::NoFilter());
 
+    /**
+     * @brief   Broadcast a TCP message to the clients of a talk group
+     * @param   tg The talk group to send the message to
+     * @param   msg The message to broadcast
+     * @param   filter The client filter to apply
+     * @param   include_monitors Also send to clients monitoring the TG
+     *
+     * Unlike broadcastMsg this function only visits the clients that have
+     * selected (and optionally monitor) the given talk group, using the
+     * subscriber index maintained by the TGHandler.
+     */
+    void broadcastMsgToTg(uint32_t tg, const ReflectorMsg& msg,
+        const ReflectorClient::Filter& filter=ReflectorClient::NoFilter(),
+        bool include_monitors=false);
+
+    /**
+     * @brief   Broadcast a UDP message to the clients of a talk group
+     * @param   tg The talk group to send the message to
+     * @param   msg The message to broadcast
+     * @param   filter The client filter to apply
+     *
+     * Only the clients that have selected the given talk group are visited so
+     * the cost is proportional to the number of subscribers of the TG rather
+     * than to the total number of connected clients.
+     */
+    void broadcastUdpMsgToTg(uint32_t tg, const ReflectorUdpMsg& msg,
+        const ReflectorClient::Filter& filter=ReflectorClient::NoFilter());
+
+    /**
+     * @brief   Broadcast an already packed UDP message to a talk group
+     * @param   tg The talk group to send the message to
+     * @param   packed_msg The packed message to broadcast
+     * @param   filter The client filter to apply
+     */
+    void broadcastUdpMsgToTg(uint32_t tg,
+        const ReflectorPackedUdpMsg& packed_msg,
+        const ReflectorClient::Filter& filter=ReflectorClient::NoFilter());
+
     /**
      * @brief   Get the TG for protocol V1 clients
      * @return  Returns the TG used for protocol V1 clients
@@ -216,9 +310,42 @@ class Reflector : public sigc::trackable
 
     Async::SslCertSigningReq loadClientPendingCsr(const std::string& callsign);
     Async::SslCertSigningReq loadClientCsr(const std::string& callsign);
-    bool renewedClientCert(Async::SslX509& cert);
-    bool signClientCert(Async::SslX509& cert, const std::string& ca_op);
-    Async::SslX509 signClientCsr(const std::string& cn);
+
+    /**
+     * @brief   A slot called when a certificate signing operation is done
+     * @param   cert The signed certificate or a null object on failure
+     */
+    using CertSignedSlot = sigc::slot<void(Async::SslX509&)>;
+
+    /**
+     * @brief   Get a renewed client certificate
+     * @param   cert The current client certificate
+     * @param   done Called with the renewed certificate when available
+     *
+     * If the certificate need to be signed again, the signing is done in the
+     * crypto worker pool so the slot may be called after this function has
+     * returned.
+     */
+    void renewedClientCert(Async::SslX509&& cert, const CertSignedSlot& done);
+
+    /**
+     * @brief   Sign a client certificate using the issuing CA
+     * @param   cert  The certificate to sign
+     * @param   ca_op The CA operation to report to the CA hook
+     * @param   done  Called with the signed certificate when done
+     *
+     * The signing is done in the crypto worker pool, if configured, so the
+     * slot may be called after this function has returned.
+     */
+    void signClientCert(Async::SslX509&& cert, const std::string& ca_op,
+                        const CertSignedSlot& done);
+
+    /**
+     * @brief   Sign a pending client CSR
+     * @param   cn    The common name (callsign) of the CSR to sign
+     * @param   done  Called with the signed certificate when done
+     */
+    void signClientCsr(const std::string& cn, const CertSignedSlot& done);
     Async::SslX509 loadClientCertificate(const std::string& callsign);
 
     size_t caSize(void) const { return m_ca_size; }
@@ -228,6 +355,12 @@ class Reflector : public sigc::trackable
     std::string caBundlePem(void) const;
     std::string issuingCertPem(void) const;
     bool callsignOk(const std::string& callsign, bool verbose=true) const;
+
+    /**
+     * @brief   Get the user credential store
+     * @return  Returns the user store
+     */
+    ReflectorUserDb& userDb(void) { return *m_user_db; }
     bool reqEmailOk(const Async::SslCertSigningReq& req) const;
     bool emailOk(const std::string& email) const;
     std::string checkCsr(const Async::SslCertSigningReq& req);
@@ -235,6 +368,17 @@ class Reflector : public sigc::trackable
 
     Json::Value& clientStatus(const std::string& callsign);
 
+    /**
+     * @brief   Tell the reflector that the status of a node has changed
+     * @param   callsign The callsign of the node
+     *
+     * This function must be called after the JSON object returned by the
+     * clientStatus function has been modified. It will invalidate the cached
+     * HTTP status document and record the change so that it is included in
+     * the next status delta.
+     */
+    void clientStatusUpdated(const std::string& callsign);
+
   protected:
 
   private:
@@ -247,10 +391,42 @@ class Reflector : public sigc::trackable
     static constexpr unsigned ISSUING_CA_VALIDITY_DAYS  = 4*90;
     static constexpr unsigned CERT_VALIDITY_DAYS        = 90;
     static constexpr int      CERT_VALIDITY_OFFSET_DAYS = -1;
+    static constexpr unsigned UDP_RX_BATCH_SIZE         = 16;
+    static constexpr size_t   UDP_FANOUT_MIN_CLIENTS    = 16;
+    static constexpr size_t   STATUS_MAX_REMOVED_NODES  = 256;
+    static constexpr unsigned TG_AUDIO_STATS_IDLE_LIMIT = 60;
+    static constexpr size_t   VERIFIED_PEER_CACHE_SIZE  = 10000;
+    static constexpr size_t   UDP_CIPHER_CACHE_SIZE     = 16384;
+    static constexpr unsigned UDP_SOCKETS_MAX           = 64;
+
+    struct TgAudioStats
+    {
+      uint64_t  rx_bytes        = 0;
+      uint64_t  tx_bytes        = 0;
+      uint64_t  prev_rx_bytes   = 0;
+      uint64_t  prev_tx_bytes   = 0;
+      uint64_t  rx_rate         = 0;
+      uint64_t  tx_rate         = 0;
+      unsigned  idle_cnt        = 0;
+    };
+    using TgAudioStatsMap = std::map<uint32_t, TgAudioStats>;
+    using TgMixerMap = std::map<uint32_t, TGMixer*>;
+    using TgPrevAudioMap = std::map<uint32_t, std::vector<uint8_t>>;
+    using TgTranscoderMap = std::map<uint32_t, TGTranscoder*>;
+    using TrunkList = std::vector<ReflectorTrunk*>;
+    using TrunkPendingConMap = std::map<Async::FramedTcpConnection*,
+                                        sigc::connection>;
 
     FramedTcpServer*            m_srv;
     Async::EncryptedUdpSocket*  m_udp_sock;
+    std::vector<Async::EncryptedUdpSocket*> m_udp_socks;
+    std::vector<uint64_t>       m_udp_kernel_drops;
+    uint64_t                    m_udp_kernel_drops_total = 0;
     ReflectorClientConMap       m_client_con_map;
+    std::vector<uint8_t>        m_udp_tx_buf;
+    std::vector<uint8_t>        m_udp_iv_buf;
+    UdpFanoutEncryptor*         m_udp_fanout_encryptor = nullptr;
+    Async::WorkerPool*          m_crypto_pool = nullptr;
     Async::Config*              m_cfg;
     uint32_t                    m_tg_for_v1_clients;
     uint32_t                    m_random_qsy_lo;
@@ -263,6 +439,7 @@ class Reflector : public sigc::trackable
     std::string                 m_pending_csrs_dir;
     std::string                 m_csrs_dir;
     std::string                 m_certs_dir;
+    CertStore                   m_cert_store;
     UdpCipher::AAD              m_aad;
     Async::SslKeypair           m_ca_pkey;
     Async::SslX509              m_ca_cert;
@@ -278,6 +455,34 @@ class Reflector : public sigc::trackable
     std::vector<uint8_t>        m_ca_sig;
     std::string                 m_accept_cert_email;
     Json::Value                 m_status;
+    uint64_t                    m_status_ver = 1;
+    std::map<std::string, uint64_t> m_status_node_ver;
+    std::map<std::string, uint64_t> m_status_removed_ver;
+    uint64_t                    m_status_removed_floor = 0;
+    uint32_t                    m_node_list_ver = 0;
+    std::string                 m_status_nodes_json;
+    bool                        m_status_dirty = true;
+    TgAudioStatsMap             m_tg_audio_stats;
+    uint64_t                    m_tg_audio_stats_ver = 0;
+    Async::Timer                m_tg_audio_stats_timer;
+    AudioTraceStats             m_audio_trace_stats;
+    TgMixerMap                  m_tg_mixers;
+    TgPrevAudioMap              m_tg_prev_audio;
+    TgTranscoderMap             m_tg_transcoders;
+    bool                        m_udp_tx_congested = false;
+    uint64_t                    m_udp_tx_drops = 0;
+    SvxLink::MetricCounter*     m_metric_udp_rx_bytes       = nullptr;
+    SvxLink::MetricCounter*     m_metric_udp_tx_datagrams   = nullptr;
+    SvxLink::MetricCounter*     m_metric_udp_tx_bytes       = nullptr;
+    SvxLink::MetricHistogram*   m_metric_fanout_time        = nullptr;
+    SvxLink::MetricHistogram*   m_metric_encrypt_time       = nullptr;
+    TrunkList                   m_trunks;
+    FramedTcpServer*            m_trunk_srv = nullptr;
+    TrunkPendingConMap          m_trunk_pending_cons;
+    ReflectorUserDb*            m_user_db = nullptr;
+    std::regex                  m_accept_cs_re;
+    std::regex                  m_reject_cs_re;
+    bool                        m_reject_cs_re_set = false;
 
     Reflector(const Reflector&);
     Reflector& operator=(const Reflector&);
@@ -285,13 +490,67 @@ class Reflector : public sigc::trackable
     void clientDisconnected(Async::FramedTcpConnection *con,
                             Async::FramedTcpConnection::DisconnectReason reason);
     bool udpCipherDataReceived(const Async::IpAddress& addr, uint16_t port,
-                               void *buf, int count);
+                               void *buf, int count,
+                               Async::EncryptedUdpSocket* sock);
     void udpDatagramReceived(const Async::IpAddress& addr, uint16_t port,
-                             void* aad, void *buf, int count);
+                             void* aad, void *buf, int count,
+                             Async::EncryptedUdpSocket* sock);
+    Async::UdpSocket::RxStats udpRxStats(void) const;
+    void updateUdpKernelDrops(void);
     void onTalkerUpdated(uint32_t tg, ReflectorClient* old_talker,
                          ReflectorClient *new_talker);
     void httpRequestReceived(Async::HttpServerConnection *con,
                              Async::HttpServerConnection::Request& req);
+    void httpStatusRequest(Async::HttpServerConnection *con,
+                           Async::HttpServerConnection::Request& req);
+    void httpStatusDeltaRequest(Async::HttpServerConnection *con,
+                                Async::HttpServerConnection::Request& req,
+                                const std::string& query);
+    void httpMetricsRequest(Async::HttpServerConnection *con,
+                            Async::HttpServerConnection::Request& req);
+    void initMetrics(void);
+    void collectMetrics(void);
+    Json::Value udpRxStatus(void) const;
+    Json::Value tcpTxStatus(void) const;
+    Json::Value udpTxStatus(void) const;
+    Json::Value clientMemoryStatus(void) const;
+    Json::Value commandPtyStatus(void) const;
+    void syncClientTelemetry(void);
+    void updateTgAudioStats(void);
+    Json::Value tgAudioStatus(void) const;
+    void handleAudioTrace(ReflectorClient* client, MsgUdpAudioTrace& msg);
+    TGMixer* tgMixer(uint32_t tg, const ReflectorClient* client);
+    void onMixedAudio(ReflectorClient* to, const void* buf, int size,
+                      uint32_t tg);
+    void onMixFlushed(ReflectorClient* to, uint32_t tg);
+    void cleanupTgMixers(void);
+    bool isConferenceTg(uint32_t tg) const;
+    void transcodeAudio(uint32_t tg, const void* audio, size_t audio_size);
+    void onTranscodedAudio(const std::string& profile, const void* buf,
+                           int size, uint32_t tg);
+    void flushTranscoder(uint32_t tg);
+    void cleanupTgTranscoders(void);
+    bool initTrunks(void);
+    void trunkClientConnected(Async::FramedTcpConnection *con);
+    void trunkClientDisconnected(Async::FramedTcpConnection *con,
+        Async::FramedTcpConnection::DisconnectReason reason);
+    void trunkHelloReceived(Async::FramedTcpConnection *con,
+                            std::vector<uint8_t>& data);
+    void onTrunkStateChanged(ReflectorTrunk* trunk, bool is_up);
+    void onTrunkTalkerStart(ReflectorTrunk* trunk, uint32_t tg,
+                            const std::string& callsign);
+    void onTrunkTalkerStop(ReflectorTrunk* trunk, uint32_t tg);
+    void udpSendBufferFull(bool is_full);
+    bool udpTxAllowed(ReflectorClient* client);
+    void sendMonitorAudio(uint32_t tg, const ReflectorClient* talker,
+                          const uint8_t* audio, size_t audio_size);
+    void sendRedundantAudio(uint32_t tg, const ReflectorClient* talker,
+                            const uint8_t* audio, size_t audio_size);
+    void onTrunkAudio(ReflectorTrunk* trunk, uint32_t tg,
+                      const std::vector<uint8_t>& audio);
+    void onTrunkTalkerUpdated(uint32_t tg, const std::string& old_callsign,
+                              const std::string& new_callsign);
+    void updateTrunkSubscriptions(void);
     void httpClientConnected(Async::HttpServerConnection *con);
     void httpClientDisconnected(Async::HttpServerConnection *con,
         Async::HttpServerConnection::DisconnectReason reason);
@@ -299,6 +558,7 @@ class Reflector : public sigc::trackable
     uint32_t nextRandomQsyTg(void);
     void ctrlPtyDataReceived(const void *buf, size_t count);
     void cfgUpdated(const std::string& section, const std::string& tag);
+    bool compileCallsignPatterns(void);
     bool loadCertificateFiles(void);
     bool loadServerCertificateFiles(void);
     bool generateKeyFile(Async::SslKeypair& pkey, const std::string& keyfile);
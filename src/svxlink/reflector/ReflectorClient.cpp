@@ -6,7 +6,7 @@
 
 \verbatim
 SvxReflector - An audio reflector for connecting SvxLink Servers
-Copyright (C) 2003-2025 Tobias Blomberg / SM0SVX
+Copyright (C) 2003-2026 Tobias Blomberg / SM0SVX
 
 This program is free software; you can redistribute it and/or modify
 it under the terms of the GNU General Public License as published by
@@ -38,6 +38,9 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 #include <cerrno>
 #include <ctime>
 #include <iterator>
+#include <memory>
+#include <cmath>
+#include <set>
 
 
 /****************************************************************************
@@ -63,6 +66,8 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 #include "ReflectorClient.h"
 #include "Reflector.h"
 #include "TGHandler.h"
+#include "ReflectorUserDb.h"
+#include "TGTranscoder.h"
 
 
 /****************************************************************************
@@ -123,6 +128,10 @@ std::mt19937 ReflectorClient::id_gen(std::random_device{}());
 ReflectorClient::ClientIdRandomDist ReflectorClient::id_dist(
     CLIENT_ID_MIN, CLIENT_ID_MAX);
 
+  // The Opus frame sizes, in tenths of a millisecond
+const uint16_t ReflectorClient::AUDIO_FRAME_SIZES[] =
+  { 25, 50, 100, 200, 400, 600, 0 };
+
 
 /****************************************************************************
  *
@@ -194,13 +203,15 @@ ReflectorClient::ReflectorClient(Reflector *ref, Async::FramedTcpConnection *con
     m_udp_heartbeat_tx_cnt(UDP_HEARTBEAT_TX_CNT_RESET),
     m_udp_heartbeat_rx_cnt(UDP_HEARTBEAT_RX_CNT_RESET),
     m_reflector(ref), m_blocktime(0), m_remaining_blocktime(0),
-    m_current_tg(0), m_udp_cipher_iv_cntr(0)
+    m_current_tg(0), m_udp_cipher_iv_cntr(0),
+    m_udp_cipher(Async::EncryptedUdpSocket::fetchCipher(UdpCipher::NAME))
 {
+  m_con->setRecvBufLen(RECV_BUF_LEN);
   m_con->setMaxRxFrameSize(ReflectorMsg::MAX_PREAUTH_FRAME_SIZE);
   m_con->setMaxTxFrameSize(ReflectorMsg::MAX_POSTAUTH_FRAME_SIZE);
   m_con->sslConnectionReady.connect(
       sigc::mem_fun(*this, &ReflectorClient::onSslConnectionReady));
-  m_con->frameReceived.connect(
+  m_con->frameDataReceived.connect(
       sigc::mem_fun(*this, &ReflectorClient::onFrameReceived));
   m_disc_timer.expired.connect(
       sigc::mem_fun(*this, &ReflectorClient::onDiscTimeout));
@@ -209,6 +220,9 @@ ReflectorClient::ReflectorClient(Reflector *ref, Async::FramedTcpConnection *con
   m_renew_cert_timer.expired.connect(sigc::hide(
       sigc::mem_fun(*this, &ReflectorClient::renewClientCertificate)));
 
+  m_udp_stale_timeout = DEFAULT_UDP_STALE_TIMEOUT;
+  m_cfg->getValue("GLOBAL", "UDP_STALE_TIMEOUT", m_udp_stale_timeout);
+
   string codecs;
   if (m_cfg->getValue("GLOBAL", "CODECS", codecs))
   {
@@ -267,32 +281,48 @@ void ReflectorClient::setRemoteUdpSource(const ReflectorClient::ClientSrc& src)
 } /* ReflectorClient::setRemoteUdpSource */
 
 
+Async::TcpConnection::SharedBuffer ReflectorClient::packMsg(
+    const ReflectorMsg& msg)
+{
+  ReflectorMsg header(msg.type());
+  auto buf = std::make_shared<std::vector<uint8_t>>(
+      header.packedSize() + msg.packedSize());
+  Async::MsgBufWriter w(buf->data(), buf->size());
+  if (!header.pack(w) || !msg.pack(w))
+  {
+    cerr << "*** ERROR: Failed to pack TCP message\n";
+    return nullptr;
+  }
+  buf->resize(w.size());
+  return buf;
+} /* ReflectorClient::packMsg */
+
+
 int ReflectorClient::sendMsg(const ReflectorMsg& msg)
+{
+  return sendPackedMsg(msg.type(), packMsg(msg));
+} /* ReflectorClient::sendMsg */
+
+
+int ReflectorClient::sendPackedMsg(uint16_t type,
+                                   const Async::TcpConnection::SharedBuffer& buf)
 {
   errno = 0;
 
-  if (((m_con_state != STATE_CONNECTED) && (msg.type() >= 100)) ||
+  if (((m_con_state != STATE_CONNECTED) && (type >= 100)) ||
       !m_con->isConnected())
   {
     errno = ENOTCONN;
   }
-
-  ostringstream ss;
-  if (errno == 0)
+  else if (buf == nullptr)
   {
-    m_heartbeat_tx_cnt = HEARTBEAT_TX_CNT_RESET;
-
-    ReflectorMsg header(msg.type());
-    if (!header.pack(ss) || !msg.pack(ss))
-    {
-      cerr << "*** ERROR: Failed to pack TCP message\n";
-      errno = EBADMSG;
-    }
+    errno = EBADMSG;
   }
 
   if (errno == 0)
   {
-    auto ret = m_con->write(ss.str().data(), ss.str().size());
+    m_heartbeat_tx_cnt = HEARTBEAT_TX_CNT_RESET;
+    auto ret = m_con->write(buf);
     if (ret >= 0)
     {
       return ret;
@@ -300,32 +330,97 @@ int ReflectorClient::sendMsg(const ReflectorMsg& msg)
   }
   std::cerr << "*** ERROR[" << m_con->remoteHost() << ":"
             << m_con->remotePort() << "]: Write to client failed due to '"
-            << strerror(errno) << "'. Message type=" << msg.type() << "."
+            << strerror(errno) << "'. Message type=" << type << "."
             << std::endl;
   disconnect();
   return -1;
-} /* ReflectorClient::sendMsg */
+} /* ReflectorClient::sendPackedMsg */
 
 
 void ReflectorClient::udpMsgReceived(const ReflectorUdpMsg &header)
 {
   m_udp_heartbeat_rx_cnt = UDP_HEARTBEAT_RX_CNT_RESET;
+  if (m_udp_keepalive_interval > 0)
+  {
+      // The UDP datagrams are authenticated so they prove that the client is
+      // alive. The TCP connection is therefore not checked separately.
+    m_heartbeat_rx_cnt = heartbeatRxCntReset();
+  }
 
   if ((m_blocktime > 0) && (header.type() == MsgUdpAudio::TYPE))
   {
     m_remaining_blocktime = m_blocktime;
   }
+
+  if (header.type() == MsgUdpAudio::TYPE)
+  {
+      // Audio packets are sent at a fixed rate during a transmission so the
+      // variation of the time between two packets tell how much jitter
+      // there is. Gaps longer than a second are taken as a new transmission.
+    const auto now = std::chrono::steady_clock::now();
+    const double interval =
+      std::chrono::duration<double>(now - m_udp_audio_rx_time).count();
+    if ((m_udp_audio_rx_interval >= 0.0) && (interval < 1.0))
+    {
+      const double d = std::fabs(interval - m_udp_audio_rx_interval);
+      m_udp_rx_jitter += (d - m_udp_rx_jitter) / 16.0;
+    }
+    m_udp_audio_rx_interval = (interval < 1.0) ? interval : -1.0;
+    m_udp_audio_rx_time = now;
+  }
 } /* ReflectorClient::udpMsgReceived */
 
 
+void ReflectorClient::udpKeepaliveReceived(const MsgUdpKeepalive& msg)
+{
+  if (m_udp_keepalive_interval == 0)
+  {
+    return;
+  }
+
+    // Only log when the reported TG start or stop differing from the
+    // selected one since a keepalive is received every few seconds
+  bool tg_mismatch = (msg.tg() != m_current_tg);
+  if (tg_mismatch && !m_udp_keepalive_tg_mismatch)
+  {
+    std::cerr << "*** WARNING[" << callsign() << "]: The client report TG #"
+              << msg.tg() << " in a keepalive but TG #" << m_current_tg
+              << " is selected" << std::endl;
+  }
+  else if (!tg_mismatch && m_udp_keepalive_tg_mismatch)
+  {
+    std::cout << callsign() << ": The TG reported in keepalives now match "
+                 "the selected TG #" << m_current_tg << std::endl;
+  }
+  m_udp_keepalive_tg_mismatch = tg_mismatch;
+
+  if ((msg.flags() != m_udp_keepalive_flags) && (m_status != nullptr))
+  {
+    Json::Value& keepalive = (*m_status)["udpKeepalive"];
+    keepalive["talking"] = msg.talking();
+    keepalive["receiving"] = msg.receiving();
+    statusUpdated();
+  }
+  m_udp_keepalive_flags = msg.flags();
+
+  sendUdpMsg(MsgUdpKeepalive(m_current_tg, false, false));
+} /* ReflectorClient::udpKeepaliveReceived */
+
+
 void ReflectorClient::sendUdpMsg(const ReflectorUdpMsg &msg)
+{
+  sendUdpMsg(ReflectorPackedUdpMsg(msg));
+} /* ReflectorClient::sendUdpMsg */
+
+
+void ReflectorClient::sendUdpMsg(const ReflectorPackedUdpMsg &msg)
 {
   if (remoteUdpPort() == 0)
   {
     return;
   }
 
-  m_udp_heartbeat_tx_cnt = UDP_HEARTBEAT_TX_CNT_RESET;
+  udpMsgSent();
 
   (void)m_reflector->sendUdpDatagram(this, msg);
 } /* ReflectorClient::sendUdpMsg */
@@ -352,20 +447,117 @@ void ReflectorClient::updateIsTalker(void)
   if (m_status != nullptr)
   {
     auto talker = TGHandler::instance()->talkerForTG(m_current_tg);
-    (*m_status)["isTalker"] = (
-        TGHandler::instance()->showActivity(m_current_tg) &&
-        (talker == this)
-        );
+    const bool is_talker = TGHandler::instance()->showActivity(m_current_tg) &&
+                           (talker == this);
+    Json::Value& status_is_talker = (*m_status)["isTalker"];
+    if (status_is_talker != Json::Value(is_talker))
+    {
+      status_is_talker = is_talker;
+      statusUpdated();
+    }
   }
 } /* ReflectorClient:;updateIsTalker */
 
 
-std::vector<uint8_t> ReflectorClient::udpCipherIV(void) const
+const Json::Value* ReflectorClient::audioStats(void) const
+{
+  if ((m_status == nullptr) || !m_status->isMember("audioStats"))
+  {
+    return nullptr;
+  }
+  return &(*m_status)["audioStats"];
+} /* ReflectorClient::audioStats */
+
+
+void ReflectorClient::udpCipherIV(std::vector<uint8_t>& iv) const
 {
-  return UdpCipher::IV{udpCipherIVRand(), 0, m_udp_cipher_iv_cntr};
+  UdpCipher::IV{udpCipherIVRand(), 0, m_udp_cipher_iv_cntr}.assignTo(iv);
 } /* ReflectorClient::udpCipherIV */
 
 
+void ReflectorClient::setRxSignalStrengthValues(
+    const MsgSignalStrengthValuesBase::Rxs& rxs)
+{
+  bool changed = false;
+  for (const auto& rx : rxs)
+  {
+    //std::cout << "### MsgSignalStrengthValues:"
+    //  << " id=" << rx.id()
+    //  << " siglev=" << rx.siglev()
+    //  << " enabled=" << rx.enabled()
+    //  << " sql_open=" << rx.sqlOpen()
+    //  << " active=" << rx.active()
+    //  << std::endl;
+    uint8_t flags = MsgRxTelemetry::flags(rx.enabled(), rx.sqlOpen(),
+                                          rx.active());
+    changed |= storeRxTelemetry(rx.id(), rx.siglev(), flags, 0);
+  }
+  if (changed)
+  {
+    statusUpdated();
+  }
+} /* ReflectorClient::setRxSignalStrengthValues */
+
+
+void ReflectorClient::setTxTransmit(char id, bool transmit)
+{
+  auto it = std::find_if(m_tx_status.begin(), m_tx_status.end(),
+                         [id](const TxStatus& tx) { return tx.id == id; });
+  if ((it != m_tx_status.end()) && (it->transmit != transmit))
+  {
+    it->transmit = transmit;
+    (*it->json)["transmit"] = transmit;
+    statusUpdated();
+  }
+} /* ReflectorClient::setTxTransmit */
+
+
+size_t ReflectorClient::memoryUsage(void) const
+{
+  size_t bytes = sizeof(*this) + sizeof(*m_con);
+  bytes += m_con->recvBufLen() + m_con->rxFrameBufLen() +
+           m_con->writeQueueBytes();
+  bytes += m_callsign.capacity();
+  for (const auto& codec : m_supported_codecs)
+  {
+    bytes += sizeof(codec) + codec.capacity();
+  }
+    // Estimate the size of a set node to four pointers plus the value
+  bytes += m_monitored_tgs.size() * (4 * sizeof(void*) + sizeof(uint32_t));
+  bytes += m_udp_cipher_iv_rand.capacity() + m_udp_cipher_key.capacity();
+  bytes += m_rx_telemetry.capacity() * sizeof(RxTelemetry);
+  bytes += m_tx_status.capacity() * sizeof(TxStatus);
+  return bytes;
+} /* ReflectorClient::memoryUsage */
+
+
+void ReflectorClient::syncRxTelemetry(void)
+{
+  if (!m_rx_telemetry_dirty)
+  {
+    return;
+  }
+  m_rx_telemetry_dirty = false;
+  for (auto& rx : m_rx_telemetry)
+  {
+    if (!rx.dirty)
+    {
+      continue;
+    }
+    rx.dirty = false;
+    Json::Value& json = *rx.json;
+    json["siglev"] = rx.siglev;
+    json["enabled"] = (rx.flags & MsgRxTelemetry::FLAG_ENABLED) != 0;
+    json["sql_open"] = (rx.flags & MsgRxTelemetry::FLAG_SQL_OPEN) != 0;
+    json["active"] = (rx.flags & MsgRxTelemetry::FLAG_ACTIVE) != 0;
+    if (rx.timestamp != 0)
+    {
+      json["ts"] = Json::UInt64(rx.timestamp);
+    }
+  }
+} /* ReflectorClient::syncRxTelemetry */
+
+
 void ReflectorClient::certificateUpdated(Async::SslX509& cert)
 {
   if (m_con_state == STATE_CONNECTED)
@@ -477,7 +669,7 @@ void ReflectorClient::onSslConnectionReady(TcpConnection *con)
 
 
 void ReflectorClient::onFrameReceived(FramedTcpConnection *con,
-                                      std::vector<uint8_t>& data)
+                                      const uint8_t* data, size_t len)
 {
   if ((m_con_state == STATE_DISCONNECTED) ||
       (m_con_state == STATE_EXPECT_DISCONNECT))
@@ -485,11 +677,7 @@ void ReflectorClient::onFrameReceived(FramedTcpConnection *con,
     return;
   }
 
-  int len = data.size();
-  assert(len >= 0);
-  auto buf = reinterpret_cast<const char*>(data.data());
-  stringstream ss;
-  ss.write(buf, len);
+  FramedTcpConnection::FrameIStream ss(data, len);
 
   std::stringstream idss;
   if (m_callsign.empty())
@@ -524,7 +712,7 @@ void ReflectorClient::onFrameReceived(FramedTcpConnection *con,
     return;
   }
 
-  m_heartbeat_rx_cnt = HEARTBEAT_RX_CNT_RESET;
+  m_heartbeat_rx_cnt = heartbeatRxCntReset();
 
   switch (header.type())
   {
@@ -560,6 +748,30 @@ void ReflectorClient::onFrameReceived(FramedTcpConnection *con,
     case MsgTxStatus::TYPE:
       handleMsgTxStatus(ss);
       break;
+    case MsgRxTelemetry::TYPE:
+      handleMsgRxTelemetry(ss);
+      break;
+    case MsgAudioParams::TYPE:
+      handleMsgAudioParams(ss);
+      break;
+    case MsgUdpCipher::TYPE:
+      handleMsgUdpCipher(ss);
+      break;
+    case MsgMonitorAudio::TYPE:
+      handleMsgMonitorAudio(ss);
+      break;
+    case MsgAudioRedundancy::TYPE:
+      handleMsgAudioRedundancy(ss);
+      break;
+    case MsgAudioTranscode::TYPE:
+      handleMsgAudioTranscode(ss);
+      break;
+    case MsgUdpKeepaliveInterval::TYPE:
+      handleMsgUdpKeepaliveInterval(ss);
+      break;
+    case MsgNodeListSubscribe::TYPE:
+      handleMsgNodeListSubscribe(ss);
+      break;
 #if 0
     case MsgNodeInfo::TYPE:
       handleNodeInfo(ss);
@@ -865,13 +1077,13 @@ void ReflectorClient::handleSelectTG(std::istream& is)
     auto talker = TGHandler::instance()->talkerForTG(m_current_tg);
     if (talker == this)
     {
-      m_reflector->broadcastUdpMsg(MsgUdpFlushSamples(),
-          mkAndFilter(
-            TgFilter(m_current_tg),
-            ExceptFilter(this)));
+      m_reflector->broadcastUdpMsgToTg(m_current_tg, MsgUdpFlushSamples(),
+          ExceptFilter(this));
     }
-    else if (talker != 0)
+    else if ((talker != 0) || m_monitor_audio)
     {
+        // A client receiving monitor audio use the flush as a marker for
+        // when the switch over to the new TG has been done
       sendUdpMsg(MsgUdpFlushSamples());
     }
 
@@ -928,6 +1140,15 @@ void ReflectorClient::handleNodeInfo(std::istream& is)
     //std::cout << "### handleNodeInfo: udpSrcPort()=" << msg.udpSrcPort()
     //          << " JSON=" << msg.json() << std::endl;
     //setRemoteUdpSource(msg.udpSrcPort());
+    if ((m_udp_cipher == nullptr) ||
+        (msg.udpCipherKey().size() !=
+         static_cast<size_t>(EVP_CIPHER_key_length(m_udp_cipher))))
+    {
+      cout << "Client " << m_con->remoteHost() << ":" << m_con->remotePort()
+           << " ERROR: Wrong UDP cipher key length in MsgNodeInfo" << endl;
+      sendError("Illegal MsgNodeInfo protocol message received");
+      return;
+    }
     setUdpCipherIVRand(msg.ivRand());
     setUdpCipherKey(msg.udpCipherKey());
     jsonstr = msg.json();
@@ -952,11 +1173,15 @@ void ReflectorClient::handleNodeInfo(std::istream& is)
     m_status = &(m_reflector->clientStatus(m_callsign));
     auto& status = *m_status;
     status.clear();
+    m_rx_telemetry.clear();
+    m_rx_telemetry_dirty = false;
+    m_tx_status.clear();
     std::istringstream is(jsonstr);
     is >> status;
 
     status["protoVer"]["majorVer"] = protoVer().majorVer();
     status["protoVer"]["minorVer"] = protoVer().minorVer();
+    updateAudioParamsStatus();
     setMonitoredTGs(m_monitored_tgs);
     setTg(m_current_tg);
     if (status.isMember("qth") && status["qth"].isArray())
@@ -978,11 +1203,14 @@ void ReflectorClient::handleNodeInfo(std::istream& is)
               Json::Value& rx(qth["rx"][rx_id_str]);
               if (rx.isObject())
               {
-                m_json_rx_map.emplace(rx_id, rx);
-                setRxSiglev(rx_id, 0);
-                setRxEnabled(rx_id, false);
-                setRxSqlOpen(rx_id, false);
-                setRxActive(rx_id, false);
+                  // The initial state is written to the JSON object on the
+                  // next telemetry sync
+                RxTelemetry telemetry;
+                telemetry.json = &rx;
+                telemetry.id = rx_id;
+                telemetry.dirty = true;
+                m_rx_telemetry.push_back(telemetry);
+                m_rx_telemetry_dirty = true;
               }
             }
           }
@@ -999,8 +1227,11 @@ void ReflectorClient::handleNodeInfo(std::istream& is)
               Json::Value& tx(qth["tx"][tx_id_str]);
               if (tx.isObject())
               {
-                m_json_tx_map.emplace(tx_id, tx);
-                setTxTransmit(tx_id, false);
+                TxStatus tx_status;
+                tx_status.json = &tx;
+                tx_status.id = tx_id;
+                m_tx_status.push_back(tx_status);
+                tx["transmit"] = false;
               }
             }
           }
@@ -1014,6 +1245,7 @@ void ReflectorClient::handleNodeInfo(std::istream& is)
               << "]: Failed to parse MsgNodeInfo JSON object: "
               << e.what() << std::endl;
   }
+  statusUpdated();
 } /* ReflectorClient::handleNodeInfo */
 
 
@@ -1027,23 +1259,332 @@ void ReflectorClient::handleMsgSignalStrengthValues(std::istream& is)
             "MsgSignalStrengthValues message" << endl;
     return;
   }
-  typedef MsgSignalStrengthValues::Rxs::const_iterator RxsIter;
-  for (RxsIter it = msg.rxs().begin(); it != msg.rxs().end(); ++it)
+  setRxSignalStrengthValues(msg.rxs());
+} /* ReflectorClient::handleMsgSignalStrengthValues */
+
+
+void ReflectorClient::handleMsgRxTelemetry(std::istream& is)
+{
+  MsgRxTelemetry msg;
+  if (!msg.unpack(is))
   {
-    const MsgSignalStrengthValues::Rx& rx = *it;
-    //std::cout << "### MsgSignalStrengthValues:"
-    //  << " id=" << rx.id()
-    //  << " siglev=" << rx.siglev()
-    //  << " enabled=" << rx.enabled()
-    //  << " sql_open=" << rx.sqlOpen()
-    //  << " active=" << rx.active()
+    cerr << "*** WARNING[" << callsign()
+         << "]: Could not unpack incoming MsgRxTelemetry message" << endl;
+    return;
+  }
+  bool changed = false;
+  for (const auto& rec : msg.records())
+  {
+    //std::cout << "### MsgRxTelemetry:"
+    //  << " id=" << rec.id()
+    //  << " siglev=" << unsigned(rec.siglev())
+    //  << " flags=" << unsigned(rec.flags())
+    //  << " ts=" << msg.timestamp(rec)
     //  << std::endl;
-    setRxSiglev(rx.id(), rx.siglev());
-    setRxEnabled(rx.id(), rx.enabled());
-    setRxSqlOpen(rx.id(), rx.sqlOpen());
-    setRxActive(rx.id(), rx.active());
+    changed |= storeRxTelemetry(rec.id(), rec.siglev(), rec.flags(),
+                                msg.timestamp(rec));
+  }
+  if (changed)
+  {
+    statusUpdated();
+  }
+} /* ReflectorClient::handleMsgRxTelemetry */
+
+
+void ReflectorClient::handleMsgAudioParams(std::istream& is)
+{
+  MsgAudioParams msg;
+  if (!msg.unpack(is))
+  {
+    cerr << "*** WARNING[" << callsign()
+         << "]: Could not unpack incoming MsgAudioParams message" << endl;
+    return;
+  }
+
+  float min_frame_size = 2.5f;
+  m_cfg->getValue("GLOBAL", "AUDIO_MIN_FRAME_SIZE", min_frame_size);
+  float max_frame_size = 60.0f;
+  m_cfg->getValue("GLOBAL", "AUDIO_MAX_FRAME_SIZE", max_frame_size);
+  bool allow_dtx = true;
+  m_cfg->getValue("GLOBAL", "AUDIO_ALLOW_DTX", allow_dtx);
+  bool allow_fec = true;
+  m_cfg->getValue("GLOBAL", "AUDIO_ALLOW_FEC", allow_fec);
+
+    // Select the largest valid frame size not larger than the requested one
+    // within the configured limits. If none is found, use the smallest frame
+    // size allowed.
+  uint16_t frame_size = 0;
+  for (const uint16_t* fs = AUDIO_FRAME_SIZES; *fs != 0; ++fs)
+  {
+    if ((*fs < min_frame_size * 10.0f) || (*fs > max_frame_size * 10.0f))
+    {
+      continue;
+    }
+    if ((frame_size == 0) || (*fs <= msg.frameSize()))
+    {
+      frame_size = *fs;
+    }
+  }
+  if (frame_size == 0)
+  {
+    frame_size = 200;
+  }
+
+  m_audio_params = MsgAudioParams(frame_size, msg.dtx() && allow_dtx,
+                                  msg.fec() && allow_fec,
+                                  msg.expectedPacketLoss());
+  std::cout << callsign() << ": Using audio frame size "
+            << (frame_size / 10.0f) << "ms"
+            << ", DTX " << (m_audio_params.dtx() ? "on" : "off")
+            << ", FEC " << (m_audio_params.fec() ? "on" : "off")
+            << std::endl;
+  sendMsg(m_audio_params);
+  updateAudioParamsStatus();
+  statusUpdated();
+} /* ReflectorClient::handleMsgAudioParams */
+
+
+void ReflectorClient::handleMsgUdpCipher(std::istream& is)
+{
+  MsgUdpCipher msg;
+  if (!msg.unpack(is))
+  {
+    cerr << "*** WARNING[" << callsign()
+         << "]: Could not unpack incoming MsgUdpCipher message" << endl;
+    sendError("Illegal MsgUdpCipher protocol message received");
+    return;
+  }
+
+    // The cipher cannot be changed when the UDP key has been received
+  if (!m_udp_cipher_key.empty())
+  {
+    cerr << "*** WARNING[" << callsign()
+         << "]: MsgUdpCipher received after MsgNodeInfo" << endl;
+    sendError("Protocol error");
+    return;
   }
-} /* ReflectorClient::handleMsgSignalStrengthValues */
+
+  const Async::EncryptedUdpSocket::Cipher* cipher = nullptr;
+  if ((msg.name() == UdpCipher::NAME) ||
+      (msg.name() == UdpCipher::NAME_NO_AES))
+  {
+    cipher = Async::EncryptedUdpSocket::fetchCipher(msg.name());
+  }
+  if (cipher == nullptr)
+  {
+    sendError("Unsupported UDP cipher " + msg.name());
+    return;
+  }
+  m_udp_cipher = cipher;
+  std::cout << callsign() << ": Using UDP cipher " << msg.name() << std::endl;
+} /* ReflectorClient::handleMsgUdpCipher */
+
+
+void ReflectorClient::handleMsgMonitorAudio(std::istream& is)
+{
+  MsgMonitorAudio msg;
+  if (!msg.unpack(is))
+  {
+    cerr << "*** WARNING[" << callsign()
+         << "]: Could not unpack incoming MsgMonitorAudio message" << endl;
+    sendError("Illegal MsgMonitorAudio protocol message received");
+    return;
+  }
+  bool allow = true;
+  m_cfg->getValue("GLOBAL", "MONITOR_AUDIO", allow);
+  m_monitor_audio = allow && msg.enable();
+  std::cout << callsign() << ": Monitor audio "
+            << (m_monitor_audio ? "enabled" : "disabled") << std::endl;
+} /* ReflectorClient::handleMsgMonitorAudio */
+
+
+void ReflectorClient::handleMsgAudioRedundancy(std::istream& is)
+{
+  MsgAudioRedundancy msg;
+  if (!msg.unpack(is))
+  {
+    cerr << "*** WARNING[" << callsign()
+         << "]: Could not unpack incoming MsgAudioRedundancy message" << endl;
+    sendError("Illegal MsgAudioRedundancy protocol message received");
+    return;
+  }
+  bool allow = true;
+  m_cfg->getValue("GLOBAL", "AUDIO_REDUNDANCY", allow);
+  m_audio_redundancy = allow && msg.enable();
+  std::cout << callsign() << ": Audio redundancy "
+            << (m_audio_redundancy ? "enabled" : "disabled") << std::endl;
+} /* ReflectorClient::handleMsgAudioRedundancy */
+
+
+void ReflectorClient::handleMsgAudioTranscode(std::istream& is)
+{
+  MsgAudioTranscode msg;
+  if (!msg.unpack(is))
+  {
+    cerr << "*** WARNING[" << callsign()
+         << "]: Could not unpack incoming MsgAudioTranscode message" << endl;
+    sendError("Illegal MsgAudioTranscode protocol message received");
+    return;
+  }
+
+  std::set<std::string> allowed_codecs;
+  m_cfg->getValue("GLOBAL", "TRANSCODE_CODECS", allowed_codecs);
+  if (!msg.codec().empty() &&
+      (allowed_codecs.count(msg.codec()) > 0) &&
+      TGTranscoder::profileIsValid(msg.codec(), msg.bitrate()))
+  {
+    m_transcode_codec = msg.codec();
+    m_transcode_bitrate = msg.bitrate();
+    m_transcode_profile = TGTranscoder::profileName(msg.codec(),
+                                                    msg.bitrate());
+    std::cout << callsign() << ": Transcoding audio to "
+              << m_transcode_profile << std::endl;
+  }
+  else
+  {
+    if (!msg.codec().empty())
+    {
+      std::cout << callsign() << ": Rejected request for audio transcoding to "
+                << TGTranscoder::profileName(msg.codec(), msg.bitrate())
+                << std::endl;
+    }
+    m_transcode_codec.clear();
+    m_transcode_bitrate = 0;
+    m_transcode_profile.clear();
+  }
+  sendMsg(MsgAudioTranscode(m_transcode_codec, m_transcode_bitrate));
+
+  if (m_status != nullptr)
+  {
+    (*m_status)["audio"]["transcode"] = m_transcode_profile;
+    statusUpdated();
+  }
+} /* ReflectorClient::handleMsgAudioTranscode */
+
+
+void ReflectorClient::handleMsgUdpKeepaliveInterval(std::istream& is)
+{
+  MsgUdpKeepaliveInterval msg;
+  if (!msg.unpack(is))
+  {
+    cerr << "*** WARNING[" << callsign()
+         << "]: Could not unpack incoming MsgUdpKeepaliveInterval message"
+         << endl;
+    sendError("Illegal MsgUdpKeepaliveInterval protocol message received");
+    return;
+  }
+
+  unsigned max_interval = MAX_UDP_KEEPALIVE_INTERVAL;
+  m_cfg->getValue("GLOBAL", "UDP_KEEPALIVE_MAX_INTERVAL", max_interval);
+  if (max_interval > MAX_UDP_KEEPALIVE_INTERVAL)
+  {
+    max_interval = MAX_UDP_KEEPALIVE_INTERVAL;
+  }
+  if (m_udp_stale_timeout > 0)
+  {
+      // Even the longest jittered interval must be well within the stale
+      // timeout or audio would be withheld from idle clients
+    max_interval = std::min(max_interval, m_udp_stale_timeout / 2);
+  }
+
+  unsigned interval = std::min(unsigned(msg.interval()), max_interval);
+  if (interval < MIN_UDP_KEEPALIVE_INTERVAL)
+  {
+    interval = 0;
+  }
+  m_udp_keepalive_interval = interval;
+  m_udp_keepalive_flags = 0;
+  m_udp_keepalive_tg_mismatch = false;
+  m_heartbeat_rx_cnt = heartbeatRxCntReset();
+  sendMsg(MsgUdpKeepaliveInterval(m_udp_keepalive_interval));
+
+  if (m_udp_keepalive_interval > 0)
+  {
+    std::cout << callsign() << ": Using UDP keepalives every "
+              << m_udp_keepalive_interval << " seconds" << std::endl;
+  }
+  else if (msg.interval() > 0)
+  {
+    std::cout << callsign() << ": Rejected request for UDP keepalives every "
+              << msg.interval() << " seconds" << std::endl;
+  }
+
+  if (m_status != nullptr)
+  {
+    Json::Value& keepalive = (*m_status)["udpKeepalive"];
+    keepalive["interval"] = m_udp_keepalive_interval;
+    keepalive["talking"] = false;
+    keepalive["receiving"] = false;
+    statusUpdated();
+  }
+} /* ReflectorClient::handleMsgUdpKeepaliveInterval */
+
+
+void ReflectorClient::handleMsgNodeListSubscribe(std::istream& is)
+{
+  MsgNodeListSubscribe msg;
+  if (!msg.unpack(is))
+  {
+    cerr << "*** WARNING[" << callsign()
+         << "]: Could not unpack incoming MsgNodeListSubscribe message"
+         << endl;
+    sendError("Illegal MsgNodeListSubscribe protocol message received");
+    return;
+  }
+  if (msg.scope() > MsgNodeListSubscribe::SCOPE_TGS)
+  {
+    sendError("Illegal node list scope in MsgNodeListSubscribe");
+    return;
+  }
+  m_node_list_scope = msg.scope();
+  sendNodeListSnapshot();
+} /* ReflectorClient::handleMsgNodeListSubscribe */
+
+
+void ReflectorClient::sendNodeListSnapshot(void)
+{
+  std::vector<std::string> nodes;
+  if (m_node_list_scope == MsgNodeListSubscribe::SCOPE_ALL)
+  {
+    m_reflector->nodeList(nodes);
+  }
+  else if (m_node_list_scope == MsgNodeListSubscribe::SCOPE_TGS)
+  {
+    std::set<uint32_t> tgs(m_monitored_tgs);
+    if (m_current_tg != 0)
+    {
+      tgs.insert(m_current_tg);
+    }
+    m_reflector->nodeList(nodes, tgs);
+  }
+  std::sort(nodes.begin(), nodes.end());
+  nodes.erase(std::unique(nodes.begin(), nodes.end()), nodes.end());
+
+  const size_t page_size = MsgNodeListSnapshot::MAX_PAGE_SIZE;
+  const size_t page_cnt = std::max(size_t(1),
+                                   (nodes.size() + page_size - 1) / page_size);
+  for (size_t page=0; page<page_cnt; ++page)
+  {
+    const size_t begin = page * page_size;
+    const size_t end = std::min(nodes.size(), begin + page_size);
+    MsgNodeListSnapshot msg(m_reflector->nodeListVersion(), page, page_cnt);
+    msg.setNodes(nodes.begin() + begin, nodes.begin() + end);
+    sendMsg(msg);
+  }
+} /* ReflectorClient::sendNodeListSnapshot */
+
+
+void ReflectorClient::updateAudioParamsStatus(void)
+{
+  if ((m_status == nullptr) || (m_audio_params.frameSize() == 0))
+  {
+    return;
+  }
+  Json::Value& audio = (*m_status)["audio"];
+  audio["frameSize"] = m_audio_params.frameSize() / 10.0;
+  audio["dtx"] = m_audio_params.dtx();
+  audio["fec"] = m_audio_params.fec();
+} /* ReflectorClient::updateAudioParamsStatus */
 
 
 void ReflectorClient::handleMsgTxStatus(std::istream& is)
@@ -1092,6 +1633,33 @@ void ReflectorClient::handleStateEvent(std::istream& is)
     sendError("Illegal MsgStateEvent protocol message received");
     return;
   }
+
+  if (msg.name() == "Logic:audio_stats")
+  {
+    if (m_status == nullptr)
+    {
+      return;
+    }
+    try
+    {
+      Json::Value stats;
+      std::istringstream ss(msg.msg());
+      ss >> stats;
+      if (stats.isObject())
+      {
+        (*m_status)["audioStats"][msg.src()] = stats;
+        statusUpdated();
+      }
+    }
+    catch (const Json::Exception& e)
+    {
+      std::cerr << "*** WARNING[" << m_callsign
+                << "]: Failed to parse audio statistics JSON object: "
+                << e.what() << std::endl;
+    }
+    return;
+  }
+
   cout << "### ReflectorClient::handleStateEvent:"
        << " src=" << msg.src()
        << " name=" << msg.name()
@@ -1232,14 +1800,31 @@ void ReflectorClient::disconnect(void)
 
 void ReflectorClient::handleHeartbeat(Async::Timer *t)
 {
+    // When UDP keepalives are used the client drive the heartbeating and we
+    // only answer its keepalives. UDP heartbeats are still sent to a stale
+    // client so that the path to it can recover.
   if (--m_heartbeat_tx_cnt == 0)
   {
-    sendMsg(MsgHeartbeat());
+    if (m_udp_keepalive_interval > 0)
+    {
+      m_heartbeat_tx_cnt = HEARTBEAT_TX_CNT_RESET;
+    }
+    else
+    {
+      sendMsg(MsgHeartbeat());
+    }
   }
 
   if (--m_udp_heartbeat_tx_cnt == 0)
   {
-    sendUdpMsg(MsgUdpHeartbeat());
+    if ((m_udp_keepalive_interval > 0) && !udpIsStale())
+    {
+      m_udp_heartbeat_tx_cnt = UDP_HEARTBEAT_TX_CNT_RESET;
+    }
+    else
+    {
+      sendUdpMsg(MsgUdpHeartbeat());
+    }
   }
 
   if (--m_heartbeat_rx_cnt == 0)
@@ -1286,17 +1871,25 @@ void ReflectorClient::handleHeartbeat(Async::Timer *t)
 } /* ReflectorClient::handleHeartbeat */
 
 
+unsigned ReflectorClient::heartbeatRxCntReset(void) const
+{
+  return (m_udp_keepalive_interval > 0) ? UDP_HEARTBEAT_RX_CNT_RESET
+                                        : HEARTBEAT_RX_CNT_RESET;
+} /* ReflectorClient::heartbeatRxCntReset */
+
+
 std::string ReflectorClient::lookupUserKey(const std::string& callsign)
 {
   string auth_group;
-  if (!m_cfg->getValue("USERS", callsign, auth_group) || auth_group.empty())
+  string auth_key;
+  auto status = m_reflector->userDb().lookup(callsign, auth_group, auth_key);
+  if (status == ReflectorUserDb::USER_UNKNOWN)
   {
     cout << "*** WARNING: Unknown user \"" << callsign << "\""
          << endl;
     return "";
   }
-  string auth_key;
-  if (!m_cfg->getValue("PASSWORDS", auth_group, auth_key) || auth_key.empty())
+  else if (status == ReflectorUserDb::USER_NO_PASSWORD)
   {
     cout << "*** ERROR: User \"" << callsign << "\" found in SvxReflector "
          << "configuration but password with groupname \"" << auth_group
@@ -1309,10 +1902,10 @@ std::string ReflectorClient::lookupUserKey(const std::string& callsign)
 
 void ReflectorClient::connectionAuthenticated(const std::string& callsign)
 {
-  vector<string> connected_nodes;
-  m_reflector->nodeList(connected_nodes);
-  if (find(connected_nodes.begin(), connected_nodes.end(),
-           callsign) == connected_nodes.end())
+    // Look the callsign up in the callsign map instead of building a list
+    // of all connected nodes, which is costly when many nodes log in at the
+    // same time, e.g. after a reflector restart
+  if (lookup(callsign) == nullptr)
   {
     m_con->setMaxRxFrameSize(ReflectorMsg::MAX_POSTAUTH_FRAME_SIZE);
     m_callsign = callsign;
@@ -1327,8 +1920,13 @@ void ReflectorClient::connectionAuthenticated(const std::string& callsign)
     assert(client_callsign_map.find(m_callsign) == client_callsign_map.end());
     client_callsign_map[m_callsign] = this;
 
+      // Clients using protocol version 3.4 or later have to subscribe to
+      // get the node list, which is costly to send to many clients
     MsgServerInfo msg_srv_info(m_client_id, m_supported_codecs);
-    m_reflector->nodeList(msg_srv_info.nodes());
+    if (m_client_proto_ver < ProtoVer(3, 4))
+    {
+      m_reflector->nodeList(msg_srv_info.nodes());
+    }
     sendMsg(msg_srv_info);
 
     if (m_client_proto_ver < ProtoVer(0, 7))
@@ -1342,7 +1940,7 @@ void ReflectorClient::connectionAuthenticated(const std::string& callsign)
       setTg(m_reflector->tgForV1Clients());
     }
 
-    m_reflector->broadcastMsg(MsgNodeJoined(m_callsign), ExceptFilter(this));
+    m_reflector->nodeJoined(this);
   }
   else
   {
@@ -1389,8 +1987,14 @@ void ReflectorClient::sendAuthChallenge(void)
 
 void ReflectorClient::renewClientCertificate(void)
 {
-  auto cert = m_con->sslPeerCertificate();
-  if (cert.isNull() || !m_reflector->renewedClientCert(cert))
+  m_reflector->renewedClientCert(m_con->sslPeerCertificate(),
+      sigc::mem_fun(*this, &ReflectorClient::onRenewedClientCert));
+} /* ReflectorClient::renewClientCertificate */
+
+
+void ReflectorClient::onRenewedClientCert(Async::SslX509& cert)
+{
+  if (cert.isNull())
   {
     std::cerr << "*** WARNING: Certificate renewal for '"
               << m_callsign << "' failed" << std::endl;
@@ -1399,12 +2003,19 @@ void ReflectorClient::renewClientCertificate(void)
   std::cout << m_callsign << ": Send renewed client certificate" << std::endl;
   sendClientCert(cert);
   m_con_state = STATE_EXPECT_DISCONNECT;
-} /* ReflectorClient::renewClientCertificate */
+} /* ReflectorClient::onRenewedClientCert */
 
 
 void ReflectorClient::setMonitoredTGs(const std::set<uint32_t>& tgs)
 {
+  const bool changed = (tgs != m_monitored_tgs);
   m_monitored_tgs = tgs;
+  TGHandler::instance()->setMonitoredTGs(this, tgs);
+
+  if (changed && (m_node_list_scope == MsgNodeListSubscribe::SCOPE_TGS))
+  {
+    sendNodeListSnapshot();
+  }
 
   if (m_status != nullptr)
   {
@@ -1419,6 +2030,7 @@ void ReflectorClient::setMonitoredTGs(const std::set<uint32_t>& tgs)
     {
       monitored_tgs.append(tg);
     }
+    statusUpdated();
   }
 } /* ReflectorClient::setMonitoredTGs */
 
@@ -1439,7 +2051,16 @@ void ReflectorClient::setTg(uint32_t tg)
       tg = 0;
     }
 
+    const uint32_t old_tg = m_current_tg;
     m_current_tg = tg;
+    if (tg != old_tg)
+    {
+      m_reflector->nodeTgChanged(this, old_tg, tg);
+      if (m_node_list_scope == MsgNodeListSubscribe::SCOPE_TGS)
+      {
+        sendNodeListSnapshot();
+      }
+    }
   }
 
   if (m_status != nullptr)
@@ -1450,12 +2071,47 @@ void ReflectorClient::setTg(uint32_t tg)
     }
     (*m_status)["tg"] = tg;
     (*m_status)["restrictedTG"] = TGHandler::instance()->isRestricted(tg);
+    statusUpdated();
   }
 
   updateIsTalker();
 } /* ReflectorClient::setTg */
 
 
+void ReflectorClient::statusUpdated(void)
+{
+  if (m_status != nullptr)
+  {
+    m_reflector->clientStatusUpdated(m_callsign);
+  }
+} /* ReflectorClient::statusUpdated */
+
+
+bool ReflectorClient::storeRxTelemetry(char id, uint8_t siglev, uint8_t flags,
+                                       uint64_t timestamp)
+{
+    // A node only have a few receivers so a linear search is faster
+    // than a map lookup
+  auto it = std::find_if(m_rx_telemetry.begin(), m_rx_telemetry.end(),
+                         [id](const RxTelemetry& rx) { return rx.id == id; });
+  if (it == m_rx_telemetry.end())
+  {
+    return false;
+  }
+  RxTelemetry& rx = *it;
+  if ((rx.siglev == siglev) && (rx.flags == flags))
+  {
+    return false;
+  }
+  rx.timestamp = timestamp;
+  rx.siglev = siglev;
+  rx.flags = flags;
+  rx.dirty = true;
+  m_rx_telemetry_dirty = true;
+  return true;
+} /* ReflectorClient::storeRxTelemetry */
+
+
 
 /*
  * This file has not been truncated
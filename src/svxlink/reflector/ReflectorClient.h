@@ -6,7 +6,7 @@
 
 \verbatim
 SvxReflector - An audio reflector for connecting SvxLink Servers
-Copyright (C) 2003-2025 Tobias Blomberg / SM0SVX
+Copyright (C) 2003-2026 Tobias Blomberg / SM0SVX
 
 This program is free software; you can redistribute it and/or modify
 it under the terms of the GNU General Public License as published by
@@ -38,6 +38,9 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 #include <json/json.h>
 #include <sigc++/sigc++.h>
 #include <random>
+#include <array>
+#include <chrono>
+#include <unordered_map>
 
 
 /****************************************************************************
@@ -52,6 +55,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 #include <AsyncConfig.h>
 #include <AsyncSslCertSigningReq.h>
 #include <AsyncSslX509.h>
+#include <AsyncEncryptedUdpSocket.h>
 
 
 /****************************************************************************
@@ -130,6 +134,13 @@ class ReflectorClient : public sigc::trackable
       STATE_CONNECTED
     } ConState;
 
+    typedef enum
+    {
+      UDP_TX_DROP_STALE,      ///< No UDP traffic received from the client
+      UDP_TX_DROP_CONGESTED,  ///< The UDP socket send buffer was full
+      UDP_TX_DROP_CNT
+    } UdpTxDrop;
+
     class Filter
     {
       public:
@@ -191,6 +202,30 @@ class ReflectorClient : public sigc::trackable
         uint32_t m_tg;
     };
 
+    class AudioRedundancyFilter : public Filter
+    {
+      public:
+        AudioRedundancyFilter(bool redundancy) : m_redundancy(redundancy) {}
+        virtual bool operator ()(ReflectorClient *client) const
+        {
+          return client->m_audio_redundancy == m_redundancy;
+        }
+      private:
+        bool m_redundancy;
+    };
+
+    class TranscodeFilter : public Filter
+    {
+      public:
+        TranscodeFilter(const std::string& profile) : m_profile(profile) {}
+        virtual bool operator ()(ReflectorClient *client) const
+        {
+          return client->m_transcode_profile == m_profile;
+        }
+      private:
+        std::string m_profile;
+    };
+
     class TgMonitorFilter : public Filter
     {
       public:
@@ -203,6 +238,21 @@ class ReflectorClient : public sigc::trackable
         uint32_t m_tg;
     };
 
+    class NodeListFilter : public Filter
+    {
+      public:
+        NodeListFilter(uint8_t scope, uint32_t not_tg=0)
+          : m_scope(scope), m_not_tg(not_tg) {}
+        virtual bool operator ()(ReflectorClient *client) const
+        {
+          return (client->m_node_list_scope == m_scope) &&
+                 ((m_not_tg == 0) || !client->hasTg(m_not_tg));
+        }
+      private:
+        uint8_t   m_scope;
+        uint32_t  m_not_tg;
+    };
+
     template <class F1, class F2>
     class AndFilter : public Filter
     {
@@ -395,6 +445,37 @@ class ReflectorClient : public sigc::trackable
      */
     int sendMsg(const ReflectorMsg& msg);
 
+    /**
+     * @brief   Pack a TCP message into a buffer that can be shared
+     * @param   msg The message to pack
+     * @return  Returns the packed message or a null pointer on failure
+     *
+     * Use this function together with sendPackedMsg when the same message
+     * is sent to many clients so that it is only packed once.
+     */
+    static Async::TcpConnection::SharedBuffer packMsg(const ReflectorMsg& msg);
+
+    /**
+     * @brief   Send a packed TCP message to the remote end
+     * @param   type  The message type
+     * @param   buf   The message packed using packMsg
+     * @return  On success 0 is returned or else -1
+     */
+    int sendPackedMsg(uint16_t type,
+                      const Async::TcpConnection::SharedBuffer& buf);
+
+    /**
+     * @brief   Get the number of segments queued for sending
+     * @return  Returns the TCP write queue depth
+     */
+    size_t tcpTxQueueDepth(void) const { return m_con->writeQueueDepth(); }
+
+    /**
+     * @brief   Get the number of bytes queued for sending
+     * @return  Returns the number of bytes not yet handed over to the OS
+     */
+    size_t tcpTxQueueBytes(void) const { return m_con->writeQueueBytes(); }
+
     /**
      * @brief   Handle a received UDP message
      * @param   The received UDP message
@@ -404,12 +485,101 @@ class ReflectorClient : public sigc::trackable
      */
     void udpMsgReceived(const ReflectorUdpMsg &header);
 
+    /**
+     * @brief   Count UDP frames lost from the client
+     * @param   cnt The number of lost frames
+     */
+    void udpFramesLost(uint64_t cnt) { m_udp_rx_lost_frames += cnt; }
+
+    /**
+     * @brief   Handle a received UDP keepalive message
+     * @param   msg The received message
+     *
+     * The keepalive is answered directly if UDP keepalives have been
+     * negotiated with the client. Otherwise it is ignored.
+     */
+    void udpKeepaliveReceived(const MsgUdpKeepalive& msg);
+
+    /**
+     * @brief   Get the number of UDP frames lost from the client
+     * @return  Returns the number of lost frames since the client connected
+     */
+    uint64_t udpRxLostFrames(void) const { return m_udp_rx_lost_frames; }
+
+    /**
+     * @brief   Get the estimated audio packet arrival jitter
+     * @return  Returns the jitter in seconds
+     *
+     * The jitter is the smoothed variation of the time between received
+     * audio packets, in the same way as the interarrival jitter in RFC 3550
+     * but without using timestamps from the sender.
+     */
+    double udpRxJitter(void) const { return m_udp_rx_jitter; }
+
+    /**
+     * @brief   Check if the UDP path to the client seem to be dead
+     * @return  Returns \em true if no UDP datagram has been received from
+     *          the client for GLOBAL/UDP_STALE_TIMEOUT seconds
+     *
+     * The client is not disconnected until the UDP heartbeat times out but
+     * there is no point in sending audio to it until it is heard from again.
+     */
+    bool udpIsStale(void) const
+    {
+      return (m_udp_stale_timeout > 0) &&
+             (UDP_HEARTBEAT_RX_CNT_RESET - m_udp_heartbeat_rx_cnt >=
+              m_udp_stale_timeout);
+    }
+
+    /**
+     * @brief   Count a UDP datagram that was not sent to the client
+     * @param   reason The reason for not sending the datagram
+     */
+    void udpTxDropped(UdpTxDrop reason) { m_udp_tx_dropped[reason] += 1; }
+
+    /**
+     * @brief   Get the number of UDP datagrams not sent to the client
+     * @param   reason The reason for not sending the datagrams
+     * @return  Returns the number of dropped datagrams since connect
+     */
+    uint64_t udpTxDropCount(UdpTxDrop reason) const
+    {
+      return m_udp_tx_dropped[reason];
+    }
+
+    /**
+     * @brief   Get the audio health statistics reported by the client
+     * @return  Returns a JSON object with one member per logic core, or
+     *          nullptr if no statistics have been received
+     *
+     * The statistics are sent by the client in a state event, see the
+     * LogicAudioStats class in SvxLink for the format.
+     */
+    const Json::Value* audioStats(void) const;
+
     /**
      * @brief   Send a UDP message to the client
      * @param   The message to send
      */
     void sendUdpMsg(const ReflectorUdpMsg &msg);
 
+    /**
+     * @brief   Send an already packed UDP message to the client
+     * @param   The packed message to send
+     */
+    void sendUdpMsg(const ReflectorPackedUdpMsg &msg);
+
+    /**
+     * @brief   Tell the client that a UDP message was sent to it
+     *
+     * Used when a datagram has been sent to the client without going
+     * through sendUdpMsg, so that no needless heartbeat is sent.
+     */
+    void udpMsgSent(void)
+    {
+      m_udp_heartbeat_tx_cnt = UDP_HEARTBEAT_TX_CNT_RESET;
+    }
+
     /**
      * @brief   Block client audio for the specified time
      * @param   The number of seconds to block
@@ -438,12 +608,32 @@ class ReflectorClient : public sigc::trackable
      */
     const ProtoVer& protoVer(void) const { return m_client_proto_ver; }
 
+    /**
+     * @brief   Get the audio codec used by the client
+     * @return  Returns the name of the audio codec
+     */
+    const std::string& codecName(void) const
+    {
+      return m_supported_codecs.front();
+    }
+
     /**
      * @brief   Get the current talk group
      * @return  Returns the currently selected talk group
      */
     uint32_t currentTG(void) const { return m_current_tg; }
 
+    /**
+     * @brief   Check if the client has selected or monitor a talk group
+     * @param   tg The talk group to check
+     * @return  Returns \em true if the client has selected or monitor the TG
+     */
+    bool hasTg(uint32_t tg) const
+    {
+      return (tg != 0) &&
+             ((tg == m_current_tg) || (m_monitored_tgs.count(tg) > 0));
+    }
+
     /**
      * @brief   Get the monitored talk groups
      * @return  Returns the monitored talk groups
@@ -456,36 +646,50 @@ class ReflectorClient : public sigc::trackable
     std::vector<char> rxIdList(void) const
     {
       std::vector<char> ids;
-      ids.reserve(m_json_rx_map.size());
-      for (const auto& rx : m_json_rx_map)
+      ids.reserve(m_rx_telemetry.size());
+      for (const auto& rx : m_rx_telemetry)
       {
-        ids.push_back(rx.first);
+        ids.push_back(rx.id);
       }
       return ids;
     }
-    void setRxSiglev(char id, uint8_t siglev)
-    {
-      setRxParam(id, "siglev", siglev);
-    }
-    void setRxEnabled(char id, bool enab) { setRxParam(id, "enabled", enab); }
-    void setRxSqlOpen(char id, bool open) { setRxParam(id, "sql_open", open); }
-    void setRxActive(char id, bool active) { setRxParam(id, "active", active); }
 
-    void setTxTransmit(char id, bool transmit)
-    {
-      setTxParam(id, "transmit", transmit);
-    }
+    /**
+     * @brief   Update the signal strength values for a number of receivers
+     * @param   rxs The signal strength values received from the client
+     *
+     * The values are stored in the receiver telemetry array. They will be
+     * written to the JSON status object when syncRxTelemetry is called.
+     */
+    void setRxSignalStrengthValues(
+        const MsgSignalStrengthValuesBase::Rxs& rxs);
+
+    /**
+     * @brief   Write updated receiver telemetry to the JSON status object
+     *
+     * Receiver telemetry is received at a high rate so it is stored in a
+     * flat array when received. This function must be called before the
+     * JSON status object for this client is read.
+     */
+    void syncRxTelemetry(void);
+
+    /**
+     * @brief   Update the transmit state for a transmitter
+     * @param   id The transmitter id
+     * @param   transmit Set to \em true if the transmitter is transmitting
+     */
+    void setTxTransmit(char id, bool transmit);
 
     void updateIsTalker(void);
 
     uint32_t udpCipherIVCntrNext() { return m_udp_cipher_iv_cntr++; }
-    std::vector<uint8_t> udpCipherIV(void) const;
+    void udpCipherIV(std::vector<uint8_t>& iv) const;
 
     void setUdpCipherIVRand(const std::vector<uint8_t>& iv_rand)
     {
       m_udp_cipher_iv_rand = iv_rand;
     }
-    std::vector<uint8_t> udpCipherIVRand(void) const
+    const std::vector<uint8_t>& udpCipherIVRand(void) const
     {
       return m_udp_cipher_iv_rand;
     }
@@ -494,25 +698,114 @@ class ReflectorClient : public sigc::trackable
     {
       m_udp_cipher_key = key;
     }
-    std::vector<uint8_t> udpCipherKey(void) const { return m_udp_cipher_key; }
+    const std::vector<uint8_t>& udpCipherKey(void) const
+    {
+      return m_udp_cipher_key;
+    }
+
+    /**
+     * @brief   Get the cipher used for UDP datagrams to/from this client
+     * @return  Returns the cipher selected by the client
+     */
+    const Async::EncryptedUdpSocket::Cipher* udpCipher(void) const
+    {
+      return m_udp_cipher;
+    }
 
     void certificateUpdated(Async::SslX509& cert);
 
+    /**
+     * @brief   Get an estimate of the memory used by this client
+     * @return  Returns the number of bytes used
+     *
+     * The estimate include the client object itself, the TCP connection
+     * object with its buffers and the dynamically allocated members. The
+     * JSON status object for the client is not included.
+     */
+    size_t memoryUsage(void) const;
+
+    /**
+     * @brief   Check if the client want audio for monitored talk groups
+     * @return  Returns \em true if MsgUdpMonitorAudio should be sent
+     */
+    bool monitorAudio(void) const { return m_monitor_audio; }
+
+    /**
+     * @brief   Check if the client want redundant audio
+     * @return  Returns \em true if MsgUdpRedundantAudio should be sent
+     */
+    bool audioRedundancy(void) const { return m_audio_redundancy; }
+
+    /**
+     * @brief   Get the transcoding profile used for audio sent to the client
+     * @return  Returns the profile name or an empty string if the client
+     *          receive the audio in the codec used on the reflector
+     */
+    const std::string& transcodeProfile(void) const
+    {
+      return m_transcode_profile;
+    }
+
+    /**
+     * @brief   Get the codec that audio is transcoded to for this client
+     * @return  Returns the codec name or an empty string if not transcoding
+     */
+    const std::string& transcodeCodec(void) const { return m_transcode_codec; }
+
+    /**
+     * @brief   Get the bitrate that audio is transcoded to for this client
+     * @return  Returns the bitrate in bits per second
+     */
+    uint32_t transcodeBitrate(void) const { return m_transcode_bitrate; }
+
   private:
     using ClientIdRandomDist  = std::uniform_int_distribution<ClientId>;
-    using ClientMap           = std::map<ClientId, ReflectorClient*>;
-    using ClientSrcMap        = std::map<ClientSrc, ReflectorClient*>;
+    struct ClientSrcHash
+    {
+      size_t operator()(const ClientSrc& src) const
+      {
+        return std::hash<Async::IpAddress>()(src.first) ^
+               (std::hash<uint16_t>()(src.second) << 1);
+      }
+    };
+    using ClientMap           = std::unordered_map<ClientId, ReflectorClient*>;
+    using ClientSrcMap        = std::unordered_map<ClientSrc, ReflectorClient*,
+                                                   ClientSrcHash>;
     using ClientCallsignMap   = std::map<std::string, ReflectorClient*>;
-    using JsonRxMap           = std::map<char, Json::Value&>;
-    using JsonTxMap           = std::map<char, Json::Value&>;
+
+    struct RxTelemetry
+    {
+      Json::Value*  json      {nullptr};
+      uint64_t      timestamp {0};
+      char          id        {0};
+      uint8_t       siglev    {0};
+      uint8_t       flags     {0};
+      bool          dirty     {false};
+    };
+    using RxTelemetryList     = std::vector<RxTelemetry>;
+
+    struct TxStatus
+    {
+      Json::Value*  json      {nullptr};
+      char          id        {0};
+      bool          transmit  {false};
+    };
+    using TxStatusList        = std::vector<TxStatus>;
+
+    static const size_t RECV_BUF_LEN = 2048;
 
     static const uint16_t MIN_MAJOR_VER = 0;
     static const uint16_t MIN_MINOR_VER = 6;
 
+    static const uint16_t AUDIO_FRAME_SIZES[];
+
     static const unsigned HEARTBEAT_TX_CNT_RESET      = 10;
     static const unsigned HEARTBEAT_RX_CNT_RESET      = 15;
     static const unsigned UDP_HEARTBEAT_TX_CNT_RESET  = 15;
     static const unsigned UDP_HEARTBEAT_RX_CNT_RESET  = 120;
+    static const unsigned DEFAULT_UDP_STALE_TIMEOUT   = 60;
+    static const unsigned MIN_UDP_KEEPALIVE_INTERVAL  = 5;
+    static const unsigned MAX_UDP_KEEPALIVE_INTERVAL  = 30;
 
     static const ClientId CLIENT_ID_MAX = std::numeric_limits<ClientId>::max();
     static const ClientId CLIENT_ID_MIN = 1;
@@ -545,13 +838,31 @@ class ReflectorClient : public sigc::trackable
     std::vector<std::string>    m_supported_codecs;
     uint32_t                    m_current_tg;
     std::set<uint32_t>          m_monitored_tgs;
-    JsonRxMap                   m_json_rx_map;
-    JsonTxMap                   m_json_tx_map;
     std::vector<uint8_t>        m_udp_cipher_iv_rand;
     std::vector<uint8_t>        m_udp_cipher_key;
     UdpCipher::IVCntr           m_udp_cipher_iv_cntr;
+    const Async::EncryptedUdpSocket::Cipher* m_udp_cipher;
     Async::AtTimer              m_renew_cert_timer;
     Json::Value*                m_status                {nullptr};
+    RxTelemetryList             m_rx_telemetry;
+    TxStatusList                m_tx_status;
+    bool                        m_rx_telemetry_dirty    {false};
+    MsgAudioParams              m_audio_params;
+    uint64_t                    m_udp_rx_lost_frames    {0};
+    double                      m_udp_rx_jitter         {0.0};
+    unsigned                    m_udp_stale_timeout     {0};
+    uint64_t                    m_udp_tx_dropped[UDP_TX_DROP_CNT] {0};
+    bool                        m_monitor_audio         {false};
+    bool                        m_audio_redundancy      {false};
+    std::string                 m_transcode_profile;
+    std::string                 m_transcode_codec;
+    uint32_t                    m_transcode_bitrate     {0};
+    unsigned                    m_udp_keepalive_interval {0};
+    uint8_t                     m_node_list_scope       {0};
+    uint8_t                     m_udp_keepalive_flags   {0};
+    bool                        m_udp_keepalive_tg_mismatch {false};
+    double                      m_udp_audio_rx_interval {-1.0};
+    std::chrono::steady_clock::time_point m_udp_audio_rx_time;
 
     static ClientId newClientId(ReflectorClient* client);
 
@@ -559,7 +870,7 @@ class ReflectorClient : public sigc::trackable
     ReflectorClient& operator=(const ReflectorClient&);
     void onSslConnectionReady(Async::TcpConnection *con);
     void onFrameReceived(Async::FramedTcpConnection *con,
-                         std::vector<uint8_t>& data);
+                         const uint8_t* data, size_t len);
     void handleMsgProtoVer(std::istream& is);
     void handleMsgCABundleRequest(std::istream& is);
     void handleMsgStartEncryptionRequest(std::istream& is);
@@ -569,6 +880,16 @@ class ReflectorClient : public sigc::trackable
     void handleTgMonitor(std::istream& is);
     void handleNodeInfo(std::istream& is);
     void handleMsgSignalStrengthValues(std::istream& is);
+    void handleMsgRxTelemetry(std::istream& is);
+    void handleMsgAudioParams(std::istream& is);
+    void handleMsgUdpCipher(std::istream& is);
+    void handleMsgMonitorAudio(std::istream& is);
+    void handleMsgAudioRedundancy(std::istream& is);
+    void handleMsgAudioTranscode(std::istream& is);
+    void handleMsgUdpKeepaliveInterval(std::istream& is);
+    void handleMsgNodeListSubscribe(std::istream& is);
+    void sendNodeListSnapshot(void);
+    void updateAudioParamsStatus(void);
     void handleMsgTxStatus(std::istream& is);
     void handleRequestQsy(std::istream& is);
     void handleStateEvent(std::istream& is);
@@ -577,33 +898,18 @@ class ReflectorClient : public sigc::trackable
     void onDiscTimeout(Async::Timer *t);
     void disconnect(void);
     void handleHeartbeat(Async::Timer *t);
+    unsigned heartbeatRxCntReset(void) const;
     std::string lookupUserKey(const std::string& callsign);
     void connectionAuthenticated(const std::string& callsign);
     bool sendClientCert(const Async::SslX509& cert);
     void sendAuthChallenge(void);
     void renewClientCertificate(void);
+    void onRenewedClientCert(Async::SslX509& cert);
     void setMonitoredTGs(const std::set<uint32_t>& tgs);
     void setTg(uint32_t tg);
-
-    template <typename T>
-    void setRxParam(char id, const std::string& name, const T& value)
-    {
-      auto it = m_json_rx_map.find(id);
-      if (it != m_json_rx_map.end())
-      {
-        (it->second)[name] = value;
-      }
-    }
-
-    template <typename T>
-    void setTxParam(char id, const std::string& name, const T& value)
-    {
-      auto it = m_json_tx_map.find(id);
-      if (it != m_json_tx_map.end())
-      {
-        (it->second)[name] = value;
-      }
-    }
+    void statusUpdated(void);
+    bool storeRxTelemetry(char id, uint8_t siglev, uint8_t flags,
+                          uint64_t timestamp);
 
 };  /* class ReflectorClient */
 
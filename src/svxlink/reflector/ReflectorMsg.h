@@ -6,7 +6,7 @@
 
 \verbatim
 SvxReflector - An audio reflector for connecting SvxLink Servers
-Copyright (C) 2003-2024 Tobias Blomberg / SM0SVX
+Copyright (C) 2003-2026 Tobias Blomberg / SM0SVX
 
 This program is free software; you can redistribute it and/or modify
 it under the terms of the GNU General Public License as published by
@@ -37,6 +37,9 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 #include <openssl/rand.h>
 #include <openssl/evp.h>
 #include <vector>
+#include <string>
+#include <set>
+#include <cstring>
 
 
 /****************************************************************************
@@ -258,6 +261,196 @@ class ReflectorUdpMsgV2 : public Async::Msg
 };
 
 
+/**
+@brief   A UDP message serialized once for sending to many clients
+@author  Tobias Blomberg / SM0SVX
+@date    2026-10-14
+
+When the same UDP message is sent to a lot of clients, e.g. an audio frame
+relayed to all listeners on a talk group, there is no need to serialize it
+once per client. This class holds the complete plaintext protocol V3
+datagram, since the V3 header does not contain any client specific fields,
+and gives access to the payload part for use with the older V2 header.
+
+A message that is packed by this class is written to a buffer taken from a
+pool of buffers so that no memory is allocated once the pool has warmed up.
+A received datagram that is relayed as is can be wrapped without copying it
+at all. In that case the received buffer must stay valid for as long as this
+object is used, which is the case when relaying from inside the receive
+handler. The pool is not thread safe so this class must only be used in the
+main thread.
+ */
+class ReflectorPackedUdpMsg
+{
+  public:
+    /**
+     * @brief Statistics for the buffer pool
+     */
+    struct PoolStats
+    {
+      uint64_t  packets     = 0;  //!< Number of messages handled
+      uint64_t  allocations = 0;  //!< Number of buffer (re)allocations
+    };
+
+    /**
+     * @brief   Get the statistics for the buffer pool
+     * @return  Returns the statistics for the buffer pool
+     */
+    static const PoolStats& poolStats(void) { return pool().stats; }
+
+    /**
+     * @brief   Constructor
+     * @param   msg The message to pack
+     */
+    explicit ReflectorPackedUdpMsg(const ReflectorUdpMsg& msg)
+      : m_type(msg.type()), m_valid(false), m_body_offset(0)
+    {
+      ReflectorUdpMsg header(m_type);
+      const size_t header_size = header.packedSize();
+      acquireBuffer(header_size + msg.packedSize());
+      Async::MsgBufWriter w(m_buf.data(), m_buf.size());
+      if (header.pack(w) && msg.pack(w))
+      {
+        m_buf.resize(w.size());
+        m_body_offset = header_size;
+        m_valid = true;
+      }
+      m_data = m_buf.data();
+      m_size = m_buf.size();
+    }
+
+    /**
+     * @brief   Constructor for an already packed message payload
+     * @param   type      The message type
+     * @param   body      The packed message payload, without header
+     * @param   body_size The size of the payload
+     *
+     * The payload is copied to a buffer after a newly packed V3 header.
+     */
+    ReflectorPackedUdpMsg(uint16_t type, const uint8_t* body, size_t body_size)
+      : m_type(type), m_valid(false), m_body_offset(0)
+    {
+      ReflectorUdpMsg header(m_type);
+      const size_t header_size = header.packedSize();
+      acquireBuffer(header_size + body_size);
+      Async::MsgBufWriter w(m_buf.data(), m_buf.size());
+      if (header.pack(w))
+      {
+        std::memcpy(m_buf.data() + header_size, body, body_size);
+        m_body_offset = header_size;
+        m_valid = true;
+      }
+      m_data = m_buf.data();
+      m_size = m_buf.size();
+    }
+
+    /**
+     * @brief   Constructor for wrapping an already packed V3 datagram
+     * @param   type        The message type
+     * @param   datagram    The plaintext V3 header followed by the payload
+     * @param   size        The size of the datagram
+     * @param   body_offset The offset to the payload in the datagram
+     *
+     * The datagram is not copied so it must stay valid for the lifetime of
+     * this object.
+     */
+    ReflectorPackedUdpMsg(uint16_t type, const void* datagram, size_t size,
+                          size_t body_offset)
+      : m_type(type), m_valid(body_offset <= size),
+        m_body_offset(body_offset),
+        m_data(static_cast<const uint8_t*>(datagram)), m_size(size)
+    {
+      pool().stats.packets += 1;
+    }
+
+    /**
+     * @brief   Destructor
+     */
+    ~ReflectorPackedUdpMsg(void)
+    {
+      if (m_buf.capacity() > 0)
+      {
+        pool().free.push_back(std::move(m_buf));
+      }
+    }
+
+    /**
+     * @brief   Check if the message was successfully packed
+     * @return  Returns \em true if the packing succeeded
+     */
+    bool isValid(void) const { return m_valid; }
+
+    /**
+     * @brief   Get the message type
+     * @return  Returns the message type
+     */
+    uint16_t type(void) const { return m_type; }
+
+    /**
+     * @brief   Get the packed message payload, without header
+     * @return  Returns a pointer to the start of the payload
+     */
+    const uint8_t* bodyData(void) const { return m_data + m_body_offset; }
+
+    /**
+     * @brief   Get the size of the packed message payload
+     * @return  Returns the payload size in bytes
+     */
+    size_t bodySize(void) const { return m_size - m_body_offset; }
+
+    /**
+     * @brief   Get the packed plaintext datagram for protocol V3 clients
+     * @return  Returns a pointer to the V3 header followed by the payload
+     */
+    const uint8_t* datagramData(void) const { return m_data; }
+
+    /**
+     * @brief   Get the size of the packed plaintext V3 datagram
+     * @return  Returns the size of the V3 datagram in bytes
+     */
+    size_t datagramSize(void) const { return m_size; }
+
+  private:
+    struct Pool
+    {
+      std::vector<std::vector<uint8_t>> free;
+      PoolStats                         stats;
+    };
+
+    static Pool& pool(void)
+    {
+      static Pool the_pool;
+      return the_pool;
+    }
+
+    uint16_t              m_type;
+    bool                  m_valid;
+    size_t                m_body_offset;
+    std::vector<uint8_t>  m_buf;
+    const uint8_t*        m_data = nullptr;
+    size_t                m_size = 0;
+
+    ReflectorPackedUdpMsg(const ReflectorPackedUdpMsg&);
+    ReflectorPackedUdpMsg& operator=(const ReflectorPackedUdpMsg&);
+
+    void acquireBuffer(size_t size)
+    {
+      Pool& p = pool();
+      p.stats.packets += 1;
+      if (!p.free.empty())
+      {
+        m_buf = std::move(p.free.back());
+        p.free.pop_back();
+      }
+      if (m_buf.capacity() < size)
+      {
+        p.stats.allocations += 1;
+      }
+      m_buf.resize(size);
+    }
+};
+
+
 /**
 @brief	 Intermediate template base class for Reflector UDP network messages
 @author  Tobias Blomberg / SM0SVX
@@ -312,7 +505,7 @@ class MsgProtoVer : public ReflectorMsgBase<5>
 {
   public:
     static const uint16_t MAJOR = 3;
-    static const uint16_t MINOR = 0;
+    static const uint16_t MINOR = 4;
     MsgProtoVer(void) : m_major(MAJOR), m_minor(MINOR) {}
     MsgProtoVer(uint16_t major, uint16_t minor)
       : m_major(major), m_minor(minor) {}
@@ -703,7 +896,8 @@ class MsgCABundle : public ReflectorMsgBase<21>
 @date    2023-07-24
 
 This message is sent by the server to the client to inform about server and
-connection properties.
+connection properties. From protocol version 3.4 the node list is left empty.
+Clients use MsgNodeListSubscribe to get it instead.
 */
 class MsgServerInfo : public ReflectorMsgBase<100>
 {
@@ -755,7 +949,8 @@ class MsgNodeList : public ReflectorMsgBase<101>
 @date    2017-02-12
 
 This message is sent by the server to the clients to inform about that a new
-node has connected to the reflector.
+node has connected to the reflector. It is not sent to clients using protocol
+version 3.4 or later. Those get MsgNodeListDelta messages instead.
 */
 class MsgNodeJoined : public ReflectorMsgBase<102>
 {
@@ -777,7 +972,8 @@ class MsgNodeJoined : public ReflectorMsgBase<102>
 @date    2017-02-12
 
 This message is sent by the server to the clients to inform about that a node
-has disconnected from the reflector.
+has disconnected from the reflector. It is not sent to clients using protocol
+version 3.4 or later. Those get MsgNodeListDelta messages instead.
 */
 class MsgNodeLeft : public ReflectorMsgBase<103>
 {
@@ -1395,6 +1591,570 @@ class MsgStartUdpEncryption : public ReflectorMsgBase<114>
 }; /* MsgStartUdpEncryption */
 
 
+/**
+@brief   Receiver telemetry
+@author  Tobias Blomberg / SM0SVX
+@date    2026-10-14
+
+This message is used by a client, using protocol version 3.1 or later, to send
+signal level and squelch state for its receivers to the reflector. It replace
+the MsgSignalStrengthValues message. Each receiver is described by a fixed
+size record so the message is cheap to both build and parse. The message
+timestamp is the wall clock time in milliseconds since the epoch and each
+record carry an offset in milliseconds from that timestamp, telling when the
+values were measured. A client may collect records and send them in batches.
+*/
+class MsgRxTelemetry : public ReflectorMsgBase<115>
+{
+  public:
+    static const uint8_t FLAG_ENABLED   = 0x01;
+    static const uint8_t FLAG_SQL_OPEN  = 0x02;
+    static const uint8_t FLAG_ACTIVE    = 0x04;
+
+    class Record : public Async::Msg
+    {
+      public:
+        Record(void) : m_id('?'), m_siglev(0), m_flags(0), m_time_offset(0) {}
+        Record(char id, uint8_t siglev, uint8_t flags, uint16_t time_offset)
+          : m_id(id), m_siglev(siglev), m_flags(flags),
+            m_time_offset(time_offset) {}
+        char id(void) const { return m_id; }
+        uint8_t siglev(void) const { return m_siglev; }
+        uint8_t flags(void) const { return m_flags; }
+        bool enabled(void) const { return (m_flags & FLAG_ENABLED) != 0; }
+        bool sqlOpen(void) const { return (m_flags & FLAG_SQL_OPEN) != 0; }
+        bool active(void) const { return (m_flags & FLAG_ACTIVE) != 0; }
+        uint16_t timeOffset(void) const { return m_time_offset; }
+
+        ASYNC_MSG_MEMBERS(m_id, m_siglev, m_flags, m_time_offset)
+
+      private:
+        char      m_id;
+        uint8_t   m_siglev;
+        uint8_t   m_flags;
+        uint16_t  m_time_offset;
+    };
+    typedef std::vector<Record> Records;
+
+    static uint8_t flags(bool enabled, bool sql_open, bool active)
+    {
+      return (enabled ? FLAG_ENABLED : 0) | (sql_open ? FLAG_SQL_OPEN : 0) |
+             (active ? FLAG_ACTIVE : 0);
+    }
+
+    MsgRxTelemetry(void) : m_timestamp(0) {}
+    MsgRxTelemetry(uint64_t timestamp) : m_timestamp(timestamp) {}
+    uint64_t timestamp(void) const { return m_timestamp; }
+    uint64_t timestamp(const Record& rec) const
+    {
+      return m_timestamp + rec.timeOffset();
+    }
+    Records& records(void) { return m_records; }
+    const Records& records(void) const { return m_records; }
+    void pushBack(const Record& rec) { m_records.push_back(rec); }
+
+    ASYNC_MSG_MEMBERS(m_timestamp, m_records)
+
+  private:
+    uint64_t  m_timestamp;
+    Records   m_records;
+}; /* MsgRxTelemetry */
+
+
+/**
+@brief   Audio encoding parameters
+@author  Tobias Blomberg / SM0SVX
+@date    2026-10-14
+
+This message is used by a client, using protocol version 3.1 or later, to ask
+the reflector server for audio encoding parameters. This is done after the
+MsgServerInfo message has been received and an audio codec has been selected.
+The server answer with the same message, containing the parameters that the
+client should use. They may differ from what the client asked for depending on
+the server configuration. The audio frames are forwarded unchanged by the
+server so the receiving clients must be able to decode audio using any
+parameters. The frame size is given in tenths of a millisecond.
+*/
+class MsgAudioParams : public ReflectorMsgBase<116>
+{
+  public:
+    static const uint8_t FLAG_DTX = 0x01;
+    static const uint8_t FLAG_FEC = 0x02;
+
+    MsgAudioParams(void)
+      : m_frame_size(0), m_flags(0), m_expected_packet_loss(0) {}
+    MsgAudioParams(uint16_t frame_size, bool dtx, bool fec,
+                   uint8_t expected_packet_loss)
+      : m_frame_size(frame_size),
+        m_flags((dtx ? FLAG_DTX : 0) | (fec ? FLAG_FEC : 0)),
+        m_expected_packet_loss(expected_packet_loss) {}
+    uint16_t frameSize(void) const { return m_frame_size; }
+    bool dtx(void) const { return (m_flags & FLAG_DTX) != 0; }
+    bool fec(void) const { return (m_flags & FLAG_FEC) != 0; }
+    uint8_t expectedPacketLoss(void) const { return m_expected_packet_loss; }
+
+    ASYNC_MSG_MEMBERS(m_frame_size, m_flags, m_expected_packet_loss)
+
+  private:
+    uint16_t  m_frame_size;
+    uint8_t   m_flags;
+    uint8_t   m_expected_packet_loss;
+}; /* MsgAudioParams */
+
+
+/**
+@brief   UDP cipher selection
+@author  Tobias Blomberg / SM0SVX
+@date    2026-10-14
+
+This message is sent by a client, using protocol version 3.2 or later, to
+tell the reflector server which cipher that it will use for its UDP
+datagrams. It must be sent before the MsgNodeInfo message since the cipher
+key in that message must have the length required by the selected cipher.
+The server use the same cipher for the datagrams that it send to the client.
+Valid ciphers are UdpCipher::NAME and UdpCipher::NAME_NO_AES. The latter is
+faster on CPUs without hardware support for AES. A client that does not send
+this message use UdpCipher::NAME.
+*/
+class MsgUdpCipher : public ReflectorMsgBase<117>
+{
+  public:
+    MsgUdpCipher(void) {}
+    MsgUdpCipher(const std::string& name) : m_name(name) {}
+    const std::string& name(void) const { return m_name; }
+
+    ASYNC_MSG_MEMBERS(m_name)
+
+  private:
+    std::string m_name;
+}; /* MsgUdpCipher */
+
+
+/**
+@brief   Request audio for monitored talk groups
+@author  Tobias Blomberg / SM0SVX
+@date    2026-10-14
+
+This message is sent by a client to ask the reflector server to also send the
+audio for talk groups that the client monitor, but has not selected, using
+MsgUdpMonitorAudio messages. The client use the audio to keep a short pre-roll
+buffer for each talk group so that audio can be played directly when a talk
+group with an active talker is selected. A server that does not know about
+this message just ignore it.
+*/
+class MsgMonitorAudio : public ReflectorMsgBase<118>
+{
+  public:
+    MsgMonitorAudio(void) : m_enable(0) {}
+    MsgMonitorAudio(bool enable) : m_enable(enable ? 1 : 0) {}
+    bool enable(void) const { return m_enable != 0; }
+
+    ASYNC_MSG_MEMBERS(m_enable)
+
+  private:
+    uint8_t m_enable;
+}; /* MsgMonitorAudio */
+
+
+/**
+@brief   Request redundant audio
+@author  Tobias Blomberg / SM0SVX
+@date    2026-10-15
+
+This message is sent by a client to ask the reflector server to add the
+previous audio frame to each audio frame sent to the client. The audio is then
+sent using MsgUdpRedundantAudio messages instead of MsgUdpAudio messages. A
+single lost datagram can then be fully recovered by the client, at the cost
+of twice the audio bandwidth. This is useful on links with random packet loss,
+like mobile networks. A server that does not know about this message just
+ignore it.
+*/
+class MsgAudioRedundancy : public ReflectorMsgBase<119>
+{
+  public:
+    MsgAudioRedundancy(void) : m_enable(0) {}
+    MsgAudioRedundancy(bool enable) : m_enable(enable ? 1 : 0) {}
+    bool enable(void) const { return m_enable != 0; }
+
+    ASYNC_MSG_MEMBERS(m_enable)
+
+  private:
+    uint8_t m_enable;
+}; /* MsgAudioRedundancy */
+
+
+/**
+@brief   Request transcoded audio
+@author  Tobias Blomberg / SM0SVX
+@date    2026-10-15
+
+This message is sent by a client to ask the reflector server to transcode the
+audio sent to the client to a low bitrate codec. This is useful on links where
+every byte count, like satellite or HF data links. The audio sent by the
+client must still be encoded using the codec selected from the MsgServerInfo
+message. The server answer with the same message, containing the codec and
+bitrate that will be used. An empty codec name means that the request was
+rejected and that the audio is sent as usual. The client must not switch its
+decoder until the answer has been received. A server that does not know about
+this message just ignore it.
+
+The server transcode the audio once per talk group for each codec and bitrate
+combination that is in use by the clients on the talk group.
+*/
+class MsgAudioTranscode : public ReflectorMsgBase<120>
+{
+  public:
+    MsgAudioTranscode(void) : m_bitrate(0) {}
+    MsgAudioTranscode(const std::string& codec, uint32_t bitrate)
+      : m_codec(codec), m_bitrate(bitrate) {}
+    const std::string& codec(void) const { return m_codec; }
+    uint32_t bitrate(void) const { return m_bitrate; }
+
+    ASYNC_MSG_MEMBERS(m_codec, m_bitrate)
+
+  private:
+    std::string m_codec;
+    uint32_t    m_bitrate;
+}; /* MsgAudioTranscode */
+
+
+/**
+@brief   Negotiate UDP keepalives
+@author  Tobias Blomberg / SM0SVX
+@date    2026-10-15
+
+This message is sent by a client to ask the reflector server to use
+MsgUdpKeepalive messages, sent with the given interval in seconds, instead of
+the usual TCP and UDP heartbeats. The server answer with the same message,
+containing the interval that it accepted. The accepted interval may be
+shorter than the requested one. An interval of zero means that the request
+was rejected and that the usual heartbeats are still used. A server that does
+not know about this message just ignore it so the client must keep sending
+heartbeats until the answer has been received.
+
+When UDP keepalives are in use, both sides take any received UDP datagram as
+a sign that the other side is alive, also for the TCP connection.
+*/
+class MsgUdpKeepaliveInterval : public ReflectorMsgBase<121>
+{
+  public:
+    MsgUdpKeepaliveInterval(void) : m_interval(0) {}
+    MsgUdpKeepaliveInterval(uint16_t interval) : m_interval(interval) {}
+    uint16_t interval(void) const { return m_interval; }
+
+    ASYNC_MSG_MEMBERS(m_interval)
+
+  private:
+    uint16_t m_interval;
+}; /* MsgUdpKeepaliveInterval */
+
+
+/**
+@brief   Subscribe to node membership updates
+@author  Tobias Blomberg / SM0SVX
+@date    2026-10-15
+
+Clients using protocol version 3.4 or later do not get the list of connected
+nodes in the MsgServerInfo message and they do not get any MsgNodeJoined or
+MsgNodeLeft messages. A client that want to know which nodes are connected
+send this message to subscribe to node membership updates.
+
+With SCOPE_ALL the client is told about all connected nodes. With SCOPE_TGS it
+is only told about the nodes that have selected the same talk group as the
+client or one of the talk groups monitored by the client. SCOPE_NONE end the
+subscription. The server answer with a MsgNodeListSnapshot and then keep the
+client up to date using MsgNodeListDelta messages. A new snapshot is sent when
+the set of talk groups of a SCOPE_TGS subscriber change.
+*/
+class MsgNodeListSubscribe : public ReflectorMsgBase<122>
+{
+  public:
+    static const uint8_t SCOPE_NONE = 0;
+    static const uint8_t SCOPE_ALL  = 1;
+    static const uint8_t SCOPE_TGS  = 2;
+
+    MsgNodeListSubscribe(uint8_t scope=SCOPE_NONE) : m_scope(scope) {}
+    uint8_t scope(void) const { return m_scope; }
+
+    ASYNC_MSG_MEMBERS(m_scope)
+
+  private:
+    uint8_t m_scope;
+}; /* MsgNodeListSubscribe */
+
+
+/**
+@brief   A snapshot of the node list
+@author  Tobias Blomberg / SM0SVX
+@date    2026-10-15
+
+This message is sent by the server as an answer to a MsgNodeListSubscribe
+message. A large list is split into pages of at most MAX_PAGE_SIZE nodes that
+are sent directly after each other. The first page replace the node list held
+by the client and the following pages add to it.
+
+The callsigns are sorted and front coded to save space. Each entry only hold
+the part of the callsign that differ from the previous callsign on the same
+page, together with the number of leading characters that are shared.
+
+The version is the value of a counter in the server that is increased on each
+change to the node membership. MsgNodeListDelta messages that follow carry a
+higher version.
+*/
+class MsgNodeListSnapshot : public ReflectorMsgBase<123>
+{
+  public:
+    static const size_t MAX_PAGE_SIZE = 1000;
+
+    MsgNodeListSnapshot(void) : m_version(0), m_page(0), m_page_cnt(0) {}
+    MsgNodeListSnapshot(uint32_t version, uint16_t page, uint16_t page_cnt)
+      : m_version(version), m_page(page), m_page_cnt(page_cnt) {}
+    uint32_t version(void) const { return m_version; }
+    uint16_t page(void) const { return m_page; }
+    uint16_t pageCount(void) const { return m_page_cnt; }
+
+    template <typename InputIt>
+    void setNodes(InputIt first, InputIt last)
+    {
+      m_prefix_len.clear();
+      m_suffixes.clear();
+      std::string prev;
+      for (; first != last; ++first)
+      {
+        const std::string& callsign = *first;
+        size_t len = 0;
+        while ((len < prev.size()) && (len < callsign.size()) &&
+               (len < 255) && (prev[len] == callsign[len]))
+        {
+          ++len;
+        }
+        m_prefix_len.push_back(len);
+        m_suffixes.push_back(callsign.substr(len));
+        prev = callsign;
+      }
+    }
+
+    bool getNodes(std::vector<std::string>& nodes) const
+    {
+      if (m_prefix_len.size() != m_suffixes.size())
+      {
+        return false;
+      }
+      std::string prev;
+      for (size_t i=0; i<m_suffixes.size(); ++i)
+      {
+        if (m_prefix_len[i] > prev.size())
+        {
+          return false;
+        }
+        prev.replace(m_prefix_len[i], std::string::npos, m_suffixes[i]);
+        nodes.push_back(prev);
+      }
+      return true;
+    }
+
+    ASYNC_MSG_MEMBERS(m_version, m_page, m_page_cnt, m_prefix_len, m_suffixes)
+
+  private:
+    uint32_t                  m_version;
+    uint16_t                  m_page;
+    uint16_t                  m_page_cnt;
+    std::vector<uint8_t>      m_prefix_len;
+    std::vector<std::string>  m_suffixes;
+}; /* MsgNodeListSnapshot */
+
+
+/**
+@brief   A change to the node list
+@author  Tobias Blomberg / SM0SVX
+@date    2026-10-15
+
+This message is sent by the server to the clients that have subscribed to
+node membership updates using the MsgNodeListSubscribe message. It replace
+the MsgNodeJoined and MsgNodeLeft messages for those clients. For a SCOPE_TGS
+subscriber a node also join or leave when it switch talk group.
+*/
+class MsgNodeListDelta : public ReflectorMsgBase<124>
+{
+  public:
+    MsgNodeListDelta(void) : m_version(0) {}
+    MsgNodeListDelta(uint32_t version) : m_version(version) {}
+    uint32_t version(void) const { return m_version; }
+    const std::vector<std::string>& joined(void) const { return m_joined; }
+    const std::vector<std::string>& left(void) const { return m_left; }
+    void addJoined(const std::string& callsign)
+    {
+      m_joined.push_back(callsign);
+    }
+    void addLeft(const std::string& callsign) { m_left.push_back(callsign); }
+
+    ASYNC_MSG_MEMBERS(m_version, m_joined, m_left)
+
+  private:
+    uint32_t                  m_version;
+    std::vector<std::string>  m_joined;
+    std::vector<std::string>  m_left;
+}; /* MsgNodeListDelta */
+
+
+/**************************** Trunk Messages ****************************/
+
+/**
+@brief   Trunk hello TCP network message
+@author  Tobias Blomberg / SM0SVX
+@date    2026-10-14
+
+This message is sent by both sides of a trunk connection between two
+reflector servers directly after the TCP connection has been established. It
+contain the name of the trunk, which must be the same in the configuration on
+both sides, a random challenge that the other side must answer using a
+MsgAuthResponse message and the instance id of the sending reflector. The
+instance id is a random number, generated at startup, that is used to decide
+which talker win when two reflectors start talking on the same talk group at
+the same time.
+
+Trunk message types start at 200 and are only valid on a trunk connection.
+The MsgHeartbeat and MsgAuthResponse messages are also used on trunks.
+*/
+class MsgTrunkHello : public ReflectorMsgBase<200>
+{
+  public:
+    static const uint16_t MAJOR = 1;
+    static const uint16_t MINOR = 0;
+
+    MsgTrunkHello(void) : m_major(MAJOR), m_minor(MINOR), m_instance_id(0) {}
+    MsgTrunkHello(const std::string& trunk_name, uint64_t instance_id)
+      : m_major(MAJOR), m_minor(MINOR), m_trunk_name(trunk_name),
+        m_instance_id(instance_id)
+    {
+      m_challenge.resize(MsgAuthChallenge::LENGTH);
+      if (RAND_bytes(&m_challenge.front(), m_challenge.size()) != 1)
+      {
+        std::cerr << "*** WARNING: Failed to generate trunk challenge"
+                  << std::endl;
+        m_challenge.clear();
+      }
+    }
+    uint16_t majorVer(void) const { return m_major; }
+    uint16_t minorVer(void) const { return m_minor; }
+    const std::string& trunkName(void) const { return m_trunk_name; }
+    uint64_t instanceId(void) const { return m_instance_id; }
+    const uint8_t *challenge(void) const
+    {
+      if (m_challenge.size() != MsgAuthChallenge::LENGTH)
+      {
+        return nullptr;
+      }
+      return &m_challenge[0];
+    }
+
+    ASYNC_MSG_MEMBERS(m_major, m_minor, m_trunk_name, m_instance_id,
+                      m_challenge)
+
+  private:
+    uint16_t              m_major;
+    uint16_t              m_minor;
+    std::string           m_trunk_name;
+    uint64_t              m_instance_id;
+    std::vector<uint8_t>  m_challenge;
+}; /* MsgTrunkHello */
+
+
+/**
+@brief   Trunk talk group subscription TCP network message
+@author  Tobias Blomberg / SM0SVX
+@date    2026-10-14
+
+This message is sent over a trunk to tell the other reflector which talk
+groups that have local members or monitors. Only talker state and audio for
+those talk groups are sent over the trunk. The full set is sent every time it
+change.
+*/
+class MsgTrunkSubscribe : public ReflectorMsgBase<201>
+{
+  public:
+    MsgTrunkSubscribe(void) {}
+    MsgTrunkSubscribe(const std::set<uint32_t>& tgs) : m_tgs(tgs) {}
+    const std::set<uint32_t>& tgs(void) const { return m_tgs; }
+
+    ASYNC_MSG_MEMBERS(m_tgs)
+
+  private:
+    std::set<uint32_t> m_tgs;
+}; /* MsgTrunkSubscribe */
+
+
+/**
+@brief   Trunk talker start TCP network message
+@author  Tobias Blomberg / SM0SVX
+@date    2026-10-14
+
+This message is sent over a trunk when a local node start talking on a talk
+group that the other reflector subscribe to.
+*/
+class MsgTrunkTalkerStart : public ReflectorMsgBase<202>
+{
+  public:
+    MsgTrunkTalkerStart(void) : m_tg(0) {}
+    MsgTrunkTalkerStart(uint32_t tg, const std::string& callsign)
+      : m_tg(tg), m_callsign(callsign) {}
+    uint32_t tg(void) const { return m_tg; }
+    const std::string& callsign(void) const { return m_callsign; }
+
+    ASYNC_MSG_MEMBERS(m_tg, m_callsign)
+
+  private:
+    uint32_t    m_tg;
+    std::string m_callsign;
+}; /* MsgTrunkTalkerStart */
+
+
+/**
+@brief   Trunk talker stop TCP network message
+@author  Tobias Blomberg / SM0SVX
+@date    2026-10-14
+
+This message is sent over a trunk when a local talker stop talking. It also
+mark the end of the audio stream for the talk group.
+*/
+class MsgTrunkTalkerStop : public ReflectorMsgBase<203>
+{
+  public:
+    MsgTrunkTalkerStop(uint32_t tg=0) : m_tg(tg) {}
+    uint32_t tg(void) const { return m_tg; }
+
+    ASYNC_MSG_MEMBERS(m_tg)
+
+  private:
+    uint32_t m_tg;
+}; /* MsgTrunkTalkerStop */
+
+
+/**
+@brief   Trunk audio TCP network message
+@author  Tobias Blomberg / SM0SVX
+@date    2026-10-14
+
+This message carry the encoded audio from a local talker over a trunk. The
+audio is forwarded unchanged, in the same format as in a MsgUdpAudio message.
+*/
+class MsgTrunkAudio : public ReflectorMsgBase<204>
+{
+  public:
+    MsgTrunkAudio(void) : m_tg(0) {}
+    MsgTrunkAudio(uint32_t tg, const std::vector<uint8_t>& audio_data)
+      : m_tg(tg), m_audio_data(audio_data) {}
+    uint32_t tg(void) const { return m_tg; }
+    const std::vector<uint8_t>& audioData(void) const { return m_audio_data; }
+
+    ASYNC_MSG_MEMBERS(m_tg, m_audio_data)
+
+  private:
+    uint32_t              m_tg;
+    std::vector<uint8_t>  m_audio_data;
+}; /* MsgTrunkAudio */
+
+
 /***************************** UDP Messages *****************************/
 
 /**
@@ -1413,6 +2173,46 @@ class MsgUdpHeartbeat : public ReflectorUdpMsgBase<1>
 };  /* MsgUdpHeartbeat */
 
 
+/**
+@brief   Keepalive UDP network message
+@author  Tobias Blomberg / SM0SVX
+@date    2026-10-15
+
+This message replace both the TCP and the UDP heartbeats when that has been
+negotiated using the MsgUdpKeepaliveInterval message. The client send it with
+the negotiated interval, randomly varied by up to 20 percent so that many
+clients do not send at the same time. The server answer each keepalive with
+a keepalive but never send one on its own. Like all UDP messages it is
+authenticated using the UDP cipher so it cannot be forged by a third party.
+
+The message also carry the selected talk group and the local audio state of
+the client so that the server can check that its view of the client is up to
+date.
+*/
+class MsgUdpKeepalive : public ReflectorUdpMsgBase<2>
+{
+  public:
+    static const uint8_t FLAG_TALKING   = 0x01;
+    static const uint8_t FLAG_RECEIVING = 0x02;
+
+    MsgUdpKeepalive(void) : m_tg(0), m_flags(0) {}
+    MsgUdpKeepalive(uint32_t tg, bool talking, bool receiving)
+      : m_tg(tg),
+        m_flags((talking ? FLAG_TALKING : 0) |
+                (receiving ? FLAG_RECEIVING : 0)) {}
+    uint32_t tg(void) const { return m_tg; }
+    uint8_t flags(void) const { return m_flags; }
+    bool talking(void) const { return (m_flags & FLAG_TALKING) != 0; }
+    bool receiving(void) const { return (m_flags & FLAG_RECEIVING) != 0; }
+
+    ASYNC_MSG_MEMBERS(m_tg, m_flags)
+
+  private:
+    uint32_t  m_tg;
+    uint8_t   m_flags;
+};  /* MsgUdpKeepalive */
+
+
 /**
 @brief   Audio UDP network message
 @author  Tobias Blomberg / SM0SVX
@@ -1437,6 +2237,31 @@ class MsgUdpAudio : public ReflectorUdpMsgBase<101>
     std::vector<uint8_t>& audioData(void) { return m_audio_data; }
     const std::vector<uint8_t>& audioData(void) const { return m_audio_data; }
 
+    /**
+     * @brief   Find the audio data in a packed message without copying it
+     * @param   r     A reader positioned directly after the message header
+     * @param   buf   The buffer that the reader read from
+     * @param   data  Set to point at the audio data inside buf
+     * @param   size  Set to the number of bytes of audio data
+     * @return  Returns \em true on success or \em false if malformed
+     *
+     * On success, the reader is positioned directly after the message.
+     */
+    static bool peekAudioData(Async::MsgBufReader& r, const void* buf,
+                              const uint8_t*& data, size_t& size)
+    {
+      uint16_t len = 0;
+      if (!Async::MsgPacker<uint16_t>::unpack(r, len) ||
+          (len > r.remaining()))
+      {
+        return false;
+      }
+      data = static_cast<const uint8_t*>(buf) + r.pos();
+      size = len;
+      r.seek(r.pos() + len);
+      return true;
+    }
+
     ASYNC_MSG_MEMBERS(m_audio_data)
 
   private:
@@ -1444,6 +2269,184 @@ class MsgUdpAudio : public ReflectorUdpMsgBase<101>
 }; /* MsgUdpAudio */
 
 
+/**
+@brief   Monitored talk group audio UDP network message
+@author  Tobias Blomberg / SM0SVX
+@date    2026-10-14
+
+This message is sent by the reflector server to a client that has asked for
+monitor audio using the MsgMonitorAudio message. It contain the audio from the
+talker on a talk group that the client monitor but has not selected. No flush
+message is sent at the end of a talker stream. The MsgTalkerStop message tell
+the client that the talker has stopped.
+*/
+class MsgUdpMonitorAudio : public ReflectorUdpMsgBase<105>
+{
+  public:
+    MsgUdpMonitorAudio(void) : m_tg(0) {}
+    MsgUdpMonitorAudio(uint32_t tg, const void *buf, int count)
+      : m_tg(tg)
+    {
+      if (count > 0)
+      {
+        const uint8_t *bbuf = reinterpret_cast<const uint8_t*>(buf);
+        m_audio_data.assign(bbuf, bbuf+count);
+      }
+    }
+    uint32_t tg(void) const { return m_tg; }
+    std::vector<uint8_t>& audioData(void) { return m_audio_data; }
+    const std::vector<uint8_t>& audioData(void) const { return m_audio_data; }
+
+    ASYNC_MSG_MEMBERS(m_tg, m_audio_data)
+
+  private:
+    uint32_t              m_tg;
+    std::vector<uint8_t>  m_audio_data;
+}; /* MsgUdpMonitorAudio */
+
+
+/**
+@brief   Redundant audio UDP network message
+@author  Tobias Blomberg / SM0SVX
+@date    2026-10-15
+
+This message is sent by the reflector server, instead of MsgUdpAudio, to a
+client that has asked for redundant audio using the MsgAudioRedundancy
+message. Beside the audio frame it contain a copy of the previous audio frame
+from the same talker, if any. When the client detect that one frame has been
+lost, the copy is decoded in place of the lost frame.
+*/
+class MsgUdpRedundantAudio : public ReflectorUdpMsgBase<107>
+{
+  public:
+    MsgUdpRedundantAudio(void) {}
+    MsgUdpRedundantAudio(const void *buf, int count,
+                         const std::vector<uint8_t>& prev_audio_data)
+      : m_prev_audio_data(prev_audio_data)
+    {
+      if (count > 0)
+      {
+        const uint8_t *bbuf = reinterpret_cast<const uint8_t*>(buf);
+        m_audio_data.assign(bbuf, bbuf+count);
+      }
+    }
+    std::vector<uint8_t>& audioData(void) { return m_audio_data; }
+    const std::vector<uint8_t>& audioData(void) const { return m_audio_data; }
+    std::vector<uint8_t>& prevAudioData(void) { return m_prev_audio_data; }
+    const std::vector<uint8_t>& prevAudioData(void) const
+    {
+      return m_prev_audio_data;
+    }
+
+    ASYNC_MSG_MEMBERS(m_audio_data, m_prev_audio_data)
+
+  private:
+    std::vector<uint8_t>  m_audio_data;
+    std::vector<uint8_t>  m_prev_audio_data;
+}; /* MsgUdpRedundantAudio */
+
+
+/**
+@brief   Audio latency trace UDP network message
+@author  Tobias Blomberg / SM0SVX
+@date    2026-10-15
+
+This message is used, in protocol version 3.3 or later, to measure the
+latency of the audio path from one node, through the reflector server, to
+another node. A client send it, for a sample of the audio frames, directly
+after the MsgUdpAudio message carrying the frame. Each hop along the path
+append a timestamp, the wall clock time in microseconds since the epoch,
+telling when the frame passed.
+
+The origin node add a HOP_ORIGIN timestamp. The reflector server add a
+HOP_REFLECTOR timestamp, fill in the talk group and origin callsign and then
+relay the message, together with the audio frame, to the other nodes on the
+talk group. A receiving node add a HOP_NODE_RX timestamp and a HOP_PLAYOUT
+timestamp, estimating when the frame will leave the audio buffer of the node,
+and then send the message back to the reflector server. The server use the
+completed traces to build latency histograms per talk group and per path.
+
+Timestamps from different hosts are only comparable if the clocks are
+synchronized, e.g. using NTP.
+*/
+class MsgUdpAudioTrace : public ReflectorUdpMsgBase<106>
+{
+  public:
+    typedef enum
+    {
+      HOP_ORIGIN, HOP_REFLECTOR, HOP_NODE_RX, HOP_PLAYOUT
+    } HopType;
+
+    class Hop : public Async::Msg
+    {
+      public:
+        Hop(void) : m_type(HOP_ORIGIN), m_timestamp(0) {}
+        Hop(HopType type, uint64_t timestamp)
+          : m_type(type), m_timestamp(timestamp) {}
+        HopType type(void) const { return static_cast<HopType>(m_type); }
+        uint64_t timestamp(void) const { return m_timestamp; }
+
+        ASYNC_MSG_MEMBERS(m_type, m_timestamp)
+
+      private:
+        uint8_t   m_type;
+        uint64_t  m_timestamp;
+    };
+    typedef std::vector<Hop> Hops;
+
+    static const size_t MAX_HOPS = 8;
+
+    MsgUdpAudioTrace(void) : m_id(0), m_tg(0) {}
+    MsgUdpAudioTrace(uint32_t id) : m_id(id), m_tg(0) {}
+    uint32_t id(void) const { return m_id; }
+    uint32_t tg(void) const { return m_tg; }
+    void setTg(uint32_t tg) { m_tg = tg; }
+    const std::string& origin(void) const { return m_origin; }
+    void setOrigin(const std::string& origin) { m_origin = origin; }
+    const Hops& hops(void) const { return m_hops; }
+    void addHop(HopType type, uint64_t timestamp)
+    {
+      m_hops.push_back(Hop(type, timestamp));
+    }
+
+    /**
+     * @brief   Find the timestamp for a hop
+     * @param   type      The hop type to look for
+     * @param   timestamp Set to the timestamp of the hop, if found
+     * @return  Returns \em true if the hop was found
+     */
+    bool findHop(HopType type, uint64_t& timestamp) const
+    {
+      for (const auto& hop : m_hops)
+      {
+        if (hop.type() == type)
+        {
+          timestamp = hop.timestamp();
+          return true;
+        }
+      }
+      return false;
+    }
+
+    /**
+     * @brief   Get the type of the last hop
+     * @return  Returns the type of the last hop or HOP_ORIGIN if empty
+     */
+    HopType lastHop(void) const
+    {
+      return m_hops.empty() ? HOP_ORIGIN : m_hops.back().type();
+    }
+
+    ASYNC_MSG_MEMBERS(m_id, m_tg, m_origin, m_hops)
+
+  private:
+    uint32_t    m_id;
+    uint32_t    m_tg;
+    std::string m_origin;
+    Hops        m_hops;
+}; /* MsgUdpAudioTrace */
+
+
 /**
 @brief	 Audio flush UDP network message
 @author  Tobias Blomberg / SM0SVX
@@ -1501,12 +2504,13 @@ namespace UdpCipher
   using IVCntr    = uint32_t;
   using ClientId  = ReflectorUdpMsg::ClientId;
 
-  static constexpr const char*  NAME      = "AES-128-GCM";
-  static constexpr const size_t AADLEN    = 4;
-  static constexpr const size_t TAGLEN    = 8;
-  static constexpr const size_t IVLEN     = 12;
-  static constexpr const size_t IVRANDLEN = IVLEN - sizeof(IVCntr) -
-                                            sizeof(ClientId);
+  static constexpr const char*  NAME        = "AES-128-GCM";
+  static constexpr const char*  NAME_NO_AES = "ChaCha20-Poly1305";
+  static constexpr const size_t AADLEN      = 4;
+  static constexpr const size_t TAGLEN      = 8;
+  static constexpr const size_t IVLEN       = 12;
+  static constexpr const size_t IVRANDLEN   = IVLEN - sizeof(IVCntr) -
+                                              sizeof(ClientId);
 
   struct AAD : public Async::Msg
   {
@@ -1538,6 +2542,13 @@ namespace UdpCipher
         }
       }
 
+      void assignTo(std::vector<uint8_t>& iv) const
+      {
+        iv.resize(IVLEN);
+        Async::MsgBufWriter w(iv.data(), iv.size());
+        pack(w);
+      }
+
       operator std::vector<uint8_t>(void) const
       {
         std::vector<uint8_t> iv;
@@ -0,0 +1,665 @@
+/**
+@file   ReflectorTrunk.cpp
+@brief  A trunk connection between two reflector servers
+@author Tobias Blomberg / SM0SVX
+@date   2026-10-14
+
+\verbatim
+SvxReflector - An audio reflector for connecting SvxLink Servers
+Copyright (C) 2003-2026 Tobias Blomberg / SM0SVX
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+\endverbatim
+*/
+
+/****************************************************************************
+ *
+ * System Includes
+ *
+ ****************************************************************************/
+
+#include <iostream>
+#include <sstream>
+#include <cassert>
+
+
+/****************************************************************************
+ *
+ * Project Includes
+ *
+ ****************************************************************************/
+
+#include <AsyncConfig.h>
+#include <AsyncSslX509.h>
+
+
+/****************************************************************************
+ *
+ * Local Includes
+ *
+ ****************************************************************************/
+
+#include "ReflectorTrunk.h"
+#include "TGHandler.h"
+
+
+/****************************************************************************
+ *
+ * Namespaces to use
+ *
+ ****************************************************************************/
+
+using namespace std;
+using namespace Async;
+
+
+/****************************************************************************
+ *
+ * Defines & typedefs
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Local class definitions
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Prototypes
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Exported Global Variables
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Local Global Variables
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Public member functions
+ *
+ ****************************************************************************/
+
+ReflectorTrunk::ReflectorTrunk(Async::Config& cfg, const std::string& name,
+                               const std::string& ca_file)
+  : m_cfg(cfg), m_name(name), m_port(DEFAULT_PORT), m_ca_file(ca_file),
+    m_client(nullptr),
+    m_con(nullptr), m_state(STATE_DISCONNECTED), m_hello_received(false),
+    m_auth_ok(false), m_peer_id(0),
+    m_reconnect_timer(RECONNECT_INTERVAL, Timer::TYPE_ONESHOT, false),
+    m_heartbeat_timer(1000, Timer::TYPE_PERIODIC, false),
+    m_heartbeat_tx_cnt(HEARTBEAT_TX_CNT_RESET),
+    m_heartbeat_rx_cnt(HEARTBEAT_RX_CNT_RESET)
+{
+  m_reconnect_timer.expired.connect(
+      mem_fun(*this, &ReflectorTrunk::reconnect));
+  m_heartbeat_timer.expired.connect(
+      mem_fun(*this, &ReflectorTrunk::handleHeartbeat));
+} /* ReflectorTrunk::ReflectorTrunk */
+
+
+ReflectorTrunk::~ReflectorTrunk(void)
+{
+  m_frame_con.disconnect();
+  if (m_client != nullptr)
+  {
+    m_client->disconnect();
+    delete m_client;
+    m_client = nullptr;
+  }
+} /* ReflectorTrunk::~ReflectorTrunk */
+
+
+bool ReflectorTrunk::initialize(void)
+{
+  if (!m_cfg.getValue(m_name, "SECRET", m_secret) || m_secret.empty())
+  {
+    cerr << "*** ERROR: " << m_name << "/SECRET must be set for a trunk"
+         << endl;
+    return false;
+  }
+  m_cfg.getValue(m_name, "HOST", m_host);
+  m_cfg.getValue(m_name, "PORT", m_port);
+
+  if (isOutgoing())
+  {
+    m_cfg.getValue(m_name, "CERT_CA_BUNDLE", m_ca_file);
+    if (!m_ssl_ctx.setCaCertificateFile(m_ca_file))
+    {
+      cerr << "*** ERROR: Failed to read CA file '" << m_ca_file
+           << "' for trunk " << m_name << endl;
+      return false;
+    }
+
+    m_client = new FramedTcpClient(m_host, m_port);
+    m_client->connected.connect(
+        mem_fun(*this, &ReflectorTrunk::onConnected));
+    m_client->disconnected.connect(
+        mem_fun(*this, &ReflectorTrunk::onDisconnected));
+    m_client->verifyPeer.connect(
+        mem_fun(*this, &ReflectorTrunk::onVerifyPeer));
+    m_client->sslConnectionReady.connect(
+        mem_fun(*this, &ReflectorTrunk::onSslConnectionReady));
+    m_client->setMaxRxFrameSize(MAX_PREAUTH_FRAME_SIZE);
+    m_client->setMaxTxFrameSize(ReflectorMsg::MAX_POSTAUTH_FRAME_SIZE);
+    cout << m_name << ": Connecting trunk to " << m_host << ":" << m_port
+         << endl;
+    m_client->connect();
+  }
+
+  return true;
+} /* ReflectorTrunk::initialize */
+
+
+bool ReflectorTrunk::acceptConnection(Async::FramedTcpConnection* con,
+                                      const MsgTrunkHello& hello)
+{
+  if (isOutgoing())
+  {
+    cerr << "*** WARNING[" << m_name << "]: Incoming connection from "
+         << con->remoteHost() << ":" << con->remotePort()
+         << " rejected since this side initiate the trunk connection"
+         << endl;
+    return false;
+  }
+  if (m_con != nullptr)
+  {
+    cerr << "*** WARNING[" << m_name << "]: Incoming connection from "
+         << con->remoteHost() << ":" << con->remotePort()
+         << " rejected since the trunk is already connected" << endl;
+    return false;
+  }
+
+  cout << m_name << ": Incoming trunk connection from "
+       << con->remoteHost() << ":" << con->remotePort() << endl;
+  m_con = con;
+  connectionEstablished();
+  if (m_con != nullptr)
+  {
+    handleMsgTrunkHello(hello);
+  }
+  return m_con != nullptr;
+} /* ReflectorTrunk::acceptConnection */
+
+
+void ReflectorTrunk::connectionClosed(Async::FramedTcpConnection* con)
+{
+  if ((m_con == con) && !isOutgoing())
+  {
+    cout << m_name << ": Trunk connection closed" << endl;
+    cleanup();
+  }
+} /* ReflectorTrunk::connectionClosed */
+
+
+void ReflectorTrunk::setLocalTGs(const std::set<uint32_t>& tgs)
+{
+  if (tgs == m_local_tgs)
+  {
+    return;
+  }
+  m_local_tgs = tgs;
+  if (isConnected())
+  {
+    sendMsg(MsgTrunkSubscribe(m_local_tgs));
+  }
+} /* ReflectorTrunk::setLocalTGs */
+
+
+void ReflectorTrunk::sendTalkerStart(uint32_t tg, const std::string& callsign)
+{
+  if (peerWantsTG(tg))
+  {
+    sendMsg(MsgTrunkTalkerStart(tg, callsign));
+  }
+} /* ReflectorTrunk::sendTalkerStart */
+
+
+void ReflectorTrunk::sendTalkerStop(uint32_t tg)
+{
+  if (peerWantsTG(tg))
+  {
+    sendMsg(MsgTrunkTalkerStop(tg));
+  }
+} /* ReflectorTrunk::sendTalkerStop */
+
+
+void ReflectorTrunk::sendAudio(uint32_t tg, const uint8_t* audio, size_t size)
+{
+  if (peerWantsTG(tg))
+  {
+    sendMsg(MsgTrunkAudio(tg, std::vector<uint8_t>(audio, audio + size)));
+  }
+} /* ReflectorTrunk::sendAudio */
+
+
+
+/****************************************************************************
+ *
+ * Protected member functions
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Private member functions
+ *
+ ****************************************************************************/
+
+void ReflectorTrunk::connectionEstablished(void)
+{
+  assert(m_con != nullptr);
+  m_con->setMaxRxFrameSize(MAX_PREAUTH_FRAME_SIZE);
+  m_con->setMaxTxFrameSize(ReflectorMsg::MAX_POSTAUTH_FRAME_SIZE);
+  m_frame_con = m_con->frameReceived.connect(
+      mem_fun(*this, &ReflectorTrunk::onFrameReceived));
+
+  m_hello_received = false;
+  m_auth_ok = false;
+  m_peer_id = 0;
+  m_peer_tgs.clear();
+  m_heartbeat_tx_cnt = HEARTBEAT_TX_CNT_RESET;
+  m_heartbeat_rx_cnt = HEARTBEAT_RX_CNT_RESET;
+  m_heartbeat_timer.setEnable(true);
+
+  MsgTrunkHello hello(m_name, TGHandler::instance()->instanceId());
+  if (hello.challenge() == nullptr)
+  {
+    disconnect();
+    return;
+  }
+  m_challenge.assign(hello.challenge(),
+                     hello.challenge() + MsgAuthChallenge::LENGTH);
+  m_state = STATE_EXPECT_HELLO;
+  sendMsg(hello);
+} /* ReflectorTrunk::connectionEstablished */
+
+
+void ReflectorTrunk::onConnected(void)
+{
+  cout << m_name << ": Trunk connection established to "
+       << m_client->remoteHost() << ":" << m_client->remotePort() << endl;
+  m_con = m_client;
+
+    // Use the heartbeat timeout to give up on a stalled TLS handshake
+  m_heartbeat_tx_cnt = HEARTBEAT_TX_CNT_RESET;
+  m_heartbeat_rx_cnt = HEARTBEAT_RX_CNT_RESET;
+  m_heartbeat_timer.setEnable(true);
+
+  m_client->setSslContext(m_ssl_ctx);
+  m_client->enableSsl(true);
+} /* ReflectorTrunk::onConnected */
+
+
+bool ReflectorTrunk::onVerifyPeer(Async::TcpConnection* con,
+                                  bool preverify_ok,
+                                  X509_STORE_CTX* x509_store_ctx)
+{
+  Async::SslX509 cert(*x509_store_ctx);
+  preverify_ok = preverify_ok && !cert.isNull();
+  preverify_ok = preverify_ok && !cert.commonName().empty();
+  if (!preverify_ok)
+  {
+    cerr << "*** ERROR[" << m_name
+         << "]: Certificate verification failed for trunk peer" << endl;
+    cout << "------------- Peer Certificate --------------" << endl;
+    cert.print();
+    cout << "---------------------------------------------" << endl;
+  }
+  return preverify_ok;
+} /* ReflectorTrunk::onVerifyPeer */
+
+
+void ReflectorTrunk::onSslConnectionReady(Async::TcpConnection* con)
+{
+  cout << m_name << ": Encrypted trunk connection established" << endl;
+  connectionEstablished();
+} /* ReflectorTrunk::onSslConnectionReady */
+
+
+void ReflectorTrunk::onDisconnected(Async::FramedTcpConnection* con,
+                        Async::FramedTcpConnection::DisconnectReason reason)
+{
+  cout << m_name << ": Trunk disconnected: "
+       << TcpConnection::disconnectReasonStr(reason) << endl;
+  cleanup();
+} /* ReflectorTrunk::onDisconnected */
+
+
+void ReflectorTrunk::onFrameReceived(Async::FramedTcpConnection* con,
+                                     std::vector<uint8_t>& data)
+{
+  if ((con != m_con) || (m_state == STATE_DISCONNECTED))
+  {
+    return;
+  }
+
+  auto buf = reinterpret_cast<const char*>(data.data());
+  stringstream ss;
+  ss.write(buf, data.size());
+
+  ReflectorMsg header;
+  if (!header.unpack(ss))
+  {
+    cerr << "*** ERROR[" << m_name
+         << "]: Unpacking failed for trunk message header" << endl;
+    disconnect();
+    return;
+  }
+
+  if ((m_state != STATE_CONNECTED) &&
+      (header.type() != MsgTrunkHello::TYPE) &&
+      (header.type() != MsgAuthResponse::TYPE) &&
+      (header.type() != MsgHeartbeat::TYPE))
+  {
+    cerr << "*** ERROR[" << m_name << "]: Trunk message " << header.type()
+         << " received in unauthenticated state" << endl;
+    disconnect();
+    return;
+  }
+
+  m_heartbeat_rx_cnt = HEARTBEAT_RX_CNT_RESET;
+
+  switch (header.type())
+  {
+    case MsgHeartbeat::TYPE:
+      break;
+    case MsgTrunkHello::TYPE:
+    {
+      MsgTrunkHello msg;
+      if (!msg.unpack(ss))
+      {
+        cerr << "*** ERROR[" << m_name << "]: Could not unpack MsgTrunkHello"
+             << endl;
+        disconnect();
+        return;
+      }
+      handleMsgTrunkHello(msg);
+      break;
+    }
+    case MsgAuthResponse::TYPE:
+      handleMsgAuthResponse(ss);
+      break;
+    case MsgTrunkSubscribe::TYPE:
+      handleMsgTrunkSubscribe(ss);
+      break;
+    case MsgTrunkTalkerStart::TYPE:
+      handleMsgTrunkTalkerStart(ss);
+      break;
+    case MsgTrunkTalkerStop::TYPE:
+      handleMsgTrunkTalkerStop(ss);
+      break;
+    case MsgTrunkAudio::TYPE:
+      handleMsgTrunkAudio(ss);
+      break;
+    default:
+      cerr << "*** WARNING[" << m_name << "]: Unknown trunk message type "
+           << header.type() << endl;
+      break;
+  }
+} /* ReflectorTrunk::onFrameReceived */
+
+
+void ReflectorTrunk::handleMsgTrunkHello(const MsgTrunkHello& msg)
+{
+  if (m_hello_received)
+  {
+    cerr << "*** ERROR[" << m_name << "]: Duplicate MsgTrunkHello" << endl;
+    disconnect();
+    return;
+  }
+  if (msg.majorVer() != MsgTrunkHello::MAJOR)
+  {
+    cerr << "*** ERROR[" << m_name << "]: Incompatible trunk protocol version "
+         << msg.majorVer() << "." << msg.minorVer() << endl;
+    disconnect();
+    return;
+  }
+  if (msg.trunkName() != m_name)
+  {
+    cerr << "*** ERROR[" << m_name << "]: The other side call the trunk \""
+         << msg.trunkName() << "\"" << endl;
+    disconnect();
+    return;
+  }
+  if ((msg.challenge() == nullptr) ||
+      (msg.instanceId() == TGHandler::instance()->instanceId()))
+  {
+    cerr << "*** ERROR[" << m_name << "]: Malformed MsgTrunkHello" << endl;
+    disconnect();
+    return;
+  }
+
+  m_hello_received = true;
+  m_peer_id = msg.instanceId();
+  m_state = STATE_EXPECT_AUTH;
+  sendMsg(MsgAuthResponse(m_name, m_secret, msg.challenge()));
+} /* ReflectorTrunk::handleMsgTrunkHello */
+
+
+void ReflectorTrunk::handleMsgAuthResponse(std::istream& is)
+{
+  MsgAuthResponse msg;
+  if (!msg.unpack(is))
+  {
+    cerr << "*** ERROR[" << m_name << "]: Could not unpack MsgAuthResponse"
+         << endl;
+    disconnect();
+    return;
+  }
+  if ((m_state != STATE_EXPECT_AUTH) || m_auth_ok)
+  {
+    cerr << "*** ERROR[" << m_name << "]: Unexpected MsgAuthResponse"
+         << endl;
+    disconnect();
+    return;
+  }
+  if ((msg.callsign() != m_name) || !msg.verify(m_secret, &m_challenge[0]))
+  {
+    cerr << "*** ERROR[" << m_name << "]: Trunk authentication failed"
+         << endl;
+    disconnect();
+    return;
+  }
+  m_auth_ok = true;
+  checkAuthenticated();
+} /* ReflectorTrunk::handleMsgAuthResponse */
+
+
+void ReflectorTrunk::handleMsgTrunkSubscribe(std::istream& is)
+{
+  MsgTrunkSubscribe msg;
+  if (!msg.unpack(is))
+  {
+    cerr << "*** ERROR[" << m_name << "]: Could not unpack MsgTrunkSubscribe"
+         << endl;
+    disconnect();
+    return;
+  }
+  m_peer_tgs = msg.tgs();
+} /* ReflectorTrunk::handleMsgTrunkSubscribe */
+
+
+void ReflectorTrunk::handleMsgTrunkTalkerStart(std::istream& is)
+{
+  MsgTrunkTalkerStart msg;
+  if (!msg.unpack(is))
+  {
+    cerr << "*** ERROR[" << m_name
+         << "]: Could not unpack MsgTrunkTalkerStart" << endl;
+    disconnect();
+    return;
+  }
+  talkerStartReceived(this, msg.tg(), msg.callsign());
+} /* ReflectorTrunk::handleMsgTrunkTalkerStart */
+
+
+void ReflectorTrunk::handleMsgTrunkTalkerStop(std::istream& is)
+{
+  MsgTrunkTalkerStop msg;
+  if (!msg.unpack(is))
+  {
+    cerr << "*** ERROR[" << m_name
+         << "]: Could not unpack MsgTrunkTalkerStop" << endl;
+    disconnect();
+    return;
+  }
+  talkerStopReceived(this, msg.tg());
+} /* ReflectorTrunk::handleMsgTrunkTalkerStop */
+
+
+void ReflectorTrunk::handleMsgTrunkAudio(std::istream& is)
+{
+  MsgTrunkAudio msg;
+  if (!msg.unpack(is))
+  {
+    cerr << "*** ERROR[" << m_name << "]: Could not unpack MsgTrunkAudio"
+         << endl;
+    disconnect();
+    return;
+  }
+  audioReceived(this, msg.tg(), msg.audioData());
+} /* ReflectorTrunk::handleMsgTrunkAudio */
+
+
+void ReflectorTrunk::checkAuthenticated(void)
+{
+  if (!m_hello_received || !m_auth_ok)
+  {
+    return;
+  }
+  m_con->setMaxRxFrameSize(ReflectorMsg::MAX_POSTAUTH_FRAME_SIZE);
+  m_state = STATE_CONNECTED;
+  cout << m_name << ": Trunk authenticated" << endl;
+  sendMsg(MsgTrunkSubscribe(m_local_tgs));
+  stateChanged(this, true);
+} /* ReflectorTrunk::checkAuthenticated */
+
+
+void ReflectorTrunk::sendMsg(const ReflectorMsg& msg)
+{
+  if ((m_con == nullptr) || !m_con->isConnected())
+  {
+    return;
+  }
+
+  m_heartbeat_tx_cnt = HEARTBEAT_TX_CNT_RESET;
+
+  ReflectorMsg header(msg.type());
+  std::vector<uint8_t> buf(header.packedSize() + msg.packedSize());
+  Async::MsgBufWriter w(buf.data(), buf.size());
+  if (!header.pack(w) || !msg.pack(w))
+  {
+    cerr << "*** ERROR[" << m_name << "]: Failed to pack trunk message "
+         << msg.type() << endl;
+    return;
+  }
+  if (m_con->write(buf.data(), w.size()) == -1)
+  {
+    cerr << "*** ERROR[" << m_name << "]: Failed to write trunk message "
+         << msg.type() << endl;
+  }
+} /* ReflectorTrunk::sendMsg */
+
+
+void ReflectorTrunk::disconnect(void)
+{
+  if (m_con == nullptr)
+  {
+    return;
+  }
+  if (isOutgoing())
+  {
+    m_client->disconnect();
+    cleanup();
+  }
+  else
+  {
+      // The TCP server own the connection so let it finish the job. The
+      // server will call connectionClosed when done.
+    auto con = m_con;
+    con->disconnect();
+    con->disconnected(con, TcpConnection::DR_ORDERED_DISCONNECT);
+  }
+} /* ReflectorTrunk::disconnect */
+
+
+void ReflectorTrunk::cleanup(void)
+{
+  bool was_connected = isConnected();
+  m_frame_con.disconnect();
+  m_con = nullptr;
+  m_state = STATE_DISCONNECTED;
+  m_hello_received = false;
+  m_auth_ok = false;
+  m_peer_tgs.clear();
+  m_heartbeat_timer.setEnable(false);
+  if (isOutgoing())
+  {
+    m_reconnect_timer.setEnable(true);
+  }
+  if (was_connected)
+  {
+    stateChanged(this, false);
+  }
+} /* ReflectorTrunk::cleanup */
+
+
+void ReflectorTrunk::reconnect(Async::Timer* t)
+{
+  cout << m_name << ": Reconnecting trunk to " << m_host << ":" << m_port
+       << endl;
+  m_client->connect();
+} /* ReflectorTrunk::reconnect */
+
+
+void ReflectorTrunk::handleHeartbeat(Async::Timer* t)
+{
+  if (--m_heartbeat_tx_cnt == 0)
+  {
+    sendMsg(MsgHeartbeat());
+  }
+  if (--m_heartbeat_rx_cnt == 0)
+  {
+    cerr << "*** ERROR[" << m_name << "]: Trunk heartbeat timeout" << endl;
+    disconnect();
+  }
+} /* ReflectorTrunk::handleHeartbeat */
+
+
+/*
+ * This file has not been truncated
+ */
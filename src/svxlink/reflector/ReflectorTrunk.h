@@ -0,0 +1,355 @@
+/**
+@file   ReflectorTrunk.h
+@brief  A trunk connection between two reflector servers
+@author Tobias Blomberg / SM0SVX
+@date   2026-10-14
+
+\verbatim
+SvxReflector - An audio reflector for connecting SvxLink Servers
+Copyright (C) 2003-2026 Tobias Blomberg / SM0SVX
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+\endverbatim
+*/
+
+#ifndef REFLECTOR_TRUNK_INCLUDED
+#define REFLECTOR_TRUNK_INCLUDED
+
+
+/****************************************************************************
+ *
+ * System Includes
+ *
+ ****************************************************************************/
+
+#include <sigc++/sigc++.h>
+
+#include <set>
+#include <string>
+#include <vector>
+
+
+/****************************************************************************
+ *
+ * Project Includes
+ *
+ ****************************************************************************/
+
+#include <AsyncTcpClient.h>
+#include <AsyncFramedTcpConnection.h>
+#include <AsyncSslContext.h>
+#include <AsyncTimer.h>
+
+
+/****************************************************************************
+ *
+ * Local Includes
+ *
+ ****************************************************************************/
+
+#include "ReflectorMsg.h"
+
+
+/****************************************************************************
+ *
+ * Forward declarations
+ *
+ ****************************************************************************/
+
+namespace Async
+{
+  class Config;
+};
+
+
+/****************************************************************************
+ *
+ * Namespace
+ *
+ ****************************************************************************/
+
+//namespace MyNameSpace
+//{
+
+
+/****************************************************************************
+ *
+ * Forward declarations of classes inside of the declared namespace
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Defines & typedefs
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Exported Global Variables
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Class definitions
+ *
+ ****************************************************************************/
+
+/**
+@brief  A trunk connection between two reflector servers
+@author Tobias Blomberg / SM0SVX
+@date   2026-10-14
+
+A trunk is used to join talk groups on two reflector servers so that the
+nodes connected to different servers can talk to each other. A number of
+reflectors connected to each other using trunks, in a full mesh, form a
+cluster that can serve more nodes than a single reflector process can.
+
+Each trunk is configured in its own configuration section on both
+reflectors. The side that have HOST set initiate the connection and the
+other side accept it on the GLOBAL/TRUNK_LISTEN_PORT. The connection is
+encrypted using TLS and the connecting side verify the server certificate of
+the other reflector. Both sides then prove that they know the shared SECRET by
+answering a challenge from the other side.
+
+When connected, each side tell the other which talk groups it has members
+or monitors for. Talker start, talker stop and audio is then only sent for
+talk groups that the other side has subscribed to. Audio is never forwarded
+from one trunk to another, which is why the cluster must be a full mesh.
+*/
+class ReflectorTrunk : public sigc::trackable
+{
+  public:
+    /**
+     * @brief The default TCP port for trunk connections
+     */
+    static const uint16_t DEFAULT_PORT = 5302;
+
+    /**
+     * @brief The largest frame accepted before the trunk is authenticated
+     */
+    static const uint32_t MAX_PREAUTH_FRAME_SIZE = 256;
+
+    /**
+     * @brief   Constructor
+     * @param   cfg     The configuration object
+     * @param   name    The name of the trunk configuration section
+     * @param   ca_file The default CA bundle used to verify the other side
+     */
+    ReflectorTrunk(Async::Config& cfg, const std::string& name,
+                   const std::string& ca_file);
+
+    /**
+     * @brief   Destructor
+     */
+    ~ReflectorTrunk(void);
+
+    /**
+     * @brief   Initialize the trunk
+     * @return  Returns \em true on success or \em false on failure
+     *
+     * For an outgoing trunk, the connection attempts are started.
+     */
+    bool initialize(void);
+
+    /**
+     * @brief   Get the name of the trunk
+     * @return  Returns the name of the trunk configuration section
+     */
+    const std::string& name(void) const { return m_name; }
+
+    /**
+     * @brief   Check if this side initiate the connection
+     * @return  Returns \em true if HOST is configured for this trunk
+     */
+    bool isOutgoing(void) const { return !m_host.empty(); }
+
+    /**
+     * @brief   Check if the trunk is connected and authenticated
+     * @return  Returns \em true if the trunk is usable
+     */
+    bool isConnected(void) const { return m_state == STATE_CONNECTED; }
+
+    /**
+     * @brief   Get the instance id of the reflector on the other side
+     * @return  Returns the instance id received in the hello message
+     */
+    uint64_t peerInstanceId(void) const { return m_peer_id; }
+
+    /**
+     * @brief   Take over an incoming connection
+     * @param   con   The connection
+     * @param   hello The hello message received on the connection
+     * @return  Returns \em true if the connection was accepted
+     *
+     * This function is used by the reflector when the first message on an
+     * incoming trunk connection has been received. The connection is still
+     * owned by the TCP server and must already be encrypted.
+     */
+    bool acceptConnection(Async::FramedTcpConnection* con,
+                          const MsgTrunkHello& hello);
+
+    /**
+     * @brief   Tell the trunk that an incoming connection has been closed
+     * @param   con The connection that was closed
+     */
+    void connectionClosed(Async::FramedTcpConnection* con);
+
+    /**
+     * @brief   Check if the other side has subscribed to a talk group
+     * @param   tg The talk group
+     * @return  Returns \em true if the trunk is up and the TG is wanted
+     */
+    bool peerWantsTG(uint32_t tg) const
+    {
+      return isConnected() && (m_peer_tgs.count(tg) > 0);
+    }
+
+    /**
+     * @brief   Set the talk groups this side want to get traffic for
+     * @param   tgs The set of talk groups
+     *
+     * A new subscription is only sent if the set has changed.
+     */
+    void setLocalTGs(const std::set<uint32_t>& tgs);
+
+    /**
+     * @brief   Send a talker start to the other side
+     * @param   tg        The talk group
+     * @param   callsign  The callsign of the local talker
+     */
+    void sendTalkerStart(uint32_t tg, const std::string& callsign);
+
+    /**
+     * @brief   Send a talker stop to the other side
+     * @param   tg The talk group
+     */
+    void sendTalkerStop(uint32_t tg);
+
+    /**
+     * @brief   Send encoded audio to the other side
+     * @param   tg    The talk group
+     * @param   audio The encoded audio
+     * @param   size  The number of bytes of encoded audio
+     */
+    void sendAudio(uint32_t tg, const uint8_t* audio, size_t size);
+
+    /**
+     * @brief A signal that is emitted when the trunk goes up or down
+     * @param trunk The trunk object
+     * @param is_up \em true if the trunk is now connected
+     */
+    sigc::signal<void(ReflectorTrunk*, bool)> stateChanged;
+
+    /**
+     * @brief A signal that is emitted when a talker start is received
+     * @param trunk     The trunk object
+     * @param tg        The talk group
+     * @param callsign  The callsign of the remote talker
+     */
+    sigc::signal<void(ReflectorTrunk*, uint32_t,
+                      const std::string&)> talkerStartReceived;
+
+    /**
+     * @brief A signal that is emitted when a talker stop is received
+     * @param trunk     The trunk object
+     * @param tg        The talk group
+     */
+    sigc::signal<void(ReflectorTrunk*, uint32_t)> talkerStopReceived;
+
+    /**
+     * @brief A signal that is emitted when audio is received
+     * @param trunk     The trunk object
+     * @param tg        The talk group
+     * @param audio     The encoded audio
+     */
+    sigc::signal<void(ReflectorTrunk*, uint32_t,
+                      const std::vector<uint8_t>&)> audioReceived;
+
+  private:
+    typedef Async::TcpClient<Async::FramedTcpConnection> FramedTcpClient;
+    typedef enum
+    {
+      STATE_DISCONNECTED, STATE_EXPECT_HELLO, STATE_EXPECT_AUTH,
+      STATE_CONNECTED
+    } State;
+
+    static const unsigned RECONNECT_INTERVAL      = 5000;
+    static const unsigned HEARTBEAT_TX_CNT_RESET  = 10;
+    static const unsigned HEARTBEAT_RX_CNT_RESET  = 30;
+
+    Async::Config&              m_cfg;
+    const std::string           m_name;
+    std::string                 m_host;
+    uint16_t                    m_port;
+    std::string                 m_secret;
+    std::string                 m_ca_file;
+    Async::SslContext           m_ssl_ctx;
+    FramedTcpClient*            m_client;
+    Async::FramedTcpConnection* m_con;
+    sigc::connection            m_frame_con;
+    State                       m_state;
+    std::vector<uint8_t>        m_challenge;
+    bool                        m_hello_received;
+    bool                        m_auth_ok;
+    uint64_t                    m_peer_id;
+    std::set<uint32_t>          m_local_tgs;
+    std::set<uint32_t>          m_peer_tgs;
+    Async::Timer                m_reconnect_timer;
+    Async::Timer                m_heartbeat_timer;
+    unsigned                    m_heartbeat_tx_cnt;
+    unsigned                    m_heartbeat_rx_cnt;
+
+    ReflectorTrunk(const ReflectorTrunk&);
+    ReflectorTrunk& operator=(const ReflectorTrunk&);
+    void connectionEstablished(void);
+    void onConnected(void);
+    bool onVerifyPeer(Async::TcpConnection* con, bool preverify_ok,
+                      X509_STORE_CTX* x509_store_ctx);
+    void onSslConnectionReady(Async::TcpConnection* con);
+    void onDisconnected(Async::FramedTcpConnection* con,
+                        Async::FramedTcpConnection::DisconnectReason reason);
+    void onFrameReceived(Async::FramedTcpConnection* con,
+                         std::vector<uint8_t>& data);
+    void handleMsgTrunkHello(const MsgTrunkHello& msg);
+    void handleMsgAuthResponse(std::istream& is);
+    void handleMsgTrunkSubscribe(std::istream& is);
+    void handleMsgTrunkTalkerStart(std::istream& is);
+    void handleMsgTrunkTalkerStop(std::istream& is);
+    void handleMsgTrunkAudio(std::istream& is);
+    void checkAuthenticated(void);
+    void sendMsg(const ReflectorMsg& msg);
+    void disconnect(void);
+    void cleanup(void);
+    void reconnect(Async::Timer* t);
+    void handleHeartbeat(Async::Timer* t);
+
+};  /* class ReflectorTrunk */
+
+
+//} /* namespace */
+
+#endif /* REFLECTOR_TRUNK_INCLUDED */
+
+/*
+ * This file has not been truncated
+ */
@@ -0,0 +1,446 @@
+/**
+@file   ReflectorUserDb.cpp
+@brief  A pre-indexed store for user credentials
+@author Tobias Blomberg / SM0SVX
+@date   2026-10-14
+
+\verbatim
+SvxReflector - An audio reflector for connecting SvxLink Servers
+Copyright (C) 2003-2026 Tobias Blomberg / SM0SVX
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+\endverbatim
+*/
+
+/****************************************************************************
+ *
+ * System Includes
+ *
+ ****************************************************************************/
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <iostream>
+#include <algorithm>
+#include <cstring>
+#include <cerrno>
+
+
+/****************************************************************************
+ *
+ * Project Includes
+ *
+ ****************************************************************************/
+
+#include <AsyncConfig.h>
+
+
+/****************************************************************************
+ *
+ * Local Includes
+ *
+ ****************************************************************************/
+
+#include "ReflectorUserDb.h"
+
+
+/****************************************************************************
+ *
+ * Namespaces to use
+ *
+ ****************************************************************************/
+
+using namespace std;
+using namespace Async;
+
+
+/****************************************************************************
+ *
+ * Defines & typedefs
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Local class definitions
+ *
+ ****************************************************************************/
+
+/**
+ * A memory mapped user file. The file is indexed by an array of pointers into
+ * the mapped memory, sorted on callsign, so no strings are allocated.
+ */
+class ReflectorUserDb::UserFile
+{
+  public:
+    struct Str
+    {
+      const char* ptr = nullptr;
+      size_t      len = 0;
+
+      int compare(const char* other, size_t other_len) const
+      {
+        int diff = ::memcmp(ptr, other, std::min(len, other_len));
+        if (diff != 0)
+        {
+          return diff;
+        }
+        return (len < other_len) ? -1 : ((len > other_len) ? 1 : 0);
+      }
+      bool operator<(const Str& other) const
+      {
+        return compare(other.ptr, other.len) < 0;
+      }
+    };
+
+    struct Entry
+    {
+      Str callsign;
+      Str group;
+    };
+
+    UserFile(void) {}
+    UserFile(const UserFile&) = delete;
+    UserFile& operator=(const UserFile&) = delete;
+
+    ~UserFile(void)
+    {
+      if (m_data != nullptr)
+      {
+        ::munmap(m_data, m_size);
+      }
+    } /* ~UserFile */
+
+    bool open(const std::string& path)
+    {
+      int fd = ::open(path.c_str(), O_RDONLY);
+      if (fd < 0)
+      {
+        std::cerr << "*** ERROR: Could not open user file \"" << path
+                  << "\": " << std::strerror(errno) << std::endl;
+        return false;
+      }
+      struct stat st;
+      if (::fstat(fd, &st) < 0)
+      {
+        std::cerr << "*** ERROR: Could not read user file \"" << path
+                  << "\": " << std::strerror(errno) << std::endl;
+        ::close(fd);
+        return false;
+      }
+      if (st.st_size > 0)
+      {
+        void* data = ::mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE,
+                            fd, 0);
+        if (data == MAP_FAILED)
+        {
+          std::cerr << "*** ERROR: Could not map user file \"" << path
+                    << "\": " << std::strerror(errno) << std::endl;
+          ::close(fd);
+          return false;
+        }
+        m_data = data;
+        m_size = st.st_size;
+      }
+      ::close(fd);
+      buildIndex(path);
+      return true;
+    } /* open */
+
+    const Entry* find(const std::string& callsign) const
+    {
+      auto it = std::lower_bound(m_entries.begin(), m_entries.end(), callsign,
+          [](const Entry& e, const std::string& cs)
+          {
+            return e.callsign.compare(cs.data(), cs.size()) < 0;
+          });
+      if ((it == m_entries.end()) ||
+          (it->callsign.compare(callsign.data(), callsign.size()) != 0))
+      {
+        return nullptr;
+      }
+      return &(*it);
+    } /* find */
+
+    size_t size(void) const { return m_entries.size(); }
+
+  private:
+    void*               m_data = nullptr;
+    size_t              m_size = 0;
+    std::vector<Entry>  m_entries;
+
+    static bool isSpace(char ch)
+    {
+      return (ch == ' ') || (ch == '\t') || (ch == '\r');
+    } /* isSpace */
+
+    static Str trim(const char* begin, const char* end)
+    {
+      while ((begin < end) && isSpace(*begin))
+      {
+        ++begin;
+      }
+      while ((end > begin) && isSpace(*(end-1)))
+      {
+        --end;
+      }
+      Str str;
+      str.ptr = begin;
+      str.len = end - begin;
+      return str;
+    } /* trim */
+
+    void buildIndex(const std::string& path)
+    {
+      const char* ptr = static_cast<const char*>(m_data);
+      const char* data_end = ptr + m_size;
+      size_t line_no = 0;
+      while (ptr < data_end)
+      {
+        ++line_no;
+        const char* eol = static_cast<const char*>(
+            ::memchr(ptr, '\n', data_end - ptr));
+        if (eol == nullptr)
+        {
+          eol = data_end;
+        }
+        Str line = trim(ptr, eol);
+        ptr = eol + 1;
+        if ((line.len == 0) || (line.ptr[0] == '#'))
+        {
+          continue;
+        }
+        const char* line_end = line.ptr + line.len;
+        const char* sep = line.ptr;
+        while ((sep < line_end) && !isSpace(*sep) && (*sep != '='))
+        {
+          ++sep;
+        }
+        Entry entry;
+        if (sep < line_end)
+        {
+          entry.callsign = trim(line.ptr, sep);
+          entry.group = trim(sep + 1, line_end);
+        }
+        if ((entry.callsign.len == 0) || (entry.group.len == 0))
+        {
+          std::cerr << "*** WARNING: Illegal line " << line_no
+                    << " in user file \"" << path << "\". Ignored."
+                    << std::endl;
+          continue;
+        }
+        m_entries.push_back(entry);
+      }
+
+        // A stable sort make sure that the first of a number of duplicate
+        // callsigns is found
+      std::stable_sort(m_entries.begin(), m_entries.end(),
+          [](const Entry& lhs, const Entry& rhs)
+          {
+            return lhs.callsign < rhs.callsign;
+          });
+    } /* buildIndex */
+};
+
+
+/****************************************************************************
+ *
+ * Prototypes
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Exported Global Variables
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Local Global Variables
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Public member functions
+ *
+ ****************************************************************************/
+
+ReflectorUserDb::ReflectorUserDb(Async::Config& cfg)
+  : m_cfg(cfg)
+{
+} /* ReflectorUserDb::ReflectorUserDb */
+
+
+ReflectorUserDb::~ReflectorUserDb(void)
+{
+} /* ReflectorUserDb::~ReflectorUserDb */
+
+
+bool ReflectorUserDb::initialize(void)
+{
+  return reload();
+} /* ReflectorUserDb::initialize */
+
+
+bool ReflectorUserDb::reload(void)
+{
+  m_dirty = false;
+  const Table* table = buildTable();
+  if (table == nullptr)
+  {
+    return false;
+  }
+  m_table.reset(table);
+  return true;
+} /* ReflectorUserDb::reload */
+
+
+ReflectorUserDb::Status ReflectorUserDb::lookup(const std::string& callsign,
+                                                std::string& group,
+                                                std::string& key)
+{
+  if (m_dirty || !m_table)
+  {
+    if (!reload() && !m_table)
+    {
+      return USER_UNKNOWN;
+    }
+  }
+
+  auto user_it = m_table->users.find(callsign);
+  if (user_it != m_table->users.end())
+  {
+    group = user_it->second;
+  }
+  else
+  {
+    const UserFile::Entry* entry = nullptr;
+    if (m_table->file)
+    {
+      entry = m_table->file->find(callsign);
+    }
+    if (entry == nullptr)
+    {
+      return USER_UNKNOWN;
+    }
+    group.assign(entry->group.ptr, entry->group.len);
+  }
+  if (group.empty())
+  {
+    return USER_UNKNOWN;
+  }
+
+  auto pw_it = m_table->passwords.find(group);
+  if ((pw_it == m_table->passwords.end()) || pw_it->second.empty())
+  {
+    return USER_NO_PASSWORD;
+  }
+  key = pw_it->second;
+  return USER_OK;
+} /* ReflectorUserDb::lookup */
+
+
+size_t ReflectorUserDb::size(void) const
+{
+  if (!m_table)
+  {
+    return 0;
+  }
+  size_t cnt = m_table->users.size();
+  if (m_table->file)
+  {
+    cnt += m_table->file->size();
+  }
+  return cnt;
+} /* ReflectorUserDb::size */
+
+
+/****************************************************************************
+ *
+ * Protected member functions
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Private member functions
+ *
+ ****************************************************************************/
+
+ReflectorUserDb::Table::~Table(void)
+{
+} /* ReflectorUserDb::Table::~Table */
+
+
+const ReflectorUserDb::Table* ReflectorUserDb::buildTable(void) const
+{
+  std::unique_ptr<Table> table(new Table);
+
+  std::string user_file;
+  m_cfg.getValue("GLOBAL", "USER_DB_FILE", user_file);
+  if (!user_file.empty())
+  {
+    table->file.reset(new UserFile);
+    if (!table->file->open(user_file))
+    {
+      return nullptr;
+    }
+  }
+
+  const auto users = m_cfg.listSection("USERS");
+  table->users.reserve(users.size());
+  for (const auto& callsign : users)
+  {
+    table->users[callsign] = m_cfg.getValue("USERS", callsign);
+  }
+
+  const auto groups = m_cfg.listSection("PASSWORDS");
+  table->passwords.reserve(groups.size());
+  for (const auto& group : groups)
+  {
+    table->passwords[group] = m_cfg.getValue("PASSWORDS", group);
+  }
+
+  std::cout << "Loaded " << table->users.size()
+            << " users from the configuration";
+  if (table->file)
+  {
+    std::cout << " and " << table->file->size() << " users from \""
+              << user_file << "\"";
+  }
+  std::cout << std::endl;
+
+  return table.release();
+} /* ReflectorUserDb::buildTable */
+
+
+/*
+ * This file has not been truncated
+ */
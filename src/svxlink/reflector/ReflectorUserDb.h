@@ -0,0 +1,221 @@
+/**
+@file   ReflectorUserDb.h
+@brief  A pre-indexed store for user credentials
+@author Tobias Blomberg / SM0SVX
+@date   2026-10-14
+
+\verbatim
+SvxReflector - An audio reflector for connecting SvxLink Servers
+Copyright (C) 2003-2026 Tobias Blomberg / SM0SVX
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+\endverbatim
+*/
+
+#ifndef REFLECTOR_USER_DB_INCLUDED
+#define REFLECTOR_USER_DB_INCLUDED
+
+
+/****************************************************************************
+ *
+ * System Includes
+ *
+ ****************************************************************************/
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <unordered_map>
+
+
+/****************************************************************************
+ *
+ * Project Includes
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Local Includes
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Forward declarations
+ *
+ ****************************************************************************/
+
+namespace Async
+{
+  class Config;
+};
+
+
+/****************************************************************************
+ *
+ * Namespace
+ *
+ ****************************************************************************/
+
+//namespace MyNameSpace
+//{
+
+
+/****************************************************************************
+ *
+ * Forward declarations of classes inside of the declared namespace
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Defines & typedefs
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Exported Global Variables
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Class definitions
+ *
+ ****************************************************************************/
+
+/**
+@brief  A pre-indexed store for user credentials
+@author Tobias Blomberg / SM0SVX
+@date   2026-10-14
+
+This class hold the users and passwords that the reflector use to
+authenticate nodes. The USERS and PASSWORDS configuration sections are read
+into hash tables when the store is loaded so that a login only need two hash
+table lookups.
+
+Users may also be stored in a separate file, given by the GLOBAL/USER_DB_FILE
+configuration variable. It has one user per line on the form "CALLSIGN GROUP"
+or "CALLSIGN=GROUP". Empty lines and lines starting with a # are ignored. The
+file is memory mapped and indexed in place so no memory is used for the
+strings, which make it possible to have a very large number of users. A user
+in the USERS section take precedence over the same user in the file.
+
+The store is rebuilt when it has been invalidated, e.g. because a variable in
+the USERS or PASSWORDS section has changed, or when reload is called. A new
+store is completely built before it replace the old one so a failure to
+reread the user file leave the old store in use.
+*/
+class ReflectorUserDb
+{
+  public:
+    /**
+     * @brief The result of looking up a user
+     */
+    typedef enum
+    {
+      USER_OK,          ///< The user and the password was found
+      USER_UNKNOWN,     ///< The user was not found
+      USER_NO_PASSWORD  ///< The user was found but not its password
+    } Status;
+
+    /**
+     * @brief   Constructor
+     * @param   cfg The configuration object
+     */
+    explicit ReflectorUserDb(Async::Config& cfg);
+
+    /**
+     * @brief   Destructor
+     */
+    ~ReflectorUserDb(void);
+
+    /**
+     * @brief   Load the user store
+     * @return  Returns \em true on success or \em false on failure
+     */
+    bool initialize(void);
+
+    /**
+     * @brief   Rebuild the user store
+     * @return  Returns \em true on success or \em false on failure
+     *
+     * If the rebuild fail, the old store is kept.
+     */
+    bool reload(void);
+
+    /**
+     * @brief   Mark the store as out of date
+     *
+     * The store will be rebuilt on the next lookup.
+     */
+    void invalidate(void) { m_dirty = true; }
+
+    /**
+     * @brief   Look up the password for a user
+     * @param   callsign  The callsign of the user
+     * @param   group     Set to the password group of the user
+     * @param   key       Set to the password for the user
+     * @return  Returns the status of the lookup
+     */
+    Status lookup(const std::string& callsign, std::string& group,
+                  std::string& key);
+
+    /**
+     * @brief   Get the number of users
+     * @return  Returns the number of users in the store
+     */
+    size_t size(void) const;
+
+  private:
+    class UserFile;
+    struct Table
+    {
+      std::unordered_map<std::string, std::string>  users;
+      std::unordered_map<std::string, std::string>  passwords;
+      std::unique_ptr<UserFile>                     file;
+      ~Table(void);
+    };
+
+    Async::Config&                m_cfg;
+    std::unique_ptr<const Table>  m_table;
+    bool                          m_dirty = false;
+
+    ReflectorUserDb(const ReflectorUserDb&);
+    ReflectorUserDb& operator=(const ReflectorUserDb&);
+    const Table* buildTable(void) const;
+
+};  /* class ReflectorUserDb */
+
+
+//} /* namespace */
+
+#endif /* REFLECTOR_USER_DB_INCLUDED */
+
+/*
+ * This file has not been truncated
+ */
@@ -6,7 +6,7 @@
 
 \verbatim
 SvxReflector - An audio reflector for connecting SvxLink Servers
-Copyright (C) 2003-2021 Tobias Blomberg / SM0SVX
+Copyright (C) 2003-2026 Tobias Blomberg / SM0SVX
 
 This program is free software; you can redistribute it and/or modify
 it under the terms of the GNU General Public License as published by
@@ -35,6 +35,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 #include <algorithm>
 #include <sstream>
 #include <regex>
+#include <iterator>
 
 
 /****************************************************************************
@@ -111,7 +112,8 @@ using namespace std;
 
 TGHandler::TGHandler(void)
   : m_cfg(0), m_timeout_timer(1000, Async::Timer::TYPE_PERIODIC),
-    m_sql_timeout(0), m_sql_timeout_blocktime(60)
+    m_sql_timeout(0), m_sql_timeout_blocktime(60), m_instance_id(0),
+    m_tick(0)
 {
   m_timeout_timer.expired.connect(
       mem_fun(*this, &TGHandler::checkTimers));
@@ -166,6 +168,7 @@ bool TGHandler::switchTo(ReflectorClient *client, uint32_t tg)
       std::ostringstream ss;
       ss << "TG#" << tg;
       m_cfg->getValue(ss.str(), "AUTO_QSY_AFTER", tg_info->auto_qsy_after_s);
+      m_cfg->getValue(ss.str(), "MAX_TALKERS", tg_info->max_talkers);
       m_id_map[tg] = tg_info;
     }
     tg_info->clients.insert(client);
@@ -191,6 +194,7 @@ void TGHandler::removeClient(ReflectorClient* client)
     removeClientP(tg_info, client);
     //printTGStatus();
   }
+  setMonitoredTGs(client, std::set<uint32_t>());
 } /* TGHandler::removeClient */
 
 
@@ -206,6 +210,59 @@ const TGHandler::ClientSet& TGHandler::clientsForTG(uint32_t tg) const
 } /* TGHandler::clientsForTG */
 
 
+void TGHandler::setMonitoredTGs(ReflectorClient* client,
+                                const std::set<uint32_t>& tgs)
+{
+  ClientMonitorMap::iterator client_it = m_client_monitor_map.find(client);
+  if (client_it != m_client_monitor_map.end())
+  {
+    for (const auto& tg : client_it->second)
+    {
+      if (tgs.count(tg) > 0)
+      {
+        continue;
+      }
+      MonitorMap::iterator mon_it = m_monitor_map.find(tg);
+      if (mon_it != m_monitor_map.end())
+      {
+        mon_it->second.erase(client);
+        if (mon_it->second.empty())
+        {
+          m_monitor_map.erase(mon_it);
+        }
+      }
+    }
+  }
+
+  if (tgs.empty())
+  {
+    if (client_it != m_client_monitor_map.end())
+    {
+      m_client_monitor_map.erase(client_it);
+    }
+    return;
+  }
+
+  for (const auto& tg : tgs)
+  {
+    m_monitor_map[tg].insert(client);
+  }
+  m_client_monitor_map[client] = tgs;
+} /* TGHandler::setMonitoredTGs */
+
+
+const TGHandler::ClientSet& TGHandler::monitorsForTG(uint32_t tg) const
+{
+  static const TGHandler::ClientSet empty_set;
+  MonitorMap::const_iterator mon_it = m_monitor_map.find(tg);
+  if (mon_it == m_monitor_map.end())
+  {
+    return empty_set;
+  }
+  return mon_it->second;
+} /* TGHandler::monitorsForTG */
+
+
 void TGHandler::setTalkerForTG(uint32_t tg, ReflectorClient* new_talker)
 {
   IdMap::const_iterator id_map_it = m_id_map.find(tg);
@@ -220,7 +277,15 @@ void TGHandler::setTalkerForTG(uint32_t tg, ReflectorClient* new_talker)
     gettimeofday(&tg_info->last_talker_timestamp, NULL);
     return;
   }
-  tg_info->sql_timeout_cnt = (new_talker != 0) ? m_sql_timeout : 0;
+  tg_info->sql_timeout_tick = 0;
+  if (new_talker != 0)
+  {
+    if (m_sql_timeout > 0)
+    {
+      tg_info->sql_timeout_tick = m_tick + m_sql_timeout;
+    }
+    scheduleTalkerCheck(tg_info, m_tick + 1);
+  }
   id_map_it->second->talker = new_talker;
   talkerUpdated(tg, old_talker, new_talker);
 
@@ -252,6 +317,17 @@ ReflectorClient* TGHandler::talkerForTG(uint32_t tg) const
 } /* TGHandler::talkerForTG */
 
 
+unsigned TGHandler::maxTalkers(uint32_t tg) const
+{
+  IdMap::const_iterator id_map_it = m_id_map.find(tg);
+  if (id_map_it == m_id_map.end())
+  {
+    return 1;
+  }
+  return id_map_it->second->max_talkers;
+} /* TGHandler::maxTalkers */
+
+
 uint32_t TGHandler::TGForClient(ReflectorClient* client)
 {
   ClientMap::iterator client_map_it = m_client_map.find(client);
@@ -338,6 +414,98 @@ bool TGHandler::isRestricted(uint32_t tg) const
 } /* TGHandler::isRestricted */
 
 
+std::set<uint32_t> TGHandler::activeTGs(void) const
+{
+  std::set<uint32_t> tgs;
+  for (const auto& item : m_id_map)
+  {
+    tgs.insert(item.first);
+  }
+  for (const auto& item : m_monitor_map)
+  {
+    tgs.insert(item.first);
+  }
+  return tgs;
+} /* TGHandler::activeTGs */
+
+
+bool TGHandler::trunkTalkerStart(uint32_t tg, uint64_t peer_id,
+                                 const std::string& callsign)
+{
+  TrunkTalkerMap::iterator it = m_trunk_talker_map.find(tg);
+  if (it != m_trunk_talker_map.end())
+  {
+    if (it->second.peer_id == peer_id)
+    {
+      gettimeofday(&it->second.last_talker_timestamp, NULL);
+      if (it->second.callsign != callsign)
+      {
+        setTrunkTalker(tg, peer_id, callsign);
+      }
+      return true;
+    }
+    if (peer_id < it->second.peer_id)
+    {
+      return false;
+    }
+    setTrunkTalker(tg, peer_id, callsign);
+    return true;
+  }
+
+  ReflectorClient* talker = talkerForTG(tg);
+  if (talker != 0)
+  {
+    if (peer_id < m_instance_id)
+    {
+      return false;
+    }
+    cout << talker->callsign() << ": Talker on TG #" << tg
+         << " lost the arbitration to " << callsign
+         << " on a trunked reflector" << endl;
+    setTalkerForTG(tg, 0);
+  }
+  setTrunkTalker(tg, peer_id, callsign);
+  return true;
+} /* TGHandler::trunkTalkerStart */
+
+
+void TGHandler::trunkTalkerStop(uint32_t tg, uint64_t peer_id)
+{
+  TrunkTalkerMap::iterator it = m_trunk_talker_map.find(tg);
+  if ((it != m_trunk_talker_map.end()) && (it->second.peer_id == peer_id))
+  {
+    clearTrunkTalker(it);
+  }
+} /* TGHandler::trunkTalkerStop */
+
+
+bool TGHandler::trunkTalkerAudio(uint32_t tg, uint64_t peer_id)
+{
+  TrunkTalkerMap::iterator it = m_trunk_talker_map.find(tg);
+  if ((it == m_trunk_talker_map.end()) || (it->second.peer_id != peer_id))
+  {
+    return false;
+  }
+  gettimeofday(&it->second.last_talker_timestamp, NULL);
+  return true;
+} /* TGHandler::trunkTalkerAudio */
+
+
+void TGHandler::removeTrunkTalkers(uint64_t peer_id)
+{
+  TrunkTalkerMap::iterator it = m_trunk_talker_map.begin();
+  while (it != m_trunk_talker_map.end())
+  {
+    TrunkTalkerMap::iterator next = std::next(it);
+    if (it->second.peer_id == peer_id)
+    {
+      clearTrunkTalker(it);
+    }
+    it = next;
+  }
+} /* TGHandler::removeTrunkTalkers */
+
+
 /****************************************************************************
  *
  * Protected member functions
@@ -354,35 +522,95 @@ bool TGHandler::isRestricted(uint32_t tg) const
 
 void TGHandler::checkTimers(Async::Timer *t)
 {
+    // Only the talk groups that have a talker are checked. They are kept in
+    // a timer wheel, indexed by the timer tick when they are due for a check.
+    // An entry is stale if the talk group has been rescheduled or removed.
+  ++m_tick;
+  std::vector<uint32_t> due;
+  due.swap(m_timer_wheel[m_tick % TIMER_WHEEL_SIZE]);
+  for (const auto& tg : due)
+  {
+    IdMap::iterator it = m_id_map.find(tg);
+    if ((it != m_id_map.end()) && (it->second->wheel_tick == m_tick))
+    {
+      checkTalkerTimeout(it->second);
+    }
+  }
+  due.clear();
+  if (m_timer_wheel[m_tick % TIMER_WHEEL_SIZE].empty())
+  {
+    m_timer_wheel[m_tick % TIMER_WHEEL_SIZE].swap(due);
+  }
+
   struct timeval now;
   gettimeofday(&now, NULL);
-  for (IdMap::iterator it = m_id_map.begin(); it != m_id_map.end(); ++it)
+  TrunkTalkerMap::iterator tit = m_trunk_talker_map.begin();
+  while (tit != m_trunk_talker_map.end())
   {
-    TGInfo *tg_info = it->second;
-    assert(tg_info != 0);
-    if (tg_info->talker != 0)
+    TrunkTalkerMap::iterator next = std::next(tit);
+    struct timeval diff;
+    timersub(&now, &tit->second.last_talker_timestamp, &diff);
+    if (diff.tv_sec > TALKER_AUDIO_TIMEOUT)
     {
-      struct timeval diff;
-      timersub(&now, &tg_info->last_talker_timestamp, &diff);
-      if (diff.tv_sec > TALKER_AUDIO_TIMEOUT)
-      {
-        cout << tg_info->talker->callsign() << ": Talker audio timeout on TG #"
-             << tg_info->id << endl;
-        setTalkerForTG(tg_info->id, 0);
-      }
-
-      if ((tg_info->sql_timeout_cnt > 0) && (--tg_info->sql_timeout_cnt == 0))
-      {
-        cout << tg_info->talker->callsign() << ": Talker audio timeout on TG #"
-             << tg_info->id << endl;
-        tg_info->talker->setBlock(m_sql_timeout_blocktime);
-        setTalkerForTG(tg_info->id, 0);
-      }
+      cout << tit->second.callsign << ": Trunk talker audio timeout on TG #"
+           << tit->first << endl;
+      clearTrunkTalker(tit);
     }
+    tit = next;
   }
 } /* TGHandler::checkTimers */
 
 
+void TGHandler::checkTalkerTimeout(TGInfo *tg_info)
+{
+  assert(tg_info != 0);
+  tg_info->wheel_tick = 0;
+  if (tg_info->talker == 0)
+  {
+    return;
+  }
+
+  struct timeval now, diff;
+  gettimeofday(&now, NULL);
+  timersub(&now, &tg_info->last_talker_timestamp, &diff);
+  if (diff.tv_sec > TALKER_AUDIO_TIMEOUT)
+  {
+    cout << tg_info->talker->callsign() << ": Talker audio timeout on TG #"
+         << tg_info->id << endl;
+    setTalkerForTG(tg_info->id, 0);
+    return;
+  }
+
+  if ((tg_info->sql_timeout_tick > 0) && (m_tick >= tg_info->sql_timeout_tick))
+  {
+    cout << tg_info->talker->callsign() << ": Talker audio timeout on TG #"
+         << tg_info->id << endl;
+    tg_info->talker->setBlock(m_sql_timeout_blocktime);
+    setTalkerForTG(tg_info->id, 0);
+    return;
+  }
+
+  uint64_t tick = m_tick + TALKER_AUDIO_TIMEOUT + 1 - diff.tv_sec;
+  if (tg_info->sql_timeout_tick > 0)
+  {
+    tick = std::min(tick, tg_info->sql_timeout_tick);
+  }
+  scheduleTalkerCheck(tg_info, tick);
+} /* TGHandler::checkTalkerTimeout */
+
+
+void TGHandler::scheduleTalkerCheck(TGInfo *tg_info, uint64_t tick)
+{
+  tick = std::min(std::max(tick, m_tick + 1), m_tick + TIMER_WHEEL_SIZE - 1);
+  if ((tg_info->wheel_tick > m_tick) && (tg_info->wheel_tick <= tick))
+  {
+    return;
+  }
+  tg_info->wheel_tick = tick;
+  m_timer_wheel[tick % TIMER_WHEEL_SIZE].push_back(tg_info->id);
+} /* TGHandler::scheduleTalkerCheck */
+
+
 void TGHandler::removeClientP(TGInfo *tg_info, ReflectorClient* client)
 {
   assert(tg_info != 0);
@@ -401,6 +629,28 @@ void TGHandler::removeClientP(TGInfo *tg_info, ReflectorClient* client)
 } /* TGHandler::removeClientP */
 
 
+void TGHandler::setTrunkTalker(uint32_t tg, uint64_t peer_id,
+                               const std::string& callsign)
+{
+  std::string old_callsign;
+  TrunkTalker& talker = m_trunk_talker_map[tg];
+  old_callsign = talker.callsign;
+  talker.peer_id = peer_id;
+  talker.callsign = callsign;
+  gettimeofday(&talker.last_talker_timestamp, NULL);
+  trunkTalkerUpdated(tg, old_callsign, callsign);
+} /* TGHandler::setTrunkTalker */
+
+
+void TGHandler::clearTrunkTalker(TrunkTalkerMap::iterator it)
+{
+  const uint32_t tg = it->first;
+  const std::string old_callsign = it->second.callsign;
+  m_trunk_talker_map.erase(it);
+  trunkTalkerUpdated(tg, old_callsign, "");
+} /* TGHandler::clearTrunkTalker */
+
+
 void TGHandler::printTGStatus(void)
 {
   std::cout << "### ----------- BEGIN ----------------" << std::endl;
@@ -6,7 +6,7 @@
 
 \verbatim
 SvxReflector - An audio reflector for connecting SvxLink Servers
-Copyright (C) 2003-2024 Tobias Blomberg / SM0SVX
+Copyright (C) 2003-2026 Tobias Blomberg / SM0SVX
 
 This program is free software; you can redistribute it and/or modify
 it under the terms of the GNU General Public License as published by
@@ -34,8 +34,13 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
  *
  ****************************************************************************/
 
+#include <array>
 #include <map>
 #include <set>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
 #include <sigc++/sigc++.h>
 #include <sys/time.h>
 
@@ -117,7 +122,7 @@ the system.
 class TGHandler : public sigc::trackable
 {
   public:
-    typedef std::set<ReflectorClient*> ClientSet;
+    typedef std::unordered_set<ReflectorClient*> ClientSet;
 
     static TGHandler* instance(void)
     {
@@ -157,10 +162,38 @@ class TGHandler : public sigc::trackable
 
     const ClientSet& clientsForTG(uint32_t tg) const;
 
+    /**
+     * @brief   Update the set of talk groups monitored by a client
+     * @param   client The client that changed its monitored talk groups
+     * @param   tgs The new set of monitored talk groups
+     *
+     * The handler keeps a per talk group index of monitoring clients so that
+     * talker updates can be sent without scanning all connected clients.
+     */
+    void setMonitoredTGs(ReflectorClient* client,
+                         const std::set<uint32_t>& tgs);
+
+    /**
+     * @brief   Get the clients that monitor a talk group
+     * @param   tg The talk group
+     * @return  Returns the set of clients monitoring the given talk group
+     */
+    const ClientSet& monitorsForTG(uint32_t tg) const;
+
     void setTalkerForTG(uint32_t tg, ReflectorClient* client);
 
     ReflectorClient* talkerForTG(uint32_t tg) const;
 
+    /**
+     * @brief   Get the maximum number of simultaneous talkers for a TG
+     * @param   tg The talk group
+     * @return  Returns the MAX_TALKERS value read when the TG was created
+     *
+     * A value larger than one means that the talk group is a conference
+     * talk group where the audio from up to that many talkers is mixed.
+     */
+    unsigned maxTalkers(uint32_t tg) const;
+
     uint32_t TGForClient(ReflectorClient* client);
 
     bool allowTgSelection(ReflectorClient *client, uint32_t tg);
@@ -169,6 +202,70 @@ class TGHandler : public sigc::trackable
 
     bool showActivity(uint32_t tg) const;
 
+    /**
+     * @brief   Get all talk groups that have local members or monitors
+     * @return  Returns the set of talk groups that are in use locally
+     */
+    std::set<uint32_t> activeTGs(void) const;
+
+    /**
+     * @brief   Set the instance id of this reflector
+     * @param   id The random instance id used for talker arbitration
+     */
+    void setInstanceId(uint64_t id) { m_instance_id = id; }
+
+    /**
+     * @brief   Get the instance id of this reflector
+     * @return  Returns the instance id used for talker arbitration
+     */
+    uint64_t instanceId(void) const { return m_instance_id; }
+
+    /**
+     * @brief   Handle a talker start received from a trunked reflector
+     * @param   tg        The talk group
+     * @param   peer_id   The instance id of the reflector with the talker
+     * @param   callsign  The callsign of the talker
+     * @return  Returns \em true if the remote talker got the talk group
+     *
+     * If a local talker or a talker on another trunk already have the talk
+     * group, the reflector with the highest instance id win. All reflectors
+     * in a cluster see the same talker start messages so they all make the
+     * same decision. If a local talker lose, it is stopped.
+     */
+    bool trunkTalkerStart(uint32_t tg, uint64_t peer_id,
+                          const std::string& callsign);
+
+    /**
+     * @brief   Handle a talker stop received from a trunked reflector
+     * @param   tg        The talk group
+     * @param   peer_id   The instance id of the reflector that sent the stop
+     */
+    void trunkTalkerStop(uint32_t tg, uint64_t peer_id);
+
+    /**
+     * @brief   Check if audio from a trunked reflector should be used
+     * @param   tg        The talk group
+     * @param   peer_id   The instance id of the reflector that sent the audio
+     * @return  Returns \em true if the reflector own the talk group
+     */
+    bool trunkTalkerAudio(uint32_t tg, uint64_t peer_id);
+
+    /**
+     * @brief   Remove all talkers belonging to a trunked reflector
+     * @param   peer_id   The instance id of the reflector
+     */
+    void removeTrunkTalkers(uint64_t peer_id);
+
+    /**
+     * @brief   Check if a talk group is occupied by a trunked talker
+     * @param   tg The talk group
+     * @return  Returns \em true if a remote talker own the talk group
+     */
+    bool hasTrunkTalker(uint32_t tg) const
+    {
+      return m_trunk_talker_map.count(tg) > 0;
+    }
+
     bool isRestricted(uint32_t tg) const;
 
     sigc::signal<void(uint32_t,
@@ -176,8 +273,18 @@ class TGHandler : public sigc::trackable
 
     sigc::signal<void(uint32_t)> requestAutoQsy;
 
+    /**
+     * @brief   A signal emitted when the trunked talker for a TG change
+     * @param   tg            The talk group
+     * @param   old_callsign  The previous talker or empty if none
+     * @param   new_callsign  The new talker or empty if none
+     */
+    sigc::signal<void(uint32_t, const std::string&,
+                      const std::string&)> trunkTalkerUpdated;
+
   private:
     static const time_t TALKER_AUDIO_TIMEOUT = 3; // Max three seconds gap
+    static const size_t TIMER_WHEEL_SIZE = 64;    // Timer ticks (seconds)
 
     struct TGInfo
     {
@@ -185,31 +292,55 @@ class TGHandler : public sigc::trackable
       ClientSet         clients;
       ReflectorClient*  talker;
       struct timeval    last_talker_timestamp;
-      unsigned          sql_timeout_cnt;
+      uint64_t          sql_timeout_tick;
+      uint64_t          wheel_tick;
       time_t            auto_qsy_after_s;
       time_t            auto_qsy_time;
+      unsigned          max_talkers;
 
       TGInfo(uint32_t tg)
-        : id(tg), talker(0), sql_timeout_cnt(0), auto_qsy_after_s(0),
-          auto_qsy_time(-1)
+        : id(tg), talker(0), sql_timeout_tick(0), wheel_tick(0),
+          auto_qsy_after_s(0), auto_qsy_time(-1), max_talkers(1)
       {
         timerclear(&last_talker_timestamp);
       }
     };
-    typedef std::map<uint32_t, TGInfo*>               IdMap;
-    typedef std::map<const ReflectorClient*, TGInfo*> ClientMap;
+    struct TrunkTalker
+    {
+      uint64_t        peer_id;
+      std::string     callsign;
+      struct timeval  last_talker_timestamp;
+    };
+    typedef std::unordered_map<uint32_t, TGInfo*>     IdMap;
+    typedef std::unordered_map<const ReflectorClient*, TGInfo*> ClientMap;
+    typedef std::unordered_map<uint32_t, ClientSet>   MonitorMap;
+    typedef std::unordered_map<const ReflectorClient*, std::set<uint32_t> >
+                                                      ClientMonitorMap;
+    typedef std::map<uint32_t, TrunkTalker>           TrunkTalkerMap;
+    typedef std::array<std::vector<uint32_t>, TIMER_WHEEL_SIZE> TimerWheel;
 
     const Async::Config*  m_cfg;
     IdMap                 m_id_map;
     ClientMap             m_client_map;
+    MonitorMap            m_monitor_map;
+    ClientMonitorMap      m_client_monitor_map;
     Async::Timer          m_timeout_timer;
     unsigned              m_sql_timeout;
     unsigned              m_sql_timeout_blocktime;
+    uint64_t              m_instance_id;
+    TrunkTalkerMap        m_trunk_talker_map;
+    TimerWheel            m_timer_wheel;
+    uint64_t              m_tick;
 
     TGHandler(const TGHandler&);
     TGHandler& operator=(const TGHandler&);
     void checkTimers(Async::Timer *t);
+    void checkTalkerTimeout(TGInfo *tg_info);
+    void scheduleTalkerCheck(TGInfo *tg_info, uint64_t tick);
     void removeClientP(TGInfo *tg_info, ReflectorClient* client);
+    void setTrunkTalker(uint32_t tg, uint64_t peer_id,
+                        const std::string& callsign);
+    void clearTrunkTalker(TrunkTalkerMap::iterator it);
     void printTGStatus(void);
 };  /* class TGHandler */
 
@@ -0,0 +1,511 @@
+/**
+@file   TGMixer.cpp
+@brief  Mix the audio from simultaneous talkers in a talk group
+@author Tobias Blomberg / SM0SVX
+@date   2026-10-14
+
+\verbatim
+SvxReflector - An audio reflector for connecting SvxLink Servers
+Copyright (C) 2003-2026 Tobias Blomberg / SM0SVX
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+\endverbatim
+*/
+
+/****************************************************************************
+ *
+ * System Includes
+ *
+ ****************************************************************************/
+
+#include <sys/time.h>
+
+#include <iostream>
+#include <cassert>
+#include <algorithm>
+
+
+/****************************************************************************
+ *
+ * Project Includes
+ *
+ ****************************************************************************/
+
+#include <AsyncAudioDecoder.h>
+#include <AsyncAudioEncoder.h>
+#include <AsyncAudioCodecPool.h>
+#include <AsyncAudioFifo.h>
+#include <AsyncAudioMixer.h>
+#include <AsyncAudioSplitter.h>
+#include <AsyncAudioPassthrough.h>
+
+
+/****************************************************************************
+ *
+ * Local Includes
+ *
+ ****************************************************************************/
+
+#include "TGMixer.h"
+
+
+/****************************************************************************
+ *
+ * Namespaces to use
+ *
+ ****************************************************************************/
+
+using namespace std;
+using namespace Async;
+
+
+/****************************************************************************
+ *
+ * Defines & typedefs
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Local class definitions
+ *
+ ****************************************************************************/
+
+struct TGMixer::Output
+{
+  AudioMixer    mixer;
+  AudioEncoder* enc;
+  Slot*         slot;
+  bool          active;
+
+  Output(Slot* slot) : enc(nullptr), slot(slot), active(false) {}
+  ~Output(void) { AudioCodecPool::instance().release(enc); }
+};
+
+
+struct TGMixer::Slot
+{
+  ReflectorClient*  client;
+  AudioDecoder*     dec;
+  AudioFifo         fifo;
+  AudioSplitter     splitter;
+  Output*           mix_minus;
+  struct timeval    last_audio;
+  bool              flushing;
+
+  Slot(void)
+    : client(nullptr), dec(nullptr),
+      fifo(FIFO_SIZE * INTERNAL_SAMPLE_RATE / 1000), mix_minus(nullptr),
+      flushing(false)
+  {
+    timerclear(&last_audio);
+  }
+};
+
+
+/****************************************************************************
+ *
+ * Prototypes
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Exported Global Variables
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Local Global Variables
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Public member functions
+ *
+ ****************************************************************************/
+
+TGMixer::TGMixer(uint32_t tg, unsigned max_talkers, const std::string& codec)
+  : m_tg(tg), m_init_ok(false), m_full_mix(nullptr),
+    m_check_timer(CHECK_INTERVAL, Timer::TYPE_PERIODIC, false)
+{
+  m_check_timer.expired.connect(mem_fun(*this, &TGMixer::checkSlots));
+
+  max_talkers = std::min(std::max(max_talkers, 1U), MAX_TALKERS);
+  bool init_ok = true;
+  for (unsigned i=0; i<max_talkers; ++i)
+  {
+    Slot* slot = new Slot;
+    m_slots.push_back(slot);
+    slot->dec = AudioCodecPool::instance().createDecoder(codec);
+    if (slot->dec == nullptr)
+    {
+      init_ok = false;
+      continue;
+    }
+    slot->fifo.setPrebufSamples(PREBUF_SIZE * INTERNAL_SAMPLE_RATE / 1000);
+    slot->fifo.setOverwrite(true);
+    slot->dec->registerSink(&slot->fifo);
+    slot->fifo.registerSink(&slot->splitter);
+    slot->mix_minus = createOutput(codec, slot);
+    init_ok = init_ok && (slot->mix_minus->enc != nullptr);
+  }
+  m_full_mix = createOutput(codec, nullptr);
+  init_ok = init_ok && (m_full_mix->enc != nullptr);
+  if (!init_ok)
+  {
+    cerr << "*** ERROR: Failed to initialize " << codec
+         << " audio codec for the mixer on TG #" << m_tg << endl;
+    return;
+  }
+
+    // The audio from each talker go to the full mix and to the mix for
+    // each of the other talkers
+  for (const auto& slot : m_slots)
+  {
+    AudioPassthrough* branch = new AudioPassthrough;
+    slot->splitter.addSink(branch, true);
+    m_full_mix->mixer.addSource(branch);
+    for (const auto& other : m_slots)
+    {
+      if (other != slot)
+      {
+        branch = new AudioPassthrough;
+        slot->splitter.addSink(branch, true);
+        other->mix_minus->mixer.addSource(branch);
+      }
+    }
+  }
+
+  m_init_ok = true;
+} /* TGMixer::TGMixer */
+
+
+TGMixer::~TGMixer(void)
+{
+    // The encoders are handed back to the codec pool by the outputs
+  delete m_full_mix;
+  m_full_mix = nullptr;
+  for (auto& slot : m_slots)
+  {
+    delete slot->mix_minus;
+    slot->mix_minus = nullptr;
+  }
+  for (auto& slot : m_slots)
+  {
+    slot->fifo.unregisterSink();
+    AudioCodecPool::instance().release(slot->dec);
+    delete slot;
+  }
+  m_slots.clear();
+} /* TGMixer::~TGMixer */
+
+
+void TGMixer::setEncoderOption(const std::string& name,
+                               const std::string& value)
+{
+  if (m_full_mix->enc != nullptr)
+  {
+    m_full_mix->enc->setOption(name, value);
+  }
+  for (const auto& slot : m_slots)
+  {
+    if ((slot->mix_minus != nullptr) && (slot->mix_minus->enc != nullptr))
+    {
+      slot->mix_minus->enc->setOption(name, value);
+    }
+  }
+} /* TGMixer::setEncoderOption */
+
+
+void TGMixer::printCodecParams(void)
+{
+  if (m_full_mix->enc != nullptr)
+  {
+    m_full_mix->enc->printCodecParams();
+  }
+} /* TGMixer::printCodecParams */
+
+
+bool TGMixer::writeAudio(ReflectorClient* client, const void* buf, int size)
+{
+  assert(m_init_ok);
+
+  Slot* slot = nullptr;
+  Slot* free_slot = nullptr;
+  for (const auto& s : m_slots)
+  {
+    if (s->client == client)
+    {
+      slot = s;
+      break;
+    }
+    if ((free_slot == nullptr) && (s->client == nullptr))
+    {
+      free_slot = s;
+    }
+  }
+
+  if (slot == nullptr)
+  {
+    if (free_slot == nullptr)
+    {
+      return false;
+    }
+    slot = free_slot;
+    slot->client = client;
+    cout << client->callsign() << ": Conference talker start on TG #"
+         << m_tg << " (" << talkerCount() << "/" << m_slots.size() << ")"
+         << endl;
+
+      // The client get the mix of the other talkers from now on so the
+      // full mix stream that it may have been receiving must be ended
+    if (m_full_mix->active)
+    {
+      mixFlushed(client);
+    }
+  }
+
+  slot->flushing = false;
+  gettimeofday(&slot->last_audio, NULL);
+  slot->dec->writeEncodedSamples(const_cast<void*>(buf), size);
+  m_check_timer.setEnable(true);
+
+  return true;
+} /* TGMixer::writeAudio */
+
+
+void TGMixer::flushAudio(ReflectorClient* client)
+{
+  for (const auto& slot : m_slots)
+  {
+    if (slot->client == client)
+    {
+      if (!slot->flushing)
+      {
+        slot->flushing = true;
+        slot->dec->flushEncodedSamples();
+      }
+      return;
+    }
+  }
+} /* TGMixer::flushAudio */
+
+
+void TGMixer::removeClient(ReflectorClient* client)
+{
+  for (const auto& slot : m_slots)
+  {
+    if (slot->client == client)
+    {
+      if (!slot->flushing)
+      {
+        slot->dec->flushEncodedSamples();
+      }
+      slot->mix_minus->active = false;
+      releaseSlot(slot);
+      return;
+    }
+  }
+} /* TGMixer::removeClient */
+
+
+bool TGMixer::isTalker(const ReflectorClient* client) const
+{
+  for (const auto& slot : m_slots)
+  {
+    if (slot->client == client)
+    {
+      return true;
+    }
+  }
+  return false;
+} /* TGMixer::isTalker */
+
+
+unsigned TGMixer::talkerCount(void) const
+{
+  unsigned cnt = 0;
+  for (const auto& slot : m_slots)
+  {
+    if (slot->client != nullptr)
+    {
+      ++cnt;
+    }
+  }
+  return cnt;
+} /* TGMixer::talkerCount */
+
+
+bool TGMixer::isIdle(void) const
+{
+  if (m_full_mix->active)
+  {
+    return false;
+  }
+  for (const auto& slot : m_slots)
+  {
+    if ((slot->client != nullptr) || slot->mix_minus->active)
+    {
+      return false;
+    }
+  }
+  return true;
+} /* TGMixer::isIdle */
+
+
+
+/****************************************************************************
+ *
+ * Protected member functions
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Private member functions
+ *
+ ****************************************************************************/
+
+TGMixer::Output* TGMixer::createOutput(const std::string& codec, Slot* slot)
+{
+  Output* out = new Output(slot);
+  out->enc = AudioCodecPool::instance().createEncoder(codec);
+  if (out->enc == nullptr)
+  {
+    return out;
+  }
+  out->enc->writeEncodedSamples.connect(
+      sigc::bind(mem_fun(*this, &TGMixer::onEncodedAudio), out));
+  out->enc->flushEncodedSamples.connect(
+      sigc::bind(mem_fun(*this, &TGMixer::onEncodedFlush), out));
+  out->mixer.setSoftLimiter(true);
+  out->mixer.registerSink(out->enc, true);
+  return out;
+} /* TGMixer::createOutput */
+
+
+void TGMixer::onEncodedAudio(const void* buf, int size, Output* out)
+{
+  ReflectorClient* to = nullptr;
+  if (out->slot != nullptr)
+  {
+    to = out->slot->client;
+    if (to == nullptr)
+    {
+      return;
+    }
+  }
+  out->active = true;
+  audioMixed(to, buf, size);
+} /* TGMixer::onEncodedAudio */
+
+
+void TGMixer::onEncodedFlush(Output* out)
+{
+  if (out->active)
+  {
+    out->active = false;
+    ReflectorClient* to = nullptr;
+    if (out->slot != nullptr)
+    {
+      to = out->slot->client;
+    }
+    if ((out->slot == nullptr) || (to != nullptr))
+    {
+      mixFlushed(to);
+    }
+  }
+  out->enc->allEncodedSamplesFlushed();
+} /* TGMixer::onEncodedFlush */
+
+
+void TGMixer::releaseSlot(Slot* slot)
+{
+  ReflectorClient* client = slot->client;
+  slot->client = nullptr;
+  slot->flushing = false;
+  timerclear(&slot->last_audio);
+    // The next talker in this slot start a new stream so the decoder state
+    // left by this talker must not be used
+  slot->dec->reset();
+  cout << client->callsign() << ": Conference talker stop on TG #"
+       << m_tg << endl;
+  if (slot->mix_minus->active)
+  {
+    slot->mix_minus->active = false;
+    mixFlushed(client);
+  }
+} /* TGMixer::releaseSlot */
+
+
+void TGMixer::checkSlots(Async::Timer* t)
+{
+  struct timeval now;
+  gettimeofday(&now, NULL);
+  bool busy = false;
+  for (const auto& slot : m_slots)
+  {
+    if (slot->client == nullptr)
+    {
+      continue;
+    }
+    if (slot->flushing)
+    {
+        // Keep excluding the talker from the full mix until its own audio
+        // has been played out
+      if (slot->fifo.empty())
+      {
+        releaseSlot(slot);
+      }
+      else
+      {
+        busy = true;
+      }
+      continue;
+    }
+    struct timeval diff;
+    timersub(&now, &slot->last_audio, &diff);
+    if (diff.tv_sec * 1000 + diff.tv_usec / 1000 > TALKER_AUDIO_TIMEOUT)
+    {
+      cout << slot->client->callsign()
+           << ": Conference talker audio timeout on TG #" << m_tg << endl;
+      slot->flushing = true;
+      slot->dec->flushEncodedSamples();
+    }
+    busy = true;
+  }
+  if (!busy)
+  {
+    m_check_timer.setEnable(false);
+  }
+} /* TGMixer::checkSlots */
+
+
+/*
+ * This file has not been truncated
+ */
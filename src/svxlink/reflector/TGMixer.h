@@ -0,0 +1,286 @@
+/**
+@file   TGMixer.h
+@brief  Mix the audio from simultaneous talkers in a talk group
+@author Tobias Blomberg / SM0SVX
+@date   2026-10-14
+
+\verbatim
+SvxReflector - An audio reflector for connecting SvxLink Servers
+Copyright (C) 2003-2026 Tobias Blomberg / SM0SVX
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+\endverbatim
+*/
+
+#ifndef TG_MIXER_INCLUDED
+#define TG_MIXER_INCLUDED
+
+
+/****************************************************************************
+ *
+ * System Includes
+ *
+ ****************************************************************************/
+
+#include <sigc++/sigc++.h>
+
+#include <string>
+#include <vector>
+
+
+/****************************************************************************
+ *
+ * Project Includes
+ *
+ ****************************************************************************/
+
+#include <AsyncTimer.h>
+
+
+/****************************************************************************
+ *
+ * Local Includes
+ *
+ ****************************************************************************/
+
+#include "ReflectorClient.h"
+
+
+/****************************************************************************
+ *
+ * Forward declarations
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Namespace
+ *
+ ****************************************************************************/
+
+//namespace MyNameSpace
+//{
+
+
+/****************************************************************************
+ *
+ * Forward declarations of classes inside of the declared namespace
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Defines & typedefs
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Exported Global Variables
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Class definitions
+ *
+ ****************************************************************************/
+
+/**
+@brief  Mix the audio from simultaneous talkers in a talk group
+@author Tobias Blomberg / SM0SVX
+@date   2026-10-14
+
+Normally the reflector just forward the encoded audio from the single
+talker in a talk group to all other members. For a conference talk group,
+configured using MAX_TALKERS in a TG#<n> configuration section, up to that
+many clients may talk at the same time. The audio from each talker is
+decoded and the streams are added together using an Async::AudioMixer.
+
+The full mix is encoded once and sent to all members of the talk group that
+are not talking. Each talker get a mix of all the other talkers so that it
+does not hear itself. That make the number of encoders grow with the number
+of simultaneous talkers, not with the number of listeners.
+
+Each talker get its own slot with a decoder and a small FIFO that absorb
+network jitter. A slot is released when the talker flush its audio stream
+or when no audio has been received from the talker for a while.
+*/
+class TGMixer : public sigc::trackable
+{
+  public:
+    /**
+     * @brief The largest number of simultaneous talkers that can be mixed
+     */
+    static const unsigned MAX_TALKERS = 8;
+
+    /**
+     * @brief A client filter that only match clients that are not talking
+     */
+    class ListenerFilter : public ReflectorClient::Filter
+    {
+      public:
+        ListenerFilter(const TGMixer& mixer) : m_mixer(mixer) {}
+        virtual bool operator ()(ReflectorClient *client) const
+        {
+          return !m_mixer.isTalker(client);
+        }
+      private:
+        const TGMixer& m_mixer;
+    };
+
+    /**
+     * @brief   Constructor
+     * @param   tg          The talk group that this mixer is used for
+     * @param   max_talkers The maximum number of simultaneous talkers
+     * @param   codec       The name of the audio codec to use
+     */
+    TGMixer(uint32_t tg, unsigned max_talkers, const std::string& codec);
+
+    /**
+     * @brief   Destructor
+     */
+    ~TGMixer(void);
+
+    /**
+     * @brief   Check if the initialization was ok
+     * @return  Returns \em true if all decoders and encoders were created
+     */
+    bool initOk(void) const { return m_init_ok; }
+
+    /**
+     * @brief   Get the talk group that this mixer is used for
+     * @return  Returns the talk group number
+     */
+    uint32_t tg(void) const { return m_tg; }
+
+    /**
+     * @brief   Get the maximum number of simultaneous talkers
+     * @return  Returns the number of talker slots
+     */
+    unsigned maxTalkers(void) const { return m_slots.size(); }
+
+    /**
+     * @brief   Set an option on all encoders
+     * @param   name  The name of the option
+     * @param   value The value of the option
+     */
+    void setEncoderOption(const std::string& name, const std::string& value);
+
+    /**
+     * @brief   Print the codec parameters of the encoders
+     */
+    void printCodecParams(void);
+
+    /**
+     * @brief   Write encoded audio received from a client
+     * @param   client  The client that sent the audio
+     * @param   buf     The buffer containing the encoded audio
+     * @param   size    The number of bytes in the buffer
+     * @return  Returns \em true if the audio was accepted or \em false if all
+     *          talker slots are busy
+     */
+    bool writeAudio(ReflectorClient* client, const void* buf, int size);
+
+    /**
+     * @brief   Tell the mixer that a client has ended its audio stream
+     * @param   client The client that flushed its audio stream
+     */
+    void flushAudio(ReflectorClient* client);
+
+    /**
+     * @brief   Remove a client from the mixer
+     * @param   client The client to remove
+     *
+     * This function must be called before a client object is deleted.
+     */
+    void removeClient(ReflectorClient* client);
+
+    /**
+     * @brief   Check if a client is talking
+     * @param   client The client to check
+     * @return  Returns \em true if the client currently occupy a talker slot
+     */
+    bool isTalker(const ReflectorClient* client) const;
+
+    /**
+     * @brief   Get the number of active talkers
+     * @return  Returns the number of occupied talker slots
+     */
+    unsigned talkerCount(void) const;
+
+    /**
+     * @brief   Check if the mixer is idle
+     * @return  Returns \em true if there are no talkers and no active stream
+     */
+    bool isIdle(void) const;
+
+    /**
+     * @brief A signal that is emitted when mixed audio has been encoded
+     * @param to    The talker to send the audio to or \em nullptr if the
+     *              audio should be sent to all clients that are not talking
+     * @param buf   The buffer containing the encoded audio
+     * @param size  The number of bytes in the buffer
+     */
+    sigc::signal<void(ReflectorClient*, const void*, int)> audioMixed;
+
+    /**
+     * @brief A signal that is emitted when a mixed audio stream has ended
+     * @param to    The talker to send the flush to or \em nullptr if it
+     *              should be sent to all clients that are not talking
+     */
+    sigc::signal<void(ReflectorClient*)> mixFlushed;
+
+  private:
+    static const unsigned TALKER_AUDIO_TIMEOUT  = 1000;
+    static const unsigned PREBUF_SIZE           = 60;
+    static const unsigned FIFO_SIZE             = 500;
+    static const unsigned CHECK_INTERVAL        = 100;
+
+    struct Output;
+    struct Slot;
+
+    const uint32_t        m_tg;
+    bool                  m_init_ok;
+    std::vector<Slot*>    m_slots;
+    Output*               m_full_mix;
+    Async::Timer          m_check_timer;
+
+    TGMixer(const TGMixer&);
+    TGMixer& operator=(const TGMixer&);
+    Output* createOutput(const std::string& codec, Slot* slot);
+    void onEncodedAudio(const void* buf, int size, Output* out);
+    void onEncodedFlush(Output* out);
+    void releaseSlot(Slot* slot);
+    void checkSlots(Async::Timer* t);
+
+};  /* class TGMixer */
+
+
+//} /* namespace */
+
+#endif /* TG_MIXER_INCLUDED */
+
+/*
+ * This file has not been truncated
+ */
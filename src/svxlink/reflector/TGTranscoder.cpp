@@ -0,0 +1,277 @@
+/**
+@file   TGTranscoder.cpp
+@brief  Transcode the audio in a talk group to low bitrate codecs
+@author Tobias Blomberg / SM0SVX
+@date   2026-10-15
+
+\verbatim
+SvxReflector - An audio reflector for connecting SvxLink Servers
+Copyright (C) 2003-2026 Tobias Blomberg / SM0SVX
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+\endverbatim
+*/
+
+/****************************************************************************
+ *
+ * System Includes
+ *
+ ****************************************************************************/
+
+#include <iostream>
+
+
+/****************************************************************************
+ *
+ * Project Includes
+ *
+ ****************************************************************************/
+
+#include <AsyncAudioDecoder.h>
+#include <AsyncAudioEncoder.h>
+#include <AsyncAudioCodecPool.h>
+
+
+/****************************************************************************
+ *
+ * Local Includes
+ *
+ ****************************************************************************/
+
+#include "TGTranscoder.h"
+
+
+/****************************************************************************
+ *
+ * Namespaces to use
+ *
+ ****************************************************************************/
+
+using namespace std;
+using namespace Async;
+
+
+/****************************************************************************
+ *
+ * Defines & typedefs
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Local class definitions
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Prototypes
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Exported Global Variables
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Local Global Variables
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Public member functions
+ *
+ ****************************************************************************/
+
+bool TGTranscoder::profileIsValid(const std::string& codec, uint32_t bitrate)
+{
+  if (!AudioEncoder::isAvailable(codec))
+  {
+    return false;
+  }
+  if (codec == "CODEC2")
+  {
+    static const uint32_t codec2_bitrates[] =
+    {
+      3200, 2400, 1600, 1400, 1300, 1200, 700, 0
+    };
+    for (const uint32_t* br = codec2_bitrates; *br != 0; ++br)
+    {
+      if (bitrate == *br)
+      {
+        return true;
+      }
+    }
+    return false;
+  }
+  if (codec == "OPUS")
+  {
+    return (bitrate >= OPUS_MIN_BITRATE) && (bitrate <= OPUS_MAX_BITRATE);
+  }
+  return false;
+} /* TGTranscoder::profileIsValid */
+
+
+std::string TGTranscoder::profileName(const std::string& codec,
+                                      uint32_t bitrate)
+{
+  return codec + "/" + std::to_string(bitrate);
+} /* TGTranscoder::profileName */
+
+
+TGTranscoder::TGTranscoder(uint32_t tg, const std::string& codec)
+  : m_tg(tg), m_dec(nullptr), m_active(false)
+{
+  m_dec = AudioCodecPool::instance().createDecoder(codec);
+  if (m_dec == nullptr)
+  {
+    cerr << "*** ERROR: Failed to initialize " << codec
+         << " audio decoder for the transcoder on TG #" << m_tg << endl;
+    return;
+  }
+  m_dec->registerSink(&m_splitter);
+} /* TGTranscoder::TGTranscoder */
+
+
+TGTranscoder::~TGTranscoder(void)
+{
+  for (auto& out : m_outputs)
+  {
+    m_splitter.removeSink(out->enc);
+    AudioCodecPool::instance().release(out->enc);
+    delete out;
+  }
+  m_outputs.clear();
+  if (m_dec != nullptr)
+  {
+    m_dec->unregisterSink();
+    AudioCodecPool::instance().release(m_dec);
+    m_dec = nullptr;
+  }
+} /* TGTranscoder::~TGTranscoder */
+
+
+bool TGTranscoder::addProfile(const std::string& codec, uint32_t bitrate)
+{
+  const std::string profile = profileName(codec, bitrate);
+  for (const auto& out : m_outputs)
+  {
+    if (out->profile == profile)
+    {
+      return true;
+    }
+  }
+
+  AudioEncoder* enc = AudioCodecPool::instance().createEncoder(codec);
+  if (enc == nullptr)
+  {
+    cerr << "*** ERROR: Failed to initialize " << codec
+         << " audio encoder for the transcoder on TG #" << m_tg << endl;
+    return false;
+  }
+  enc->setOption("BITRATE", std::to_string(bitrate));
+  if (codec == "OPUS")
+  {
+      // Longer frames lower the packet overhead, which is significant at
+      // these bitrates
+    enc->setOption("FRAME_SIZE", std::to_string(OPUS_FRAME_SIZE));
+  }
+
+  Output* out = new Output;
+  out->profile = profile;
+  out->enc = enc;
+  enc->writeEncodedSamples.connect(
+      sigc::bind(mem_fun(*this, &TGTranscoder::onEncodedAudio), out));
+  enc->flushEncodedSamples.connect(
+      sigc::bind(mem_fun(*this, &TGTranscoder::onEncodedFlush), out));
+  m_splitter.addSink(enc);
+  m_outputs.push_back(out);
+
+  std::cout << "Transcoding audio on TG #" << m_tg << " to " << profile
+            << std::endl;
+
+  return true;
+} /* TGTranscoder::addProfile */
+
+
+void TGTranscoder::writeAudio(const void* buf, int size)
+{
+  if ((m_dec == nullptr) || m_outputs.empty())
+  {
+    return;
+  }
+  m_active = true;
+  m_dec->writeEncodedSamples(const_cast<void*>(buf), size);
+} /* TGTranscoder::writeAudio */
+
+
+void TGTranscoder::flushAudio(void)
+{
+  if (!m_active)
+  {
+    return;
+  }
+  m_active = false;
+  m_dec->flushEncodedSamples();
+    // The next stream must not be decoded using the state left by this one
+  m_dec->reset();
+} /* TGTranscoder::flushAudio */
+
+
+
+/****************************************************************************
+ *
+ * Protected member functions
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Private member functions
+ *
+ ****************************************************************************/
+
+void TGTranscoder::onEncodedAudio(const void* buf, int size, Output* out)
+{
+  audioTranscoded(out->profile, buf, size);
+} /* TGTranscoder::onEncodedAudio */
+
+
+void TGTranscoder::onEncodedFlush(Output* out)
+{
+  out->enc->allEncodedSamplesFlushed();
+} /* TGTranscoder::onEncodedFlush */
+
+
+
+/*
+ * This file has not been truncated
+ */
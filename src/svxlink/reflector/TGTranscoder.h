@@ -0,0 +1,249 @@
+/**
+@file   TGTranscoder.h
+@brief  Transcode the audio in a talk group to low bitrate codecs
+@author Tobias Blomberg / SM0SVX
+@date   2026-10-15
+
+\verbatim
+SvxReflector - An audio reflector for connecting SvxLink Servers
+Copyright (C) 2003-2026 Tobias Blomberg / SM0SVX
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+\endverbatim
+*/
+
+#ifndef TG_TRANSCODER_INCLUDED
+#define TG_TRANSCODER_INCLUDED
+
+
+/****************************************************************************
+ *
+ * System Includes
+ *
+ ****************************************************************************/
+
+#include <sigc++/sigc++.h>
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+
+/****************************************************************************
+ *
+ * Project Includes
+ *
+ ****************************************************************************/
+
+#include <AsyncAudioSplitter.h>
+
+
+/****************************************************************************
+ *
+ * Local Includes
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Forward declarations
+ *
+ ****************************************************************************/
+
+namespace Async
+{
+  class AudioDecoder;
+  class AudioEncoder;
+};
+
+
+/****************************************************************************
+ *
+ * Namespace
+ *
+ ****************************************************************************/
+
+//namespace MyNameSpace
+//{
+
+
+/****************************************************************************
+ *
+ * Forward declarations of classes inside of the declared namespace
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Defines & typedefs
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Exported Global Variables
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Class definitions
+ *
+ ****************************************************************************/
+
+/**
+@brief  Transcode the audio in a talk group to low bitrate codecs
+@author Tobias Blomberg / SM0SVX
+@date   2026-10-15
+
+Clients on narrow links may ask the reflector, using a MsgAudioTranscode
+message, to get the audio transcoded to a low bitrate codec. A profile is the
+combination of a codec and a bitrate, e.g. "CODEC2/1600". The audio for a talk
+group is decoded once and is then encoded once for each profile in use on the
+talk group, no matter how many clients use that profile.
+
+The supported profiles are Codec2 at all of its bitrates and Opus at 6 to 8
+kbit/s. The latter is meant for clients that use Opus but that need a lower
+bitrate than the one used on the reflector.
+
+The flush of an audio stream is done synchronously so all remaining encoded
+audio has been emitted when flushAudio returns.
+*/
+class TGTranscoder : public sigc::trackable
+{
+  public:
+    /**
+     * @brief   Check if a codec and bitrate combination is supported
+     * @param   codec   The name of the codec
+     * @param   bitrate The bitrate in bits per second
+     * @return  Returns \em true if the combination is supported
+     */
+    static bool profileIsValid(const std::string& codec, uint32_t bitrate);
+
+    /**
+     * @brief   Get the name of a profile
+     * @param   codec   The name of the codec
+     * @param   bitrate The bitrate in bits per second
+     * @return  Returns the profile name, e.g. "CODEC2/1600"
+     */
+    static std::string profileName(const std::string& codec,
+                                   uint32_t bitrate);
+
+    /**
+     * @brief   Constructor
+     * @param   tg      The talk group that this transcoder is used for
+     * @param   codec   The name of the codec used on the reflector
+     */
+    TGTranscoder(uint32_t tg, const std::string& codec);
+
+    /**
+     * @brief   Destructor
+     */
+    ~TGTranscoder(void);
+
+    /**
+     * @brief   Check if the initialization was ok
+     * @return  Returns \em true if the decoder was created
+     */
+    bool initOk(void) const { return m_dec != nullptr; }
+
+    /**
+     * @brief   Get the talk group that this transcoder is used for
+     * @return  Returns the talk group number
+     */
+    uint32_t tg(void) const { return m_tg; }
+
+    /**
+     * @brief   Make sure that there is an encoder for a profile
+     * @param   codec   The name of the codec
+     * @param   bitrate The bitrate in bits per second
+     * @return  Returns \em false if the encoder could not be created
+     */
+    bool addProfile(const std::string& codec, uint32_t bitrate);
+
+    /**
+     * @brief   Get the number of profiles
+     * @return  Returns the number of profiles that audio is encoded for
+     */
+    size_t profileCount(void) const { return m_outputs.size(); }
+
+    /**
+     * @brief   Write encoded audio in the codec used on the reflector
+     * @param   buf     The buffer containing the encoded audio
+     * @param   size    The number of bytes in the buffer
+     */
+    void writeAudio(const void* buf, int size);
+
+    /**
+     * @brief   End the current audio stream
+     */
+    void flushAudio(void);
+
+    /**
+     * @brief   Check if the transcoder is idle
+     * @return  Returns \em true if there is no active audio stream
+     */
+    bool isIdle(void) const { return !m_active; }
+
+    /**
+     * @brief A signal that is emitted when audio has been transcoded
+     * @param profile The name of the profile that the audio was encoded for
+     * @param buf     The buffer containing the encoded audio
+     * @param size    The number of bytes in the buffer
+     */
+    sigc::signal<void(const std::string&, const void*, int)> audioTranscoded;
+
+  private:
+    static const unsigned OPUS_MIN_BITRATE  = 6000;
+    static const unsigned OPUS_MAX_BITRATE  = 8000;
+    static const unsigned OPUS_FRAME_SIZE   = 40;
+
+    struct Output
+    {
+      std::string           profile;
+      Async::AudioEncoder*  enc;
+    };
+
+    const uint32_t        m_tg;
+    Async::AudioDecoder*  m_dec;
+    Async::AudioSplitter  m_splitter;
+    std::vector<Output*>  m_outputs;
+    bool                  m_active;
+
+    TGTranscoder(const TGTranscoder&);
+    TGTranscoder& operator=(const TGTranscoder&);
+    void onEncodedAudio(const void* buf, int size, Output* out);
+    void onEncodedFlush(Output* out);
+
+};  /* class TGTranscoder */
+
+
+//} /* namespace */
+
+#endif /* TG_TRANSCODER_INCLUDED */
+
+
+
+/*
+ * This file has not been truncated
+ */
@@ -0,0 +1,265 @@
+/**
+@file   UdpFanoutEncryptor.cpp
+@brief  Encrypt UDP datagrams for many clients using worker threads
+@author Tobias Blomberg / SM0SVX
+@date   2026-10-14
+
+\verbatim
+SvxReflector - An audio reflector for connecting SvxLink Servers
+Copyright (C) 2003-2026 Tobias Blomberg / SM0SVX
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+\endverbatim
+*/
+
+/****************************************************************************
+ *
+ * System Includes
+ *
+ ****************************************************************************/
+
+#include <iostream>
+#include <cassert>
+
+
+/****************************************************************************
+ *
+ * Project Includes
+ *
+ ****************************************************************************/
+
+#include <AsyncEncryptedUdpSocket.h>
+
+
+/****************************************************************************
+ *
+ * Local Includes
+ *
+ ****************************************************************************/
+
+#include "UdpFanoutEncryptor.h"
+
+
+/****************************************************************************
+ *
+ * Namespaces to use
+ *
+ ****************************************************************************/
+
+using namespace std;
+using namespace Async;
+
+
+/****************************************************************************
+ *
+ * Defines & typedefs
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Local class definitions
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Prototypes
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Exported Global Variables
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Local Global Variables
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Public member functions
+ *
+ ****************************************************************************/
+
+UdpFanoutEncryptor::UdpFanoutEncryptor(unsigned threads)
+  : m_next_job(0), m_done_cnt(0)
+{
+  const EncryptedUdpSocket::Cipher* cipher =
+    EncryptedUdpSocket::fetchCipher(UdpCipher::NAME);
+  if (cipher == nullptr)
+  {
+    std::cerr << "*** ERROR: Could not fetch cipher " << UdpCipher::NAME
+              << std::endl;
+    return;
+  }
+
+    // One cipher context cache for the calling thread and one for each
+    // worker. The contexts are created when a key is first used.
+  for (unsigned i=0; i<=threads; ++i)
+  {
+    m_ctx_caches.emplace_back(new ContextCache(CONTEXT_CACHE_SIZE));
+  }
+  m_init_ok = true;
+
+  for (unsigned i=1; i<m_ctx_caches.size(); ++i)
+  {
+    m_threads.emplace_back(&UdpFanoutEncryptor::workerFunc, this,
+                           m_ctx_caches[i].get());
+  }
+} /* UdpFanoutEncryptor::UdpFanoutEncryptor */
+
+
+UdpFanoutEncryptor::~UdpFanoutEncryptor(void)
+{
+  {
+    std::lock_guard<std::mutex> lk(m_mutex);
+    m_stop = true;
+  }
+  m_work_cond.notify_all();
+  for (auto& thread : m_threads)
+  {
+    thread.join();
+  }
+} /* UdpFanoutEncryptor::~UdpFanoutEncryptor */
+
+
+void UdpFanoutEncryptor::run(const uint8_t* plain, size_t plainlen,
+                             size_t cnt)
+{
+  assert(m_init_ok);
+  assert(cnt <= m_job_vec.size());
+  if (cnt == 0)
+  {
+    return;
+  }
+
+  std::unique_lock<std::mutex> lk(m_mutex);
+
+    // Workers that woke up late for the previous run may still be
+    // looking at the old job list
+  m_done_cond.wait(lk, [this]{ return m_active == 0; });
+
+  m_jobs = m_job_vec.data();
+  m_job_cnt = cnt;
+  m_plain = plain;
+  m_plainlen = plainlen;
+  m_next_job = 0;
+  m_done_cnt = 0;
+  m_generation += 1;
+  lk.unlock();
+  m_work_cond.notify_all();
+
+  processJobs(m_ctx_caches[0].get(), m_job_vec.data(), cnt, plain, plainlen);
+
+  lk.lock();
+  m_done_cond.wait(lk, [this, cnt]{ return m_done_cnt == cnt; });
+} /* UdpFanoutEncryptor::run */
+
+
+
+/****************************************************************************
+ *
+ * Protected member functions
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Private member functions
+ *
+ ****************************************************************************/
+
+void UdpFanoutEncryptor::workerFunc(ContextCache* ctx_cache)
+{
+  unsigned generation = 0;
+  std::unique_lock<std::mutex> lk(m_mutex);
+  for (;;)
+  {
+    m_work_cond.wait(lk, [&]{ return m_stop || (m_generation != generation); });
+    if (m_stop)
+    {
+      break;
+    }
+    generation = m_generation;
+    Job* jobs = m_jobs;
+    size_t job_cnt = m_job_cnt;
+    const uint8_t* plain = m_plain;
+    size_t plainlen = m_plainlen;
+    m_active += 1;
+    lk.unlock();
+
+    processJobs(ctx_cache, jobs, job_cnt, plain, plainlen);
+
+    lk.lock();
+    m_active -= 1;
+    m_done_cond.notify_all();
+  }
+} /* UdpFanoutEncryptor::workerFunc */
+
+
+void UdpFanoutEncryptor::processJobs(ContextCache* ctx_cache, Job* jobs,
+                                     size_t job_cnt, const uint8_t* plain,
+                                     size_t plainlen)
+{
+  static const std::vector<uint8_t> no_key;
+  size_t done = 0;
+  for (;;)
+  {
+    size_t idx = m_next_job++;
+    if (idx >= job_cnt)
+    {
+      break;
+    }
+    Job& job = jobs[idx];
+    job.out.resize(EncryptedUdpSocket::cipherTextMaxSize(
+          UdpCipher::AADLEN, UdpCipher::TAGLEN, plainlen));
+    EVP_CIPHER_CTX* ctx = ctx_cache->encryptContext(job.cipher, job.key);
+    job.ok = (ctx != nullptr) &&
+             EncryptedUdpSocket::encrypt(ctx, no_key, job.iv,
+                 UdpCipher::TAGLEN, job.aad, UdpCipher::AADLEN,
+                 plain, plainlen, job.out.data(), job.outlen);
+    ++done;
+  }
+
+  if (done > 0)
+  {
+    std::lock_guard<std::mutex> lk(m_mutex);
+    m_done_cnt += done;
+    m_done_cond.notify_all();
+  }
+} /* UdpFanoutEncryptor::processJobs */
+
+
+
+/*
+ * This file has not been truncated
+ */
@@ -0,0 +1,238 @@
+/**
+@file   UdpFanoutEncryptor.h
+@brief  Encrypt UDP datagrams for many clients using worker threads
+@author Tobias Blomberg / SM0SVX
+@date   2026-10-14
+
+\verbatim
+SvxReflector - An audio reflector for connecting SvxLink Servers
+Copyright (C) 2003-2026 Tobias Blomberg / SM0SVX
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+\endverbatim
+*/
+
+#ifndef UDP_FANOUT_ENCRYPTOR_INCLUDED
+#define UDP_FANOUT_ENCRYPTOR_INCLUDED
+
+
+/****************************************************************************
+ *
+ * System Includes
+ *
+ ****************************************************************************/
+
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <memory>
+
+
+/****************************************************************************
+ *
+ * Project Includes
+ *
+ ****************************************************************************/
+
+#include <AsyncIpAddress.h>
+#include <AsyncEncryptedUdpSocket.h>
+
+
+/****************************************************************************
+ *
+ * Local Includes
+ *
+ ****************************************************************************/
+
+#include "ReflectorMsg.h"
+
+
+/****************************************************************************
+ *
+ * Forward declarations
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Namespace
+ *
+ ****************************************************************************/
+
+//namespace MyNameSpace
+//{
+
+
+/****************************************************************************
+ *
+ * Forward declarations of classes inside of the declared namespace
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Defines & typedefs
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Exported Global Variables
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Class definitions
+ *
+ ****************************************************************************/
+
+/**
+@brief  Encrypt UDP datagrams for many clients using worker threads
+@author Tobias Blomberg / SM0SVX
+@date   2026-10-14
+
+When an audio frame is relayed to a talk group with a lot of listeners, the
+AEAD encryption, which must be done with a unique key and IV for each client,
+is what dominates the CPU usage of the reflector. This class spread that work
+over a number of worker threads. The calling thread also take part in the
+work and the run function return when all datagrams have been encrypted.
+
+Only the encryption is done in the worker threads. All client state, like
+the IV counters, is handled by the main thread when setting up the jobs and
+all network I/O is done by the main thread after the run function returns.
+Each thread keep a cache of cipher contexts, already set up with the key of
+each client, so that only the IV has to be set for each datagram.
+*/
+class UdpFanoutEncryptor
+{
+  public:
+    /**
+     * @brief   A datagram to encrypt
+     */
+    struct Job
+    {
+      Async::IpAddress      addr;
+      uint16_t              port      = 0;
+      const Async::EncryptedUdpSocket::Cipher* cipher = nullptr;
+      std::vector<uint8_t>  key;
+      std::vector<uint8_t>  iv;
+      uint8_t               aad[UdpCipher::AADLEN];
+      std::vector<uint8_t>  out;
+      int                   outlen    = 0;
+      bool                  ok        = false;
+    };
+    /**
+     * @brief   Constructor
+     * @param   threads The number of worker threads to start
+     */
+    explicit UdpFanoutEncryptor(unsigned threads);
+
+    /**
+     * @brief   Destructor
+     */
+    ~UdpFanoutEncryptor(void);
+
+    /**
+     * @brief   Check if the initialization was ok
+     * @return  Returns \em true if all cipher contexts could be set up
+     */
+    bool initOk(void) const { return m_init_ok; }
+
+    /**
+     * @brief   Get the number of worker threads
+     * @return  Returns the number of worker threads
+     */
+    unsigned threadCount(void) const { return m_threads.size(); }
+
+    /**
+     * @brief   Get a job slot to fill in before calling run
+     * @param   idx The index of the job
+     * @return  Returns a reference to the job
+     *
+     * The job storage is reused between calls to run so that the buffers
+     * do not have to be reallocated for each datagram.
+     */
+    Job& job(size_t idx)
+    {
+      if (idx >= m_job_vec.size())
+      {
+        m_job_vec.resize(idx + 1);
+      }
+      return m_job_vec[idx];
+    }
+
+    /**
+     * @brief   Encrypt a datagram for a number of clients
+     * @param   plain     The plaintext datagram
+     * @param   plainlen  The size of the plaintext datagram
+     * @param   cnt       The number of jobs to process
+     *
+     * This function will block until the first cnt jobs have been processed.
+     * Each job will have its ok member set to indicate if the encryption
+     * succeeded.
+     */
+    void run(const uint8_t* plain, size_t plainlen, size_t cnt);
+
+  private:
+    using ContextCache = Async::EncryptedUdpSocket::ContextCache;
+
+    static constexpr size_t CONTEXT_CACHE_SIZE = 16384;
+
+    std::vector<std::thread>      m_threads;
+    std::vector<std::unique_ptr<ContextCache>> m_ctx_caches;
+    bool                          m_init_ok     = false;
+    std::vector<Job>              m_job_vec;
+    std::mutex                    m_mutex;
+    std::condition_variable       m_work_cond;
+    std::condition_variable       m_done_cond;
+    bool                          m_stop        = false;
+    unsigned                      m_generation  = 0;
+    unsigned                      m_active      = 0;
+    Job*                          m_jobs        = nullptr;
+    size_t                        m_job_cnt     = 0;
+    const uint8_t*                m_plain       = nullptr;
+    size_t                        m_plainlen    = 0;
+    std::atomic<size_t>           m_next_job;
+    std::atomic<size_t>           m_done_cnt;
+
+    UdpFanoutEncryptor(const UdpFanoutEncryptor&);
+    UdpFanoutEncryptor& operator=(const UdpFanoutEncryptor&);
+    void workerFunc(ContextCache* ctx_cache);
+    void processJobs(ContextCache* ctx_cache, Job* jobs, size_t job_cnt,
+                     const uint8_t* plain, size_t plainlen);
+
+};  /* class UdpFanoutEncryptor */
+
+
+//} /* namespace */
+
+#endif /* UDP_FANOUT_ENCRYPTOR_INCLUDED */
+
+
+
+/*
+ * This file has not been truncated
+ */
@@ -0,0 +1,250 @@
+/**
+@file	 svxreflector-fanoutbench.cpp
+@brief   A micro benchmark for the reflector UDP audio fan-out
+@author  Tobias Blomberg / SM0SVX
+@date	 2026-10-14
+
+This program measure how many audio frames per second the reflector can send
+to a number of protocol V3 receivers. Each audio frame is sent the same way
+as the reflector does it, encrypted with the key and IV of each receiver and
+sent in one batch to a UDP socket on localhost. This is done both with the
+message serialized for each receiver, like the reflector did before, and with
+the message serialized once per frame and shared between the receivers.
+
+Run with something like:
+
+  svxreflector-fanoutbench [receivers] [frames]
+
+\verbatim
+SvxReflector - An audio reflector for connecting SvxLink Servers
+Copyright (C) 2003-2026 Tobias Blomberg / SM0SVX
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+\endverbatim
+*/
+
+
+
+/****************************************************************************
+ *
+ * System Includes
+ *
+ ****************************************************************************/
+
+#include <cstdlib>
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <vector>
+
+
+/****************************************************************************
+ *
+ * Project Includes
+ *
+ ****************************************************************************/
+
+#include <AsyncCppApplication.h>
+#include <AsyncEncryptedUdpSocket.h>
+#include <AsyncUdpSocket.h>
+#include <AsyncIpAddress.h>
+
+
+/****************************************************************************
+ *
+ * Local Includes
+ *
+ ****************************************************************************/
+
+#include "ReflectorMsg.h"
+
+
+/****************************************************************************
+ *
+ * Namespaces to use
+ *
+ ****************************************************************************/
+
+using namespace std;
+using namespace Async;
+
+
+/****************************************************************************
+ *
+ * Defines & typedefs
+ *
+ ****************************************************************************/
+
+typedef std::chrono::steady_clock Clock;
+
+
+/****************************************************************************
+ *
+ * Local class definitions
+ *
+ ****************************************************************************/
+
+  /*
+   * The cipher state the reflector keep for each connected client
+   */
+struct Receiver
+{
+  std::vector<uint8_t>  key;
+  std::vector<uint8_t>  iv_rand;
+  UdpCipher::IVCntr     iv_cntr = 0;
+};
+
+
+/****************************************************************************
+ *
+ * Local Global Variables
+ *
+ ****************************************************************************/
+
+static const size_t AUDIO_FRAME_SIZE = 160;
+static const uint16_t SINK_PORT = 5310;
+static std::vector<uint8_t> iv_buf;
+
+
+/****************************************************************************
+ *
+ * Local functions
+ *
+ ****************************************************************************/
+
+  /*
+   * Encrypt and queue one datagram for a receiver, like
+   * Reflector::sendUdpDatagram does for a protocol V3 client
+   */
+static bool sendDatagram(EncryptedUdpSocket& sock, const IpAddress& addr,
+                         uint16_t port, Receiver& rx,
+                         const ReflectorPackedUdpMsg& msg)
+{
+  UdpCipher::IV{rx.iv_rand, 0, rx.iv_cntr}.assignTo(iv_buf);
+  sock.setCipherIV(iv_buf);
+  sock.setCipherKey(rx.key);
+  UdpCipher::AAD aad{rx.iv_cntr++};
+  uint8_t aadbuf[UdpCipher::AADLEN];
+  Async::MsgBufWriter aadw(aadbuf, sizeof(aadbuf));
+  if (!aad.pack(aadw))
+  {
+    return false;
+  }
+  return sock.write(addr, port, aadbuf, aadw.size(),
+                    msg.datagramData(), msg.datagramSize());
+} /* sendDatagram */
+
+
+static void printResult(const char *name, size_t frames, size_t datagrams,
+                        Clock::duration elapsed)
+{
+  const double s = chrono::duration<double>(elapsed).count();
+  cout << setw(24) << left << name << right << fixed
+       << setw(14) << setprecision(0) << (frames / s) << " frames/s"
+       << setw(14) << setprecision(0) << (datagrams / s) << " datagrams/s"
+       << endl;
+} /* printResult */
+
+
+/****************************************************************************
+ *
+ * MAIN
+ *
+ ****************************************************************************/
+
+int main(int argc, const char **argv)
+{
+  unsigned rx_cnt = 500;
+  size_t frames = 2000;
+  if (argc > 1)
+  {
+    rx_cnt = atoi(argv[1]);
+  }
+  if (argc > 2)
+  {
+    frames = atoi(argv[2]);
+  }
+  if ((rx_cnt == 0) || (frames == 0))
+  {
+    cerr << "Usage: svxreflector-fanoutbench [receivers] [frames]" << endl;
+    return 1;
+  }
+
+  CppApplication app;
+
+    // The datagrams are sent to a socket that is never read so the kernel
+    // drop them when its receive buffer is full
+  const IpAddress addr("127.0.0.1");
+  UdpSocket sink(SINK_PORT, addr);
+  EncryptedUdpSocket sock;
+  if (!sink.initOk() || !sock.initOk() || !sock.setCipher(UdpCipher::NAME))
+  {
+    cerr << "*** ERROR: Could not set up the UDP sockets" << endl;
+    return 1;
+  }
+  sock.setCipherAADLength(UdpCipher::AADLEN);
+  sock.setTagLength(UdpCipher::TAGLEN);
+  const uint16_t port = SINK_PORT;
+
+  vector<Receiver> receivers(rx_cnt);
+  for (auto& rx : receivers)
+  {
+    rx.key.resize(16);
+    rx.iv_rand.resize(UdpCipher::IVRANDLEN);
+    EncryptedUdpSocket::randomBytes(rx.key);
+    EncryptedUdpSocket::randomBytes(rx.iv_rand);
+  }
+
+  vector<uint8_t> frame(AUDIO_FRAME_SIZE, 0x55);
+  size_t datagrams = 0;
+  Clock::time_point start = Clock::now();
+  for (size_t i=0; i<frames; ++i)
+  {
+    MsgUdpAudio msg(frame);
+    sock.beginBatch();
+    for (auto& rx : receivers)
+    {
+      datagrams += sendDatagram(sock, addr, port, rx,
+                                ReflectorPackedUdpMsg(msg)) ? 1 : 0;
+    }
+    sock.flushBatch();
+  }
+  printResult("Pack per receiver", frames, datagrams, Clock::now() - start);
+
+  datagrams = 0;
+  start = Clock::now();
+  for (size_t i=0; i<frames; ++i)
+  {
+    const ReflectorPackedUdpMsg msg((MsgUdpAudio(frame)));
+    sock.beginBatch();
+    for (auto& rx : receivers)
+    {
+      datagrams += sendDatagram(sock, addr, port, rx, msg) ? 1 : 0;
+    }
+    sock.flushBatch();
+  }
+  printResult("Pack once", frames, datagrams, Clock::now() - start);
+
+  cout << "\n" << rx_cnt << " receivers, " << AUDIO_FRAME_SIZE
+       << " byte audio frames, " << UdpCipher::NAME << endl;
+
+  return 0;
+} /* main */
+
+
+
+/*
+ * This file has not been truncated
+ */
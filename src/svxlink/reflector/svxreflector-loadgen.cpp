@@ -0,0 +1,1327 @@
+/**
+@file	 svxreflector-loadgen.cpp
+@brief   A load generator and benchmark for the SvxReflector
+@author  Tobias Blomberg / SM0SVX
+@date	 2026-10-14
+
+This program emulate a large number of SvxLink nodes that connect to a running
+SvxReflector server. The nodes talk on their talk groups using prepared
+Opus frames and the program measure how the reflector perform with respect to
+fan-out latency, delivery ratio, CPU usage per forwarded frame and how long it
+take for all nodes to log in again after a reconnect storm.
+
+\verbatim
+SvxReflector - An audio reflector for connecting SvxLink Servers
+Copyright (C) 2003-2026 Tobias Blomberg / SM0SVX
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+\endverbatim
+*/
+
+
+
+/****************************************************************************
+ *
+ * System Includes
+ *
+ ****************************************************************************/
+
+#include <locale.h>
+#include <signal.h>
+#include <unistd.h>
+#include <sys/time.h>
+#include <sys/resource.h>
+#include <arpa/inet.h>
+
+#include <popt.h>
+#include <sigc++/sigc++.h>
+#include <json/json.h>
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cmath>
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <sstream>
+#include <chrono>
+#include <random>
+#include <map>
+#include <unordered_map>
+#include <unordered_set>
+#include <memory>
+#include <new>
+#include <atomic>
+
+
+/****************************************************************************
+ *
+ * Project Includes
+ *
+ ****************************************************************************/
+
+#include <AsyncCppApplication.h>
+#include <AsyncTimer.h>
+#include <AsyncAudioEncoder.h>
+#include <RelayBench.h>
+
+
+/****************************************************************************
+ *
+ * Local Includes
+ *
+ ****************************************************************************/
+
+#include "version/SVXREFLECTOR.h"
+#include "LoadGenNode.h"
+
+
+/****************************************************************************
+ *
+ * Namespaces to use
+ *
+ ****************************************************************************/
+
+using namespace std;
+using namespace Async;
+using namespace SvxLink;
+
+
+/****************************************************************************
+ *
+ * Defines & typedefs
+ *
+ ****************************************************************************/
+
+#define PROGRAM_NAME "SvxReflectorLoadGen"
+
+typedef std::chrono::steady_clock Clock;
+
+
+/****************************************************************************
+ *
+ * Local class definitions
+ *
+ ****************************************************************************/
+
+namespace {
+
+  /**
+   * @brief Counters that are kept both for each interval and in total
+   */
+  struct Counters
+  {
+    uint64_t          frames_sent       = 0;
+    uint64_t          frames_dropped    = 0;
+    uint64_t          frames_expected   = 0;
+    uint64_t          frames_received   = 0;
+    uint64_t          frames_unmatched  = 0;
+    uint64_t          frames_lost       = 0;
+    LatencyHistogram  latency;
+
+    void clear(void)
+    {
+      frames_sent = frames_dropped = frames_expected = 0;
+      frames_received = frames_unmatched = frames_lost = 0;
+      latency.clear();
+    }
+  };
+
+  /**
+   * @brief The state of one emulated talk group
+   */
+  struct TalkGroup
+  {
+    uint32_t                    tg;
+    std::vector<LoadGenNode*>   members;
+    LoadGenNode*                talker        = nullptr;
+    unsigned                    frames_left   = 0;
+    unsigned                    idle_left     = 0;
+    size_t                      frame_idx     = 0;
+    bool                        in_loss_burst = false;
+    std::vector<Clock::time_point> sent_at;
+  };
+
+}; /* anonymous namespace */
+
+
+/****************************************************************************
+ *
+ * Prototypes
+ *
+ ****************************************************************************/
+
+static void parse_arguments(int argc, const char **argv);
+static void handle_unix_signal(int signum);
+static bool raise_fd_limit(rlim_t needed);
+static bool write_user_db(void);
+static bool setup_ssl(void);
+static void create_audio_pool(void);
+static void create_nodes(void);
+static uint64_t frame_hash(const uint8_t* data, size_t size);
+static std::string node_callsign(unsigned idx);
+static unsigned jitter(unsigned value);
+static void on_node_logged_in(LoadGenNode* node);
+static void on_node_disconnected(LoadGenNode* node, const std::string& reason);
+static void on_node_audio(LoadGenNode* node, const uint8_t* data,
+                          size_t size, uint32_t lost);
+static void on_frame_timer(Timer* t);
+static void process_talk_group(TalkGroup& tg);
+static void on_tick_timer(Timer* t);
+static void start_storm(void);
+static bool read_process_cpu_usec(uint64_t& usec);
+static uint64_t own_cpu_usec(void);
+static void print_status(void);
+static bool steady_state_allocs(double& per_s, double& per_frame);
+static void print_summary(void);
+static bool write_json(void);
+
+
+/****************************************************************************
+ *
+ * Exported Global Variables
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Local Global Variables
+ *
+ ****************************************************************************/
+
+namespace {
+  const unsigned        FRAME_INTERVAL_MS = 20;
+  const unsigned        POOL_SIZE         = 500;
+  const unsigned        RECONNECT_DELAY   = 5;
+
+  char*                 host              = nullptr;
+  int                   port              = 5300;
+  char*                 auth_key          = nullptr;
+  char*                 cert_email        = nullptr;
+  char*                 cafile            = nullptr;
+  char*                 keyfile           = nullptr;
+  char*                 bind_base         = nullptr;
+  char*                 callsign_prefix   = nullptr;
+  char*                 user_db_file      = nullptr;
+  char*                 auth_group        = nullptr;
+  char*                 json_file         = nullptr;
+  int                   node_cnt          = 100;
+  int                   ramp              = 200;
+  int                   tg_cnt            = 10;
+  int                   tg_base           = 1000;
+  int                   monitor_cnt       = 0;
+  int                   duty              = 50;
+  int                   spurt_len         = 10;
+  char*                 loss_str          = nullptr;
+  int                   loss_burst        = 1;
+  int                   duration          = 0;
+  int                   interval          = 10;
+  int                   storm_interval    = 0;
+  int                   reflector_pid     = 0;
+  int                   seed              = 1;
+
+  double                loss_fraction     = 0.0;
+  LoadGenNode::Shared   shared;
+  SslContext            ssl_ctx;
+  SslKeypair            keypair;
+  std::vector<std::vector<uint8_t>>         audio_pool;
+  std::unordered_map<uint64_t, size_t>      audio_pool_idx;
+  std::vector<std::unique_ptr<LoadGenNode>> nodes;
+  std::vector<TalkGroup>                    tgs;
+  std::map<uint32_t, TalkGroup*>            tg_map;
+  std::unordered_set<LoadGenNode*>          logged_in;
+  std::map<LoadGenNode*, unsigned>          reconnect_queue;
+  std::map<std::string, unsigned>           disconnect_reasons;
+  std::mt19937                              rng;
+  size_t                                    next_node_to_connect = 0;
+  double                                    ramp_credit = 0.0;
+  Counters                                  interval_cnt;
+  Counters                                  total_cnt;
+  Clock::time_point                         start_time;
+  Clock::time_point                         interval_start;
+  Clock::time_point                         storm_start;
+  bool                                      storm_active = false;
+  bool                                      all_logged_in = false;
+  double                                    initial_login_time = -1.0;
+  std::vector<double>                       storm_recovery_times;
+  unsigned                                  seconds_left_to_storm = 0;
+  unsigned                                  seconds_run = 0;
+  uint64_t                                  refl_cpu_start = 0;
+  uint64_t                                  refl_cpu_interval = 0;
+  uint64_t                                  own_cpu_start = 0;
+  uint64_t                                  own_cpu_interval = 0;
+  uint64_t                                  alloc_interval = 0;
+  uint64_t                                  alloc_steady_start = 0;
+  uint64_t                                  frames_steady_start = 0;
+  Clock::time_point                         steady_start;
+
+    // Updated by the replaced global operator new below. The emulated nodes
+    // use the same message, UDP and cipher code as a real node so the
+    // number of allocations in steady state show how much the per frame
+    // code paths allocate.
+  std::atomic<uint64_t>                     alloc_cnt(0);
+};
+
+
+/****************************************************************************
+ *
+ * Allocation counting
+ *
+ ****************************************************************************/
+
+void* operator new(std::size_t size)
+{
+  alloc_cnt.fetch_add(1, std::memory_order_relaxed);
+  void* ptr = std::malloc((size > 0) ? size : 1);
+  if (ptr == nullptr)
+  {
+    throw std::bad_alloc();
+  }
+  return ptr;
+} /* operator new */
+
+
+void operator delete(void* ptr) noexcept
+{
+  std::free(ptr);
+} /* operator delete */
+
+
+void operator delete(void* ptr, std::size_t) noexcept
+{
+  std::free(ptr);
+} /* operator delete */
+
+
+/****************************************************************************
+ *
+ * MAIN
+ *
+ ****************************************************************************/
+
+/*
+ *----------------------------------------------------------------------------
+ * Function:  main
+ * Purpose:   Start everything...
+ * Input:     argc  - The number of arguments passed to this program
+ *    	      	      (including the program name).
+ *    	      argv  - The arguments passed to this program. argv[0] is the
+ *    	      	      program name.
+ * Output:    Return 0 on success, else non-zero.
+ * Author:    Tobias Blomberg, SM0SVX
+ * Created:   2026-10-14
+ * Remarks:
+ * Bugs:
+ *----------------------------------------------------------------------------
+ */
+int main(int argc, const char *argv[])
+{
+  setlocale(LC_ALL, "");
+
+  CppApplication app;
+  app.catchUnixSignal(SIGINT);
+  app.catchUnixSignal(SIGTERM);
+  app.unixSignalCaught.connect(sigc::ptr_fun(&handle_unix_signal));
+
+  parse_arguments(argc, const_cast<const char **>(argv));
+
+  if (user_db_file != nullptr)
+  {
+    return write_user_db() ? 0 : 1;
+  }
+
+  if (host == nullptr)
+  {
+    std::cerr << "*** ERROR: The --host option must be given" << std::endl;
+    exit(1);
+  }
+  if (auth_key == nullptr)
+  {
+    std::cerr << "*** ERROR: The --auth-key option must be given" << std::endl;
+    exit(1);
+  }
+  if ((node_cnt < 2) || (tg_cnt < 1) || (tg_cnt > node_cnt / 2) ||
+      (ramp < 1) || (duty < 1) || (duty > 100) || (spurt_len < 1) ||
+      (loss_burst < 1) || (interval < 1) || (monitor_cnt < 0) ||
+      (monitor_cnt >= tg_cnt) || (duration < 0) || (storm_interval < 0))
+  {
+    std::cerr << "*** ERROR: Illegal combination of options. There must be "
+                 "at least two nodes per talk group." << std::endl;
+    exit(1);
+  }
+  if (loss_str != nullptr)
+  {
+    std::istringstream is(loss_str);
+    if (!(is >> loss_fraction) || (loss_fraction < 0.0) ||
+        (loss_fraction >= 100.0))
+    {
+      std::cerr << "*** ERROR: Illegal --loss value \"" << loss_str << "\""
+                << std::endl;
+      exit(1);
+    }
+    loss_fraction /= 100.0;
+  }
+
+  rng.seed(seed);
+
+    // Each node use one TCP and one UDP socket
+  raise_fd_limit(2 * node_cnt + 64);
+
+  if (!setup_ssl())
+  {
+    exit(1);
+  }
+
+  create_audio_pool();
+  create_nodes();
+
+  std::cout << PROGRAM_NAME " v" SVXREFLECTOR_VERSION ": Emulating "
+            << node_cnt << " nodes on " << tg_cnt << " talk groups against "
+            << host << ":" << port << std::endl;
+
+  start_time = interval_start = Clock::now();
+  seconds_left_to_storm = storm_interval;
+  read_process_cpu_usec(refl_cpu_start);
+  refl_cpu_interval = refl_cpu_start;
+  own_cpu_start = own_cpu_interval = own_cpu_usec();
+
+  Timer frame_timer(FRAME_INTERVAL_MS, Timer::TYPE_PERIODIC);
+  frame_timer.expired.connect(sigc::ptr_fun(&on_frame_timer));
+  Timer tick_timer(1000, Timer::TYPE_PERIODIC);
+  tick_timer.expired.connect(sigc::ptr_fun(&on_tick_timer));
+
+  app.exec();
+
+  for (auto& node : nodes)
+  {
+    node->disconnect();
+  }
+
+  print_summary();
+  nodes.clear();
+  if ((json_file != nullptr) && !write_json())
+  {
+    return 1;
+  }
+
+  return 0;
+} /* main */
+
+
+/****************************************************************************
+ *
+ * Functions
+ *
+ ****************************************************************************/
+
+/*
+ *----------------------------------------------------------------------------
+ * Function:  parse_arguments
+ * Purpose:   Parse the command line arguments.
+ * Input:     argc  - Number of arguments in the command line
+ *    	      argv  - Array of strings with the arguments
+ * Output:    None. The program is terminated on error.
+ * Author:    Tobias Blomberg, SM0SVX
+ * Created:   2026-10-14
+ * Remarks:
+ * Bugs:
+ *----------------------------------------------------------------------------
+ */
+static void parse_arguments(int argc, const char **argv)
+{
+  int print_version = 0;
+
+  poptContext optCon;
+  const struct poptOption optionsTable[] =
+  {
+    POPT_AUTOHELP
+    {"host", 0, POPT_ARG_STRING, &host, 0,
+            "The host name or IP address of the reflector", "<host>"},
+    {"port", 0, POPT_ARG_INT, &port, 0,
+            "The port of the reflector (5300)", "<port>"},
+    {"auth-key", 0, POPT_ARG_STRING, &auth_key, 0,
+            "The password used by all emulated nodes", "<key>"},
+    {"cert-email", 0, POPT_ARG_STRING, &cert_email, 0,
+            "The email address to put in the CSR of each node", "<email>"},
+    {"cafile", 0, POPT_ARG_STRING, &cafile, 0,
+            "Verify the reflector certificate using this CA bundle",
+            "<filename>"},
+    {"keyfile", 0, POPT_ARG_STRING, &keyfile, 0,
+            "The private key file used by all nodes, created if missing",
+            "<filename>"},
+    {"bind-base", 0, POPT_ARG_STRING, &bind_base, 0,
+            "Bind node N to this local IP address plus N", "<ip>"},
+    {"nodes", 0, POPT_ARG_INT, &node_cnt, 0,
+            "The number of nodes to emulate (100)", "<count>"},
+    {"callsign-prefix", 0, POPT_ARG_STRING, &callsign_prefix, 0,
+            "The prefix of the node callsigns (LT)", "<prefix>"},
+    {"ramp", 0, POPT_ARG_INT, &ramp, 0,
+            "The number of nodes to connect per second at start (200)",
+            "<nodes/s>"},
+    {"tgs", 0, POPT_ARG_INT, &tg_cnt, 0,
+            "The number of talk groups to use (10)", "<count>"},
+    {"tg-base", 0, POPT_ARG_INT, &tg_base, 0,
+            "The first talk group number (1000)", "<tg>"},
+    {"monitor", 0, POPT_ARG_INT, &monitor_cnt, 0,
+            "The number of other talk groups each node monitor (0)",
+            "<count>"},
+    {"duty", 0, POPT_ARG_INT, &duty, 0,
+            "The percentage of time that each talk group is active (50)",
+            "<percent>"},
+    {"spurt", 0, POPT_ARG_INT, &spurt_len, 0,
+            "The mean length of a talk spurt (10)", "<seconds>"},
+    {"loss", 0, POPT_ARG_STRING, &loss_str, 0,
+            "The percentage of sent frames to drop (0)", "<percent>"},
+    {"loss-burst", 0, POPT_ARG_INT, &loss_burst, 0,
+            "The mean number of frames in a loss burst (1)", "<frames>"},
+    {"duration", 0, POPT_ARG_INT, &duration, 0,
+            "Stop after this many seconds, 0 = run until SIGINT (0)",
+            "<seconds>"},
+    {"interval", 0, POPT_ARG_INT, &interval, 0,
+            "The status print interval (10)", "<seconds>"},
+    {"storm", 0, POPT_ARG_INT, &storm_interval, 0,
+            "Reconnect all nodes at once with this interval (0)",
+            "<seconds>"},
+    {"reflector-pid", 0, POPT_ARG_INT, &reflector_pid, 0,
+            "The PID of a local reflector, used to measure its CPU usage",
+            "<pid>"},
+    {"seed", 0, POPT_ARG_INT, &seed, 0,
+            "The random number generator seed (1)", "<seed>"},
+    {"json", 0, POPT_ARG_STRING, &json_file, 0,
+            "Write a summary in JSON format to this file", "<filename>"},
+    {"write-user-db", 0, POPT_ARG_STRING, &user_db_file, 0,
+            "Write a reflector user database file for the nodes and exit",
+            "<filename>"},
+    {"auth-group", 0, POPT_ARG_STRING, &auth_group, 0,
+            "The group name used in the user database (LoadTest)",
+            "<group>"},
+    {"version", 0, POPT_ARG_NONE, &print_version, 0,
+	    "Print the application version string", NULL},
+    {NULL, 0, 0, NULL, 0}
+  };
+  int err;
+
+  optCon = poptGetContext(PROGRAM_NAME, argc, argv, optionsTable, 0);
+  poptReadDefaultConfig(optCon, 0);
+
+  err = poptGetNextOpt(optCon);
+  if (err != -1)
+  {
+    fprintf(stderr, "\t%s: %s\n",
+	    poptBadOption(optCon, POPT_BADOPTION_NOALIAS),
+	    poptStrerror(err));
+    exit(1);
+  }
+
+  poptFreeContext(optCon);
+
+  if (print_version)
+  {
+    std::cout << SVXREFLECTOR_VERSION << std::endl;
+    exit(0);
+  }
+} /* parse_arguments */
+
+
+static void handle_unix_signal(int signum)
+{
+  std::cout << "\nNOTICE: " << ((signum == SIGINT) ? "SIGINT" : "SIGTERM")
+            << " received. Stopping..." << std::endl;
+  Application::app().quit();
+} /* handle_unix_signal */
+
+
+static bool raise_fd_limit(rlim_t needed)
+{
+  struct rlimit rlim;
+  if (getrlimit(RLIMIT_NOFILE, &rlim) != 0)
+  {
+    perror("getrlimit");
+    return false;
+  }
+  if (rlim.rlim_cur < needed)
+  {
+    rlim.rlim_cur = std::min(needed, rlim.rlim_max);
+    if (setrlimit(RLIMIT_NOFILE, &rlim) != 0)
+    {
+      perror("setrlimit");
+    }
+  }
+  if (rlim.rlim_cur < needed)
+  {
+    std::cerr << "*** WARNING: The open file limit (" << rlim.rlim_cur
+              << ") is too low for " << node_cnt << " nodes. Raise the "
+                 "hard limit to at least " << needed << std::endl;
+    return false;
+  }
+  return true;
+} /* raise_fd_limit */
+
+
+static bool write_user_db(void)
+{
+  std::ofstream ofs(user_db_file);
+  if (!ofs)
+  {
+    std::cerr << "*** ERROR: Could not open user database file \""
+              << user_db_file << "\" for writing" << std::endl;
+    return false;
+  }
+  const std::string group((auth_group != nullptr) ? auth_group : "LoadTest");
+  ofs << "# Generated by " PROGRAM_NAME " for " << node_cnt << " nodes\n";
+  for (int i=0; i<node_cnt; ++i)
+  {
+    ofs << node_callsign(i) << " " << group << "\n";
+  }
+  ofs.close();
+  if (!ofs)
+  {
+    std::cerr << "*** ERROR: Write to user database file \""
+              << user_db_file << "\" failed" << std::endl;
+    return false;
+  }
+  std::cout << "Wrote " << node_cnt << " users to \"" << user_db_file
+            << "\". Set the password with \"" << group << "=<key>\" in the "
+               "PASSWORDS section of the reflector configuration."
+            << std::endl;
+  return true;
+} /* write_user_db */
+
+
+static bool setup_ssl(void)
+{
+  if ((keyfile != nullptr) && (access(keyfile, F_OK) == 0))
+  {
+    if (!keypair.readPrivateKeyFile(keyfile))
+    {
+      std::cerr << "*** ERROR: Could not read private key file \""
+                << keyfile << "\"" << std::endl;
+      return false;
+    }
+  }
+  else
+  {
+    std::cout << "Generating private key..." << std::endl;
+    if (!keypair.generate(2048))
+    {
+      std::cerr << "*** ERROR: Failed to generate private key" << std::endl;
+      return false;
+    }
+    if ((keyfile != nullptr) && !keypair.writePrivateKeyFile(keyfile))
+    {
+      std::cerr << "*** ERROR: Could not write private key file \""
+                << keyfile << "\"" << std::endl;
+      return false;
+    }
+  }
+  if (keyfile == nullptr)
+  {
+    std::cout << "*** WARNING: No --keyfile given. The reflector will see a "
+                 "new public key for each node on every run." << std::endl;
+  }
+
+  if (cafile != nullptr)
+  {
+    if (!ssl_ctx.setCaCertificateFile(cafile))
+    {
+      std::cerr << "*** ERROR: Failed to read CA file \"" << cafile << "\""
+                << std::endl;
+      return false;
+    }
+  }
+  else
+  {
+    std::cout << "*** WARNING: No --cafile given. The reflector certificate "
+                 "will not be verified." << std::endl;
+  }
+
+  Json::Value node_info(Json::objectValue);
+  node_info["sw"] = PROGRAM_NAME;
+  node_info["swVer"] = SVXREFLECTOR_VERSION;
+  Json::StreamWriterBuilder builder;
+  builder["commentStyle"] = "None";
+  builder["indentation"] = "";
+
+  shared.host = host;
+  shared.port = port;
+  shared.auth_key = auth_key;
+  if (cert_email != nullptr)
+  {
+    shared.cert_email = cert_email;
+  }
+  shared.ssl_ctx = &ssl_ctx;
+  shared.keypair = &keypair;
+  shared.verify_server = (cafile != nullptr);
+  shared.node_info_json = Json::writeString(builder, node_info);
+  return true;
+} /* setup_ssl */
+
+
+static void create_audio_pool(void)
+{
+  std::unique_ptr<AudioEncoder> enc(AudioEncoder::create("OPUS"));
+  if (enc != nullptr)
+  {
+    enc->setOption("FRAME_SIZE", std::to_string(FRAME_INTERVAL_MS));
+    enc->writeEncodedSamples.connect(
+        [](const void* buf, int count)
+        {
+          const uint8_t* bbuf = static_cast<const uint8_t*>(buf);
+          std::vector<uint8_t> frame(bbuf, bbuf + count);
+          const uint64_t key = frame_hash(frame.data(), frame.size());
+          if (audio_pool_idx.emplace(key, audio_pool.size()).second)
+          {
+            audio_pool.push_back(std::move(frame));
+          }
+        });
+
+      // A slowly swept tone with some noise so that each frame is unique
+    std::uniform_real_distribution<float> noise(-0.05f, 0.05f);
+    const unsigned block_size = INTERNAL_SAMPLE_RATE * FRAME_INTERVAL_MS / 1000;
+    std::vector<float> block(block_size);
+    double phase = 0.0;
+    for (unsigned n=0; (audio_pool.size() < POOL_SIZE) && (n < 2 * POOL_SIZE);
+         ++n)
+    {
+      for (auto& sample : block)
+      {
+        const double freq = 300.0 + 2000.0 * (n % 100) / 100.0;
+        phase += 2.0 * M_PI * freq / INTERNAL_SAMPLE_RATE;
+        sample = 0.5f * std::sin(phase) + noise(rng);
+      }
+      enc->writeSamples(block.data(), block.size());
+    }
+  }
+
+  if (audio_pool.size() < POOL_SIZE)
+  {
+    std::cout << "*** WARNING: Opus encoding not available. Using random "
+                 "payload data instead." << std::endl;
+    audio_pool.clear();
+    audio_pool_idx.clear();
+    std::uniform_int_distribution<int> byte(0, 255);
+    while (audio_pool.size() < POOL_SIZE)
+    {
+      std::vector<uint8_t> frame(60);
+      for (auto& b : frame)
+      {
+        b = byte(rng);
+      }
+      const uint64_t key = frame_hash(frame.data(), frame.size());
+      if (audio_pool_idx.emplace(key, audio_pool.size()).second)
+      {
+        audio_pool.push_back(std::move(frame));
+      }
+    }
+  }
+} /* create_audio_pool */
+
+
+static void create_nodes(void)
+{
+  IpAddress bind_ip;
+  if ((bind_base != nullptr) && !bind_ip.setIpFromString(bind_base))
+  {
+    std::cerr << "*** ERROR: Illegal --bind-base address \"" << bind_base
+              << "\"" << std::endl;
+    exit(1);
+  }
+
+  tgs.resize(tg_cnt);
+  for (int i=0; i<tg_cnt; ++i)
+  {
+    TalkGroup& tg = tgs[i];
+    tg.tg = tg_base + i;
+    tg.sent_at.resize(audio_pool.size());
+      // Let the talk groups start at different times
+    tg.idle_left = std::uniform_int_distribution<unsigned>(
+        0, spurt_len * 1000 / FRAME_INTERVAL_MS)(rng);
+    tg_map[tg.tg] = &tg;
+  }
+
+  for (int i=0; i<node_cnt; ++i)
+  {
+    TalkGroup& tg = tgs[i % tg_cnt];
+    std::set<uint32_t> monitor_tgs;
+    for (int m=1; m<=monitor_cnt; ++m)
+    {
+      monitor_tgs.insert(tg_base + (i + m) % tg_cnt);
+    }
+    LoadGenNode* node = new LoadGenNode(shared, node_callsign(i), tg.tg,
+                                        monitor_tgs);
+    if (!bind_ip.isEmpty())
+    {
+      IpAddress::Ip4Addr addr = bind_ip.ip4Addr();
+      addr.s_addr = htonl(ntohl(addr.s_addr) + i);
+      node->setBindIp(IpAddress(addr));
+    }
+    node->loggedIn.connect(sigc::ptr_fun(&on_node_logged_in));
+    node->disconnected.connect(sigc::ptr_fun(&on_node_disconnected));
+    node->audioReceived.connect(sigc::ptr_fun(&on_node_audio));
+    nodes.emplace_back(node);
+    tg.members.push_back(node);
+  }
+} /* create_nodes */
+
+
+  // FNV-1a, used to look up received frames in the audio pool without
+  // having to copy them
+static uint64_t frame_hash(const uint8_t* data, size_t size)
+{
+  uint64_t hash = 14695981039346656037ULL;
+  for (size_t i=0; i<size; ++i)
+  {
+    hash = (hash ^ data[i]) * 1099511628211ULL;
+  }
+  return hash;
+} /* frame_hash */
+
+
+static std::string node_callsign(unsigned idx)
+{
+  std::ostringstream ss;
+  ss << ((callsign_prefix != nullptr) ? callsign_prefix : "LT")
+     << (idx / 26) << static_cast<char>('A' + idx % 26);
+  return ss.str();
+} /* node_callsign */
+
+
+static unsigned jitter(unsigned value)
+{
+  std::uniform_real_distribution<double> dist(0.5, 1.5);
+  return static_cast<unsigned>(std::lround(value * dist(rng)));
+} /* jitter */
+
+
+static void on_node_logged_in(LoadGenNode* node)
+{
+  logged_in.insert(node);
+  if (logged_in.size() < nodes.size())
+  {
+    return;
+  }
+
+  std::chrono::duration<double> elapsed;
+  if (storm_active)
+  {
+    storm_active = false;
+    elapsed = Clock::now() - storm_start;
+    storm_recovery_times.push_back(elapsed.count());
+    std::cout << "All nodes logged in again " << std::fixed
+              << std::setprecision(2) << elapsed.count()
+              << "s after reconnect storm" << std::endl;
+  }
+  else if (!all_logged_in)
+  {
+    elapsed = Clock::now() - start_time;
+    initial_login_time = elapsed.count();
+    steady_start = Clock::now();
+    alloc_steady_start = alloc_cnt.load();
+    frames_steady_start = total_cnt.frames_sent + total_cnt.frames_received;
+    std::cout << "All nodes logged in after " << std::fixed
+              << std::setprecision(2) << initial_login_time << "s"
+              << std::endl;
+  }
+  all_logged_in = true;
+  seconds_left_to_storm = storm_interval;
+} /* on_node_logged_in */
+
+
+static void on_node_disconnected(LoadGenNode* node, const std::string& reason)
+{
+  std::cout << "*** WARNING[" << node->callsign() << "]: Disconnected: "
+            << reason << std::endl;
+  logged_in.erase(node);
+  disconnect_reasons[reason] += 1;
+  reconnect_queue[node] = RECONNECT_DELAY;
+} /* on_node_disconnected */
+
+
+static void on_node_audio(LoadGenNode* node, const uint8_t* data,
+                          size_t size, uint32_t lost)
+{
+  const Clock::time_point now = Clock::now();
+  interval_cnt.frames_lost += lost;
+  total_cnt.frames_lost += lost;
+
+  auto tgit = tg_map.find(node->tg());
+  auto it = audio_pool_idx.find(frame_hash(data, size));
+  if ((it != audio_pool_idx.end()) &&
+      ((audio_pool[it->second].size() != size) ||
+       (memcmp(audio_pool[it->second].data(), data, size) != 0)))
+  {
+    it = audio_pool_idx.end();
+  }
+  if ((tgit == tg_map.end()) || (it == audio_pool_idx.end()))
+  {
+      // The frame was not sent by us unmodified. This may happen when the
+      // reflector mix audio from several talkers.
+    interval_cnt.frames_unmatched += 1;
+    total_cnt.frames_unmatched += 1;
+    return;
+  }
+
+  const std::chrono::duration<double, std::milli> latency =
+    now - tgit->second->sent_at[it->second];
+  interval_cnt.frames_received += 1;
+  interval_cnt.latency.add(latency.count());
+  total_cnt.frames_received += 1;
+  total_cnt.latency.add(latency.count());
+} /* on_node_audio */
+
+
+static void on_frame_timer(Timer* t)
+{
+    // Ramp up the number of connected nodes
+  if (next_node_to_connect < nodes.size())
+  {
+    ramp_credit += ramp * FRAME_INTERVAL_MS / 1000.0;
+    while ((ramp_credit >= 1.0) && (next_node_to_connect < nodes.size()))
+    {
+      nodes[next_node_to_connect++]->connect();
+      ramp_credit -= 1.0;
+    }
+  }
+
+  for (auto& tg : tgs)
+  {
+    process_talk_group(tg);
+  }
+} /* on_frame_timer */
+
+
+static void process_talk_group(TalkGroup& tg)
+{
+  if ((tg.talker != nullptr) && !tg.talker->isLoggedIn())
+  {
+    tg.talker = nullptr;
+    tg.idle_left = 0;
+  }
+
+  if (tg.talker == nullptr)
+  {
+    if (tg.idle_left > 0)
+    {
+      tg.idle_left -= 1;
+      return;
+    }
+    std::vector<LoadGenNode*> candidates;
+    for (auto node : tg.members)
+    {
+      if (node->isLoggedIn())
+      {
+        candidates.push_back(node);
+      }
+    }
+    if (candidates.size() < 2)
+    {
+      return;
+    }
+    tg.talker = candidates[
+      std::uniform_int_distribution<size_t>(0, candidates.size()-1)(rng)];
+    tg.frames_left = std::max(1U,
+        jitter(spurt_len * 1000 / FRAME_INTERVAL_MS));
+    tg.in_loss_burst = false;
+  }
+
+    // Two state loss model. The bad state is entered with a probability
+    // that give the requested loss fraction with the requested mean burst
+    // length.
+  bool drop = false;
+  if (loss_fraction > 0.0)
+  {
+    std::uniform_real_distribution<double> dist(0.0, 1.0);
+    if (tg.in_loss_burst)
+    {
+      tg.in_loss_burst = (dist(rng) >= 1.0 / loss_burst);
+    }
+    else
+    {
+      tg.in_loss_burst =
+        (dist(rng) < loss_fraction / (loss_burst * (1.0 - loss_fraction)));
+    }
+    drop = tg.in_loss_burst;
+  }
+
+  tg.frame_idx = (tg.frame_idx + 1) % audio_pool.size();
+  tg.sent_at[tg.frame_idx] = Clock::now();
+  tg.talker->sendAudio(audio_pool[tg.frame_idx], drop);
+  interval_cnt.frames_sent += 1;
+  total_cnt.frames_sent += 1;
+  if (drop)
+  {
+    interval_cnt.frames_dropped += 1;
+    total_cnt.frames_dropped += 1;
+  }
+  else
+  {
+    uint64_t receivers = 0;
+    for (auto node : tg.members)
+    {
+      if ((node != tg.talker) && node->isLoggedIn())
+      {
+        receivers += 1;
+      }
+    }
+    interval_cnt.frames_expected += receivers;
+    total_cnt.frames_expected += receivers;
+  }
+
+  if (--tg.frames_left == 0)
+  {
+    tg.talker->flushAudio();
+    tg.talker = nullptr;
+    tg.idle_left = jitter(
+        spurt_len * 1000 / FRAME_INTERVAL_MS * (100 - duty) / duty);
+  }
+} /* process_talk_group */
+
+
+static void on_tick_timer(Timer* t)
+{
+  for (auto& node : nodes)
+  {
+    node->tick();
+  }
+
+  for (auto it = reconnect_queue.begin(); it != reconnect_queue.end(); )
+  {
+    if (--it->second == 0)
+    {
+      it->first->connect();
+      it = reconnect_queue.erase(it);
+    }
+    else
+    {
+      ++it;
+    }
+  }
+
+  seconds_run += 1;
+  if ((seconds_run % interval) == 0)
+  {
+    print_status();
+  }
+
+  if ((storm_interval > 0) && all_logged_in && !storm_active &&
+      (--seconds_left_to_storm == 0))
+  {
+    start_storm();
+  }
+
+  if ((duration > 0) && (seconds_run >= static_cast<unsigned>(duration)))
+  {
+    Application::app().quit();
+  }
+} /* on_tick_timer */
+
+
+static void start_storm(void)
+{
+  std::cout << "Starting reconnect storm" << std::endl;
+  for (auto& node : nodes)
+  {
+    node->disconnect();
+  }
+  logged_in.clear();
+  reconnect_queue.clear();
+  for (auto& tg : tgs)
+  {
+    tg.talker = nullptr;
+  }
+  storm_active = true;
+  storm_start = Clock::now();
+  for (auto& node : nodes)
+  {
+    node->connect();
+  }
+  next_node_to_connect = nodes.size();
+} /* start_storm */
+
+
+static bool read_process_cpu_usec(uint64_t& usec)
+{
+  return processCpuUsec(reflector_pid, usec);
+} /* read_process_cpu_usec */
+
+
+static uint64_t own_cpu_usec(void)
+{
+  return ownCpuUsec();
+} /* own_cpu_usec */
+
+
+static void print_status(void)
+{
+  const Clock::time_point now = Clock::now();
+  const std::chrono::duration<double> elapsed = now - interval_start;
+  interval_start = now;
+
+  const Counters& c = interval_cnt;
+  std::cout << std::fixed << std::setprecision(1)
+            << "[" << std::setw(5) << seconds_run << "s] "
+            << "nodes=" << logged_in.size() << "/" << nodes.size()
+            << " tx=" << (c.frames_sent / elapsed.count()) << "/s"
+            << " rx=" << (c.frames_received / elapsed.count()) << "/s"
+            << " delivery="
+            << ((c.frames_expected > 0)
+                ? 100.0 * c.frames_received / c.frames_expected : 100.0)
+            << "%" << std::setprecision(2)
+            << " lat_ms(p50/p95/p99/max)="
+            << c.latency.percentile(0.5) << "/"
+            << c.latency.percentile(0.95) << "/"
+            << c.latency.percentile(0.99) << "/"
+            << c.latency.max();
+  if (c.frames_unmatched > 0)
+  {
+    std::cout << " unmatched=" << c.frames_unmatched;
+  }
+
+  const uint64_t own_cpu = own_cpu_usec();
+  std::cout << std::setprecision(1) << " cpu="
+            << (100.0 * (own_cpu - own_cpu_interval) / 1.0e6 /
+                elapsed.count()) << "%";
+  own_cpu_interval = own_cpu;
+
+  const uint64_t allocs = alloc_cnt.load() - alloc_interval;
+  alloc_interval += allocs;
+  std::cout << std::setprecision(0) << " allocs=" << (allocs / elapsed.count())
+            << "/s";
+  if (c.frames_sent + c.frames_received > 0)
+  {
+    std::cout << std::setprecision(2) << " allocs/frame="
+              << (static_cast<double>(allocs) /
+                  (c.frames_sent + c.frames_received));
+  }
+
+  uint64_t refl_cpu = 0;
+  if (read_process_cpu_usec(refl_cpu))
+  {
+    std::cout << " refl_cpu="
+              << (100.0 * (refl_cpu - refl_cpu_interval) / 1.0e6 /
+                  elapsed.count()) << "%";
+    if (c.frames_received > 0)
+    {
+      std::cout << std::setprecision(2) << " refl_us/frame="
+                << (static_cast<double>(refl_cpu - refl_cpu_interval) /
+                    c.frames_received);
+    }
+    refl_cpu_interval = refl_cpu;
+  }
+  std::cout << std::endl;
+
+  interval_cnt.clear();
+} /* print_status */
+
+
+static bool steady_state_allocs(double& per_s, double& per_frame)
+{
+  if (initial_login_time < 0.0)
+  {
+    return false;
+  }
+  const std::chrono::duration<double> elapsed = Clock::now() - steady_start;
+  const uint64_t allocs = alloc_cnt.load() - alloc_steady_start;
+  const uint64_t frames = total_cnt.frames_sent + total_cnt.frames_received -
+                          frames_steady_start;
+  if ((elapsed.count() <= 0.0) || (frames == 0))
+  {
+    return false;
+  }
+  per_s = allocs / elapsed.count();
+  per_frame = static_cast<double>(allocs) / frames;
+  return true;
+} /* steady_state_allocs */
+
+
+static void print_summary(void)
+{
+  const std::chrono::duration<double> elapsed = Clock::now() - start_time;
+  const Counters& c = total_cnt;
+  std::cout << std::fixed << std::setprecision(2)
+            << "\n--- Summary after " << elapsed.count() << "s ---\n"
+            << "Nodes logged in:       " << logged_in.size() << "/"
+            << nodes.size() << "\n"
+            << "Initial login time:    ";
+  if (initial_login_time >= 0.0)
+  {
+    std::cout << initial_login_time << "s\n";
+  }
+  else
+  {
+    std::cout << "not all nodes logged in\n";
+  }
+  for (size_t i=0; i<storm_recovery_times.size(); ++i)
+  {
+    std::cout << "Storm " << std::setw(3) << (i + 1) << " recovery:    "
+              << storm_recovery_times[i] << "s\n";
+  }
+  if (storm_active)
+  {
+    std::cout << "Storm " << std::setw(3) << (storm_recovery_times.size() + 1)
+              << " recovery:    not completed\n";
+  }
+  std::cout << "Frames sent:           " << c.frames_sent
+            << " (" << c.frames_dropped << " dropped by loss model)\n"
+            << "Frames received:       " << c.frames_received << " of "
+            << c.frames_expected << " expected ("
+            << ((c.frames_expected > 0)
+                ? 100.0 * c.frames_received / c.frames_expected : 100.0)
+            << "%)\n"
+            << "Frames unmatched:      " << c.frames_unmatched << "\n"
+            << "Sequence gaps seen:    " << c.frames_lost << "\n"
+            << "Latency ms:            min=" << c.latency.min()
+            << " avg=" << c.latency.mean()
+            << " p50=" << c.latency.percentile(0.5)
+            << " p95=" << c.latency.percentile(0.95)
+            << " p99=" << c.latency.percentile(0.99)
+            << " max=" << c.latency.max() << "\n"
+            << "Load generator CPU:    "
+            << (own_cpu_usec() - own_cpu_start) / 1.0e6 << "s\n";
+  double allocs_per_s = 0.0;
+  double allocs_per_frame = 0.0;
+  if (steady_state_allocs(allocs_per_s, allocs_per_frame))
+  {
+    std::cout << "Node allocations:      " << allocs_per_s << "/s ("
+              << allocs_per_frame << " per frame sent or received) after "
+              << "all nodes logged in\n";
+  }
+  uint64_t refl_cpu = 0;
+  if (read_process_cpu_usec(refl_cpu))
+  {
+    std::cout << "Reflector CPU:         "
+              << (refl_cpu - refl_cpu_start) / 1.0e6 << "s";
+    if (c.frames_received > 0)
+    {
+      std::cout << " ("
+                << (static_cast<double>(refl_cpu - refl_cpu_start) /
+                    c.frames_received)
+                << "us per forwarded frame)";
+    }
+    std::cout << "\n";
+  }
+  for (const auto& reason : disconnect_reasons)
+  {
+    std::cout << "Disconnects:           " << reason.second << " x "
+              << reason.first << "\n";
+  }
+  std::cout << std::flush;
+} /* print_summary */
+
+
+static bool write_json(void)
+{
+  const std::chrono::duration<double> elapsed = Clock::now() - start_time;
+  const Counters& c = total_cnt;
+
+  Json::Value root(Json::objectValue);
+  Json::Value& settings = root["settings"];
+  settings["host"] = host;
+  settings["port"] = port;
+  settings["nodes"] = node_cnt;
+  settings["tgs"] = tg_cnt;
+  settings["monitor"] = monitor_cnt;
+  settings["duty"] = duty;
+  settings["spurt"] = spurt_len;
+  settings["loss"] = loss_fraction * 100.0;
+  settings["loss_burst"] = loss_burst;
+  settings["storm"] = storm_interval;
+  settings["seed"] = seed;
+
+  root["elapsed_s"] = elapsed.count();
+  root["nodes_logged_in"] = Json::UInt64(logged_in.size());
+  root["initial_login_s"] =
+    (initial_login_time >= 0.0) ? Json::Value(initial_login_time)
+                                : Json::Value(Json::nullValue);
+  Json::Value& storms = root["storm_recovery_s"];
+  storms = Json::Value(Json::arrayValue);
+  for (const auto& t : storm_recovery_times)
+  {
+    storms.append(t);
+  }
+  root["storm_incomplete"] = storm_active;
+
+  Json::Value& frames = root["frames"];
+  frames["sent"] = Json::UInt64(c.frames_sent);
+  frames["dropped"] = Json::UInt64(c.frames_dropped);
+  frames["expected"] = Json::UInt64(c.frames_expected);
+  frames["received"] = Json::UInt64(c.frames_received);
+  frames["unmatched"] = Json::UInt64(c.frames_unmatched);
+  frames["seq_gaps"] = Json::UInt64(c.frames_lost);
+  frames["delivery_ratio"] =
+    (c.frames_expected > 0)
+      ? static_cast<double>(c.frames_received) / c.frames_expected : 1.0;
+
+  Json::Value& latency = root["latency_ms"];
+  latency["min"] = c.latency.min();
+  latency["avg"] = c.latency.mean();
+  latency["p50"] = c.latency.percentile(0.5);
+  latency["p95"] = c.latency.percentile(0.95);
+  latency["p99"] = c.latency.percentile(0.99);
+  latency["max"] = c.latency.max();
+
+  root["loadgen_cpu_s"] = (own_cpu_usec() - own_cpu_start) / 1.0e6;
+  double allocs_per_s = 0.0;
+  double allocs_per_frame = 0.0;
+  if (steady_state_allocs(allocs_per_s, allocs_per_frame))
+  {
+    root["node_allocs_per_s"] = allocs_per_s;
+    root["node_allocs_per_frame"] = allocs_per_frame;
+  }
+  uint64_t refl_cpu = 0;
+  if (read_process_cpu_usec(refl_cpu))
+  {
+    root["reflector_cpu_s"] = (refl_cpu - refl_cpu_start) / 1.0e6;
+    if (c.frames_received > 0)
+    {
+      root["reflector_us_per_frame"] =
+        static_cast<double>(refl_cpu - refl_cpu_start) / c.frames_received;
+    }
+      // The same values under the names also used by svxserver-loadgen so
+      // that the two relay implementations can be compared
+    root["relay_cpu_s"] = root["reflector_cpu_s"];
+    if (root.isMember("reflector_us_per_frame"))
+    {
+      root["relay_us_per_frame"] = root["reflector_us_per_frame"];
+    }
+  }
+
+  Json::Value& reasons = root["disconnects"];
+  reasons = Json::Value(Json::objectValue);
+  for (const auto& reason : disconnect_reasons)
+  {
+    reasons[reason.first] = reason.second;
+  }
+
+  std::ofstream ofs(json_file);
+  Json::StreamWriterBuilder builder;
+  builder["indentation"] = "  ";
+  ofs << Json::writeString(builder, root) << std::endl;
+  if (!ofs)
+  {
+    std::cerr << "*** ERROR: Could not write JSON file \"" << json_file
+              << "\"" << std::endl;
+    return false;
+  }
+  return true;
+} /* write_json */
+
+
+/*
+ * This file has not been truncated
+ */
@@ -0,0 +1,234 @@
+/**
+@file	 svxreflector-tgbench.cpp
+@brief   A micro benchmark for the talk group handler of the SvxReflector
+@author  Tobias Blomberg / SM0SVX
+@date	 2026-10-14
+
+This program measure how long the most common TGHandler operations take for
+a large reflector. A number of clients are spread out over a number of talk
+groups where each client also monitor a few extra talk groups. Then talk group
+selections, talker updates and the lookups done when fanning out audio are
+timed.
+
+\verbatim
+SvxReflector - An audio reflector for connecting SvxLink Servers
+Copyright (C) 2003-2026 Tobias Blomberg / SM0SVX
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+\endverbatim
+*/
+
+
+
+/****************************************************************************
+ *
+ * System Includes
+ *
+ ****************************************************************************/
+
+#include <cstdlib>
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <random>
+#include <vector>
+#include <set>
+
+
+/****************************************************************************
+ *
+ * Project Includes
+ *
+ ****************************************************************************/
+
+#include <AsyncCppApplication.h>
+#include <AsyncConfig.h>
+
+
+/****************************************************************************
+ *
+ * Local Includes
+ *
+ ****************************************************************************/
+
+#include "TGHandler.h"
+
+
+/****************************************************************************
+ *
+ * Namespaces to use
+ *
+ ****************************************************************************/
+
+using namespace std;
+using namespace Async;
+
+
+/****************************************************************************
+ *
+ * Defines & typedefs
+ *
+ ****************************************************************************/
+
+typedef std::chrono::steady_clock Clock;
+
+
+/****************************************************************************
+ *
+ * Local Global Variables
+ *
+ ****************************************************************************/
+
+static const unsigned MONITORED_TGS = 5;
+
+
+/****************************************************************************
+ *
+ * Local functions
+ *
+ ****************************************************************************/
+
+static void printResult(const char* name, size_t ops, Clock::duration elapsed)
+{
+  double ns = chrono::duration<double, nano>(elapsed).count();
+  cout << setw(24) << left << name << right
+       << setw(10) << ops
+       << setw(12) << fixed << setprecision(1) << (ns / ops) << " ns/op"
+       << endl;
+} /* printResult */
+
+
+/****************************************************************************
+ *
+ * MAIN
+ *
+ ****************************************************************************/
+
+int main(int argc, const char **argv)
+{
+  unsigned client_cnt = 5000;
+  unsigned tg_cnt = 500;
+  size_t rounds = 200000;
+  if (argc > 1)
+  {
+    client_cnt = atoi(argv[1]);
+  }
+  if (argc > 2)
+  {
+    tg_cnt = atoi(argv[2]);
+  }
+  if ((client_cnt == 0) || (tg_cnt == 0))
+  {
+    cerr << "Usage: svxreflector-tgbench [clients] [talk groups]" << endl;
+    return 1;
+  }
+
+  CppApplication app;
+  Config cfg;
+  TGHandler tg_handler;
+  tg_handler.setConfig(&cfg);
+
+    // The handler only use the client pointers as keys as long as no
+    // TG#<tg>/ALLOW is configured and no talker timeout occur, which cannot
+    // happen since the application main loop is never run. Dummy objects
+    // therefore stand in for real connected clients.
+  vector<char> storage(client_cnt);
+  vector<ReflectorClient*> clients;
+  for (auto& c : storage)
+  {
+    clients.push_back(reinterpret_cast<ReflectorClient*>(&c));
+  }
+
+  mt19937 rng(4711);
+  uniform_int_distribution<uint32_t> tg_dist(1, tg_cnt);
+  uniform_int_distribution<size_t> client_dist(0, client_cnt - 1);
+
+  Clock::time_point start = Clock::now();
+  for (auto& client : clients)
+  {
+    tg_handler.switchTo(client, tg_dist(rng));
+    set<uint32_t> tgs;
+    while (tgs.size() < std::min(MONITORED_TGS, tg_cnt))
+    {
+      tgs.insert(tg_dist(rng));
+    }
+    tg_handler.setMonitoredTGs(client, tgs);
+  }
+  printResult("Login", client_cnt, Clock::now() - start);
+
+  start = Clock::now();
+  for (size_t i=0; i<rounds; ++i)
+  {
+    tg_handler.switchTo(clients[client_dist(rng)], tg_dist(rng));
+  }
+  printResult("Select TG", rounds, Clock::now() - start);
+
+    // One talker per talk group sending audio frames round robin
+  vector<pair<uint32_t, ReflectorClient*> > talkers;
+  for (uint32_t tg=1; tg<=tg_cnt; ++tg)
+  {
+    const auto& members = tg_handler.clientsForTG(tg);
+    if (!members.empty())
+    {
+      talkers.push_back(make_pair(tg, *members.begin()));
+    }
+  }
+  if (talkers.empty())
+  {
+    cerr << "*** ERROR: No talk group have any members" << endl;
+    return 1;
+  }
+  start = Clock::now();
+  size_t receivers = 0;
+  for (size_t i=0; i<rounds; ++i)
+  {
+    const auto& talker = talkers[i % talkers.size()];
+    tg_handler.setTalkerForTG(talker.first, talker.second);
+    receivers += tg_handler.clientsForTG(talker.first).size() +
+                 tg_handler.monitorsForTG(talker.first).size();
+  }
+  printResult("Talker audio frame", rounds, Clock::now() - start);
+
+  start = Clock::now();
+  for (size_t i=0; i<rounds; ++i)
+  {
+    auto& client = clients[client_dist(rng)];
+    uint32_t tg = tg_handler.TGForClient(client);
+    if (tg_handler.talkerForTG(tg) == client)
+    {
+      tg_handler.setTalkerForTG(tg, 0);
+    }
+    tg_handler.switchTo(client, tg_dist(rng));
+  }
+  printResult("QSY during QSO", rounds, Clock::now() - start);
+
+  start = Clock::now();
+  for (auto& client : clients)
+  {
+    tg_handler.removeClient(client);
+  }
+  printResult("Logout", client_cnt, Clock::now() - start);
+
+  cout << "\n" << client_cnt << " clients, " << tg_cnt << " talk groups, "
+       << (receivers / rounds) << " receivers per audio frame" << endl;
+
+  return 0;
+} /* main */
+
+
+
+/*
+ * This file has not been truncated
+ */
@@ -0,0 +1,448 @@
+/**
+@file	 IqServer.cpp
+@brief   A server that send channelized tuner samples to SvxLink
+@author  Tobias Blomberg / SM0SVX
+@date	 2026-10-14
+
+\verbatim
+RemoteTrx - A remote receiver for the SvxLink server
+Copyright (C) 2003-2026 Tobias Blomberg / SM0SVX
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+\endverbatim
+*/
+
+
+
+/****************************************************************************
+ *
+ * System Includes
+ *
+ ****************************************************************************/
+
+#include <iostream>
+#include <string>
+#include <sstream>
+
+
+/****************************************************************************
+ *
+ * Project Includes
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Local Includes
+ *
+ ****************************************************************************/
+
+#include "IqServer.h"
+#include "RtlSdr.h"
+#include "WbRxRtlSdr.h"
+#include "PfbChannelizer.h"
+
+
+/****************************************************************************
+ *
+ * Namespaces to use
+ *
+ ****************************************************************************/
+
+using namespace std;
+using namespace Async;
+
+
+
+/****************************************************************************
+ *
+ * Defines & typedefs
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Local class definitions
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Prototypes
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Exported Global Variables
+ *
+ ****************************************************************************/
+
+
+
+
+/****************************************************************************
+ *
+ * Local Global Variables
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Public member functions
+ *
+ ****************************************************************************/
+
+IqServer::IqServer(Async::Config &cfg, const std::string &name)
+  : m_cfg(cfg), m_name(name), m_rtl(0), m_pfb(0), m_srv(0), m_con(0)
+{
+} /* IqServer::IqServer */
+
+
+IqServer::~IqServer(void)
+{
+  delete m_srv;
+  m_srv = 0;
+  m_con = 0;
+  delete m_rtl;
+  m_rtl = 0;
+  delete m_pfb;
+  m_pfb = 0;
+} /* IqServer::~IqServer */
+
+
+bool IqServer::initialize(void)
+{
+  string rtl_type;
+  m_cfg.getValue(m_name, "TYPE", rtl_type);
+  if (rtl_type == "RtlRemote")
+  {
+    cerr << "*** ERROR: " << m_name << "/TYPE=RtlRemote is not valid for "
+         << "an IQ server" << endl;
+    return false;
+  }
+  m_rtl = WbRxRtlSdr::createDongle(m_cfg, m_name);
+  if (m_rtl == 0)
+  {
+    return false;
+  }
+  m_rtl->iqReceived.connect(mem_fun(*this, &IqServer::iqReceived));
+  m_rtl->readyStateChanged.connect(
+      mem_fun(*this, &IqServer::rtlReadyStateChanged));
+
+  bool peak_meter = false;
+  m_cfg.getValue(m_name, "PEAK_METER", peak_meter);
+  m_rtl->enableDistPrint(peak_meter);
+
+  string listen_port;
+  {
+    ostringstream ss;
+    ss << RtlRemoteMsg::DEFAULT_PORT;
+    listen_port = ss.str();
+  }
+  m_cfg.getValue(m_name, "LISTEN_PORT", listen_port);
+  m_srv = new FramedTcpServer(listen_port);
+  m_srv->clientConnected.connect(mem_fun(*this, &IqServer::clientConnected));
+  m_srv->clientDisconnected.connect(
+      mem_fun(*this, &IqServer::clientDisconnected));
+
+  cout << m_name << ": Listening for IQ clients on TCP port " << listen_port
+       << endl;
+
+  return true;
+} /* IqServer::initialize */
+
+
+
+/****************************************************************************
+ *
+ * Protected member functions
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Private member functions
+ *
+ ****************************************************************************/
+
+void IqServer::clientConnected(Async::FramedTcpConnection *con)
+{
+  if (m_con != 0)
+  {
+    cerr << "*** WARNING: " << m_name << ": Rejecting IQ client "
+         << con->remoteHost() << ":" << con->remotePort()
+         << " since another client is already connected" << endl;
+    con->disconnect();
+    con->disconnected(con, FramedTcpConnection::DR_ORDERED_DISCONNECT);
+    return;
+  }
+
+  cout << m_name << ": IQ client connected from " << con->remoteHost() << ":"
+       << con->remotePort() << endl;
+  m_con = con;
+  m_con->setMaxRxFrameSize(RtlRemoteMsg::MAX_FRAME_SIZE);
+  m_con->setMaxTxFrameSize(RtlRemoteMsg::MAX_FRAME_SIZE);
+  m_con->frameReceived.connect(mem_fun(*this, &IqServer::frameReceived));
+  if (m_rtl->isReady())
+  {
+    sendMsg(RtlRemoteMsgHello(m_rtl->tunerType()));
+  }
+} /* IqServer::clientConnected */
+
+
+void IqServer::clientDisconnected(Async::FramedTcpConnection *con,
+                      Async::FramedTcpConnection::DisconnectReason reason)
+{
+  if (con != m_con)
+  {
+    return;
+  }
+  cout << m_name << ": IQ client " << con->remoteHost() << ":"
+       << con->remotePort() << " disconnected: "
+       << TcpConnection::disconnectReasonStr(reason) << endl;
+  m_con = 0;
+  subscribe(std::vector<uint16_t>());
+} /* IqServer::clientDisconnected */
+
+
+void IqServer::frameReceived(Async::FramedTcpConnection *con,
+                             std::vector<uint8_t>& data)
+{
+  Async::MsgBufReader r(data.data(), data.size());
+  RtlRemoteMsg header;
+  if (!header.unpack(r))
+  {
+    cerr << "*** WARNING: " << m_name << ": Could not unpack IQ client "
+         << "message header" << endl;
+    disconnectClient();
+    return;
+  }
+
+  switch (header.type())
+  {
+    case RtlRemoteMsgCommand::TYPE:
+    {
+      RtlRemoteMsgCommand msg;
+      if (!msg.unpack(r))
+      {
+        cerr << "*** WARNING: " << m_name << ": Could not unpack IQ client "
+             << "command" << endl;
+        disconnectClient();
+        return;
+      }
+      handleCommand(msg);
+      break;
+    }
+
+    case RtlRemoteMsgSubscribe::TYPE:
+    {
+      RtlRemoteMsgSubscribe msg;
+      if (!msg.unpack(r))
+      {
+        cerr << "*** WARNING: " << m_name << ": Could not unpack IQ client "
+             << "subscription" << endl;
+        disconnectClient();
+        return;
+      }
+      subscribe(msg.bins());
+      break;
+    }
+
+    default:
+      cerr << "*** WARNING: " << m_name << ": Unknown IQ client message type "
+           << header.type() << endl;
+      break;
+  }
+} /* IqServer::frameReceived */
+
+
+void IqServer::handleCommand(const RtlRemoteMsgCommand& msg)
+{
+  uint32_t param = msg.param();
+  switch (msg.cmd())
+  {
+    case RtlRemoteMsgCommand::CMD_CENTER_FQ:
+      m_rtl->setCenterFq(param);
+      break;
+    case RtlRemoteMsgCommand::CMD_SAMPLE_RATE:
+      setSampleRate(param);
+      break;
+    case RtlRemoteMsgCommand::CMD_GAIN_MODE:
+      m_rtl->setGainMode(param);
+      break;
+    case RtlRemoteMsgCommand::CMD_GAIN:
+      m_rtl->setGain(static_cast<int32_t>(param));
+      break;
+    case RtlRemoteMsgCommand::CMD_FQ_CORR:
+      m_rtl->setFqCorr(param);
+      break;
+    case RtlRemoteMsgCommand::CMD_TUNER_IF_GAIN:
+      m_rtl->setTunerIfGain(param >> 16, static_cast<int16_t>(param & 0xffff));
+      break;
+    case RtlRemoteMsgCommand::CMD_TEST_MODE:
+      m_rtl->enableTestMode(param != 0);
+      break;
+    case RtlRemoteMsgCommand::CMD_DIGITAL_AGC:
+      m_rtl->enableDigitalAgc(param != 0);
+      break;
+    default:
+      cerr << "*** WARNING: " << m_name << ": Unknown IQ client command "
+           << static_cast<unsigned>(msg.cmd()) << endl;
+      break;
+  }
+} /* IqServer::handleCommand */
+
+
+void IqServer::setSampleRate(uint32_t rate)
+{
+  if (!PfbChannelizer::isSupported(rate))
+  {
+    cerr << "*** WARNING: " << m_name << ": Unsupported sample rate "
+         << rate << " requested by IQ client" << endl;
+    disconnectClient();
+    return;
+  }
+
+  if ((m_pfb != 0) && (m_rtl->sampleRate() == rate))
+  {
+    return;
+  }
+
+    // The bin layout depend on the sample rate so the subscription is
+    // dropped. The client will subscribe again when it notice.
+  subscribe(std::vector<uint16_t>());
+  delete m_pfb;
+  m_pfb = new PfbChannelizer(rate);
+  m_rtl->setSampleRate(rate);
+} /* IqServer::setSampleRate */
+
+
+void IqServer::subscribe(const std::vector<uint16_t>& bins)
+{
+  for (auto& con : m_bin_cons)
+  {
+    con.disconnect();
+  }
+  m_bin_cons.clear();
+  m_bins.clear();
+
+  if (m_pfb == 0)
+  {
+    return;
+  }
+
+  for (const auto& bin : bins)
+  {
+    if (bin >= m_pfb->binCount())
+    {
+      cerr << "*** WARNING: " << m_name << ": IQ client subscribed to "
+           << "non-existent bin " << bin << endl;
+      continue;
+    }
+    m_bins.push_back(bin);
+    m_bin_cons.push_back(m_pfb->connectBin(bin,
+        sigc::bind(mem_fun(*this, &IqServer::binSamplesReceived),
+                   static_cast<unsigned>(bin))));
+  }
+} /* IqServer::subscribe */
+
+
+void IqServer::binSamplesReceived(const std::vector<Sample>& samples,
+                                  unsigned bin)
+{
+  m_bin_msg.setSamples(bin, samples);
+  sendMsg(m_bin_msg);
+} /* IqServer::binSamplesReceived */
+
+
+void IqServer::iqReceived(const std::vector<Sample>& samples)
+{
+  if ((m_pfb != 0) && !m_bins.empty())
+  {
+    m_pfb->iqReceived(samples);
+  }
+} /* IqServer::iqReceived */
+
+
+void IqServer::rtlReadyStateChanged(void)
+{
+  if (m_rtl->isReady())
+  {
+    cout << m_name << ": Tuner " << m_rtl->displayName() << " ready ("
+         << m_rtl->tunerTypeString() << ")" << endl;
+    sendMsg(RtlRemoteMsgHello(m_rtl->tunerType()));
+  }
+  else
+  {
+    cerr << "*** WARNING: " << m_name << ": Tuner " << m_rtl->displayName()
+         << " not ready" << endl;
+    disconnectClient();
+  }
+} /* IqServer::rtlReadyStateChanged */
+
+
+void IqServer::sendMsg(const RtlRemoteMsg& msg)
+{
+  if ((m_con == 0) || !m_con->isConnected())
+  {
+    return;
+  }
+
+  RtlRemoteMsg header(msg.type());
+  m_tx_buf.resize(header.packedSize() + msg.packedSize());
+  Async::MsgBufWriter w(m_tx_buf.data(), m_tx_buf.size());
+  if (!header.pack(w) || !msg.pack(w))
+  {
+    cerr << "*** ERROR: " << m_name << ": Failed to pack IQ message "
+         << msg.type() << endl;
+    return;
+  }
+  if (m_con->write(m_tx_buf.data(), w.size()) == -1)
+  {
+    cerr << "*** ERROR: " << m_name << ": Failed to write IQ message "
+         << msg.type() << endl;
+    disconnectClient();
+  }
+} /* IqServer::sendMsg */
+
+
+void IqServer::disconnectClient(void)
+{
+  if (m_con == 0)
+  {
+    return;
+  }
+  Async::FramedTcpConnection *con = m_con;
+  con->disconnect();
+  con->disconnected(con, FramedTcpConnection::DR_ORDERED_DISCONNECT);
+} /* IqServer::disconnectClient */
+
+
+/*
+ * This file has not been truncated
+ */
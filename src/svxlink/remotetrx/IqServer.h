@@ -0,0 +1,192 @@
+/**
+@file	 IqServer.h
+@brief   A server that send channelized tuner samples to SvxLink
+@author  Tobias Blomberg / SM0SVX
+@date	 2026-10-14
+
+\verbatim
+RemoteTrx - A remote receiver for the SvxLink server
+Copyright (C) 2003-2026 Tobias Blomberg / SM0SVX
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+\endverbatim
+*/
+
+
+#ifndef IQ_SERVER_INCLUDED
+#define IQ_SERVER_INCLUDED
+
+
+/****************************************************************************
+ *
+ * System Includes
+ *
+ ****************************************************************************/
+
+#include <sigc++/sigc++.h>
+
+#include <string>
+#include <vector>
+
+
+/****************************************************************************
+ *
+ * Project Includes
+ *
+ ****************************************************************************/
+
+#include <AsyncConfig.h>
+#include <AsyncTcpServer.h>
+#include <AsyncFramedTcpConnection.h>
+
+
+/****************************************************************************
+ *
+ * Local Includes
+ *
+ ****************************************************************************/
+
+#include "RtlRemoteMsg.h"
+
+
+/****************************************************************************
+ *
+ * Forward declarations
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Namespace
+ *
+ ****************************************************************************/
+
+//namespace MyNameSpace
+//{
+
+
+/****************************************************************************
+ *
+ * Forward declarations of classes inside of the declared namespace
+ *
+ ****************************************************************************/
+
+class RtlSdr;
+class PfbChannelizer;
+  
+
+/****************************************************************************
+ *
+ * Defines & typedefs
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Exported Global Variables
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Class definitions
+ *
+ ****************************************************************************/
+
+/**
+@brief	A server that send channelized tuner samples to SvxLink
+@author Tobias Blomberg / SM0SVX
+@date   2026-10-14
+
+This class own an RTL2832U based tuner, either directly over USB or through
+rtl_tcp, and run the polyphase filter bank channelizer on the wideband
+samples. A SvxLink WbRx of type RtlRemote connect to the server, control the
+tuner and subscribe to the channelizer bins that its DDR:s use. Only the
+subscribed bins are sent over the network, which is a small fraction of the
+full wideband sample stream that rtl_tcp would send.
+
+Only one client at a time can be connected since the client control the
+tuner settings.
+*/
+class IqServer : public sigc::trackable
+{
+  public:
+    /**
+     * @brief 	Constuctor
+     * @param   cfg   The configuration object
+     * @param   name  The name of the configuration section
+     */
+    IqServer(Async::Config &cfg, const std::string &name);
+  
+    /**
+     * @brief 	Destructor
+     */
+    ~IqServer(void);
+  
+    /**
+     * @brief 	Initialize the IQ server
+     * @return	Returns \em true on success or else \em false
+     */
+    bool initialize(void);
+    
+  private:
+    typedef Async::TcpServer<Async::FramedTcpConnection> FramedTcpServer;
+    typedef std::complex<float> Sample;
+
+    Async::Config&                m_cfg;
+    std::string                   m_name;
+    RtlSdr*                       m_rtl;
+    PfbChannelizer*               m_pfb;
+    FramedTcpServer*              m_srv;
+    Async::FramedTcpConnection*   m_con;
+    std::vector<uint16_t>         m_bins;
+    std::vector<sigc::connection> m_bin_cons;
+    RtlRemoteMsgBinSamples        m_bin_msg;
+    std::vector<uint8_t>          m_tx_buf;
+
+    IqServer(const IqServer&);
+    IqServer& operator=(const IqServer&);
+    void clientConnected(Async::FramedTcpConnection *con);
+    void clientDisconnected(Async::FramedTcpConnection *con,
+                            Async::FramedTcpConnection::DisconnectReason reason);
+    void frameReceived(Async::FramedTcpConnection *con,
+                       std::vector<uint8_t>& data);
+    void handleCommand(const RtlRemoteMsgCommand& msg);
+    void setSampleRate(uint32_t rate);
+    void subscribe(const std::vector<uint16_t>& bins);
+    void binSamplesReceived(const std::vector<Sample>& samples, unsigned bin);
+    void iqReceived(const std::vector<Sample>& samples);
+    void rtlReadyStateChanged(void);
+    void sendMsg(const RtlRemoteMsg& msg);
+    void disconnectClient(void);
+    
+};  /* class IqServer */
+
+
+//} /* namespace */
+
+#endif /* IQ_SERVER_INCLUDED */
+
+
+
+/*
+ * This file has not been truncated
+ */
@@ -6,7 +6,7 @@
 
 \verbatim
 RemoteTrx - A remote receiver for the SvxLink server
-Copyright (C) 2003-2025 Tobias Blomberg / SM0SVX
+Copyright (C) 2003-2026 Tobias Blomberg / SM0SVX
 
 This program is free software; you can redistribute it and/or modify
 it under the terms of the GNU General Public License as published by
@@ -35,6 +35,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 #include <iostream>
 #include <cstring>
 #include <cerrno>
+#include <algorithm>
 
 
 /****************************************************************************
@@ -49,9 +50,12 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 #include <AsyncTimer.h>
 #include <AsyncAudioEncoder.h>
 #include <AsyncAudioDecoder.h>
+#include <AsyncAudioCodecPool.h>
 #include <AsyncAudioSplitter.h>
 #include <AsyncAudioSelector.h>
 #include <AsyncAudioPassthrough.h>
+#include <AsyncAudioSink.h>
+#include <AsyncAudioSource.h>
 
 
 /****************************************************************************
@@ -61,6 +65,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
  ****************************************************************************/
 
 #include "NetUplink.h"
+#include "NetTrxUdpChannel.h"
 #include "Rx.h"
 
 
@@ -90,6 +95,149 @@ using namespace NetTrxMsg;
  *
  ****************************************************************************/
 
+  /*
+   * The state for one connected client
+   */
+struct NetUplink::Client
+{
+  Async::TcpConnection  *con;
+  char                  recv_buf[4096];
+  unsigned              recv_cnt;
+  unsigned              recv_exp;
+  struct timeval        last_msg_timestamp;
+  State                 state;
+  unsigned char         auth_challenge[MsgAuthChallenge::CHALLENGE_LEN];
+  unsigned              prio;
+  unsigned              seq;
+  Tx::TxCtrlMode        tx_ctrl_mode;
+  bool                  ctcss_enabled;
+  Rx::MuteState         mute_state;
+  RxEncoder             *rx_enc;
+  Async::AudioDecoder   *audio_dec;
+  uint64_t              peer_hb_timestamp;
+  struct timeval        peer_hb_rx_timestamp;
+
+  Client(void)
+    : con(0), recv_cnt(0), recv_exp(0), last_msg_timestamp(),
+      state(STATE_DISC), prio(0), seq(0), tx_ctrl_mode(Tx::TX_OFF),
+      ctcss_enabled(false), mute_state(Rx::MUTE_ALL), rx_enc(0),
+      audio_dec(0), peer_hb_timestamp(0), peer_hb_rx_timestamp()
+  {
+  }
+}; /* struct NetUplink::Client */
+
+
+  /*
+   * Hold back the TX audio until the launch time of the stream. The audio
+   * is buffered in the FIFO before the gate while it is held.
+   */
+class NetUplink::LaunchGate : public Async::AudioSink,
+                              public Async::AudioSource
+{
+  public:
+    LaunchGate(void) {}
+
+    void hold(void) { is_held = true; }
+
+    void release(void)
+    {
+      is_held = false;
+      if (input_stopped)
+      {
+        input_stopped = false;
+        sourceResumeOutput();
+      }
+      if (flush_pending)
+      {
+        flush_pending = false;
+        sinkFlushSamples();
+      }
+    }
+
+    void reset(void)
+    {
+      release();
+      is_idle = true;
+    }
+
+    bool isHeld(void) const { return is_held; }
+    bool isIdle(void) const { return is_idle; }
+
+    virtual int writeSamples(const float *samples, int count) override
+    {
+      is_idle = false;
+      if (is_held)
+      {
+        input_stopped = true;
+        return 0;
+      }
+      int ret = sinkWriteSamples(samples, count);
+      input_stopped = (ret == 0);
+      return ret;
+    }
+
+    virtual void flushSamples(void) override
+    {
+      if (is_held)
+      {
+        flush_pending = true;
+        return;
+      }
+      sinkFlushSamples();
+    }
+
+    virtual void resumeOutput(void) override
+    {
+      if (!is_held && input_stopped)
+      {
+        input_stopped = false;
+        sourceResumeOutput();
+      }
+    }
+
+    virtual void allSamplesFlushed(void) override
+    {
+      is_idle = true;
+      sourceAllSamplesFlushed();
+    }
+
+  private:
+    bool is_held        = false;
+    bool is_idle        = true;
+    bool input_stopped  = false;
+    bool flush_pending  = false;
+}; /* class NetUplink::LaunchGate */
+
+
+  /*
+   * An RX audio encoder shared by all clients using the same codec
+   * configuration
+   */
+struct NetUplink::RxEncoder
+{
+  std::string           key;
+  Async::AudioEncoder   *enc;
+  unsigned              users;
+}; /* struct NetUplink::RxEncoder */
+
+
+  /*
+   * A tone detector that has been added to the receiver
+   */
+struct NetUplink::ToneDet
+{
+  float fq;
+  int   bw;
+  float thresh;
+  int   required_duration;
+
+  bool operator==(const ToneDet& other) const
+  {
+    return (fq == other.fq) && (bw == other.bw) && (thresh == other.thresh) &&
+           (required_duration == other.required_duration);
+  }
+}; /* struct NetUplink::ToneDet */
+
 
 
 /****************************************************************************
@@ -125,36 +273,62 @@ using namespace NetTrxMsg;
 
 NetUplink::NetUplink(Config &cfg, const string &name, Rx *rx, Tx *tx,
       	      	     const string& port_str)
-  : server(0), con(0), recv_cnt(0), recv_exp(0), rx(rx), tx(tx), fifo(0),
-    cfg(cfg), name(name), last_msg_timestamp(), heartbeat_timer(0),
-    audio_enc(0), audio_dec(0), loopback_con(0), rx_splitter(0),
-    tx_selector(0), state(STATE_DISC), mute_tx_timer(0), tx_muted(false),
-    fallback_enabled(false), tx_ctrl_mode(Tx::TX_OFF)
+  : server(0), tx_client(0), udp_client(0), max_clients(1), client_seq(0),
+    rx(rx), tx(tx), fifo(0), cfg(cfg), name(name), heartbeat_timer(0),
+    loopback_con(0), rx_splitter(0), tx_selector(0), dec_selector(0),
+    launch_gate(0), launch_timer(0),
+    mute_tx_timer(0), tx_muted(false), fallback_enabled(false), udp_chan(0),
+    udp_port(0)
 {
   heartbeat_timer = new Timer(10000);
   heartbeat_timer->setEnable(false);
   heartbeat_timer->expired.connect(mem_fun(*this, &NetUplink::heartbeat));
 
+  launch_timer = new Timer(0);
+  launch_timer->setEnable(false);
+  launch_timer->expired.connect(mem_fun(*this, &NetUplink::txLaunch));
+
     // FIXME: Shouldn't we use the updates directly from the receiver instead?
     // Why is this even here?!
   //siglev_check_timer = new Timer(1000, Timer::TYPE_PERIODIC);
   //siglev_check_timer->setEnable(true);
   //siglev_check_timer->expired.connect(mem_fun(*this, &NetUplink::checkSiglev));
-  
+
 } /* NetUplink::NetUplink */
 
 
 NetUplink::~NetUplink(void)
 {
-  delete audio_enc;
-  delete audio_dec;
+  for (ClientList::iterator it=clients.begin(); it!=clients.end(); ++it)
+  {
+    Client *client = *it;
+    if (client->audio_dec != 0)
+    {
+      dec_selector->removeSource(client->audio_dec);
+      AudioCodecPool::instance().release(client->audio_dec);
+    }
+    delete client;
+  }
+  clients.clear();
+  for (RxEncoderMap::iterator it=rx_encoders.begin(); it!=rx_encoders.end();
+       ++it)
+  {
+    rx_splitter->removeSink(it->second->enc);
+    AudioCodecPool::instance().release(it->second->enc);
+    delete it->second;
+  }
+  rx_encoders.clear();
   delete fifo;
+  delete launch_gate;
   delete tx_selector;
+  delete dec_selector;
   delete rx_splitter;
   delete loopback_con;
   delete server;
   delete heartbeat_timer;
+  delete launch_timer;
   delete mute_tx_timer;
+  delete udp_chan;
   //delete siglev_check_timer;
 } /* NetUplink::~NetUplink */
 
@@ -194,6 +368,14 @@ bool NetUplink::initialize(void)
   cfg.getValue(name, "FALLBACK_REPEATER", fallback_enabled, true);
   cfg.getValue(name, "AUTH_KEY", auth_key);
 
+  if (!cfg.getValue(name, "MAX_CLIENTS", 1U, 64U, max_clients, true))
+  {
+    std::cerr << "*** ERROR: Illegal value for configuration variable "
+              << name << "/MAX_CLIENTS. Valid range is 1-64." << std::endl;
+    return false;
+  }
+  cfg.getValue(name, "CLIENT_PRIORITY", client_prio, true);
+
   int mute_tx_on_rx = -1;
   cfg.getValue(name, "MUTE_TX_ON_RX", mute_tx_on_rx, true);
   if (mute_tx_on_rx >= 0)
@@ -202,29 +384,54 @@ bool NetUplink::initialize(void)
     mute_tx_timer->setEnable(false);
     mute_tx_timer->expired.connect(mem_fun(*this, &NetUplink::unmuteTx));
   }
-  
+
+  bool udp_audio = false;
+  cfg.getValue(name, "UDP_AUDIO", udp_audio);
+  if (udp_audio)
+  {
+    string udp_listen_port(listen_port);
+    cfg.getValue(name, "UDP_LISTEN_PORT", udp_listen_port);
+    udp_port = static_cast<uint16_t>(atoi(udp_listen_port.c_str()));
+    udp_chan = new NetTrxUdpChannel(NetTrxUdpChannel::ROLE_SERVER, udp_port);
+    if ((udp_port == 0) || !udp_chan->initOk())
+    {
+      std::cerr << "*** ERROR: Could not set up UDP audio on port "
+                << udp_listen_port << " in NetUplink " << name << std::endl;
+      return false;
+    }
+    unsigned udp_jitter_buffer_delay = udp_chan->jitterBufferDelay();
+    cfg.getValue(name, "UDP_JITTER_BUFFER_DELAY", udp_jitter_buffer_delay);
+    udp_chan->setJitterBufferDelay(udp_jitter_buffer_delay);
+    udp_chan->upStateChanged.connect(
+        mem_fun(*this, &NetUplink::udpUpStateChanged));
+    udp_chan->audioReceived.connect(
+        mem_fun(*this, &NetUplink::udpAudioReceived));
+    udp_chan->flushReceived.connect(
+        mem_fun(*this, &NetUplink::udpFlushReceived));
+  }
+
   server = new TcpServer<>(listen_port);
   server->clientConnected.connect(mem_fun(*this, &NetUplink::clientConnected));
   server->clientDisconnected.connect(
       mem_fun(*this, &NetUplink::clientDisconnected));
-  
-  rx->reset();
+
+  resetRx();
   rx->squelchOpen.connect(mem_fun(*this, &NetUplink::squelchOpen));
   rx->signalLevelUpdated.connect(mem_fun(*this, &NetUplink::signalLevelUpdated));
   rx->dtmfDigitDetected.connect(mem_fun(*this, &NetUplink::dtmfDigitDetected));
   rx->toneDetected.connect(mem_fun(*this, &NetUplink::toneDetected));
   rx->selcallSequenceDetected.connect(
       mem_fun(*this, &NetUplink::selcallSequenceDetected));
-  
+
   tx->txTimeout.connect(mem_fun(*this, &NetUplink::txTimeout));
   tx->transmitterStateChange.connect(
       mem_fun(*this, &NetUplink::transmitterStateChange));
-  
+
   rx_splitter = new AudioSplitter;
   rx->registerSink(rx_splitter);
 
   loopback_con = new AudioPassthrough;
-  
+
   rx_splitter->addSink(loopback_con);
 
   tx_selector = new AudioSelector;
@@ -232,13 +439,23 @@ bool NetUplink::initialize(void)
 
   unsigned tx_jitter_buffer_delay = 0;
   cfg.getValue(name, "TX_JITTER_BUFFER_DELAY", tx_jitter_buffer_delay);
-  fifo = new AudioFifo(INTERNAL_SAMPLE_RATE);
+    // The FIFO must be able to hold the audio received while waiting for
+    // the launch time of a simulcast stream
+  fifo = new AudioFifo(
+      (1000 + MsgTxLaunchTime::MAX_DELAY) * INTERNAL_SAMPLE_RATE / 1000);
   fifo->setPrebufSamples(tx_jitter_buffer_delay*INTERNAL_SAMPLE_RATE/1000);
-  tx_selector->addSource(fifo);
-  tx_selector->selectSource(fifo);
+  launch_gate = new LaunchGate;
+  fifo->registerSink(launch_gate);
+  tx_selector->addSource(launch_gate);
+  tx_selector->selectSource(launch_gate);
+
+    // The TX audio decoders of all clients are connected to the FIFO through
+    // this selector. Only the client controlling the transmitter is selected.
+  dec_selector = new AudioSelector;
+  dec_selector->registerSink(fifo);
 
   tx_selector->registerSink(tx);
-  
+
   if (fallback_enabled)
   {
     setFallbackActive(true);
@@ -249,7 +466,7 @@ bool NetUplink::initialize(void)
   }
 
   return true;
-  
+
 } /* NetUplink::initialize */
 
 
@@ -271,47 +488,44 @@ bool NetUplink::initialize(void)
 
 void NetUplink::handleIncomingConnection(TcpConnection *incoming_con)
 {
-  assert(con == 0);
-  rx->reset();
-  if (fallback_enabled) // Deactivate fallback repeater mode
-  {
-    setFallbackActive(false);
-  }
-  
-  if (audio_enc != 0)
-  {
-    rx_splitter->removeSink(audio_enc);
-    delete audio_enc;
-    audio_enc = 0;
-  }
-  
-  delete audio_dec;
-  audio_dec = 0;
-  
-  con = incoming_con;
-  con->dataReceived.connect(mem_fun(*this, &NetUplink::tcpDataReceived));
-  recv_exp = sizeof(Msg);
-  recv_cnt = 0;
-  heartbeat_timer->setEnable(true);
-  gettimeofday(&last_msg_timestamp, NULL);
-  
-  setState(STATE_CON_SETUP);
+  if (clients.empty())
+  {
+    resetRx();
+    if (fallback_enabled) // Deactivate fallback repeater mode
+    {
+      setFallbackActive(false);
+    }
+    heartbeat_timer->setEnable(true);
+  }
+
+  Client *client = new Client;
+  client->con = incoming_con;
+  client->prio = clientPrio(incoming_con);
+  client->seq = ++client_seq;
+  client->con->dataReceived.connect(
+      sigc::bind(mem_fun(*this, &NetUplink::tcpDataReceived), client));
+  client->recv_exp = sizeof(Msg);
+  client->recv_cnt = 0;
+  gettimeofday(&client->last_msg_timestamp, NULL);
+  client->state = STATE_CON_SETUP;
+  clients.push_back(client);
 
   MsgProtoVer *ver_msg = new MsgProtoVer;
-  sendMsg(ver_msg);
-  
+  sendMsg(client, ver_msg);
+
   if (auth_key.empty())
   {
     MsgAuthOk *auth_msg = new MsgAuthOk;
-    sendMsg(auth_msg);
-    setState(STATE_READY);
+    sendMsg(client, auth_msg);
+    client->state = STATE_READY;
+    updateTxClient();
   }
   else
   {
     MsgAuthChallenge *auth_msg = new MsgAuthChallenge;
-    memcpy(auth_challenge, auth_msg->challenge(),
+    memcpy(client->auth_challenge, auth_msg->challenge(),
            MsgAuthChallenge::CHALLENGE_LEN);
-    sendMsg(auth_msg);
+    sendMsg(client, auth_msg);
   }
 } /* NetUplink::handleIncomingConnection */
 
@@ -322,36 +536,61 @@ void NetUplink::clientConnected(TcpConnection *incoming_con)
             << incoming_con->remoteHost() << ":"
             << incoming_con->remotePort() << std::endl;
 
-  switch (state)
+    // Clients being cleaned up are counted so that we never have more than
+    // max_clients client objects
+  if (clients.size() >= max_clients)
   {
-    case STATE_DISC:
-      handleIncomingConnection(incoming_con);
-      break;
-    case STATE_CON_SETUP:
-    case STATE_READY:
+    if (max_clients == 1)
+    {
       std::cout << name << ": Only one client allowed. Disconnecting..."
                 << std::endl;
-      // Fall through
-    case STATE_DISC_CLEANUP:
-      incoming_con->disconnect();
-      break;
+    }
+    else
+    {
+      std::cout << name << ": Only " << max_clients
+                << " clients allowed. Disconnecting..." << std::endl;
+    }
+    incoming_con->disconnect();
+    return;
   }
+
+  handleIncomingConnection(incoming_con);
 } /* NetUplink::clientConnected */
 
 
-void NetUplink::disconnectCleanup(void)
+void NetUplink::disconnectCleanup(Client *client)
 {
-  con = 0;
-  recv_exp = 0;
-  setState(STATE_DISC);
+  clients.erase(find(clients.begin(), clients.end(), client));
 
-  rx->reset();
-  tx->enableCtcss(false);
-  fifo->clear();
-  if (audio_dec != 0)
+  if (client == udp_client)
+  {
+    udp_chan->close();
+    udp_client = 0;
+  }
+  releaseRxEncoder(client);
+  if (client->audio_dec != 0)
   {
-    audio_dec->flushEncodedSamples();
+    dec_selector->removeSource(client->audio_dec);
+    AudioCodecPool::instance().release(client->audio_dec);
   }
+  if (client == tx_client)
+  {
+    tx_client = 0;
+    cancelTxLaunch();
+    fifo->clear();
+  }
+  delete client;
+
+  if (!clients.empty())
+  {
+    updateRxMuteState();
+    updateTxClient();
+    return;
+  }
+
+  resetRx();
+  tx->enableCtcss(false);
+  fifo->clear();
   tx->setTxCtrlMode(Tx::TX_OFF);
   heartbeat_timer->setEnable(false);
 
@@ -361,8 +600,7 @@ void NetUplink::disconnectCleanup(void)
   }
 
   tx_muted = false;
-  tx_ctrl_mode = Tx::TX_OFF;
-    
+
   if (fallback_enabled)
   {
     setFallbackActive(true);
@@ -377,150 +615,188 @@ void NetUplink::disconnectCleanup(void)
 void NetUplink::clientDisconnected(TcpConnection *the_con,
                                    TcpConnection::DisconnectReason reason)
 {
+  ClientList::iterator it = clients.begin();
+  while ((it != clients.end()) && ((*it)->con != the_con))
+  {
+    ++it;
+  }
+  if (it == clients.end())
+  {
+    return;
+  }
+  Client *client = *it;
+
   std::cout << "NOTICE[" << name << "]: Client disconnected: "
             << the_con->remoteHost() << ":"
             << the_con->remotePort() << ": "
             << TcpConnection::disconnectReasonStr(reason)
             << std::endl;
 
-  con = 0;
-  setState(STATE_DISC_CLEANUP);
-  Application::app().runTask(mem_fun(*this, &NetUplink::disconnectCleanup));
+  client->con = 0;
+  client->state = STATE_DISC_CLEANUP;
+  Application::app().runTask(
+      sigc::bind(mem_fun(*this, &NetUplink::disconnectCleanup), client));
 } /* NetUplink::clientDisconnected */
 
 
-int NetUplink::tcpDataReceived(TcpConnection *con, void *data, int size)
+int NetUplink::tcpDataReceived(TcpConnection *con, void *data, int size,
+                               Client *client)
 {
   //cout << "NetRx::tcpDataReceived: size=" << size << endl;
-  
+
   //Msg *msg = reinterpret_cast<Msg*>(data);
   //cout << "Received a TCP message with type " << msg->type()
   //     << " and size " << msg->size() << endl;
-  
+
     // Discard data if we are not in one of the "connected" states
-  if ((state != STATE_CON_SETUP) && (state != STATE_READY))
+  if ((client->state != STATE_CON_SETUP) && (client->state != STATE_READY))
   {
     return size;
   }
 
-  if (recv_exp == 0)
+  if (client->recv_exp == 0)
   {
     std::cerr << "*** ERROR: Unexpected TCP data received in NetUplink "
               << name << ". Throwing it away..." << std::endl;
     return size;
   }
-  
+
   int orig_size = size;
-  
+
   char *buf = static_cast<char*>(data);
-  while (size > 0)
+  while ((size > 0) && (client->state != STATE_DISC_CLEANUP))
   {
-    unsigned read_cnt = min(static_cast<unsigned>(size), recv_exp-recv_cnt);
-    if (recv_cnt+read_cnt > sizeof(recv_buf))
+    unsigned read_cnt = min(static_cast<unsigned>(size),
+                            client->recv_exp-client->recv_cnt);
+    if (client->recv_cnt+read_cnt > sizeof(client->recv_buf))
     {
       std::cerr << "*** ERROR: TCP receive buffer overflow in NetUplink "
                 << name << ". Disconnecting..." << std::endl;
-      forceDisconnect();
+      forceDisconnect(client);
       return orig_size;
     }
-    memcpy(recv_buf+recv_cnt, buf, read_cnt);
+    memcpy(client->recv_buf+client->recv_cnt, buf, read_cnt);
     size -= read_cnt;
-    recv_cnt += read_cnt;
+    client->recv_cnt += read_cnt;
     buf += read_cnt;
-    
-    if (recv_cnt == recv_exp)
+
+    if (client->recv_cnt == client->recv_exp)
     {
-      if (recv_exp == sizeof(Msg))
+      if (client->recv_exp == sizeof(Msg))
       {
-      	Msg *msg = reinterpret_cast<Msg*>(recv_buf);
+      	Msg *msg = reinterpret_cast<Msg*>(client->recv_buf);
 	if (msg->size() == sizeof(Msg))
 	{
-	  handleMsg(msg);
-	  recv_cnt = 0;
-	  recv_exp = sizeof(Msg);
+	  handleMsg(client, msg);
+	  client->recv_cnt = 0;
+	  client->recv_exp = sizeof(Msg);
 	}
 	else if (msg->size() > sizeof(Msg))
 	{
-      	  recv_exp = msg->size();
+      	  client->recv_exp = msg->size();
 	}
 	else
 	{
           std::cerr << "*** ERROR: Illegal message header received in "
                     << "NetUplink " << name << ". Header length too small ("
                     << msg->size() << ")" << std::endl;
-          forceDisconnect();
+          forceDisconnect(client);
 	  return orig_size;
 	}
       }
       else
       {
-      	Msg *msg = reinterpret_cast<Msg*>(recv_buf);
-      	handleMsg(msg);
-	recv_cnt = 0;
-	recv_exp = sizeof(Msg);
+      	Msg *msg = reinterpret_cast<Msg*>(client->recv_buf);
+      	handleMsg(client, msg);
+	client->recv_cnt = 0;
+	client->recv_exp = sizeof(Msg);
       }
     }
   }
-  
+
   return orig_size;
-  
+
 } /* NetUplink::tcpDataReceived */
 
 
-void NetUplink::handleMsg(Msg *msg)
+void NetUplink::handleMsg(Client *client, Msg *msg)
 {
-  switch (state)
+  switch (client->state)
   {
     case STATE_DISC:
     case STATE_DISC_CLEANUP:
       return;
-      
+
     case STATE_CON_SETUP:
       if (msg->type() == MsgAuthResponse::TYPE &&
           msg->size() == sizeof(MsgAuthResponse))
       {
         MsgAuthResponse *resp_msg = reinterpret_cast<MsgAuthResponse *>(msg);
-        if (!resp_msg->verify(auth_key, auth_challenge))
+        if (!resp_msg->verify(auth_key, client->auth_challenge))
         {
           std::cerr << "*** ERROR: Authentication error in NetUplink "
                     << name << "." << std::endl;
-          forceDisconnect();
+          forceDisconnect(client);
           return;
         }
         else
         {
           MsgAuthOk *ok_msg = new MsgAuthOk;
-          sendMsg(ok_msg);
+          sendMsg(client, ok_msg);
         }
-        setState(STATE_READY);
+        client->state = STATE_READY;
+        updateTxClient();
       }
       else
       {
         std::cerr << "*** ERROR: Protocol error in NetUplink " << name << "."
                   << std::endl;
-        forceDisconnect();
+        forceDisconnect(client);
       }
       return;
-    
+
     case STATE_READY:
       break;
   }
-  
-  gettimeofday(&last_msg_timestamp, NULL);
-  
+
+  gettimeofday(&client->last_msg_timestamp, NULL);
+
   switch (msg->type())
   {
     case MsgHeartbeat::TYPE:
     {
+      if (msg->size() >= sizeof(MsgHeartbeat))
+      {
+        MsgHeartbeat *hb_msg = reinterpret_cast<MsgHeartbeat*>(msg);
+        client->peer_hb_timestamp = hb_msg->timestamp();
+        client->peer_hb_rx_timestamp = client->last_msg_timestamp;
+      }
       break;
     }
-    
+
+    case MsgUdpSetupRequest::TYPE:
+    {
+      handleUdpSetupRequest(client);
+      break;
+    }
+
     case MsgReset::TYPE:
     {
-      rx->reset();
+        // With more than one client connected, only the state requested by
+        // this client is reset. Tone detectors added by it are left in the
+        // receiver since other clients may use them.
+      client->mute_state = Rx::MUTE_ALL;
+      if (clients.size() == 1)
+      {
+        resetRx();
+      }
+      else
+      {
+        updateRxMuteState();
+      }
       break;
     }
-    
+
     case MsgSetRxFq::TYPE:
     {
       MsgSetRxFq *fq_msg = reinterpret_cast<MsgSetRxFq*>(msg);
@@ -546,146 +822,107 @@ void NetUplink::handleMsg(Msg *msg)
       std::cout << rx->name() << ": SetMuteState("
                 << Rx::muteStateToString(mute_msg->muteState())
                 << ")" << std::endl;
-      rx->setMuteState(mute_msg->muteState());
+      client->mute_state = mute_msg->muteState();
+      updateRxMuteState();
       break;
     }
-    
+
     case MsgAddToneDetector::TYPE:
     {
       MsgAddToneDetector *atd = reinterpret_cast<MsgAddToneDetector*>(msg);
       std::cout << rx->name() << ": AddToneDetector(" << atd->fq()
                 << ", " << atd->bw()
                 << ", " << atd->requiredDuration() << ")" << std::endl;
-      rx->addToneDetector(atd->fq(), atd->bw(), atd->thresh(),
-      	      	      	  atd->requiredDuration());
+        // Clients using the same receiver normally request the same tone
+        // detectors so only add a detector that is not already there
+      ToneDet det = { atd->fq(), atd->bw(), atd->thresh(),
+                      atd->requiredDuration() };
+      if (find(rx_tone_dets.begin(), rx_tone_dets.end(), det) ==
+          rx_tone_dets.end())
+      {
+        rx->addToneDetector(atd->fq(), atd->bw(), atd->thresh(),
+                            atd->requiredDuration());
+        rx_tone_dets.push_back(det);
+      }
       break;
     }
-    
+
     case MsgSetTxCtrlMode::TYPE:
     {
       MsgSetTxCtrlMode *mode_msg = reinterpret_cast<MsgSetTxCtrlMode *>(msg);
-      tx_ctrl_mode = mode_msg->mode();
-      if (!tx_muted)
-      {
-	tx->setTxCtrlMode(tx_ctrl_mode);
-      }
+      client->tx_ctrl_mode = mode_msg->mode();
+      updateTxClient();
       break;
     }
-     
+
     case MsgEnableCtcss::TYPE:
     {
       MsgEnableCtcss *ctcss_msg = reinterpret_cast<MsgEnableCtcss *>(msg);
-      tx->enableCtcss(ctcss_msg->enable());
+      client->ctcss_enabled = ctcss_msg->enable();
+      if (client == tx_client)
+      {
+        tx->enableCtcss(client->ctcss_enabled);
+      }
       break;
     }
-     
+
     case MsgSendDtmf::TYPE:
     {
-      MsgSendDtmf *dtmf_msg = reinterpret_cast<MsgSendDtmf *>(msg);
-      tx->sendDtmf(dtmf_msg->digits(), dtmf_msg->duration());
+      if (client == tx_client)
+      {
+        MsgSendDtmf *dtmf_msg = reinterpret_cast<MsgSendDtmf *>(msg);
+        tx->sendDtmf(dtmf_msg->digits(), dtmf_msg->duration());
+      }
       break;
     }
-    
+
     case MsgRxAudioCodecSelect::TYPE:
     {
-      MsgRxAudioCodecSelect *codec_msg = 
-          reinterpret_cast<MsgRxAudioCodecSelect *>(msg);
-      if (audio_enc != 0)
-      {
-	rx_splitter->removeSink(audio_enc);
-	delete audio_enc;
-      }
-      audio_enc = AudioEncoder::create(codec_msg->name());
-      if (audio_enc != 0)
-      {
-        audio_enc->writeEncodedSamples.connect(
-                mem_fun(*this, &NetUplink::writeEncodedSamples));
-        audio_enc->flushEncodedSamples.connect(
-                mem_fun(*audio_enc, &AudioEncoder::allEncodedSamplesFlushed));
-        //audio_enc->registerSource(rx);
-	rx_splitter->addSink(audio_enc);
-        std::cout << name << ": Using CODEC \"" << audio_enc->name()
-                  << "\" to encode RX audio" << std::endl;
-	
-	MsgRxAudioCodecSelect::Opts opts;
-	codec_msg->options(opts);
-	MsgRxAudioCodecSelect::Opts::const_iterator it;
-	for (it=opts.begin(); it!=opts.end(); ++it)
-	{
-	  audio_enc->setOption((*it).first, (*it).second);
-	}
-	audio_enc->printCodecParams();
-      }
-      else
-      {
-        std::cerr << "*** ERROR: Received request for unknown RX audio codec ("
-                  << codec_msg->name() << ") in NetUplink " << name
-                  << std::endl;
-      }
+      selectRxAudioCodec(client,
+                         reinterpret_cast<MsgRxAudioCodecSelect *>(msg));
       break;
     }
-    
+
     case MsgTxAudioCodecSelect::TYPE:
     {
-      MsgTxAudioCodecSelect *codec_msg = 
-          reinterpret_cast<MsgTxAudioCodecSelect *>(msg);
-      delete audio_dec;
-      audio_dec = AudioDecoder::create(codec_msg->name());
-      if (audio_dec != 0)
-      {
-        audio_dec->registerSink(fifo);
-        audio_dec->allEncodedSamplesFlushed.connect(
-            mem_fun(*this, &NetUplink::allEncodedSamplesFlushed));
-        std::cout << name << ": Using CODEC \"" << audio_dec->name()
-                  << "\" to decode TX audio" << std::endl;
-	
-	MsgRxAudioCodecSelect::Opts opts;
-	codec_msg->options(opts);
-	MsgTxAudioCodecSelect::Opts::const_iterator it;
-	for (it=opts.begin(); it!=opts.end(); ++it)
-	{
-	  audio_dec->setOption((*it).first, (*it).second);
-	}
-	audio_dec->printCodecParams();
-      }
-      else
-      {
-        std::cerr << "*** ERROR: Received request for unknown TX audio codec ("
-                  << codec_msg->name() << ") in NetUplink " << name
-                  << std::endl;
-      }
+      selectTxAudioCodec(client,
+                         reinterpret_cast<MsgTxAudioCodecSelect *>(msg));
       break;
     }
-    
+
     case MsgAudio::TYPE:
     {
       //cout << "NetUplink [MsgAudio]\n";
-      if (!tx_muted && (audio_dec != 0))
-      {
-        MsgAudio *audio_msg = reinterpret_cast<MsgAudio*>(msg);
-        audio_dec->writeEncodedSamples(audio_msg->buf(), audio_msg->size());
-      }
+      MsgAudio *audio_msg = reinterpret_cast<MsgAudio*>(msg);
+      writeTxAudio(client, audio_msg->buf(), audio_msg->size());
       break;
     }
-    
+
     case MsgFlush::TYPE:
     {
-      if (audio_dec != 0)
-      {
-        audio_dec->flushEncodedSamples();
-      }
+      flushTxAudio(client);
       break;
-    } 
+    }
+
+    case MsgTxLaunchTime::TYPE:
+    {
+      MsgTxLaunchTime *launch_msg = reinterpret_cast<MsgTxLaunchTime*>(msg);
+      scheduleTxLaunch(client, launch_msg->launchTime());
+      break;
+    }
 
     case MsgTransmittedSignalStrength::TYPE:
     {
-      MsgTransmittedSignalStrength *siglev_msg =
-        reinterpret_cast<MsgTransmittedSignalStrength *>(msg);
-      tx->setTransmittedSignalStrength(siglev_msg->sqlRxId(),
-                                       siglev_msg->signalStrength());
+      if (client == tx_client)
+      {
+        MsgTransmittedSignalStrength *siglev_msg =
+          reinterpret_cast<MsgTransmittedSignalStrength *>(msg);
+        tx->setTransmittedSignalStrength(siglev_msg->sqlRxId(),
+                                         siglev_msg->signalStrength());
+      }
       break;
     }
-    
+
     case MsgSetTxFq::TYPE:
     {
       MsgSetTxFq *fq_msg = reinterpret_cast<MsgSetTxFq*>(msg);
@@ -711,34 +948,51 @@ void NetUplink::handleMsg(Msg *msg)
            << msg->size() << endl;
       break;
   }
-  
+
 } /* NetUplink::handleMsg */
 
 
-void NetUplink::sendMsg(Msg *msg)
+void NetUplink::writeMsg(Client *client, const Msg *msg)
 {
-  if ((state == STATE_CON_SETUP) || (state == STATE_READY))
+  if ((client->state == STATE_CON_SETUP) || (client->state == STATE_READY))
   {
-    int written = con->write(msg, msg->size());
+    int written = client->con->write(msg, msg->size());
     if (written == -1)
     {
       std::cerr << "*** ERROR: TCP transmit error in NetUplink \"" << name
                 << "\": " << strerror(errno) << "." << std::endl;
-      forceDisconnect();
+      forceDisconnect(client);
     }
     else if (written != static_cast<int>(msg->size()))
     {
       std::cerr << "*** ERROR: TCP transmit buffer overflow in NetUplink "
                 << name << "." << std::endl;
-      forceDisconnect();
+      forceDisconnect(client);
     }
   }
-  
+} /* NetUplink::writeMsg */
+
+
+void NetUplink::sendMsg(Client *client, Msg *msg)
+{
+  writeMsg(client, msg);
   delete msg;
-  
 } /* NetUplink::sendMsg */
 
 
+void NetUplink::broadcastMsg(Msg *msg)
+{
+  for (ClientList::iterator it=clients.begin(); it!=clients.end(); ++it)
+  {
+    if ((*it)->state == STATE_READY)
+    {
+      writeMsg(*it, msg);
+    }
+  }
+  delete msg;
+} /* NetUplink::broadcastMsg */
+
+
 void NetUplink::squelchOpen(bool is_open)
 {
   if (mute_tx_timer != 0)
@@ -755,8 +1009,9 @@ void NetUplink::squelchOpen(bool is_open)
   }
 
   MsgSquelch *msg = new MsgSquelch(is_open, rx->signalStrength(),
-                                   rx->sqlRxId(), rx->squelchActivityInfo());
-  sendMsg(msg);
+                                   rx->sqlRxId(), rx->squelchActivityInfo(),
+                                   Msg::currentTimestamp());
+  broadcastMsg(msg);
 } /* NetUplink::squelchOpen */
 
 
@@ -765,7 +1020,7 @@ void NetUplink::dtmfDigitDetected(char digit, int duration)
   cout << name << ": DTMF digit detected: " << digit << " with duration " << duration
        << " milliseconds" << endl;
   MsgDtmf *msg = new MsgDtmf(digit, duration);
-  sendMsg(msg);
+  broadcastMsg(msg);
 } /* NetUplink::dtmfDigitDetected */
 
 
@@ -773,19 +1028,136 @@ void NetUplink::toneDetected(float tone_fq)
 {
   cout << name << ": Tone detected: " << tone_fq << endl;
   MsgTone *msg = new MsgTone(tone_fq);
-  sendMsg(msg);
+  broadcastMsg(msg);
 } /* NetUplink::toneDetected */
 
 
-void NetUplink::selcallSequenceDetected(std::string sequence)
+void NetUplink::selcallSequenceDetected(const std::string& sequence)
 {
   // cout "Sel5 sequence detected: " << sequence << endl;
   MsgSel5 *msg = new MsgSel5(sequence);
-  sendMsg(msg);
+  broadcastMsg(msg);
 } /* NetUplink::selcallSequenceDetected */
 
 
-void NetUplink::writeEncodedSamples(const void *buf, int size)
+void NetUplink::selectRxAudioCodec(Client *client,
+                                   MsgRxAudioCodecSelect *codec_msg)
+{
+  releaseRxEncoder(client);
+
+    // Clients asking for the same codec with the same options share one
+    // encoder so that the audio is only encoded once
+  MsgRxAudioCodecSelect::Opts opts;
+  codec_msg->options(opts);
+  string key(codec_msg->name());
+  MsgRxAudioCodecSelect::Opts::const_iterator it;
+  for (it=opts.begin(); it!=opts.end(); ++it)
+  {
+    key += ";" + (*it).first + "=" + (*it).second;
+  }
+
+  RxEncoderMap::iterator enc_it = rx_encoders.find(key);
+  if (enc_it != rx_encoders.end())
+  {
+    client->rx_enc = enc_it->second;
+    client->rx_enc->users += 1;
+    std::cout << name << ": Sharing CODEC \"" << client->rx_enc->enc->name()
+              << "\" to encode RX audio" << std::endl;
+    return;
+  }
+
+  AudioEncoder *audio_enc =
+      AudioCodecPool::instance().createEncoder(codec_msg->name());
+  if (audio_enc == 0)
+  {
+    std::cerr << "*** ERROR: Received request for unknown RX audio codec ("
+              << codec_msg->name() << ") in NetUplink " << name
+              << std::endl;
+    return;
+  }
+
+  RxEncoder *rx_enc = new RxEncoder;
+  rx_enc->key = key;
+  rx_enc->enc = audio_enc;
+  rx_enc->users = 1;
+  rx_encoders[key] = rx_enc;
+  client->rx_enc = rx_enc;
+
+  audio_enc->writeEncodedSamples.connect(
+          sigc::bind(mem_fun(*this, &NetUplink::writeEncodedSamples), rx_enc));
+  audio_enc->flushEncodedSamples.connect(
+          sigc::bind(mem_fun(*this, &NetUplink::flushEncodedSamples), rx_enc));
+  //audio_enc->registerSource(rx);
+  rx_splitter->addSink(audio_enc);
+  std::cout << name << ": Using CODEC \"" << audio_enc->name()
+            << "\" to encode RX audio" << std::endl;
+
+  for (it=opts.begin(); it!=opts.end(); ++it)
+  {
+    audio_enc->setOption((*it).first, (*it).second);
+  }
+  audio_enc->printCodecParams();
+} /* NetUplink::selectRxAudioCodec */
+
+
+void NetUplink::releaseRxEncoder(Client *client)
+{
+  RxEncoder *rx_enc = client->rx_enc;
+  client->rx_enc = 0;
+  if ((rx_enc == 0) || (--rx_enc->users > 0))
+  {
+    return;
+  }
+  rx_encoders.erase(rx_enc->key);
+  rx_splitter->removeSink(rx_enc->enc);
+  AudioCodecPool::instance().release(rx_enc->enc);
+  delete rx_enc;
+} /* NetUplink::releaseRxEncoder */
+
+
+void NetUplink::selectTxAudioCodec(Client *client,
+                                   MsgTxAudioCodecSelect *codec_msg)
+{
+  if (client->audio_dec != 0)
+  {
+    dec_selector->removeSource(client->audio_dec);
+    AudioCodecPool::instance().release(client->audio_dec);
+  }
+  client->audio_dec =
+      AudioCodecPool::instance().createDecoder(codec_msg->name());
+  if (client->audio_dec != 0)
+  {
+    dec_selector->addSource(client->audio_dec);
+    if (client == tx_client)
+    {
+      dec_selector->selectSource(client->audio_dec);
+    }
+    client->audio_dec->allEncodedSamplesFlushed.connect(
+        sigc::bind(mem_fun(*this, &NetUplink::allEncodedSamplesFlushed),
+                   client));
+    std::cout << name << ": Using CODEC \"" << client->audio_dec->name()
+              << "\" to decode TX audio" << std::endl;
+
+    MsgRxAudioCodecSelect::Opts opts;
+    codec_msg->options(opts);
+    MsgTxAudioCodecSelect::Opts::const_iterator it;
+    for (it=opts.begin(); it!=opts.end(); ++it)
+    {
+      client->audio_dec->setOption((*it).first, (*it).second);
+    }
+    client->audio_dec->printCodecParams();
+  }
+  else
+  {
+    std::cerr << "*** ERROR: Received request for unknown TX audio codec ("
+              << codec_msg->name() << ") in NetUplink " << name
+              << std::endl;
+  }
+} /* NetUplink::selectTxAudioCodec */
+
+
+void NetUplink::writeEncodedSamples(const void *buf, int size,
+                                    RxEncoder *rx_enc)
 {
   //cout << "NetUplink::writeEncodedSamples: size=" << size << endl;
   const char *ptr = reinterpret_cast<const char *>(buf);
@@ -793,18 +1165,48 @@ void NetUplink::writeEncodedSamples(const void *buf, int size)
   {
     const int bufsize = MsgAudio::BUFSIZE;
     int len = min(size, bufsize);
-    MsgAudio *msg = new MsgAudio(ptr, len);
-    sendMsg(msg);
+    MsgAudio *msg = 0;
+    for (ClientList::iterator it=clients.begin(); it!=clients.end(); ++it)
+    {
+      Client *client = *it;
+      if ((client->rx_enc != rx_enc) || (client->state != STATE_READY))
+      {
+        continue;
+      }
+      if ((client == udp_client) && udp_chan->sendAudio(ptr, len))
+      {
+        continue;
+      }
+      if (msg == 0)
+      {
+        msg = new MsgAudio(ptr, len, Msg::currentTimestamp());
+      }
+      writeMsg(client, msg);
+    }
+    delete msg;
     size -= len;
     ptr += len;
   }
 } /* NetUplink::writeEncodedSamples */
 
 
+void NetUplink::flushEncodedSamples(RxEncoder *rx_enc)
+{
+    // There is no flush message for RX audio on TCP. The squelch close
+    // message is used instead. On UDP, the flush mark the end of the stream
+    // so that the squelch close is not handled before the last audio packet.
+  if ((udp_client != 0) && (udp_client->rx_enc == rx_enc))
+  {
+    udp_chan->sendFlush();
+  }
+  rx_enc->enc->allEncodedSamplesFlushed();
+} /* NetUplink::flushEncodedSamples */
+
+
 void NetUplink::txTimeout(void)
 {
   MsgTxTimeout *msg = new MsgTxTimeout;
-  sendMsg(msg);
+  broadcastMsg(msg);
 } /* NetUplink::txTimeout */
 
 
@@ -812,37 +1214,206 @@ void NetUplink::transmitterStateChange(bool is_transmitting)
 {
   MsgTransmitterStateChange *msg =
       new MsgTransmitterStateChange(is_transmitting);
-  sendMsg(msg);
+  broadcastMsg(msg);
 } /* NetUplink::transmitterStateChange */
 
 
-void NetUplink::allEncodedSamplesFlushed(void)
+void NetUplink::allEncodedSamplesFlushed(Client *client)
 {
   MsgAllSamplesFlushed *msg = new MsgAllSamplesFlushed;
-  sendMsg(msg);
+  sendMsg(client, msg);
 } /* NetUplink::allEncodedSamplesFlushed */
 
 
+void NetUplink::writeTxAudio(Client *client, const void *buf, int size)
+{
+    // Audio from clients not controlling the transmitter is thrown away
+  if (!tx_muted && (client == tx_client) && (client->audio_dec != 0))
+  {
+    client->audio_dec->writeEncodedSamples(const_cast<void*>(buf), size);
+  }
+} /* NetUplink::writeTxAudio */
+
+
+void NetUplink::flushTxAudio(Client *client)
+{
+  if (client->audio_dec == 0)
+  {
+    return;
+  }
+  if (client == tx_client)
+  {
+    client->audio_dec->flushEncodedSamples();
+  }
+  else
+  {
+    allEncodedSamplesFlushed(client);
+  }
+} /* NetUplink::flushTxAudio */
+
+
+void NetUplink::scheduleTxLaunch(Client *client, uint64_t launch_time)
+{
+  if ((client != tx_client) || tx_muted)
+  {
+    return;
+  }
+
+    // The launch time only apply to a stream that has not started yet. If
+    // the audio has started to play already it is too late to hold it back.
+  if (!launch_gate->isIdle() && !launch_gate->isHeld())
+  {
+    std::cerr << "*** WARNING[" << name << "]: TX launch time received "
+                 "after the audio stream started" << std::endl;
+    return;
+  }
+
+  int64_t delay_us =
+      static_cast<int64_t>(launch_time - Msg::currentTimestamp());
+  if (delay_us <= 0)
+  {
+    std::cerr << "*** WARNING[" << name << "]: TX launch time passed "
+              << (-delay_us / 1000) << "ms ago. The network delay is larger "
+                 "than the configured simulcast delay or the clocks are not "
+                 "synchronized." << std::endl;
+    txLaunch(launch_timer);
+    return;
+  }
+  if (delay_us > 1000 * static_cast<int64_t>(MsgTxLaunchTime::MAX_DELAY))
+  {
+    std::cerr << "*** WARNING[" << name << "]: TX launch time is "
+              << (delay_us / 1000) << "ms into the future. Check that the "
+                 "clocks are synchronized." << std::endl;
+    txLaunch(launch_timer);
+    return;
+  }
+
+  launch_gate->hold();
+  launch_timer->setTimeout((delay_us + 500) / 1000);
+  launch_timer->setEnable(true);
+} /* NetUplink::scheduleTxLaunch */
+
+
+void NetUplink::txLaunch(Timer *t)
+{
+  launch_timer->setEnable(false);
+  launch_gate->release();
+} /* NetUplink::txLaunch */
+
+
+void NetUplink::cancelTxLaunch(void)
+{
+  launch_timer->setEnable(false);
+  launch_gate->reset();
+} /* NetUplink::cancelTxLaunch */
+
+
+void NetUplink::handleUdpSetupRequest(Client *client)
+{
+    // There is only one UDP channel. If it is already used by another
+    // client this client will use TCP for the audio.
+  if ((udp_chan == 0) || ((udp_client != 0) && (udp_client != client)))
+  {
+    sendMsg(client, new MsgUdpSetup);
+    return;
+  }
+
+  uint32_t session_id = 0;
+  while (session_id == 0)
+  {
+    gcry_create_nonce(&session_id, sizeof(session_id));
+  }
+  const unsigned char *challenge =
+      auth_key.empty() ? 0 : client->auth_challenge;
+  MsgUdpSetup *setup_msg = new MsgUdpSetup(udp_port, session_id,
+                                           !auth_key.empty());
+  udp_client = client;
+  if (!udp_chan->open(*setup_msg, auth_key, challenge))
+  {
+    std::cerr << "*** ERROR: Could not set up the UDP audio channel in "
+                 "NetUplink " << name << std::endl;
+    delete setup_msg;
+    setup_msg = new MsgUdpSetup;
+    udp_client = 0;
+  }
+  sendMsg(client, setup_msg);
+} /* NetUplink::handleUdpSetupRequest */
+
+
+void NetUplink::udpUpStateChanged(bool is_up)
+{
+  if (is_up)
+  {
+    std::cout << name << ": UDP audio channel up"
+              << (udp_chan->isEncrypted() ? " (encrypted)" : "")
+              << std::endl;
+  }
+  else
+  {
+    const NetTrxUdpChannel::Stats& stats = udp_chan->statistics();
+    std::cout << name << ": UDP audio channel down. Using TCP for audio. "
+              << "Received=" << stats.received_packets
+              << " lost=" << stats.lost_packets
+              << " late=" << stats.late_packets << std::endl;
+  }
+} /* NetUplink::udpUpStateChanged */
+
+
+void NetUplink::udpAudioReceived(const void *buf, int size)
+{
+  if ((udp_client != 0) && (udp_client->state == STATE_READY))
+  {
+    writeTxAudio(udp_client, buf, size);
+  }
+} /* NetUplink::udpAudioReceived */
+
+
+void NetUplink::udpFlushReceived(void)
+{
+  if ((udp_client != 0) && (udp_client->state == STATE_READY))
+  {
+    flushTxAudio(udp_client);
+  }
+} /* NetUplink::udpFlushReceived */
+
+
 void NetUplink::heartbeat(Timer *t)
 {
-  MsgHeartbeat *msg = new MsgHeartbeat;
-  sendMsg(msg);
-  
-  struct timeval diff_tv;
   struct timeval now;
   gettimeofday(&now, NULL);
-  timersub(&now, &last_msg_timestamp, &diff_tv);
-  int diff_ms = diff_tv.tv_sec * 1000 + diff_tv.tv_usec / 1000;
-  
-  if (diff_ms > 15000)
+
+  for (ClientList::iterator it=clients.begin(); it!=clients.end(); ++it)
   {
-    std::cerr << "*** ERROR: Heartbeat timeout in NetUplink " << name
-              << std::endl;
-    forceDisconnect();
+    Client *client = *it;
+    uint32_t echo_delay = 0;
+    if (client->peer_hb_timestamp != 0)
+    {
+      struct timeval diff_tv;
+      timersub(&now, &client->peer_hb_rx_timestamp, &diff_tv);
+      echo_delay = diff_tv.tv_sec * 1000000 + diff_tv.tv_usec;
+    }
+    MsgHeartbeat *msg = new MsgHeartbeat(client->peer_hb_timestamp,
+                                         echo_delay);
+    sendMsg(client, msg);
+    if ((client->state != STATE_CON_SETUP) && (client->state != STATE_READY))
+    {
+      continue;
+    }
+
+    struct timeval diff_tv;
+    timersub(&now, &client->last_msg_timestamp, &diff_tv);
+    int diff_ms = diff_tv.tv_sec * 1000 + diff_tv.tv_usec / 1000;
+
+    if (diff_ms > 15000)
+    {
+      std::cerr << "*** ERROR: Heartbeat timeout in NetUplink " << name
+                << std::endl;
+      forceDisconnect(client);
+    }
   }
-  
+
   t->reset();
-  
+
 } /* NetTrxTcpClient::heartbeat */
 
 
@@ -858,13 +1429,13 @@ void NetUplink::unmuteTx(Timer *t)
 {
   mute_tx_timer->setEnable(false);
   tx_muted = false;
-  tx->setTxCtrlMode(tx_ctrl_mode);
+  tx->setTxCtrlMode(txCtrlMode());
 } /* NetUplink::unmuteTx */
 
 
 void NetUplink::setFallbackActive(bool activate)
 {
-  rx->reset();
+  resetRx();
   if (activate)
   {
     std::cout << name << ": Activating fallback repeater mode" << std::endl;
@@ -884,18 +1455,126 @@ void NetUplink::setFallbackActive(bool activate)
 void NetUplink::signalLevelUpdated(float siglev)
 {
   MsgSiglevUpdate *msg = new MsgSiglevUpdate(rx->signalStrength(),
-					     rx->sqlRxId());
-  sendMsg(msg);  
+					     rx->sqlRxId(),
+                                             Msg::currentTimestamp());
+  broadcastMsg(msg);
 } /* NetUplink::signalLevelUpdated */
 
 
-void NetUplink::forceDisconnect(void)
+void NetUplink::forceDisconnect(Client *client)
 {
+  TcpConnection *con = client->con;
   con->disconnect();
   clientDisconnected(con, TcpConnection::DR_ORDERED_DISCONNECT);
 } /* NetUplink::forceDisconnect */
 
 
+void NetUplink::resetRx(void)
+{
+  rx->reset();
+  rx_tone_dets.clear();
+} /* NetUplink::resetRx */
+
+
+void NetUplink::updateRxMuteState(void)
+{
+    // The receiver is muted as little as any of the clients want
+  Rx::MuteState mute_state = Rx::MUTE_ALL;
+  for (ClientList::iterator it=clients.begin(); it!=clients.end(); ++it)
+  {
+    if (((*it)->state == STATE_READY) && ((*it)->mute_state < mute_state))
+    {
+      mute_state = (*it)->mute_state;
+    }
+  }
+  rx->setMuteState(mute_state);
+} /* NetUplink::updateRxMuteState */
+
+
+void NetUplink::updateTxClient(void)
+{
+    // The transmitter is given to the client with the highest priority
+    // that want to transmit. If no client want to transmit, it is given to
+    // the client with the highest priority so that it can set up the
+    // transmitter, e.g. enable CTCSS, before it start transmitting.
+  Client *best = 0;
+  for (ClientList::iterator it=clients.begin(); it!=clients.end(); ++it)
+  {
+    Client *client = *it;
+    if (client->state != STATE_READY)
+    {
+      continue;
+    }
+    if (best == 0)
+    {
+      best = client;
+      continue;
+    }
+    const bool client_tx = (client->tx_ctrl_mode != Tx::TX_OFF);
+    const bool best_tx = (best->tx_ctrl_mode != Tx::TX_OFF);
+    if ((client_tx && !best_tx) ||
+        ((client_tx == best_tx) &&
+         ((client->prio > best->prio) ||
+          ((client->prio == best->prio) && (client->seq < best->seq)))))
+    {
+      best = client;
+    }
+  }
+
+  if (best != tx_client)
+  {
+    if (tx_client != 0)
+    {
+      cancelTxLaunch();
+      fifo->clear();
+    }
+    tx_client = best;
+    if ((tx_client != 0) && (tx_client->audio_dec != 0))
+    {
+      dec_selector->selectSource(tx_client->audio_dec);
+    }
+    else
+    {
+      dec_selector->selectSource(0);
+    }
+    tx->enableCtcss((tx_client != 0) && tx_client->ctcss_enabled);
+    if ((tx_client != 0) && (clients.size() > 1))
+    {
+      std::cout << name << ": Transmitter controlled by "
+                << tx_client->con->remoteHost() << ":"
+                << tx_client->con->remotePort() << std::endl;
+    }
+  }
+
+  if (!tx_muted)
+  {
+    tx->setTxCtrlMode(txCtrlMode());
+  }
+} /* NetUplink::updateTxClient */
+
+
+Tx::TxCtrlMode NetUplink::txCtrlMode(void) const
+{
+  return (tx_client != 0) ? tx_client->tx_ctrl_mode : Tx::TX_OFF;
+} /* NetUplink::txCtrlMode */
+
+
+unsigned NetUplink::clientPrio(const TcpConnection *con) const
+{
+    // The first host in the CLIENT_PRIORITY list get the highest priority.
+    // Hosts not in the list get the lowest priority.
+  const string host = con->remoteHost().toString();
+  for (size_t i=0; i<client_prio.size(); ++i)
+  {
+    if (client_prio[i] == host)
+    {
+      return client_prio.size() - i;
+    }
+  }
+  return 0;
+} /* NetUplink::clientPrio */
+
+
 /*
  * This file has not been truncated
  */
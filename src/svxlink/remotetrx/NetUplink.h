@@ -6,7 +6,7 @@
 
 \verbatim
 RemoteTrx - A remote receiver for the SvxLink server
-Copyright (C) 2003-2010 Tobias Blomberg / SM0SVX
+Copyright (C) 2003-2026 Tobias Blomberg / SM0SVX
 
 This program is free software; you can redistribute it and/or modify
 it under the terms of the GNU General Public License as published by
@@ -38,6 +38,8 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 #include <sys/time.h>
 
 #include <string>
+#include <vector>
+#include <map>
 
 
 /****************************************************************************
@@ -84,6 +86,8 @@ namespace NetTrxMsg
   class Msg;
 };
 
+class NetTrxUdpChannel;
+
 /****************************************************************************
  *
  * Namespace
@@ -130,6 +134,15 @@ namespace NetTrxMsg
 @date   2006-04-14
 
 This class implements a remote transceiver uplink via an IP network.
+
+More than one client may be connected at the same time if the MAX_CLIENTS
+configuration variable is set, e.g. a primary and a hot standby SvxLink
+server using the same remote receiver. The receiver audio is encoded once for
+each distinct codec configuration requested by the clients and the encoded
+audio is sent to all clients that requested that configuration. All receiver
+events are sent to all clients. The transmitter is controlled by one client
+at a time. The client with the highest priority that want to transmit get
+the transmitter, see CLIENT_PRIORITY.
 */
 class NetUplink : public Uplink
 {
@@ -164,43 +177,56 @@ class NetUplink : public Uplink
     {
       STATE_DISC, STATE_CON_SETUP, STATE_READY, STATE_DISC_CLEANUP
     } State;
+
+    struct Client;
+    struct RxEncoder;
+    struct ToneDet;
+    class LaunchGate;
+    typedef std::vector<Client*>              ClientList;
+    typedef std::map<std::string, RxEncoder*> RxEncoderMap;
     
     Async::TcpServer<Async::TcpConnection>*  server;
-    Async::TcpConnection    *con;
-    char      	      	    recv_buf[4096];
-    unsigned       	    recv_cnt;
-    unsigned       	    recv_exp;
+    ClientList              clients;
+    RxEncoderMap            rx_encoders;
+    std::vector<ToneDet>    rx_tone_dets;
+    Client                  *tx_client;
+    Client                  *udp_client;
+    unsigned                max_clients;
+    std::vector<std::string> client_prio;
+    unsigned                client_seq;
     Rx	      	      	    *rx;
     Tx	      	      	    *tx;
     Async::AudioFifo  	    *fifo;
     Async::Config     	    &cfg;
     std::string       	    name;
-    struct timeval    	    last_msg_timestamp;
     Async::Timer      	    *heartbeat_timer;
-    Async::AudioEncoder     *audio_enc;
-    Async::AudioDecoder     *audio_dec;
     Async::AudioPassthrough *loopback_con;
     Async::AudioSplitter    *rx_splitter;
     Async::AudioSelector    *tx_selector;
-    State                   state;
+    Async::AudioSelector    *dec_selector;
+    LaunchGate              *launch_gate;
+    Async::Timer            *launch_timer;
     std::string             auth_key;
-    unsigned char           auth_challenge[NetTrxMsg::MsgAuthChallenge::CHALLENGE_LEN];
     //Async::Timer      	    *siglev_check_timer;
     Async::Timer	    *mute_tx_timer;
     bool		    tx_muted;
     bool                    fallback_enabled;
-    Tx::TxCtrlMode	    tx_ctrl_mode;
+    NetTrxUdpChannel        *udp_chan;
+    uint16_t                udp_port;
     
     NetUplink(const NetUplink&);
     NetUplink& operator=(const NetUplink&);
     void handleIncomingConnection(Async::TcpConnection *incoming_con);
     void clientConnected(Async::TcpConnection *con);
-    void disconnectCleanup(void);
+    void disconnectCleanup(Client *client);
     void clientDisconnected(Async::TcpConnection *con,
       	      	      	    Async::TcpConnection::DisconnectReason reason);
-    int tcpDataReceived(Async::TcpConnection *con, void *data, int size);
-    void handleMsg(NetTrxMsg::Msg *msg);
-    void sendMsg(NetTrxMsg::Msg *msg);
+    int tcpDataReceived(Async::TcpConnection *con, void *data, int size,
+                        Client *client);
+    void handleMsg(Client *client, NetTrxMsg::Msg *msg);
+    void writeMsg(Client *client, const NetTrxMsg::Msg *msg);
+    void sendMsg(Client *client, NetTrxMsg::Msg *msg);
+    void broadcastMsg(NetTrxMsg::Msg *msg);
 
     /**
      * @brief 	Set squelch state to open/closed
@@ -224,20 +250,39 @@ class NetUplink : public Uplink
      * @brief 	Pass on detected selcall sequence
      * @param 	sequence received sequence of digits
     */
-    void selcallSequenceDetected(std::string sequence);
+    void selcallSequenceDetected(const std::string& sequence);
 
 
-    void writeEncodedSamples(const void *buf, int size);
+    void selectRxAudioCodec(Client *client,
+                            NetTrxMsg::MsgRxAudioCodecSelect *codec_msg);
+    void releaseRxEncoder(Client *client);
+    void selectTxAudioCodec(Client *client,
+                            NetTrxMsg::MsgTxAudioCodecSelect *codec_msg);
+    void writeEncodedSamples(const void *buf, int size, RxEncoder *rx_enc);
+    void flushEncodedSamples(RxEncoder *rx_enc);
     void txTimeout(void);
     void transmitterStateChange(bool is_transmitting);
-    void allEncodedSamplesFlushed(void);
+    void allEncodedSamplesFlushed(Client *client);
+    void writeTxAudio(Client *client, const void *buf, int size);
+    void flushTxAudio(Client *client);
+    void scheduleTxLaunch(Client *client, uint64_t launch_time);
+    void txLaunch(Async::Timer *t);
+    void cancelTxLaunch(void);
+    void handleUdpSetupRequest(Client *client);
+    void udpUpStateChanged(bool is_up);
+    void udpAudioReceived(const void *buf, int size);
+    void udpFlushReceived(void);
     void heartbeat(Async::Timer *t);
     //void checkSiglev(Async::Timer *t);
     void unmuteTx(Async::Timer *t);
     void setFallbackActive(bool activate);
     void signalLevelUpdated(float siglev);
-    void forceDisconnect(void);
-    void setState(State new_state) { state = new_state; }
+    void forceDisconnect(Client *client);
+    void resetRx(void);
+    void updateRxMuteState(void);
+    void updateTxClient(void);
+    Tx::TxCtrlMode txCtrlMode(void) const;
+    unsigned clientPrio(const Async::TcpConnection *con) const;
 
 };  /* class NetUplink */
 
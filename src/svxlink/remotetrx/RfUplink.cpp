@@ -195,6 +195,9 @@ bool RfUplink::initialize(void)
   unsigned det_1750_duration = 0;
   cfg.getValue(name, "DETECT_1750", det_1750_duration);
 
+  bool passthrough = false;
+  cfg.getValue(name, "PASSTHROUGH", passthrough);
+
   rx->squelchOpen.connect(
       mem_fun(*this, &RfUplink::rxSquelchOpen));
   rx->signalLevelUpdated.connect(
@@ -219,8 +222,11 @@ bool RfUplink::initialize(void)
   }
   AudioSource *prev_src = rx;
 
+    // In passthrough mode the audio is not prebuffered. The FIFO then only
+    // hold audio while the uplink transmitter cannot take it, so audio
+    // blocks from the receiver are handed over as they are.
   AudioFifo *fifo = new AudioFifo(8000);
-  fifo->setPrebufSamples(512);
+  fifo->setPrebufSamples(passthrough ? 0 : 512);
   prev_src->registerSink(fifo, true);
   prev_src = fifo;
   
@@ -81,6 +81,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 
 #include "version/REMOTE_TRX.h"
 #include "TrxHandler.h"
+#include "IqServer.h"
 #include "NetTrxAdapter.h"
 
 
@@ -475,6 +476,31 @@ int main(int argc, char **argv)
   cfg.getValue("GLOBAL", "CARD_CHANNELS", card_channels);
   AudioIO::setChannels(card_channels);
 
+    // Override the sound card buffering set up above. Smaller blocks give
+    // lower latency but increase the risk of buffer overruns/underruns.
+  size_t card_block_size = 0;
+  if (cfg.getValue("GLOBAL", "CARD_BLOCK_SIZE", card_block_size))
+  {
+    if ((card_block_size < 32) || (card_block_size > 8192))
+    {
+      cerr << "*** ERROR: Illegal value for config variable "
+              "GLOBAL/CARD_BLOCK_SIZE. Valid values are 32 to 8192\n";
+      exit(1);
+    }
+    AudioIO::setBlocksize(card_block_size);
+  }
+  size_t card_block_count = 0;
+  if (cfg.getValue("GLOBAL", "CARD_BLOCK_COUNT", card_block_count))
+  {
+    if ((card_block_count < 2) || (card_block_count > 32))
+    {
+      cerr << "*** ERROR: Illegal value for config variable "
+              "GLOBAL/CARD_BLOCK_COUNT. Valid values are 2 to 32\n";
+      exit(1);
+    }
+    AudioIO::setBlockCount(card_block_count);
+  }
+
   struct termios org_termios = {0};
   if (logfile_name == 0)
   {
@@ -510,7 +536,27 @@ int main(int argc, char **argv)
     cout << endl;
   }
 
-  if (!trx_handlers.empty())
+  vector<IqServer*> iq_servers;
+  vector<string> iq_server_names;
+  value = "";
+  cfg.getValue("GLOBAL", "IQ_SERVERS", value);
+  splitStr(iq_server_names, value, ",");
+  for (unsigned i=0; i<iq_server_names.size(); ++i)
+  {
+    cout << "Setting up IQ server \"" << iq_server_names[i] << "\"\n";
+    IqServer *iq_server = new IqServer(cfg, iq_server_names[i]);
+    if (!iq_server->initialize())
+    {
+      cerr << "*** ERROR: Failed to setup IQ server " << iq_server_names[i]
+           << endl;
+      delete iq_server;
+      continue;
+    }
+    iq_servers.push_back(iq_server);
+    cout << endl;
+  }
+
+  if (!trx_handlers.empty() || !iq_servers.empty())
   {
     if (reset)
     {
@@ -534,6 +580,14 @@ int main(int argc, char **argv)
   }
   trx_handlers.clear();
 
+  for (vector<IqServer*>::iterator it = iq_servers.begin();
+       it != iq_servers.end();
+       ++it)
+  {
+    delete *it;
+  }
+  iq_servers.clear();
+
   if (stdin_watch != 0)
   {
     delete stdin_watch;
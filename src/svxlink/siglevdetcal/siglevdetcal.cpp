@@ -6,7 +6,7 @@
 
 \verbatim
 SvxLink - A Multi Purpose Voice Services System for Ham Radio Use
-Copyright (C) 2003-2025 Tobias Blomberg / SM0SVX
+Copyright (C) 2003-2026 Tobias Blomberg / SM0SVX
 
 This program is free software; you can redistribute it and/or modify
 it under the terms of the GNU General Public License as published by
@@ -33,6 +33,10 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 #include <iostream>
 #include <cstdlib>
 #include <map>
+#include <vector>
+#include <string>
+#include <sstream>
+#include <json/json.h>
 
 
 /****************************************************************************
@@ -84,6 +88,20 @@ struct CtcssMeasurement
   size_t count = 0;
 };
 
+  // All receivers are measured at the same time so the state for each one
+  // is kept separately
+struct RxMeasurement
+{
+  LocalRxBase*                      rx = nullptr;
+  float                             siglev_slope = 10.0;
+  float                             siglev_offset = 0.0;
+  double                            open_sum = 0.0;
+  double                            close_sum = 0.0;
+  std::map<float, CtcssMeasurement> ctcss_snr_sum;
+  std::map<float, float>            ctcss_open_snr;
+  std::map<float, float>            ctcss_close_snr;
+};
+
 
 /****************************************************************************
  *
@@ -95,14 +113,8 @@ static const int INTERVAL = 100;
 static const int ITERATIONS = 150;
 
 static Config cfg;
-static LocalRxBase *rx;
-static double open_sum = 0.0f;
-static double close_sum = 0.0f;
-static float siglev_slope = 10.0;
-static float siglev_offset = 0.0;
-static std::map<float, CtcssMeasurement> ctcss_snr_sum;
-static std::map<float, float> ctcss_open_snr;
-static std::map<float, float> ctcss_close_snr;
+static std::vector<RxMeasurement> rxs;
+static bool json_output = false;
 
 
 /****************************************************************************
@@ -151,37 +163,64 @@ void squelchOpen(bool is_open)
 #endif
 
 
-void sample_squelch_close(Timer *t)
+static void print_signal_strengths(void)
 {
-  static int count = 0;
-  printf("Signal strength=%.3f\n",
-         siglev_offset + siglev_slope * rx->signalStrength());
-  
-  close_sum += rx->signalStrength();
-  
-  if (++count == ITERATIONS)
+  for (const auto& m : rxs)
   {
-    delete t;
+    if (rxs.size() > 1)
+    {
+      printf("%s: ", m.rx->name().c_str());
+    }
+    printf("Signal strength=%.3f\n",
+           m.siglev_offset + m.siglev_slope * m.rx->signalStrength());
+  }
+} /* print_signal_strengths */
 
-    float open_close_mean = (open_sum - close_sum) / ITERATIONS;
-    float close_mean = close_sum / ITERATIONS;
+
+static void print_results(void)
+{
+  Json::Value results(Json::arrayValue);
+  for (auto& m : rxs)
+  {
+    float open_close_mean = (m.open_sum - m.close_sum) / ITERATIONS;
+    float close_mean = m.close_sum / ITERATIONS;
 
     float new_siglev_slope = 100.0 / open_close_mean;
     float new_siglev_offset = -close_mean * new_siglev_slope;
-    for (const auto& entry : ctcss_snr_sum)
+    for (const auto& entry : m.ctcss_snr_sum)
     {
-      ctcss_close_snr[entry.first] = entry.second.sum / entry.second.count;
+      m.ctcss_close_snr[entry.first] = entry.second.sum / entry.second.count;
+    }
+
+    if (json_output)
+    {
+      Json::Value result(Json::objectValue);
+      result["rx"] = m.rx->name();
+      result["siglevSlope"] = new_siglev_slope;
+      result["siglevOffset"] = new_siglev_offset;
+      Json::Value ctcss(Json::arrayValue);
+      for (const auto& entry : m.ctcss_close_snr)
+      {
+        Json::Value tone(Json::objectValue);
+        tone["fq"] = entry.first;
+        tone["snr"] = m.ctcss_open_snr[entry.first] - entry.second;
+        tone["snrOffset"] = entry.second;
+        ctcss.append(tone);
+      }
+      result["ctcss"] = ctcss;
+      results.append(result);
+      continue;
     }
 
     cout << endl;
-    cout << "--- Results\n";
+    cout << "--- Results for " << m.rx->name() << "\n";
     printf("Mean SNR for the CTCSS tones : ");
-    if (!ctcss_close_snr.empty())
+    if (!m.ctcss_close_snr.empty())
     {
       printf("\n");
-      for (const auto& entry : ctcss_close_snr)
+      for (const auto& entry : m.ctcss_close_snr)
       {
-        float snr = ctcss_open_snr[entry.first] - entry.second;
+        float snr = m.ctcss_open_snr[entry.first] - entry.second;
         printf("    %5.1f : %+5.1fdB\n", entry.first, snr);
       }
     }
@@ -194,16 +233,16 @@ void sample_squelch_close(Timer *t)
 
     cout << endl;
     cout << "--- Put the config variables below in the configuration file\n";
-    cout << "--- section for " << rx->name() << ".\n";
+    cout << "--- section for " << m.rx->name() << ".\n";
     printf("SIGLEV_SLOPE=%.2f\n", new_siglev_slope);
     printf("SIGLEV_OFFSET=%.2f\n", new_siglev_offset);
-    if (!ctcss_close_snr.empty())
+    if (!m.ctcss_close_snr.empty())
     {
       printf("CTCSS_SNR_OFFSETS=");
-      for (auto it = ctcss_close_snr.begin();
-           it != ctcss_close_snr.end(); ++it)
+      for (auto it = m.ctcss_close_snr.begin();
+           it != m.ctcss_close_snr.end(); ++it)
       {
-        if (it->first != ctcss_close_snr.begin()->first)
+        if (it->first != m.ctcss_close_snr.begin()->first)
         {
           printf(",");
         }
@@ -211,10 +250,35 @@ void sample_squelch_close(Timer *t)
       }
       printf("\n");
     }
-    cout << endl;
-    
+  }
+
+  if (json_output)
+  {
+    Json::StreamWriterBuilder builder;
+    cout << Json::writeString(builder, results);
+  }
+  cout << endl;
+} /* print_results */
+
+
+void sample_squelch_close(Timer *t)
+{
+  static int count = 0;
+  print_signal_strengths();
+
+  for (auto& m : rxs)
+  {
+    m.close_sum += m.rx->signalStrength();
+  }
+
+  if (++count == ITERATIONS)
+  {
+    delete t;
+
+    print_results();
+
     //rx->setVerbose(true);
-    
+
     Application::app().quit();
   }
   else
@@ -227,13 +291,16 @@ void sample_squelch_close(Timer *t)
 void start_squelch_close_measurement(FdWatch *w)
 {
   int ch = getchar();
-  
+
   if (ch == '\n')
   {
     cout << "--- Starting squelch close measurement\n";
     delete w;
 
-    ctcss_snr_sum.clear();
+    for (auto& m : rxs)
+    {
+      m.ctcss_snr_sum.clear();
+    }
 
     Timer *timer = new Timer(INTERVAL);
     timer->expired.connect(sigc::ptr_fun(&sample_squelch_close));
@@ -244,25 +311,30 @@ void start_squelch_close_measurement(FdWatch *w)
 void sample_squelch_open(Timer *t)
 {
   static int count = 0;
-  printf("Signal strength=%.3f\n",
-      siglev_offset + siglev_slope * rx->signalStrength());
-  
-  open_sum += rx->signalStrength();
-  
+  print_signal_strengths();
+
+  for (auto& m : rxs)
+  {
+    m.open_sum += m.rx->signalStrength();
+  }
+
   if (++count == ITERATIONS)
   {
     delete t;
-    
-    for (const auto& entry : ctcss_snr_sum)
+
+    for (auto& m : rxs)
     {
-      ctcss_open_snr[entry.first] = entry.second.sum / entry.second.count;
+      for (const auto& entry : m.ctcss_snr_sum)
+      {
+        m.ctcss_open_snr[entry.first] = entry.second.sum / entry.second.count;
+      }
     }
 
     FdWatch *w = new FdWatch(0, FdWatch::FD_WATCH_RD);
     // must explicitly specify name space for ptr_fun() to avoid conflict
     // with ptr_fun() in /usr/include/c++/4.5/bits/stl_function.h
     w->activity.connect(sigc::ptr_fun(&start_squelch_close_measurement));
-    
+
     cout << endl;
     cout << "--- Release the PTT.\n";
     cout << "--- Open the squelch on the SvxLink receiver with no input signal\n";
@@ -280,29 +352,59 @@ void sample_squelch_open(Timer *t)
 void start_squelch_open_measurement(FdWatch *w)
 {
   int ch = getchar();
-  
+
   if (ch == '\n')
   {
     cout << "--- Starting squelch open measurement\n";
     delete w;
-    ctcss_snr_sum.clear();
+    for (auto& m : rxs)
+    {
+      m.ctcss_snr_sum.clear();
+    }
     Timer *timer = new Timer(INTERVAL);
     // must explicitly specify name space for ptr_fun() to avoid conflict
     // with ptr_fun() in /usr/include/c++/4.5/bits/stl_function.h
     timer->expired.connect(sigc::ptr_fun(&sample_squelch_open));
   }
-  
+
 } /* start_squelch_open_measurement */
 
 
-void ctcss_snr_updated(float snr, float fq)
+void ctcss_snr_updated(float snr, float fq, size_t idx)
 {
-  auto& measurement = ctcss_snr_sum[fq];
+  auto& measurement = rxs[idx].ctcss_snr_sum[fq];
   measurement.sum += snr;
   measurement.count += 1;
 }
 
 
+static void add_rx_sections(const string& sect, vector<string>& rx_sects)
+{
+  string type;
+  cfg.getValue(sect, "TYPE", type);
+  if (type != "Voter")
+  {
+    rx_sects.push_back(sect);
+    return;
+  }
+
+    // The receivers of a voter are calibrated one by one, at the same time.
+    // The optional ":<delay>" specifier for each receiver is ignored.
+  string receivers;
+  cfg.getValue(sect, "RECEIVERS", receivers);
+  stringstream ss(receivers);
+  string rx_name;
+  while (getline(ss, rx_name, ','))
+  {
+    rx_name = rx_name.substr(0, rx_name.find(':'));
+    if (!rx_name.empty())
+    {
+      rx_sects.push_back(rx_name);
+    }
+  }
+} /* add_rx_sections */
+
+
 /****************************************************************************
  *
  * MAIN
@@ -314,20 +416,26 @@ int main(int argc, char **argv)
   CppApplication app;
   
   cout << PROGRAM_NAME " v" SIGLEV_DET_CAL_VERSION
-          " Copyright (C) 2003-2025 Tobias Blomberg / SM0SVX\n\n";
+          " Copyright (C) 2003-2026 Tobias Blomberg / SM0SVX\n\n";
   cout << PROGRAM_NAME " comes with ABSOLUTELY NO WARRANTY. "
           "This is free software, and you\n";
   cout << "are welcome to redistribute it in accordance with the "
           "terms and conditions in\n";
   cout << "the GNU GPL (General Public License) version 2 or later.\n\n";
 
-  if (argc < 3)
+  int argi = 1;
+  if ((argc > argi) && (string(argv[argi]) == "--json"))
   {
-    cerr << "Usage: siglevdetcal <config file> <receiver section>\n";
+    json_output = true;
+    ++argi;
+  }
+  if (argc - argi < 2)
+  {
+    cerr << "Usage: siglevdetcal [--json] <config file> <receiver section> "
+            "[<receiver section>...]\n";
     exit(1);
   }
-  string cfg_file(argv[1]);
-  string rx_name(argv[2]);
+  string cfg_file(argv[argi++]);
   
   if (!cfg.open(cfg_file))
   {
@@ -370,51 +478,73 @@ int main(int argc, char **argv)
     cout << "--- Using sample rate " << rate << "Hz\n";
   }
   
-  string rx_type;
-  if (!cfg.getValue(rx_name, "TYPE", rx_type))
+  vector<string> rx_names;
+  for (; argi < argc; ++argi)
   {
-    cerr << "*** ERROR: Config variable " << rx_name << "/TYPE not set. "
-         << "Are you sure \"" << rx_name << "\" is an existing receiver config "
-	 << "section?\n";
-    exit(1);
+    string rx_name(argv[argi]);
+    string rx_type;
+    if (!cfg.getValue(rx_name, "TYPE", rx_type))
+    {
+      cerr << "*** ERROR: Config variable " << rx_name << "/TYPE not set. "
+           << "Are you sure \"" << rx_name << "\" is an existing receiver "
+           << "config section?\n";
+      exit(1);
+    }
+    add_rx_sections(rx_name, rx_names);
   }
 
-    // Make sure we have CTCSS squelch enabled
-  //cfg.setValue(rx_name, "SQL_DET", "CTCSS");
-
-    // Make sure that the squelch will not open during calibration
-  cfg.setValue(rx_name, "CTCSS_OPEN_THRESH", "100");
-  cfg.setValue(rx_name, "SIGLEV_OPEN_THRESH", "10000");
-  
-    // Make sure we are using the "Noise" siglev detector
-  //cfg.setValue(rx_name, "SIGLEV_DET", "NOISE");
-
-    // Read the configured siglev slope and offset, then clear them so that
-    // they cannot affect the measurement.
-  cfg.getValue(rx_name, "SIGLEV_SLOPE", siglev_slope);
-  cfg.setValue(rx_name, "SIGLEV_SLOPE", "1.0");
-  cfg.getValue(rx_name, "SIGLEV_OFFSET", siglev_offset);
-  cfg.setValue(rx_name, "SIGLEV_OFFSET", "0.0");
-  
-  rx = dynamic_cast<LocalRxBase*>(RxFactory::createNamedRx(cfg, rx_name));
-  if (rx == 0)
+  rxs.resize(rx_names.size());
+  for (size_t idx = 0; idx < rx_names.size(); ++idx)
   {
-    cerr << "*** ERROR: The given receiver config section is not for a "
-         << "local receiver. Calibration can only be done locally.\n";
-    exit(1);
+    const string& rx_name = rx_names[idx];
+    RxMeasurement& m = rxs[idx];
+
+      // Make sure we have CTCSS squelch enabled
+    //cfg.setValue(rx_name, "SQL_DET", "CTCSS");
+
+      // Make sure that the squelch will not open during calibration
+    cfg.setValue(rx_name, "CTCSS_OPEN_THRESH", "100");
+    cfg.setValue(rx_name, "SIGLEV_OPEN_THRESH", "10000");
+
+      // Make sure we are using the "Noise" siglev detector
+    //cfg.setValue(rx_name, "SIGLEV_DET", "NOISE");
+
+      // Read the configured siglev slope and offset, then clear them so that
+      // they cannot affect the measurement.
+    cfg.getValue(rx_name, "SIGLEV_SLOPE", m.siglev_slope);
+    cfg.setValue(rx_name, "SIGLEV_SLOPE", "1.0");
+    cfg.getValue(rx_name, "SIGLEV_OFFSET", m.siglev_offset);
+    cfg.setValue(rx_name, "SIGLEV_OFFSET", "0.0");
+
+    Rx *rx = RxFactory::createNamedRx(cfg, rx_name);
+    m.rx = dynamic_cast<LocalRxBase*>(rx);
+    if (m.rx == 0)
+    {
+      cerr << "*** ERROR: The receiver config section \"" << rx_name
+           << "\" is not for a local receiver. Calibration can only be "
+           << "done locally.\n";
+      exit(1);
+    }
+    if (!m.rx->initialize())
+    {
+      cerr << "*** ERROR: Could not initialize receiver \"" << rx_name
+           << "\"\n";
+      exit(1);
+    }
+    // must explicitly specify name space for ptr_fun() to avoid conflict
+    // with ptr_fun() in /usr/include/c++/4.5/bits/stl_function.h
+    //rx->squelchOpen.connect(sigc::ptr_fun(&squelchOpen));
+    m.rx->ctcssSnrUpdated.connect(
+        sigc::bind(sigc::ptr_fun(&ctcss_snr_updated), idx));
+    m.rx->setMuteState(Rx::MUTE_NONE);
+    m.rx->setVerbose(false);
   }
-  if (!rx->initialize())
+  if (rxs.size() > 1)
   {
-    cerr << "*** ERROR: Could not initialize receiver \"" << rx_name << "\"\n";
-    exit(1);
+    cout << "--- Calibrating " << rxs.size()
+         << " receivers at the same time\n";
   }
-  // must explicitly specify name space for ptr_fun() to avoid conflict
-  // with ptr_fun() in /usr/include/c++/4.5/bits/stl_function.h
-  //rx->squelchOpen.connect(sigc::ptr_fun(&squelchOpen));
-  rx->ctcssSnrUpdated.connect(sigc::ptr_fun(&ctcss_snr_updated));
-  rx->setMuteState(Rx::MUTE_NONE);
-  rx->setVerbose(false);
-  
+
   FdWatch *w = new FdWatch(0, FdWatch::FD_WATCH_RD);
   // must explicitly specify name space for ptr_fun() to avoid conflict
   // with ptr_fun() in /usr/include/c++/4.5/bits/stl_function.h
@@ -429,7 +559,10 @@ int main(int argc, char **argv)
   cout << "--- Press ENTER when ready.\n";
   
   app.exec();
-  
-  delete rx;
+
+  for (auto& m : rxs)
+  {
+    delete m.rx;
+  }
   
 } /* main */
@@ -6,7 +6,7 @@
 
 \verbatim
 SvxLink - A Multi Purpose Voice Services System for Ham Radio Use
-Copyright (C) 2003-2025 Tobias Blomberg / SM0SVX
+Copyright (C) 2003-2026 Tobias Blomberg / SM0SVX
 
 This program is free software; you can redistribute it and/or modify
 it under the terms of the GNU General Public License as published by
@@ -112,59 +112,141 @@ using namespace std;
 
 CmdParser::~CmdParser(void)
 {
-  CmdMap cmds_copy = cmds;
-  CmdMap::iterator it;
-  for (it = cmds_copy.begin(); it != cmds_copy.end(); ++it)
+    // The command destructor remove the command from the parser so the
+    // commands are collected before deleting them
+  std::vector<Command*> cmds;
+  collectCmds(&m_root, cmds);
+  for (Command* cmd : cmds)
   {
-    delete (*it).second;
+    delete cmd;
   }
 } /* CmdParser::~CmdParser */
 
 
 bool CmdParser::addCmd(Command *cmd)
 {
-  bool cmd_undefined = (cmds.count(cmd->cmdStr()) == 0);
-  if (cmd_undefined)
+  const std::string& cmd_str = cmd->cmdStr();
+  for (char digit : cmd_str)
   {
-    cmds[cmd->cmdStr()] = cmd;
+    if (digitIndex(digit) < 0)
+    {
+      return false;
+    }
+  }
+
+  const Node* existing = findNode(cmd_str);
+  if ((existing != 0) && (existing->cmd != 0))
+  {
+    return false;
   }
-  return cmd_undefined;
+
+  Node* node = &m_root;
+  node->cmd_cnt += 1;
+  for (char digit : cmd_str)
+  {
+    std::unique_ptr<Node>& child = node->children[digitIndex(digit)];
+    if (child == nullptr)
+    {
+      child.reset(new Node);
+    }
+    node = child.get();
+    node->cmd_cnt += 1;
+  }
+  node->cmd = cmd;
+  return true;
 } /* CmdParser::addCmd */
 
 
 bool CmdParser::removeCmd(Command *cmd)
 {
-  CmdMap::iterator cmd_it = cmds.find(cmd->cmdStr());
-  bool cmd_exist = (cmd_it != cmds.end());
-  if (cmd_exist)
+  const std::string& cmd_str = cmd->cmdStr();
+  const Node* found = findNode(cmd_str);
+  if ((found == 0) || (found->cmd != cmd))
   {
-    cmds.erase(cmd_it);
+    return false;
+  }
+
+    // Decrease the command count along the path and prune the branch
+    // where no more commands are left
+  Node* node = &m_root;
+  node->cmd_cnt -= 1;
+  for (char digit : cmd_str)
+  {
+    std::unique_ptr<Node>& child = node->children[digitIndex(digit)];
+    if (--child->cmd_cnt == 0)
+    {
+      child.reset();
+      return true;
+    }
+    node = child.get();
   }
-  return cmd_exist;
+  node->cmd = 0;
+  return true;
 } /* CmdParser::removeCmd */
 
 
+Command *CmdParser::findCmd(const std::string& cmd_str) const
+{
+  const Node* node = findNode(cmd_str);
+  return (node != 0) ? node->cmd : 0;
+} /* CmdParser::findCmd */
+
+
 bool CmdParser::processCmd(const string& cmd_str)
 {
-  int len = cmd_str.size();
-  while (len > 0)
+    // Find the longest command that match the start of the command string
+  Command *cmd = 0;
+  size_t cmd_len = 0;
+  const Node* node = &m_root;
+  for (size_t i=0; i<cmd_str.size(); ++i)
   {
-    const std::string base_cmd = cmd_str.substr(0, len);
-    if (cmds.count(base_cmd) == 1)
+    const int idx = digitIndex(cmd_str[i]);
+    if ((idx < 0) || (node->children[idx] == nullptr))
+    {
+      break;
+    }
+    node = node->children[idx].get();
+    if ((node->cmd != 0) &&
+        (!node->cmd->exactMatch() || (i+1 == cmd_str.size())))
     {
-      Command *cmd = cmds[base_cmd];
-      if (!cmd->exactMatch() || (cmd_str.size() == cmd->cmdStr().size()))
-      {
-        (*cmd)(cmd_str.substr(len, cmd_str.size()-len));
-        return true;
-      }
+      cmd = node->cmd;
+      cmd_len = i + 1;
     }
-    --len;
   }
 
-  return false;
-  
+  if (cmd == 0)
+  {
+    return false;
+  }
+  (*cmd)(cmd_str.substr(cmd_len));
+  return true;
 } /* CmdParser::processCmd */
+
+
+CmdParser::MatchType CmdParser::matchPrefix(const std::string& digits) const
+{
+  const Node* node = &m_root;
+  for (char digit : digits)
+  {
+    if ((node->cmd != 0) && !node->cmd->exactMatch())
+    {
+        // A command that may be followed by a sub command
+      return MATCH_PARTIAL;
+    }
+    const int idx = digitIndex(digit);
+    if ((idx < 0) || (node->children[idx] == nullptr))
+    {
+      return MATCH_NONE;
+    }
+    node = node->children[idx].get();
+  }
+
+  if ((node->cmd != 0) && node->cmd->exactMatch() && (node->cmd_cnt == 1))
+  {
+    return MATCH_COMPLETE;
+  }
+  return MATCH_PARTIAL;
+} /* CmdParser::matchPrefix */
     
 
 
@@ -200,6 +282,59 @@ bool CmdParser::processCmd(const string& cmd_str)
  *
  ****************************************************************************/
 
+int CmdParser::digitIndex(char digit)
+{
+  if ((digit >= '0') && (digit <= '9'))
+  {
+    return digit - '0';
+  }
+  if ((digit >= 'A') && (digit <= 'D'))
+  {
+    return 10 + digit - 'A';
+  }
+  if (digit == '*')
+  {
+    return 14;
+  }
+  if (digit == '#')
+  {
+    return 15;
+  }
+  return -1;
+} /* CmdParser::digitIndex */
+
+
+const CmdParser::Node* CmdParser::findNode(const std::string& cmd_str) const
+{
+  const Node* node = &m_root;
+  for (char digit : cmd_str)
+  {
+    const int idx = digitIndex(digit);
+    if ((idx < 0) || (node->children[idx] == nullptr))
+    {
+      return 0;
+    }
+    node = node->children[idx].get();
+  }
+  return node;
+} /* CmdParser::findNode */
+
+
+void CmdParser::collectCmds(const Node* node, std::vector<Command*>& cmds)
+{
+  if (node->cmd != 0)
+  {
+    cmds.push_back(node->cmd);
+  }
+  for (const auto& child : node->children)
+  {
+    if (child != nullptr)
+    {
+      collectCmds(child.get(), cmds);
+    }
+  }
+} /* CmdParser::collectCmds */
+
 
 /*
  *----------------------------------------------------------------------------
@@ -6,7 +6,7 @@
 
 \verbatim
 SvxLink - A Multi Purpose Voice Services System for Ham Radio Use
-Copyright (C) 2003-2025 Tobias Blomberg / SM0SVX
+Copyright (C) 2003-2026 Tobias Blomberg / SM0SVX
 
 This program is free software; you can redistribute it and/or modify
 it under the terms of the GNU General Public License as published by
@@ -36,8 +36,9 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 
 #include <sigc++/sigc++.h>
 
-#include <map>
 #include <string>
+#include <vector>
+#include <memory>
 #include <cassert>
 
 
@@ -113,6 +114,12 @@ class Command;
 
 This is the DTMF command parser engine implementation. Add commands based on
 the Command class.
+
+The commands are stored in a prefix tree over the DTMF digit alphabet
+(0-9, A-D, * and #) so finding the command matching a digit string take
+time proportional to the length of the string, no matter how many commands
+that have been added. The same tree is used by the matchPrefix function to
+find out, while the digits are being received, if a command is complete.
 */
 class CmdParser
 {
@@ -141,20 +148,63 @@ class CmdParser
      */
     bool removeCmd(Command *cmd);
     
+    /**
+     * @brief	Find a command
+     * @param	cmd_str The exact command string to look for
+     * @return	Returns the command object or 0 if not found
+     */
+    Command *findCmd(const std::string& cmd_str) const;
+
     /**
      * @brief	Process a command string
      * @param	cmd_str The command string to process
      * @return	Returns \em true if the command was found or else \em false
      */
     bool processCmd(const std::string& cmd_str);
-    
-    
+
+    /**
+     * @brief   The result of matching a partial command string
+     */
+    typedef enum
+    {
+      MATCH_NONE,     ///< No command can match the digits
+      MATCH_PARTIAL,  ///< More digits may be needed to form a command
+      MATCH_COMPLETE  ///< The digits form a command that cannot be extended
+    } MatchType;
+
+    /**
+     * @brief   Match a partial command string
+     * @param   digits The digits received so far
+     * @return  Returns how well the digits match the added commands
+     *
+     * This function is used to match the digits while they are being
+     * received. MATCH_COMPLETE is only returned if the digits exactly match
+     * a command that require an exact match and no other command start with
+     * the same digits. Such a command can be executed directly, without
+     * waiting for the end of the command.
+     */
+    MatchType matchPrefix(const std::string& digits) const;
+
   protected:
-    
+
   private:
-    typedef std::map<std::string, Command *> CmdMap;
-    CmdMap cmds;
-    
+    static const int ALPHABET_SIZE = 16;
+
+    struct Node
+    {
+      Command*              cmd       {nullptr};
+      unsigned              cmd_cnt   {0};
+      std::unique_ptr<Node> children[ALPHABET_SIZE];
+    };
+
+    Node m_root;
+
+    CmdParser(const CmdParser&);
+    CmdParser& operator=(const CmdParser&);
+    static int digitIndex(char digit);
+    const Node* findNode(const std::string& cmd_str) const;
+    static void collectCmds(const Node* node, std::vector<Command*>& cmds);
+
 };  /* class CmdParser */
 
 
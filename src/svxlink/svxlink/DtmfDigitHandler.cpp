@@ -176,6 +176,13 @@ void DtmfDigitHandler::digitReceived(char digit)
         received_digits += digit;
       }
     }
+
+    if (!received_digits.empty() && cmd_matcher &&
+        cmd_matcher(received_digits))
+    {
+      commandComplete();
+      reset();
+    }
   }
 }
 
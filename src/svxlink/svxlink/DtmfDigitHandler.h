@@ -176,11 +176,25 @@ class DtmfDigitHandler : public sigc::trackable
      */
     sigc::signal<void()> commandComplete;
 
+    /**
+     * @brief   Set a function used to detect complete commands early
+     * @param   matcher A function returning \em true for a complete command
+     *
+     * The matcher is called with the received digits every time a digit is
+     * added to the buffer. If it returns \em true, the commandComplete signal
+     * is emitted directly without waiting for a # or the squelch to close.
+     */
+    void setCommandMatcher(const sigc::slot<bool(const std::string&)>& matcher)
+    {
+      cmd_matcher = matcher;
+    }
+
   private:
     Async::Timer  cmd_tmo_timer;
     std::string   received_digits;
     bool          anti_flutter;
     char          prev_digit;
+    sigc::slot<bool(const std::string&)> cmd_matcher;
 
     DtmfDigitHandler(const DtmfDigitHandler&);
     DtmfDigitHandler& operator=(const DtmfDigitHandler&);
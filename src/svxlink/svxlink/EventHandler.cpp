@@ -36,6 +36,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 #include <cassert>
 #include <cstdlib>
 #include <cstring>
+#include <deque>
 
 
 /****************************************************************************
@@ -45,6 +46,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
  ****************************************************************************/
 
 #include <AsyncApplication.h>
+#include <AsyncWorkerPool.h>
 
 
 
@@ -118,8 +120,166 @@ using namespace Async;
  ****************************************************************************/
 
 
-EventHandler::EventHandler(const string& event_script, const string& logic_name)
+EventHandler::EventHandler(const string& event_script,
+                           const string& logic_name, bool threaded)
   : event_script(event_script), logic_name(logic_name), interp(0)
+{
+  if (threaded)
+  {
+    worker.reset(new WorkerPool(1));
+    if (!worker->initOk())
+    {
+      cerr << "*** WARNING: Could not start the TCL thread for logic "
+           << logic_name << ". Running TCL in the main thread.\n";
+      worker.reset();
+    }
+  }
+  runInTclThread([this]{ createInterp(); });
+} /* EventHandler::EventHandler */
+
+
+EventHandler::~EventHandler(void)
+{
+    // Events that are still queued are run to completion but their calls to
+    // the main thread are dropped since the owner is going away
+  stopping = true;
+  runInTclThreadAndWait([this]{ deleteInterp(); });
+} /* EventHandler::~EventHandler */
+
+
+bool EventHandler::initialize(void)
+{
+  bool success = false;
+  runInTclThreadAndWait([this, &success]
+    {
+      if (interp == 0)
+      {
+        return;
+      }
+      if (Tcl_EvalFile(interp, event_script.c_str()) != TCL_OK)
+      {
+        const char *trace = Tcl_GetVar(interp, "errorInfo", TCL_GLOBAL_ONLY); 
+        std::cerr << "*** ERROR[" << logic_name
+                  << "]: Failed to load event script "
+                  << "'" << event_script << "'\n"
+                  << trace << std::endl;
+        return;
+      }
+      success = true;
+    });
+  return success;
+  
+} /* EventHandler::initialize */
+
+
+void EventHandler::addCommand(const std::string& name, CommandHandler f)
+{
+  auto data = new GenericCommand{this, f};
+  runInTclThread([this, name, data]
+    {
+      if (interp == 0)
+      {
+        delete data;
+        return;
+      }
+      Tcl_CreateCommand(interp, name.c_str(), genericCommandHandler, data,
+          [](ClientData cdata) {
+            delete static_cast<GenericCommand*>(cdata);
+          });
+    });
+} /* EventHandler::addCommand */
+
+
+void EventHandler::setVariable(const string& name, const string& value)
+{
+  runInTclThread([this, name, value]
+    {
+      if (interp == 0)
+      {
+        return;
+      }
+
+      Tcl_Preserve(interp);
+      if (Tcl_SetVar(interp, name.c_str(), value.c_str(), TCL_LEAVE_ERR_MSG)
+            == NULL)
+      {
+        cerr << event_script << " in logic " << logic_name
+             << " failed setting variable \"" << name << "=" << value
+             << "\": " << Tcl_GetStringResult(interp) << endl;
+      }
+      Tcl_Release(interp);
+    });
+} /* EventHandler::setVariable */
+
+
+bool EventHandler::processEvent(const string& event)
+{
+  if (worker == nullptr)
+  {
+    return evalEvent(event);
+  }
+  worker->run([this, event]{ evalEvent(event); flushMainThreadCalls(); });
+  return true;
+} /* EventHandler::processEvent */
+
+
+bool EventHandler::processEventAndWait(const string& event)
+{
+  bool success = false;
+  runInTclThreadAndWait([this, &event, &success]
+    {
+      success = evalEvent(event);
+    });
+  return success;
+} /* EventHandler::processEventAndWait */
+
+
+const string EventHandler::eventResult(void) const
+{
+  std::lock_guard<std::mutex> lk(main_mutex);
+  return event_result;
+} /* EventHandler::eventResult */
+
+
+EventHandler::EventStatsMap EventHandler::eventStats(void) const
+{
+  std::lock_guard<std::mutex> lk(main_mutex);
+  return event_stats;
+} /* EventHandler::eventStats */
+
+
+/****************************************************************************
+ *
+ * Protected member functions
+ *
+ ****************************************************************************/
+
+
+/*
+ *------------------------------------------------------------------------
+ * Method:    
+ * Purpose:   
+ * Input:     
+ * Output:    
+ * Author:    
+ * Created:   
+ * Remarks:   
+ * Bugs:      
+ *------------------------------------------------------------------------
+ */
+
+
+
+
+
+
+/****************************************************************************
+ *
+ * Private member functions
+ *
+ ****************************************************************************/
+
+void EventHandler::createInterp(void)
 {
   interp = Tcl_CreateInterp();
   if (interp == 0)
@@ -149,6 +309,8 @@ EventHandler::EventHandler(const string& event_script, const string& logic_name)
   Tcl_CreateCommand(interp, "publishStateEvent", publishStateEventHandler,
                     this, NULL);
   Tcl_CreateCommand(interp, "playDtmf", playDtmfHandler, this, NULL);
+  Tcl_CreateCommand(interp, "beginSequence", sequenceHandler, this, NULL);
+  Tcl_CreateCommand(interp, "endSequence", sequenceHandler, this, NULL);
   Tcl_CreateCommand(interp, "injectDtmf", injectDtmfHandler, this, NULL);
   Tcl_CreateCommand(interp, "getConfigValue", getConfigValueHandler,
                     this, NULL);
@@ -157,11 +319,17 @@ EventHandler::EventHandler(const string& event_script, const string& logic_name)
 
   //setVariable("script_path", event_script);
 
-} /* EventHandler::EventHandler */
+} /* EventHandler::createInterp */
 
 
-EventHandler::~EventHandler(void)
+void EventHandler::deleteInterp(void)
 {
+  for (auto& cmd_obj : cmd_objs)
+  {
+    Tcl_DecrRefCount(cmd_obj.second);
+  }
+  cmd_objs.clear();
+
   if (interp != 0)
   {
     Tcl_Preserve(interp);
@@ -170,125 +338,253 @@ EventHandler::~EventHandler(void)
       Tcl_DeleteInterp(interp);
     }
     Tcl_Release(interp);
+    interp = 0;
   }
-} /* EventHandler::~EventHandler */
+} /* EventHandler::deleteInterp */
 
 
-bool EventHandler::initialize(void)
+bool EventHandler::evalEvent(const string& event)
 {
   if (interp == 0)
   {
     return false;
   }
-  
-  if (Tcl_EvalFile(interp, event_script.c_str()) != TCL_OK)
+
+  const string name(event, 0, event.find(' '));
+  Tcl_Obj *objv[MAX_EVENT_WORDS];
+  int objc = splitEvent(event, name, objv);
+
+  bool success = true;
+  auto start = std::chrono::steady_clock::now();
+  Tcl_Preserve(interp);
+  int ret = (objc > 0) ? Tcl_EvalObjv(interp, objc, objv, 0)
+                       : Tcl_Eval(interp, (event + ";").c_str());
+  if (ret != TCL_OK)
   {
     const char *trace = Tcl_GetVar(interp, "errorInfo", TCL_GLOBAL_ONLY); 
-    std::cerr << "*** ERROR[" << logic_name << "]: Failed to load event script "
-              << "'" << event_script << "'\n"
-              << trace << std::endl;
-    return false;
+    std::cerr << "*** ERROR[" << logic_name << "]: Unable to handle event "
+              << "\"" << event << "\"\n"
+              << ((trace != 0) ? trace : Tcl_GetStringResult(interp))
+              << std::endl;
+    success = false;
+  }
+  {
+    std::lock_guard<std::mutex> lk(main_mutex);
+    event_result = Tcl_GetStringResult(interp);
+  }
+  Tcl_Release(interp);
+  updateEventStats(name, std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - start));
+
+    // The first object is the cached command object which is kept
+  for (int i=1; i<objc; ++i)
+  {
+    Tcl_DecrRefCount(objv[i]);
   }
   
-  return true;
+  return success;
   
-} /* EventHandler::initialize */
+} /* EventHandler::evalEvent */
 
 
-void EventHandler::addCommand(const std::string& name, CommandHandler f)
+void EventHandler::runInTclThread(std::function<void(void)> func)
 {
-  Tcl_CreateCommand(interp, name.c_str(), genericCommandHandler,
-      new CommandHandler(f),
-      [](ClientData cdata) {
-        delete static_cast<CommandHandler*>(cdata);
-      });
-} /* EventHandler::addCommand */
+  if (worker == nullptr)
+  {
+    func();
+    return;
+  }
+  worker->run([this, func]{ func(); flushMainThreadCalls(); });
+} /* EventHandler::runInTclThread */
 
 
-void EventHandler::setVariable(const string& name, const string& value)
+void EventHandler::runInTclThreadAndWait(std::function<void(void)> func)
 {
-  if (interp == 0)
+  if (worker == nullptr)
   {
+    func();
     return;
   }
-  
-  Tcl_Preserve(interp);
-  if (Tcl_SetVar(interp, name.c_str(), value.c_str(), TCL_LEAVE_ERR_MSG)
-  	== NULL)
+
+  bool done = false;
+  worker->run([this, &func, &done]
+    {
+      func();
+      flushMainThreadCalls();
+      std::lock_guard<std::mutex> lk(main_mutex);
+      done = true;
+      main_cond.notify_all();
+    });
+
+    // The TCL thread may be waiting for the main thread to handle a call so
+    // those calls must be handled while waiting here
+  std::unique_lock<std::mutex> lk(main_mutex);
+  while (!done)
   {
-    cerr << event_script << " in logic " << logic_name
-         << " failed setting variable \"" << name << "=" << value << "\": "
-         << Tcl_GetStringResult(interp) << endl;
+    if (main_calls.empty())
+    {
+      main_cond.wait(lk);
+      continue;
+    }
+    lk.unlock();
+    runMainThreadCalls();
+    lk.lock();
   }
-  Tcl_Release(interp);
-} /* EventHandler::setVariable */
+} /* EventHandler::runInTclThreadAndWait */
 
 
-bool EventHandler::processEvent(const string& event)
+void EventHandler::callInMainThread(std::function<void(void)> func)
 {
-  if (interp == 0)
+  if (worker == nullptr)
   {
-    return false;
+    func();
+    return;
   }
-  
-  bool success = true;
-  Tcl_Preserve(interp);
-  if (Tcl_Eval(interp, (event + ";").c_str()) != TCL_OK)
+  pending_calls.push_back(std::move(func));
+} /* EventHandler::callInMainThread */
+
+
+void EventHandler::callInMainThreadAndWait(std::function<void(void)> func)
+{
+  if (worker == nullptr)
   {
-    const char *trace = Tcl_GetVar(interp, "errorInfo", TCL_GLOBAL_ONLY); 
-    std::cerr << "*** ERROR[" << logic_name << "]: Unable to handle event "
-              << "\"" << event << "\"\n" << trace << std::endl;
-    success = false;
+    func();
+    return;
   }
-  Tcl_Release(interp);
-  
-  return success;
-  
-} /* EventHandler::processEvent */
 
+  bool done = false;
+  flushMainThreadCalls();
+  std::unique_lock<std::mutex> lk(main_mutex);
+  main_calls.push_back({std::move(func), &done});
+  main_cond.notify_all();
+  worker->runInMainThread([this]{ runMainThreadCalls(); });
+  main_cond.wait(lk, [&done]{ return done; });
+} /* EventHandler::callInMainThreadAndWait */
 
-const string EventHandler::eventResult(void) const
+
+void EventHandler::flushMainThreadCalls(void)
 {
-  if (interp == 0)
+    // All calls made by one event are handed over together so that the
+    // main thread see them at the same time, just like when TCL is run in
+    // the main thread
+  if (pending_calls.empty())
   {
-    return 0;
+    return;
   }
-  
-  return Tcl_GetStringResult(interp);
-  
-} /* EventHandler::eventResult */
+  std::vector<std::function<void(void)>> calls;
+  calls.swap(pending_calls);
+  {
+    std::lock_guard<std::mutex> lk(main_mutex);
+    main_calls.push_back({[calls]{ for (auto& call : calls) { call(); } },
+                          nullptr});
+  }
+  main_cond.notify_all();
+  worker->runInMainThread([this]{ runMainThreadCalls(); });
+} /* EventHandler::flushMainThreadCalls */
 
 
-/****************************************************************************
- *
- * Protected member functions
- *
- ****************************************************************************/
+void EventHandler::runMainThreadCalls(void)
+{
+  std::deque<MainThreadCall> calls;
+  {
+    std::lock_guard<std::mutex> lk(main_mutex);
+    calls.swap(main_calls);
+  }
+  for (auto& call : calls)
+  {
+    if (!stopping)
+    {
+      call.func();
+    }
+    if (call.done != nullptr)
+    {
+      std::lock_guard<std::mutex> lk(main_mutex);
+      *call.done = true;
+      main_cond.notify_all();
+    }
+  }
+} /* EventHandler::runMainThreadCalls */
 
 
-/*
- *------------------------------------------------------------------------
- * Method:    
- * Purpose:   
- * Input:     
- * Output:    
- * Author:    
- * Created:   
- * Remarks:   
- * Bugs:      
- *------------------------------------------------------------------------
- */
+int EventHandler::splitEvent(const std::string& event, const std::string& name,
+                             Tcl_Obj *objv[])
+{
+    // Only events that are a plain list of space separated words are
+    // split. Anything that the TCL parser would treat specially is left for
+    // Tcl_Eval to handle.
+  if (name.empty() || (name[0] == '#') ||
+      (event.find_first_of("$[]{}\\\";\t\r\n") != string::npos))
+  {
+    return 0;
+  }
+
+  int objc = 0;
+  objv[objc++] = cmdObj(name);
+  string::size_type pos = name.size();
+  while (pos < event.size())
+  {
+    string::size_type end = event.find(' ', pos);
+    if (end == string::npos)
+    {
+      end = event.size();
+    }
+    if (end > pos)
+    {
+      if (objc == MAX_EVENT_WORDS)
+      {
+        for (int i=1; i<objc; ++i)
+        {
+          Tcl_DecrRefCount(objv[i]);
+        }
+        return 0;
+      }
+      objv[objc] = Tcl_NewStringObj(event.data() + pos, end - pos);
+      Tcl_IncrRefCount(objv[objc]);
+      ++objc;
+    }
+    pos = end + 1;
+  }
 
+  return objc;
+} /* EventHandler::splitEvent */
 
 
+Tcl_Obj *EventHandler::cmdObj(const std::string& name)
+{
+    // TCL cache the command lookup in the object so it is reused for all
+    // calls to the same event handler function
+  CmdObjMap::iterator it = cmd_objs.find(name);
+  if (it == cmd_objs.end())
+  {
+    Tcl_Obj *obj = Tcl_NewStringObj(name.data(), name.size());
+    Tcl_IncrRefCount(obj);
+    it = cmd_objs.insert(std::make_pair(name, obj)).first;
+  }
+  return it->second;
+} /* EventHandler::cmdObj */
 
 
+void EventHandler::updateEventStats(const std::string& name,
+                                    std::chrono::microseconds duration)
+{
+  std::lock_guard<std::mutex> lk(main_mutex);
+  EventStats& stats = event_stats[name];
+  stats.count += 1;
+  stats.total += duration;
+  if (duration > stats.max)
+  {
+    stats.max = duration;
+  }
+  if (duration.count() > 1000L * SLOW_EVENT_THRESHOLD_MS)
+  {
+    std::cerr << "*** WARNING[" << logic_name << "]: Handling event \""
+              << name << "\" took " << duration.count() / 1000 << "ms ("
+              << stats.count << " calls, average "
+              << stats.total.count() / stats.count / 1000 << "ms, max "
+              << stats.max.count() / 1000 << "ms)" << std::endl;
+  }
+} /* EventHandler::updateEventStats */
 
-/****************************************************************************
- *
- * Private member functions
- *
- ****************************************************************************/
 
 int EventHandler::playFileHandler(ClientData cdata, Tcl_Interp *irp, int argc,
       	      	      	   const char *argv[])
@@ -303,7 +599,7 @@ int EventHandler::playFileHandler(ClientData cdata, Tcl_Interp *irp, int argc,
 
   EventHandler *self = static_cast<EventHandler *>(cdata);
   string filename(argv[1]);
-  self->playFile(filename);
+  self->callInMainThread([self, filename]{ self->playFile(filename); });
 
   return TCL_OK;
 }
@@ -321,7 +617,8 @@ int EventHandler::playSilenceHandler(ClientData cdata, Tcl_Interp *irp,
   //cout << "EventHandler::playSilence: " << argv[1] << endl;
 
   EventHandler *self = static_cast<EventHandler *>(cdata);
-  self->playSilence(atoi(argv[1]));
+  int duration = atoi(argv[1]);
+  self->callInMainThread([self, duration]{ self->playSilence(duration); });
 
   return TCL_OK;
 }
@@ -339,7 +636,13 @@ int EventHandler::playToneHandler(ClientData cdata, Tcl_Interp *irp,
   //cout << "EventHandler::playTone: " << argv[1] << endl;
 
   EventHandler *self = static_cast<EventHandler *>(cdata);
-  self->playTone(atoi(argv[1]), atoi(argv[2]), atoi(argv[3]));
+  int fq = atoi(argv[1]);
+  int amp = atoi(argv[2]);
+  int duration = atoi(argv[3]);
+  self->callInMainThread([self, fq, amp, duration]
+      {
+        self->playTone(fq, amp, duration);
+      });
 
   return TCL_OK;
 }
@@ -364,7 +667,11 @@ int EventHandler::recordHandler(ClientData cdata, Tcl_Interp *irp,
     {
       max_time = atoi(argv[2]);
     }
-    self->recordStart(argv[1], max_time);
+    string filename(argv[1]);
+    self->callInMainThread([self, filename, max_time]
+        {
+          self->recordStart(filename, max_time);
+        });
   }
   else
   {
@@ -376,7 +683,7 @@ int EventHandler::recordHandler(ClientData cdata, Tcl_Interp *irp,
     }
 
     EventHandler *self = static_cast<EventHandler *>(cdata);
-    self->recordStop();
+    self->callInMainThread([self]{ self->recordStop(); });
   }
   
 
@@ -395,7 +702,10 @@ int EventHandler::deactivateModuleHandler(ClientData cdata, Tcl_Interp *irp,
   }
 
   EventHandler *self = static_cast<EventHandler *>(cdata);
-  Application::app().runTask(self->deactivateModule.make_slot());
+  self->callInMainThread([self]
+      {
+        Application::app().runTask(self->deactivateModule.make_slot());
+      });
 
   return TCL_OK;
 }
@@ -412,7 +722,12 @@ int EventHandler::publishStateEventHandler(ClientData cdata, Tcl_Interp *irp,
   }
 
   EventHandler *self = static_cast<EventHandler *>(cdata);
-  self->publishStateEvent(argv[1], argv[2]);
+  string event_name(argv[1]);
+  string event_msg(argv[2]);
+  self->callInMainThread([self, event_name, event_msg]
+      {
+        self->publishStateEvent(event_name, event_msg);
+      });
 
   return TCL_OK;
 }
@@ -430,12 +745,62 @@ int EventHandler::playDtmfHandler(ClientData cdata, Tcl_Interp *irp,
   //cout << "EventHandler::playDtmf: " << argv[1] << ", "
   //    << argv[2] << ", " << argv[3]<< endl;
   EventHandler *self = static_cast<EventHandler *>(cdata);
-  self->playDtmf(argv[1], atoi(argv[2]), atoi(argv[3]));
+  string digits(argv[1]);
+  int amp = atoi(argv[2]);
+  int duration = atoi(argv[3]);
+  self->callInMainThread([self, digits, amp, duration]
+      {
+        self->playDtmf(digits, amp, duration);
+      });
 
   return TCL_OK;
 } /* EventHandler::playDtmfHandler */
 
 
+int EventHandler::sequenceHandler(ClientData cdata, Tcl_Interp *irp,
+                                  int argc, const char *argv[])
+{
+  EventHandler *self = static_cast<EventHandler *>(cdata);
+  if (strcmp(argv[0], "beginSequence") == 0)
+  {
+    if (argc != 2)
+    {
+      static char msg[] = "Usage: beginSequence <key>";
+      Tcl_SetResult(irp, msg, TCL_STATIC);
+      return TCL_ERROR;
+    }
+
+      // Without a connected slot the messages are always played
+    bool play = true;
+    string key(argv[1]);
+    self->callInMainThreadAndWait([self, &key, &play]
+        {
+          if (!self->beginSequence.empty())
+          {
+            play = self->beginSequence(key);
+          }
+        });
+    static char play_msg[] = "1";
+    static char skip_msg[] = "0";
+    Tcl_SetResult(irp, play ? play_msg : skip_msg, TCL_STATIC);
+  }
+  else
+  {
+    if (argc > 2)
+    {
+      static char msg[] = "Usage: endSequence [store]";
+      Tcl_SetResult(irp, msg, TCL_STATIC);
+      return TCL_ERROR;
+    }
+
+    bool store = (argc < 2) || (atoi(argv[1]) != 0);
+    self->callInMainThread([self, store]{ self->endSequence(store); });
+  }
+
+  return TCL_OK;
+} /* EventHandler::sequenceHandler */
+
+
 int EventHandler::injectDtmfHandler(ClientData cdata, Tcl_Interp *irp,
                                     int argc, const char *argv[])
 {
@@ -453,7 +818,10 @@ int EventHandler::injectDtmfHandler(ClientData cdata, Tcl_Interp *irp,
   }
   //cout << "EventHandler::injectDtmf: " << digits << ", " << duration << endl;
   EventHandler *self = static_cast<EventHandler *>(cdata);
-  self->injectDtmf(digits, duration);
+  self->callInMainThread([self, digits, duration]
+      {
+        self->injectDtmf(digits, duration);
+      });
 
   return TCL_OK;
 } /* EventHandler::injectDtmfHandler */
@@ -476,7 +844,12 @@ int EventHandler::getConfigValueHandler(ClientData cdata, Tcl_Interp *irp,
     value = argv[3];
   }
   EventHandler *self = static_cast<EventHandler*>(cdata);
-  if (!self->getConfigValue(section, tag, value))
+  bool found = false;
+  self->callInMainThreadAndWait([self, &section, &tag, &value, &found]
+      {
+        found = self->getConfigValue(section, tag, value);
+      });
+  if (!found)
   {
     static char msg[] = "getConfigValue: Failed to read configuration variable";
     Tcl_SetResult(irp, msg, TCL_STATIC);
@@ -507,7 +880,10 @@ int EventHandler::setConfigValueHandler(ClientData cdata, Tcl_Interp *irp,
   //std::cout << "### EventHandler::setConfigValueHandler: " << section << "/"
   //          << tag << "=" << value << std::endl;
   EventHandler *self = static_cast<EventHandler *>(cdata);
-  self->setConfigValue(section, tag, value);
+  self->callInMainThread([self, section, tag, value]
+      {
+        self->setConfigValue(section, tag, value);
+      });
 
   return TCL_OK;
 } /* EventHandler::setConfigValueHandler */
@@ -516,8 +892,12 @@ int EventHandler::setConfigValueHandler(ClientData cdata, Tcl_Interp *irp,
 int EventHandler::genericCommandHandler(ClientData cdata, Tcl_Interp *irp,
                                         int argc, const char *argv[])
 {
-  const auto& func = *static_cast<CommandHandler*>(cdata);
-  std::string msg = func(argc, argv);
+  const auto& cmd = *static_cast<GenericCommand*>(cdata);
+  std::string msg;
+  cmd.self->callInMainThreadAndWait([&cmd, &msg, argc, argv]
+      {
+        msg = cmd.func(argc, argv);
+      });
   if (!msg.empty())
   {
     auto msg_alloc_len = msg.size()+1;
@@ -40,6 +40,13 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 #include <string>
 #include <sstream>
 #include <functional>
+#include <chrono>
+#include <map>
+#include <deque>
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <condition_variable>
 
 
 /****************************************************************************
@@ -64,6 +71,10 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
  *
  ****************************************************************************/
 
+namespace Async
+{
+  class WorkerPool;
+};
 
 
 /****************************************************************************
@@ -116,10 +127,33 @@ class EventHandler : public sigc::trackable
   public:
     using CommandHandler = std::function<std::string(int argc, const char *argv[])>;
 
+    /**
+     * @brief Timing statistics for one event handler
+     */
+    struct EventStats
+    {
+      unsigned long             count = 0;  //!< Number of calls
+      std::chrono::microseconds total{0};   //!< Total time spent in handler
+      std::chrono::microseconds max{0};     //!< Longest time for one call
+    };
+    using EventStatsMap = std::map<std::string, EventStats>;
+
     /**
      * @brief 	Constuctor
+     * @param   event_script  The path to the TCL event script
+     * @param   logic_name    The name of the logic that own this handler
+     * @param   threaded      Set to \em true to run TCL in its own thread
+     *
+     * When threaded is \em true, the TCL interpreter is created in and only
+     * used from a thread of its own. Events and variable updates are then
+     * queued to that thread in order and the calls that the TCL script make
+     * to play audio, read or write configuration variables and so on are
+     * sent back to the main thread. This way a slow TCL event handler, e.g.
+     * one that run an external program, does not stall the audio handling
+     * in the main thread.
      */
-    EventHandler(const std::string& event_script, const std::string& logic_name);
+    EventHandler(const std::string& event_script, const std::string& logic_name,
+                 bool threaded=false);
 
     /**
      * @brief 	Destructor
@@ -178,8 +212,39 @@ class EventHandler : public sigc::trackable
      * @brief 	Process the given event
      * @param 	event The event must be a valid TCL function call
      * @return	Returns \em true on success or else \em false
+     *
+     * Most events are just a command name followed by a couple of simple
+     * arguments. Such events are split into words here and the TCL command is
+     * called directly, using a cached command object, so that the TCL
+     * interpreter does not have to parse the event as a script each time.
+     * Events containing quoting or substitution characters are evaluated as
+     * a TCL script, just like before.
+     *
+     * When running TCL in a thread of its own the event is just queued and
+     * \em true is returned.
      */
     bool processEvent(const std::string& event);
+
+    /**
+     * @brief   Process the given event and wait for it to be handled
+     * @param   event The event must be a valid TCL function call
+     * @return  Returns \em true on success or else \em false
+     *
+     * This function is used for events where the result from the TCL
+     * function, as returned by eventResult, is needed. When running TCL in a
+     * thread of its own, the main thread is blocked until the event has been
+     * handled so it should only be used for events that are rare.
+     */
+    bool processEventAndWait(const std::string& event);
+
+    /**
+     * @brief   Get the timing statistics for all processed events
+     * @return  Returns a map from event name to statistics
+     *
+     * The event name is the first word of the event, i.e. the name of the
+     * TCL function called.
+     */
+    EventStatsMap eventStats(void) const;
   
     /**
      * @brief 	Return the event result from the last call
@@ -219,6 +284,22 @@ class EventHandler : public sigc::trackable
      */
     sigc::signal<void(const std::string&, int, int)> playDtmf;
 
+    /**
+     * @brief 	A signal that is emitted when the TCL script begin a cached
+     *	      	sequence of messages
+     * @param 	key The key that identify the sequence
+     * @return  Return \em true if the messages in the sequence should be
+     *          queued or \em false if a cached rendering was queued
+     */
+    sigc::signal<bool(const std::string&)> beginSequence;
+
+    /**
+     * @brief 	A signal that is emitted when the TCL script end a cached
+     *	      	sequence of messages
+     * @param 	store Set to \em false if the sequence should not be cached
+     */
+    sigc::signal<void(bool)> endSequence;
+
     /**
      * @brief 	A signal that is emitted when the TCL script want to start
      *	      	a recording
@@ -278,9 +359,50 @@ class EventHandler : public sigc::trackable
   protected:
 
   private:
+    using CmdObjMap = std::map<std::string, Tcl_Obj*>;
+    struct GenericCommand
+    {
+      EventHandler*   self;
+      CommandHandler  func;
+    };
+    struct MainThreadCall
+    {
+      std::function<void(void)> func;
+      bool*                     done;
+    };
+
+    static const int      MAX_EVENT_WORDS         = 16;
+    static const unsigned SLOW_EVENT_THRESHOLD_MS = 100;
+
     std::string   event_script;
     std::string   logic_name;
     Tcl_Interp *  interp;
+    CmdObjMap     cmd_objs;
+    EventStatsMap event_stats;
+    std::string   event_result;
+    bool          stopping = false;
+
+    mutable std::mutex                      main_mutex;
+    std::condition_variable                 main_cond;
+    std::deque<MainThreadCall>              main_calls;
+    std::vector<std::function<void(void)>>  pending_calls;
+    std::unique_ptr<Async::WorkerPool>      worker;
+
+    void createInterp(void);
+    void deleteInterp(void);
+    bool evalEvent(const std::string& event);
+    void runInTclThread(std::function<void(void)> func);
+    void runInTclThreadAndWait(std::function<void(void)> func);
+    void callInMainThread(std::function<void(void)> func);
+    void callInMainThreadAndWait(std::function<void(void)> func);
+    void flushMainThreadCalls(void);
+    void runMainThreadCalls(void);
+
+    int splitEvent(const std::string& event, const std::string& name,
+                   Tcl_Obj *objv[]);
+    Tcl_Obj *cmdObj(const std::string& name);
+    void updateEventStats(const std::string& name,
+                          std::chrono::microseconds duration);
 
     static int playFileHandler(ClientData cdata, Tcl_Interp *irp,
       	      	    int argc, const char *argv[]);
@@ -296,6 +418,8 @@ class EventHandler : public sigc::trackable
       	            int argc, const char *argv[]);
     static int playDtmfHandler(ClientData cdata, Tcl_Interp *irp,
                     int argc, const char *argv[]);
+    static int sequenceHandler(ClientData cdata, Tcl_Interp *irp,
+                    int argc, const char *argv[]);
     static int injectDtmfHandler(ClientData cdata, Tcl_Interp *irp,
                     int argc, const char *argv[]);
     static int getConfigValueHandler(ClientData cdata, Tcl_Interp *irp,
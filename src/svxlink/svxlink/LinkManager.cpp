@@ -8,7 +8,7 @@
 
 \verbatim
 SvxLink - A Multi Purpose Voice Services System for Ham Radio Use
-Copyright (C) 2003-2021 Tobias Blomberg / SM0SVX
+Copyright (C) 2003-2026 Tobias Blomberg / SM0SVX
 
 This program is free software; you can redistribute it and/or modify
 it under the terms of the GNU General Public License as published by
@@ -41,6 +41,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 #include <algorithm>
 #include <iterator>
 #include <regex>
+#include <numeric>
 
 
 /****************************************************************************
@@ -101,6 +102,7 @@ namespace
  *
  ****************************************************************************/
 
+unsigned findGroupRoot(vector<unsigned>& parent, unsigned id);
 
 
 /****************************************************************************
@@ -127,6 +129,7 @@ namespace
  ****************************************************************************/
 
 LinkManager* LinkManager::_instance = 0;
+const unsigned LinkManager::NO_GROUP;
 
 
 /****************************************************************************
@@ -169,6 +172,7 @@ bool LinkManager::initialize(Async::Config &cfg,
       // Logic1:70:name1,Logic2:71:name2,...
     string connect_logics;
     cfg.getValue(link.name, "CONNECT_LOGICS", connect_logics);
+    link.connect_logics = connect_logics;
 
     vector<string> logic_specs;
     SvxLink::splitStr(logic_specs, connect_logics, ",");
@@ -213,56 +217,7 @@ bool LinkManager::initialize(Async::Config &cfg,
       init_ok = false;
     }
 
-    int timeout = -1;
-    cfg.getValue(link.name, "TIMEOUT", timeout);
-
-      // Automatically activate the link, if one (or more) logics
-      // has activity, e.g. squelch open, announcement activity etc.
-    string activate_on_activity;
-    if (cfg.getValue(link.name, "AUTOACTIVATE_ON_SQL", activate_on_activity))
-    {
-      std::cerr << "*** WARNING: Configuration variable " << link.name
-                << "/AUTOACTIVATE_ON_SQL has been renamed to "
-                   "ACTIVATE_ON_ACTIVITY"
-                << std::endl;
-      cfg.setValue(link.name, "ACTIVATE_ON_ACTIVITY", activate_on_activity);
-    }
-    if (cfg.getValue(link.name, "ACTIVATE_ON_ACTIVITY", activate_on_activity))
-    {
-      SvxLink::splitStr(link.auto_activate, activate_on_activity, ",");
-
-        // An automatically connected link should be disconnected after a
-        // while so the TIMEOUT configuration variable must be set.
-      if (timeout <= 0)
-      {
-        std::cerr << "*** WARNING: missing param " << link.name
-                  << "/TIMEOUT=??, set to default (30 sec)" << std::endl;
-        timeout = 30;
-      }
-    }
-
-    if (cfg.getValue(link.name, "ACTIVATE_ON_TG", link.auto_activate_on_tg))
-    {
-        // An automatically connected link should be disconnected after a
-        // while so the TIMEOUT configuration variable must be set.
-      if (timeout <= 0)
-      {
-        std::cerr << "*** WARNING: Missing configuration " << link.name
-                  << "/TIMEOUT=??, setting to default (30 sec)" << std::endl;
-        timeout = 30;
-      }
-    }
-
-    if (timeout > 0)
-    {
-      link.timeout_timer = new Timer(1000 * timeout);
-      link.timeout_timer->setEnable(false);
-      link.timeout_timer->expired.connect(sigc::bind(
-          mem_fun(*LinkManager::instance(), &LinkManager::linkTimeout),
-          &link));
-    }
-
-    cfg.getValue(link.name, "DEFAULT_ACTIVE", link.default_active);
+    LinkManager::instance()->configureLink(cfg, link);
   }
 
   if(!init_ok)
@@ -275,6 +230,39 @@ bool LinkManager::initialize(Async::Config &cfg,
 } /* LinkManager::initialize */
 
 
+void LinkManager::configReloaded(Async::Config &cfg,
+                                 const std::set<std::string>& changed_sections)
+{
+  for (auto& entry : links)
+  {
+    Link &link = entry.second;
+    if (changed_sections.count(link.name) == 0)
+    {
+      continue;
+    }
+
+    std::cout << "Reloading configuration for link '" << link.name << "'"
+              << std::endl;
+    string connect_logics;
+    cfg.getValue(link.name, "CONNECT_LOGICS", connect_logics);
+    if (connect_logics != link.connect_logics)
+    {
+      std::cerr << "*** WARNING: Changes to " << link.name
+                << "/CONNECT_LOGICS will not take effect until SvxLink is "
+                   "restarted" << std::endl;
+    }
+
+    bool was_default_active = link.default_active;
+    configureLink(cfg, link);
+    if (link.default_active && !was_default_active)
+    {
+      activateLink(link, "DEFAULT_ACTIVE");
+    }
+    checkTimeoutTimer(link);
+  }
+} /* LinkManager::configReloaded */
+
+
 void LinkManager::addLogic(LogicBase *logic)
 {
     // Make sure that we have not added this logic before
@@ -290,6 +278,7 @@ void LinkManager::addLogic(LogicBase *logic)
   logic->logicConOut()->registerSink(splitter);
 
     // Register the new logic source
+  sources[logic->name()].logic = logic;
   sources[logic->name()].source = logic->logicConOut();
   sources[logic->name()].splitter = splitter;
 
@@ -302,27 +291,25 @@ void LinkManager::addLogic(LogicBase *logic)
   sinks[logic->name()].sink = logic->logicConIn();
   sinks[logic->name()].selector = selector;
 
-    // Now create a connection from the new logic source to each sink.
-  for (SinkMap::iterator it=sinks.begin(); it != sinks.end(); ++it)
+    // The connections between the new logic and the other logics are
+    // created by setConnection when they are needed for the first time.
+
+    // Give the logic a numeric id, reusing the slot of a deleted logic if
+    // possible. The id is used to index the vectors used when calculating
+    // which logics to connect.
+  unsigned id = 0;
+  while ((id < logic_by_id.size()) && (logic_by_id[id] != 0))
   {
-    AudioPassthrough *connector = new AudioPassthrough;
-    splitter->addSink(connector, true);
-    AudioSelector *other_selector = (*it).second.selector;
-    other_selector->addSource(connector);
-    (*it).second.connectors[logic->name()] = connector;
+    ++id;
   }
-
-    // Now create a connection from each existing logic source to the new sink.
-  for (SourceMap::iterator it=sources.begin(); it!=sources.end(); ++it)
+  if (id == logic_by_id.size())
   {
-    AudioPassthrough *connector = new AudioPassthrough;
-    (*it).second.splitter->addSink(connector, true);
-    selector->addSource(connector);
-    sinks[logic->name()].connectors[(*it).first] = connector;
+    logic_by_id.push_back(0);
+    logic_group.push_back(NO_GROUP);
   }
 
     // Create new object containing metadata for this logic core
-  LogicInfo logic_info(logic);
+  LogicInfo logic_info(logic, id);
 
     // Keep track of the newly added logics idle state so that we can start
     // and stop timeout timers.
@@ -338,7 +325,24 @@ void LinkManager::addLogic(LogicBase *logic)
         sigc::mem_fun(*this, &LinkManager::onPublishStateEvent), logic));
 
     // Add the logic core to the logic map
-  logic_map.emplace(logic->name(), logic_info);
+  LogicInfo &info = logic_map.emplace(logic->name(), logic_info).first->second;
+  logic_by_id[id] = &info;
+  logic_group[id] = NO_GROUP;
+
+    // The new logic is not connected to any other logic yet so nobody
+    // listen to its audio
+  logic->logicConOutConsumersChanged(false);
+
+    // Find the links that this logic is a member of
+  for (auto& link_spec : links)
+  {
+    Link &link = link_spec.second;
+    if (link.logic_props.find(logic->name()) != link.logic_props.end())
+    {
+      link.logic_ids.push_back(id);
+      info.links.push_back(&link);
+    }
+  }
 
     // Create command objects associated with this logic
     // FIXME: We should not reference to a specific logic core type in this
@@ -391,16 +395,29 @@ void LinkManager::deleteLogic(LogicBase *logic)
   assert(logic_info.received_publish_state_event_con.connected());
   logic_info.received_publish_state_event_con.disconnect();
 
+    // Remove the logic from the links it is a member of
+  for (auto& link : logic_info.links)
+  {
+    LogicIdVec &ids = link->logic_ids;
+    ids.erase(std::remove(ids.begin(), ids.end(), logic_info.id), ids.end());
+  }
+  logic_by_id[logic_info.id] = 0;
+  logic_group[logic_info.id] = NO_GROUP;
+
     // Delete the logic source splitter and all connections associated with it
   AudioSplitter *splitter = sources[logic->name()].splitter;
   for (SinkMap::iterator smit=sinks.begin(); smit!=sinks.end(); ++smit)
   {
     SinkInfo &sink_info = (*smit).second;
     ConMap::iterator cmit = sink_info.connectors.find(logic->name());
-    assert(cmit != sink_info.connectors.end());
+    if (cmit == sink_info.connectors.end())
+    {
+      continue;
+    }
     AudioPassthrough *connector = (*cmit).second;
     sink_info.selector->removeSource(connector);
     sink_info.connectors.erase(logic->name());
+    connector_src.erase(connector);
     splitter->removeSink(connector);
     //delete connector;
   }
@@ -414,6 +431,7 @@ void LinkManager::deleteLogic(LogicBase *logic)
   {
     AudioPassthrough *connector = (*cmit).second;
     selector->removeSource(connector);
+    connector_src.erase(connector);
     const string &source_name = (*cmit).first;
     sources[source_name].splitter->removeSink(connector);
     //delete connector;
@@ -516,18 +534,14 @@ string LinkManager::cmdReceived(LinkRef link, LogicBase *logic,
 
 LogicBase *LinkManager::currentTalkerFor(const std::string& logic_name)
 {
-  AudioSelector *selector = sinks[logic_name].selector;
-  AudioSource *selected = selector->selectedSource();
-  const ConMap& con_map = sinks[logic_name].connectors;
-  for (ConMap::const_iterator it = con_map.begin(); it != con_map.end(); ++it)
+  SinkMap::const_iterator it = sinks.find(logic_name);
+  if (it == sinks.end())
   {
-    if (it->second == selected)
-    {
-      //cout << "### Selected source: " << it->first << endl;
-      return logic_map.at(it->first).logic;
-    }
+    return 0;
   }
-  return 0;
+  ConnectorSrcMap::const_iterator cit =
+    connector_src.find(it->second.selector->selectedSource());
+  return (cit != connector_src.end()) ? cit->second : 0;
 } /* LinkManager::currentTalkerFor */
 
 
@@ -538,9 +552,9 @@ void LinkManager::setLogicMute(const LogicBase *logic, bool mute)
   {
     info.is_muted = mute;
     updateConnections();
-    for (const auto& link_name : getLinkNames(logic->name()))
+    for (auto& link : info.links)
     {
-      checkTimeoutTimer(links.at(link_name));
+      checkTimeoutTimer(*link);
     }
   }
 } /* LinkManager::setLogicMute */
@@ -640,148 +654,231 @@ LinkManager::~LinkManager(void)
 } /* LinkManager::~LinkManager */
 
 
+void LinkManager::configureLink(Async::Config &cfg, Link &link)
+{
+  link.auto_activate.clear();
+  link.auto_activate_on_tg.clear();
+  delete link.timeout_timer;
+  link.timeout_timer = 0;
+  link.default_active = false;
+
+  int timeout = -1;
+  cfg.getValue(link.name, "TIMEOUT", timeout);
+
+    // Automatically activate the link, if one (or more) logics
+    // has activity, e.g. squelch open, announcement activity etc.
+  string activate_on_activity;
+  if (cfg.getValue(link.name, "AUTOACTIVATE_ON_SQL", activate_on_activity))
+  {
+    std::cerr << "*** WARNING: Configuration variable " << link.name
+              << "/AUTOACTIVATE_ON_SQL has been renamed to "
+                 "ACTIVATE_ON_ACTIVITY"
+              << std::endl;
+    cfg.setValue(link.name, "ACTIVATE_ON_ACTIVITY", activate_on_activity);
+  }
+  if (cfg.getValue(link.name, "ACTIVATE_ON_ACTIVITY", activate_on_activity))
+  {
+    SvxLink::splitStr(link.auto_activate, activate_on_activity, ",");
+
+      // An automatically connected link should be disconnected after a
+      // while so the TIMEOUT configuration variable must be set.
+    if (timeout <= 0)
+    {
+      std::cerr << "*** WARNING: missing param " << link.name
+                << "/TIMEOUT=??, set to default (30 sec)" << std::endl;
+      timeout = 30;
+    }
+  }
+
+  if (cfg.getValue(link.name, "ACTIVATE_ON_TG", link.auto_activate_on_tg))
+  {
+      // An automatically connected link should be disconnected after a
+      // while so the TIMEOUT configuration variable must be set.
+    if (timeout <= 0)
+    {
+      std::cerr << "*** WARNING: Missing configuration " << link.name
+                << "/TIMEOUT=??, setting to default (30 sec)" << std::endl;
+      timeout = 30;
+    }
+  }
+
+  if (timeout > 0)
+  {
+    link.timeout_timer = new Timer(1000 * timeout);
+    link.timeout_timer->setEnable(false);
+    link.timeout_timer->expired.connect(sigc::bind(
+        mem_fun(*this, &LinkManager::linkTimeout),
+        &link));
+  }
+
+  cfg.getValue(link.name, "DEFAULT_ACTIVE", link.default_active);
+} /* LinkManager::configureLink */
+
+
 /**
  * @brief Find out which logics that should be connected
- * @param want The connections we want
+ * @param group The wanted group for each logic id
  *
  * This function will calculate which logic connections that should currently
  * be established to get the correct audio flow in the currently activated
- * logic links. It will not set up the logic connections though so the caller
- * have to figure out which currently active connections to break and which to
- * establish to get to the set of connections reported by this function.
+ * logic links. Logics that are connected to each other, directly in a link or
+ * implicitly via other logics, form a group. All logics in a group should be
+ * connected to each other. The group of each logic is identified by a
+ * representative logic id, or NO_GROUP if the logic should not be connected
+ * to any other logic. A union-find is used to join logics into groups so the
+ * cost grow linearly with the number of logics in the active links.
  */
-void LinkManager::wantedConnections(LogicConSet &want)
+void LinkManager::wantedGroups(LogicIdVec &group)
 {
-    // Fill "want" with the base set of connections that are explicitly
-    // specified in the link configuration for active links. The connection
-    // graph will not be complete if two links share one or more logics. This
-    // will be solved in the next step below.
-  for (LinkMap::iterator lit = links.begin(); lit != links.end(); ++lit)
-  {
-    Link &link = (*lit).second;
-    if (link.is_activated)
-    {
-        // oit=outer iterator
-      for (LogicPropMap::iterator oit = link.logic_props.begin();
-           oit != link.logic_props.end();
-           ++oit)
+  LogicIdVec parent(logic_by_id.size());
+  std::iota(parent.begin(), parent.end(), 0);
+  vector<bool> is_linked(logic_by_id.size(), false);
+
+  for (auto& link_spec : links)
+  {
+    const Link &link = link_spec.second;
+    if (!link.is_activated)
+    {
+      continue;
+    }
+    unsigned first_id = NO_GROUP;
+    for (auto id : link.logic_ids)
+    {
+      if (logic_by_id[id]->is_muted)
       {
-          // iit=inner iterator
-        LogicPropMap::iterator iit = oit;
-        for (++iit; iit != link.logic_props.end(); ++iit)
-        {
-          const std::string& l1_name = (*oit).first;
-          const std::string& l2_name = (*iit).first;
-          const LogicInfo &l1_info = logic_map.at(l1_name);
-          const LogicInfo &l2_info = logic_map.at(l2_name);
-          if ((l1_name != l2_name) && !l1_info.is_muted && !l2_info.is_muted)
-          {
-            want.insert(make_pair(l1_name, l2_name));
-            want.insert(make_pair(l2_name, l1_name));
-          }
-        }
+        continue;
+      }
+      if (first_id == NO_GROUP)
+      {
+        first_id = id;
+        continue;
       }
+      unsigned root1 = findGroupRoot(parent, first_id);
+      unsigned root2 = findGroupRoot(parent, id);
+      parent[root2] = root1;
+      is_linked[first_id] = true;
+      is_linked[id] = true;
     }
   }
 
-    // Now we need to complete the graph with connections between logics that
-    // are implicitly connected. That is, logics that are connected to each
-    // other via other logics.
-    //
-    // The algoritm below is not very optimized but that should not be needed
-    // since SvxLink most often just have a few logics defined. If a lot of
-    // logics is used, the code below may have to be optimized.
-    //
-    // The outer loop (do {} while) is needed since new connections may be
-    // added and then new implicit connections may appear. We are done when
-    // all connections have been gone through and no new connections was
-    // added.
-  size_t prev_size;
-  do
-  {
-      // Store the current size of the connection set so that we can check
-      // later if new connections have been added.
-    prev_size = want.size();
-
-      // Now compare all connections to each other. This requires two loops,
-      // an outer (oit=outer iterator) and an inner (iit=inner iterator).
-    for (LogicConSet::iterator oit = want.begin();
-         oit != want.end();
-         ++oit)
-    {
-      for (LogicConSet::iterator iit = want.begin();
-           iit != want.end();
-           ++iit)
-      {
-          // If the sink of the outer connection belongs to the same logic
-          // as the source of the inner connection, then we need to also
-          // connect the source of the outer connection to the sink of the
-          // inner connection. To exemplify, if the set contains the
-          // connections: <L1,L2>,<L2,L3> we also need to add <L1,L3> since
-          // L1 is implicitly connected to L3 via L2.
-          // The comparison below also make sure that a connection is not
-          // added which connect back to the same logic. To exemplify this,
-          // if the set contains the connections: <L1,L2>,<L2,L1> we should
-          // not connect <L1,L1>.
-        if ((oit->second == iit->first) && (oit->first != iit->second))
-        {
-          want.insert(make_pair(oit->first, iit->second));
-        }
-      }
+  group.assign(logic_by_id.size(), NO_GROUP);
+  for (unsigned id=0; id<group.size(); ++id)
+  {
+    if (is_linked[id])
+    {
+      group[id] = findGroupRoot(parent, id);
     }
-  } while (want.size() > prev_size);
-} /* LinkManager::wantedConnections */
+  }
+} /* LinkManager::wantedGroups */
 
 
 void LinkManager::updateConnections(void)
 {
-    // Get the wanted logic connections based on which links that are activated
-  LogicConSet want;
-  wantedConnections(want);
+    // Get the wanted logic groups based on which links that are activated
+  LogicIdVec want;
+  wantedGroups(want);
+
+    // Only logics that have changed group can have changed connections. The
+    // group id itself carry no meaning, only which logics share it, so the
+    // connections to all other logics must be checked for those logics.
+  LogicIdVec changed;
+  for (unsigned id=0; id<want.size(); ++id)
+  {
+    if (want[id] != logic_group[id])
+    {
+      changed.push_back(id);
+    }
+  }
+  if (changed.empty())
+  {
+    return;
+  }
 
-    // Calculate which of the current connections should be broken.
-    // This is easily done with a simple difference set operation.
-    // After this operation the "to_disconnect" variable will contain
-    // the set of logic connections that have to be broken.
-  LogicConSet to_disconnect;
-  set_difference(current_cons.begin(), current_cons.end(),
-                 want.begin(), want.end(),
-                 inserter(to_disconnect, to_disconnect.end()));
+  auto is_connected = [](const LogicIdVec& group, unsigned id1, unsigned id2)
+  {
+    return (id1 != id2) && (group[id1] != NO_GROUP) &&
+           (group[id1] == group[id2]);
+  };
 
-  for (auto it = to_disconnect.begin(); it != to_disconnect.end(); ++it)
+    // Break the connections that are not wanted anymore before establishing
+    // the new ones. Each pair of logics is only checked once.
+  for (bool connect : {false, true})
   {
-    const string &src_name = it->first;
-    const string &sink_name = it->second;
-    SinkInfo &sink = sinks.at(sink_name);
+    for (auto id : changed)
+    {
+      for (unsigned other=0; other<want.size(); ++other)
+      {
+        if ((logic_by_id[other] == 0) ||
+            ((other < id) && (want[other] != logic_group[other])))
+        {
+          continue;
+        }
+        bool was_connected = is_connected(logic_group, id, other);
+        if ((is_connected(want, id, other) == connect) &&
+            (was_connected != connect))
+        {
+          setConnection(id, other, connect);
+          setConnection(other, id, connect);
+        }
+      }
+    }
+  }
 
-      // Disconnect the audio path from source logic to sink logic
-    sink.selector->disableAutoSelect(sink.connectors.at(src_name));
+  logic_group.swap(want);
 
-      // Delete the link connect information
-    current_cons.erase(*it);
+    // A logic is only connected to other logics while it is part of a
+    // group. Tell the logics that got or lost all their connections.
+  for (auto id : changed)
+  {
+    if ((logic_by_id[id] != 0) &&
+        ((want[id] == NO_GROUP) != (logic_group[id] == NO_GROUP)))
+    {
+      logic_by_id[id]->logic->logicConOutConsumersChanged(
+          logic_group[id] != NO_GROUP);
+    }
   }
+} /* LinkManager::updateConnections */
 
-    // Calculate the difference between the wanted connection set and the
-    // current connection set. This is easily done using the difference set
-    // operation. After this operation the "to_connect" variable will contain
-    // the set of logic connections that have to be established.
-  LogicConSet to_connect;
-  set_difference(want.begin(), want.end(),
-                 current_cons.begin(), current_cons.end(),
-                 inserter(to_connect, to_connect.end()));
 
-    // Establish missing connections
-  for (auto it = to_connect.begin(); it != to_connect.end(); ++it)
+void LinkManager::setConnection(unsigned src_id, unsigned sink_id,
+                                bool connect)
+{
+  const string &src_name = logic_by_id[src_id]->logic->name();
+  SourceInfo &source = sources.at(src_name);
+  SinkInfo &sink = sinks.at(logic_by_id[sink_id]->logic->name());
+  ConMap::iterator it = sink.connectors.find(src_name);
+  if (it == sink.connectors.end())
   {
-    const string &src_name = it->first;
-    const string &sink_name = it->second;
-    SinkInfo &sink = sinks.at(sink_name);
-    sink.selector->enableAutoSelect(sink.connectors.at(src_name), 0);
+    if (!connect)
+    {
+      return;
+    }
 
-      // Store all connections in "current_cons" (current connections)
-    current_cons.insert(*it);
+      // Create the audio path from the source logic to the sink logic the
+      // first time the two logics are connected. Logics that never get
+      // connected to each other do not need any path at all.
+    AudioPassthrough *connector = new AudioPassthrough;
+    source.splitter->addSink(connector, true);
+    sink.selector->addSource(connector);
+    it = sink.connectors.emplace(src_name, connector).first;
+    connector_src[connector] = source.logic;
   }
-} /* LinkManager::updateConnections */
+
+  AudioPassthrough *connector = it->second;
+  if (connect)
+  {
+    source.splitter->enableSink(connector, true);
+    sink.selector->enableAutoSelect(connector, 0);
+  }
+  else
+  {
+      // Disconnect the audio path from source logic to sink logic. The
+      // splitter branch is disabled so that no audio is passed on to a
+      // selector branch that cannot be selected.
+    sink.selector->disableAutoSelect(connector);
+    source.splitter->enableSink(connector, false);
+  }
+} /* LinkManager::setConnection */
 
 
 void LinkManager::activateLink(Link &link, const std::string& reason)
@@ -848,24 +945,6 @@ bool LinkManager::isConnected(const string& source_name,
 #endif
 
 
-/**
- * @brief Returns all linknames in that the specific logic is involved
- */
-vector<string> LinkManager::getLinkNames(const string& logicname)
-{
-  vector<string> linknames;
-  for (LinkMap::iterator it=links.begin(); it!=links.end(); ++it)
-  {
-    Link &link = (*it).second;
-    if (link.logic_props.find(logicname) != link.logic_props.end())
-    {
-      linknames.push_back(link.name);
-    }
-  }
-  return linknames;
-} /* LinkManager::getLinkNames */
-
-
 void LinkManager::linkTimeout(Async::Timer *t, Link *link)
 {
   if (link->is_activated && !link->default_active)
@@ -893,19 +972,14 @@ void LinkManager::logicIdleStateChanged(bool is_idle, const LogicBase *logic)
     return;
   }
 
-    // We need all linknames where the logic is included
-  vector<string> link_names = getLinkNames(logic->name());
+  LogicMap::const_iterator lmit = logic_map.find(logic->name());
+  assert(lmit != logic_map.end());
 
     // Loop through all links associated with the logic to see if we should
     // enable or disable any timeout timers.
-  for (std::vector<string>::iterator lnit = link_names.begin();
-       lnit != link_names.end();
-       ++lnit)
-  {
-    const string &link_name = *lnit;
-    LinkMap::iterator lmit = links.find(link_name);
-    assert(lmit != links.end());
-    Link &link = (*lmit).second;
+  for (auto& link_ptr : lmit->second.links)
+  {
+    Link &link = *link_ptr;
     
       // Check if the logic that updated its idle state is defined as a
       // "auto_activate" logic. If not idle, all logics of the link shall
@@ -1017,6 +1091,26 @@ void LinkManager::onPublishStateEvent(LogicBase *src_logic,
 } /* LinkManager::onPublishStateEvent */
 
 
+
+/****************************************************************************
+ *
+ * Local functions
+ *
+ ****************************************************************************/
+
+namespace {
+  unsigned findGroupRoot(vector<unsigned>& parent, unsigned id)
+  {
+    while (parent[id] != id)
+    {
+      parent[id] = parent[parent[id]];
+      id = parent[id];
+    }
+    return id;
+  } /* findGroupRoot */
+};
+
+
 /*
  * This file has not been truncated
  */
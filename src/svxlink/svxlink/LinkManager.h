@@ -8,7 +8,7 @@
 
 \verbatim
 SvxLink - A Multi Purpose Voice Services System for Ham Radio Use
-Copyright (C) 2003-2025 Tobias Blomberg / SM0SVX
+Copyright (C) 2003-2026 Tobias Blomberg / SM0SVX
 
 This program is free software; you can redistribute it and/or modify
 it under the terms of the GNU General Public License as published by
@@ -43,6 +43,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 #include <vector>
 #include <list>
 #include <set>
+#include <unordered_map>
 
 
 /****************************************************************************
@@ -220,6 +221,18 @@ class LinkManager : public sigc::trackable
      */
     void allLogicsStarted(void);
 
+    /**
+     * @brief   Called when the configuration has been reloaded
+     * @param   cfg The updated config object
+     * @param   changed_sections The configuration sections that changed
+     *
+     * The settings controlling when links are activated and deactivated are
+     * read again for all links that have a changed configuration section.
+     * The current activation state of the links is kept.
+     */
+    void configReloaded(Async::Config &cfg,
+                        const std::set<std::string>& changed_sections);
+
     /**
      * @brief   Called by the DTMF command handler upon command reception
      * @param   link The link object associated with this command
@@ -291,6 +304,7 @@ class LinkManager : public sigc::trackable
     };
     typedef std::map<std::string, LogicProperties> LogicPropMap;
     typedef std::set<std::string> StrSet;
+    typedef std::vector<unsigned> LogicIdVec;
     using StrPairVec = std::vector<SvxLink::SepPair<std::string, std::string>>;
     using StrPairMap = std::map<std::string, std::string>;
     struct Link
@@ -300,17 +314,19 @@ class LinkManager : public sigc::trackable
       ~Link(void) { delete timeout_timer; }
 
       std::string   name;
+      std::string   connect_logics;
       LogicPropMap  logic_props;
       StrSet        auto_activate;
       StrPairMap    auto_activate_on_tg;
       bool          default_active;
       bool          is_activated;
       Async::Timer  *timeout_timer;
+      LogicIdVec    logic_ids;
     };
     typedef std::map<std::string, Link> LinkMap;
-    typedef std::set<std::pair<std::string, std::string> > LogicConSet;
     struct SourceInfo
     {
+      LogicBase               *logic;
       Async::AudioSource      *source;
       Async::AudioSplitter    *splitter;
     };
@@ -323,10 +339,15 @@ class LinkManager : public sigc::trackable
     };
     typedef std::map<std::string, SourceInfo> SourceMap;
     typedef std::map<std::string, SinkInfo>   SinkMap;
+    typedef std::unordered_map<const Async::AudioSource*, LogicBase*>
+      ConnectorSrcMap;
     struct LogicInfo
     {
-      LogicInfo(LogicBase* logic) : logic(logic), is_muted(false) {}
+      LogicInfo(LogicBase* logic, unsigned id)
+        : logic(logic), id(id), is_muted(false) {}
       LogicBase         *logic;
+      unsigned          id;
+      std::vector<Link*> links;
       sigc::connection  idle_state_changed_con;
       sigc::connection  received_tg_update_con;
       sigc::connection  received_publish_state_event_con;
@@ -334,22 +355,27 @@ class LinkManager : public sigc::trackable
     };
     typedef std::map<std::string, LogicInfo> LogicMap;
 
+    static const unsigned NO_GROUP = ~0U;
+
     static LinkManager *_instance;
 
-    LinkMap     links;
-    LogicMap    logic_map;
-    LogicConSet current_cons;
-    SourceMap   sources;
-    SinkMap     sinks;
-    bool        all_logics_started;
+    LinkMap                 links;
+    LogicMap                logic_map;
+    std::vector<LogicInfo*> logic_by_id;
+    LogicIdVec              logic_group;
+    ConnectorSrcMap         connector_src;
+    SourceMap               sources;
+    SinkMap                 sinks;
+    bool                    all_logics_started;
 
     LinkManager(void) : all_logics_started(false) {};
     LinkManager(const LinkManager&);
     ~LinkManager(void);
 
-    std::vector<std::string> getLinkNames(const std::string& logicname);
-    void wantedConnections(LogicConSet &want);
+    void configureLink(Async::Config &cfg, Link &link);
+    void wantedGroups(LogicIdVec &group);
     void updateConnections(void);
+    void setConnection(unsigned src_id, unsigned sink_id, bool connect);
     void activateLink(Link &link, const std::string& reason="");
     void deactivateLink(Link &link, const std::string& reason="");
     void sendCmdToLogics(Link &link, LogicBase *src_logic,
@@ -10,7 +10,7 @@ specific logic core classes (e.g. SimplexLogic and RepeaterLogic).
 
 \verbatim
 SvxLink - A Multi Purpose Voice Services System for Ham Radio Use
-Copyright (C) 2003-2025 Tobias Blomberg / SM0SVX
+Copyright (C) 2003-2026 Tobias Blomberg / SM0SVX
 
 This program is free software; you can redistribute it and/or modify
 it under the terms of the GNU General Public License as published by
@@ -49,6 +49,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 #include <sstream>
 #include <map>
 #include <list>
+#include <set>
 #include <vector>
 
 
@@ -58,6 +59,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
  *
  ****************************************************************************/
 
+#include <AsyncApplication.h>
 #include <AsyncConfig.h>
 #include <AsyncTimer.h>
 #include <Rx.h>
@@ -75,6 +77,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 #include <AsyncAudioRecorder.h>
 #include <common.h>
 #include <config.h>
+#include <Metrics.h>
 
 
 /****************************************************************************
@@ -91,6 +94,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 #include "QsoRecorder.h"
 //#include "LinkManager.h"
 #include "DtmfDigitHandler.h"
+#include "LogicAudioStats.h"
 
 
 /****************************************************************************
@@ -170,7 +174,8 @@ Logic::Logic(void)
     currently_set_tx_ctrl_mode(Tx::TX_OFF), is_online(true),
     dtmf_digit_handler(0),                  state_pty(0),
     dtmf_ctrl_pty(0),                       command_pty(0),
-    m_ctcss_to_tg_timer(-1),                m_ctcss_to_tg_last_fq(-1.0f)
+    m_ctcss_to_tg_timer(-1),                m_ctcss_to_tg_last_fq(-1.0f),
+    m_state_event_timer(0, Timer::TYPE_ONESHOT, false)
 {
   rgr_sound_timer.expired.connect(sigc::hide(
         mem_fun(*this, &Logic::sendRgrSound)));
@@ -407,6 +412,13 @@ bool Logic::initialize(Async::Config& cfgobj, const std::string& logic_name)
   cfg().getValue(name(), "FX_GAIN_NORMAL", fx_gain_normal);
   cfg().getValue(name(), "FX_GAIN_LOW", fx_gain_low);
 
+    // Collect audio health statistics from the audio pipe
+  m_audio_stats = new LogicAudioStats;
+  m_audio_stats->collect.connect(mem_fun(*this, &Logic::collectAudioStats));
+  m_audio_stats->publishStats.connect(
+      mem_fun(*this, &Logic::onPublishStateEvent));
+  m_audio_stats->initialize(cfg(), name());
+
   AudioSource *prev_rx_src = 0;
 
     // Create the RX object
@@ -448,10 +460,17 @@ bool Logic::initialize(Async::Config& cfgobj, const std::string& logic_name)
   prev_rx_src->registerSink(rx_valve, true);
   prev_rx_src = rx_valve;
 
-    // Split the RX audio stream to multiple sinks
+    // Split the RX audio stream to multiple sinks. If AUDIO_BRANCH_BUFFER is
+    // set, each sink get a queue of its own so that a slow sink does not
+    // stall the audio to the others.
+  unsigned branch_buf_ms = 0;
+  cfg().getValue(name(), "AUDIO_BRANCH_BUFFER", branch_buf_ms);
+  const int branch_buf = branch_buf_ms * INTERNAL_SAMPLE_RATE / 1000;
   rx_splitter = new AudioSplitter;
+  rx_splitter->setMaxBranchBuffer(branch_buf);
   prev_rx_src->registerSink(rx_splitter, true);
   prev_rx_src = 0;
+  logic_con_in->setMaxBranchBuffer(branch_buf);
 
     // Create a selector for audio to the module
   audio_to_module_selector = new AudioSelector;
@@ -576,6 +595,7 @@ bool Logic::initialize(Async::Config& cfgobj, const std::string& logic_name)
     // Add a pre-buffered FIFO to avoid underrun
   AudioFifo *tx_fifo = new AudioFifo(1024 * INTERNAL_SAMPLE_RATE / 8000);
   tx_fifo->setPrebufSamples(512 * INTERNAL_SAMPLE_RATE / 8000);
+  tx_fifo->setStats(m_audio_stats->stats());
   prev_tx_src->registerSink(tx_fifo, true);
   prev_tx_src = tx_fifo;
 
@@ -598,6 +618,7 @@ bool Logic::initialize(Async::Config& cfgobj, const std::string& logic_name)
   tx().transmitterStateChange.connect(
       mem_fun(*this, &Logic::transmitterStateChange));
   tx().publishStateEvent.connect(mem_fun(*this, &Logic::onPublishStateEvent));
+  tx().setAudioStats(m_audio_stats->stats());
   prev_tx_src->registerSink(m_tx);
   prev_tx_src = 0;
 
@@ -606,6 +627,18 @@ bool Logic::initialize(Async::Config& cfgobj, const std::string& logic_name)
   msg_handler->allMsgsWritten.connect(mem_fun(*this, &Logic::allMsgsWritten));
   prev_tx_src = msg_handler;
 
+  bool preload_clips = false;
+  cfg().getValue("GLOBAL", "SOUND_CLIP_PRELOAD", preload_clips);
+  if (preload_clips)
+  {
+    std::string sound_dir(event_handler_str);
+    std::string::size_type slash = sound_dir.rfind('/');
+    sound_dir.erase((slash == std::string::npos) ? 0 : slash + 1);
+    std::string lang("en_US");
+    cfg().getValue(name(), "DEFAULT_LANG", lang);
+    MsgHandler::preloadClips(sound_dir + "sounds/" + lang);
+  }
+
     // This gain control is used to reduce the audio volume of effects
     // and announcements when mixed with normal audio
   fx_gain_ctrl = new AudioAmp;
@@ -616,11 +649,15 @@ bool Logic::initialize(Async::Config& cfgobj, const std::string& logic_name)
     // Pace the audio so that we don't fill up the audio output pipe.
   AudioPacer *msg_pacer = new AudioPacer(INTERNAL_SAMPLE_RATE,
       	      	      	      	      	 256 * INTERNAL_SAMPLE_RATE / 8000, 0);
+  msg_pacer->setSampleClockEnabled(true);
   prev_tx_src->registerSink(msg_pacer, true);
   tx_audio_mixer->addSource(msg_pacer);
   prev_tx_src = 0;
 
-  event_handler = new EventHandler(event_handler_str, name());
+  bool event_handler_thread = false;
+  cfg().getValue(name(), "EVENT_HANDLER_THREAD", event_handler_thread);
+  event_handler = new EventHandler(event_handler_str, name(),
+                                   event_handler_thread);
   event_handler->playFile.connect(mem_fun(*this, &Logic::playFile));
   event_handler->playSilence.connect(mem_fun(*this, &Logic::playSilence));
   event_handler->playTone.connect(mem_fun(*this, &Logic::playTone));
@@ -631,6 +668,9 @@ bool Logic::initialize(Async::Config& cfgobj, const std::string& logic_name)
   event_handler->publishStateEvent.connect(
           mem_fun(*this, &Logic::onPublishStateEvent));
   event_handler->playDtmf.connect(mem_fun(*this, &Logic::playDtmf));
+  event_handler->beginSequence.connect(
+          mem_fun(*this, &Logic::beginSequence));
+  event_handler->endSequence.connect(mem_fun(*this, &Logic::endSequence));
   event_handler->injectDtmf.connect(mem_fun(*this, &Logic::injectDtmf));
   event_handler->getConfigValue.connect(
           sigc::mem_fun(*this, &Logic::getConfigValue));
@@ -657,6 +697,16 @@ bool Logic::initialize(Async::Config& cfgobj, const std::string& logic_name)
       loaded_modules += " ";
     }
     loaded_modules += (*mit)->name();
+  }
+    // Modules that are loaded on demand must be known by the event handler
+    // from the start so that their TCL event handlers get loaded
+  for (const auto& lazy_module : lazy_modules)
+  {
+    if (!loaded_modules.empty())
+    {
+      loaded_modules += " ";
+    }
+    loaded_modules += lazy_module.name;
   }
   event_handler->setVariable("loaded_modules", loaded_modules);
 
@@ -696,9 +746,19 @@ bool Logic::initialize(Async::Config& cfgobj, const std::string& logic_name)
   dtmf_digit_handler = new DtmfDigitHandler;
   dtmf_digit_handler->commandComplete.connect(
       mem_fun(*this, &Logic::putCmdOnQueue));
+  dtmf_digit_handler->setCommandMatcher(
+      mem_fun(*this, &Logic::isCompleteCoreCmd));
   exec_cmd_on_sql_close_timer.expired.connect(sigc::hide(
       mem_fun(*dtmf_digit_handler, &DtmfDigitHandler::forceCommandComplete)));
 
+    // State events with the same name are coalesced so that only the latest
+    // one is published within each interval
+  unsigned state_event_interval = 0;
+  cfg().getValue(name(), "STATE_EVENT_INTERVAL", state_event_interval);
+  m_state_event_timer.setTimeout(state_event_interval);
+  m_state_event_timer.expired.connect(sigc::hide(
+      mem_fun(*this, &Logic::flushStateEvents)));
+
   int ctcss_to_tg_delay = 0;
   cfg().getValue(name(), "CTCSS_TO_TG_DELAY", ctcss_to_tg_delay);
   m_ctcss_to_tg_timer.setTimeout(ctcss_to_tg_delay);
@@ -753,6 +813,11 @@ bool Logic::initialize(Async::Config& cfgobj, const std::string& logic_name)
 
   cfg().valueUpdated.connect(sigc::mem_fun(*this, &Logic::cfgUpdated));
 
+  SvxLink::Metrics* metrics = SvxLink::Metrics::instance();
+  m_metric_squelch_open = &metrics->counter("svxlink_squelch_open_total",
+      "Number of times the squelch has opened", {{"logic", name()}});
+  metrics->collect.connect(mem_fun(*this, &Logic::collectMetrics));
+
   return true;
 
 } /* Logic::initialize */
@@ -773,6 +838,14 @@ void Logic::processEvent(const string& event, const Module *module)
 } /* Logic::processEvent */
 
 
+void Logic::processEventAndWait(const string& event)
+{
+  msg_handler->begin();
+  event_handler->processEventAndWait(name() + "::" + event);
+  msg_handler->end();
+} /* Logic::processEventAndWait */
+
+
 void Logic::setEventVariable(const string& varname, const string& value)
 {
   std::string fullname(varname);
@@ -840,6 +913,27 @@ void Logic::playDtmf(const std::string& digits, int amp, int len)
 } /* Logic::playDtmf */
 
 
+bool Logic::beginSequence(const std::string& key)
+{
+  bool play = msg_handler->beginSequence(key, report_events_as_idle);
+
+  if (!msg_handler->isIdle())
+  {
+    updateTxCtcss(true, TX_CTCSS_ANNOUNCEMENT);
+  }
+
+  checkIdle();
+
+  return play;
+} /* Logic::beginSequence */
+
+
+void Logic::endSequence(bool store)
+{
+  msg_handler->endSequence(store);
+} /* Logic::endSequence */
+
+
 void Logic::recordStart(const string& filename, unsigned max_time)
 {
   recordStop();
@@ -886,6 +980,7 @@ bool Logic::activateModule(Module *module)
     audio_to_module_splitter->enableSink(module, true);
     module->activate();
     event_handler->setVariable("active_module", module->name());
+    statusChanged("active_module", module->name());
     return true;
   }
 
@@ -906,6 +1001,14 @@ void Logic::deactivateModule(Module *module)
     active_module = 0;
     module->deactivate();
     event_handler->setVariable("active_module", "");
+    statusChanged("active_module", "");
+
+      // The module may have called us so it cannot be deleted right away
+    if (!m_pending_module_reloads.empty())
+    {
+      Async::Application::app().runTask(
+          sigc::mem_fun(*this, &Logic::processPendingModuleReloads));
+    }
   }
 } /* Logic::deactivateModule */
 
@@ -926,6 +1029,14 @@ Module *Logic::findModule(int id)
     }
   }
 
+  for (auto lit=lazy_modules.begin(); lit!=lazy_modules.end(); ++lit)
+  {
+    if (lit->id == id)
+    {
+      return loadLazyModule(lit);
+    }
+  }
+
   return 0;
 
 } /* Logic::findModule */
@@ -942,11 +1053,31 @@ Module *Logic::findModule(const string& name)
     }
   }
 
+  for (auto lit=lazy_modules.begin(); lit!=lazy_modules.end(); ++lit)
+  {
+    if (lit->name == name)
+    {
+      return loadLazyModule(lit);
+    }
+  }
+
   return 0;
 
 } /* Logic::findModule */
 
 
+std::list<Module*> Logic::moduleList(void)
+{
+    // The caller want to see all modules so the ones that have not been
+    // used yet have to be loaded
+  while (!lazy_modules.empty())
+  {
+    loadLazyModule(lazy_modules.begin());
+  }
+  return modules;
+} /* Logic::moduleList */
+
+
 void Logic::dtmfDigitDetected(char digit, int duration)
 {
   if (active_module != 0)
@@ -967,7 +1098,7 @@ void Logic::dtmfDigitDetected(char digit, int duration)
 } /* Logic::dtmfDigitDetected */
 
 
-void Logic::selcallSequenceDetected(std::string sequence)
+void Logic::selcallSequenceDetected(const std::string& sequence)
 {
   if ((sequence.compare(sel5_from) >= 0) && (sequence.compare(sel5_to) <= 0))
   {
@@ -1056,6 +1187,79 @@ void Logic::remoteReceivedTgUpdated(LogicBase *src_logic, uint32_t tg)
 } /* Logic::remoteReceivedTgUpdated */
 
 
+void Logic::configReloaded(const std::set<std::string>& changed_sections)
+{
+  std::vector<std::string> module_list;
+  cfg().getValue(name(), "MODULES", module_list, true);
+  std::set<std::string> configured(module_list.begin(), module_list.end());
+
+    // Loaded modules that have been removed from the configuration or that
+    // have a changed configuration section are unloaded and, when still
+    // configured, loaded again. Other modules are left untouched.
+  std::set<std::string> present;
+  std::vector<std::string> stale;
+  for (const auto& module : modules)
+  {
+    present.insert(module->cfgName());
+    if ((configured.count(module->cfgName()) == 0) ||
+        (changed_sections.count(module->cfgName()) > 0))
+    {
+      stale.push_back(module->cfgName());
+    }
+  }
+  for (const auto& module_cfg_name : stale)
+  {
+    reloadModule(module_cfg_name);
+  }
+
+    // Modules that have not been loaded yet only need to be registered again
+  std::vector<std::string> relazy;
+  for (auto it=lazy_modules.begin(); it!=lazy_modules.end(); )
+  {
+    present.insert(it->cfg_name);
+    if ((configured.count(it->cfg_name) == 0) ||
+        (changed_sections.count(it->cfg_name) > 0))
+    {
+      removeModuleActivateCmd(it->id);
+      if (configured.count(it->cfg_name) > 0)
+      {
+        relazy.push_back(it->cfg_name);
+      }
+      it = lazy_modules.erase(it);
+    }
+    else
+    {
+      ++it;
+    }
+  }
+  for (const auto& module_cfg_name : relazy)
+  {
+    addLazyModule(module_cfg_name);
+  }
+
+    // Load modules that have been added to the MODULES configuration variable
+  bool lazy_load = false;
+  cfg().getValue(name(), "LAZY_MODULE_LOAD", lazy_load);
+  std::set<std::string> keep_warm;
+  cfg().getValue(name(), "KEEP_WARM_MODULES", keep_warm);
+  for (const auto& module_cfg_name : module_list)
+  {
+    if (present.count(module_cfg_name) > 0)
+    {
+      continue;
+    }
+    if (lazy_load && (keep_warm.count(module_cfg_name) == 0))
+    {
+      addLazyModule(module_cfg_name);
+    }
+    else
+    {
+      loadModule(module_cfg_name);
+    }
+  }
+} /* Logic::configReloaded */
+
+
 /****************************************************************************
  *
  * Protected member functions
@@ -1077,7 +1281,7 @@ void Logic::squelchOpen(bool is_open)
 
   if (active_module != 0)
   {
-    active_module->squelchOpen(is_open);
+    active_module->squelchStateChanged(is_open);
   }
 
   signalLevelUpdated(rx().signalStrength());
@@ -1088,6 +1292,10 @@ void Logic::squelchOpen(bool is_open)
   if (is_open)
   {
     exec_cmd_on_sql_close_timer.setEnable(false);
+    if (m_metric_squelch_open != nullptr)
+    {
+      m_metric_squelch_open->inc();
+    }
   }
   else
   {
@@ -1182,6 +1390,19 @@ void Logic::commandPtyCmdReceived(const void *buf, size_t count)
     }
     cfg().setValue(section, tag, value);
   }
+  else if (cmd == "RELOAD")
+  {
+    std::string extra;
+    if (ss >> extra)
+    {
+      std::cerr << "*** ERROR: Invalid PTY command in logic "
+                << name() << ": \"" << cmdline << "\". "
+                << "Usage: RELOAD"
+                << std::endl;
+      return;
+    }
+    configReloadRequested();
+  }
   else if (cmd == "EVENT")
   {
     std::string event(std::istreambuf_iterator<char>(ss >> std::ws), {});
@@ -1204,11 +1425,15 @@ void Logic::commandPtyCmdReceived(const void *buf, size_t count)
       processEvent(event);
     }
   }
+  else if (cmd == "AUDIO_STATS")
+  {
+    m_audio_stats->publish();
+  }
   else
   {
     std::cerr << "*** ERROR: Unknown PTY command in logic "
               << name() << ": \"" << cmdline << "\". "
-              << "Valid commands are: CFG, EVENT"
+              << "Valid commands are: AUDIO_STATS, CFG, EVENT, RELOAD"
               << std::endl;
   }
 } /* Logic::commandPtyCmdReceived */
@@ -1259,10 +1484,44 @@ void Logic::rxValveSetOpen(bool do_open)
 
 void Logic::rptValveSetOpen(bool do_open)
 {
-  rpt_valve->setOpen(do_open);
+  rpt_valve_open = do_open;
+  rpt_valve->setOpen(rpt_valve_open && !rpt_fast_path_active);
+  if (rpt_fast_valve != nullptr)
+  {
+    rpt_fast_valve->setOpen(rpt_valve_open && rpt_fast_path_active);
+  }
 } /* Logic::rptValveSetOpen */
 
 
+void Logic::createRptFastPath(void)
+{
+  if (rpt_fast_valve != nullptr)
+  {
+    return;
+  }
+
+    // A valve that route RX audio straight into the TX audio mixer. This
+    // bypass the TX audio selector and the prebuffered TX FIFO so repeated
+    // audio reach the transmitter with as little delay as possible.
+  rpt_fast_valve = new AudioValve;
+  rpt_fast_valve->setOpen(false);
+  rx_splitter->addSink(rpt_fast_valve, true);
+  tx_audio_mixer->addSource(rpt_fast_valve);
+} /* Logic::createRptFastPath */
+
+
+void Logic::rptFastPathSetActive(bool active)
+{
+  active = active && (rpt_fast_valve != nullptr);
+  if (active == rpt_fast_path_active)
+  {
+    return;
+  }
+  rpt_fast_path_active = active;
+  rptValveSetOpen(rpt_valve_open);
+} /* Logic::rptFastPathSetActive */
+
+
 void Logic::checkIdle(void)
 {
   setIdle(getIdleState());
@@ -1326,27 +1585,40 @@ void Logic::loadModules(void)
     return;
   }
 
+  bool lazy_load = false;
+  cfg().getValue(name(), "LAZY_MODULE_LOAD", lazy_load);
+  std::set<std::string> keep_warm;
+  cfg().getValue(name(), "KEEP_WARM_MODULES", keep_warm);
+
   string::iterator comma;
   string::iterator begin = modules.begin();
   do
   {
     comma = find(begin, modules.end(), ',');
+    string module_name;
     if (comma == modules.end())
     {
-      string module_name(begin, modules.end());
-      loadModule(module_name);
+      module_name = string(begin, modules.end());
     }
     else
     {
-      string module_name(begin, comma);
-      loadModule(module_name);
+      module_name = string(begin, comma);
       begin = comma + 1;
     }
+    if (lazy_load && (keep_warm.count(module_name) == 0))
+    {
+      addLazyModule(module_name);
+    }
+    else
+    {
+      loadModule(module_name);
+    }
   } while (comma != modules.end());
 } /* Logic::loadModules */
 
 
-void Logic::loadModule(const string& module_cfg_name)
+Module *Logic::loadModule(const string& module_cfg_name,
+                          bool add_activate_cmd)
 {
   std::cout << name() << ": Loading module \"" << module_cfg_name << "\""
             << std::endl;
@@ -1374,7 +1646,7 @@ void Logic::loadModule(const string& module_cfg_name)
       cerr << "*** ERROR: Failed to load module "
         << module_cfg_name.c_str() << " into logic " << name() << ": "
         << dlerror() << endl;
-      return;
+      return 0;
     }
   }
   else
@@ -1390,7 +1662,7 @@ void Logic::loadModule(const string& module_cfg_name)
         cerr << "*** ERROR: Failed to load module "
           << module_cfg_name.c_str() << " into logic " << name() << ": "
           << dlerror() << endl;
-        return;
+        return 0;
       }
     }
   }
@@ -1402,7 +1674,7 @@ void Logic::loadModule(const string& module_cfg_name)
       	 << module_cfg_name.c_str() << " in logic " << name() << ": "
          << dlerror() << endl;
     dlclose(handle);
-    return;
+    return 0;
   }
   cout << "\tFound " << link_map->l_name << endl;
 
@@ -1413,7 +1685,7 @@ void Logic::loadModule(const string& module_cfg_name)
       	 << module_cfg_name.c_str() << " in logic " << name() << ": "
          << dlerror() << endl;
     dlclose(handle);
-    return;
+    return 0;
   }
 
   Module *module = init(handle, this, module_cfg_name.c_str());
@@ -1422,7 +1694,7 @@ void Logic::loadModule(const string& module_cfg_name)
     cerr << "*** ERROR: Creation failed for module "
       	 << module_cfg_name.c_str() << " in logic " << name() << endl;
     dlclose(handle);
-    return;
+    return 0;
   }
 
   if (!module->initialize())
@@ -1431,10 +1703,10 @@ void Logic::loadModule(const string& module_cfg_name)
       	 << module_cfg_name.c_str() << " in logic " << name() << endl;
     delete module;
     dlclose(handle);
-    return;
+    return 0;
   }
 
-  if (module->id() >= 0)
+  if (add_activate_cmd && (module->id() >= 0))
   {
     stringstream ss;
     ss << module->id();
@@ -1449,7 +1721,7 @@ void Logic::loadModule(const string& module_cfg_name)
       delete cmd;
       delete module;
       dlclose(handle);
-      return;
+      return 0;
     }
   }
 
@@ -1463,9 +1735,66 @@ void Logic::loadModule(const string& module_cfg_name)
 
   modules.push_back(module);
 
+  return module;
 } /* Logic::loadModule */
 
 
+  /*
+   * Register a module that should be loaded the first time it is used. The
+   * module activation command and the TCL variables are set up directly so
+   * that the module look the same as a loaded module to the outside.
+   */
+void Logic::addLazyModule(const string& module_cfg_name)
+{
+  LazyModule lazy_module;
+  lazy_module.cfg_name = module_cfg_name;
+  lazy_module.name = module_cfg_name;
+  cfg().getValue(module_cfg_name, "NAME", lazy_module.name);
+  lazy_module.id = -1;
+  cfg().getValue(module_cfg_name, "ID", lazy_module.id);
+
+  std::cout << name() << ": Module \"" << module_cfg_name
+            << "\" will be loaded on first use" << std::endl;
+
+  event_handler->processEvent(
+      "namespace eval " + name() + "::" + lazy_module.name + " {}");
+  list<string> vars = cfg().listSection(module_cfg_name);
+  for (const auto& var : vars)
+  {
+    string value;
+    cfg().getValue(module_cfg_name, var, value);
+    setEventVariable(lazy_module.name + "::CFG_" + var, value);
+  }
+
+  if (lazy_module.id >= 0)
+  {
+    stringstream ss;
+    ss << lazy_module.id;
+    ModuleActivateCmd *cmd = new ModuleActivateCmd(&cmd_parser, ss.str(), this);
+    if (!cmd->addToParser())
+    {
+      cerr << "\n*** ERROR: Failed to add module activation command for "
+           << "module \"" << module_cfg_name << "\" in logic \"" << name()
+           << "\". This is probably due to having set up two modules with the "
+           << "same module id or choosing a module id that is the same as "
+           << "another command.\n\n";
+      delete cmd;
+      return;
+    }
+  }
+
+  lazy_modules.push_back(lazy_module);
+} /* Logic::addLazyModule */
+
+
+Module *Logic::loadLazyModule(std::list<LazyModule>::iterator it)
+{
+  std::string module_cfg_name(it->cfg_name);
+  lazy_modules.erase(it);
+  return loadModule(module_cfg_name, false);
+} /* Logic::loadLazyModule */
+
+
 void Logic::unloadModules(void)
 {
   deactivateModule(0);
@@ -1478,9 +1807,91 @@ void Logic::unloadModules(void)
     dlclose(plugin_handle);
   }
   modules.clear();
+  lazy_modules.clear();
 } /* logic::unloadModules */
 
 
+void Logic::unloadModule(Module *module)
+{
+  std::cout << name() << ": Unloading module \"" << module->cfgName() << "\""
+            << std::endl;
+  deactivateModule(module);
+  audio_from_module_selector->removeSource(module);
+  audio_to_module_splitter->removeSink(module);
+  modules.remove(module);
+  void *plugin_handle = module->pluginHandle();
+  delete module;
+  dlclose(plugin_handle);
+} /* Logic::unloadModule */
+
+
+  /*
+   * Unload a module and load it again using the current configuration. A
+   * module that is active is not touched until it is deactivated so that
+   * an ongoing session is not interrupted.
+   */
+void Logic::reloadModule(const std::string& module_cfg_name)
+{
+  auto it = std::find_if(modules.begin(), modules.end(),
+      [&](Module *m) { return m->cfgName() == module_cfg_name; });
+  if (it == modules.end())
+  {
+    return;
+  }
+  Module *module = *it;
+  if (module == active_module)
+  {
+    std::cout << name() << ": Module \"" << module_cfg_name
+              << "\" will be reloaded when it is deactivated" << std::endl;
+    m_pending_module_reloads.insert(module_cfg_name);
+    return;
+  }
+
+  const int old_id = module->id();
+  unloadModule(module);
+
+  std::vector<std::string> module_list;
+  cfg().getValue(name(), "MODULES", module_list, true);
+  if (std::find(module_list.begin(), module_list.end(), module_cfg_name) ==
+      module_list.end())
+  {
+    removeModuleActivateCmd(old_id);
+    return;
+  }
+
+  int new_id = -1;
+  cfg().getValue(module_cfg_name, "ID", new_id);
+  if (new_id != old_id)
+  {
+    removeModuleActivateCmd(old_id);
+  }
+  loadModule(module_cfg_name, new_id != old_id);
+} /* Logic::reloadModule */
+
+
+void Logic::processPendingModuleReloads(void)
+{
+  std::set<std::string> pending;
+  pending.swap(m_pending_module_reloads);
+  for (const auto& module_cfg_name : pending)
+  {
+    reloadModule(module_cfg_name);
+  }
+} /* Logic::processPendingModuleReloads */
+
+
+void Logic::removeModuleActivateCmd(int id)
+{
+  if (id < 0)
+  {
+    return;
+  }
+  std::ostringstream ss;
+  ss << id;
+  delete dynamic_cast<ModuleActivateCmd*>(cmd_parser.findCmd(ss.str()));
+} /* Logic::removeModuleActivateCmd */
+
+
 void Logic::processCommandQueue(void)
 {
   if (rx().squelchIsOpen() || cmd_queue.empty())
@@ -1495,7 +1906,7 @@ void Logic::processCommandQueue(void)
 
     stringstream ss;
     ss << "dtmf_cmd_received \"" << cmd << "\"";
-    processEvent(ss.str());
+    processEventAndWait(ss.str());
     if (atoi(event_handler->eventResult().c_str()) != 0)
     {
       continue;
@@ -1665,6 +2076,23 @@ void Logic::putCmdOnQueue(void)
 } /* Logic::putCmdOnQueue */
 
 
+bool Logic::isCompleteCoreCmd(const std::string& digits) const
+{
+    // Only core commands can be matched early since the modules handle
+    // their own commands
+  if (!is_online || (active_module != 0) || (digits.size() >= long_cmd_digits))
+  {
+    return false;
+  }
+  if (!m_macro_prefix.empty() &&
+      (digits.compare(0, m_macro_prefix.size(), m_macro_prefix) == 0))
+  {
+    return false;
+  }
+  return (cmd_parser.matchPrefix(digits) == CmdParser::MATCH_COMPLETE);
+} /* Logic::isCompleteCoreCmd */
+
+
 void Logic::sendRgrSound(void)
 {
   processEvent("send_rgr_sound");
@@ -1721,7 +2149,7 @@ void Logic::dtmfDigitDetectedP(char digit, int duration)
 
   stringstream ss;
   ss << "dtmf_digit_received " << digit << " " << duration;
-  processEvent(ss.str());
+  processEventAndWait(ss.str());
   if (atoi(event_handler->eventResult().c_str()) != 0)
   {
     return;
@@ -1785,6 +2213,7 @@ void Logic::cleanup(void)
   delete state_pty;                   state_pty = 0;
   delete dtmf_ctrl_pty;               dtmf_ctrl_pty = 0;
   delete command_pty;                 command_pty = 0;
+  delete m_audio_stats;               m_audio_stats = nullptr;
 } /* Logic::cleanup */
 
 
@@ -1806,6 +2235,7 @@ void Logic::updateTxCtcss(bool do_set, TxCtcssType type)
 
 void Logic::logicConInStreamStateChanged(bool is_active, bool is_idle)
 {
+  logic_con_in_active = !is_idle;
   updateTxCtcss(!is_idle, TX_CTCSS_LOGIC);
 } /* Logic::logicConInStreamStateChanged */
 
@@ -1816,7 +2246,7 @@ void Logic::audioFromModuleStreamStateChanged(bool is_active, bool is_idle)
 } /* Logic::audioFromModuleStreamStateChanged */
 
 
-void Logic::onPublishStateEvent(const string &event_name, const string &msg)
+void Logic::sendStateEvent(const string &event_name, const string &msg)
 {
   publishStateEvent(event_name, msg);
 
@@ -1832,6 +2262,41 @@ void Logic::onPublishStateEvent(const string &event_name, const string &msg)
   os << event_name << " " << msg;
   os << endl;
   state_pty->write(os.str().c_str(), os.str().size());
+} /* Logic::sendStateEvent */
+
+
+void Logic::flushStateEvents(void)
+{
+  m_state_event_timer.setEnable(false);
+  if (m_pending_state_events.empty())
+  {
+    return;
+  }
+  std::map<std::string, std::string> pending;
+  pending.swap(m_pending_state_events);
+  for (const auto& event : pending)
+  {
+    sendStateEvent(event.first, event.second);
+  }
+  m_state_event_timer.setEnable(true);
+} /* Logic::flushStateEvents */
+
+
+void Logic::onPublishStateEvent(const string &event_name, const string &msg)
+{
+    // The first event is published directly. Events arriving before the
+    // interval has passed are queued and only the latest one for each event
+    // name is kept.
+  if (m_state_event_timer.timeout() > 0)
+  {
+    if (m_state_event_timer.isEnabled())
+    {
+      m_pending_state_events[event_name] = msg;
+      return;
+    }
+    m_state_event_timer.setEnable(true);
+  }
+  sendStateEvent(event_name, msg);
 } /* Logic::onPublishStateEvent */
 
 
@@ -1854,6 +2319,14 @@ void Logic::cfgUpdated(const std::string& section, const std::string& tag)
       event_handler->setVariable(name() + "::Logic::CFG_" + tag, value);
       processEvent("config_updated CFG_" + tag + " \"" + value + "\"");
     }
+    if (tag == "STATE_EVENT_INTERVAL")
+    {
+      unsigned state_event_interval = 0;
+      cfg().getValue(name(), "STATE_EVENT_INTERVAL", state_event_interval);
+      flushStateEvents();
+      m_state_event_timer.setEnable(false);
+      m_state_event_timer.setTimeout(state_event_interval);
+    }
     if (tag == "ONLINE")
     {
       bool online;
@@ -1881,6 +2354,27 @@ void Logic::signalLevelUpdated(float siglev)
 } /* Logic::signalLevelUpdated */
 
 
+void Logic::collectMetrics(void)
+{
+  SvxLink::Metrics::instance()->counter("svxlink_tx_audio_underruns_total",
+      "Number of times the transmitter audio output ran dry",
+      {{"logic", name()}}).set(tx().audioUnderrunCount());
+} /* Logic::collectMetrics */
+
+
+void Logic::collectAudioStats(Async::AudioStats::Snapshot& snap)
+{
+  if (m_tx != 0)
+  {
+    snap.counters[AudioStats::XRUNS] += tx().audioUnderrunCount();
+  }
+  if (m_rx != 0)
+  {
+    snap.counters[AudioStats::XRUNS] += rx().audioOverrunCount();
+  }
+} /* Logic::collectAudioStats */
+
+
 /*
  * This file has not been truncated
  */
@@ -10,7 +10,7 @@ specific logic core classes (e.g. SimplexLogic and RepeaterLogic).
 
 \verbatim
 SvxLink - A Multi Purpose Voice Services System for Ham Radio Use
-Copyright (C) 2004-2025  Tobias Blomberg / SM0SVX
+Copyright (C) 2004-2026  Tobias Blomberg / SM0SVX
 
 This program is free software; you can redistribute it and/or modify
 it under the terms of the GNU General Public License as published by
@@ -42,6 +42,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 #include <string>
 #include <list>
 #include <map>
+#include <set>
 #include <vector>
 #include <stdint.h>
 
@@ -57,6 +58,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 #include <LocationInfo.h>
 #include <AsyncAtTimer.h>
 #include <AsyncTimer.h>
+#include <AsyncAudioStats.h>
 #include <Tx.h>
 
 
@@ -92,6 +94,12 @@ namespace Async
   class Pty;
 };
 
+namespace SvxLink
+{
+  class MetricCounter;
+  class MetricHistogram;
+};
+
 
 /****************************************************************************
  *
@@ -116,6 +124,7 @@ class EventHandler;
 class Command;
 class QsoRecorder;
 class DtmfDigitHandler;
+class LogicAudioStats;
 
 
 /****************************************************************************
@@ -173,6 +182,8 @@ class Logic : public LogicBase
     virtual void playSilence(int length);
     virtual void playTone(int fq, int amp, int len);
     virtual void playDtmf(const std::string& digits, int amp, int len);
+    bool beginSequence(const std::string& key);
+    void endSequence(bool store);
     void recordStart(const std::string& filename, unsigned max_time);
     void recordStop(void);
     void injectDtmf(const std::string& digits, int len);
@@ -182,7 +193,7 @@ class Logic : public LogicBase
     Module *activeModule(void) const { return active_module; }
     Module *findModule(int id);
     Module *findModule(const std::string& name);
-    std::list<Module*> moduleList(void) const { return modules; }
+    std::list<Module*> moduleList(void);
 
     const std::string& callsign(void) const { return m_callsign; }
 
@@ -207,6 +218,8 @@ class Logic : public LogicBase
     virtual void remoteCmdReceived(LogicBase* src_logic,
                                    const std::string& cmd);
     virtual void remoteReceivedTgUpdated(LogicBase *src_logic, uint32_t tg);
+    virtual void configReloaded(
+        const std::set<std::string>& changed_sections) override;
 
 
     CmdParser *cmdParser(void) { return &cmd_parser; }
@@ -225,7 +238,7 @@ class Logic : public LogicBase
     virtual void audioStreamStateChange(bool is_active, bool is_idle);
     virtual bool getIdleState(void) const;
     virtual void transmitterStateChange(bool is_transmitting);
-    virtual void selcallSequenceDetected(std::string sequence);
+    virtual void selcallSequenceDetected(const std::string& sequence);
     virtual void dtmfCtrlPtyCmdReceived(const void *buf, size_t count);
     virtual void commandPtyCmdReceived(const void *buf, size_t count);
 
@@ -233,10 +246,20 @@ class Logic : public LogicBase
     void enableRgrSoundTimer(bool enable);
     void rxValveSetOpen(bool do_open);
     void rptValveSetOpen(bool do_open);
+    void createRptFastPath(void);
+    void rptFastPathSetActive(bool active);
+    bool rptFastPathIsActive(void) const { return rpt_fast_path_active; }
+    bool logicConInIsActive(void) const { return logic_con_in_active; }
     void checkIdle(void);
     void setTxCtrlMode(Tx::TxCtrlMode mode);
 
   private:
+    struct LazyModule
+    {
+      std::string cfg_name;
+      std::string name;
+      int         id;
+    };
 
     typedef enum
     {
@@ -249,6 +272,7 @@ class Logic : public LogicBase
     MsgHandler	      	      	    *msg_handler;
     Module    	      	      	    *active_module;
     std::list<Module*>	      	    modules;
+    std::list<LazyModule>           lazy_modules;
     std::string       	      	    m_callsign;
     std::list<std::string>    	    cmd_queue;
     Async::Timer      	      	    exec_cmd_on_sql_close_timer;
@@ -268,6 +292,10 @@ class Logic : public LogicBase
     Async::AudioSplitter      	    *rx_splitter;
     Async::AudioValve 	      	    *rx_valve;
     Async::AudioValve 	      	    *rpt_valve;
+    Async::AudioValve               *rpt_fast_valve               {nullptr};
+    bool                            rpt_valve_open                {false};
+    bool                            rpt_fast_path_active          {false};
+    bool                            logic_con_in_active           {false};
     Async::AudioSelector      	    *audio_from_module_selector;
     Async::AudioSplitter      	    *audio_to_module_splitter;
     Async::AudioSelector      	    *audio_to_module_selector;
@@ -293,13 +321,27 @@ class Logic : public LogicBase
     Async::Timer                    m_ctcss_to_tg_timer;
     float                           m_ctcss_to_tg_last_fq;
     std::string                     m_macro_prefix                {"D"};
+    SvxLink::MetricCounter*         m_metric_squelch_open         {nullptr};
+    LogicAudioStats*                m_audio_stats                 {nullptr};
+    std::set<std::string>           m_pending_module_reloads;
+    Async::Timer                    m_state_event_timer;
+    std::map<std::string, std::string> m_pending_state_events;
 
     void loadModules(void);
-    void loadModule(const std::string& module_name);
+    Module *loadModule(const std::string& module_name,
+                       bool add_activate_cmd=true);
+    void addLazyModule(const std::string& module_cfg_name);
+    Module *loadLazyModule(std::list<LazyModule>::iterator it);
     void unloadModules(void);
+    void unloadModule(Module *module);
+    void reloadModule(const std::string& module_cfg_name);
+    void processPendingModuleReloads(void);
+    void removeModuleActivateCmd(int id);
     void processCommandQueue(void);
+    void processEventAndWait(const std::string& event);
     void processCommand(const std::string &cmd, bool force_core_cmd=false);
     void putCmdOnQueue(void);
+    bool isCompleteCoreCmd(const std::string& digits) const;
     void sendRgrSound(void);
     void timeoutNextMinute(void);
 	void timeoutNextSecond(void);
@@ -310,6 +352,9 @@ class Logic : public LogicBase
     void updateTxCtcss(bool do_set, TxCtcssType type);
     void logicConInStreamStateChanged(bool is_active, bool is_idle);
     void audioFromModuleStreamStateChanged(bool is_active, bool is_idle);
+    void sendStateEvent(const std::string &event_name,
+                        const std::string &msg);
+    void flushStateEvents(void);
     void onPublishStateEvent(const std::string &event_name,
                              const std::string &msg);
     void detectedTone(float fq);
@@ -317,6 +362,8 @@ class Logic : public LogicBase
     bool getConfigValue(const std::string& section, const std::string& tag,
                         std::string& value);
     void signalLevelUpdated(float siglev);
+    void collectMetrics(void);
+    void collectAudioStats(Async::AudioStats::Snapshot& snap);
 
 };  /* class Logic */
 
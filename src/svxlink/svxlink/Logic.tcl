@@ -133,9 +133,11 @@ proc manual_identification {} {
 #
 proc send_short_voice_ident {hour minute} {
   printInfo "Playing short voice ID"
-  spellWord ${::mycall}
-  if {${::logic_type} == "Repeater"} {
-    playMsg "repeater"
+  playCached "short_voice_ident" {
+    spellWord ${::mycall}
+    if {${::logic_type} == "Repeater"} {
+      playMsg "repeater"
+    }
   }
 }
 
@@ -162,11 +164,13 @@ proc send_short_announce_ident {hour minute} {
 #
 proc send_short_cw_ident {hour minute} {
   printInfo "Playing short CW ID"
-  if {${::logic_type} == "Repeater"} {
-    set call "${::mycall}/R"
-    CW::play $call
-  } else {
-    CW::play ${::mycall}
+  playCached "short_cw_ident" {
+    if {${::logic_type} == "Repeater"} {
+      set call "${::mycall}/R"
+      CW::play $call
+    } else {
+      CW::play ${::mycall}
+    }
   }
 }
 
@@ -0,0 +1,284 @@
+/**
+@file	 LogicAudioStats.cpp
+@brief   Audio health statistics for a logic core
+@author  Tobias Blomberg / SM0SVX
+@date	 2026-10-15
+
+\verbatim
+SvxLink - A Multi Purpose Voice Services System for Ham Radio Use
+Copyright (C) 2003-2026 Tobias Blomberg / SM0SVX
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+\endverbatim
+*/
+
+/****************************************************************************
+ *
+ * System Includes
+ *
+ ****************************************************************************/
+
+#include <json/json.h>
+
+#include <iostream>
+#include <sstream>
+#include <vector>
+
+
+/****************************************************************************
+ *
+ * Project Includes
+ *
+ ****************************************************************************/
+
+#include <Metrics.h>
+
+
+/****************************************************************************
+ *
+ * Local Includes
+ *
+ ****************************************************************************/
+
+#include "LogicAudioStats.h"
+
+
+/****************************************************************************
+ *
+ * Namespaces to use
+ *
+ ****************************************************************************/
+
+using namespace std;
+using namespace Async;
+
+
+
+/****************************************************************************
+ *
+ * Defines & typedefs
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Local class definitions
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Prototypes
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Exported Global Variables
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Local Global Variables
+ *
+ ****************************************************************************/
+
+namespace {
+  const char* counter_help[AudioStats::COUNTER_CNT] =
+  {
+    "Number of times an audio buffer ran empty in the middle of a stream",
+    "Number of audio device playback underruns and capture overruns",
+    "Number of network audio frames that arrived too late",
+    "Number of network audio frames that were lost",
+    "Number of audio frames recreated by packet loss concealment",
+    "Number of audio blocks dropped due to an audio encoder backlog",
+    "Number of audio frames dropped due to an audio decoder backlog"
+  };
+};
+
+
+/****************************************************************************
+ *
+ * Public member functions
+ *
+ ****************************************************************************/
+
+const char* LogicAudioStats::EVENT_NAME = "Logic:audio_stats";
+
+
+LogicAudioStats::LogicAudioStats(void)
+  : m_publish_timer(1000 * DEFAULT_INTERVAL, Timer::TYPE_PERIODIC, false)
+{
+  m_publish_timer.expired.connect(
+      sigc::hide(sigc::mem_fun(*this, &LogicAudioStats::publishTimeout)));
+} /* LogicAudioStats::LogicAudioStats */
+
+
+LogicAudioStats::~LogicAudioStats(void)
+{
+} /* LogicAudioStats::~LogicAudioStats */
+
+
+bool LogicAudioStats::initialize(Async::Config& cfg, const std::string& name)
+{
+  m_name = name;
+
+  unsigned interval = DEFAULT_INTERVAL;
+  cfg.getValue(name, "AUDIO_STATS_INTERVAL", interval);
+  if (interval > 0)
+  {
+    m_publish_timer.setTimeout(1000 * interval);
+    m_publish_timer.setEnable(true);
+  }
+
+  SvxLink::Metrics::instance()->collect.connect(
+      sigc::mem_fun(*this, &LogicAudioStats::collectMetrics));
+
+  return true;
+} /* LogicAudioStats::initialize */
+
+
+void LogicAudioStats::snapshot(Async::AudioStats::Snapshot& snap)
+{
+  m_stats.snapshot(snap);
+  collect(snap);
+} /* LogicAudioStats::snapshot */
+
+
+std::string LogicAudioStats::json(void)
+{
+  AudioStats::Snapshot snap;
+  snapshot(snap);
+  return snapshotJson(snap);
+} /* LogicAudioStats::json */
+
+
+void LogicAudioStats::publish(void)
+{
+  AudioStats::Snapshot snap;
+  snapshot(snap);
+  doPublish(snap);
+} /* LogicAudioStats::publish */
+
+
+
+/****************************************************************************
+ *
+ * Protected member functions
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Private member functions
+ *
+ ****************************************************************************/
+
+void LogicAudioStats::publishTimeout(void)
+{
+  AudioStats::Snapshot snap;
+  snapshot(snap);
+  if (snap != m_last_published)
+  {
+    doPublish(snap);
+  }
+} /* LogicAudioStats::publishTimeout */
+
+
+void LogicAudioStats::doPublish(const Async::AudioStats::Snapshot& snap)
+{
+  m_last_published = snap;
+  publishStats(EVENT_NAME, snapshotJson(snap));
+} /* LogicAudioStats::doPublish */
+
+
+std::string LogicAudioStats::snapshotJson(
+    const Async::AudioStats::Snapshot& snap)
+{
+  Json::Value event(Json::objectValue);
+  event["logic"] = m_name;
+  for (unsigned i=0; i<AudioStats::COUNTER_CNT; ++i)
+  {
+    const char* name = AudioStats::counterName(AudioStats::Counter(i));
+    event[name] = Json::UInt64(snap.counters[i]);
+  }
+  if (snap.latency_cnt > 0)
+  {
+    Json::Value latency(Json::objectValue);
+    latency["count"] = Json::UInt64(snap.latency_cnt);
+    latency["avg_ms"] = snap.latency_sum / snap.latency_cnt;
+    Json::Value hist(Json::arrayValue);
+    for (unsigned i=0; i<AudioStats::LATENCY_BUCKETS; ++i)
+    {
+      hist.append(Json::UInt64(snap.latency_hist[i]));
+    }
+    latency["hist"] = hist;
+    event["latency"] = latency;
+  }
+
+  Json::StreamWriterBuilder builder;
+  builder["commentStyle"] = "None";
+  builder["indentation"] = ""; //The JSON document is written on a single line
+  return Json::writeString(builder, event);
+} /* LogicAudioStats::snapshotJson */
+
+
+void LogicAudioStats::collectMetrics(void)
+{
+  AudioStats::Snapshot snap;
+  snapshot(snap);
+
+  SvxLink::Metrics* metrics = SvxLink::Metrics::instance();
+  const SvxLink::Metrics::Labels labels{{"logic", m_name}};
+  for (unsigned i=0; i<AudioStats::COUNTER_CNT; ++i)
+  {
+    const string name = string("svxlink_audio_") +
+      AudioStats::counterName(AudioStats::Counter(i)) + "_total";
+    metrics->counter(name, counter_help[i], labels).set(snap.counters[i]);
+  }
+
+  vector<double> bounds;
+  for (unsigned i=0; i<AudioStats::LATENCY_BUCKETS-1; ++i)
+  {
+    bounds.push_back(AudioStats::latencyBucketBound(i) / 1000.0);
+  }
+  SvxLink::MetricHistogram& latency = metrics->histogram(
+      "svxlink_audio_latency_seconds",
+      "Audio latency from network ingress to the audio device",
+      bounds, labels);
+  latency.clear();
+  for (unsigned i=0; i<AudioStats::LATENCY_BUCKETS; ++i)
+  {
+    latency.add(i, snap.latency_hist[i], 0.0);
+  }
+  latency.add(0, 0, snap.latency_sum / 1000.0);
+} /* LogicAudioStats::collectMetrics */
+
+
+
+/*
+ * This file has not been truncated
+ */
@@ -0,0 +1,219 @@
+/**
+@file	 LogicAudioStats.h
+@brief   Audio health statistics for a logic core
+@author  Tobias Blomberg / SM0SVX
+@date	 2026-10-15
+
+\verbatim
+SvxLink - A Multi Purpose Voice Services System for Ham Radio Use
+Copyright (C) 2003-2026 Tobias Blomberg / SM0SVX
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+\endverbatim
+*/
+
+#ifndef LOGIC_AUDIO_STATS_INCLUDED
+#define LOGIC_AUDIO_STATS_INCLUDED
+
+
+/****************************************************************************
+ *
+ * System Includes
+ *
+ ****************************************************************************/
+
+#include <sigc++/sigc++.h>
+
+#include <string>
+
+
+/****************************************************************************
+ *
+ * Project Includes
+ *
+ ****************************************************************************/
+
+#include <AsyncTimer.h>
+#include <AsyncConfig.h>
+#include <AsyncAudioStats.h>
+
+
+/****************************************************************************
+ *
+ * Local Includes
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Forward declarations
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Namespace
+ *
+ ****************************************************************************/
+
+//namespace MyNameSpace
+//{
+
+
+/****************************************************************************
+ *
+ * Forward declarations of classes inside of the declared namespace
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Defines & typedefs
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Exported Global Variables
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Class definitions
+ *
+ ****************************************************************************/
+
+/**
+@brief	Audio health statistics for a logic core
+@author Tobias Blomberg / SM0SVX
+@date   2026-10-15
+
+This class aggregate the audio health statistics for one logic core. The
+Async::AudioStats object returned by the stats function is handed to the
+audio pipe components of the logic core, which update it directly from the
+audio path. Statistics kept elsewhere, like the xrun counters of the audio
+devices, are added by slots connected to the collect signal.
+
+The statistics are exported through the metrics registry, labeled by the
+logic name. They are also published as a state event, in JSON format, at
+the interval given by the AUDIO_STATS_INTERVAL configuration variable.
+Nothing is published if nothing has changed since the last time. The state
+event reach the state PTY of the logic core and linked reflector logic cores,
+which forward it to the reflector server.
+*/
+class LogicAudioStats : public sigc::trackable
+{
+  public:
+    /**
+     * @brief   The name of the state event used to publish the statistics
+     */
+    static const char* EVENT_NAME;
+
+    /**
+     * @brief 	Default constructor
+     */
+    LogicAudioStats(void);
+
+    /**
+     * @brief 	Destructor
+     */
+    ~LogicAudioStats(void);
+
+    /**
+     * @brief 	Initialize the statistics object
+     * @param 	cfg   The configuration object to read the settings from
+     * @param 	name  The name of the logic core
+     * @return	Return \em true on success or else \em false
+     */
+    bool initialize(Async::Config& cfg, const std::string& name);
+
+    /**
+     * @brief 	Get the statistics object to hand to audio pipe components
+     * @return	Return the statistics object
+     */
+    Async::AudioStats* stats(void) { return &m_stats; }
+
+    /**
+     * @brief 	Get all statistics for the logic core
+     * @param 	snap The snapshot to add the statistics to
+     */
+    void snapshot(Async::AudioStats::Snapshot& snap);
+
+    /**
+     * @brief 	Get all statistics for the logic core in JSON format
+     * @return	Return a JSON object written on a single line
+     */
+    std::string json(void);
+
+    /**
+     * @brief 	Publish the statistics right away
+     *
+     * The statistics are published even if nothing has changed.
+     */
+    void publish(void);
+
+    /**
+     * @brief 	A signal emitted when statistics kept elsewhere are needed
+     * @param 	snap The snapshot to add the statistics to
+     */
+    sigc::signal<void(Async::AudioStats::Snapshot&)> collect;
+
+    /**
+     * @brief 	A signal emitted when the statistics should be published
+     * @param 	event_name  The name of the state event
+     * @param 	data        The statistics in JSON format
+     */
+    sigc::signal<void(const std::string&, const std::string&)> publishStats;
+
+  protected:
+
+  private:
+    static const unsigned DEFAULT_INTERVAL = 60;
+
+    std::string                   m_name;
+    Async::AudioStats             m_stats;
+    Async::Timer                  m_publish_timer;
+    Async::AudioStats::Snapshot   m_last_published;
+
+    LogicAudioStats(const LogicAudioStats&);
+    LogicAudioStats& operator=(const LogicAudioStats&);
+    void publishTimeout(void);
+    void doPublish(const Async::AudioStats::Snapshot& snap);
+    std::string snapshotJson(const Async::AudioStats::Snapshot& snap);
+    void collectMetrics(void);
+
+};  /* class LogicAudioStats */
+
+
+//} /* namespace */
+
+#endif /* LOGIC_AUDIO_STATS_INCLUDED */
+
+
+
+/*
+ * This file has not been truncated
+ */
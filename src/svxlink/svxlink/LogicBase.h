@@ -6,7 +6,7 @@
 
 \verbatim
 SvxLink - A Multi Purpose Voice Services System for Ham Radio Use
-Copyright (C) 2004-2022  Tobias Blomberg / SM0SVX
+Copyright (C) 2004-2026  Tobias Blomberg / SM0SVX
 
 This program is free software; you can redistribute it and/or modify
 it under the terms of the GNU General Public License as published by
@@ -36,6 +36,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
  ****************************************************************************/
 
 #include <string>
+#include <set>
 
 #include <sigc++/sigc++.h>
 
@@ -276,6 +277,31 @@ class LogicBase : public Async::Plugin, public sigc::trackable
         LogicBase *logic, const std::string& event_name,
         const std::string& msg) {}
 
+    /**
+     * @brief   The configuration has been reloaded
+     * @param   changed_sections The configuration sections that changed
+     *
+     * This function is called after a new configuration has been loaded into
+     * the configuration object given to the initialize function. All
+     * configuration variable update notifications have been sent when this
+     * function is called. A logic core may use this to rebuild the parts
+     * that do not support live updates of configuration variables.
+     */
+    virtual void configReloaded(const std::set<std::string>& changed_sections)
+    {}
+
+    /**
+     * @brief   The consumers of the logic connection audio have changed
+     * @param   has_consumers \em True if any other logic receive the audio
+     *
+     * This function is called by the link manager when the audio from
+     * logicConOut start or stop being routed to at least one other logic
+     * core. A logic core may use this to avoid doing expensive work, like
+     * decoding audio, that nobody is going to listen to. It is assumed that
+     * there are consumers until told otherwise.
+     */
+    virtual void logicConOutConsumersChanged(bool has_consumers) {}
+
     /**
      * @brief   A signal that is emitted when the idle state change
      * @param   is_idle \em True if the logic core is idle or \em false if not
@@ -302,6 +328,25 @@ class LogicBase : public Async::Plugin, public sigc::trackable
     sigc::signal<void(const std::string&,
                  const std::string&)> publishStateEvent;
 
+    /**
+     * @brief   A signal that is emitted when a status value change
+     * @param   key   The name of the status value, e.g. active_module
+     * @param   value The new value
+     *
+     * This signal is used to report the status of the logic core to the node
+     * status document served by the metrics HTTP server. Unlike state events,
+     * status values are not forwarded to other logic cores.
+     */
+    sigc::signal<void(const std::string&, const std::string&)> statusChanged;
+
+    /**
+     * @brief   A signal that is emitted to request a configuration reload
+     *
+     * This signal is emitted when a configuration reload has been requested
+     * from a logic core, e.g. through the command PTY.
+     */
+    sigc::signal<void()> configReloadRequested;
+
   protected:
     /**
      * @brief 	Destructor
@@ -36,6 +36,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 #include <AsyncTimer.h>
 
 #include <Rx.h>
+#include <Metrics.h>
 
 #include "version/SVXLINK.h"
 #include "Logic.h"
@@ -49,9 +50,10 @@ using namespace Async;
 Module::Module(void *dl_handle, Logic *logic, const string& cfg_name)
   : m_dl_handle(dl_handle), m_logic(logic), m_id(-1), m_name(cfg_name),
     m_is_transmitting(false), m_is_active(false), m_cfg_name(cfg_name),
-    m_tmo_timer(0), m_mute_linking(true)
+    m_tmo_timer(0), m_mute_linking(true), m_sql_close_pending(false),
+    m_metric_reaction(0)
 {
-  
+  timerclear(&m_sql_close_timestamp);
 } /* Module::Module */
 
 
@@ -83,6 +85,13 @@ bool Module::initialize(void)
   }
 
   cfg().getValue(cfgName(), "MUTE_LOGIC_LINKING", m_mute_linking);
+  cfg().getValue(cfgName(), "TCL_IGNORE_EVENTS", m_tcl_ignore_events, true);
+
+  m_metric_reaction = &SvxLink::Metrics::instance()->histogram(
+      "svxlink_module_reaction_seconds",
+      "Time from squelch close to the module reacting to it",
+      SvxLink::Metrics::exponentialBuckets(0.01, 2.0, 12),
+      {{"logic", logicName()}, {"module", name()}});
 
   list<string> vars = cfg().listSection(cfgName());
   list<string>::const_iterator cfgit;
@@ -136,6 +145,7 @@ void Module::deactivate(void)
   processEvent("deactivating_module");
   
   m_is_active = false;
+  m_sql_close_pending = false;
 
   setIdle(true);
   m_logic->setMuteLinking(false);
@@ -168,10 +178,25 @@ void Module::dtmfCmdReceivedWhenIdle(const std::string &cmd)
 } /* Module::dtmfCmdReceivedWhenIdle */
 
 
+void Module::squelchStateChanged(bool is_open)
+{
+  m_sql_close_pending = !is_open;
+  if (!is_open)
+  {
+    gettimeofday(&m_sql_close_timestamp, NULL);
+  }
+  squelchOpen(is_open);
+} /* Module::squelchStateChanged */
+
+
 void Module::processEvent(const string& event)
 {
-  logic()->processEvent(event, this);
-} /* Module::playFile */
+  eventEmitted(this, event);
+  if (m_tcl_ignore_events.count(event.substr(0, event.find(' '))) == 0)
+  {
+    logic()->processEvent(event, this);
+  }
+} /* Module::processEvent */
 
 
 void Module::setEventVariable(const string& name, const string& value)
@@ -292,6 +317,20 @@ bool Module::isWritingMessage(void)
 } /* Module::isWritingMessage */
 
 
+void Module::squelchCloseHandled(void)
+{
+  if (!m_sql_close_pending || (m_metric_reaction == 0))
+  {
+    return;
+  }
+  m_sql_close_pending = false;
+  struct timeval now, diff_tv;
+  gettimeofday(&now, NULL);
+  timersub(&now, &m_sql_close_timestamp, &diff_tv);
+  m_metric_reaction->observe(diff_tv.tv_sec + diff_tv.tv_usec / 1.0e6);
+} /* Module::squelchCloseHandled */
+
+
 void Module::moduleTimeout(Timer *t)
 {
   cout << logic()->name() << ": Module timeout: " << name() << endl;
@@ -41,8 +41,11 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 #include <dlfcn.h>
 #include <sigc++/sigc++.h>
 
+#include <sys/time.h>
+
 #include <string>
 #include <list>
+#include <set>
 
 
 /****************************************************************************
@@ -76,6 +79,11 @@ namespace Async
   class Timer;
 };
 
+namespace SvxLink
+{
+  class MetricHistogram;
+};
+
 class Logic;
 
 
@@ -364,6 +372,17 @@ class Module : public sigc::trackable, public Async::AudioSink,
      * This function will only be called if this module is active.
      */
     virtual void squelchOpen(bool is_open) {}
+
+    /**
+     * @brief 	Internal function for squelch notification
+     * @param 	is_open \em True when the squelch is open or else \em false
+     *
+     * This function is called by the logic core when the squelch opens or
+     * closes. It records the time of a squelch close, used for the reaction
+     * latency metric, and then calls the squelchOpen function.
+     * Note: This function should NOT be called by the module.
+     */
+    void squelchStateChanged(bool is_open);
     
     /**
      * @brief 	Tell the module that all announcement messages has been played
@@ -412,6 +431,18 @@ class Module : public sigc::trackable, public Async::AudioSink,
     void playFile(const std::string& path);
     
     void sendDtmf(const std::string& digits);
+
+    /**
+     * @brief 	A signal that is emitted for each event that the module emit
+     * @param 	module The module that emitted the event
+     * @param 	event  The event, e.g. "all_played"
+     *
+     * This signal is emitted by the processEvent function before the event
+     * is handed to the Tcl event handler. C++ code can connect to it to react
+     * to module events directly. Events listed in the TCL_IGNORE_EVENTS
+     * configuration variable are only delivered through this signal.
+     */
+    sigc::signal<void(Module*, const std::string&)> eventEmitted;
     
     
   protected:
@@ -491,6 +522,17 @@ class Module : public sigc::trackable, public Async::AudioSink,
      */
     bool isWritingMessage(void);
 
+    /**
+     * @brief   Tell the core that the module has reacted to a squelch close
+     *
+     * A module should call this function when it act on the end of a
+     * transmission, e.g. when it start playing back recorded audio. The time
+     * from the last squelch close is then recorded in the
+     * svxlink_module_reaction_seconds histogram. Only the first call after
+     * each squelch close is recorded.
+     */
+    void squelchCloseHandled(void);
+
     /**
      * @brief   Called when a configuration variable is updated
      * @param   section The name of the configuration section
@@ -510,6 +552,10 @@ class Module : public sigc::trackable, public Async::AudioSink,
     std::string	      m_cfg_name;
     Async::Timer      *m_tmo_timer;
     bool              m_mute_linking;
+    std::set<std::string>     m_tcl_ignore_events;
+    struct timeval            m_sql_close_timestamp;
+    bool                      m_sql_close_pending;
+    SvxLink::MetricHistogram* m_metric_reaction;
     
     void moduleTimeout(Async::Timer *t);
 
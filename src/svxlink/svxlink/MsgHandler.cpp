@@ -8,7 +8,7 @@ This file contains an object that handles the playback of audio clips.
 
 \verbatim
 SvxLink - A Multi Purpose Voice Services System for Ham Radio Use
-Copyright (C) 2003-2015 Tobias Blomberg / SM0SVX
+Copyright (C) 2003-2026 Tobias Blomberg / SM0SVX
 
 This program is free software; you can redistribute it and/or modify
 it under the terms of the GNU General Public License as published by
@@ -38,6 +38,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 #include <sys/stat.h>
 #include <fcntl.h>
 #include <unistd.h>
+#include <dirent.h>
 #include <stdio.h>
 #include <ctype.h>
 #include <math.h>
@@ -47,11 +48,18 @@ extern "C" {
 #include <gsm.h>
 }
 
+#ifdef OGG_MAJOR
+#include <ogg/ogg.h>
+#endif
+
 #include <cassert>
 #include <iostream>
 #include <cstring>
 #include <fstream>
 #include <cerrno>
+#include <memory>
+#include <vector>
+#include <set>
 
 
 
@@ -61,6 +69,9 @@ extern "C" {
  *
  ****************************************************************************/
 
+#include <AsyncAudioSink.h>
+#include <AsyncAudioDecoder.h>
+#include <AsyncAudioToneTable.h>
 
 
 /****************************************************************************
@@ -80,6 +91,7 @@ extern "C" {
  ****************************************************************************/
 
 using namespace std;
+using namespace Async;
 
 
 
@@ -92,6 +104,9 @@ using namespace std;
 //#define WRITE_BLOCK_SIZE    4*160
 #define WRITE_BLOCK_SIZE    256
 
+  // Longer sequences are not put into the sound clip cache
+#define MAX_SEQUENCE_TIME   60
+
 
 
 /****************************************************************************
@@ -106,6 +121,7 @@ class QueueItem
     QueueItem(bool idle_marked) : idle_marked(idle_marked) {}
     virtual ~QueueItem(void) {}
     virtual bool initialize(void) { return true; }
+    virtual void prefetch(void) {}
     virtual int readSamples(float *samples, int len) = 0;
     virtual void unreadSamples(int len) = 0;
     
@@ -134,17 +150,18 @@ class ToneQueueItem : public QueueItem
 {
   public:
     ToneQueueItem(int fq, int amp, int len, int sample_rate, bool idle_marked)
-      : QueueItem(idle_marked), fq(fq), amp(amp),
-      	tone_len(sample_rate * len / 1000), pos(0), sample_rate(sample_rate) {}
+      : QueueItem(idle_marked),
+        table(AudioToneTable::get(abs(fq), sample_rate)),
+        amp((fq < 0) ? -amp / 1000.0f : amp / 1000.0f),
+      	tone_len(sample_rate * len / 1000), pos(0) {}
     int readSamples(float *samples, int len);
     void unreadSamples(int len);
 
   private:
-    int fq;
-    int amp;
-    int tone_len;
-    int pos;
-    int sample_rate;
+    AudioToneTable::Ptr table;
+    float               amp;
+    int                 tone_len;
+    int                 pos;
     
 };
 
@@ -153,18 +170,22 @@ class DtmfQueueItem : public QueueItem
   public:
     DtmfQueueItem(int fqh, int fql, int amp, int len, int sample_rate,
                   bool idle_marked)
-      : QueueItem(idle_marked), fqh(fqh), fql(fql), amp(amp),
-        tone_len(sample_rate * len / 1000), pos(0), sample_rate(sample_rate) {}
+      : QueueItem(idle_marked),
+        table_h(AudioToneTable::get(abs(fqh), sample_rate)),
+        table_l(AudioToneTable::get(abs(fql), sample_rate)),
+        amp_h((fqh < 0) ? -amp / 1000.0f : amp / 1000.0f),
+        amp_l((fql < 0) ? -amp / 1000.0f : amp / 1000.0f),
+        tone_len(sample_rate * len / 1000), pos(0) {}
     int readSamples(float *samples, int len);
     void unreadSamples(int len);
 
   private:
-    int fqh;
-    int fql;
-    int amp;
-    int tone_len;
-    int pos;
-    int sample_rate;
+    AudioToneTable::Ptr table_h;
+    AudioToneTable::Ptr table_l;
+    float               amp_h;
+    float               amp_l;
+    int                 tone_len;
+    int                 pos;
 
 };
 
@@ -242,6 +263,116 @@ class WavFileQueueItem : public QueueItem
     int read16bitValue(uint8_t *ptr, uint16_t *val);
 };
 
+#ifdef OGG_MAJOR
+class OpusFileQueueItem : public QueueItem
+{
+  public:
+    OpusFileQueueItem(const std::string& filename, bool idle_marked)
+      : QueueItem(idle_marked), filename(filename), packet_cnt(0),
+        stream_initialized(false), decoder(0), buf_pos(0), skip(0),
+        is_prefetched(false)
+    {
+      ogg_sync_init(&sync);
+    }
+    ~OpusFileQueueItem(void);
+    bool initialize(void);
+    void prefetch(void);
+    int readSamples(float *samples, int len);
+    void unreadSamples(int len);
+
+  private:
+    class DecodedSink : public AudioSink
+    {
+      public:
+        explicit DecodedSink(vector<float>& buf) : buf(buf) {}
+        int writeSamples(const float *samples, int count)
+        {
+          buf.insert(buf.end(), samples, samples + count);
+          return count;
+        }
+        void flushSamples(void) { sourceAllSamplesFlushed(); }
+
+      private:
+        vector<float>& buf;
+    };
+
+    static const int READ_SIZE = 4096;
+    static const int PREFETCH_SIZE = 256 * 1024;
+
+    string            filename;
+    ifstream          file;
+    ogg_sync_state    sync;
+    ogg_stream_state  stream;
+    unsigned          packet_cnt;
+    bool              stream_initialized;
+    AudioDecoder      *decoder;
+    vector<float>     buf;
+    size_t            buf_pos;
+    size_t            skip;
+    bool              is_prefetched;
+
+    bool decodeNextPacket(void);
+    bool handleHeader(const ogg_packet& packet);
+};
+#endif
+
+class ClipCache
+{
+  public:
+    typedef std::shared_ptr<const std::vector<float> > Clip;
+
+    static ClipCache& instance(void)
+    {
+      static ClipCache cache;
+      return cache;
+    }
+
+    ClipCache(void) : cur_size(0), max_size(0) {}
+    void setMaxSize(size_t size);
+    bool isEnabled(void) const { return max_size > 0; }
+    bool fits(const Clip& clip) const
+    {
+      return cur_size + clipSize(clip) <= max_size;
+    }
+    Clip find(const std::string& path);
+    void insert(const std::string& path, const Clip& clip);
+    bool markPreloaded(const std::string& dir)
+    {
+      return preloaded_dirs.insert(dir).second;
+    }
+    size_t size(void) const { return cur_size; }
+
+  private:
+    typedef std::list<std::pair<std::string, Clip> > LruList;
+
+    LruList                                 lru;
+    std::map<std::string, LruList::iterator> clips;
+    std::set<std::string>                   preloaded_dirs;
+    size_t                                  cur_size;
+    size_t                                  max_size;
+
+    static size_t clipSize(const Clip& clip)
+    {
+      return clip->size() * sizeof(float) + sizeof(LruList::value_type);
+    }
+    void evict(size_t size);
+};
+
+class CachedClipQueueItem : public QueueItem
+{
+  public:
+    CachedClipQueueItem(const ClipCache::Clip& clip, bool idle_marked)
+      : QueueItem(idle_marked), clip(clip), pos(0) {}
+    bool initialize(void) { return clip != nullptr; }
+    int readSamples(float *samples, int len);
+    void unreadSamples(int len);
+
+  private:
+    ClipCache::Clip clip;
+    size_t          pos;
+
+};
+
 
 
 /****************************************************************************
@@ -250,6 +381,13 @@ class WavFileQueueItem : public QueueItem
  *
  ****************************************************************************/
 
+static QueueItem *createFileQueueItem(const std::string& path,
+                                      bool idle_marked);
+static QueueItem *createClipQueueItem(const std::string& path,
+                                      bool idle_marked);
+static ClipCache::Clip loadClip(const std::string& path);
+static bool preloadDir(ClipCache& cache, const std::string& dir, int depth);
+
 
 
 /****************************************************************************
@@ -277,7 +415,7 @@ class WavFileQueueItem : public QueueItem
 
 MsgHandler::MsgHandler(int sample_rate)
   : sample_rate(sample_rate), nesting_level(0), pending_play_next(false),
-    current(0), is_writing_message(false), non_idle_cnt(0)
+    current(0), is_writing_message(false), non_idle_cnt(0), seq_depth(0)
 {
   
 }
@@ -291,26 +429,25 @@ MsgHandler::~MsgHandler(void)
 
 void MsgHandler::playFile(const string& path, bool idle_marked)
 {
-  QueueItem *item = 0;
-  const char *ext = strrchr(path.c_str(), '.');
-  if (strcmp(ext, ".gsm") == 0)
-  {
-    item = new GsmFileQueueItem(path, idle_marked);
-  }
-  else if (strcmp(ext, ".wav") == 0)
+  if (!seq_key.empty())
   {
-    item = new WavFileQueueItem(path, idle_marked);
-  }
-  else
-  {
-    item = new RawFileQueueItem(path, idle_marked);
+    seq_items.push_back([path]() { return createClipQueueItem(path, false); });
   }
+  QueueItem *item = createClipQueueItem(path, idle_marked);
   addItemToQueue(item);
 } /* MsgHandler::playFile */
 
 
 void MsgHandler::playSilence(int length, bool idle_marked)
 {
+  if (!seq_key.empty())
+  {
+    int rate = sample_rate;
+    seq_items.push_back([length, rate]()
+        {
+          return new SilenceQueueItem(length, rate, false);
+        });
+  }
   QueueItem *item = new SilenceQueueItem(length, sample_rate, idle_marked);
   addItemToQueue(item);
 } /* MsgHandler::playSilence */
@@ -318,6 +455,14 @@ void MsgHandler::playSilence(int length, bool idle_marked)
 
 void MsgHandler::playTone(int fq, int amp, int length, bool idle_marked)
 {
+  if (!seq_key.empty())
+  {
+    int rate = sample_rate;
+    seq_items.push_back([fq, amp, length, rate]()
+        {
+          return new ToneQueueItem(fq, amp, length, rate, false);
+        });
+  }
   QueueItem *item = new ToneQueueItem(fq, amp, length, sample_rate,
       	      	      	      	      idle_marked);
   addItemToQueue(item);
@@ -349,6 +494,14 @@ void MsgHandler::playDtmf(char digit, int amp, int length, bool idle_marked)
 
   if (fql > 0)
   {
+    if (!seq_key.empty())
+    {
+      int rate = sample_rate;
+      seq_items.push_back([fqh, fql, amp, length, rate]()
+          {
+            return new DtmfQueueItem(fqh, fql, amp, length, rate, false);
+          });
+    }
     QueueItem *item = new DtmfQueueItem(fqh, fql, amp, length, sample_rate,
                                         idle_marked);
     addItemToQueue(item);
@@ -396,6 +549,102 @@ void MsgHandler::end(void)
 } /* MsgHandler::end */
 
 
+void MsgHandler::setClipCacheSize(size_t max_size)
+{
+  ClipCache::instance().setMaxSize(max_size);
+} /* MsgHandler::setClipCacheSize */
+
+
+void MsgHandler::preloadClips(const std::string& dir)
+{
+  ClipCache& cache = ClipCache::instance();
+  if (!cache.isEnabled() || !cache.markPreloaded(dir))
+  {
+    return;
+  }
+  size_t prev_size = cache.size();
+  preloadDir(cache, dir, 0);
+  cout << "--- Preloaded " << (cache.size() - prev_size) / 1024
+       << "kB of sound clips from \"" << dir << "\"\n";
+} /* MsgHandler::preloadClips */
+
+
+bool MsgHandler::beginSequence(const std::string& key, bool idle_marked)
+{
+  if (seq_depth > 0)
+  {
+      // A nested sequence is cached as part of the outermost one
+    ++seq_depth;
+    return true;
+  }
+
+  ClipCache& cache = ClipCache::instance();
+  if (cache.isEnabled() && !key.empty())
+  {
+    ClipCache::Clip clip = cache.find("sequence:" + key);
+    if (clip != nullptr)
+    {
+      addItemToQueue(new CachedClipQueueItem(clip, idle_marked));
+      return false;
+    }
+    seq_key = key;
+    seq_items.clear();
+  }
+  ++seq_depth;
+  return true;
+} /* MsgHandler::beginSequence */
+
+
+void MsgHandler::endSequence(bool store)
+{
+  if ((seq_depth == 0) || (--seq_depth > 0))
+  {
+    return;
+  }
+
+  string key;
+  key.swap(seq_key);
+  vector<std::function<QueueItem*(void)> > items;
+  items.swap(seq_items);
+  if (!store || key.empty() || items.empty())
+  {
+    return;
+  }
+
+    // The sequence is rendered from the sound clip cache so this is a
+    // memory copy for the clips that are already cached
+  const size_t max_len = MAX_SEQUENCE_TIME * sample_rate;
+  std::shared_ptr<vector<float> > buf(new vector<float>);
+  float block[WRITE_BLOCK_SIZE];
+  for (auto& create_item : items)
+  {
+    std::unique_ptr<QueueItem> item(create_item());
+    if (!item->initialize())
+    {
+        // Do not cache a sequence with missing clips
+      return;
+    }
+    int cnt;
+    while ((cnt = item->readSamples(block, WRITE_BLOCK_SIZE)) > 0)
+    {
+      buf->insert(buf->end(), block, block + cnt);
+    }
+    if (buf->size() > max_len)
+    {
+      return;
+    }
+  }
+
+  buf->shrink_to_fit();
+  ClipCache& cache = ClipCache::instance();
+  key = "sequence:" + key;
+  if (cache.find(key) == nullptr)
+  {
+    cache.insert(key, buf);
+  }
+} /* MsgHandler::endSequence */
+
+
 void MsgHandler::resumeOutput(void)
 {
   if (current != 0)
@@ -441,6 +690,7 @@ void MsgHandler::addItemToQueue(QueueItem *item)
   {
     playMsg();
   }
+  prefetchNext();
 } /* MsgHandler::addItemToQueue */
 
 
@@ -473,11 +723,23 @@ void MsgHandler::playMsg(void)
   }
   else
   {
+    prefetchNext();
     writeSamples();
   }
 } /* MsgHandler::playMsg */
 
 
+void MsgHandler::prefetchNext(void)
+{
+    // Let the next item prepare while the current one is playing so that
+    // starting it does not delay the audio
+  if ((current != 0) && !msg_queue.empty())
+  {
+    msg_queue.front()->prefetch();
+  }
+} /* MsgHandler::prefetchNext */
+
+
 void MsgHandler::writeSamples(void)
 {
   float buf[WRITE_BLOCK_SIZE];
@@ -997,6 +1259,187 @@ int WavFileQueueItem::read16bitValue(uint8_t *ptr, uint16_t *val)
 
 
 
+#ifdef OGG_MAJOR
+/****************************************************************************
+ *
+ * Private member functions for class OpusFileQueueItem
+ *
+ ****************************************************************************/
+
+OpusFileQueueItem::~OpusFileQueueItem(void)
+{
+  delete decoder;
+  if (stream_initialized)
+  {
+    ogg_stream_clear(&stream);
+  }
+  ogg_sync_clear(&sync);
+} /* OpusFileQueueItem::~OpusFileQueueItem */
+
+
+bool OpusFileQueueItem::initialize(void)
+{
+  prefetch();
+  if (!file.is_open())
+  {
+    cerr << "*** WARNING: Could not find audio file \"" << filename << "\"\n";
+    return false;
+  }
+
+  decoder = AudioDecoder::create("OPUS");
+  if (decoder == 0)
+  {
+    cerr << "*** WARNING: Could not play audio file \"" << filename
+         << "\". The Opus codec is not available.\n";
+    return false;
+  }
+  decoder->registerSink(new DecodedSink(buf), true);
+
+  return true;
+
+} /* OpusFileQueueItem::initialize */
+
+
+void OpusFileQueueItem::prefetch(void)
+{
+  if (is_prefetched)
+  {
+    return;
+  }
+  is_prefetched = true;
+
+    // Read the start of the file into the Ogg sync buffer while the
+    // previous item is playing. Since Opus clips are small, most of them
+    // fit completely so no file access is needed during playback. Longer
+    // files are read further on demand.
+  file.open(filename.c_str(), ios::in | ios::binary);
+  if (file)
+  {
+    char *data = ogg_sync_buffer(&sync, PREFETCH_SIZE);
+    file.read(data, PREFETCH_SIZE);
+    if (file.gcount() > 0)
+    {
+      ogg_sync_wrote(&sync, file.gcount());
+    }
+    file.clear();
+  }
+} /* OpusFileQueueItem::prefetch */
+
+
+int OpusFileQueueItem::readSamples(float *samples, int len)
+{
+  if ((buf_pos == buf.size()) && !decodeNextPacket())
+  {
+    return 0;
+  }
+
+  int read_cnt = min(static_cast<size_t>(len), buf.size() - buf_pos);
+  memcpy(samples, &buf[buf_pos], read_cnt * sizeof(*samples));
+  buf_pos += read_cnt;
+
+  return read_cnt;
+
+} /* OpusFileQueueItem::readSamples */
+
+
+void OpusFileQueueItem::unreadSamples(int len)
+{
+  if (static_cast<size_t>(len) > buf_pos)
+  {
+    cerr << "*** WARNING: Trying to unread more Opus samples then was "
+            "previously read." << endl;
+    return;
+  }
+
+  buf_pos -= len;
+
+} /* OpusFileQueueItem::unreadSamples */
+
+
+bool OpusFileQueueItem::decodeNextPacket(void)
+{
+    // The file is read one block at a time and decoded one packet at a time
+    // so that only a few milliseconds of audio is held in memory
+  for (;;)
+  {
+    ogg_packet packet;
+    if (stream_initialized && (ogg_stream_packetout(&stream, &packet) == 1))
+    {
+      if (packet_cnt++ < 2)
+      {
+        if (!handleHeader(packet))
+        {
+          return false;
+        }
+        continue;
+      }
+      buf.clear();
+      buf_pos = 0;
+      decoder->writeEncodedSamples(packet.packet, packet.bytes);
+      size_t skip_cnt = min(skip, buf.size());
+      buf_pos = skip_cnt;
+      skip -= skip_cnt;
+      if (buf_pos < buf.size())
+      {
+        return true;
+      }
+      continue;
+    }
+
+    ogg_page page;
+    int ret = ogg_sync_pageout(&sync, &page);
+    if (ret == 1)
+    {
+      if (!stream_initialized)
+      {
+        ogg_stream_init(&stream, ogg_page_serialno(&page));
+        stream_initialized = true;
+      }
+        // Pages belonging to other logical streams are rejected here
+      ogg_stream_pagein(&stream, &page);
+      continue;
+    }
+    else if (ret < 0)
+    {
+      cerr << "*** WARNING: Corrupt Ogg/Opus file: " << filename << endl;
+      continue;
+    }
+
+    if (file.eof())
+    {
+      return false;
+    }
+    char *data = ogg_sync_buffer(&sync, READ_SIZE);
+    file.read(data, READ_SIZE);
+    if (file.gcount() <= 0)
+    {
+      return false;
+    }
+    ogg_sync_wrote(&sync, file.gcount());
+  }
+} /* OpusFileQueueItem::decodeNextPacket */
+
+
+bool OpusFileQueueItem::handleHeader(const ogg_packet& packet)
+{
+  if (packet_cnt == 1)
+  {
+    if ((packet.bytes < 19) ||
+        (memcmp(packet.packet, "OpusHead", 8) != 0))
+    {
+      cerr << "*** WARNING: Not an Ogg/Opus file: " << filename << endl;
+      return false;
+    }
+      // The pre-skip is given at 48kHz in little endian byte order
+    unsigned pre_skip = packet.packet[10] | (packet.packet[11] << 8);
+    skip = static_cast<size_t>(pre_skip) * INTERNAL_SAMPLE_RATE / 48000;
+  }
+  return true;
+} /* OpusFileQueueItem::handleHeader */
+#endif /* OGG_MAJOR */
+
+
+
 /****************************************************************************
  *
  * Private member functions for class SilenceQueueItem
@@ -1038,12 +1481,10 @@ void SilenceQueueItem::unreadSamples(int len)
 
 int ToneQueueItem::readSamples(float *samples, int len)
 {
+    // The tone is copied from a table holding one period of the waveform
   int read_cnt = min(len, tone_len-pos);
-  for (int i=0; i<read_cnt; ++i)
-  {
-    samples[i] = amp / 1000.0 * sin(2 * M_PI * fq * pos / sample_rate);
-    ++pos;
-  }
+  table->read(samples, pos, read_cnt, amp);
+  pos += read_cnt;
   
   return read_cnt;
   
@@ -1066,13 +1507,9 @@ void ToneQueueItem::unreadSamples(int len)
 int DtmfQueueItem::readSamples(float *samples, int len)
 {
   int read_cnt = min(len, tone_len-pos);
-  for (int i=0; i<read_cnt; ++i)
-  {
-    samples[i] = amp / 1000.0 * (
-                sin(2 * M_PI * fqh * pos / sample_rate) +
-                sin(2 * M_PI * fql * pos / sample_rate));
-    ++pos;
-  }
+  table_h->read(samples, pos, read_cnt, amp_h);
+  table_l->add(samples, pos, read_cnt, amp_l);
+  pos += read_cnt;
 
   return read_cnt;
 } /* DtmfQueueItem::readSamples */
@@ -1085,6 +1522,225 @@ void DtmfQueueItem::unreadSamples(int len)
 
 
 
+/****************************************************************************
+ *
+ * Private member functions for class ClipCache
+ *
+ ****************************************************************************/
+
+void ClipCache::setMaxSize(size_t size)
+{
+  max_size = size;
+  evict(0);
+} /* ClipCache::setMaxSize */
+
+
+ClipCache::Clip ClipCache::find(const std::string& path)
+{
+  std::map<std::string, LruList::iterator>::iterator it = clips.find(path);
+  if (it == clips.end())
+  {
+    return nullptr;
+  }
+  lru.splice(lru.begin(), lru, it->second);
+  return it->second->second;
+} /* ClipCache::find */
+
+
+void ClipCache::insert(const std::string& path, const Clip& clip)
+{
+  assert(clips.find(path) == clips.end());
+  size_t size = clipSize(clip);
+  if (size > max_size)
+  {
+    return;
+  }
+  evict(size);
+  lru.push_front(std::make_pair(path, clip));
+  clips[path] = lru.begin();
+  cur_size += size;
+} /* ClipCache::insert */
+
+
+void ClipCache::evict(size_t size)
+{
+    // Clips that are currently playing are kept alive by the queue items
+    // that use them, so they can safely be dropped from the cache here
+  while (!lru.empty() && (cur_size + size > max_size))
+  {
+    cur_size -= clipSize(lru.back().second);
+    clips.erase(lru.back().first);
+    lru.pop_back();
+  }
+} /* ClipCache::evict */
+
+
+
+/****************************************************************************
+ *
+ * Private member functions for class CachedClipQueueItem
+ *
+ ****************************************************************************/
+
+int CachedClipQueueItem::readSamples(float *samples, int len)
+{
+  assert(clip != nullptr);
+  int read_cnt = min(static_cast<size_t>(len), clip->size() - pos);
+  memcpy(samples, clip->data() + pos, sizeof(*samples) * read_cnt);
+  pos += read_cnt;
+  return read_cnt;
+} /* CachedClipQueueItem::readSamples */
+
+
+void CachedClipQueueItem::unreadSamples(int len)
+{
+  assert(static_cast<size_t>(len) <= pos);
+  pos -= len;
+} /* CachedClipQueueItem::unreadSamples */
+
+
+
+/****************************************************************************
+ *
+ * Local functions
+ *
+ ****************************************************************************/
+
+static QueueItem *createFileQueueItem(const std::string& path,
+                                      bool idle_marked)
+{
+  const char *ext = strrchr(path.c_str(), '.');
+  if ((ext != 0) && (strcmp(ext, ".gsm") == 0))
+  {
+    return new GsmFileQueueItem(path, idle_marked);
+  }
+  else if ((ext != 0) && (strcmp(ext, ".wav") == 0))
+  {
+    return new WavFileQueueItem(path, idle_marked);
+  }
+#ifdef OGG_MAJOR
+  else if ((ext != 0) && (strcmp(ext, ".opus") == 0))
+  {
+    return new OpusFileQueueItem(path, idle_marked);
+  }
+#endif
+  return new RawFileQueueItem(path, idle_marked);
+} /* createFileQueueItem */
+
+
+static QueueItem *createClipQueueItem(const std::string& path,
+                                      bool idle_marked)
+{
+  ClipCache& cache = ClipCache::instance();
+  if (!cache.isEnabled())
+  {
+    return createFileQueueItem(path, idle_marked);
+  }
+
+    // On a cache miss the whole file is decoded right away. A clip that
+    // could not be loaded give an item that fail to initialize, just like
+    // a missing file does when played directly.
+  ClipCache::Clip clip = cache.find(path);
+  if (clip == nullptr)
+  {
+    clip = loadClip(path);
+    if (clip != nullptr)
+    {
+      cache.insert(path, clip);
+    }
+  }
+  return new CachedClipQueueItem(clip, idle_marked);
+} /* createClipQueueItem */
+
+
+static ClipCache::Clip loadClip(const std::string& path)
+{
+    // Decode the whole file using the normal file queue items so that a
+    // cached clip sound exactly the same as when it is played directly
+  std::unique_ptr<QueueItem> item(createFileQueueItem(path, false));
+  if (!item->initialize())
+  {
+    return nullptr;
+  }
+  std::shared_ptr<std::vector<float> > clip(new std::vector<float>);
+  float buf[WRITE_BLOCK_SIZE];
+  int read_cnt;
+  while ((read_cnt = item->readSamples(buf, WRITE_BLOCK_SIZE)) > 0)
+  {
+    clip->insert(clip->end(), buf, buf + read_cnt);
+  }
+  clip->shrink_to_fit();
+  return clip;
+} /* loadClip */
+
+
+static bool preloadDir(ClipCache& cache, const std::string& dir, int depth)
+{
+  static const int MAX_DEPTH = 8;
+
+  DIR *dirp = opendir(dir.c_str());
+  if (dirp == 0)
+  {
+    cerr << "*** WARNING: Could not open sound clip directory \""
+         << dir << "\": " << strerror(errno) << endl;
+    return true;
+  }
+
+  bool has_room = true;
+  struct dirent *entry;
+  while (has_room && ((entry = readdir(dirp)) != 0))
+  {
+    if (entry->d_name[0] == '.')
+    {
+      continue;
+    }
+    string path = dir + "/" + entry->d_name;
+    struct stat st;
+    if (stat(path.c_str(), &st) != 0)
+    {
+      continue;
+    }
+    if (S_ISDIR(st.st_mode))
+    {
+      if (depth < MAX_DEPTH)
+      {
+        has_room = preloadDir(cache, path, depth + 1);
+      }
+      continue;
+    }
+    const char *ext = strrchr(entry->d_name, '.');
+    bool is_clip = (ext != 0) &&
+        ((strcmp(ext, ".wav") == 0) || (strcmp(ext, ".gsm") == 0) ||
+         (strcmp(ext, ".raw") == 0));
+#ifdef OGG_MAJOR
+    is_clip = is_clip || ((ext != 0) && (strcmp(ext, ".opus") == 0));
+#endif
+    if (!S_ISREG(st.st_mode) || !is_clip)
+    {
+      continue;
+    }
+    if (cache.find(path) != nullptr)
+    {
+      continue;
+    }
+    ClipCache::Clip clip = loadClip(path);
+    if (clip == nullptr)
+    {
+      continue;
+    }
+      // Do not push out clips that were preloaded earlier
+    has_room = cache.fits(clip);
+    if (has_room)
+    {
+      cache.insert(path, clip);
+    }
+  }
+  closedir(dirp);
+  return has_room;
+} /* preloadDir */
+
+
+
 /*
  * This file has not been truncated
  */
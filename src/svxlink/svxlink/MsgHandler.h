@@ -8,7 +8,7 @@ This file contains an object that handles the playback of audio clips.
 
 \verbatim
 SvxLink - A Multi Purpose Voice Services System for Ham Radio Use
-Copyright (C) 2003-2015 Tobias Blomberg / SM0SVX
+Copyright (C) 2003-2026 Tobias Blomberg / SM0SVX
 
 This program is free software; you can redistribute it and/or modify
 it under the terms of the GNU General Public License as published by
@@ -41,6 +41,8 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 #include <string>
 #include <list>
 #include <map>
+#include <vector>
+#include <functional>
 
 #include <sigc++/sigc++.h>
 
@@ -226,6 +228,60 @@ class MsgHandler : public sigc::trackable, public Async::AudioSource
      * This function is normally only called from a connected sink object.
      */
     virtual void resumeOutput(void);
+
+    /**
+     * @brief   Set the size of the sound clip cache
+     * @param   max_size The maximum number of bytes of decoded audio to keep
+     *
+     * The sound clip cache is shared by all message handlers in the process.
+     * When enabled, each played audio file is decoded once and kept in
+     * memory so that later playbacks do not have to read the file again. The
+     * least recently used clips are dropped when the cache is full. Setting
+     * the size to zero, which is the default, disable the cache.
+     */
+    static void setClipCacheSize(size_t max_size);
+
+    /**
+     * @brief   Load all audio files in a directory into the sound clip cache
+     * @param   dir The directory to load audio files from
+     *
+     * All .wav, .gsm, .raw and .opus files in the given directory, and in its
+     * subdirectories, are decoded and put into the sound clip cache until
+     * the cache is full. A directory that has already been preloaded is
+     * skipped so this function may be called once per logic. Nothing is done
+     * if the cache is disabled.
+     */
+    static void preloadClips(const std::string& dir);
+
+    /**
+     * @brief   Begin a cached sequence of messages
+     * @param   key         A key that uniquely identify the sequence
+     * @param   idle_marked Choose if the playback should be idle marked or not
+     * @return  Returns \em true if the caller should queue the messages in
+     *          the sequence, followed by a call to endSequence
+     *
+     * A sequence is a number of messages, e.g. a voice identification, that
+     * is rendered into one contiguous buffer and put into the sound clip
+     * cache when the sequence is ended. The next time a sequence with the
+     * same key is begun, the rendered sequence is queued as one item and
+     * \em false is returned so that the caller can skip queueing the
+     * individual messages. The key must include everything that affect the
+     * content of the sequence. Sequences may be nested but only the
+     * outermost one is cached. If the sound clip cache is disabled, this
+     * function always return \em true.
+     */
+    bool beginSequence(const std::string& key, bool idle_marked=false);
+
+    /**
+     * @brief   End a cached sequence of messages
+     * @param   store Set to \em false to not cache the sequence
+     *
+     * Must be called once for each call to beginSequence that returned
+     * \em true. The messages have already been queued for playback when
+     * this function is called so the rendering is only done to fill the
+     * cache.
+     */
+    void endSequence(bool store=true);
     
   protected:
     /**
@@ -245,10 +301,14 @@ class MsgHandler : public sigc::trackable, public Async::AudioSource
     QueueItem 	      	    *current;
     bool      	      	    is_writing_message;
     int       	      	    non_idle_cnt;
+    int                     seq_depth;
+    std::string             seq_key;
+    std::vector<std::function<QueueItem*(void)> > seq_items;
     
     MsgHandler(const MsgHandler&);
     MsgHandler& operator=(const MsgHandler&);
     void addItemToQueue(QueueItem *item);
+    void prefetchNext(void);
     void playMsg(void);
     void writeSamples(void);
     void deleteQueueItem(QueueItem *item);
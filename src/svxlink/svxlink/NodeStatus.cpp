@@ -0,0 +1,245 @@
+/**
+@file	 NodeStatus.cpp
+@brief   A cached status document for the node
+@author  Tobias Blomberg / SM0SVX
+@date	 2026-10-15
+
+\verbatim
+SvxLink - A Multi Purpose Voice Services System for Ham Radio Use
+Copyright (C) 2003-2026 Tobias Blomberg / SM0SVX
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+\endverbatim
+*/
+
+/****************************************************************************
+ *
+ * System Includes
+ *
+ ****************************************************************************/
+
+#include <json/json.h>
+
+#include <sstream>
+#include <ctime>
+
+
+/****************************************************************************
+ *
+ * Project Includes
+ *
+ ****************************************************************************/
+
+#include <AsyncApplication.h>
+
+
+/****************************************************************************
+ *
+ * Local Includes
+ *
+ ****************************************************************************/
+
+#include "NodeStatus.h"
+#include "LogicBase.h"
+
+
+/****************************************************************************
+ *
+ * Namespaces to use
+ *
+ ****************************************************************************/
+
+using namespace std;
+using namespace Async;
+
+
+
+/****************************************************************************
+ *
+ * Defines & typedefs
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Local class definitions
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Prototypes
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Exported Global Variables
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Local Global Variables
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Public member functions
+ *
+ ****************************************************************************/
+
+NodeStatus::NodeStatus(void)
+  : m_doc(Json::objectValue)
+{
+  m_doc["started"] = static_cast<Json::Int64>(time(NULL));
+  m_doc["logics"] = Json::Value(Json::objectValue);
+  m_doc["event_loop"] = Json::Value(Json::objectValue);
+} /* NodeStatus::NodeStatus */
+
+
+NodeStatus::~NodeStatus(void)
+{
+} /* NodeStatus::~NodeStatus */
+
+
+void NodeStatus::addLogic(LogicBase* logic)
+{
+  Json::Value& logic_status = m_doc["logics"][logic->name()];
+  logic_status["type"] = logic->type();
+  logic_status["idle"] = logic->isIdle();
+  logic_status["status"] = Json::Value(Json::objectValue);
+  logic_status["state_events"] = Json::Value(Json::objectValue);
+  m_dirty = true;
+
+  logic->publishStateEvent.connect(
+      sigc::bind(sigc::mem_fun(*this, &NodeStatus::onStateEvent),
+                 logic->name()));
+  logic->statusChanged.connect(
+      sigc::bind(sigc::mem_fun(*this, &NodeStatus::onStatusChanged),
+                 logic->name()));
+  logic->idleStateChanged.connect(
+      sigc::bind(sigc::mem_fun(*this, &NodeStatus::onIdleStateChanged),
+                 logic->name()));
+} /* NodeStatus::addLogic */
+
+
+const std::string& NodeStatus::json(void)
+{
+  updateLoopStats();
+  if (m_dirty)
+  {
+    Json::StreamWriterBuilder builder;
+    builder["commentStyle"] = "None";
+    builder["indentation"] = "";
+    m_json = Json::writeString(builder, m_doc);
+    m_json += "\n";
+    m_dirty = false;
+  }
+  return m_json;
+} /* NodeStatus::json */
+
+
+
+/****************************************************************************
+ *
+ * Protected member functions
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Private member functions
+ *
+ ****************************************************************************/
+
+void NodeStatus::onStateEvent(const std::string& event_name,
+                              const std::string& data,
+                              const std::string& logic_name)
+{
+    // Most state events carry a JSON object which is stored as such. Other
+    // events are stored as a string.
+  Json::Value value(data);
+  if (!data.empty() && (data[0] == '{'))
+  {
+    Json::CharReaderBuilder builder;
+    std::istringstream is(data);
+    std::string errs;
+    Json::Value obj;
+    if (Json::parseFromStream(builder, is, &obj, &errs))
+    {
+      value = obj;
+    }
+  }
+  m_doc["logics"][logic_name]["state_events"][event_name] = value;
+  m_dirty = true;
+} /* NodeStatus::onStateEvent */
+
+
+void NodeStatus::onStatusChanged(const std::string& key,
+                                 const std::string& value,
+                                 const std::string& logic_name)
+{
+  m_doc["logics"][logic_name]["status"][key] = value;
+  m_dirty = true;
+} /* NodeStatus::onStatusChanged */
+
+
+void NodeStatus::onIdleStateChanged(bool is_idle,
+                                    const std::string& logic_name)
+{
+  m_doc["logics"][logic_name]["idle"] = is_idle;
+  m_dirty = true;
+} /* NodeStatus::onIdleStateChanged */
+
+
+void NodeStatus::updateLoopStats(void)
+{
+  const auto now = std::chrono::steady_clock::now();
+  if (now - m_loop_stats_updated <
+      std::chrono::milliseconds(LOOP_STATS_INTERVAL))
+  {
+    return;
+  }
+  m_loop_stats_updated = now;
+
+  const Application::LoopStats& stats = Application::app().loopStats();
+  Json::Value& loop = m_doc["event_loop"];
+  loop["iterations"] = static_cast<Json::UInt64>(stats.iterations);
+  loop["busy_us"] = static_cast<Json::UInt64>(stats.busy_us);
+  loop["timer_expirations"] =
+    static_cast<Json::UInt64>(stats.timer_expirations);
+  loop["timer_lag_ms"] = static_cast<Json::UInt64>(stats.timer_lag_ms);
+  m_dirty = true;
+} /* NodeStatus::updateLoopStats */
+
+
+
+/*
+ * This file has not been truncated
+ */
@@ -0,0 +1,179 @@
+/**
+@file	 NodeStatus.h
+@brief   A cached status document for the node
+@author  Tobias Blomberg / SM0SVX
+@date	 2026-10-15
+
+\verbatim
+SvxLink - A Multi Purpose Voice Services System for Ham Radio Use
+Copyright (C) 2003-2026 Tobias Blomberg / SM0SVX
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+\endverbatim
+*/
+
+#ifndef NODE_STATUS_INCLUDED
+#define NODE_STATUS_INCLUDED
+
+
+/****************************************************************************
+ *
+ * System Includes
+ *
+ ****************************************************************************/
+
+#include <sigc++/sigc++.h>
+#include <json/json.h>
+
+#include <string>
+#include <chrono>
+
+
+/****************************************************************************
+ *
+ * Project Includes
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Local Includes
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Forward declarations
+ *
+ ****************************************************************************/
+
+class LogicBase;
+
+
+/****************************************************************************
+ *
+ * Namespace
+ *
+ ****************************************************************************/
+
+//namespace MyNameSpace
+//{
+
+
+/****************************************************************************
+ *
+ * Forward declarations of classes inside of the declared namespace
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Defines & typedefs
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Exported Global Variables
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Class definitions
+ *
+ ****************************************************************************/
+
+/**
+@brief	A cached status document for the node
+@author Tobias Blomberg / SM0SVX
+@date   2026-10-15
+
+This class keep a JSON document describing the state of the node, which is
+served by the metrics HTTP server at /status. The document is updated a piece
+at a time as state events and status changes are reported by the logic cores,
+e.g. squelch state, signal level, active module and reflector connection
+state. The document is only serialized again when it has been changed so
+that polling it just cost a string copy.
+
+The event loop statistics change all the time so they are only updated when
+the document is requested, at most once a second.
+*/
+class NodeStatus : public sigc::trackable
+{
+  public:
+    /**
+     * @brief 	Default constructor
+     */
+    NodeStatus(void);
+
+    /**
+     * @brief 	Destructor
+     */
+    ~NodeStatus(void);
+
+    /**
+     * @brief 	Start tracking the status of a logic core
+     * @param 	logic The logic core to track
+     */
+    void addLogic(LogicBase* logic);
+
+    /**
+     * @brief 	Get the status document
+     * @return	Return the status document in JSON format
+     */
+    const std::string& json(void);
+
+  protected:
+
+  private:
+    static const unsigned LOOP_STATS_INTERVAL = 1000; // Milliseconds
+
+    Json::Value                           m_doc;
+    std::string                           m_json;
+    bool                                  m_dirty = true;
+    std::chrono::steady_clock::time_point m_loop_stats_updated;
+
+    NodeStatus(const NodeStatus&);
+    NodeStatus& operator=(const NodeStatus&);
+    void onStateEvent(const std::string& event_name, const std::string& data,
+                      const std::string& logic_name);
+    void onStatusChanged(const std::string& key, const std::string& value,
+                         const std::string& logic_name);
+    void onIdleStateChanged(bool is_idle, const std::string& logic_name);
+    void updateLoopStats(void);
+
+};  /* class NodeStatus */
+
+
+//} /* namespace */
+
+#endif /* NODE_STATUS_INCLUDED */
+
+
+
+/*
+ * This file has not been truncated
+ */
@@ -55,6 +55,8 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 #include <AsyncConfig.h>
 #include <AsyncTimer.h>
 #include <AsyncExec.h>
+#include <AsyncWorkerPool.h>
+#include <AsyncAtTimer.h>
 
 
 /****************************************************************************
@@ -142,7 +144,9 @@ namespace {
 QsoRecorder::QsoRecorder(Logic *logic)
   : recorder(0), hard_chunk_limit(0), soft_chunk_limit(0), max_dirsize(0),
     default_active(false), tmo_timer(0), logic(logic), qso_tmo_timer(0),
-    min_samples(0)
+    min_samples(0), file_ext(".wav"), write_pool(0), write_buffer_time(10),
+    write_flush_interval(1000), shard_time(0), shard_timer(0),
+    write_index(false)
 {
   selector = new AudioSelector;
 } /* QsoRecorder::QsoRecorder */
@@ -154,6 +158,13 @@ QsoRecorder::~QsoRecorder(void)
   delete selector;
   delete tmo_timer;
   delete qso_tmo_timer;
+  delete shard_timer;
+  if (write_pool != 0)
+  {
+      // Let the last file be completely written before the pool is removed
+    write_pool->waitForIdle();
+    delete write_pool;
+  }
 } /* QsoRecorder::~QsoRecorder */
 
 
@@ -175,6 +186,38 @@ bool QsoRecorder::initialize(const Config &cfg, const string &name)
   cfg.getValue(name, "MAX_DIRSIZE", max_dirsize);
   setMaxRecDirSize(max_dirsize * 1024 * 1024);
 
+  string file_format("wav");
+  cfg.getValue(name, "FILE_FORMAT", file_format);
+  if ((file_format != "wav") && (file_format != "opus"))
+  {
+    cerr << "*** ERROR: Unknown file format \"" << file_format
+         << "\" specified in " << name << "/FILE_FORMAT. "
+         << "Valid values are \"wav\" or \"opus\"\n";
+    return false;
+  }
+  file_ext = "." + file_format;
+
+  bool background_write = false;
+  cfg.getValue(name, "BACKGROUND_WRITE", background_write);
+  if (background_write)
+  {
+    cfg.getValue(name, "WRITE_BUFFER_TIME", write_buffer_time);
+    cfg.getValue(name, "WRITE_FLUSH_INTERVAL", write_flush_interval);
+    write_pool = new WorkerPool(1);
+    if (!write_pool->initOk())
+    {
+      cerr << "*** ERROR: Could not start the QSO recorder file writer "
+              "thread in logic " << logic->name() << endl;
+      return false;
+    }
+  }
+
+  unsigned shard_time = 0;
+  cfg.getValue(name, "SHARD_TIME", shard_time);
+  setShardTime(shard_time);
+
+  cfg.getValue(name, "WRITE_INDEX", write_index);
+
   cfg.getValue(name, "DEFAULT_ACTIVE", default_active);
   setEnabled(default_active);
 
@@ -205,7 +248,7 @@ bool QsoRecorder::initialize(const Config &cfg, const string &name)
   cfg.getValue(name, "ENCODER_CMD", encoder_cmd);
 
   logic->idleStateChanged.connect(
-      hide(mem_fun(*this, &QsoRecorder::checkTimeoutTimers)));
+      mem_fun(*this, &QsoRecorder::onIdleStateChanged));
 
   return true;
 } /* QsoRecorder::initialize */
@@ -251,6 +294,31 @@ void QsoRecorder::setMaxRecDirSize(unsigned max_size)
 } /* QsoRecorder::setMaxRecDirSize */
 
 
+void QsoRecorder::setShardTime(unsigned shard_time)
+{
+  this->shard_time = shard_time;
+  if (shard_time == 0)
+  {
+    delete shard_timer;
+    shard_timer = 0;
+    return;
+  }
+  if (shard_timer == 0)
+  {
+    shard_timer = new AtTimer;
+      // Make sure that time() has passed the boundary when the next shard
+      // timeout is calculated
+    shard_timer->setExpireOffset(100);
+    shard_timer->expired.connect(
+        hide(mem_fun(*this, &QsoRecorder::openNewFile)));
+  }
+  if (recorder != 0)
+  {
+    startShardTimer();
+  }
+} /* QsoRecorder::setShardTime */
+
+
 
 /****************************************************************************
  *
@@ -280,8 +348,13 @@ void QsoRecorder::openFile(void)
     string filename(rec_dir);
     filename += "/.qsorec_";
     filename += logic->name();
-    filename += ".wav";
+    filename += file_ext;
     recorder = new AudioRecorder(filename);
+    if (write_pool != 0)
+    {
+      recorder->setBackgroundWrite(write_pool, 1000 * write_buffer_time,
+                                   write_flush_interval);
+    }
     recorder->setMaxRecordingTime(hard_chunk_limit, soft_chunk_limit);
     recorder->maxRecordingTimeReached.connect(
         mem_fun(*this, &QsoRecorder::openNewFile));
@@ -293,6 +366,16 @@ void QsoRecorder::openFile(void)
            << " for writing in logic " << logic->name() << ": "
            << recorder->errorMsg() << endl;
     }
+
+    qso_index.clear();
+    if (!logic->isIdle())
+    {
+      beginQsoMark();
+    }
+    if (shard_timer != 0)
+    {
+      startShardTimer();
+    }
   }
 } /* QsoRecorder::openFile */
 
@@ -301,18 +384,27 @@ void QsoRecorder::closeFile(void)
 {
   if (recorder != 0)
   {
-    string oldpath(rec_dir + "/.qsorec_" + logic->name() + ".wav");
+    string oldpath(rec_dir + "/.qsorec_" + logic->name() + file_ext);
+
+    if (recorder->overflowCount() > 0)
+    {
+      cerr << "*** WARNING: The QSO recorder in logic " << logic->name()
+           << " could not write audio fast enough. "
+           << recorder->droppedBytes() << " bytes were thrown away in "
+           << recorder->overflowCount() << " blocks. Consider increasing "
+              "WRITE_BUFFER_TIME.\n";
+    }
 
-    if (!recorder->closeFile())
+    if (shard_timer != 0)
     {
-      cerr << "*** ERROR: Failed to close QsoRecorder file \"" << oldpath
-           << "\" in logic " << logic->name() << ": " << recorder->errorMsg()
-           << endl;
+      shard_timer->stop();
     }
+    endQsoMark();
 
+    string basename;
     if (recorder->samplesWritten() > min_samples)
     {
-      string basename("qsorec_" + logic->name() + "_");
+      basename = "qsorec_" + logic->name() + "_";
 
       const struct timeval &begin_time = recorder->beginTimestamp();
       struct tm tm;
@@ -327,60 +419,117 @@ void QsoRecorder::closeFile(void)
       localtime_r(&end_time.tv_sec, &tm);
       strftime(timestamp, sizeof(timestamp), "%Y-%m-%d_%H%M%S", &tm);
       basename += timestamp;
-      string newpath = rec_dir + "/" + basename + ".wav";
-      if (rename(oldpath.c_str(), newpath.c_str()) != 0)
+
+      if (write_index)
       {
-        perror("QsoRecorder rename");
+        writeIndexFile(basename);
       }
+    }
+    qso_index.clear();
 
-      cout << logic->name() << ": Wrote QSO recorder file "
-           << basename << ".wav\n";
-
-        // Execute external audio file handler (e.g. encoder) if configured
-      if (!encoder_cmd.empty())
+    if (write_pool != 0)
+    {
+        // The file is renamed, or removed, right away since the writer
+        // thread may still be working on it when the next file is opened.
+        // The open file descriptor follow the file.
+      if (!basename.empty())
       {
-        cout << logic->name() << ": Starting encoding for file "
-             << basename << ".wav\n";
-        const char *shell = getenv("SHELL");
-        if (shell == NULL)
+        string newpath = rec_dir + "/" + basename + file_ext;
+        if (rename(oldpath.c_str(), newpath.c_str()) != 0)
         {
-          shell = "/bin/sh";
+          perror("QsoRecorder rename");
         }
-        FileEncoder *enc = new FileEncoder(shell, basename);
-        enc->appendArgument("-c");
-        string cmdline(encoder_cmd);
-        replace_all(cmdline, "%f", newpath);
-        replace_all(cmdline, "%d", rec_dir);
-        replace_all(cmdline, "%b", basename);
-        replace_all(cmdline, "%n", basename + ".wav");
-        enc->appendArgument(cmdline);
-        enc->stdoutData.connect(
-            mem_fun(*this, &QsoRecorder::handleEncoderPrintouts));
-        enc->stderrData.connect(
-            mem_fun(*this, &QsoRecorder::handleEncoderPrintouts));
-        enc->exited.connect(
-            sigc::bind(mem_fun(*this, &QsoRecorder::encoderExited), enc));
-        enc->nice();
-        enc->setTimeout(60*60); // One hour timeout
-        enc->run();
       }
-    }
-    else
-    {
-      if (unlink(oldpath.c_str()) != 0)
+      else if (unlink(oldpath.c_str()) != 0)
       {
         perror("QsoRecorder unlink");
       }
+      recorder->closeFile(
+          [this, basename](bool success, const string& errmsg)
+          {
+            fileClosed(basename, success, errmsg);
+          });
+      delete recorder;
+      recorder = 0;
+      return;
     }
 
+    bool success = recorder->closeFile();
+    string errmsg(recorder->errorMsg());
     delete recorder;
     recorder = 0;
 
-    cleanupDirectory();
+    if (!basename.empty())
+    {
+      string newpath = rec_dir + "/" + basename + file_ext;
+      if (rename(oldpath.c_str(), newpath.c_str()) != 0)
+      {
+        perror("QsoRecorder rename");
+      }
+    }
+    else if (unlink(oldpath.c_str()) != 0)
+    {
+      perror("QsoRecorder unlink");
+    }
+
+    fileClosed(basename, success, errmsg);
   }
 } /* QsoRecorder::closeFile */
 
 
+void QsoRecorder::fileClosed(const string& basename, bool success,
+                             const string& errmsg)
+{
+  if (!success)
+  {
+    cerr << "*** ERROR: Failed to close QsoRecorder file \""
+         << (basename.empty() ? string(".qsorec_" + logic->name())
+                              : basename)
+         << file_ext << "\" in logic " << logic->name() << ": " << errmsg
+         << endl;
+  }
+
+  if (!basename.empty())
+  {
+    string filename(basename + file_ext);
+    string newpath = rec_dir + "/" + filename;
+    cout << logic->name() << ": Wrote QSO recorder file "
+         << filename << "\n";
+
+      // Execute external audio file handler (e.g. encoder) if configured
+    if (!encoder_cmd.empty())
+    {
+      cout << logic->name() << ": Starting encoding for file "
+           << filename << "\n";
+      const char *shell = getenv("SHELL");
+      if (shell == NULL)
+      {
+        shell = "/bin/sh";
+      }
+      FileEncoder *enc = new FileEncoder(shell, basename);
+      enc->appendArgument("-c");
+      string cmdline(encoder_cmd);
+      replace_all(cmdline, "%f", newpath);
+      replace_all(cmdline, "%d", rec_dir);
+      replace_all(cmdline, "%b", basename);
+      replace_all(cmdline, "%n", filename);
+      enc->appendArgument(cmdline);
+      enc->stdoutData.connect(
+          mem_fun(*this, &QsoRecorder::handleEncoderPrintouts));
+      enc->stderrData.connect(
+          mem_fun(*this, &QsoRecorder::handleEncoderPrintouts));
+      enc->exited.connect(
+          sigc::bind(mem_fun(*this, &QsoRecorder::encoderExited), enc));
+      enc->nice();
+      enc->setTimeout(60*60); // One hour timeout
+      enc->run();
+    }
+  }
+
+  cleanupDirectory();
+} /* QsoRecorder::fileClosed */
+
+
 void QsoRecorder::cleanupDirectory(void)
 {
   if (max_dirsize == 0)
@@ -456,6 +605,95 @@ void QsoRecorder::checkTimeoutTimers(void)
 } /* QsoRecorder::checkTimeoutTimers */
 
 
+void QsoRecorder::onIdleStateChanged(bool is_idle)
+{
+  if (recorder != 0)
+  {
+    if (is_idle)
+    {
+      endQsoMark();
+    }
+    else
+    {
+      beginQsoMark();
+    }
+  }
+  checkTimeoutTimers();
+} /* QsoRecorder::onIdleStateChanged */
+
+
+void QsoRecorder::beginQsoMark(void)
+{
+  if (!write_index ||
+      (!qso_index.empty() && !timerisset(&qso_index.back().end)))
+  {
+    return;
+  }
+  QsoMark mark;
+  gettimeofday(&mark.begin, NULL);
+  timerclear(&mark.end);
+  mark.begin_sample = recorder->samplesWritten();
+  mark.end_sample = mark.begin_sample;
+  qso_index.push_back(mark);
+} /* QsoRecorder::beginQsoMark */
+
+
+void QsoRecorder::endQsoMark(void)
+{
+  if (qso_index.empty() || timerisset(&qso_index.back().end))
+  {
+    return;
+  }
+  QsoMark &mark = qso_index.back();
+  gettimeofday(&mark.end, NULL);
+  mark.end_sample = recorder->samplesWritten();
+  if (mark.end_sample == mark.begin_sample)
+  {
+      // Nothing was recorded, e.g. when only transmitting
+    qso_index.pop_back();
+  }
+} /* QsoRecorder::endQsoMark */
+
+
+void QsoRecorder::writeIndexFile(const std::string& basename)
+{
+  string path(rec_dir + "/" + basename + ".idx");
+  FILE *file = fopen(path.c_str(), "w");
+  if (file == NULL)
+  {
+    perror("QsoRecorder fopen index");
+    return;
+  }
+  for (const auto& mark : qso_index)
+  {
+    char begin_str[64];
+    char end_str[64];
+    struct tm tm;
+    localtime_r(&mark.begin.tv_sec, &tm);
+    strftime(begin_str, sizeof(begin_str), "%Y-%m-%d %H:%M:%S", &tm);
+    localtime_r(&mark.end.tv_sec, &tm);
+    strftime(end_str, sizeof(end_str), "%Y-%m-%d %H:%M:%S", &tm);
+    fprintf(file, "%s.%03ld %s.%03ld %.3f %.3f\n",
+            begin_str, static_cast<long>(mark.begin.tv_usec / 1000),
+            end_str, static_cast<long>(mark.end.tv_usec / 1000),
+            static_cast<double>(mark.begin_sample) / INTERNAL_SAMPLE_RATE,
+            static_cast<double>(mark.end_sample) / INTERNAL_SAMPLE_RATE);
+  }
+  if (fclose(file) != 0)
+  {
+    perror("QsoRecorder fclose index");
+  }
+} /* QsoRecorder::writeIndexFile */
+
+
+void QsoRecorder::startShardTimer(void)
+{
+  time_t now = time(NULL);
+  shard_timer->setTimeout(now - now % shard_time + shard_time);
+  shard_timer->start();
+} /* QsoRecorder::startShardTimer */
+
+
 void QsoRecorder::handleEncoderPrintouts(const char *buf, int cnt)
 {
   cout << buf;
@@ -465,7 +703,7 @@ void QsoRecorder::handleEncoderPrintouts(const char *buf, int cnt)
 void QsoRecorder::encoderExited(QsoRecorder::FileEncoder *enc)
 {
   cout << logic->name() << ": Encoding done for file "
-             << enc->basename << ".wav\n";
+             << enc->basename << file_ext << "\n";
   if (enc->ifExited() && (enc->exitStatus() != 0))
   {
     cerr << "*** ERROR: QSO recorder external audio file handler in logic "
@@ -34,7 +34,10 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
  *
  ****************************************************************************/
 
+#include <sys/time.h>
+
 #include <string>
+#include <vector>
 
 
 /****************************************************************************
@@ -66,6 +69,8 @@ namespace Async
   class Config;
   class Timer;
   class Exec;
+  class WorkerPool;
+  class AtTimer;
 };
 
 class Logic;
@@ -172,6 +177,16 @@ class QsoRecorder
 
     void setMaxRecDirSize(unsigned max_size);
 
+    /**
+     * @brief   Set the time between file shards
+     * @param   shard_time The shard time in seconds. 0 disables sharding.
+     *
+     * When set, a new file is started each time the wall clock pass a
+     * multiple of the shard time, counted from midnight UTC. A shard time
+     * of 3600 will for example give one file per hour.
+     */
+    void setShardTime(unsigned shard_time);
+
     bool recorderIsActive(void) const { return (recorder != 0); }
 
   protected:
@@ -179,6 +194,14 @@ class QsoRecorder
   private:
     class FileEncoder;
 
+    struct QsoMark
+    {
+      struct timeval  begin;
+      struct timeval  end;
+      unsigned        begin_sample;
+      unsigned        end_sample;
+    };
+
     Async::AudioSelector  *selector;
     Async::AudioRecorder  *recorder;
     std::string           rec_dir;
@@ -191,15 +214,30 @@ class QsoRecorder
     Async::Timer          *qso_tmo_timer;
     unsigned              min_samples;
     std::string           encoder_cmd;
+    std::string           file_ext;
+    Async::WorkerPool     *write_pool;
+    unsigned              write_buffer_time;
+    unsigned              write_flush_interval;
+    unsigned              shard_time;
+    Async::AtTimer        *shard_timer;
+    bool                  write_index;
+    std::vector<QsoMark>  qso_index;
 
     QsoRecorder(const QsoRecorder&);
     QsoRecorder& operator=(const QsoRecorder&);
     void openNewFile(void);
     void openFile(void);
     void closeFile(void);
+    void fileClosed(const std::string& basename, bool success,
+                    const std::string& errmsg);
     void cleanupDirectory(void);
     void timerExpired(void);
     void checkTimeoutTimers(void);
+    void onIdleStateChanged(bool is_idle);
+    void beginQsoMark(void);
+    void endQsoMark(void);
+    void writeIndexFile(const std::string& basename);
+    void startShardTimer(void);
     void handleEncoderPrintouts(const char *buf, int cnt);
     void encoderExited(FileEncoder *enc);
     void onError(void);
@@ -0,0 +1,567 @@
+/**
+@file	 ReflectorClientAudio.cpp
+@brief   The audio path shared by the reflector client logic cores
+@author  Tobias Blomberg / SM0SVX
+@date	 2026-10-14
+
+\verbatim
+SvxLink - A Multi Purpose Voice Services System for Ham Radio Use
+Copyright (C) 2003-2026 Tobias Blomberg / SM0SVX
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+\endverbatim
+*/
+
+/****************************************************************************
+ *
+ * System Includes
+ *
+ ****************************************************************************/
+
+#include <cassert>
+#include <iostream>
+#include <algorithm>
+#include <list>
+
+
+/****************************************************************************
+ *
+ * Project Includes
+ *
+ ****************************************************************************/
+
+#include <AsyncAudioSource.h>
+#include <AsyncAudioSink.h>
+#include <AsyncAudioFifo.h>
+#include <AsyncAudioJitterFifo.h>
+#include <AsyncAudioCodecThread.h>
+#include <AsyncAudioCodecPool.h>
+#include <AsyncAudioStats.h>
+
+
+/****************************************************************************
+ *
+ * Local Includes
+ *
+ ****************************************************************************/
+
+#include "ReflectorClientAudio.h"
+#include "LatencyProbe.h"
+
+
+/****************************************************************************
+ *
+ * Namespaces to use
+ *
+ ****************************************************************************/
+
+using namespace std;
+using namespace Async;
+
+
+
+/****************************************************************************
+ *
+ * Defines & typedefs
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Local class definitions
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Prototypes
+ *
+ ****************************************************************************/
+
+namespace {
+    // Set all codec options found in the configuration section that start
+    // with the given prefix, e.g. OPUS_ENC_COMPLEXITY
+  template <class Codec>
+  void setCodecOptions(Async::Config& cfg, const std::string& section,
+                       Codec* codec, const std::string& opt_prefix)
+  {
+    const list<string> names = cfg.listSection(section);
+    for (const auto& cfg_name : names)
+    {
+      if (cfg_name.find(opt_prefix) == 0)
+      {
+        string opt_value;
+        cfg.getValue(section, cfg_name, opt_value);
+        codec->setOption(cfg_name.substr(opt_prefix.size()), opt_value);
+      }
+    }
+    codec->printCodecParams();
+  }
+};
+
+
+/****************************************************************************
+ *
+ * Exported Global Variables
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Local Global Variables
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Public member functions
+ *
+ ****************************************************************************/
+
+ReflectorClientAudio::ReflectorClientAudio(void)
+  : m_cfg(0), m_enc_endpoint(0), m_enc(0), m_dec(0), m_codec_thread(0),
+    m_ingress_probe(0), m_jitter_fifo(0), m_fifo(0),
+    m_flush_timeout_timer(FLUSH_TIMEOUT, Async::Timer::TYPE_ONESHOT, false),
+    m_consumed(true), m_verbose(true), m_stats(0)
+{
+  m_flush_timeout_timer.expired.connect(
+      sigc::mem_fun(*this, &ReflectorClientAudio::flushTimeout));
+  timerclear(&m_last_talker_timestamp);
+} /* ReflectorClientAudio::ReflectorClientAudio */
+
+
+ReflectorClientAudio::~ReflectorClientAudio(void)
+{
+    // The decoder own the rest of the receive audio pipe
+  releaseEncoder();
+  releaseDecoder();
+  delete m_codec_thread;
+  m_codec_thread = 0;
+  m_ingress_probe = 0;
+  m_jitter_fifo = 0;
+  m_fifo = 0;
+} /* ReflectorClientAudio::~ReflectorClientAudio */
+
+
+bool ReflectorClientAudio::initialize(Async::Config& cfg,
+                                      const std::string& name,
+                                      Async::AudioSource* src,
+                                      Async::AudioSink* sink)
+{
+  m_cfg = &cfg;
+  m_name = name;
+  m_enc_endpoint = src;
+
+  bool codec_thread = false;
+  cfg.getValue(name, "CODEC_THREAD", codec_thread);
+  if (codec_thread)
+  {
+    unsigned codec_max_latency = AudioCodecThread::DEFAULT_MAX_LATENCY;
+    cfg.getValue(name, "CODEC_MAX_LATENCY", codec_max_latency);
+    m_codec_thread = new AudioCodecThread(codec_max_latency);
+    if (!m_codec_thread->initOk())
+    {
+      cerr << "*** ERROR[" << name << "]: Could not start the codec thread"
+           << endl;
+      return false;
+    }
+  }
+
+    // Create dummy audio codec used before setting the real encoder
+  if (!setAudioCodec("DUMMY")) { return false; }
+  AudioSource *prev_src = m_dec;
+
+    // Record the arrival time of audio frames for transmitters that
+    // measure the latency from the network to the audio device
+  m_ingress_probe = new LatencyProbe(LatencyProbe::INGRESS);
+  prev_src->registerSink(m_ingress_probe, true);
+  prev_src = m_ingress_probe;
+
+    // Create jitter buffer
+  unsigned jitter_buffer_delay = 0;
+  cfg.getValue(name, "JITTER_BUFFER_DELAY", jitter_buffer_delay);
+  bool jitter_buffer_adaptive = false;
+  cfg.getValue(name, "JITTER_BUFFER_ADAPTIVE", jitter_buffer_adaptive);
+  if (jitter_buffer_adaptive)
+  {
+    unsigned jitter_buffer_max_delay = 400;
+    if (!cfg.getValue(name, "JITTER_BUFFER_MAX_DELAY",
+                      std::max(jitter_buffer_delay, 1U), 2000U,
+                      jitter_buffer_max_delay, true))
+    {
+      std::cerr << "*** ERROR[" << name
+                << "]: Illegal value (" << jitter_buffer_max_delay
+                << ") for JITTER_BUFFER_MAX_DELAY" << std::endl;
+      return false;
+    }
+    m_jitter_fifo = new Async::AudioJitterFifo(2*INTERNAL_SAMPLE_RATE);
+    m_jitter_fifo->setStats(m_stats);
+    m_jitter_fifo->enableAdaptive(
+        jitter_buffer_delay * INTERNAL_SAMPLE_RATE / 1000,
+        jitter_buffer_max_delay * INTERNAL_SAMPLE_RATE / 1000);
+    prev_src->registerSink(m_jitter_fifo, true);
+    prev_src = m_jitter_fifo;
+  }
+  else
+  {
+    m_fifo = new Async::AudioFifo(2*INTERNAL_SAMPLE_RATE);
+    m_fifo->setStats(m_stats);
+    prev_src->registerSink(m_fifo, true);
+    prev_src = m_fifo;
+    if (jitter_buffer_delay > 0)
+    {
+      m_fifo->setPrebufSamples(
+          jitter_buffer_delay * INTERNAL_SAMPLE_RATE / 1000);
+    }
+  }
+
+  prev_src->registerSink(sink, true);
+
+  return true;
+} /* ReflectorClientAudio::initialize */
+
+
+bool ReflectorClientAudio::setAudioCodec(const std::string& codec_name)
+{
+  assert(m_cfg != 0);
+
+  releaseEncoder();
+  m_enc = AudioCodecPool::instance().createEncoder(codec_name);
+  if (m_enc == 0)
+  {
+    cerr << "*** ERROR[" << m_name
+         << "]: Failed to initialize " << codec_name
+         << " audio encoder" << endl;
+    m_enc = AudioCodecPool::instance().createEncoder("DUMMY");
+    assert(m_enc != 0);
+    return false;
+  }
+  if ((m_codec_thread != 0) && (codec_name != "DUMMY"))
+  {
+    AudioEncoderThreaded *enc = new AudioEncoderThreaded(*m_codec_thread,
+                                                         m_enc);
+    enc->setStats(m_stats);
+    m_enc = enc;
+  }
+  m_enc->writeEncodedSamples.connect(
+      sigc::mem_fun(*this, &ReflectorClientAudio::onEncodedAudio));
+  m_enc->flushEncodedSamples.connect(
+      sigc::mem_fun(*this, &ReflectorClientAudio::onEncoderFlush));
+  m_enc_endpoint->registerSink(m_enc, false);
+  setCodecOptions(*m_cfg, m_name, m_enc, string(m_enc->name()) + "_ENC_");
+
+  return setDecoderCodec(codec_name);
+} /* ReflectorClientAudio::setAudioCodec */
+
+
+bool ReflectorClientAudio::setDecoderCodec(const std::string& codec_name,
+                                           unsigned bitrate)
+{
+  assert(m_cfg != 0);
+
+  AudioSink *sink = 0;
+  if (m_dec != 0)
+  {
+    sink = m_dec->sink();
+    m_dec->unregisterSink();
+    releaseDecoder();
+  }
+  m_dec = AudioCodecPool::instance().createDecoder(codec_name);
+  if (m_dec == 0)
+  {
+    cerr << "*** ERROR[" << m_name
+         << "]: Failed to initialize " << codec_name
+         << " audio decoder" << endl;
+    m_dec = AudioCodecPool::instance().createDecoder("DUMMY");
+    assert(m_dec != 0);
+    return false;
+  }
+  if ((m_codec_thread != 0) && (codec_name != "DUMMY"))
+  {
+    AudioDecoderThreaded *dec = new AudioDecoderThreaded(*m_codec_thread,
+                                                         m_dec);
+    dec->setStats(m_stats);
+    m_dec = dec;
+  }
+  m_dec->allEncodedSamplesFlushed.connect(
+      sigc::mem_fun(*this, &ReflectorClientAudio::onDecoderAllFlushed));
+  if (sink != 0)
+  {
+    m_dec->registerSink(sink, true);
+  }
+  setCodecOptions(*m_cfg, m_name, m_dec, string(m_dec->name()) + "_DEC_");
+  if (bitrate > 0)
+  {
+    m_dec->setOption("BITRATE", to_string(bitrate));
+  }
+
+  return true;
+} /* ReflectorClientAudio::setDecoderCodec */
+
+
+bool ReflectorClientAudio::codecIsAvailable(const std::string &codec_name)
+{
+  return AudioEncoder::isAvailable(codec_name) &&
+         AudioDecoder::isAvailable(codec_name);
+} /* ReflectorClientAudio::codecIsAvailable */
+
+
+unsigned ReflectorClientAudio::bufferedMs(void) const
+{
+  unsigned samples = 0;
+  if (m_jitter_fifo != 0)
+  {
+    samples = m_jitter_fifo->samplesInFifo();
+  }
+  else if (m_fifo != 0)
+  {
+    samples = m_fifo->samplesInFifo();
+  }
+  return samples * 1000 / INTERNAL_SAMPLE_RATE;
+} /* ReflectorClientAudio::bufferedMs */
+
+
+void ReflectorClientAudio::audioReceived(void* buf, int size,
+                                         unsigned lost_frames)
+{
+  if (size <= 0)
+  {
+    return;
+  }
+
+    // Let the decoder conceal lost frames in the middle of a stream.
+    // Nobody listen if there are no consumers so then the decoder
+    // just write silence of the same length as the frame.
+  if ((lost_frames > 0) && isReceiving() && m_consumed)
+  {
+    m_dec->encodedFramesLost(lost_frames, buf, size);
+    if (m_stats != 0)
+    {
+      m_stats->inc(AudioStats::CONCEALED_FRAMES, lost_frames);
+    }
+  }
+  gettimeofday(&m_last_talker_timestamp, NULL);
+  m_ingress_probe->markIngress();
+  if (m_consumed)
+  {
+    m_dec->writeEncodedSamples(buf, size);
+  }
+  else
+  {
+    m_dec->skipEncodedSamples(buf, size);
+  }
+} /* ReflectorClientAudio::audioReceived */
+
+
+void ReflectorClientAudio::writeAudio(void* buf, int size)
+{
+  gettimeofday(&m_last_talker_timestamp, NULL);
+  m_dec->writeEncodedSamples(buf, size);
+} /* ReflectorClientAudio::writeAudio */
+
+
+void ReflectorClientAudio::flushDecoder(void)
+{
+  m_dec->flushEncodedSamples();
+  timerclear(&m_last_talker_timestamp);
+} /* ReflectorClientAudio::flushDecoder */
+
+
+void ReflectorClientAudio::flushReceived(void)
+{
+  flushDecoder();
+  printJitterBufferStats();
+} /* ReflectorClientAudio::flushReceived */
+
+
+void ReflectorClientAudio::allSamplesFlushedReceived(void)
+{
+  m_flush_timeout_timer.setEnable(false);
+  m_enc->allEncodedSamplesFlushed();
+} /* ReflectorClientAudio::allSamplesFlushedReceived */
+
+
+void ReflectorClientAudio::framesLate(unsigned cnt)
+{
+  if (m_stats != 0)
+  {
+    m_stats->inc(AudioStats::LATE_FRAMES, cnt);
+  }
+  if (m_jitter_fifo != 0)
+  {
+    m_jitter_fifo->reportLateFrames(cnt);
+  }
+} /* ReflectorClientAudio::framesLate */
+
+
+void ReflectorClientAudio::framesLost(unsigned cnt)
+{
+  if (m_stats != 0)
+  {
+    m_stats->inc(AudioStats::LOST_FRAMES, cnt);
+  }
+  if (m_jitter_fifo != 0)
+  {
+    m_jitter_fifo->reportLostFrames(cnt);
+  }
+} /* ReflectorClientAudio::framesLost */
+
+
+void ReflectorClientAudio::checkTalkerTimeout(void)
+{
+  if (isReceiving())
+  {
+    struct timeval now, diff;
+    gettimeofday(&now, NULL);
+    timersub(&now, &m_last_talker_timestamp, &diff);
+    if (diff.tv_sec > static_cast<time_t>(TALKER_AUDIO_TIMEOUT))
+    {
+      cout << m_name << ": Last talker audio timeout" << endl;
+      flushDecoder();
+    }
+  }
+} /* ReflectorClientAudio::checkTalkerTimeout */
+
+
+void ReflectorClientAudio::reset(void)
+{
+  if (m_flush_timeout_timer.isEnabled())
+  {
+    flushTimeout();
+  }
+  if (isReceiving())
+  {
+    flushDecoder();
+  }
+} /* ReflectorClientAudio::reset */
+
+
+
+/****************************************************************************
+ *
+ * Protected member functions
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Private member functions
+ *
+ ****************************************************************************/
+
+void ReflectorClientAudio::releaseEncoder(void)
+{
+    // Codecs running in a codec thread are owned by the threaded wrapper so
+    // only codecs running in the main thread are handed back to the pool
+  if (dynamic_cast<AudioEncoderThreaded*>(m_enc) != 0)
+  {
+    delete m_enc;
+  }
+  else
+  {
+    AudioCodecPool::instance().release(m_enc);
+  }
+  m_enc = 0;
+} /* ReflectorClientAudio::releaseEncoder */
+
+
+void ReflectorClientAudio::releaseDecoder(void)
+{
+  if (dynamic_cast<AudioDecoderThreaded*>(m_dec) != 0)
+  {
+    delete m_dec;
+  }
+  else
+  {
+    AudioCodecPool::instance().release(m_dec);
+  }
+  m_dec = 0;
+} /* ReflectorClientAudio::releaseDecoder */
+
+
+void ReflectorClientAudio::onEncodedAudio(const void *buf, int count)
+{
+  if (sendAudio(buf, count))
+  {
+    m_flush_timeout_timer.setEnable(false);
+  }
+} /* ReflectorClientAudio::onEncodedAudio */
+
+
+void ReflectorClientAudio::onEncoderFlush(void)
+{
+  if (!sendFlush())
+  {
+    flushTimeout();
+    return;
+  }
+  m_flush_timeout_timer.setEnable(true);
+} /* ReflectorClientAudio::onEncoderFlush */
+
+
+void ReflectorClientAudio::onDecoderAllFlushed(void)
+{
+  sendAllSamplesFlushed();
+} /* ReflectorClientAudio::onDecoderAllFlushed */
+
+
+void ReflectorClientAudio::flushTimeout(Async::Timer *t)
+{
+  m_flush_timeout_timer.setEnable(false);
+  m_enc->allEncodedSamplesFlushed();
+} /* ReflectorClientAudio::flushTimeout */
+
+
+void ReflectorClientAudio::printJitterBufferStats(void)
+{
+  if ((m_jitter_fifo == 0) || !m_verbose)
+  {
+    return;
+  }
+
+  const Async::AudioJitterFifo::Stats& stats = m_jitter_fifo->statistics();
+  if (stats.received_frames == 0)
+  {
+    return;
+  }
+  std::cout << m_name << ": Jitter buffer: target_delay="
+            << (1000 * stats.target_delay / INTERNAL_SAMPLE_RATE) << "ms"
+            << " received=" << stats.received_frames
+            << " late=" << stats.late_frames
+            << " lost=" << stats.lost_frames
+            << " underruns=" << stats.underruns
+            << " concealed="
+            << (1000 * stats.concealed_samples / INTERNAL_SAMPLE_RATE) << "ms"
+            << " dropped="
+            << (1000 * stats.dropped_samples / INTERNAL_SAMPLE_RATE) << "ms"
+            << std::endl;
+  m_jitter_fifo->resetStatistics();
+} /* ReflectorClientAudio::printJitterBufferStats */
+
+
+
+/*
+ * This file has not been truncated
+ */
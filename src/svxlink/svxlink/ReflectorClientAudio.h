@@ -0,0 +1,374 @@
+/**
+@file	 ReflectorClientAudio.h
+@brief   The audio path shared by the reflector client logic cores
+@author  Tobias Blomberg / SM0SVX
+@date	 2026-10-14
+
+\verbatim
+SvxLink - A Multi Purpose Voice Services System for Ham Radio Use
+Copyright (C) 2003-2026 Tobias Blomberg / SM0SVX
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+\endverbatim
+*/
+
+#ifndef REFLECTOR_CLIENT_AUDIO_INCLUDED
+#define REFLECTOR_CLIENT_AUDIO_INCLUDED
+
+
+/****************************************************************************
+ *
+ * System Includes
+ *
+ ****************************************************************************/
+
+#include <sys/time.h>
+#include <sigc++/sigc++.h>
+
+#include <string>
+
+
+/****************************************************************************
+ *
+ * Project Includes
+ *
+ ****************************************************************************/
+
+#include <AsyncTimer.h>
+#include <AsyncConfig.h>
+#include <AsyncAudioEncoder.h>
+#include <AsyncAudioDecoder.h>
+
+
+/****************************************************************************
+ *
+ * Local Includes
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Forward declarations
+ *
+ ****************************************************************************/
+
+namespace Async
+{
+  class AudioSource;
+  class AudioSink;
+  class AudioJitterFifo;
+  class AudioFifo;
+  class AudioCodecThread;
+  class AudioStats;
+};
+
+class LatencyProbe;
+
+
+/****************************************************************************
+ *
+ * Namespace
+ *
+ ****************************************************************************/
+
+//namespace MyNameSpace
+//{
+
+
+/****************************************************************************
+ *
+ * Forward declarations of classes inside of the declared namespace
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Defines & typedefs
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Exported Global Variables
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Class definitions
+ *
+ ****************************************************************************/
+
+/**
+@brief	The audio path shared by the reflector client logic cores
+@author Tobias Blomberg / SM0SVX
+@date   2026-10-14
+
+This class contain everything in a reflector client that has to do with
+audio but is independent of the reflector protocol version. That is the
+audio encoder and decoder, the optional codec thread, the jitter buffer,
+the flush handshake and the last talker timeout. Both the ReflectorLogic
+and the ReflectorV2Logic use it so optimizations of the audio path only
+have to be done in one place.
+
+The logic core is responsible for the network protocol. Received audio
+messages are handed over to the audioReceived, flushReceived and
+allSamplesFlushedReceived functions. Encoded audio that should be sent to
+the reflector is delivered through the sendAudio, sendFlush and
+sendAllSamplesFlushed signals.
+*/
+class ReflectorClientAudio : public sigc::trackable
+{
+  public:
+    /**
+     * @brief 	Default constructor
+     */
+    ReflectorClientAudio(void);
+
+    /**
+     * @brief 	Destructor
+     */
+    ~ReflectorClientAudio(void);
+
+    /**
+     * @brief 	Initialize the audio path
+     * @param 	cfg   The configuration object to read the settings from
+     * @param 	name  The name of the configuration section to use
+     * @param 	src   The source of the audio to send to the reflector
+     * @param 	sink  The sink for the audio received from the reflector
+     * @return	Return \em true on success or else \em false
+     *
+     * The sink will be owned by the audio path and will be deleted when
+     * this object is deleted.
+     */
+    bool initialize(Async::Config& cfg, const std::string& name,
+                    Async::AudioSource* src, Async::AudioSink* sink);
+
+    /**
+     * @brief 	Set the audio codec to use
+     * @param 	codec_name The name of the codec
+     * @return	Return \em true on success or else \em false
+     *
+     * If the codec cannot be created the DUMMY codec will be used instead
+     * and \em false is returned.
+     */
+    bool setAudioCodec(const std::string& codec_name);
+
+    /**
+     * @brief 	Set the audio codec to use for received audio only
+     * @param 	codec_name The name of the codec
+     * @param 	bitrate The bitrate of the received audio or 0 for default
+     * @return	Return \em true on success or else \em false
+     *
+     * This is used when the reflector transcode the audio sent to us. The
+     * encoder is not touched. If the decoder cannot be created the DUMMY
+     * decoder will be used instead and \em false is returned.
+     */
+    bool setDecoderCodec(const std::string& codec_name, unsigned bitrate=0);
+
+    /**
+     * @brief 	Check if an audio codec is available
+     * @param 	codec_name The name of the codec
+     * @return	Return \em true if both an encoder and a decoder exist
+     */
+    static bool codecIsAvailable(const std::string& codec_name);
+
+    /**
+     * @brief 	Get the current audio encoder
+     * @return	Return the audio encoder
+     */
+    Async::AudioEncoder* encoder(void) { return m_enc; }
+
+    /**
+     * @brief 	Tell if anyone is listening to the received audio
+     * @param 	consumed Set to \em false if nobody listen
+     *
+     * When nobody listen, received audio is not decoded. The decoder just
+     * write silence of the same length to keep the timing.
+     */
+    void setConsumed(bool consumed) { m_consumed = consumed; }
+
+    /**
+     * @brief 	Set if jitter buffer statistics should be printed
+     * @param 	verbose Set to \em true to print statistics
+     */
+    void setVerbose(bool verbose) { m_verbose = verbose; }
+
+    /**
+     * @brief 	Set the object to report audio health statistics to
+     * @param 	stats The statistics object, not owned by the audio path
+     *
+     * Call this function before calling initialize. Underruns in the jitter
+     * buffer, late and lost frames, concealed frames and codec thread drops
+     * are reported to the statistics object.
+     */
+    void setStats(Async::AudioStats* stats) { m_stats = stats; }
+
+    /**
+     * @brief 	Check if audio is being received from the reflector
+     * @return	Return \em true if a talker is active
+     */
+    bool isReceiving(void) const
+    {
+      return timerisset(&m_last_talker_timestamp);
+    }
+
+    /**
+     * @brief 	Get the amount of audio buffered in the jitter buffer
+     * @return	Return the buffered audio in milliseconds
+     *
+     * This is an estimate of how long it will take for a frame received
+     * right now to reach the output of the audio path.
+     */
+    unsigned bufferedMs(void) const;
+
+    /**
+     * @brief 	Handle audio received from the reflector
+     * @param 	buf         The encoded audio
+     * @param 	size        The size of the encoded audio
+     * @param 	lost_frames The number of frames lost right before this one
+     *
+     * Lost frames are concealed by the decoder if a talker is active.
+     */
+    void audioReceived(void* buf, int size, unsigned lost_frames=0);
+
+    /**
+     * @brief 	Write audio directly to the decoder
+     * @param 	buf   The encoded audio
+     * @param 	size  The size of the encoded audio
+     *
+     * Use this function for audio that is not part of the normal audio
+     * stream, like pre-roll audio. No concealment or latency measurement
+     * is done.
+     */
+    void writeAudio(void* buf, int size);
+
+    /**
+     * @brief 	Flush the decoder
+     *
+     * This function ends the current talk spurt without printing any
+     * jitter buffer statistics.
+     */
+    void flushDecoder(void);
+
+    /**
+     * @brief 	Handle a flush message received from the reflector
+     */
+    void flushReceived(void);
+
+    /**
+     * @brief 	Handle an all samples flushed message from the reflector
+     */
+    void allSamplesFlushedReceived(void);
+
+    /**
+     * @brief 	Report frames that arrived too late to the jitter buffer
+     * @param 	cnt The number of frames
+     */
+    void framesLate(unsigned cnt);
+
+    /**
+     * @brief 	Report lost frames to the jitter buffer
+     * @param 	cnt The number of frames
+     */
+    void framesLost(unsigned cnt);
+
+    /**
+     * @brief 	Check if the last talker has timed out
+     *
+     * This function should be called about once a second. The decoder is
+     * flushed if no audio has been received for more than three seconds.
+     */
+    void checkTalkerTimeout(void);
+
+    /**
+     * @brief 	Reset the audio path when the connection is lost
+     *
+     * A pending flush is completed and an active talker is stopped.
+     */
+    void reset(void);
+
+    /**
+     * @brief 	A signal that is emitted when encoded audio should be sent
+     * @param 	buf   The encoded audio
+     * @param 	count The size of the encoded audio
+     * @return	Return \em true if the audio was sent
+     */
+    sigc::signal<bool(const void*, int)> sendAudio;
+
+    /**
+     * @brief 	A signal that is emitted when a flush should be sent
+     * @return	Return \em true if the message was sent
+     *
+     * If the flush cannot be sent, the flush is completed directly.
+     */
+    sigc::signal<bool()> sendFlush;
+
+    /**
+     * @brief 	A signal emitted when an all flushed message should be sent
+     */
+    sigc::signal<void()> sendAllSamplesFlushed;
+
+  protected:
+
+  private:
+    static const unsigned FLUSH_TIMEOUT       = 3000;
+    static const unsigned TALKER_AUDIO_TIMEOUT = 3;
+
+    std::string               m_name;
+    Async::Config*            m_cfg;
+    Async::AudioSource*       m_enc_endpoint;
+    Async::AudioEncoder*      m_enc;
+    Async::AudioDecoder*      m_dec;
+    Async::AudioCodecThread*  m_codec_thread;
+    LatencyProbe*             m_ingress_probe;
+    Async::AudioJitterFifo*   m_jitter_fifo;
+    Async::AudioFifo*         m_fifo;
+    Async::Timer              m_flush_timeout_timer;
+    struct timeval            m_last_talker_timestamp;
+    bool                      m_consumed;
+    bool                      m_verbose;
+    Async::AudioStats*        m_stats;
+
+    ReflectorClientAudio(const ReflectorClientAudio&);
+    ReflectorClientAudio& operator=(const ReflectorClientAudio&);
+    void releaseEncoder(void);
+    void releaseDecoder(void);
+    void onEncodedAudio(const void *buf, int count);
+    void onEncoderFlush(void);
+    void onDecoderAllFlushed(void);
+    void flushTimeout(Async::Timer *t=0);
+    void printJitterBufferStats(void);
+
+};  /* class ReflectorClientAudio */
+
+
+//} /* namespace */
+
+#endif /* REFLECTOR_CLIENT_AUDIO_INCLUDED */
+
+
+
+/*
+ * This file has not been truncated
+ */
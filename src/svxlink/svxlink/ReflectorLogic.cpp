@@ -6,7 +6,7 @@
 
 \verbatim
 SvxLink - A Multi Purpose Voice Services System for Ham Radio Use
-Copyright (C) 2003-2025 Tobias Blomberg / SM0SVX
+Copyright (C) 2003-2026 Tobias Blomberg / SM0SVX
 
 This program is free software; you can redistribute it and/or modify
 it under the terms of the GNU General Public License as published by
@@ -42,6 +42,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 #include <streambuf>
 #include <limits>
 #include <numeric>
+#include <chrono>
 
 
 /****************************************************************************
@@ -155,9 +156,6 @@ extern "C" {
  *
  ****************************************************************************/
 
-namespace {
-  MsgProtoVer proto_ver;
-};
 
 
 /****************************************************************************
@@ -171,12 +169,11 @@ ReflectorLogic::ReflectorLogic(void)
     m_logic_con_in(0), m_logic_con_out(0),
     m_reconnect_timer(60000, Timer::TYPE_ONESHOT, false),
     /*m_next_udp_tx_seq(0),*/ m_next_udp_rx_seq(0),
-    m_heartbeat_timer(1000, Timer::TYPE_PERIODIC, false), m_dec(0),
-    m_flush_timeout_timer(3000, Timer::TYPE_ONESHOT, false),
+    m_heartbeat_timer(1000, Timer::TYPE_PERIODIC, false),
     m_udp_heartbeat_tx_cnt_reset(DEFAULT_UDP_HEARTBEAT_TX_CNT_RESET),
     m_udp_heartbeat_tx_cnt(0), m_udp_heartbeat_rx_cnt(0),
     m_tcp_heartbeat_tx_cnt(0), m_tcp_heartbeat_rx_cnt(0),
-    m_con_state(STATE_DISCONNECTED), m_enc(0), m_default_tg(0),
+    m_con_state(STATE_DISCONNECTED), m_default_tg(0),
     m_tg_select_timeout(DEFAULT_TG_SELECT_TIMEOUT),
     m_tg_select_inhibit_timeout(DEFAULT_TG_SELECT_TIMEOUT),
     m_tg_select_timer(1000, Async::Timer::TYPE_PERIODIC),
@@ -185,32 +182,51 @@ ReflectorLogic::ReflectorLogic(void)
     m_report_tg_timer(500, Async::Timer::TYPE_ONESHOT, false),
     m_tg_local_activity(false), m_last_qsy(0), m_logic_con_in_valve(0),
     m_mute_first_tx_loc(true), m_mute_first_tx_rem(false),
-    m_tmp_monitor_timer(1000, Async::Timer::TYPE_PERIODIC),
+    m_tmp_monitor_timer(1000, Async::Timer::TYPE_PERIODIC, false),
     m_tmp_monitor_timeout(DEFAULT_TMP_MONITOR_TIMEOUT), m_use_prio(true),
-    m_qsy_pending_timer(-1), m_verbose(true)
+    m_qsy_pending_timer(-1), m_verbose(true),
+    m_rx_telemetry_timer(DEFAULT_RX_TELEMETRY_INTERVAL, Timer::TYPE_ONESHOT,
+                         false),
+    m_state_event_timer(STATE_EVENT_RETRY_INTERVAL, Timer::TYPE_ONESHOT,
+                        false)
 {
   m_reconnect_timer.expired.connect(
       sigc::hide(mem_fun(*this, &ReflectorLogic::reconnect)));
+    // The one second housekeeping timers do not need to be exact so let
+    // them expire in the same event loop wakeup
+  m_heartbeat_timer.setSlack(1000);
+  m_heartbeat_timer.setName("ReflectorLogic::heartbeat");
   m_heartbeat_timer.expired.connect(
       mem_fun(*this, &ReflectorLogic::handleTimerTick));
-  m_flush_timeout_timer.expired.connect(
-      mem_fun(*this, &ReflectorLogic::flushTimeout));
-  timerclear(&m_last_talker_timestamp);
-
+  m_audio.sendAudio.connect(
+      sigc::mem_fun(*this, &ReflectorLogic::sendEncodedAudio));
+  m_audio.sendFlush.connect(
+      sigc::mem_fun(*this, &ReflectorLogic::flushEncodedAudio));
+  m_audio.sendAllSamplesFlushed.connect(
+      sigc::mem_fun(*this, &ReflectorLogic::allEncodedSamplesFlushed));
+
+  m_tg_select_timer.setSlack(1000);
+  m_tg_select_timer.setName("ReflectorLogic::tg_select");
   m_tg_select_timer.expired.connect(sigc::hide(
         sigc::mem_fun(*this, &ReflectorLogic::tgSelectTimerExpired)));
   m_report_tg_timer.expired.connect(sigc::hide(
         sigc::mem_fun(*this, &ReflectorLogic::processTgSelectionEvent)));
+  m_tmp_monitor_timer.setSlack(1000);
+  m_tmp_monitor_timer.setName("ReflectorLogic::tmp_monitor");
   m_tmp_monitor_timer.expired.connect(sigc::hide(
         sigc::mem_fun(*this, &ReflectorLogic::checkTmpMonitorTimeout)));
   m_qsy_pending_timer.expired.connect(sigc::hide(
         sigc::mem_fun(*this, &ReflectorLogic::qsyPendingTimeout)));
+  m_rx_telemetry_timer.expired.connect(sigc::hide(
+        sigc::mem_fun(*this, &ReflectorLogic::sendRxTelemetry)));
+  m_state_event_timer.expired.connect(sigc::hide(
+        sigc::mem_fun(*this, &ReflectorLogic::processStateEvents)));
 
   m_con.connected.connect(
       sigc::mem_fun(*this, &ReflectorLogic::onConnected));
   m_con.disconnected.connect(
       sigc::mem_fun(*this, &ReflectorLogic::onDisconnected));
-  m_con.frameReceived.connect(
+  m_con.frameDataReceived.connect(
       sigc::mem_fun(*this, &ReflectorLogic::onFrameReceived));
   m_con.verifyPeer.connect(
       sigc::mem_fun(*this, &ReflectorLogic::onVerifyPeer));
@@ -238,6 +254,28 @@ bool ReflectorLogic::initialize(Async::Config& cfgobj, const std::string& logic_
 
   cfg().getValue(name(), "VERBOSE", m_verbose);
 
+  std::string node_list = "ALL";
+  cfg().getValue(name(), "NODE_LIST", node_list);
+  if (node_list == "ALL")
+  {
+    m_node_list_scope = MsgNodeListSubscribe::SCOPE_ALL;
+  }
+  else if (node_list == "TG")
+  {
+    m_node_list_scope = MsgNodeListSubscribe::SCOPE_TGS;
+  }
+  else if (node_list == "NONE")
+  {
+    m_node_list_scope = MsgNodeListSubscribe::SCOPE_NONE;
+  }
+  else
+  {
+    std::cerr << "*** ERROR[" << name() << "]: Illegal value \"" << node_list
+              << "\" for NODE_LIST. Valid values are ALL, TG and NONE."
+              << std::endl;
+    return false;
+  }
+
   std::vector<std::string> hosts;
   if (cfg().getValue(name(), "HOST", hosts))
   {
@@ -290,6 +328,26 @@ bool ReflectorLogic::initialize(Async::Config& cfgobj, const std::string& logic_
     }
   }
 
+  bool fast_failover = false;
+  cfg().getValue(name(), "FAST_FAILOVER", fast_failover);
+  m_con.setFastFailover(fast_failover);
+
+    // Spread out the reconnects of all nodes when a reflector restart. The
+    // randomization default to 100% so that the first reconnect attempts
+    // of all nodes do not end up in the same second.
+  unsigned reconnect_min_time = 1000;
+  cfg().getValue(name(), "RECONNECT_MIN_TIME", reconnect_min_time);
+  unsigned reconnect_max_time = 20000;
+  cfg().getValue(name(), "RECONNECT_MAX_TIME", reconnect_max_time);
+  unsigned reconnect_backoff = 50;
+  cfg().getValue(name(), "RECONNECT_BACKOFF", reconnect_backoff);
+  unsigned reconnect_randomize = 100;
+  cfg().getValue(name(), "RECONNECT_RANDOMIZE", reconnect_randomize);
+  m_con.setReconnectMinTime(reconnect_min_time);
+  m_con.setReconnectMaxTime(std::max(reconnect_max_time, reconnect_min_time));
+  m_con.setReconnectBackoffPercent(reconnect_backoff);
+  m_con.setReconnectRandomizePercent(reconnect_randomize);
+
   if (!cfg().getValue(name(), "CERT_PKI_DIR", m_pki_dir) || m_pki_dir.empty())
   {
     m_pki_dir = std::string(SVX_LOCAL_STATE_DIR) + "/pki";
@@ -432,6 +490,9 @@ bool ReflectorLogic::initialize(Async::Config& cfgobj, const std::string& logic_
               << m_crtfile << "'." << std::endl;
   }
 
+    // Resuming the TLS session make reconnects to a server a lot faster
+  m_ssl_ctx.enableClientSessionCache();
+
   cfg().getValue(name(), "CERT_DOWNLOAD_CA_BUNDLE", m_download_ca_bundle);
   if (!cfg().getValue(name(), "CERT_CAFILE", m_cafile))
   {
@@ -505,6 +566,47 @@ bool ReflectorLogic::initialize(Async::Config& cfgobj, const std::string& logic_
 
   AudioSource *prev_src = m_logic_con_in;
 
+  if (!cfg().getValue(name(), "MONITOR_TGS_PREROLL", 0U, 10000U,
+                      m_monitor_tgs_preroll, true))
+  {
+    std::cerr << "*** ERROR[" << name()
+              << "]: Illegal value (" << m_monitor_tgs_preroll
+              << ") for MONITOR_TGS_PREROLL. Valid range is 0 to 10000 ms."
+              << std::endl;
+    return false;
+  }
+
+  cfg().getValue(name(), "AUDIO_REDUNDANCY", m_audio_redundancy);
+
+  cfg().getValue(name(), "TRANSCODE_CODEC", m_transcode_codec);
+  if (!m_transcode_codec.empty())
+  {
+    if (!ReflectorClientAudio::codecIsAvailable(m_transcode_codec))
+    {
+      std::cerr << "*** ERROR[" << name() << "]: The codec \""
+                << m_transcode_codec << "\" given in TRANSCODE_CODEC is "
+                   "not available" << std::endl;
+      return false;
+    }
+    if (!cfg().getValue(name(), "TRANSCODE_BITRATE", m_transcode_bitrate) ||
+        (m_transcode_bitrate == 0))
+    {
+      std::cerr << "*** ERROR[" << name() << "]: TRANSCODE_BITRATE must be "
+                   "set when TRANSCODE_CODEC is set" << std::endl;
+      return false;
+    }
+  }
+
+  if (!cfg().getValue(name(), "AUDIO_TRACE_SAMPLE_RATE", 0.0, 100.0,
+                      m_audio_trace_sample_rate, true))
+  {
+    std::cerr << "*** ERROR[" << name()
+              << "]: Illegal value (" << m_audio_trace_sample_rate
+              << ") for AUDIO_TRACE_SAMPLE_RATE. Valid range is 0 to 100 %."
+              << std::endl;
+    return false;
+  }
+
   cfg().getValue(name(), "MUTE_FIRST_TX_LOC", m_mute_first_tx_loc);
   cfg().getValue(name(), "MUTE_FIRST_TX_REM", m_mute_first_tx_rem);
   if (m_mute_first_tx_loc || m_mute_first_tx_rem)
@@ -515,25 +617,17 @@ bool ReflectorLogic::initialize(Async::Config& cfgobj, const std::string& logic_
     prev_src = m_logic_con_in_valve;
   }
 
-  m_enc_endpoint = prev_src;
-  prev_src = 0;
-
-    // Create dummy audio codec used before setting the real encoder
-  if (!setAudioCodec("DUMMY")) { return false; }
-  prev_src = m_dec;
-
-    // Create jitter buffer
-  AudioFifo *fifo = new Async::AudioFifo(2*INTERNAL_SAMPLE_RATE);
-  prev_src->registerSink(fifo, true);
-  prev_src = fifo;
-  unsigned jitter_buffer_delay = 0;
-  cfg().getValue(name(), "JITTER_BUFFER_DELAY", jitter_buffer_delay);
-  if (jitter_buffer_delay > 0)
+    // The codecs, the jitter buffer and the rest of the audio path is
+    // shared with the ReflectorV2Logic
+  m_audio_stats.initialize(cfg(), name());
+  m_audio_stats.publishStats.connect(
+      sigc::mem_fun(*this, &ReflectorLogic::publishAudioStats));
+  m_audio.setStats(m_audio_stats.stats());
+  m_audio.setVerbose(m_verbose);
+  if (!m_audio.initialize(cfg(), name(), prev_src, m_logic_con_out))
   {
-    fifo->setPrebufSamples(jitter_buffer_delay * INTERNAL_SAMPLE_RATE / 1000);
+    return false;
   }
-
-  prev_src->registerSink(m_logic_con_out, true);
   prev_src = 0;
 
   cfg().getValue(name(), "DEFAULT_TG", m_default_tg);
@@ -566,7 +660,10 @@ bool ReflectorLogic::initialize(Async::Config& cfgobj, const std::string& logic_
     m_qsy_pending_timer.setTimeout(1000 * qsy_pending_timeout);
   }
 
-  m_event_handler = new EventHandler(event_handler_str, name());
+  bool event_handler_thread = false;
+  cfg().getValue(name(), "EVENT_HANDLER_THREAD", event_handler_thread);
+  m_event_handler = new EventHandler(event_handler_str, name(),
+                                     event_handler_thread);
   if (LinkManager::hasInstance())
   {
     m_event_handler->playFile.connect(
@@ -650,6 +747,24 @@ bool ReflectorLogic::initialize(Async::Config& cfgobj, const std::string& logic_
   cfg().getValue(name(), "UDP_HEARTBEAT_INTERVAL",
       m_udp_heartbeat_tx_cnt_reset);
 
+  if (!cfg().getValue(name(), "UDP_KEEPALIVE_INTERVAL",
+                      0U, 30U, m_udp_keepalive_req_interval, true))
+  {
+    std::cerr << "*** ERROR[" << name()
+              << "]: Illegal value (" << m_udp_keepalive_req_interval
+              << ") for UDP_KEEPALIVE_INTERVAL. Valid range is 0 to 30 "
+                 "seconds." << std::endl;
+    return false;
+  }
+
+  unsigned rx_telemetry_interval = DEFAULT_RX_TELEMETRY_INTERVAL;
+  cfg().getValue(name(), "RX_TELEMETRY_INTERVAL", rx_telemetry_interval);
+  m_rx_telemetry_timer.setTimeout(rx_telemetry_interval);
+
+  cfg().getValue(name(), "STATE_EVENT_BANDWIDTH", m_state_event_bandwidth);
+  m_state_event_budget = m_state_event_bandwidth;
+  m_state_event_budget_ts = std::chrono::steady_clock::now();
+
   Async::Application::app().runTask([&]{ connect(); });
 
   return true;
@@ -772,6 +887,7 @@ void ReflectorLogic::remoteCmdReceived(LogicBase* src_logic,
           MonitorTgEntry mte(tg);
           mte.timeout = m_tmp_monitor_timeout;
           m_monitor_tgs.insert(mte);
+          m_tmp_monitor_timer.setEnable(true);
           sendMsg(MsgTgMonitor(std::set<uint32_t>(
                   m_monitor_tgs.begin(), m_monitor_tgs.end())));
           os << "tmp_monitor_add " << tg;
@@ -840,10 +956,37 @@ void ReflectorLogic::remoteReceivedPublishStateEvent(
     return;
   }
 
+    // Events waiting to be sent are replaced by newer ones with the same
+    // name. Audio statistics are queued separately for each logic core.
+  if (event_name == LogicAudioStats::EVENT_NAME)
+  {
+    m_pending_state_events[event_name + "/" + logic->name()] = data;
+  }
+  else
+  {
+    m_pending_state_events[event_name] = data;
+  }
+  if (!m_state_event_timer.isEnabled())
+  {
+    processStateEvents();
+  }
+} /* ReflectorLogic::remoteReceivedPublishStateEvent */
+
+
+void ReflectorLogic::logicConOutConsumersChanged(bool has_consumers)
+{
+  m_audio.setConsumed(has_consumers);
+} /* ReflectorLogic::logicConOutConsumersChanged */
+
+
+void ReflectorLogic::sendStateEvent(const std::string& event_name,
+                                    const std::string& data)
+{
   if (event_name == "Voter:sql_state")
   {
     //MsgUdpSignalStrengthValues msg;
     MsgSignalStrengthValues msg;
+    bool flags_changed = false;
     std::istringstream is(data);
     Json::Value rx_arr;
     is >> rx_arr;
@@ -862,6 +1005,12 @@ void ReflectorLogic::remoteReceivedPublishStateEvent(
       bool is_enabled = rx_data.get("enabled", false).asBool();
       bool sql_open = rx_data.get("sql_open", false).asBool();
       bool is_active = rx_data.get("active", false).asBool();
+      if (protoVerAtLeast(3, 1))
+      {
+        flags_changed |= queueRxTelemetry(id, siglev,
+            MsgRxTelemetry::flags(is_enabled, sql_open, is_active));
+        continue;
+      }
       //MsgUdpSignalStrengthValues::Rx rx(id, siglev);
       MsgSignalStrengthValues::Rx rx(id, siglev);
       rx.setEnabled(is_enabled);
@@ -869,6 +1018,18 @@ void ReflectorLogic::remoteReceivedPublishStateEvent(
       rx.setActive(is_active);
       msg.pushBack(rx);
     }
+    if (protoVerAtLeast(3, 1))
+    {
+      if (flags_changed || (m_rx_telemetry_timer.timeout() == 0))
+      {
+        sendRxTelemetry();
+      }
+      else if (!m_rx_telemetry.empty())
+      {
+        m_rx_telemetry_timer.setEnable(true);
+      }
+      return;
+    }
     //sendUdpMsg(msg);
     sendMsg(msg);
   }
@@ -889,6 +1050,20 @@ void ReflectorLogic::remoteReceivedPublishStateEvent(
     int siglev = rx_data.get("siglev", 0).asInt();
     siglev = std::min(std::max(siglev, 0), 100);
     bool sql_open = rx_data.get("sql_open", false).asBool();
+    if (protoVerAtLeast(3, 1))
+    {
+      if (queueRxTelemetry(id, siglev,
+                           MsgRxTelemetry::flags(true, sql_open, sql_open)) ||
+          (m_rx_telemetry_timer.timeout() == 0))
+      {
+        sendRxTelemetry();
+      }
+      else
+      {
+        m_rx_telemetry_timer.setEnable(true);
+      }
+      return;
+    }
     //MsgUdpSignalStrengthValues::Rx rx(id, siglev);
     MsgSignalStrengthValues::Rx rx(id, siglev);
     rx.setEnabled(true);
@@ -946,7 +1121,18 @@ void ReflectorLogic::remoteReceivedPublishStateEvent(
     }
     sendMsg(msg);
   }
-} /* ReflectorLogic::remoteReceivedPublishStateEvent */
+  else if (event_name.find(LogicAudioStats::EVENT_NAME) == 0)
+  {
+      // The name of the source logic core follow the slash
+    const std::string::size_type slash = event_name.find('/');
+    if (slash == std::string::npos)
+    {
+      return;
+    }
+    sendMsg(MsgStateEvent(event_name.substr(slash + 1),
+                          LogicAudioStats::EVENT_NAME, data));
+  }
+} /* ReflectorLogic::sendStateEvent */
 
 
 /****************************************************************************
@@ -964,10 +1150,6 @@ ReflectorLogic::~ReflectorLogic(void)
   m_udp_sock = 0;
   delete m_logic_con_in;
   m_logic_con_in = 0;
-  delete m_enc;
-  m_enc = 0;
-  delete m_dec;
-  m_dec = 0;
   delete m_logic_con_in_valve;
   m_logic_con_in_valve = 0;
 } /* ReflectorLogic::~ReflectorLogic */
@@ -987,15 +1169,16 @@ void ReflectorLogic::onConnected(void)
             << m_con.remoteHost() << ":" << m_con.remotePort()
             << " (" << (m_con.isPrimary() ? "primary" : "secondary") << ")"
             << std::endl;
-  sendMsg(proto_ver);
+  m_proto_ver = MsgProtoVer();
+  sendMsg(m_proto_ver);
   m_udp_heartbeat_tx_cnt = m_udp_heartbeat_tx_cnt_reset;
   m_udp_heartbeat_rx_cnt = UDP_HEARTBEAT_RX_CNT_RESET;
   m_tcp_heartbeat_tx_cnt = TCP_HEARTBEAT_TX_CNT_RESET;
   m_tcp_heartbeat_rx_cnt = TCP_HEARTBEAT_RX_CNT_RESET;
+  m_udp_keepalive_interval = 0;
   m_heartbeat_timer.setEnable(true);
   //m_next_udp_tx_seq = 0;
   m_next_udp_rx_seq = 0;
-  timerclear(&m_last_talker_timestamp);
   //m_con_state = STATE_EXPECT_AUTH_CHALLENGE;
   //m_con.setMaxFrameSize(ReflectorMsg::MAX_SSL_SETUP_FRAME_SIZE);
   m_con_state = STATE_EXPECT_CA_INFO;
@@ -1010,25 +1193,27 @@ void ReflectorLogic::onDisconnected(TcpConnection*,
   cout << name() << ": Disconnected from " << m_con.remoteHost() << ":"
        << m_con.remotePort() << ": "
        << TcpConnection::disconnectReasonStr(reason) << endl;
-  //m_reconnect_timer.setTimeout(1000 + std::rand() % 5000);
+  m_reconnect_timer.setTimeout(60000 + std::rand() % 30000);
   m_reconnect_timer.setEnable(reason == TcpConnection::DR_ORDERED_DISCONNECT);
   delete m_udp_sock;
   m_udp_sock = 0;
   //m_next_udp_tx_seq = 0;
   m_next_udp_rx_seq = 0;
   m_heartbeat_timer.setEnable(false);
-  if (m_flush_timeout_timer.isEnabled())
-  {
-    m_flush_timeout_timer.setEnable(false);
-    m_enc->allEncodedSamplesFlushed();
-  }
-  if (timerisset(&m_last_talker_timestamp))
-  {
-    m_dec->flushEncodedSamples();
-    timerclear(&m_last_talker_timestamp);
-  }
+  m_rx_telemetry_timer.setEnable(false);
+  m_rx_telemetry.clear();
+  m_rx_telemetry_flags.clear();
+  m_nodes.clear();
+  m_node_list_ver = 0;
+  m_node_list_next_page = 0;
+  m_state_event_timer.setEnable(false);
+  m_pending_state_events.clear();
+  m_preroll.clear();
+  m_preroll_active = false;
+  m_audio.reset();
   m_con_state = STATE_DISCONNECTED;
   processEvent("reflector_connection_status_update 0");
+  statusChanged("reflector_connected", "0");
 } /* ReflectorLogic::onDisconnected */
 
 
@@ -1110,15 +1295,11 @@ void ReflectorLogic::onSslConnectionReady(TcpConnection*)
 
 
 void ReflectorLogic::onFrameReceived(FramedTcpConnection*,
-                                     std::vector<uint8_t>& data)
+                                     const uint8_t* data, size_t len)
 {
-  //std::cout << "### ReflectorLogic::onFrameReceived: data.size()="
-  //          << data.size() << std::endl;
-  char *buf = reinterpret_cast<char*>(&data.front());
-  int len = data.size();
-
-  stringstream ss;
-  ss.write(buf, len);
+  //std::cout << "### ReflectorLogic::onFrameReceived: len="
+  //          << len << std::endl;
+  FramedTcpConnection::FrameIStream ss(data, len);
 
   ReflectorMsg header;
   if (!header.unpack(ss))
@@ -1138,7 +1319,10 @@ void ReflectorLogic::onFrameReceived(FramedTcpConnection*,
     return;
   }
 
-  m_tcp_heartbeat_rx_cnt = TCP_HEARTBEAT_RX_CNT_RESET;
+  if (m_udp_keepalive_interval == 0)
+  {
+    m_tcp_heartbeat_rx_cnt = TCP_HEARTBEAT_RX_CNT_RESET;
+  }
 
   switch (header.type())
   {
@@ -1183,6 +1367,12 @@ void ReflectorLogic::onFrameReceived(FramedTcpConnection*,
     case MsgNodeLeft::TYPE:
       handleMsgNodeLeft(ss);
       break;
+    case MsgNodeListSnapshot::TYPE:
+      handleMsgNodeListSnapshot(ss);
+      break;
+    case MsgNodeListDelta::TYPE:
+      handleMsgNodeListDelta(ss);
+      break;
     case MsgTalkerStart::TYPE:
       handleMsgTalkerStart(ss);
       break;
@@ -1195,6 +1385,15 @@ void ReflectorLogic::onFrameReceived(FramedTcpConnection*,
     case MsgStartUdpEncryption::TYPE:
       handlMsgStartUdpEncryption(ss);
       break;
+    case MsgAudioParams::TYPE:
+      handleMsgAudioParams(ss);
+      break;
+    case MsgAudioTranscode::TYPE:
+      handleMsgAudioTranscode(ss);
+      break;
+    case MsgUdpKeepaliveInterval::TYPE:
+      handleMsgUdpKeepaliveInterval(ss);
+      break;
     default:
       // Better just ignoring unknown messages for easier addition of protocol
       // messages while being backwards compatible
@@ -1233,23 +1432,24 @@ void ReflectorLogic::handleMsgProtoVerDowngrade(std::istream& is)
     disconnect();
     return;
   }
-#if 0
-  if (msg.majorVer() == 2)
+    // Minor protocol versions only add functionality so downgrading within
+    // the same major version just mean that we stop using the new features
+  if ((msg.majorVer() == m_proto_ver.majorVer()) &&
+      (msg.minorVer() < m_proto_ver.minorVer()))
   {
     std::cout << name()
 	      << ": The server is requesting protocol downgrade to v"
 	      << msg.majorVer() << "." << msg.minorVer() << ". Complying."
 	      << std::endl;
-    sendMsg(MsgProtoVer(msg.majorVer(), msg.minorVer()));
-    m_con_state = STATE_EXPECT_AUTH_CHALLENGE;
+    m_proto_ver = MsgProtoVer(msg.majorVer(), msg.minorVer());
+    sendMsg(m_proto_ver);
   }
   else
-#endif
   {
     std::cout << name()
          << ": Server too old and we cannot downgrade to protocol version "
          << msg.majorVer() << "." << msg.minorVer() << " from "
-         << proto_ver.majorVer() << "." << proto_ver.minorVer()
+         << m_proto_ver.majorVer() << "." << m_proto_ver.minorVer()
          << std::endl;
     disconnect();
   }
@@ -1646,28 +1846,23 @@ void ReflectorLogic::handleMsgServerInfo(std::istream& is)
   //     std::ostream_iterator<std::string>(cout, " "));
   //cout << endl;
 
-  cout << name() << ": Connected nodes: ";
-  const vector<string>& nodes = msg.nodes();
-  if (!nodes.empty())
+    // From protocol version 3.4 the node list is only sent on request
+  if (!protoVerAtLeast(3, 4))
   {
-    vector<string>::const_iterator it = nodes.begin();
-    cout << *it++;
-    for (; it != nodes.end(); ++it)
-    {
-      cout << ", " << *it;
-    }
+    m_nodes.clear();
+    m_nodes.insert(msg.nodes().begin(), msg.nodes().end());
+    printNodeList();
   }
-  cout << endl;
 
   string selected_codec;
   for (vector<string>::const_iterator it = msg.codecs().begin();
        it != msg.codecs().end();
        ++it)
   {
-    if (codecIsAvailable(*it))
+    if (ReflectorClientAudio::codecIsAvailable(*it))
     {
       selected_codec = *it;
-      setAudioCodec(selected_codec);
+      m_audio.setAudioCodec(selected_codec);
       break;
     }
   }
@@ -1694,8 +1889,38 @@ void ReflectorLogic::handleMsgServerInfo(std::istream& is)
     }
   }
   */
+    // From protocol version 3.2 the client may select a cipher that is
+    // faster than AES on CPUs without hardware AES support
+  std::string cipher_name(UdpCipher::NAME);
+  if (protoVerAtLeast(3, 2))
+  {
+    std::string cfg_cipher("AUTO");
+    cfg().getValue(name(), "UDP_CIPHER", cfg_cipher);
+    if (cfg_cipher == "AUTO")
+    {
+      if (!EncryptedUdpSocket::hasAesHardware())
+      {
+        cipher_name = UdpCipher::NAME_NO_AES;
+      }
+    }
+    else if (cfg_cipher == UdpCipher::NAME_NO_AES)
+    {
+      cipher_name = UdpCipher::NAME_NO_AES;
+    }
+    else if (cfg_cipher != UdpCipher::NAME)
+    {
+      std::cerr << "*** WARNING[" << name() << "]: Unknown UDP_CIPHER \""
+                << cfg_cipher << "\". Using " << UdpCipher::NAME << "."
+                << std::endl;
+    }
+    if ((cipher_name != UdpCipher::NAME) &&
+        (EncryptedUdpSocket::fetchCipher(cipher_name) == nullptr))
+    {
+      cipher_name = UdpCipher::NAME;
+    }
+  }
   std::cout << name() << ": ";
-  const auto cipher = EncryptedUdpSocket::fetchCipher(UdpCipher::NAME);
+  const auto cipher = EncryptedUdpSocket::fetchCipher(cipher_name);
   if (cipher != nullptr)
   {
     std::cout << "Using UDP cipher " << EncryptedUdpSocket::cipherName(cipher)
@@ -1703,11 +1928,15 @@ void ReflectorLogic::handleMsgServerInfo(std::istream& is)
   }
   else
   {
-    std::cout << "Unsupported UDP cipher " << UdpCipher::NAME
+    std::cout << "Unsupported UDP cipher " << cipher_name
               << " :-(" << std::endl;
     disconnect();
     return;
   }
+  if (protoVerAtLeast(3, 2))
+  {
+    sendMsg(MsgUdpCipher(cipher_name));
+  }
 
   delete m_udp_sock;
   m_udp_cipher_iv_cntr = 1;
@@ -1748,6 +1977,20 @@ void ReflectorLogic::handleMsgServerInfo(std::istream& is)
                             node_info_os.str());
   sendMsg(node_info_msg);
 
+  if (protoVerAtLeast(3, 1) && (selected_codec == "OPUS"))
+  {
+    float frame_size = 20.0f;
+    cfg().getValue(name(), "OPUS_ENC_FRAME_SIZE", frame_size);
+    bool dtx = false;
+    cfg().getValue(name(), "OPUS_ENC_DTX", dtx);
+    bool fec = false;
+    cfg().getValue(name(), "OPUS_ENC_FEC", fec);
+    unsigned packet_loss = 0;
+    cfg().getValue(name(), "OPUS_ENC_PACKET_LOSS", packet_loss);
+    sendMsg(MsgAudioParams(static_cast<uint16_t>(frame_size * 10.0f + 0.5f),
+                           dtx, fec, std::min(packet_loss, 100U)));
+  }
+
 #if 0
     // Set up RX and TX sites node information
   MsgNodeInfo::RxSite rx_site;
@@ -1825,18 +2068,9 @@ void ReflectorLogic::handleMsgNodeList(std::istream& is)
     disconnect();
     return;
   }
-  cout << name() << ": Connected nodes: ";
-  const vector<string>& nodes = msg.nodes();
-  if (!nodes.empty())
-  {
-    vector<string>::const_iterator it = nodes.begin();
-    cout << *it++;
-    for (; it != nodes.end(); ++it)
-    {
-      cout << ", " << *it;
-    }
-  }
-  cout << endl;
+  m_nodes.clear();
+  m_nodes.insert(msg.nodes().begin(), msg.nodes().end());
+  printNodeList();
 } /* ReflectorLogic::handleMsgNodeList */
 
 
@@ -1850,6 +2084,7 @@ void ReflectorLogic::handleMsgNodeJoined(std::istream& is)
     disconnect();
     return;
   }
+  m_nodes.insert(msg.callsign());
   if (m_verbose)
   {
     std::cout << name() << ": Node joined: " << msg.callsign() << std::endl;
@@ -1867,6 +2102,7 @@ void ReflectorLogic::handleMsgNodeLeft(std::istream& is)
     disconnect();
     return;
   }
+  m_nodes.erase(msg.callsign());
   if (m_verbose)
   {
     std::cout << name() << ": Node left: " << msg.callsign() << std::endl;
@@ -1874,6 +2110,104 @@ void ReflectorLogic::handleMsgNodeLeft(std::istream& is)
 } /* ReflectorLogic::handleMsgNodeLeft */
 
 
+void ReflectorLogic::handleMsgNodeListSnapshot(std::istream& is)
+{
+  MsgNodeListSnapshot msg;
+  if (!msg.unpack(is))
+  {
+    std::cerr << "*** ERROR[" << name()
+              << "]: Could not unpack MsgNodeListSnapshot" << std::endl;
+    disconnect();
+    return;
+  }
+  if ((msg.page() >= msg.pageCount()) ||
+      ((msg.page() > 0) && (msg.page() != m_node_list_next_page)))
+  {
+    std::cerr << "*** ERROR[" << name()
+              << "]: Unexpected page " << msg.page() << " of "
+              << msg.pageCount() << " in MsgNodeListSnapshot" << std::endl;
+    disconnect();
+    return;
+  }
+
+  if (msg.page() == 0)
+  {
+    m_nodes.clear();
+    m_node_list_ver = msg.version();
+  }
+  std::vector<std::string> nodes;
+  if (!msg.getNodes(nodes))
+  {
+    std::cerr << "*** ERROR[" << name()
+              << "]: Malformed MsgNodeListSnapshot" << std::endl;
+    disconnect();
+    return;
+  }
+  m_nodes.insert(nodes.begin(), nodes.end());
+  m_node_list_next_page = msg.page() + 1;
+
+  if ((m_node_list_next_page == msg.pageCount()) &&
+      (m_verbose ||
+       (m_node_list_scope == MsgNodeListSubscribe::SCOPE_ALL)))
+  {
+    printNodeList();
+  }
+} /* ReflectorLogic::handleMsgNodeListSnapshot */
+
+
+void ReflectorLogic::handleMsgNodeListDelta(std::istream& is)
+{
+  MsgNodeListDelta msg;
+  if (!msg.unpack(is))
+  {
+    std::cerr << "*** ERROR[" << name()
+              << "]: Could not unpack MsgNodeListDelta" << std::endl;
+    disconnect();
+    return;
+  }
+    // Deltas already included in the last snapshot are ignored
+  if (msg.version() <= m_node_list_ver)
+  {
+    return;
+  }
+  m_node_list_ver = msg.version();
+  for (const auto& callsign : msg.joined())
+  {
+    m_nodes.insert(callsign);
+    if (m_verbose)
+    {
+      std::cout << name() << ": Node joined: " << callsign << std::endl;
+    }
+  }
+  for (const auto& callsign : msg.left())
+  {
+    m_nodes.erase(callsign);
+    if (m_verbose)
+    {
+      std::cout << name() << ": Node left: " << callsign << std::endl;
+    }
+  }
+} /* ReflectorLogic::handleMsgNodeListDelta */
+
+
+void ReflectorLogic::printNodeList(void) const
+{
+  cout << name() << ": Connected nodes";
+  if (m_node_list_scope == MsgNodeListSubscribe::SCOPE_TGS)
+  {
+    cout << " on selected and monitored TGs";
+  }
+  cout << " (" << m_nodes.size() << "): ";
+  const char* sep = "";
+  for (const auto& callsign : m_nodes)
+  {
+    cout << sep << callsign;
+    sep = ", ";
+  }
+  cout << endl;
+} /* ReflectorLogic::printNodeList */
+
+
 void ReflectorLogic::handleMsgTalkerStart(std::istream& is)
 {
   MsgTalkerStart msg;
@@ -1931,6 +2265,15 @@ void ReflectorLogic::handleMsgTalkerStop(std::istream& is)
   cout << name() << ": Talker stop on TG #" << msg.tg() << ": "
        << msg.callsign() << endl;
 
+  m_preroll.erase(msg.tg());
+  if (m_preroll_active && (msg.tg() == m_selected_tg))
+  {
+      // The talker stopped before the reflector started to send the normal
+      // audio stream so no flush will be received for it
+    m_preroll_active = false;
+    m_audio.flushDecoder();
+  }
+
   std::ostringstream ss;
   ss << "talker_stop " << msg.tg() << " " << msg.callsign();
   processEvent(ss.str());
@@ -1978,6 +2321,107 @@ void ReflectorLogic::handleMsgRequestQsy(std::istream& is)
 } /* ReflectorLogic::handleMsgRequestQsy */
 
 
+void ReflectorLogic::handleMsgAudioParams(std::istream& is)
+{
+  if (m_con_state < STATE_TCP_CONNECTED)
+  {
+    std::cerr << "*** ERROR[" << name() << "]: Unexpected MsgAudioParams"
+              << std::endl;
+    disconnect();
+    return;
+  }
+  MsgAudioParams msg;
+  if (!msg.unpack(is))
+  {
+    std::cerr << "*** ERROR[" << name()
+              << "]: Could not unpack MsgAudioParams" << std::endl;
+    disconnect();
+    return;
+  }
+  std::ostringstream frame_size;
+  frame_size << (msg.frameSize() / 10.0f);
+  std::cout << name() << ": The reflector selected audio frame size "
+            << frame_size.str() << "ms"
+            << ", DTX " << (msg.dtx() ? "on" : "off")
+            << ", FEC " << (msg.fec() ? "on" : "off")
+            << std::endl;
+  Async::AudioEncoder* enc = m_audio.encoder();
+  enc->setOption("FRAME_SIZE", frame_size.str());
+  enc->setOption("DTX", msg.dtx() ? "1" : "0");
+  enc->setOption("FEC", msg.fec() ? "1" : "0");
+  enc->setOption("PACKET_LOSS", std::to_string(msg.expectedPacketLoss()));
+} /* ReflectorLogic::handleMsgAudioParams */
+
+
+void ReflectorLogic::handleMsgAudioTranscode(std::istream& is)
+{
+  MsgAudioTranscode msg;
+  if (!msg.unpack(is))
+  {
+    std::cerr << "*** ERROR[" << name()
+              << "]: Could not unpack MsgAudioTranscode" << std::endl;
+    disconnect();
+    return;
+  }
+  if (msg.codec().empty())
+  {
+    std::cout << name() << ": The reflector rejected the request for audio "
+                 "transcoding to " << m_transcode_codec << "/"
+              << m_transcode_bitrate << std::endl;
+    return;
+  }
+  if ((msg.codec() != m_transcode_codec) ||
+      (msg.bitrate() != m_transcode_bitrate))
+  {
+    std::cerr << "*** ERROR[" << name()
+              << "]: Unexpected MsgAudioTranscode reply" << std::endl;
+    disconnect();
+    return;
+  }
+    // Only received audio is transcoded. Our own audio is still sent using
+    // the codec selected by the reflector.
+  if (!m_audio.setDecoderCodec(msg.codec(), msg.bitrate()))
+  {
+    disconnect();
+    return;
+  }
+  std::cout << name() << ": Receiving audio transcoded to " << msg.codec()
+            << "/" << msg.bitrate() << std::endl;
+} /* ReflectorLogic::handleMsgAudioTranscode */
+
+
+void ReflectorLogic::handleMsgUdpKeepaliveInterval(std::istream& is)
+{
+  MsgUdpKeepaliveInterval msg;
+  if (!msg.unpack(is))
+  {
+    std::cerr << "*** ERROR[" << name()
+              << "]: Could not unpack MsgUdpKeepaliveInterval" << std::endl;
+    disconnect();
+    return;
+  }
+  if ((m_udp_keepalive_req_interval == 0) ||
+      (msg.interval() > m_udp_keepalive_req_interval))
+  {
+    std::cerr << "*** ERROR[" << name()
+              << "]: Unexpected MsgUdpKeepaliveInterval reply" << std::endl;
+    disconnect();
+    return;
+  }
+  if (msg.interval() == 0)
+  {
+    std::cout << name() << ": The reflector rejected the request for UDP "
+                 "keepalives. Using heartbeats." << std::endl;
+    return;
+  }
+  m_udp_keepalive_interval = msg.interval();
+  m_udp_heartbeat_tx_cnt = 1;
+  m_tcp_heartbeat_rx_cnt = UDP_HEARTBEAT_RX_CNT_RESET;
+  std::cout << name() << ": Using UDP keepalives every "
+            << m_udp_keepalive_interval << " seconds" << std::endl;
+} /* ReflectorLogic::handleMsgUdpKeepaliveInterval */
+
+
 void ReflectorLogic::handlMsgStartUdpEncryption(std::istream& is)
 {
   //std::cout << "### ReflectorLogic::handlMsgStartUdpEncryption" << std::endl;
@@ -2020,16 +2464,17 @@ void ReflectorLogic::sendMsg(const ReflectorMsg& msg)
 
   m_tcp_heartbeat_tx_cnt = TCP_HEARTBEAT_TX_CNT_RESET;
 
-  ostringstream ss;
   ReflectorMsg header(msg.type());
-  if (!header.pack(ss) || !msg.pack(ss))
+  std::vector<uint8_t> buf(header.packedSize() + msg.packedSize());
+  Async::MsgBufWriter w(buf.data(), buf.size());
+  if (!header.pack(w) || !msg.pack(w))
   {
     std::cerr << "*** ERROR[" << name()
               << "]: Failed to pack reflector TCP message" << std::endl;
     disconnect();
     return;
   }
-  if (m_con.write(ss.str().data(), ss.str().size()) == -1)
+  if (m_con.write(buf.data(), w.size()) == -1)
   {
     std::cerr << "*** ERROR[" << name()
               << "]: Failed to write message to network connection"
@@ -2039,30 +2484,41 @@ void ReflectorLogic::sendMsg(const ReflectorMsg& msg)
 } /* ReflectorLogic::sendMsg */
 
 
-void ReflectorLogic::sendEncodedAudio(const void *buf, int count)
+bool ReflectorLogic::sendEncodedAudio(const void *buf, int count)
 {
   if (!isLoggedIn())
   {
-    return;
+    return false;
   }
+  sendUdpMsg(MsgUdpAudio(buf, count));
 
-  if (m_flush_timeout_timer.isEnabled())
+    // A trace is sent directly after a sample of the audio frames, spread
+    // out evenly to give the requested sample rate
+  if ((m_audio_trace_sample_rate > 0.0) && protoVerAtLeast(3, 3))
   {
-    m_flush_timeout_timer.setEnable(false);
+    m_audio_trace_acc += m_audio_trace_sample_rate / 100.0;
+    if (m_audio_trace_acc >= 1.0)
+    {
+      m_audio_trace_acc -= 1.0;
+      MsgUdpAudioTrace msg(++m_audio_trace_id);
+      msg.addHop(MsgUdpAudioTrace::HOP_ORIGIN,
+          std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::system_clock::now().time_since_epoch()).count());
+      sendUdpMsg(msg);
+    }
   }
-  sendUdpMsg(MsgUdpAudio(buf, count));
+  return true;
 } /* ReflectorLogic::sendEncodedAudio */
 
 
-void ReflectorLogic::flushEncodedAudio(void)
+bool ReflectorLogic::flushEncodedAudio(void)
 {
   if (!isLoggedIn())
   {
-    flushTimeout();
-    return;
+    return false;
   }
   sendUdpMsg(MsgUdpFlushSamples());
-  m_flush_timeout_timer.setEnable(true);
+  return true;
 } /* ReflectorLogic::flushEncodedAudio */
 
 
@@ -2075,9 +2531,8 @@ bool ReflectorLogic::udpCipherDataReceived(const IpAddress& addr, uint16_t port,
     //             "short to hold associated data" << std::endl;
     return true;
   }
-  stringstream ss;
-  ss.write(reinterpret_cast<const char *>(buf), UdpCipher::AADLEN);
-  if (!m_aad.unpack(ss))
+  Async::MsgBufReader r(buf, UdpCipher::AADLEN);
+  if (!m_aad.unpack(r))
   {
     std::cerr << "*** WARNING: Unpacking associated data failed for UDP "
                  "datagram from " << addr << ":" << port << std::endl;
@@ -2085,8 +2540,9 @@ bool ReflectorLogic::udpCipherDataReceived(const IpAddress& addr, uint16_t port,
   }
   //std::cout << "### ReflectorLogic::udpCipherDataReceived: m_aad.iv_cntr="
   //          << m_aad.iv_cntr << std::endl;
-  m_udp_sock->setCipherIV(UdpCipher::IV{m_udp_cipher_iv_rand, 0,
-                                        m_aad.iv_cntr});
+  UdpCipher::IV{m_udp_cipher_iv_rand, 0, m_aad.iv_cntr}
+    .assignTo(m_udp_iv_buf);
+  m_udp_sock->setCipherIV(m_udp_iv_buf);
   return false;
 } /* ReflectorLogic::udpCipherDataReceived */
 
@@ -2120,11 +2576,10 @@ void ReflectorLogic::udpDatagramReceived(const IpAddress& addr, uint16_t port,
     return;
   }
 
-  stringstream ss;
-  ss.write(reinterpret_cast<const char *>(buf), count);
+  Async::MsgBufReader r(buf, count);
 
   ReflectorUdpMsg header;
-  if (!header.unpack(ss))
+  if (!header.unpack(r))
   {
     cerr << "*** WARNING[" << name()
          << "]: Unpacking failed for UDP message header" << endl;
@@ -2140,15 +2595,19 @@ void ReflectorLogic::udpDatagramReceived(const IpAddress& addr, uint16_t port,
   //}
 
     // Check sequence number
+  UdpCipher::IVCntr lost_frames = 0;
   if (m_aad.iv_cntr < m_next_udp_rx_seq) // Frame out of sequence (ignore)
   {
     std::cout << name()
               << ": Dropping out of sequence UDP frame with seq="
               << m_aad.iv_cntr << std::endl;
+    m_audio.framesLate(1);
     return;
   }
   else if (m_aad.iv_cntr > m_next_udp_rx_seq) // Frame lost
   {
+    lost_frames = m_aad.iv_cntr - m_next_udp_rx_seq;
+    m_audio.framesLost(lost_frames);
     std::cout << name() << ": UDP frame(s) lost. Expected seq="
               << m_next_udp_rx_seq
               << " but received " << m_aad.iv_cntr
@@ -2158,6 +2617,12 @@ void ReflectorLogic::udpDatagramReceived(const IpAddress& addr, uint16_t port,
   m_next_udp_rx_seq = m_aad.iv_cntr + 1;
 
   m_udp_heartbeat_rx_cnt = UDP_HEARTBEAT_RX_CNT_RESET;
+  if (m_udp_keepalive_interval > 0)
+  {
+      // The UDP datagrams are authenticated so they prove that the reflector
+      // is alive. No TCP heartbeats are sent when using keepalives.
+    m_tcp_heartbeat_rx_cnt = UDP_HEARTBEAT_RX_CNT_RESET;
+  }
 
   if ((m_con_state == STATE_EXPECT_UDP_HEARTBEAT) &&
       (header.type() == MsgUdpHeartbeat::TYPE))
@@ -2167,6 +2632,7 @@ void ReflectorLogic::udpDatagramReceived(const IpAddress& addr, uint16_t port,
     m_con.markAsEstablished();
     m_con_state = STATE_CONNECTED;
     processEvent("reflector_connection_status_update 1");
+    statusChanged("reflector_connected", "1");
 
     if (m_selected_tg > 0)
     {
@@ -2179,6 +2645,32 @@ void ReflectorLogic::udpDatagramReceived(const IpAddress& addr, uint16_t port,
       sendMsg(MsgTgMonitor(
             std::set<uint32_t>(m_monitor_tgs.begin(), m_monitor_tgs.end())));
     }
+
+    if (m_monitor_tgs_preroll > 0)
+    {
+      sendMsg(MsgMonitorAudio(true));
+    }
+
+    if (m_audio_redundancy)
+    {
+      sendMsg(MsgAudioRedundancy(true));
+    }
+
+    if (!m_transcode_codec.empty())
+    {
+      sendMsg(MsgAudioTranscode(m_transcode_codec, m_transcode_bitrate));
+    }
+
+    if (m_udp_keepalive_req_interval > 0)
+    {
+      sendMsg(MsgUdpKeepaliveInterval(m_udp_keepalive_req_interval));
+    }
+
+    if (protoVerAtLeast(3, 4) &&
+        (m_node_list_scope != MsgNodeListSubscribe::SCOPE_NONE))
+    {
+      sendMsg(MsgNodeListSubscribe(m_node_list_scope));
+    }
   }
 
   if (!isLoggedIn())
@@ -2189,33 +2681,84 @@ void ReflectorLogic::udpDatagramReceived(const IpAddress& addr, uint16_t port,
   switch (header.type())
   {
     case MsgUdpHeartbeat::TYPE:
+    case MsgUdpKeepalive::TYPE:
       break;
 
     case MsgUdpAudio::TYPE:
     {
-      MsgUdpAudio msg;
-      if (!msg.unpack(ss))
+        // The audio is given to the decoder directly from the receive
+        // buffer instead of copying it into a MsgUdpAudio object
+      const uint8_t* audio = nullptr;
+      size_t audio_size = 0;
+      if (!MsgUdpAudio::peekAudioData(r, buf, audio, audio_size))
       {
         std::cerr << "*** WARNING[" << name()
                   << "]: Could not unpack MsgUdpAudio" << std::endl;
         return;
       }
-      if (!msg.audioData().empty())
+      if (!discardPrerollAudio())
+      {
+        m_audio.audioReceived(const_cast<uint8_t*>(audio), audio_size,
+                              lost_frames);
+      }
+      break;
+    }
+
+    case MsgUdpRedundantAudio::TYPE:
+    {
+      MsgUdpRedundantAudio msg;
+      if (!msg.unpack(r))
+      {
+        std::cerr << "*** WARNING[" << name()
+                  << "]: Could not unpack MsgUdpRedundantAudio" << std::endl;
+        return;
+      }
+      if (!discardPrerollAudio())
       {
-        gettimeofday(&m_last_talker_timestamp, NULL);
-        m_dec->writeEncodedSamples(
-            &msg.audioData().front(), msg.audioData().size());
+        handleRedundantAudio(msg, lost_frames);
       }
       break;
     }
 
+    case MsgUdpMonitorAudio::TYPE:
+    {
+      MsgUdpMonitorAudio msg;
+      if (!msg.unpack(r))
+      {
+        std::cerr << "*** WARNING[" << name()
+                  << "]: Could not unpack MsgUdpMonitorAudio" << std::endl;
+        return;
+      }
+      handleMonitorAudio(msg);
+      break;
+    }
+
+    case MsgUdpAudioTrace::TYPE:
+    {
+      MsgUdpAudioTrace msg;
+      if (!msg.unpack(r))
+      {
+        std::cerr << "*** WARNING[" << name()
+                  << "]: Could not unpack MsgUdpAudioTrace" << std::endl;
+        return;
+      }
+      handleAudioTrace(msg);
+      break;
+    }
+
     case MsgUdpFlushSamples::TYPE:
-      m_dec->flushEncodedSamples();
-      timerclear(&m_last_talker_timestamp);
+      if (m_preroll_active)
+      {
+          // The reflector has switched over to the selected TG. This flush
+          // end the stream from the previous TG, which has been thrown away.
+        m_preroll_active = false;
+        break;
+      }
+      m_audio.flushReceived();
       break;
 
     case MsgUdpAllSamplesFlushed::TYPE:
-      m_enc->allEncodedSamplesFlushed();
+      m_audio.allSamplesFlushedReceived();
       break;
 
     default:
@@ -2232,7 +2775,9 @@ void ReflectorLogic::udpDatagramReceived(const IpAddress& addr, uint16_t port,
 void ReflectorLogic::sendUdpMsg(const UdpCipher::AAD& aad,
                                 const ReflectorUdpMsg& msg)
 {
-  m_udp_heartbeat_tx_cnt = m_udp_heartbeat_tx_cnt_reset;
+  m_udp_heartbeat_tx_cnt = (m_udp_keepalive_interval > 0)
+    ? m_udp_keepalive_interval
+    : m_udp_heartbeat_tx_cnt_reset;
 
   if (m_udp_sock == 0)
   {
@@ -2240,17 +2785,20 @@ void ReflectorLogic::sendUdpMsg(const UdpCipher::AAD& aad,
   }
 
   ReflectorUdpMsg header(msg.type());
-  ostringstream ss;
-  if (!header.pack(ss) || !msg.pack(ss))
+  m_udp_tx_buf.resize(header.packedSize() + msg.packedSize());
+  Async::MsgBufWriter w(m_udp_tx_buf.data(), m_udp_tx_buf.size());
+  if (!header.pack(w) || !msg.pack(w))
   {
     std::cerr << "*** ERROR[" << name()
               << "]: Failed to pack reflector UDP message" << std::endl;
     return;
   }
-  m_udp_sock->setCipherIV(UdpCipher::IV{m_udp_cipher_iv_rand, m_client_id,
-                                        aad.iv_cntr});
-  std::ostringstream adss;
-  if (!aad.pack(adss))
+  UdpCipher::IV{m_udp_cipher_iv_rand, m_client_id, aad.iv_cntr}
+    .assignTo(m_udp_iv_buf);
+  m_udp_sock->setCipherIV(m_udp_iv_buf);
+  uint8_t aadbuf[UdpCipher::AADLEN + sizeof(UdpCipher::ClientId)];
+  Async::MsgBufWriter aadw(aadbuf, sizeof(aadbuf));
+  if (!aad.pack(aadw))
   {
     std::cerr << "*** WARNING: Packing associated data failed for UDP "
                  "datagram to " << m_con.remoteHost() << ":"
@@ -2258,8 +2806,7 @@ void ReflectorLogic::sendUdpMsg(const UdpCipher::AAD& aad,
     return;
   }
   m_udp_sock->write(m_con.remoteHost(), m_con.remotePort(),
-                    adss.str().data(), adss.str().size(),
-                    ss.str().data(), ss.str().size());
+                    aadbuf, aadw.size(), m_udp_tx_buf.data(), w.size());
 } /* ReflectorLogic::sendUdpMsg */
 
 
@@ -2323,27 +2870,9 @@ void ReflectorLogic::allEncodedSamplesFlushed(void)
 } /* ReflectorLogic::allEncodedSamplesFlushed */
 
 
-void ReflectorLogic::flushTimeout(Async::Timer *t)
-{
-  m_flush_timeout_timer.setEnable(false);
-  m_enc->allEncodedSamplesFlushed();
-} /* ReflectorLogic::flushTimeout */
-
-
 void ReflectorLogic::handleTimerTick(Async::Timer *t)
 {
-  if (timerisset(&m_last_talker_timestamp))
-  {
-    struct timeval now, diff;
-    gettimeofday(&now, NULL);
-    timersub(&now, &m_last_talker_timestamp, &diff);
-    if (diff.tv_sec > 3)
-    {
-      cout << name() << ": Last talker audio timeout" << endl;
-      m_dec->flushEncodedSamples();
-      timerclear(&m_last_talker_timestamp);
-    }
-  }
+  m_audio.checkTalkerTimeout();
 
   if (--m_udp_heartbeat_tx_cnt == 0)
   {
@@ -2351,6 +2880,16 @@ void ReflectorLogic::handleTimerTick(Async::Timer *t)
     {
       sendUdpRegisterMsg();
     }
+    else if (isLoggedIn() && (m_udp_keepalive_interval > 0))
+    {
+      sendUdpMsg(MsgUdpKeepalive(m_selected_tg, !m_logic_con_in->isIdle(),
+                                 !m_logic_con_out->isIdle()));
+        // Vary the interval by up to 20% so that the keepalives from many
+        // nodes do not bunch up on the reflector
+      const unsigned spread = m_udp_keepalive_interval * 2 / 5;
+      m_udp_heartbeat_tx_cnt = m_udp_keepalive_interval - spread / 2 +
+                               std::rand() % (spread + 1);
+    }
     else if (isLoggedIn())
     {
       sendUdpMsg(MsgUdpHeartbeat());
@@ -2359,7 +2898,14 @@ void ReflectorLogic::handleTimerTick(Async::Timer *t)
 
   if (--m_tcp_heartbeat_tx_cnt == 0)
   {
-    sendMsg(MsgHeartbeat());
+    if (m_udp_keepalive_interval > 0)
+    {
+      m_tcp_heartbeat_tx_cnt = TCP_HEARTBEAT_TX_CNT_RESET;
+    }
+    else
+    {
+      sendMsg(MsgHeartbeat());
+    }
   }
 
   if (--m_udp_heartbeat_rx_cnt == 0)
@@ -2376,89 +2922,6 @@ void ReflectorLogic::handleTimerTick(Async::Timer *t)
 } /* ReflectorLogic::handleTimerTick */
 
 
-bool ReflectorLogic::setAudioCodec(const std::string& codec_name)
-{
-  delete m_enc;
-  m_enc = Async::AudioEncoder::create(codec_name);
-  if (m_enc == 0)
-  {
-    cerr << "*** ERROR[" << name()
-         << "]: Failed to initialize " << codec_name
-         << " audio encoder" << endl;
-    m_enc = Async::AudioEncoder::create("DUMMY");
-    assert(m_enc != 0);
-    return false;
-  }
-  m_enc->writeEncodedSamples.connect(
-      mem_fun(*this, &ReflectorLogic::sendEncodedAudio));
-  m_enc->flushEncodedSamples.connect(
-      mem_fun(*this, &ReflectorLogic::flushEncodedAudio));
-  m_enc_endpoint->registerSink(m_enc, false);
-
-  string opt_prefix(m_enc->name());
-  opt_prefix += "_ENC_";
-  list<string> names = cfg().listSection(name());
-  for (list<string>::const_iterator nit=names.begin(); nit!=names.end(); ++nit)
-  {
-    if ((*nit).find(opt_prefix) == 0)
-    {
-      string opt_value;
-      cfg().getValue(name(), *nit, opt_value);
-      string opt_name((*nit).substr(opt_prefix.size()));
-      m_enc->setOption(opt_name, opt_value);
-    }
-  }
-  m_enc->printCodecParams();
-
-  AudioSink *sink = 0;
-  if (m_dec != 0)
-  {
-    sink = m_dec->sink();
-    m_dec->unregisterSink();
-    delete m_dec;
-  }
-  m_dec = Async::AudioDecoder::create(codec_name);
-  if (m_dec == 0)
-  {
-    cerr << "*** ERROR[" << name()
-         << "]: Failed to initialize " << codec_name
-         << " audio decoder" << endl;
-    m_dec = Async::AudioDecoder::create("DUMMY");
-    assert(m_dec != 0);
-    return false;
-  }
-  m_dec->allEncodedSamplesFlushed.connect(
-      mem_fun(*this, &ReflectorLogic::allEncodedSamplesFlushed));
-  if (sink != 0)
-  {
-    m_dec->registerSink(sink, true);
-  }
-
-  opt_prefix = string(m_dec->name()) + "_DEC_";
-  names = cfg().listSection(name());
-  for (list<string>::const_iterator nit=names.begin(); nit!=names.end(); ++nit)
-  {
-    if ((*nit).find(opt_prefix) == 0)
-    {
-      string opt_value;
-      cfg().getValue(name(), *nit, opt_value);
-      string opt_name((*nit).substr(opt_prefix.size()));
-      m_dec->setOption(opt_name, opt_value);
-    }
-  }
-  m_dec->printCodecParams();
-
-  return true;
-} /* ReflectorLogic::setAudioCodec */
-
-
-bool ReflectorLogic::codecIsAvailable(const std::string &codec_name)
-{
-  return AudioEncoder::isAvailable(codec_name) &&
-         AudioDecoder::isAvailable(codec_name);
-} /* ReflectorLogic::codecIsAvailable */
-
-
 void ReflectorLogic::onLogicConInStreamIsIdle(bool is_idle)
 {
   //std::cout << "### ReflectorLogic::onLogicConInStreamIsIdle: "
@@ -2574,6 +3037,8 @@ void ReflectorLogic::selectTg(uint32_t tg, const std::string& event, bool unmute
     std::cout << name() << ": Selecting TG #" << tg << std::endl;
 
     sendMsg(MsgSelectTG(tg));
+    m_preroll_active = false;
+    playPreRoll(tg);
     if (m_selected_tg != 0)
     {
       m_previous_tg = m_selected_tg;
@@ -2591,6 +3056,7 @@ void ReflectorLogic::selectTg(uint32_t tg, const std::string& event, bool unmute
     }
     m_event_handler->setVariable(name() + "::selected_tg", m_selected_tg);
     m_event_handler->setVariable(name() + "::previous_tg", m_previous_tg);
+    statusChanged("selected_tg", std::to_string(m_selected_tg));
 
     ostringstream os;
     os << "tg_selected " << m_selected_tg << " " << m_previous_tg;
@@ -2605,6 +3071,133 @@ void ReflectorLogic::selectTg(uint32_t tg, const std::string& event, bool unmute
 } /* ReflectorLogic::selectTg */
 
 
+void ReflectorLogic::handleMonitorAudio(const MsgUdpMonitorAudio& msg)
+{
+  if ((m_monitor_tgs_preroll == 0) || msg.audioData().empty())
+  {
+    return;
+  }
+
+  const auto now = std::chrono::steady_clock::now();
+  if (msg.tg() == m_selected_tg)
+  {
+      // The reflector has not yet switched over to the selected TG so the
+      // monitor audio is played until the normal audio stream start
+    if (m_preroll_active)
+    {
+      m_preroll_last_frame = now;
+      m_audio.writeAudio(const_cast<uint8_t*>(msg.audioData().data()),
+                         msg.audioData().size());
+    }
+    return;
+  }
+
+  PreRoll& preroll = m_preroll[msg.tg()];
+  PreRollFrame frame;
+  frame.timestamp = now;
+  frame.audio = msg.audioData();
+  preroll.push_back(std::move(frame));
+  const auto max_age = std::chrono::milliseconds(m_monitor_tgs_preroll);
+  while (now - preroll.front().timestamp > max_age)
+  {
+    preroll.pop_front();
+  }
+} /* ReflectorLogic::handleMonitorAudio */
+
+
+bool ReflectorLogic::discardPrerollAudio(void)
+{
+    // Audio from the previously selected TG may still arrive after a
+    // pre-roll has been started. It is thrown away until the reflector
+    // switch over to the newly selected TG.
+  if (m_preroll_active)
+  {
+    if (std::chrono::steady_clock::now() - m_preroll_last_frame <
+        std::chrono::milliseconds(PREROLL_HANDOVER_TIMEOUT))
+    {
+      return true;
+    }
+    m_preroll_active = false;
+  }
+  return false;
+} /* ReflectorLogic::discardPrerollAudio */
+
+
+void ReflectorLogic::handleRedundantAudio(MsgUdpRedundantAudio& msg,
+                                          unsigned lost_frames)
+{
+    // The copy of the previous frame replace the last lost frame. Any
+    // frames lost before that are concealed by the decoder.
+  std::vector<uint8_t>& prev = msg.prevAudioData();
+  if ((lost_frames > 0) && !prev.empty())
+  {
+    m_audio.audioReceived(prev.data(), prev.size(), lost_frames - 1);
+    lost_frames = 0;
+  }
+  std::vector<uint8_t>& audio = msg.audioData();
+  m_audio.audioReceived(audio.data(), audio.size(), lost_frames);
+} /* ReflectorLogic::handleRedundantAudio */
+
+
+void ReflectorLogic::handleAudioTrace(MsgUdpAudioTrace& msg)
+{
+    // The trace follow directly after the audio frame that it belongs to.
+    // Traces for audio that is thrown away during a pre-roll handover are
+    // ignored.
+  if (m_preroll_active ||
+      (msg.lastHop() != MsgUdpAudioTrace::HOP_REFLECTOR) ||
+      (msg.hops().size() + 2 > MsgUdpAudioTrace::MAX_HOPS))
+  {
+    return;
+  }
+  const uint64_t now = std::chrono::duration_cast<std::chrono::microseconds>(
+      std::chrono::system_clock::now().time_since_epoch()).count();
+  msg.addHop(MsgUdpAudioTrace::HOP_NODE_RX, now);
+  msg.addHop(MsgUdpAudioTrace::HOP_PLAYOUT,
+             now + 1000ULL * m_audio.bufferedMs());
+  sendUdpMsg(msg);
+} /* ReflectorLogic::handleAudioTrace */
+
+
+void ReflectorLogic::playPreRoll(uint32_t tg)
+{
+  PreRollMap::iterator it = m_preroll.find(tg);
+  if (it == m_preroll.end())
+  {
+    return;
+  }
+  PreRoll preroll;
+  preroll.swap(it->second);
+  m_preroll.erase(it);
+
+    // Only audio that is recent enough is played. If the last frame is old
+    // the talker has probably stopped.
+  const auto now = std::chrono::steady_clock::now();
+  const auto max_age = std::chrono::milliseconds(m_monitor_tgs_preroll);
+  while (!preroll.empty() && (now - preroll.front().timestamp > max_age))
+  {
+    preroll.pop_front();
+  }
+  if (preroll.empty() ||
+      (now - preroll.back().timestamp >
+       std::chrono::milliseconds(PREROLL_HANDOVER_TIMEOUT)))
+  {
+    return;
+  }
+
+  std::cout << name() << ": Playing "
+            << std::chrono::duration_cast<std::chrono::milliseconds>(
+                 now - preroll.front().timestamp).count()
+            << "ms of pre-roll audio for TG #" << tg << std::endl;
+  for (auto& frame : preroll)
+  {
+    m_audio.writeAudio(frame.audio.data(), frame.audio.size());
+  }
+  m_preroll_active = true;
+  m_preroll_last_frame = preroll.back().timestamp;
+} /* ReflectorLogic::playPreRoll */
+
+
 void ReflectorLogic::processEvent(const std::string& event)
 {
   m_event_handler->processEvent(name() + "::" + event);
@@ -2627,6 +3220,7 @@ void ReflectorLogic::processTgSelectionEvent(void)
 void ReflectorLogic::checkTmpMonitorTimeout(void)
 {
   bool changed = false;
+  bool tmp_monitors = false;
   MonitorTgsSet::iterator it = m_monitor_tgs.begin();
   while (it != m_monitor_tgs.end())
   {
@@ -2646,9 +3240,20 @@ void ReflectorLogic::checkTmpMonitorTimeout(void)
         os << "tmp_monitor_remove " << mte.tg;
         processEvent(os.str());
       }
+      else
+      {
+        tmp_monitors = true;
+      }
     }
     it = next;
   }
+
+    // Only keep the timer running while there are temporary monitors
+  if (!tmp_monitors)
+  {
+    m_tmp_monitor_timer.setEnable(false);
+  }
+
   if (changed)
   {
     sendMsg(MsgTgMonitor(std::set<uint32_t>(
@@ -2670,6 +3275,123 @@ void ReflectorLogic::qsyPendingTimeout(void)
 } /* ReflectorLogic::qsyPendingTimeout */
 
 
+bool ReflectorLogic::protoVerAtLeast(uint16_t major, uint16_t minor) const
+{
+  return (m_proto_ver.majorVer() > major) ||
+         ((m_proto_ver.majorVer() == major) &&
+          (m_proto_ver.minorVer() >= minor));
+} /* ReflectorLogic::protoVerAtLeast */
+
+
+bool ReflectorLogic::queueRxTelemetry(char id, int siglev, uint8_t flags)
+{
+  uint64_t now = std::chrono::duration_cast<std::chrono::milliseconds>(
+      std::chrono::system_clock::now().time_since_epoch()).count();
+  m_rx_telemetry[id] = RxTelemetry{now, static_cast<uint8_t>(siglev), flags};
+  auto it = m_rx_telemetry_flags.find(id);
+  if ((it != m_rx_telemetry_flags.end()) && (it->second == flags))
+  {
+    return false;
+  }
+  m_rx_telemetry_flags[id] = flags;
+  return true;
+} /* ReflectorLogic::queueRxTelemetry */
+
+
+void ReflectorLogic::sendRxTelemetry(void)
+{
+  m_rx_telemetry_timer.setEnable(false);
+  if (m_rx_telemetry.empty())
+  {
+    return;
+  }
+
+    // All records are sent relative to the oldest one
+  uint64_t base = m_rx_telemetry.begin()->second.timestamp;
+  for (const auto& item : m_rx_telemetry)
+  {
+    base = std::min(base, item.second.timestamp);
+  }
+  MsgRxTelemetry msg(base);
+  for (const auto& item : m_rx_telemetry)
+  {
+    const RxTelemetry& rx = item.second;
+    uint64_t offset = std::min(rx.timestamp - base,
+        uint64_t(std::numeric_limits<uint16_t>::max()));
+    msg.pushBack(MsgRxTelemetry::Record(item.first, rx.siglev, rx.flags,
+                                        offset));
+  }
+  m_rx_telemetry.clear();
+  sendMsg(msg);
+} /* ReflectorLogic::sendRxTelemetry */
+
+
+  /*
+   * Send queued state events as long as the TCP connection is not backed up
+   * and the bandwidth budget allow it. Otherwise, try again a little later.
+   * Since only the latest event of each name is kept, the queue cannot grow
+   * beyond the number of distinct event names.
+   */
+void ReflectorLogic::processStateEvents(void)
+{
+  m_state_event_timer.setEnable(false);
+  while (!m_pending_state_events.empty())
+  {
+    if ((m_con_state != STATE_CONNECTED) || !stateEventAllowed())
+    {
+      m_state_event_timer.setEnable(m_con_state == STATE_CONNECTED);
+      return;
+    }
+    auto it = m_pending_state_events.begin();
+    const std::string event_name(it->first);
+    const std::string data(std::move(it->second));
+    m_pending_state_events.erase(it);
+
+    size_t backlog = m_con.writeQueueBytes();
+    sendStateEvent(event_name, data);
+    if (m_state_event_bandwidth > 0)
+    {
+      size_t new_backlog = m_con.writeQueueBytes();
+      if (new_backlog > backlog)
+      {
+        m_state_event_budget -= new_backlog - backlog;
+      }
+    }
+  }
+} /* ReflectorLogic::processStateEvents */
+
+
+bool ReflectorLogic::stateEventAllowed(void)
+{
+    // Telemetry must never delay the control messages
+  if (m_con.writeQueueBytes() > STATE_EVENT_MAX_TCP_BACKLOG)
+  {
+    return false;
+  }
+  if (m_state_event_bandwidth == 0)
+  {
+    return true;
+  }
+
+    // A token bucket allowing bursts of up to one second worth of data
+  auto now = std::chrono::steady_clock::now();
+  double elapsed = std::chrono::duration<double>(
+      now - m_state_event_budget_ts).count();
+  m_state_event_budget_ts = now;
+  m_state_event_budget = std::min(
+      m_state_event_budget + elapsed * m_state_event_bandwidth,
+      double(m_state_event_bandwidth));
+  return m_state_event_budget > 0.0;
+} /* ReflectorLogic::stateEventAllowed */
+
+
+void ReflectorLogic::publishAudioStats(const std::string& event_name,
+                                       const std::string& data)
+{
+  remoteReceivedPublishStateEvent(this, event_name, data);
+} /* ReflectorLogic::publishAudioStats */
+
+
 bool ReflectorLogic::isIdle(void)
 {
   return m_logic_con_out->isIdle() && m_logic_con_in->isIdle();
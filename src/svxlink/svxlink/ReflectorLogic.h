@@ -6,7 +6,7 @@
 
 \verbatim
 SvxLink - A Multi Purpose Voice Services System for Ham Radio Use
-Copyright (C) 2003-2023 Tobias Blomberg / SM0SVX
+Copyright (C) 2003-2026 Tobias Blomberg / SM0SVX
 
 This program is free software; you can redistribute it and/or modify
 it under the terms of the GNU General Public License as published by
@@ -36,6 +36,10 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 
 #include <sys/time.h>
 #include <string>
+#include <map>
+#include <set>
+#include <deque>
+#include <chrono>
 #include <json/json.h>
 
 
@@ -62,6 +66,8 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 
 #include "LogicBase.h"
 #include "../reflector/ReflectorMsg.h"
+#include "ReflectorClientAudio.h"
+#include "LogicAudioStats.h"
 
 
 /****************************************************************************
@@ -178,6 +184,16 @@ class ReflectorLogic : public LogicBase
         LogicBase *logic, const std::string& event_name,
         const std::string& data);
 
+    /**
+     * @brief   The consumers of the logic connection audio have changed
+     * @param   has_consumers \em True if any other logic receive the audio
+     *
+     * Audio received from the reflector is not decoded when there are no
+     * consumers. Silence of the same length is written instead so that the
+     * idle state and talk group timeouts work just like before.
+     */
+    virtual void logicConOutConsumersChanged(bool has_consumers);
+
   protected:
     /**
      * @brief 	Destructor
@@ -217,12 +233,33 @@ class ReflectorLogic : public LogicBase
     typedef Async::TcpPrioClient<Async::FramedTcpConnection> FramedTcpClient;
     typedef std::set<MonitorTgEntry> MonitorTgsSet;
 
+    struct RxTelemetry
+    {
+      uint64_t  timestamp;
+      uint8_t   siglev;
+      uint8_t   flags;
+    };
+    typedef std::map<char, RxTelemetry> RxTelemetryMap;
+    typedef std::map<char, uint8_t> RxFlagsMap;
+
+    struct PreRollFrame
+    {
+      std::chrono::steady_clock::time_point timestamp;
+      std::vector<uint8_t>                  audio;
+    };
+    typedef std::deque<PreRollFrame> PreRoll;
+    typedef std::map<uint32_t, PreRoll> PreRollMap;
+
     static const unsigned DEFAULT_UDP_HEARTBEAT_TX_CNT_RESET  = 15;
     static const unsigned UDP_HEARTBEAT_RX_CNT_RESET          = 60;
     static const unsigned TCP_HEARTBEAT_TX_CNT_RESET          = 10;
     static const unsigned TCP_HEARTBEAT_RX_CNT_RESET          = 15;
     static const unsigned DEFAULT_TG_SELECT_TIMEOUT           = 30;
     static const int      DEFAULT_TMP_MONITOR_TIMEOUT         = 3600;
+    static const unsigned DEFAULT_RX_TELEMETRY_INTERVAL       = 100;
+    static const unsigned STATE_EVENT_RETRY_INTERVAL          = 100;
+    static const size_t   STATE_EVENT_MAX_TCP_BACKLOG         = 1024;
+    static const unsigned PREROLL_HANDOVER_TIMEOUT            = 200;
 
     std::string                       m_reflector_host;
     FramedTcpClient                   m_con;
@@ -236,16 +273,14 @@ class ReflectorLogic : public LogicBase
     //uint16_t                          m_next_udp_tx_seq;
     UdpCipher::IVCntr                 m_next_udp_rx_seq;
     Async::Timer                      m_heartbeat_timer;
-    Async::AudioDecoder*              m_dec;
-    Async::Timer                      m_flush_timeout_timer;
+    LogicAudioStats                   m_audio_stats;
+    ReflectorClientAudio              m_audio;
     unsigned                          m_udp_heartbeat_tx_cnt_reset;
     unsigned                          m_udp_heartbeat_tx_cnt;
     unsigned                          m_udp_heartbeat_rx_cnt;
     unsigned                          m_tcp_heartbeat_tx_cnt;
     unsigned                          m_tcp_heartbeat_rx_cnt;
-    struct timeval                    m_last_talker_timestamp;
     ConState                          m_con_state;
-    Async::AudioEncoder*              m_enc;
     uint32_t                          m_default_tg;
     unsigned                          m_tg_select_timeout;
     unsigned                          m_tg_select_inhibit_timeout;
@@ -260,7 +295,6 @@ class ReflectorLogic : public LogicBase
     uint32_t                          m_last_qsy;
     MonitorTgsSet                     m_monitor_tgs;
     Json::Value                       m_node_info;
-    Async::AudioSource*               m_enc_endpoint;
     Async::AudioValve*                m_logic_con_in_valve;
     bool                              m_mute_first_tx_loc;
     bool                              m_mute_first_tx_rem;
@@ -281,7 +315,34 @@ class ReflectorLogic : public LogicBase
     std::vector<uint8_t>              m_udp_cipher_iv_rand;
     UdpCipher::IVCntr                 m_udp_cipher_iv_cntr;
     UdpCipher::AAD                    m_aad;
+    std::vector<uint8_t>              m_udp_tx_buf;
+    std::vector<uint8_t>              m_udp_iv_buf;
     bool                              m_download_ca_bundle = true;
+    MsgProtoVer                       m_proto_ver;
+    Async::Timer                      m_rx_telemetry_timer;
+    RxTelemetryMap                    m_rx_telemetry;
+    RxFlagsMap                        m_rx_telemetry_flags;
+    std::map<std::string, std::string> m_pending_state_events;
+    Async::Timer                      m_state_event_timer;
+    unsigned                          m_state_event_bandwidth = 0;
+    double                            m_state_event_budget = 0.0;
+    std::chrono::steady_clock::time_point m_state_event_budget_ts;
+    unsigned                          m_monitor_tgs_preroll = 0;
+    bool                              m_audio_redundancy = false;
+    std::string                       m_transcode_codec;
+    unsigned                          m_transcode_bitrate = 0;
+    unsigned                          m_udp_keepalive_req_interval = 0;
+    unsigned                          m_udp_keepalive_interval = 0;
+    uint8_t                           m_node_list_scope = 1;
+    std::set<std::string>             m_nodes;
+    uint32_t                          m_node_list_ver = 0;
+    unsigned                          m_node_list_next_page = 0;
+    PreRollMap                        m_preroll;
+    bool                              m_preroll_active = false;
+    std::chrono::steady_clock::time_point m_preroll_last_frame;
+    double                            m_audio_trace_sample_rate = 0.0;
+    double                            m_audio_trace_acc = 0.0;
+    uint32_t                          m_audio_trace_id = 0;
 
     ReflectorLogic(const ReflectorLogic&);
     ReflectorLogic& operator=(const ReflectorLogic&);
@@ -292,17 +353,23 @@ class ReflectorLogic : public LogicBase
                       X509_STORE_CTX *x509_store_ctx);
     void onSslConnectionReady(Async::TcpConnection* con);
     void onFrameReceived(Async::FramedTcpConnection *con,
-                         std::vector<uint8_t>& data);
+                         const uint8_t* data, size_t len);
     void handleMsgError(std::istream& is);
     void handleMsgProtoVerDowngrade(std::istream& is);
     void handleMsgAuthChallenge(std::istream& is);
     void handleMsgNodeList(std::istream& is);
     void handleMsgNodeJoined(std::istream& is);
     void handleMsgNodeLeft(std::istream& is);
+    void handleMsgNodeListSnapshot(std::istream& is);
+    void handleMsgNodeListDelta(std::istream& is);
+    void printNodeList(void) const;
     void handleMsgTalkerStart(std::istream& is);
     void handleMsgTalkerStop(std::istream& is);
     void handleMsgRequestQsy(std::istream& is);
     void handlMsgStartUdpEncryption(std::istream& is);
+    void handleMsgAudioParams(std::istream& is);
+    void handleMsgAudioTranscode(std::istream& is);
+    void handleMsgUdpKeepaliveInterval(std::istream& is);
     void handleMsgAuthOk(void);
     void handleMsgCAInfo(std::istream& is);
     void handleMsgStartEncryption(void);
@@ -310,9 +377,15 @@ class ReflectorLogic : public LogicBase
     void handleMsgClientCsrRequest(void);
     void handleMsgClientCert(std::istream& is);
     void handleMsgServerInfo(std::istream& is);
+    void handleMonitorAudio(const MsgUdpMonitorAudio& msg);
+    bool discardPrerollAudio(void);
+    void handleRedundantAudio(MsgUdpRedundantAudio& msg,
+                              unsigned lost_frames);
+    void handleAudioTrace(MsgUdpAudioTrace& msg);
+    void playPreRoll(uint32_t tg);
     void sendMsg(const ReflectorMsg& msg);
-    void sendEncodedAudio(const void *buf, int count);
-    void flushEncodedAudio(void);
+    bool sendEncodedAudio(const void *buf, int count);
+    bool flushEncodedAudio(void);
     bool udpCipherDataReceived(const Async::IpAddress& addr, uint16_t port,
                                void *buf, int count);
     void udpDatagramReceived(const Async::IpAddress& addr, uint16_t port,
@@ -326,10 +399,7 @@ class ReflectorLogic : public LogicBase
     bool isConnected(void) const;
     bool isLoggedIn(void) const { return m_con_state == STATE_CONNECTED; }
     void allEncodedSamplesFlushed(void);
-    void flushTimeout(Async::Timer *t=0);
     void handleTimerTick(Async::Timer *t);
-    bool setAudioCodec(const std::string& codec_name);
-    bool codecIsAvailable(const std::string &codec_name);
     void tgSelectTimerExpired(void);
     void onLogicConInStreamIsIdle(bool is_idle);
     void onLogicConOutStreamStateChanged(bool is_active, bool is_idle);
@@ -338,6 +408,15 @@ class ReflectorLogic : public LogicBase
     void processTgSelectionEvent(void);
     void checkTmpMonitorTimeout(void);
     void qsyPendingTimeout(void);
+    bool protoVerAtLeast(uint16_t major, uint16_t minor) const;
+    bool queueRxTelemetry(char id, int siglev, uint8_t flags);
+    void sendRxTelemetry(void);
+    void sendStateEvent(const std::string& event_name,
+                        const std::string& data);
+    void processStateEvents(void);
+    void publishAudioStats(const std::string& event_name,
+                           const std::string& data);
+    bool stateEventAllowed(void);
     void checkIdle(void);
     bool isIdle(void);
     void handlePlayFile(const std::string& path);
@@ -139,12 +139,11 @@ ReflectorLogic::ReflectorLogic(void)
     m_logic_con_in(0), m_logic_con_out(0),
     m_reconnect_timer(60000, Timer::TYPE_ONESHOT, false),
     m_next_udp_tx_seq(0), m_next_udp_rx_seq(0),
-    m_heartbeat_timer(1000, Timer::TYPE_PERIODIC, false), m_dec(0),
-    m_flush_timeout_timer(3000, Timer::TYPE_ONESHOT, false),
+    m_heartbeat_timer(1000, Timer::TYPE_PERIODIC, false),
     m_udp_heartbeat_tx_cnt_reset(DEFAULT_UDP_HEARTBEAT_TX_CNT_RESET),
     m_udp_heartbeat_tx_cnt(0), m_udp_heartbeat_rx_cnt(0),
     m_tcp_heartbeat_tx_cnt(0), m_tcp_heartbeat_rx_cnt(0),
-    m_con_state(STATE_DISCONNECTED), m_enc(0), m_default_tg(0),
+    m_con_state(STATE_DISCONNECTED), m_default_tg(0),
     m_tg_select_timeout(DEFAULT_TG_SELECT_TIMEOUT),
     m_tg_select_inhibit_timeout(DEFAULT_TG_SELECT_TIMEOUT),
     m_tg_select_timer(1000, Async::Timer::TYPE_PERIODIC),
@@ -161,9 +160,12 @@ ReflectorLogic::ReflectorLogic(void)
       sigc::hide(mem_fun(*this, &ReflectorLogic::reconnect)));
   m_heartbeat_timer.expired.connect(
       mem_fun(*this, &ReflectorLogic::handleTimerTick));
-  m_flush_timeout_timer.expired.connect(
-      mem_fun(*this, &ReflectorLogic::flushTimeout));
-  timerclear(&m_last_talker_timestamp);
+  m_audio.sendAudio.connect(
+      sigc::mem_fun(*this, &ReflectorLogic::sendEncodedAudio));
+  m_audio.sendFlush.connect(
+      sigc::mem_fun(*this, &ReflectorLogic::flushEncodedAudio));
+  m_audio.sendAllSamplesFlushed.connect(
+      sigc::mem_fun(*this, &ReflectorLogic::allEncodedSamplesFlushed));
 
   m_tg_select_timer.expired.connect(sigc::hide(
         sigc::mem_fun(*this, &ReflectorLogic::tgSelectTimerExpired)));
@@ -334,25 +336,15 @@ bool ReflectorLogic::initialize(Async::Config& cfgobj, const std::string& logic_
     prev_src = m_logic_con_in_valve;
   }
 
-  m_enc_endpoint = prev_src;
-  prev_src = 0;
-
-    // Create dummy audio codec used before setting the real encoder
-  if (!setAudioCodec("DUMMY")) { return false; }
-  prev_src = m_dec;
-
-    // Create jitter buffer
-  AudioFifo *fifo = new Async::AudioFifo(2*INTERNAL_SAMPLE_RATE);
-  prev_src->registerSink(fifo, true);
-  prev_src = fifo;
-  unsigned jitter_buffer_delay = 0;
-  cfg().getValue(name(), "JITTER_BUFFER_DELAY", jitter_buffer_delay);
-  if (jitter_buffer_delay > 0)
+    // The codecs, the jitter buffer and the rest of the audio path is
+    // shared with the ReflectorLogic
+  m_audio_stats.initialize(cfg(), name());
+  m_audio.setStats(m_audio_stats.stats());
+  m_audio.setVerbose(m_verbose);
+  if (!m_audio.initialize(cfg(), name(), prev_src, m_logic_con_out))
   {
-    fifo->setPrebufSamples(jitter_buffer_delay * INTERNAL_SAMPLE_RATE / 1000);
+    return false;
   }
-
-  prev_src->registerSink(m_logic_con_out, true);
   prev_src = 0;
 
   cfg().getValue(name(), "DEFAULT_TG", m_default_tg);
@@ -750,6 +742,12 @@ void ReflectorLogic::remoteReceivedPublishStateEvent(
 } /* ReflectorLogic::remoteReceivedPublishStateEvent */
 
 
+void ReflectorLogic::logicConOutConsumersChanged(bool has_consumers)
+{
+  m_audio.setConsumed(has_consumers);
+} /* ReflectorLogic::logicConOutConsumersChanged */
+
+
 /****************************************************************************
  *
  * Protected member functions
@@ -765,10 +763,6 @@ ReflectorLogic::~ReflectorLogic(void)
   m_udp_sock = 0;
   delete m_logic_con_in;
   m_logic_con_in = 0;
-  delete m_enc;
-  m_enc = 0;
-  delete m_dec;
-  m_dec = 0;
   delete m_logic_con_in_valve;
   m_logic_con_in_valve = 0;
 } /* ReflectorLogic::~ReflectorLogic */
@@ -796,7 +790,6 @@ void ReflectorLogic::onConnected(void)
   m_heartbeat_timer.setEnable(true);
   m_next_udp_tx_seq = 0;
   m_next_udp_rx_seq = 0;
-  timerclear(&m_last_talker_timestamp);
   m_con_state = STATE_EXPECT_AUTH_CHALLENGE;
   m_con.setMaxFrameSize(ReflectorMsg::MAX_PREAUTH_FRAME_SIZE);
   processEvent("reflector_connection_status_update 1");
@@ -816,16 +809,7 @@ void ReflectorLogic::onDisconnected(TcpConnection *con,
   m_next_udp_tx_seq = 0;
   m_next_udp_rx_seq = 0;
   m_heartbeat_timer.setEnable(false);
-  if (m_flush_timeout_timer.isEnabled())
-  {
-    m_flush_timeout_timer.setEnable(false);
-    m_enc->allEncodedSamplesFlushed();
-  }
-  if (timerisset(&m_last_talker_timestamp))
-  {
-    m_dec->flushEncodedSamples();
-    timerclear(&m_last_talker_timestamp);
-  }
+  m_audio.reset();
   m_con_state = STATE_DISCONNECTED;
   processEvent("reflector_connection_status_update 0");
 } /* ReflectorLogic::onDisconnected */
@@ -1033,10 +1017,10 @@ void ReflectorLogic::handleMsgServerInfo(std::istream& is)
        it != msg.codecs().end();
        ++it)
   {
-    if (codecIsAvailable(*it))
+    if (ReflectorClientAudio::codecIsAvailable(*it))
     {
       selected_codec = *it;
-      setAudioCodec(selected_codec);
+      m_audio.setAudioCodec(selected_codec);
       break;
     }
   }
@@ -1326,30 +1310,25 @@ void ReflectorLogic::sendMsg(const ReflectorMsg& msg)
 } /* ReflectorLogic::sendMsg */
 
 
-void ReflectorLogic::sendEncodedAudio(const void *buf, int count)
+bool ReflectorLogic::sendEncodedAudio(const void *buf, int count)
 {
   if (!isLoggedIn())
   {
-    return;
-  }
-
-  if (m_flush_timeout_timer.isEnabled())
-  {
-    m_flush_timeout_timer.setEnable(false);
+    return false;
   }
   sendUdpMsg(MsgUdpAudio(buf, count));
+  return true;
 } /* ReflectorLogic::sendEncodedAudio */
 
 
-void ReflectorLogic::flushEncodedAudio(void)
+bool ReflectorLogic::flushEncodedAudio(void)
 {
   if (!isLoggedIn())
   {
-    flushTimeout();
-    return;
+    return false;
   }
   sendUdpMsg(MsgUdpFlushSamples());
-  m_flush_timeout_timer.setEnable(true);
+  return true;
 } /* ReflectorLogic::flushEncodedAudio */
 
 
@@ -1402,10 +1381,12 @@ void ReflectorLogic::udpDatagramReceived(const IpAddress& addr, uint16_t port,
     cout << name()
          << ": Dropping out of sequence UDP frame with seq="
          << header.sequenceNum() << endl;
+    m_audio.framesLate(1);
     return;
   }
   else if (udp_rx_seq_diff > 0) // Frame lost
   {
+    m_audio.framesLost(udp_rx_seq_diff);
     cout << name() << ": UDP frame(s) lost. Expected seq="
          << m_next_udp_rx_seq
          << " but received " << header.sequenceNum()
@@ -1432,20 +1413,18 @@ void ReflectorLogic::udpDatagramReceived(const IpAddress& addr, uint16_t port,
       }
       if (!msg.audioData().empty())
       {
-        gettimeofday(&m_last_talker_timestamp, NULL);
-        m_dec->writeEncodedSamples(
-            &msg.audioData().front(), msg.audioData().size());
+        m_audio.audioReceived(&msg.audioData().front(),
+                              msg.audioData().size(), udp_rx_seq_diff);
       }
       break;
     }
 
     case MsgUdpFlushSamples::TYPE:
-      m_dec->flushEncodedSamples();
-      timerclear(&m_last_talker_timestamp);
+      m_audio.flushReceived();
       break;
 
     case MsgUdpAllSamplesFlushed::TYPE:
-      m_enc->allEncodedSamplesFlushed();
+      m_audio.allSamplesFlushedReceived();
       break;
 
     default:
@@ -1530,27 +1509,9 @@ void ReflectorLogic::allEncodedSamplesFlushed(void)
 } /* ReflectorLogic::allEncodedSamplesFlushed */
 
 
-void ReflectorLogic::flushTimeout(Async::Timer *t)
-{
-  m_flush_timeout_timer.setEnable(false);
-  m_enc->allEncodedSamplesFlushed();
-} /* ReflectorLogic::flushTimeout */
-
-
 void ReflectorLogic::handleTimerTick(Async::Timer *t)
 {
-  if (timerisset(&m_last_talker_timestamp))
-  {
-    struct timeval now, diff;
-    gettimeofday(&now, NULL);
-    timersub(&now, &m_last_talker_timestamp, &diff);
-    if (diff.tv_sec > 3)
-    {
-      cout << name() << ": Last talker audio timeout" << endl;
-      m_dec->flushEncodedSamples();
-      timerclear(&m_last_talker_timestamp);
-    }
-  }
+  m_audio.checkTalkerTimeout();
 
   if (--m_udp_heartbeat_tx_cnt == 0)
   {
@@ -1576,89 +1537,6 @@ void ReflectorLogic::handleTimerTick(Async::Timer *t)
 } /* ReflectorLogic::handleTimerTick */
 
 
-bool ReflectorLogic::setAudioCodec(const std::string& codec_name)
-{
-  delete m_enc;
-  m_enc = Async::AudioEncoder::create(codec_name);
-  if (m_enc == 0)
-  {
-    cerr << "*** ERROR[" << name()
-         << "]: Failed to initialize " << codec_name
-         << " audio encoder" << endl;
-    m_enc = Async::AudioEncoder::create("DUMMY");
-    assert(m_enc != 0);
-    return false;
-  }
-  m_enc->writeEncodedSamples.connect(
-      mem_fun(*this, &ReflectorLogic::sendEncodedAudio));
-  m_enc->flushEncodedSamples.connect(
-      mem_fun(*this, &ReflectorLogic::flushEncodedAudio));
-  m_enc_endpoint->registerSink(m_enc, false);
-
-  string opt_prefix(m_enc->name());
-  opt_prefix += "_ENC_";
-  list<string> names = cfg().listSection(name());
-  for (list<string>::const_iterator nit=names.begin(); nit!=names.end(); ++nit)
-  {
-    if ((*nit).find(opt_prefix) == 0)
-    {
-      string opt_value;
-      cfg().getValue(name(), *nit, opt_value);
-      string opt_name((*nit).substr(opt_prefix.size()));
-      m_enc->setOption(opt_name, opt_value);
-    }
-  }
-  m_enc->printCodecParams();
-
-  AudioSink *sink = 0;
-  if (m_dec != 0)
-  {
-    sink = m_dec->sink();
-    m_dec->unregisterSink();
-    delete m_dec;
-  }
-  m_dec = Async::AudioDecoder::create(codec_name);
-  if (m_dec == 0)
-  {
-    cerr << "*** ERROR[" << name()
-         << "]: Failed to initialize " << codec_name
-         << " audio decoder" << endl;
-    m_dec = Async::AudioDecoder::create("DUMMY");
-    assert(m_dec != 0);
-    return false;
-  }
-  m_dec->allEncodedSamplesFlushed.connect(
-      mem_fun(*this, &ReflectorLogic::allEncodedSamplesFlushed));
-  if (sink != 0)
-  {
-    m_dec->registerSink(sink, true);
-  }
-
-  opt_prefix = string(m_dec->name()) + "_DEC_";
-  names = cfg().listSection(name());
-  for (list<string>::const_iterator nit=names.begin(); nit!=names.end(); ++nit)
-  {
-    if ((*nit).find(opt_prefix) == 0)
-    {
-      string opt_value;
-      cfg().getValue(name(), *nit, opt_value);
-      string opt_name((*nit).substr(opt_prefix.size()));
-      m_dec->setOption(opt_name, opt_value);
-    }
-  }
-  m_dec->printCodecParams();
-
-  return true;
-} /* ReflectorLogic::setAudioCodec */
-
-
-bool ReflectorLogic::codecIsAvailable(const std::string &codec_name)
-{
-  return AudioEncoder::isAvailable(codec_name) &&
-         AudioDecoder::isAvailable(codec_name);
-} /* ReflectorLogic::codecIsAvailable */
-
-
 void ReflectorLogic::onLogicConInStreamStateChanged(bool is_active,
                                                     bool is_idle)
 {
@@ -61,6 +61,8 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
  ****************************************************************************/
 
 #include "LogicBase.h"
+#include "ReflectorClientAudio.h"
+#include "LogicAudioStats.h"
 
 
 /****************************************************************************
@@ -177,6 +179,12 @@ class ReflectorLogic : public LogicBase
         LogicBase *logic, const std::string& event_name,
         const std::string& data);
 
+    /**
+     * @brief   The consumers of the logic connection audio have changed
+     * @param   has_consumers \em True if any other logic receive the audio
+     */
+    virtual void logicConOutConsumersChanged(bool has_consumers);
+
   protected:
     /**
      * @brief 	Destructor
@@ -224,16 +232,14 @@ class ReflectorLogic : public LogicBase
     uint16_t                          m_next_udp_tx_seq;
     uint16_t                          m_next_udp_rx_seq;
     Async::Timer                      m_heartbeat_timer;
-    Async::AudioDecoder*              m_dec;
-    Async::Timer                      m_flush_timeout_timer;
+    LogicAudioStats                   m_audio_stats;
+    ReflectorClientAudio              m_audio;
     unsigned                          m_udp_heartbeat_tx_cnt_reset;
     unsigned                          m_udp_heartbeat_tx_cnt;
     unsigned                          m_udp_heartbeat_rx_cnt;
     unsigned                          m_tcp_heartbeat_tx_cnt;
     unsigned                          m_tcp_heartbeat_rx_cnt;
-    struct timeval                    m_last_talker_timestamp;
     ConState                          m_con_state;
-    Async::AudioEncoder*              m_enc;
     uint32_t                          m_default_tg;
     unsigned                          m_tg_select_timeout;
     unsigned                          m_tg_select_inhibit_timeout;
@@ -248,7 +254,6 @@ class ReflectorLogic : public LogicBase
     uint32_t                          m_last_qsy;
     MonitorTgsSet                     m_monitor_tgs;
     Json::Value                       m_node_info;
-    Async::AudioSource*               m_enc_endpoint;
     Async::AudioValve*                m_logic_con_in_valve;
     bool                              m_mute_first_tx_loc;
     bool                              m_mute_first_tx_rem;
@@ -277,8 +282,8 @@ class ReflectorLogic : public LogicBase
     void handleMsgAuthOk(void);
     void handleMsgServerInfo(std::istream& is);
     void sendMsg(const ReflectorMsg& msg);
-    void sendEncodedAudio(const void *buf, int count);
-    void flushEncodedAudio(void);
+    bool sendEncodedAudio(const void *buf, int count);
+    bool flushEncodedAudio(void);
     void udpDatagramReceived(const Async::IpAddress& addr, uint16_t port,
                              void *buf, int count);
     void sendUdpMsg(const ReflectorUdpMsg& msg);
@@ -288,10 +293,7 @@ class ReflectorLogic : public LogicBase
     bool isConnected(void) const;
     bool isLoggedIn(void) const { return m_con_state == STATE_CONNECTED; }
     void allEncodedSamplesFlushed(void);
-    void flushTimeout(Async::Timer *t=0);
     void handleTimerTick(Async::Timer *t);
-    bool setAudioCodec(const std::string& codec_name);
-    bool codecIsAvailable(const std::string &codec_name);
     void tgSelectTimerExpired(void);
     void onLogicConInStreamStateChanged(bool is_active, bool is_idle);
     void onLogicConOutStreamStateChanged(bool is_active, bool is_idle);
@@ -54,6 +54,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 
 #include <Rx.h>
 #include <Tx.h>
+#include <Metrics.h>
 
 
 /****************************************************************************
@@ -291,6 +292,17 @@ bool RepeaterLogic::initialize(Async::Config& cfgobj, const std::string& logic_n
 
   cfg().getValue(name(), "IDENT_NAG_MIN_TIME", ident_nag_min_time);
   cfg().getValue(name(), "DTMF_IGNORE_WHEN_NOT_UP", m_dtmf_ignore_when_not_up);
+  cfg().getValue(name(), "LOW_LATENCY_REPEAT", m_low_latency_repeat);
+  if (m_low_latency_repeat)
+  {
+    createRptFastPath();
+  }
+
+  m_metric_sql_to_ptt = &SvxLink::Metrics::instance()->histogram(
+      "svxlink_repeater_sql_to_ptt_seconds",
+      "Time from squelch open to the transmitter being keyed",
+      SvxLink::Metrics::exponentialBuckets(0.01, 2.0, 10),
+      {{"logic", name()}});
 
   rx().toneDetected.connect(mem_fun(*this, &RepeaterLogic::detectedTone));
   
@@ -352,6 +364,8 @@ bool RepeaterLogic::activateModule(Module *module)
 {
   open_reason = "MODULE";
   setUp(true, open_reason);
+    // The module should get the audio through the normal path
+  rptFastPathSetActive(false);
   return Logic::activateModule(module);
 } /* RepeaterLogic::activateModule */
 
@@ -390,7 +404,7 @@ void RepeaterLogic::dtmfDigitDetected(char digit, int duration)
 } /* RepeaterLogic::dtmfDigitDetected */
 
 
-void RepeaterLogic::selcallSequenceDetected(std::string sequence)
+void RepeaterLogic::selcallSequenceDetected(const std::string& sequence)
 {
   if (repeater_is_up)
   {
@@ -546,6 +560,16 @@ void RepeaterLogic::setUp(bool up, string reason)
     short_sql_open_cnt = 0;
     repeater_is_up = true;
 
+      // In low latency mode the transmitter is keyed before the event
+      // handler is called so that the time spent in the event handler does
+      // not delay the transmitter
+    if (m_low_latency_repeat)
+    {
+      rxValveSetOpen(true);
+      setTxCtrlMode(Tx::TX_ON);
+      updateRptFastPath(rx().squelchIsOpen());
+    }
+
     stringstream ss;
     //ss << "repeater_up " << (ident ? "1" : "0");
     ss << "repeater_up " << reason;
@@ -583,6 +607,7 @@ void RepeaterLogic::setUp(bool up, string reason)
     open_reason = "?";
     rxValveSetOpen(false);
     repeater_is_up = false;
+    updateRptFastPath(false);
     up_timer.setEnable(false);
     idle_sound_timer.setEnable(false);
     ident_nag_timer.setEnable(false);
@@ -609,9 +634,11 @@ void RepeaterLogic::squelchOpen(bool is_open)
   {
     gettimeofday(&sql_up_timestamp, NULL);
   }
+  m_ptt_pending = is_open && !tx().isTransmitting();
 
   if (repeater_is_up)
   {
+    updateRptFastPath(is_open);
     if (is_open)
     {
       setIdle(false);
@@ -687,6 +714,20 @@ void RepeaterLogic::squelchOpen(bool is_open)
 } /* RepeaterLogic::squelchOpen */
 
 
+void RepeaterLogic::transmitterStateChange(bool is_transmitting)
+{
+  if (is_transmitting && m_ptt_pending)
+  {
+    m_ptt_pending = false;
+    struct timeval now, diff_tv;
+    gettimeofday(&now, NULL);
+    timersub(&now, &sql_up_timestamp, &diff_tv);
+    m_metric_sql_to_ptt->observe(diff_tv.tv_sec + diff_tv.tv_usec / 1.0e6);
+  }
+  Logic::transmitterStateChange(is_transmitting);
+} /* RepeaterLogic::transmitterStateChange */
+
+
 void RepeaterLogic::detectedTone(float fq)
 {
   if (fq >= 300.0f)
@@ -773,6 +814,17 @@ void RepeaterLogic::identNag(Timer *t)
 } /* RepeaterLogic::identNag */
 
 
+void RepeaterLogic::updateRptFastPath(bool sql_open)
+{
+    // The fast path is only used for local repeat. Audio from modules and
+    // linked logics must go through the TX audio selector as usual. The path
+    // is chosen when the squelch open so that a link becoming active in the
+    // middle of a transmission does not cause a switch.
+  rptFastPathSetActive(m_low_latency_repeat && repeater_is_up && sql_open &&
+                       (activeModule() == 0) && !logicConInIsActive());
+} /* RepeaterLogic::updateRptFastPath */
+
+
 
 /*
  * This file has not been truncated
@@ -166,7 +166,7 @@ class RepeaterLogic : public Logic
      * @brief 	Called when a valid selcall sequence has been detected
      * @param 	sequence The detected sequence
      */
-    virtual void selcallSequenceDetected(std::string sequence);
+    virtual void selcallSequenceDetected(const std::string& sequence);
 
 
   protected:
@@ -179,6 +179,7 @@ class RepeaterLogic : public Logic
     virtual void audioStreamStateChange(bool is_active, bool is_idle);
     virtual void dtmfCtrlPtyCmdReceived(const void *buf, size_t count);
     virtual void setReceivedTg(uint32_t tg) override;
+    virtual void transmitterStateChange(bool is_transmitting) override;
 
   private:
     typedef enum
@@ -211,6 +212,9 @@ class RepeaterLogic : public Logic
     uint32_t        delayed_tg_activation;
     Async::Timer    open_on_ctcss_timer;
     bool            m_dtmf_ignore_when_not_up {true};
+    bool            m_low_latency_repeat      {false};
+    bool            m_ptt_pending             {false};
+    SvxLink::MetricHistogram* m_metric_sql_to_ptt {nullptr};
 
     void idleTimeout(Async::Timer *t);
     void setIdle(bool idle);
@@ -221,6 +225,7 @@ class RepeaterLogic : public Logic
     void openOnSqlTimerExpired(Async::Timer *t);
     void activateOnOpenOrClose(SqlFlank flank);
     void identNag(Async::Timer *t);
+    void updateRptFastPath(bool sql_open);
 
 };  /* class RepeaterLogic */
 
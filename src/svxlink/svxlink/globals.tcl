@@ -270,12 +270,12 @@ proc findFirstFileOf {args} {
 #
 proc playMsg {context msg {warn 1}} {
   set filename [findFirstFileOf \
-      "$::langdir/local/$context/$msg.{wav,raw,gsm}" \
-      "$::basedir/sounds/local/$context/$msg.{wav,raw,gsm}" \
-      "$::langdir/$context/$msg.{wav,raw,gsm}" \
-      "$::langdir/local/Default/$msg.{wav,raw,gsm}" \
-      "$::basedir/sounds/local/Default/$msg.{wav,raw,gsm}" \
-      "$::langdir/Default/$msg.{wav,raw,gsm}" \
+      "$::langdir/local/$context/$msg.{wav,raw,gsm,opus}" \
+      "$::basedir/sounds/local/$context/$msg.{wav,raw,gsm,opus}" \
+      "$::langdir/$context/$msg.{wav,raw,gsm,opus}" \
+      "$::langdir/local/Default/$msg.{wav,raw,gsm,opus}" \
+      "$::basedir/sounds/local/Default/$msg.{wav,raw,gsm,opus}" \
+      "$::langdir/Default/$msg.{wav,raw,gsm,opus}" \
       ]
   if {$filename != ""} {
     playFile "$filename"
@@ -289,6 +289,28 @@ proc playMsg {context msg {warn 1}} {
 }
 
 
+#
+# Play a sequence of messages that is cached as one contiguous sound clip.
+# The first time the script is run, the messages are played as usual and are
+# then rendered into the sound clip cache. The next time, the cached
+# rendering is played and the script is not run at all. The key must include
+# everything that affect what the script play. It is prefixed by the logic
+# name since the cache is shared by all logics. If the sound clip cache is
+# disabled (SOUND_CLIP_CACHE_SIZE), the script is always run.
+#
+#   key     - A key that uniquely identify the sequence
+#   script  - The script that play the messages
+#
+proc playCached {key script} {
+  if {![beginSequence "${::logic_name}:$key"]} {
+    return
+  }
+  set ret [catch {uplevel 1 $script} result options]
+  endSequence [expr {$ret == 0}]
+  return -options $options $result
+}
+
+
 #
 # Recursively print the TCL namespace tree
 #
@@ -0,0 +1,1032 @@
+/**
+@file	 svxlink-bench.cpp
+@brief   An end-to-end audio latency and CPU benchmark for the SvxLink server
+@author  Tobias Blomberg / SM0SVX
+@date	 2026-10-15
+
+This program start the SvxLink server with a reference configuration where
+the receivers and the transmitter use UDP audio devices. Tone bursts are then
+sent to the receivers in real time and the time until each burst show up in
+the transmitter audio is measured. At the same time the CPU usage, page faults
+and context switches of the SvxLink process are read from the /proc
+filesystem. The result is printed as a JSON document, or a table, so that
+different configurations or versions of SvxLink can be compared.
+
+Run with something like:
+
+  svxlink-bench --scenario repeater --bursts 20 > result.json
+
+The following scenarios are available:
+
+  simplex   A simplex logic with the Parrot module. The module is activated
+            using DTMF and the time from the end of each burst to the start
+            of the playback is measured.
+  repeater  A repeater logic with a voter with two receivers. The time from
+            the start of each burst to the start of the repeated audio is
+            measured.
+  custom    A configuration file given using --config. The strings
+            @RX1_DEV@, @RX2_DEV@ and @TX_DEV@ in the file are replaced by
+            the audio devices that the benchmark use. The time from the
+            start of each burst to the start of the output audio is measured.
+            This is for example used for logics linked through a reflector
+            or through EchoLink where external servers are needed.
+
+\verbatim
+SvxLink - A Multi Purpose Voice Services System for Ham Radio Use
+Copyright (C) 2003-2026 Tobias Blomberg / SM0SVX
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+\endverbatim
+*/
+
+
+
+/****************************************************************************
+ *
+ * System Includes
+ *
+ ****************************************************************************/
+
+#include <sys/types.h>
+#include <dirent.h>
+#include <unistd.h>
+#include <limits.h>
+
+#include <cstdlib>
+#include <cstdint>
+#include <cstring>
+#include <cerrno>
+#include <cmath>
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <map>
+#include <chrono>
+#include <algorithm>
+
+
+/****************************************************************************
+ *
+ * Project Includes
+ *
+ ****************************************************************************/
+
+#include <AsyncCppApplication.h>
+#include <AsyncTimer.h>
+#include <AsyncUdpSocket.h>
+#include <AsyncIpAddress.h>
+#include <AsyncExec.h>
+
+
+/****************************************************************************
+ *
+ * Local Includes
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Namespaces to use
+ *
+ ****************************************************************************/
+
+using namespace std;
+using namespace Async;
+
+
+
+/****************************************************************************
+ *
+ * Defines & typedefs
+ *
+ ****************************************************************************/
+
+namespace {
+
+typedef map<string, map<string, string> > CfgSections;
+
+
+/****************************************************************************
+ *
+ * Local Global Variables
+ *
+ ****************************************************************************/
+
+  // The sample rate used for all audio to and from the SvxLink server
+const unsigned  SAMPLE_RATE = 16000;
+
+  // The number of samples sent to the receivers in each UDP packet (10ms)
+const unsigned  SEND_BLOCK = 160;
+
+  // The number of samples in each tone detection window (5ms)
+const unsigned  DET_WIN = 80;
+
+  // The frequency and amplitude of the tone bursts
+const float     TONE_FQ = 1100.0f;
+const float     TONE_AMP = 0.5f;
+
+  // The smallest amplitude that is detected as a tone in the transmitter
+  // audio
+const float     DET_MIN_AMP = 0.02f;
+
+  // The time to wait after the Parrot module has been activated before the
+  // first burst is sent
+const unsigned  MODULE_ACTIVATION_TIME = 3000;
+
+
+/****************************************************************************
+ *
+ * Local class definitions
+ *
+ ****************************************************************************/
+
+/**
+ * The audio sent to the receivers, built up from a number of segments where
+ * each one is silence, a tone or a DTMF digit. The samples are read out in
+ * order using the next function.
+ */
+class Stimulus
+{
+  public:
+    void add(uint64_t start, uint64_t len, float f1, float f2, float amp)
+    {
+      Segment seg = {start, len, f1, f2, amp};
+      segs.push_back(seg);
+    }
+
+    float next(void)
+    {
+      while ((seg_idx < segs.size()) &&
+             (pos >= segs[seg_idx].start + segs[seg_idx].len))
+      {
+        ++seg_idx;
+      }
+      float sample = 0.0f;
+      if ((seg_idx < segs.size()) && (pos >= segs[seg_idx].start))
+      {
+        const Segment& seg = segs[seg_idx];
+        const double t = static_cast<double>(pos) / SAMPLE_RATE;
+        sample = seg.amp * sin(2.0 * M_PI * seg.f1 * t);
+        if (seg.f2 > 0.0f)
+        {
+          sample += seg.amp * sin(2.0 * M_PI * seg.f2 * t);
+        }
+      }
+      ++pos;
+      return sample;
+    }
+
+  private:
+    struct Segment
+    {
+      uint64_t  start;
+      uint64_t  len;
+      float     f1;
+      float     f2;
+      float     amp;
+    };
+
+    vector<Segment> segs;
+    size_t          seg_idx = 0;
+    uint64_t        pos = 0;
+};
+
+
+/**
+ * One tone burst. The latency is measured from the time when the reference
+ * sample was sent to the time when the tone was detected in the transmitter
+ * audio.
+ */
+struct Burst
+{
+  uint64_t  ref_sample;
+  double    ref_time  = -1.0;
+  double    latency   = -1.0;
+};
+
+
+/**
+ * Resource usage for the SvxLink process and its threads
+ */
+struct ProcStats
+{
+  double              cpu         = 0.0;
+  uint64_t            minflt      = 0;
+  uint64_t            majflt      = 0;
+  uint64_t            vol_csw     = 0;
+  uint64_t            invol_csw   = 0;
+  uint64_t            hwm_kb      = 0;
+  map<string, double> thread_cpu;
+};
+
+
+class Bench : public sigc::trackable
+{
+  public:
+    string      scenario      = "repeater";
+    string      cfg_file;
+    string      svxlink_bin;
+    string      workdir;
+    string      format        = "json";
+    CfgSections overrides;
+    unsigned    bursts        = 10;
+    unsigned    interval      = 5000;
+    unsigned    tone_len      = 1000;
+    unsigned    warmup        = 5;
+    unsigned    port_base     = 45100;
+    int         exit_code     = 0;
+
+    ~Bench(void)
+    {
+      delete send_timer;
+      delete rx_sock;
+      delete tx_sock;
+      delete svxlink;
+    }
+
+    bool start(void);
+
+  private:
+    Stimulus            stimulus;
+    vector<Burst>       burst_list;
+    size_t              next_ref        = 0;
+    int                 pending         = -1;
+    uint64_t            sent            = 0;
+    uint64_t            measure_start   = 0;
+    uint64_t            end_sample      = 0;
+    bool                use_voter       = false;
+    bool                remove_workdir  = false;
+    bool                finished        = false;
+    chrono::steady_clock::time_point  t0;
+    double              measure_t0      = 0.0;
+    double              measure_t1      = 0.0;
+    ProcStats           stats0;
+    ProcStats           stats1;
+    float               det_buf[DET_WIN];
+    unsigned            det_len         = 0;
+    Timer*              send_timer      = nullptr;
+    UdpSocket*          rx_sock         = nullptr;
+    UdpSocket*          tx_sock         = nullptr;
+    Exec*               svxlink         = nullptr;
+    IpAddress           localhost       = IpAddress("127.0.0.1");
+
+    double elapsed(void) const
+    {
+      return chrono::duration<double>(
+          chrono::steady_clock::now() - t0).count();
+    }
+
+    string udpDev(unsigned port) const
+    {
+      return "udp:127.0.0.1:" + to_string(port);
+    }
+
+    bool writeConfig(const string& path);
+    void buildSchedule(void);
+    void sendAudio(Timer*);
+    void txAudioReceived(const IpAddress& ip, uint16_t port,
+                         void* buf, int count);
+    void checkTone(double t);
+    void finish(void);
+    void svxlinkExited(void);
+    void printReport(void);
+    void cleanup(void);
+};
+
+
+/****************************************************************************
+ *
+ * Prototypes
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Local functions
+ *
+ ****************************************************************************/
+
+bool readTaskStat(const string& dir, double& cpu, uint64_t& minflt,
+                  uint64_t& majflt)
+{
+  ifstream is(dir + "/stat");
+  string line;
+  if (!getline(is, line))
+  {
+    return false;
+  }
+    // The command name may contain spaces so start after its end parenthesis
+  const size_t pos = line.rfind(')');
+  if (pos == string::npos)
+  {
+    return false;
+  }
+  istringstream ss(line.substr(pos + 1));
+  string state;
+  long skip;
+  uint64_t cminflt, cmajflt, utime, stime;
+  ss >> state >> skip >> skip >> skip >> skip >> skip >> skip
+     >> minflt >> cminflt >> majflt >> cmajflt >> utime >> stime;
+  if (!ss)
+  {
+    return false;
+  }
+  cpu = static_cast<double>(utime + stime) / sysconf(_SC_CLK_TCK);
+  return true;
+} /* readTaskStat */
+
+
+void readTaskStatus(const string& dir, ProcStats& stats)
+{
+  ifstream is(dir + "/status");
+  string line;
+  while (getline(is, line))
+  {
+    istringstream ss(line);
+    string tag;
+    uint64_t value = 0;
+    ss >> tag >> value;
+    if (tag == "voluntary_ctxt_switches:")
+    {
+      stats.vol_csw += value;
+    }
+    else if (tag == "nonvoluntary_ctxt_switches:")
+    {
+      stats.invol_csw += value;
+    }
+    else if (tag == "VmHWM:")
+    {
+      stats.hwm_kb = max(stats.hwm_kb, value);
+    }
+  }
+} /* readTaskStatus */
+
+
+ProcStats readProcStats(pid_t pid)
+{
+  ProcStats stats;
+  const string proc_dir("/proc/" + to_string(pid));
+  readTaskStat(proc_dir, stats.cpu, stats.minflt, stats.majflt);
+  readTaskStatus(proc_dir, stats);
+
+    // The context switches are only counted per thread so they are summed
+    // up over all threads. The CPU time is summed up per thread name so that
+    // the threads in a worker pool show up as one entry.
+  stats.vol_csw = 0;
+  stats.invol_csw = 0;
+  const string task_dir(proc_dir + "/task");
+  DIR* dir = opendir(task_dir.c_str());
+  if (dir == nullptr)
+  {
+    return stats;
+  }
+  struct dirent* ent;
+  while ((ent = readdir(dir)) != nullptr)
+  {
+    if (ent->d_name[0] == '.')
+    {
+      continue;
+    }
+    const string tdir(task_dir + "/" + ent->d_name);
+    double cpu = 0.0;
+    uint64_t minflt, majflt;
+    if (!readTaskStat(tdir, cpu, minflt, majflt))
+    {
+      continue;
+    }
+    string name;
+    ifstream comm(tdir + "/comm");
+    getline(comm, name);
+    stats.thread_cpu[name] += cpu;
+    readTaskStatus(tdir, stats);
+  }
+  closedir(dir);
+  return stats;
+} /* readProcStats */
+
+
+bool parseOverride(const string& arg, CfgSections& overrides)
+{
+  const size_t slash = arg.find('/');
+  const size_t eq = arg.find('=');
+  if ((slash == string::npos) || (eq == string::npos) || (eq < slash) ||
+      (slash == 0) || (eq == slash + 1))
+  {
+    return false;
+  }
+  overrides[arg.substr(0, slash)][arg.substr(slash + 1, eq - slash - 1)] =
+    arg.substr(eq + 1);
+  return true;
+} /* parseOverride */
+
+
+string defaultSvxlinkBin(void)
+{
+    // The svxlink binary is built into the same directory as this program
+  char buf[PATH_MAX];
+  ssize_t len = readlink("/proc/self/exe", buf, sizeof(buf) - 1);
+  if (len <= 0)
+  {
+    return "svxlink";
+  }
+  buf[len] = '\0';
+  string path(buf);
+  return path.substr(0, path.rfind('/') + 1) + "svxlink";
+} /* defaultSvxlinkBin */
+
+
+void usage(const char *prog)
+{
+  cerr << "Usage: " << prog << " [--scenario simplex|repeater|custom] "
+          "[--config <file>]\n"
+          "       [--svxlink <path>] [--set <SECTION/TAG=value>] "
+          "[--bursts <count>]\n"
+          "       [--interval <ms>] [--tone-len <ms>] [--warmup <seconds>]\n"
+          "       [--port-base <port>] [--workdir <dir>] "
+          "[--format table|json]\n";
+} /* usage */
+
+
+/****************************************************************************
+ *
+ * Bench member functions
+ *
+ ****************************************************************************/
+
+bool Bench::start(void)
+{
+  if (svxlink_bin.empty())
+  {
+    svxlink_bin = defaultSvxlinkBin();
+  }
+  if (workdir.empty())
+  {
+    char tmpl[] = "/tmp/svxlink-bench-XXXXXX";
+    if (mkdtemp(tmpl) == nullptr)
+    {
+      cerr << "*** ERROR: Could not create a temporary directory: "
+           << strerror(errno) << endl;
+      return false;
+    }
+    workdir = tmpl;
+    remove_workdir = true;
+  }
+  const string cfg_path(workdir + "/svxlink.conf");
+  if (!writeConfig(cfg_path))
+  {
+    return false;
+  }
+
+  tx_sock = new UdpSocket(port_base + 2, localhost);
+  if (!tx_sock->initOk())
+  {
+    cerr << "*** ERROR: Could not bind to UDP port " << (port_base + 2)
+         << endl;
+    return false;
+  }
+  tx_sock->dataReceived.connect(mem_fun(*this, &Bench::txAudioReceived));
+  rx_sock = new UdpSocket;
+  if (!rx_sock->initOk())
+  {
+    cerr << "*** ERROR: Could not create the UDP socket for receiver audio\n";
+    return false;
+  }
+
+  buildSchedule();
+
+  svxlink = new Exec(svxlink_bin);
+  svxlink->appendArgument("--config=" + cfg_path);
+  svxlink->appendArgument("--logfile=" + workdir + "/svxlink.log");
+  svxlink->exited.connect(mem_fun(*this, &Bench::svxlinkExited));
+  if (!svxlink->run())
+  {
+    cerr << "*** ERROR: Could not start " << svxlink_bin << endl;
+    return false;
+  }
+
+    // Silence is sent from the start, just like a sound card would do
+  t0 = chrono::steady_clock::now();
+  send_timer = new Timer(SEND_BLOCK * 1000 / SAMPLE_RATE,
+                         Timer::TYPE_PERIODIC);
+  send_timer->expired.connect(mem_fun(*this, &Bench::sendAudio));
+
+  return true;
+} /* Bench::start */
+
+
+bool Bench::writeConfig(const string& path)
+{
+  string cfg_text;
+  if (scenario == "custom")
+  {
+    ifstream is(cfg_file);
+    if (!is)
+    {
+      cerr << "*** ERROR: Could not open configuration file \"" << cfg_file
+           << "\"\n";
+      return false;
+    }
+    stringstream ss;
+    ss << is.rdbuf();
+    cfg_text = ss.str();
+    const pair<string, string> subst[] = {
+      {"@RX1_DEV@", udpDev(port_base)},
+      {"@RX2_DEV@", udpDev(port_base + 1)},
+      {"@TX_DEV@", udpDev(port_base + 2)}
+    };
+    for (const auto& s : subst)
+    {
+      size_t pos;
+      while ((pos = cfg_text.find(s.first)) != string::npos)
+      {
+        cfg_text.replace(pos, s.first.size(), s.second);
+      }
+    }
+    use_voter = (ss.str().find("@RX2_DEV@") != string::npos);
+  }
+  else
+  {
+    CfgSections cfg;
+    cfg["GLOBAL"]["CARD_SAMPLE_RATE"] = to_string(SAMPLE_RATE);
+    cfg["GLOBAL"]["CARD_CHANNELS"] = "1";
+    cfg["GLOBAL"]["TIMESTAMP_FORMAT"] = "\"%c\"";
+
+    const string rx_names[] = {"Rx1", "Rx2"};
+    for (unsigned i=0; i<2; ++i)
+    {
+      auto& rx = cfg[rx_names[i]];
+      rx["TYPE"] = "Local";
+      rx["AUDIO_DEV"] = udpDev(port_base + i);
+      rx["AUDIO_CHANNEL"] = "0";
+      rx["SQL_DET"] = "VOX";
+      rx["SQL_START_DELAY"] = "0";
+      rx["SQL_DELAY"] = "0";
+      rx["SQL_HANGTIME"] = "100";
+      rx["VOX_FILTER_DEPTH"] = "20";
+      rx["VOX_THRESH"] = "1000";
+      rx["DTMF_DEC_TYPE"] = "INTERNAL";
+      rx["DEEMPHASIS"] = "0";
+    }
+
+    auto& tx = cfg["Tx1"];
+    tx["TYPE"] = "Local";
+    tx["AUDIO_DEV"] = udpDev(port_base + 2);
+    tx["AUDIO_CHANNEL"] = "0";
+    tx["PTT_TYPE"] = "NONE";
+    tx["TX_DELAY"] = "0";
+    tx["PREEMPHASIS"] = "0";
+
+    if (scenario == "simplex")
+    {
+      cfg["GLOBAL"]["LOGICS"] = "SimplexLogic";
+      auto& logic = cfg["SimplexLogic"];
+      logic["TYPE"] = "Simplex";
+      logic["RX"] = "Rx1";
+      logic["TX"] = "Tx1";
+      logic["MODULES"] = "ModuleParrot";
+      logic["CALLSIGN"] = "BENCH";
+      auto& parrot = cfg["ModuleParrot"];
+      parrot["NAME"] = "Parrot";
+      parrot["ID"] = "1";
+      parrot["TIMEOUT"] = "600";
+      parrot["FIFO_LEN"] = "60";
+      parrot["REPEAT_DELAY"] = "0";
+      cfg.erase("Rx2");
+    }
+    else
+    {
+      cfg["GLOBAL"]["LOGICS"] = "RepeaterLogic";
+      auto& logic = cfg["RepeaterLogic"];
+      logic["TYPE"] = "Repeater";
+      logic["RX"] = "Voter";
+      logic["TX"] = "Tx1";
+      logic["CALLSIGN"] = "BENCH";
+      logic["OPEN_ON_SQL"] = "100";
+      logic["OPEN_SQL_FLANK"] = "OPEN";
+      logic["IDLE_TIMEOUT"] = "600";
+      auto& voter = cfg["Voter"];
+      voter["TYPE"] = "Voter";
+      voter["RECEIVERS"] = "Rx1,Rx2";
+      voter["VOTING_DELAY"] = "100";
+      voter["BUFFER_LENGTH"] = "0";
+      use_voter = true;
+    }
+
+    for (const auto& sec : overrides)
+    {
+      for (const auto& var : sec.second)
+      {
+        cfg[sec.first][var.first] = var.second;
+      }
+    }
+
+    ostringstream ss;
+    ss << "[GLOBAL]\n";
+    for (const auto& var : cfg["GLOBAL"])
+    {
+      ss << var.first << "=" << var.second << "\n";
+    }
+    for (const auto& sec : cfg)
+    {
+      if (sec.first == "GLOBAL")
+      {
+        continue;
+      }
+      ss << "\n[" << sec.first << "]\n";
+      for (const auto& var : sec.second)
+      {
+        ss << var.first << "=" << var.second << "\n";
+      }
+    }
+    cfg_text = ss.str();
+  }
+
+  ofstream os(path);
+  os << cfg_text;
+  if (!os)
+  {
+    cerr << "*** ERROR: Could not write configuration file \"" << path
+         << "\"\n";
+    return false;
+  }
+  return true;
+} /* Bench::writeConfig */
+
+
+void Bench::buildSchedule(void)
+{
+  const uint64_t ms = SAMPLE_RATE / 1000;
+  uint64_t pos = warmup * 1000 * ms;
+  if (scenario == "simplex")
+  {
+      // Activate the Parrot module by sending the DTMF command "1#"
+    const float dtmf_fq[][2] = {{697.0f, 1209.0f}, {941.0f, 1477.0f}};
+    for (const auto& fq : dtmf_fq)
+    {
+      stimulus.add(pos, 100 * ms, fq[0], fq[1], TONE_AMP / 2);
+      pos += 200 * ms;
+    }
+    pos += MODULE_ACTIVATION_TIME * ms;
+  }
+  measure_start = pos;
+  for (unsigned i=0; i<bursts; ++i)
+  {
+    stimulus.add(pos, tone_len * ms, TONE_FQ, 0.0f, TONE_AMP);
+    Burst burst;
+      // For the Parrot module the reaction to the squelch close is measured
+    burst.ref_sample = (scenario == "simplex") ? pos + tone_len * ms : pos;
+    burst_list.push_back(burst);
+    pos += interval * ms;
+  }
+  end_sample = pos;
+} /* Bench::buildSchedule */
+
+
+void Bench::sendAudio(Timer*)
+{
+  const double now = elapsed();
+  const uint64_t due = static_cast<uint64_t>(now * SAMPLE_RATE);
+  while (sent + SEND_BLOCK <= due)
+  {
+    if ((sent <= measure_start) && (measure_start < sent + SEND_BLOCK))
+    {
+      stats0 = readProcStats(svxlink->processId());
+      measure_t0 = now;
+    }
+    int16_t buf[SEND_BLOCK];
+    int16_t buf2[SEND_BLOCK];
+    for (unsigned i=0; i<SEND_BLOCK; ++i)
+    {
+      const float sample = stimulus.next();
+      buf[i] = static_cast<int16_t>(32767.0f * sample);
+        // The second receiver get a weaker signal so that the voter have
+        // something to choose between
+      buf2[i] = buf[i] / 2;
+    }
+    while ((next_ref < burst_list.size()) &&
+           (burst_list[next_ref].ref_sample < sent + SEND_BLOCK))
+    {
+      burst_list[next_ref].ref_time = now;
+      pending = next_ref++;
+    }
+    rx_sock->write(localhost, port_base, buf, sizeof(buf));
+    if (use_voter)
+    {
+      rx_sock->write(localhost, port_base + 1, buf2, sizeof(buf2));
+    }
+    sent += SEND_BLOCK;
+  }
+
+  if (sent >= end_sample)
+  {
+    finish();
+  }
+} /* Bench::sendAudio */
+
+
+void Bench::txAudioReceived(const IpAddress&, uint16_t, void* buf, int count)
+{
+  const double now = elapsed();
+  const int16_t* samples = static_cast<const int16_t*>(buf);
+  const int sample_cnt = count / sizeof(int16_t);
+  for (int i=0; i<sample_cnt; ++i)
+  {
+    det_buf[det_len++] = samples[i] / 32768.0f;
+    if (det_len == DET_WIN)
+    {
+        // The samples in a packet are sent paced by the audio device so the
+        // detection time is adjusted by the position in the packet
+      checkTone(now + static_cast<double>(i + 1 - DET_WIN) / SAMPLE_RATE);
+      det_len = 0;
+    }
+  }
+} /* Bench::txAudioReceived */
+
+
+void Bench::checkTone(double t)
+{
+  if (pending < 0)
+  {
+    return;
+  }
+
+    // Goertzel detector for the burst frequency
+  const float coeff = 2.0f * cos(2.0 * M_PI * TONE_FQ / SAMPLE_RATE);
+  float s1 = 0.0f;
+  float s2 = 0.0f;
+  float energy = 0.0f;
+  for (unsigned i=0; i<DET_WIN; ++i)
+  {
+    const float s0 = det_buf[i] + coeff * s1 - s2;
+    s2 = s1;
+    s1 = s0;
+    energy += det_buf[i] * det_buf[i];
+  }
+  const float power = s1 * s1 + s2 * s2 - coeff * s1 * s2;
+  const float amp = 2.0f * sqrt(max(power, 0.0f)) / DET_WIN;
+
+    // The tone must dominate the window so that announcements and other
+    // tones are not detected
+  if ((amp > DET_MIN_AMP) && (amp * amp / 2 > 0.5f * energy / DET_WIN))
+  {
+    Burst& burst = burst_list[pending];
+    burst.latency = max(0.0, t - burst.ref_time);
+    pending = -1;
+  }
+} /* Bench::checkTone */
+
+
+void Bench::finish(void)
+{
+  if (finished)
+  {
+    return;
+  }
+  finished = true;
+  send_timer->setEnable(false);
+  measure_t1 = elapsed();
+  stats1 = readProcStats(svxlink->processId());
+  svxlink->kill();
+} /* Bench::finish */
+
+
+void Bench::svxlinkExited(void)
+{
+  if (!finished)
+  {
+    cerr << "*** ERROR: " << svxlink_bin << " exited prematurely";
+    if (!remove_workdir)
+    {
+      cerr << ". See " << workdir << "/svxlink.log";
+    }
+    cerr << endl;
+    remove_workdir = false;
+    exit_code = 1;
+  }
+  else
+  {
+    printReport();
+  }
+  cleanup();
+  Application::app().quit();
+} /* Bench::svxlinkExited */
+
+
+void Bench::printReport(void)
+{
+  vector<double> lat;
+  for (const auto& burst : burst_list)
+  {
+    if (burst.latency >= 0.0)
+    {
+      lat.push_back(1000.0 * burst.latency);
+    }
+  }
+  sort(lat.begin(), lat.end());
+  double mean = 0.0;
+  for (double l : lat)
+  {
+    mean += l;
+  }
+  auto percentile = [&](double p)
+    {
+      return lat.empty() ? 0.0 : lat[static_cast<size_t>(p * (lat.size() - 1))];
+    };
+  if (!lat.empty())
+  {
+    mean /= lat.size();
+  }
+
+  const double wall = measure_t1 - measure_t0;
+  const double cpu = stats1.cpu - stats0.cpu;
+  const double minflt = stats1.minflt - stats0.minflt;
+  const double vol_csw = stats1.vol_csw - stats0.vol_csw;
+  const double invol_csw = stats1.invol_csw - stats0.invol_csw;
+
+  if (format == "json")
+  {
+    cout << "{\n"
+         << "  \"scenario\": \"" << scenario << "\",\n"
+         << "  \"bursts\": " << burst_list.size() << ",\n"
+         << "  \"detected\": " << lat.size() << ",\n"
+         << "  \"latencyMs\": {\n"
+         << "    \"min\": " << percentile(0.0) << ",\n"
+         << "    \"mean\": " << mean << ",\n"
+         << "    \"p50\": " << percentile(0.5) << ",\n"
+         << "    \"p95\": " << percentile(0.95) << ",\n"
+         << "    \"max\": " << percentile(1.0) << "\n"
+         << "  },\n"
+         << "  \"wallSeconds\": " << wall << ",\n"
+         << "  \"cpuSeconds\": " << cpu << ",\n"
+         << "  \"cpuLoad\": " << (cpu / wall) << ",\n"
+         << "  \"threadCpuSeconds\": {";
+    const char* sep = "\n";
+    for (const auto& thread : stats1.thread_cpu)
+    {
+      auto it = stats0.thread_cpu.find(thread.first);
+      const double start = (it != stats0.thread_cpu.end()) ? it->second : 0.0;
+      cout << sep << "    \"" << thread.first << "\": "
+           << (thread.second - start);
+      sep = ",\n";
+    }
+    cout << "\n  },\n"
+         << "  \"minorFaultsPerSecond\": " << (minflt / wall) << ",\n"
+         << "  \"peakRssKb\": " << stats1.hwm_kb << ",\n"
+         << "  \"wakeupsPerSecond\": " << (vol_csw / wall) << ",\n"
+         << "  \"preemptionsPerSecond\": " << (invol_csw / wall) << "\n"
+         << "}\n";
+  }
+  else
+  {
+    cout << fixed << setprecision(2)
+         << "Scenario            : " << scenario << "\n"
+         << "Bursts detected     : " << lat.size() << " of "
+         << burst_list.size() << "\n"
+         << "Latency min/mean/max: " << percentile(0.0) << " / " << mean
+         << " / " << percentile(1.0) << " ms\n"
+         << "Latency p50/p95     : " << percentile(0.5) << " / "
+         << percentile(0.95) << " ms\n"
+         << "Wall time           : " << wall << " s\n"
+         << "CPU load            : " << (100.0 * cpu / wall)
+         << "% of one core\n";
+    for (const auto& thread : stats1.thread_cpu)
+    {
+      auto it = stats0.thread_cpu.find(thread.first);
+      const double start = (it != stats0.thread_cpu.end()) ? it->second : 0.0;
+      cout << "  " << left << setw(18) << thread.first << ": "
+           << (100.0 * (thread.second - start) / wall) << "%\n" << right;
+    }
+    cout << "Minor page faults   : " << (minflt / wall) << " /s\n"
+         << "Peak RSS            : " << stats1.hwm_kb << " kB\n"
+         << "Wakeups             : " << (vol_csw / wall) << " /s\n"
+         << "Preemptions         : " << (invol_csw / wall) << " /s\n";
+  }
+} /* Bench::printReport */
+
+
+void Bench::cleanup(void)
+{
+  if (!remove_workdir)
+  {
+    return;
+  }
+  unlink((workdir + "/svxlink.conf").c_str());
+  unlink((workdir + "/svxlink.log").c_str());
+  rmdir(workdir.c_str());
+} /* Bench::cleanup */
+
+}; /* anonymous namespace */
+
+
+/****************************************************************************
+ *
+ * MAIN
+ *
+ ****************************************************************************/
+
+int main(int argc, const char **argv)
+{
+  Bench bench;
+  for (int i=1; i<argc; ++i)
+  {
+    string arg(argv[i]);
+    if ((arg == "--scenario") && (i+1 < argc))
+    {
+      bench.scenario = argv[++i];
+    }
+    else if ((arg == "--config") && (i+1 < argc))
+    {
+      bench.cfg_file = argv[++i];
+    }
+    else if ((arg == "--svxlink") && (i+1 < argc))
+    {
+      bench.svxlink_bin = argv[++i];
+    }
+    else if ((arg == "--set") && (i+1 < argc))
+    {
+      if (!parseOverride(argv[++i], bench.overrides))
+      {
+        usage(argv[0]);
+        return 1;
+      }
+    }
+    else if ((arg == "--bursts") && (i+1 < argc))
+    {
+      bench.bursts = atoi(argv[++i]);
+    }
+    else if ((arg == "--interval") && (i+1 < argc))
+    {
+      bench.interval = atoi(argv[++i]);
+    }
+    else if ((arg == "--tone-len") && (i+1 < argc))
+    {
+      bench.tone_len = atoi(argv[++i]);
+    }
+    else if ((arg == "--warmup") && (i+1 < argc))
+    {
+      bench.warmup = atoi(argv[++i]);
+    }
+    else if ((arg == "--port-base") && (i+1 < argc))
+    {
+      bench.port_base = atoi(argv[++i]);
+    }
+    else if ((arg == "--workdir") && (i+1 < argc))
+    {
+      bench.workdir = argv[++i];
+    }
+    else if ((arg == "--format") && (i+1 < argc))
+    {
+      bench.format = argv[++i];
+    }
+    else
+    {
+      usage(argv[0]);
+      return 1;
+    }
+  }
+  if (((bench.scenario != "simplex") && (bench.scenario != "repeater") &&
+       (bench.scenario != "custom")) ||
+      ((bench.scenario == "custom") == bench.cfg_file.empty()) ||
+      (bench.bursts == 0) || (bench.tone_len == 0) ||
+      (bench.interval <= bench.tone_len) || (bench.port_base == 0) ||
+      (bench.port_base > 65533) ||
+      ((bench.format != "table") && (bench.format != "json")))
+  {
+    usage(argv[0]);
+    return 1;
+  }
+
+  CppApplication app;
+  if (!bench.start())
+  {
+    return 1;
+  }
+  app.exec();
+
+  return bench.exit_code;
+} /* main */
+
+
+
+/*
+ * This file has not been truncated
+ */
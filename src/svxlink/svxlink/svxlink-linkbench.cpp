@@ -0,0 +1,327 @@
+/**
+@file	 svxlink-linkbench.cpp
+@brief   A micro benchmark for the link manager
+@author  Tobias Blomberg / SM0SVX
+@date	 2026-10-15
+
+This program measure how long it take for the link manager to activate the
+logic links when a logic go active. A number of logics, which do nothing but
+pass audio through, are connected by a number of randomly chosen links. Some
+of the links are active by default and the rest are activated on activity
+from their first logic. Each round every such logic is set active and then
+idle again, one at a time, and the time for the link manager to handle each
+activation is measured. The links are then left to time out before the next
+round start. The time for a call to LinkManager::currentTalkerFor is also
+measured.
+
+Run with something like:
+
+  svxlink-linkbench [logics] [links] [rounds]
+
+\verbatim
+SvxLink - A Multi Purpose Voice Services System for Ham Radio Use
+Copyright (C) 2003-2026 Tobias Blomberg / SM0SVX
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+\endverbatim
+*/
+
+
+
+/****************************************************************************
+ *
+ * System Includes
+ *
+ ****************************************************************************/
+
+#include <cstdlib>
+#include <iostream>
+#include <iomanip>
+#include <sstream>
+#include <chrono>
+#include <random>
+#include <algorithm>
+#include <vector>
+#include <set>
+
+
+/****************************************************************************
+ *
+ * Project Includes
+ *
+ ****************************************************************************/
+
+#include <AsyncCppApplication.h>
+#include <AsyncConfig.h>
+#include <AsyncTimer.h>
+#include <AsyncAudioPassthrough.h>
+
+
+/****************************************************************************
+ *
+ * Local Includes
+ *
+ ****************************************************************************/
+
+#include "LogicBase.h"
+#include "LinkManager.h"
+
+
+/****************************************************************************
+ *
+ * Namespaces to use
+ *
+ ****************************************************************************/
+
+using namespace std;
+using namespace Async;
+
+
+/****************************************************************************
+ *
+ * Defines & typedefs
+ *
+ ****************************************************************************/
+
+typedef std::chrono::steady_clock Clock;
+
+
+/****************************************************************************
+ *
+ * Local class definitions
+ *
+ ****************************************************************************/
+
+  /*
+   * A logic core that only pass the audio through and which is set active
+   * or idle by the benchmark
+   */
+class BenchLogic : public LogicBase
+{
+  public:
+    virtual ~BenchLogic(void) override {}
+    virtual AudioSink *logicConIn(void) override { return &m_con_in; }
+    virtual AudioSource *logicConOut(void) override { return &m_con_out; }
+    void setActive(bool active) { setIdle(!active); }
+
+  private:
+    AudioPassthrough m_con_in;
+    AudioPassthrough m_con_out;
+};
+
+
+/****************************************************************************
+ *
+ * Local Global Variables
+ *
+ ****************************************************************************/
+
+static const unsigned LINK_TIMEOUT = 1;
+
+static vector<BenchLogic*>  logics;
+static vector<BenchLogic*>  activators;
+static vector<double>       latencies;
+static unsigned             rounds = 10;
+static unsigned             round_no = 0;
+
+
+/****************************************************************************
+ *
+ * Local functions
+ *
+ ****************************************************************************/
+
+static string logicName(unsigned idx)
+{
+  ostringstream ss;
+  ss << "Logic" << idx;
+  return ss.str();
+} /* logicName */
+
+
+  /*
+   * Set each activating logic active and idle again. The links activated
+   * will time out before the next round is run.
+   */
+static void runRound(Timer *t)
+{
+  if (round_no++ == rounds)
+  {
+    Application::app().quit();
+    return;
+  }
+
+  for (auto& logic : activators)
+  {
+    Clock::time_point start = Clock::now();
+    logic->setActive(true);
+    latencies.push_back(
+        chrono::duration<double, micro>(Clock::now() - start).count());
+    logic->setActive(false);
+  }
+  t->reset();
+} /* runRound */
+
+
+static double percentile(const vector<double>& sorted, double p)
+{
+  size_t idx = static_cast<size_t>(p * (sorted.size() - 1) + 0.5);
+  return sorted[idx];
+} /* percentile */
+
+
+/****************************************************************************
+ *
+ * MAIN
+ *
+ ****************************************************************************/
+
+int main(int argc, const char **argv)
+{
+  unsigned logic_cnt = 20;
+  unsigned link_cnt = 40;
+  if (argc > 1)
+  {
+    logic_cnt = atoi(argv[1]);
+  }
+  if (argc > 2)
+  {
+    link_cnt = atoi(argv[2]);
+  }
+  if (argc > 3)
+  {
+    rounds = atoi(argv[3]);
+  }
+  if ((logic_cnt < 2) || (link_cnt == 0) || (rounds == 0))
+  {
+    cerr << "Usage: svxlink-linkbench [logics] [links] [rounds]" << endl;
+    return 1;
+  }
+
+  CppApplication app;
+
+    // Every fourth link is active by default. The others connect two to four
+    // logics and are activated on activity from the first one.
+  Config cfg;
+  mt19937 rng(1);
+  uniform_int_distribution<unsigned> logic_dist(0, logic_cnt-1);
+  uniform_int_distribution<unsigned> size_dist(2, min(4U, logic_cnt));
+  set<unsigned> activator_idx;
+  string link_names;
+  for (unsigned i=0; i<link_cnt; ++i)
+  {
+    ostringstream name;
+    name << "Link" << i;
+    vector<unsigned> members;
+    const unsigned size = size_dist(rng);
+    while (members.size() < size)
+    {
+      unsigned idx = logic_dist(rng);
+      if (find(members.begin(), members.end(), idx) == members.end())
+      {
+        members.push_back(idx);
+      }
+    }
+    string connect_logics;
+    for (unsigned idx : members)
+    {
+      connect_logics += (connect_logics.empty() ? "" : ",") + logicName(idx);
+    }
+    cfg.setValue(name.str(), "CONNECT_LOGICS", connect_logics);
+    cfg.setValue(name.str(), "TIMEOUT", LINK_TIMEOUT);
+    if (i % 4 == 0)
+    {
+      cfg.setValue(name.str(), "DEFAULT_ACTIVE", 1);
+    }
+    else
+    {
+      cfg.setValue(name.str(), "ACTIVATE_ON_ACTIVITY",
+                   logicName(members.front()));
+      activator_idx.insert(members.front());
+    }
+    link_names += (link_names.empty() ? "" : ",") + name.str();
+  }
+
+    // The link manager print each link activation so standard output is
+    // turned off while the benchmark is running
+  cout.setstate(ios::badbit);
+  if (!LinkManager::initialize(cfg, link_names))
+  {
+    cout.clear();
+    cerr << "*** ERROR: Could not initialize the link manager" << endl;
+    return 1;
+  }
+  for (unsigned i=0; i<logic_cnt; ++i)
+  {
+    cfg.setValue(logicName(i), "TYPE", "Bench");
+    BenchLogic *logic = new BenchLogic;
+    if (!logic->initialize(cfg, logicName(i)))
+    {
+      cout.clear();
+      cerr << "*** ERROR: Could not initialize logic " << logicName(i)
+           << endl;
+      return 1;
+    }
+    logics.push_back(logic);
+  }
+  for (unsigned idx : activator_idx)
+  {
+    activators.push_back(logics[idx]);
+  }
+  LinkManager::instance()->allLogicsStarted();
+
+  Timer round_timer(1000 * LINK_TIMEOUT + 500);
+  round_timer.expired.connect(sigc::ptr_fun(&runRound));
+  runRound(&round_timer);
+  app.exec();
+
+  const unsigned talker_calls = 100000;
+  Clock::time_point start = Clock::now();
+  size_t talkers = 0;
+  for (unsigned i=0; i<talker_calls; ++i)
+  {
+    talkers += (LinkManager::instance()->currentTalkerFor(
+                  logics[i % logic_cnt]->name()) != nullptr) ? 1 : 0;
+  }
+  const double talker_time =
+    chrono::duration<double, nano>(Clock::now() - start).count();
+  cout.clear();
+
+  sort(latencies.begin(), latencies.end());
+  cout << logic_cnt << " logics, " << link_cnt << " links, "
+       << activators.size() << " activating logics, " << rounds
+       << " rounds\n\n";
+  cout << fixed << setprecision(1)
+       << "Activation latency (us): min " << latencies.front()
+       << "  median " << percentile(latencies, 0.5)
+       << "  p99 " << percentile(latencies, 0.99)
+       << "  max " << latencies.back() << endl;
+  cout << "currentTalkerFor (ns/call): " << (talker_time / talker_calls)
+       << " (" << talkers << " talkers)" << endl;
+
+  LinkManager::deleteInstance();
+  for (auto& logic : logics)
+  {
+    delete logic;
+  }
+
+  return 0;
+} /* main */
+
+
+
+/*
+ * This file has not been truncated
+ */
@@ -6,7 +6,7 @@
 
 \verbatim
 SvxLink - A Multi Purpose Voice Services System for Ham Radio Use
-Copyright (C) 2003-2025 Tobias Blomberg / SM0SVX
+Copyright (C) 2003-2026 Tobias Blomberg / SM0SVX
 
 This program is free software; you can redistribute it and/or modify
 it under the terms of the GNU General Public License as published by
@@ -40,11 +40,17 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 #include <dirent.h>
 #include <pwd.h>
 #include <grp.h>
+#include <sched.h>
 
 #include <string>
 #include <iostream>
+#include <iomanip>
 #include <algorithm>
 #include <vector>
+#include <sstream>
+#include <map>
+#include <set>
+#include <chrono>
 
 
 /****************************************************************************
@@ -58,10 +64,14 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 #include <AsyncTimer.h>
 #include <AsyncFdWatch.h>
 #include <AsyncAudioIO.h>
+#include <AsyncTcpServer.h>
+#include <AsyncHttpServerConnection.h>
+#include <AsyncThreadSched.h>
 #include <LocationInfo.h>
 #include <common.h>
 #include <config.h>
 #include <LogWriter.h>
+#include <Metrics.h>
 
 
 /****************************************************************************
@@ -73,6 +83,8 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 #include "version/SVXLINK.h"
 #include "Logic.h"
 #include "LinkManager.h"
+#include "MsgHandler.h"
+#include "NodeStatus.h"
 
 
 /****************************************************************************
@@ -112,9 +124,19 @@ using namespace sigc;
 static void parse_arguments(int argc, const char **argv);
 static void stdinHandler(FdWatch *w);
 static void initialize_logics(Config &cfg);
+static void initialize_thread_sched(Config &cfg);
+static bool read_cfg_dir(Config &cfg, const std::string& main_filename);
+static void reload_config(void);
+static void startup_phase_done(const std::string& phase);
 static void sighup_handler(int signal);
+static void sigusr1_handler(int signal);
 static void sigterm_handler(int signal);
 static void handle_unix_signal(int signum);
+static void metricsClientConnected(HttpServerConnection *con);
+static void collectLoopMetrics(void);
+static void reportWakeups(Timer *t);
+static void metricsRequestReceived(HttpServerConnection *con,
+                                   HttpServerConnection::Request& req);
 
 
 /****************************************************************************
@@ -142,6 +164,14 @@ namespace {
   vector<LogicBase*>    logic_vec;
   FdWatch*              stdin_watch = 0;
   LogWriter             logwriter;
+  Config*               main_cfg = nullptr;
+  std::string           main_cfg_filename;
+  TcpServer<HttpServerConnection>* metrics_server = nullptr;
+  NodeStatus*           node_status = nullptr;
+  Timer*                wakeup_audit_timer = nullptr;
+  bool                  startup_profile = false;
+  std::chrono::steady_clock::time_point startup_begin;
+  std::chrono::steady_clock::time_point startup_phase_begin;
 };
 
 
@@ -171,8 +201,12 @@ int main(int argc, char **argv)
 {
   setlocale(LC_ALL, "");
 
+  startup_begin = startup_phase_begin = std::chrono::steady_clock::now();
+
   CppApplication app;
+  ThreadSched::Registration main_sched_reg("main");
   app.catchUnixSignal(SIGHUP);
+  app.catchUnixSignal(SIGUSR1);
   app.catchUnixSignal(SIGINT);
   app.catchUnixSignal(SIGTERM);
   app.unixSignalCaught.connect(sigc::ptr_fun(&handle_unix_signal));
@@ -315,56 +349,11 @@ int main(int argc, char **argv)
       }
     }
   }
-  string main_cfg_filename(cfg_filename);
-  
-  string cfg_dir;
-  if (cfg.getValue("GLOBAL", "CFG_DIR", cfg_dir))
+  main_cfg_filename = cfg_filename;
+  main_cfg = &cfg;
+  if (!read_cfg_dir(cfg, main_cfg_filename))
   {
-    if (cfg_dir[0] != '/')
-    {
-      int slash_pos = main_cfg_filename.rfind('/');
-      if (slash_pos != -1)
-      {
-      	cfg_dir = main_cfg_filename.substr(0, slash_pos+1) + cfg_dir;
-      }
-      else
-      {
-      	cfg_dir = string("./") + cfg_dir;
-      }
-    }
-    
-    DIR *dir = opendir(cfg_dir.c_str());
-    if (dir == NULL)
-    {
-      cerr << "*** ERROR: Could not read from directory spcified by "
-      	   << "configuration variable GLOBAL/CFG_DIR=" << cfg_dir << endl;
-      exit(1);
-    }
-    
-    struct dirent *dirent;
-    while ((dirent = readdir(dir)) != NULL)
-    {
-      char *dot = strrchr(dirent->d_name, '.');
-      if ((dot == NULL) || (dirent->d_name[0] == '.') ||
-          (strcmp(dot, ".conf") != 0))
-      {
-      	continue;
-      }
-      cfg_filename = cfg_dir + "/" + dirent->d_name;
-      if (!cfg.open(cfg_filename))
-       {
-	 cerr << "*** ERROR: Could not open configuration file: "
-	      << cfg_filename << endl;
-	 exit(1);
-       }
-    }
-    
-    if (closedir(dir) == -1)
-    {
-      cerr << "*** ERROR: Error closing directory specified by"
-      	   << "configuration variable GLOBAL/CFG_DIR=" << cfg_dir << endl;
-      exit(1);
-    }
+    exit(1);
   }
 
   std::string tstamp_format = "%c";
@@ -380,6 +369,9 @@ int main(int argc, char **argv)
   cout << "GNU GPL (General Public License) version 2 or later.\n";
 
   cout << "\nUsing configuration file: " << main_cfg_filename << endl;
+
+  cfg.getValue("GLOBAL", "STARTUP_PROFILE", startup_profile);
+  startup_phase_done("configuration");
   
   string value;
   if (cfg.getValue("GLOBAL", "CARD_SAMPLE_RATE", value))
@@ -420,6 +412,37 @@ int main(int argc, char **argv)
   cfg.getValue("GLOBAL", "CARD_CHANNELS", card_channels);
   AudioIO::setChannels(card_channels);
 
+    // Override the sound card buffering set up above. Smaller blocks give
+    // lower latency but increase the risk of buffer overruns/underruns.
+  size_t card_block_size = 0;
+  if (cfg.getValue("GLOBAL", "CARD_BLOCK_SIZE", card_block_size))
+  {
+    if ((card_block_size < 32) || (card_block_size > 8192))
+    {
+      cerr << "*** ERROR: Illegal value for config variable "
+              "GLOBAL/CARD_BLOCK_SIZE. Valid values are 32 to 8192\n";
+      exit(1);
+    }
+    AudioIO::setBlocksize(card_block_size);
+  }
+  size_t card_block_count = 0;
+  if (cfg.getValue("GLOBAL", "CARD_BLOCK_COUNT", card_block_count))
+  {
+    if ((card_block_count < 2) || (card_block_count > 32))
+    {
+      cerr << "*** ERROR: Illegal value for config variable "
+              "GLOBAL/CARD_BLOCK_COUNT. Valid values are 2 to 32\n";
+      exit(1);
+    }
+    AudioIO::setBlockCount(card_block_count);
+  }
+
+  unsigned clip_cache_size = 0;
+  cfg.getValue("GLOBAL", "SOUND_CLIP_CACHE_SIZE", clip_cache_size);
+  MsgHandler::setClipCacheSize(1024 * static_cast<size_t>(clip_cache_size));
+
+  startup_phase_done("audio setup");
+
     // Init locationinfo
   if (cfg.getValue("GLOBAL", "LOCATION_INFO", value))
   {
@@ -430,6 +453,7 @@ int main(int argc, char **argv)
                 << std::endl;
       exit(1);
     }
+    startup_phase_done("location info");
   }
 
     // Init Logiclinking
@@ -441,10 +465,45 @@ int main(int argc, char **argv)
            << "GLOBAL/LINKS=" << value << ".\n";
       exit(1);
     }
+    startup_phase_done("link manager");
   }
 
+  initialize_thread_sched(cfg);
+  startup_phase_done("thread scheduling");
   initialize_logics(cfg);
 
+  unsigned loop_watchdog_threshold = 0;
+  if (cfg.getValue("GLOBAL", "LOOP_WATCHDOG_THRESHOLD",
+                   loop_watchdog_threshold))
+  {
+    app.setLoopWatchdog(loop_watchdog_threshold);
+  }
+
+  unsigned wakeup_audit_interval = 0;
+  if (cfg.getValue("GLOBAL", "WAKEUP_AUDIT_INTERVAL", wakeup_audit_interval) &&
+      (wakeup_audit_interval > 0))
+  {
+    app.setWakeupAudit(true);
+    wakeup_audit_timer = new Timer(1000 * wakeup_audit_interval,
+                                   Timer::TYPE_PERIODIC);
+    wakeup_audit_timer->setName("svxlink::wakeup_audit");
+    wakeup_audit_timer->expired.connect(sigc::ptr_fun(&reportWakeups));
+  }
+
+  if (cfg.getValue("GLOBAL", "METRICS_HTTP_PORT", value) && !value.empty())
+  {
+    metrics_server = new TcpServer<HttpServerConnection>(value);
+    metrics_server->clientConnected.connect(
+        sigc::ptr_fun(&metricsClientConnected));
+    SvxLink::Metrics::instance()->collect.connect(
+        sigc::ptr_fun(&collectLoopMetrics));
+    node_status = new NodeStatus;
+    for (const auto& logic : logic_vec)
+    {
+      node_status->addLogic(logic);
+    }
+  }
+
   if (LinkManager::hasInstance())
   {
     LinkManager::instance()->allLogicsStarted();
@@ -471,10 +530,26 @@ int main(int argc, char **argv)
     Async::Application::app().quit();
   }
 
+  if (startup_profile)
+  {
+    std::cout << "--- Startup profile: Initialization done in "
+              << std::chrono::duration_cast<std::chrono::milliseconds>(
+                   std::chrono::steady_clock::now() - startup_begin).count()
+              << "ms" << std::endl;
+  }
+
   std::cout << "NOTICE: Initialization done. Starting main application."
             << std::endl;
   app.exec();
 
+  delete wakeup_audit_timer;
+  wakeup_audit_timer = nullptr;
+
+  delete metrics_server;
+  metrics_server = nullptr;
+  delete node_status;
+  node_status = nullptr;
+
   LinkManager::deleteInstance();
   LocationInfo::deleteInstance();
 
@@ -694,7 +769,9 @@ static void initialize_logics(Config &cfg)
       continue;
     }
 
+    logic->configReloadRequested.connect(sigc::ptr_fun(&reload_config));
     logic_vec.push_back(logic);
+    startup_phase_done("logic " + logic_name);
   } while (comma != logics.end());
   
   if (logic_vec.size() == 0)
@@ -705,18 +782,243 @@ static void initialize_logics(Config &cfg)
 } /* initialize_logics */
 
 
-static void sighup_handler(int signal)
+  /* Print the time used by a startup phase, if startup profiling is enabled.
+   * The time is measured from the end of the previous phase. */
+static void startup_phase_done(const std::string& phase)
 {
-  if (logfile_name == 0)
+  auto now = std::chrono::steady_clock::now();
+  if (startup_profile)
+  {
+    std::cout << "--- Startup profile: " << phase << " took "
+              << std::chrono::duration_cast<std::chrono::milliseconds>(
+                   now - startup_phase_begin).count()
+              << "ms" << std::endl;
+  }
+  startup_phase_begin = now;
+} /* startup_phase_done */
+
+
+static void initialize_thread_sched(Config &cfg)
+{
+  bool lock_memory = false;
+  cfg.getValue("GLOBAL", "MLOCKALL", lock_memory);
+  if (lock_memory && ThreadSched::lockMemory())
+  {
+    cout << "Locked all process memory in RAM" << endl;
+  }
+
+  std::map<std::string, int> rt_prios;
+  if (!cfg.getValue("GLOBAL", "THREAD_RT_PRIO", rt_prios, ':', true))
+  {
+    cerr << "*** ERROR: Illegal format for config variable "
+            "GLOBAL/THREAD_RT_PRIO. It should be a comma separated list of "
+            "thread:prio pairs.\n";
+    exit(1);
+  }
+  std::map<std::string, std::string> cpu_lists;
+  if (!cfg.getValue("GLOBAL", "THREAD_CPU_AFFINITY", cpu_lists, ':', true))
+  {
+    cerr << "*** ERROR: Illegal format for config variable "
+            "GLOBAL/THREAD_CPU_AFFINITY. It should be a comma separated list "
+            "of thread:cpus pairs.\n";
+    exit(1);
+  }
+
+  std::map<std::string, ThreadSched::Params> params;
+  for (const auto& rt_prio : rt_prios)
+  {
+    if ((rt_prio.second < sched_get_priority_min(SCHED_FIFO)) ||
+        (rt_prio.second > sched_get_priority_max(SCHED_FIFO)))
+    {
+      cerr << "*** ERROR: Illegal real time priority " << rt_prio.second
+           << " for thread \"" << rt_prio.first
+           << "\" in config variable GLOBAL/THREAD_RT_PRIO\n";
+      exit(1);
+    }
+    params[rt_prio.first].rt_prio = rt_prio.second;
+  }
+  for (const auto& cpu_list : cpu_lists)
+  {
+    std::vector<unsigned> cpus;
+    if (!ThreadSched::parseCpuList(cpu_list.second, cpus))
+    {
+      cerr << "*** ERROR: Illegal CPU list \"" << cpu_list.second
+           << "\" for thread \"" << cpu_list.first
+           << "\" in config variable GLOBAL/THREAD_CPU_AFFINITY\n";
+      exit(1);
+    }
+    params[cpu_list.first].cpus = cpus;
+  }
+
+  static const std::set<std::string> thread_classes = {
+    "main", "logwriter", "dns", "worker", "rtlusb", "audio"
+  };
+  for (const auto& param : params)
+  {
+    if (thread_classes.count(param.first) == 0)
+    {
+      cerr << "*** WARNING: Unknown thread \"" << param.first
+           << "\" in GLOBAL/THREAD_RT_PRIO or GLOBAL/THREAD_CPU_AFFINITY\n";
+    }
+    cout << "Thread scheduling for \"" << param.first << "\":";
+    if (param.second.rt_prio > 0)
+    {
+      cout << " SCHED_FIFO priority " << param.second.rt_prio;
+    }
+    if (!param.second.cpus.empty())
+    {
+      cout << " CPUs " << ThreadSched::cpuListString(param.second.cpus);
+    }
+    cout << endl;
+    ThreadSched::setParams(param.first, param.second);
+  }
+} /* initialize_thread_sched */
+
+
+static bool read_cfg_dir(Config &cfg, const std::string& main_filename)
+{
+  string cfg_dir;
+  if (cfg.getValue("GLOBAL", "CFG_DIR", cfg_dir))
+  {
+    if (cfg_dir[0] != '/')
+    {
+      int slash_pos = main_filename.rfind('/');
+      if (slash_pos != -1)
+      {
+      	cfg_dir = main_filename.substr(0, slash_pos+1) + cfg_dir;
+      }
+      else
+      {
+      	cfg_dir = string("./") + cfg_dir;
+      }
+    }
+    
+    DIR *dir = opendir(cfg_dir.c_str());
+    if (dir == NULL)
+    {
+      cerr << "*** ERROR: Could not read from directory spcified by "
+      	   << "configuration variable GLOBAL/CFG_DIR=" << cfg_dir << endl;
+      return false;
+    }
+    
+    struct dirent *dirent;
+    while ((dirent = readdir(dir)) != NULL)
+    {
+      char *dot = strrchr(dirent->d_name, '.');
+      if ((dot == NULL) || (dirent->d_name[0] == '.') ||
+          (strcmp(dot, ".conf") != 0))
+      {
+      	continue;
+      }
+      string cfg_filename = cfg_dir + "/" + dirent->d_name;
+      if (!cfg.open(cfg_filename))
+       {
+	 cerr << "*** ERROR: Could not open configuration file: "
+	      << cfg_filename << endl;
+	 return false;
+       }
+    }
+    
+    if (closedir(dir) == -1)
+    {
+      cerr << "*** ERROR: Error closing directory specified by"
+      	   << "configuration variable GLOBAL/CFG_DIR=" << cfg_dir << endl;
+      return false;
+    }
+  }
+  return true;
+} /* read_cfg_dir */
+
+
+  /*
+   * Read the configuration files again and load all changed values into the
+   * configuration object. Subsystems that subscribe to configuration updates
+   * will be notified for each changed variable. After that, the logic cores
+   * and the link manager get the chance to rebuild objects whose
+   * configuration have changed.
+   */
+static void reload_config(void)
+{
+  std::cout << "Reloading configuration file " << main_cfg_filename
+            << std::endl;
+  Config new_cfg;
+  if (!new_cfg.open(main_cfg_filename) ||
+      !read_cfg_dir(new_cfg, main_cfg_filename))
+  {
+    std::cerr << "*** ERROR: Could not read the configuration. "
+                 "Keeping the current configuration." << std::endl;
+    return;
+  }
+
+    // Removal of variables is not supported by the configuration object
+  for (const auto& section : main_cfg->listSections())
+  {
+    for (const auto& tag : main_cfg->listSection(section))
+    {
+      std::string value;
+      if (!new_cfg.getValue(section, tag, value, true))
+      {
+        std::cerr << "*** WARNING: Removal of configuration variable "
+                  << section << "/" << tag << " require a restart"
+                  << std::endl;
+      }
+    }
+  }
+
+  std::set<std::string> changed_sections;
+  sigc::connection con = main_cfg->valueUpdated.connect(
+      [&](const std::string& section, const std::string& tag)
+      {
+        changed_sections.insert(section);
+      });
+  size_t changed = main_cfg->loadSnapshot(new_cfg);
+  con.disconnect();
+
+  std::cout << "Configuration reloaded: " << changed
+            << " variable(s) changed";
+  for (const auto& section : changed_sections)
+  {
+    std::cout << " [" << section << "]";
+  }
+  std::cout << std::endl;
+  if (changed_sections.count("GLOBAL") > 0)
+  {
+    std::cerr << "*** WARNING: Most changes in the GLOBAL section require a "
+                 "restart" << std::endl;
+  }
+  if (changed == 0)
   {
-    cout << "Ignoring SIGHUP\n";
     return;
   }
+
+  for (auto& logic : logic_vec)
+  {
+    logic->configReloaded(changed_sections);
+  }
+  if (LinkManager::hasInstance())
+  {
+    LinkManager::instance()->configReloaded(*main_cfg, changed_sections);
+  }
+} /* reload_config */
+
+
+static void sighup_handler(int signal)
+{
   std::cout << "SIGHUP received" << std::endl;
-  logwriter.reopenLogfile();
+  if (logfile_name != 0)
+  {
+    logwriter.reopenLogfile();
+  }
 } /* sighup_handler */
 
 
+static void sigusr1_handler(int signal)
+{
+  std::cout << "SIGUSR1 received" << std::endl;
+  reload_config();
+} /* sigusr1_handler */
+
+
 static void sigterm_handler(int signal)
 {
   const char *signame = 0;
@@ -747,6 +1049,9 @@ static void handle_unix_signal(int signum)
     case SIGHUP:
       sighup_handler(signum);
       break;
+    case SIGUSR1:
+      sigusr1_handler(signum);
+      break;
     case SIGINT:
     case SIGTERM:
       sigterm_handler(signum);
@@ -755,6 +1060,160 @@ static void handle_unix_signal(int signum)
 } /* handle_unix_signal */
 
 
+static void metricsClientConnected(HttpServerConnection *con)
+{
+  con->requestReceived.connect(sigc::ptr_fun(&metricsRequestReceived));
+} /* metricsClientConnected */
+
+
+static void collectLoopMetrics(void)
+{
+  SvxLink::Metrics* metrics = SvxLink::Metrics::instance();
+  const Application::LoopStats& loop_stats = Application::app().loopStats();
+  std::vector<double> busy_bounds;
+  std::vector<double> lag_bounds;
+  for (unsigned i=0; i<Application::LoopStats::HIST_BUCKETS-1; ++i)
+  {
+    busy_bounds.push_back((1 << i) / 1000000.0);
+    lag_bounds.push_back((1 << i) / 1000.0);
+  }
+  SvxLink::MetricHistogram& busy = metrics->histogram(
+      "svxlink_event_loop_busy_seconds",
+      "Time spent handling events in one event loop iteration", busy_bounds);
+  busy.clear();
+  SvxLink::MetricHistogram& lag = metrics->histogram(
+      "svxlink_timer_lag_seconds", "How late timers were when they expired",
+      lag_bounds);
+  lag.clear();
+  for (unsigned i=0; i<Application::LoopStats::HIST_BUCKETS; ++i)
+  {
+    busy.add(i, loop_stats.busy_us_hist[i], 0.0);
+    lag.add(i, loop_stats.timer_lag_ms_hist[i], 0.0);
+  }
+  busy.add(0, 0, loop_stats.busy_us / 1000000.0);
+  lag.add(0, 0, loop_stats.timer_lag_ms / 1000.0);
+
+  const char* slow_max_name = "svxlink_event_loop_slow_callback_seconds";
+  const char* slow_cnt_name = "svxlink_event_loop_slow_callbacks_total";
+  metrics->clear(slow_max_name);
+  metrics->clear(slow_cnt_name);
+  for (const auto& cb : Application::app().slowCallbacks())
+  {
+    const SvxLink::Metrics::Labels labels{{"source", cb.source}};
+    metrics->gauge(slow_max_name,
+        "The longest time used by one call to a slow event loop callback",
+        labels).set(cb.max_us / 1000000.0);
+    metrics->counter(slow_cnt_name,
+        "Number of calls to an event loop callback that were slow",
+        labels).set(cb.count);
+  }
+
+  const Application::ObjectCounts& objs = Application::objectCounts();
+  metrics->gauge("svxlink_event_loop_timers",
+      "Number of existing event loop timers").set(objs.timers);
+  metrics->gauge("svxlink_event_loop_enabled_timers",
+      "Number of enabled event loop timers").set(objs.enabled_timers);
+  metrics->gauge("svxlink_event_loop_fd_watches",
+      "Number of existing file descriptor watches").set(objs.fd_watches);
+  metrics->gauge("svxlink_event_loop_enabled_fd_watches",
+      "Number of enabled file descriptor watches").set(
+        objs.enabled_fd_watches);
+
+  if (Application::app().wakeupAudit())
+  {
+    for (const auto& src : Application::app().wakeupSources())
+    {
+      metrics->counter("svxlink_event_loop_wakeups_total",
+          "Number of event loop callbacks from each wakeup source",
+          {{"source", src.source}}).set(src.count);
+    }
+  }
+} /* collectLoopMetrics */
+
+
+static void reportWakeups(Timer *t)
+{
+  static const unsigned REPORT_CNT = 5;
+  static uint64_t prev_iterations = 0;
+  static std::map<std::string, uint64_t> prev_counts;
+
+  const Application& app = Application::app();
+  const double interval_s = t->timeout() / 1000.0;
+  const uint64_t iterations = app.loopStats().iterations;
+  std::ostringstream os;
+  os << std::fixed << std::setprecision(1)
+     << "Event loop wakeups: " << (iterations - prev_iterations) / interval_s
+     << "/s\n";
+  prev_iterations = iterations;
+  const Application::ObjectCounts& objs = Application::objectCounts();
+  os << "  Timers: " << objs.timers << " (" << objs.enabled_timers
+     << " enabled), FD watches: " << objs.fd_watches << " ("
+     << objs.enabled_fd_watches << " enabled)\n";
+
+    // The sources are sorted by the total count so sort them again by the
+    // count during the last interval
+  std::vector<std::pair<uint64_t, std::string>> sources;
+  for (const auto& src : app.wakeupSources())
+  {
+    uint64_t& prev = prev_counts[src.source];
+    if (src.count > prev)
+    {
+      sources.push_back({src.count - prev, src.source});
+    }
+    prev = src.count;
+  }
+  std::sort(sources.rbegin(), sources.rend());
+  for (unsigned i=0; (i<sources.size()) && (i<REPORT_CNT); ++i)
+  {
+    os << "  " << std::setw(8) << (60.0 * sources[i].first / interval_s)
+       << "/min " << sources[i].second << "\n";
+  }
+  std::cout << os.str() << std::flush;
+} /* reportWakeups */
+
+
+static void metricsRequestReceived(HttpServerConnection *con,
+                                   HttpServerConnection::Request& req)
+{
+  HttpServerConnection::Response res;
+  if ((req.method != "GET") && (req.method != "HEAD"))
+  {
+    res.setCode(501);
+    res.setContent("text/plain", req.method + ": Method not implemented\n");
+    con->write(res);
+    return;
+  }
+
+  std::string path(req.target);
+  path.erase(std::min(path.find('?'), path.size()));
+  if ((path == "/status") && (node_status != nullptr))
+  {
+    res.setHeader("Cache-Control", "no-cache");
+    res.setContent("application/json", node_status->json());
+    res.setSendContent(req.method == "GET");
+    res.setCode(200);
+    con->write(res);
+    return;
+  }
+  if (path != "/metrics")
+  {
+    res.setCode(404);
+    res.setContent("text/plain", "Not found\n");
+    res.setSendContent(req.method == "GET");
+    con->write(res);
+    return;
+  }
+
+  std::ostringstream os;
+  SvxLink::Metrics::instance()->write(os);
+  res.setHeader("Cache-Control", "no-cache");
+  res.setContent(SvxLink::Metrics::contentType(), os.str());
+  res.setSendContent(req.method == "GET");
+  res.setCode(200);
+  con->write(res);
+} /* metricsRequestReceived */
+
+
 /*
  * This file has not been truncated
  */
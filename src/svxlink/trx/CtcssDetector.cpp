@@ -0,0 +1,463 @@
+/**
+@file	 CtcssDetector.cpp
+@brief   A detector for a number of CTCSS tones sharing one analysis engine
+@author  Tobias Blomberg / SM0SVX
+@date	 2026-10-14
+
+\verbatim
+SvxLink - A Multi Purpose Voice Services System for Ham Radio Use
+Copyright (C) 2003-2026 Tobias Blomberg / SM0SVX
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+\endverbatim
+*/
+
+
+
+
+/****************************************************************************
+ *
+ * System Includes
+ *
+ ****************************************************************************/
+
+#include <cassert>
+#include <cmath>
+#include <sstream>
+#include <algorithm>
+
+
+/****************************************************************************
+ *
+ * Project Includes
+ *
+ ****************************************************************************/
+
+#include <AsyncAudioFilter.h>
+#include <AsyncSigCAudioSink.h>
+#include <AsyncSimd.h>
+
+
+/****************************************************************************
+ *
+ * Local Includes
+ *
+ ****************************************************************************/
+
+#include "CtcssDetector.h"
+
+
+
+/****************************************************************************
+ *
+ * Namespaces to use
+ *
+ ****************************************************************************/
+
+using namespace std;
+using namespace Async;
+
+
+
+/****************************************************************************
+ *
+ * Defines & typedefs
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Local class definitions
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Prototypes and local functions
+ *
+ ****************************************************************************/
+
+namespace
+{
+  inline double wrapToPi(double x)
+  {
+    if (x > M_PI)
+    {
+      x -= 2*M_PI * std::trunc((x+M_PI)/(2*M_PI));
+    }
+    else if (x < -M_PI)
+    {
+      x -= 2*M_PI * std::trunc((x-M_PI)/(2*M_PI));
+    }
+    return x;
+  } /* wrapToPi */
+}; /* Anonymous namespace */
+
+
+
+/****************************************************************************
+ *
+ * Exported Global Variables
+ *
+ ****************************************************************************/
+
+
+
+
+/****************************************************************************
+ *
+ * Local Global Variables
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Public member functions
+ *
+ ****************************************************************************/
+
+CtcssDetector::CtcssDetector(const std::vector<float>& tone_fqs,
+                             unsigned bpf_low, unsigned bpf_high)
+  : m_passband_bw(bpf_high - bpf_low),
+    m_dec_fact(INTERNAL_SAMPLE_RATE / ANALYSIS_SAMPLE_RATE)
+{
+  assert(INTERNAL_SAMPLE_RATE % ANALYSIS_SAMPLE_RATE == 0);
+
+    // The band pass filter limit the signal to the CTCSS band. The low pass
+    // filter is added to suppress what is left above the band enough for
+    // the decimation to not cause any noticeable aliasing.
+  std::ostringstream filter_spec;
+  filter_spec << "BpBu8/" << bpf_low << "-" << bpf_high << " x LpBu4/"
+              << (2 * ANALYSIS_SAMPLE_RATE / 5);
+  m_filter = new AudioFilter(filter_spec.str());
+  setHandler(m_filter);
+
+  SigCAudioSink *sigc_sink = new SigCAudioSink;
+  sigc_sink->sigWriteSamples.connect(
+      mem_fun(*this, &CtcssDetector::processSamples));
+  sigc_sink->sigFlushSamples.connect(
+      mem_fun(*sigc_sink, &SigCAudioSink::allSamplesFlushed));
+  m_filter->registerSink(sigc_sink, true);
+
+  m_tones.resize(tone_fqs.size());
+  for (size_t i=0; i<m_tones.size(); ++i)
+  {
+    Tone& tone = m_tones[i];
+    tone.fq = tone_fqs[i];
+    setupWindow(tone.det, tone.fq, DET_BW);
+    setupWindow(tone.undet, tone.fq, UNDET_BW);
+    m_hist_len = std::max(m_hist_len, std::max(tone.det.len, tone.undet.len));
+  }
+  m_energy.resize(m_hist_len + 1);
+  m_snrs.resize(m_tones.size());
+
+  setDetectDelay(DEFAULT_DET_DELAY_MS);
+  setUndetectDelay(DEFAULT_UNDET_DELAY_MS);
+
+  reset();
+} /* CtcssDetector::CtcssDetector */
+
+
+CtcssDetector::~CtcssDetector(void)
+{
+  clearHandler();
+  delete m_filter;
+} /* CtcssDetector::~CtcssDetector */
+
+
+void CtcssDetector::setSnrThresh(size_t idx, float open_thresh_db,
+                                 float close_thresh_db)
+{
+  m_tones[idx].open_thresh = open_thresh_db;
+  m_tones[idx].close_thresh = close_thresh_db;
+} /* CtcssDetector::setSnrThresh */
+
+
+void CtcssDetector::setDetectDelay(int delay_ms)
+{
+  for (auto& tone : m_tones)
+  {
+    setStableCountThresh(tone.det, delay_ms);
+  }
+} /* CtcssDetector::setDetectDelay */
+
+
+void CtcssDetector::setUndetectDelay(int delay_ms)
+{
+  for (auto& tone : m_tones)
+  {
+    setStableCountThresh(tone.undet, delay_ms);
+  }
+} /* CtcssDetector::setUndetectDelay */
+
+
+void CtcssDetector::setToneFrequencyTolerancePercent(float tol_percent)
+{
+  m_fq_tol_percent = tol_percent;
+} /* CtcssDetector::setToneFrequencyTolerancePercent */
+
+
+void CtcssDetector::reset(void)
+{
+  m_hist.assign(m_hist_len, 0.0f);
+  m_dec_pos = 0;
+  m_new_cnt = 0;
+  for (auto& tone : m_tones)
+  {
+    tone.is_activated = false;
+    tone.last_active = false;
+    tone.stable_count = 0;
+    tone.fresh_cnt = 0;
+    tone.prev_res = 0;
+    tone.has_prev = false;
+    tone.last_snr = 0.0f;
+    tone.fq_est = 0.0f;
+  }
+} /* CtcssDetector::reset */
+
+
+size_t CtcssDetector::strongestTone(void) const
+{
+  size_t max_idx = 0;
+  for (size_t i=1; i<m_tones.size(); ++i)
+  {
+    if (m_tones[i].last_snr > m_tones[max_idx].last_snr)
+    {
+      max_idx = i;
+    }
+  }
+  return max_idx;
+} /* CtcssDetector::strongestTone */
+
+
+
+/****************************************************************************
+ *
+ * Private member functions
+ *
+ ****************************************************************************/
+
+void CtcssDetector::setupWindow(WinParams& win, float fq, float bw)
+{
+    // Adjust the window length to place the tone as close to the center of
+    // a DFT bin as possible
+  win.len = lrintf(ANALYSIS_SAMPLE_RATE * ceilf(fq / bw) / fq);
+
+  const double w = 2.0 * M_PI * fq / ANALYSIS_SAMPLE_RATE;
+  win.cos_tab.resize(win.len);
+  win.sin_tab.resize(win.len);
+  for (size_t n=0; n<win.len; ++n)
+  {
+    win.cos_tab[n] = cos(w * n);
+    win.sin_tab[n] = sin(w * n);
+  }
+
+    // At the low analysis sampling rate the window length cannot be chosen
+    // to hold an exact number of tone periods, so the negative frequency
+    // image of the tone leak into the DFT bin. It make the phase jump
+    // around from one window to the next, which would ruin the frequency
+    // estimate. Since the leakage for a tone at the bin frequency is known,
+    // it can be removed from the result.
+  std::complex<double> image = 0.0;
+  for (size_t n=0; n<win.len; ++n)
+  {
+    image += std::polar(1.0, -2.0 * w * n);
+  }
+  const double len = win.len;
+  win.image = image;
+  win.image_scale = len / (len * len - std::norm(image));
+} /* CtcssDetector::setupWindow */
+
+
+void CtcssDetector::setStableCountThresh(WinParams& win, int delay_ms)
+{
+  if (delay_ms > 0)
+  {
+    int block_cnt = 1;
+    size_t delay_cnt = delay_ms * ANALYSIS_SAMPLE_RATE / 1000;
+    if (delay_cnt > win.len)
+    {
+      block_cnt += 1 + (delay_cnt - win.len) / ANALYSIS_INTERVAL;
+    }
+    win.stable_cnt_thresh = block_cnt;
+  }
+  else if (delay_ms == 0)
+  {
+    win.stable_cnt_thresh = DEFAULT_STABLE_COUNT_THRESH;
+  }
+} /* CtcssDetector::setStableCountThresh */
+
+
+int CtcssDetector::processSamples(float *samples, int count)
+{
+  for (int i=0; i<count; ++i)
+  {
+    if (++m_dec_pos < m_dec_fact)
+    {
+      continue;
+    }
+    m_dec_pos = 0;
+    m_hist.push_back(samples[i]);
+    if (++m_new_cnt >= ANALYSIS_INTERVAL)
+    {
+      analyze();
+      m_new_cnt = 0;
+    }
+  }
+  return count;
+} /* CtcssDetector::processSamples */
+
+
+void CtcssDetector::analyze(void)
+{
+    // Only keep the samples needed for the longest window
+  m_hist.erase(m_hist.begin(), m_hist.end() - m_hist_len);
+
+    // Calculate the energy of the latest samples, for all window lengths at
+    // once
+  const float *newest = &m_hist[m_hist_len - 1];
+  m_energy[0] = 0.0;
+  for (size_t k=1; k<=m_hist_len; ++k)
+  {
+    const double sample = *(newest + 1 - k);
+    m_energy[k] = m_energy[k-1] + sample * sample;
+  }
+
+  std::vector<std::pair<float, size_t> > activations;
+  std::vector<size_t> deactivations;
+  for (size_t i=0; i<m_tones.size(); ++i)
+  {
+    Tone& tone = m_tones[i];
+    const WinParams& win = tone.is_activated ? tone.undet : tone.det;
+
+      // After a state change, wait until the window is filled with samples
+      // received after the change
+    tone.fresh_cnt += ANALYSIS_INTERVAL;
+    if (tone.fresh_cnt < win.len)
+    {
+      m_snrs[i] = tone.last_snr;
+      continue;
+    }
+
+      // Calculate the DFT for the tone over the window
+    const float *x = &m_hist[m_hist_len - win.len];
+    const float re = Simd::dotProduct(x, win.cos_tab.data(), win.len);
+    const float im = -Simd::dotProduct(x, win.sin_tab.data(), win.len);
+    const std::complex<float> raw(re, im);
+    const std::complex<float> res =
+      (raw * static_cast<float>(win.len) - std::conj(raw) * win.image) *
+      win.image_scale;
+
+      // Estimate the SNR by comparing the mean tone power to the noise power
+      // estimated over the passband. This is the same calculation as the
+      // one in ToneDetector.
+    const float block_len = win.len;
+    const float Ptone = 2.0f * std::norm(res) / (block_len * block_len);
+    const float Ppassband = m_energy[win.len] / block_len;
+    const float det_bw = ANALYSIS_SAMPLE_RATE / block_len;
+    const float Pnoise =
+      (Ppassband - Ptone) / ((m_passband_bw - det_bw) / det_bw);
+    tone.last_snr = 70.0f;
+    if (Pnoise > 0.0f)
+    {
+      tone.last_snr = 10.0f * log10f(Ptone / Pnoise);
+    }
+    m_snrs[i] = tone.last_snr;
+
+    const float snr_thresh =
+      tone.is_activated ? tone.close_thresh : tone.open_thresh;
+    bool active = (Ptone > TONE_PWR_THRESH) && (tone.last_snr > snr_thresh);
+
+      // Estimate the tone frequency from the phase change since the last
+      // analysis. This is only done when waiting for a tone.
+    if (!tone.is_activated && (m_fq_tol_percent > 0.0f))
+    {
+      if (tone.has_prev)
+      {
+        const double exp_adv =
+          2.0 * M_PI * tone.fq * ANALYSIS_INTERVAL / ANALYSIS_SAMPLE_RATE;
+        const double phase_err =
+          wrapToPi(std::arg(res * std::conj(tone.prev_res)) - exp_adv);
+        const double fq_err =
+          ANALYSIS_SAMPLE_RATE * phase_err / (2.0 * M_PI * ANALYSIS_INTERVAL);
+        tone.fq_est = tone.fq + fq_err;
+        active = active &&
+                 (fabs(fq_err) < tone.fq * m_fq_tol_percent / 100.0f);
+      }
+      else
+      {
+        active = false;
+      }
+      tone.prev_res = res;
+      tone.has_prev = true;
+    }
+
+      // If the detector is stable in the active or inactive state, the
+      // stable counter is increaed. Otherwise it is reset.
+    if (active == tone.last_active)
+    {
+      tone.stable_count += 1;
+    }
+    else
+    {
+      tone.stable_count = 1;
+    }
+    tone.last_active = active;
+
+    if ((tone.is_activated != active) &&
+        (tone.stable_count >= win.stable_cnt_thresh))
+    {
+      tone.is_activated = active;
+      tone.fresh_cnt = 0;
+      tone.has_prev = false;
+      if (active)
+      {
+        activations.push_back(std::make_pair(tone.last_snr, i));
+      }
+      else
+      {
+        deactivations.push_back(i);
+      }
+    }
+  }
+
+  snrsUpdated(m_snrs);
+
+    // Report deactivations first and then activations, strongest tone first
+  for (size_t idx : deactivations)
+  {
+    activated(idx, false);
+    m_tones[idx].fq_est = 0.0f;
+  }
+  std::sort(activations.begin(), activations.end(),
+            std::greater<std::pair<float, size_t> >());
+  for (const auto& act : activations)
+  {
+    activated(act.second, true);
+    m_tones[act.second].fq_est = 0.0f;
+  }
+} /* CtcssDetector::analyze */
+
+
+
+/*
+ * This file has not been truncated
+ */
@@ -0,0 +1,305 @@
+/**
+@file	 CtcssDetector.h
+@brief   A detector for a number of CTCSS tones sharing one analysis engine
+@author  Tobias Blomberg / SM0SVX
+@date	 2026-10-14
+
+\verbatim
+SvxLink - A Multi Purpose Voice Services System for Ham Radio Use
+Copyright (C) 2003-2026 Tobias Blomberg / SM0SVX
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+\endverbatim
+*/
+
+
+#ifndef CTCSS_DETECTOR_INCLUDED
+#define CTCSS_DETECTOR_INCLUDED
+
+
+/****************************************************************************
+ *
+ * System Includes
+ *
+ ****************************************************************************/
+
+#include <sigc++/sigc++.h>
+#include <vector>
+#include <complex>
+
+
+/****************************************************************************
+ *
+ * Project Includes
+ *
+ ****************************************************************************/
+
+#include <AsyncAudioSink.h>
+#include <CppStdCompat.h>
+
+
+/****************************************************************************
+ *
+ * Local Includes
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Forward declarations
+ *
+ ****************************************************************************/
+
+namespace Async
+{
+  class AudioFilter;
+};
+
+
+/****************************************************************************
+ *
+ * Namespace
+ *
+ ****************************************************************************/
+
+//namespace MyNameSpace
+//{
+
+/****************************************************************************
+ *
+ * Defines & typedefs
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Exported Global Variables
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Class definitions
+ *
+ ****************************************************************************/
+
+/**
+@brief	A detector for a number of CTCSS tones sharing one analysis engine
+@author Tobias Blomberg / SM0SVX
+@date   2026-10-14
+
+This class detect any of a number of CTCSS tones using one analysis engine.
+The incoming audio is band pass filtered and decimated down to a low
+sampling rate once, no matter how many tones there are. All tones are then
+analysed at the same time, at a fixed interval, by calculating the DFT over
+the latest samples for each tone. The passband energy is also shared by all
+tones.
+
+Detection is done in the same way as the ToneDetector class does it when
+using overlapping blocks, SNR estimation and tone frequency tolerance
+checking (CTCSS_MODE=4). A wide detection bandwidth is used while waiting
+for a tone to be detected and a narrow one while a tone is active.
+
+The SNR for all tones is reported in one go after each analysis. If more than
+one tone is detected during the same analysis, the activations are reported
+in order of falling SNR so the first one reported is the strongest tone.
+*/
+class CtcssDetector : public sigc::trackable, public Async::AudioSink
+{
+  public:
+    /**
+     * @brief   Constructor
+     * @param   tone_fqs The CTCSS tone frequencies to detect, in Hz
+     * @param   bpf_low The lower edge of the passband, in Hz
+     * @param   bpf_high The upper edge of the passband, in Hz
+     */
+    CtcssDetector(const std::vector<float>& tone_fqs, unsigned bpf_low,
+                  unsigned bpf_high);
+
+    /**
+     * @brief   Destructor
+     */
+    ~CtcssDetector(void);
+
+    /**
+     * @brief   Get the number of tones
+     * @return  Returns the number of tones handled by this detector
+     */
+    size_t toneCount(void) const { return m_tones.size(); }
+
+    /**
+     * @brief   Get the frequency of a tone
+     * @param   idx The tone index
+     * @return  Returns the tone frequency in Hz
+     */
+    float toneFq(size_t idx) const { return m_tones[idx].fq; }
+
+    /**
+     * @brief   Set the SNR thresholds for a tone
+     * @param   idx The tone index
+     * @param   open_thresh_db The SNR needed to detect the tone
+     * @param   close_thresh_db The SNR under which the tone is undetected
+     */
+    void setSnrThresh(size_t idx, float open_thresh_db, float close_thresh_db);
+
+    /**
+     * @brief   Set the detection delay
+     * @param   delay_ms The delay in milliseconds
+     *
+     * A tone must have been detected for this long before it is reported
+     * as active. Specifying 0 will set the default delay.
+     */
+    void setDetectDelay(int delay_ms);
+
+    /**
+     * @brief   Set the undetection delay
+     * @param   delay_ms The delay in milliseconds
+     *
+     * A tone must have been gone for this long before it is reported as
+     * inactive. Specifying 0 will set the default delay.
+     */
+    void setUndetectDelay(int delay_ms);
+
+    /**
+     * @brief   Set the maximum tone frequency error
+     * @param   tol_percent The maximum frequency error in percent
+     *
+     * The frequency of a tone is estimated while detecting it. If the
+     * estimated frequency differ more than the given tolerance, the tone is
+     * not detected. Specifying 0 will disable the check.
+     */
+    void setToneFrequencyTolerancePercent(float tol_percent);
+
+    /**
+     * @brief   Reset the detector
+     */
+    void reset(void);
+
+    /**
+     * @brief   Check if a tone is active
+     * @param   idx The tone index
+     * @return  Returns \em true if the tone is active
+     */
+    bool isActivated(size_t idx) const { return m_tones[idx].is_activated; }
+
+    /**
+     * @brief   Get the latest calculated SNR for a tone
+     * @param   idx The tone index
+     * @return  Returns the SNR in dB
+     */
+    float lastSnr(size_t idx) const { return m_tones[idx].last_snr; }
+
+    /**
+     * @brief   Get the latest estimated frequency for a tone
+     * @param   idx The tone index
+     * @return  Returns the estimated frequency or 0 if not available
+     *
+     * The frequency is only estimated when the frequency tolerance check is
+     * enabled and the tone is not active.
+     */
+    float toneFqEstimate(size_t idx) const { return m_tones[idx].fq_est; }
+
+    /**
+     * @brief   Find the tone with the highest SNR
+     * @return  Returns the index of the tone with the highest SNR
+     */
+    size_t strongestTone(void) const;
+
+    /**
+     * @brief  A signal that is emitted when a tone change state
+     * @param  idx The tone index
+     * @param  is_activated Set to \em true if the tone was activated
+     */
+    sigc::signal<void(size_t, bool)> activated;
+
+    /**
+     * @brief  A signal that is emitted when the SNR has been recalculated
+     * @param  snrs The SNR in dB for each tone, in tone index order
+     */
+    sigc::signal<void(const std::vector<float>&)> snrsUpdated;
+
+  private:
+    struct WinParams
+    {
+      size_t                  len         = 0;
+      std::vector<float>      cos_tab;
+      std::vector<float>      sin_tab;
+      std::complex<float>     image       = 0;
+      float                   image_scale = 0.0f;
+      int                     stable_cnt_thresh = 0;
+    };
+    struct Tone
+    {
+      float                   fq          = 0.0f;
+      float                   open_thresh = 0.0f;
+      float                   close_thresh = 0.0f;
+      WinParams               det;
+      WinParams               undet;
+      bool                    is_activated = false;
+      bool                    last_active = false;
+      int                     stable_count = 0;
+      size_t                  fresh_cnt   = 0;
+      std::complex<float>     prev_res    = 0;
+      bool                    has_prev    = false;
+      float                   last_snr    = 0.0f;
+      float                   fq_est      = 0.0f;
+    };
+
+    static CONSTEXPR unsigned ANALYSIS_SAMPLE_RATE    = 1000;
+    static CONSTEXPR unsigned ANALYSIS_INTERVAL       = 20;
+    static CONSTEXPR float    DET_BW                  = 16.0f;
+    static CONSTEXPR float    UNDET_BW                = 8.0f;
+    static CONSTEXPR int      DEFAULT_DET_DELAY_MS    = 100;
+    static CONSTEXPR int      DEFAULT_UNDET_DELAY_MS  = 100;
+    static CONSTEXPR int      DEFAULT_STABLE_COUNT_THRESH = 3;
+    static CONSTEXPR float    TONE_PWR_THRESH         = 1.0e-7f;
+
+    std::vector<Tone>         m_tones;
+    Async::AudioFilter*       m_filter        = nullptr;
+    float                     m_passband_bw   = 0.0f;
+    unsigned                  m_dec_fact      = 1;
+    unsigned                  m_dec_pos       = 0;
+    std::vector<float>        m_hist;
+    size_t                    m_hist_len      = 0;
+    size_t                    m_new_cnt       = 0;
+    float                     m_fq_tol_percent = 0.0f;
+    std::vector<double>       m_energy;
+    std::vector<float>        m_snrs;
+
+    CtcssDetector(const CtcssDetector&);
+    CtcssDetector& operator=(const CtcssDetector&);
+    void setupWindow(WinParams& win, float fq, float bw);
+    void setStableCountThresh(WinParams& win, int delay_ms);
+    int processSamples(float *samples, int count);
+    void analyze(void);
+
+};  /* class CtcssDetector */
+
+
+//} /* namespace */
+
+#endif /* CTCSS_DETECTOR_INCLUDED */
+
+
+
+/*
+ * This file has not been truncated
+ */
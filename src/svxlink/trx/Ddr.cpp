@@ -8,7 +8,7 @@ This file contains a class that handle local digital drop receivers.
 
 \verbatim
 SvxLink - A Multi Purpose Voice Services System for Ham Radio Use
-Copyright (C) 2004-2018 Tobias Blomberg / SM0SVX
+Copyright (C) 2004-2026 Tobias Blomberg / SM0SVX
 
 This program is free software; you can redistribute it and/or modify
 it under the terms of the GNU General Public License as published by
@@ -50,6 +50,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 #include <algorithm>
 #include <iterator>
 #include <deque>
+#include <memory>
 
 
 /****************************************************************************
@@ -60,7 +61,11 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 
 #include <AsyncConfig.h>
 #include <AsyncAudioSource.h>
+#include <AsyncAudioPassthrough.h>
+#include <AsyncApplication.h>
 #include <AsyncTcpClient.h>
+#include <AsyncWorkerPool.h>
+#include <AsyncSimd.h>
 
 
 /****************************************************************************
@@ -72,6 +77,8 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 #include "Ddr.h"
 #include "WbRxRtlSdr.h"
 #include "DdrFilterCoeffs.h"
+#include "PfbChannelizer.h"
+#include "DdrFirKernels.h"
 
 
 /****************************************************************************
@@ -101,23 +108,64 @@ using namespace Async;
  ****************************************************************************/
 
 namespace {
+    /**
+     * Split samples into separate real and imaginary arrays and merge them
+     * back again. For real samples, only the real array is used.
+     */
+  template <class T> struct SampleSplit;
+
+  template <>
+  struct SampleSplit<float>
+  {
+    static const bool is_complex = false;
+    static void split(const vector<float> &in, float *re, float *)
+    {
+      copy(in.begin(), in.end(), re);
+    }
+    static void merge(vector<float> &out, const float *re, const float *,
+                      size_t cnt)
+    {
+      out.assign(re, re + cnt);
+    }
+  };
+
+  template <>
+  struct SampleSplit<complex<float> >
+  {
+    static const bool is_complex = true;
+    static void split(const vector<complex<float> > &in, float *re,
+                      float *im)
+    {
+      for (size_t i=0; i<in.size(); ++i)
+      {
+        re[i] = in[i].real();
+        im[i] = in[i].imag();
+      }
+    }
+    static void merge(vector<complex<float> > &out, const float *re,
+                      const float *im, size_t cnt)
+    {
+      out.clear();
+      out.reserve(cnt);
+      for (size_t i=0; i<cnt; ++i)
+      {
+        out.push_back(complex<float>(re[i], im[i]));
+      }
+    }
+  };
+
   template <class T>
   class Decimator
   {
     public:
-      Decimator(void) : dec_fact(0), p_Z(0), taps(0) {}
+      Decimator(void) : dec_fact(0), taps(0), symmetric(false) {}
 
       Decimator(int dec_fact, const float *coeff, int taps)
-        : dec_fact(dec_fact), p_Z(0), taps(taps)
+        : dec_fact(dec_fact), taps(taps), symmetric(false)
       {
         setDecimatorParams(dec_fact, coeff, taps);
       }
 
-      ~Decimator(void)
-      {
-        delete [] p_Z;
-      }
-
       int decFact(void) const { return dec_fact; }
 
       void setDecimatorParams(int dec_fact, const float *coeff, int taps)
@@ -126,63 +174,130 @@ namespace {
 
         set_coeff.assign(coeff, coeff + taps);
         this->dec_fact = dec_fact;
-        this->coeff = set_coeff;
         this->taps = taps;
 
-        delete [] p_Z;
-        p_Z = new T[taps]();
+          // Most of the filters used are linear phase lowpass filters with
+          // symmetric coefficients. For those, each coefficient only have to
+          // be multiplied once for each pair of samples.
+        symmetric = equal(set_coeff.begin(), set_coeff.end(),
+                          set_coeff.rbegin());
+        updateCoeff(1.0f);
+
+          // The delay line is kept at the beginning of the sample buffers
+        buf_re.assign(taps - 1, 0.0f);
+        buf_im.assign(SampleSplit<T>::is_complex ? taps - 1 : 0, 0.0f);
       }
 
       void setGain(double gain_adjust)
       {
-        coeff = set_coeff;
-        for (vector<float>::iterator it=coeff.begin(); it!=coeff.end(); ++it)
-        {
-          *it *= pow(10.0, gain_adjust / 20.0);
-        }
+        updateCoeff(pow(10.0, gain_adjust / 20.0));
       }
 
       void decimate(vector<T> &out, const vector<T> &in)
       {
-        int orig_count = in.size();
-
           // this implementation assumes in.size() is a multiple of factor_M
         assert(in.size() % dec_fact == 0);
 
-        int num_out = 0;
-        typename vector<T>::const_iterator src = in.begin();
-        out.clear();
-        out.reserve(in.size() / dec_fact);
-        while (src != in.end())
+        const bool is_complex = SampleSplit<T>::is_complex;
+        const size_t hist = taps - 1;
+        const size_t out_cnt = in.size() / dec_fact;
+
+          // Append the new samples to the delay line in split real/imag
+          // format so that the filter kernels can work on contiguous arrays
+          // of floats
+        buf_re.resize(hist + in.size());
+        if (is_complex)
         {
-            // shift Z delay line up to make room for next samples
-          memmove(p_Z + dec_fact, p_Z, (taps - dec_fact) * sizeof(T));
+          buf_im.resize(hist + in.size());
+        }
+        SampleSplit<T>::split(in, &buf_re[hist],
+                              is_complex ? &buf_im[hist] : 0);
 
-            // copy next samples from input buffer to bottom of Z delay line
-          for (int tap = dec_fact - 1; tap >= 0; tap--)
+        out_re.resize(out_cnt);
+        out_im.resize(is_complex ? out_cnt : 0);
+        if (out_cnt > 0)
+        {
+          const size_t start = dec_fact - 1;
+          if (symmetric)
           {
-            assert(src != in.end());
-            p_Z[tap] = *src++;
+            const size_t rev_start = in.size() - dec_fact;
+            rev_re.assign(buf_re.rbegin(), buf_re.rend());
+            if (is_complex)
+            {
+              rev_im.assign(buf_im.rbegin(), buf_im.rend());
+              DdrFirKernels::firDecimateSym(&coeff[0], coeff.size(),
+                  &buf_re[start], &buf_im[start],
+                  &rev_re[rev_start], &rev_im[rev_start],
+                  out_cnt, dec_fact, &out_re[0], &out_im[0]);
+            }
+            else
+            {
+              DdrFirKernels::firDecimateSym(&coeff[0], coeff.size(),
+                  &buf_re[start], &rev_re[rev_start], out_cnt, dec_fact,
+                  &out_re[0]);
+            }
           }
-
-            // calculate FIR sum
-          T sum(0);
-          for (int tap = 0; tap < taps; tap++)
+          else
           {
-            sum += coeff[tap] * p_Z[tap];
+            if (is_complex)
+            {
+              DdrFirKernels::firDecimate(&coeff[0], coeff.size(),
+                  &buf_re[start], &buf_im[start], out_cnt, dec_fact,
+                  &out_re[0], &out_im[0]);
+            }
+            else
+            {
+              DdrFirKernels::firDecimate(&coeff[0], coeff.size(),
+                  &buf_re[start], out_cnt, dec_fact, &out_re[0]);
+            }
           }
-          out.push_back(sum);     /* store sum */
-          num_out++;
         }
-        assert(num_out == orig_count / dec_fact);
+        SampleSplit<T>::merge(out, &out_re[0],
+                              is_complex ? &out_im[0] : 0, out_cnt);
+
+          // Keep the last samples as the delay line for the next call
+        copy(buf_re.end() - hist, buf_re.end(), buf_re.begin());
+        buf_re.resize(hist);
+        if (is_complex)
+        {
+          copy(buf_im.end() - hist, buf_im.end(), buf_im.begin());
+          buf_im.resize(hist);
+        }
       }
 
     private:
       int             dec_fact;
-      T               *p_Z;
       int             taps;
+      bool            symmetric;
       vector<float>   set_coeff;
       vector<float>   coeff;
+      vector<float>   buf_re;
+      vector<float>   buf_im;
+      vector<float>   rev_re;
+      vector<float>   rev_im;
+      vector<float>   out_re;
+      vector<float>   out_im;
+
+        // The filter kernels want the coefficients in reverse order, that is
+        // the coefficient for the oldest sample first. For symmetric filters
+        // only the first half is used and the middle coefficient, if any, is
+        // halved since the middle sample is added twice.
+      void updateCoeff(float gain)
+      {
+        coeff.assign(set_coeff.rbegin(), set_coeff.rend());
+        for (vector<float>::iterator it=coeff.begin(); it!=coeff.end(); ++it)
+        {
+          *it *= gain;
+        }
+        if (symmetric)
+        {
+          coeff.resize((taps + 1) / 2);
+          if (taps % 2 == 1)
+          {
+            coeff.back() *= 0.5f;
+          }
+        }
+      }
   };
 
   template <class T>
@@ -333,13 +448,25 @@ namespace {
   {
     public:
       Translate(unsigned samp_rate, int offset)
-        : samp_rate(samp_rate), n(0)
+        : samp_rate(samp_rate), offset(0), n(0)
       {
         setOffset(offset);
       }
 
+        // The new table start at the phase where the old one was left so
+        // that retuning does not cause a phase jump in the output
       void setOffset(int offset)
       {
+        if ((offset == this->offset) && (offset != 0) && !exp_lut.empty())
+        {
+          return;
+        }
+        complex<float> phase(1.0f, 0.0f);
+        if (!exp_lut.empty())
+        {
+          phase = exp_lut[n];
+        }
+        this->offset = offset;
         n = 0;
         exp_lut.clear();
         if (offset == 0)
@@ -352,22 +479,32 @@ namespace {
         for (unsigned i=0; i<N; ++i)
         {
           complex<float> e(0.0f, -2.0*M_PI*offset*i/samp_rate);
-          exp_lut[i] = exp(e);
+          exp_lut[i] = phase * exp(e);
         }
       }
 
+      bool isShifting(void) const { return !exp_lut.empty(); }
+
       void iq_received(vector<WbRxRtlSdr::Sample> &out,
                        const vector<WbRxRtlSdr::Sample> &in)
       {
         if (exp_lut.size() > 0)
         {
-          out.clear();
-          out.reserve(in.size());
-          vector<WbRxRtlSdr::Sample>::const_iterator it;
-          for (it = in.begin(); it != in.end(); ++it)
+            // std::complex<float> is guaranteed to be stored as two floats
+            // so the samples can be multiplied as interleaved complex
+            // samples, in chunks up to where the table wrap around
+          out.resize(in.size());
+          size_t i = 0;
+          while (i < in.size())
           {
-            out.push_back(*it * exp_lut[n]);
-            if (++n == exp_lut.size())
+            const size_t cnt = std::min(in.size() - i, exp_lut.size() - n);
+            Simd::complexMultiply(
+                reinterpret_cast<float*>(&out[i]),
+                reinterpret_cast<const float*>(&in[i]),
+                reinterpret_cast<const float*>(&exp_lut[n]), cnt);
+            i += cnt;
+            n += cnt;
+            if (n == exp_lut.size())
             {
               n = 0;
             }
@@ -381,6 +518,7 @@ namespace {
 
     private:
       unsigned samp_rate;
+      int offset;
       vector<complex<float> > exp_lut;
       unsigned n;
 
@@ -471,9 +609,20 @@ namespace {
   class Demodulator : public Async::AudioSource
   {
     public:
+      Demodulator(void) : audio_buf(0) {}
       virtual ~Demodulator(void) {}
 
-      virtual void iq_received(vector<WbRxRtlSdr::Sample> samples) = 0;
+      virtual void iq_received(const vector<WbRxRtlSdr::Sample>& samples) = 0;
+
+        // When a buffer is set, the demodulated audio is appended to it
+        // instead of being written to the sink. That is used when
+        // demodulating in a worker thread.
+      void setAudioBuffer(vector<float> *buf) { audio_buf = buf; }
+
+      void writeAudio(const vector<float>& audio)
+      {
+        sinkWriteSamples(audio.data(), audio.size());
+      }
 
       /**
        * @brief Resume audio output to the sink
@@ -496,6 +645,21 @@ namespace {
        * This function is normally only called from a connected sink object.
        */
       virtual void allSamplesFlushed(void) { }
+
+      void outputAudio(const float *samples, int count)
+      {
+        if (audio_buf != 0)
+        {
+          audio_buf->insert(audio_buf->end(), samples, samples + count);
+        }
+        else
+        {
+          sinkWriteSamples(samples, count);
+        }
+      }
+
+    private:
+      vector<float> *audio_buf;
   };
 
 
@@ -503,43 +667,36 @@ namespace {
   {
     public:
       DemodulatorFm(unsigned samp_rate, double max_dev)
-        : iold(1.0f), qold(1.0f),
+        : fast_discr(false), prev(1.0f, 1.0f),
+          audio_dec_160k(5, coeff_dec_160k_32k, coeff_dec_160k_32k_cnt),
+          audio_dec_192k(6, coeff_dec_192k_32k, coeff_dec_192k_32k_cnt),
           audio_dec(2, coeff_dec_audio_32k_16k, coeff_dec_audio_32k_16k_cnt),
-          dec(0)
+          dec_32k(audio_dec), dec_160k(audio_dec_160k, audio_dec),
+          dec_192k(audio_dec_192k, audio_dec), dec(0)
       {
         setDemodParams(samp_rate, max_dev);
       }
 
-      ~DemodulatorFm(void)
-      {
-        delete dec;
-        dec = 0;
-      }
-
+        // All decimator chains are set up on construction so changing the
+        // parameters never allocate memory. The discriminator state is kept.
       void setDemodParams(unsigned samp_rate, double max_dev)
       {
-        delete dec;
         dec = 0;
-
         if (samp_rate == 16000)
         {
-          dec = new DecimatorMS0<float>;
+          dec = &dec_16k;
         }
         else if (samp_rate == 32000)
         {
-          dec = new DecimatorMS1<float>(audio_dec);
+          dec = &dec_32k;
         }
         else if (samp_rate == 160000)
         {
-          audio_dec_wb.setDecimatorParams(5, coeff_dec_160k_32k, 
-                                          coeff_dec_160k_32k_cnt);
-          dec = new DecimatorMS2<float>(audio_dec_wb, audio_dec);
+          dec = &dec_160k;
         }
         else if (samp_rate == 192000)
         {
-          audio_dec_wb.setDecimatorParams(6, coeff_dec_192k_32k, 
-                                          coeff_dec_192k_32k_cnt);
-          dec = new DecimatorMS2<float>(audio_dec_wb, audio_dec);
+          dec = &dec_192k;
         }
 
         assert((dec != 0) &&
@@ -553,41 +710,45 @@ namespace {
         dec->setGain(adj_db);
       }
 
-      void iq_received(vector<WbRxRtlSdr::Sample> samples)
+        // Use a polynomial atan2 approximation instead of the libm
+        // function. The maximum error is about 1e-5 radians, which is
+        // far below the noise floor of the demodulated audio.
+      void setFastDiscriminator(bool enable) { fast_discr = enable; }
+
+      void iq_received(const vector<WbRxRtlSdr::Sample>& samples)
       {
-          // From article-sdr-is-qs.pdf: Watch your Is and Qs:
-          //   FM = (Qn.In-1 - In.Qn-1)/(In.In-1 + Qn.Qn-1)
-          //
-          // A more indepth report:
-          //   Implementation of FM demodulator algorithms on a
-          //   high performance digital signal processor
-        vector<float> audio;
-        for (size_t idx=0; idx<samples.size(); ++idx)
+        const size_t cnt = samples.size();
+        discr_audio.resize(cnt);
+        if (fast_discr)
         {
-          complex<float> samp = samples[idx];
-
-            // Normalize signal amplitude
-          samp = samp / abs(samp);
-
-            // Mixed demodulator (delay demodulator + phase adapter demodulator)
-          float i = samp.real();
-          float q = samp.imag();
-          double demod = atan2(q*iold - i*qold, i*iold + q*qold);
-          iold = i;
-          qold = q;
-
-          audio.push_back(demod);
+          discr_re.resize(cnt);
+          discr_im.resize(cnt);
+          DdrFirKernels::fmDiscriminatorFast(samples.data(), cnt, prev,
+              discr_re.data(), discr_im.data(), discr_audio.data());
         }
-        vector<float> dec_audio;
-        dec->decimate(dec_audio, audio);
-        sinkWriteSamples(&dec_audio[0], dec_audio.size());
+        else
+        {
+          DdrFirKernels::fmDiscriminator(samples.data(), cnt, prev,
+                                         discr_audio.data());
+        }
+        dec->decimate(discr_dec_audio, discr_audio);
+        outputAudio(discr_dec_audio.data(), discr_dec_audio.size());
       }
 
     private:
-      float iold;
-      float qold;
-      Decimator<float> audio_dec_wb;
+      bool fast_discr;
+      complex<float> prev;
+      vector<float> discr_re;
+      vector<float> discr_im;
+      vector<float> discr_audio;
+      vector<float> discr_dec_audio;
+      Decimator<float> audio_dec_160k;
+      Decimator<float> audio_dec_192k;
       Decimator<float> audio_dec;
+      DecimatorMS0<float> dec_16k;
+      DecimatorMS1<float> dec_32k;
+      DecimatorMS2<float> dec_160k;
+      DecimatorMS2<float> dec_192k;
       DecimatorMS<float> *dec;
   };
 
@@ -602,7 +763,7 @@ namespace {
         agc.setReference(1);
       }
 
-      void iq_received(vector<WbRxRtlSdr::Sample> samples)
+      void iq_received(const vector<WbRxRtlSdr::Sample>& samples)
       {
         vector<WbRxRtlSdr::Sample> gain_adjusted;
         agc.iq_received(gain_adjusted, samples);
@@ -614,7 +775,7 @@ namespace {
           float demod = abs(samp);
           audio.push_back(demod);
         }
-        sinkWriteSamples(&audio[0], audio.size());
+        outputAudio(&audio[0], audio.size());
       }
 
     private:
@@ -639,7 +800,7 @@ namespace {
         use_lsb = use;
       }
 
-      void iq_received(vector<WbRxRtlSdr::Sample> samples)
+      void iq_received(const vector<WbRxRtlSdr::Sample>& samples)
       {
         vector<float> Q, Qh, audio;
         Q.reserve(samples.size());
@@ -666,7 +827,7 @@ namespace {
           audio.push_back(demod);
         }
         I.erase(I.begin(), I.begin() + Qh.size());
-        sinkWriteSamples(&audio[0], audio.size());
+        outputAudio(&audio[0], audio.size());
       }
 
     private:
@@ -690,7 +851,7 @@ namespace {
         trans.setOffset(lsb ? 2000 : -2000);
       }
 
-      void iq_received(vector<WbRxRtlSdr::Sample> samples)
+      void iq_received(const vector<WbRxRtlSdr::Sample>& samples)
       {
         vector<WbRxRtlSdr::Sample> gain_adjusted;
         agc.iq_received(gain_adjusted, samples);
@@ -707,7 +868,7 @@ namespace {
           float demod = it->real();
           audio.push_back(demod);
         }
-        sinkWriteSamples(&audio[0], audio.size());
+        outputAudio(&audio[0], audio.size());
       }
 
     private:
@@ -728,7 +889,7 @@ namespace {
         agc.setReference(0.05);
       }
 
-      void iq_received(vector<WbRxRtlSdr::Sample> samples)
+      void iq_received(const vector<WbRxRtlSdr::Sample>& samples)
       {
         vector<WbRxRtlSdr::Sample> gain_adjusted;
         agc.iq_received(gain_adjusted, samples);
@@ -744,7 +905,7 @@ namespace {
           float demod = it->real();
           audio.push_back(demod);
         }
-        sinkWriteSamples(&audio[0], audio.size());
+        outputAudio(&audio[0], audio.size());
       }
 
     private:
@@ -766,8 +927,6 @@ namespace {
       virtual unsigned chSampRate(void) const = 0;
       virtual void iq_received(vector<WbRxRtlSdr::Sample> &out,
                                const vector<WbRxRtlSdr::Sample> &in) = 0;
-
-      sigc::signal<void(const std::vector<RtlTcp::Sample>&)> preDemod;
   };
 
   class Channelizer960 : public Channelizer
@@ -784,55 +943,30 @@ namespace {
           ch_filt_6k(   1, coeff_nbam_channel,  coeff_nbam_channel_cnt ),
           ch_filt_3k(   1, coeff_ssb_channel,   coeff_ssb_channel_cnt  ),
           ch_filt_500(  1, coeff_cw_channel,    coeff_cw_channel_cnt   ),
+          dec_wide(dec_960k_192k),
+          dec_20k( dec_960k_192k, dec_192k_64k, dec_64k_32k, ch_filt),
+          dec_10k( dec_960k_192k, dec_192k_48k, dec_48k_16k, ch_filt_narr),
+          dec_6k(  dec_960k_192k, dec_192k_48k, dec_48k_16k, ch_filt_6k),
+          dec_3k(  dec_960k_192k, dec_192k_48k, dec_48k_16k, ch_filt_3k),
+          dec_500( dec_960k_192k, dec_192k_48k, dec_48k_16k, ch_filt_500),
           dec(0)
       {
         setBw(BW_20K);
       }
-      virtual ~Channelizer960(void)
-      {
-        delete dec;
-        dec = 0;
-      }
 
+        // The decimator chains are all set up on construction so changing
+        // the bandwidth is just a matter of selecting another chain. The
+        // first decimation stage is shared so its state is kept.
       virtual void setBw(Bandwidth bw)
       {
-        delete dec;
-        dec = 0;
         switch (bw)
         {
-          case BW_WIDE:
-            dec = new DecimatorMS1<complex<float> >(dec_960k_192k);
-            return;
-          case BW_20K:
-            dec = new DecimatorMS4<complex<float> >(dec_960k_192k,
-                                                    dec_192k_64k,
-                                                    dec_64k_32k, 
-                                                    ch_filt);
-            return;
-          case BW_10K:
-            dec = new DecimatorMS4<complex<float> >(dec_960k_192k,
-                                                    dec_192k_48k,
-                                                    dec_48k_16k,
-                                                    ch_filt_narr);
-            return;
-          case BW_6K:
-            dec = new DecimatorMS4<complex<float> >(dec_960k_192k,
-                                                    dec_192k_48k,
-                                                    dec_48k_16k,
-                                                    ch_filt_6k);
-            return;
-          case BW_3K:
-            dec = new DecimatorMS4<complex<float> >(dec_960k_192k,
-                                                    dec_192k_48k,
-                                                    dec_48k_16k,
-                                                    ch_filt_3k);
-            return;
-          case BW_500:
-            dec = new DecimatorMS4<complex<float> >(dec_960k_192k,
-                                                    dec_192k_48k,
-                                                    dec_48k_16k,
-                                                    ch_filt_500);
-            return;
+          case BW_WIDE: dec = &dec_wide;  return;
+          case BW_20K:  dec = &dec_20k;   return;
+          case BW_10K:  dec = &dec_10k;   return;
+          case BW_6K:   dec = &dec_6k;    return;
+          case BW_3K:   dec = &dec_3k;    return;
+          case BW_500:  dec = &dec_500;   return;
         }
         assert(!"Channelizer::setBw: Unknown bandwidth");
       }
@@ -846,7 +980,6 @@ namespace {
                                const vector<WbRxRtlSdr::Sample> &in)
       {
         dec->decimate(out, in);
-        preDemod(out);
       }
 
     private:
@@ -860,6 +993,12 @@ namespace {
       Decimator<complex<float> >    ch_filt_6k;
       Decimator<complex<float> >    ch_filt_3k;
       Decimator<complex<float> >    ch_filt_500;
+      DecimatorMS1<complex<float> > dec_wide;
+      DecimatorMS4<complex<float> > dec_20k;
+      DecimatorMS4<complex<float> > dec_10k;
+      DecimatorMS4<complex<float> > dec_6k;
+      DecimatorMS4<complex<float> > dec_3k;
+      DecimatorMS4<complex<float> > dec_500;
       DecimatorMS<complex<float> >  *dec;
   };
 
@@ -876,61 +1015,31 @@ namespace {
           ch_filt_6k    (1, coeff_nbam_channel,   coeff_nbam_channel_cnt  ),
           ch_filt_3k    (1, coeff_ssb_channel,    coeff_ssb_channel_cnt   ),
           ch_filt_500   (1, coeff_cw_channel,     coeff_cw_channel_cnt    ),
+          dec_wide(dec_2400k_800k, dec_800k_160k),
+          dec_20k (dec_2400k_800k, dec_800k_160k, dec_160k_32k, ch_filt),
+          dec_10k (dec_2400k_800k, dec_800k_160k, dec_160k_32k, dec_32k_16k,
+                   ch_filt_narr),
+          dec_6k  (dec_2400k_800k, dec_800k_160k, dec_160k_32k, dec_32k_16k,
+                   ch_filt_6k),
+          dec_3k  (dec_2400k_800k, dec_800k_160k, dec_160k_32k, dec_32k_16k,
+                   ch_filt_3k),
+          dec_500 (dec_2400k_800k, dec_800k_160k, dec_160k_32k, dec_32k_16k,
+                   ch_filt_500),
           dec(0)
       {
         setBw(BW_20K);
       }
-      virtual ~Channelizer2400(void)
-      {
-        delete dec;
-        dec = 0;
-      }
 
       virtual void setBw(Bandwidth bw)
       {
-        delete dec;
-        dec = 0;
-
         switch (bw)
         {
-          case BW_WIDE:
-            dec = new DecimatorMS2<complex<float> >(dec_2400k_800k,
-                                                    dec_800k_160k);
-            return;
-          case BW_20K:
-            dec = new DecimatorMS4<complex<float> >(dec_2400k_800k,
-                                                    dec_800k_160k,
-                                                    dec_160k_32k, 
-                                                    ch_filt);
-            return;
-          case BW_10K:
-            dec = new DecimatorMS5<complex<float> >(dec_2400k_800k,
-                                                    dec_800k_160k,
-                                                    dec_160k_32k, 
-                                                    dec_32k_16k,
-                                                    ch_filt_narr);
-            return;
-          case BW_6K:
-            dec = new DecimatorMS5<complex<float> >(dec_2400k_800k,
-                                                    dec_800k_160k,
-                                                    dec_160k_32k, 
-                                                    dec_32k_16k,
-                                                    ch_filt_6k);
-            return;
-          case BW_3K:
-            dec = new DecimatorMS5<complex<float> >(dec_2400k_800k,
-                                                    dec_800k_160k,
-                                                    dec_160k_32k,
-                                                    dec_32k_16k,
-                                                    ch_filt_3k);
-            return;
-          case BW_500:
-            dec = new DecimatorMS5<complex<float> >(dec_2400k_800k,
-                                                    dec_800k_160k,
-                                                    dec_160k_32k,
-                                                    dec_32k_16k,
-                                                    ch_filt_500);
-            return;
+          case BW_WIDE: dec = &dec_wide;  return;
+          case BW_20K:  dec = &dec_20k;   return;
+          case BW_10K:  dec = &dec_10k;   return;
+          case BW_6K:   dec = &dec_6k;    return;
+          case BW_3K:   dec = &dec_3k;    return;
+          case BW_500:  dec = &dec_500;   return;
         }
         assert(!"Channelizer::setBw: Unknown bandwidth");
       }
@@ -944,7 +1053,6 @@ namespace {
                                const vector<WbRxRtlSdr::Sample> &in)
       {
         dec->decimate(out, in);
-        preDemod(out);
       }
 
     private:
@@ -957,37 +1065,149 @@ namespace {
       Decimator<complex<float> >    ch_filt_6k;
       Decimator<complex<float> >    ch_filt_3k;
       Decimator<complex<float> >    ch_filt_500;
+      DecimatorMS2<complex<float> > dec_wide;
+      DecimatorMS4<complex<float> > dec_20k;
+      DecimatorMS5<complex<float> > dec_10k;
+      DecimatorMS5<complex<float> > dec_6k;
+      DecimatorMS5<complex<float> > dec_3k;
+      DecimatorMS5<complex<float> > dec_500;
       DecimatorMS<complex<float> >  *dec;
   };
 
+    /**
+     * A channelizer working on the output of one PfbChannelizer bin. Since
+     * the bin sampling rate is low, only a few short filters are needed.
+     * Wideband modulations can not be handled since their bandwidth is wider
+     * than the bins.
+     */
+  class ChannelizerPfb : public Channelizer
+  {
+    public:
+      ChannelizerPfb(unsigned bin_samp_rate)
+        : bin_samp_rate(bin_samp_rate),
+          dec_32k_16k (2, coeff_dec_32k_16k,    coeff_dec_32k_16k_cnt   ),
+          ch_filt     (1, coeff_25k_channel,    coeff_25k_channel_cnt   ),
+          ch_filt_narr(1, coeff_12k5_channel,   coeff_12k5_channel_cnt  ),
+          ch_filt_6k  (1, coeff_nbam_channel,   coeff_nbam_channel_cnt  ),
+          ch_filt_3k  (1, coeff_ssb_channel,    coeff_ssb_channel_cnt   ),
+          ch_filt_500 (1, coeff_cw_channel,     coeff_cw_channel_cnt    ),
+          dec_20k (dec_bin_32k, ch_filt),
+          dec_10k (dec_bin_32k, dec_32k_16k, ch_filt_narr),
+          dec_6k  (dec_bin_32k, dec_32k_16k, ch_filt_6k),
+          dec_3k  (dec_bin_32k, dec_32k_16k, ch_filt_3k),
+          dec_500 (dec_bin_32k, dec_32k_16k, ch_filt_500),
+          dec(0)
+      {
+        if (bin_samp_rate == 96000)
+        {
+          dec_bin_32k.setDecimatorParams(3, coeff_dec_96k_32k,
+                                         coeff_dec_96k_32k_cnt);
+        }
+        else
+        {
+          assert(bin_samp_rate == 64000);
+          dec_bin_32k.setDecimatorParams(2, coeff_dec_64k_32k,
+                                         coeff_dec_64k_32k_cnt);
+        }
+        setBw(BW_20K);
+      }
+
+      virtual void setBw(Bandwidth bw)
+      {
+        switch (bw)
+        {
+          case BW_WIDE: break;
+          case BW_20K:  dec = &dec_20k;   return;
+          case BW_10K:  dec = &dec_10k;   return;
+          case BW_6K:   dec = &dec_6k;    return;
+          case BW_3K:   dec = &dec_3k;    return;
+          case BW_500:  dec = &dec_500;   return;
+        }
+        assert(!"ChannelizerPfb::setBw: Unsupported bandwidth");
+      }
+
+      virtual unsigned chSampRate(void) const
+      {
+        return bin_samp_rate / dec->decFact();
+      }
+
+      virtual void iq_received(vector<WbRxRtlSdr::Sample> &out,
+                               const vector<WbRxRtlSdr::Sample> &in)
+      {
+          // The decimators require the block size to be a multiple of the
+          // decimation factor, which the bin output is not guaranteed to be
+        pending.insert(pending.end(), in.begin(), in.end());
+        size_t cnt = pending.size() - pending.size() % dec->decFact();
+        if (cnt == 0)
+        {
+          out.clear();
+          return;
+        }
+        vector<WbRxRtlSdr::Sample> block(pending.begin(),
+                                         pending.begin() + cnt);
+        pending.erase(pending.begin(), pending.begin() + cnt);
+        dec->decimate(out, block);
+      }
+
+    private:
+      unsigned                      bin_samp_rate;
+      Decimator<complex<float> >    dec_bin_32k;
+      Decimator<complex<float> >    dec_32k_16k;
+      Decimator<complex<float> >    ch_filt;
+      Decimator<complex<float> >    ch_filt_narr;
+      Decimator<complex<float> >    ch_filt_6k;
+      Decimator<complex<float> >    ch_filt_3k;
+      Decimator<complex<float> >    ch_filt_500;
+      DecimatorMS2<complex<float> > dec_20k;
+      DecimatorMS3<complex<float> > dec_10k;
+      DecimatorMS3<complex<float> > dec_6k;
+      DecimatorMS3<complex<float> > dec_3k;
+      DecimatorMS3<complex<float> > dec_500;
+      DecimatorMS<complex<float> >  *dec;
+      vector<WbRxRtlSdr::Sample>    pending;
+  };
+
 }; /* anonymous namespace */
 
 
 class Ddr::Channel : public sigc::trackable, public Async::AudioSource
 {
   public:
-    Channel(int fq_offset, unsigned sample_rate)
-      : sample_rate(sample_rate), channelizer(0),
-        fm_demod(32000, 5000.0), ssb_demod(16000), cw_demod(16000), demod(0),
-        trans(sample_rate, fq_offset), enabled(true), ch_offset(0),
-        fq_offset(fq_offset)
+    Channel(WbRxRtlSdr *rtl, int fq_offset)
+      : rtl(rtl), sample_rate(rtl->sampleRate()), wb_channelizer(0),
+        bin_channelizer(0), channelizer(0), pfb(rtl->channelizer()), pfb_bin(0),
+        use_pfb(false), con_bin(-1), fm_demod(32000, 5000.0),
+        ssb_demod(16000), cw_demod(16000), demod(0),
+        mod(Modulation::MOD_UNKNOWN), trans(sample_rate, 0),
+        bin_trans((pfb != 0) ? pfb->binSampRate() : sample_rate, 0),
+        enabled(true), ch_offset(0), fq_offset(fq_offset),
+        pool(rtl->workerPool()), busy(false), pending_is_bin(false),
+        drop_cnt(0)
     {
     }
 
     ~Channel(void)
     {
-      delete channelizer;
+      iq_con.disconnect();
+      if (work != 0)
+      {
+          // The completion function may still be queued in the main loop
+        work->alive = false;
+      }
+      waitForWorker();
+      delete wb_channelizer;
+      delete bin_channelizer;
     }
 
     bool initialize(void)
     {
       if (sample_rate == 2400000)
       {
-        channelizer = new Channelizer2400;
+        wb_channelizer = new Channelizer2400;
       }
       else if (sample_rate == 960000)
       {
-        channelizer = new Channelizer960;
+        wb_channelizer = new Channelizer960;
       }
       else
       {
@@ -995,21 +1215,60 @@ class Ddr::Channel : public sigc::trackable, public Async::AudioSource
              << ". Legal values are: 960000 and 2400000\n";
         return false;
       }
+      if (pfb != 0)
+      {
+        bin_channelizer = new ChannelizerPfb(pfb->binSampRate());
+      }
+      if (pool != 0)
+      {
+        work = std::make_shared<Work>();
+        fm_demod.setAudioBuffer(&work->audio);
+        am_demod.setAudioBuffer(&work->audio);
+        ssb_demod.setAudioBuffer(&work->audio);
+        cw_demod.setAudioBuffer(&work->audio);
+      }
       setModulation(Modulation::MOD_FM);
-      channelizer->preDemod.connect(preDemod.make_slot());
       return true;
     }
 
+      // Retuning within the tuner passband only change the frequency
+      // translation, and possibly the channelizer bin, so it is cheap
+      // enough to be used when scanning
     void setFqOffset(int fq_offset)
     {
+      waitForWorker();
       this->fq_offset = fq_offset;
-      trans.setOffset(fq_offset - ch_offset);
+      if (use_pfb)
+      {
+        int residual = 0;
+        pfb_bin = pfb->findBin(fq_offset - ch_offset, residual);
+        bin_trans.setOffset(residual);
+        trans.setOffset(0);
+      }
+      else
+      {
+        trans.setOffset(fq_offset - ch_offset);
+        bin_trans.setOffset(0);
+      }
+      connectInput();
     }
 
     void setModulation(Modulation::Type mod)
     {
+      if (mod == this->mod)
+      {
+        return;
+      }
+      waitForWorker();
+      this->mod = mod;
       demod = 0;
       ch_offset = 0;
+
+        // Wideband FM does not fit in a channelizer bin so the full rate
+        // signal have to be used for that
+      use_pfb = (bin_channelizer != 0) && (mod != Modulation::MOD_WBFM);
+      channelizer = use_pfb ? bin_channelizer : wb_channelizer;
+
       switch (mod)
       {
         case Modulation::MOD_FM:
@@ -1076,25 +1335,53 @@ class Ddr::Channel : public sigc::trackable, public Async::AudioSource
       return channelizer->chSampRate();
     }
 
-    void iq_received(vector<WbRxRtlSdr::Sample> samples)
+    void setFastFmDiscriminator(bool enable)
+    {
+      waitForWorker();
+      fm_demod.setFastDiscriminator(enable);
+    }
+
+    void iq_received(const vector<WbRxRtlSdr::Sample>& samples)
     {
       if (enabled)
       {
-        vector<WbRxRtlSdr::Sample> translated, channelized;
-        trans.iq_received(translated, samples);
-        channelizer->iq_received(channelized, translated);
-        demod->iq_received(channelized);
+        if (pool != 0)
+        {
+          queueWork(samples, false);
+        }
+        else
+        {
+          process(samples, false);
+        }
       }
     };
 
+    void bin_received(const vector<WbRxRtlSdr::Sample>& samples)
+    {
+      if (enabled)
+      {
+        if (pool != 0)
+        {
+          queueWork(samples, true);
+        }
+        else
+        {
+          process(samples, true);
+        }
+      }
+    }
+
     void enable(void)
     {
       enabled = true;
+      connectInput();
     }
 
     void disable(void)
     {
       enabled = false;
+      pending.clear();
+      connectInput();
     }
 
     bool isEnabled(void) const { return enabled; }
@@ -1102,17 +1389,189 @@ class Ddr::Channel : public sigc::trackable, public Async::AudioSource
     sigc::signal<void(const std::vector<RtlTcp::Sample>&)> preDemod;
 
   private:
+      // The state shared with a job running in a worker thread. While a job
+      // is running, only the worker thread may touch it, except for the
+      // alive flag which is only used in the main thread.
+    struct Work
+    {
+      vector<WbRxRtlSdr::Sample>  in;
+      bool                        is_bin = false;
+      bool                        want_pre_demod = false;
+      vector<float>               audio;
+      vector<WbRxRtlSdr::Sample>  pre_demod;
+      bool                        alive = true;
+    };
+
+      // Never buffer more than this many milliseconds of input while
+      // waiting for a worker thread to keep the latency bounded
+    static const unsigned MAX_PENDING_MS = 100;
+
+    WbRxRtlSdr *rtl;
     unsigned sample_rate;
+    Channelizer *wb_channelizer;
+    Channelizer *bin_channelizer;
     Channelizer *channelizer;
+    PfbChannelizer *pfb;
+    unsigned pfb_bin;
+    bool use_pfb;
+    int con_bin;
+    sigc::connection iq_con;
     DemodulatorFm fm_demod;
     DemodulatorAm am_demod;
     DemodulatorSsb ssb_demod;
     DemodulatorCw cw_demod;
     Demodulator *demod;
+    Modulation::Type mod;
     Translate trans;
+    Translate bin_trans;
     bool enabled;
     int ch_offset;
     int fq_offset;
+    vector<WbRxRtlSdr::Sample> translated;
+    vector<WbRxRtlSdr::Sample> channelized;
+    Async::WorkerPool *pool;
+    std::shared_ptr<Work> work;
+    bool busy;
+    vector<WbRxRtlSdr::Sample> pending;
+    bool pending_is_bin;
+    unsigned drop_cnt;
+
+      // Translate, channelize and demodulate a block of samples. When using
+      // a worker pool this is run in a worker thread so it must only touch
+      // the signal processing objects and the work state.
+    void process(const vector<WbRxRtlSdr::Sample>& samples, bool is_bin)
+    {
+      if (is_bin)
+      {
+        bin_trans.iq_received(translated, samples);
+        channelizer->iq_received(channelized, translated);
+      }
+      else
+      {
+          // Without a frequency offset the shared wideband block is fed
+          // directly to the channelizer instead of being copied
+        const vector<WbRxRtlSdr::Sample> *in = &samples;
+        if (trans.isShifting())
+        {
+          trans.iq_received(translated, samples);
+          in = &translated;
+        }
+        channelizer->iq_received(channelized, *in);
+      }
+      if (channelized.empty())
+      {
+        return;
+      }
+      if (work == 0)
+      {
+        preDemod(channelized);
+      }
+      else if (work->want_pre_demod)
+      {
+        work->pre_demod.insert(work->pre_demod.end(),
+                               channelized.begin(), channelized.end());
+      }
+      demod->iq_received(channelized);
+    }
+
+    void queueWork(const vector<WbRxRtlSdr::Sample>& samples, bool is_bin)
+    {
+      if (!pending.empty() && (pending_is_bin != is_bin))
+      {
+        pending.clear();
+      }
+      unsigned rate = is_bin ? pfb->binSampRate() : sample_rate;
+      size_t max_pending = rate / 1000 * MAX_PENDING_MS;
+      if (pending.size() + samples.size() > max_pending)
+      {
+        ++drop_cnt;
+        return;
+      }
+      pending.insert(pending.end(), samples.begin(), samples.end());
+      pending_is_bin = is_bin;
+      if (!busy)
+      {
+        startWork();
+      }
+    }
+
+    void startWork(void)
+    {
+      busy = true;
+      work->in.swap(pending);
+      pending.clear();
+      work->is_bin = pending_is_bin;
+      work->want_pre_demod = !preDemod.empty();
+      work->audio.clear();
+      work->pre_demod.clear();
+      std::shared_ptr<Work> w = work;
+      pool->run(
+          [this, w](void) { process(w->in, w->is_bin); },
+          [this, w](void) { if (w->alive) workDone(); });
+    }
+
+    void workDone(void)
+    {
+      busy = false;
+      if (!work->pre_demod.empty())
+      {
+        preDemod(work->pre_demod);
+      }
+      if (!work->audio.empty())
+      {
+        demod->writeAudio(work->audio);
+      }
+      if (drop_cnt > 0)
+      {
+        cerr << "*** WARNING: The DDR worker threads could not keep up. "
+             << drop_cnt << " sample blocks dropped." << endl;
+        drop_cnt = 0;
+      }
+      if (enabled && !pending.empty())
+      {
+        startWork();
+      }
+    }
+
+      // Wait for a running job to finish before changing any of the signal
+      // processing objects. The completion function will still be called
+      // from the main loop later.
+    void waitForWorker(void)
+    {
+      if ((pool != 0) && busy)
+      {
+        pool->waitForIdle();
+      }
+    }
+
+      // Connect to the wideband signal or to the channelizer bin, depending
+      // on the modulation, or disconnect if disabled. A disabled channel
+      // should not cost anything.
+    void connectInput(void)
+    {
+      if (!enabled)
+      {
+        iq_con.disconnect();
+        return;
+      }
+      int bin = use_pfb ? static_cast<int>(pfb_bin) : -1;
+      if (iq_con.connected() && (bin == con_bin))
+      {
+        return;
+      }
+      iq_con.disconnect();
+      if (use_pfb)
+      {
+        iq_con = pfb->connectBin(pfb_bin,
+            mem_fun(*this, &Channel::bin_received));
+      }
+      else
+      {
+        iq_con = rtl->iqReceived.connect(
+            mem_fun(*this, &Channel::iq_received));
+      }
+      con_bin = bin;
+    }
 }; /* Channel */
 
 
@@ -1160,13 +1619,22 @@ Ddr *Ddr::find(const std::string &name)
 
 Ddr::Ddr(Config &cfg, const std::string& name)
   : LocalRxBase(cfg, name), cfg(cfg), channel(0), rtl(0),
-    fq(0)
+    fq(0), demod_enabled(true), audio_pipe(0), mod(Modulation::MOD_FM),
+    fast_fm_discr(false), rebalance_pending(false)
 {
 } /* Ddr::Ddr */
 
 
 Ddr::~Ddr(void)
 {
+    // The channel must be deleted before the tuner since it may be using
+    // the worker pool owned by the tuner
+  delete channel;
+  channel = 0;
+  delete audio_pipe;
+  audio_pipe = 0;
+
+  ready_con.disconnect();
   if (rtl != 0)
   {
     rtl->unregisterDdr(this);
@@ -1178,8 +1646,6 @@ Ddr::~Ddr(void)
   {
     ddr_map.erase(it);
   }
-
-  delete channel;
 } /* Ddr::~Ddr */
 
 
@@ -1201,49 +1667,51 @@ bool Ddr::initialize(void)
     return false;
   }
   
-  string wbrx;
-  if (!cfg.getValue(name(), "WBRX", wbrx))
+  if (!cfg.getValue(name(), "WBRX", wbrx_names) || wbrx_names.empty())
   {
     cerr << "*** ERROR: Config variable " << name()
          << "/WBRX not set\n";
     return false;
   }
 
-  rtl = WbRxRtlSdr::instance(cfg, wbrx);
-  if (rtl == 0)
+  string modstr("FM");
+  cfg.getValue(name(), "MODULATION", modstr);
+  mod = Modulation::fromString(modstr);
+  if (mod == Modulation::MOD_UNKNOWN)
   {
-    cout << "*** ERROR: Could not create WBRX " << wbrx
+    cout << "*** ERROR: Unknown modulation " << modstr
          << " specified in receiver " << name() << endl;
     return false;
   }
-  rtl->registerDdr(this);
 
-  channel = new Channel(fq-rtl->centerFq(), rtl->sampleRate());
-  if (!channel->initialize())
+  string fm_discr("ATAN2");
+  cfg.getValue(name(), "FM_DISCRIMINATOR", fm_discr);
+  if (fm_discr == "FAST")
   {
-    cout << "*** ERROR: Could not initialize channel object for receiver "
-         << name() << endl;
-    delete channel;
-    channel = 0;
+    fast_fm_discr = true;
+  }
+  else if (fm_discr != "ATAN2")
+  {
+    cout << "*** ERROR: Unknown FM discriminator " << fm_discr
+         << " specified in receiver " << name()
+         << ". Legal values are: ATAN2 and FAST\n";
     return false;
   }
-  channel->preDemod.connect(preDemod.make_slot());
-  rtl->iqReceived.connect(mem_fun(*channel, &Channel::iq_received));
-  rtl->readyStateChanged.connect(readyStateChanged.make_slot());
 
-  string modstr("FM");
-  cfg.getValue(name(), "MODULATION", modstr);
-  Modulation::Type mod = Modulation::fromString(modstr);
-  if (mod != Modulation::MOD_UNKNOWN)
+  rtl = WbRxRtlSdr::select(cfg, wbrx_names, this, 0);
+  if (rtl == 0)
   {
-    channel->setModulation(mod);
+    cout << "*** ERROR: Could not create WBRX " << wbrx_names.front()
+         << " specified in receiver " << name() << endl;
+    return false;
   }
-  else
+  rtl->registerDdr(this);
+
+    // The channel is recreated when moving to another tuner so the rest of
+    // the receiver is connected to a passthrough object instead
+  audio_pipe = new AudioPassthrough;
+  if (!setupChannel())
   {
-    cout << "*** ERROR: Unknown modulation " << modstr
-         << " specified in receiver " << name() << endl;
-    delete channel;
-    channel = 0;
     return false;
   }
 
@@ -1281,6 +1749,10 @@ bool Ddr::isReady(void) const
 void Ddr::setFq(unsigned fq)
 {
   this->fq = fq;
+  if (hasTunerGroup())
+  {
+    rebalance();
+  }
   rtl->updateDdrFq(this);
   updateFqOffset();
 } /* Ddr::setFq */
@@ -1288,6 +1760,7 @@ void Ddr::setFq(unsigned fq)
 
 void Ddr::setModulation(Modulation::Type mod)
 {
+  this->mod = mod;
   channel->setModulation(mod);
 } /* Ddr::setModulation */
 
@@ -1318,10 +1791,28 @@ int Ddr::audioSampleRate(void)
 
 Async::AudioSource *Ddr::audioSource(void)
 {
-  return channel;
+  return audio_pipe;
 } /* Ddr::audioSource */
 
 
+void Ddr::setDemodEnabled(bool enable)
+{
+  demod_enabled = enable;
+  if (channel == 0)
+  {
+    return;
+  }
+  if (enable)
+  {
+    updateFqOffset();
+  }
+  else
+  {
+    channel->disable();
+  }
+} /* Ddr::setDemodEnabled */
+
+
 
 /****************************************************************************
  *
@@ -1339,6 +1830,13 @@ void Ddr::updateFqOffset(void)
   double new_offset = fq - rtl->centerFq();
   if (abs(new_offset) > (rtl->sampleRate() / 2)-12500)
   {
+      // Another tuner in the group may cover the frequency. The move is
+      // deferred since this is called while the tuner iterate over its DDR:s.
+    if (hasTunerGroup() && !rebalance_pending)
+    {
+      rebalance_pending = true;
+      Application::app().runTask(mem_fun(*this, &Ddr::rebalance));
+    }
     if (channel->isEnabled())
     {
       cout << "*** WARNING: Could not fit DDR \"" << name() 
@@ -1349,10 +1847,78 @@ void Ddr::updateFqOffset(void)
     return;
   }
   channel->setFqOffset(new_offset);
-  channel->enable();
+  if (demod_enabled)
+  {
+    channel->enable();
+  }
 } /* Ddr::updateFqOffset */
 
 
+bool Ddr::setupChannel(void)
+{
+  channel = new Channel(rtl, fq-rtl->centerFq());
+  if (!channel->initialize())
+  {
+    cout << "*** ERROR: Could not initialize channel object for receiver "
+         << name() << endl;
+    delete channel;
+    channel = 0;
+    return false;
+  }
+  channel->setModulation(mod);
+  channel->setFastFmDiscriminator(fast_fm_discr);
+  if (!demod_enabled)
+  {
+    channel->disable();
+  }
+  channel->preDemod.connect(preDemod.make_slot());
+  channel->registerSink(audio_pipe);
+  ready_con = rtl->readyStateChanged.connect(readyStateChanged.make_slot());
+  return true;
+} /* Ddr::setupChannel */
+
+
+bool Ddr::moveToTuner(WbRxRtlSdr *new_rtl)
+{
+  cout << name() << ": Moving from tuner " << rtl->name() << " to tuner "
+       << new_rtl->name() << endl;
+
+    // The channel must be deleted before leaving the tuner since it may be
+    // using the worker pool owned by the tuner. The old tuner delete itself
+    // if this was its last DDR.
+  delete channel;
+  channel = 0;
+  ready_con.disconnect();
+  WbRxRtlSdr *old_rtl = rtl;
+  rtl = new_rtl;
+  rtl->registerDdr(this);
+  old_rtl->unregisterDdr(this);
+
+  if (!setupChannel())
+  {
+    return false;
+  }
+  updateFqOffset();
+  readyStateChanged();
+  return true;
+} /* Ddr::moveToTuner */
+
+
+void Ddr::rebalance(void)
+{
+  rebalance_pending = false;
+  if ((channel == 0) || (rtl == 0))
+  {
+    return;
+  }
+  WbRxRtlSdr *best = WbRxRtlSdr::select(cfg, wbrx_names, this, rtl);
+  if ((best != 0) && (best != rtl))
+  {
+    moveToTuner(best);
+  }
+} /* Ddr::rebalance */
+
+
 
 /*
  * This file has not been truncated
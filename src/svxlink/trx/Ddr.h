@@ -37,6 +37,10 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
  *
  ****************************************************************************/
 
+#include <stdint.h>
+
+#include <vector>
+#include <string>
 
 
 /****************************************************************************
@@ -63,6 +67,10 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
  *
  ****************************************************************************/
 
+namespace Async
+{
+  class AudioPassthrough;
+};
 class WbRxRtlSdr;
 
 
@@ -114,6 +122,12 @@ class WbRxRtlSdr;
 This class handle local digital drop receivers. A digital drop receiver use
 a wideband tuner to receive wideband samples. A narrowband channel is then
 extracted from this wideband signal and a demodulator is applied.
+
+More than one wideband tuner may be given for a DDR. The DDR is then placed on
+the tuner, among the given ones, that cover its frequency and that has the
+fewest DDR:s already. If the frequency no longer fit in the passband of the
+tuner, e.g. after a retune, the DDR move to another tuner in the list that
+cover the frequency.
 */
 class Ddr : public LocalRxBase
 {
@@ -142,11 +156,23 @@ class Ddr : public LocalRxBase
      */
     uint32_t nbFq(void) const { return fq; }
 
+    /**
+     * @brief   Get the frequencies that the tuner need to cover for this DDR
+     * @param   fqs The frequencies, in Hz, are appended to this vector
+     *
+     * This function is used by the wideband receiver when placing the tuner.
+     * An ordinary DDR only need its own frequency to be covered.
+     */
+    virtual void coveredFqs(std::vector<uint32_t>& fqs) const
+    {
+      fqs.push_back(nbFq());
+    }
+
     /**
      * @brief   Tell the DDR that the frequency of the wideband tuner changed
      * @param   fq The new tuner frequency
      */
-    void tunerFqChanged(uint32_t fq);
+    virtual void tunerFqChanged(uint32_t fq);
 
     /**
      * @brief   Find out what the pre-demodulation sample rate is
@@ -225,7 +251,28 @@ class Ddr : public LocalRxBase
      * the LocalRxBase::initialize function.
      */
     virtual Async::AudioSource *audioSource(void);
-    
+
+    /**
+     * @brief   Get the wideband receiver that this DDR is connected to
+     * @returns Returns the wideband receiver or 0 if not initialized
+     */
+    WbRxRtlSdr *wbRx(void) { return rtl; }
+
+    /**
+     * @brief   Find out if more than one wideband receiver is configured
+     * @returns Returns \em true if the DDR may move between tuners
+     */
+    bool hasTunerGroup(void) const { return wbrx_names.size() > 1; }
+
+    /**
+     * @brief   Enable or disable the channel demodulator
+     * @param   enable Set to \em true to enable the demodulator
+     *
+     * A disabled demodulator does not process any samples at all so it does
+     * not cost anything. The squelch will of course not open either.
+     */
+    void setDemodEnabled(bool enable);
+
   private:
     class Channel;
     typedef std::map<std::string, Ddr*> DdrMap;
@@ -236,8 +283,18 @@ class Ddr : public LocalRxBase
     Channel                 *channel;
     WbRxRtlSdr              *rtl;
     double                  fq;
+    bool                    demod_enabled;
+    std::vector<std::string> wbrx_names;
+    Async::AudioPassthrough *audio_pipe;
+    Modulation::Type        mod;
+    bool                    fast_fm_discr;
+    sigc::connection        ready_con;
+    bool                    rebalance_pending;
 
     void updateFqOffset(void);
+    bool setupChannel(void);
+    bool moveToTuner(WbRxRtlSdr *new_rtl);
+    void rebalance(void);
     
 };  /* class Ddr */
 
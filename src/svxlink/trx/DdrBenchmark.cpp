@@ -0,0 +1,425 @@
+/******************************************************************************
+ *
+ * Measure the throughput of the Ddr decimator stages and FM discriminators.
+ *
+ * Run with something like:
+ *   svxlink/trx/DdrBenchmark [--time <seconds>] [--fm-snr]
+ *
+ * Each stage of the Ddr decimator chains is run on a block of I/Q samples
+ * using its real filter coefficients, once using the DdrFirKernels like the
+ * Ddr decimator does and once using a plain std::complex<float>
+ * implementation that work like the Ddr decimator did before the kernels
+ * were added. The throughput of each stage is printed in million input
+ * samples per second (MS/s), together with the speedup of the kernels.
+ * The throughput of the exact and the fast FM discriminator is printed in
+ * the same way. Use --fm-snr to also compare the output SNR of the two FM
+ * discriminators for a number of carrier to noise ratios.
+ *
+ ******************************************************************************/
+
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <functional>
+#include <chrono>
+#include <complex>
+#include <random>
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <cmath>
+
+#include "DdrFirKernels.h"
+#include "DdrFilterCoeffs.h"
+
+using namespace std;
+
+
+namespace {
+
+typedef std::chrono::steady_clock Clock;
+
+const size_t BLOCK_SIZE = 16384;
+const unsigned FM_SAMP_RATE = 32000;
+
+struct StageSpec
+{
+  const char  *name;
+  size_t      dec_fact;
+  const float *coeff;
+  size_t      taps;
+};
+
+const StageSpec stages[] =
+{
+  { "960k_192k",    5, coeff_dec_960k_192k,   coeff_dec_960k_192k_cnt },
+  { "192k_64k",     3, coeff_dec_192k_64k,    coeff_dec_192k_64k_cnt },
+  { "64k_32k",      2, coeff_dec_64k_32k,     coeff_dec_64k_32k_cnt },
+  { "192k_48k",     4, coeff_dec_192k_48k,    coeff_dec_192k_48k_cnt },
+  { "48k_16k",      3, coeff_dec_48k_16k,     coeff_dec_48k_16k_cnt },
+  { "2400k_800k",   3, coeff_dec_2400k_800k,  coeff_dec_2400k_800k_cnt },
+  { "800k_160k",    5, coeff_dec_800k_160k,   coeff_dec_800k_160k_cnt },
+  { "160k_32k",     5, coeff_dec_160k_32k,    coeff_dec_160k_32k_cnt },
+  { "32k_16k",      2, coeff_dec_32k_16k,     coeff_dec_32k_16k_cnt },
+  { "25k_channel",  1, coeff_25k_channel,     coeff_25k_channel_cnt },
+  { "12k5_channel", 1, coeff_12k5_channel,    coeff_12k5_channel_cnt },
+};
+
+
+  /*
+   * Create a block of I/Q samples, a few carriers and some noise
+   */
+vector<complex<float> > createIqBlock(size_t len)
+{
+  vector<complex<float> > iq(len);
+  mt19937 rng(2);
+  normal_distribution<float> noise(0.0f, 0.01f);
+  for (size_t i=0; i<len; ++i)
+  {
+    iq[i] = 0.5f * polar(1.0f, static_cast<float>(0.013 * i)) +
+            0.2f * polar(1.0f, static_cast<float>(-0.41 * i)) +
+            complex<float>(noise(rng), noise(rng));
+  }
+  return iq;
+} /* createIqBlock */
+
+
+  /*
+   * The stage implemented using the DdrFirKernels. The coefficients and
+   * the delay line are prepared the same way as the Decimator class in
+   * Ddr.cpp does, including the reversed copy of the samples that the
+   * symmetric kernel need.
+   */
+class KernelStage
+{
+  public:
+    KernelStage(const StageSpec& spec, const vector<complex<float> >& iq)
+      : dec_fact(spec.dec_fact), hist(spec.taps - 1),
+        coeff(spec.coeff, spec.coeff + spec.taps), re(hist), im(hist)
+    {
+      symmetric = equal(coeff.begin(), coeff.end(), coeff.rbegin());
+      reverse(coeff.begin(), coeff.end());
+      if (symmetric)
+      {
+        coeff.resize((spec.taps + 1) / 2);
+        if (spec.taps % 2 == 1)
+        {
+          coeff.back() *= 0.5f;
+        }
+      }
+      for (size_t i=0; i<iq.size(); ++i)
+      {
+        re.push_back(iq[i].real());
+        im.push_back(iq[i].imag());
+      }
+      in_cnt = iq.size();
+      out_re.resize(in_cnt / dec_fact);
+      out_im.resize(in_cnt / dec_fact);
+    }
+
+    bool isSymmetric(void) const { return symmetric; }
+
+    size_t run(void)
+    {
+      const size_t start = dec_fact - 1;
+      if (symmetric)
+      {
+        const size_t rev_start = in_cnt - dec_fact;
+        rev_re.assign(re.rbegin(), re.rend());
+        rev_im.assign(im.rbegin(), im.rend());
+        DdrFirKernels::firDecimateSym(&coeff[0], coeff.size(), &re[start],
+            &im[start], &rev_re[rev_start], &rev_im[rev_start],
+            out_re.size(), dec_fact, &out_re[0], &out_im[0]);
+      }
+      else
+      {
+        DdrFirKernels::firDecimate(&coeff[0], coeff.size(), &re[start],
+            &im[start], out_re.size(), dec_fact, &out_re[0], &out_im[0]);
+      }
+      return in_cnt;
+    }
+
+  private:
+    size_t        dec_fact;
+    size_t        hist;
+    bool          symmetric;
+    size_t        in_cnt;
+    vector<float> coeff;
+    vector<float> re;
+    vector<float> im;
+    vector<float> rev_re;
+    vector<float> rev_im;
+    vector<float> out_re;
+    vector<float> out_im;
+};
+
+
+  /*
+   * The stage implemented the way the Ddr decimator did before the
+   * DdrFirKernels were added, with a std::complex<float> delay line that is
+   * shifted using memmove for each output sample
+   */
+class ReferenceStage
+{
+  public:
+    ReferenceStage(const StageSpec& spec, const vector<complex<float> >& iq)
+      : dec_fact(spec.dec_fact), taps(spec.taps),
+        coeff(spec.coeff, spec.coeff + spec.taps), z(spec.taps), in(iq)
+    {
+      out.reserve(in.size() / dec_fact);
+    }
+
+    size_t run(void)
+    {
+      out.clear();
+      vector<complex<float> >::const_iterator src = in.begin();
+      while (src != in.end())
+      {
+        memmove(&z[dec_fact], &z[0],
+                (taps - dec_fact) * sizeof(complex<float>));
+        for (int tap = dec_fact - 1; tap >= 0; tap--)
+        {
+          z[tap] = *src++;
+        }
+        complex<float> sum(0);
+        for (size_t tap = 0; tap < taps; tap++)
+        {
+          sum += coeff[tap] * z[tap];
+        }
+        out.push_back(sum);
+      }
+      return in.size();
+    }
+
+  private:
+    size_t                          dec_fact;
+    size_t                          taps;
+    vector<float>                   coeff;
+    vector<complex<float> >         z;
+    const vector<complex<float> >&  in;
+    vector<complex<float> >         out;
+};
+
+
+  /*
+   * Create a block of FM modulated I/Q samples, a 1 kHz tone with 5 kHz
+   * deviation sampled at 32 kHz, with gaussian noise added to give the
+   * given carrier to noise ratio. If ideal is given, it is filled with the
+   * phase difference between the samples before the noise was added, that
+   * is what a perfect discriminator would output.
+   */
+vector<complex<float> > createFmBlock(double cnr_db, size_t len,
+                                      vector<float> *ideal=0)
+{
+  vector<complex<float> > iq(len);
+  mt19937 rng(3);
+  const double noise_pwr = pow(10.0, -cnr_db / 10.0);
+  normal_distribution<float> noise(0.0f, sqrt(0.5 * noise_pwr));
+  const double k = 2.0 * M_PI * 5000.0 / FM_SAMP_RATE;
+  double phase = 0.0;
+  if (ideal != 0)
+  {
+    ideal->resize(len);
+  }
+  for (size_t i=0; i<len; ++i)
+  {
+    const double dphi = k * sin(2.0 * M_PI * 1000.0 * i / FM_SAMP_RATE);
+    phase = fmod(phase + dphi, 2.0 * M_PI);
+    iq[i] = polar(1.0f, static_cast<float>(phase)) +
+            complex<float>(noise(rng), noise(rng));
+    if (ideal != 0)
+    {
+      (*ideal)[i] = dphi;
+    }
+  }
+  return iq;
+} /* createFmBlock */
+
+
+  /*
+   * The exact or the fast FM discriminator, run on a block of samples
+   */
+class FmDiscriminator
+{
+  public:
+    FmDiscriminator(bool fast, const vector<complex<float> >& iq)
+      : fast(fast), in(iq), prev(iq[0]), tmp_re(iq.size()),
+        tmp_im(iq.size()), out(iq.size())
+    {
+    }
+
+    const vector<float>& output(void) const { return out; }
+
+    size_t run(void)
+    {
+      if (fast)
+      {
+        DdrFirKernels::fmDiscriminatorFast(in.data(), in.size(), prev,
+            tmp_re.data(), tmp_im.data(), out.data());
+      }
+      else
+      {
+        DdrFirKernels::fmDiscriminator(in.data(), in.size(), prev,
+                                       out.data());
+      }
+      return in.size();
+    }
+
+  private:
+    bool                            fast;
+    const vector<complex<float> >&  in;
+    complex<float>                  prev;
+    vector<float>                   tmp_re;
+    vector<float>                   tmp_im;
+    vector<float>                   out;
+};
+
+
+  /*
+   * Call the given function repeatedly for at least min_time seconds and
+   * return the number of processed samples per second
+   */
+double measure(const function<size_t(void)>& run, double min_time)
+{
+  run();
+  size_t samples = 0;
+  double seconds = 0.0;
+  Clock::time_point start = Clock::now();
+  while (seconds < min_time)
+  {
+    for (int i=0; i<10; ++i)
+    {
+      samples += run();
+    }
+    seconds = chrono::duration<double>(Clock::now() - start).count();
+  }
+  return samples / seconds;
+} /* measure */
+
+
+  /*
+   * Compare the signal to noise ratio of the output from the FM
+   * discriminators against the output of a perfect discriminator. The SNR
+   * is measured directly on the discriminator output, before the audio
+   * decimator.
+   */
+void printFmSnr(void)
+{
+  cout << left << setw(10) << "CNR dB" << right
+       << setw(14) << "SNR atan2" << setw(14) << "SNR fast"
+       << setw(14) << "max diff" << endl;
+  for (int cnr_db=0; cnr_db<=100; cnr_db+=10)
+  {
+    vector<float> ideal;
+    const vector<complex<float> > iq = createFmBlock(cnr_db, 65536, &ideal);
+    FmDiscriminator exact(false, iq);
+    FmDiscriminator fast(true, iq);
+    exact.run();
+    fast.run();
+    const FmDiscriminator *discr[] = { &exact, &fast };
+    double snr_db[2];
+    for (int i=0; i<2; ++i)
+    {
+      const vector<float>& out = discr[i]->output();
+      double sig_pwr = 0.0;
+      double err_pwr = 0.0;
+      for (size_t n=1; n<out.size(); ++n)
+      {
+        const double err = out[n] - ideal[n];
+        sig_pwr += ideal[n] * ideal[n];
+        err_pwr += err * err;
+      }
+      snr_db[i] = 10.0 * log10(sig_pwr / err_pwr);
+    }
+    float max_diff = 0.0f;
+    for (size_t n=1; n<iq.size(); ++n)
+    {
+      max_diff = max(max_diff,
+                     fabsf(fast.output()[n] - exact.output()[n]));
+    }
+    cout << left << setw(10) << cnr_db << right << fixed
+         << setw(14) << setprecision(1) << snr_db[0]
+         << setw(14) << setprecision(1) << snr_db[1]
+         << setw(14) << scientific << setprecision(1) << max_diff << endl;
+  }
+} /* printFmSnr */
+
+
+void usage(const char *prog)
+{
+  cerr << "Usage: " << prog << " [--time <seconds>] [--fm-snr]\n";
+} /* usage */
+
+}; /* anonymous namespace */
+
+
+int main(int argc, const char **argv)
+{
+  double min_time = 1.0;
+  bool fm_snr = false;
+  for (int i=1; i<argc; ++i)
+  {
+    string arg(argv[i]);
+    if ((arg == "--time") && (i+1 < argc))
+    {
+      min_time = atof(argv[++i]);
+    }
+    else if (arg == "--fm-snr")
+    {
+      fm_snr = true;
+    }
+    else
+    {
+      usage(argv[0]);
+      return 1;
+    }
+  }
+
+  cout << left << setw(14) << "Stage" << right << setw(6) << "Dec"
+       << setw(6) << "Taps" << setw(5) << "Sym"
+       << setw(16) << "Ref (MS/s)" << setw(16) << "Kernel (MS/s)"
+       << setw(10) << "Speedup" << endl;
+  for (const StageSpec& spec : stages)
+  {
+    vector<complex<float> > iq = createIqBlock(BLOCK_SIZE);
+    iq.resize(iq.size() - iq.size() % spec.dec_fact);
+
+    ReferenceStage ref(spec, iq);
+    KernelStage kernel(spec, iq);
+    const double ref_rate = measure([&]() { return ref.run(); }, min_time);
+    const double kernel_rate =
+        measure([&]() { return kernel.run(); }, min_time);
+
+    cout << left << setw(14) << spec.name << right
+         << setw(6) << spec.dec_fact << setw(6) << spec.taps
+         << setw(5) << (kernel.isSymmetric() ? "yes" : "no") << fixed
+         << setw(16) << setprecision(1) << (ref_rate / 1.0e6)
+         << setw(16) << setprecision(1) << (kernel_rate / 1.0e6)
+         << setw(9) << setprecision(1) << (kernel_rate / ref_rate) << "x"
+         << endl;
+  }
+
+  cout << endl << left << setw(14) << "FM discr" << right
+       << setw(16) << "atan2 (MS/s)" << setw(16) << "fast (MS/s)"
+       << setw(10) << "Speedup" << endl;
+  const vector<complex<float> > fm_iq = createFmBlock(20.0, BLOCK_SIZE);
+  FmDiscriminator exact(false, fm_iq);
+  FmDiscriminator fast(true, fm_iq);
+  const double exact_rate = measure([&]() { return exact.run(); }, min_time);
+  const double fast_rate = measure([&]() { return fast.run(); }, min_time);
+  cout << left << setw(14) << "32k" << right << fixed
+       << setw(16) << setprecision(1) << (exact_rate / 1.0e6)
+       << setw(16) << setprecision(1) << (fast_rate / 1.0e6)
+       << setw(9) << setprecision(1) << (fast_rate / exact_rate) << "x"
+       << endl;
+
+  if (fm_snr)
+  {
+    cout << endl;
+    printFmSnr();
+  }
+
+  return 0;
+} /* main */
+
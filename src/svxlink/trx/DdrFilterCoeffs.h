@@ -464,6 +464,66 @@ FILTER_COEFF(coeff_dec_64k_32k,
   -0.0021501279583193
 )
 
+/**
+ * fs=96000;
+ * b=fir1(48, 13000/(fs/2), kaiser(49, 4.533));
+ *
+ * Lowpass filter of order 48 for decimation from 96kHz to 32kHz sampling
+ * frequency. Used on the output of the polyphase channelizer for a tuner
+ * sampling rate of 2400kHz. Below -50dB over 16kHz.
+ */
+FILTER_COEFF(coeff_dec_96k_32k,
+  0.0007371349736524,
+  0.0007430846317730,
+  -0.0002104448704393,
+  -0.0018343013200757,
+  -0.0028232188099163,
+  -0.0016711078972475,
+  0.0018332301104633,
+  0.0056623022792363,
+  0.0063823584546855,
+  0.0017537186500489,
+  -0.0066193712336108,
+  -0.0130390832013991,
+  -0.0110508147440328,
+  0.0012188198504610,
+  0.0176110917914641,
+  0.0259657973972498,
+  0.0158507252827275,
+  -0.0122961593192313,
+  -0.0431973789871978,
+  -0.0523247977388697,
+  -0.0194826347909196,
+  0.0571439554331183,
+  0.1556531206828347,
+  0.2385454222021806,
+  0.2708971023460892,
+  0.2385454222021806,
+  0.1556531206828347,
+  0.0571439554331183,
+  -0.0194826347909196,
+  -0.0523247977388697,
+  -0.0431973789871978,
+  -0.0122961593192313,
+  0.0158507252827275,
+  0.0259657973972498,
+  0.0176110917914641,
+  0.0012188198504610,
+  -0.0110508147440328,
+  -0.0130390832013991,
+  -0.0066193712336108,
+  0.0017537186500489,
+  0.0063823584546855,
+  0.0056623022792363,
+  0.0018332301104633,
+  -0.0016711078972475,
+  -0.0028232188099163,
+  -0.0018343013200757,
+  -0.0002104448704393,
+  0.0007430846317730,
+  0.0007371349736524
+)
+
 /**
  * fs=32000;
  * a=[1 1 0 0];
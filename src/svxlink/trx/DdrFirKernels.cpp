@@ -0,0 +1,362 @@
+/**
+@file	 DdrFirKernels.cpp
+@brief   Vectorized FIR filter kernels used by the Ddr decimators
+@author  Tobias Blomberg / SM0SVX
+@date	 2026-10-14
+
+\verbatim
+SvxLink - A Multi Purpose Voice Services System for Ham Radio Use
+Copyright (C) 2003-2026 Tobias Blomberg / SM0SVX
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+\endverbatim
+*/
+
+
+
+/****************************************************************************
+ *
+ * System Includes
+ *
+ ****************************************************************************/
+
+#include <cstring>
+#include <cmath>
+
+
+/****************************************************************************
+ *
+ * Project Includes
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Local Includes
+ *
+ ****************************************************************************/
+
+#include "DdrFirKernels.h"
+
+
+
+/****************************************************************************
+ *
+ * Namespaces to use
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Defines & typedefs
+ *
+ ****************************************************************************/
+
+  // The GCC vector extensions are used to write the kernels in a portable
+  // way. The compiler map the operations to whatever SIMD instructions are
+  // available on the target (SSE, AVX, NEON). If not supported by the
+  // compiler, plain scalar code is used.
+#if defined(__GNUC__)
+#define DDR_FIR_VECTOR_EXT
+typedef float VecFloat __attribute__((vector_size(32)));
+static const size_t VEC_LEN = sizeof(VecFloat) / sizeof(float);
+#endif
+
+  // On x86, also build a version of each kernel for CPU:s supporting AVX2.
+  // The best version is selected at runtime when the program is loaded.
+#if defined(DDR_FIR_VECTOR_EXT) && defined(__x86_64__) && \
+    defined(__ELF__) && !defined(__clang__)
+#define DDR_FIR_KERNEL __attribute__((target_clones("avx2", "default")))
+#else
+#define DDR_FIR_KERNEL
+#endif
+
+
+
+/****************************************************************************
+ *
+ * Local class definitions
+ *
+ ****************************************************************************/
+
+namespace {
+#ifdef DDR_FIR_VECTOR_EXT
+    // Load from a possibly unaligned address. Returning the vector by value
+    // would trigger ABI warnings on x86 so an out parameter is used.
+  inline void loadVec(VecFloat& v, const float *ptr)
+  {
+    memcpy(&v, ptr, sizeof(v));
+  } /* loadVec */
+
+
+  inline float sumVec(const VecFloat& v)
+  {
+    float sum = 0.0f;
+    for (size_t i=0; i<VEC_LEN; ++i)
+    {
+      sum += v[i];
+    }
+    return sum;
+  } /* sumVec */
+#endif
+};
+
+
+
+/****************************************************************************
+ *
+ * Prototypes
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Exported Global Variables
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Local Global Variables
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Public functions
+ *
+ ****************************************************************************/
+
+DDR_FIR_KERNEL
+void DdrFirKernels::firDecimate(const float *coeff, size_t taps,
+                                const float *in, size_t out_cnt,
+                                size_t dec_fact, float *out)
+{
+  for (size_t m=0; m<out_cnt; ++m)
+  {
+    const float *x = in + m * dec_fact;
+    size_t k = 0;
+    float sum = 0.0f;
+#ifdef DDR_FIR_VECTOR_EXT
+    VecFloat acc = {};
+    for (; k + VEC_LEN <= taps; k += VEC_LEN)
+    {
+      VecFloat c, v;
+      loadVec(c, coeff + k);
+      loadVec(v, x + k);
+      acc += c * v;
+    }
+    sum = sumVec(acc);
+#endif
+    for (; k < taps; ++k)
+    {
+      sum += coeff[k] * x[k];
+    }
+    out[m] = sum;
+  }
+} /* DdrFirKernels::firDecimate */
+
+
+DDR_FIR_KERNEL
+void DdrFirKernels::firDecimate(const float *coeff, size_t taps,
+                                const float *in_re, const float *in_im,
+                                size_t out_cnt, size_t dec_fact,
+                                float *out_re, float *out_im)
+{
+  for (size_t m=0; m<out_cnt; ++m)
+  {
+    const float *xr = in_re + m * dec_fact;
+    const float *xi = in_im + m * dec_fact;
+    size_t k = 0;
+    float sum_re = 0.0f;
+    float sum_im = 0.0f;
+#ifdef DDR_FIR_VECTOR_EXT
+    VecFloat acc_re = {};
+    VecFloat acc_im = {};
+    for (; k + VEC_LEN <= taps; k += VEC_LEN)
+    {
+      VecFloat c, vr, vi;
+      loadVec(c, coeff + k);
+      loadVec(vr, xr + k);
+      loadVec(vi, xi + k);
+      acc_re += c * vr;
+      acc_im += c * vi;
+    }
+    sum_re = sumVec(acc_re);
+    sum_im = sumVec(acc_im);
+#endif
+    for (; k < taps; ++k)
+    {
+      sum_re += coeff[k] * xr[k];
+      sum_im += coeff[k] * xi[k];
+    }
+    out_re[m] = sum_re;
+    out_im[m] = sum_im;
+  }
+} /* DdrFirKernels::firDecimate */
+
+
+DDR_FIR_KERNEL
+void DdrFirKernels::firDecimateSym(const float *coeff, size_t half,
+                                   const float *in, const float *rev,
+                                   size_t out_cnt, size_t dec_fact,
+                                   float *out)
+{
+  for (size_t m=0; m<out_cnt; ++m)
+  {
+    const float *x = in + m * dec_fact;
+    const float *y = rev - m * dec_fact;
+    size_t k = 0;
+    float sum = 0.0f;
+#ifdef DDR_FIR_VECTOR_EXT
+    VecFloat acc = {};
+    for (; k + VEC_LEN <= half; k += VEC_LEN)
+    {
+      VecFloat c, v, w;
+      loadVec(c, coeff + k);
+      loadVec(v, x + k);
+      loadVec(w, y + k);
+      acc += c * (v + w);
+    }
+    sum = sumVec(acc);
+#endif
+    for (; k < half; ++k)
+    {
+      sum += coeff[k] * (x[k] + y[k]);
+    }
+    out[m] = sum;
+  }
+} /* DdrFirKernels::firDecimateSym */
+
+
+DDR_FIR_KERNEL
+void DdrFirKernels::firDecimateSym(const float *coeff, size_t half,
+                                   const float *in_re, const float *in_im,
+                                   const float *rev_re, const float *rev_im,
+                                   size_t out_cnt, size_t dec_fact,
+                                   float *out_re, float *out_im)
+{
+  for (size_t m=0; m<out_cnt; ++m)
+  {
+    const float *xr = in_re + m * dec_fact;
+    const float *xi = in_im + m * dec_fact;
+    const float *yr = rev_re - m * dec_fact;
+    const float *yi = rev_im - m * dec_fact;
+    size_t k = 0;
+    float sum_re = 0.0f;
+    float sum_im = 0.0f;
+#ifdef DDR_FIR_VECTOR_EXT
+    VecFloat acc_re = {};
+    VecFloat acc_im = {};
+    for (; k + VEC_LEN <= half; k += VEC_LEN)
+    {
+      VecFloat c, vr, vi, wr, wi;
+      loadVec(c, coeff + k);
+      loadVec(vr, xr + k);
+      loadVec(vi, xi + k);
+      loadVec(wr, yr + k);
+      loadVec(wi, yi + k);
+      acc_re += c * (vr + wr);
+      acc_im += c * (vi + wi);
+    }
+    sum_re = sumVec(acc_re);
+    sum_im = sumVec(acc_im);
+#endif
+    for (; k < half; ++k)
+    {
+      sum_re += coeff[k] * (xr[k] + yr[k]);
+      sum_im += coeff[k] * (xi[k] + yi[k]);
+    }
+    out_re[m] = sum_re;
+    out_im[m] = sum_im;
+  }
+} /* DdrFirKernels::firDecimateSym */
+
+
+DDR_FIR_KERNEL
+void DdrFirKernels::fmDiscriminator(const std::complex<float> *in,
+                                    size_t cnt, std::complex<float> &prev,
+                                    float *out)
+{
+    // From article-sdr-is-qs.pdf: Watch your Is and Qs:
+    //   FM = (Qn.In-1 - In.Qn-1)/(In.In-1 + Qn.Qn-1)
+    //
+    // A more indepth report:
+    //   Implementation of FM demodulator algorithms on a
+    //   high performance digital signal processor
+  float iold = prev.real();
+  float qold = prev.imag();
+  for (size_t idx=0; idx<cnt; ++idx)
+  {
+      // Normalize signal amplitude
+    const std::complex<float> samp = in[idx] / std::abs(in[idx]);
+
+      // Mixed demodulator (delay demodulator + phase adapter demodulator)
+    const float i = samp.real();
+    const float q = samp.imag();
+    out[idx] = std::atan2(q*iold - i*qold, i*iold + q*qold);
+    iold = i;
+    qold = q;
+  }
+  prev = std::complex<float>(iold, qold);
+} /* DdrFirKernels::fmDiscriminator */
+
+
+DDR_FIR_KERNEL
+void DdrFirKernels::fmDiscriminatorFast(const std::complex<float> *in,
+                                        size_t cnt,
+                                        std::complex<float> &prev,
+                                        float *tmp_re, float *tmp_im,
+                                        float *out)
+{
+  if (cnt == 0)
+  {
+    return;
+  }
+
+    // Both loops are free of dependencies between iterations so the
+    // compiler can vectorize them
+  tmp_re[0] = in[0].real() * prev.real() + in[0].imag() * prev.imag();
+  tmp_im[0] = in[0].imag() * prev.real() - in[0].real() * prev.imag();
+  for (size_t idx=1; idx<cnt; ++idx)
+  {
+    const std::complex<float>& s = in[idx];
+    const std::complex<float>& p = in[idx-1];
+    tmp_re[idx] = s.real() * p.real() + s.imag() * p.imag();
+    tmp_im[idx] = s.imag() * p.real() - s.real() * p.imag();
+  }
+  prev = in[cnt-1];
+
+  for (size_t idx=0; idx<cnt; ++idx)
+  {
+    out[idx] = fastAtan2(tmp_im[idx], tmp_re[idx]);
+  }
+} /* DdrFirKernels::fmDiscriminatorFast */
+
+
+
+/*
+ * This file has not been truncated
+ */
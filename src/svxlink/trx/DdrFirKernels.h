@@ -0,0 +1,222 @@
+/**
+@file	 DdrFirKernels.h
+@brief   Vectorized FIR filter kernels used by the Ddr decimators
+@author  Tobias Blomberg / SM0SVX
+@date	 2026-10-14
+
+\verbatim
+SvxLink - A Multi Purpose Voice Services System for Ham Radio Use
+Copyright (C) 2003-2026 Tobias Blomberg / SM0SVX
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+\endverbatim
+*/
+
+#ifndef DDR_FIR_KERNELS_INCLUDED
+#define DDR_FIR_KERNELS_INCLUDED
+
+
+/****************************************************************************
+ *
+ * System Includes
+ *
+ ****************************************************************************/
+
+#include <cstddef>
+#include <complex>
+#include <algorithm>
+#include <cmath>
+
+
+/****************************************************************************
+ *
+ * Project Includes
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Local Includes
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Forward declarations
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Namespace
+ *
+ ****************************************************************************/
+
+/**
+@brief  Vectorized FIR filter kernels used by the Ddr decimators
+@author Tobias Blomberg / SM0SVX
+@date   2026-10-14
+
+All kernels calculate a number of decimated FIR filter output samples in one
+call. The samples are stored in split real/imaginary arrays so that the inner
+loops only operate on contiguous float arrays, which is what the compiler
+need to generate SIMD code (SSE/AVX on x86, NEON on ARM). On x86, a version
+using AVX2 is selected at runtime if the CPU support it.
+
+The coefficients must be given in reverse order, i.e. the coefficient for the
+oldest sample first. Output sample m is calculated from the input samples
+starting at index m*dec_fact.
+
+The symmetric versions of the kernels take advantage of the fact that most
+lowpass filters have symmetric coefficients, which halve the number of
+multiplications. They take the first (taps+1)/2 coefficients, with the middle
+coefficient halved for an odd number of taps, and a reversed copy of the
+input samples. The reversed samples for output sample m start at
+rev[-m*dec_fact].
+
+The FM discriminators used by the Ddr FM demodulator are also kept here so
+that they can be benchmarked and compared outside of the Ddr.
+*/
+namespace DdrFirKernels
+{
+
+/**
+ * @brief   Calculate decimated FIR output for real samples
+ * @param   coeff     The reversed filter coefficients
+ * @param   taps      The number of coefficients
+ * @param   in        The input samples
+ * @param   out_cnt   The number of output samples to calculate
+ * @param   dec_fact  The decimation factor
+ * @param   out       The buffer to write the output samples to
+ */
+void firDecimate(const float *coeff, size_t taps, const float *in,
+                 size_t out_cnt, size_t dec_fact, float *out);
+
+/**
+ * @brief   Calculate decimated FIR output for complex samples
+ * @param   coeff     The reversed filter coefficients
+ * @param   taps      The number of coefficients
+ * @param   in_re     The real part of the input samples
+ * @param   in_im     The imaginary part of the input samples
+ * @param   out_cnt   The number of output samples to calculate
+ * @param   dec_fact  The decimation factor
+ * @param   out_re    The buffer to write the real part of the output to
+ * @param   out_im    The buffer to write the imaginary part of the output to
+ */
+void firDecimate(const float *coeff, size_t taps, const float *in_re,
+                 const float *in_im, size_t out_cnt, size_t dec_fact,
+                 float *out_re, float *out_im);
+
+/**
+ * @brief   Calculate decimated symmetric FIR output for real samples
+ * @param   coeff     The first half of the coefficients
+ * @param   half      The number of coefficients in coeff
+ * @param   in        The input samples
+ * @param   rev       The reversed input samples for the first output sample
+ * @param   out_cnt   The number of output samples to calculate
+ * @param   dec_fact  The decimation factor
+ * @param   out       The buffer to write the output samples to
+ */
+void firDecimateSym(const float *coeff, size_t half, const float *in,
+                    const float *rev, size_t out_cnt, size_t dec_fact,
+                    float *out);
+
+/**
+ * @brief   Calculate decimated symmetric FIR output for complex samples
+ * @param   coeff     The first half of the coefficients
+ * @param   half      The number of coefficients in coeff
+ * @param   in_re     The real part of the input samples
+ * @param   in_im     The imaginary part of the input samples
+ * @param   rev_re    The reversed real part for the first output sample
+ * @param   rev_im    The reversed imaginary part for the first output sample
+ * @param   out_cnt   The number of output samples to calculate
+ * @param   dec_fact  The decimation factor
+ * @param   out_re    The buffer to write the real part of the output to
+ * @param   out_im    The buffer to write the imaginary part of the output to
+ */
+void firDecimateSym(const float *coeff, size_t half, const float *in_re,
+                    const float *in_im, const float *rev_re,
+                    const float *rev_im, size_t out_cnt, size_t dec_fact,
+                    float *out_re, float *out_im);
+
+/**
+ * @brief   Approximate atan2 using a polynomial
+ * @param   y   The imaginary part
+ * @param   x   The real part
+ * @return  Returns the angle in radians, in the range -pi to pi
+ *
+ * A minimax polynomial for atan on [0,1] is used, followed by octant
+ * folding. The maximum error is about 1.2e-5 radians. Zero in give zero out.
+ */
+inline float fastAtan2(float y, float x)
+{
+  const float ax = std::fabs(x);
+  const float ay = std::fabs(y);
+  const float mx = std::max(ax, ay);
+  const float mn = std::min(ax, ay);
+  const float a = mn / (mx + 1.0e-30f);
+  const float s = a * a;
+  float r = ((((0.0208351f * s - 0.0851330f) * s + 0.1801410f) * s
+              - 0.3302995f) * s + 0.9998660f) * a;
+  r = (ay > ax) ? (float(M_PI_2) - r) : r;
+  r = (x < 0.0f) ? (float(M_PI) - r) : r;
+  return (y < 0.0f) ? -r : r;
+} /* fastAtan2 */
+
+/**
+ * @brief   FM discriminator using the libm atan2 function
+ * @param   in    The I/Q input samples
+ * @param   cnt   The number of input samples
+ * @param   prev  The last sample of the previous block, updated on return
+ * @param   out   The buffer to write cnt demodulated samples to
+ *
+ * Each sample is normalized before the phase difference to the previous
+ * sample is calculated.
+ */
+void fmDiscriminator(const std::complex<float> *in, size_t cnt,
+                     std::complex<float> &prev, float *out);
+
+/**
+ * @brief   FM discriminator using the fastAtan2 approximation
+ * @param   in      The I/Q input samples
+ * @param   cnt     The number of input samples
+ * @param   prev    The last sample of the previous block, updated on return
+ * @param   tmp_re  A work buffer of at least cnt floats
+ * @param   tmp_im  A work buffer of at least cnt floats
+ * @param   out     The buffer to write cnt demodulated samples to
+ *
+ * The phase difference between two samples is the argument of
+ * s[n]*conj(s[n-1]). Since atan2 do not care about the magnitude, there is
+ * no need to normalize the samples.
+ */
+void fmDiscriminatorFast(const std::complex<float> *in, size_t cnt,
+                         std::complex<float> &prev, float *tmp_re,
+                         float *tmp_im, float *out);
+
+} /* namespace */
+
+#endif /* DDR_FIR_KERNELS_INCLUDED */
+
+
+
+/*
+ * This file has not been truncated
+ */
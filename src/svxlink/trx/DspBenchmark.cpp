@@ -0,0 +1,970 @@
+/******************************************************************************
+ *
+ * Measure the throughput of the DSP building blocks used by SvxLink.
+ *
+ * Run with something like:
+ *   svxlink/trx/DspBenchmark [--filter <text>] [--time <seconds>]
+ *                            [--block <samples>] [--format table|csv|json]
+ *
+ * Each benchmark is run for at least the given time and the number of
+ * samples processed per second, the time spent per sample and how many
+ * times faster than real time that is are printed. The csv and json formats
+ * are meant to be saved so that results from different machines, e.g. a
+ * Raspberry Pi 3, a Raspberry Pi 4 and a PC, or from before and after a
+ * change, can be compared. Use --list to print the benchmark names.
+ *
+ ******************************************************************************/
+
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <memory>
+#include <functional>
+#include <chrono>
+#include <complex>
+#include <random>
+#include <cstdlib>
+#include <cstring>
+#include <cmath>
+
+#include <AsyncCppApplication.h>
+#include <AsyncConfig.h>
+#include <AsyncTimer.h>
+#include <AsyncAudioSink.h>
+#include <AsyncAudioFilter.h>
+#include <AsyncAudioDecimator.h>
+#include <AsyncAudioInterpolator.h>
+#include <AsyncAudioFixedDecimator.h>
+#include <AsyncAudioFixedInterpolator.h>
+#include <AsyncAudioEncoder.h>
+#include <AsyncAudioNoiseAdder.h>
+#include <AsyncPrng.h>
+#include <AsyncSimd.h>
+
+#include "Rx.h"
+#include "Voter.h"
+#include "Squelch.h"
+#include "ToneDetector.h"
+#include "DtmfDecoder.h"
+#include "Sel5Decoder.h"
+#include "SigLevDetSim.h"
+#include "PfbChannelizer.h"
+#include "DdrFirKernels.h"
+#include "multirate_filter_coeff.h"
+
+using namespace std;
+using namespace Async;
+
+
+namespace {
+
+  /*
+   * The base class for all benchmarks. The process function is called with
+   * one block of the test signal at a time and should return the number of
+   * samples that was processed.
+   */
+class Benchmark
+{
+  public:
+    virtual ~Benchmark(void) {}
+
+      // The sample rate of the processed stream, used to calculate the
+      // real time factor
+    virtual unsigned sampleRate(void) const { return INTERNAL_SAMPLE_RATE; }
+
+    virtual size_t process(const float *samples, size_t count) = 0;
+};
+
+
+  /*
+   * Throw away all samples written to the sink
+   */
+class NullSink : public AudioSink
+{
+  public:
+    int writeSamples(const float *samples, int count) override
+    {
+      return count;
+    }
+
+    void flushSamples(void) override
+    {
+      sourceAllSamplesFlushed();
+    }
+};
+
+
+  /*
+   * Benchmark an audio sink, e.g. an audio processor or a detector. The
+   * output, if any, is connected to a null sink.
+   */
+template <class T>
+class SinkBenchmark : public Benchmark
+{
+  public:
+    SinkBenchmark(T *obj, unsigned sample_rate=INTERNAL_SAMPLE_RATE)
+      : obj(obj), sample_rate(sample_rate)
+    {
+      AudioSource *src = dynamic_cast<AudioSource*>(obj);
+      if (src != 0)
+      {
+        src->registerSink(&null_sink);
+      }
+    }
+
+    ~SinkBenchmark(void)
+    {
+      delete obj;
+    }
+
+    unsigned sampleRate(void) const override { return sample_rate; }
+
+    size_t process(const float *samples, size_t count) override
+    {
+      return obj->writeSamples(samples, count);
+    }
+
+  private:
+    T *       obj;
+    unsigned  sample_rate;
+    NullSink  null_sink;
+};
+
+
+class EncoderBenchmark : public Benchmark
+{
+  public:
+    explicit EncoderBenchmark(AudioEncoder *enc) : enc(enc) {}
+    ~EncoderBenchmark(void) { delete enc; }
+
+    size_t process(const float *samples, size_t count) override
+    {
+      return enc->writeSamples(samples, count);
+    }
+
+  private:
+    AudioEncoder *enc;
+};
+
+
+  /*
+   * Benchmark the generation of gaussian noise. The input samples are not
+   * used, the same number of noise samples are generated instead.
+   */
+class PrngBenchmark : public Benchmark
+{
+  public:
+    size_t process(const float *samples, size_t count) override
+    {
+      buf.resize(count);
+      prng.fillGaussian(buf.data(), count, 0.1f);
+      return count;
+    }
+
+  private:
+    Prng          prng;
+    vector<float> buf;
+};
+
+
+  /*
+   * Benchmark one of the Simd kernels using the given instruction set. The
+   * instruction set is restored to the automatically selected one when the
+   * benchmark is deleted.
+   */
+class SimdBenchmark : public Benchmark
+{
+  public:
+    typedef enum
+    {
+      KERNEL_FIR, KERNEL_COMPLEX_MULTIPLY, KERNEL_S16_CONV
+    } Kernel;
+
+    static const size_t FIR_TAPS = 64;
+
+    static Benchmark *create(Kernel kernel, Simd::Isa isa)
+    {
+      const Simd::Isa best_isa = Simd::isa();
+      if (!Simd::setIsa(isa))
+      {
+        return 0;
+      }
+      return new SimdBenchmark(kernel, best_isa);
+    }
+
+    ~SimdBenchmark(void) override
+    {
+      Simd::setIsa(best_isa);
+    }
+
+    size_t process(const float *samples, size_t count) override
+    {
+      switch (kernel)
+      {
+        case KERNEL_FIR:
+          hist.resize(FIR_TAPS - 1);
+          hist.insert(hist.end(), samples, samples + count);
+          out.resize(count);
+          for (size_t i=0; i<count; ++i)
+          {
+            out[i] = Simd::dotProduct(coeff.data(), &hist[i], FIR_TAPS);
+          }
+          hist.erase(hist.begin(), hist.end() - (FIR_TAPS - 1));
+          break;
+        case KERNEL_COMPLEX_MULTIPLY:
+          if (lut.size() < count)
+          {
+            lut.resize(count + 1);
+            for (size_t i=0; i<count; i+=2)
+            {
+              lut[i] = cosf(0.1f * i);
+              lut[i+1] = -sinf(0.1f * i);
+            }
+          }
+          out.resize(count);
+          Simd::complexMultiply(out.data(), samples, lut.data(), count / 2);
+          break;
+        case KERNEL_S16_CONV:
+          s16.resize(count);
+          out.resize(count);
+          Simd::floatToS16(s16.data(), samples, count);
+          Simd::s16ToFloat(out.data(), s16.data(), count);
+          break;
+      }
+      return count;
+    }
+
+  private:
+    Kernel          kernel;
+    Simd::Isa       best_isa;
+    vector<float>   coeff;
+    vector<float>   lut;
+    vector<float>   hist;
+    vector<float>   out;
+    vector<int16_t> s16;
+
+    SimdBenchmark(Kernel kernel, Simd::Isa best_isa)
+      : kernel(kernel), best_isa(best_isa), coeff(FIR_TAPS)
+    {
+      for (size_t i=0; i<coeff.size(); ++i)
+      {
+        coeff[i] = cosf(0.01f * i) / FIR_TAPS;
+      }
+    }
+};
+
+
+  /*
+   * Create a block of wideband I/Q samples, noise and a few carriers, the
+   * size of the blocks delivered by an RTL dongle
+   */
+vector<complex<float> > createIqBlock(void)
+{
+  vector<complex<float> > iq(16384);
+  mt19937 rng(2);
+  normal_distribution<float> noise(0.0f, 0.05f);
+  for (size_t i=0; i<iq.size(); ++i)
+  {
+    iq[i] = complex<float>(noise(rng), noise(rng));
+    for (int k=1; k<=4; ++k)
+    {
+      iq[i] += 0.1f * polar(1.0f, static_cast<float>(0.01 * k * k * i));
+    }
+  }
+  return iq;
+} /* createIqBlock */
+
+
+  /*
+   * Benchmark the polyphase filter bank channelizer with a number of bins in
+   * use. The audio test signal is not used since the channelizer work on
+   * wideband I/Q samples.
+   */
+class PfbBenchmark : public Benchmark
+{
+  public:
+    PfbBenchmark(unsigned samp_rate, unsigned bins)
+      : pfb(samp_rate), samp_rate(samp_rate), iq(createIqBlock())
+    {
+      for (unsigned i=0; i<bins; ++i)
+      {
+        pfb.connectBin(i * pfb.binCount() / bins,
+            [](const vector<PfbChannelizer::Sample>&) {});
+      }
+    }
+
+    unsigned sampleRate(void) const override { return samp_rate; }
+
+    size_t process(const float *, size_t) override
+    {
+      pfb.iqReceived(iq);
+      return iq.size();
+    }
+
+  private:
+    PfbChannelizer                  pfb;
+    unsigned                        samp_rate;
+    const vector<complex<float> >   iq;
+};
+
+
+  /*
+   * Benchmark the complex FIR decimation kernel used by the DDR channel
+   * filters. Like for the channelizer, wideband I/Q samples are used.
+   */
+class DdrFirBenchmark : public Benchmark
+{
+  public:
+    DdrFirBenchmark(size_t taps, size_t dec_fact, unsigned samp_rate)
+      : coeff(taps), dec_fact(dec_fact), samp_rate(samp_rate),
+        re(taps - 1), im(taps - 1)
+    {
+      for (size_t i=0; i<taps; ++i)
+      {
+        coeff[i] = 1.0f / taps;
+      }
+      vector<complex<float> > iq = createIqBlock();
+      for (size_t i=0; i<iq.size(); ++i)
+      {
+        re.push_back(iq[i].real());
+        im.push_back(iq[i].imag());
+      }
+      out_re.resize(iq.size() / dec_fact);
+      out_im.resize(iq.size() / dec_fact);
+    }
+
+    unsigned sampleRate(void) const override { return samp_rate; }
+
+    size_t process(const float *, size_t) override
+    {
+      DdrFirKernels::firDecimate(&coeff[0], coeff.size(), &re[dec_fact - 1],
+          &im[dec_fact - 1], out_re.size(), dec_fact, &out_re[0],
+          &out_im[0]);
+      return out_re.size() * dec_fact;
+    }
+
+  private:
+    vector<float> coeff;
+    size_t        dec_fact;
+    unsigned      samp_rate;
+    vector<float> re;
+    vector<float> im;
+    vector<float> out_re;
+    vector<float> out_im;
+};
+
+
+  /*
+   * A receiver used as a voter satellite. The benchmark write the audio
+   * directly to it and control the squelch.
+   */
+class BenchRx : public Rx
+{
+  public:
+    BenchRx(Config &cfg, const string &name) : Rx(cfg, name) {}
+    void reset(void) override {}
+    void resumeOutput(void) override {}
+    void allSamplesFlushed(void) override {}
+    float signalStrength(void) const override { return siglev; }
+
+    void setSquelch(bool is_open, float level)
+    {
+      siglev = level;
+      setSquelchState(is_open, "BENCH");
+    }
+
+    void updateSignalLevel(float level)
+    {
+      siglev = level;
+      signalLevelUpdated(level);
+    }
+
+    size_t write(const float *samples, size_t count)
+    {
+      return sinkWriteSamples(samples, count);
+    }
+
+  private:
+    float siglev = 0.0f;
+};
+
+
+class BenchRxFactory : public RxFactory
+{
+  public:
+    BenchRxFactory(void) : RxFactory("Bench") {}
+
+    vector<BenchRx*> rxs;
+
+  protected:
+    Rx *createRx(Config& cfg, const string& name) override
+    {
+      BenchRx *rx = new BenchRx(cfg, name);
+      rxs.push_back(rx);
+      return rx;
+    }
+};
+
+
+  /*
+   * Benchmark the voter with a number of satellite receivers all receiving
+   * audio, one of them with an open squelch. The event loop is run for a
+   * while before the benchmark start so that a receiver is selected.
+   */
+class VoterBenchmark : public Benchmark
+{
+  public:
+    explicit VoterBenchmark(unsigned sat_cnt)
+    {
+      string receivers;
+      for (unsigned i=0; i<sat_cnt; ++i)
+      {
+        string name = "BenchSat" + to_string(i);
+        cfg.setValue(name, "TYPE", "Bench");
+        receivers += (i > 0) ? "," + name : name;
+      }
+      cfg.setValue("BenchVoter", "TYPE", "Voter");
+      cfg.setValue("BenchVoter", "RECEIVERS", receivers);
+      cfg.setValue("BenchVoter", "VOTING_DELAY", "0");
+      voter.reset(new Voter(cfg, "BenchVoter"));
+      if (!voter->initialize() || (factory.rxs.size() != sat_cnt))
+      {
+        cerr << "*** ERROR: Could not initialize the voter\n";
+        exit(1);
+      }
+      voter->registerSink(&null_sink);
+      voter->setMuteState(Rx::MUTE_NONE);
+      for (size_t i=0; i<factory.rxs.size(); ++i)
+      {
+        factory.rxs[i]->setSquelch(i == 0, (i == 0) ? 50.0f : 0.0f);
+      }
+      Timer settle_timer(500);
+      settle_timer.expired.connect([](Timer*) { Application::app().quit(); });
+      Application::app().exec();
+    }
+
+    size_t process(const float *samples, size_t count) override
+    {
+      size_t processed = 0;
+      for (BenchRx *rx : factory.rxs)
+      {
+        processed += rx->write(samples, count);
+      }
+      return processed;
+    }
+
+  private:
+    Config            cfg;
+    BenchRxFactory    factory;
+    unique_ptr<Voter> voter;
+    NullSink          null_sink;
+};
+
+
+  /*
+   * Benchmark the voter event dispatching. All satellites have an open
+   * squelch and each call send one signal level update from each of them,
+   * with the best receiver changing now and then. A "sample" is one event
+   * and the real time factor is calculated for 20 updates per second and
+   * satellite.
+   */
+class VoterEventBenchmark : public Benchmark
+{
+  public:
+    explicit VoterEventBenchmark(unsigned sat_cnt) : sat_cnt(sat_cnt)
+    {
+      string receivers;
+      for (unsigned i=0; i<sat_cnt; ++i)
+      {
+        string name = "BenchSat" + to_string(i);
+        cfg.setValue(name, "TYPE", "Bench");
+        receivers += (i > 0) ? "," + name : name;
+      }
+      cfg.setValue("BenchVoter", "TYPE", "Voter");
+      cfg.setValue("BenchVoter", "RECEIVERS", receivers);
+      cfg.setValue("BenchVoter", "VOTING_DELAY", "0");
+      voter.reset(new Voter(cfg, "BenchVoter"));
+      if (!voter->initialize() || (factory.rxs.size() != sat_cnt))
+      {
+        cerr << "*** ERROR: Could not initialize the voter\n";
+        exit(1);
+      }
+      voter->registerSink(&null_sink);
+      voter->setMuteState(Rx::MUTE_NONE);
+      for (size_t i=0; i<factory.rxs.size(); ++i)
+      {
+        factory.rxs[i]->setSquelch(true, 10.0f + i);
+      }
+      Timer settle_timer(500);
+      settle_timer.expired.connect([](Timer*) { Application::app().quit(); });
+      Application::app().exec();
+    }
+
+    unsigned sampleRate(void) const override { return 20 * sat_cnt; }
+
+    size_t process(const float *, size_t) override
+    {
+      ++round;
+      for (size_t i=0; i<factory.rxs.size(); ++i)
+      {
+        float siglev = 10.0f + ((i + round / 64) % sat_cnt);
+        factory.rxs[i]->updateSignalLevel(siglev);
+      }
+      if (round % 64 == 0)
+      {
+          // Run the tasks queued by the voter, like a main loop iteration
+        Timer t(0);
+        t.expired.connect([](Timer*) { Application::app().quit(); });
+        Application::app().exec();
+      }
+      return factory.rxs.size();
+    }
+
+  private:
+    unsigned          sat_cnt;
+    size_t            round = 0;
+    Config            cfg;
+    BenchRxFactory    factory;
+    unique_ptr<Voter> voter;
+    NullSink          null_sink;
+};
+
+
+  /*
+   * Benchmark a number of DTMF decoders of the same type, like on a site
+   * with many receivers. The main loop is not run so a multi channel engine
+   * will process the blocks when its pending queue is full.
+   */
+class DtmfChannelsBenchmark : public Benchmark
+{
+  public:
+    DtmfChannelsBenchmark(const string& type, unsigned ch_cnt)
+    {
+      for (unsigned i=0; i<ch_cnt; ++i)
+      {
+        string name = "BenchDtmf" + to_string(i);
+        cfg.setValue(name, "DTMF_DEC_TYPE", type);
+        DtmfDecoder *dec = DtmfDecoder::create(0, cfg, name);
+        if ((dec == 0) || !dec->initialize())
+        {
+          cerr << "*** ERROR: Could not create DTMF decoder " << type << "\n";
+          exit(1);
+        }
+        decs.emplace_back(dec);
+      }
+    }
+
+    size_t process(const float *samples, size_t count) override
+    {
+      size_t processed = 0;
+      for (auto& dec : decs)
+      {
+        processed += dec->writeSamples(samples, count);
+      }
+      return processed;
+    }
+
+  private:
+    Config                          cfg;
+    vector<unique_ptr<DtmfDecoder>> decs;
+};
+
+
+struct BenchmarkSpec
+{
+  string                      name;
+  function<Benchmark*(void)>  create;
+};
+
+
+Config cfg;
+
+  /*
+   * Create a DTMF decoder of the given type
+   */
+Benchmark *createDtmfBenchmark(const string& type)
+{
+  cfg.setValue("Bench" + type, "DTMF_DEC_TYPE", type);
+  DtmfDecoder *dec = DtmfDecoder::create(0, cfg, "Bench" + type);
+  if ((dec == 0) || !dec->initialize())
+  {
+    delete dec;
+    return 0;
+  }
+  return new SinkBenchmark<DtmfDecoder>(dec);
+} /* createDtmfBenchmark */
+
+
+  /*
+   * Create a software Sel5 decoder for the given tone set
+   */
+Benchmark *createSel5Benchmark(const string& type)
+{
+  cfg.setValue("BenchSel5" + type, "SEL5_DEC_TYPE", "INTERNAL");
+  cfg.setValue("BenchSel5" + type, "SEL5_TYPE", type);
+  Sel5Decoder *dec = Sel5Decoder::create(cfg, "BenchSel5" + type);
+  if ((dec == 0) || !dec->initialize())
+  {
+    delete dec;
+    return 0;
+  }
+  return new SinkBenchmark<Sel5Decoder>(dec);
+} /* createSel5Benchmark */
+
+
+  /*
+   * Create a simulated signal level detector with a randomly varying
+   * signal level
+   */
+Benchmark *createSigLevDetSimBenchmark(void)
+{
+  cfg.setValue("BenchSigLevSim", "SIGLEV_RAND_INTERVAL", "10");
+  cfg.setValue("BenchSigLevSim", "SIGLEV_TOGGLE_INTERVAL", "1000");
+  SigLevDetSim *det = new SigLevDetSim;
+  if (!det->initialize(cfg, "BenchSigLevSim", INTERNAL_SAMPLE_RATE))
+  {
+    delete det;
+    return 0;
+  }
+  det->setContinuousUpdateInterval(50);
+  return new SinkBenchmark<AudioSink>(det);
+} /* createSigLevDetSimBenchmark */
+
+
+  /*
+   * Create a combined squelch using a CTCSS and a VOX sub-squelch
+   */
+Benchmark *createSquelchCombineBenchmark(void)
+{
+  cfg.setValue("BenchRx:CTCSS", "SQL_DET", "CTCSS");
+  cfg.setValue("BenchRx:CTCSS", "CTCSS_FQ", "136.5");
+  cfg.setValue("BenchRx:VOX", "SQL_DET", "VOX");
+  cfg.setValue("BenchRx:VOX", "VOX_FILTER_DEPTH", "20");
+  cfg.setValue("BenchRx:VOX", "VOX_THRESH", "1000");
+  cfg.setValue("BenchRx", "SQL_COMBINE", "BenchRx:CTCSS | BenchRx:VOX");
+  Squelch *sql = createSquelch("COMBINE");
+  if ((sql == 0) || !sql->initialize(cfg, "BenchRx"))
+  {
+    delete sql;
+    return 0;
+  }
+  return new SinkBenchmark<Squelch>(sql);
+} /* createSquelchCombineBenchmark */
+
+
+Benchmark *createEncoderBenchmark(const string& name)
+{
+  AudioEncoder *enc = AudioEncoder::create(name);
+  return (enc != 0) ? new EncoderBenchmark(enc) : 0;
+} /* createEncoderBenchmark */
+
+
+const vector<BenchmarkSpec> benchmarks =
+{
+  { "AudioFilter/BpCh12_300-3500", []() -> Benchmark* {
+      return new SinkBenchmark<AudioFilter>(
+          new AudioFilter("BpCh12/-0.1/300-3500"));
+    }},
+  { "AudioFilter/LpCh9_3500", []() -> Benchmark* {
+      return new SinkBenchmark<AudioFilter>(
+          new AudioFilter("LpCh9/-0.05/3500"));
+    }},
+  { "AudioDecimator/48k-16k", []() -> Benchmark* {
+      return new SinkBenchmark<AudioDecimator>(
+          new AudioDecimator(3, coeff_48_16_wide, coeff_48_16_wide_taps),
+          48000);
+    }},
+  { "AudioDecimator/16k-8k", []() -> Benchmark* {
+      return new SinkBenchmark<AudioDecimator>(
+          new AudioDecimator(2, coeff_16_8, coeff_16_8_taps));
+    }},
+  { "AudioInterpolator/16k-48k", []() -> Benchmark* {
+      return new SinkBenchmark<AudioInterpolator>(
+          new AudioInterpolator(3, coeff_48_16_int, coeff_48_16_int_taps));
+    }},
+  { "AudioFixedDecimator/48k-16k", []() -> Benchmark* {
+      return new SinkBenchmark<AudioProcessor>(
+          new AudioFixedDecimator<3, coeff_48_16_wide_taps>(coeff_48_16_wide),
+          48000);
+    }},
+  { "AudioFixedDecimator/16k-8k", []() -> Benchmark* {
+      return new SinkBenchmark<AudioProcessor>(
+          new AudioFixedDecimator<2, coeff_16_8_taps>(coeff_16_8));
+    }},
+  { "AudioFixedInterpolator/16k-48k", []() -> Benchmark* {
+      return new SinkBenchmark<AudioProcessor>(
+          new AudioFixedInterpolator<3, coeff_48_16_int_taps>(coeff_48_16_int));
+    }},
+  { "AudioNoiseAdder/-20dB", []() -> Benchmark* {
+      return new SinkBenchmark<AudioNoiseAdder>(new AudioNoiseAdder(-20.0f));
+    }},
+  { "Prng/Gaussian", []() -> Benchmark* { return new PrngBenchmark; }},
+  { "SigLevDetSim/rand_10ms", createSigLevDetSimBenchmark },
+  { "ToneDetector/1750", []() -> Benchmark* {
+      return new SinkBenchmark<ToneDetector>(new ToneDetector(1750, 50));
+    }},
+  { "DtmfDecoder/INTERNAL", []() { return createDtmfBenchmark("INTERNAL"); }},
+  { "DtmfDecoder/DH1DM", []() { return createDtmfBenchmark("DH1DM"); }},
+  { "DtmfDecoder/INTERNAL_MULTI", []() {
+      return createDtmfBenchmark("INTERNAL_MULTI");
+    }},
+  { "DtmfDecoder/INTERNAL_16ch", []() -> Benchmark* {
+      return new DtmfChannelsBenchmark("INTERNAL", 16);
+    }},
+  { "DtmfDecoder/INTERNAL_MULTI_16ch", []() -> Benchmark* {
+      return new DtmfChannelsBenchmark("INTERNAL_MULTI", 16);
+    }},
+  { "Sel5Decoder/ZVEI1", []() { return createSel5Benchmark("ZVEI1"); }},
+  { "Sel5Decoder/CCIR", []() { return createSel5Benchmark("CCIR"); }},
+  { "SquelchCombine/CTCSS_VOX", createSquelchCombineBenchmark },
+  { "AudioEncoder/OPUS", []() { return createEncoderBenchmark("OPUS"); }},
+  { "AudioEncoder/GSM", []() { return createEncoderBenchmark("GSM"); }},
+  { "AudioEncoder/SPEEX", []() { return createEncoderBenchmark("SPEEX"); }},
+  { "PfbChannelizer/960k_1bin", []() -> Benchmark* {
+      return new PfbBenchmark(960000, 1);
+    }},
+  { "PfbChannelizer/960k_8bins", []() -> Benchmark* {
+      return new PfbBenchmark(960000, 8);
+    }},
+  { "PfbChannelizer/2400k_8bins", []() -> Benchmark* {
+      return new PfbBenchmark(2400000, 8);
+    }},
+  { "DdrFir/64taps_dec4", []() -> Benchmark* {
+      return new DdrFirBenchmark(64, 4, 960000);
+    }},
+  { "Simd/fir64_generic", []() {
+      return SimdBenchmark::create(SimdBenchmark::KERNEL_FIR,
+                                   Simd::ISA_GENERIC);
+    }},
+  { "Simd/fir64_avx2", []() {
+      return SimdBenchmark::create(SimdBenchmark::KERNEL_FIR, Simd::ISA_AVX2);
+    }},
+  { "Simd/fir64_neon", []() {
+      return SimdBenchmark::create(SimdBenchmark::KERNEL_FIR, Simd::ISA_NEON);
+    }},
+  { "Simd/cmul_generic", []() {
+      return SimdBenchmark::create(SimdBenchmark::KERNEL_COMPLEX_MULTIPLY,
+                                   Simd::ISA_GENERIC);
+    }},
+  { "Simd/cmul_avx2", []() {
+      return SimdBenchmark::create(SimdBenchmark::KERNEL_COMPLEX_MULTIPLY,
+                                   Simd::ISA_AVX2);
+    }},
+  { "Simd/cmul_neon", []() {
+      return SimdBenchmark::create(SimdBenchmark::KERNEL_COMPLEX_MULTIPLY,
+                                   Simd::ISA_NEON);
+    }},
+  { "Simd/s16conv_generic", []() {
+      return SimdBenchmark::create(SimdBenchmark::KERNEL_S16_CONV,
+                                   Simd::ISA_GENERIC);
+    }},
+  { "Simd/s16conv_avx2", []() {
+      return SimdBenchmark::create(SimdBenchmark::KERNEL_S16_CONV,
+                                   Simd::ISA_AVX2);
+    }},
+  { "Simd/s16conv_neon", []() {
+      return SimdBenchmark::create(SimdBenchmark::KERNEL_S16_CONV,
+                                   Simd::ISA_NEON);
+    }},
+  { "Voter/4sats", []() -> Benchmark* { return new VoterBenchmark(4); }},
+  { "Voter/16sats", []() -> Benchmark* { return new VoterBenchmark(16); }},
+  { "VoterEvents/16sats", []() -> Benchmark* {
+      return new VoterEventBenchmark(16);
+    }},
+};
+
+
+struct Result
+{
+  string  name;
+  size_t  samples;
+  double  seconds;
+  double  realtime;
+};
+
+
+  /*
+   * Run one benchmark for at least min_time seconds
+   */
+Result runBenchmark(const string& name, Benchmark& bench,
+                    const vector<float>& signal, size_t block,
+                    double min_time)
+{
+  typedef chrono::steady_clock Clock;
+
+    // Warm up caches and let the objects allocate their buffers
+  size_t pos = 0;
+  for (int i=0; i<16; ++i)
+  {
+    bench.process(&signal[pos], block);
+    pos = (pos + block) % (signal.size() - block);
+  }
+
+  Result result = { name, 0, 0.0, 0.0 };
+  Clock::time_point start = Clock::now();
+  do
+  {
+    for (int i=0; i<64; ++i)
+    {
+      result.samples += bench.process(&signal[pos], block);
+      pos = (pos + block) % (signal.size() - block);
+    }
+    result.seconds = chrono::duration<double>(Clock::now() - start).count();
+  } while (result.seconds < min_time);
+
+  result.realtime = result.samples / result.seconds / bench.sampleRate();
+  return result;
+} /* runBenchmark */
+
+
+void printResult(ostream& os, const Result& result, const string& format,
+                 bool first)
+{
+  const double rate = result.samples / result.seconds;
+  const double ns_per_sample = 1.0e9 * result.seconds / result.samples;
+  if (format == "csv")
+  {
+    if (first)
+    {
+      os << "name,samples,seconds,samples_per_second,ns_per_sample,"
+              "realtime_factor\n";
+    }
+    os << result.name << "," << result.samples << "," << result.seconds
+         << "," << rate << "," << ns_per_sample << "," << result.realtime
+         << "\n";
+  }
+  else if (format == "json")
+  {
+    os << (first ? "[\n" : ",\n")
+         << "  {\"name\": \"" << result.name << "\", "
+         << "\"samples\": " << result.samples << ", "
+         << "\"seconds\": " << result.seconds << ", "
+         << "\"samples_per_second\": " << rate << ", "
+         << "\"ns_per_sample\": " << ns_per_sample << ", "
+         << "\"realtime_factor\": " << result.realtime << "}";
+  }
+  else
+  {
+    if (first)
+    {
+      os << left << setw(30) << "Benchmark" << right
+           << setw(14) << "Samples/s" << setw(12) << "ns/sample"
+           << setw(12) << "x realtime" << "\n";
+    }
+    os << left << setw(30) << result.name << right << fixed
+         << setw(14) << setprecision(0) << rate
+         << setw(12) << setprecision(2) << ns_per_sample
+         << setw(12) << setprecision(1) << result.realtime << "\n";
+  }
+} /* printResult */
+
+
+void usage(const char *prog)
+{
+  cerr << "Usage: " << prog << " [--filter <text>] [--time <seconds>] "
+                               "[--block <samples>]\n"
+       << "       " << string(strlen(prog), ' ')
+       << " [--format table|csv|json] [--list]\n";
+} /* usage */
+
+}; /* anonymous namespace */
+
+
+int main(int argc, const char **argv)
+{
+  string filter;
+  double min_time = 2.0;
+  size_t block = 256;
+  string format("table");
+  for (int i=1; i<argc; ++i)
+  {
+    string arg(argv[i]);
+    if (arg == "--list")
+    {
+      for (const BenchmarkSpec& spec : benchmarks)
+      {
+        cout << spec.name << "\n";
+      }
+      return 0;
+    }
+    else if ((arg == "--filter") && (i+1 < argc))
+    {
+      filter = argv[++i];
+    }
+    else if ((arg == "--time") && (i+1 < argc))
+    {
+      min_time = atof(argv[++i]);
+    }
+    else if ((arg == "--block") && (i+1 < argc))
+    {
+      block = atoi(argv[++i]);
+    }
+    else if ((arg == "--format") && (i+1 < argc))
+    {
+      format = argv[++i];
+    }
+    else
+    {
+      usage(argv[0]);
+      return 1;
+    }
+  }
+  if ((block < 2) || (min_time <= 0.0) ||
+      ((format != "table") && (format != "csv") && (format != "json")))
+  {
+    usage(argv[0]);
+    return 1;
+  }
+
+  CppApplication app;
+
+    // Some of the benchmarked objects print status messages on stdout.
+    // Send those to stderr to keep the results machine readable.
+  ostream out(cout.rdbuf());
+  cout.rdbuf(cerr.rdbuf());
+
+  cerr << "Using " << Simd::isaName(Simd::isa()) << " SIMD kernels\n";
+
+    // The test signal is a mix of DTMF digit 5, a CTCSS tone and noise.
+    // It is long enough to not fit in the cache of small machines.
+  const size_t signal_len = 4 * INTERNAL_SAMPLE_RATE + block;
+  vector<float> signal(signal_len);
+  mt19937 rng(1);
+  normal_distribution<float> noise(0.0f, 0.05f);
+  for (size_t i=0; i<signal.size(); ++i)
+  {
+    float t = static_cast<float>(i) / INTERNAL_SAMPLE_RATE;
+    signal[i] = 0.2f * sinf(2.0f * M_PI * 770.0f * t) +
+                0.2f * sinf(2.0f * M_PI * 1336.0f * t) +
+                0.05f * sinf(2.0f * M_PI * 136.5f * t) + noise(rng);
+  }
+
+  bool first = true;
+  for (const BenchmarkSpec& spec : benchmarks)
+  {
+    if (spec.name.find(filter) == string::npos)
+    {
+      continue;
+    }
+    unique_ptr<Benchmark> bench(spec.create());
+    if (bench == nullptr)
+    {
+      cerr << "*** WARNING: Benchmark " << spec.name
+           << " is not available in this build\n";
+      continue;
+    }
+    Result result = runBenchmark(spec.name, *bench, signal, block, min_time);
+    printResult(out, result, format, first);
+    first = false;
+  }
+  if ((format == "json") && !first)
+  {
+    out << "\n]\n";
+  }
+
+  cout.rdbuf(out.rdbuf());
+
+  return 0;
+} /* main */
+
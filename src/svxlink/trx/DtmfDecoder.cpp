@@ -54,6 +54,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 #include "DtmfDecoder.h"
 #include "Dh1dmSwDtmfDecoder.h"
 #include "SvxSwDtmfDecoder.h"
+#include "MultiChannelDtmfDecoder.h"
 #include "S54sDtmfDecoder.h"
 #include "AfskDtmfDecoder.h"
 #include "PtyDtmfDecoder.h"
@@ -125,6 +126,10 @@ DtmfDecoder *DtmfDecoder::create(Rx *rx, Config &cfg, const string& name)
   {
     dec = new SvxSwDtmfDecoder(cfg, name);
   }
+  else if (type == "INTERNAL_MULTI")
+  {
+    dec = new MultiChannelDtmfDecoder(cfg, name);
+  }
   else if (type == "S54S")
   {
     dec = new S54sDtmfDecoder(cfg, name);
@@ -145,7 +150,8 @@ DtmfDecoder *DtmfDecoder::create(Rx *rx, Config &cfg, const string& name)
   {
     cerr << "*** ERROR: Unknown DTMF decoder type \"" << type << "\" "
          << "specified for " << name << "/DTMF_DEC_TYPE. "
-      	 << "Legal values are: \"NONE\", \"INTERNAL\", \"PTY\" or \"S54S\"\n";
+      	 << "Legal values are: \"NONE\", \"INTERNAL\", \"INTERNAL_MULTI\", "
+         << "\"DH1DM\", \"AFSK\", \"PTY\" or \"S54S\"\n";
   }
   
   return dec;
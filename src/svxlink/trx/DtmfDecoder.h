@@ -116,7 +116,7 @@ class DtmfDecoder : public sigc::trackable, public Async::AudioSink
      * decoder type to create is determined by the configuration pointed
      * out by the arguments to this function. The section pointed out should
      * contain a configuration variable DTMF_DEC_TYPE that points out the
-     * decoder type to use. Valid values are: INTERNAL, S54S
+     * decoder type to use. Valid values are: INTERNAL, INTERNAL_MULTI, S54S
      */
     static DtmfDecoder *create(Rx *rx, Async::Config &cfg, const std::string& name);
     
@@ -6,7 +6,7 @@
 
 \verbatim
 SvxLink - A Multi Purpose Voice Services System for Ham Radio Use
-Copyright (C) 2003-2015 Tobias Blomberg / SM0SVX
+Copyright (C) 2003-2026 Tobias Blomberg / SM0SVX
 
 This program is free software; you can redistribute it and/or modify
 it under the terms of the GNU General Public License as published by
@@ -35,6 +35,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 #include <map>
 #include <utility>
 #include <cmath>
+#include <cstring>
 
 
 /****************************************************************************
@@ -294,6 +295,8 @@ void DtmfEncoder::playNextDigit(void)
   
   low_tone = tone_map[digit].first;
   high_tone = tone_map[digit].second;
+  low_table = Async::AudioToneTable::get(low_tone, sampling_rate);
+  high_table = Async::AudioToneTable::get(high_tone, sampling_rate);
   pos = 0;
   if (length <= 0)
   {
@@ -314,19 +317,16 @@ void DtmfEncoder::writeAudio(void)
   do
   {
     unsigned count = min(BLOCK_SIZE, length - pos);
-    for (unsigned i=0; i<count; ++i)
+    if (low_tone > 0)
     {
-      if (low_tone > 0)
-      {
-      	block[i] = tone_amp * sin(2 * M_PI * low_tone * pos / sampling_rate) +
-      		   tone_amp * sin(2 * M_PI * high_tone * pos / sampling_rate);
-      }
-      else
-      {
-      	block[i] = 0;
-      }
-      ++pos;
+      low_table->read(block, pos, count, tone_amp);
+      high_table->add(block, pos, count, tone_amp);
     }
+    else
+    {
+      memset(block, 0, count * sizeof(*block));
+    }
+    pos += count;
 
     ret = sinkWriteSamples(block, count);
     pos -= (count - ret);
@@ -47,6 +47,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
  ****************************************************************************/
 
 #include <AsyncAudioSource.h>
+#include <AsyncAudioToneTable.h>
 
 
 /****************************************************************************
@@ -223,6 +224,8 @@ class DtmfEncoder : public Async::AudioSource, sigc::trackable
     SendQueue   send_queue;
     unsigned    low_tone;
     unsigned    high_tone;
+    Async::AudioToneTable::Ptr low_table;
+    Async::AudioToneTable::Ptr high_table;
     unsigned    pos;
     unsigned    length;
     bool      	is_playing;
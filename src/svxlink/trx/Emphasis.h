@@ -218,7 +218,9 @@ class PreemphasisFilter : public EmphasisBase
 
         // First we band pass filter the signal to get rid of high and low
         // frequency components. In the 8000 kHz case, only a high pass filter
-        // is needed.
+        // is needed. Since the band pass filter and the pre-emphasis filter
+        // are given in the same filter spec, they are run as one biquad
+        // cascade in a single pass over the audio.
 #if INTERNAL_SAMPLE_RATE >= 16000
       ss << "BpBu4/300-4300 x ";
 #elif INTERNAL_SAMPLE_RATE == 8000
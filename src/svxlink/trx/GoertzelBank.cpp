@@ -0,0 +1,222 @@
+/**
+@file	 GoertzelBank.cpp
+@brief   A bank of Goertzel detectors evaluated together over sample blocks
+@author  Tobias Blomberg / SM0SVX
+@date	 2026-10-14
+
+\verbatim
+SvxLink - A Multi Purpose Voice Services System for Ham Radio Use
+Copyright (C) 2003-2026 Tobias Blomberg / SM0SVX
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+\endverbatim
+*/
+
+
+
+/****************************************************************************
+ *
+ * System Includes
+ *
+ ****************************************************************************/
+
+#include <cmath>
+#include <cstring>
+
+
+/****************************************************************************
+ *
+ * Project Includes
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Local Includes
+ *
+ ****************************************************************************/
+
+#include "GoertzelBank.h"
+
+
+
+/****************************************************************************
+ *
+ * Namespaces to use
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Defines & typedefs
+ *
+ ****************************************************************************/
+
+  // The detectors are processed in groups of GROUP_LEN. The state arrays are
+  // always padded to a multiple of the group length. GCC vector extensions
+  // are used to update a whole group at once where available.
+#if defined(__GNUC__)
+#define GOERTZEL_BANK_VECTOR_EXT
+typedef float VecFloat __attribute__((vector_size(32)));
+static const size_t GROUP_LEN = sizeof(VecFloat) / sizeof(float);
+#else
+static const size_t GROUP_LEN = 8;
+#endif
+
+#if defined(GOERTZEL_BANK_VECTOR_EXT) && defined(__x86_64__) && \
+    defined(__ELF__) && !defined(__clang__)
+#define GOERTZEL_BANK_KERNEL __attribute__((target_clones("avx2", "default")))
+#else
+#define GOERTZEL_BANK_KERNEL
+#endif
+
+
+
+/****************************************************************************
+ *
+ * Local class definitions
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Prototypes
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Exported Global Variables
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Local Global Variables
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Public member functions
+ *
+ ****************************************************************************/
+
+void GoertzelBank::initialize(const std::vector<float>& fqs,
+                              unsigned sample_rate)
+{
+  bin_cnt = fqs.size();
+  const size_t padded_cnt = (bin_cnt + GROUP_LEN - 1) / GROUP_LEN * GROUP_LEN;
+  cosw.assign(padded_cnt, 0.0f);
+  sinw.assign(padded_cnt, 0.0f);
+  two_cosw.assign(padded_cnt, 0.0f);
+  q0.assign(padded_cnt, 0.0f);
+  q1.assign(padded_cnt, 0.0f);
+  for (size_t i=0; i<bin_cnt; ++i)
+  {
+    setFrequency(i, fqs[i], sample_rate);
+  }
+} /* GoertzelBank::initialize */
+
+
+void GoertzelBank::setFrequency(size_t idx, float freq, unsigned sample_rate)
+{
+  float w = 2.0f * M_PI * (freq / (float)sample_rate);
+  cosw[idx] = cosf(w);
+  sinw[idx] = sinf(w);
+  two_cosw[idx] = 2.0f * cosw[idx];
+  q0[idx] = q1[idx] = 0.0f;
+} /* GoertzelBank::setFrequency */
+
+
+void GoertzelBank::reset(void)
+{
+  q0.assign(q0.size(), 0.0f);
+  q1.assign(q1.size(), 0.0f);
+} /* GoertzelBank::reset */
+
+
+GOERTZEL_BANK_KERNEL
+void GoertzelBank::calc(const float *samples, size_t count, const float *win)
+{
+    // Each group of detectors is run through the whole buffer so that the
+    // state can be kept in registers during the loop
+  for (size_t base=0; base<q0.size(); base+=GROUP_LEN)
+  {
+#ifdef GOERTZEL_BANK_VECTOR_EXT
+    VecFloat c, s0, s1;
+    memcpy(&c, &two_cosw[base], sizeof(c));
+    memcpy(&s0, &q0[base], sizeof(s0));
+    memcpy(&s1, &q1[base], sizeof(s1));
+    for (size_t n=0; n<count; ++n)
+    {
+      const float sample = (win != 0) ? samples[n] * win[n] : samples[n];
+      VecFloat s2 = s1;
+      s1 = s0;
+      s0 = c * s1 - s2 + sample;
+    }
+    memcpy(&q0[base], &s0, sizeof(s0));
+    memcpy(&q1[base], &s1, sizeof(s1));
+#else
+    float *s0 = &q0[base];
+    float *s1 = &q1[base];
+    const float *c = &two_cosw[base];
+    for (size_t n=0; n<count; ++n)
+    {
+      const float sample = (win != 0) ? samples[n] * win[n] : samples[n];
+      for (size_t k=0; k<GROUP_LEN; ++k)
+      {
+        float s2 = s1[k];
+        s1[k] = s0[k];
+        s0[k] = c[k] * s1[k] - s2 + sample;
+      }
+    }
+#endif
+  }
+} /* GoertzelBank::calc */
+
+
+
+/****************************************************************************
+ *
+ * Protected member functions
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Private member functions
+ *
+ ****************************************************************************/
+
+
+
+/*
+ * This file has not been truncated
+ */
@@ -0,0 +1,246 @@
+/**
+@file	 GoertzelBank.h
+@brief   A bank of Goertzel detectors evaluated together over sample blocks
+@author  Tobias Blomberg / SM0SVX
+@date	 2026-10-14
+
+\verbatim
+SvxLink - A Multi Purpose Voice Services System for Ham Radio Use
+Copyright (C) 2003-2026 Tobias Blomberg / SM0SVX
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+\endverbatim
+*/
+
+
+#ifndef GOERTZEL_BANK_INCLUDED
+#define GOERTZEL_BANK_INCLUDED
+
+
+/****************************************************************************
+ *
+ * System Includes
+ *
+ ****************************************************************************/
+
+#include <cstddef>
+#include <vector>
+#include <complex>
+
+
+/****************************************************************************
+ *
+ * Project Includes
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Local Includes
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Forward declarations
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Namespace
+ *
+ ****************************************************************************/
+
+//namespace MyNameSpace
+//{
+
+
+/****************************************************************************
+ *
+ * Forward declarations of classes inside of the declared namespace
+ *
+ ****************************************************************************/
+
+  
+
+/****************************************************************************
+ *
+ * Defines & typedefs
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Exported Global Variables
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Class definitions
+ *
+ ****************************************************************************/
+
+/**
+@brief	A bank of Goertzel detectors evaluated together over sample blocks
+@author Tobias Blomberg / SM0SVX
+@date   2026-10-14
+
+This class implement the same algorithm as the Goertzel class but for a
+number of frequencies at the same time. Instead of updating each detector
+sample by sample, a whole buffer of samples is run through all detectors in
+one call. The detector states are stored in contiguous arrays so that the
+compiler can update a number of detectors in parallel using SIMD
+instructions. An optional window, shared by all detectors, can be applied to
+the samples in the same pass.
+
+See the Goertzel class documentation for information on how to choose the
+block length and how to interpret the magnitude squared values.
+
+A typical usage would be to initialize the bank with the frequencies of
+interest, call "reset" at the start of each block, call "calc" one or more
+times until the block is complete and then read the results out using the
+"magnitudeSquared" or "result" functions.
+*/
+class GoertzelBank
+{
+  public:
+    /**
+     * @brief 	Default constuctor
+     *
+     * This constructor will create an empty bank. Use the initialize method
+     * to set up the frequencies later.
+     */
+    GoertzelBank(void) : bin_cnt(0) {}
+
+    /**
+     * @brief 	Constuctor
+     * @param   fqs         The frequencies of interest, in Hz
+     * @param   sample_rate The sample rate used
+     */
+    GoertzelBank(const std::vector<float>& fqs, unsigned sample_rate)
+      : bin_cnt(0)
+    {
+      initialize(fqs, sample_rate);
+    }
+
+    /**
+     * @brief 	Destructor
+     */
+    ~GoertzelBank(void) {}
+
+    /**
+     * @brief  Initialize the bank
+     * @param  fqs         The frequencies of interest, in Hz
+     * @param  sample_rate The sample rate used
+     *
+     * This method will initialize the bank with one detector for each given
+     * frequency. Detector i will be associated with fqs[i]. It may be called
+     * more than once if something need to be changed.
+     */
+    void initialize(const std::vector<float>& fqs, unsigned sample_rate);
+
+    /**
+     * @brief  Change the frequency of a single detector
+     * @param  idx         The index of the detector
+     * @param  freq        The new frequency, in Hz
+     * @param  sample_rate The sample rate used
+     *
+     * The state of the detector is reset.
+     */
+    void setFrequency(size_t idx, float freq, unsigned sample_rate);
+
+    /**
+     * @brief  Get the number of detectors in the bank
+     * @return Returns the number of detectors
+     */
+    size_t size(void) const { return bin_cnt; }
+
+    /**
+     * @brief 	Reset the state variables for all detectors
+     */
+    void reset(void);
+
+    /**
+     * @brief 	Run a buffer of samples through all detectors
+     * @param 	samples The samples to process
+     * @param   count   The number of samples in the buffer
+     * @param   win     Window coefficients to apply to the samples, or 0
+     *
+     * If a window is given it must contain at least count coefficients.
+     * Sample n is multiplied by win[n] before being processed.
+     */
+    void calc(const float *samples, size_t count, const float *win=0);
+
+    /**
+     * @brief  Calculate the final result in complex form for one detector
+     * @param  idx The index of the detector
+     * @return Returns the final result in complex form
+     */
+    std::complex<float> result(size_t idx) const
+    {
+      return std::complex<float>(cosw[idx] * q0[idx] - q1[idx],
+                                 sinw[idx] * q0[idx]);
+    }
+
+    /**
+     * @brief  Calculate the phase for one detector
+     * @param  idx The index of the detector
+     * @return Returns the phase of the DFT
+     */
+    float phase(size_t idx) const { return std::arg(result(idx)); }
+
+    /**
+     * @brief 	Read back the magnitude squared for one detector
+     * @param   idx The index of the detector
+     * @return	Returns the magnitude squared
+     */
+    float magnitudeSquared(size_t idx) const
+    {
+      return q0[idx] * q0[idx] + q1[idx] * q1[idx] -
+             q0[idx] * q1[idx] * two_cosw[idx];
+    }
+
+  private:
+    size_t              bin_cnt;
+    std::vector<float>  cosw;
+    std::vector<float>  sinw;
+    std::vector<float>  two_cosw;
+    std::vector<float>  q0;
+    std::vector<float>  q1;
+
+};  /* class GoertzelBank */
+
+
+//} /* namespace */
+
+#endif /* GOERTZEL_BANK_INCLUDED */
+
+
+
+/*
+ * This file has not been truncated
+ */
@@ -6,7 +6,7 @@
 
 \verbatim
 SvxLink - A Multi Purpose Voice Services System for Ham Radio Use
-Copyright (C) 2003-2024 Tobias Blomberg / SM0SVX
+Copyright (C) 2003-2026 Tobias Blomberg / SM0SVX
 
 This program is free software; you can redistribute it and/or modify
 it under the terms of the GNU General Public License as published by
@@ -36,6 +36,8 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 
 #include <iostream>
 #include <string>
+#include <vector>
+#include <memory>
 
 
 /****************************************************************************
@@ -45,6 +47,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
  ****************************************************************************/
 
 #include <AsyncConfig.h>
+#include <AsyncAudioProcessorChain.h>
 #ifdef LADSPA_VERSION
 #include <AsyncAudioLADSPAPlugin.h>
 #endif
@@ -124,6 +127,9 @@ class LADSPAPluginLoader
       std::vector<std::string> ladspa_plugin_cfg;
       if (cfg.getValue(sec, "LADSPA_PLUGINS", ladspa_plugin_cfg))
       {
+        unsigned block_size = 0;
+        cfg.getValue(sec, "LADSPA_BLOCK_SIZE", block_size);
+        m_chain = new Async::AudioProcessorChain;
         for (const auto& pcfg : ladspa_plugin_cfg)
         {
           std::istringstream is(pcfg);
@@ -133,6 +139,7 @@ class LADSPAPluginLoader
           if (label[0] == '@')
           {
             std::string subsec = label.substr(1);
+            m_sections.push_back(subsec);
             if (!cfg.getValue(subsec, "LABEL", label))
             {
               std::cerr << "*** ERROR: The " << subsec
@@ -164,9 +171,14 @@ class LADSPAPluginLoader
                             << subsec << "'" << std::endl;
                   return false;
                 }
+                auto valid = m_valid;
                 cfg.subscribeValue(subsec, port_name, 0,
                     [=](LADSPA_Data val)
                     {
+                      if (!*valid)
+                      {
+                        return;
+                      }
                       plug->setControl(port_num, val);
                       //plug->print(std::string("### ") + sec + ": ");
                     });
@@ -216,29 +228,48 @@ class LADSPAPluginLoader
 
           plug->print(sec + ": ");
 
-          if (m_chain_src == nullptr)
-          {
-            m_chain_sink = plug;
-          }
-          else
-          {
-            m_chain_src->registerSink(plug, true);
-          }
-          m_chain_src = plug;
+          plug->setBlockSize(block_size);
+          m_chain->addStage(plug, true, plug->label());
         }
       }
 #endif
       return true;
     } /* load */
 
-    Async::AudioSink* chainSink(void) { return m_chain_sink; }
-    Async::AudioSource* chainSource(void) { return m_chain_src; }
+    /**
+     * @brief   Get the loaded plugin chain
+     * @return  Returns the chain or \em nullptr if no plugins are configured
+     *
+     * All plugins are run one after the other in an audio processor chain,
+     * which may be run in a worker thread. The chain is owned by the caller.
+     */
+    Async::AudioProcessorChain* chain(void) { return m_chain; }
+
+    Async::AudioSink* chainSink(void) { return m_chain; }
+    Async::AudioSource* chainSource(void) { return m_chain; }
+
+    /**
+     * @brief   Get the plugin configuration sections that was used
+     * @return  Returns the sections referenced using the "@" syntax
+     */
+    const std::vector<std::string>& sections(void) const { return m_sections; }
+
+    /**
+     * @brief   Get the flag that guard the configuration subscriptions
+     * @return  Returns a shared flag that is \em true while the chain exist
+     *
+     * Configuration variable subscriptions cannot be removed so they are still
+     * active after the chain has been deleted. Set the flag to \em false
+     * before deleting the chain to make the subscriptions do nothing.
+     */
+    std::shared_ptr<bool> validFlag(void) const { return m_valid; }
 
   protected:
 
   private:
-    Async::AudioSink*   m_chain_sink  = nullptr;
-    Async::AudioSource* m_chain_src   = nullptr;
+    Async::AudioProcessorChain* m_chain = nullptr;
+    std::vector<std::string>    m_sections;
+    std::shared_ptr<bool>       m_valid = std::make_shared<bool>(true);
 
 };  /* class LADSPAPluginLoader */
 
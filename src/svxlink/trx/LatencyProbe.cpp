@@ -0,0 +1,277 @@
+/**
+@file	 LatencyProbe.cpp
+@brief   Measure the audio latency from network ingress to the audio device
+@author  Tobias Blomberg / SM0SVX
+@date	 2026-10-14
+
+\verbatim
+SvxLink - A Multi Purpose Voice Services System for Ham Radio Use
+Copyright (C) 2003-2026 Tobias Blomberg / SM0SVX
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+\endverbatim
+*/
+
+
+
+/****************************************************************************
+ *
+ * System Includes
+ *
+ ****************************************************************************/
+
+#include <chrono>
+#include <deque>
+#include <iostream>
+#include <iomanip>
+#include <algorithm>
+#include <limits>
+
+
+/****************************************************************************
+ *
+ * Project Includes
+ *
+ ****************************************************************************/
+
+#include <AsyncAudioStats.h>
+
+
+/****************************************************************************
+ *
+ * Local Includes
+ *
+ ****************************************************************************/
+
+#include "LatencyProbe.h"
+
+
+
+/****************************************************************************
+ *
+ * Namespaces to use
+ *
+ ****************************************************************************/
+
+using namespace std;
+
+
+
+/****************************************************************************
+ *
+ * Defines & typedefs
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Local class definitions
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Prototypes
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Exported Global Variables
+ *
+ ****************************************************************************/
+
+
+
+
+/****************************************************************************
+ *
+ * Local Global Variables
+ *
+ ****************************************************************************/
+
+namespace {
+  struct IngressFrame
+  {
+    double    time;
+    uint64_t  pos;
+  };
+
+  const size_t              MAX_INGRESS_FRAMES = 1000;
+  const double              MAX_LATENCY = 5000.0; // milliseconds
+
+  std::deque<IngressFrame>  ingress_frames;
+  uint64_t                  ingress_pos = 0;
+  unsigned                  egress_probe_cnt = 0;
+
+  double monotonicTime(void)
+  {
+    return std::chrono::duration<double, std::milli>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+  }
+};
+
+
+
+/****************************************************************************
+ *
+ * Public member functions
+ *
+ ****************************************************************************/
+
+LatencyProbe::LatencyProbe(Type type, const std::string& name)
+  : m_type(type), m_name(name), m_ingress_marked(false), m_ingress_time(0.0),
+    m_egress_pos(0), m_stats(0)
+{
+  resetStats();
+  if (m_type == EGRESS)
+  {
+    ++egress_probe_cnt;
+  }
+} /* LatencyProbe::LatencyProbe */
+
+
+LatencyProbe::~LatencyProbe(void)
+{
+  if (m_type == EGRESS)
+  {
+    if (--egress_probe_cnt == 0)
+    {
+      ingress_frames.clear();
+    }
+  }
+} /* LatencyProbe::~LatencyProbe */
+
+
+void LatencyProbe::markIngress(void)
+{
+  if (egress_probe_cnt > 0)
+  {
+    m_ingress_time = monotonicTime();
+    m_ingress_marked = true;
+  }
+} /* LatencyProbe::markIngress */
+
+
+void LatencyProbe::printStats(void)
+{
+  if (m_frame_cnt > 0)
+  {
+    std::cout << m_name << ": Audio latency from network ingress to audio "
+                 "device: min=" << std::fixed << std::setprecision(1)
+              << m_min << "ms avg=" << (m_sum / m_frame_cnt) << "ms max="
+              << m_max << "ms (" << m_frame_cnt << " frames)"
+              << std::defaultfloat << std::endl;
+  }
+  resetStats();
+} /* LatencyProbe::printStats */
+
+
+int LatencyProbe::writeSamples(const float *samples, int count)
+{
+  if (egress_probe_cnt == 0)
+  {
+    return AudioPassthrough::writeSamples(samples, count);
+  }
+
+  if (m_type == INGRESS)
+  {
+    double time = m_ingress_marked ? m_ingress_time : monotonicTime();
+    m_ingress_marked = false;
+    int ret = AudioPassthrough::writeSamples(samples, count);
+    if (ret > 0)
+    {
+      ingress_frames.push_back({time, ingress_pos});
+      if (ingress_frames.size() > MAX_INGRESS_FRAMES)
+      {
+        ingress_frames.pop_front();
+      }
+      ingress_pos += ret;
+    }
+    return ret;
+  }
+
+  int ret = AudioPassthrough::writeSamples(samples, count);
+  const double now = monotonicTime();
+
+    // Frames older than MAX_LATENCY are assumed to never have reached
+    // this transmitter
+  while (!ingress_frames.empty() &&
+         (now - ingress_frames.front().time > MAX_LATENCY))
+  {
+    ingress_frames.pop_front();
+  }
+  if (ingress_frames.empty())
+  {
+      // No network audio in transit so this is audio from another source.
+      // Align the stream positions so that the next frame is measured
+      // correctly.
+    m_egress_pos = ingress_pos;
+    return ret;
+  }
+
+  m_egress_pos += ret;
+  while (!ingress_frames.empty() && (ingress_frames.front().pos < m_egress_pos))
+  {
+    double latency = now - ingress_frames.front().time;
+    ingress_frames.pop_front();
+    m_sum += latency;
+    m_min = std::min(m_min, latency);
+    m_max = std::max(m_max, latency);
+    ++m_frame_cnt;
+    if (m_stats != 0)
+    {
+      m_stats->observeLatency(latency);
+    }
+  }
+
+  return ret;
+} /* LatencyProbe::writeSamples */
+
+
+
+/****************************************************************************
+ *
+ * Protected member functions
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Private member functions
+ *
+ ****************************************************************************/
+
+void LatencyProbe::resetStats(void)
+{
+  m_frame_cnt = 0;
+  m_sum = 0.0;
+  m_min = std::numeric_limits<double>::max();
+  m_max = 0.0;
+} /* LatencyProbe::resetStats */
+
+
+
+/*
+ * This file has not been truncated
+ */
@@ -0,0 +1,214 @@
+/**
+@file	 LatencyProbe.h
+@brief   Measure the audio latency from network ingress to the audio device
+@author  Tobias Blomberg / SM0SVX
+@date	 2026-10-14
+
+\verbatim
+SvxLink - A Multi Purpose Voice Services System for Ham Radio Use
+Copyright (C) 2003-2026 Tobias Blomberg / SM0SVX
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+\endverbatim
+*/
+
+#ifndef LATENCY_PROBE_INCLUDED
+#define LATENCY_PROBE_INCLUDED
+
+
+/****************************************************************************
+ *
+ * System Includes
+ *
+ ****************************************************************************/
+
+#include <stdint.h>
+#include <string>
+
+
+/****************************************************************************
+ *
+ * Project Includes
+ *
+ ****************************************************************************/
+
+#include <AsyncAudioPassthrough.h>
+
+
+/****************************************************************************
+ *
+ * Local Includes
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Forward declarations
+ *
+ ****************************************************************************/
+
+namespace Async
+{
+  class AudioStats;
+};
+
+
+/****************************************************************************
+ *
+ * Namespace
+ *
+ ****************************************************************************/
+
+//namespace MyNameSpace
+//{
+
+
+/****************************************************************************
+ *
+ * Forward declarations of classes inside of the declared namespace
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Defines & typedefs
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Exported Global Variables
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Class definitions
+ *
+ ****************************************************************************/
+
+/**
+@brief	Measure the audio latency from network ingress to the audio device
+@author Tobias Blomberg / SM0SVX
+@date   2026-10-14
+
+Two kinds of probes are used together. An ingress probe is put directly
+after the audio decoder in a network logic core, like the ReflectorLogic,
+and an egress probe is put at the end of the audio pipe in a transmitter,
+just before the samples are handed over to the audio device. The ingress
+probe record the arrival time and stream position of each received
+audio frame. When the egress probe has passed the same number of samples the
+latency for that frame is calculated.
+
+The measurement assume that all samples written to the ingress probe come
+out at the egress probe, which is true as long as the transmitter only
+send the audio from the network. When the egress probe see audio that have
+no recorded ingress frames, like announcements, the positions are aligned
+again. Only one egress probe should be active at a time. The probes are
+passthrough objects so they do not affect the audio in any way.
+*/
+class LatencyProbe : public Async::AudioPassthrough
+{
+  public:
+    typedef enum
+    {
+      INGRESS,  ///< Record the arrival time of audio frames
+      EGRESS    ///< Calculate the latency of the recorded frames
+    } Type;
+
+    /**
+     * @brief   Constructor
+     * @param   type The type of probe
+     * @param   name The name used when printing statistics
+     */
+    LatencyProbe(Type type, const std::string& name="");
+
+    /**
+     * @brief   Destructor
+     */
+    ~LatencyProbe(void);
+
+    /**
+     * @brief   Set the arrival time of the next audio frame
+     *
+     * Call this function, for an ingress probe, when an audio frame is
+     * received from the network, before it is decoded. If not called, the
+     * time the decoded samples are written to the probe is used.
+     */
+    void markIngress(void);
+
+    /**
+     * @brief   Print and reset the latency statistics
+     *
+     * Print the minimum, average and maximum latency seen by an egress
+     * probe since the last call. Nothing is printed if no frames have been
+     * measured.
+     */
+    void printStats(void);
+
+    /**
+     * @brief   Set the object to report audio health statistics to
+     * @param   stats The statistics object or 0 to disable reporting
+     *
+     * The latency of each frame measured by an egress probe is added to the
+     * latency histogram of the statistics object. The object is not owned
+     * by the probe.
+     */
+    void setStats(Async::AudioStats *stats) { m_stats = stats; }
+
+    /**
+     * @brief   Write samples into this audio sink
+     * @param   samples The buffer containing the samples
+     * @param   count The number of samples in the buffer
+     * @return  Returns the number of samples that has been taken care of
+     */
+    virtual int writeSamples(const float *samples, int count);
+
+  private:
+    Type        m_type;
+    std::string m_name;
+    bool        m_ingress_marked;
+    double      m_ingress_time;
+    uint64_t    m_egress_pos;
+    unsigned    m_frame_cnt;
+    double      m_sum;
+    double      m_min;
+    double      m_max;
+    Async::AudioStats* m_stats;
+
+    LatencyProbe(const LatencyProbe&);
+    LatencyProbe& operator=(const LatencyProbe&);
+    void resetStats(void);
+
+};  /* class LatencyProbe */
+
+
+//} /* namespace */
+
+#endif /* LATENCY_PROBE_INCLUDED */
+
+
+
+/*
+ * This file has not been truncated
+ */
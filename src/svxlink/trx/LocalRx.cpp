@@ -206,6 +206,12 @@ void LocalRx::setModulation(Modulation::Type mod)
 } /* LocalRx::setModulation */
 
 
+unsigned long LocalRx::audioOverrunCount(void) const
+{
+  return (audio_io != 0) ? audio_io->captureXrunCount() : 0;
+} /* LocalRx::audioOverrunCount */
+
+
 /****************************************************************************
  *
  * Protected member functions
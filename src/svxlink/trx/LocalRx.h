@@ -151,6 +151,12 @@ class LocalRx : public LocalRxBase
      */
     virtual void setModulation(Modulation::Type mod);
 
+    /**
+     * @brief   Get the number of audio overruns
+     * @return  Returns the number of capture overruns on the sound card
+     */
+    virtual unsigned long audioOverrunCount(void) const;
+
   protected:
     /**
      * @brief   Open the audio input source
@@ -10,7 +10,7 @@ the SvxLink core is running. It can also be a DDR (Digital Drop Receiver).
 
 \verbatim
 SvxLink - A Multi Purpose Voice Services System for Ham Radio Use
-Copyright (C) 2003-2024 Tobias Blomberg / SM0SVX
+Copyright (C) 2003-2026 Tobias Blomberg / SM0SVX
 
 This program is free software; you can redistribute it and/or modify
 it under the terms of the GNU General Public License as published by
@@ -50,14 +50,17 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
  *
  ****************************************************************************/
 
+#include <AsyncApplication.h>
 #include <AsyncConfig.h>
 #include <AsyncAudioIO.h>
 #include <AsyncAudioFilter.h>
 #include <AsyncAudioSplitter.h>
 #include <AsyncAudioAmp.h>
 #include <AsyncAudioPassthrough.h>
-#include <AsyncAudioDecimator.h>
+#include <AsyncAudioFixedDecimator.h>
 #include <AsyncAudioClipper.h>
+#include <AsyncAudioProcessorChain.h>
+#include <AsyncAudioWorkerStage.h>
 #include <AsyncAudioCompressor.h>
 #include <AsyncAudioFifo.h>
 #include <AsyncAudioStreamStateDetector.h>
@@ -116,31 +119,30 @@ using namespace Async;
  *
  ****************************************************************************/
 
-class PeakMeter : public AudioPassthrough
+class PeakMeter : public AudioProcessor
 {
   public:
     PeakMeter(const string& name) : name(name) {}
-    
-    int writeSamples(const float *samples, int count)
+  
+  protected:
+    void processSamples(float *dest, const float *src, int count)
     {
-      int ret = sinkWriteSamples(samples, count);
+      memcpy(dest, src, count * sizeof(*dest));
       
       int i;
-      for (i=0; i<ret; ++i)
+      for (i=0; i<count; ++i)
       {
-      	if (abs(samples[i]) > 0.997)
+      	if (abs(src[i]) > 0.997)
 	{
 	  break;
 	}
       }
       
-      if (i < ret)
+      if (i < count)
       {
       	cout << name
 	     << ": Distortion detected! Please lower the input volume!\n";
       }
-      
-      return ret;
     }
   
   private:
@@ -238,7 +240,9 @@ LocalRxBase::LocalRxBase(Config &cfg, const std::string& name)
     tone_dets(0), sql_valve(0), delay(0), sql_tail_elim(0),
     preamp_gain(0), mute_valve(0), sql_hangtime(0), sql_extended_hangtime(0),
     sql_extended_hangtime_thresh(0), input_fifo(0), dtmf_muting_pre(0),
-    ob_afsk_deframer(0), ib_afsk_deframer(0), audio_dev_keep_open(false)
+    ob_afsk_deframer(0), ib_afsk_deframer(0), audio_dev_keep_open(false),
+    preamp(0), limiter(0), filter_in(0), filter_out(0), ladspa_stage(0),
+    filter_reload_pending(false)
 {
 } /* LocalRxBase::LocalRxBase */
 
@@ -248,6 +252,12 @@ LocalRxBase::~LocalRxBase(void)
   clearHandler();
   delete input_fifo;  // This will delete the whole chain of audio objects
   input_fifo = 0;
+  if (ladspa_valid != nullptr)
+  {
+    *ladspa_valid = false;
+  }
+  delete filter_out;  // The output chain is not owned by the filter chain
+  filter_out = 0;
   delete ob_afsk_deframer;
   ob_afsk_deframer = 0;
   delete ib_afsk_deframer;
@@ -283,6 +293,21 @@ bool LocalRxBase::initialize(void)
   
   bool peak_meter = false;
   cfg().getValue(name(), "PEAK_METER", peak_meter);
+
+    // The filters and decimators may be run in worker threads that are
+    // shared by all local receivers
+  unsigned worker_threads = 0;
+  cfg().getValue("GLOBAL", "RX_WORKER_THREADS", worker_threads);
+  if (worker_threads > 0)
+  {
+    worker_group = sharedWorkerGroup(worker_threads);
+    if (!worker_group->initOk())
+    {
+      cerr << "*** ERROR: Could not start the receiver worker threads for "
+           << name() << endl;
+      return false;
+    }
+  }
   
     // Get the audio source object
   AudioSource *prev_src = audioSource();
@@ -319,32 +344,33 @@ bool LocalRxBase::initialize(void)
     raw_audio_splitter->addSink(udp, true);
   }
   
+    // The preamp, the peak meter and the first decimator have no other
+    // consumers in between so they are run in one pass by a processor chain
+  AudioProcessorChain *input_chain = new AudioProcessorChain;
+
     // If a preamp was configured, create it
   if (preamp_gain != 0)
   {
-    AudioAmp *preamp = new AudioAmp;
+    preamp = new AudioAmp;
     preamp->setGain(preamp_gain);
-    prev_src->registerSink(preamp, true);
-    prev_src = preamp;
+    input_chain->addStage(preamp, true, "preamp");
   }
   
     // If a peak meter was configured, create it
   if (peak_meter)
   {
-    PeakMeter *peak_meter = new PeakMeter(name());
-    prev_src->registerSink(peak_meter, true);
-    prev_src = peak_meter;
+    input_chain->addStage(new PeakMeter(name()), true, "peak_meter");
   }
   
     // If the sound card sample rate is higher than 16kHz (48kHz assumed),
     // decimate it down to 16kHz
   if (audioSampleRate() > 16000)
   {
-    AudioDecimator *d1 = new AudioDecimator(3, coeff_48_16_wide,
-					    coeff_48_16_wide_taps);
-    prev_src->registerSink(d1, true);
-    prev_src = d1;
+    AudioProcessor *d1 =
+      new AudioFixedDecimator<3, coeff_48_16_wide_taps>(coeff_48_16_wide);
+    input_chain->addStage(d1, true, "decimator");
   }
+  prev_src = addProcessorChain(prev_src, input_chain);
 
   AudioSplitter *siglevdet_splitter = 0;
   siglevdet_splitter = new AudioSplitter;
@@ -369,15 +395,18 @@ bool LocalRxBase::initialize(void)
   siglevdet_splitter->addSink(siglevdet_splitter_pass, true);
   prev_src = siglevdet_splitter_pass;
 
+    // The second decimator and the deemphasis filter are run in one pass too
+  AudioProcessorChain *voice_chain = new AudioProcessorChain;
+
 #if (INTERNAL_SAMPLE_RATE != 16000)
     // If the sound card sample rate is higher than 8kHz (16 or 48kHz assumed)
     // decimate it down to 8kHz.
     // 16kHz audio to other consumers.
   if (audioSampleRate() > 8000)
   {
-    AudioDecimator *d2 = new AudioDecimator(2, coeff_16_8, coeff_16_8_taps);
-    prev_src->registerSink(d2, true);
-    prev_src = d2;
+    AudioProcessor *d2 =
+      new AudioFixedDecimator<2, coeff_16_8_taps>(coeff_16_8);
+    voice_chain->addStage(d2, true, "decimator");
   }
 #endif
 
@@ -392,9 +421,9 @@ bool LocalRxBase::initialize(void)
     //deemph_filt->setOutputGain(7.0f);
 
     DeemphasisFilter *deemph_filt = new DeemphasisFilter;
-    prev_src->registerSink(deemph_filt, true);
-    prev_src = deemph_filt;
+    voice_chain->addStage(deemph_filt, true, "deemphasis");
   }
+  prev_src = addProcessorChain(prev_src, voice_chain);
   
     // Create a splitter to distribute full bandwidth audio to all consumers
   fullband_splitter = new AudioSplitter;
@@ -487,8 +516,8 @@ bool LocalRxBase::initialize(void)
     ob_afsk_deframer = new HdlcDeframer;
     ob_afsk_deframer->frameReceived.connect(
         mem_fun(*this, &LocalRxBase::dataFrameReceived));
-    sync->bitsReceived.connect(
-        mem_fun(*ob_afsk_deframer, &HdlcDeframer::bitsReceived));
+    sync->packedBitsReceived.connect(
+        mem_fun(*ob_afsk_deframer, &HdlcDeframer::packedBitsReceived));
   }
 
   bool ib_afsk_enable = false;
@@ -513,8 +542,8 @@ bool LocalRxBase::initialize(void)
     ib_afsk_deframer = new HdlcDeframer;
     ib_afsk_deframer->frameReceived.connect(
         mem_fun(*this, &LocalRxBase::dataFrameReceivedIb));
-    sync->bitsReceived.connect(
-        mem_fun(*ib_afsk_deframer, &HdlcDeframer::bitsReceived));
+    sync->packedBitsReceived.connect(
+        mem_fun(*ib_afsk_deframer, &HdlcDeframer::packedBitsReceived));
   }
 
     // Create a new audio splitter to handle tone detectors
@@ -529,18 +558,24 @@ bool LocalRxBase::initialize(void)
 #else
   AudioFilter *voiceband_filter = new AudioFilter("BpCh12/-0.1/300-3500");
 #endif
-  prev_src->registerSink(voiceband_filter, true);
-  prev_src = voiceband_filter;
+  prev_src = addProcessor(prev_src, voiceband_filter);
 
     // Create an audio splitter to distribute the voiceband audio to all
-    // other consumers
-  AudioSplitter *voiceband_splitter = new AudioSplitter;
-  prev_src->registerSink(voiceband_splitter, true);
-  prev_src = voiceband_splitter;
-
-    // Create the configured type of DTMF decoder and add it to the splitter
+    // other consumers. It is only needed if there are any voiceband
+    // detectors configured.
   string dtmf_dec_type("NONE");
   cfg().getValue(name(), "DTMF_DEC_TYPE", dtmf_dec_type);
+  string sel5_dec_type("NONE");
+  cfg().getValue(name(), "SEL5_DEC_TYPE", sel5_dec_type);
+  AudioSplitter *voiceband_splitter = 0;
+  if ((dtmf_dec_type != "NONE") || (sel5_dec_type != "NONE") || mute_1750)
+  {
+    voiceband_splitter = new AudioSplitter;
+    prev_src->registerSink(voiceband_splitter, true);
+    prev_src = voiceband_splitter;
+  }
+
+    // Create the configured type of DTMF decoder and add it to the splitter
   if (dtmf_dec_type != "NONE")
   {
     DtmfDecoder *dtmf_dec = DtmfDecoder::create(this, cfg(), name());
@@ -566,8 +601,6 @@ bool LocalRxBase::initialize(void)
   }
   
     // Create a selective multiple tone detector object
-  string sel5_dec_type("NONE");
-  cfg().getValue(name(), "SEL5_DEC_TYPE", sel5_dec_type);
   if (sel5_dec_type != "NONE")
   {
     Sel5Decoder *sel5_dec = Sel5Decoder::create(cfg(), name());
@@ -602,42 +635,45 @@ bool LocalRxBase::initialize(void)
     std::cout << name() << ": Delay line (for DTMF muting etc) set to "
               << delay_line_len << " ms" << std::endl;
     delay = new AudioDelayLine(delay_line_len);
+    delay->setZeroCopy(true);
     prev_src->registerSink(delay, true);
     prev_src = delay;
   }
 
-  LADSPAPluginLoader ladspa_plug_loader;
-  if (!ladspa_plug_loader.load(cfg(), name()))
+    // The LADSPA plugin chain is put between two passthrough objects so
+    // that it can be rebuilt when the configuration is reloaded
+  filter_in = new AudioPassthrough;
+  prev_src->registerSink(filter_in, true);
+  filter_out = new AudioPassthrough;
+  if (!loadFilterChain())
   {
-    delete ladspa_plug_loader.chainSink();
     return false;
   }
-  if (ladspa_plug_loader.chainSink() != nullptr)
-  {
-    prev_src->registerSink(ladspa_plug_loader.chainSink(), true);
-    prev_src = ladspa_plug_loader.chainSource();
-  }
+  prev_src = filter_out;
+
+    // The last stages only process the samples one after the other so they
+    // are run in one pass by a processor chain
+  AudioProcessorChain *output_chain = new AudioProcessorChain;
+  prev_src = addProcessor(prev_src, output_chain);
 
     // Add a limiter to smoothly limit the audio before hard clipping it
   double limiter_thresh = DEFAULT_LIMITER_THRESH;
   cfg().getValue(name(), "LIMITER_THRESH", limiter_thresh);
   if (limiter_thresh != 0.0)
   {
-    AudioCompressor *limit = new AudioCompressor;
-    limit->setThreshold(limiter_thresh);
-    limit->setRatio(0.1);
-    limit->setAttack(2);
-    limit->setDecay(20);
-    limit->setOutputGain(1);
-    prev_src->registerSink(limit, true);
-    prev_src = limit;
+    limiter = new AudioCompressor;
+    limiter->setThreshold(limiter_thresh);
+    limiter->setRatio(0.1);
+    limiter->setAttack(2);
+    limiter->setDecay(20);
+    limiter->setOutputGain(1);
+    output_chain->addStage(limiter, true, "limiter");
   }
 
     // Clip audio to limit its amplitude
   AudioClipper *clipper = new AudioClipper;
   clipper->setClipLevel(0.98);
-  prev_src->registerSink(clipper, true);
-  prev_src = clipper;
+  output_chain->addStage(clipper, true, "clipper");
 
     // Remove high frequencies generated by the previous clipping
 #if (INTERNAL_SAMPLE_RATE == 16000)
@@ -645,8 +681,7 @@ bool LocalRxBase::initialize(void)
 #else
   AudioFilter *splatter_filter = new AudioFilter("LpCh9/-0.05/3500");
 #endif
-  prev_src->registerSink(splatter_filter, true);
-  prev_src = splatter_filter;
+  output_chain->addStage(splatter_filter, true, "splatter");
   
     // Set the previous audio pipe object to handle audio distribution for
     // the LocalRxBase class
@@ -823,7 +858,49 @@ void LocalRxBase::unregisterFullbandSink(Async::AudioSink* sink)
  *
  ****************************************************************************/
 
-void LocalRxBase::sel5Detected(std::string sequence)
+std::shared_ptr<AudioWorkerStage::Group> LocalRxBase::sharedWorkerGroup(
+    unsigned threads)
+{
+    // The group is shared by all receivers and is deleted when the last
+    // receiver using it is deleted
+  static std::weak_ptr<AudioWorkerStage::Group> shared_group;
+  std::shared_ptr<AudioWorkerStage::Group> group = shared_group.lock();
+  if (group == nullptr)
+  {
+    group = std::make_shared<AudioWorkerStage::Group>(threads);
+    shared_group = group;
+  }
+  return group;
+} /* LocalRxBase::sharedWorkerGroup */
+
+
+AudioSource *LocalRxBase::addProcessor(AudioSource *prev_src,
+                                       AudioProcessor *proc)
+{
+  if (worker_group != nullptr)
+  {
+    AudioWorkerStage *stage = new AudioWorkerStage(*worker_group, proc);
+    prev_src->registerSink(stage, true);
+    return stage;
+  }
+  prev_src->registerSink(proc, true);
+  return proc;
+} /* LocalRxBase::addProcessor */
+
+
+AudioSource *LocalRxBase::addProcessorChain(AudioSource *prev_src,
+                                            AudioProcessorChain *chain)
+{
+  if (chain->stageCount() == 0)
+  {
+    delete chain;
+    return prev_src;
+  }
+  return addProcessor(prev_src, chain);
+} /* LocalRxBase::addProcessorChain */
+
+
+void LocalRxBase::sel5Detected(const std::string& sequence)
 {
   if (muteState() == MUTE_NONE)
   {
@@ -865,7 +942,7 @@ void LocalRxBase::onToneDetected(float fq)
 } /* LocalRxBase::onToneDetected */
 
 
-void LocalRxBase::dataFrameReceived(vector<uint8_t> frame)
+void LocalRxBase::dataFrameReceived(vector<uint8_t>& frame)
 {
   vector<uint8_t>::const_iterator it = frame.begin();
   if ((frame.size() == 5) && (*it++ == Tx::DATA_CMD_TONE_DETECTED))
@@ -889,7 +966,7 @@ void LocalRxBase::dataFrameReceived(vector<uint8_t> frame)
 } /* LocalRxBase::dataFrameReceived */
 
 
-void LocalRxBase::dataFrameReceivedIb(vector<uint8_t> frame)
+void LocalRxBase::dataFrameReceivedIb(vector<uint8_t>& frame)
 {
   cout << "### Inband data frame received: len=" << frame.size() << endl;
   dataFrameReceived(frame);
@@ -1028,10 +1105,127 @@ void LocalRxBase::cfgUpdated(const std::string& section, const std::string& tag)
                 << sql_extended_hangtime_thresh
                 << " for receiver " << name() << std::endl;
     }
+    else if (tag == "PREAMP")
+    {
+      float gain = 0;
+      cfg().getValue(name(), "PREAMP", gain);
+      if (preamp != 0)
+      {
+        preamp_gain = gain;
+        preamp->setGain(preamp_gain);
+        std::cout << "Setting PREAMP to " << preamp_gain
+                  << " for receiver " << name() << std::endl;
+      }
+      else if (gain != 0)
+      {
+        std::cerr << "*** WARNING: " << name() << "/PREAMP can only be "
+                     "changed at runtime if set to a non-zero value at "
+                     "startup" << std::endl;
+      }
+    }
+    else if (tag == "LIMITER_THRESH")
+    {
+      double thresh = DEFAULT_LIMITER_THRESH;
+      cfg().getValue(name(), "LIMITER_THRESH", thresh);
+      if ((limiter != 0) && (thresh != 0.0))
+      {
+        limiter->setThreshold(thresh);
+        std::cout << "Setting LIMITER_THRESH to " << thresh
+                  << " for receiver " << name() << std::endl;
+      }
+      else if ((limiter != 0) || (thresh != 0.0))
+      {
+        std::cerr << "*** WARNING: Enabling or disabling the limiter using "
+                  << name() << "/LIMITER_THRESH require a restart"
+                  << std::endl;
+      }
+    }
+    else if (tag.compare(0, 7, "LADSPA_") == 0)
+    {
+      reloadFilterChain();
+    }
+  }
+  else
+  {
+      // Plugin parameters are updated directly while a new label or a new
+      // parameter require that the plugin is loaded again
+    auto it = ladspa_sections.find(section);
+    if ((it != ladspa_sections.end()) &&
+        ((tag == "LABEL") || (it->second.count(tag) == 0)))
+    {
+      reloadFilterChain();
+    }
   }
 } /* LocalRxBase::cfgUpdated */
 
 
+bool LocalRxBase::loadFilterChain(void)
+{
+  LADSPAPluginLoader ladspa_plug_loader;
+  if (!ladspa_plug_loader.load(cfg(), name()))
+  {
+    *ladspa_plug_loader.validFlag() = false;
+    delete ladspa_plug_loader.chainSink();
+    filter_in->registerSink(filter_out);
+    return false;
+  }
+  ladspa_valid = ladspa_plug_loader.validFlag();
+  ladspa_sections.clear();
+  for (const auto& sec : ladspa_plug_loader.sections())
+  {
+    const auto tags = cfg().listSection(sec);
+    ladspa_sections[sec] = std::set<std::string>(tags.begin(), tags.end());
+  }
+  if (ladspa_plug_loader.chain() != nullptr)
+  {
+      // The plugins are run by a worker thread when RX_WORKER_THREADS is set
+    ladspa_stage = addProcessor(filter_in, ladspa_plug_loader.chain());
+    ladspa_stage->registerSink(filter_out);
+  }
+  else
+  {
+    filter_in->registerSink(filter_out);
+  }
+  return true;
+} /* LocalRxBase::loadFilterChain */
+
+
+void LocalRxBase::reloadFilterChain(void)
+{
+    // Many variables may be updated by one configuration reload so the
+    // rebuild is deferred until all of them have been set
+  if (!filter_reload_pending)
+  {
+    filter_reload_pending = true;
+    Async::Application::app().runTask(
+        sigc::mem_fun(*this, &LocalRxBase::rebuildFilterChain));
+  }
+} /* LocalRxBase::reloadFilterChain */
+
+
+void LocalRxBase::rebuildFilterChain(void)
+{
+  filter_reload_pending = false;
+  std::cout << name() << ": Reloading the LADSPA plugin chain" << std::endl;
+  if (ladspa_stage != 0)
+  {
+    ladspa_stage->unregisterSink();
+  }
+  filter_in->unregisterSink();
+  if (ladspa_valid != nullptr)
+  {
+    *ladspa_valid = false;
+  }
+  delete ladspa_stage;
+  ladspa_stage = 0;
+  if (!loadFilterChain())
+  {
+    std::cerr << "*** ERROR: Could not load the LADSPA plugins for receiver "
+              << name() << ". Audio will not be filtered." << std::endl;
+  }
+} /* LocalRxBase::rebuildFilterChain */
+
+
 /*
  * This file has not been truncated
  */
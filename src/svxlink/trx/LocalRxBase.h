@@ -10,7 +10,7 @@ the SvxLink core is running. It can also be a DDR (Digital Drop Receiver).
 
 \verbatim
 SvxLink - A Multi Purpose Voice Services System for Ham Radio Use
-Copyright (C) 2003-2022 Tobias Blomberg / SM0SVX
+Copyright (C) 2003-2026 Tobias Blomberg / SM0SVX
 
 This program is free software; you can redistribute it and/or modify
 it under the terms of the GNU General Public License as published by
@@ -42,6 +42,10 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 #include <sys/time.h>
 #include <stdint.h>
 #include <vector>
+#include <memory>
+#include <map>
+#include <set>
+#include <string>
 
 
 /****************************************************************************
@@ -52,6 +56,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 
 #include <AsyncAudioValve.h>
 #include <AsyncAudioDelayLine.h>
+#include <AsyncAudioWorkerStage.h>
 
 
 /****************************************************************************
@@ -75,6 +80,11 @@ namespace Async
   class AudioSplitter;
   class AudioValve;
   class AudioFifo;
+  class AudioProcessor;
+  class AudioProcessorChain;
+  class AudioAmp;
+  class AudioCompressor;
+  class AudioPassthrough;
 };
 
 class Squelch;
@@ -281,14 +291,29 @@ class LocalRxBase : public Rx
     HdlcDeframer *              ib_afsk_deframer;
     bool                        audio_dev_keep_open;
     Async::AudioSplitter *      fullband_splitter;
-
+    std::shared_ptr<Async::AudioWorkerStage::Group> worker_group;
+    Async::AudioAmp *           preamp;
+    Async::AudioCompressor *    limiter;
+    Async::AudioPassthrough *   filter_in;
+    Async::AudioPassthrough *   filter_out;
+    Async::AudioSource *        ladspa_stage;
+    std::shared_ptr<bool>       ladspa_valid;
+    std::map<std::string, std::set<std::string> > ladspa_sections;
+    bool                        filter_reload_pending;
+
+    static std::shared_ptr<Async::AudioWorkerStage::Group> sharedWorkerGroup(
+        unsigned threads);
+    Async::AudioSource *addProcessor(Async::AudioSource *prev_src,
+                                     Async::AudioProcessor *proc);
+    Async::AudioSource *addProcessorChain(Async::AudioSource *prev_src,
+                                          Async::AudioProcessorChain *chain);
     int audioRead(float *samples, int count);
     void dtmfDigitActivated(char digit);
     void onToneDetected(float fq);
-    void dataFrameReceived(std::vector<uint8_t> frame);
-    void dataFrameReceivedIb(std::vector<uint8_t> frame);
+    void dataFrameReceived(std::vector<uint8_t>& frame);
+    void dataFrameReceivedIb(std::vector<uint8_t>& frame);
     void dtmfDigitDeactivated(char digit, int duration_ms);
-    void sel5Detected(std::string sequence);
+    void sel5Detected(const std::string& sequence);
     void audioStreamStateChange(bool is_active, bool is_idle);
     void onSquelchOpen(bool is_open);
     void tone1750detected(bool detected);
@@ -297,6 +322,9 @@ class LocalRxBase : public Rx
     void rxReadyStateChanged(void);
     void publishSquelchState(void);
     void cfgUpdated(const std::string& section, const std::string& tag);
+    bool loadFilterChain(void);
+    void reloadFilterChain(void);
+    void rebuildFilterChain(void);
 
 };  /* class LocalRxBase */
 
@@ -111,7 +111,7 @@ unsigned int LocalRxSim::next_seed = 0;
  ****************************************************************************/
 
 LocalRxSim::LocalRxSim(Config &cfg, const std::string& name)
-  : LocalRxBase(cfg, name), cfg(cfg), pacer(0)
+  : LocalRxBase(cfg, name), cfg(cfg), pacer(0), noise_adder(0)
 {
 } /* LocalRxSim::LocalRxSim */
 
@@ -149,8 +149,27 @@ bool LocalRxSim::initialize(void)
   cfg.getValue(name(), "SIM_TONE_PWR", sim_tone_pwr_db);
   audio_gen.setPower(sim_tone_pwr_db);
 
-  pacer = new Async::AudioPacer(INTERNAL_SAMPLE_RATE, 128, 0);
-  audio_gen.registerSink(pacer, true);
+  unsigned block_size = 128;
+  cfg.getValue(name(), "SIM_BLOCK_SIZE", block_size);
+  if (block_size == 0)
+  {
+    cerr << "*** ERROR: " << name() << "/SIM_BLOCK_SIZE must be larger "
+            "than zero\n";
+    return false;
+  }
+
+  pacer = new Async::AudioPacer(INTERNAL_SAMPLE_RATE, block_size, 0);
+  float sim_noise_pwr_db = 0.0f;
+  if (cfg.getValue(name(), "SIM_NOISE_PWR", sim_noise_pwr_db))
+  {
+    noise_adder = new Async::AudioNoiseAdder(sim_noise_pwr_db);
+    audio_gen.registerSink(noise_adder, true);
+    noise_adder->registerSink(pacer, true);
+  }
+  else
+  {
+    audio_gen.registerSink(pacer, true);
+  }
 
   if (!LocalRxBase::initialize())
   {
@@ -43,6 +43,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
  ****************************************************************************/
 
 #include <AsyncAudioGenerator.h>
+#include <AsyncAudioNoiseAdder.h>
 
 
 /****************************************************************************
@@ -178,6 +179,7 @@ class LocalRxSim : public LocalRxBase
     Async::Config         &cfg;
     Async::AudioGenerator audio_gen;
     Async::AudioPacer     *pacer;
+    Async::AudioNoiseAdder *noise_adder;
 };  /* class LocalRxSim */
 
 
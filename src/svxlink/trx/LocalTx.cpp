@@ -66,7 +66,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 #include <AsyncAudioValve.h>
 #include <AsyncAudioPassthrough.h>
 #include <AsyncAudioFifo.h>
-#include <AsyncAudioInterpolator.h>
+#include <AsyncAudioResampler.h>
 #include <AsyncAudioAmp.h>
 #include <AsyncAudioMixer.h>
 #include <AsyncAudioDebugger.h>
@@ -85,8 +85,8 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 
 #include "LocalTx.h"
 #include "DtmfEncoder.h"
-#include "multirate_filter_coeff.h"
 #include "PttCtrl.h"
+#include "LatencyProbe.h"
 #include "SigLevDetAfsk.h"
 #include "Rx.h"
 #include "Emphasis.h"
@@ -246,7 +246,8 @@ LocalTx::LocalTx(Config& cfg, const string& name)
     fsk_mod(0), /*fsk_valve(0),*/ input_handler(0), ptt_ctrl(0),
     audio_valve(0), siglev_sine_gen(0), ptt_hangtimer(0), ptt(0),
     last_rx_id(Rx::ID_UNKNOWN), fsk_first_packet_transmitted(false),
-    hdlc_framer_ib(0), fsk_mod_ib(0), ctrl_pty(0), audio_dev_keep_open(false)
+    hdlc_framer_ib(0), fsk_mod_ib(0), ctrl_pty(0), audio_dev_keep_open(false),
+    latency_probe(0)
 {
 
 } /* LocalTx::LocalTx */
@@ -523,15 +524,22 @@ bool LocalTx::initialize(void)
   prev_src = splatter_filter;
 #endif
 
+    // The voiceband filter may be disabled when the audio has already been
+    // filtered, e.g. by the receiver on a remote receiver RF uplink
+  bool use_voiceband_filter = true;
+  cfg.getValue(name(), "VOICEBAND_FILTER", use_voiceband_filter);
+  if (use_voiceband_filter)
+  {
 #if (INTERNAL_SAMPLE_RATE == 16000)
-  AudioFilter *voiceband_filter =
-    new AudioFilter("LpCh9/-0.05/5500 x HpCh12/-0.05/300");
+    AudioFilter *voiceband_filter =
+      new AudioFilter("LpCh9/-0.05/5500 x HpCh12/-0.05/300");
 #else
-  AudioFilter *voiceband_filter =
-    new AudioFilter("LpBu20/3500 x HpCh12/-0.05/300");
+    AudioFilter *voiceband_filter =
+      new AudioFilter("LpBu20/3500 x HpCh12/-0.05/300");
 #endif
-  prev_src->registerSink(voiceband_filter, true);
-  prev_src = voiceband_filter;
+    prev_src->registerSink(voiceband_filter, true);
+    prev_src = voiceband_filter;
+  }
 
     // Create a valve so that we can control when to transmit audio
   #if USE_AUDIO_VALVE
@@ -584,13 +592,13 @@ bool LocalTx::initialize(void)
     unsigned afsk_tx_delay = 100;
     cfg.getValue(name(), "OB_AFSK_TX_DELAY", afsk_tx_delay);
 
-    AudioFilter *voice_filter = new AudioFilter("LpCh10/-0.5/4500");
+      // Two low pass filters in series, given in one filter spec so that
+      // they are run as one biquad cascade in a single pass over the audio
+    AudioFilter *voice_filter =
+      new AudioFilter("LpCh10/-0.5/4500 x LpCh10/-0.5/4500");
     voice_filter->setOutputGain(voice_gain);
     prev_src->registerSink(voice_filter, true);
     prev_src = voice_filter;
-    AudioFilter *voice_filter2 = new AudioFilter("LpCh10/-0.5/4500");
-    prev_src->registerSink(voice_filter2, true);
-    prev_src = voice_filter2;
 
       // Create a mixer so that we can mix other audio with the voice audio
     mixer = new AudioMixer;
@@ -689,6 +697,16 @@ bool LocalTx::initialize(void)
   prev_src->registerSink(ptt_ctrl, true);
   prev_src = ptt_ctrl;
 
+    // Measure the latency from network ingress to the audio device
+  bool latency_probe_enable = false;
+  cfg.getValue(name(), "LATENCY_PROBE", latency_probe_enable);
+  if (latency_probe_enable)
+  {
+    latency_probe = new LatencyProbe(LatencyProbe::EGRESS, name());
+    prev_src->registerSink(latency_probe, true);
+    prev_src = latency_probe;
+  }
+
   float master_gain = 0.0f;
   if (cfg.getValue(name(), "MASTER_GAIN", master_gain))
   {
@@ -698,29 +716,13 @@ bool LocalTx::initialize(void)
     prev_src = master_gain_stage;
   }
 
-#if (INTERNAL_SAMPLE_RATE != 16000)  
-  if (audio_io->sampleRate() > 8000)
+  if (audio_io->sampleRate() > INTERNAL_SAMPLE_RATE)
   {
-      // Interpolate sample rate to 16kHz
-    AudioInterpolator *i1 = new AudioInterpolator(2, coeff_16_8,
-                                                  coeff_16_8_taps);
-    prev_src->registerSink(i1, true);
-    prev_src = i1;
-  }
-#endif
-
-  if (audio_io->sampleRate() > 16000)
-  {
-      // Interpolate sample rate to 48kHz
-#if (INTERNAL_SAMPLE_RATE == 8000)
-    AudioInterpolator *i2 = new AudioInterpolator(3, coeff_48_16_int,
-                                                  coeff_48_16_int_taps);
-#else
-    AudioInterpolator *i2 = new AudioInterpolator(3, coeff_48_16,
-                                                  coeff_48_16_taps);
-#endif
-    prev_src->registerSink(i2, true);
-    prev_src = i2;
+      // Convert the sample rate up to the sound card sample rate
+    AudioResampler *resampler = new AudioResampler(
+        INTERNAL_SAMPLE_RATE, audio_io->sampleRate());
+    prev_src->registerSink(resampler, true);
+    prev_src = resampler;
   }
   
     // Finally connect the whole audio pipe to the audio device
@@ -905,6 +907,21 @@ void LocalTx::setModulation(Modulation::Type mod)
 } /* LocalTx::setModulation */
 
 
+unsigned long LocalTx::audioUnderrunCount(void) const
+{
+  return (audio_io != 0) ? audio_io->playbackXrunCount() : 0;
+} /* LocalTx::audioUnderrunCount */
+
+
+void LocalTx::setAudioStats(Async::AudioStats *stats)
+{
+  if (latency_probe != 0)
+  {
+    latency_probe->setStats(stats);
+  }
+} /* LocalTx::setAudioStats */
+
+
 /****************************************************************************
  *
  * Protected member functions
@@ -973,6 +990,11 @@ void LocalTx::transmit(bool do_transmit)
     txtot = 0;
     tx_timeout_occured = false;
 
+    if (latency_probe != 0)
+    {
+      latency_probe->printStats();
+    }
+
     setIsTransmitting(false);
   }
   
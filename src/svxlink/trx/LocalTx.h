@@ -80,6 +80,7 @@ namespace Async
 
 class DtmfEncoder;
 class PttCtrl;
+class LatencyProbe;
 class HdlcFramer;
 class AfskModulator;
 
@@ -207,6 +208,21 @@ class LocalTx : public Tx
      */
     void setModulation(Modulation::Type mod);
 
+    /**
+     * @brief   Get the number of audio underruns
+     * @return  Returns the number of playback underruns on the sound card
+     */
+    unsigned long audioUnderrunCount(void) const;
+
+    /**
+     * @brief   Set the object to report audio health statistics to
+     * @param   stats The statistics object or 0 to disable reporting
+     *
+     * The latency from network ingress to the audio device is reported if
+     * the latency probe is enabled.
+     */
+    void setAudioStats(Async::AudioStats *stats);
+
   private:
     Async::Config     	    &cfg;
     Async::AudioIO    	    *audio_io;
@@ -236,6 +252,7 @@ class LocalTx : public Tx
     AfskModulator           *fsk_mod_ib;
     RefCountingPty          *ctrl_pty;
     bool                    audio_dev_keep_open;
+    LatencyProbe            *latency_probe;
     
     void txTimeoutOccured(Async::Timer *t);
     bool setPtt(bool tx, bool with_hangtime=false);
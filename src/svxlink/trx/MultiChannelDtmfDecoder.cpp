@@ -0,0 +1,637 @@
+/**
+@file	 MultiChannelDtmfDecoder.cpp
+@brief   A sw DTMF decoder sharing one detector engine with other receivers
+@author  Tobias Blomberg / SM0SVX
+@date	 2026-10-14
+
+\verbatim
+SvxLink - A Multi Purpose Voice Services System for Ham Radio Use
+Copyright (C) 2003-2026 Tobias Blomberg / SM0SVX
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+\endverbatim
+*/
+
+
+
+/****************************************************************************
+ *
+ * System Includes
+ *
+ ****************************************************************************/
+
+#include <algorithm>
+#include <vector>
+#include <cmath>
+#include <cstring>
+
+
+/****************************************************************************
+ *
+ * Project Includes
+ *
+ ****************************************************************************/
+
+#include <AsyncApplication.h>
+
+
+/****************************************************************************
+ *
+ * Local Includes
+ *
+ ****************************************************************************/
+
+#include "MultiChannelDtmfDecoder.h"
+
+
+
+/****************************************************************************
+ *
+ * Namespaces to use
+ *
+ ****************************************************************************/
+
+using namespace std;
+using namespace Async;
+
+
+
+/****************************************************************************
+ *
+ * Defines & typedefs
+ *
+ ****************************************************************************/
+
+  // The engine evaluate BIN_CNT detectors for each block. The first four are
+  // the row tones and then come the four column tones.
+static const size_t BIN_CNT = 8;
+static const size_t COL_BASE = 4;
+
+  // The number of blocks, from different channels, run through the
+  // detectors at the same time
+static const size_t CALC_BLOCKS = 4;
+
+#if defined(__GNUC__)
+#define MC_DTMF_VECTOR_EXT
+typedef float VecFloat __attribute__((vector_size(32)));
+static const size_t GROUP_LEN = sizeof(VecFloat) / sizeof(float);
+static const size_t GROUP_CNT = BIN_CNT / GROUP_LEN;
+#endif
+
+#if defined(MC_DTMF_VECTOR_EXT) && defined(__x86_64__) && \
+    defined(__ELF__) && !defined(__clang__)
+#define MC_DTMF_KERNEL __attribute__((target_clones("avx2", "default")))
+#else
+#define MC_DTMF_KERNEL
+#endif
+
+
+/****************************************************************************
+ *
+ * Local class definitions
+ *
+ ****************************************************************************/
+
+class MultiChannelDtmfDecoder::Engine
+  : public sigc::trackable, public std::enable_shared_from_this<Engine>
+{
+  public:
+    static std::shared_ptr<Engine> shared(void);
+
+    Engine(void);
+    const float *window(void) const { return win; }
+    void blockReady(MultiChannelDtmfDecoder *dec);
+    void remove(MultiChannelDtmfDecoder *dec);
+    void process(void);
+
+  private:
+    float                                 two_cosw[BIN_CNT];
+    float                                 win[BLOCK_SIZE];
+    std::vector<MultiChannelDtmfDecoder*> ready;
+    std::vector<MultiChannelDtmfDecoder*> batch;
+    std::vector<float>                    ms;
+    std::vector<double>                   energy;
+    bool                                  task_pending;
+
+    void calc(const Block *const *blks, float *bin_ms, double *blk_energy);
+};
+
+
+/****************************************************************************
+ *
+ * Prototypes
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Exported Global Variables
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Local Global Variables
+ *
+ ****************************************************************************/
+
+namespace {
+  static const char digit_map[4][4] =
+  {
+    {'1', '2', '3', 'A'},
+    {'4', '5', '6', 'B'},
+    {'7', '8', '9', 'C'},
+    {'*', '0', '#', 'D'}
+  };
+
+  static const float row_fqs[] = { 697, 770, 852, 941 };
+  static const float col_fqs[] = { 1209, 1336, 1477, 1633 };
+};
+
+
+/****************************************************************************
+ *
+ * Public member functions
+ *
+ ****************************************************************************/
+
+MultiChannelDtmfDecoder::MultiChannelDtmfDecoder(Config &cfg,
+                                                 const string &name)
+  : DtmfDecoder(cfg, name), engine(Engine::shared()), twist_nrm_thresh(0),
+    twist_rev_thresh(0), block_pos(0), det_cnt(0), undet_cnt(0),
+    last_digit_active(0), min_det_cnt(DEFAULT_MIN_DET_CNT),
+    min_undet_cnt(DEFAULT_MIN_UNDET_CNT), det_state(STATE_IDLE),
+    det_cnt_weight(0), duration(0), undet_thresh(0)
+{
+  twist_nrm_thresh = powf(10.0f, DEFAULT_MAX_NORMAL_TWIST_DB / 10.0f);
+  twist_rev_thresh = powf(10.0f, -(DEFAULT_MAX_REV_TWIST_DB / 10.0f));
+  check_bank.initialize(vector<float>(CHK_CNT, 0.0f), INTERNAL_SAMPLE_RATE);
+} /* MultiChannelDtmfDecoder::MultiChannelDtmfDecoder */
+
+
+MultiChannelDtmfDecoder::~MultiChannelDtmfDecoder(void)
+{
+  engine->remove(this);
+} /* MultiChannelDtmfDecoder::~MultiChannelDtmfDecoder */
+
+
+bool MultiChannelDtmfDecoder::initialize(void)
+{
+  if (!DtmfDecoder::initialize())
+  {
+    return false;
+  }
+
+  float cfg_max_normal_twist = -1.0f;
+  if (cfg().getValue(name(), "DTMF_MAX_FWD_TWIST", cfg_max_normal_twist))
+  {
+    if (cfg_max_normal_twist > 0.0f)
+    {
+      twist_nrm_thresh = powf(10.0f, cfg_max_normal_twist / 10.0f);
+    }
+  }
+
+  float cfg_max_rev_twist = -1.0f;
+  if (cfg().getValue(name(), "DTMF_MAX_REV_TWIST", cfg_max_rev_twist))
+  {
+    if (cfg_max_rev_twist >= 0.0f)
+    {
+      twist_rev_thresh = powf(10.0f, -cfg_max_rev_twist / 10.0f);
+    }
+  }
+
+  if (hangtime() > 0)
+  {
+    const size_t block_size_ms = 1000 * BLOCK_SIZE / INTERNAL_SAMPLE_RATE;
+    const size_t step_size_ms = 1000 * STEP_SIZE / INTERNAL_SAMPLE_RATE;
+    min_undet_cnt = 1;
+    if (hangtime() > block_size_ms)
+    {
+      min_undet_cnt = 1 + (hangtime() - block_size_ms) / step_size_ms;
+    }
+  }
+
+  return true;
+
+} /* MultiChannelDtmfDecoder::initialize */
+
+
+int MultiChannelDtmfDecoder::writeSamples(const float *buf, int len)
+{
+  int pos = 0;
+  while (pos < len)
+  {
+    const int cnt = min(len - pos, static_cast<int>(BLOCK_SIZE - block_pos));
+    memcpy(block + block_pos, buf + pos, cnt * sizeof(*block));
+    block_pos += cnt;
+    pos += cnt;
+    if (block_pos >= BLOCK_SIZE)
+    {
+        // The window is applied when the block is handed over so that the
+        // engine can run the detectors directly on the stored samples
+      const float *win = engine->window();
+      pending.emplace_back();
+      Block& blk = pending.back();
+      for (size_t n=0; n<BLOCK_SIZE; ++n)
+      {
+        blk[n] = block[n] * win[n];
+      }
+      memmove(block, block + STEP_SIZE,
+              (BLOCK_SIZE - STEP_SIZE) * sizeof(*block));
+      block_pos = BLOCK_SIZE - STEP_SIZE;
+      engine->blockReady(this);
+    }
+  }
+
+  return len;
+} /* MultiChannelDtmfDecoder::writeSamples */
+
+
+/****************************************************************************
+ *
+ * Protected member functions
+ *
+ ****************************************************************************/
+
+
+/****************************************************************************
+ *
+ * Private member functions
+ *
+ ****************************************************************************/
+
+void MultiChannelDtmfDecoder::processBlock(const Block& blk,
+                                           double block_energy,
+                                           const float *ms)
+{
+    // See SvxSwDtmfDecoder::processBlock for a description of the algorithm.
+    // The tone energies have already been calculated by the engine,
+    // windowed and in the same scale as in SvxSwDtmfDecoder.
+  bool digit_active = false;
+  size_t max_row_idx = 0;
+  size_t max_col_idx = 0;
+  float max_row_ms = 0.0f;
+  float max_col_ms = 0.0f;
+  if (block_energy > ENERGY_THRESH)
+  {
+    float row_sum = 0.0f;
+    float col_sum = 0.0f;
+    for (size_t i = 0; i < 4; ++i)
+    {
+      const float row_ms = WIN_ENB * ms[i];
+      if (row_ms > max_row_ms)
+      {
+        max_row_ms = row_ms;
+        max_row_idx = i;
+      }
+      row_sum += row_ms;
+
+      const float col_ms = WIN_ENB * ms[COL_BASE + i];
+      if (col_ms > max_col_ms)
+      {
+        max_col_ms = col_ms;
+        max_col_idx = i;
+      }
+      col_sum += col_ms;
+    }
+
+    const float rel_energy =
+      2 * (max_row_ms + max_col_ms) / (BLOCK_SIZE * block_energy);
+    const float twist = max_row_ms / max_col_ms;
+    const float row_group_rel = max_row_ms / row_sum;
+    const float col_group_rel = max_col_ms / col_sum;
+    if (rel_energy > REL_THRESH_LO)
+    {
+      if (rel_energy > REL_THRESH_HI)
+      {
+        det_cnt_weight = DET_CNT_HI_WEIGHT;
+      }
+      else if (rel_energy > REL_THRESH_MED)
+      {
+        det_cnt_weight = DET_CNT_MED_WEIGHT;
+      }
+      else
+      {
+        det_cnt_weight = DET_CNT_LO_WEIGHT;
+      }
+      digit_active = (twist > twist_rev_thresh) &&
+                     (twist < twist_nrm_thresh) &&
+                     (row_group_rel > 0.80) &&
+                     (col_group_rel > 0.80);
+    }
+  }
+
+  if (digit_active)
+  {
+    const char digit = digit_map[max_row_idx][max_col_idx];
+    if ((det_state != STATE_IDLE) && (digit != last_digit_active))
+    {
+      digit_active = false;
+    }
+    else
+    {
+      last_digit_active = digit;
+    }
+  }
+
+    // The overtones and the intermodulation product depend on the strongest
+    // tones so they are calculated here, which is only needed when a digit
+    // candidate has been found
+  if (digit_active)
+  {
+    const float max_row_fq = row_fqs[max_row_idx];
+    const float max_col_fq = col_fqs[max_col_idx];
+    check_bank.setFrequency(CHK_ROW_OT, 3.0f * max_row_fq,
+                            INTERNAL_SAMPLE_RATE);
+    check_bank.setFrequency(CHK_COL_OT, 3.0f * max_col_fq,
+                            INTERNAL_SAMPLE_RATE);
+    check_bank.setFrequency(CHK_IM, max_col_fq + max_col_fq - max_row_fq,
+                            INTERNAL_SAMPLE_RATE);
+    check_bank.calc(blk.data(), BLOCK_SIZE);
+
+    const float row_ot_rel = check_bank.magnitudeSquared(CHK_ROW_OT) /
+                             max_row_ms;
+    const float col_ot_rel = check_bank.magnitudeSquared(CHK_COL_OT) /
+                             max_col_ms;
+    const float im_rel =
+        check_bank.magnitudeSquared(CHK_IM) / (max_row_ms + max_col_ms);
+    digit_active = (row_ot_rel < MAX_OT_REL) && (col_ot_rel < MAX_OT_REL) &&
+                   (im_rel < MAX_IM_REL);
+  }
+
+  switch (det_state)
+  {
+    case STATE_IDLE:
+      if (digit_active)
+      {
+        det_cnt = det_cnt_weight;
+        undet_cnt = 0;
+        duration = 1;
+        det_state = STATE_DET_DELAY;
+      }
+      break;
+
+    case STATE_DET_DELAY:
+      duration += 1;
+      if (digit_active)
+      {
+        undet_cnt = 0;
+        det_cnt += det_cnt_weight;
+        if (det_cnt >= min_det_cnt)
+        {
+          float det_quality = static_cast<float>(det_cnt)
+                            / (duration * DET_CNT_HI_WEIGHT);
+          if (det_quality > 0.5)
+          {
+            undet_thresh = min_undet_cnt;
+          }
+          else if (det_quality > 0.2)
+          {
+            undet_thresh = 2 * min_undet_cnt;
+          }
+          else
+          {
+            undet_thresh = 3 * min_undet_cnt;
+          }
+          det_state = STATE_DETECTED;
+          digitActivated(last_digit_active);
+        }
+      }
+      else
+      {
+        undet_cnt = 0;
+        det_state = STATE_IDLE;
+      }
+      break;
+
+    case STATE_DETECTED:
+      if (digit_active)
+      {
+        if (undet_cnt > 0)
+        {
+          duration += undet_cnt;
+          undet_cnt = 0;
+        }
+        else
+        {
+          duration += 1;
+        }
+      }
+      else
+      {
+        if (++undet_cnt >= undet_thresh)
+        {
+          const int first_block_time = 1000 * BLOCK_SIZE / INTERNAL_SAMPLE_RATE;
+          const int block_time = 1000 * STEP_SIZE / INTERNAL_SAMPLE_RATE;
+          const int dur_ms = first_block_time + block_time * (duration - 1);
+          det_state = STATE_IDLE;
+          digitDeactivated(last_digit_active, dur_ms);
+        }
+      }
+      break;
+  }
+} /* MultiChannelDtmfDecoder::processBlock */
+
+
+
+/****************************************************************************
+ *
+ * Private member functions for class MultiChannelDtmfDecoder::Engine
+ *
+ ****************************************************************************/
+
+std::shared_ptr<MultiChannelDtmfDecoder::Engine>
+MultiChannelDtmfDecoder::Engine::shared(void)
+{
+    // The engine is shared by all decoders and is deleted when the last
+    // decoder using it is deleted
+  static std::weak_ptr<Engine> shared_engine;
+  std::shared_ptr<Engine> engine = shared_engine.lock();
+  if (engine == nullptr)
+  {
+    engine = std::make_shared<Engine>();
+    shared_engine = engine;
+  }
+  return engine;
+} /* MultiChannelDtmfDecoder::Engine::shared */
+
+
+MultiChannelDtmfDecoder::Engine::Engine(void)
+  : task_pending(false)
+{
+  for (size_t i=0; i<4; ++i)
+  {
+    two_cosw[i] = 2.0f * cosf(2.0f * M_PI * row_fqs[i] / INTERNAL_SAMPLE_RATE);
+    two_cosw[COL_BASE + i] =
+        2.0f * cosf(2.0f * M_PI * col_fqs[i] / INTERNAL_SAMPLE_RATE);
+  }
+
+    // Hamming window, same as in SvxSwDtmfDecoder
+  for (size_t n=0; n<BLOCK_SIZE; ++n)
+  {
+    win[n] = 0.53836 - 0.46164 * cosf(2.0f * M_PI * n / (BLOCK_SIZE - 1));
+  }
+} /* MultiChannelDtmfDecoder::Engine::Engine */
+
+
+void MultiChannelDtmfDecoder::Engine::blockReady(MultiChannelDtmfDecoder *dec)
+{
+  if (find(ready.begin(), ready.end(), dec) == ready.end())
+  {
+    ready.push_back(dec);
+  }
+
+    // Normally all blocks are processed at the end of the main loop
+    // iteration. If that does not happen, e.g. when samples are written
+    // outside of the main loop, the blocks are processed when too many
+    // have been queued up.
+  if (dec->pending.size() >= MAX_PENDING)
+  {
+    process();
+  }
+  else if (!task_pending)
+  {
+    task_pending = true;
+    Application::app().runTask(sigc::mem_fun(*this, &Engine::process));
+  }
+} /* MultiChannelDtmfDecoder::Engine::blockReady */
+
+
+void MultiChannelDtmfDecoder::Engine::remove(MultiChannelDtmfDecoder *dec)
+{
+  ready.erase(std::remove(ready.begin(), ready.end(), dec), ready.end());
+  replace(batch.begin(), batch.end(), dec,
+          static_cast<MultiChannelDtmfDecoder*>(0));
+} /* MultiChannelDtmfDecoder::Engine::remove */
+
+
+void MultiChannelDtmfDecoder::Engine::process(void)
+{
+    // A digit signal handler may delete the last decoder, and with it the
+    // engine, so keep the engine alive until we are done
+  std::shared_ptr<Engine> self = shared_from_this();
+
+  task_pending = false;
+  while (!ready.empty() && batch.empty())
+  {
+    batch.swap(ready);
+
+      // Run the detectors for the oldest block of all decoders. Unused
+      // slots in the last group are filled with a silent block.
+    static const Block silence = {};
+    const size_t calc_cnt =
+        (batch.size() + CALC_BLOCKS - 1) / CALC_BLOCKS * CALC_BLOCKS;
+    ms.resize(calc_cnt * BIN_CNT);
+    energy.resize(calc_cnt);
+    for (size_t i=0; i<calc_cnt; i+=CALC_BLOCKS)
+    {
+      const Block *blks[CALC_BLOCKS];
+      for (size_t b=0; b<CALC_BLOCKS; ++b)
+      {
+        blks[b] = (i + b < batch.size()) ?
+                  &batch[i + b]->pending.front() : &silence;
+      }
+      calc(blks, &ms[i * BIN_CNT], &energy[i]);
+    }
+
+      // Let each decoder run its state machine. Decoders with more blocks
+      // waiting are processed again in the next round.
+    for (size_t i=0; i<batch.size(); ++i)
+    {
+      MultiChannelDtmfDecoder *dec = batch[i];
+      if (dec == 0)
+      {
+        continue;
+      }
+      Block blk(dec->pending.front());
+      dec->pending.pop_front();
+      if (!dec->pending.empty())
+      {
+        ready.push_back(dec);
+      }
+      dec->processBlock(blk, energy[i], &ms[i * BIN_CNT]);
+    }
+    batch.clear();
+  }
+} /* MultiChannelDtmfDecoder::Engine::process */
+
+
+MC_DTMF_KERNEL
+void MultiChannelDtmfDecoder::Engine::calc(const Block *const *blks,
+                                           float *bin_ms, double *blk_energy)
+{
+    // The Goertzel recursion is bound by the latency of each step so the
+    // blocks from CALC_BLOCKS channels are interleaved. That gives the CPU
+    // enough independent work to fill its pipelines.
+  double block_energy[CALC_BLOCKS] = {0.0};
+#ifdef MC_DTMF_VECTOR_EXT
+  VecFloat c[GROUP_CNT], s0[CALC_BLOCKS][GROUP_CNT], s1[CALC_BLOCKS][GROUP_CNT];
+  memcpy(c, two_cosw, sizeof(c));
+  memset(s0, 0, sizeof(s0));
+  memset(s1, 0, sizeof(s1));
+  for (size_t n=0; n<BLOCK_SIZE; ++n)
+  {
+    for (size_t b=0; b<CALC_BLOCKS; ++b)
+    {
+      const float sample = (*blks[b])[n];
+      block_energy[b] += static_cast<double>(sample) * sample;
+      for (size_t g=0; g<GROUP_CNT; ++g)
+      {
+        VecFloat s2 = s1[b][g];
+        s1[b][g] = s0[b][g];
+        s0[b][g] = c[g] * s1[b][g] - s2 + sample;
+      }
+    }
+  }
+  float q0[CALC_BLOCKS][BIN_CNT], q1[CALC_BLOCKS][BIN_CNT];
+  memcpy(q0, s0, sizeof(q0));
+  memcpy(q1, s1, sizeof(q1));
+#else
+  float q0[CALC_BLOCKS][BIN_CNT] = {{0}}, q1[CALC_BLOCKS][BIN_CNT] = {{0}};
+  for (size_t n=0; n<BLOCK_SIZE; ++n)
+  {
+    for (size_t b=0; b<CALC_BLOCKS; ++b)
+    {
+      const float sample = (*blks[b])[n];
+      block_energy[b] += static_cast<double>(sample) * sample;
+      for (size_t k=0; k<BIN_CNT; ++k)
+      {
+        float s2 = q1[b][k];
+        q1[b][k] = q0[b][k];
+        q0[b][k] = two_cosw[k] * q1[b][k] - s2 + sample;
+      }
+    }
+  }
+#endif
+  for (size_t b=0; b<CALC_BLOCKS; ++b)
+  {
+    for (size_t k=0; k<BIN_CNT; ++k)
+    {
+      bin_ms[b * BIN_CNT + k] = q0[b][k] * q0[b][k] + q1[b][k] * q1[b][k] -
+                                q0[b][k] * q1[b][k] * two_cosw[k];
+    }
+    blk_energy[b] = block_energy[b];
+  }
+} /* MultiChannelDtmfDecoder::Engine::calc */
+
+
+
+/*
+ * This file has not been truncated
+ */
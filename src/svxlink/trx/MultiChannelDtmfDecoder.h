@@ -0,0 +1,232 @@
+/**
+@file	 MultiChannelDtmfDecoder.h
+@brief   A sw DTMF decoder sharing one detector engine with other receivers
+@author  Tobias Blomberg / SM0SVX
+@date	 2026-10-14
+
+\verbatim
+SvxLink - A Multi Purpose Voice Services System for Ham Radio Use
+Copyright (C) 2003-2026 Tobias Blomberg / SM0SVX
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+\endverbatim
+*/
+
+
+#ifndef MULTI_CHANNEL_DTMF_DECODER_INCLUDED
+#define MULTI_CHANNEL_DTMF_DECODER_INCLUDED
+
+
+/****************************************************************************
+ *
+ * System Includes
+ *
+ ****************************************************************************/
+
+#include <array>
+#include <deque>
+#include <memory>
+
+
+/****************************************************************************
+ *
+ * Project Includes
+ *
+ ****************************************************************************/
+
+#include <CppStdCompat.h>
+
+
+/****************************************************************************
+ *
+ * Local Includes
+ *
+ ****************************************************************************/
+
+#include "DtmfDecoder.h"
+#include "GoertzelBank.h"
+
+
+/****************************************************************************
+ *
+ * Forward declarations
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Namespace
+ *
+ ****************************************************************************/
+
+//namespace MyNameSpace
+//{
+
+/****************************************************************************
+ *
+ * Defines & typedefs
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Exported Global Variables
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Class definitions
+ *
+ ****************************************************************************/
+
+/**
+ * @brief   A software DTMF decoder for sites with many receivers
+ * @author  Tobias Blomberg, SM0SVX
+ * @date    2026-10-14
+ *
+ * This class use the same detection algorithm as the SvxSwDtmfDecoder but
+ * the Goertzel detectors are not run by each decoder. Instead, all decoders
+ * in the process share one engine. Each decoder hand its completed blocks
+ * over to the engine which, at the end of the main loop iteration, evaluate
+ * the eight DTMF tones for the blocks of all decoders in one vectorized pass.
+ * The result is then handed back to each decoder which run its own detection
+ * state machine and emit its own digit signals. The overtone and
+ * intermodulation checks are only run by a decoder that has found a digit
+ * candidate.
+ *
+ * Since all receivers of a site, e.g. the satellites of a voter, deliver
+ * their audio in the same main loop iteration, the engine process all of
+ * them at once while the detector data is hot in the CPU cache.
+ * The digit signals are delayed until the end of the main loop iteration.
+ */
+class MultiChannelDtmfDecoder : public DtmfDecoder
+{
+  public:
+    /**
+     * @brief 	Constructor
+     * @param 	cfg A previously initialised configuration object
+     * @param 	name The name of the receiver configuration section
+     */
+    MultiChannelDtmfDecoder(Async::Config &cfg, const std::string &name);
+
+    /**
+     * @brief 	Destructor
+     */
+    virtual ~MultiChannelDtmfDecoder(void);
+
+    /**
+     * @brief 	Initialize the DTMF decoder
+     * @returns Returns \em true if the initialization was successful or
+     *          else \em false.
+     */
+    virtual bool initialize(void);
+
+    /**
+     * @brief 	Write samples into the DTMF decoder
+     * @param 	samples The buffer containing the samples
+     * @param 	count The number of samples in the buffer
+     * @return	Returns the number of samples that has been taken care of
+     */
+    virtual int writeSamples(const float *samples, int count);
+
+    /**
+     * @brief 	Tell the DTMF decoder to flush the previously written samples
+     */
+    virtual void flushSamples(void) { sourceAllSamplesFlushed(); }
+
+    /**
+     * @brief 	Return the active digit
+     * @return	Return the active digit if any or a '?' if none.
+     */
+    virtual char activeDigit(void) const
+    {
+      return (det_state == STATE_DETECTED) ? last_digit_active : '?';
+    }
+
+    /**
+     * @brief   The detection time for this detector
+     * @returns Returns the detection time in milliseconds
+     */
+    virtual int detectionTime(void) const { return 40; }
+
+  private:
+    class Engine;
+    friend class Engine;
+
+    typedef enum
+    {
+      STATE_IDLE, STATE_DET_DELAY, STATE_DETECTED
+    } DetState;
+
+    static CONSTEXPR float DEFAULT_MAX_NORMAL_TWIST_DB = 8.5f;
+    static CONSTEXPR float DEFAULT_MAX_REV_TWIST_DB = 6.0f;
+    static CONSTEXPR size_t DET_CNT_HI_WEIGHT = 12;
+    static CONSTEXPR size_t DET_CNT_MED_WEIGHT = 4;
+    static CONSTEXPR size_t DET_CNT_LO_WEIGHT = 1;
+    static CONSTEXPR size_t DEFAULT_MIN_DET_CNT = 2*DET_CNT_HI_WEIGHT;
+    static CONSTEXPR size_t DEFAULT_MIN_UNDET_CNT = 3;
+    static CONSTEXPR size_t BLOCK_SIZE = 20*INTERNAL_SAMPLE_RATE/1000; // 20ms
+    static CONSTEXPR size_t STEP_SIZE = 10*INTERNAL_SAMPLE_RATE/1000; // 10ms
+    static CONSTEXPR float ENERGY_THRESH = 1e-6*BLOCK_SIZE; // Min pb energy
+    static CONSTEXPR float REL_THRESH_LO = 0.5; // Tone/pb pwr low thresh
+    static CONSTEXPR float REL_THRESH_MED = 0.73; // Tone/pb pwr medium thresh
+    static CONSTEXPR float REL_THRESH_HI = 0.9; // Tone/pb pwr high thresh
+    static CONSTEXPR float WIN_ENB = 1.37f; // FFT window equivalent noise bw
+    static CONSTEXPR float MAX_OT_REL = 0.2f; // Overtone at least ~7dB below
+    static CONSTEXPR float MAX_IM_REL = 0.1f; // Intermod prod > 10dB below
+    static CONSTEXPR size_t MAX_PENDING = 4; // Blocks before forced process
+
+    enum { CHK_ROW_OT, CHK_COL_OT, CHK_IM, CHK_CNT };
+
+    typedef std::array<float, BLOCK_SIZE> Block;
+
+    std::shared_ptr<Engine> engine;
+    float                   twist_nrm_thresh;
+    float                   twist_rev_thresh;
+    GoertzelBank            check_bank;
+    float                   block[BLOCK_SIZE];
+    size_t                  block_pos;
+    std::deque<Block>       pending;
+    size_t                  det_cnt;
+    size_t                  undet_cnt;
+    char                    last_digit_active;
+    size_t                  min_det_cnt;
+    size_t                  min_undet_cnt;
+    DetState                det_state;
+    size_t                  det_cnt_weight;
+    int                     duration;
+    size_t                  undet_thresh;
+
+    void processBlock(const Block& blk, double block_energy, const float *ms);
+
+};  /* class MultiChannelDtmfDecoder */
+
+
+//} /* namespace */
+
+#endif /* MULTI_CHANNEL_DTMF_DECODER_INCLUDED */
+
+
+
+/*
+ * This file has not been truncated
+ */
@@ -47,6 +47,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 
 #include <AsyncConfig.h>
 #include <AsyncAudioDecoder.h>
+#include <AsyncAudioCodecPool.h>
 
 
 /****************************************************************************
@@ -136,7 +137,7 @@ NetRx::NetRx(Config &cfg, const string& name)
     log_disconnects_once(false), log_disconnect(true),
     last_signal_strength(0.0), last_sql_rx_id(Rx::ID_UNKNOWN),
     unflushed_samples(false), sql_is_open(false), audio_dec(0), fq(0),
-    modulation(Modulation::MOD_UNKNOWN)
+    modulation(Modulation::MOD_UNKNOWN), last_event_ts(0), delay_estimate(-1)
 {
 } /* NetRx::NetRx */
 
@@ -144,7 +145,7 @@ NetRx::NetRx(Config &cfg, const string& name)
 NetRx::~NetRx(void)
 {
   clearHandler();
-  delete audio_dec;
+  AudioCodecPool::instance().release(audio_dec);
   
   tcp_con->deleteInstance();
   
@@ -175,8 +176,11 @@ bool NetRx::initialize(void)
   string tcp_port(NET_TRX_DEFAULT_TCP_PORT);
   cfg.getValue(name(), "TCP_PORT", tcp_port);
   
-  string udp_port(NET_TRX_DEFAULT_UDP_PORT);
-  cfg.getValue(name(), "UDP_PORT", udp_port);
+  bool udp_audio = false;
+  cfg.getValue(name(), "UDP_AUDIO", udp_audio);
+  unsigned udp_jitter_buffer_delay =
+    NetTrxUdpChannel::DEFAULT_JITTER_BUFFER_DELAY;
+  cfg.getValue(name(), "UDP_JITTER_BUFFER_DELAY", udp_jitter_buffer_delay);
 
   cfg.getValue(name(), "LOG_DISCONNECTS_ONCE", log_disconnects_once);
   
@@ -190,7 +194,7 @@ bool NetRx::initialize(void)
   string auth_key;
   cfg.getValue(name(), "AUTH_KEY", auth_key);
   
-  audio_dec = AudioDecoder::create(audio_dec_name);
+  audio_dec = AudioCodecPool::instance().createDecoder(audio_dec_name);
   if (audio_dec == 0)
   {
     cerr << name() << ": *** ERROR: Illegal audio codec (" << audio_dec_name
@@ -222,6 +226,10 @@ bool NetRx::initialize(void)
     return false;
   }
   tcp_con->setAuthKey(auth_key);
+  if (udp_audio)
+  {
+    tcp_con->enableUdpAudio(udp_jitter_buffer_delay);
+  }
   tcp_con->isReady.connect(mem_fun(*this, &NetRx::connectionReady));
   tcp_con->msgReceived.connect(mem_fun(*this, &NetRx::handleMsg));
   tcp_con->connect();
@@ -342,6 +350,27 @@ void NetRx::setModulation(Modulation::Type mod)
 } /* NetRx::setModulation */
 
 
+bool NetRx::eventTimestamp(uint64_t& ts_us) const
+{
+  if (last_event_ts == 0)
+  {
+    return false;
+  }
+  ts_us = last_event_ts;
+  return true;
+} /* NetRx::eventTimestamp */
+
+
+unsigned NetRx::audioDelay(void) const
+{
+  if (delay_estimate <= 0)
+  {
+    return 0;
+  }
+  return static_cast<unsigned>(delay_estimate / 1000);
+} /* NetRx::audioDelay */
+
+
 
 /****************************************************************************
  *
@@ -449,6 +478,8 @@ void NetRx::handleMsg(Msg *msg)
       if (muteState() != Rx::MUTE_ALL)
       {
         MsgSquelch *sql_msg = reinterpret_cast<MsgSquelch*>(msg);
+        last_event_ts = sql_msg->timestamp();
+        updateDelayEstimate(last_event_ts);
         last_signal_strength = sql_msg->signalStrength();
         last_sql_rx_id = sql_msg->sqlRxId();
         sql_is_open = sql_msg->isOpen();
@@ -477,6 +508,8 @@ void NetRx::handleMsg(Msg *msg)
       if (muteState() != Rx::MUTE_ALL)
       {
         MsgSiglevUpdate *sql_msg = reinterpret_cast<MsgSiglevUpdate*>(msg);
+        last_event_ts = sql_msg->timestamp();
+        updateDelayEstimate(last_event_ts);
         last_signal_strength = sql_msg->signalStrength();
         last_sql_rx_id = sql_msg->sqlRxId();
         signalLevelUpdated(last_signal_strength);
@@ -510,6 +543,7 @@ void NetRx::handleMsg(Msg *msg)
       if ((muteState() == Rx::MUTE_NONE) && sql_is_open)
       {
 	MsgAudio *audio_msg = reinterpret_cast<MsgAudio*>(msg);
+        updateDelayEstimate(audio_msg->timestamp());
 	unflushed_samples = true;
         audio_dec->writeEncodedSamples(audio_msg->buf(), audio_msg->size());
       }
@@ -574,6 +608,28 @@ void NetRx::publishSquelchState(void)
 } /* NetRx::publishSquelchState */
 
 
+void NetRx::updateDelayEstimate(uint64_t ts)
+{
+  if (ts == 0)
+  {
+    return;
+  }
+
+    // A negative delay means that the clocks are not perfectly synchronized.
+    // Clamp it to zero rather than letting it pull the estimate down.
+  int64_t delay = static_cast<int64_t>(Msg::currentTimestamp() - ts);
+  delay = max(delay, int64_t(0));
+  if (delay_estimate < 0)
+  {
+    delay_estimate = delay;
+  }
+  else
+  {
+    delay_estimate += (delay - delay_estimate) / 8;
+  }
+} /* NetRx::updateDelayEstimate */
+
+
 
 /*
  * This file has not been truncated
@@ -190,6 +190,23 @@ class NetRx : public Rx
      */
     virtual void setModulation(Modulation::Type mod);
 
+    /**
+     * @brief   Get the capture time of the current receiver event
+     * @param   ts_us Set to the wall clock capture time in microseconds
+     * @return  Returns \em true if the remote receiver sent a timestamp
+     */
+    bool eventTimestamp(uint64_t& ts_us) const override;
+
+    /**
+     * @brief   Get the estimated audio delay for this receiver
+     * @return  Returns the estimated network delay in milliseconds
+     *
+     * The delay is estimated from the timestamps in the messages received
+     * from the remote receiver so the clocks on both sides must be
+     * synchronized for this estimate to be meaningful.
+     */
+    unsigned audioDelay(void) const override;
+
     /**
      * @brief Resume audio output to the sink
      *
@@ -215,12 +232,15 @@ class NetRx : public Rx
     unsigned            fq;
     Modulation::Type    modulation;
     std::string         last_sql_activity_info;
+    uint64_t            last_event_ts;
+    int64_t             delay_estimate;
 
     void connectionReady(bool is_ready);
     void handleMsg(NetTrxMsg::Msg *msg);
     void sendMsg(NetTrxMsg::Msg *msg);
     void allEncodedSamplesFlushed(void);
     void publishSquelchState(void);
+    void updateDelayEstimate(uint64_t ts);
 
 };  /* class NetRx */
 
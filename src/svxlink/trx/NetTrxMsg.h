@@ -6,7 +6,7 @@
 
 \verbatim
 SvxLink - A Multi Purpose Voice Services System for Ham Radio Use
-Copyright (C) 2003-2018 Tobias Blomberg / SM0SVX
+Copyright (C) 2003-2026 Tobias Blomberg / SM0SVX
 
 This program is free software; you can redistribute it and/or modify
 it under the terms of the GNU General Public License as published by
@@ -40,6 +40,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 #include <iostream>
 #include <vector>
 #include <utility>
+#include <chrono>
 
 #include <gcrypt.h>
 
@@ -146,6 +147,19 @@ class Msg
      * @return	Returns the message size
      */
      unsigned size(void) const { return m_size; }
+
+    /**
+     * @brief   Get the current time to use as a message timestamp
+     * @return  Returns the wall clock time in microseconds since the epoch
+     *
+     * Timestamps are only comparable between hosts if their clocks are
+     * synchronized, e.g. using NTP.
+     */
+    static uint64_t currentTimestamp(void)
+    {
+      return std::chrono::duration_cast<std::chrono::microseconds>(
+          std::chrono::system_clock::now().time_since_epoch()).count();
+    }
     
   protected:
   
@@ -173,7 +187,7 @@ class MsgProtoVer : public Msg
   public:
     static const unsigned TYPE  = 0;
     static const uint16_t MAJOR = 2;
-    static const uint16_t MINOR = 8;
+    static const uint16_t MINOR = 9;
     MsgProtoVer(void)
       : Msg(TYPE, sizeof(MsgProtoVer)), m_major(MAJOR),
         m_minor(MINOR) {}
@@ -187,12 +201,30 @@ class MsgProtoVer : public Msg
 }; /* MsgProtoVer */
 
 
+/**
+@brief  Heartbeat message, also used to measure the round trip time
+
+Each side echo the timestamp of the last heartbeat received from the other
+side, together with the time that has passed since it was received. The
+receiver of the echo can then calculate the round trip time using only its
+own clock.
+*/
 class MsgHeartbeat : public Msg
 {
   public:
     static const unsigned TYPE = 1;
-    MsgHeartbeat(void) : Msg(TYPE, sizeof(MsgHeartbeat)) {}
-    
+    MsgHeartbeat(uint64_t echo_timestamp=0, uint32_t echo_delay=0)
+      : Msg(TYPE, sizeof(MsgHeartbeat)), m_timestamp(currentTimestamp()),
+        m_echo_timestamp(echo_timestamp), m_echo_delay(echo_delay) {}
+    uint64_t timestamp(void) const { return m_timestamp; }
+    uint64_t echoTimestamp(void) const { return m_echo_timestamp; }
+    uint32_t echoDelay(void) const { return m_echo_delay; }
+
+  private:
+    uint64_t m_timestamp;
+    uint64_t m_echo_timestamp;
+    uint32_t m_echo_delay;
+
 };  /* MsgHeartbeat */
 
 
@@ -277,6 +309,40 @@ class MsgAuthOk : public Msg
 };  /* MsgAuthOk */
 
 
+class MsgUdpSetupRequest : public Msg
+{
+  public:
+    static const unsigned TYPE = 20;
+    MsgUdpSetupRequest(void) : Msg(TYPE, sizeof(MsgUdpSetupRequest)) {}
+
+};  /* MsgUdpSetupRequest */
+
+
+class MsgUdpSetup : public Msg
+{
+  public:
+    static const unsigned TYPE      = 21;
+    static const int      SALT_LEN  = 16;
+    MsgUdpSetup(uint16_t port=0, uint32_t session_id=0, bool encrypted=false)
+      : Msg(TYPE, sizeof(MsgUdpSetup)), m_port(port),
+        m_session_id(session_id), m_encrypted(encrypted)
+    {
+      gcry_create_nonce(m_salt, SALT_LEN);
+    }
+    uint16_t port(void) const { return m_port; }
+    uint32_t sessionId(void) const { return m_session_id; }
+    bool encrypted(void) const { return m_encrypted; }
+    const unsigned char *salt(void) const { return m_salt; }
+
+  private:
+    uint16_t      m_port;
+    uint32_t      m_session_id;
+    bool          m_encrypted;
+    unsigned char m_salt[SALT_LEN];
+
+};  /* MsgUdpSetup */
+
+
 
 
 
@@ -409,22 +475,46 @@ class MsgAudio : public Msg
   public:
     static const unsigned TYPE = 102;
     static const int BUFSIZE = sizeof(float) * 512;
-    MsgAudio(const void *buf, int size)
+    MsgAudio(const void *buf, int size, uint64_t timestamp=0)
       : Msg(TYPE, sizeof(MsgAudio) - (BUFSIZE - size))
     {
       assert(size <= BUFSIZE);
       memcpy(m_buf, buf, size);
       m_size = size;
+        // The capture timestamp is appended after the audio data so that
+        // receivers not knowing about it just ignore it
+      if (timestamp != 0)
+      {
+        memcpy(m_buf + size, &timestamp, sizeof(timestamp));
+      }
+      else
+      {
+        setSize(Msg::size() - sizeof(timestamp));
+      }
     }
     void *buf(void)
     {
       return m_buf;
     }
     int size(void) const { return m_size; }
+    bool hasTimestamp(void) const
+    {
+      return (m_size >= 0) && (m_size <= BUFSIZE) &&
+             (Msg::size() >= sizeof(MsgAudio) - (BUFSIZE - m_size));
+    }
+    uint64_t timestamp(void) const
+    {
+      uint64_t ts = 0;
+      if (hasTimestamp())
+      {
+        memcpy(&ts, m_buf + m_size, sizeof(ts));
+      }
+      return ts;
+    }
   
   private:
     int     m_size;
-    uint8_t m_buf[BUFSIZE];
+    uint8_t m_buf[BUFSIZE + sizeof(uint64_t)];
     
 }; /* MsgAudio */
 
@@ -512,9 +602,10 @@ class MsgSquelch : public Msg
     static const unsigned TYPE = 250;
     static const int MAX_ACTIVITY_INFO_LEN = 127;
     MsgSquelch(bool is_open, float signal_strength, char sql_rx_id,
-               const std::string& sql_activity_info)
+               const std::string& sql_activity_info, uint64_t timestamp=0)
       : Msg(TYPE, sizeof(MsgSquelch)), m_is_open(is_open),
-        m_signal_strength(signal_strength), m_sql_rx_id(sql_rx_id)
+        m_signal_strength(signal_strength), m_sql_rx_id(sql_rx_id),
+        m_timestamp(timestamp)
     {
       std::memset(m_sql_activity_info, 0, MAX_ACTIVITY_INFO_LEN+1);
       std::strncpy(m_sql_activity_info, sql_activity_info.data(),
@@ -533,12 +624,21 @@ class MsgSquelch : public Msg
       }
       return std::string(m_sql_activity_info, end);
     }
+    bool hasTimestamp(void) const
+    {
+      return (size() >= sizeof(MsgSquelch)) && (m_timestamp != 0);
+    }
+    uint64_t timestamp(void) const
+    {
+      return hasTimestamp() ? m_timestamp : 0;
+    }
 
   private:
-    bool  m_is_open;
-    float m_signal_strength;
-    char  m_sql_rx_id;
-    char  m_sql_activity_info[MAX_ACTIVITY_INFO_LEN+1];
+    bool      m_is_open;
+    float     m_signal_strength;
+    char      m_sql_rx_id;
+    char      m_sql_activity_info[MAX_ACTIVITY_INFO_LEN+1];
+    uint64_t  m_timestamp;
 
 }; /* MsgSquelch */
 
@@ -596,15 +696,25 @@ class MsgSiglevUpdate : public Msg
 {
   public:
     static const unsigned TYPE = 254;
-    MsgSiglevUpdate(float signal_strength, char sql_rx_id)
+    MsgSiglevUpdate(float signal_strength, char sql_rx_id,
+                    uint64_t timestamp=0)
       : Msg(TYPE, sizeof(MsgSiglevUpdate)), m_signal_strength(signal_strength),
-        m_sql_rx_id(sql_rx_id) {}
+        m_sql_rx_id(sql_rx_id), m_timestamp(timestamp) {}
     float signalStrength(void) const { return m_signal_strength; }
     char sqlRxId(void) const { return m_sql_rx_id; }
+    bool hasTimestamp(void) const
+    {
+      return (size() >= sizeof(MsgSiglevUpdate)) && (m_timestamp != 0);
+    }
+    uint64_t timestamp(void) const
+    {
+      return hasTimestamp() ? m_timestamp : 0;
+    }
   
   private:
-    float m_signal_strength;
-    char  m_sql_rx_id;
+    float     m_signal_strength;
+    char      m_sql_rx_id;
+    uint64_t  m_timestamp;
     
 }; /* MsgSiglevUpdate */
 
@@ -716,6 +826,30 @@ class MsgSetTxModulation : public Msg
 }; /* MsgSetTxModulation */
 
 
+/**
+@brief  Tell the remote transmitter when to start transmitting a stream
+
+This message is sent just before the first audio of a new TX audio stream.
+The launch time is the wall clock time, in microseconds since the epoch, at
+which the first sample of the stream should be transmitted. Transmitters
+in a simulcast system, with synchronized clocks, will then start to
+transmit at the same time even if the network delay to them differ.
+*/
+class MsgTxLaunchTime : public Msg
+{
+  public:
+    static const unsigned TYPE = 307;
+    static const unsigned MAX_DELAY = 2000;
+    MsgTxLaunchTime(uint64_t launch_time)
+      : Msg(TYPE, sizeof(MsgTxLaunchTime)), m_launch_time(launch_time) {}
+    uint64_t launchTime(void) const { return m_launch_time; }
+
+  private:
+    uint64_t m_launch_time;
+
+}; /* MsgTxLaunchTime */
+
+
 
 class MsgTxTimeout : public Msg
 {
@@ -6,7 +6,7 @@
 
 \verbatim
 SvxLink - A Multi Purpose Voice Services System for Ham Radio Use
-Copyright (C) 2003-2022 Tobias Blomberg / SM0SVX
+Copyright (C) 2003-2026 Tobias Blomberg / SM0SVX
 
 This program is free software; you can redistribute it and/or modify
 it under the terms of the GNU General Public License as published by
@@ -183,10 +183,47 @@ void NetTrxTcpClient::deleteInstance(void)
 } /* NetTrxTcpClient::deleteInstance */
 
 
+void NetTrxTcpClient::enableUdpAudio(unsigned jitter_buffer_delay)
+{
+  udp_enabled = true;
+  if (jitter_buffer_delay > 0)
+  {
+    udp_jitter_buffer_delay = jitter_buffer_delay;
+    if (udp_chan != 0)
+    {
+      udp_chan->setJitterBufferDelay(udp_jitter_buffer_delay);
+    }
+  }
+  if (state == STATE_READY)
+  {
+    requestUdpSetup();
+  }
+} /* NetTrxTcpClient::enableUdpAudio */
+
+
 void NetTrxTcpClient::sendMsg(Msg *msg)
 {
   if (state == STATE_READY)
   {
+    if (udp_chan != 0)
+    {
+        // Audio and the flush that end an audio stream go over the UDP
+        // channel if possible. Everything else always go over TCP.
+      if (msg->type() == MsgAudio::TYPE)
+      {
+        MsgAudio *audio_msg = reinterpret_cast<MsgAudio*>(msg);
+        if (udp_chan->sendAudio(audio_msg->buf(), audio_msg->size()))
+        {
+          delete msg;
+          return;
+        }
+      }
+      else if ((msg->type() == MsgFlush::TYPE) && udp_chan->sendFlush())
+      {
+        delete msg;
+        return;
+      }
+    }
     sendMsgP(msg);
   }
   else
@@ -215,7 +252,11 @@ NetTrxTcpClient::NetTrxTcpClient(const std::string& remote_host,
       	      	      	      	 uint16_t remote_port, size_t recv_buf_len)
   : TcpClient<>(remote_host, remote_port, recv_buf_len), recv_cnt(0),
     recv_exp(0), reconnect_timer(0), last_msg_timestamp(), heartbeat_timer(0),
-    user_cnt(0), state(STATE_DISC), disc_reason(DR_SYSTEM_ERROR)
+    peer_hb_timestamp(0), peer_hb_rx_timestamp(), rtt(-1),
+    user_cnt(0), state(STATE_DISC), disc_reason(DR_SYSTEM_ERROR),
+    auth_challenge_received(false), udp_enabled(false), udp_requested(false),
+    udp_jitter_buffer_delay(NetTrxUdpChannel::DEFAULT_JITTER_BUFFER_DELAY),
+    udp_chan(0)
 {
   connected.connect(mem_fun(*this, &NetTrxTcpClient::tcpConnected));
   disconnected.connect(mem_fun(*this, &NetTrxTcpClient::tcpDisconnected));
@@ -236,6 +277,7 @@ NetTrxTcpClient::~NetTrxTcpClient(void)
 {
   delete reconnect_timer;
   delete heartbeat_timer;
+  delete udp_chan;
 } /* NetTrxTcpClient::~NetTrxTcpClient */
 
 
@@ -254,6 +296,8 @@ void NetTrxTcpClient::tcpConnected(void)
   recv_exp = sizeof(Msg);
   gettimeofday(&last_msg_timestamp, NULL);
   heartbeat_timer->setEnable(true);
+  peer_hb_timestamp = 0;
+  rtt = -1;
   state = STATE_VER_WAIT;
 } /* NetTx::tcpConnected */
 
@@ -264,6 +308,8 @@ void NetTrxTcpClient::tcpDisconnected(TcpConnection *con,
   disc_reason = reason;
   recv_exp = 0;
   state = STATE_DISC;
+  auth_challenge_received = false;
+  closeUdpChannel();
   reconnect_timer->setEnable(true);
   heartbeat_timer->setEnable(false);
   isReady(false);
@@ -391,6 +437,9 @@ void NetTrxTcpClient::handleMsg(Msg *msg)
           return;
         }
         MsgAuthChallenge *chal_msg = reinterpret_cast<MsgAuthChallenge*>(msg);
+        memcpy(auth_challenge, chal_msg->challenge(),
+               MsgAuthChallenge::CHALLENGE_LEN);
+        auth_challenge_received = true;
         MsgAuthResponse *resp_msg =
             new MsgAuthResponse(auth_key, chal_msg->challenge());
         sendMsgP(resp_msg);
@@ -406,6 +455,10 @@ void NetTrxTcpClient::handleMsg(Msg *msg)
           return;
         }
         state = STATE_READY;
+        if (udp_enabled)
+        {
+          requestUdpSetup();
+        }
         isReady(true);
       }
       return;
@@ -420,6 +473,25 @@ void NetTrxTcpClient::handleMsg(Msg *msg)
   {
     case MsgHeartbeat::TYPE:
     {
+      if (msg->size() < sizeof(MsgHeartbeat))
+      {
+        break;
+      }
+      MsgHeartbeat *hb_msg = reinterpret_cast<MsgHeartbeat*>(msg);
+      peer_hb_timestamp = hb_msg->timestamp();
+      peer_hb_rx_timestamp = last_msg_timestamp;
+      if (hb_msg->echoTimestamp() != 0)
+      {
+        int64_t rtt_us = static_cast<int64_t>(Msg::currentTimestamp() -
+            hb_msg->echoTimestamp()) - hb_msg->echoDelay();
+        rtt = static_cast<int>(max(rtt_us, int64_t(0)) / 1000);
+      }
+      break;
+    }
+
+    case MsgUdpSetup::TYPE:
+    {
+      handleUdpSetup(msg);
       break;
     }
     
@@ -433,6 +505,18 @@ void NetTrxTcpClient::handleMsg(Msg *msg)
       break;
     
     default:
+        // A squelch close must not be handled before the end of the audio
+        // stream that is still in the UDP jitter buffer. Messages after
+        // a deferred message are also deferred to keep them in order.
+      if (!deferred_msgs.empty() ||
+          ((msg->type() == MsgSquelch::TYPE) &&
+           !reinterpret_cast<MsgSquelch*>(msg)->isOpen() &&
+           (udp_chan != 0) && udp_chan->rxStreamActive()))
+      {
+        const char *ptr = reinterpret_cast<const char*>(msg);
+        deferred_msgs.push_back(vector<char>(ptr, ptr + msg->size()));
+        break;
+      }
       msgReceived(msg);
       break;
   }
@@ -443,12 +527,19 @@ void NetTrxTcpClient::handleMsg(Msg *msg)
 
 void NetTrxTcpClient::heartbeat(Timer *t)
 {
-  MsgHeartbeat *msg = new MsgHeartbeat;
-  sendMsgP(msg);
-  
   struct timeval diff_tv;
   struct timeval now;
   gettimeofday(&now, NULL);
+
+  uint32_t echo_delay = 0;
+  if (peer_hb_timestamp != 0)
+  {
+    timersub(&now, &peer_hb_rx_timestamp, &diff_tv);
+    echo_delay = diff_tv.tv_sec * 1000000 + diff_tv.tv_usec;
+  }
+  MsgHeartbeat *msg = new MsgHeartbeat(peer_hb_timestamp, echo_delay);
+  sendMsgP(msg);
+  
   timersub(&now, &last_msg_timestamp, &diff_tv);
   int diff_ms = diff_tv.tv_sec * 1000 + diff_tv.tv_usec / 1000;
   
@@ -496,6 +587,123 @@ void NetTrxTcpClient::sendMsgP(Msg *msg)
 } /* NetTrxTcpClient::sendMsgP */
 
 
+void NetTrxTcpClient::requestUdpSetup(void)
+{
+  if (!udp_requested)
+  {
+    udp_requested = true;
+    sendMsgP(new MsgUdpSetupRequest);
+  }
+} /* NetTrxTcpClient::requestUdpSetup */
+
+
+void NetTrxTcpClient::handleUdpSetup(Msg *msg)
+{
+  if (msg->size() != sizeof(MsgUdpSetup))
+  {
+    cerr << "*** ERROR: Protocol error. Wrong length of "
+            "MsgUdpSetup message. Disconnecting from "
+         << remoteHost().toString() << ":" << remotePort() << "...\n";
+    localDisconnect();
+    return;
+  }
+
+  MsgUdpSetup *setup_msg = reinterpret_cast<MsgUdpSetup*>(msg);
+  if (setup_msg->port() == 0)
+  {
+    cout << remoteHost().toString() << ":" << remotePort()
+         << ": UDP audio not enabled on the remote side. Using TCP for "
+            "audio.\n";
+    return;
+  }
+
+    // The channel object is kept between connections since it may be
+    // closed from within one of its own signal handlers
+  if (udp_chan == 0)
+  {
+    udp_chan = new NetTrxUdpChannel(NetTrxUdpChannel::ROLE_CLIENT);
+    if (!udp_chan->initOk())
+    {
+      cerr << "*** ERROR: Could not create the UDP audio socket for "
+           << remoteHost().toString() << ":" << remotePort()
+           << ". Using TCP for audio.\n";
+      delete udp_chan;
+      udp_chan = 0;
+      return;
+    }
+    udp_chan->upStateChanged.connect(
+        mem_fun(*this, &NetTrxTcpClient::udpUpStateChanged));
+    udp_chan->audioReceived.connect(
+        mem_fun(*this, &NetTrxTcpClient::udpAudioReceived));
+    udp_chan->flushReceived.connect(
+        mem_fun(*this, &NetTrxTcpClient::udpFlushReceived));
+  }
+  udp_chan->setJitterBufferDelay(udp_jitter_buffer_delay);
+  if (!udp_chan->open(*setup_msg, auth_key,
+                      auth_challenge_received ? auth_challenge : 0))
+  {
+    cerr << "*** ERROR: Could not set up the UDP audio channel to "
+         << remoteHost().toString() << ":" << setup_msg->port()
+         << ". Using TCP for audio.\n";
+    return;
+  }
+  udp_chan->setRemote(remoteHost(), setup_msg->port());
+} /* NetTrxTcpClient::handleUdpSetup */
+
+
+void NetTrxTcpClient::closeUdpChannel(void)
+{
+  if (udp_chan != 0)
+  {
+    udp_chan->close();
+  }
+  udp_requested = false;
+  deferred_msgs.clear();
+} /* NetTrxTcpClient::closeUdpChannel */
+
+
+void NetTrxTcpClient::udpUpStateChanged(bool is_up)
+{
+  if (is_up)
+  {
+    cout << remoteHost().toString() << ":" << remotePort()
+         << ": UDP audio channel up"
+         << (udp_chan->isEncrypted() ? " (encrypted)" : "") << endl;
+  }
+  else
+  {
+    const NetTrxUdpChannel::Stats& stats = udp_chan->statistics();
+    cout << remoteHost().toString() << ":" << remotePort()
+         << ": UDP audio channel down. Using TCP for audio. Received="
+         << stats.received_packets << " lost=" << stats.lost_packets
+         << " late=" << stats.late_packets << endl;
+  }
+} /* NetTrxTcpClient::udpUpStateChanged */
+
+
+void NetTrxTcpClient::udpAudioReceived(const void *buf, int size)
+{
+  if ((state != STATE_READY) || (size > MsgAudio::BUFSIZE))
+  {
+    return;
+  }
+  MsgAudio msg(buf, size);
+  msgReceived(&msg);
+} /* NetTrxTcpClient::udpAudioReceived */
+
+
+void NetTrxTcpClient::udpFlushReceived(void)
+{
+  while (!deferred_msgs.empty() && (state == STATE_READY))
+  {
+    vector<char> buf;
+    buf.swap(deferred_msgs.front());
+    deferred_msgs.pop_front();
+    msgReceived(reinterpret_cast<Msg*>(buf.data()));
+  }
+} /* NetTrxTcpClient::udpFlushReceived */
+
+
 
 /*
  * This file has not been truncated
@@ -6,7 +6,7 @@
 
 \verbatim
 SvxLink - A Multi Purpose Voice Services System for Ham Radio Use
-Copyright (C) 2003-2024 Tobias Blomberg / SM0SVX
+Copyright (C) 2003-2026 Tobias Blomberg / SM0SVX
 
 This program is free software; you can redistribute it and/or modify
 it under the terms of the GNU General Public License as published by
@@ -36,6 +36,8 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
  ****************************************************************************/
 
 #include <map>
+#include <deque>
+#include <vector>
 #include <utility>
 #include <string>
 
@@ -58,6 +60,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
  ****************************************************************************/
 
 #include "NetTrxMsg.h"
+#include "NetTrxUdpChannel.h"
 
 
 /****************************************************************************
@@ -146,6 +149,17 @@ class NetTrxTcpClient : public Async::TcpClient<>
      * @param key The autentication key to use
      */
     void setAuthKey(const std::string &key) { auth_key = key; }
+
+    /**
+     * @brief Request that audio is sent over UDP
+     * @param jitter_buffer_delay The receive jitter buffer delay in ms, or
+     *                            zero to keep the current setting
+     *
+     * The UDP channel is negotiated when the connection is ready. If the
+     * remote side does not support UDP audio, or if no datagrams get
+     * through, the audio is sent over the TCP connection.
+     */
+    void enableUdpAudio(unsigned jitter_buffer_delay=0);
     
     /**
      * @brief Send a message over the connection
@@ -158,6 +172,15 @@ class NetTrxTcpClient : public Async::TcpClient<>
      */
     DiscReason disconnectReason(void) const { return disc_reason; }
 
+    /**
+     * @brief Get the last measured round trip time
+     * @return Returns the round trip time in milliseconds or -1 if unknown
+     *
+     * The round trip time is measured using the heartbeat messages so it is
+     * updated every ten seconds.
+     */
+    int roundTripTime(void) const { return rtt; }
+
     /**
      * @brief 	Connect to the remote host
      *
@@ -218,10 +241,20 @@ class NetTrxTcpClient : public Async::TcpClient<>
     Async::Timer    *reconnect_timer;
     struct timeval  last_msg_timestamp;
     Async::Timer    *heartbeat_timer;
+    uint64_t        peer_hb_timestamp;
+    struct timeval  peer_hb_rx_timestamp;
+    int             rtt;
     int       	    user_cnt;
     std::string     auth_key;
     State           state;
     DiscReason      disc_reason;
+    unsigned char   auth_challenge[NetTrxMsg::MsgAuthChallenge::CHALLENGE_LEN];
+    bool            auth_challenge_received;
+    bool            udp_enabled;
+    bool            udp_requested;
+    unsigned        udp_jitter_buffer_delay;
+    NetTrxUdpChannel *udp_chan;
+    std::deque<std::vector<char> > deferred_msgs;
     
     NetTrxTcpClient(const NetTrxTcpClient&);
     using TcpClientBase::operator=;
@@ -236,6 +269,12 @@ class NetTrxTcpClient : public Async::TcpClient<>
     void heartbeat(Async::Timer *t);
     void localDisconnect(void);
     void sendMsgP(NetTrxMsg::Msg *msg);
+    void requestUdpSetup(void);
+    void handleUdpSetup(NetTrxMsg::Msg *msg);
+    void closeUdpChannel(void);
+    void udpUpStateChanged(bool is_up);
+    void udpAudioReceived(const void *buf, int size);
+    void udpFlushReceived(void);
 
 };  /* class NetTrxTcpClient */
 
@@ -0,0 +1,682 @@
+/**
+@file	 NetTrxUdpChannel.cpp
+@brief   A UDP audio channel for remote transceivers
+@author  Tobias Blomberg / SM0SVX
+@date	 2026-10-14
+
+\verbatim
+SvxLink - A Multi Purpose Voice Services System for Ham Radio Use
+Copyright (C) 2003-2026 Tobias Blomberg / SM0SVX
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+\endverbatim
+*/
+
+
+
+/****************************************************************************
+ *
+ * System Includes
+ *
+ ****************************************************************************/
+
+#include <cstring>
+#include <iostream>
+#include <utility>
+
+#include <gcrypt.h>
+
+
+/****************************************************************************
+ *
+ * Project Includes
+ *
+ ****************************************************************************/
+
+#include <AsyncEncryptedUdpSocket.h>
+
+
+/****************************************************************************
+ *
+ * Local Includes
+ *
+ ****************************************************************************/
+
+#include "NetTrxUdpChannel.h"
+
+
+
+/****************************************************************************
+ *
+ * Namespaces to use
+ *
+ ****************************************************************************/
+
+using namespace std;
+using namespace Async;
+using namespace NetTrxMsg;
+
+
+
+/****************************************************************************
+ *
+ * Defines & typedefs
+ *
+ ****************************************************************************/
+
+namespace {
+  const char*   CIPHER_NAME   = "AES-128-GCM";
+  const size_t  KEY_LEN       = 16;
+  const size_t  IV_RAND_LEN   = 7;
+  const size_t  TAG_LEN       = 8;
+
+  const uint8_t TYPE_HEARTBEAT  = 0;
+  const uint8_t TYPE_AUDIO      = 1;
+  const uint8_t TYPE_FLUSH      = 2;
+
+#pragma pack(push, 1)
+    // Sent as associated data when encrypted
+  struct DatagramHeader
+  {
+    uint32_t session_id;
+    uint32_t cntr;
+  };
+#pragma pack(pop)
+};
+
+#pragma pack(push, 1)
+struct NetTrxUdpChannel::PayloadHeader
+{
+  uint8_t  type;
+  uint16_t stream_id;
+  uint16_t seq;
+  uint32_t timestamp;
+};
+#pragma pack(pop)
+
+
+
+/****************************************************************************
+ *
+ * Local class definitions
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Prototypes
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Exported Global Variables
+ *
+ ****************************************************************************/
+
+
+
+
+/****************************************************************************
+ *
+ * Local Global Variables
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Public member functions
+ *
+ ****************************************************************************/
+
+NetTrxUdpChannel::NetTrxUdpChannel(Role role, uint16_t local_port)
+  : role(role), sock(0), jitter_buffer_delay(DEFAULT_JITTER_BUFFER_DELAY),
+    session_id(0), encrypted(false), remote_port(0), is_up(false),
+    heartbeat_timer(HEARTBEAT_INTERVAL, Timer::TYPE_PERIODIC, false),
+    tx_cntr(0), rx_highest_cntr(0), tx_state(TX_IDLE), tx_stream_id(0),
+    tx_seq(0), rx_stream_active(false), rx_stream_valid(false),
+    rx_stream_id(0), rx_next_seq(0),
+    playout_timer(0, Timer::TYPE_ONESHOT, false),
+    rx_stream_timer(RX_STREAM_TIMEOUT, Timer::TYPE_ONESHOT, false), stats()
+{
+  sock = new EncryptedUdpSocket(local_port);
+  sock->cipherDataReceived.connect(
+      mem_fun(*this, &NetTrxUdpChannel::cipherDataReceived));
+  sock->dataReceived.connect(
+      mem_fun(*this, &NetTrxUdpChannel::datagramReceived));
+  heartbeat_timer.expired.connect(
+      mem_fun(*this, &NetTrxUdpChannel::heartbeat));
+  playout_timer.expired.connect(
+      mem_fun(*this, &NetTrxUdpChannel::playoutTimerExpired));
+  rx_stream_timer.expired.connect(
+      mem_fun(*this, &NetTrxUdpChannel::rxStreamTimeout));
+} /* NetTrxUdpChannel::NetTrxUdpChannel */
+
+
+NetTrxUdpChannel::~NetTrxUdpChannel(void)
+{
+  delete sock;
+} /* NetTrxUdpChannel::~NetTrxUdpChannel */
+
+
+bool NetTrxUdpChannel::initOk(void) const
+{
+  return sock->initOk();
+} /* NetTrxUdpChannel::initOk */
+
+
+bool NetTrxUdpChannel::open(const MsgUdpSetup& setup_msg,
+                            const std::string& auth_key,
+                            const unsigned char *challenge)
+{
+  close();
+
+  if (setup_msg.sessionId() == 0)
+  {
+    return false;
+  }
+
+  if (setup_msg.encrypted())
+  {
+    if (auth_key.empty() || (challenge == 0))
+    {
+      cerr << "*** ERROR: An authentication key is needed for an encrypted "
+              "UDP audio channel\n";
+      return false;
+    }
+
+      // Derive the session key and the fixed part of the IV from the
+      // shared authentication key, the challenge and the random salt
+    unsigned char digest[32];
+    gcry_md_hd_t hd = { 0 };
+    gcry_error_t err = gcry_md_open(&hd, GCRY_MD_SHA256, GCRY_MD_FLAG_HMAC);
+    if (!err)
+    {
+      err = gcry_md_setkey(hd, auth_key.c_str(), auth_key.size());
+    }
+    if (err)
+    {
+      gcry_md_close(hd);
+      cerr << "*** ERROR: gcrypt error: "
+           << gcry_strsource(err) << "/" << gcry_strerror(err) << endl;
+      return false;
+    }
+    gcry_md_write(hd, challenge, MsgAuthChallenge::CHALLENGE_LEN);
+    gcry_md_write(hd, setup_msg.salt(), MsgUdpSetup::SALT_LEN);
+    memcpy(digest, gcry_md_read(hd, 0), sizeof(digest));
+    gcry_md_close(hd);
+
+    vector<uint8_t> key(digest, digest + KEY_LEN);
+    iv_rand.assign(digest + KEY_LEN, digest + KEY_LEN + IV_RAND_LEN);
+    if (!sock->setCipher(CIPHER_NAME) || !sock->setCipherKey(key))
+    {
+      cerr << "*** ERROR: Could not set up the UDP audio channel cipher "
+           << CIPHER_NAME << endl;
+      return false;
+    }
+    sock->setTagLength(TAG_LEN);
+    sock->setCipherAADLength(sizeof(DatagramHeader));
+  }
+
+  session_id = setup_msg.sessionId();
+  encrypted = setup_msg.encrypted();
+  heartbeat_timer.setEnable(true);
+
+  return true;
+
+} /* NetTrxUdpChannel::open */
+
+
+void NetTrxUdpChannel::setRemote(const IpAddress& ip, uint16_t port)
+{
+  remote_ip = ip;
+  remote_port = port;
+} /* NetTrxUdpChannel::setRemote */
+
+
+void NetTrxUdpChannel::close(void)
+{
+  session_id = 0;
+  encrypted = false;
+  iv_rand.clear();
+  remote_ip = IpAddress();
+  remote_port = 0;
+  is_up = false;
+  tx_cntr = 0;
+  rx_highest_cntr = 0;
+  tx_state = TX_IDLE;
+  rx_stream_active = false;
+  rx_stream_valid = false;
+  rx_buf.clear();
+  heartbeat_timer.setEnable(false);
+  playout_timer.setEnable(false);
+  rx_stream_timer.setEnable(false);
+  stats = Stats();
+} /* NetTrxUdpChannel::close */
+
+
+bool NetTrxUdpChannel::sendAudio(const void *buf, int size)
+{
+  if ((tx_state == TX_TCP) || !is_up)
+  {
+    tx_state = TX_TCP;
+    return false;
+  }
+
+  if (tx_state == TX_IDLE)
+  {
+    tx_state = TX_UDP;
+    tx_stream_id += 1;
+    tx_seq = 0;
+    tx_stream_start = Clock::now();
+  }
+
+  PayloadHeader ph;
+  ph.type = TYPE_AUDIO;
+  ph.stream_id = tx_stream_id;
+  ph.seq = tx_seq++;
+  ph.timestamp = chrono::duration_cast<chrono::milliseconds>(
+      Clock::now() - tx_stream_start).count();
+  if (!sendDatagram(ph, buf, size))
+  {
+    tx_state = TX_TCP;
+    return false;
+  }
+
+  return true;
+
+} /* NetTrxUdpChannel::sendAudio */
+
+
+bool NetTrxUdpChannel::sendFlush(void)
+{
+  TxState state = tx_state;
+  tx_state = TX_IDLE;
+  if (state != TX_UDP)
+  {
+    return false;
+  }
+
+    // The flush is repeated since the other side will not stop the stream
+    // until it times out if no flush is received. Duplicates are ignored.
+  PayloadHeader ph;
+  ph.type = TYPE_FLUSH;
+  ph.stream_id = tx_stream_id;
+  ph.seq = tx_seq++;
+  ph.timestamp = chrono::duration_cast<chrono::milliseconds>(
+      Clock::now() - tx_stream_start).count();
+  for (unsigned i=0; i<FLUSH_REPEAT; ++i)
+  {
+    sendDatagram(ph, 0, 0);
+  }
+
+  return true;
+
+} /* NetTrxUdpChannel::sendFlush */
+
+
+
+/****************************************************************************
+ *
+ * Protected member functions
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Private member functions
+ *
+ ****************************************************************************/
+
+std::vector<uint8_t> NetTrxUdpChannel::cipherIV(bool from_server,
+                                                uint32_t cntr) const
+{
+    // The IV is made unique by the counter and by using different values for
+    // the two directions, since both sides use the same key
+  vector<uint8_t> iv(iv_rand);
+  iv.push_back(from_server ? 1 : 0);
+  const uint8_t *cntr_ptr = reinterpret_cast<const uint8_t*>(&cntr);
+  iv.insert(iv.end(), cntr_ptr, cntr_ptr + sizeof(cntr));
+  return iv;
+} /* NetTrxUdpChannel::cipherIV */
+
+
+bool NetTrxUdpChannel::sendDatagram(const PayloadHeader& ph, const void *buf,
+                                    int size)
+{
+  if (!isOpen() || (remote_port == 0))
+  {
+    return false;
+  }
+
+  DatagramHeader hdr;
+  hdr.session_id = session_id;
+  hdr.cntr = ++tx_cntr;
+
+  vector<uint8_t> dgram;
+  dgram.reserve(sizeof(hdr) + sizeof(ph) + size);
+  if (!encrypted)
+  {
+    const uint8_t *hdr_ptr = reinterpret_cast<const uint8_t*>(&hdr);
+    dgram.insert(dgram.end(), hdr_ptr, hdr_ptr + sizeof(hdr));
+  }
+  const uint8_t *ph_ptr = reinterpret_cast<const uint8_t*>(&ph);
+  dgram.insert(dgram.end(), ph_ptr, ph_ptr + sizeof(ph));
+  if (size > 0)
+  {
+    const uint8_t *buf_ptr = reinterpret_cast<const uint8_t*>(buf);
+    dgram.insert(dgram.end(), buf_ptr, buf_ptr + size);
+  }
+
+  if (!encrypted)
+  {
+    return sock->UdpSocket::write(remote_ip, remote_port,
+                                  dgram.data(), dgram.size());
+  }
+
+  sock->setCipherIV(cipherIV(role == ROLE_SERVER, hdr.cntr));
+  return sock->write(remote_ip, remote_port, &hdr, sizeof(hdr),
+                     dgram.data(), dgram.size());
+} /* NetTrxUdpChannel::sendDatagram */
+
+
+bool NetTrxUdpChannel::cipherDataReceived(const IpAddress& ip, uint16_t port,
+                                          void *buf, int count)
+{
+  if (!isOpen() || (static_cast<size_t>(count) < sizeof(DatagramHeader)))
+  {
+    return true;
+  }
+
+  DatagramHeader hdr;
+  memcpy(&hdr, buf, sizeof(hdr));
+  if (hdr.session_id != session_id)
+  {
+    return true;
+  }
+
+  if (!encrypted)
+  {
+    handleDatagram(ip, port, hdr.cntr,
+                   static_cast<uint8_t*>(buf) + sizeof(hdr),
+                   count - sizeof(hdr));
+    return true;
+  }
+
+    // The datagrams received by the client are sent by the server
+  sock->setCipherIV(cipherIV(role == ROLE_CLIENT, hdr.cntr));
+  return false;
+} /* NetTrxUdpChannel::cipherDataReceived */
+
+
+void NetTrxUdpChannel::datagramReceived(const IpAddress& ip, uint16_t port,
+                                        void *aad, void *buf, int count)
+{
+  DatagramHeader hdr;
+  memcpy(&hdr, aad, sizeof(hdr));
+  handleDatagram(ip, port, hdr.cntr, static_cast<uint8_t*>(buf), count);
+} /* NetTrxUdpChannel::datagramReceived */
+
+
+void NetTrxUdpChannel::handleDatagram(const IpAddress& ip, uint16_t port,
+                                      uint32_t cntr, const uint8_t *buf,
+                                      int count)
+{
+  if ((role == ROLE_CLIENT) && (ip != remote_ip))
+  {
+    return;
+  }
+
+  if (cntr > rx_highest_cntr)
+  {
+    rx_highest_cntr = cntr;
+      // The server learn the client address from the datagrams. Only the
+      // newest datagram is trusted so that an old datagram cannot steal
+      // the session.
+    if ((role == ROLE_SERVER) && ((ip != remote_ip) || (port != remote_port)))
+    {
+      remote_ip = ip;
+      remote_port = port;
+    }
+  }
+  last_rx_time = Clock::now();
+  setUp(true);
+
+  if (static_cast<size_t>(count) < sizeof(PayloadHeader))
+  {
+    return;
+  }
+  PayloadHeader ph;
+  memcpy(&ph, buf, sizeof(ph));
+  switch (ph.type)
+  {
+    case TYPE_HEARTBEAT:
+      break;
+
+    case TYPE_AUDIO:
+    case TYPE_FLUSH:
+      handleStreamPacket(ph, buf + sizeof(ph), count - sizeof(ph));
+      break;
+
+    default:
+      break;
+  }
+} /* NetTrxUdpChannel::handleDatagram */
+
+
+void NetTrxUdpChannel::handleStreamPacket(const PayloadHeader& ph,
+                                          const uint8_t *buf, int count)
+{
+  Clock::time_point now = Clock::now();
+  Clock::time_point base = now +
+    chrono::milliseconds(jitter_buffer_delay) -
+    chrono::milliseconds(ph.timestamp);
+
+  if (rx_stream_active && (ph.stream_id != rx_stream_id))
+  {
+    if (static_cast<int16_t>(ph.stream_id - rx_stream_id) < 0)
+    {
+      if (ph.type == TYPE_AUDIO)
+      {
+        stats.late_packets += 1;
+      }
+      return;
+    }
+      // The flush for the previous stream has been lost
+    endRxStream();
+  }
+
+  if (!rx_stream_active)
+  {
+    if (rx_stream_valid &&
+        (static_cast<int16_t>(ph.stream_id - rx_stream_id) <= 0))
+    {
+      if (ph.type == TYPE_AUDIO)
+      {
+        stats.late_packets += 1;
+      }
+      return;
+    }
+    rx_stream_active = true;
+    rx_stream_valid = true;
+    rx_stream_id = ph.stream_id;
+    rx_next_seq = 0;
+    rx_base = base;
+  }
+  else if (base < rx_base)
+  {
+      // This packet took a faster path than the previous ones
+    rx_base = base;
+  }
+  rx_stream_timer.setTimeout(RX_STREAM_TIMEOUT + jitter_buffer_delay);
+  rx_stream_timer.setEnable(true);
+
+  uint32_t seq = rx_next_seq +
+    static_cast<int16_t>(ph.seq - static_cast<uint16_t>(rx_next_seq));
+  if ((seq < rx_next_seq) || (seq > rx_next_seq + 0x8000))
+  {
+    if (ph.type == TYPE_AUDIO)
+    {
+      stats.late_packets += 1;
+    }
+    return;
+  }
+  if (rx_buf.find(seq) != rx_buf.end())
+  {
+    return;
+  }
+
+  if (ph.type == TYPE_AUDIO)
+  {
+    stats.received_packets += 1;
+  }
+  Packet& packet = rx_buf[seq];
+  packet.type = ph.type;
+  packet.timestamp = ph.timestamp;
+  packet.data.assign(buf, buf + count);
+
+  playout();
+
+} /* NetTrxUdpChannel::handleStreamPacket */
+
+
+NetTrxUdpChannel::Clock::time_point NetTrxUdpChannel::playoutTime(
+    const Packet& p) const
+{
+  return rx_base + chrono::milliseconds(p.timestamp);
+} /* NetTrxUdpChannel::playoutTime */
+
+
+void NetTrxUdpChannel::playout(void)
+{
+  Clock::time_point now = Clock::now();
+  while (rx_stream_active && !rx_buf.empty())
+  {
+    JitterBuffer::iterator it = rx_buf.begin();
+
+      // Audio is held until its playout time. A flush is handled as soon
+      // as all audio before it has been played out. If there is a gap in
+      // the sequence, wait for the missing packets until it is time to
+      // play the packet after the gap.
+    if ((it->first != rx_next_seq) || (it->second.type == TYPE_AUDIO))
+    {
+      Clock::time_point playout_time = playoutTime(it->second);
+      if (now < playout_time)
+      {
+        int timeout = chrono::duration_cast<chrono::milliseconds>(
+            playout_time - now).count() + 1;
+        playout_timer.setTimeout(timeout);
+        playout_timer.setEnable(true);
+        return;
+      }
+    }
+
+    stats.lost_packets += it->first - rx_next_seq;
+    rx_next_seq = it->first + 1;
+    Packet packet(std::move(it->second));
+    rx_buf.erase(it);
+
+    if (packet.type == TYPE_AUDIO)
+    {
+      audioReceived(packet.data.data(), packet.data.size());
+    }
+    else
+    {
+      endRxStream();
+      return;
+    }
+  }
+  playout_timer.setEnable(false);
+} /* NetTrxUdpChannel::playout */
+
+
+void NetTrxUdpChannel::endRxStream(void)
+{
+  if (!rx_stream_active)
+  {
+    return;
+  }
+  rx_stream_active = false;
+  playout_timer.setEnable(false);
+  rx_stream_timer.setEnable(false);
+
+    // Play out whatever is left without waiting for missing packets
+  JitterBuffer buf;
+  buf.swap(rx_buf);
+  for (JitterBuffer::iterator it=buf.begin(); it!=buf.end(); ++it)
+  {
+    if (it->second.type == TYPE_AUDIO)
+    {
+      audioReceived(it->second.data.data(), it->second.data.size());
+    }
+  }
+
+  flushReceived();
+} /* NetTrxUdpChannel::endRxStream */
+
+
+void NetTrxUdpChannel::setUp(bool up)
+{
+  if (up == is_up)
+  {
+    return;
+  }
+  is_up = up;
+  if (!up)
+  {
+    endRxStream();
+  }
+  upStateChanged(up);
+} /* NetTrxUdpChannel::setUp */
+
+
+void NetTrxUdpChannel::heartbeat(Timer *t)
+{
+  if (is_up && (Clock::now() - last_rx_time > chrono::milliseconds(UP_TIMEOUT)))
+  {
+    setUp(false);
+  }
+
+  PayloadHeader ph;
+  memset(&ph, 0, sizeof(ph));
+  ph.type = TYPE_HEARTBEAT;
+  sendDatagram(ph, 0, 0);
+} /* NetTrxUdpChannel::heartbeat */
+
+
+void NetTrxUdpChannel::playoutTimerExpired(Timer *t)
+{
+  playout();
+} /* NetTrxUdpChannel::playoutTimerExpired */
+
+
+void NetTrxUdpChannel::rxStreamTimeout(Timer *t)
+{
+  endRxStream();
+} /* NetTrxUdpChannel::rxStreamTimeout */
+
+
+
+/*
+ * This file has not been truncated
+ */
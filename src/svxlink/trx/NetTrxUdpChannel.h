@@ -0,0 +1,381 @@
+/**
+@file	 NetTrxUdpChannel.h
+@brief   A UDP audio channel for remote transceivers
+@author  Tobias Blomberg / SM0SVX
+@date	 2026-10-14
+
+\verbatim
+SvxLink - A Multi Purpose Voice Services System for Ham Radio Use
+Copyright (C) 2003-2026 Tobias Blomberg / SM0SVX
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+\endverbatim
+*/
+
+#ifndef NET_TRX_UDP_CHANNEL_INCLUDED
+#define NET_TRX_UDP_CHANNEL_INCLUDED
+
+
+/****************************************************************************
+ *
+ * System Includes
+ *
+ ****************************************************************************/
+
+#include <sigc++/sigc++.h>
+
+#include <map>
+#include <vector>
+#include <string>
+#include <chrono>
+
+
+/****************************************************************************
+ *
+ * Project Includes
+ *
+ ****************************************************************************/
+
+#include <AsyncIpAddress.h>
+#include <AsyncTimer.h>
+
+
+/****************************************************************************
+ *
+ * Local Includes
+ *
+ ****************************************************************************/
+
+#include "NetTrxMsg.h"
+
+
+/****************************************************************************
+ *
+ * Forward declarations
+ *
+ ****************************************************************************/
+
+namespace Async
+{
+  class EncryptedUdpSocket;
+};
+
+
+/****************************************************************************
+ *
+ * Namespace
+ *
+ ****************************************************************************/
+
+//namespace MyNameSpace
+//{
+
+
+/****************************************************************************
+ *
+ * Forward declarations of classes inside of the declared namespace
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Defines & typedefs
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Exported Global Variables
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Class definitions
+ *
+ ****************************************************************************/
+
+/**
+@brief	A UDP audio channel for remote transceivers
+@author Tobias Blomberg / SM0SVX
+@date   2026-10-14
+
+This class implement an optional UDP transport for the encoded audio sent
+between NetRx/NetTx and a RemoteTrx NetUplink. All control messages are
+still sent over the TCP connection. The UDP channel is negotiated over the
+TCP connection using the MsgUdpSetupRequest and MsgUdpSetup messages. If an
+authentication key is used, the datagrams are encrypted using AES-128-GCM
+with a key derived from the authentication key and the authentication
+challenge. The session id and a packet counter is sent as associated data.
+
+The channel is considered to be up when a datagram has been received from
+the other side within the last few seconds. Both sides send heartbeat
+datagrams so if UDP is blocked somewhere on the path, the channel never
+come up and the audio is sent over TCP as before.
+
+Each audio stream, from the first audio packet to the flush, is numbered
+and each packet in the stream carry a sequence number and a timestamp. On
+the receiving side the packets go through a jitter buffer that put the
+packets back in order and that delay the playout so that packets arriving
+up to the configured jitter buffer delay too late can be used. Packets
+that have not arrived when it is time to play the following packet are
+counted as lost. The flush is sent in-band so that it is not handled before
+the last audio packet.
+*/
+class NetTrxUdpChannel : public sigc::trackable
+{
+  public:
+    /**
+     * @brief Which side of the connection this channel is used on
+     */
+    typedef enum
+    {
+      ROLE_CLIENT,  ///< The NetRx/NetTx side
+      ROLE_SERVER   ///< The RemoteTrx NetUplink side
+    } Role;
+
+    /**
+     * @brief Statistics for the receiving side
+     */
+    struct Stats
+    {
+      unsigned received_packets;  ///< Audio packets received
+      unsigned lost_packets;      ///< Packets that never arrived in time
+      unsigned late_packets;      ///< Packets arriving after their playout
+    };
+
+    /**
+     * @brief The default jitter buffer delay in milliseconds
+     */
+    static const unsigned DEFAULT_JITTER_BUFFER_DELAY = 100;
+
+    /**
+     * @brief 	Constuctor
+     * @param 	role        The side of the connection
+     * @param 	local_port  The local UDP port to bind to, 0=ephemeral
+     */
+    explicit NetTrxUdpChannel(Role role, uint16_t local_port=0);
+
+    /**
+     * @brief 	Destructor
+     */
+    ~NetTrxUdpChannel(void);
+
+    /**
+     * @brief   Check if the initialization was ok
+     * @return  Returns \em true if the UDP socket could be created
+     */
+    bool initOk(void) const;
+
+    /**
+     * @brief   Set the jitter buffer delay
+     * @param   delay_ms The jitter buffer delay in milliseconds
+     */
+    void setJitterBufferDelay(unsigned delay_ms)
+    {
+      jitter_buffer_delay = delay_ms;
+    }
+
+    /**
+     * @brief   Get the jitter buffer delay
+     * @return  Returns the jitter buffer delay in milliseconds
+     */
+    unsigned jitterBufferDelay(void) const { return jitter_buffer_delay; }
+
+    /**
+     * @brief   Start a new UDP session
+     * @param   setup_msg The setup message sent by the server
+     * @param   auth_key  The authentication key
+     * @param   challenge The authentication challenge for this connection
+     * @return  Returns \em true on success or \em false on failure
+     *
+     * Both sides must call this function using the same setup message. The
+     * challenge may be NULL if no authentication key is used, but encryption
+     * is then not possible.
+     */
+    bool open(const NetTrxMsg::MsgUdpSetup& setup_msg,
+              const std::string& auth_key, const unsigned char *challenge);
+
+    /**
+     * @brief   Set the address of the remote side
+     * @param   ip    The IP address of the remote side
+     * @param   port  The UDP port on the remote side
+     *
+     * This function is used on the client side. On the server side, the
+     * remote address is learnt from the received datagrams.
+     */
+    void setRemote(const Async::IpAddress& ip, uint16_t port);
+
+    /**
+     * @brief   End the current session
+     *
+     * Buffered audio is thrown away without emitting any signals.
+     */
+    void close(void);
+
+    /**
+     * @brief   Check if a session is open
+     * @return  Returns \em true if the open function has been called
+     */
+    bool isOpen(void) const { return session_id != 0; }
+
+    /**
+     * @brief   Check if the UDP channel is usable
+     * @return  Returns \em true if datagrams are received from the remote side
+     */
+    bool isUp(void) const { return is_up; }
+
+    /**
+     * @brief   Check if the channel is encrypted
+     * @return  Returns \em true if the datagrams are encrypted
+     */
+    bool isEncrypted(void) const { return encrypted; }
+
+    /**
+     * @brief   Send encoded audio over the UDP channel
+     * @param   buf   The buffer containing the encoded audio
+     * @param   size  The number of bytes in the buffer
+     * @return  Returns \em true if sent or \em false if TCP should be used
+     *
+     * A stream that started on TCP or that had to fall back to TCP stay on
+     * TCP until flushed, so that the audio is not reordered.
+     */
+    bool sendAudio(const void *buf, int size);
+
+    /**
+     * @brief   End the current audio stream
+     * @return  Returns \em true if a flush was sent over the UDP channel or
+     *          \em false if the flush have to be sent over TCP
+     */
+    bool sendFlush(void);
+
+    /**
+     * @brief   Check if an incoming audio stream is active
+     * @return  Returns \em true if an incoming stream has not been flushed
+     */
+    bool rxStreamActive(void) const { return rx_stream_active; }
+
+    /**
+     * @brief   Get the receiver statistics
+     * @return  Returns the statistics for the current session
+     */
+    const Stats& statistics(void) const { return stats; }
+
+    /**
+     * @brief A signal that is emitted when the channel goes up or down
+     * @param is_up \em true if the channel is now usable
+     */
+    sigc::signal<void(bool)> upStateChanged;
+
+    /**
+     * @brief A signal that is emitted when audio is played out
+     * @param buf   The buffer containing the encoded audio
+     * @param size  The number of bytes in the buffer
+     */
+    sigc::signal<void(const void*, int)> audioReceived;
+
+    /**
+     * @brief A signal that is emitted when an incoming stream has ended
+     *
+     * This signal is emitted after all audio in the stream has been played
+     * out. It is also emitted if the stream times out or if the channel go
+     * down while a stream is active.
+     */
+    sigc::signal<void(void)> flushReceived;
+
+  private:
+    typedef std::chrono::steady_clock Clock;
+    typedef enum { TX_IDLE, TX_UDP, TX_TCP } TxState;
+
+    struct PayloadHeader;
+
+    struct Packet
+    {
+      uint8_t               type;
+      uint32_t              timestamp;
+      std::vector<uint8_t>  data;
+    };
+    typedef std::map<uint32_t, Packet> JitterBuffer;
+
+    static const unsigned HEARTBEAT_INTERVAL  = 1000;
+    static const unsigned UP_TIMEOUT          = 5000;
+    static const unsigned RX_STREAM_TIMEOUT   = 1000;
+    static const unsigned FLUSH_REPEAT        = 3;
+
+    const Role                  role;
+    Async::EncryptedUdpSocket*  sock;
+    unsigned                    jitter_buffer_delay;
+    uint32_t                    session_id;
+    bool                        encrypted;
+    std::vector<uint8_t>        iv_rand;
+    Async::IpAddress            remote_ip;
+    uint16_t                    remote_port;
+    bool                        is_up;
+    Clock::time_point           last_rx_time;
+    Async::Timer                heartbeat_timer;
+    uint32_t                    tx_cntr;
+    uint32_t                    rx_highest_cntr;
+    TxState                     tx_state;
+    uint16_t                    tx_stream_id;
+    uint16_t                    tx_seq;
+    Clock::time_point           tx_stream_start;
+    bool                        rx_stream_active;
+    bool                        rx_stream_valid;
+    uint16_t                    rx_stream_id;
+    uint32_t                    rx_next_seq;
+    Clock::time_point           rx_base;
+    JitterBuffer                rx_buf;
+    Async::Timer                playout_timer;
+    Async::Timer                rx_stream_timer;
+    Stats                       stats;
+
+    NetTrxUdpChannel(const NetTrxUdpChannel&);
+    NetTrxUdpChannel& operator=(const NetTrxUdpChannel&);
+    std::vector<uint8_t> cipherIV(bool from_server, uint32_t cntr) const;
+    bool sendDatagram(const PayloadHeader& ph, const void *buf, int size);
+    bool cipherDataReceived(const Async::IpAddress& ip, uint16_t port,
+                            void *buf, int count);
+    void datagramReceived(const Async::IpAddress& ip, uint16_t port,
+                          void *aad, void *buf, int count);
+    void handleDatagram(const Async::IpAddress& ip, uint16_t port,
+                        uint32_t cntr, const uint8_t *buf, int count);
+    void handleStreamPacket(const PayloadHeader& ph, const uint8_t *buf,
+                            int count);
+    Clock::time_point playoutTime(const Packet& p) const;
+    void playout(void);
+    void endRxStream(void);
+    void setUp(bool up);
+    void heartbeat(Async::Timer *t);
+    void playoutTimerExpired(Async::Timer *t);
+    void rxStreamTimeout(Async::Timer *t);
+
+};  /* class NetTrxUdpChannel */
+
+
+//} /* namespace */
+
+#endif /* NET_TRX_UDP_CHANNEL_INCLUDED */
+
+
+
+/*
+ * This file has not been truncated
+ */
@@ -6,7 +6,7 @@
 
 \verbatim
 SvxLink - A Multi Purpose Voice Services System for Ham Radio Use
-Copyright (C) 2003-2018 Tobias Blomberg / SM0SVX
+Copyright (C) 2003-2026 Tobias Blomberg / SM0SVX
 
 This program is free software; you can redistribute it and/or modify
 it under the terms of the GNU General Public License as published by
@@ -47,6 +47,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 #include <AsyncConfig.h>
 #include <AsyncAudioPacer.h>
 #include <AsyncAudioEncoder.h>
+#include <AsyncAudioCodecPool.h>
 
 
 /****************************************************************************
@@ -123,7 +124,8 @@ NetTx::NetTx(Config &cfg, const string& name)
     log_disconnect(true), mode(Tx::TX_OFF),
     ctcss_enable(false), pacer(0), is_connected(false), pending_flush(false),
     unflushed_samples(false), audio_enc(0), fq(0),
-    modulation(Modulation::MOD_UNKNOWN)
+    modulation(Modulation::MOD_UNKNOWN), simulcast_delay(0),
+    simulcast_offset(0), launch_late_warned(false)
 {
 } /* NetTx::NetTx */
 
@@ -131,7 +133,7 @@ NetTx::NetTx(Config &cfg, const string& name)
 NetTx::~NetTx(void)
 {
   clearHandler();
-  delete audio_enc;
+  AudioCodecPool::instance().release(audio_enc);
   delete pacer;
   tcp_con->deleteInstance();
 } /* NetTx::~NetTx */
@@ -155,8 +157,8 @@ bool NetTx::initialize(void)
   string tcp_port(NET_TRX_DEFAULT_TCP_PORT);
   cfg.getValue(name(), "TCP_PORT", tcp_port);
   
-  string udp_port(NET_TRX_DEFAULT_UDP_PORT);
-  cfg.getValue(name(), "UDP_PORT", udp_port);
+  bool udp_audio = false;
+  cfg.getValue(name(), "UDP_AUDIO", udp_audio);
   
   cfg.getValue(name(), "LOG_DISCONNECTS_ONCE", log_disconnects_once);
 
@@ -169,11 +171,32 @@ bool NetTx::initialize(void)
   
   string auth_key;
   cfg.getValue(name(), "AUTH_KEY", auth_key);
+
+  if (!cfg.getValue(name(), "SIMULCAST_DELAY", 0U, MsgTxLaunchTime::MAX_DELAY,
+                    simulcast_delay, true))
+  {
+    cerr << "*** ERROR: Illegal value for config variable " << name()
+         << "/SIMULCAST_DELAY. Valid range is 0 to "
+         << MsgTxLaunchTime::MAX_DELAY << " ms.\n";
+    return false;
+  }
+  cfg.getValue(name(), "SIMULCAST_OFFSET", simulcast_offset);
+  if ((simulcast_delay > 0) &&
+      ((static_cast<int>(simulcast_delay) + simulcast_offset <= 0) ||
+       (static_cast<int>(simulcast_delay) + simulcast_offset >
+        static_cast<int>(MsgTxLaunchTime::MAX_DELAY))))
+  {
+    cerr << "*** ERROR: The sum of " << name() << "/SIMULCAST_DELAY and "
+         << name() << "/SIMULCAST_OFFSET must be in the range 1 to "
+         << MsgTxLaunchTime::MAX_DELAY << " ms.\n";
+    return false;
+  }
   
   pacer = new AudioPacer(INTERNAL_SAMPLE_RATE, 512, 50);
+  pacer->setSampleClockEnabled(true);
   setHandler(pacer);
   
-  audio_enc = AudioEncoder::create(audio_enc_name);
+  audio_enc = AudioCodecPool::instance().createEncoder(audio_enc_name);
   if (audio_enc == 0)
   {
     cerr << "*** ERROR: Illegal audio codec (" << audio_enc_name
@@ -207,6 +230,10 @@ bool NetTx::initialize(void)
     return false;
   }
   tcp_con->setAuthKey(auth_key);
+  if (udp_audio)
+  {
+    tcp_con->enableUdpAudio();
+  }
   tcp_con->isReady.connect(mem_fun(*this, &NetTx::connectionReady));
   tcp_con->msgReceived.connect(mem_fun(*this, &NetTx::handleMsg));
   tcp_con->connect();
@@ -420,6 +447,12 @@ void NetTx::sendMsg(Msg *msg)
 
 void NetTx::writeEncodedSamples(const void *buf, int size)
 {
+  if ((simulcast_delay > 0) && is_connected &&
+      (!unflushed_samples || pending_flush))
+  {
+    sendLaunchTime();
+  }
+
   pending_flush = false;
   unflushed_samples = true;
   
@@ -474,6 +507,29 @@ void NetTx::allEncodedSamplesFlushed(void)
 } /* NetTx::allEncodedSamplesFlushed */
 
 
+void NetTx::sendLaunchTime(void)
+{
+    // All transmitters in a simulcast system get the same launch time, as
+    // long as they use the same simulcast delay, since the new stream reach
+    // all of them at the same time. The offset is used to fine tune the
+    // timing for one transmitter.
+  const int launch_delay = static_cast<int>(simulcast_delay) + simulcast_offset;
+  sendMsg(new MsgTxLaunchTime(
+        Msg::currentTimestamp() + 1000 * static_cast<uint64_t>(launch_delay)));
+
+    // The one way network delay is estimated to half the round trip time
+  const int rtt = tcp_con->roundTripTime();
+  const bool is_late = (rtt >= 0) && (rtt / 2 >= launch_delay);
+  if (is_late && !launch_late_warned)
+  {
+    cerr << "*** WARNING[" << name() << "]: The estimated network delay ("
+         << (rtt / 2) << "ms) to the remote transmitter is larger than the "
+            "launch delay (" << launch_delay << "ms)\n";
+  }
+  launch_late_warned = is_late;
+} /* NetTx::sendLaunchTime */
+
+
 
 /*
  * This file has not been truncated
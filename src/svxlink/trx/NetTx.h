@@ -6,7 +6,7 @@
 
 \verbatim
 SvxLink - A Multi Purpose Voice Services System for Ham Radio Use
-Copyright (C) 2003-2018 Tobias Blomberg / SM0SVX
+Copyright (C) 2003-2026 Tobias Blomberg / SM0SVX
 
 This program is free software; you can redistribute it and/or modify
 it under the terms of the GNU General Public License as published by
@@ -215,6 +215,9 @@ class NetTx : public Tx
     Async::AudioEncoder   *audio_enc;
     unsigned              fq;
     Modulation::Type      modulation;
+    unsigned              simulcast_delay;
+    int                   simulcast_offset;
+    bool                  launch_late_warned;
     
     void connectionReady(bool is_ready);
     void handleMsg(NetTrxMsg::Msg *msg);
@@ -222,6 +225,7 @@ class NetTx : public Tx
     void writeEncodedSamples(const void *buf, int size);
     void flushEncodedSamples(void);
     void allEncodedSamplesFlushed(void);
+    void sendLaunchTime(void);
 
 
 };  /* class NetTx */
@@ -0,0 +1,465 @@
+/**
+@file	 PfbChannelizer.cpp
+@brief   A polyphase filter bank channelizer shared by all DDR:s on a tuner
+@author  Tobias Blomberg / SM0SVX
+@date	 2026-10-14
+
+\verbatim
+SvxLink - A Multi Purpose Voice Services System for Ham Radio Use
+Copyright (C) 2003-2026 Tobias Blomberg / SM0SVX
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+\endverbatim
+*/
+
+
+
+/****************************************************************************
+ *
+ * System Includes
+ *
+ ****************************************************************************/
+
+#include <cassert>
+#include <cmath>
+#include <cstdlib>
+#include <algorithm>
+
+
+/****************************************************************************
+ *
+ * Project Includes
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Local Includes
+ *
+ ****************************************************************************/
+
+#include "PfbChannelizer.h"
+
+
+
+/****************************************************************************
+ *
+ * Namespaces to use
+ *
+ ****************************************************************************/
+
+using namespace std;
+
+
+
+/****************************************************************************
+ *
+ * Defines & typedefs
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Local class definitions
+ *
+ ****************************************************************************/
+
+namespace {
+  struct PfbParams
+  {
+    unsigned  samp_rate;
+    unsigned  bin_cnt;
+    unsigned  dec_fact;
+    unsigned  taps_per_branch;
+    double    kaiser_beta;
+  };
+
+    // The bin spacing and number of taps are selected so that a 25kHz
+    // channel placed anywhere within a bin is passed with less than 0.1dB
+    // ripple and so that everything aliasing into it is attenuated at
+    // least 48dB.
+  const PfbParams pfb_params[] = {
+    {  960000, 30, 15,  8, 4.533 },   // 32kHz spacing, 64kHz bin rate
+    { 2400000, 50, 25,  6, 5.0   }    // 48kHz spacing, 96kHz bin rate
+  };
+  const size_t pfb_params_cnt = sizeof(pfb_params) / sizeof(*pfb_params);
+
+
+  const PfbParams *findParams(unsigned samp_rate)
+  {
+    for (size_t i=0; i<pfb_params_cnt; ++i)
+    {
+      if (pfb_params[i].samp_rate == samp_rate)
+      {
+        return &pfb_params[i];
+      }
+    }
+    return 0;
+  } /* findParams */
+
+
+    // Zeroth order modified Bessel function of the first kind
+  double besselI0(double x)
+  {
+    double sum = 1.0;
+    double term = 1.0;
+    for (unsigned k=1; k<100; ++k)
+    {
+      term *= (x / (2.0 * k)) * (x / (2.0 * k));
+      sum += term;
+      if (term < 1.0e-12 * sum)
+      {
+        break;
+      }
+    }
+    return sum;
+  } /* besselI0 */
+};
+
+
+
+/****************************************************************************
+ *
+ * Prototypes
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Exported Global Variables
+ *
+ ****************************************************************************/
+
+
+
+
+/****************************************************************************
+ *
+ * Local Global Variables
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Public member functions
+ *
+ ****************************************************************************/
+
+bool PfbChannelizer::isSupported(unsigned samp_rate)
+{
+  return findParams(samp_rate) != 0;
+} /* PfbChannelizer::isSupported */
+
+
+PfbChannelizer::PfbChannelizer(unsigned samp_rate)
+  : m_samp_rate(samp_rate), m_bin_cnt(0), m_dec_fact(0), m_next_pos(0),
+    m_phase(0), m_fft_cost(0)
+{
+  const PfbParams *params = findParams(samp_rate);
+  assert(params != 0);
+  m_bin_cnt = params->bin_cnt;
+  m_dec_fact = params->dec_fact;
+
+    // Design the prototype lowpass filter using a Kaiser window. The cutoff
+    // is at half the bin sampling rate.
+  const unsigned taps = m_bin_cnt * params->taps_per_branch;
+  const double x = 1.0 / m_dec_fact;
+  const double mid = (taps - 1) / 2.0;
+  double sum = 0.0;
+  m_coeff.resize(taps);
+  for (unsigned i=0; i<taps; ++i)
+  {
+    const double n = i - mid;
+    double h = x;
+    if (n != 0.0)
+    {
+      h = sin(M_PI * x * n) / (M_PI * n);
+    }
+    const double r = n / mid;
+    h *= besselI0(params->kaiser_beta * sqrt(1.0 - r * r)) /
+         besselI0(params->kaiser_beta);
+    m_coeff[i] = h;
+    sum += h;
+  }
+    // The coefficients are stored in reverse order so that the filter loop
+    // can run forward through the sample history
+  for (unsigned i=0; i<taps; ++i)
+  {
+    m_coeff[i] /= sum;
+  }
+  reverse(m_coeff.begin(), m_coeff.end());
+
+    // Set up the mixed radix FFT
+  m_twiddles.resize(m_bin_cnt);
+  for (unsigned i=0; i<m_bin_cnt; ++i)
+  {
+    m_twiddles[i] = polar(1.0f, static_cast<float>(2.0 * M_PI * i / m_bin_cnt));
+  }
+  unsigned n = m_bin_cnt;
+  unsigned max_factor = 0;
+  for (unsigned p=2; n > 1; )
+  {
+    if (n % p == 0)
+    {
+      m_factors.push_back(p);
+      m_fft_cost += p;
+      max_factor = p;
+      n /= p;
+    }
+    else
+    {
+      ++p;
+    }
+  }
+  m_scratch.resize(max_factor);
+
+  m_hist.assign(taps - 1, Sample(0.0f, 0.0f));
+  m_next_pos = taps - 1;
+  m_bin_sigs.resize(m_bin_cnt);
+  m_bin_out.resize(m_bin_cnt);
+  m_branch.resize(m_bin_cnt);
+  m_dft.resize(m_bin_cnt);
+} /* PfbChannelizer::PfbChannelizer */
+
+
+PfbChannelizer::~PfbChannelizer(void)
+{
+} /* PfbChannelizer::~PfbChannelizer */
+
+
+unsigned PfbChannelizer::findBin(int fq_offset, int& residual) const
+{
+  const int spacing = binSpacing();
+  int bin = static_cast<int>(lround(static_cast<double>(fq_offset) / spacing));
+  residual = fq_offset - bin * spacing;
+  bin %= static_cast<int>(m_bin_cnt);
+  if (bin < 0)
+  {
+    bin += m_bin_cnt;
+  }
+  return bin;
+} /* PfbChannelizer::findBin */
+
+
+sigc::connection PfbChannelizer::connectBin(unsigned bin, const BinSlot& slot)
+{
+  assert(bin < m_bin_cnt);
+  return m_bin_sigs[bin].connect(slot);
+} /* PfbChannelizer::connectBin */
+
+
+void PfbChannelizer::iqReceived(const std::vector<Sample>& samples)
+{
+  updateUsedBins();
+
+  const unsigned taps = m_coeff.size();
+  m_hist.insert(m_hist.end(), samples.begin(), samples.end());
+
+  if (!m_used_bins.empty())
+  {
+    for (unsigned bin : m_used_bins)
+    {
+      m_bin_out[bin].clear();
+    }
+    const bool use_fft = m_used_bins.size() > m_fft_cost;
+
+    while (m_next_pos < m_hist.size())
+    {
+        // Run the polyphase filter branches. The newest sample is at
+        // m_next_pos. Since the coefficients are reversed, the branches
+        // also come out in reverse order.
+      const float *h = &m_coeff[0];
+      const Sample *x = &m_hist[m_next_pos + 1 - taps];
+      for (unsigned r=0; r<m_bin_cnt; ++r)
+      {
+        m_branch[r] = Sample(0.0f, 0.0f);
+      }
+      for (unsigned base=0; base<taps; base+=m_bin_cnt)
+      {
+        for (unsigned r=0; r<m_bin_cnt; ++r)
+        {
+          m_branch[r] += h[base + r] * x[base + r];
+        }
+      }
+      reverse(m_branch.begin(), m_branch.end());
+
+        // Calculate the DFT over the branches, either for all bins using the
+        // FFT or just for the bins that are in use
+      if (use_fft)
+      {
+        fft(&m_dft[0], &m_branch[0], 1, 0);
+      }
+      else
+      {
+        for (unsigned bin : m_used_bins)
+        {
+          Sample acc(m_branch[0]);
+          unsigned twidx = 0;
+          for (unsigned r=1; r<m_bin_cnt; ++r)
+          {
+            twidx += bin;
+            if (twidx >= m_bin_cnt)
+            {
+              twidx -= m_bin_cnt;
+            }
+            acc += m_branch[r] * m_twiddles[twidx];
+          }
+          m_dft[bin] = acc;
+        }
+      }
+
+        // Compensate for the phase rotation caused by the decimation and
+        // store the result
+      for (unsigned bin : m_used_bins)
+      {
+        const Sample& rot = m_twiddles[(bin * m_phase) % m_bin_cnt];
+        m_bin_out[bin].push_back(m_dft[bin] * conj(rot));
+      }
+
+      m_next_pos += m_dec_fact;
+      m_phase = (m_phase + m_dec_fact) % m_bin_cnt;
+    }
+  }
+  else
+  {
+    while (m_next_pos < m_hist.size())
+    {
+      m_next_pos += m_dec_fact;
+      m_phase = (m_phase + m_dec_fact) % m_bin_cnt;
+    }
+  }
+
+    // Only keep the history needed for the next output sample
+  const size_t consumed = m_next_pos - (taps - 1);
+  m_hist.erase(m_hist.begin(), m_hist.begin() + consumed);
+  m_next_pos -= consumed;
+
+  for (unsigned bin : m_used_bins)
+  {
+    m_bin_sigs[bin](m_bin_out[bin]);
+  }
+} /* PfbChannelizer::iqReceived */
+
+
+
+const std::vector<unsigned>& PfbChannelizer::usedBins(void)
+{
+  updateUsedBins();
+  return m_used_bins;
+} /* PfbChannelizer::usedBins */
+
+
+void PfbChannelizer::binReceived(unsigned bin,
+                                 const std::vector<Sample>& samples)
+{
+  if (bin < m_bin_cnt)
+  {
+    m_bin_sigs[bin](samples);
+  }
+} /* PfbChannelizer::binReceived */
+
+
+
+/****************************************************************************
+ *
+ * Protected member functions
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Private member functions
+ *
+ ****************************************************************************/
+
+void PfbChannelizer::updateUsedBins(void)
+{
+  m_used_bins.clear();
+  for (unsigned bin=0; bin<m_bin_cnt; ++bin)
+  {
+    if (!m_bin_sigs[bin].empty())
+    {
+      m_used_bins.push_back(bin);
+    }
+  }
+} /* PfbChannelizer::updateUsedBins */
+
+
+void PfbChannelizer::fft(Sample* out, const Sample* in, unsigned fstride,
+                         unsigned level)
+{
+  const unsigned p = m_factors[level];
+  const unsigned m = m_bin_cnt / (fstride * p);
+  if (m == 1)
+  {
+    for (unsigned q=0; q<p; ++q)
+    {
+      out[q] = in[q * fstride];
+    }
+  }
+  else
+  {
+    for (unsigned q=0; q<p; ++q)
+    {
+      fft(out + q * m, in + q * fstride, fstride * p, level + 1);
+    }
+  }
+  fftButterfly(out, fstride, p, m);
+} /* PfbChannelizer::fft */
+
+
+void PfbChannelizer::fftButterfly(Sample* out, unsigned fstride, unsigned p,
+                                  unsigned m)
+{
+  for (unsigned u=0; u<m; ++u)
+  {
+    for (unsigned q=0; q<p; ++q)
+    {
+      m_scratch[q] = out[u + q * m];
+    }
+    for (unsigned q1=0; q1<p; ++q1)
+    {
+      const unsigned k = u + q1 * m;
+      Sample acc(m_scratch[0]);
+      unsigned twidx = 0;
+      for (unsigned q=1; q<p; ++q)
+      {
+        twidx += fstride * k;
+        if (twidx >= m_bin_cnt)
+        {
+          twidx -= m_bin_cnt;
+        }
+        acc += m_scratch[q] * m_twiddles[twidx];
+      }
+      out[k] = acc;
+    }
+  }
+} /* PfbChannelizer::fftButterfly */
+
+
+
+/*
+ * This file has not been truncated
+ */
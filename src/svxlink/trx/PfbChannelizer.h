@@ -0,0 +1,250 @@
+/**
+@file	 PfbChannelizer.h
+@brief   A polyphase filter bank channelizer shared by all DDR:s on a tuner
+@author  Tobias Blomberg / SM0SVX
+@date	 2026-10-14
+
+\verbatim
+SvxLink - A Multi Purpose Voice Services System for Ham Radio Use
+Copyright (C) 2003-2026 Tobias Blomberg / SM0SVX
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+\endverbatim
+*/
+
+#ifndef PFB_CHANNELIZER_INCLUDED
+#define PFB_CHANNELIZER_INCLUDED
+
+
+/****************************************************************************
+ *
+ * System Includes
+ *
+ ****************************************************************************/
+
+#include <sigc++/sigc++.h>
+
+#include <vector>
+#include <complex>
+
+
+/****************************************************************************
+ *
+ * Project Includes
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Local Includes
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Forward declarations
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Namespace
+ *
+ ****************************************************************************/
+
+//namespace MyNameSpace
+//{
+
+
+/****************************************************************************
+ *
+ * Forward declarations of classes inside of the declared namespace
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Defines & typedefs
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Exported Global Variables
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Class definitions
+ *
+ ****************************************************************************/
+
+/**
+@brief	A polyphase filter bank channelizer shared by all DDR:s on a tuner
+@author Tobias Blomberg / SM0SVX
+@date   2026-10-14
+
+This class split the wideband I/Q stream from a tuner into a number of
+equally spaced frequency bins in one pass. The implementation is a twice
+oversampled polyphase filter bank (PFB) followed by an M-point DFT so the
+output sampling rate of each bin is twice the bin spacing. That make it
+possible to place a channel anywhere within a bin and still have room for the
+channel bandwidth, without aliasing. A DDR connect to the bin closest to its
+frequency and then only have to do a small frequency translation and the final
+filtering at the low bin sampling rate.
+
+The cost of the filter bank is shared by all bins. The DFT is calculated
+using an FFT when many bins are in use. When only a few bins are in use it
+is cheaper to calculate the DFT for those bins only, which is done
+automatically. If no bin is in use, no processing is done at all.
+
+Supported tuner sampling rates are 960000 and 2400000 Hz. The bin sampling
+rate is 64000 and 96000 Hz respectively.
+*/
+class PfbChannelizer
+{
+  public:
+    typedef std::complex<float> Sample;
+    typedef sigc::slot<void(const std::vector<Sample>&)> BinSlot;
+
+    /**
+     * @brief   Check if a sampling rate is supported
+     * @param   samp_rate The tuner sampling rate
+     * @returns Returns \em true if the sampling rate is supported
+     */
+    static bool isSupported(unsigned samp_rate);
+
+    /**
+     * @brief 	Constructor
+     * @param   samp_rate The tuner sampling rate
+     */
+    explicit PfbChannelizer(unsigned samp_rate);
+
+    /**
+     * @brief 	Destructor
+     */
+    ~PfbChannelizer(void);
+
+    /**
+     * @brief   Get the number of frequency bins
+     * @returns Returns the number of bins
+     */
+    unsigned binCount(void) const { return m_bin_cnt; }
+
+    /**
+     * @brief   Get the frequency spacing between the bins
+     * @returns Returns the bin spacing in Hz
+     */
+    unsigned binSpacing(void) const { return m_samp_rate / m_bin_cnt; }
+
+    /**
+     * @brief   Get the sampling rate of the bin output
+     * @returns Returns the sampling rate in Hz
+     */
+    unsigned binSampRate(void) const { return m_samp_rate / m_dec_fact; }
+
+    /**
+     * @brief   Find the bin closest to a frequency
+     * @param   fq_offset The offset from the tuner center frequency in Hz
+     * @param   residual Set to the offset from the center of the bin, in Hz
+     * @returns Returns the bin index
+     */
+    unsigned findBin(int fq_offset, int& residual) const;
+
+    /**
+     * @brief   Connect to the output of a bin
+     * @param   bin The bin index, as returned by findBin
+     * @param   slot The slot to call with the channelized samples
+     * @returns Returns the connection object
+     */
+    sigc::connection connectBin(unsigned bin, const BinSlot& slot);
+
+    /**
+     * @brief   Process wideband samples
+     * @param   samples The wideband samples from the tuner
+     *
+     * This function should be connected to the signal emitting wideband
+     * samples from the tuner.
+     */
+    void iqReceived(const std::vector<Sample>& samples);
+
+    /**
+     * @brief   Get the bins that have at least one connected slot
+     * @returns Returns the sorted indexes of the bins in use
+     */
+    const std::vector<unsigned>& usedBins(void);
+
+    /**
+     * @brief   Deliver already channelized samples for a bin
+     * @param   bin The bin index
+     * @param   samples The bin samples
+     *
+     * This function is used when the filter bank is run somewhere else, for
+     * example on a remote IQ server, and only the bin output is received.
+     * The samples are passed on to the slots connected to the bin.
+     */
+    void binReceived(unsigned bin, const std::vector<Sample>& samples);
+
+  private:
+    typedef sigc::signal<void(const std::vector<Sample>&)> BinSignal;
+
+    unsigned                          m_samp_rate;
+    unsigned                          m_bin_cnt;
+    unsigned                          m_dec_fact;
+    std::vector<float>                m_coeff;
+    std::vector<Sample>               m_hist;
+    size_t                            m_next_pos;
+    unsigned                          m_phase;
+    std::vector<BinSignal>            m_bin_sigs;
+    std::vector<std::vector<Sample> > m_bin_out;
+    std::vector<unsigned>             m_used_bins;
+    std::vector<Sample>               m_branch;
+    std::vector<Sample>               m_dft;
+    std::vector<Sample>               m_twiddles;
+    std::vector<unsigned>             m_factors;
+    std::vector<Sample>               m_scratch;
+    unsigned                          m_fft_cost;
+
+    PfbChannelizer(const PfbChannelizer&);
+    PfbChannelizer& operator=(const PfbChannelizer&);
+    void updateUsedBins(void);
+    void fft(Sample* out, const Sample* in, unsigned fstride, unsigned level);
+    void fftButterfly(Sample* out, unsigned fstride, unsigned p, unsigned m);
+
+};  /* class PfbChannelizer */
+
+
+//} /* namespace */
+
+#endif /* PFB_CHANNELIZER_INCLUDED */
+
+
+
+/*
+ * This file has not been truncated
+ */
@@ -34,6 +34,9 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 
 #include <sigc++/sigc++.h>
 
+#include <iostream>
+#include <algorithm>
+
 
 /****************************************************************************
  *
@@ -79,9 +82,14 @@ using namespace sigc;
 
 
 PttCtrl::PttCtrl(int tx_delay)
-  : tx_ctrl_mode(Tx::TX_OFF), is_transmitting(false), tx_delay_timer(0),
+  : tx_ctrl_mode(Tx::TX_OFF), is_transmitting(false),
+    tx_delay_timer(std::max(tx_delay, 1), Timer::TYPE_ONESHOT, false),
     tx_delay(tx_delay), fifo(0)
 {
+    // The TX delay timer and FIFO are set up once so that nothing has to be
+    // allocated when the PTT is activated
+  tx_delay_timer.expired.connect(mem_fun(*this, &PttCtrl::txDelayExpired));
+
   valve.setBlockWhenClosed(false);
   valve.setOpen(false);
       
@@ -105,7 +113,19 @@ PttCtrl::~PttCtrl(void)
   AudioSink::clearHandler();
   AudioSource::clearHandler();
   delete fifo;
-  delete tx_delay_timer;
+}
+
+
+void PttCtrl::setTxDelay(int delay_ms)
+{
+  if ((delay_ms > 0) && (fifo == 0))
+  {
+    std::cerr << "*** WARNING: The TX delay cannot be enabled after startup "
+                 "if it was zero initially" << std::endl;
+    return;
+  }
+  tx_delay = delay_ms;
+  tx_delay_timer.setTimeout(std::max(tx_delay, 1));
 }
 
 
@@ -193,9 +213,7 @@ void PttCtrl::transmit(bool do_transmit)
     {
       fifo->enableBuffering(true);
       valve.setBlockWhenClosed(true);
-      tx_delay_timer = new Timer(tx_delay);
-      tx_delay_timer->expired.connect(
-          mem_fun(*this, &PttCtrl::txDelayExpired));
+      tx_delay_timer.setEnable(true);
     }
     else
     {
@@ -204,11 +222,7 @@ void PttCtrl::transmit(bool do_transmit)
   }
   else
   {
-    if (tx_delay_timer != 0)
-    {
-      delete tx_delay_timer;
-      tx_delay_timer = 0;
-    }
+    tx_delay_timer.setEnable(false);
     valve.setBlockWhenClosed(false);
     valve.setOpen(false);
   }
@@ -217,8 +231,7 @@ void PttCtrl::transmit(bool do_transmit)
 
 void PttCtrl::txDelayExpired(Timer *t)
 {
-  delete tx_delay_timer;
-  tx_delay_timer = 0;
+  tx_delay_timer.setEnable(false);
   fifo->enableBuffering(false);
   valve.setOpen(true);
   valve.setBlockWhenClosed(false);
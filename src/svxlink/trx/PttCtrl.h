@@ -45,6 +45,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 #include <AsyncAudioIO.h>
 #include <AsyncAudioValve.h>
 #include <AsyncAudioFifo.h>
+#include <AsyncTimer.h>
 
 
 /****************************************************************************
@@ -102,7 +103,7 @@ class PttCtrl : public Async::AudioSink, public Async::AudioSource,
      * @param 	delay_ms  The number of milliseconds to delay audio after
      *	      	      	  PTT activation
      */
-    void setTxDelay(int delay_ms) { tx_delay = delay_ms; }
+    void setTxDelay(int delay_ms);
     
     /**
      * @brief 	Set the PTT control mode
@@ -150,7 +151,7 @@ class PttCtrl : public Async::AudioSink, public Async::AudioSource,
   private:
     Tx::TxCtrlMode      tx_ctrl_mode;
     bool      	        is_transmitting;
-    Async::Timer     	*tx_delay_timer;
+    Async::Timer     	tx_delay_timer;
     int       	        tx_delay;
     Async::AudioFifo 	*fifo;
     Async::AudioValve	valve;
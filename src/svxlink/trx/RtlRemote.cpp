@@ -0,0 +1,376 @@
+/**
+@file	 RtlRemote.cpp
+@brief   An interface class for communicating to a remote RTL IQ server
+@author  Tobias Blomberg / SM0SVX
+@date	 2026-10-14
+
+\verbatim
+SvxLink - A Multi Purpose Voice Services System for Ham Radio Use
+Copyright (C) 2003-2026 Tobias Blomberg / SM0SVX
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+\endverbatim
+*/
+
+
+
+/****************************************************************************
+ *
+ * System Includes
+ *
+ ****************************************************************************/
+
+#include <sstream>
+#include <iostream>
+
+
+/****************************************************************************
+ *
+ * Project Includes
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Local Includes
+ *
+ ****************************************************************************/
+
+#include "RtlRemote.h"
+#include "PfbChannelizer.h"
+
+
+
+/****************************************************************************
+ *
+ * Namespaces to use
+ *
+ ****************************************************************************/
+
+using namespace std;
+using namespace Async;
+
+
+
+/****************************************************************************
+ *
+ * Defines & typedefs
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Local class definitions
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Prototypes
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Exported Global Variables
+ *
+ ****************************************************************************/
+
+
+
+
+/****************************************************************************
+ *
+ * Local Global Variables
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Public member functions
+ *
+ ****************************************************************************/
+
+RtlRemote::RtlRemote(const string &remote_host, uint16_t remote_port)
+  : con(remote_host, remote_port),
+    reconnect_timer(RECONNECT_INTERVAL, Timer::TYPE_PERIODIC),
+    subscribe_timer(SUBSCRIBE_INTERVAL, Timer::TYPE_PERIODIC, false),
+    hello_received(false), pfb(0)
+{
+  con.setMaxRxFrameSize(RtlRemoteMsg::MAX_FRAME_SIZE);
+  con.setMaxTxFrameSize(RtlRemoteMsg::MAX_FRAME_SIZE);
+  con.connected.connect(mem_fun(*this, &RtlRemote::connected));
+  con.disconnected.connect(mem_fun(*this, &RtlRemote::disconnected));
+  con.frameReceived.connect(mem_fun(*this, &RtlRemote::frameReceived));
+  con.connect();
+
+  reconnect_timer.expired.connect(sigc::track_obj(
+        [this](Async::Timer*) {
+          con.connect();
+        }, *this));
+
+    // The set of bins in use change when DDR:s are tuned or when the tuner
+    // center frequency change. Polling is cheap and keep the channelizer
+    // unaware of the network transport.
+  subscribe_timer.expired.connect(sigc::track_obj(
+        [this](Async::Timer*) {
+          updateSubscription();
+        }, *this));
+} /* RtlRemote::RtlRemote */
+
+
+RtlRemote::~RtlRemote(void)
+{
+  con.disconnect();
+} /* RtlRemote::~RtlRemote */
+
+
+void RtlRemote::setChannelizer(PfbChannelizer *pfb)
+{
+  this->pfb = pfb;
+  subscribed_bins.clear();
+  updateSubscription();
+} /* RtlRemote::setChannelizer */
+
+
+const std::string RtlRemote::displayName(void) const
+{
+  ostringstream ss;
+  ss << con.remoteHostName() << ":" << con.remotePort();
+  return ss.str();
+} /* RtlRemote::displayName */
+
+
+
+/****************************************************************************
+ *
+ * Protected member functions
+ *
+ ****************************************************************************/
+
+void RtlRemote::handleSetTunerIfGain(uint16_t stage, int16_t gain)
+{
+  uint32_t param = stage;
+  param <<= 16;
+  param |= (uint16_t)gain;
+  sendCommand(RtlRemoteMsgCommand::CMD_TUNER_IF_GAIN, param);
+} /* RtlRemote::handleSetTunerIfGain */
+
+
+void RtlRemote::handleSetCenterFq(uint32_t fq)
+{
+  sendCommand(RtlRemoteMsgCommand::CMD_CENTER_FQ, fq);
+} /* RtlRemote::handleSetCenterFq */
+
+
+void RtlRemote::handleSetSampleRate(uint32_t rate)
+{
+  sendCommand(RtlRemoteMsgCommand::CMD_SAMPLE_RATE, rate);
+} /* RtlRemote::handleSetSampleRate */
+
+
+void RtlRemote::handleSetGainMode(uint32_t mode)
+{
+  sendCommand(RtlRemoteMsgCommand::CMD_GAIN_MODE, mode);
+} /* RtlRemote::handleSetGainMode */
+
+
+void RtlRemote::handleSetGain(int32_t gain)
+{
+  sendCommand(RtlRemoteMsgCommand::CMD_GAIN, static_cast<uint32_t>(gain));
+} /* RtlRemote::handleSetGain */
+
+
+void RtlRemote::handleSetFqCorr(int corr)
+{
+  sendCommand(RtlRemoteMsgCommand::CMD_FQ_CORR, static_cast<uint32_t>(corr));
+} /* RtlRemote::handleSetFqCorr */
+
+
+void RtlRemote::handleEnableTestMode(bool enable)
+{
+  sendCommand(RtlRemoteMsgCommand::CMD_TEST_MODE, enable ? 1 : 0);
+} /* RtlRemote::handleEnableTestMode */
+
+
+void RtlRemote::handleEnableDigitalAgc(bool enable)
+{
+  sendCommand(RtlRemoteMsgCommand::CMD_DIGITAL_AGC, enable ? 1 : 0);
+} /* RtlRemote::handleEnableDigitalAgc */
+
+
+
+/****************************************************************************
+ *
+ * Private member functions
+ *
+ ****************************************************************************/
+
+void RtlRemote::sendCommand(uint8_t cmd, uint32_t param)
+{
+    // Settings are sent all at once by updateSettings when the server say
+    // hello so there is no point in sending anything before that
+  if (hello_received)
+  {
+    sendMsg(RtlRemoteMsgCommand(cmd, param));
+  }
+} /* RtlRemote::sendCommand */
+
+
+void RtlRemote::sendMsg(const RtlRemoteMsg& msg)
+{
+  if (!con.isConnected())
+  {
+    return;
+  }
+
+  RtlRemoteMsg header(msg.type());
+  tx_buf.resize(header.packedSize() + msg.packedSize());
+  Async::MsgBufWriter w(tx_buf.data(), tx_buf.size());
+  if (!header.pack(w) || !msg.pack(w))
+  {
+    cerr << "*** ERROR: Failed to pack RtlRemote message " << msg.type()
+         << endl;
+    return;
+  }
+  if (con.write(tx_buf.data(), w.size()) == -1)
+  {
+    cerr << "*** ERROR: RtlRemote write error to " << displayName() << endl;
+    con.disconnect();
+    disconnected(&con, TcpConnection::DR_SYSTEM_ERROR);
+  }
+} /* RtlRemote::sendMsg */
+
+
+void RtlRemote::connected(void)
+{
+  reconnect_timer.setEnable(false);
+} /* RtlRemote::connected */
+
+
+void RtlRemote::disconnected(Async::FramedTcpConnection *c,
+                             Async::FramedTcpConnection::DisconnectReason reason)
+{
+  setTunerType(TUNER_UNKNOWN);
+  subscribe_timer.setEnable(false);
+  subscribed_bins.clear();
+  bool was_ready = hello_received;
+  hello_received = false;
+  if (!reconnect_timer.isEnabled())
+  {
+    reconnect_timer.setEnable(true);
+  }
+  if (was_ready)
+  {
+    readyStateChanged();
+  }
+} /* RtlRemote::disconnected */
+
+
+void RtlRemote::frameReceived(Async::FramedTcpConnection *c,
+                              std::vector<uint8_t>& data)
+{
+  Async::MsgBufReader r(data.data(), data.size());
+  RtlRemoteMsg header;
+  if (!header.unpack(r))
+  {
+    cerr << "*** ERROR: Could not unpack RtlRemote message header from "
+         << displayName() << endl;
+    con.disconnect();
+    disconnected(&con, TcpConnection::DR_PROTOCOL_ERROR);
+    return;
+  }
+
+  switch (header.type())
+  {
+    case RtlRemoteMsgHello::TYPE:
+    {
+      RtlRemoteMsgHello msg;
+      if (!msg.unpack(r) || (msg.protoVer() != RtlRemoteMsg::PROTO_VER))
+      {
+        cerr << "*** ERROR: Incompatible RtlRemote server at "
+             << displayName() << endl;
+        con.disconnect();
+        disconnected(&con, TcpConnection::DR_PROTOCOL_ERROR);
+        return;
+      }
+      setTunerType(static_cast<TunerType>(msg.tunerType()));
+      hello_received = true;
+      readyStateChanged();
+      updateSettings();
+      subscribed_bins.clear();
+      updateSubscription();
+      subscribe_timer.setEnable(true);
+      break;
+    }
+
+    case RtlRemoteMsgBinSamples::TYPE:
+    {
+      if (!bin_msg.unpack(r))
+      {
+        cerr << "*** WARNING: Could not unpack RtlRemote bin samples from "
+             << displayName() << endl;
+        return;
+      }
+      if (pfb != 0)
+      {
+        bin_msg.getSamples(bin_samples);
+        pfb->binReceived(bin_msg.bin(), bin_samples);
+      }
+      break;
+    }
+
+    default:
+      cerr << "*** WARNING: Unknown RtlRemote message type "
+           << header.type() << " received from " << displayName() << endl;
+      break;
+  }
+} /* RtlRemote::frameReceived */
+
+
+void RtlRemote::updateSubscription(void)
+{
+  if (!hello_received)
+  {
+    return;
+  }
+
+  std::vector<uint16_t> bins;
+  if (pfb != 0)
+  {
+    const std::vector<unsigned>& used = pfb->usedBins();
+    bins.assign(used.begin(), used.end());
+  }
+  if (bins != subscribed_bins)
+  {
+    subscribed_bins = bins;
+    sendMsg(RtlRemoteMsgSubscribe(subscribed_bins));
+  }
+} /* RtlRemote::updateSubscription */
+
+
+/*
+ * This file has not been truncated
+ */
@@ -0,0 +1,326 @@
+/**
+@file	 RtlRemoteMsg.h
+@brief   Network messages for the remote RTL IQ server
+@author  Tobias Blomberg / SM0SVX
+@date	 2026-10-14
+
+\verbatim
+SvxLink - A Multi Purpose Voice Services System for Ham Radio Use
+Copyright (C) 2003-2026 Tobias Blomberg / SM0SVX
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+\endverbatim
+*/
+
+
+#ifndef RTL_REMOTE_MSG_INCLUDED
+#define RTL_REMOTE_MSG_INCLUDED
+
+
+/****************************************************************************
+ *
+ * System Includes
+ *
+ ****************************************************************************/
+
+#include <cmath>
+#include <complex>
+#include <vector>
+#include <algorithm>
+
+
+/****************************************************************************
+ *
+ * Project Includes
+ *
+ ****************************************************************************/
+
+#include <AsyncMsg.h>
+
+
+/****************************************************************************
+ *
+ * Local Includes
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Forward declarations
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Namespace
+ *
+ ****************************************************************************/
+
+//namespace MyNameSpace
+//{
+
+
+/****************************************************************************
+ *
+ * Forward declarations of classes inside of the declared namespace
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Defines & typedefs
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Exported Global Variables
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Class definitions
+ *
+ ****************************************************************************/
+
+/**
+@brief	Base class for remote RTL IQ server network messages
+@author Tobias Blomberg / SM0SVX
+@date   2026-10-14
+
+The remote RTL IQ server, run by RemoteTrx, own the tuner and run the
+polyphase filter bank channelizer. The client, the RtlRemote class, subscribe
+to the channelizer bins that its DDR:s use and only those bins are sent over
+the network. Each message is sent in its own frame on a framed TCP connection.
+*/
+class RtlRemoteMsg : public Async::Msg
+{
+  public:
+    static const uint16_t   DEFAULT_PORT      = 5220;
+    static const uint16_t   PROTO_VER         = 1;
+    static const uint32_t   MAX_FRAME_SIZE    = 65536;
+
+    /**
+     * @brief 	Constuctor
+     * @param 	type The message type
+     */
+    RtlRemoteMsg(uint16_t type=0) : m_type(type) {}
+
+    /**
+     * @brief 	Destructor
+     */
+    virtual ~RtlRemoteMsg(void) {}
+
+    /**
+     * @brief 	Get the message type
+     * @return	Returns the message type
+     */
+    uint16_t type(void) const { return m_type; }
+
+    ASYNC_MSG_MEMBERS(m_type)
+
+  private:
+    uint16_t m_type;
+
+};  /* class RtlRemoteMsg */
+
+
+/**
+@brief	Specific remote RTL IQ server message base class
+@author Tobias Blomberg / SM0SVX
+@date   2026-10-14
+*/
+template <unsigned msg_type>
+class RtlRemoteMsgBase : public RtlRemoteMsg
+{
+  public:
+    static const unsigned TYPE  = msg_type;
+
+  protected:
+    RtlRemoteMsgBase(void) : RtlRemoteMsg(msg_type) {}
+
+};  /* class RtlRemoteMsgBase */
+
+
+/**
+@brief	 The server is ready
+@author  Tobias Blomberg / SM0SVX
+@date    2026-10-14
+
+This message is sent by the server when a client has connected and the tuner
+is ready for operation. The client should not send any commands before this
+message has been received.
+*/
+class RtlRemoteMsgHello : public RtlRemoteMsgBase<1>
+{
+  public:
+    RtlRemoteMsgHello(uint32_t tuner_type=0)
+      : m_proto_ver(PROTO_VER), m_tuner_type(tuner_type) {}
+    uint16_t protoVer(void) const { return m_proto_ver; }
+    uint32_t tunerType(void) const { return m_tuner_type; }
+
+    ASYNC_MSG_MEMBERS(m_proto_ver, m_tuner_type)
+
+  private:
+    uint16_t m_proto_ver;
+    uint32_t m_tuner_type;
+
+};  /* RtlRemoteMsgHello */
+
+
+/**
+@brief	 A tuner command
+@author  Tobias Blomberg / SM0SVX
+@date    2026-10-14
+
+This message is sent by the client to change a tuner setting. The command
+numbers are the same as in the rtl_tcp protocol.
+*/
+class RtlRemoteMsgCommand : public RtlRemoteMsgBase<2>
+{
+  public:
+    typedef enum
+    {
+      CMD_CENTER_FQ = 1, CMD_SAMPLE_RATE = 2, CMD_GAIN_MODE = 3, CMD_GAIN = 4,
+      CMD_FQ_CORR = 5, CMD_TUNER_IF_GAIN = 6, CMD_TEST_MODE = 7,
+      CMD_DIGITAL_AGC = 8
+    } Command;
+
+    RtlRemoteMsgCommand(uint8_t cmd=0, uint32_t param=0)
+      : m_cmd(cmd), m_param(param) {}
+    uint8_t cmd(void) const { return m_cmd; }
+    uint32_t param(void) const { return m_param; }
+
+    ASYNC_MSG_MEMBERS(m_cmd, m_param)
+
+  private:
+    uint8_t   m_cmd;
+    uint32_t  m_param;
+
+};  /* RtlRemoteMsgCommand */
+
+
+/**
+@brief	 Select which channelizer bins to receive
+@author  Tobias Blomberg / SM0SVX
+@date    2026-10-14
+
+This message is sent by the client every time the set of channelizer bins in
+use change. The server will only send samples for these bins. An empty list
+stop all sample transfers.
+*/
+class RtlRemoteMsgSubscribe : public RtlRemoteMsgBase<3>
+{
+  public:
+    RtlRemoteMsgSubscribe(void) {}
+    RtlRemoteMsgSubscribe(const std::vector<uint16_t>& bins) : m_bins(bins) {}
+    const std::vector<uint16_t>& bins(void) const { return m_bins; }
+
+    ASYNC_MSG_MEMBERS(m_bins)
+
+  private:
+    std::vector<uint16_t> m_bins;
+
+};  /* RtlRemoteMsgSubscribe */
+
+
+/**
+@brief	 Channelized samples for one bin
+@author  Tobias Blomberg / SM0SVX
+@date    2026-10-14
+
+This message is sent by the server for every block of samples produced for a
+subscribed channelizer bin. The complex samples are sent as interleaved 16
+bit I and Q values, scaled so that the largest value in the block use the
+full range. Since the tuner only deliver 8 bit samples, no precision that
+matter is lost.
+*/
+class RtlRemoteMsgBinSamples : public RtlRemoteMsgBase<4>
+{
+  public:
+    typedef std::complex<float> Sample;
+
+    RtlRemoteMsgBinSamples(void) : m_bin(0), m_scale(0.0f) {}
+
+    uint16_t bin(void) const { return m_bin; }
+
+    /**
+     * @brief   Set the samples to send
+     * @param   bin     The bin index
+     * @param   samples The bin samples
+     */
+    void setSamples(uint16_t bin, const std::vector<Sample>& samples)
+    {
+      m_bin = bin;
+      float max_val = 0.0f;
+      for (const auto& samp : samples)
+      {
+        max_val = std::max(max_val,
+            std::max(std::fabs(samp.real()), std::fabs(samp.imag())));
+      }
+      m_scale = max_val / 32767.0f;
+      const float mult = (max_val > 0.0f) ? (32767.0f / max_val) : 0.0f;
+      m_iq.resize(2 * samples.size());
+      for (size_t i=0; i<samples.size(); ++i)
+      {
+        m_iq[2*i] = static_cast<int16_t>(std::lrint(samples[i].real() * mult));
+        m_iq[2*i+1] =
+          static_cast<int16_t>(std::lrint(samples[i].imag() * mult));
+      }
+    }
+
+    /**
+     * @brief   Get the received samples
+     * @param   samples The vector to store the samples in
+     */
+    void getSamples(std::vector<Sample>& samples) const
+    {
+      samples.resize(m_iq.size() / 2);
+      for (size_t i=0; i<samples.size(); ++i)
+      {
+        samples[i] = Sample(m_iq[2*i] * m_scale, m_iq[2*i+1] * m_scale);
+      }
+    }
+
+    ASYNC_MSG_MEMBERS(m_bin, m_scale, m_iq)
+
+  private:
+    uint16_t              m_bin;
+    float                 m_scale;
+    std::vector<int16_t>  m_iq;
+
+};  /* RtlRemoteMsgBinSamples */
+
+
+//} /* namespace */
+
+#endif /* RTL_REMOTE_MSG_INCLUDED */
+
+
+
+/*
+ * This file has not been truncated
+ */
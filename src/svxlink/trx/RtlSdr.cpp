@@ -81,6 +81,23 @@ using namespace std;
  *
  ****************************************************************************/
 
+namespace {
+    // Lookup table for converting an unsigned 8 bit IQ component from the
+    // dongle into a float in the range -1 to 1
+  struct IqConvLut
+  {
+    float val[256];
+
+    IqConvLut(void)
+    {
+      for (unsigned i=0; i<256; ++i)
+      {
+        val[i] = i / 127.5f - 1.0f;
+      }
+    }
+  };
+};
+
 
 
 /****************************************************************************
@@ -106,6 +123,10 @@ using namespace std;
  *
  ****************************************************************************/
 
+namespace {
+  const IqConvLut iq_conv_lut;
+};
+
 
 
 /****************************************************************************
@@ -119,7 +140,8 @@ RtlSdr::RtlSdr(void)
     tuner_type(TUNER_UNKNOWN), center_fq_set(false), center_fq(100000000),
     samp_rate_set(false), gain_mode(-1), gain(GAIN_UNSET), fq_corr_set(false),
     fq_corr(0), test_mode_set(false), test_mode(false),
-    use_digital_agc_set(false), use_digital_agc(false), dist_print_cnt(-1)
+    use_digital_agc_set(false), use_digital_agc(false), dist_print_cnt(-1),
+    iq_copy_samp_cnt(0), iq_copy_cnt(0), iq_copy_rate(0)
 {
   for (unsigned i=0; i<MAX_IF_GAIN_STAGES; ++i)
   {
@@ -280,20 +302,30 @@ void RtlSdr::handleIq(const complex<uint8_t> *samples, int samp_count)
 {
   //cout << "RtlSdr::handleIq: samp_count=" << samp_count << endl;
 
-  vector<Sample> iq;
-  iq.reserve(samp_count);
+    // The block is converted into a buffer that is reused for every block
+    // and then passed by reference to all connected receivers
+  iq_buf.resize(samp_count);
+  const float *lut = iq_conv_lut.val;
+  Sample *out = iq_buf.data();
+  bool clipped = false;
   for (int idx=0; idx<samp_count; ++idx)
   {
-    if ((dist_print_cnt == 0) &&
-        ((samples[idx].real() == 255) || (samples[idx].imag() == 255)))
-    {
-      dist_print_cnt = samp_rate;
-    }
-    float i = samples[idx].real();
-    i = i / 127.5f - 1.0f;
-    float q = samples[idx].imag();
-    q = q / 127.5f - 1.0f;
-    iq.push_back(complex<float>(i, q));
+    const uint8_t i = samples[idx].real();
+    const uint8_t q = samples[idx].imag();
+    clipped |= (i == 255) | (q == 255);
+    out[idx] = Sample(lut[i], lut[q]);
+  }
+  if (clipped && (dist_print_cnt == 0))
+  {
+    dist_print_cnt = samp_rate;
+  }
+  iq_copy_cnt += samp_count * sizeof(Sample);
+  iq_copy_samp_cnt += samp_count;
+  if (iq_copy_samp_cnt >= samp_rate)
+  {
+    iq_copy_rate = iq_copy_cnt * samp_rate / iq_copy_samp_cnt;
+    iq_copy_samp_cnt = 0;
+    iq_copy_cnt = 0;
   }
 
   if (dist_print_cnt > 0)
@@ -310,7 +342,7 @@ void RtlSdr::handleIq(const complex<uint8_t> *samples, int samp_count)
     }
   }
 
-  iqReceived(iq);
+  iqReceived(iq_buf);
 } /* RtlSdr::handleIq */
 
 
@@ -288,15 +288,28 @@ class RtlSdr : public sigc::trackable
      */
     virtual const std::string displayName(void) const = 0;
 
+    /**
+     * @brief   Get the number of IQ bytes copied per second
+     * @returns Returns the IQ byte rate measured over the last second
+     *
+     * This is the number of bytes per second that are written when
+     * converting the samples received from the dongle into the buffer that
+     * is passed to all connected receivers. Since the buffer is shared,
+     * the rate does not depend on the number of receivers.
+     */
+    uint64_t iqBytesCopiedPerSecond(void) const { return iq_copy_rate; }
+
     /**
      * @brief   A signal that is emitted when new samples have been received
      * @param   samples A vector of received samples
      *
      * Connecting to this signal is the way to get samples from the DVB-T
      * dongle. The format is a vector of complex floats (I/Q) with a range from
-     * -1 to 1.
+     * -1 to 1. The samples are passed by reference and are only valid
+     * during the signal emission so a slot that need to keep them must
+     * copy them.
      */
-    sigc::signal<void(std::vector<Sample>)> iqReceived;
+    sigc::signal<void(const std::vector<Sample>&)> iqReceived;
 
     /**
      * @brief   A signal that is emitted when the ready state changes
@@ -416,6 +429,10 @@ class RtlSdr : public sigc::trackable
     bool              use_digital_agc_set;
     bool              use_digital_agc;
     int               dist_print_cnt;
+    std::vector<Sample> iq_buf;
+    uint32_t          iq_copy_samp_cnt;
+    uint64_t          iq_copy_cnt;
+    uint64_t          iq_copy_rate;
 
     RtlSdr(const RtlSdr&);
     RtlSdr& operator=(const RtlSdr&);
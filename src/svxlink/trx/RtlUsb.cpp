@@ -39,7 +39,8 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 #include <sstream>
 #include <iostream>
 #include <cassert>
-#include <queue>
+#include <vector>
+#include <atomic>
 #include <unistd.h>
 #include <stdio.h>
 #include <errno.h>
@@ -52,6 +53,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
  ****************************************************************************/
 
 #include <AsyncFdWatch.h>
+#include <AsyncThreadSched.h>
 
 
 /****************************************************************************
@@ -93,11 +95,12 @@ class RtlUsb::SampleBuffer : public sigc::trackable
 {
   public:
     SampleBuffer(uint32_t block_size)
-      : block_size(block_size), buf(0), buf_cnt(0), watch(0)
+      : block_size(block_size), buf_cnt(0), head(0), tail(0),
+        overflow_cnt(0), reported_overflow_cnt(0), watch(0)
     {
       pthread_mutex_init(&mutex, NULL);
 
-      buf = new uint8_t[block_size];
+      ring_buf.resize(RING_SIZE * block_size);
 
       int r = pipe(signal_pipe);
       assert (r == 0);
@@ -109,13 +112,6 @@ class RtlUsb::SampleBuffer : public sigc::trackable
     ~SampleBuffer(void)
     {
       pthread_mutex_destroy(&mutex);
-      delete [] buf;
-      buf = 0;
-      while (!block_queue.empty())
-      {
-        delete [] block_queue.front();
-        block_queue.pop();
-      }
       closeReadPipe();
       closeWritePipe();
     }
@@ -152,34 +148,30 @@ class RtlUsb::SampleBuffer : public sigc::trackable
     {
       lockMutex();
       block_size = new_block_size;
-      while (!block_queue.empty())
-      {
-        delete block_queue.front();
-        block_queue.pop();
-      }
-      delete [] buf;
-      buf = new uint8_t[block_size];
+      ring_buf.assign(RING_SIZE * block_size, 0);
       buf_cnt = 0;
+      tail.store(head.load());
       unlockMutex();
     }
 
     void clear(void)
     {
       lockMutex();
-      while (!block_queue.empty())
-      {
-        delete [] block_queue.front();
-        block_queue.pop();
-      }
       buf_cnt = 0;
+      tail.store(head.load());
       unlockMutex();
     }
 
+      // Called from the reader thread. The mutex is only contended when
+      // the block size is changed so the sample handoff to the main thread
+      // is done through the head and tail counters only.
     bool addSamples(const unsigned char *samples, uint32_t len)
     {
       lockMutex();
       while (len > 0)
       {
+        const unsigned h = head.load(std::memory_order_relaxed);
+        uint8_t *buf = &ring_buf[(h % RING_SIZE) * block_size];
         uint32_t cpy_cnt = min(block_size - buf_cnt, len);
         memcpy(buf + buf_cnt, samples, cpy_cnt);
         buf_cnt += cpy_cnt;
@@ -187,9 +179,15 @@ class RtlUsb::SampleBuffer : public sigc::trackable
         samples += cpy_cnt;
         if (buf_cnt >= block_size)
         {
-          block_queue.push(buf);
-          buf = new uint8_t[block_size];
           buf_cnt = 0;
+          if (h - tail.load(std::memory_order_acquire) >= RING_SIZE)
+          {
+              // The main thread is not keeping up. Drop the block by
+              // overwriting it with the next one.
+            overflow_cnt.fetch_add(1, std::memory_order_relaxed);
+            continue;
+          }
+          head.store(h + 1, std::memory_order_release);
           unlockMutex();
           if (write(signal_pipe[1], "S", 1) != 1)
           {
@@ -202,17 +200,31 @@ class RtlUsb::SampleBuffer : public sigc::trackable
       return true;
     }
 
+    /**
+     * @brief   Get the number of sample blocks dropped due to overflow
+     * @return  Returns the number of dropped blocks since the start
+     */
+    unsigned overflowCount(void) const
+    {
+      return overflow_cnt.load(std::memory_order_relaxed);
+    }
+
     sigc::signal<void(complex<uint8_t>*, int)> handleIq;
     sigc::signal<void()> writePipeClosed;
 
   private:
-    uint32_t          block_size;
-    uint8_t           *buf;
-    uint32_t          buf_cnt;
-    pthread_mutex_t   mutex;
-    int               signal_pipe[2];
-    FdWatch           *watch;
-    queue<uint8_t*>   block_queue;
+    static const unsigned RING_SIZE = 32;
+
+    uint32_t              block_size;
+    std::vector<uint8_t>  ring_buf;
+    uint32_t              buf_cnt;
+    std::atomic<unsigned> head;
+    std::atomic<unsigned> tail;
+    std::atomic<unsigned> overflow_cnt;
+    unsigned              reported_overflow_cnt;
+    pthread_mutex_t       mutex;
+    int                   signal_pipe[2];
+    FdWatch               *watch;
 
     void lockMutex(void)
     {
@@ -252,18 +264,28 @@ class RtlUsb::SampleBuffer : public sigc::trackable
         abort();
       }
 
-      lockMutex();
-      while (!block_queue.empty())
+      unsigned t = tail.load(std::memory_order_relaxed);
+      while (t != head.load(std::memory_order_acquire))
       {
-        uint8_t *buf = block_queue.front();
-        block_queue.pop();
-        unlockMutex();
+        uint8_t *buf = &ring_buf[(t % RING_SIZE) * block_size];
         complex<uint8_t> *samples = reinterpret_cast<complex<uint8_t>*>(buf);
         handleIq(samples, block_size / 2);
-        delete [] buf;
-        lockMutex();
+
+          // The ring is reset if the block size is changed by a handler
+        unsigned expected = t;
+        tail.compare_exchange_strong(expected, t + 1,
+                                     std::memory_order_release);
+        t = tail.load(std::memory_order_relaxed);
+      }
+
+      unsigned overflows = overflowCount();
+      if (overflows != reported_overflow_cnt)
+      {
+        cerr << "*** WARNING: " << (overflows - reported_overflow_cnt)
+             << " RTL sample block(s) lost since the main thread did not "
+                "keep up\n";
+        reported_overflow_cnt = overflows;
       }
-      unlockMutex();
     }
 };
 
@@ -521,6 +543,7 @@ void *RtlUsb::startRtlReader(void *data)
 {
   RtlUsb *rtl = reinterpret_cast<RtlUsb*>(data);
   assert(rtl != 0);
+  Async::ThreadSched::Registration sched_reg("rtlusb");
   rtl->rtlReader();
   return NULL;
 } /* RtlUsb::startRtlReader */
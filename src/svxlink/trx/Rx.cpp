@@ -59,6 +59,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 #include "NetRx.h"
 #include "DummyRxTx.h"
 #include "Ddr.h"
+#include "ScanRx.h"
 #include "LocalRxSim.h"
 
 
@@ -153,6 +154,19 @@ class DdrFactory : public RxFactory
 }; /* class DdrFactory */
 
 
+class ScanRxFactory : public RxFactory
+{
+  public:
+    ScanRxFactory(void) : RxFactory("Scan") {}
+
+  protected:
+    Rx *createRx(Config &cfg, const string& name)
+    {
+      return new ScanRx(cfg, name);
+    }
+}; /* class ScanRxFactory */
+
+
 class LocalRxSimFactory : public RxFactory
 {
   public:
@@ -272,6 +286,7 @@ Rx *RxFactory::createNamedRx(Config& cfg, const string& name)
   NetRxFactory net_rx_factory;
   DummyRxFactory dummy_rx_factory;
   DdrFactory ddr_rx_factory;
+  ScanRxFactory scan_rx_factory;
   LocalRxSimFactory local_rx_sim_factory;
   
   string rx_type;
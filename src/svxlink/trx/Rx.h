@@ -239,6 +239,14 @@ class Rx : public sigc::trackable, public Async::AudioSource
      */
     virtual bool isReady(void) const { return true; }
 
+    /**
+     * @brief   Get the number of audio overruns
+     * @return  Returns the number of times captured audio has been lost
+     *
+     * Receivers that do not have an audio input of their own return 0.
+     */
+    virtual unsigned long audioOverrunCount(void) const { return 0; }
+
     /**
      * @brief   Set the receiver frequency
      * @param   fq The frequency in Hz
@@ -251,6 +259,26 @@ class Rx : public sigc::trackable, public Async::AudioSource
      */
     virtual void setModulation(Modulation::Type mod) {}
 
+    /**
+     * @brief   Get the capture time of the current receiver event
+     * @param   ts_us Set to the wall clock capture time in microseconds
+     * @return  Returns \em true if a capture time is known
+     *
+     * This function may be called from a handler connected to the
+     * squelchOpen or signalLevelUpdated signals to find out when the event
+     * actually happened at the receiver. A receiver that does not know about
+     * this return \em false and the event should be assumed to have
+     * happened now.
+     */
+    virtual bool eventTimestamp(uint64_t& ts_us) const { return false; }
+
+    /**
+     * @brief   Get the estimated audio delay for this receiver
+     * @return  Returns the estimated delay in milliseconds from capture to
+     *          the time that the audio is emitted by this object
+     */
+    virtual unsigned audioDelay(void) const { return 0; }
+
     /**
      * @brief 	A signal that indicates if the squelch is open or not
      * @param 	is_open \em True if the squelch is open or \em false if not
@@ -269,7 +297,7 @@ class Rx : public sigc::trackable, public Async::AudioSource
                 detected
      * @param 	sequence the selcall sequence
      */
-    sigc::signal<void(std::string)> selcallSequenceDetected;
+    sigc::signal<void(const std::string&)> selcallSequenceDetected;
 
     /**
      * @brief 	A signal that is emitted when a previously specified tone has
@@ -0,0 +1,228 @@
+/******************************************************************************
+ *
+ * Simulate a large number of receivers in a voter setup and measure the CPU
+ * load.
+ *
+ * Run with something like:
+ *   svxlink/trx/RxSimBench [--rx <count>] [--time <seconds>]
+ *                          [--block <samples>] [--noise <dB>]
+ *                          [--threads <count>] [--format table|json]
+ *
+ * A number of LocalSim receivers are created and put behind a voter. Each
+ * receiver use a simulated signal level detector that toggle the signal
+ * level, and thereby the squelch, at slightly different intervals for each
+ * receiver. The signal level also drift randomly so that the voter have
+ * something to choose between. The event loop is then run in real time for
+ * the given time and the CPU time used by the process is measured. This give
+ * a good picture of how many receivers a machine can handle and where the
+ * overhead is when running large simulated setups, e.g. when testing voter
+ * or logic changes.
+ *
+ ******************************************************************************/
+
+#include <sys/time.h>
+#include <sys/resource.h>
+
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <chrono>
+#include <memory>
+#include <cstdlib>
+
+#include <AsyncCppApplication.h>
+#include <AsyncConfig.h>
+#include <AsyncTimer.h>
+#include <AsyncAudioSink.h>
+
+#include "Rx.h"
+
+
+using namespace std;
+using namespace Async;
+
+
+namespace {
+
+  /*
+   * Throw away all samples written to the sink
+   */
+class NullSink : public AudioSink
+{
+  public:
+    int writeSamples(const float *samples, int count) override
+    {
+      return count;
+    }
+
+    void flushSamples(void) override
+    {
+      sourceAllSamplesFlushed();
+    }
+};
+
+
+double cpuSeconds(void)
+{
+  struct rusage ru;
+  getrusage(RUSAGE_SELF, &ru);
+  return ru.ru_utime.tv_sec + ru.ru_utime.tv_usec / 1000000.0 +
+         ru.ru_stime.tv_sec + ru.ru_stime.tv_usec / 1000000.0;
+} /* cpuSeconds */
+
+
+void usage(const char *prog)
+{
+  cerr << "Usage: " << prog << " [--rx <count>] [--time <seconds>] "
+          "[--block <samples>]\n"
+          "       [--noise <dB>] [--threads <count>] "
+          "[--format table|json]\n";
+} /* usage */
+
+}; /* anonymous namespace */
+
+
+int main(int argc, const char **argv)
+{
+  unsigned rx_cnt = 16;
+  double run_time = 10.0;
+  unsigned block = 128;
+  string noise_pwr;
+  unsigned threads = 0;
+  string format("table");
+  for (int i=1; i<argc; ++i)
+  {
+    string arg(argv[i]);
+    if ((arg == "--rx") && (i+1 < argc))
+    {
+      rx_cnt = atoi(argv[++i]);
+    }
+    else if ((arg == "--time") && (i+1 < argc))
+    {
+      run_time = atof(argv[++i]);
+    }
+    else if ((arg == "--block") && (i+1 < argc))
+    {
+      block = atoi(argv[++i]);
+    }
+    else if ((arg == "--noise") && (i+1 < argc))
+    {
+      noise_pwr = argv[++i];
+    }
+    else if ((arg == "--threads") && (i+1 < argc))
+    {
+      threads = atoi(argv[++i]);
+    }
+    else if ((arg == "--format") && (i+1 < argc))
+    {
+      format = argv[++i];
+    }
+    else
+    {
+      usage(argv[0]);
+      return 1;
+    }
+  }
+  if ((rx_cnt == 0) || (block == 0) || (run_time <= 0.0) ||
+      ((format != "table") && (format != "json")))
+  {
+    usage(argv[0]);
+    return 1;
+  }
+
+  CppApplication app;
+
+    // The receivers print status messages on stdout. Send those to stderr
+    // to keep the results machine readable.
+  ostream out(cout.rdbuf());
+  cout.rdbuf(cerr.rdbuf());
+
+  Config cfg;
+  cfg.setValue("GLOBAL", "RX_WORKER_THREADS", to_string(threads));
+  string receivers;
+  for (unsigned i=0; i<rx_cnt; ++i)
+  {
+    string name = "SimRx" + to_string(i);
+    cfg.setValue(name, "TYPE", "LocalSim");
+    cfg.setValue(name, "SIM_BLOCK_SIZE", to_string(block));
+    if (!noise_pwr.empty())
+    {
+      cfg.setValue(name, "SIM_NOISE_PWR", noise_pwr);
+    }
+    cfg.setValue(name, "SQL_DET", "SIGLEV");
+    cfg.setValue(name, "SQL_SIGLEV_OPEN_THRESH", "30");
+    cfg.setValue(name, "SQL_SIGLEV_CLOSE_THRESH", "10");
+    cfg.setValue(name, "SIGLEV_DET", "SIM");
+    cfg.setValue(name, "SIGLEV_MIN", "0");
+    cfg.setValue(name, "SIGLEV_MAX", to_string(50 + i % 50));
+    cfg.setValue(name, "SIGLEV_DEFAULT", "0");
+    cfg.setValue(name, "SIGLEV_TOGGLE_INTERVAL", to_string(2000 + 137 * i));
+    cfg.setValue(name, "SIGLEV_RAND_INTERVAL", "20");
+    receivers += (i > 0) ? "," + name : name;
+  }
+  cfg.setValue("SimVoter", "TYPE", "Voter");
+  cfg.setValue("SimVoter", "RECEIVERS", receivers);
+
+  unique_ptr<Rx> voter(RxFactory::createNamedRx(cfg, "SimVoter"));
+  if ((voter == nullptr) || !voter->initialize())
+  {
+    cerr << "*** ERROR: Could not initialize the simulated voter setup\n";
+    return 1;
+  }
+  NullSink null_sink;
+  voter->registerSink(&null_sink);
+  voter->setMuteState(Rx::MUTE_NONE);
+
+  unsigned sql_open_cnt = 0;
+  unsigned siglev_cnt = 0;
+  voter->squelchOpen.connect([&](bool is_open)
+      {
+        sql_open_cnt += is_open ? 1 : 0;
+      });
+  voter->signalLevelUpdated.connect([&](float) { ++siglev_cnt; });
+
+  Timer run_timer(static_cast<int>(1000.0 * run_time));
+  run_timer.expired.connect([](Timer*) { Application::app().quit(); });
+
+  const double cpu_start = cpuSeconds();
+  const auto wall_start = chrono::steady_clock::now();
+  app.exec();
+  const double cpu = cpuSeconds() - cpu_start;
+  const double wall = chrono::duration<double>(
+      chrono::steady_clock::now() - wall_start).count();
+
+    // The load is given as the fraction of one CPU core
+  const double load = cpu / wall;
+  const double us_per_rx = 1000000.0 * cpu / wall / rx_cnt;
+  if (format == "json")
+  {
+    out << "{\n"
+        << "  \"receivers\": " << rx_cnt << ",\n"
+        << "  \"blockSize\": " << block << ",\n"
+        << "  \"workerThreads\": " << threads << ",\n"
+        << "  \"wallSeconds\": " << wall << ",\n"
+        << "  \"cpuSeconds\": " << cpu << ",\n"
+        << "  \"cpuLoad\": " << load << ",\n"
+        << "  \"cpuUsPerRxSecond\": " << us_per_rx << ",\n"
+        << "  \"squelchOpenEvents\": " << sql_open_cnt << ",\n"
+        << "  \"signalLevelUpdates\": " << siglev_cnt << "\n"
+        << "}\n";
+  }
+  else
+  {
+    out << fixed << setprecision(2)
+        << "Receivers           : " << rx_cnt << "\n"
+        << "Block size          : " << block << " samples\n"
+        << "Worker threads      : " << threads << "\n"
+        << "Wall time           : " << wall << " s\n"
+        << "CPU time            : " << cpu << " s\n"
+        << "CPU load            : " << (100.0 * load) << "% of one core\n"
+        << "CPU per receiver    : " << us_per_rx << " us/s\n"
+        << "Voter squelch opens : " << sql_open_cnt << "\n"
+        << "Voter siglev updates: " << siglev_cnt << "\n";
+  }
+
+  cout.rdbuf(out.rdbuf());
+
+  return 0;
+} /* main */
@@ -34,6 +34,8 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
  ****************************************************************************/
 
 #include <iostream>
+#include <cstring>
+#include <cerrno>
 
 
 /****************************************************************************
@@ -161,6 +163,14 @@ bool S54sDtmfDecoder::initialize(void)
     serial->close();
     return false;
   }
+  bool low_latency = false;
+  cfg().getValue(name(), "DTMF_SERIAL_LOW_LATENCY", low_latency);
+  if (low_latency && !serial->setLowLatency(true))
+  {
+    cerr << "*** WARNING: Could not enable low latency mode for "
+         << serial_dev << " specified in " << name() << "/DTMF_SERIAL: "
+         << strerror(errno) << endl;
+  }
   serial->charactersReceived.connect(
       mem_fun(*this, &S54sDtmfDecoder::charactersReceived));
   
@@ -0,0 +1,462 @@
+/**
+@file	 ScanRx.cpp
+@brief   A receiver scanning many channels on one wideband tuner
+@author  Tobias Blomberg / SM0SVX
+@date	 2026-10-15
+
+This file contains a receiver class that scan a list of channels within the
+passband of one wideband tuner and demodulate the channel that is active.
+
+\verbatim
+SvxLink - A Multi Purpose Voice Services System for Ham Radio Use
+Copyright (C) 2004-2026 Tobias Blomberg / SM0SVX
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+\endverbatim
+*/
+
+
+
+/****************************************************************************
+ *
+ * System Includes
+ *
+ ****************************************************************************/
+
+#include <sigc++/sigc++.h>
+
+#include <cstdlib>
+#include <cmath>
+#include <complex>
+#include <iostream>
+#include <sstream>
+
+
+/****************************************************************************
+ *
+ * Project Includes
+ *
+ ****************************************************************************/
+
+#include <AsyncConfig.h>
+
+
+/****************************************************************************
+ *
+ * Local Includes
+ *
+ ****************************************************************************/
+
+#include "ScanRx.h"
+#include "WbRxRtlSdr.h"
+#include "PfbChannelizer.h"
+
+
+/****************************************************************************
+ *
+ * Namespaces to use
+ *
+ ****************************************************************************/
+
+using namespace std;
+using namespace sigc;
+using namespace Async;
+
+
+
+/****************************************************************************
+ *
+ * Defines & typedefs
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Local class definitions
+ *
+ ****************************************************************************/
+
+  /**
+   * A cheap power squelch for one channel. The channel is moved to the
+   * center of the bin and then integrated over a few samples, which work as
+   * a crude lowpass filter of about the width of a narrowband channel. The
+   * power is averaged over 10 milliseconds before being compared to the
+   * thresholds.
+   */
+class ScanRx::ChannelMonitor : public sigc::trackable
+{
+  public:
+    ChannelMonitor(uint32_t fq, float open_thresh, float close_thresh)
+      : m_fq(fq), m_open_thresh(open_thresh), m_close_thresh(close_thresh),
+        m_is_active(false), m_rot(1.0f, 0.0f), m_step(1.0f, 0.0f),
+        m_dump_len(1), m_acc(0.0f, 0.0f), m_acc_cnt(0), m_pwr_sum(0.0f),
+        m_dump_cnt(0), m_outside(false)
+    {
+    }
+
+    ~ChannelMonitor(void)
+    {
+      m_con.disconnect();
+    }
+
+    uint32_t fq(void) const { return m_fq; }
+
+    bool isActive(void) const { return m_is_active; }
+
+    void connect(PfbChannelizer *pfb, int fq_offset, int max_offset)
+    {
+      m_con.disconnect();
+      m_acc = 0.0f;
+      m_acc_cnt = 0;
+      m_pwr_sum = 0.0f;
+      m_dump_cnt = 0;
+      setActive(false);
+
+      if (abs(fq_offset) > max_offset)
+      {
+        if (!m_outside)
+        {
+          cerr << "*** WARNING: Scanner channel " << m_fq
+               << "Hz does not fit into the tuner passband" << endl;
+          m_outside = true;
+        }
+        return;
+      }
+      m_outside = false;
+
+      int residual = 0;
+      unsigned bin = pfb->findBin(fq_offset, residual);
+      const unsigned samp_rate = pfb->binSampRate();
+      m_dump_len = samp_rate / CH_SAMP_RATE;
+      if (m_dump_len == 0)
+      {
+        m_dump_len = 1;
+      }
+      m_rot = complex<float>(1.0f, 0.0f);
+      m_step = polar(1.0f, static_cast<float>(-2.0 * M_PI * residual /
+                                              samp_rate));
+      m_con = pfb->connectBin(bin,
+          mem_fun(*this, &ChannelMonitor::binReceived));
+    }
+
+    sigc::signal<void(bool)> activityChanged;
+
+  private:
+    static const unsigned CH_SAMP_RATE  = 16000;
+    static const unsigned EVAL_CNT      = CH_SAMP_RATE / 100;
+
+    uint32_t                m_fq;
+    float                   m_open_thresh;
+    float                   m_close_thresh;
+    bool                    m_is_active;
+    complex<float>          m_rot;
+    complex<float>          m_step;
+    unsigned                m_dump_len;
+    complex<float>          m_acc;
+    unsigned                m_acc_cnt;
+    float                   m_pwr_sum;
+    unsigned                m_dump_cnt;
+    bool                    m_outside;
+    sigc::connection        m_con;
+
+    void binReceived(const vector<PfbChannelizer::Sample>& samples)
+    {
+      for (size_t i=0; i<samples.size(); ++i)
+      {
+        m_acc += samples[i] * m_rot;
+        m_rot *= m_step;
+        if (++m_acc_cnt < m_dump_len)
+        {
+          continue;
+        }
+        m_pwr_sum += norm(m_acc) / (m_dump_len * m_dump_len);
+        m_acc = 0.0f;
+        m_acc_cnt = 0;
+        if (++m_dump_cnt == EVAL_CNT)
+        {
+          float level = 10.0f * log10f(m_pwr_sum / EVAL_CNT + 1.0e-20f);
+          m_pwr_sum = 0.0f;
+          m_dump_cnt = 0;
+          if (!m_is_active && (level > m_open_thresh))
+          {
+            setActive(true);
+          }
+          else if (m_is_active && (level < m_close_thresh))
+          {
+            setActive(false);
+          }
+        }
+      }
+
+        // Keep the rotator from drifting away from the unit circle
+      m_rot /= abs(m_rot);
+    }
+
+    void setActive(bool is_active)
+    {
+      if (is_active != m_is_active)
+      {
+        m_is_active = is_active;
+        activityChanged(is_active);
+      }
+    }
+};  /* ScanRx::ChannelMonitor */
+
+
+
+/****************************************************************************
+ *
+ * Prototypes
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Exported Global Variables
+ *
+ ****************************************************************************/
+
+
+
+
+/****************************************************************************
+ *
+ * Local Global Variables
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Public member functions
+ *
+ ****************************************************************************/
+
+ScanRx::ScanRx(Config &cfg, const std::string& name)
+  : Ddr(cfg, name), cfg(cfg), active_ch(-1), preempt(false),
+    hang_timer(2000, Timer::TYPE_ONESHOT, false)
+{
+  hang_timer.expired.connect(hide(mem_fun(*this, &ScanRx::hangTimeout)));
+} /* ScanRx::ScanRx */
+
+
+ScanRx::~ScanRx(void)
+{
+  for (Monitors::iterator it=monitors.begin(); it!=monitors.end(); ++it)
+  {
+    delete *it;
+  }
+  monitors.clear();
+} /* ScanRx::~ScanRx */
+
+
+bool ScanRx::initialize(void)
+{
+  vector<uint32_t> channels;
+  if (!cfg.getValue(name(), "CHANNELS", channels) || channels.empty())
+  {
+    cerr << "*** ERROR: Config variable " << name()
+         << "/CHANNELS not set or empty\n";
+    return false;
+  }
+
+  float open_thresh = -60.0f;
+  cfg.getValue(name(), "SCAN_OPEN_THRESH", open_thresh);
+  float close_thresh = open_thresh - 6.0f;
+  cfg.getValue(name(), "SCAN_CLOSE_THRESH", close_thresh);
+  unsigned hang_time = 2000;
+  cfg.getValue(name(), "SCAN_HANG_TIME", hang_time);
+  hang_timer.setTimeout(hang_time);
+  cfg.getValue(name(), "SCAN_PREEMPT", preempt);
+
+    // The demodulator start out on the first channel
+  string fqstr;
+  if (!cfg.getValue(name(), "FQ", fqstr))
+  {
+    ostringstream ss;
+    ss << channels[0];
+    cfg.setValue(name(), "FQ", ss.str());
+  }
+
+  for (size_t ch=0; ch<channels.size(); ++ch)
+  {
+    ChannelMonitor *mon = new ChannelMonitor(channels[ch], open_thresh,
+                                             close_thresh);
+    mon->activityChanged.connect(
+        sigc::bind(sigc::mem_fun(*this, &ScanRx::channelActivityChanged),
+                   static_cast<int>(ch)));
+    monitors.push_back(mon);
+  }
+  squelchOpen.connect(mem_fun(*this, &ScanRx::squelchStateChanged));
+
+  if (!Ddr::initialize())
+  {
+    return false;
+  }
+
+    // The channel monitors are connected to the filter bank of the tuner so
+    // a scanning receiver cannot move between tuners
+  if (hasTunerGroup())
+  {
+    cerr << "*** ERROR: The scanning receiver " << name()
+         << " can only use one wideband receiver in WBRX\n";
+    return false;
+  }
+
+  if (wbRx()->channelizer() == 0)
+  {
+    cerr << "*** ERROR: The scanning receiver " << name()
+         << " require PFB_CHANNELIZER to be enabled in the wideband "
+         << "receiver\n";
+    return false;
+  }
+
+  setDemodEnabled(false);
+  tunerFqChanged(wbRx()->centerFq());
+
+  return true;
+} /* ScanRx::initialize */
+
+
+void ScanRx::coveredFqs(std::vector<uint32_t>& fqs) const
+{
+  for (Monitors::const_iterator it=monitors.begin(); it!=monitors.end(); ++it)
+  {
+    fqs.push_back((*it)->fq());
+  }
+} /* ScanRx::coveredFqs */
+
+
+void ScanRx::tunerFqChanged(uint32_t fq)
+{
+  Ddr::tunerFqChanged(fq);
+
+  WbRxRtlSdr *rtl = wbRx();
+  PfbChannelizer *pfb = (rtl != 0) ? rtl->channelizer() : 0;
+  if (pfb == 0)
+  {
+    return;
+  }
+  const int max_offset = static_cast<int>(rtl->sampleRate() / 2) - 12500;
+  for (Monitors::iterator it=monitors.begin(); it!=monitors.end(); ++it)
+  {
+    ChannelMonitor *mon = *it;
+    mon->connect(pfb, static_cast<int>(mon->fq()) - static_cast<int>(fq),
+                 max_offset);
+  }
+} /* ScanRx::tunerFqChanged */
+
+
+
+/****************************************************************************
+ *
+ * Protected member functions
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Private member functions
+ *
+ ****************************************************************************/
+
+void ScanRx::channelActivityChanged(int ch, bool is_active)
+{
+  if (!is_active)
+  {
+    return;
+  }
+  if ((active_ch < 0) || (preempt && (ch < active_ch)))
+  {
+    selectChannel(ch);
+  }
+} /* ScanRx::channelActivityChanged */
+
+
+void ScanRx::squelchStateChanged(bool is_open)
+{
+  if (active_ch < 0)
+  {
+    return;
+  }
+  hang_timer.setEnable(false);
+  if (!is_open)
+  {
+    hang_timer.setEnable(true);
+  }
+} /* ScanRx::squelchStateChanged */
+
+
+void ScanRx::hangTimeout(void)
+{
+  if (squelchIsOpen())
+  {
+    return;
+  }
+
+    // Do not go straight back to the channel just left. It may carry a
+    // signal that the receiver squelch does not accept.
+  int released_ch = active_ch;
+  active_ch = -1;
+  int ch = findActiveChannel(released_ch);
+  if (ch >= 0)
+  {
+    selectChannel(ch);
+  }
+  else
+  {
+    setDemodEnabled(false);
+  }
+} /* ScanRx::hangTimeout */
+
+
+void ScanRx::selectChannel(int ch)
+{
+  active_ch = ch;
+  cout << name() << ": Scanner selected channel " << monitors[ch]->fq()
+       << "Hz\n";
+  setFq(monitors[ch]->fq());
+  setDemodEnabled(true);
+
+    // Go back to scanning if the receiver squelch does not open
+  hang_timer.setEnable(false);
+  hang_timer.setEnable(true);
+} /* ScanRx::selectChannel */
+
+
+int ScanRx::findActiveChannel(int skip_ch) const
+{
+  for (size_t ch=0; ch<monitors.size(); ++ch)
+  {
+    if ((static_cast<int>(ch) != skip_ch) && monitors[ch]->isActive())
+    {
+      return ch;
+    }
+  }
+  return -1;
+} /* ScanRx::findActiveChannel */
+
+
+
+/*
+ * This file has not been truncated
+ */
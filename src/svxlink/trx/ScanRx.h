@@ -0,0 +1,186 @@
+/**
+@file	 ScanRx.h
+@brief   A receiver scanning many channels on one wideband tuner
+@author  Tobias Blomberg / SM0SVX
+@date	 2026-10-15
+
+This file contains a receiver class that scan a list of channels within the
+passband of one wideband tuner and demodulate the channel that is active.
+
+\verbatim
+SvxLink - A Multi Purpose Voice Services System for Ham Radio Use
+Copyright (C) 2004-2026 Tobias Blomberg / SM0SVX
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+\endverbatim
+*/
+
+#ifndef SCAN_RX_INCLUDED
+#define SCAN_RX_INCLUDED
+
+
+/****************************************************************************
+ *
+ * System Includes
+ *
+ ****************************************************************************/
+
+#include <vector>
+
+
+/****************************************************************************
+ *
+ * Project Includes
+ *
+ ****************************************************************************/
+
+#include <AsyncTimer.h>
+
+
+/****************************************************************************
+ *
+ * Local Includes
+ *
+ ****************************************************************************/
+
+#include "Ddr.h"
+
+
+/****************************************************************************
+ *
+ * Forward declarations
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Namespace
+ *
+ ****************************************************************************/
+
+//namespace MyNameSpace
+//{
+
+
+/****************************************************************************
+ *
+ * Forward declarations of classes inside of the declared namespace
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Defines & typedefs
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Exported Global Variables
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Class definitions
+ *
+ ****************************************************************************/
+
+/**
+@brief	A scanning receiver built on a digital drop receiver
+@author Tobias Blomberg / SM0SVX
+@date   2026-10-15
+
+This receiver monitor a list of channels within the passband of one wideband
+tuner. Each channel only get a cheap power squelch working directly on the
+output of the shared polyphase filter bank channelizer. The full channel
+filter, demodulator and audio chain of the underlying DDR is only run for the
+channel that currently is active. When a channel opens the power squelch, the
+DDR is retuned to it and the ordinary squelch of the receiver decide if the
+audio is passed on.
+
+The channels are listed in priority order. When more than one channel is
+active, the one listed first is selected. Optionally, a channel with a higher
+priority may take over from a lower priority channel that is being received.
+*/
+class ScanRx : public Ddr
+{
+  public:
+    /**
+     * @brief 	Default constuctor
+     */
+    explicit ScanRx(Async::Config &cfg, const std::string& name);
+
+    /**
+     * @brief 	Destructor
+     */
+    virtual ~ScanRx(void);
+
+    /**
+     * @brief 	Initialize the receiver object
+     * @return 	Return \em true on success, or \em false on failure
+     */
+    virtual bool initialize(void);
+
+    /**
+     * @brief   Get the frequencies that the tuner need to cover
+     * @param   fqs The frequencies, in Hz, are appended to this vector
+     */
+    virtual void coveredFqs(std::vector<uint32_t>& fqs) const;
+
+    /**
+     * @brief   Tell the receiver that the frequency of the tuner changed
+     * @param   fq The new tuner frequency
+     */
+    virtual void tunerFqChanged(uint32_t fq);
+
+  private:
+    class ChannelMonitor;
+    typedef std::vector<ChannelMonitor*> Monitors;
+
+    Async::Config &cfg;
+    Monitors      monitors;
+    int           active_ch;
+    bool          preempt;
+    Async::Timer  hang_timer;
+
+    ScanRx(const ScanRx&);
+    ScanRx& operator=(const ScanRx&);
+    void channelActivityChanged(int ch, bool is_active);
+    void squelchStateChanged(bool is_open);
+    void hangTimeout(void);
+    void selectChannel(int ch);
+    int findActiveChannel(int skip_ch) const;
+
+};  /* class ScanRx */
+
+
+//} /* namespace */
+
+#endif /* SCAN_RX_INCLUDED */
+
+
+
+/*
+ * This file has not been truncated
+ */
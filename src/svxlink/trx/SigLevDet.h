@@ -194,7 +194,7 @@ class SigLevDet : public sigc::trackable, public Async::AudioSink
      * data frame. If the message type is recognized it will be processed buf
      * if it's not recognized nothing will happen.
      */
-    virtual void frameReceived(std::vector<uint8_t> frame) {}
+    virtual void frameReceived(const std::vector<uint8_t>& frame) {}
 
     /**
      * @brief	A signal that is emitted when the signal strength is updated
@@ -216,7 +216,42 @@ class SigLevDet : public sigc::trackable, public Async::AudioSink
      * file, the update request will be ignored.
      */
     void updateRxId(char rx_id);
-    
+
+    /**
+     * @brief   Calculate the energy of a block of samples
+     * @param   samples The samples
+     * @param   count   The number of samples
+     * @return  Returns the sum of the squared samples
+     *
+     * The samples are accumulated in a number of independent partial sums
+     * so that the compiler can vectorize the loop without relaxing the
+     * floating point rules. A block of complex samples may be given as an
+     * array of twice as many float values.
+     */
+    static double blockEnergy(const float *samples, unsigned count)
+    {
+      static const unsigned LANES = 8;
+      float part[LANES] = {0.0f};
+      unsigned i = 0;
+      for (; i + LANES <= count; i += LANES)
+      {
+        for (unsigned j=0; j<LANES; ++j)
+        {
+          part[j] += samples[i+j] * samples[i+j];
+        }
+      }
+      double energy = 0.0;
+      for (unsigned j=0; j<LANES; ++j)
+      {
+        energy += part[j];
+      }
+      for (; i<count; ++i)
+      {
+        energy += static_cast<double>(samples[i]) * samples[i];
+      }
+      return energy;
+    }
+
   private:
     typedef std::map<std::string, SigLevDet*> DetMap;
 
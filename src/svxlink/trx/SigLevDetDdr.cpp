@@ -35,6 +35,8 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 #include <iostream>
 #include <cstdio>
 #include <cstdlib>
+#include <cmath>
+#include <algorithm>
 
 
 /****************************************************************************
@@ -117,7 +119,7 @@ using namespace Async;
 SigLevDetDdr::SigLevDetDdr(void)
   : sample_rate(0), block_idx(0), last_siglev(0.0f), integration_time(1),
     update_interval(0), update_counter(0), pwr_sum(0.0), slope(1.0),
-    offset(0.0), block_size(0)
+    offset(0.0), block_size(0), siglev_integrated(0.0f)
 {
 } /* SigLevDetDdr::SigLevDetDdr */
 
@@ -144,6 +146,13 @@ bool SigLevDetDdr::initialize(Config &cfg, const string& name, int sample_rate)
   cfg.getValue(name, "SIGLEV_SLOPE", slope);
 
   block_size = BLOCK_LENGTH * sample_rate / 1000;
+  cfg.getValue(name, "SIGLEV_BLOCK_SAMPLES", block_size);
+  if (block_size == 0)
+  {
+    cerr << "*** ERROR: " << name << "/SIGLEV_BLOCK_SAMPLES must be "
+            "larger than zero\n";
+    return false;
+  }
 
   reset();
 
@@ -159,6 +168,7 @@ void SigLevDetDdr::reset(void)
   update_counter = 0;
   siglev_values.clear();
   pwr_sum = 0.0;
+  siglev_integrated = 0.0f;
 } /* SigLevDetDdr::reset */
 
 
@@ -173,7 +183,7 @@ void SigLevDetDdr::setIntegrationTime(int time_ms)
 {
     // Calculate the integration time expressed as the
     // number of processing blocks.
-  integration_time = time_ms * 16000 / 1000 / block_size;
+  integration_time = max(0, time_ms) * sample_rate / 1000 / block_size;
   if (integration_time <= 0)
   {
     integration_time = 1;
@@ -181,22 +191,6 @@ void SigLevDetDdr::setIntegrationTime(int time_ms)
 } /* SigLevDetDdr::setIntegrationTime */
 
 
-float SigLevDetDdr::siglevIntegrated(void) const
-{
-  if (siglev_values.size() > 0)
-  {
-    float sum = 0;
-    deque<float>::const_iterator it;
-    for (it=siglev_values.begin(); it!=siglev_values.end(); ++it)
-    {
-      sum += *it;
-    }
-    return sum / siglev_values.size();
-  }
-  return 0;
-} /* SigLevDetDdr::siglevIntegrated */
-
-
 
 /****************************************************************************
  *
@@ -214,38 +208,60 @@ float SigLevDetDdr::siglevIntegrated(void) const
 
 void SigLevDetDdr::processSamples(const vector<RtlTcp::Sample> &samples)
 {
-  for (vector<RtlTcp::Sample>::const_iterator it = samples.begin();
-       it != samples.end();
-       ++it)
+    // Process the samples in chunks ending at the block boundaries. The
+    // complex samples are handled as an array of interleaved I and Q values
+    // so that the power estimation can be vectorized.
+  const float *iq = reinterpret_cast<const float*>(samples.data());
+  size_t pos = 0;
+  while (pos < samples.size())
   {
-    pwr_sum += it->real() * it->real() + it->imag() * it->imag();
-    if (++block_idx == block_size)
+    unsigned len = min(samples.size() - pos,
+                       static_cast<size_t>(block_size - block_idx));
+    pwr_sum += blockEnergy(iq + 2 * pos, 2 * len);
+    block_idx += len;
+    pos += len;
+    if (block_idx >= block_size)
     {
-      last_siglev = offset + slope * 10.0 * log10(pwr_sum / block_size);
-      siglev_values.push_back(last_siglev);
-      if (siglev_values.size() > integration_time)
-      {
-	siglev_values.erase(siglev_values.begin(),
-		siglev_values.begin()+siglev_values.size()-integration_time);
-      }
-      
-      if (update_interval > 0)
-      {
-	update_counter += block_size;
-	if (update_counter >= update_interval)
-	{
-	  signalLevelUpdated(siglevIntegrated());
-	  update_counter = 0;
-	}
-      }
-
-      block_idx = 0;
-      pwr_sum = 0.0;
+      blockDone();
     }
   }
 } /* SigLevDetDdr::processSamples */
 
 
+void SigLevDetDdr::blockDone(void)
+{
+  last_siglev = offset + slope * 10.0 * log10(pwr_sum / block_size);
+  siglev_values.push_back(last_siglev);
+  if (siglev_values.size() > integration_time)
+  {
+    siglev_values.erase(siglev_values.begin(),
+        siglev_values.begin()+siglev_values.size()-integration_time);
+  }
+
+    // Calculate the integrated value once per block so that it can be read
+    // by both the squelch and the signal level reporting
+  float sum = 0.0f;
+  for (deque<float>::const_iterator it=siglev_values.begin();
+       it!=siglev_values.end(); ++it)
+  {
+    sum += *it;
+  }
+  siglev_integrated = sum / siglev_values.size();
+
+  if (update_interval > 0)
+  {
+    update_counter += block_size;
+    if (update_counter >= update_interval)
+    {
+      signalLevelUpdated(siglevIntegrated());
+      update_counter = 0;
+    }
+  }
+  block_idx = 0;
+  pwr_sum = 0.0;
+} /* SigLevDetDdr::blockDone */
+
+
 
 /*
  * This file has not been truncated
@@ -169,7 +169,7 @@ class SigLevDetDdr : public SigLevDet
      * @brief   Read the integrated siglev value
      * @return  Returns the integrated siglev value
      */
-    virtual float siglevIntegrated(void) const;
+    virtual float siglevIntegrated(void) const { return siglev_integrated; }
 
     /**
      * @brief   Reset the signal level detector
@@ -195,9 +195,11 @@ class SigLevDetDdr : public SigLevDet
     double     	        slope;
     double     	        offset;
     unsigned            block_size;
+    float               siglev_integrated;
     
     SigLevDetDdr(const SigLevDetDdr&);
     SigLevDetDdr& operator=(const SigLevDetDdr&);
+    void blockDone(void);
     void processSamples(const std::vector<RtlTcp::Sample> &samples);
     
 };  /* class SigLevDetDdr */
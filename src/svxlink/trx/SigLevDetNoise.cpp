@@ -34,7 +34,8 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 
 #include <cmath>
 #include <limits>
-//#include <iostream>
+#include <iostream>
+#include <algorithm>
 
 
 /****************************************************************************
@@ -120,7 +121,8 @@ SigLevDetNoise::SigLevDetNoise(void)
   : sample_rate(0), block_len(0), filter(0), sigc_sink(0),
     slope(10.0), offset(0.0), update_interval(0), update_counter(0),
     integration_time(0), ss(0.0), ss_cnt(0),
-    bogus_thresh(numeric_limits<float>::max())
+    bogus_thresh(numeric_limits<float>::max()), last_siglev(0.0f),
+    siglev_integrated(0.0f)
 {
 } /* SigLevDetNoise::SigLevDetNoise */
 
@@ -138,6 +140,13 @@ bool SigLevDetNoise::initialize(Config &cfg, const string& name,
 {
   this->sample_rate = sample_rate;
   block_len = BLOCK_TIME * sample_rate / 1000;
+  cfg.getValue(name, "SIGLEV_BLOCK_SAMPLES", block_len);
+  if (block_len == 0)
+  {
+    cerr << "*** ERROR: " << name << "/SIGLEV_BLOCK_SAMPLES must be "
+            "larger than zero\n";
+    return false;
+  }
   if (sample_rate >= 16000)
   {
     filter = new AudioFilter("BpBu4/5000-5500", sample_rate);
@@ -183,6 +192,7 @@ void SigLevDetNoise::setDetectorOffset(float offset)
 void SigLevDetNoise::setBogusThresh(float thresh)
 {
   bogus_thresh = thresh;
+  updateSiglev();
 } /* SigLevDetNoise::setBogusThresh */
 
 
@@ -195,74 +205,21 @@ void SigLevDetNoise::setContinuousUpdateInterval(int interval_ms)
 
 void SigLevDetNoise::setIntegrationTime(int time_ms)
 {
-  if (time_ms < static_cast<int>(BLOCK_TIME))
+  integration_time = max(0, time_ms) * sample_rate / 1000;
+  if (integration_time < block_len)
   {
-    time_ms = BLOCK_TIME;
+    integration_time = block_len;
   }
-  integration_time = time_ms * sample_rate / 1000;
 
   while (ss_idx.size() > integration_time / block_len)
   {
     ss_values.erase(*ss_idx.begin());
     ss_idx.pop_front();
   }
+  updateSiglev();
 } /* SigLevDetNoise::setIntegrationTime */
 
 
-float SigLevDetNoise::lastSiglev(void) const
-{
-  if (ss_idx.empty())
-  {
-    return 0.0f;
-  }
-
-    // Calculate the siglev value
-  float siglev = offset - slope * log10(*ss_idx.back());
-
-    // If the siglev value is way above 100 (like 120), it's probably bogus.
-    // It's likely that this is caused by a closed squelch on the receiver or
-    // that it has been turned off.
-  if (siglev > bogus_thresh)
-  {
-    return 0.0f;
-  }
-
-  return offset - slope * log10(*ss_idx.back());
-
-} /* SigLevDetNoise::lastSiglev */
-
-
-float SigLevDetNoise::siglevIntegrated(void) const
-{
-  if (ss_values.empty())
-  {
-    return 0.0f;
-  }
-
-    // Calculate the siglev value.
-    // Compensate for the over estimation of the siglev value caused by
-    // using the minimum value over the "integration time".
-    // The over estimation have been determined by a small number of
-    // experiments so it may be wrong for some receivers.
-    // The compensation may have to be determined for each receiver using
-    // calibration but we'll try to have it hard coded for now.
-    // If the BLOCK_TIME is changed, the compensation probably will have to
-    // be changed too.
-  float siglev = offset - slope * (log10(*ss_values.begin()) + 0.25);
-
-    // If the siglev value is way above 100 (like 120), it's probably bogus.
-    // It's likely that this is caused by a closed squelch on the receiver or
-    // that it has been turned off.
-  if (siglev > bogus_thresh)
-  {
-    return 0.0f;
-  }
-
-  return siglev;
-
-} /* SigLevDetNoise::siglevIntegrated */
-
-
 void SigLevDetNoise::reset(void)
 {
   filter->reset();
@@ -271,6 +228,7 @@ void SigLevDetNoise::reset(void)
   ss_idx.clear();
   ss_cnt = 0;
   ss = 0.0;
+  updateSiglev();
 } /* SigLevDetNoise::reset */
 
 
@@ -291,22 +249,18 @@ void SigLevDetNoise::reset(void)
 
 int SigLevDetNoise::processSamples(float *samples, int count)
 {
-  for (int i=0; i<count; ++i)
+    // Process the samples in chunks ending at the block boundaries so that
+    // the energy calculation can run over contiguous memory
+  int pos = 0;
+  while (pos < count)
   {
-    const float &sample = samples[i];
-    ss += static_cast<double>(sample) * sample;
-    if (++ss_cnt >= block_len)
+    unsigned len = min(static_cast<unsigned>(count - pos), block_len - ss_cnt);
+    ss += blockEnergy(samples + pos, len);
+    ss_cnt += len;
+    pos += len;
+    if (ss_cnt >= block_len)
     {
-      SsSetIter it = ss_values.insert(ss);
-      ss_idx.push_back(it);
-      if (ss_idx.size() > integration_time / block_len)
-      {
-        ss_values.erase(*ss_idx.begin());
-        ss_idx.pop_front();
-      }
-
-      ss = 0.0;
-      ss_cnt = 0;
+      blockDone();
     }
   }
 
@@ -325,6 +279,59 @@ int SigLevDetNoise::processSamples(float *samples, int count)
 } /* SigLevDetNoise::processSamples */
 
 
+void SigLevDetNoise::blockDone(void)
+{
+  SsSetIter it = ss_values.insert(ss);
+  ss_idx.push_back(it);
+  if (ss_idx.size() > integration_time / block_len)
+  {
+    ss_values.erase(*ss_idx.begin());
+    ss_idx.pop_front();
+  }
+  ss = 0.0;
+  ss_cnt = 0;
+
+  updateSiglev();
+} /* SigLevDetNoise::blockDone */
+
+
+void SigLevDetNoise::updateSiglev(void)
+{
+  last_siglev = 0.0f;
+  siglev_integrated = 0.0f;
+  if (ss_idx.empty())
+  {
+    return;
+  }
+
+    // Calculate the siglev value
+  float siglev = offset - slope * log10(*ss_idx.back());
+
+    // If the siglev value is way above 100 (like 120), it's probably bogus.
+    // It's likely that this is caused by a closed squelch on the receiver or
+    // that it has been turned off.
+  if (siglev <= bogus_thresh)
+  {
+    last_siglev = siglev;
+  }
+
+    // Calculate the integrated siglev value.
+    // Compensate for the over estimation of the siglev value caused by
+    // using the minimum value over the "integration time".
+    // The over estimation have been determined by a small number of
+    // experiments so it may be wrong for some receivers.
+    // The compensation may have to be determined for each receiver using
+    // calibration but we'll try to have it hard coded for now.
+    // If the block length is changed, the compensation probably will have to
+    // be changed too.
+  siglev = offset - slope * (log10(*ss_values.begin()) + 0.25);
+  if (siglev <= bogus_thresh)
+  {
+    siglev_integrated = siglev;
+  }
+} /* SigLevDetNoise::updateSiglev */
+
+
 
 /*
  * This file has not been truncated
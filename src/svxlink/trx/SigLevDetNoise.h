@@ -191,13 +191,13 @@ class SigLevDetNoise : public SigLevDet
      * @brief 	Read the latest calculated signal level
      * @return	Returns the latest calculated signal level
      */
-    virtual float lastSiglev(void) const;
+    virtual float lastSiglev(void) const { return last_siglev; }
      
     /**
      * @brief   Read the integrated siglev value
      * @return  Returns the integrated siglev value
      */
-    virtual float siglevIntegrated(void) const;
+    virtual float siglevIntegrated(void) const { return siglev_integrated; }
     
     /**
      * @brief   Reset the signal level detector
@@ -228,10 +228,14 @@ class SigLevDetNoise : public SigLevDet
     double                    ss;
     unsigned                  ss_cnt;
     float                     bogus_thresh;
+    float                     last_siglev;
+    float                     siglev_integrated;
     
     SigLevDetNoise(const SigLevDetNoise&);
     SigLevDetNoise& operator=(const SigLevDetNoise&);
     int processSamples(float *samples, int count);
+    void blockDone(void);
+    void updateSiglev(void);
     
 };  /* class SigLevDetNoise */
 
@@ -31,6 +31,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
  ****************************************************************************/
 
 #include <cstdlib>
+#include <algorithm>
 
 
 /****************************************************************************
@@ -113,7 +114,7 @@ SigLevDetSim::SigLevDetSim(void)
     update_interval(0), update_counter(0), siglev_toggle_interval(0),
     siglev_toggle_counter(0), siglev_rand_interval(0), siglev_rand_counter(0),
     block_size(0), siglev_min(0.0f), siglev_max(100.0f), siglev_default(0.0f),
-    seed(next_seed++)
+    prng(next_seed++)
 {
 } /* SigLevDetSim::SigLevDetSim */
 
@@ -202,11 +203,33 @@ float SigLevDetSim::siglevIntegrated(void) const
 
 int SigLevDetSim::writeSamples(const float *samples, int count)
 {
-  for (int i=0; i<count; ++i)
+    // The samples are not looked at so instead of stepping all counters
+    // for each sample, jump directly to the next sample where something
+    // is going to happen. This make the simulated detector almost free to
+    // run, even for a large number of simulated receivers.
+  unsigned left = count;
+  while (left > 0)
   {
+    unsigned step = std::min(left, samplesUntil(block_idx, block_size));
     if (siglev_rand_interval > 0)
     {
-      if (++siglev_rand_counter >= siglev_rand_interval)
+      step = std::min(step,
+          samplesUntil(siglev_rand_counter, siglev_rand_interval));
+    }
+    if (siglev_toggle_interval > 0)
+    {
+      step = std::min(step,
+          samplesUntil(siglev_toggle_counter, siglev_toggle_interval));
+    }
+    if (update_interval > 0)
+    {
+      step = std::min(step, samplesUntil(update_counter, update_interval));
+    }
+    left -= step;
+
+    if (siglev_rand_interval > 0)
+    {
+      if ((siglev_rand_counter += step) >= siglev_rand_interval)
       {
         siglev_rand_counter = 0;
         randNewSiglev();
@@ -215,14 +238,14 @@ int SigLevDetSim::writeSamples(const float *samples, int count)
 
     if (siglev_toggle_interval > 0)
     {
-      if (++siglev_toggle_counter >= siglev_toggle_interval)
+      if ((siglev_toggle_counter += step) >= siglev_toggle_interval)
       {
         siglev_toggle_counter = 0;
         toggleSiglev();
       }
     }
 
-    if (++block_idx == block_size)
+    if ((block_idx += step) >= block_size)
     {
       block_idx = 0;
       siglev_values.push_back(last_siglev);
@@ -235,7 +258,7 @@ int SigLevDetSim::writeSamples(const float *samples, int count)
 
     if (update_interval > 0)
     {
-      if (++update_counter >= update_interval)
+      if ((update_counter += step) >= update_interval)
       {
         update_counter = 0;
         signalLevelUpdated(siglevIntegrated());
@@ -255,7 +278,7 @@ int SigLevDetSim::writeSamples(const float *samples, int count)
 
 void SigLevDetSim::randNewSiglev(void)
 {
-  if ((rand_r(&seed) > RAND_MAX/2) && (last_siglev < siglev_max))
+  if ((prng.next() & 0x80000000U) && (last_siglev < siglev_max))
   {
     last_siglev += 1.0f;
   }
@@ -266,6 +289,12 @@ void SigLevDetSim::randNewSiglev(void)
 } /* SigLevDetSim::randNewSiglev */
 
 
+unsigned SigLevDetSim::samplesUntil(unsigned counter, unsigned interval)
+{
+  return (counter < interval) ? interval - counter : 1;
+} /* SigLevDetSim::samplesUntil */
+
+
 void SigLevDetSim::toggleSiglev(void)
 {
   if (last_siglev == siglev_min)
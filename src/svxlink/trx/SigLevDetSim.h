@@ -43,6 +43,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
  *
  ****************************************************************************/
 
+#include <AsyncPrng.h>
 
 
 /****************************************************************************
@@ -196,12 +197,13 @@ class SigLevDetSim : public SigLevDet
     float               siglev_min;
     float               siglev_max;
     float               siglev_default;
-    unsigned int        seed;
+    Async::Prng         prng;
     
     SigLevDetSim(const SigLevDetSim&);
     SigLevDetSim& operator=(const SigLevDetSim&);
     void randNewSiglev(void);
     void toggleSiglev(void);
+    static unsigned samplesUntil(unsigned counter, unsigned interval);
     
 };  /* class SigLevDetSim */
 
@@ -0,0 +1,270 @@
+/**
+@file	 SpectrumTap.cpp
+@brief   Calculate an averaged power spectrum from an I/Q stream
+@author  Tobias Blomberg / SM0SVX
+@date	 2026-10-14
+
+\verbatim
+SvxLink - A Multi Purpose Voice Services System for Ham Radio Use
+Copyright (C) 2003-2026 Tobias Blomberg / SM0SVX
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+\endverbatim
+*/
+
+
+
+/****************************************************************************
+ *
+ * System Includes
+ *
+ ****************************************************************************/
+
+#include <cassert>
+#include <cmath>
+#include <algorithm>
+
+
+/****************************************************************************
+ *
+ * Project Includes
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Local Includes
+ *
+ ****************************************************************************/
+
+#include "SpectrumTap.h"
+
+
+
+/****************************************************************************
+ *
+ * Namespaces to use
+ *
+ ****************************************************************************/
+
+using namespace std;
+
+
+
+/****************************************************************************
+ *
+ * Defines & typedefs
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Local class definitions
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Prototypes
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Exported Global Variables
+ *
+ ****************************************************************************/
+
+
+
+
+/****************************************************************************
+ *
+ * Local Global Variables
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Public member functions
+ *
+ ****************************************************************************/
+
+bool SpectrumTap::isValidFftSize(unsigned fft_size)
+{
+  return (fft_size >= 16) && (fft_size <= 65536) &&
+         ((fft_size & (fft_size - 1)) == 0);
+} /* SpectrumTap::isValidFftSize */
+
+
+SpectrumTap::SpectrumTap(unsigned samp_rate, unsigned fft_size,
+                         unsigned frame_rate, unsigned averages)
+  : m_fft_size(fft_size), m_averages(max(averages, 1U)), m_skip_cnt(0),
+    m_fill(0), m_skip(0), m_avg_cnt(0), m_scale(1.0f)
+{
+  assert(isValidFftSize(fft_size));
+
+    // Spread the FFT blocks evenly in time. If the blocks do not fit, they
+    // are taken back to back and the frame rate will be lower than asked for.
+  unsigned hop = samp_rate / (max(frame_rate, 1U) * m_averages);
+  m_skip_cnt = (hop > m_fft_size) ? (hop - m_fft_size) : 0;
+
+    // Hann window, normalized so that a full scale sine wave give 0dB
+  m_window.resize(m_fft_size);
+  double wsum = 0.0;
+  for (unsigned i=0; i<m_fft_size; ++i)
+  {
+    m_window[i] = 0.5 - 0.5 * cos(2.0 * M_PI * i / m_fft_size);
+    wsum += m_window[i];
+  }
+  m_scale = 1.0 / (wsum * wsum * m_averages);
+
+  m_twiddles.resize(m_fft_size / 2);
+  for (unsigned i=0; i<m_fft_size/2; ++i)
+  {
+    m_twiddles[i] = polar(1.0f, static_cast<float>(-2.0 * M_PI * i /
+                                                   m_fft_size));
+  }
+
+  unsigned bits = 0;
+  while ((1U << bits) < m_fft_size)
+  {
+    ++bits;
+  }
+  m_bitrev.resize(m_fft_size);
+  for (unsigned i=0; i<m_fft_size; ++i)
+  {
+    unsigned r = 0;
+    for (unsigned b=0; b<bits; ++b)
+    {
+      r |= ((i >> b) & 1) << (bits - 1 - b);
+    }
+    m_bitrev[i] = r;
+  }
+
+  m_buf.resize(m_fft_size);
+  m_power.assign(m_fft_size, 0.0f);
+  m_frame.resize(m_fft_size);
+} /* SpectrumTap::SpectrumTap */
+
+
+SpectrumTap::~SpectrumTap(void)
+{
+} /* SpectrumTap::~SpectrumTap */
+
+
+void SpectrumTap::iqReceived(const std::vector<Sample>& samples)
+{
+  size_t idx = 0;
+  while (idx < samples.size())
+  {
+    size_t left = samples.size() - idx;
+    if (m_skip > 0)
+    {
+      size_t adv = min(static_cast<size_t>(m_skip), left);
+      m_skip -= adv;
+      idx += adv;
+      continue;
+    }
+
+      // Store the samples in bit reversed order, ready for the FFT
+    size_t cnt = min(static_cast<size_t>(m_fft_size - m_fill), left);
+    for (size_t i=0; i<cnt; ++i)
+    {
+      m_buf[m_bitrev[m_fill]] = samples[idx+i] * m_window[m_fill];
+      ++m_fill;
+    }
+    idx += cnt;
+
+    if (m_fill == m_fft_size)
+    {
+      processBlock();
+      m_fill = 0;
+      m_skip = m_skip_cnt;
+    }
+  }
+} /* SpectrumTap::iqReceived */
+
+
+
+/****************************************************************************
+ *
+ * Protected member functions
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Private member functions
+ *
+ ****************************************************************************/
+
+void SpectrumTap::processBlock(void)
+{
+    // Iterative radix-2 decimation in time FFT
+  for (unsigned len=2; len<=m_fft_size; len<<=1)
+  {
+    unsigned half = len / 2;
+    unsigned tw_step = m_fft_size / len;
+    for (unsigned start=0; start<m_fft_size; start+=len)
+    {
+      for (unsigned k=0; k<half; ++k)
+      {
+        Sample t = m_twiddles[k * tw_step] * m_buf[start + k + half];
+        m_buf[start + k + half] = m_buf[start + k] - t;
+        m_buf[start + k] += t;
+      }
+    }
+  }
+
+  for (unsigned i=0; i<m_fft_size; ++i)
+  {
+    m_power[i] += norm(m_buf[i]);
+  }
+
+  if (++m_avg_cnt < m_averages)
+  {
+    return;
+  }
+
+    // Reorder so that the lowest frequency come first and convert to dB
+  unsigned half = m_fft_size / 2;
+  for (unsigned i=0; i<m_fft_size; ++i)
+  {
+    float p = m_power[(i + half) % m_fft_size] * m_scale;
+    m_frame[i] = 10.0f * log10f(p + 1.0e-20f);
+  }
+  m_power.assign(m_fft_size, 0.0f);
+  m_avg_cnt = 0;
+  frameReady(m_frame);
+} /* SpectrumTap::processBlock */
+
+
+
+/*
+ * This file has not been truncated
+ */
@@ -0,0 +1,200 @@
+/**
+@file	 SpectrumTap.h
+@brief   Calculate an averaged power spectrum from an I/Q stream
+@author  Tobias Blomberg / SM0SVX
+@date	 2026-10-14
+
+\verbatim
+SvxLink - A Multi Purpose Voice Services System for Ham Radio Use
+Copyright (C) 2003-2026 Tobias Blomberg / SM0SVX
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+\endverbatim
+*/
+
+#ifndef SPECTRUM_TAP_INCLUDED
+#define SPECTRUM_TAP_INCLUDED
+
+
+/****************************************************************************
+ *
+ * System Includes
+ *
+ ****************************************************************************/
+
+#include <sigc++/sigc++.h>
+
+#include <vector>
+#include <complex>
+
+
+/****************************************************************************
+ *
+ * Project Includes
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Local Includes
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Forward declarations
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Namespace
+ *
+ ****************************************************************************/
+
+//namespace MyNameSpace
+//{
+
+
+/****************************************************************************
+ *
+ * Forward declarations of classes inside of the declared namespace
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Defines & typedefs
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Exported Global Variables
+ *
+ ****************************************************************************/
+
+
+
+/****************************************************************************
+ *
+ * Class definitions
+ *
+ ****************************************************************************/
+
+/**
+@brief	Calculate an averaged power spectrum from an I/Q stream
+@author Tobias Blomberg / SM0SVX
+@date   2026-10-14
+
+This class is used to get a low rate spectrum view of a tuner, for example
+to look for interference on the receiver frequencies. A windowed FFT is
+calculated over a block of samples now and then, not over all samples. A
+number of such FFT:s are averaged into each emitted frame so the cost is
+just a few small FFT:s each second, no matter what the sampling rate is.
+
+The input can be the wideband signal from a tuner or the output from one
+bin of a PfbChannelizer, for a zoomed in view of a part of the band.
+*/
+class SpectrumTap
+{
+  public:
+    typedef std::complex<float> Sample;
+
+    /**
+     * @brief   Check if an FFT size is supported
+     * @param   fft_size The FFT size
+     * @returns Returns \em true if the size is a power of two in 16-65536
+     */
+    static bool isValidFftSize(unsigned fft_size);
+
+    /**
+     * @brief 	Constructor
+     * @param   samp_rate   The sampling rate of the input signal
+     * @param   fft_size    The FFT size, which is the number of bins
+     * @param   frame_rate  The number of frames to emit each second
+     * @param   averages    The number of FFT:s to average in each frame
+     */
+    SpectrumTap(unsigned samp_rate, unsigned fft_size, unsigned frame_rate,
+                unsigned averages=4);
+
+    /**
+     * @brief 	Destructor
+     */
+    ~SpectrumTap(void);
+
+    /**
+     * @brief   Get the FFT size
+     * @returns Returns the number of bins in each frame
+     */
+    unsigned fftSize(void) const { return m_fft_size; }
+
+    /**
+     * @brief   Process samples
+     * @param   samples The input samples
+     */
+    void iqReceived(const std::vector<Sample>& samples);
+
+    /**
+     * @brief   A signal that is emitted when a new frame is ready
+     * @param   power The power in each bin in dBFS
+     *
+     * The first bin is the lowest frequency, at minus half the sampling
+     * rate, and the center bin is the center frequency. A full scale sine
+     * wave give 0dB.
+     */
+    sigc::signal<void(const std::vector<float>&)> frameReady;
+
+  private:
+    unsigned              m_fft_size;
+    unsigned              m_averages;
+    unsigned              m_skip_cnt;
+    std::vector<float>    m_window;
+    std::vector<Sample>   m_twiddles;
+    std::vector<unsigned> m_bitrev;
+    std::vector<Sample>   m_buf;
+    std::vector<float>    m_power;
+    std::vector<float>    m_frame;
+    unsigned              m_fill;
+    unsigned              m_skip;
+    unsigned              m_avg_cnt;
+    float                 m_scale;
+
+    SpectrumTap(const SpectrumTap&);
+    SpectrumTap& operator=(const SpectrumTap&);
+    void processBlock(void);
+
+};  /* class SpectrumTap */
+
+
+//} /* namespace */
+
+#endif /* SPECTRUM_TAP_INCLUDED */
+
+
+
+/*
+ * This file has not been truncated
+ */
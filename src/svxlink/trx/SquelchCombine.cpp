@@ -33,6 +33,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 #include <iostream>
 #include <iterator>
 #include <set>
+#include <algorithm>
 
 
 /****************************************************************************
@@ -75,43 +76,22 @@ using namespace std;
  *
  ****************************************************************************/
 
-class SquelchCombine::Node
+class SquelchCombine::SubSquelch
 {
   public:
-    typedef std::set<std::string> SquelchStates;
-    Node(const std::string& name) : m_name(name) {}
-    virtual ~Node(void) {}
-    const std::string name(void) const { return m_name; }
-    virtual void print(std::ostream& os) = 0;
-    virtual bool initialize(Async::Config& cfg) = 0;
-    virtual void reset(void) = 0;
-    virtual void restart(void) = 0;
-    virtual void processSamples(const float *samples, int count) = 0;
-    virtual bool isOpen(void) const = 0;
-    virtual std::string activityInfo(void) const = 0;
-    virtual SquelchStates& squelchStates(SquelchStates& states) = 0;
-    sigc::signal<void(bool)> squelchOpen;
-    sigc::signal<void(float)> toneDetected;
+    SubSquelch(const std::string& name) : m_name(name) {}
 
-  private:
-    std::string m_name;
-}; /* SquelchCombine::Node */
-
-
-class SquelchCombine::LeafNode : public SquelchCombine::Node
-{
-  public:
-    LeafNode(const std::string n) : Node(n) {}
-
-    virtual ~LeafNode(void)
+    ~SubSquelch(void)
     {
       delete m_squelch;
       m_squelch = nullptr;
     }
 
-    virtual void print(std::ostream& os) { os << name(); }
+    const std::string& name(void) const { return m_name; }
+
+    Squelch* squelch(void) { return m_squelch; }
 
-    virtual bool initialize(Async::Config& cfg)
+    bool initialize(Async::Config& cfg)
     {
       string sql_det_str;
       if (!cfg.getValue(name(), "SQL_DET", sql_det_str))
@@ -126,14 +106,12 @@ class SquelchCombine::LeafNode : public SquelchCombine::Node
                   << name() << "\"\n";
         return false;
       }
-      m_squelch->squelchOpen.connect(squelchOpen.make_slot());
-      m_squelch->toneDetected.connect(toneDetected.make_slot());
       return true;
     }
 
-    virtual bool isOpen(void) const { return m_squelch->isOpen(); }
+    bool isOpen(void) const { return m_squelch->isOpen(); }
 
-    virtual std::string activityInfo(void) const
+    std::string activityInfo(void) const
     {
       std::string act_info = name();
       if (m_squelch->isOpen())
@@ -151,15 +129,11 @@ class SquelchCombine::LeafNode : public SquelchCombine::Node
       return act_info;
     }
 
-    virtual void reset(void) { m_squelch->reset(); }
-
-    virtual void restart(void) { m_squelch->restart(); }
-
-    virtual void processSamples(const float *samples, int count)
+    void processSamples(const float *samples, int count)
     {
       int pos = 0;
       do {
-        int ret = m_squelch->writeSamples(samples, count);
+        int ret = m_squelch->writeSamples(samples + pos, count - pos);
         if (ret < 1)
         {
           std::cout << "*** WARNING: Failed to write samples to squelch "
@@ -171,180 +145,10 @@ class SquelchCombine::LeafNode : public SquelchCombine::Node
       } while (pos < count);
     }
 
-    virtual SquelchStates& squelchStates(SquelchStates& states)
-    {
-      states.emplace(activityInfo());
-      return states;
-    }
-
   private:
-    Squelch* m_squelch = nullptr;
-}; /* SquelchCombine::LeafNode */
-
-
-class SquelchCombine::UnaryOpNode : public SquelchCombine::Node
-{
-  public:
-    UnaryOpNode(const std::string& name, Node *node)
-      : Node(name), m_node(node)
-    {
-      m_node->squelchOpen.connect(squelchOpen.make_slot());
-      m_node->toneDetected.connect(toneDetected.make_slot());
-    }
-
-    virtual ~UnaryOpNode(void)
-    {
-      delete m_node;
-      m_node = nullptr;
-    }
-
-    virtual void print(std::ostream& os)
-    {
-      os << name() << "(";
-      m_node->print(os);
-      os << ")";
-    }
-
-    virtual bool initialize(Async::Config& cfg)
-    {
-      return m_node->initialize(cfg);
-    }
-
-    virtual void reset(void)
-    {
-      m_node->reset();
-    }
-
-    virtual void restart(void)
-    {
-      m_node->restart();
-    }
-
-    virtual void processSamples(const float *samples, int count)
-    {
-      m_node->processSamples(samples, count);
-    }
-
-    virtual SquelchStates& squelchStates(SquelchStates& states)
-    {
-      return m_node->squelchStates(states);
-    }
-
-    virtual std::string activityInfo(void) const
-    {
-      return name() + "(" + m_node->activityInfo() + ")";
-    }
-
-  protected:
-    Node* m_node;
-}; /* SquelchCombine::UnaryOpNode */
-
-
-struct SquelchCombine::NegationOpNode : public SquelchCombine::UnaryOpNode
-{
-  NegationOpNode(Node* node) : UnaryOpNode("NOT", node) {}
-  virtual bool isOpen(void) const { return !m_node->isOpen(); }
-}; /* SquelchCombine::NegationOpNode */
-
-
-class SquelchCombine::BinaryOpNode : public SquelchCombine::Node
-{
-  public:
-    BinaryOpNode(const std::string& n, Node* l, Node* r)
-      : Node(n), m_left(l), m_right(r)
-    {
-      m_left->squelchOpen.connect(
-          sigc::mem_fun(*this, &BinaryOpNode::onSquelchOpen));
-      m_left->toneDetected.connect(toneDetected.make_slot());
-      m_right->squelchOpen.connect(
-          sigc::mem_fun(*this, &BinaryOpNode::onSquelchOpen));
-      m_right->toneDetected.connect(toneDetected.make_slot());
-    }
-
-    virtual ~BinaryOpNode(void)
-    {
-      delete m_left;
-      m_left = nullptr;
-      delete m_right;
-      m_right = nullptr;
-    }
-
-    virtual void print(std::ostream& os)
-    {
-      os << name() << "(";
-      m_left->print(os);
-      os << ", ";
-      m_right->print(os);
-      os << ")";
-    }
-
-    virtual bool initialize(Async::Config& cfg)
-    {
-      return m_left->initialize(cfg) && m_right->initialize(cfg);
-    }
-
-    virtual void reset(void)
-    {
-      m_left->reset();
-      m_right->reset();
-    }
-
-    virtual void restart(void)
-    {
-      m_left->restart();
-      m_right->restart();
-    }
-
-    virtual void processSamples(const float *samples, int count)
-    {
-      m_left->processSamples(samples, count);
-      m_right->processSamples(samples, count);
-    }
-
-    void onSquelchOpen(bool is_open)
-    {
-      squelchOpen(isOpen());
-    }
-
-    virtual SquelchStates& squelchStates(SquelchStates& states)
-    {
-      m_left->squelchStates(states);
-      m_right->squelchStates(states);
-      return states;
-    }
-
-    virtual std::string activityInfo(void) const
-    {
-      return name() + "(" + m_left->activityInfo() + ", " +
-             m_right->activityInfo() + ")";
-    }
-
-  protected:
-    Node* m_left;
-    Node* m_right;
-}; /* SquelchCombine::BinaryOpNode */
-
-
-struct SquelchCombine::OrOpNode : public SquelchCombine::BinaryOpNode
-{
-  OrOpNode(Node* l, Node* r) : BinaryOpNode("OR", l, r) {}
-
-  virtual bool isOpen(void) const
-  {
-    return m_left->isOpen() || m_right->isOpen();
-  }
-}; /* SquelchCombine::OrOpNode */
-
-
-struct SquelchCombine::AndOpNode : public SquelchCombine::BinaryOpNode
-{
-  AndOpNode(Node* l, Node* r) : BinaryOpNode("AND", l, r) {}
-
-  virtual bool isOpen(void) const
-  {
-    return m_left->isOpen() && m_right->isOpen();
-  }
-}; /* SquelchCombine::AndOpNode */
+    std::string m_name;
+    Squelch*    m_squelch = nullptr;
+}; /* SquelchCombine::SubSquelch */
 
 
 /****************************************************************************
@@ -385,7 +189,11 @@ SquelchCombine::SquelchCombine(void)
 
 SquelchCombine::~SquelchCombine(void)
 {
-  delete m_comb;
+  for (auto sub : m_subs)
+  {
+    delete sub;
+  }
+  m_subs.clear();
 } /* SquelchCombine::~SquelchCombine */
 
 
@@ -405,46 +213,63 @@ bool SquelchCombine::initialize(Async::Config& cfg,
     return false;
   }
 
-  m_comb = parseExpression();
-  if (!m_tokens.empty())
+  std::string desc;
+  bool parse_ok = parseExpression(desc);
+  if (parse_ok && !m_tokens.empty())
   {
     std::cout << "*** ERROR: Unparsed extra tokens in malformed squelch "
                  "combiner expression: ";
     copy(m_tokens.begin(), m_tokens.end(),
         std::ostream_iterator<std::string>(std::cout, " "));
     std::cout << std::endl;
-    delete m_comb;
-    m_comb = nullptr;
+    parse_ok = false;
   }
-  if (m_comb == nullptr)
+  if (!parse_ok)
   {
     std::cout << "*** ERROR: Failed to create combined squelch for RX \""
               << rx_name << "\"" << std::endl;
     return false;
   }
 
-  std::cout << rx_name << ": Combined squelch structure is ";
-  m_comb->print(std::cout);
-  std::cout << std::endl;
+  std::cout << rx_name << ": Combined squelch structure is " << desc
+            << std::endl;
 
-  m_comb->squelchOpen.connect(
-      sigc::mem_fun(*this, &SquelchCombine::onSquelchOpen));
-  m_comb->toneDetected.connect(toneDetected.make_slot());
+  for (size_t idx=0; idx<m_subs.size(); ++idx)
+  {
+    SubSquelch* sub = m_subs[idx];
+    if (!sub->initialize(cfg))
+    {
+      return false;
+    }
+    sub->squelch()->squelchOpen.connect(sigc::bind(
+          sigc::mem_fun(*this, &SquelchCombine::onSubSquelchOpen), idx));
+    sub->squelch()->toneDetected.connect(toneDetected.make_slot());
+  }
 
-  return m_comb->initialize(cfg) && Squelch::initialize(cfg, rx_name);
+  m_stack.reserve(m_code.size());
+  buildTruthTable();
+
+  return Squelch::initialize(cfg, rx_name);
 } /* SquelchCombine::initialize */
 
 
 void SquelchCombine::reset(void)
 {
-  m_comb->reset();
+  for (auto sub : m_subs)
+  {
+    sub->squelch()->reset();
+  }
+  m_inputs = 0;
   Squelch::reset();
 } /* SquelchCombine::reset */
 
 
 void SquelchCombine::restart(void)
 {
-  m_comb->restart();
+  for (auto sub : m_subs)
+  {
+    sub->squelch()->restart();
+  }
   Squelch::restart();
 } /* SquelchCombine::restart */
 
@@ -457,7 +282,10 @@ void SquelchCombine::restart(void)
 
 int SquelchCombine::processSamples(const float *samples, int count)
 {
-  m_comb->processSamples(samples, count);
+  for (auto sub : m_subs)
+  {
+    sub->processSamples(samples, count);
+  }
   return count;
 } /* SquelchCombine::processSamples */
 
@@ -468,14 +296,34 @@ int SquelchCombine::processSamples(const float *samples, int count)
  *
  ****************************************************************************/
 
-void SquelchCombine::onSquelchOpen(bool is_open)
+void SquelchCombine::onSubSquelchOpen(bool is_open, size_t idx)
 {
+  const uint32_t mask = uint32_t(1) << idx;
+  if (m_subs[idx]->isOpen())
+  {
+    m_inputs |= mask;
+  }
+  else
+  {
+    m_inputs &= ~mask;
+  }
+  updateSquelchState();
+} /* SquelchCombine::onSubSquelchOpen */
+
+
+void SquelchCombine::updateSquelchState(void)
+{
+  bool is_open = evaluate(m_inputs);
   if (is_open != signalDetected())
   {
     std::string info;
     info.reserve(127);
-    SquelchCombine::Node::SquelchStates states;
-    for (const auto& state : m_comb->squelchStates(states))
+    std::set<std::string> states;
+    for (auto sub : m_subs)
+    {
+      states.emplace(sub->activityInfo());
+    }
+    for (const auto& state : states)
     {
       if (!info.empty())
       {
@@ -484,9 +332,67 @@ void SquelchCombine::onSquelchOpen(bool is_open)
       info += state;
     }
     setSignalDetected(is_open, info);
-    //setSignalDetected(is_open, m_comb->activityInfo());
   }
-} /* SquelchCombine::onSquelchOpen */
+} /* SquelchCombine::updateSquelchState */
+
+
+bool SquelchCombine::evaluate(uint32_t inputs)
+{
+  if (!m_truth_table.empty())
+  {
+    return (m_truth_table[inputs >> 6] >> (inputs & 63)) & 1;
+  }
+
+  m_stack.clear();
+  for (const auto& instr : m_code)
+  {
+    switch (instr.op)
+    {
+      case OP_PUSH:
+        m_stack.push_back((inputs >> instr.arg) & 1);
+        break;
+      case OP_NOT:
+        m_stack.back() = !m_stack.back();
+        break;
+      case OP_AND:
+      {
+        bool right = m_stack.back();
+        m_stack.pop_back();
+        m_stack.back() = m_stack.back() && right;
+        break;
+      }
+      case OP_OR:
+      {
+        bool right = m_stack.back();
+        m_stack.pop_back();
+        m_stack.back() = m_stack.back() || right;
+        break;
+      }
+    }
+  }
+  return m_stack.back();
+} /* SquelchCombine::evaluate */
+
+
+void SquelchCombine::buildTruthTable(void)
+{
+  m_truth_table.clear();
+  if (m_subs.size() > MAX_TABLE_INPUTS)
+  {
+    return;
+  }
+
+  const uint32_t entries = uint32_t(1) << m_subs.size();
+  std::vector<uint64_t> table((entries + 63) / 64, 0);
+  for (uint32_t inputs=0; inputs<entries; ++inputs)
+  {
+    if (evaluate(inputs))
+    {
+      table[inputs >> 6] |= uint64_t(1) << (inputs & 63);
+    }
+  }
+  m_truth_table.swap(table);
+} /* SquelchCombine::buildTruthTable */
 
 
 bool SquelchCombine::tokenize(const std::string& expr)
@@ -534,25 +440,24 @@ bool SquelchCombine::tokenize(const std::string& expr)
 } /*SquelchCombine::tokenize */
 
 
-SquelchCombine::Node* SquelchCombine::parseInstExpression(void)
+bool SquelchCombine::parseInstExpression(std::string& desc)
 {
   if (m_tokens.empty())
   {
     std::cout << "*** ERROR: Empty squelch combiner expression" << std::endl;
-    return nullptr;
+    return false;
   }
 
   if (m_tokens.front() == "(")
   {
     m_tokens.pop_front();
-    Node* expr = parseExpression();
-    if ((expr == nullptr) || (m_tokens.front() != ")"))
+    if (!parseExpression(desc) || m_tokens.empty() ||
+        (m_tokens.front() != ")"))
     {
-      delete expr;
-      return nullptr;
+      return false;
     }
     m_tokens.pop_front();
-    return expr;
+    return true;
   }
 
   std::string inst(m_tokens.front());
@@ -560,39 +465,65 @@ SquelchCombine::Node* SquelchCombine::parseInstExpression(void)
   {
     std::cout << "*** ERROR: Cannot use operator '" << inst
               << "' as instance name in squelch combiner" << std::endl;
-    return nullptr;
+    return false;
   }
   m_tokens.pop_front();
 
-  return new LeafNode(inst);
+    // A squelch instance that is used more than once in the expression is
+    // only created once so that it only has to process the audio once
+  auto it = std::find_if(m_subs.begin(), m_subs.end(),
+      [&](const SubSquelch* sub) { return sub->name() == inst; });
+  if (it == m_subs.end())
+  {
+    if (m_subs.size() >= MAX_SUB_SQUELCHES)
+    {
+      std::cout << "*** ERROR: Too many squelch instances in squelch "
+                   "combiner. The maximum is " << MAX_SUB_SQUELCHES
+                << "." << std::endl;
+      return false;
+    }
+    it = m_subs.insert(m_subs.end(), new SubSquelch(inst));
+  }
+  m_code.push_back({OP_PUSH, static_cast<uint8_t>(it - m_subs.begin())});
+  desc = inst;
+
+  return true;
 } /* SquelchCombine::parseInstExpression */
 
 
-SquelchCombine::Node* SquelchCombine::parseUnaryOpExpression(void)
+bool SquelchCombine::parseUnaryOpExpression(std::string& desc)
 {
   bool is_negation_op = false;
-  if (m_tokens.front() == "!")
+  if (!m_tokens.empty() && (m_tokens.front() == "!"))
   {
     is_negation_op = true;
     m_tokens.pop_front();
   }
 
-  Node* node = parseInstExpression();
-  if ((node == nullptr) || !is_negation_op)
+  if (!parseInstExpression(desc))
   {
-    return node;
+    return false;
   }
 
-  return new NegationOpNode(node);
+  if (is_negation_op)
+  {
+    m_code.push_back({OP_NOT, 0});
+    desc = "NOT(" + desc + ")";
+  }
+
+  return true;
 } /* SquelchCombine::parseUnaryOpExpression */
 
 
-SquelchCombine::Node* SquelchCombine::parseAndExpression(void)
+bool SquelchCombine::parseAndExpression(std::string& desc)
 {
-  Node* left = parseUnaryOpExpression();
-  if ((left == nullptr) || m_tokens.empty() || (m_tokens.front() != "&"))
+  if (!parseUnaryOpExpression(desc))
+  {
+    return false;
+  }
+  if (m_tokens.empty() || (m_tokens.front() != "&"))
   {
-    return left;
+    return true;
   }
 
   if (m_tokens.size() < 2)
@@ -600,28 +531,31 @@ SquelchCombine::Node* SquelchCombine::parseAndExpression(void)
     std::cout << "*** ERROR: Right hand expression missing in squelch "
                  "combiner AND-expression"
               << std::endl;
-    delete left;
-    return nullptr;
+    return false;
   }
   m_tokens.pop_front();
 
-  Node* right = parseAndExpression();
-  if (right == nullptr)
+  std::string right;
+  if (!parseAndExpression(right))
   {
-    delete left;
-    return nullptr;
+    return false;
   }
+  m_code.push_back({OP_AND, 0});
+  desc = "AND(" + desc + ", " + right + ")";
 
-  return new AndOpNode(left, right);
+  return true;
 } /* SquelchCombine::parseAndExpression */
 
 
-SquelchCombine::Node* SquelchCombine::parseOrExpression(void)
+bool SquelchCombine::parseOrExpression(std::string& desc)
 {
-  Node* left = parseAndExpression();
-  if ((left == nullptr) || m_tokens.empty() || (m_tokens.front() != "|"))
+  if (!parseAndExpression(desc))
+  {
+    return false;
+  }
+  if (m_tokens.empty() || (m_tokens.front() != "|"))
   {
-    return left;
+    return true;
   }
 
   if (m_tokens.size() < 2)
@@ -629,29 +563,28 @@ SquelchCombine::Node* SquelchCombine::parseOrExpression(void)
     std::cout << "*** ERROR: Right hand expression missing in squelch "
                  "combiner OR-expression"
               << std::endl;
-    delete left;
-    return nullptr;
+    return false;
   }
   m_tokens.pop_front();
 
-  Node* right = parseOrExpression();
-  if (right == nullptr)
+  std::string right;
+  if (!parseOrExpression(right))
   {
-    delete left;
-    return nullptr;
+    return false;
   }
+  m_code.push_back({OP_OR, 0});
+  desc = "OR(" + desc + ", " + right + ")";
 
-  return new OrOpNode(left, right);
+  return true;
 } /* SquelchCombine::parseOrExpression */
 
 
-SquelchCombine::Node* SquelchCombine::parseExpression(void)
+bool SquelchCombine::parseExpression(std::string& desc)
 {
-  return parseOrExpression();
+  return parseOrExpression(desc);
 } /* SquelchCombine::parseExpresseion */
 
 
 /*
  * This file has not been truncated
  */
-
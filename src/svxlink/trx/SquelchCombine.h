@@ -34,8 +34,10 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
  *
  ****************************************************************************/
 
+#include <stdint.h>
 #include <string>
 #include <deque>
+#include <vector>
 
 
 /****************************************************************************
@@ -135,6 +137,14 @@ SIGLEV_CLOSE_THRESH=2
 SQL_DET=COMBINE
 SQL_COMBINE=Rx1:CTCSS | Rx1:SIGLEV
 ...
+
+The expression is compiled into a small stack based program when the squelch
+is initialized. If there are few enough sub-squelches, the program is then
+used to build a truth table so that the combined state can be found using a
+single lookup every time one of the sub-squelches open or close. A
+sub-squelch that is used more than once in the expression is only
+instantiated once so each audio block is only processed once per
+sub-squelch.
 */
 class SquelchCombine : public Squelch
 {
@@ -199,24 +209,37 @@ class SquelchCombine : public Squelch
 
   private:
     typedef std::deque<std::string> Tokens;
-    class Node;
-    class LeafNode;
-    class UnaryOpNode;
-    struct NegationOpNode;
-    class BinaryOpNode;
-    struct OrOpNode;
-    struct AndOpNode;
-
-    Tokens  m_tokens;
-    Node*   m_comb    = nullptr;
-
-    void onSquelchOpen(bool is_open);
+    class SubSquelch;
+    typedef enum
+    {
+      OP_PUSH, OP_NOT, OP_AND, OP_OR
+    } OpCode;
+    struct Instr
+    {
+      OpCode  op;
+      uint8_t arg;
+    };
+
+    static const size_t MAX_SUB_SQUELCHES = 32;
+    static const size_t MAX_TABLE_INPUTS  = 16;
+
+    Tokens                    m_tokens;
+    std::vector<SubSquelch*>  m_subs;
+    std::vector<Instr>        m_code;
+    std::vector<uint64_t>     m_truth_table;
+    std::vector<bool>         m_stack;
+    uint32_t                  m_inputs  = 0;
+
+    void onSubSquelchOpen(bool is_open, size_t idx);
+    void updateSquelchState(void);
+    bool evaluate(uint32_t inputs);
+    void buildTruthTable(void);
     bool tokenize(const std::string& expr);
-    Node* parseInstExpression(void);
-    Node* parseUnaryOpExpression(void);
-    Node* parseAndExpression(void);
-    Node* parseOrExpression(void);
-    Node* parseExpression(void);
+    bool parseInstExpression(std::string& desc);
+    bool parseUnaryOpExpression(std::string& desc);
+    bool parseAndExpression(std::string& desc);
+    bool parseOrExpression(std::string& desc);
+    bool parseExpression(std::string& desc);
 
 };  /* class SquelchCombine */
 
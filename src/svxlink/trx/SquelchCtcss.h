@@ -60,6 +60,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
  ****************************************************************************/
 
 #include "ToneDetector.h"
+#include "CtcssDetector.h"
 #include "Squelch.h"
 
 
@@ -118,7 +119,9 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 
 This squelch detector use tone detectors to detect the presence of one or more
 CTCSS squelch tones. The actual tone detector is implemented outside of this
-class.
+class. In the default mode (CTCSS_MODE=4) all tones are handled by one
+CtcssDetector so that the filtering and analysis is shared between the tones.
+The other modes use one ToneDetector per tone.
 */
 class SquelchCtcss : public Squelch
 {
@@ -137,6 +140,7 @@ class SquelchCtcss : public Squelch
     virtual ~SquelchCtcss(void)
     {
       delete m_splitter;
+      delete m_ctcss;
     }
 
     /**
@@ -227,16 +231,38 @@ class SquelchCtcss : public Squelch
 
       cfg.getValue(rx_name, "CTCSS_EMIT_TONE_DETECTED", m_emit_tone_detected);
 
-      m_splitter = new Async::AudioSplitter;
+      if ((ctcss_mode < 1) || (ctcss_mode > 3))
+      {
+        //std::cout << "### CTCSS mode: Shared multi tone detector\n";
+        static const float TONE_FQ_TOLERANCE  = 0.75f;
+
+        m_ctcss = new CtcssDetector(ctcss_fqs, bpf_low, bpf_high);
+        for (size_t i=0; i<ctcss_fqs.size(); ++i)
+        {
+          m_ctcss->setSnrThresh(i, open_threshs[ctcss_fqs[i]],
+                                close_threshs[ctcss_fqs[i]]);
+        }
+        m_ctcss->setDetectDelay(100);
+        m_ctcss->setUndetectDelay(100);
+        m_ctcss->setToneFrequencyTolerancePercent(TONE_FQ_TOLERANCE);
+        m_ctcss->activated.connect(
+            sigc::mem_fun(*this, &SquelchCtcss::onToneActivated));
+        m_ctcss->snrsUpdated.connect(
+            sigc::mem_fun(*this, &SquelchCtcss::onSnrsUpdated));
+      }
+      else
+      {
+        m_splitter = new Async::AudioSplitter;
+      }
 
-      for (FqList::const_iterator it = ctcss_fqs.begin();
-           it != ctcss_fqs.end(); ++it)
+      for (size_t idx=0; (m_splitter != nullptr) && (idx<ctcss_fqs.size());
+           ++idx)
       {
-        float ctcss_fq = *it;
+        float ctcss_fq = ctcss_fqs[idx];
 
         ToneDetector *det = new ToneDetector(ctcss_fq, 8.0f);
         det->activated.connect(sigc::bind(
-            sigc::mem_fun(*this, &SquelchCtcss::checkSignalDetected), det));
+            sigc::mem_fun(*this, &SquelchCtcss::onToneActivated), idx));
         det->snrUpdated.connect(sigc::bind(snrUpdated.make_slot(), ctcss_fq));
         Async::AudioSink *sink = det;
 
@@ -306,43 +332,6 @@ class SquelchCtcss : public Squelch
             sink = filter;
             break;
           }
-
-          default:
-          case 4:
-          {
-            static const float OVERLAP_PERCENT    = 75.0f;
-            static const float TONE_FQ_TOLERANCE  = 0.75f;
-            static const bool  USE_WINDOWING      = false;
-
-           //std::ostringstream ss;
-           //ss << "### CTCSS " << std::setw(5) << std::setprecision(1)
-           //   << std::fixed << det->toneFq() << " mode 4: " << OVERLAP_PERCENT
-           //   << "% overlap + Estimated SNR + tone frequency "
-           //   << std::setprecision(2) << TONE_FQ_TOLERANCE << "% tolerance";
-           //std::cout << ss.str() << std::endl;
-
-            det->setDetectBw(16.0f);
-            det->setDetectOverlapPercent(OVERLAP_PERCENT);
-            det->setDetectDelay(100);
-            det->setDetectToneFrequencyTolerancePercent(TONE_FQ_TOLERANCE);
-            det->setDetectUseWindowing(USE_WINDOWING);
-            det->setDetectPeakThresh(0.0f);
-            det->setDetectSnrThresh(open_threshs[ctcss_fq], bpf_high - bpf_low);
-
-            det->setUndetectBw(8.0f);
-            det->setUndetectOverlapPercent(OVERLAP_PERCENT);
-            det->setUndetectDelay(100);
-            det->setUndetectUseWindowing(USE_WINDOWING);
-            det->setUndetectPeakThresh(0.0f);
-            det->setUndetectSnrThresh(close_threshs[ctcss_fq], bpf_high - bpf_low);
-
-              // Set up CTCSS band pass filter
-            Async::AudioFilter *filter =
-              new Async::AudioFilter(filter_spec.str());
-            filter->registerSink(det, true);
-            sink = filter;
-            break;
-          }
         }
 
         m_splitter->addSink(sink, true);
@@ -368,11 +357,15 @@ class SquelchCtcss : public Squelch
      */
     virtual void reset(void)
     {
+      if (m_ctcss != nullptr)
+      {
+        m_ctcss->reset();
+      }
       for (DetList::iterator it = m_dets.begin(); it != m_dets.end(); ++it)
       {
         (*it)->reset();
       }
-      m_active_det = 0;
+      m_active_tone = -1;
       Squelch::reset();
     }
 
@@ -382,6 +375,10 @@ class SquelchCtcss : public Squelch
       */
     virtual void setDelay(int delay)
     {
+      if (m_ctcss != nullptr)
+      {
+        m_ctcss->setDetectDelay(delay);
+      }
       for (DetList::iterator it = m_dets.begin(); it != m_dets.end(); ++it)
       {
         (*it)->setDetectDelay(delay);
@@ -395,7 +392,7 @@ class SquelchCtcss : public Squelch
      *
      * This signal will be emitted as soon as a new SNR value for the CTCSS
      * tone has been calculated. The signal will only be emitted when
-     * CTCSS_MODE is set to 2 or 3.
+     * CTCSS_MODE is set to 2, 3 or 4.
      */
     sigc::signal<void(float, float)> snrUpdated;
 
@@ -408,6 +405,10 @@ class SquelchCtcss : public Squelch
      */
     int processSamples(const float *samples, int count)
     {
+      if (m_ctcss != nullptr)
+      {
+        return m_ctcss->writeSamples(samples, count);
+      }
       return m_splitter->writeSamples(samples, count);
     }
 
@@ -417,6 +418,10 @@ class SquelchCtcss : public Squelch
      */
     virtual void setCurrentHangtime(int hang)
     {
+      if (m_ctcss != nullptr)
+      {
+        m_ctcss->setUndetectDelay(hang);
+      }
       for (DetList::iterator it = m_dets.begin(); it != m_dets.end(); ++it)
       {
         (*it)->setUndetectDelay(hang);
@@ -428,7 +433,8 @@ class SquelchCtcss : public Squelch
 
     DetList                       m_dets;
     Async::AudioSplitter*         m_splitter            = nullptr;
-    ToneDetector*                 m_active_det          = nullptr;
+    CtcssDetector*                m_ctcss               = nullptr;
+    int                           m_active_tone         = -1;
     std::map<float, float>        m_ctcss_snr_offsets;
     bool                          m_debug               = false;
     std::unique_ptr<Async::Timer> m_dbg_timer           = nullptr;
@@ -437,39 +443,77 @@ class SquelchCtcss : public Squelch
     SquelchCtcss(const SquelchCtcss&);
     SquelchCtcss& operator=(const SquelchCtcss&);
 
-    void checkSignalDetected(bool is_detected, ToneDetector *det)
+    size_t toneCount(void) const
+    {
+      return (m_ctcss != nullptr) ? m_ctcss->toneCount() : m_dets.size();
+    }
+
+    float toneFq(size_t idx) const
+    {
+      return (m_ctcss != nullptr) ? m_ctcss->toneFq(idx)
+                                  : m_dets[idx]->toneFq();
+    }
+
+    float toneFqEstimate(size_t idx) const
+    {
+      return (m_ctcss != nullptr) ? m_ctcss->toneFqEstimate(idx)
+                                  : m_dets[idx]->toneFqEstimate();
+    }
+
+    float lastSnr(size_t idx) const
+    {
+      return (m_ctcss != nullptr) ? m_ctcss->lastSnr(idx)
+                                  : m_dets[idx]->lastSnr();
+    }
+
+    bool isActivated(size_t idx) const
+    {
+      return (m_ctcss != nullptr) ? m_ctcss->isActivated(idx)
+                                  : m_dets[idx]->isActivated();
+    }
+
+    void onSnrsUpdated(const std::vector<float>& snrs)
+    {
+      for (size_t idx=0; idx<snrs.size(); ++idx)
+      {
+        snrUpdated(snrs[idx], m_ctcss->toneFq(idx));
+      }
+    }
+
+    void onToneActivated(size_t idx, bool is_detected)
     {
       if (m_debug)
       {
         printDebug();
       }
+      const float tone_fq = toneFq(idx);
       std::ostringstream ss;
-      ss << std::setprecision(1) << std::fixed << det->toneFq();
-      if (det->toneFqEstimate() > 0.0f)
+      ss << std::setprecision(1) << std::fixed << tone_fq;
+      if (toneFqEstimate(idx) > 0.0f)
       {
-        float fq_err = det->toneFqEstimate() - det->toneFq();
-        fq_err = 100.0 * fq_err / det->toneFq();
+        float fq_err = toneFqEstimate(idx) - tone_fq;
+        fq_err = 100.0 * fq_err / tone_fq;
         ss << std::showpos << fq_err;
       }
       ss << ":" << static_cast<int>(
-            std::roundf(det->lastSnr() - m_ctcss_snr_offsets[det->toneFq()]));
+            std::roundf(lastSnr(idx) - m_ctcss_snr_offsets[tone_fq]));
       if (is_detected)
       {
-        if (m_active_det == 0)
+        if (m_active_tone < 0)
         {
-          m_active_det = det;
+          m_active_tone = idx;
           setSignalDetected(true, ss.str());
           if (m_emit_tone_detected)
           {
-            toneDetected(det->toneFq());
+            toneDetected(tone_fq);
           }
         }
       }
       else
       {
-        if (m_active_det == det)
+        if (m_active_tone == static_cast<int>(idx))
         {
-          m_active_det = 0;
+          m_active_tone = -1;
           //for (const auto& d : m_dets)
           //{
           //  if (d->isActivated())
@@ -493,17 +537,18 @@ class SquelchCtcss : public Squelch
     {
       std::ostringstream os;
       os << rxName() << ":";
-      for (auto det : m_dets)
+      for (size_t idx=0; idx<toneCount(); ++idx)
       {
-        float snr = det->lastSnr() - m_ctcss_snr_offsets[det->toneFq()];
-        char stat = det->isActivated() ? '*' : ':';
+        const float tone_fq = toneFq(idx);
+        float snr = lastSnr(idx) - m_ctcss_snr_offsets[tone_fq];
+        char stat = isActivated(idx) ? '*' : ':';
         os << std::showpos << std::setfill(' ')
            << std::setw(4) << static_cast<int>(roundf(snr))
            << stat << std::fixed << std::setprecision(1) << std::noshowpos
-           << det->toneFq();
-        if (det->toneFqEstimate() > 0.0)
+           << tone_fq;
+        if (toneFqEstimate(idx) > 0.0)
         {
-          float fq_err = det->toneFqEstimate() - det->toneFq();
+          float fq_err = toneFqEstimate(idx) - tone_fq;
           os << std::showpos << std::setfill('_') << std::setw(5) << fq_err;
         }
       }
@@ -6,7 +6,7 @@
 
 \verbatim
 SvxLink - A Multi Purpose Voice Services System for Ham Radio Use
-Copyright (C) 2003-2013 Tobias Blomberg / SM0SVX
+Copyright (C) 2003-2026 Tobias Blomberg / SM0SVX
 
 This program is free software; you can redistribute it and/or modify
 it under the terms of the GNU General Public License as published by
@@ -47,6 +47,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
  ****************************************************************************/
 
 #include <AsyncTimer.h>
+#include <AsyncFdWatch.h>
 
 
 /****************************************************************************
@@ -118,7 +119,8 @@ using namespace Async;
  ****************************************************************************/
 
 SquelchGpio::SquelchGpio(void)
-  : fd(-1), timer(0), active_low(false), gpio_path("/sys/class/gpio")
+  : fd(-1), timer(0), watch(0), active_low(false),
+    gpio_path("/sys/class/gpio")
 {
   
 } /* SquelchGpio::SquelchGpio */
@@ -128,6 +130,8 @@ SquelchGpio::~SquelchGpio(void)
 {
   delete timer;
   timer = 0;
+  delete watch;
+  watch = 0;
   if (fd >= 0)
   {
     close(fd);
@@ -159,23 +163,40 @@ bool SquelchGpio::initialize(Async::Config& cfg, const std::string& rx_name)
     sql_pin.erase(0, 1);
   }
 
-  stringstream ss;
-  ss << gpio_path << "/" << sql_pin << "/value";
-  fd = open(ss.str().c_str(), O_RDONLY);
+  const string pin_path(gpio_path + "/" + sql_pin);
+  const string value_path(pin_path + "/value");
+  fd = open(value_path.c_str(), O_RDONLY);
   if (fd < 0)
   {
-    cerr << "*** ERROR: Could not open GPIO device " << ss.str()
+    cerr << "*** ERROR: Could not open GPIO device " << value_path
          << " specified in " << rx_name << "/GPIO_SQL_PIN: "
          << strerror(errno) << endl;
     return false;
   }
 
-  timer = new Timer(100, Timer::TYPE_PERIODIC);
-  timer->expired.connect(
-      hide(mem_fun(*this, &SquelchGpio::readGpioValueData)));
+    // A change of the pin value is signalled as a priority event on the
+    // value file when edge detection is enabled. Poll the pin if not.
+  if (enableEdgeDetection(pin_path))
+  {
+    watch = new FdWatch(fd, FdWatch::FD_WATCH_PRI);
+    watch->activity.connect(
+        hide(mem_fun(*this, &SquelchGpio::readGpioValueData)));
+  }
+  else
+  {
+    cerr << "*** WARNING: Edge detection could not be enabled for GPIO pin "
+         << pin_path << " in receiver " << rx_name
+         << ". Falling back to polling the squelch state." << endl;
+    timer = new Timer(100, Timer::TYPE_PERIODIC);
+    timer->expired.connect(
+        hide(mem_fun(*this, &SquelchGpio::readGpioValueData)));
+  }
+
+    // Read the initial state. This also acknowledge any pending event.
+  readGpioValueData();
 
   return true;
-}
+} /* SquelchGpio::initialize */
 
 
 
@@ -194,8 +215,10 @@ bool SquelchGpio::initialize(Async::Config& cfg, const std::string& rx_name)
  ****************************************************************************/
 
 /**
- * @brief  Called by a timer to periodically read the state of the GPIO pin
+ * @brief  Called to read the state of the GPIO pin
  *
+ * This function is called when a priority event occur on the value file, or
+ * by a timer if edge detection is not available.
  * An example of reading a GPIO ports can be found at:
  * http://elinux.org/RPi_Low-level_peripherals#C_.2B_sysfs
  * Note though that this example code is not 100% safe and not optimal. The
@@ -236,6 +259,38 @@ void SquelchGpio::readGpioValueData(void)
 } /* SquelchGpio::readGpioValueData */
 
 
+/**
+ * @brief  Make the kernel signal changes on both edges of the GPIO pin
+ *
+ * The edge file is usually set up by the same script that export the pin. It
+ * is only written if it is not already set to "both" since it might not be
+ * writable by the user that SvxLink run as.
+ */
+bool SquelchGpio::enableEdgeDetection(const std::string& pin_path)
+{
+  const string edge_path(pin_path + "/edge");
+  int edge_fd = open(edge_path.c_str(), O_RDWR);
+  if (edge_fd < 0)
+  {
+    edge_fd = open(edge_path.c_str(), O_RDONLY);
+    if (edge_fd < 0)
+    {
+      return false;
+    }
+  }
+
+  char edge[8] = {0};
+  ssize_t cnt = read(edge_fd, edge, sizeof(edge) - 1);
+  bool ok = (cnt >= 4) && (strncmp(edge, "both", 4) == 0);
+  if (!ok)
+  {
+    ok = (write(edge_fd, "both", 4) == 4);
+  }
+  close(edge_fd);
+  return ok;
+} /* SquelchGpio::enableEdgeDetection */
+
+
 
 /*
  * This file has not been truncated
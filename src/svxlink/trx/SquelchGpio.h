@@ -6,7 +6,7 @@
 
 \verbatim
 SvxLink - A Multi Purpose Voice Services System for Ham Radio Use
-Copyright (C) 2003-2013 Tobias Blomberg / SM0SVX
+Copyright (C) 2003-2026 Tobias Blomberg / SM0SVX
 
 This program is free software; you can redistribute it and/or modify
 it under the terms of the GNU General Public License as published by
@@ -63,6 +63,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 namespace Async
 {
   class Timer;
+  class FdWatch;
 };
 
 
@@ -114,6 +115,10 @@ namespace Async
 This squelch detector read the squelch indicator signal from a GPIO input pin.
 A high level (3.3V) will be interpreted as squelch open and a low level (GND)
 will be interpreted as squelch close.
+
+If the GPIO pin support edge detection, the value file is watched for changes
+so that the squelch state is updated as soon as the pin change. Otherwise the
+pin is polled every 100 milliseconds.
 */
 class SquelchGpio : public Squelch
 {
@@ -144,12 +149,14 @@ class SquelchGpio : public Squelch
   private:
     int           fd;
     Async::Timer  *timer;
+    Async::FdWatch *watch;
     bool          active_low;
     std::string   gpio_path;
 
     SquelchGpio(const SquelchGpio&);
     SquelchGpio& operator=(const SquelchGpio&);
     void readGpioValueData(void);
+    bool enableEdgeDetection(const std::string& pin_path);
 
 };  /* class SquelchGpio */
 
@@ -6,7 +6,7 @@
 
 \verbatim
 SvxLink - A Multi Purpose Voice Services System for Ham Radio Use
-Copyright (C) 2003-2025 Tobias Blomberg / SM0SVX
+Copyright (C) 2003-2026 Tobias Blomberg / SM0SVX
 
 This program is free software; you can redistribute it and/or modify
 it under the terms of the GNU General Public License as published by
@@ -110,15 +110,25 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 SquelchGpiod::SquelchGpiod(void)
   : m_timer(100, Async::Timer::TYPE_PERIODIC)
 {
+  m_timer.setEnable(false);
+  m_timer.expired.connect(
+      sigc::hide(sigc::mem_fun(*this, &SquelchGpiod::readGpioValueData)));
+  m_watch.activity.connect(
+      sigc::hide(sigc::mem_fun(*this, &SquelchGpiod::readGpioEvents)));
 } /* SquelchGpiod::SquelchGpiod */
 
 
 SquelchGpiod::~SquelchGpiod(void)
 {
   m_timer.setEnable(false);
-  //m_watch.setEnabled(false);
+  m_watch.setEnabled(false);
 
 #if GPIOD_VERSION_MAJOR >= 2
+  if (m_event_buffer != nullptr)
+  {
+    gpiod_edge_event_buffer_free(m_event_buffer);
+    m_event_buffer = nullptr;
+  }
   if (m_request != nullptr)
   {
     gpiod_line_request_release(m_request);
@@ -219,6 +229,9 @@ bool SquelchGpiod::initialize(Async::Config& cfg, const std::string& rx_name)
   std::string bias;
   cfg.getValue(rx_name, "SQL_GPIOD_BIAS", bias);
 
+  unsigned debounce = 0;
+  cfg.getValue(rx_name, "SQL_GPIOD_DEBOUNCE", debounce);
+
 #if GPIOD_VERSION_MAJOR >= 2
     // Create line settings
   struct gpiod_line_settings* settings = gpiod_line_settings_new();
@@ -230,6 +243,11 @@ bool SquelchGpiod::initialize(Async::Config& cfg, const std::string& rx_name)
   }
 
   gpiod_line_settings_set_direction(settings, GPIOD_LINE_DIRECTION_INPUT);
+  gpiod_line_settings_set_edge_detection(settings, GPIOD_LINE_EDGE_BOTH);
+  if (debounce > 0)
+  {
+    gpiod_line_settings_set_debounce_period_us(settings, 1000UL * debounce);
+  }
 
   if (active_low)
   {
@@ -297,6 +315,19 @@ bool SquelchGpiod::initialize(Async::Config& cfg, const std::string& rx_name)
 
     // Request the line
   m_request = gpiod_chip_request_lines(m_chip, req_config, config);
+  bool use_events = (m_request != nullptr);
+  if (m_request == nullptr)
+  {
+      // Not all GPIO chips can generate edge events, e.g. some I2C port
+      // expanders, so try again without edge detection
+    gpiod_line_settings_set_edge_detection(settings, GPIOD_LINE_EDGE_NONE);
+    gpiod_line_settings_set_debounce_period_us(settings, 0);
+    if (gpiod_line_config_add_line_settings(config, &m_line_offset, 1,
+                                            settings) == 0)
+    {
+      m_request = gpiod_chip_request_lines(m_chip, req_config, config);
+    }
+  }
   if (m_request == nullptr)
   {
     std::cerr << "*** ERROR: Request GPIOD line \"" << line
@@ -313,19 +344,19 @@ bool SquelchGpiod::initialize(Async::Config& cfg, const std::string& rx_name)
   gpiod_line_config_free(config);
   gpiod_line_settings_free(settings);
 
-    // Set up timer for polling
-  m_timer.expired.connect([=](Async::Timer*) {
-        enum gpiod_line_value val =
-          gpiod_line_request_get_value(m_request, m_line_offset);
-        if (val == GPIOD_LINE_VALUE_ERROR)
-        {
-          std::cerr << "*** WARNING: Read GPIOD line \"" << line
-                    << "\" failed for RX \"" << rx_name << "\": "
-                    << std::strerror(errno) << std::endl;
-          return;
-        }
-        setSignalDetected(val == GPIOD_LINE_VALUE_ACTIVE);
-      });
+  if (use_events)
+  {
+    m_event_buffer = gpiod_edge_event_buffer_new(EVENT_BUFFER_SIZE);
+    if (m_event_buffer == nullptr)
+    {
+      std::cerr << "*** ERROR: Failed to create GPIOD event buffer for RX \""
+                << rx_name << "\"" << std::endl;
+      return false;
+    }
+    m_watch.setFd(gpiod_line_request_get_fd(m_request),
+                  Async::FdWatch::FD_WATCH_RD);
+    m_watch.setEnabled(true);
+  }
 #else
     // libgpiod v1
   struct gpiod_line_request_config req_cfg;
@@ -371,7 +402,27 @@ bool SquelchGpiod::initialize(Async::Config& cfg, const std::string& rx_name)
 #endif
   }
 
+  if (debounce > 0)
+  {
+    std::cerr << "*** WARNING: Config variable " << rx_name
+              << "/SQL_GPIOD_DEBOUNCE has been specified but the version "
+                 "of libgpiod that SvxLink was compiled with ("
+              << GPIOD_VERSION_MAJOR << "." << GPIOD_VERSION_MINOR
+              << ") does not support setting the debounce time. "
+                 "Need libgpiod >= 2.0."
+              << std::endl;
+  }
+
+  req_cfg.request_type = GPIOD_LINE_REQUEST_EVENT_BOTH_EDGES;
   int ret = gpiod_line_request(m_line, &req_cfg, 0);
+  bool use_events = (ret == 0);
+  if (ret < 0)
+  {
+      // Not all GPIO chips can generate edge events, e.g. some I2C port
+      // expanders, so try again without edge detection
+    req_cfg.request_type = GPIOD_LINE_REQUEST_DIRECTION_INPUT;
+    ret = gpiod_line_request(m_line, &req_cfg, 0);
+  }
   if (ret < 0)
   {
     std::cerr << "*** ERROR: Set GPIOD line \"" << line
@@ -380,19 +431,24 @@ bool SquelchGpiod::initialize(Async::Config& cfg, const std::string& rx_name)
     return false;
   }
 
-  m_timer.expired.connect([=](Async::Timer*) {
-        int val = gpiod_line_get_value(m_line);
-        if (val < 0)
-        {
-          std::cerr << "*** WARNING: Read GPIOD line \"" << line
-                    << "\" failed for RX \"" << rx_name << "\": "
-                    << std::strerror(errno) << std::endl;
-          return;
-        }
-        setSignalDetected(val > 0);
-      });
+  if (use_events)
+  {
+    m_watch.setFd(gpiod_line_event_get_fd(m_line),
+                  Async::FdWatch::FD_WATCH_RD);
+    m_watch.setEnabled(true);
+  }
 #endif
 
+  if (!use_events)
+  {
+    std::cerr << "*** WARNING: Edge events could not be enabled for GPIOD "
+                 "line \"" << line << "\" in RX \"" << rx_name << "\". "
+                 "Falling back to polling the squelch state." << std::endl;
+    m_timer.setEnable(true);
+  }
+
+  readGpioValueData();
+
   return true;
 } /* SquelchGpiod::initialize */
 
@@ -403,30 +459,55 @@ bool SquelchGpiod::initialize(Async::Config& cfg, const std::string& rx_name)
  *
  ****************************************************************************/
 
-#if 0
 void SquelchGpiod::readGpioValueData(void)
 {
-  struct gpiod_line_event event;
-  int ret = gpiod_line_event_read_fd(m_watch.fd(), &event);
-  if (ret < 0)
+#if GPIOD_VERSION_MAJOR >= 2
+  enum gpiod_line_value val =
+    gpiod_line_request_get_value(m_request, m_line_offset);
+  if (val == GPIOD_LINE_VALUE_ERROR)
   {
-    std::cerr << "*** WARNING: SquelchGpiod::readGpioValueData: "
-                 "gpiod_line_event_read failed: "
-              << std::strerror(errno) << std::endl;
+    std::cerr << "*** WARNING: Read GPIOD line failed for RX \""
+              << rxName() << "\": " << std::strerror(errno) << std::endl;
     return;
   }
-
-  int event_type = event.event_type;
-  if (event_type == GPIOD_LINE_EVENT_RISING_EDGE)
-  {
-    setSignalDetected(true);
-  }
-  else if (event_type == GPIOD_LINE_EVENT_FALLING_EDGE)
+  setSignalDetected(val == GPIOD_LINE_VALUE_ACTIVE);
+#else
+  int val = gpiod_line_get_value(m_line);
+  if (val < 0)
   {
-    setSignalDetected(false);
+    std::cerr << "*** WARNING: Read GPIOD line failed for RX \""
+              << rxName() << "\": " << std::strerror(errno) << std::endl;
+    return;
   }
+  setSignalDetected(val > 0);
+#endif
 } /* SquelchGpiod::readGpioValueData */
+
+
+/**
+ * @brief  Called when there are edge events to read for the GPIO line
+ *
+ * The events are only read to acknowledge them. The squelch state is then
+ * set from the current value of the line, which take care of the active low
+ * setting and of any events that were missed.
+ */
+void SquelchGpiod::readGpioEvents(void)
+{
+#if GPIOD_VERSION_MAJOR >= 2
+  int ret = gpiod_line_request_read_edge_events(m_request, m_event_buffer,
+                                                EVENT_BUFFER_SIZE);
+#else
+  struct gpiod_line_event event;
+  int ret = gpiod_line_event_read(m_line, &event);
 #endif
+  if (ret < 0)
+  {
+    std::cerr << "*** WARNING: Read GPIOD events failed for RX \""
+              << rxName() << "\": " << std::strerror(errno) << std::endl;
+    return;
+  }
+  readGpioValueData();
+} /* SquelchGpiod::readGpioEvents */
 
 
 /*
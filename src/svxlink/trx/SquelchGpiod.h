@@ -6,7 +6,7 @@
 
 \verbatim
 SvxLink - A Multi Purpose Voice Services System for Ham Radio Use
-Copyright (C) 2003-2025 Tobias Blomberg / SM0SVX
+Copyright (C) 2003-2026 Tobias Blomberg / SM0SVX
 
 This program is free software; you can redistribute it and/or modify
 it under the terms of the GNU General Public License as published by
@@ -44,7 +44,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
  *
  ****************************************************************************/
 
-//#include <AsyncFdWatch.h>
+#include <AsyncFdWatch.h>
 #include <AsyncTimer.h>
 
 
@@ -111,7 +111,9 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 @date   2021-08-13
 
 This squelch detector read the squelch indicator signal from a GPIO input pin
-using the gpiod library.
+using the gpiod library. Edge events are requested for the pin so that the
+squelch state is updated as soon as the pin change. If the GPIO chip cannot
+generate edge events, the pin is polled every 100 milliseconds instead.
 */
 class SquelchGpiod : public Squelch
 {
@@ -138,17 +140,23 @@ class SquelchGpiod : public Squelch
     bool initialize(Async::Config& cfg, const std::string& rx_name);
 
   private:
+#if GPIOD_VERSION_MAJOR >= 2
+    static const size_t         EVENT_BUFFER_SIZE = 16;
+#endif
+
     Async::Timer                m_timer;
-    //Async::FdWatch             m_watch;
+    Async::FdWatch              m_watch;
     struct gpiod_chip*          m_chip          = nullptr;
 #if GPIOD_VERSION_MAJOR >= 2
     struct gpiod_line_request*  m_request       = nullptr;
+    struct gpiod_edge_event_buffer* m_event_buffer = nullptr;
     unsigned int                m_line_offset;
 #else
     struct gpiod_line*          m_line          = nullptr;
 #endif
 
-    //void readGpioValueData(void);
+    void readGpioValueData(void);
+    void readGpioEvents(void);
 
 };  /* class SquelchGpiod */
 
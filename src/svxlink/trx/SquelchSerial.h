@@ -36,6 +36,8 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 
 #include <iostream>
 #include <string>
+#include <cstring>
+#include <cerrno>
 
 
 /****************************************************************************
@@ -235,6 +237,15 @@ class SquelchSerial : public Squelch
         return false;
       }
 
+      bool low_latency = false;
+      cfg.getValue(rx_name, "SERIAL_LOW_LATENCY", low_latency);
+      if (low_latency && !serial->setLowLatency(true))
+      {
+        std::cerr << "*** WARNING: Could not enable low latency mode for "
+                  << rx_name << "/SERIAL_PORT=" << serial_port << ": "
+                  << std::strerror(errno) << "\n";
+      }
+
       return true;
     }
 
@@ -125,7 +125,7 @@ namespace {
 
 SvxSwDtmfDecoder::SvxSwDtmfDecoder(Config &cfg, const string &name)
   : DtmfDecoder(cfg, name), twist_nrm_thresh(0), twist_rev_thresh(0),
-    row(8), col(8), block_size(0), block_pos(0), det_cnt(0), undet_cnt(0),
+    block_size(0), block_pos(0), det_cnt(0), undet_cnt(0),
     last_digit_active(0), min_det_cnt(DEFAULT_MIN_DET_CNT),
     min_undet_cnt(DEFAULT_MIN_UNDET_CNT), det_state(STATE_IDLE),
     det_cnt_weight(0), duration(0), undet_thresh(0), debug(false),
@@ -134,19 +134,12 @@ SvxSwDtmfDecoder::SvxSwDtmfDecoder(Config &cfg, const string &name)
   twist_nrm_thresh = powf(10.0f, DEFAULT_MAX_NORMAL_TWIST_DB / 10.0f);
   twist_rev_thresh = powf(10.0f, -(DEFAULT_MAX_REV_TWIST_DB / 10.0f));
 
-    // Row detectors
-  for (size_t i=0; i<4; ++i)
-  {
-    row[i].initialize(row_fqs[i]);
-    row[i+4].initialize(3.0f * row_fqs[i]); // Third overtone
-  }
-
-    // Column detectors
-  for (size_t i=0; i<4; ++i)
-  {
-    col[i].initialize(col_fqs[i]);
-    col[i+4].initialize(3.0f * col_fqs[i]); // Third overtone
-  }
+    // Row and column detectors. The overtone and intermodulation
+    // detectors are set up when a digit is found.
+  vector<float> fqs(row_fqs, row_fqs + 4);
+  fqs.insert(fqs.end(), col_fqs, col_fqs + 4);
+  tone_bank.initialize(fqs, INTERNAL_SAMPLE_RATE);
+  check_bank.initialize(vector<float>(CHK_CNT, 0.0f), INTERNAL_SAMPLE_RATE);
 
     // Initialize window function
   for (size_t n=0; n<BLOCK_SIZE; ++n)
@@ -243,16 +236,6 @@ int SvxSwDtmfDecoder::writeSamples(const float *buf, int len)
 
 void SvxSwDtmfDecoder::processBlock(void)
 {
-    // Reset all Goertzel objects
-  row[0].reset();
-  row[1].reset();
-  row[2].reset();
-  row[3].reset();
-  col[0].reset();
-  col[1].reset();
-  col[2].reset();
-  col[3].reset();
-
     // Calculate the total block energy and energy for all individual
     // Goertzel detectors over the block
   double block_energy = 0.0;
@@ -260,15 +243,9 @@ void SvxSwDtmfDecoder::processBlock(void)
   {
     float sample = block[i] * win[i];
     block_energy += static_cast<double>(sample) * sample;
-    row[0].calc(sample);
-    row[1].calc(sample);
-    row[2].calc(sample);
-    row[3].calc(sample);
-    col[0].calc(sample);
-    col[1].calc(sample);
-    col[2].calc(sample);
-    col[3].calc(sample);
   }
+  tone_bank.reset();
+  tone_bank.calc(block, BLOCK_SIZE, win);
   ios_base::fmtflags orig_cout_flags(cout.flags());
   if (debug)
   {
@@ -301,7 +278,7 @@ void SvxSwDtmfDecoder::processBlock(void)
     float col_sum = 0.0f;
     for (size_t i = 0; i < 4; ++i)
     {
-      const float row_ms = WIN_ENB * row[i].magnitudeSquared();
+      const float row_ms = WIN_ENB * tone_bank.magnitudeSquared(i);
       if (row_ms > max_row_ms)
       {
         max_row_ms = row_ms;
@@ -309,7 +286,7 @@ void SvxSwDtmfDecoder::processBlock(void)
       }
       row_sum += row_ms;
 
-      const float col_ms = WIN_ENB * col[i].magnitudeSquared();
+      const float col_ms = WIN_ENB * tone_bank.magnitudeSquared(COL_BASE + i);
       if (col_ms > max_col_ms)
       {
         max_col_ms = col_ms;
@@ -351,8 +328,8 @@ void SvxSwDtmfDecoder::processBlock(void)
                      (col_group_rel > 0.80);
     }
   }
-  DtmfGoertzel &max_row = row[max_row_idx];
-  DtmfGoertzel &max_col = col[max_col_idx];
+  const float max_row_fq = row_fqs[max_row_idx];
+  const float max_col_fq = col_fqs[max_col_idx];
 
     // Find out what digit corresponds to the two strongest tones.
     // If the digit changed from the previous detection without a proper pause
@@ -383,21 +360,18 @@ void SvxSwDtmfDecoder::processBlock(void)
     // that this is not a DTMF digit.
   if (digit_active)
   {
-    Goertzel im(max_col.m_freq + max_col.m_freq - max_row.m_freq,
-                INTERNAL_SAMPLE_RATE);
-    row[max_row_idx+4].reset();
-    col[max_col_idx+4].reset();
-    for (size_t i=0; i<BLOCK_SIZE; ++i)
-    {
-      float sample = block[i] * win[i];
-      im.calc(sample);
-      row[max_row_idx+4].calc(sample);
-      col[max_col_idx+4].calc(sample);
-    }
-
-    float row_ot_rel = row[max_row_idx+4].magnitudeSquared() / max_row_ms;
-    float col_ot_rel = col[max_col_idx+4].magnitudeSquared() / max_col_ms;
-    float im_rel = im.magnitudeSquared() / (max_row_ms + max_col_ms);
+    check_bank.setFrequency(CHK_ROW_OT, 3.0f * max_row_fq,
+                            INTERNAL_SAMPLE_RATE);
+    check_bank.setFrequency(CHK_COL_OT, 3.0f * max_col_fq,
+                            INTERNAL_SAMPLE_RATE);
+    check_bank.setFrequency(CHK_IM, max_col_fq + max_col_fq - max_row_fq,
+                            INTERNAL_SAMPLE_RATE);
+    check_bank.calc(block, BLOCK_SIZE, win);
+
+    float row_ot_rel = check_bank.magnitudeSquared(CHK_ROW_OT) / max_row_ms;
+    float col_ot_rel = check_bank.magnitudeSquared(CHK_COL_OT) / max_col_ms;
+    float im_rel =
+      check_bank.magnitudeSquared(CHK_IM) / (max_row_ms + max_col_ms);
     if (debug)
     {
       cout << " row3rd=" << row_ot_rel;
@@ -422,10 +396,8 @@ void SvxSwDtmfDecoder::processBlock(void)
     // of 3% frequency deviation.
   if (digit_active)
   {
-    DtmfGoertzel &max_row = row[max_row_idx];
-    DtmfGoertzel &max_col = col[max_col_idx];
-    max_row.reset();
-    max_col.reset();
+    Goertzel max_row(max_row_fq, INTERNAL_SAMPLE_RATE);
+    Goertzel max_col(max_col_fq, INTERNAL_SAMPLE_RATE);
     max_row.calc(block[0]);
     max_col.calc(block[0]);
     complex<double> prev_row_result = max_row.result();
@@ -455,17 +427,17 @@ void SvxSwDtmfDecoder::processBlock(void)
     }
     float row_fq = INTERNAL_SAMPLE_RATE * arg(row_sum) / (8.0 * M_PI);
     float col_fq = INTERNAL_SAMPLE_RATE * arg(col_sum) / (8.0 * M_PI);
-    float row_fqdiff = 2.0 * (row_fq - max_row.m_freq);
-    float col_fqdiff = 2.0 * (col_fq - max_col.m_freq);
+    float row_fqdiff = 2.0 * (row_fq - max_row_fq);
+    float col_fqdiff = 2.0 * (col_fq - max_col_fq);
     if (debug)
     {
       cout << " row_fqdiff=" << row_fqdiff
-           << " (" << (100.0 * row_fqdiff / max_row.m_freq) << "%)";
+           << " (" << (100.0 * row_fqdiff / max_row_fq) << "%)";
       cout << " col_fqdiff=" << col_fqdiff
-           << " (" << (100.0 * col_fqdiff / max_col.m_freq) << "%)";
+           << " (" << (100.0 * col_fqdiff / max_col_fq) << "%)";
 
-      digit_active = (abs(row_fqdiff) < max_row.m_max_fqdiff) &&
-                     (abs(col_fqdiff) < max_col.m_max_fqdiff);
+      digit_active = (abs(row_fqdiff) < MAX_FQ_ERROR * max_row_fq) &&
+                     (abs(col_fqdiff) < MAX_FQ_ERROR * max_col_fq);
     }
   }
 #endif
@@ -578,14 +550,6 @@ void SvxSwDtmfDecoder::processBlock(void)
 } /* SvxSwDtmfDecoder::processBlock */
 
 
-void SvxSwDtmfDecoder::DtmfGoertzel::initialize(float freq)
-{
-  Goertzel::initialize(freq, INTERNAL_SAMPLE_RATE);
-  m_freq = freq;
-  //m_max_fqdiff = m_freq * MAX_FQ_ERROR;
-} /* SvxSwDtmfDecoder::DtmfGoertzel::initialize */
-
-
 /*
  * This file has not been truncated
  */
@@ -56,7 +56,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
  ****************************************************************************/
 
 #include "DtmfDecoder.h"
-#include "Goertzel.h"
+#include "GoertzelBank.h"
 
 
 /****************************************************************************
@@ -165,13 +165,6 @@ class SvxSwDtmfDecoder : public DtmfDecoder
     virtual int detectionTime(void) const { return 40; }
 
   private:
-    struct DtmfGoertzel : public Goertzel
-    {
-      float m_freq;
-      float m_max_fqdiff;
-
-      void initialize(float freq);
-    };
     typedef enum
     {
       STATE_IDLE, STATE_DET_DELAY, STATE_DETECTED
@@ -195,11 +188,14 @@ class SvxSwDtmfDecoder : public DtmfDecoder
     static CONSTEXPR float MAX_OT_REL = 0.2f; // Overtone at least ~7dB below
     static CONSTEXPR float MAX_SEC_REL = 0.13f; // Second strongest > ~9dB below
     static CONSTEXPR float MAX_IM_REL = 0.1f; // Intermod prod > 10dB below
+    static CONSTEXPR size_t COL_BASE = 4; // First column tone in tone_bank
+
+    enum { CHK_ROW_OT, CHK_COL_OT, CHK_IM, CHK_CNT };
 
     float twist_nrm_thresh;
     float twist_rev_thresh;
-    std::vector<DtmfGoertzel> row;
-    std::vector<DtmfGoertzel> col;
+    GoertzelBank tone_bank;
+    GoertzelBank check_bank;
     float block[BLOCK_SIZE];
     size_t block_size;
     size_t block_pos;
@@ -80,12 +80,11 @@ using namespace Async;
 #define SEL5_RELATIVE_PEAK          20.0f  /* 13dB */
 
 // The Goertzel algorithm is just a recursive way to evaluate the DFT at a
-// single frequency. For maximum detection reliability, the bandwidth will
-// be adapted to place the tone frequency near the center of the DFT.
-// As a side effect, the detection bandwidth is slightly narrowed, which
-// however is acceptable for the SEL5 decoder. Furthermore, a time slack
-// between the tone detectors is unavoidable, since they use different
-// block lengths.
+// single frequency. All tone detectors use the same block length, given by
+// the detection bandwidth, so that they can be evaluated together in one
+// pass over the block. Since the magnitude is evaluated at the exact tone
+// frequency, there is no need to adapt the block length for each tone.
+// A new analysis block is completed every half block length.
 #define SEL5_BANDWIDTH              35     /* 35Hz */
 #define SEL5_BLOCK_LENGTH           (INTERNAL_SAMPLE_RATE / 1000)
 
@@ -129,8 +128,9 @@ using namespace Async;
  ****************************************************************************/
 
 SwSel5Decoder::SwSel5Decoder(Config &cfg, const string &name)
-  : Sel5Decoder(cfg, name), samples_left(SEL5_BLOCK_LENGTH), last_hit(0),
-    last_stable(0), stable_timer(0), active_timer(0)
+  : Sel5Decoder(cfg, name), block_pos(0), scale_factor(0.0f),
+    samples_left(SEL5_BLOCK_LENGTH), last_hit(0), last_stable(0),
+    stable_timer(0), active_timer(0)
 {
 } /* SwSel5Decoder::SwSel5Decoder */
 
@@ -315,10 +315,18 @@ bool SwSel5Decoder::initialize(void)
   memset(row_energy, 0, sizeof(row_energy));
 
   /* Init row detectors */
-  for (size_t a=0; a<tonedef.size(); a++)
+  tone_bank.initialize(vector<float>(tones, tones + tonedef.size()),
+                       INTERNAL_SAMPLE_RATE);
+  const size_t block_length = INTERNAL_SAMPLE_RATE / SEL5_BANDWIDTH;
+  block.assign(block_length, 0.0f);
+  block_pos = 0;
+  /* Scale output values to achieve same levels as before */
+  scale_factor = 1.0e6f / (block_length * block_length);
+  /* Hamming window */
+  win.resize(block_length);
+  for (size_t i = 0; i < block_length; i++)
   {
-     goertzelInit(&row_out[a],    tones[a], SEL5_BANDWIDTH, 0.0f);
-     goertzelInit(&row_out[a+20], tones[a], SEL5_BANDWIDTH, 0.5f);
+     win[i] = 0.54 - 0.46 * cosf(2.0f * M_PI * i / (block_length - 1));
   }
 
   return true;
@@ -328,31 +336,29 @@ bool SwSel5Decoder::initialize(void)
 
 int SwSel5Decoder::writeSamples(const float *buf, int len)
 {
-    for (int i = 0; i < len; i++)
+    if (block.empty())
     {
-        float v1;
-        float famp = *(buf++);
+        return len;
+    }
 
-        for (size_t k=0; k<tonedef.size(); k++)
-        {
-          v1 = row_out[k].v2;
-          row_out[k].v2 = row_out[k].v3;
-          row_out[k].v3 = row_out[k].fac * row_out[k].v2 - v1 +
-			  famp * *(row_out[k].win++);
-        }
+    int pos = 0;
+    while (pos < len)
+    {
+        /* Copy samples up to the end of the analysis block or the end of
+           the detection interval, whichever come first */
+        int cnt = min(len - pos, samples_left);
+        cnt = min(cnt, static_cast<int>(block.size() - block_pos));
+        memcpy(&block[block_pos], buf + pos, cnt * sizeof(block[0]));
+        block_pos += cnt;
+        pos += cnt;
+        samples_left -= cnt;
 
         /* Row result calculators */
-        for (size_t k=0; k<tonedef.size(); k++)
-        {
-          if (--row_out[k].samples_left == 0)
-              row_energy[k] = goertzelResult(&row_out[k]);
-
-          if (--row_out[k+20].samples_left == 0)
-              row_energy[k] = goertzelResult(&row_out[k+20]);
-        }
+        if (block_pos == block.size())
+            analyzeBlock();
 
          /* Now we are at the end of the detection block */
-        if (--samples_left == 0)
+        if (samples_left == 0)
             Sel5Receive();
     }
 
@@ -443,49 +449,22 @@ void SwSel5Decoder::Sel5PostProcess(uint8_t hit)
 } /* SwSel5Decoder::Sel5PostProcess */
 
 
-void SwSel5Decoder::goertzelInit(GoertzelState *s, float freq, float bw, float offset)
+void SwSel5Decoder::analyzeBlock(void)
 {
-    /* Adjust the block length to minimize the DFT error. */
-    s->block_length = lrintf(ceilf(freq / bw) * INTERNAL_SAMPLE_RATE / freq);
-    /* Scale output values to achieve same levels at different block lengths. */
-    s->scale_factor = 1.0e6f / (s->block_length * s->block_length);
-    /* Init detector frequency. */
-    s->fac = 2.0f * cosf(2.0f * M_PI * freq / INTERNAL_SAMPLE_RATE);
-    /* Reset the tone detector state. */
-    s->v2 = s->v3 = 0.0f;
-    s->samples_left = static_cast<int>(s->block_length * (1.0f - offset));
-    /* Hamming window */
-    for (int i = 0; i < s->block_length; i++)
+    /* Run all tone detectors over the windowed block */
+    tone_bank.reset();
+    tone_bank.calc(&block[0], block.size(), &win[0]);
+    for (size_t k=0; k<tonedef.size(); k++)
     {
-        s->window_table.push_back(
-           0.54 - 0.46 * cosf(2.0f * M_PI * i / (s->block_length - 1)));
+        row_energy[k] = tone_bank.magnitudeSquared(k) * scale_factor;
     }
-    /* Point to the first table entry */
-    s->win = s->window_table.begin();
 
-} /* SwSel5Decoder::goertzelInit */
+    /* Keep the last half of the block as the start of the next one */
+    const size_t step = block.size() / 2;
+    memmove(&block[0], &block[step], (block.size() - step) * sizeof(block[0]));
+    block_pos = block.size() - step;
 
-
-float SwSel5Decoder::goertzelResult(GoertzelState *s)
-{
-    float v1, res;
-
-    /* Push a zero through the process to finish things off. */
-    v1 = s->v2;
-    s->v2 = s->v3;
-    s->v3 = s->fac*s->v2 - v1;
-    /* Now calculate the non-recursive side of the filter. */
-    /* The result here is not scaled down to allow for the magnification
-       effect of the filter (the usual DFT magnification effect). */
-    res = (s->v3*s->v3 + s->v2*s->v2 - s->v2*s->v3*s->fac) * s->scale_factor;
-    /* Reset the tone detector state. */
-    s->v2 = s->v3 = 0.0f;
-    s->samples_left = s->block_length;
-    s->win = s->window_table.begin();
-    /* Return the calculated signal level. */
-    return res;
-
-} /* SwSel5Decoder::goertzelResult */
+} /* SwSel5Decoder::analyzeBlock */
 
 
 int SwSel5Decoder::findMaxIndex(const float f[])
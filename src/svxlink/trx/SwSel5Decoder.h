@@ -55,6 +55,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
  ****************************************************************************/
 
 #include "Sel5Decoder.h"
+#include "GoertzelBank.h"
 
 
 /****************************************************************************
@@ -102,7 +103,9 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
  * @date    2010-02-27
  *
  * This class implements a software SEL5 decoder
- * implemented using Goertzel's algorithm.
+ * implemented using Goertzel's algorithm. All tones of the selected tone set
+ * are evaluated in one pass over each block using a GoertzelBank, the same
+ * vectorized detector bank that is used by the DTMF decoder.
  */
 class SwSel5Decoder : public Sel5Decoder
 {
@@ -139,21 +142,16 @@ class SwSel5Decoder : public Sel5Decoder
 
   private:
 
-    // Tone detection descriptor
-    typedef struct
-    {
-      float v2;
-      float v3;
-      float fac;
-      float scale_factor;
-      std::vector<float> window_table;
-      std::vector<float>::const_iterator win;
-      int samples_left;
-      int block_length;
-    } GoertzelState;
-
-    /*! Tone detector working states for the row tones. */
-    GoertzelState row_out[36];
+    /*! The tone detectors for all tones in the tone set. */
+    GoertzelBank tone_bank;
+    /*! The window applied to each analysis block. */
+    std::vector<float> win;
+    /*! The analysis block. Consecutive blocks overlap by half a block. */
+    std::vector<float> block;
+    /*! The number of samples currently in the analysis block. */
+    size_t block_pos;
+    /*! Scale output values to get the same levels as the old detectors. */
+    float scale_factor;
 
     /* tone-digit table*/
     std::string tonedef;
@@ -176,8 +174,7 @@ class SwSel5Decoder : public Sel5Decoder
 
     void Sel5Receive(void);
     void Sel5PostProcess(uint8_t hit);
-    void goertzelInit(GoertzelState *s, float freq, float bw, float offset);
-    float goertzelResult(GoertzelState *s);
+    void analyzeBlock(void);
     int findMaxIndex(const float f[]);
 
 };  /* class SwSel5Decoder */
@@ -57,7 +57,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
  ****************************************************************************/
 
 #include "ToneDetector.h"
-#include "Goertzel.h"
+#include "GoertzelBank.h"
 
 
 
@@ -105,9 +105,7 @@ struct ToneDetector::DetectorParams
   float               phase_mean_thresh       = DEFAULT_PHASE_MEAN_THRESH;
   float               phase_var_thresh        = DEFAULT_PHASE_VAR_THRESH;
   float               phase_actual_fq         = 0.0f;
-  Goertzel            center;
-  Goertzel            lower;
-  Goertzel            upper;
+  GoertzelBank        bank;
   std::vector<float>  window_table;
   bool                use_windowing           = DEFAULT_USE_WINDOWING;
   float               peak_to_tot_pwr_thresh  = DEFAULT_PEAK_TO_TOT_PWR_THRESH;
@@ -264,10 +262,7 @@ void ToneDetector::reset(void)
   buf_pos = 0;
   tone_fq_est = 0.0f;
   passband_energy = 0.0f;
-  win = par->window_table.begin();
-  par->center.reset();
-  par->lower.reset();
-  par->upper.reset();
+  par->bank.reset();
   par->overlap_buf.clear();
   par->prev_res_cmplx = 0;
   phaseCheckReset();
@@ -445,56 +440,76 @@ void ToneDetector::setUndetectUseWindowing(bool enable)
 int ToneDetector::writeSamples(const float *buf, int len)
 {
   const float *end = buf + len;
+  float chunk[CHUNK_SIZE];
   while (buf != end)
   {
-    float famp;
-    if (buf_pos < par->overlap_buf.size())
+      // Find out how many samples that can be processed before something
+      // else need to be done, like the end of the block or a phase check
+    size_t chunk_len = 1;
+    if (buf_pos < par->block_len)
     {
-      famp = par->overlap_buf.at(buf_pos);
+      chunk_len = par->block_len - buf_pos;
     }
-    else
+    if ((phase_check_left > 0) &&
+        (static_cast<size_t>(phase_check_left) < chunk_len))
     {
-      famp = *buf++;
+      chunk_len = phase_check_left;
     }
-    const size_t non_overlap_len = par->block_len - par->overlap_buf_size;
-    if (buf_pos >= non_overlap_len)
+    if (chunk_len > CHUNK_SIZE)
     {
-      const size_t insert_pos = buf_pos - non_overlap_len;
-      if (insert_pos < par->overlap_buf.size())
+      chunk_len = CHUNK_SIZE;
+    }
+
+    size_t chunk_cnt = 0;
+    while ((chunk_cnt < chunk_len) && (buf != end))
+    {
+      float famp;
+      if (buf_pos < par->overlap_buf.size())
       {
-        par->overlap_buf[insert_pos] = famp;
+        famp = par->overlap_buf.at(buf_pos);
       }
       else
       {
-        par->overlap_buf.push_back(famp);
+        famp = *buf++;
+      }
+      const size_t non_overlap_len = par->block_len - par->overlap_buf_size;
+      if (buf_pos >= non_overlap_len)
+      {
+        const size_t insert_pos = buf_pos - non_overlap_len;
+        if (insert_pos < par->overlap_buf.size())
+        {
+          par->overlap_buf[insert_pos] = famp;
+        }
+        else
+        {
+          par->overlap_buf.push_back(famp);
+        }
       }
-    }
-
-    passband_energy += static_cast<double>(famp) * famp;
 
-      // First apply the Hamming window, if enabled
-    if (par->use_windowing)
-    {
-      famp *= *(win++);
-    }
+      passband_energy += static_cast<double>(famp) * famp;
 
-      // Run the recursive Goertzel stage for the center frequency
-    par->center.calc(famp);
+        // Apply the Hamming window, if enabled
+      if (par->use_windowing && (buf_pos < par->window_table.size()))
+      {
+        famp *= par->window_table[buf_pos];
+      }
 
-    if (par->peak_thresh > 0.0f)
-    {
-        // Run the recursive Goertzel stage for the lower and upper frequency
-      par->lower.calc(famp);
-      par->upper.calc(famp);
+      chunk[chunk_cnt++] = famp;
+      ++buf_pos;
     }
 
-    if ((phase_check_left > 0) && (--phase_check_left == 0))
+      // Run the recursive Goertzel stage for the center, lower and upper
+      // frequencies in one go
+    par->bank.calc(chunk, chunk_cnt);
+
+    if ((phase_check_left > 0) &&
+        ((phase_check_left -= static_cast<int>(chunk_cnt)) == 0))
     {
       phaseCheck();
       phase_check_left = par->period_block_len;
     }
 
-    if (++buf_pos >= par->block_len)
+    if (buf_pos >= par->block_len)
     {
       postProcess();
     }
@@ -529,7 +544,7 @@ void ToneDetector::phaseCheckReset(void)
 
 void ToneDetector::phaseCheck(void)
 {
-  float phase = par->center.phase();
+  float phase = par->bank.phase(BIN_CENTER);
   if (prev_phase < 2.0f * M_PI)
   {
     float diff = phase - prev_phase;
@@ -563,8 +578,8 @@ void ToneDetector::postProcess(void)
   }
 
     // Calculate the magnitude for the center bin
-  const std::complex<float> res_cmplx = par->center.result();
-  float res_center = win_comp_energy * Goertzel::magnitudeSquared(res_cmplx);
+  const std::complex<float> res_cmplx = par->bank.result(BIN_CENTER);
+  float res_center = win_comp_energy * std::norm(res_cmplx);
 
     // Now determine if the tone is active or not. We start by checking
     // if the tone energy exceed the energy threshold. This check
@@ -576,12 +591,12 @@ void ToneDetector::postProcess(void)
   {
       // Check if the center fq is above the lower fq bin by the peak threshold.
       // This is part of the "neighbour bin SNR" check.
-    float res_lower = win_comp_energy * par->lower.magnitudeSquared();
+    float res_lower = win_comp_energy * par->bank.magnitudeSquared(BIN_LOWER);
     active = active && (res_center > (res_lower * par->peak_thresh));
 
       // Check if the center fq is above the upper fq bin by the peak threshold.
       // This is part of the "neighbour bin SNR" check.
-    float res_upper = win_comp_energy * par->upper.magnitudeSquared();
+    float res_upper = win_comp_energy * par->bank.magnitudeSquared(BIN_UPPER);
     active = active && (res_center > (res_upper * par->peak_thresh));
   }
 
@@ -711,15 +726,10 @@ void ToneDetector::postProcess(void)
     tone_fq_est = 0.0f;
   }
 
-    // Point to the first windowing table entry
-  win = par->window_table.begin();
-
     // Reset sample counter
   buf_pos = 0;
 
-  par->center.reset();
-  par->lower.reset();
-  par->upper.reset();
+  par->bank.reset();
   phaseCheckReset();
   passband_energy = 0.0f;
 
@@ -853,9 +863,11 @@ void ToneDetector::setBw(ToneDetector::DetectorParams* par, float bw_hz)
     }
   }
 
-  par->center.initialize(tone_fq, INTERNAL_SAMPLE_RATE);
-  par->lower.initialize(tone_fq - 2 * bw_hz, INTERNAL_SAMPLE_RATE);
-  par->upper.initialize(tone_fq + 2 * bw_hz, INTERNAL_SAMPLE_RATE);
+  std::vector<float> fqs(BIN_CNT);
+  fqs[BIN_CENTER] = tone_fq;
+  fqs[BIN_LOWER] = tone_fq - 2 * bw_hz;
+  fqs[BIN_UPPER] = tone_fq + 2 * bw_hz;
+  par->bank.initialize(fqs, INTERNAL_SAMPLE_RATE);
 
   setOverlapPercent(par, par->overlap_percent);
 } /* ToneDetector::setBw */
@@ -552,6 +552,9 @@ class ToneDetector : public sigc::trackable, public Async::AudioSink
     static CONSTEXPR float  DEFAULT_FREQ_TOL_HZ             = 0.0f;
     static CONSTEXPR float  DEFAULT_PEAK_TO_TOT_PWR_THRESH  = 0.0f;
     static CONSTEXPR float  DEFAULT_SNR_THRESH              = 0.0f;
+    static CONSTEXPR size_t CHUNK_SIZE                      = 256;
+
+    enum { BIN_CENTER, BIN_LOWER, BIN_UPPER, BIN_CNT };
 
     const float         tone_fq;
     size_t              buf_pos;
@@ -568,8 +571,6 @@ class ToneDetector : public sigc::trackable, public Async::AudioSink
     float               last_snr;
     float               tone_fq_est;
 
-    std::vector<float>::const_iterator win;
-
     void phaseCheckReset(void);
     void phaseCheck(void);
     void postProcess(void);
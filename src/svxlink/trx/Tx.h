@@ -67,6 +67,10 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
  *
  ****************************************************************************/
 
+namespace Async
+{
+  class AudioStats;
+};
 
 
 /****************************************************************************
@@ -223,6 +227,23 @@ class Tx : public sigc::trackable, public Async::AudioSink
      * @param 	msg The frame data
      */
     virtual void sendData(const std::vector<uint8_t> &msg) {}
+
+    /**
+     * @brief   Get the number of audio underruns
+     * @return  Returns the number of times the audio output ran dry
+     *
+     * Transmitters that do not have an audio output of their own return 0.
+     */
+    virtual unsigned long audioUnderrunCount(void) const { return 0; }
+
+    /**
+     * @brief   Set the object to report audio health statistics to
+     * @param   stats The statistics object or 0 to disable reporting
+     *
+     * Call this function after the transmitter has been initialized. The
+     * statistics object is not owned by the transmitter.
+     */
+    virtual void setAudioStats(Async::AudioStats *stats) {}
     
     /**
      * @brief   Set the transmitter frequency
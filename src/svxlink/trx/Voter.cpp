@@ -6,7 +6,7 @@
 
 \verbatim
 SvxLink - A Multi Purpose Voice Services System for Ham Radio Use
-Copyright (C) 2003-2021 Tobias Blomberg / SM0SVX
+Copyright (C) 2003-2026 Tobias Blomberg / SM0SVX
 
 This program is free software; you can redistribute it and/or modify
 it under the terms of the GNU General Public License as published by
@@ -40,6 +40,8 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 #include <cstdlib>
 #include <utility>
 #include <list>
+#include <deque>
+#include <chrono>
 #include <sigc++/bind.h>
 #include <sys/time.h>
 #include <json/json.h>
@@ -56,6 +58,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 #include <AsyncAudioFifo.h>
 #include <AsyncAudioSelector.h>
 #include <AsyncAudioValve.h>
+#include <AsyncAudioPassthrough.h>
 #include <AsyncPty.h>
 #include <AsyncPtyStreamBuf.h>
 
@@ -106,13 +109,29 @@ using namespace Async;
  * its "subscribers".
  * When the receiver close its squelch, the squelch signal is delayed until
  * all audio has been flushed.
+ *
+ * If an alignment window is set, squelch and signal level events are held
+ * back until the alignment window has passed since the event was captured
+ * at the receiver. The audio is delayed by the same amount, minus the
+ * estimated network delay, so that all receivers are put on a common
+ * timeline no matter how far away they are.
+ *
+ * The most recent audio received by each receiver is kept in a small,
+ * preallocated history buffer. When the active receiver is changed while the
+ * squelch is open, the new receiver skip the audio that the old receiver
+ * already has played and its first few milliseconds are cross-faded with
+ * the continuation of the old receiver audio, taken from the history buffer.
  */
 class Voter::SatRx : public AudioSource, public sigc::trackable
 {
   public:
-    SatRx(Config &cfg, const string &rx_name, int id, int fifo_length_ms)
-      : rx_id(id), rx(0), fifo(0), sql_open(false), enabled(true),
-        mute_state(Rx::MUTE_ALL), sql_open_delay(0)
+    SatRx(Config &cfg, const string &rx_name, int id, int fifo_length_ms,
+          unsigned align_window_ms, unsigned crossfade_ms)
+      : rx_id(id), rx(0), fifo(0), align_fifo(0), sql_open(false),
+        enabled(true), mute_state(Rx::MUTE_ALL), sql_open_delay(0),
+        align_window(align_window_ms), align_timer(0, Timer::TYPE_ONESHOT, false),
+        history(HISTORY_LENGTH * INTERNAL_SAMPLE_RATE / 1000),
+        crossfade_len(crossfade_ms * INTERNAL_SAMPLE_RATE / 1000)
     {
       rx = RxFactory::createNamedRx(cfg, rx_name);
       if (rx != 0)
@@ -133,6 +152,19 @@ class Voter::SatRx : public AudioSource, public sigc::trackable
 
 	AudioSource *prev_src = rx;
 
+        prev_src->registerSink(&history);
+        prev_src = &history;
+
+        if (align_window > 0)
+        {
+          align_fifo = new AudioFifo(
+              2 * align_window * INTERNAL_SAMPLE_RATE / 1000);
+          prev_src->registerSink(align_fifo);
+          prev_src = align_fifo;
+          align_timer.expired.connect(
+                  sigc::hide(sigc::mem_fun(*this, &SatRx::processAlignQueue)));
+        }
+
 	if (fifo_length_ms > 0)
 	{
 	  fifo = new AudioFifo(fifo_length_ms * INTERNAL_SAMPLE_RATE / 1000);
@@ -148,14 +180,16 @@ class Voter::SatRx : public AudioSource, public sigc::trackable
 	
 	valve.setOpen(false);
 	prev_src->registerSink(&valve);
+        valve.registerSink(&splice);
 	
-	AudioSource::setHandler(&valve);
+	AudioSource::setHandler(&splice);
       }
     }
     
     ~SatRx(void)
     {
       delete fifo;
+      delete align_fifo;
       rx->reset();
       delete rx;
     }
@@ -196,7 +230,10 @@ class Voter::SatRx : public AudioSource, public sigc::trackable
       return rx->addToneDetector(fq, bw, thresh, required_duration);
     }
     
-    float signalStrength(void) const { return rx->signalStrength(); }
+    float signalStrength(void) const
+    {
+      return (align_fifo != 0) ? aligned_siglev : rx->signalStrength();
+    }
 
     const std::string& squelchActivityInfo(void) const
     {
@@ -222,6 +259,10 @@ class Voter::SatRx : public AudioSource, public sigc::trackable
     
     void stopOutput(bool do_stop)
     {
+      if (do_stop)
+      {
+        splice.cancel();
+      }
       valve.setOpen(!do_stop);
       if (!do_stop)
       {
@@ -255,8 +296,29 @@ class Voter::SatRx : public AudioSource, public sigc::trackable
     }
     unsigned sqlOpenDelay(void) const { return sql_open_delay; }
 
+    void spliceFrom(const SatRx& old_srx)
+    {
+        // Continue at the point in the audio stream where the old receiver
+        // stopped. Both receivers are assumed to receive the same audio at
+        // the same time so the difference in buffered audio is what the old
+        // receiver already has played.
+      const unsigned new_len = bufferedSamples();
+      const unsigned old_len = old_srx.bufferedSamples();
+      const unsigned skip = (new_len > old_len) ? new_len - old_len : 0;
+      const uint64_t old_end = old_srx.history.totalSamples();
+      if ((crossfade_len > 0) && (old_end >= old_len))
+      {
+        splice.start(skip, &old_srx.history, old_end - old_len,
+                     crossfade_len);
+      }
+      else
+      {
+        splice.start(skip, 0, 0, 0);
+      }
+    }
+
     sigc::signal<void(char, int)>     dtmfDigitDetected;
-    sigc::signal<void(string)>        selcallSequenceDetected;
+    sigc::signal<void(const string&)> selcallSequenceDetected;
     sigc::signal<void(bool, SatRx*)>  squelchOpen;
     sigc::signal<void(float, SatRx*)> signalLevelUpdated;
     sigc::signal<void(float)>         toneDetected;
@@ -265,17 +327,154 @@ class Voter::SatRx : public AudioSource, public sigc::trackable
     virtual void allSamplesFlushed(void)
     {
       AudioSource::allSamplesFlushed();
-      setSquelchOpen(rx->squelchIsOpen());
+      setSquelchOpen((align_fifo != 0) ? aligned_sql_open
+                                       : rx->squelchIsOpen());
     }
   
   
   private:
+    static const unsigned HISTORY_LENGTH = 100;
+
+    /**
+     * A preallocated ring buffer holding the most recent audio samples
+     * passing through
+     */
+    class AudioHistory : public AudioPassthrough
+    {
+      public:
+        explicit AudioHistory(unsigned len) : buf(len, 0.0f), total(0) {}
+
+        int writeSamples(const float *samples, int count) override
+        {
+          int ret = AudioPassthrough::writeSamples(samples, count);
+          for (int i=0; i<ret; ++i)
+          {
+            buf[(total + i) % buf.size()] = samples[i];
+          }
+          total += ret;
+          return ret;
+        }
+
+        uint64_t totalSamples(void) const { return total; }
+
+        bool sample(uint64_t idx, float& s) const
+        {
+          if ((idx >= total) || (total - idx > buf.size()))
+          {
+            return false;
+          }
+          s = buf[idx % buf.size()];
+          return true;
+        }
+
+      private:
+        vector<float> buf;
+        uint64_t      total;
+    };
+
+    /**
+     * Skip samples and cross-fade with the audio from another receiver
+     * when the active receiver is changed
+     */
+    class SpliceStage : public AudioPassthrough
+    {
+      public:
+        SpliceStage(void)
+          : skip(0), other(0), other_pos(0), fade_len(0), fade_pos(0) {}
+
+        void start(unsigned skip_samples, const AudioHistory *other_hist,
+                   uint64_t other_start, unsigned len)
+        {
+          skip = skip_samples;
+          other = other_hist;
+          other_pos = other_start;
+          fade_len = len;
+          fade_pos = 0;
+        }
+
+        void cancel(void)
+        {
+          skip = 0;
+          other = 0;
+        }
+
+        int writeSamples(const float *samples, int count) override
+        {
+          int done = min(count, static_cast<int>(skip));
+          skip -= done;
+          samples += done;
+          count -= done;
+
+          while ((count > 0) && (other != 0))
+          {
+            int len = min(count, min(static_cast<int>(fade_len - fade_pos),
+                                     BLOCK_SIZE));
+            int i = 0;
+            for (; i<len; ++i)
+            {
+              float o;
+              if (!other->sample(other_pos + fade_pos + i, o))
+              {
+                break;
+              }
+              float w = static_cast<float>(fade_pos + i + 1) / (fade_len + 1);
+              block[i] = w * samples[i] + (1.0f - w) * o;
+            }
+            if (i == 0)
+            {
+                // The other receiver audio is not available so the fade
+                // have to end here
+              other = 0;
+              break;
+            }
+            int ret = sinkWriteSamples(block, i);
+            fade_pos += ret;
+            done += ret;
+            samples += ret;
+            count -= ret;
+            if (fade_pos >= fade_len)
+            {
+              other = 0;
+            }
+            if (ret < i)
+            {
+              return done;
+            }
+          }
+
+          if (count > 0)
+          {
+            done += sinkWriteSamples(samples, count);
+          }
+          return done;
+        }
+
+      private:
+        static const int BLOCK_SIZE = 256;
+
+        unsigned            skip;
+        const AudioHistory  *other;
+        uint64_t            other_pos;
+        unsigned            fade_len;
+        unsigned            fade_pos;
+        float               block[BLOCK_SIZE];
+    };
+
     typedef list<pair<char, int> >	DtmfBuf;
     typedef list<string>		SelcallBuf;
+    struct AlignEvent
+    {
+      uint64_t  due;
+      bool      is_sql;
+      bool      is_open;
+      float     siglev;
+    };
+    typedef deque<AlignEvent>           AlignQueue;
     
     int		  rx_id;
     Rx		  *rx;
     AudioFifo 	  *fifo;
+    AudioFifo     *align_fifo;
     AudioValve	  valve;
     DtmfBuf   	  dtmf_buf;
     SelcallBuf	  selcall_buf;
@@ -284,6 +483,34 @@ class Voter::SatRx : public AudioSource, public sigc::trackable
     Rx::MuteState mute_state;
     unsigned      sql_open_delay;
     float         tone_detected   {-1.0};
+    unsigned      align_window;
+    AlignQueue    align_queue;
+    Timer         align_timer;
+    bool          aligned_sql_open  {false};
+    float         aligned_siglev    {0.0f};
+    AudioHistory  history;
+    SpliceStage   splice;
+    unsigned      crossfade_len;
+
+    unsigned bufferedSamples(void) const
+    {
+      unsigned len = 0;
+      if (align_fifo != 0)
+      {
+        len += align_fifo->samplesInFifo(true);
+      }
+      if (fifo != 0)
+      {
+        len += fifo->samplesInFifo(true);
+      }
+      return len;
+    }
+
+    static uint64_t currentTime(void)
+    {
+      return chrono::duration_cast<chrono::microseconds>(
+          chrono::system_clock::now().time_since_epoch()).count();
+    }
     
     void onDtmfDigitDetected(char digit, int duration)
     {
@@ -297,7 +524,7 @@ class Voter::SatRx : public AudioSource, public sigc::trackable
       }
     }
     
-    void onSelcallSequenceDetected(string sequence)
+    void onSelcallSequenceDetected(const string& sequence)
     {
       if (!valve.isOpen())
       {
@@ -322,6 +549,25 @@ class Voter::SatRx : public AudioSource, public sigc::trackable
     }
 
     void rxSquelchOpen(bool is_open)
+    {
+      if (align_fifo == 0)
+      {
+        handleSquelchOpen(is_open);
+        return;
+      }
+
+      if (is_open)
+      {
+          // Delay the audio so that it come out alignment window
+          // milliseconds after it was captured. This only take effect if
+          // the previous talk spurt has been completely played out.
+        unsigned delay = align_window - min(align_window, rx->audioDelay());
+        align_fifo->setPrebufSamples(delay * INTERNAL_SAMPLE_RATE / 1000);
+      }
+      queueAlignEvent(true, is_open, rx->signalStrength());
+    }
+
+    void handleSquelchOpen(bool is_open)
     {
       if (is_open)
       {
@@ -329,7 +575,8 @@ class Voter::SatRx : public AudioSource, public sigc::trackable
       }
       else
       {
-      	if ((fifo == 0) || fifo->empty())
+      	if (((fifo == 0) || fifo->empty()) &&
+            ((align_fifo == 0) || align_fifo->empty()))
 	{
 	  setSquelchOpen(false);
 	}
@@ -338,11 +585,73 @@ class Voter::SatRx : public AudioSource, public sigc::trackable
     
     void rxSignalLevelUpdated(float siglev)
     {
+      if (align_fifo != 0)
+      {
+        queueAlignEvent(false, false, siglev);
+        return;
+      }
+
       if (sql_open)
       {
 	signalLevelUpdated(siglev, this);
       }
     }
+
+    void queueAlignEvent(bool is_sql, bool is_open, float siglev)
+    {
+      const uint64_t now = currentTime();
+      const uint64_t window = 1000ULL * align_window;
+      uint64_t ts = now;
+      if (!rx->eventTimestamp(ts) || (ts > now))
+      {
+        ts = now;
+      }
+
+        // Events must be handled in the order they were received even if
+        // the capture timestamps say otherwise
+      AlignEvent event;
+      event.due = ts + window;
+      if (!align_queue.empty() && (event.due < align_queue.back().due))
+      {
+        event.due = align_queue.back().due;
+      }
+      event.is_sql = is_sql;
+      event.is_open = is_open;
+      event.siglev = siglev;
+      align_queue.push_back(event);
+      processAlignQueue();
+    }
+
+    void processAlignQueue(void)
+    {
+      const uint64_t now = currentTime();
+      while (!align_queue.empty() && (align_queue.front().due <= now))
+      {
+        AlignEvent event = align_queue.front();
+        align_queue.pop_front();
+        aligned_siglev = event.siglev;
+        if (event.is_sql)
+        {
+          aligned_sql_open = event.is_open;
+          handleSquelchOpen(event.is_open);
+        }
+        else if (sql_open)
+        {
+          signalLevelUpdated(event.siglev, this);
+        }
+      }
+
+      if (align_queue.empty())
+      {
+        align_timer.setEnable(false);
+      }
+      else
+      {
+        uint64_t wait_ms = (align_queue.front().due - now + 999) / 1000;
+        align_timer.setTimeout(static_cast<int>(wait_ms));
+        align_timer.setEnable(true);
+      }
+    }
     
     void setSquelchOpen(bool is_open)
     {
@@ -362,6 +671,10 @@ class Voter::SatRx : public AudioSource, public sigc::trackable
         {
           fifo->clear();
         }
+        if (align_fifo != 0)
+        {
+          align_fifo->clear();
+        }
         dtmf_buf.clear();
         selcall_buf.clear();
         tone_detected = -1.0f;
@@ -417,6 +730,13 @@ Voter::~Voter(void)
   delete selector;
   selector = 0;
   
+    // Leave any active receiver state while the receivers still exist.
+    // The state exit actions reference the active satellite receiver.
+  if (muteState() != Rx::MUTE_ALL)
+  {
+    setMuteState(Rx::MUTE_ALL);
+  }
+
     // Mute all receivers before deleting them so that we do not get any
     // unexpected updates during deletion
   list<SatRx *>::iterator it;
@@ -450,6 +770,7 @@ bool Voter::initialize(void)
       << name() << "/" << "COMMAND_PTY" << endl;
       return false;
     }
+    command_pty->setLineBuffered(true);
     command_pty->dataReceived.connect(
         sigc::mem_fun(*this, &Voter::onCommandPtyInput));
   }
@@ -471,6 +792,28 @@ bool Voter::initialize(void)
     return false;
   }
   sm->setVotingDelay(voting_delay);
+
+  float voting_margin = DEFAULT_VOTING_MARGIN;
+  cfg.getValue(name(), "VOTING_MARGIN", voting_margin);
+  if ((voting_margin < 0.0f) || (voting_margin > MAX_VOTING_MARGIN))
+  {
+    cerr << "*** ERROR: Config variable " << name() << "/VOTING_MARGIN out "
+            "of range (" << voting_margin << "). Valid range is 0 to "
+	 << MAX_VOTING_MARGIN << ".\n";
+    return false;
+  }
+  sm->setVotingMargin(voting_margin);
+
+  unsigned voting_min_delay = 0;
+  cfg.getValue(name(), "VOTING_MIN_DELAY", voting_min_delay);
+  if (voting_min_delay > voting_delay)
+  {
+    cerr << "*** ERROR: Config variable " << name() << "/VOTING_MIN_DELAY "
+            "out of range (" << voting_min_delay << "). Valid range is 0 to "
+            "VOTING_DELAY (" << voting_delay << ").\n";
+    return false;
+  }
+  sm->setVotingMinDelay(voting_min_delay);
   
   unsigned buffer_length = voting_delay;
   cfg.getValue(name(), "BUFFER_LENGTH", buffer_length);
@@ -534,6 +877,28 @@ bool Voter::initialize(void)
   }
   sm->setRxSwitchDelay(rx_switch_delay);
 
+  unsigned alignment_window = 0;
+  cfg.getValue(name(), "ALIGNMENT_WINDOW", alignment_window);
+  if (alignment_window > MAX_ALIGNMENT_WINDOW)
+  {
+    cerr << "*** ERROR: Config variable " << name()
+         << "/ALIGNMENT_WINDOW out of range ("
+	 << alignment_window << "). Valid range is 0 to "
+	 << MAX_ALIGNMENT_WINDOW << ".\n";
+    return false;
+  }
+
+  unsigned switch_crossfade = DEFAULT_SWITCH_CROSSFADE;
+  cfg.getValue(name(), "SWITCH_CROSSFADE", switch_crossfade);
+  if (switch_crossfade > MAX_SWITCH_CROSSFADE)
+  {
+    cerr << "*** ERROR: Config variable " << name()
+         << "/SWITCH_CROSSFADE out of range ("
+	 << switch_crossfade << "). Valid range is 0 to "
+	 << MAX_SWITCH_CROSSFADE << ".\n";
+    return false;
+  }
+
   cfg.getValue(name(), "VERBOSE", m_print_sat_squelch);
 
   selector = new AudioSelector;
@@ -560,7 +925,8 @@ bool Voter::initialize(void)
     if (!rx_name.empty())
     {
       cout << "\tAdding receiver: " << rx_name << endl;
-      SatRx *srx = new SatRx(cfg, rx_name, rxs.size() + 1, buffer_length);
+      SatRx *srx = new SatRx(cfg, rx_name, rxs.size() + 1, buffer_length,
+                             alignment_window, switch_crossfade);
       srx->setSqlOpenDelay(sql_open_delay);
       srx->squelchOpen.connect(mem_fun(*this, &Voter::satSquelchOpen));
       srx->signalLevelUpdated.connect(
@@ -597,7 +963,7 @@ void Voter::setMuteState(MuteState new_mute_state)
   //cout << "Voter::mute: do_mute=" << (do_mute ? "TRUE" : "FALSE") << endl;
   assert(!is_processing_event);
   Rx::setMuteState(new_mute_state);
-  dispatchEvent(Macho::Event(&Top::setMuteState, new_mute_state));
+  dispatchEvent(&Top::setMuteState, new_mute_state);
 } /* Voter::setMuteState */
 
 
@@ -633,7 +999,7 @@ char Voter::sqlRxId(void) const
 void Voter::reset(void)
 {
   assert(!is_processing_event);
-  dispatchEvent(Macho::Event(&Top::reset));
+  dispatchEvent(&Top::reset);
 } /* Voter::reset */
 
 
@@ -653,25 +1019,15 @@ void Voter::reset(void)
  *
  ****************************************************************************/
 
-void Voter::dispatchEvent(Macho::IEvent<Top> *event)
+void Voter::dispatchQueuedEvents(void)
 {
-  if (!is_processing_event)
-  {
-    is_processing_event = true;
-    sm.dispatch(event);
-    EventQueue::iterator it;
-    for (it=event_queue.begin(); it!=event_queue.end(); ++it)
-    {
-      sm.dispatch(*it);
-    }
-    event_queue.clear();
-    is_processing_event = false;
-  }
-  else
+  EventQueue::iterator it;
+  for (it=event_queue.begin(); it!=event_queue.end(); ++it)
   {
-    event_queue.push_back(event);
+    sm.dispatch(*it);
   }
-} /* Voter::dispatchEvent */
+  event_queue.clear();
+} /* Voter::dispatchQueuedEvents */
 
 
 void Voter::satSquelchOpen(bool is_open, SatRx *srx)
@@ -692,7 +1048,7 @@ void Voter::satSquelchOpen(bool is_open, SatRx *srx)
 
   if (srx->isEnabled())
   {
-    dispatchEvent(Macho::Event(&Top::satSquelchOpen, srx, is_open));
+    dispatchEvent(&Top::satSquelchOpen, srx, is_open);
   }
 
   Async::Application::app().runTask([&]{ publishSquelchState(); });
@@ -703,7 +1059,7 @@ void Voter::satSignalLevelUpdated(float siglev, SatRx *srx)
 {
   if (srx->isEnabled())
   {
-    dispatchEvent(Macho::Event(&Top::satSignalLevelUpdated, srx, siglev));
+    dispatchEvent(&Top::satSignalLevelUpdated, srx, siglev);
   }
 } /* Voter::satSignalLevelUpdated */
 
@@ -788,6 +1144,55 @@ Voter::SatRx *Voter::findBestRx(void) const
 } /* Voter::findBestRx */
 
 
+bool Voter::srxDominates(const SatRx *srx, float margin) const
+{
+  for (const auto& other : rxs)
+  {
+    if ((other != srx) && other->isEnabled() && other->squelchIsOpen() &&
+        (other->signalStrength() + margin > srx->signalStrength()))
+    {
+      return false;
+    }
+  }
+  return true;
+} /* Voter::srxDominates */
+
+
+void Voter::voteDecided(unsigned delay_ms, bool early)
+{
+  vote_stats.decisions += 1;
+  if (early)
+  {
+    vote_stats.early_decisions += 1;
+  }
+  vote_stats.total_delay += delay_ms;
+  vote_stats.max_delay = std::max(vote_stats.max_delay, delay_ms);
+  vote_stats.last_delay = delay_ms;
+  Async::Application::app().runTask([&]{ publishVoteStats(); });
+} /* Voter::voteDecided */
+
+
+void Voter::publishVoteStats(void)
+{
+  Json::Value event(Json::objectValue);
+  event["decisions"] = vote_stats.decisions;
+  event["early_decisions"] = vote_stats.early_decisions;
+  event["last_delay_ms"] = vote_stats.last_delay;
+  event["avg_delay_ms"] = (vote_stats.decisions > 0)
+    ? static_cast<unsigned>(vote_stats.total_delay / vote_stats.decisions)
+    : 0U;
+  event["max_delay_ms"] = vote_stats.max_delay;
+  Json::StreamWriterBuilder builder;
+  builder["commentStyle"] = "None";
+  builder["indentation"] = ""; //The JSON document is written on a single line
+  Json::StreamWriter* writer = builder.newStreamWriter();
+  stringstream os;
+  writer->write(event, &os);
+  delete writer;
+  publishStateEvent("Voter:vote_stats", os.str());
+} /* Voter::publishVoteStats */
+
+
 
 /****************************************************************************
  *
@@ -907,7 +1312,7 @@ void Voter::Top::stopTimer(void)
 
 void Voter::Top::eventTimerExpired(Timer *t)
 { 
-  voter().dispatchEvent(Macho::Event(&Top::timerExpired));
+  voter().dispatchEvent(&Top::timerExpired);
 } /* Voter::Top::eventTimerExpired */
 
 
@@ -974,6 +1379,7 @@ void Voter::Idle::satSquelchOpen(SatRx *srx, bool is_open)
   {
     if (srx->signalStrength() * hysteresis() > 100.0f)
     {
+      voter().voteDecided(0, true);
       setState<ActiveRxSelected>(bestSrx());
     }
     else
@@ -1001,7 +1407,13 @@ void Voter::VotingDelay::entry(void)
 void Voter::VotingDelay::init(SatRx *srx)
 {
   //cout << "### VotingDelay::init\n";
-  startTimer(max(votingDelay() - srx->sqlOpenDelay(), 0U));
+    // The voting delay is counted from when the first receiver opened its
+    // squelch, which may have been before we heard about it
+  box().begin = std::chrono::steady_clock::now() -
+                std::chrono::milliseconds(srx->sqlOpenDelay());
+  unsigned delay = isAdaptive() ? votingMinDelay() : votingDelay();
+  box().min_delay_passed = !isAdaptive();
+  startTimer((delay > elapsed()) ? delay - elapsed() : 0);
 } /* Voter::VotingDelay::init */
 
 
@@ -1019,7 +1431,11 @@ void Voter::VotingDelay::satSquelchOpen(SatRx *srx, bool is_open)
   {
     if (srx->signalStrength() * hysteresis() > 100.0f)
     {
-      setState<ActiveRxSelected>(bestSrx());
+      decide(true);
+    }
+    else if (box().min_delay_passed && isAdaptive() && bestIsClear())
+    {
+      decide(true);
     }
   }
   else
@@ -1032,14 +1448,59 @@ void Voter::VotingDelay::satSquelchOpen(SatRx *srx, bool is_open)
 } /* Voter::VotingDelay::satSquelchOpen */
 
 
+void Voter::VotingDelay::satSignalLevelUpdated(SatRx *srx, float siglev)
+{
+  SUPER::satSignalLevelUpdated(srx, siglev);
+  if (box().min_delay_passed && isAdaptive() && bestIsClear())
+  {
+    decide(true);
+  }
+} /* Voter::VotingDelay::satSignalLevelUpdated */
+
+
 void Voter::VotingDelay::timerExpired(void)
 {
   assert(bestSrx() != 0);
   assert(bestSrx()->squelchIsOpen());
-  setState<ActiveRxSelected>(bestSrx());
+  if (!box().min_delay_passed)
+  {
+      // Only wait for the full voting delay if the signal levels are close
+    box().min_delay_passed = true;
+    if (bestIsClear())
+    {
+      decide(true);
+    }
+    else
+    {
+      unsigned delay = votingDelay();
+      startTimer((delay > elapsed()) ? delay - elapsed() : 0);
+    }
+    return;
+  }
+  decide(false);
 } /* Voter::VotingDelay::timerExpired */
 
 
+unsigned Voter::VotingDelay::elapsed(void)
+{
+  return std::chrono::duration_cast<std::chrono::milliseconds>(
+      std::chrono::steady_clock::now() - box().begin).count();
+} /* Voter::VotingDelay::elapsed */
+
+
+bool Voter::VotingDelay::bestIsClear(void)
+{
+  return (bestSrx() != 0) && voter().srxDominates(bestSrx(), votingMargin());
+} /* Voter::VotingDelay::bestIsClear */
+
+
+void Voter::VotingDelay::decide(bool early)
+{
+  voter().voteDecided(elapsed(), early);
+  setState<ActiveRxSelected>(bestSrx());
+} /* Voter::VotingDelay::decide */
+
+
 
 /****************************************************************************
  *
@@ -1161,6 +1622,7 @@ float Voter::SquelchOpen::signalStrength(void)
 
 void Voter::SquelchOpen::changeActiveSrx(SatRx *srx)
 {
+  srx->spliceFrom(*activeSrx());
   runTask(bind(mem_fun(*activeSrx(), &SatRx::stopOutput), true));
   SUPER::changeActiveSrx(srx);
   runTask(bind(mem_fun(*activeSrx(), &SatRx::stopOutput), false));
@@ -1338,29 +1800,9 @@ void Voter::SwitchActiveRx::timerExpired(void)
 
 void Voter::onCommandPtyInput(const void *buf, size_t count)
 {
+    // The PTY is line buffered so each call contain one command
   const char *buffer = reinterpret_cast<const char*>(buf);
-  for (size_t i=0; i<count; ++i)
-  {
-    char ch = buffer[i];
-    switch (ch)
-    {
-      case '\n':  // Execute command on NL
-        handlePtyCommand(command_buf);
-        command_buf.clear();
-        break;
-
-      case '\r':  // Ignore CR
-        break;
-
-      default:    // Append character to command buffer
-        if (command_buf.size() >= 256)  // Prevent cmd buffer growing too big
-        {
-          command_buf.clear();
-        }
-        command_buf += ch;
-        break;
-    }
-  }
+  handlePtyCommand(std::string(buffer, count));
 } /* Voter::onCommandPtyInput */
 
 
@@ -1418,7 +1860,7 @@ void Voter::setRxEnabled(const std::string &rx_name,
                   << std::endl;
         if (srx->squelchIsOpen())
         {
-          dispatchEvent(Macho::Event(&Top::satSquelchOpen, srx, do_enable));
+          dispatchEvent(&Top::satSquelchOpen, srx, do_enable);
         }
         publishSquelchState();
       }
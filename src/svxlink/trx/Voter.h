@@ -6,7 +6,7 @@
 
 \verbatim
 SvxLink - A Multi Purpose Voice Services System for Ham Radio Use
-Copyright (C) 2003-2021 Tobias Blomberg / SM0SVX
+Copyright (C) 2003-2026 Tobias Blomberg / SM0SVX
 
 This program is free software; you can redistribute it and/or modify
 it under the terms of the GNU General Public License as published by
@@ -36,6 +36,9 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
  ****************************************************************************/
 
 #include <list>
+#include <utility>
+#include <chrono>
+#include <cstdint>
 
 
 /****************************************************************************
@@ -197,6 +200,8 @@ class Voter : public Rx
     static CONSTEXPR unsigned DEFAULT_SQL_CLOSE_REVOTE_DELAY = 500;
     static CONSTEXPR unsigned DEFAULT_REVOTE_INTERVAL        = 1000;
     static CONSTEXPR unsigned DEFAULT_RX_SWITCH_DELAY        = 500;
+    static CONSTEXPR unsigned DEFAULT_SWITCH_CROSSFADE       = 5;
+    static CONSTEXPR float    DEFAULT_VOTING_MARGIN          = 0.0f;
     
     static CONSTEXPR unsigned MAX_VOTING_DELAY               = 5000;
     static CONSTEXPR unsigned MAX_BUFFER_LENGTH              = MAX_VOTING_DELAY;
@@ -205,6 +210,18 @@ class Voter : public Rx
     static CONSTEXPR unsigned MIN_REVOTE_INTERVAL            = 100;
     static CONSTEXPR unsigned MAX_REVOTE_INTERVAL            = 60000;
     static CONSTEXPR unsigned MAX_RX_SWITCH_DELAY            = 3000;
+    static CONSTEXPR unsigned MAX_ALIGNMENT_WINDOW           = 1000;
+    static CONSTEXPR unsigned MAX_SWITCH_CROSSFADE           = 50;
+    static CONSTEXPR float    MAX_VOTING_MARGIN              = 100.0f;
+
+    struct VoteStats
+    {
+      unsigned  decisions       = 0;
+      unsigned  early_decisions = 0;
+      uint64_t  total_delay     = 0;
+      unsigned  max_delay       = 0;
+      unsigned  last_delay      = 0;
+    };
 
     class SatRx;
 
@@ -213,7 +230,8 @@ class Voter : public Rx
 	// Top state variables (visible to all substates)
       struct Box {
 	Box(void)
-	  : voting_delay(DEFAULT_VOTING_DEALAY), hysteresis(DEFAULT_HYSTERESIS),
+	  : voting_delay(DEFAULT_VOTING_DEALAY), voting_min_delay(0),
+	    voting_margin(DEFAULT_VOTING_MARGIN), hysteresis(DEFAULT_HYSTERESIS),
 	    sql_close_revote_delay(DEFAULT_SQL_CLOSE_REVOTE_DELAY),
 	    rx_switch_delay(DEFAULT_RX_SWITCH_DELAY),
 	    revote_interval(DEFAULT_REVOTE_INTERVAL), voter(0), best_srx(0),
@@ -223,6 +241,8 @@ class Voter : public Rx
 	}
 	
 	unsigned	voting_delay;
+	unsigned	voting_min_delay;
+	float		voting_margin;
 	float		hysteresis;
 	unsigned	sql_close_revote_delay;
 	unsigned	rx_switch_delay;
@@ -240,6 +260,13 @@ class Voter : public Rx
         box().voting_delay = delay_ms;
       }
       unsigned votingDelay(void) { return box().voting_delay; }
+      void setVotingMinDelay(unsigned delay_ms)
+      {
+        box().voting_min_delay = delay_ms;
+      }
+      unsigned votingMinDelay(void) { return box().voting_min_delay; }
+      void setVotingMargin(float margin) { box().voting_margin = margin; }
+      float votingMargin(void) { return box().voting_margin; }
       void setHysteresis(float hysteresis) { box().hysteresis = hysteresis; }
       float hysteresis(void) { return box().hysteresis; }
       void setSqlCloseRevoteDelay(unsigned delay_ms)
@@ -312,16 +339,28 @@ class Voter : public Rx
 
     SUBSTATE(VotingDelay, Top)
     {
+      struct Box
+      {
+	Box(void) : min_delay_passed(true) {}
+	std::chrono::steady_clock::time_point begin;
+	bool min_delay_passed;
+      };
+
       STATE(VotingDelay)
 
       virtual void timerExpired(void);
       virtual void satSquelchOpen(SatRx *srx, bool is_open);
+      virtual void satSignalLevelUpdated(SatRx *srx, float siglev);
 
       private:
         void entry(void);
         void init(void) {}
         void init(SatRx *srx);
         void exit(void);
+        bool isAdaptive(void) { return votingMargin() > 0.0f; }
+        unsigned elapsed(void);
+        bool bestIsClear(void);
+        void decide(bool early);
 	
     };
 
@@ -417,10 +456,34 @@ class Voter : public Rx
     bool		  is_processing_event;
     EventQueue		  event_queue;
     Async::Pty            *command_pty;
-    std::string           command_buf;
     bool                  m_print_sat_squelch;
-
-    void dispatchEvent(Macho::IEvent<Top> *event);
+    VoteStats             vote_stats;
+
+      /*
+       * Call an event handler in the current state. Every squelch and signal
+       * level update from the satellites end up here so the handler is
+       * called directly, without allocating a Macho event object. Only an
+       * event generated while another event is being processed need to be
+       * stored to be dispatched later.
+       */
+    template <typename... Params, typename... Args>
+    void dispatchEvent(void (Top::*handler)(Params...), Args&&... args)
+    {
+      if (!is_processing_event)
+      {
+        is_processing_event = true;
+          // The temporary returned by operator-> perform pending state
+          // transitions when it is destroyed, after the handler has returned
+        (sm.operator->().operator->()->*handler)(std::forward<Args>(args)...);
+        dispatchQueuedEvents();
+        is_processing_event = false;
+      }
+      else
+      {
+        event_queue.push_back(Macho::Event(handler, args...));
+      }
+    }
+    void dispatchQueuedEvents(void);
     void satSquelchOpen(bool is_open, SatRx *rx);
     void satSignalLevelUpdated(float siglev, SatRx *srx);
     void muteAllBut(SatRx *srx, Rx::MuteState mute_state);
@@ -429,6 +492,9 @@ class Voter : public Rx
     void resetAll(void);
     void publishSquelchState(void);
     SatRx *findBestRx(void) const;
+    bool srxDominates(const SatRx *srx, float margin) const;
+    void voteDecided(unsigned delay_ms, bool early);
+    void publishVoteStats(void);
     void onCommandPtyInput(const void *buf, size_t count);
     void handlePtyCommand(const std::string &full_command);
     void setRxEnabled(const std::string &rx_name,
@@ -33,11 +33,15 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
  ****************************************************************************/
 
 #include <stdint.h>
+#include <cstdlib>
 #include <cassert>
 #include <limits>
 #include <algorithm>
 #include <deque>
 #include <iterator>
+#include <sstream>
+#include <iomanip>
+#include <sys/time.h>
 
 
 /****************************************************************************
@@ -47,6 +51,9 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
  ****************************************************************************/
 
 #include <AsyncConfig.h>
+#include <AsyncWorkerPool.h>
+#include <AsyncThreadSched.h>
+#include <AsyncPty.h>
 
 
 /****************************************************************************
@@ -57,10 +64,13 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 
 #include "WbRxRtlSdr.h"
 #include "RtlTcp.h"
+#include "RtlRemote.h"
 #ifdef HAS_RTLSDR_SUPPORT
 #include "RtlUsb.h"
 #endif
 #include "Ddr.h"
+#include "PfbChannelizer.h"
+#include "SpectrumTap.h"
 
 
 
@@ -136,11 +146,62 @@ WbRxRtlSdr *WbRxRtlSdr::instance(Async::Config &cfg, const string &name)
 } /* WbRxRtlSdr::instance */
 
 
-WbRxRtlSdr::WbRxRtlSdr(Async::Config &cfg, const string &name)
-  : auto_tune_enabled(true), m_name(name), xvrtr_offset(0)
+WbRxRtlSdr *WbRxRtlSdr::select(Async::Config &cfg,
+                               const vector<string> &names,
+                               const Ddr *ddr, WbRxRtlSdr *current)
 {
-  //cout << "### Initializing WBRX " << name << endl;
+  if ((current != 0) && current->canCover(ddr))
+  {
+    return current;
+  }
+
+  vector<uint32_t> fqs;
+  ddr->coveredFqs(fqs);
+  string best_name;
+  size_t best_load = numeric_limits<size_t>::max();
+  for (vector<string>::const_iterator it=names.begin(); it!=names.end(); ++it)
+  {
+    const string& name = *it;
+    size_t load = 0;
+    bool covers = false;
+    InstanceMap::iterator iit = instances.find(name);
+    if (iit != instances.end())
+    {
+      WbRxRtlSdr *wbrx = (*iit).second;
+      covers = wbrx->canCover(ddr);
+      load = wbrx->ddrLoad(ddr);
+    }
+    else
+    {
+        // Check the configuration of tuners that have not been created yet
+        // so that no dongle is opened just to find out that it is not used
+      uint32_t sample_rate = 960000;
+      cfg.getValue(name, "SAMPLE_RATE", sample_rate);
+      uint32_t center_fq = 0;
+      bool auto_tune = !cfg.getValue(name, "CENTER_FQ", center_fq);
+      covers = fqsFit(fqs, auto_tune, center_fq, sample_rate);
+    }
+    if (covers && (load < best_load))
+    {
+      best_name = name;
+      best_load = load;
+    }
+  }
+
+  if (best_name.empty())
+  {
+    if (current != 0)
+    {
+      return current;
+    }
+    best_name = names.front();
+  }
+  return instance(cfg, best_name);
+} /* WbRxRtlSdr::select */
+
 
+RtlSdr *WbRxRtlSdr::createDongle(Async::Config &cfg, const string &name)
+{
   string rtl_type = "RtlTcp";
   cfg.getValue(name, "TYPE", rtl_type);
   if (rtl_type == "RtlTcp")
@@ -152,7 +213,15 @@ WbRxRtlSdr::WbRxRtlSdr(Async::Config &cfg, const string &name)
 
     //cout << "###   HOST        = " << remote_host << endl;
     //cout << "###   PORT        = " << tcp_port << endl;
-    rtl = new RtlTcp(remote_host, tcp_port);
+    return new RtlTcp(remote_host, tcp_port);
+  }
+  else if (rtl_type == "RtlRemote")
+  {
+    string remote_host = "localhost";
+    cfg.getValue(name, "HOST", remote_host);
+    uint16_t tcp_port = RtlRemoteMsg::DEFAULT_PORT;
+    cfg.getValue(name, "PORT", tcp_port);
+    return new RtlRemote(remote_host, tcp_port);
   }
 #ifdef HAS_RTLSDR_SUPPORT
   else if (rtl_type == "RtlUsb")
@@ -160,14 +229,28 @@ WbRxRtlSdr::WbRxRtlSdr(Async::Config &cfg, const string &name)
     string dev_match = "0";
     cfg.getValue(name, "DEV_MATCH", dev_match);
     //cout << "###   DEV_MATCH   = " << dev_match << endl;
-    rtl = new RtlUsb(dev_match);
+    return new RtlUsb(dev_match);
   }
 #endif
-  else
+
+  cerr << "*** ERROR: Unknown WbRx type: " << rtl_type << endl;
+  return 0;
+} /* WbRxRtlSdr::createDongle */
+
+
+WbRxRtlSdr::WbRxRtlSdr(Async::Config &cfg, const string &name)
+  : rtl(0), remote(0), auto_tune_enabled(true), m_name(name),
+    xvrtr_offset(0), use_pfb(true), pfb(0), worker_pool(0), spectrum_tap(0),
+    spectrum_pty(0)
+{
+  //cout << "### Initializing WBRX " << name << endl;
+
+  rtl = createDongle(cfg, name);
+  if (rtl == 0)
   {
-    cerr << "*** ERROR: Unknown WbRx type: " << rtl_type << endl;
     exit(1);
   }
+  remote = dynamic_cast<RtlRemote*>(rtl);
 
   int sample_rate = 960000;
   cfg.getValue(name, "SAMPLE_RATE", sample_rate);
@@ -206,6 +289,36 @@ WbRxRtlSdr::WbRxRtlSdr(Async::Config &cfg, const string &name)
   bool peak_meter = false;
   cfg.getValue(name, "PEAK_METER", peak_meter);
   rtl->enableDistPrint(peak_meter);
+
+  cfg.getValue(name, "PFB_CHANNELIZER", use_pfb);
+
+    // A remote IQ server only send channelizer bins so the filter bank
+    // cannot be disabled
+  if (remote != 0)
+  {
+    if (!use_pfb)
+    {
+      cerr << "*** WARNING: " << name << "/PFB_CHANNELIZER cannot be "
+           << "disabled for TYPE=RtlRemote" << endl;
+      use_pfb = true;
+    }
+    if (!PfbChannelizer::isSupported(sample_rate))
+    {
+      cerr << "*** ERROR: " << name << "/SAMPLE_RATE must be 960000 or "
+           << "2400000 for TYPE=RtlRemote" << endl;
+      exit(1);
+    }
+  }
+
+  if (!setupWorkerPool(cfg))
+  {
+    exit(1);
+  }
+
+  if (!setupSpectrumTap(cfg))
+  {
+    exit(1);
+  }
 } /* WbRxRtlSdr::WbRxRtlSdr */
 
 
@@ -213,6 +326,14 @@ WbRxRtlSdr::~WbRxRtlSdr(void)
 {
   delete rtl;
   rtl = 0;
+  delete pfb;
+  pfb = 0;
+  delete worker_pool;
+  worker_pool = 0;
+  delete spectrum_tap;
+  spectrum_tap = 0;
+  delete spectrum_pty;
+  spectrum_pty = 0;
 } /* WbRxRtlSdr::~WbRxRtlSdr */
 
 
@@ -273,13 +394,44 @@ void WbRxRtlSdr::unregisterDdr(Ddr *ddr)
 
 void WbRxRtlSdr::updateDdrFq(Ddr *ddr)
 {
-  if (auto_tune_enabled)
+  if (!auto_tune_enabled)
   {
-    findBestCenterFq();
+    return;
   }
+
+    // Keep the tuner where it is if the new frequency fit in the current
+    // passband, away from the center of the band. Retuning the DDR is then
+    // just a matter of changing its frequency offset, which is what make
+    // scanning fast.
+  int64_t offset = static_cast<int64_t>(ddr->nbFq()) - centerFq();
+  int64_t max_offset = static_cast<int64_t>(sampleRate() / 2) - 12500;
+  if ((llabs(offset) >= 12500) && (llabs(offset) <= max_offset))
+  {
+    return;
+  }
+  findBestCenterFq();
 } /* WbRxRtlSdr::updateDdrFq */
 
 
+PfbChannelizer *WbRxRtlSdr::channelizer(void)
+{
+  if ((pfb == 0) && use_pfb && PfbChannelizer::isSupported(sampleRate()))
+  {
+    pfb = new PfbChannelizer(sampleRate());
+    if (remote != 0)
+    {
+      remote->setChannelizer(pfb);
+    }
+    else
+    {
+      rtl->iqReceived.connect(
+          sigc::mem_fun(*pfb, &PfbChannelizer::iqReceived));
+    }
+  }
+  return pfb;
+} /* WbRxRtlSdr::channelizer */
+
+
 bool WbRxRtlSdr::isReady(void) const
 {
   return (rtl != 0) && rtl->isReady();
@@ -301,6 +453,95 @@ bool WbRxRtlSdr::isReady(void) const
  *
  ****************************************************************************/
 
+bool WbRxRtlSdr::fqsFit(const vector<uint32_t>& fqs, bool auto_tune,
+                        uint32_t center_fq, uint32_t sample_rate)
+{
+  if (fqs.empty())
+  {
+    return true;
+  }
+  if (auto_tune)
+  {
+    uint32_t span = *max_element(fqs.begin(), fqs.end()) -
+                    *min_element(fqs.begin(), fqs.end());
+    return span <= sample_rate - 25000;
+  }
+  const int64_t max_offset = static_cast<int64_t>(sample_rate / 2) - 12500;
+  for (vector<uint32_t>::const_iterator it=fqs.begin(); it!=fqs.end(); ++it)
+  {
+    if (llabs(static_cast<int64_t>(*it) - center_fq) > max_offset)
+    {
+      return false;
+    }
+  }
+  return true;
+} /* WbRxRtlSdr::fqsFit */
+
+
+bool WbRxRtlSdr::canCover(const Ddr *ddr)
+{
+  vector<uint32_t> fqs;
+  ddr->coveredFqs(fqs);
+  if (auto_tune_enabled)
+  {
+      // The tuner will be placed to cover all of its DDR:s so the
+      // frequencies of the other DDR:s have to fit as well
+    for (Ddrs::iterator it=ddrs.begin(); it!=ddrs.end(); ++it)
+    {
+      if (*it != ddr)
+      {
+        (*it)->coveredFqs(fqs);
+      }
+    }
+  }
+  return fqsFit(fqs, auto_tune_enabled, centerFq(), sampleRate());
+} /* WbRxRtlSdr::canCover */
+
+
+size_t WbRxRtlSdr::ddrLoad(const Ddr *ddr) const
+{
+  return ddrs.size() - ddrs.count(const_cast<Ddr*>(ddr));
+} /* WbRxRtlSdr::ddrLoad */
+
+
+bool WbRxRtlSdr::setupWorkerPool(Async::Config &cfg)
+{
+  unsigned worker_threads = 0;
+  cfg.getValue(m_name, "WORKER_THREADS", worker_threads);
+  if (worker_threads == 0)
+  {
+    return true;
+  }
+
+    // Each tuner get its own thread class when pinned so that the channels
+    // of different tuners can be kept on different CPU cores
+  string thread_class("worker");
+  string cpu_list;
+  if (cfg.getValue(m_name, "WORKER_CPUS", cpu_list) && !cpu_list.empty())
+  {
+    Async::ThreadSched::Params params;
+    if (!Async::ThreadSched::parseCpuList(cpu_list, params.cpus))
+    {
+      cerr << "*** ERROR: Illegal CPU list \"" << cpu_list
+           << "\" in config variable " << m_name << "/WORKER_CPUS" << endl;
+      return false;
+    }
+    thread_class = "ddr_" + m_name;
+    Async::ThreadSched::setParams(thread_class, params);
+  }
+
+  worker_pool = new Async::WorkerPool(worker_threads, thread_class);
+  if (!worker_pool->initOk())
+  {
+    cerr << "*** WARNING: " << m_name << ": Could not start the DDR worker "
+         << "threads. Demodulating in the main thread." << endl;
+    delete worker_pool;
+    worker_pool = 0;
+  }
+  return true;
+} /* WbRxRtlSdr::setupWorkerPool */
+
+
 void WbRxRtlSdr::findBestCenterFq(void)
 {
   if (ddrs.empty())
@@ -318,7 +559,9 @@ void WbRxRtlSdr::findBestCenterFq(void)
          << ": fq=" << ddr->nbFq()
          << endl;
     */
-    fqs.push_back(ddr->nbFq());
+    vector<uint32_t> ddr_fqs;
+    ddr->coveredFqs(ddr_fqs);
+    fqs.insert(fqs.end(), ddr_fqs.begin(), ddr_fqs.end());
   }
   sort(fqs.begin(), fqs.end());
 
@@ -406,6 +649,73 @@ void WbRxRtlSdr::rtlReadyStateChanged(void)
 } /* WbRxRtlSdr::rtlReadyStateChanged */
 
 
+bool WbRxRtlSdr::setupSpectrumTap(Async::Config &cfg)
+{
+  string pty_path;
+  if (!cfg.getValue(m_name, "SPECTRUM_PTY", pty_path) || pty_path.empty())
+  {
+    return true;
+  }
+  if (remote != 0)
+  {
+    cerr << "*** WARNING: " << m_name << "/SPECTRUM_PTY is not supported "
+         << "for TYPE=RtlRemote since no wideband samples are received"
+         << endl;
+    return true;
+  }
+
+  unsigned fft_size = 1024;
+  cfg.getValue(m_name, "SPECTRUM_FFT_SIZE", fft_size);
+  if (!SpectrumTap::isValidFftSize(fft_size))
+  {
+    cerr << "*** ERROR: " << m_name << "/SPECTRUM_FFT_SIZE must be a power "
+         << "of two between 16 and 65536" << endl;
+    return false;
+  }
+  unsigned frame_rate = 2;
+  cfg.getValue(m_name, "SPECTRUM_RATE", frame_rate);
+
+  spectrum_pty = new Async::Pty(pty_path);
+  if (!spectrum_pty->open())
+  {
+    cerr << "*** ERROR: Could not open spectrum PTY " << pty_path
+         << " as specified in configuration variable " << m_name
+         << "/SPECTRUM_PTY" << endl;
+    delete spectrum_pty;
+    spectrum_pty = 0;
+    return false;
+  }
+
+  spectrum_tap = new SpectrumTap(sampleRate(), fft_size, frame_rate);
+  spectrum_tap->frameReady.connect(
+      mem_fun(*this, &WbRxRtlSdr::spectrumFrameReady));
+  rtl->iqReceived.connect(
+      sigc::mem_fun(*spectrum_tap, &SpectrumTap::iqReceived));
+
+  return true;
+} /* WbRxRtlSdr::setupSpectrumTap */
+
+
+void WbRxRtlSdr::spectrumFrameReady(const std::vector<float>& power)
+{
+  struct timeval tv;
+  gettimeofday(&tv, NULL);
+  ostringstream os;
+  os << setfill('0');
+  os << tv.tv_sec << "." << setw(3) << tv.tv_usec / 1000 << " ";
+  os << setfill(' ') << fixed << setprecision(1);
+  os << "SPECTRUM " << centerFq() << " " << sampleRate() << " "
+     << power.size();
+  for (std::vector<float>::const_iterator it=power.begin();
+       it!=power.end(); ++it)
+  {
+    os << " " << *it;
+  }
+  os << endl;
+  spectrum_pty->write(os.str());
+} /* WbRxRtlSdr::spectrumFrameReady */
+
+
 
 /*
  * This file has not been truncated
@@ -68,9 +68,14 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 namespace Async
 {
   class Config;
+  class WorkerPool;
+  class Pty;
 };
 class RtlSdr;
+class RtlRemote;
 class Ddr;
+class PfbChannelizer;
+class SpectrumTap;
 
 
 /****************************************************************************
@@ -128,6 +133,35 @@ class WbRxRtlSdr : public sigc::trackable
 
     static WbRxRtlSdr *instance(Async::Config &cfg, const std::string &name);
 
+    /**
+     * @brief   Select the tuner to use for a DDR among a group of tuners
+     * @param   cfg The configuration object
+     * @param   names The names of the configuration sections for the tuners
+     * @param   ddr The DDR to find a tuner for
+     * @param   current The tuner that the DDR currently use, or 0 if none
+     * @returns Returns the selected tuner or 0 if it could not be created
+     *
+     * The current tuner is kept as long as it cover all frequencies of the
+     * DDR. Otherwise the tuner that cover the frequencies and that has the
+     * fewest DDR:s is selected, creating it if necessary. If no tuner cover
+     * the frequencies, the current tuner or the first one is selected.
+     */
+    static WbRxRtlSdr *select(Async::Config &cfg,
+                              const std::vector<std::string> &names,
+                              const Ddr *ddr, WbRxRtlSdr *current);
+
+    /**
+     * @brief   Create a tuner object from a configuration section
+     * @param   cfg The configuration object
+     * @param   name The name of the configuration section
+     * @returns Returns a new tuner object or 0 if TYPE is unknown
+     *
+     * The TYPE configuration variable select which tuner class to create.
+     * The HOST, PORT and DEV_MATCH configuration variables are also read
+     * here, depending on the type. The caller own the returned object.
+     */
+    static RtlSdr *createDongle(Async::Config &cfg, const std::string &name);
+
     /**
      * @brief 	Constructor
      * @param   cfg A previously initialized configuration object
@@ -183,6 +217,27 @@ class WbRxRtlSdr : public sigc::trackable
      */
     void updateDdrFq(Ddr *ddr);
 
+    /**
+     * @brief   Get the channelizer shared by all DDR:s on this tuner
+     * @returns Returns the channelizer or 0 if not enabled or not supported
+     *
+     * The channelizer is created the first time this function is called. All
+     * DDR:s using the returned channelizer share the cost of splitting the
+     * wideband signal into channels.
+     */
+    PfbChannelizer *channelizer(void);
+
+    /**
+     * @brief   Get the worker pool used to demodulate the DDR channels
+     * @returns Returns the worker pool or 0 if not enabled
+     *
+     * When set up using the WORKER_THREADS configuration variable, all
+     * DDR:s on this tuner process their channels concurrently in the
+     * threads of this pool. The threads may be pinned to a set of CPUs
+     * using the WORKER_CPUS configuration variable.
+     */
+    Async::WorkerPool *workerPool(void) { return worker_pool; }
+
     /**
      * @brief   Get the name of this tuner object
      * @returns Returns the name of this tuner object
@@ -201,9 +256,9 @@ class WbRxRtlSdr : public sigc::trackable
      *
      * Connecting to this signal is the way to get samples from the DVB-T
      * dongle. The format is a vector of complex floats (I/Q) with a range from
-     * -1 to 1.
+     * -1 to 1. The samples are only valid during the signal emission.
      */
-    sigc::signal<void(std::vector<Sample>)> iqReceived;
+    sigc::signal<void(const std::vector<Sample>&)> iqReceived;
     
     /**
      * @brief   A signal that is emitted when the ready state changes
@@ -219,15 +274,29 @@ class WbRxRtlSdr : public sigc::trackable
     static InstanceMap instances;
 
     RtlSdr *rtl;
+    RtlRemote *remote;
     Ddrs ddrs;
     bool auto_tune_enabled;
     std::string m_name;
     int xvrtr_offset;
+    bool use_pfb;
+    PfbChannelizer *pfb;
+    Async::WorkerPool *worker_pool;
+    SpectrumTap *spectrum_tap;
+    Async::Pty *spectrum_pty;
+
+    static bool fqsFit(const std::vector<uint32_t>& fqs, bool auto_tune,
+                       uint32_t center_fq, uint32_t sample_rate);
 
     WbRxRtlSdr(const WbRxRtlSdr&);
     WbRxRtlSdr& operator=(const WbRxRtlSdr&);
+    bool canCover(const Ddr *ddr);
+    size_t ddrLoad(const Ddr *ddr) const;
+    bool setupWorkerPool(Async::Config &cfg);
     void findBestCenterFq(void);
     void rtlReadyStateChanged(void);
+    bool setupSpectrumTap(Async::Config &cfg);
+    void spectrumFrameReady(const std::vector<float>& power);
     
 };  /* class WbRxRtlSdr */
 
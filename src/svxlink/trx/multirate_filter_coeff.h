@@ -22,8 +22,8 @@ Passband ripple: 0.1 dB
 Transition band: 0.09375 (4500Hz)
 Stopband attenuation: 60.0 dB
 */
-static const int coeff_48_16_int_taps = 30;
-static const float coeff_48_16_int[coeff_48_16_int_taps] =
+static constexpr int coeff_48_16_int_taps = 30;
+static constexpr float coeff_48_16_int[coeff_48_16_int_taps] =
 {
   -0.001104533022845565,
   1.4483111628894497E-4,
@@ -70,8 +70,8 @@ Passband ripple: 0.1 dB
 Transition band: 0.05208333333333333333 (2500Hz)
 Stopband attenuation: 60.0 dB
 */
-static const int coeff_48_16_taps = 50;
-static const float coeff_48_16[coeff_48_16_taps] =
+static constexpr int coeff_48_16_taps = 50;
+static constexpr float coeff_48_16[coeff_48_16_taps] =
 {
   -0.0006552324784575,
   -0.0023665474931056,
@@ -148,8 +148,8 @@ frequency range is not used anyway.
 What is gained by using a wider transition band is that the filter will have
 a lower order which reduce required CPU power and filter delay.
 */
-static const int coeff_48_16_wide_taps = 54;
-static const float coeff_48_16_wide[coeff_48_16_wide_taps] =
+static constexpr int coeff_48_16_wide_taps = 54;
+static constexpr float coeff_48_16_wide[coeff_48_16_wide_taps] =
 {
   5.11059239270262E-4,
   -8.255590813253409E-4,
@@ -220,8 +220,8 @@ Passband ripple: 0.1 dB
 Transition band: 0.03125 (500Hz)
 Stopband attenuation: 62.0 dB
 */
-static const int coeff_16_8_taps = 90;
-static const float coeff_16_8[coeff_16_8_taps] =
+static constexpr int coeff_16_8_taps = 90;
+static constexpr float coeff_16_8[coeff_16_8_taps] =
 {
   4.4954770039301524E-4,
   -8.268172996066966E-4,